@@ -1,4 +1,4 @@
-__all__=['GeniusError', 'CmdQueue', 'GeniusCommand', 'CmdRunDeck', 'CmdQueryStruct', 'GeniusCtrl']
+__all__=['GeniusError', 'CmdQueue', 'GeniusCommand', 'CmdRunDeck', 'CmdQueryStruct', 'CmdOpenSolver', 'CmdBias', 'CmdCloseSolver', 'SolverSession', 'GeniusCtrl']
 
 import os
 import sys
@@ -18,8 +18,11 @@ class GeniusError(Exception):
 
 class GeniusCommand(object):
     opcode = 'nop'
+    # independent requests, which can be solved by different sweep groups at the same time
+    batchable = False
     def __init__(self):
         self.finished = threading.Event()
+        self.result = None
     
     def __str__(self):
         return self.toStr()
@@ -215,6 +218,175 @@ class CmdRunDeck(GeniusCommand):
         return True
 
         
+def _parseParams(str):
+    ''' parse "name=value name=value ..." to a dict, numbers are converted to float '''
+    params = {}
+    for item in str.split():
+        name, sep, value = item.partition('=')
+        if not sep:
+            raise ValueError
+        try:
+            params[name] = float(value)
+        except ValueError:
+            if value.lower() in ('true', 'false'):
+                params[name] = value.lower()=='true'
+            else:
+                params[name] = value
+    return params
+
+
+class CmdOpenSolver(GeniusCommand):
+    ''' open-solver type=steadystate ...
+        keep a solver of the resident device alive, for the following bias commands
+    '''
+    opcode = 'open-solver'
+    def __init__(self, paramStr=''):
+        super(CmdOpenSolver, self).__init__()
+        self.paramStr = paramStr
+
+    def toStr(self):
+        return 'open-solver %s' % self.paramStr
+
+    def fromStr(self, str):
+        m = re.match('^open-solver\s*(.*)$', str, re.I)
+        if m==None:
+            raise ValueError
+        self.paramStr = m.group(1).rstrip()
+        return self
+
+    def do(self):
+        if GeniusCtrl.session:
+            GeniusCtrl.session.close()
+            GeniusCtrl.session = None
+        GeniusCtrl.session = SolverSession(**_parseParams(self.paramStr))
+        self.result = 'ok'
+        return True
+
+
+class CmdCloseSolver(GeniusCommand):
+    opcode = 'close-solver'
+    def toStr(self):
+        return 'close-solver'
+
+    def fromStr(self, str):
+        if not re.match('^close-solver\s*$', str, re.I):
+            raise ValueError
+        return self
+
+    def do(self):
+        if GeniusCtrl.session:
+            GeniusCtrl.session.close()
+            GeniusCtrl.session = None
+        self.result = 'ok'
+        return True
+
+
+class CmdBias(GeniusCommand):
+    ''' bias <electrode>=<V> ...
+        set electrode voltages and solve with the open solver, warm started from the last solution.
+        result is one line "electrode potential(V) current(A)" for each electrode
+    '''
+    opcode = 'bias'
+    batchable = True
+    def __init__(self, biasStr=''):
+        super(CmdBias, self).__init__()
+        self.biasStr = biasStr
+
+    def toStr(self):
+        return 'bias %s' % self.biasStr
+
+    def fromStr(self, str):
+        m = re.match('^bias\s*(.*)$', str, re.I)
+        if m==None:
+            raise ValueError
+        self.biasStr = m.group(1).rstrip()
+        return self
+
+    def do(self):
+        session = GeniusCtrl.session
+        if session==None:
+            raise GeniusError("No solver is opened.")
+        for electrode, v in _parseParams(self.biasStr).items():
+            session.set_voltage(electrode, v)
+        session.solve()
+
+        system = GeniusCtrl.SolverControl.system()
+        sip.transferto(system, None) ## temporary workaround
+        lines = []
+        for i in xrange(system.n_bcs()):
+            bc = system.get_bc(i)
+            sip.transferto(bc, None)
+            if bc.is_electrode():
+                lines.append('%s %e %e' % (bc.label(), bc.electrode_potential(), bc.electrode_current()))
+        self.result = '\n'.join(lines)+'\n'
+        return True
+
+
+class SolverSession(object):
+    ''' Keep one solver alive for in-process parameter sweeps.
+        The deck must have been run (mesh, models and methods are set up).
+        The dof map, Jacobian pattern and preconditioner are built once by the constructor,
+        each solve() is warm started from the last solution.
+
+        s = SolverSession(type='steadystate')
+        for v in vlist:
+            s.set_voltage('drain', v)
+            s.solve()
+            n = s.node_data('channel', 'electron')
+        s.close()
+    '''
+    def __init__(self, **params):
+        card = GeniusCtrl.Parser.Card('SOLVE')
+        for name, value in params.items():
+            card.insert(name.replace('_', '.'), value)
+        if not GeniusCtrl.pattern.check_detail(card)==0:
+            raise GeniusError("Invalid SOLVE parameters.")
+
+        self.control = GeniusCtrl.SolverControl
+        if not self.control.open_solver(card)==0:
+            raise GeniusError("Selected solver is not supported.")
+
+    def solve(self):
+        if not self.control.run_solver()==0:
+            raise GeniusError("Solver failed.")
+
+    def close(self):
+        self.control.close_solver()
+
+    def set_voltage(self, electrode, v):
+        if not self.control.set_electrode_voltage(electrode, v)==0:
+            raise GeniusError("Electrode %s can't be found." % electrode)
+
+    def set_current(self, electrode, i):
+        if not self.control.set_electrode_current(electrode, i)==0:
+            raise GeniusError("Electrode %s can't be found." % electrode)
+
+    def set_bc_parameter(self, label, name, value):
+        ''' value is in genius internal unit '''
+        if not self.control.set_bc_parameter(label, name, value)==0:
+            raise GeniusError("Parameter %s of boundary %s can't be found." % (name, label))
+
+    def node_data(self, region, variable, scaled=False):
+        ''' NumPy view of the node variable of region, in genius internal unit.
+            the array shares memory with the solver and is writable, it is only valid
+            until the simulation system is rebuilt. scaled=True returns a copy in user unit
+        '''
+        import numpy
+        system = self.control.system()
+        sip.transferto(system, None) ## temporary workaround
+        r = system.region(region)
+        if r==None:
+            raise GeniusError("Region %s can't be found." % region)
+        sip.transferto(r, None)
+        buf = r.node_variable(variable)
+        if buf==None:
+            raise GeniusError("Variable %s of region %s can't be found." % (variable, region))
+        a = numpy.frombuffer(buf, dtype=numpy.float64)
+        if scaled:
+            return a/r.node_variable_unit(variable)
+        return a
+
+
 class CmdQueue:
     ''' Command queue. Only the first processor maintains this queue, 
         which accepts commands from the (HTTP) front-end.
@@ -249,6 +421,17 @@ class CmdQueue:
         self.lock.release()
         return cmd
 
+    def getBatch(self, n):
+        ''' Remove and return at most n batchable commands at the head of queue
+        '''
+        self.lock.acquire()
+        batch = []
+        while len(batch)<n and len(self.queue)>0 and self.queue[0].batchable:
+            batch.append(self.queue[0])
+            self.queue = self.queue[1:]
+        self.lock.release()
+        return batch
+
 class GeniusCtrlClass:
     def __init__(self):
         self._g = {}
@@ -260,6 +443,7 @@ class GeniusCtrlClass:
         self._cmdQueue = None
         
         self.patternFile = None
+        self.session = None
         
     def __getattr__(self, name):
         if name=='SolverControl':
@@ -313,7 +497,7 @@ class GeniusCtrlClass:
         genius.Genius.set_genius_dir(GeniusDir)
         self._g = genius
 
-    def initialize(self, jobName='genius'):
+    def initialize(self, jobName='genius', sweepGroups=1):
         try:
             self._loadGenius()
         except GeniusError, e:
@@ -322,12 +506,18 @@ class GeniusCtrlClass:
         
         self.jobName = jobName
         petscOpts = ['dummy', '-on_error_attach_debugger', 'noxterm']
+        if sweepGroups>1:
+            # each sweep group keeps its own copy of the device on a MPI sub-communicator
+            petscOpts.extend(['-sweep_groups', str(sweepGroups)])
         self.Genius.init_processors(petscOpts)
        
-        self.logFilename = os.path.abspath('%s.log.%d' % (self.jobName, self.Genius.processor_id()))
+        if self.Genius.n_sweep_groups()>1:
+            self.logFilename = os.path.abspath('%s.log.g%d.%d' % (self.jobName, self.Genius.sweep_group(), self.Genius.processor_id()))
+        else:
+            self.logFilename = os.path.abspath('%s.log.%d' % (self.jobName, self.Genius.processor_id()))
         self.Genius.add_log_filename('file', self.logFilename)
         self.log = self.Genius.log
-        if self.Genius.processor_id()==0 and sys.stdout.isatty():
+        if self.isFarmRoot() and sys.stdout.isatty():
           self.Genius.add_log_file('console', sys.stdout);
         
         self.log("Genius initialized successfully.\n")
@@ -350,7 +540,11 @@ class GeniusCtrlClass:
     def finalize(self):
         self.log("Shutting down Genius...\n")
          
-        if self.Genius.processor_id()==0:
+        if self.session:
+            self.session.close()
+            self.session = None
+
+        if self.isFarmRoot():
             self.Genius.remove_log_file('console');
         self.Genius.remove_log_file('file');
         
@@ -359,13 +553,23 @@ class GeniusCtrlClass:
         self.ready = False
         self.running = False
 
+    def isFarmRoot(self):
+        ''' the first processor of sweep group 0, which maintains the command queue '''
+        return self.Genius.sweep_group()==0 and self.Genius.processor_id()==0
+
     def run(self):
+        ''' Command loop. Commands are broadcast to all the sweep groups and executed by each of them,
+            so every group keeps the same resident device. Batchable commands at the head of queue
+            are dispatched one for each sweep group, and their results are gathered back.
+        '''
         nopCnt=10
+        nGroups = self.Genius.n_sweep_groups()
+        group = self.Genius.sweep_group()
         while(True):
             time.sleep(0.5)
-            cmd = None
-            if self.Genius.processor_id()==0:
-                # processor 0 gets the original command object
+            cmds = None
+            if self.isFarmRoot():
+                # farm root gets the original command objects
                 if self._cmdQueue==None:
                     raise ValueError
 
@@ -382,29 +586,53 @@ class GeniusCtrlClass:
                 elif not isinstance(cmd, GeniusCommand):
                     raise TypeError
 
-                self.Parallel.broadcast(cmd.toStr(),0)
+                cmds = [cmd]
+                if cmd.batchable:
+                    cmds.extend(self._cmdQueue.getBatch(nGroups-1))
+
+                self.Parallel.farm_broadcast('\n'.join([c.toStr() for c in cmds]))
 
             else:
                 # other processors make a copy of the command from the string 
                 # some properties (e.g. finished event) are lost
-                cmdStr=None
-                cmdStr=self.Parallel.broadcast(cmdStr,0)
-                cmd = _mkCmdFromStr(cmdStr)
+                cmdStr = self.Parallel.farm_broadcast(None)
+                cmds = [_mkCmdFromStr(c) for c in cmdStr.split('\n')]
 
-            if isinstance(cmd, CmdQuit):
-                cmd.finished.set()
+            if isinstance(cmds[0], CmdQuit):
+                cmds[0].finished.set()
                 break;
+
+            if cmds[0].batchable:
+                # the i-th request of the batch is solved by the i-th sweep group
+                myCmds = cmds[group:group+1]
             else:
+                myCmds = cmds
+
+            for cmd in myCmds:
                 try:
                     cmd.do()
                 except Exception, e:
                     self.log(str(e)+'\n')
-                finally:
-                    cmd.finished.set()
+
+            if cmds[0].batchable and nGroups>1:
+                # the first processor of each group sends its result marked by 'R', or 'N' for failure
+                result = ''
+                if self.Genius.processor_id()==0 and len(myCmds)>0:
+                    if myCmds[0].result==None:
+                        result = 'N'
+                    else:
+                        result = 'R' + str(myCmds[0].result)
+                results = [r for r in self.Parallel.farm_gather(result) if r]
+                for i in xrange(1, min(len(cmds), len(results))):
+                    if results[i][0]=='R':
+                        cmds[i].result = results[i][1:]
+
+            for cmd in cmds:
+                cmd.finished.set()
 
     def setCmdQueue(self, queue):
         self._cmdQueue=queue
         
 # module initialization
 GeniusCtrl = GeniusCtrlClass()
-ValidCommands = [GeniusCommand, CmdQuit, CmdRunDeck, CmdReset, CmdChdir, CmdQueryStruct]
+ValidCommands = [GeniusCommand, CmdQuit, CmdRunDeck, CmdReset, CmdChdir, CmdQueryStruct, CmdOpenSolver, CmdCloseSolver, CmdBias]
@@ -107,6 +107,7 @@ class HTTPFrontEnd(SocketServer.ThreadingMixIn, HTTPServer):
                ('/status(/(?P<cmd>quit|exit|reset|chdir|tmpdir))', self.doStatusCmd),
                ('/status(/(?P<cmd>name|pwd|wait))?(\?(?P<arg>.*))?', self.doStatusQuery),
                ('/deck(/(?P<type>file|text))', self.doRunDeck),
+               ('/solver/(?P<cmd>open|bias|close)', self.doSolver),
                ('/solution', self.doSolution),
                ('/struct(/(?P<format>xml|text))', self.doStructQuery),
                ('/file/(?P<path>.*)', self.doFile)
@@ -184,6 +185,40 @@ class HTTPFrontEnd(SocketServer.ThreadingMixIn, HTTPServer):
             return
                         
     
+    def doSolver(self, param, request):
+        '''
+            POST /solver/open   open a solver on the resident device, body: type=steadystate ...
+            POST /solver/bias   solve with the open solver, body: <electrode>=<V> ...
+                                returns "electrode potential current" lines
+            POST /solver/close  close the solver
+        '''
+        self._checkError(request)
+        if not request.command=='POST':
+            request.send_error(405) # method not allowed
+            return
+
+        cmd = param['cmd']
+        body = ''
+        if not cmd=='close':
+            body = request.rfile.readline().strip()
+
+        if cmd=='open':
+            gCmd = self.cmdQueue.addCmd('open-solver %s' % body)
+        elif cmd=='bias':
+            gCmd = self.cmdQueue.addCmd('bias %s' % body)
+        else:
+            gCmd = self.cmdQueue.addCmd('close-solver')
+
+        gCmd.finished.wait()
+        if gCmd.result==None:
+            request.send_error(500)
+            return
+
+        request.send_response(200)
+        request.send_header('Content-Type', 'text/plain')
+        request.end_headers()
+        request.wfile.write(str(gCmd.result))
+
     def doStatusCmd(self, param, request):
         '''
             POST /status/quit   quit
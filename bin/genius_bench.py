@@ -0,0 +1,268 @@
+#!/usr/bin/env python
+#
+# Performance benchmark of Genius.
+#
+# Runs the cases of a suite file (see genius_bench_suite.json) at several mesh
+# sizes, collects timing, memory and Newton statistics from the perf.report and
+# counters.report files of each SOLVE command, and compares them to a baseline.
+#
+# Usage:
+#   genius_bench.py [options]
+#     --genius=<bin>      genius executable [$GENIUS_DIR/bin/genius]
+#     --examples=<dir>    examples directory [../examples]
+#     --suite=<file>      suite file [genius_bench_suite.json]
+#     --case=<name>       only run cases whose name starts with <name>, can be repeated
+#     --np=<n>            run with mpirun -np <n>
+#     --work=<dir>        work directory [bench_work]
+#     --output=<file>     write results of this run to <file> [bench_result.json]
+#     --baseline=<file>   compare with baseline, exit with 1 when any metric regresses
+#     --update            write results of this run as the new baseline
+#     --threshold=<r>     relative regression threshold of time and memory [0.2]
+#
+from __future__ import print_function
+
+import getopt
+import glob
+import json
+import os
+import re
+import shutil
+import subprocess
+import sys
+import time
+
+try:
+    import resource
+except ImportError:
+    resource = None
+
+
+# metrics compared against baseline: name -> (relative threshold scale, absolute floor)
+# a metric regresses when value > base*(1+threshold*scale) + floor
+METRICS = {
+    'wall_time'           : (1.0, 0.05),
+    'setup_time'          : (1.0, 0.05),
+    'residual_time'       : (1.0, 0.05),
+    'jacobian_time'       : (1.0, 0.05),
+    'linear_solve_time'   : (1.0, 0.05),
+    'memory_mb'           : (0.5, 2.0),
+    'newton_iterations'   : (0.5, 2),
+    'ksp_iterations'      : (1.0, 10),
+    'linesearch_cutbacks' : (1.0, 2),
+    'rejected_steps'      : (1.0, 1),
+}
+
+
+def usage():
+    sys.stderr.write(open(__file__).read().split('from __future__')[0].replace('#', ''))
+
+
+def scale_deck(text, scale):
+    """multiply N.SPACES of the mesh cards by scale"""
+    if scale == 1:
+        return text
+    def rep(m):
+        return '%s%d' % (m.group(1), max(1, int(round(int(m.group(2))*scale))))
+    return re.sub(r'(?i)(n\.spaces\s*=\s*)(\d+)', rep, text)
+
+
+def instrument_deck(text, tag):
+    """add perf.report and counters.report to each SOLVE command"""
+    lines = text.split('\n')
+    n_solve = 0
+    for i, line in enumerate(lines):
+        if not re.match(r'(?i)^\s*solve\b', line):
+            continue
+        body, sep, comment = line.partition('#')
+        body = body.rstrip()
+        cont = body.endswith('\\')
+        if cont:
+            body = body[:-1].rstrip()
+        body += ' perf.report=%s.perf%d.json counters.report=%s.counters%d.json' % (tag, n_solve, tag, n_solve)
+        if cont:
+            body += ' \\'
+        lines[i] = body + (' ' + sep + comment if sep else '')
+        n_solve += 1
+    return '\n'.join(lines)
+
+
+def child_maxrss_mb():
+    if resource is None:
+        return 0.0
+    rss = resource.getrusage(resource.RUSAGE_CHILDREN).ru_maxrss
+    # ru_maxrss is in bytes on Mac OS X, KB elsewhere
+    if sys.platform == 'darwin':
+        return rss/1024.0/1024.0
+    return rss/1024.0
+
+
+def collect_reports(workdir, tag):
+    """sum the perf and counters reports written by the SOLVE commands"""
+    r = dict(solve_time=0.0, residual_time=0.0, jacobian_time=0.0, newton_step_time=0.0,
+             newton_iterations=0, ksp_iterations=0, linesearch_cutbacks=0, rejected_steps=0)
+
+    for fname in glob.glob(os.path.join(workdir, '%s.perf*.json' % tag)):
+        rep = json.load(open(fname))
+        r['solve_time'] += rep.get('wall_time', 0.0)
+        for sec in rep.get('sections', []):
+            if sec.get('section') != 'total':
+                continue
+            for ev in sec.get('events', []):
+                name = ev.get('event', '')
+                if name.endswith('Solver_Residual()'):
+                    r['residual_time'] += ev['time']
+                elif name.endswith('Solver_Jacobian()'):
+                    r['jacobian_time'] += ev['time']
+                elif name.startswith('Newton step'):
+                    r['newton_step_time'] += ev['time']
+
+    for fname in glob.glob(os.path.join(workdir, '%s.counters*.json' % tag)):
+        c = json.load(open(fname)).get('counters', {})
+        r['newton_iterations']   += c.get('newton.iterations', 0)
+        r['ksp_iterations']      += c.get('ksp.iterations', 0)
+        r['linesearch_cutbacks'] += c.get('linesearch.cutbacks', 0)
+        r['rejected_steps']      += c.get('timestep.rejected', 0)
+    return r
+
+
+def run_case(case, scale, opts):
+    name = '%s@x%g' % (case['name'], scale)
+    workdir = os.path.join(opts['work'], name)
+    if os.path.exists(workdir):
+        shutil.rmtree(workdir)
+    os.makedirs(workdir)
+
+    totals = dict(wall_time=0.0, solve_time=0.0, residual_time=0.0, jacobian_time=0.0,
+                  newton_step_time=0.0, memory_mb=0.0, newton_iterations=0, ksp_iterations=0,
+                  linesearch_cutbacks=0, rejected_steps=0)
+
+    for k, deck in enumerate(case['decks']):
+        src = os.path.join(opts['examples'], deck)
+        # auxiliary files (profiles, netlists) next to the deck
+        for f in glob.glob(os.path.join(os.path.dirname(src), '*')):
+            if os.path.isfile(f) and not os.path.exists(os.path.join(workdir, os.path.basename(f))):
+                shutil.copy(f, workdir)
+
+        tag = 'bench%d' % k
+        text = instrument_deck(scale_deck(open(src).read(), scale), tag)
+        inp = os.path.join(workdir, os.path.basename(deck))
+        open(inp, 'w').write(text)
+
+        cmd = [opts['genius'], '-i', os.path.basename(deck)]
+        if opts['np'] > 1:
+            cmd = ['mpirun', '-np', str(opts['np'])] + cmd
+
+        log = open(os.path.join(workdir, os.path.basename(deck) + '.log'), 'w')
+        t0 = time.time()
+        ret = subprocess.call(cmd, cwd=workdir, stdout=log, stderr=subprocess.STDOUT)
+        wall = time.time() - t0
+        log.close()
+        if ret != 0:
+            raise RuntimeError('%s failed with status %d, see %s' % (deck, ret, log.name))
+
+        rep = collect_reports(workdir, tag)
+        totals['wall_time'] += wall
+        for key in rep:
+            totals[key] += rep[key]
+
+    # the high water mark of all the child processes so far, cases run in increasing order
+    totals['memory_mb'] = child_maxrss_mb()
+
+    totals['setup_time'] = max(0.0, totals['wall_time'] - totals['solve_time'])
+    # the Newton step event covers Jacobian, KSP and line search
+    totals['linear_solve_time'] = max(0.0, totals['newton_step_time'] - totals['jacobian_time'] - totals['residual_time'])
+    del totals['newton_step_time']
+    return name, totals
+
+
+def compare(result, baseline, threshold):
+    regressions = []
+    for name, metrics in sorted(result.items()):
+        base = baseline.get(name)
+        if base is None:
+            print('  %-24s no baseline' % name)
+            continue
+        for m, (scale, floor) in sorted(METRICS.items()):
+            if m not in base or m not in metrics:
+                continue
+            limit = base[m]*(1.0 + threshold*scale) + floor
+            if metrics[m] > limit:
+                regressions.append((name, m, base[m], metrics[m]))
+    return regressions
+
+
+def main():
+    bindir = os.path.dirname(os.path.abspath(__file__))
+    genius_dir = os.environ.get('GENIUS_DIR', os.path.join(bindir, '..'))
+    opts = dict(genius=os.path.join(genius_dir, 'bin', 'genius'),
+                examples=os.path.join(bindir, '..', 'examples'),
+                suite=os.path.join(bindir, 'genius_bench_suite.json'),
+                cases=[], np=1, work='bench_work', output='bench_result.json',
+                baseline=None, update=False, threshold=0.2)
+    try:
+        o, args = getopt.getopt(sys.argv[1:], 'h', ['genius=', 'examples=', 'suite=', 'case=', 'np=', 'work=',
+                                                     'output=', 'baseline=', 'update', 'threshold=', 'help'])
+    except getopt.GetoptError as err:
+        print(err)
+        usage()
+        return 2
+
+    for k, v in o:
+        if k in ('-h', '--help'):
+            usage()
+            return 0
+        elif k == '--case':
+            opts['cases'].append(v)
+        elif k == '--np':
+            opts['np'] = int(v)
+        elif k == '--threshold':
+            opts['threshold'] = float(v)
+        elif k == '--update':
+            opts['update'] = True
+        else:
+            opts[k[2:]] = v
+    opts['genius'] = os.path.abspath(opts['genius'])
+    opts['work'] = os.path.abspath(opts['work'])
+
+    suite = json.load(open(opts['suite']))
+
+    result = {}
+    failed = []
+    for case in suite['cases']:
+        if opts['cases'] and not any(case['name'].startswith(c) for c in opts['cases']):
+            continue
+        for scale in sorted(case.get('scales', [1])):
+            try:
+                name, metrics = run_case(case, scale, opts)
+            except (RuntimeError, OSError) as err:
+                print('  %s@x%g FAILED: %s' % (case['name'], scale, err))
+                failed.append(case['name'])
+                continue
+            result[name] = metrics
+            print('  %-24s wall %8.2fs  setup %7.2fs  residual %7.2fs  jacobian %7.2fs  linear %7.2fs  mem %7.1fMB  newton %5d  ksp %6d'
+                  % (name, metrics['wall_time'], metrics['setup_time'], metrics['residual_time'], metrics['jacobian_time'],
+                     metrics['linear_solve_time'], metrics['memory_mb'], metrics['newton_iterations'], metrics['ksp_iterations']))
+
+    record = dict(suite=os.path.basename(opts['suite']), np=opts['np'], date=time.strftime('%Y-%m-%d %H:%M:%S'), cases=result)
+    json.dump(record, open(opts['output'], 'w'), indent=2, sort_keys=True)
+
+    status = 1 if failed else 0
+    if opts['baseline'] and os.path.exists(opts['baseline']) and not opts['update']:
+        baseline = json.load(open(opts['baseline'])).get('cases', {})
+        regressions = compare(result, baseline, opts['threshold'])
+        for name, m, b, v in regressions:
+            print('  REGRESSION %-24s %-20s baseline %-12g now %g' % (name, m, b, v))
+        if regressions:
+            status = 1
+        else:
+            print('  no regression against %s' % opts['baseline'])
+
+    if opts['update'] and opts['baseline']:
+        json.dump(record, open(opts['baseline'], 'w'), indent=2, sort_keys=True)
+        print('  baseline written to %s' % opts['baseline'])
+
+    return status
+
+
+if __name__ == '__main__':
+    sys.exit(main())
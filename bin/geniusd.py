@@ -20,22 +20,28 @@ class NullStream:
   def writelines(self, seq): pass
 
 def usage():
-    print '''geniusd.py -a <server name>'''
+    print '''geniusd.py -a <server name> [-g <sweep groups>]
+
+    -g n   split the MPI processors into n groups, each keeps a copy of the device,
+           independent bias requests are solved by the groups at the same time'''
 
 def main():
 
     # parse options
     try:
-        cmdOpts, args = getopt.getopt(sys.argv[1:], 'ha:')
+        cmdOpts, args = getopt.getopt(sys.argv[1:], 'ha:g:')
     except getopt.GetoptError, err:
         print(err)
         usage()
         exit(-1)
         
     serverName=None
+    sweepGroups=1
     for opt,val in cmdOpts:
         if opt=='-a':
             serverName = val
+        elif opt=='-g':
+            sweepGroups = int(val)
         elif opt=='-h':
             usage()
             exit(0)
@@ -44,7 +50,7 @@ def main():
 
     # initialize Genius
     try:
-        GeniusCtrl.initialize(serverName)
+        GeniusCtrl.initialize(serverName, sweepGroups)
     except GeniusError, e:
         sys.stderr.write(e.message+'\n')
         sys.exit(-1)
@@ -62,8 +68,8 @@ def main():
     worker = threading.Thread(target=GeniusCtrl.run)
     worker.start()
 
-    if GeniusCtrl.Genius.processor_id()==0:
-        # start HTTP front-end at process 0
+    if GeniusCtrl.isFarmRoot():
+        # start HTTP front-end at process 0 of sweep group 0
         fe = None
         try:
             fe = HTTPFrontEnd(GeniusCtrl, cmdQueue, serverName)
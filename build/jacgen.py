@@ -0,0 +1,418 @@
+#! /usr/bin/env python
+# encoding: utf-8
+
+"""
+jacgen: generate straight-line value and derivative code from model definitions.
+
+A definition file (*.jac) holds one or more functions
+
+  ## doc line, copied to the generated doc comment
+  function In_dd(Vt, dV, n1, n2, h) wrt(dV, n1, n2)
+    u = dV/Vt
+    b = bern(u)
+    return Vt*(n2*(b+u) - n1*b)/h
+  end
+
+The body is a list of assignments and one return, in python expression syntax.
+Known functions: exp log sqrt pow fabs bern. bern is evaluated by the branchless
+bern_nb() of bern_nb.h, which gives the value and derivative at once.
+
+For each function the generated header has
+  NAME_jac(args..., &d_v...)  value and partial derivatives to the wrt arguments
+  NAME_jac(AutoDScalar ...)   AD result built by chain rule from the partials,
+                              checked against NAME_ref<AutoDScalar> in DEBUG build
+  NAME_ref<T>(args...)        the definition evaluated on any scalar type
+
+As waf tool it turns every *.jac source into <name>_jac.h in the build directory.
+It also runs standalone: python jacgen.py input.jac output.h
+"""
+
+import ast
+import os
+import re
+import sys
+
+FUNCS = ('exp', 'log', 'sqrt', 'pow', 'fabs', 'bern')
+
+
+class JacgenError(Exception):
+  pass
+
+
+def _num(node):
+  if hasattr(ast, 'Constant') and isinstance(node, ast.Constant) and isinstance(node.value, (int, float)):
+    return node.value
+  if hasattr(ast, 'Num') and isinstance(node, ast.Num):
+    return node.n
+  return None
+
+
+def _lit(v):
+  s = repr(float(v))
+  return s
+
+
+class Function(object):
+  def __init__(self, name, args, wrt, doc):
+    self.name = name
+    self.args = args
+    self.wrt = wrt
+    self.doc = doc
+    self.stmts = []   # (name, python expression string)
+    self.ret = None
+
+
+def parse(text):
+  funcs = []
+  doc = []
+  cur = None
+  for lineno, raw in enumerate(text.splitlines(), 1):
+    line = raw.strip()
+    if line.startswith('##'):
+      doc.append(line[2:].strip())
+      continue
+    line = line.split('#')[0].strip()
+    if not line:
+      continue
+    m = re.match(r'function\s+(\w+)\s*\(([^)]*)\)\s*wrt\s*\(([^)]*)\)$', line)
+    if m:
+      if cur:
+        raise JacgenError('line %d: nested function' % lineno)
+      args = [a.strip() for a in m.group(2).split(',') if a.strip()]
+      wrt = [a.strip() for a in m.group(3).split(',') if a.strip()]
+      for v in wrt:
+        if v not in args:
+          raise JacgenError('line %d: %s is not an argument' % (lineno, v))
+      cur = Function(m.group(1), args, wrt, doc)
+      doc = []
+      continue
+    if cur is None:
+      raise JacgenError('line %d: statement outside function' % lineno)
+    if line == 'end':
+      if cur.ret is None:
+        raise JacgenError('line %d: function %s has no return' % (lineno, cur.name))
+      funcs.append(cur)
+      cur = None
+      continue
+    if line.startswith('return '):
+      cur.ret = line[len('return '):]
+      continue
+    m = re.match(r'(\w+)\s*=\s*(.+)$', line)
+    if not m:
+      raise JacgenError('line %d: can not parse "%s"' % (lineno, line))
+    cur.stmts.append((m.group(1), m.group(2)))
+  if cur:
+    raise JacgenError('function %s has no end' % cur.name)
+  return funcs
+
+
+class Emitter(object):
+  """
+  forward mode source transformation. every call is hoisted to a temporary,
+  so the derivative of a call result refers to the temporary itself.
+  """
+  def __init__(self, func):
+    self.func = func
+    self.lines = []
+    self.deriv = {}     # name -> {wrt: c++ expression}
+    self.ntmp = 0
+    for a in func.args:
+      self.deriv[a] = {}
+    for v in func.wrt:
+      self.deriv[v] = {v: '1.0'}
+
+  def tmp(self):
+    self.ntmp += 1
+    return '_t%d' % self.ntmp
+
+  # replace every call by a temporary holding its value
+  def hoist(self, node):
+    if isinstance(node, ast.UnaryOp):
+      if not isinstance(node.op, ast.USub):
+        raise JacgenError('%s: unsupported operator' % self.func.name)
+      return ast.UnaryOp(op=node.op, operand=self.hoist(node.operand))
+    if isinstance(node, ast.BinOp):
+      if isinstance(node.op, ast.Pow):
+        return self.call('pow', [self.hoist(node.left), self.hoist(node.right)])
+      return ast.BinOp(left=self.hoist(node.left), op=node.op, right=self.hoist(node.right))
+    if isinstance(node, ast.Call):
+      if not isinstance(node.func, ast.Name):
+        raise JacgenError('%s: unsupported call' % self.func.name)
+      return self.call(node.func.id, [self.hoist(a) for a in node.args])
+    if isinstance(node, ast.Name) and node.id not in self.deriv:
+      raise JacgenError('%s: unknown name %s' % (self.func.name, node.id))
+    return node
+
+  # c++ text of call free expression
+  def expr(self, node):
+    n = _num(node)
+    if n is not None:
+      return _lit(n)
+    if isinstance(node, ast.Name):
+      return node.id
+    if isinstance(node, ast.UnaryOp):
+      return '(-%s)' % self.expr(node.operand)
+    if isinstance(node, ast.BinOp):
+      ops = {ast.Add: '+', ast.Sub: '-', ast.Mult: '*', ast.Div: '/'}
+      op = ops.get(type(node.op))
+      if op is None:
+        raise JacgenError('%s: unsupported operator' % self.func.name)
+      return '(%s %s %s)' % (self.expr(node.left), op, self.expr(node.right))
+    raise JacgenError('%s: unsupported expression' % self.func.name)
+
+  # derivative of expression to v, None for zero
+  def d(self, node, v):
+    if _num(node) is not None:
+      return None
+    if isinstance(node, ast.Name):
+      return self.deriv[node.id].get(v)
+    if isinstance(node, ast.UnaryOp):
+      da = self.d(node.operand, v)
+      return None if da is None else '(-%s)' % da
+    if isinstance(node, ast.BinOp):
+      a, b = node.left, node.right
+      da, db = self.d(a, v), self.d(b, v)
+      if isinstance(node.op, (ast.Add, ast.Sub)):
+        s = '+' if isinstance(node.op, ast.Add) else '-'
+        if da is None and db is None: return None
+        if db is None: return da
+        if da is None: return db if s == '+' else '(-%s)' % db
+        return '(%s %s %s)' % (da, s, db)
+      if isinstance(node.op, ast.Mult):
+        terms = []
+        if da is not None: terms.append('%s*%s' % (da, self.expr(b)))
+        if db is not None: terms.append('%s*%s' % (self.expr(a), db))
+        return None if not terms else '(%s)' % ' + '.join(terms)
+      if isinstance(node.op, ast.Div):
+        eb = self.expr(b)
+        if db is None:
+          return None if da is None else '(%s/%s)' % (da, eb)
+        num = '%s*%s' % (self.expr(a), db)
+        if da is None:
+          return '(-%s/(%s*%s))' % (num, eb, eb)
+        return '((%s*%s - %s)/(%s*%s))' % (da, eb, num, eb, eb)
+    raise JacgenError('%s: can not differentiate' % self.func.name)
+
+  # emit the value and derivatives of a call with hoisted arguments
+  def call(self, f, args):
+    if f not in FUNCS:
+      raise JacgenError('%s: unknown function %s' % (self.func.name, f))
+    nargs = 2 if f == 'pow' else 1
+    if len(args) != nargs:
+      raise JacgenError('%s: %s takes %d argument' % (self.func.name, f, nargs))
+    a = args[0]
+    ea = self.expr(a)
+    da = dict((v, self.d(a, v)) for v in self.func.wrt)
+    t = self.tmp()
+    fd = None   # c++ factor of da
+    if f == 'exp':
+      self.emit('const PetscScalar %s = std::exp(%s);' % (t, ea))
+      fd = t
+    elif f == 'log':
+      self.emit('const PetscScalar %s = std::log(%s);' % (t, ea))
+      fd = '(1.0/%s)' % ea
+    elif f == 'sqrt':
+      self.emit('const PetscScalar %s = std::sqrt(%s);' % (t, ea))
+      fd = '(0.5/%s)' % t
+    elif f == 'fabs':
+      self.emit('const PetscScalar %s = std::fabs(%s);' % (t, ea))
+      fd = '(%s < 0.0 ? -1.0 : 1.0)' % ea
+    elif f == 'bern':
+      self.emit('PetscScalar %s, %s_d;' % (t, t))
+      self.emit('bern_nb(%s, %s, %s_d);' % (ea, t, t))
+      fd = '%s_d' % t
+    elif f == 'pow':
+      b = args[1]
+      eb = self.expr(b)
+      db = dict((v, self.d(b, v)) for v in self.func.wrt)
+      if all(x is None for x in db.values()):
+        # a^b = a^(b-1)*a, the derivative b*a^(b-1) needs no extra pow
+        self.emit('const PetscScalar %s_m = std::pow(%s, %s - 1.0);' % (t, ea, eb))
+        self.emit('const PetscScalar %s = %s_m*%s;' % (t, t, ea))
+        fd = '(%s*%s_m)' % (eb, t)
+      else:
+        self.emit('const PetscScalar %s = std::pow(%s, %s);' % (t, ea, eb))
+        self.emit('const PetscScalar %s_l = std::log(%s);' % (t, ea))
+        deriv = {}
+        for v in self.func.wrt:
+          terms = []
+          if da[v] is not None: terms.append('%s*%s/%s*%s' % (eb, t, ea, da[v]))
+          if db[v] is not None: terms.append('%s*%s_l*%s' % (t, t, db[v]))
+          if terms:
+            deriv[v] = '(%s)' % ' + '.join(terms)
+        self.set_deriv(t, deriv)
+        return ast.Name(id=t, ctx=ast.Load())
+    deriv = {}
+    for v in self.func.wrt:
+      if da[v] is not None:
+        deriv[v] = '%s*%s' % (fd, da[v])
+    self.set_deriv(t, deriv)
+    return ast.Name(id=t, ctx=ast.Load())
+
+  def set_deriv(self, name, deriv):
+    self.deriv[name] = {}
+    for v in self.func.wrt:
+      if v in deriv:
+        dn = '%s__%s' % (name, v)
+        self.emit('const PetscScalar %s = %s;' % (dn, deriv[v]))
+        self.deriv[name][v] = dn
+
+  def emit(self, line):
+    self.lines.append(line)
+
+  def assign(self, name, text):
+    node = self.hoist(ast.parse(text, mode='eval').body)
+    e = self.expr(node)
+    deriv = {}
+    for v in self.func.wrt:
+      dv = self.d(node, v)
+      if dv is not None:
+        deriv[v] = dv
+    self.emit('const PetscScalar %s = %s;' % (name, e))
+    self.set_deriv(name, deriv)
+
+
+def _ref_expr(text):
+  # generic scalar version keeps the expression, ** becomes pow
+  node = ast.parse(text, mode='eval').body
+  def r(n):
+    v = _num(n)
+    if v is not None: return _lit(v)
+    if isinstance(n, ast.Name): return n.id
+    if isinstance(n, ast.UnaryOp): return '(-%s)' % r(n.operand)
+    if isinstance(n, ast.BinOp):
+      if isinstance(n.op, ast.Pow): return 'pow(%s, %s)' % (r(n.left), r(n.right))
+      ops = {ast.Add: '+', ast.Sub: '-', ast.Mult: '*', ast.Div: '/'}
+      return '(%s %s %s)' % (r(n.left), ops[type(n.op)], r(n.right))
+    if isinstance(n, ast.Call):
+      return '%s(%s)' % (n.func.id, ', '.join(r(a) for a in n.args))
+    raise JacgenError('unsupported expression %s' % text)
+  return r(node)
+
+
+def generate(funcs, source_name):
+  guard = '__%s_jac_h__' % re.sub(r'\W', '_', os.path.splitext(source_name)[0])
+  out = []
+  out.append('// generated by build/jacgen.py from %s, do not edit' % source_name)
+  out.append('')
+  out.append('#ifndef %s' % guard)
+  out.append('#define %s' % guard)
+  out.append('')
+  out.append('#include <cmath>')
+  out.append('#include "genius_common.h"')
+  out.append('#include "mathfunc.h"')
+  out.append('#include "bern_nb.h"')
+  out.append('')
+
+  for f in funcs:
+    em = Emitter(f)
+    for name, text in f.stmts:
+      em.assign(name, text)
+    em.assign('_value', f.ret)
+
+    doc = ['/**'] + [' * %s' % l for l in f.doc] + [' * value of %s and its derivatives to %s' % (f.name, ' '.join(f.wrt)), ' */']
+    out.extend(doc)
+    params = ['const PetscScalar %s' % a for a in f.args] + ['PetscScalar &d_%s' % v for v in f.wrt]
+    out.append('inline PetscScalar %s_jac(%s)' % (f.name, ', '.join(params)))
+    out.append('{')
+    for l in em.lines:
+      out.append('  ' + l)
+    for v in f.wrt:
+      out.append('  d_%s = %s;' % (v, em.deriv['_value'].get(v, '0.0')))
+    out.append('  return _value;')
+    out.append('}')
+    out.append('')
+
+    out.append('/**')
+    out.append(' * %s evaluated on scalar type T, the reference of %s_jac' % (f.name, f.name))
+    out.append(' */')
+    out.append('template <typename T>')
+    out.append('inline T %s_ref(%s)' % (f.name, ', '.join('const T &%s' % a for a in f.args)))
+    out.append('{')
+    out.append('  using std::exp; using std::log; using std::sqrt; using std::pow; using std::fabs;')
+    for name, text in f.stmts:
+      out.append('  const T %s = %s;' % (name, _ref_expr(text)))
+    out.append('  return %s;' % _ref_expr(f.ret))
+    out.append('}')
+    out.append('')
+
+    out.append('/**')
+    out.append(' * AD version of %s, chain rule on the generated derivatives' % f.name)
+    out.append(' */')
+    params = []
+    for a in f.args:
+      params.append(('const AutoDScalar &%s' if a in f.wrt else 'const PetscScalar %s') % a)
+    out.append('inline AutoDScalar %s_jac(%s)' % (f.name, ', '.join(params)))
+    out.append('{')
+    for v in f.wrt:
+      out.append('  PetscScalar d_%s;' % v)
+    call_args = [('%s.getValue()' % a if a in f.wrt else a) for a in f.args] + ['d_%s' % v for v in f.wrt]
+    out.append('  const PetscScalar value = %s_jac(%s);' % (f.name, ', '.join(call_args)))
+    out.append('  AutoDScalar r = %s;' % ' + '.join('d_%s*%s' % (v, v) for v in f.wrt))
+    out.append('  r.setValue(value);')
+    out.append('#ifdef DEBUG')
+    out.append('  // the AD evaluation of the same definition')
+    ref_args = [(a if a in f.wrt else 'AutoDScalar(%s)' % a) for a in f.args]
+    out.append('  const AutoDScalar ref = %s_ref<AutoDScalar>(%s);' % (f.name, ', '.join(ref_args)))
+    out.append('  const PetscScalar tol = 1e-8*(std::fabs(ref.getValue()) + 1e-300);')
+    out.append('  genius_assert( std::fabs(ref.getValue() - value) <= tol );')
+    out.append('  for(unsigned int i=0; i<AutoDScalar::numdir; ++i)')
+    out.append('    genius_assert( std::fabs(ref.getADValue(i) - r.getADValue(i)) <= 1e-6*(std::fabs(ref.getADValue(i)) + std::fabs(value)) + 1e-300 );')
+    out.append('#endif')
+    out.append('  return r;')
+    out.append('}')
+    out.append('')
+
+  out.append('#endif // #define %s' % guard)
+  out.append('')
+  return '\n'.join(out)
+
+
+def translate(src, tgt):
+  f = open(src)
+  text = f.read()
+  f.close()
+  code = generate(parse(text), os.path.basename(src))
+  f = open(tgt, 'w')
+  f.write(code)
+  f.close()
+
+
+# waf tool
+try:
+  from waflib import Task
+  from waflib.TaskGen import extension
+
+  class jacgen(Task.Task):
+    color = 'BLUE'
+    ext_out = ['.h']
+    def run(self):
+      try:
+        translate(self.inputs[0].abspath(), self.outputs[0].abspath())
+      except JacgenError as err:
+        self.err_msg = str(err)
+        return 1
+      return 0
+
+  @extension('.jac')
+  def process_jac(self, node):
+    out = node.parent.find_or_declare(node.name.replace('.jac', '_jac.h'))
+    self.create_task('jacgen', node, out)
+
+except ImportError:
+  pass
+
+
+def options(opt):
+  pass
+
+
+def configure(conf):
+  pass
+
+
+if __name__ == '__main__':
+  if len(sys.argv) != 3:
+    sys.stderr.write('usage: jacgen.py input.jac output.h\n')
+    sys.exit(1)
+  translate(sys.argv[1], sys.argv[2])
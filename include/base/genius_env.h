@@ -89,8 +89,38 @@ namespace Genius {
    * @return MPI_Comm self communicator
    */
   const MPI_Comm & comm_self();
+
+  /**
+   * @return MPI_Comm of all the processors in all the sweep groups.
+   * equals to MPI_COMM_WORLD when sweep farm mode is enabled
+   */
+  const MPI_Comm & comm_farm();
+
+  /**
+   * @return MPI_Comm of the processors on the same shared memory node.
+   * MPI_COMM_NULL if all the processors are on one node, or each node has only one processor
+   */
+  const MPI_Comm & comm_node();
+
+  /**
+   * @return MPI_Comm of the first processor of each shared memory node,
+   * MPI_COMM_NULL on the other processors or when comm_node() is MPI_COMM_NULL
+   */
+  const MPI_Comm & comm_node_leaders();
 #endif
 
+  /**
+   * @return the number of sweep groups. with command line option -sweep_groups n,
+   * the MPI world is split into n independent sub-communicators before PETSc init,
+   * and each group runs the input deck as a separate simulation
+   */
+  unsigned int n_sweep_groups();
+
+  /**
+   * @return the sweep group of local processor
+   */
+  unsigned int sweep_group();
+
 
   /**
    * @returns the input filename;
@@ -157,8 +187,34 @@ namespace Genius {
      */
     static MPI_Comm _comm_self;
 
+    /**
+     * MPI_Comm of all the sweep groups
+     */
+    static MPI_Comm _comm_farm;
+
+    /**
+     * MPI_Comm of shared memory node and of the node leaders
+     */
+    static MPI_Comm _comm_node;
+    static MPI_Comm _comm_node_leaders;
+
+    /**
+     * MPI is initialized by genius (for sweep farm), and should be finalized by genius
+     */
+    static bool _own_mpi;
+
 #endif
 
+    /**
+     * number of sweep groups
+     */
+    static int  _n_sweep_groups;
+
+    /**
+     * the sweep group of local processor
+     */
+    static int  _sweep_group;
+
     /**
      * the user input file.
      */
@@ -227,9 +283,36 @@ inline  const MPI_Comm & Genius::comm_self()
 {
   return (GeniusPrivateData::_comm_self);
 }
+
+inline  const MPI_Comm & Genius::comm_farm()
+{
+  return (GeniusPrivateData::_comm_farm);
+}
+
+inline  const MPI_Comm & Genius::comm_node()
+{
+  return (GeniusPrivateData::_comm_node);
+}
+
+inline  const MPI_Comm & Genius::comm_node_leaders()
+{
+  return (GeniusPrivateData::_comm_node_leaders);
+}
 #endif
 
 
+inline unsigned int Genius::n_sweep_groups()
+{
+  return static_cast<unsigned int>(GeniusPrivateData::_n_sweep_groups);
+}
+
+
+inline unsigned int Genius::sweep_group()
+{
+  return static_cast<unsigned int>(GeniusPrivateData::_sweep_group);
+}
+
+
 inline const char * Genius::input_file()
 {
   return GeniusPrivateData::_input_file.c_str();
@@ -0,0 +1,104 @@
+/********************************************************************************/
+/*     888888    888888888   88     888  88888   888      888    88888888       */
+/*   8       8   8           8 8     8     8      8        8    8               */
+/*  8            8           8  8    8     8      8        8    8               */
+/*  8            888888888   8   8   8     8      8        8     8888888        */
+/*  8      8888  8           8    8  8     8      8        8            8       */
+/*   8       8   8           8     8 8     8      8        8            8       */
+/*     888888    888888888  888     88   88888     88888888     88888888        */
+/*                                                                              */
+/*       A Three-Dimensional General Purpose Semiconductor Simulator.           */
+/*                                                                              */
+/*                                                                              */
+/*  Copyright (C) 2007-2008                                                     */
+/*  Cogenda Pte Ltd                                                             */
+/*                                                                              */
+/*  Please contact Cogenda Pte Ltd for license information                      */
+/*                                                                              */
+/*  Author: Gong Ding   gdiso@ustc.edu                                          */
+/*                                                                              */
+/********************************************************************************/
+
+#ifndef __hw_counters_h__
+#define __hw_counters_h__
+
+#include <string>
+
+#include "genius_common.h"
+
+
+/**
+ * a group of hardware performance counters of the calling thread, read by Linux perf events.
+ * the counters are read together so the values of one read are consistent.
+ * on other platforms, or when the kernel refuses the counters (see
+ * /proc/sys/kernel/perf_event_paranoid), \p open() fails and nothing is counted.
+ *
+ * FLOP counts have no generic perf event, they are vendor specific raw events and not
+ * counted here. the memory traffic is estimated as last level cache misses x cache line size.
+ */
+class HWCounters
+{
+public:
+
+  /**
+   * the counters of the group
+   */
+  enum Counter
+  {
+    Cycles=0,
+    Instructions,
+    L1DMisses,
+    LLCMisses,
+    N_COUNTERS
+  };
+
+  /**
+   * bytes per last level cache miss
+   */
+  static const unsigned int cache_line_size = 64;
+
+  HWCounters();
+
+  ~HWCounters();
+
+  /**
+   * open and start the counters
+   * @return false if the counters are not available, \p message tells why
+   */
+  bool open(std::string &message);
+
+  /**
+   * stop and close the counters
+   */
+  void close();
+
+  /**
+   * @return true when the counters are running
+   */
+  bool is_open() const
+  { return _fd[0] >= 0; }
+
+  /**
+   * read the current value of all the counters into \p values
+   */
+  void read(unsigned long long *values) const;
+
+  /**
+   * @return the name of counter \p c
+   */
+  static const char * name(unsigned int c);
+
+private:
+
+  /**
+   * file descriptors of the perf events, the first one is the group leader
+   */
+  int _fd[N_COUNTERS];
+
+  // no copy
+  HWCounters(const HWCounters &);
+  HWCounters & operator= (const HWCounters &);
+};
+
+
+#endif
@@ -6,8 +6,24 @@
 #include <string>
 #include <map>
 
+#ifndef WINDOWS
+#include <pthread.h>
+#endif
+
+/**
+ * message levels, a message is recorded when its level is not above
+ * the level of its category
+ */
+enum LogLevel { LOG_ERROR=0, LOG_WARNING=1, LOG_INFO=2, LOG_VERBOSE=3, LOG_DEBUG=4 };
+
 /**
  *  We need two streams for message output: screen and log file.
+ *
+ *  In asynchronous mode, record() of a MESSAGE_LOG message only moves it to
+ *  a pending buffer and a writer thread writes and flushes the streams, so
+ *  solver loops do not wait on a slow console or network file system.
+ *  Plain MESSAGE is still written at once, after the pending ones, so an error
+ *  message followed by genius_error() is never lost.
  */
 class GENIUS_LOG_STREAM
 {
@@ -17,6 +33,29 @@ private:
   std::map<std::string, std::ostream*> _streams;  // output streams.
   std::map<std::string, std::filebuf*> _bufs;  // file buffers opened in genius.
   std::ostringstream _sstream;
+  bool _deferred;                                 // current message may be written by the writer thread
+
+  int _level;                                     // level of the categories not in _category_level
+  int _max_level;                                 // max of all the levels, fast reject
+  std::map<std::string, int> _category_level;     // level of each category
+
+  void _write(const std::string &msg);            // write and flush all the streams
+
+#ifndef WINDOWS
+  bool _async;
+  bool _running;
+  bool _busy;
+  bool _stop;
+  std::string _pending;                           // messages not yet written
+  pthread_t       _thread;
+  pthread_mutex_t _mutex;
+  pthread_cond_t  _msg_ready;
+  pthread_cond_t  _written;
+
+  static void * _thread_main(void * ctx);
+  void _run();
+  void _stop_thread();
+#endif
 
 public:
   /**
@@ -51,10 +90,54 @@ public:
    */
   std::ostringstream& log_stream() { return _sstream; }
 
+  /**
+   * stream of MESSAGE_LOG, its message may be written asynchronously
+   */
+  std::ostringstream& deferred_log_stream() { _deferred = true; return _sstream; }
+
   /**
    * flush the buffer
    */
   void record();
+
+  /**
+   * wait until all the recorded messages are written
+   */
+  void flush();
+
+  /**
+   * write the messages by a writer thread. no effect on windows
+   */
+  void set_async(bool async);
+
+  /**
+   * set the level of all the categories without their own level
+   */
+  void set_level(int level);
+
+  /**
+   * set the level of \p category
+   */
+  void set_category_level(const std::string &category, int level);
+
+  /**
+   * parse a list of category:level separated by comma
+   */
+  void set_category_levels(const std::string &list);
+
+  /**
+   * @return true when message of \p level in \p category is recorded
+   */
+  bool enabled(int level, const char *category=0) const
+  {
+    if (level > _max_level) return false;
+    if (_category_level.empty()) return true;
+    return _enabled(level, category);
+  }
+
+private:
+
+  bool _enabled(int level, const char *category) const;
 };
 
 extern GENIUS_LOG_STREAM genius_log;
@@ -62,5 +145,11 @@ extern GENIUS_LOG_STREAM genius_log;
 #define   MESSAGE   genius_log.log_stream()
 #define   RECORD()  genius_log.record()
 
+/**
+ * message of \p level in \p category, the stream expression is not
+ * evaluated at all when the message is disabled
+ */
+#define   MESSAGE_LOG(level, category)  if( !genius_log.enabled(level, category) ) ; else genius_log.deferred_log_stream()
+
 
 #endif
@@ -31,11 +31,13 @@
 // Local includes
 #include "genius_common.h"
 #include "o_string_stream.h"
+#include "hw_counters.h"
 
 // C++ includes
 #include <string>
 #include <stack>
 #include <map>
+#include <vector>
 
 #ifdef WINDOWS
   #include <time.h>
@@ -75,7 +77,10 @@ class PerfData
     count(0),
     open(false),
     called_recursively(0)
-    {}
+    {
+      for (unsigned int c=0; c<HWCounters::N_COUNTERS; ++c)
+        counters[c] = cstart[c] = 0;
+    }
 
 
   /**
@@ -113,6 +118,18 @@ class PerfData
 
   int called_recursively;
 
+  /**
+   * Hardware counts spent in this event, and their values
+   * when the event was last started
+   */
+  unsigned long long counters[HWCounters::N_COUNTERS];
+  unsigned long long cstart[HWCounters::N_COUNTERS];
+
+  /**
+   * The hardware counters read by all the events, NULL when not counting
+   */
+  static HWCounters * hw_counters;
+
 };
 
 
@@ -233,6 +250,88 @@ class PerfLog
   double get_total_time() const
     {return total_time;}
 
+  /**
+   * @returns true if events are logged
+   */
+  bool logging() const
+    {return log_events;}
+
+  /**
+   * Start a report. The report only counts the time and calls
+   * of events after this point.
+   */
+  void begin_report();
+
+  /**
+   * Finish the report, further \p mark() calls are ignored.
+   */
+  void end_report();
+
+  /**
+   * Record the time and calls of events since the last mark
+   * (or the beginning of the report) as a section named \p tag,
+   * i.e. one Newton iteration. Does nothing if no report is active.
+   */
+  void mark(const std::string &tag);
+
+  /**
+   * @returns the report in JSON format
+   */
+  std::string get_report_json(const std::string &title) const;
+
+  /**
+   * @returns the report in CSV format, one line per event of each section
+   */
+  std::string get_report_csv(const std::string &title) const;
+
+  /**
+   * Count hardware events (cycles, instructions, cache misses) of the logged events
+   * on the main thread. @return false if the counters are not available, \p message tells why
+   */
+  bool enable_counters(std::string &message);
+
+  /**
+   * Stop counting hardware events
+   */
+  void disable_counters();
+
+  /**
+   * @returns true if hardware events are counted
+   */
+  bool counting() const
+    {return PerfData::hw_counters != NULL;}
+
+  /**
+   * @returns a string containing the hardware counts of each event
+   */
+  std::string get_counter_info() const;
+
+  /**
+   * Start the timeline trace, the begin and end of each event
+   * is recorded with its time stamp. Collective, the time stamps
+   * of all the processors count from here.
+   */
+  void begin_trace();
+
+  /**
+   * Finish the timeline trace
+   */
+  void end_trace();
+
+  /**
+   * @returns the timeline of all the processors in Chrome trace event format,
+   * readable by chrome://tracing or Perfetto, one process per processor.
+   * Collective, the string is only filled on processor 0
+   */
+  std::string get_trace_json() const;
+
+  /**
+   * @returns the max and average time of each event over the processors
+   * during the trace, and the slowest processor.
+   * Collective, the string is only filled on processor 0
+   */
+  std::string get_imbalance_summary() const;
+
 
  private:
 
@@ -287,6 +386,99 @@ class PerfLog
   void _character_line(const unsigned int n,
 		       const char c,
 		       OStringStream& out) const;
+
+  /**
+   * total time and calls of each event
+   */
+  typedef std::map<std::pair<std::string, std::string>, std::pair<double, unsigned int> > Snapshot;
+
+  /**
+   * @returns the current total time and calls of each event,
+   * the running time of the active event is accumulated first
+   */
+  Snapshot _snapshot();
+
+  /**
+   * @returns the events changed from \p before to \p now
+   */
+  static Snapshot _difference(const Snapshot &now, const Snapshot &before);
+
+  /**
+   * Flag indicating if a report is active
+   */
+  bool report_active;
+
+  /**
+   * The wall time of report begin / end
+   */
+  double report_time;
+
+  /**
+   * Events at the beginning of the report
+   */
+  Snapshot report_begin;
+
+  /**
+   * Events since the beginning of the report, valid after \p end_report()
+   */
+  Snapshot report_total;
+
+  /**
+   * Events at the last mark
+   */
+  Snapshot report_last_mark;
+
+  /**
+   * Sections of the report
+   */
+  std::vector<std::pair<std::string, Snapshot> > report_sections;
+
+  /**
+   * The hardware counters
+   */
+  HWCounters hw_counters;
+
+  /**
+   * record the begin or end of event \p key in the trace
+   */
+  void _trace(const std::pair<std::string, std::string> *key, bool begin);
+
+  /**
+   * An event of the trace, time in seconds since the trace begin
+   */
+  struct TraceEvent
+  {
+    const std::pair<std::string, std::string> *key;
+    double time;
+    bool   begin;
+  };
+
+  /**
+   * Flag indicating if a trace is active
+   */
+  bool trace_active;
+
+  /**
+   * The wall time of trace begin
+   */
+  double trace_start;
+
+  /**
+   * The number of events opened during the trace and not closed yet,
+   * events opened before the trace are not recorded when they close
+   */
+  unsigned int trace_depth;
+
+  /**
+   * The timeline
+   */
+  std::vector<TraceEvent> trace_events;
+
+  /**
+   * Events at the beginning of the trace, and since then after \p end_trace()
+   */
+  Snapshot trace_begin;
+  Snapshot trace_total;
 };
 
 
@@ -307,7 +499,9 @@ void PerfLog::push (const std::string &label,
     {
       // Get a reference to the event data to avoid
       // repeated map lookups
-      PerfData *perf_data = &(log[std::make_pair(header,label)]);
+      std::map<std::pair<std::string, std::string>, PerfData>::iterator it =
+        log.insert(std::make_pair(std::make_pair(header,label), PerfData())).first;
+      PerfData *perf_data = &(it->second);
 
       if (!log_stack.empty())
 	total_time +=
@@ -315,6 +509,9 @@ void PerfLog::push (const std::string &label,
 
       perf_data->start();
       log_stack.push(perf_data);
+
+      if (trace_active)
+        _trace(&(it->first), true);
     }
 }
 
@@ -337,6 +534,9 @@ void PerfLog::pop (const std::string &label,
 
       log_stack.pop();
 
+      if (trace_active)
+        _trace(&(log.find(std::make_pair(header,label))->first), false);
+
       if (!log_stack.empty())
 	log_stack.top()->restart();
     }
@@ -359,12 +559,14 @@ extern PerfLog  perflog;
 #  define PAUSE_LOG(a,b)   { deprecated(); }
 #  define RESTART_LOG(a,b) { deprecated{}; }
 #  define PRINT_LOG()      { perflog.print_log(); }
+#  define MARK_LOG(a)      { perflog.mark(a); }
 #else
 #  define START_LOG(a,b)   {}
 #  define STOP_LOG(a,b)    {}
 #  define PAUSE_LOG(a,b)   {}
 #  define RESTART_LOG(a,b) {}
 #  define PRINT_LOG()      {}
+#  define MARK_LOG(a)      {}
 #endif // #ifdef ENABLE_PERFORMANCE_LOGGING
 
 
@@ -0,0 +1,161 @@
+/********************************************************************************/
+/*     888888    888888888   88     888  88888   888      888    88888888       */
+/*   8       8   8           8 8     8     8      8        8    8               */
+/*  8            8           8  8    8     8      8        8    8               */
+/*  8            888888888   8   8   8     8      8        8     8888888        */
+/*  8      8888  8           8    8  8     8      8        8            8       */
+/*   8       8   8           8     8 8     8      8        8            8       */
+/*     888888    888888888  888     88   88888     88888888     88888888        */
+/*                                                                              */
+/*       A Three-Dimensional General Purpose Semiconductor Simulator.           */
+/*                                                                              */
+/*                                                                              */
+/*  Copyright (C) 2007-2008                                                     */
+/*  Cogenda Pte Ltd                                                             */
+/*                                                                              */
+/*  Please contact Cogenda Pte Ltd for license information                      */
+/*                                                                              */
+/*  Author: Gong Ding   gdiso@ustc.edu                                          */
+/*                                                                              */
+/********************************************************************************/
+
+
+#ifndef __solver_counters_h__
+#define __solver_counters_h__
+
+#include <string>
+#include <vector>
+#include <map>
+
+#include "genius_common.h"
+
+#ifdef HAVE_OPENMP
+#include <omp.h>
+#endif
+
+
+/**
+ * registry of integer counters and floating point gauges of solver internals, i.e. Newton iterations,
+ * KSP iterations, rejected time steps and assembly calls.
+ *
+ * each thread increments its own padded slot, so the counters can be updated from threaded
+ * assembly loops without lock or atomic operation. The slots are summed when the counters are read.
+ * named counters should be registered outside threaded regions.
+ *
+ * the registry is reset at the beginning of each solve command and can be written as JSON at the end.
+ * hooks can read or add counters through the global \p solver_counters object.
+ */
+class SolverCounters
+{
+public:
+
+  /**
+   * predefined counters
+   */
+  enum Counter
+  {
+    NewtonIterations=0,
+    LineSearchSteps,
+    LineSearchCutbacks,
+    LineSearchTrials,
+    KSPIterations,
+    NonlinearSolves,
+    DivergedSolves,
+    RejectedSteps,
+    AcceptedSteps,
+    FunctionAssembly,
+    JacobianAssembly,
+    N_PREDEFINED_COUNTERS
+  };
+
+  /**
+   * max number of counters, storage is fixed so that registration never moves the slots
+   */
+  static const unsigned int max_counters = 128;
+
+  /**
+   * max number of threads which own a counter slot
+   */
+  static const unsigned int max_threads = 64;
+
+  SolverCounters();
+
+  /**
+   * @return the id of named counter, create it if not exist
+   */
+  unsigned int counter(const std::string &name);
+
+  /**
+   * add \p n to counter \p id, called from any thread
+   */
+  void add(unsigned int id, long n=1)
+  { _slots[_thread_id()].value[id] += n; }
+
+  /**
+   * @return the value of counter \p id summed over threads of this processor
+   */
+  long value(unsigned int id) const;
+
+  /**
+   * @return the value of named counter, 0 if not exist
+   */
+  long value(const std::string &name) const;
+
+  /**
+   * set gauge \p name to \p v, should be called by the master thread of every processor
+   */
+  void set_gauge(const std::string &name, Real v)
+  { _gauges[name] = v; }
+
+  /**
+   * @return the value of gauge \p name, 0 if not exist
+   */
+  Real gauge(const std::string &name) const;
+
+  /**
+   * clear all the counters and gauges, the registered names are kept
+   */
+  void reset();
+
+  /**
+   * @return the counters and gauges in JSON format. counters are summed over processors and
+   * gauges are taken as maximum, so this function should be called on all the processors
+   */
+  std::string get_report_json(const std::string &title) const;
+
+private:
+
+  static unsigned int _thread_id()
+  {
+#ifdef HAVE_OPENMP
+    const unsigned int tid = static_cast<unsigned int>(omp_get_thread_num());
+    genius_assert(tid < max_threads);
+    return tid;
+#else
+    return 0;
+#endif
+  }
+
+  /**
+   * counters of one thread, aligned to cache line to avoid false sharing
+   */
+  struct Slot
+  {
+    long value[max_counters];
+    char pad[64];
+  };
+
+  std::vector<Slot> _slots;
+
+  std::vector<std::string> _names;
+
+  std::map<std::string, Real> _gauges;
+};
+
+
+/**
+ * the global counter registry
+ */
+extern SolverCounters solver_counters;
+
+#endif
@@ -0,0 +1,103 @@
+/********************************************************************************/
+/*     888888    888888888   88     888  88888   888      888    88888888       */
+/*   8       8   8           8 8     8     8      8        8    8               */
+/*  8            8           8  8    8     8      8        8    8               */
+/*  8            888888888   8   8   8     8      8        8     8888888        */
+/*  8      8888  8           8    8  8     8      8        8            8       */
+/*   8       8   8           8     8 8     8      8        8            8       */
+/*     888888    888888888  888     88   88888     88888888     88888888        */
+/*                                                                              */
+/*       A Three-Dimensional General Purpose Semiconductor Simulator.           */
+/*                                                                              */
+/*                                                                              */
+/*  Copyright (C) 2007-2008                                                     */
+/*  Cogenda Pte Ltd                                                             */
+/*                                                                              */
+/*  Please contact Cogenda Pte Ltd for license information                      */
+/*                                                                              */
+/*  Author: Gong Ding   gdiso@ustc.edu                                          */
+/*                                                                              */
+/********************************************************************************/
+
+
+#ifndef __startup_log_h__
+#define __startup_log_h__
+
+#include <string>
+#include <vector>
+
+
+/**
+ * wall time and memory of the startup phases before the first solve, i.e. mesh generation,
+ * broadcast, fvm mesh and bc setup, doping/mole evaluation and region init.
+ * the phases are always recorded, the breakdown is printed by the first SOLVE card
+ * with startup.report on.
+ */
+class StartupLog
+{
+public:
+
+  StartupLog() : _t_begin(0.0), _rss_begin(0) {}
+
+  /**
+   * begin a phase, phases are not nested
+   */
+  void begin(const std::string &phase);
+
+  /**
+   * finish the current phase
+   */
+  void end();
+
+  /**
+   * @return true if no phase recorded
+   */
+  bool empty() const
+  { return _phases.empty(); }
+
+  /**
+   * print the breakdown with the max time over processors and the resident
+   * memory summed over processors. collective
+   */
+  void print() const;
+
+  /**
+   * clear recorded phases
+   */
+  void clear()
+  { _phases.clear(); }
+
+private:
+
+  struct Phase
+  {
+    std::string name;
+
+    /**
+     * wall time in seconds
+     */
+    double      time;
+
+    /**
+     * resident memory at the end and its change during the phase, in byte
+     */
+    double      rss;
+    double      rss_delta;
+  };
+
+  std::vector<Phase> _phases;
+
+  std::string _current;
+
+  double _t_begin;
+
+  size_t _rss_begin;
+};
+
+
+/**
+ * the global startup log
+ */
+extern StartupLog startup_log;
+
+#endif
@@ -388,8 +388,161 @@ public:
    */
   SimulationSystem    & system()  { return _system; }
 
+protected:
+
+  /**
+   * @return the displacement current flow into the on processor boundary nodes of region_type,
+   * without z_width scaling. evaluated by a precomputed flux stencil, see build_displacement_stencil
+   * @param x   local solution array
+   */
+  PetscScalar displacement_current(const PetscScalar *x, SimulationRegionType region_type);
+
+  /**
+   * add scale*d(displacement current)/d(psi) to the given row of jacobian matrix
+   */
+  void displacement_current_jacobian(Mat *jac, PetscInt row, PetscScalar scale, SimulationRegionType region_type);
+
+  /**
+   * @return the surface integral of electric displacement \sum cv_surface_area*eps*(psi_nb-psi)/distance
+   * over the on processor boundary nodes of region_type, without z_width scaling.
+   * the flux is linear in psi, it shares the precomputed stencil of displacement_current
+   * @param x   local solution array
+   */
+  PetscScalar displacement_flux(const PetscScalar *x, SimulationRegionType region_type);
+
+  /**
+   * add scale*d(displacement flux)/d(psi) to the given row of jacobian matrix in one MatSetValues call
+   */
+  void displacement_flux_jacobian(Mat *jac, PetscInt row, PetscScalar scale, SimulationRegionType region_type);
+
+  /**
+   * one fvm_node of an on processor boundary node in the flat region node table
+   */
+  struct RegionNodeEntry
+  {
+    const SimulationRegion * region;
+    const FVM_Node         * fvm_node;
+    /// the first none NULL ghost node of fvm_node, the unique one on a two region interface. NULL if not exist
+    const FVM_Node         * ghost_node;
+    /// outside_boundary_surface_area of fvm_node
+    Real                     area;
+  };
+
+  /**
+   * build the flat region node table once for each mesh revision.
+   * the interface bcs stream over it instead of traversing the region node map,
+   * the ghost node list and get_region_fvm_node for each node in every function/jacobian call
+   */
+  void build_region_node_table();
+
+  /**
+   * walker over the region node table, it builds the table on construction if needed.
+   * it visits the on processor boundary nodes in turn, node[i] for i in [0, node.size())
+   * are all the fvm_nodes which have the current node as root node. these fvm_nodes have
+   * the same location in geometry, but belong to different regions in logic, they are
+   * in the order of region_node_begin/end
+   *
+   *   for(TableWalk node(*this); node.valid(); node.next())
+   *     for(unsigned int i=0; i<node.size(); ++i)
+   *       ... node[i].region, node[i].fvm_node ...
+   */
+  class TableWalk
+  {
+  public:
+    TableWalk(BoundaryCondition & bc) : _bc(bc), _k(0)
+    { _bc.build_region_node_table(); }
+
+    bool valid() const
+    { return _k < _bc._rn_node.size(); }
+
+    void next()
+    { ++_k; }
+
+    /**
+     * @return the current boundary node
+     */
+    const Node * root() const
+    { return _bc._rn_node[_k]; }
+
+    /**
+     * @return the number of fvm_nodes of the current boundary node
+     */
+    unsigned int size() const
+    { return _bc._rn_ptr[_k+1] - _bc._rn_ptr[_k]; }
+
+    const RegionNodeEntry & operator [] (unsigned int i) const
+    { return _bc._rn_entry[_bc._rn_ptr[_k]+i]; }
+
+    /**
+     * @return the entry in bc_regions().first, NULL if not exist
+     */
+    const RegionNodeEntry * first() const
+    { return _bc._rn_first[_k]==invalid_uint ? NULL : &_bc._rn_entry[_bc._rn_first[_k]]; }
+
+    /**
+     * @return the entry in bc_regions().second, NULL if not exist
+     */
+    const RegionNodeEntry * second() const
+    { return _bc._rn_second[_k]==invalid_uint ? NULL : &_bc._rn_entry[_bc._rn_second[_k]]; }
+
+  private:
+    BoundaryCondition & _bc;
+    unsigned int _k;
+  };
+
+  friend class TableWalk;
+
 private:
 
+  /**
+   * build the flux stencil of displacement current once for each mesh.
+   * for each on processor boundary fvm_node in region_type, the neighbor nodes and
+   * the factor cv_surface_area*eps/distance of each edge are stored in flat arrays
+   */
+  void build_displacement_stencil(SimulationRegionType region_type);
+
+  /**
+   * the time derivative coefficients of current time step, dEdt = (a*dV - b*dpsi + c*dpsi_last)/dt
+   */
+  static void displacement_time_coefficients(PetscScalar &a, PetscScalar &b, PetscScalar &c, PetscScalar &dt);
+
+  /**
+   * add d*coeff to the center node and -d*coeff to the neighbor node of each stencil edge in the given row
+   */
+  void displacement_stencil_jacobian(Mat *jac, PetscInt row, PetscScalar d);
+
+  /**
+   * the center and neighbor node of each edge in displacement current stencil
+   */
+  std::vector<const FVM_Node *> _disp_node;
+  std::vector<const FVM_Node *> _disp_nb_node;
+
+  /**
+   * cv_surface_area*eps/distance of each edge
+   */
+  std::vector<PetscScalar>      _disp_coeff;
+
+  /**
+   * mesh revision and region type the stencil built for
+   */
+  unsigned int                  _disp_mesh_revision;
+  SimulationRegionType          _disp_region_type;
+
+  /**
+   * the region node table, see build_region_node_table
+   */
+  std::vector<const Node *>     _rn_node;
+  std::vector<unsigned int>     _rn_ptr;
+  std::vector<RegionNodeEntry>  _rn_entry;
+  std::vector<unsigned int>     _rn_first;
+  std::vector<unsigned int>     _rn_second;
+
+  /**
+   * mesh revision the region node table built for
+   */
+  unsigned int                  _rn_mesh_revision;
+
+
   /**
    * the reference to corresponding SimulationSystem
    * since bc contains physical equations, it is important
@@ -463,6 +616,15 @@ public:
   virtual PetscScalar & z_width()
   { return _z_width;}
 
+  /**
+   * @return the quasi-static charge of electrode, -z_width*(surface integral of electric displacement)
+   * over the on processor semiconductor and insulator nodes of this boundary.
+   * its time derivative is the displacement current
+   * @param x   local solution array
+   */
+  PetscScalar electrode_charge(const PetscScalar *x)
+  { return -z_width()*(displacement_flux(x, SemiconductorRegion) + displacement_flux(x, InsulatorRegion)); }
+
 
   /**
    * @return the psi of this boundary.
@@ -190,6 +190,12 @@ public:
    */
   int bc_setup();
 
+  /**
+   * @return the boundary ids of periodic boundaries and their partners given by the BOUNDARY cards,
+   * it can be called before bc_setup() to keep the periodic node pairs on one processor
+   */
+  std::vector<short int> periodic_boundary_ids();
+
   /**
    * set up the boundary nodes for PMI
    */
@@ -280,6 +286,8 @@ private:
 
   int Set_BC_NeumannBoundary(const Parser::Card &c);
 
+  int Set_BC_PeriodicBoundary(const Parser::Card &c);
+
   int Set_BC_OhmicContact(const Parser::Card &c);
 
   int Set_BC_IF_Metal_Ohmic(const Parser::Card &c);
@@ -132,7 +132,38 @@ private:
     Point p;
   };
 
-  std::multimap<const Node *, NearestPoint>  _node_nearest_point_map;
+  /**
+   * tunneling path from a semiconductor node to its nearest point in gate region,
+   * built once in _find_nearest_points_in_gate_region
+   */
+  struct GatePath
+  {
+    /// fvm_node at semiconductor side
+    const FVM_Node * semiconductor_node;
+    /// fvm_node at insulator side
+    const FVM_Node * insulator_node;
+    /// the bc the nearest point on
+    BoundaryCondition * bc;
+    /// range of gate face nodes in _gate_path_face_nodes/_gate_path_face_weights
+    unsigned int face_begin, face_end;
+    /// tunneling distance
+    Real t;
+  };
+
+  /**
+   * all the tunneling paths of on processor nodes
+   */
+  std::vector<GatePath>  _gate_paths;
+
+  /**
+   * fvm nodes of the gate face each path ends on, stored flat
+   */
+  std::vector<const FVM_Node *>  _gate_path_face_nodes;
+
+  /**
+   * interpolation weight of the gate face nodes at the nearest point
+   */
+  std::vector<Real>  _gate_path_face_weights;
 
   /**
    * record the target fvm node in gate region
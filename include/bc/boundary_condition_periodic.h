@@ -0,0 +1,299 @@
+/********************************************************************************/
+/*     888888    888888888   88     888  88888   888      888    88888888       */
+/*   8       8   8           8 8     8     8      8        8    8               */
+/*  8            8           8  8    8     8      8        8    8               */
+/*  8            888888888   8   8   8     8      8        8     8888888        */
+/*  8      8888  8           8    8  8     8      8        8            8       */
+/*   8       8   8           8     8 8     8      8        8            8       */
+/*     888888    888888888  888     88   88888     88888888     88888888        */
+/*                                                                              */
+/*       A Three-Dimensional General Purpose Semiconductor Simulator.           */
+/*                                                                              */
+/*                                                                              */
+/*  Copyright (C) 2007-2008                                                     */
+/*  Cogenda Pte Ltd                                                             */
+/*                                                                              */
+/*  Please contact Cogenda Pte Ltd for license information                      */
+/*                                                                              */
+/*  Author: Gong Ding   gdiso@ustc.edu                                          */
+/*                                                                              */
+/********************************************************************************/
+
+#ifndef __boundary_condition_periodic_h__
+#define __boundary_condition_periodic_h__
+
+
+#include "boundary_condition.h"
+
+/**
+ * The Periodic Boundary Condition.
+ * each node on this boundary is identified with the node at the same position
+ * on the partner boundary, shifted by the distance between the two boundaries.
+ * the equation of the slave node is added to its master, and the slave row is replaced
+ * by x_slave - x_master. mirror symmetry is the zero flux Neumann boundary.
+ * the partitioner keeps the nodes of both boundaries on one processor, a node without
+ * partner is an error.
+ */
+class PeriodicBC : public BoundaryCondition
+{
+public:
+
+  /**
+   * constructor, set default value
+   */
+  PeriodicBC(SimulationSystem  & system, const std::string & label="");
+
+  /**
+   * destructor
+   */
+  virtual ~PeriodicBC(){}
+
+
+  /**
+   * @return boundary condition type
+   */
+  virtual BCType bc_type() const
+    { return PeriodicBoundary; }
+
+  /**
+   * @return boundary condition type in string
+   */
+  virtual std::string bc_type_name() const
+  { return "PeriodicBoundary"; }
+
+  /**
+   * @return boundary type
+   */
+  virtual BoundaryType boundary_type() const
+    { return BOUNDARY; }
+
+  /**
+   * indicate that this bc is an electrode
+   * @return false
+   */
+  virtual bool is_electrode() const
+    {return false;}
+
+  /**
+   * @return true iff this boundary has a current flow
+   */
+  virtual bool has_current_flow() const
+  { return false; }
+
+  /**
+   * @return the string which indicates the boundary condition
+   */
+  virtual std::string boundary_condition_in_string() const;
+
+  /**
+   * @return the label of partner boundary
+   */
+  const std::string & partner_label() const
+  { return _partner_label; }
+
+  /**
+   * @return writable reference to the label of partner boundary
+   */
+  std::string & partner_label()
+  { return _partner_label; }
+
+  /**
+   * the on processor node pair, the slave node on this boundary and its master node on the partner boundary.
+   * both fvm nodes belong to regions of the same type
+   */
+  struct PeriodicPair
+  {
+    const SimulationRegion * region;
+    const FVM_Node * slave;
+    const FVM_Node * master;
+  };
+
+  /**
+   * @return node pairs of this boundary, build the pairs when mesh changed.
+   * when the master is a slave of another periodic boundary (i.e. corner of a 2D periodic cell),
+   * the final master is used.
+   */
+  const std::vector<PeriodicPair> & periodic_pairs();
+
+  /**
+   * @return node pairs of this boundary as matched to the partner boundary
+   */
+  const std::vector<PeriodicPair> & raw_periodic_pairs();
+
+  /**
+   * the dofs of each pair for a solver
+   */
+  typedef unsigned int (*PeriodicDofs)(const SimulationRegion *);
+
+public:
+
+  //////////////////////////////////////////////////////////////////////////////////////////////
+  //----------------Function and Jacobian evaluate for Poisson's Equation---------------------//
+  //////////////////////////////////////////////////////////////////////////////////////////////
+
+  /**
+   * preprocess function for poisson solver
+   */
+  virtual void Poissin_Function_Preprocess(PetscScalar *, Vec, std::vector<PetscInt> &, std::vector<PetscInt> &, std::vector<PetscInt> &);
+
+  /**
+   * build function and its jacobian for poisson solver
+   */
+  virtual void Poissin_Function(PetscScalar * , Vec , InsertMode &);
+
+  /**
+   * reserve non zero pattern in jacobian matrix for poisson solver
+   */
+  virtual void Poissin_Jacobian_Reserve(Mat *, InsertMode &);
+
+  /**
+   * preprocess jacobian matrix for poisson solver
+   */
+  virtual void Poissin_Jacobian_Preprocess(PetscScalar *, Mat *, std::vector<PetscInt> &, std::vector<PetscInt> &, std::vector<PetscInt> &);
+
+  /**
+   * build function and its jacobian for poisson solver
+   */
+  virtual void Poissin_Jacobian(PetscScalar * , Mat *, InsertMode &);
+
+
+  //////////////////////////////////////////////////////////////////////////////////
+  //----------------Function and Jacobian evaluate for L1 DDM---------------------//
+  //////////////////////////////////////////////////////////////////////////////////
+
+  /**
+   * preprocess function for level 1 DDM solver
+   */
+  virtual void DDM1_Function_Preprocess(PetscScalar *, Vec, std::vector<PetscInt> &, std::vector<PetscInt> &, std::vector<PetscInt> &);
+
+  /**
+   * build function and its jacobian for level 1 DDM solver
+   */
+  virtual void DDM1_Function(PetscScalar * , Vec , InsertMode &);
+
+  /**
+   * reserve non zero pattern in jacobian matrix for level 1 DDM solver
+   */
+  virtual void DDM1_Jacobian_Reserve(Mat *, InsertMode &);
+
+  /**
+   * preprocess jacobian matrix for level 1 DDM solver
+   */
+  virtual void DDM1_Jacobian_Preprocess(PetscScalar *, Mat *, std::vector<PetscInt> &, std::vector<PetscInt> &, std::vector<PetscInt> &);
+
+  /**
+   * build function and its jacobian for level 1 DDM solver
+   */
+  virtual void DDM1_Jacobian(PetscScalar * , Mat *, InsertMode &);
+
+
+  //////////////////////////////////////////////////////////////////////////////////
+  //----------------Function and Jacobian evaluate for L2 DDM---------------------//
+  //////////////////////////////////////////////////////////////////////////////////
+
+  /**
+   * preprocess function for level 2 DDM solver
+   */
+  virtual void DDM2_Function_Preprocess(PetscScalar *, Vec, std::vector<PetscInt> &, std::vector<PetscInt> &, std::vector<PetscInt> &);
+
+  /**
+   * build function and its jacobian for level 2 DDM solver
+   */
+  virtual void DDM2_Function(PetscScalar * , Vec , InsertMode &);
+
+  /**
+   * reserve non zero pattern in jacobian matrix for level 2 DDM solver
+   */
+  virtual void DDM2_Jacobian_Reserve(Mat *, InsertMode &);
+
+  /**
+   * preprocess jacobian matrix for level 2 DDM solver
+   */
+  virtual void DDM2_Jacobian_Preprocess(PetscScalar *, Mat *, std::vector<PetscInt> &, std::vector<PetscInt> &, std::vector<PetscInt> &);
+
+  /**
+   * build function and its jacobian for level 2 DDM solver
+   */
+  virtual void DDM2_Jacobian(PetscScalar * , Mat *, InsertMode &);
+
+
+  //////////////////////////////////////////////////////////////////////////////////
+  //----------------Function and Jacobian evaluate for L3 EBM---------------------//
+  //////////////////////////////////////////////////////////////////////////////////
+
+  /**
+   * preprocess function for level 3 EBM solver
+   */
+  virtual void EBM3_Function_Preprocess(PetscScalar *, Vec, std::vector<PetscInt> &, std::vector<PetscInt> &, std::vector<PetscInt> &);
+
+  /**
+   * build function and its jacobian for level 3 EBM solver
+   */
+  virtual void EBM3_Function(PetscScalar * , Vec , InsertMode &);
+
+  /**
+   * reserve non zero pattern in jacobian matrix for level 3 EBM solver
+   */
+  virtual void EBM3_Jacobian_Reserve(Mat *, InsertMode &);
+
+  /**
+   * preprocess jacobian matrix for level 3 EBM solver
+   */
+  virtual void EBM3_Jacobian_Preprocess(PetscScalar *, Mat *, std::vector<PetscInt> &, std::vector<PetscInt> &, std::vector<PetscInt> &);
+
+  /**
+   * build function and its jacobian for level 3 EBM solver
+   */
+  virtual void EBM3_Jacobian(PetscScalar * , Mat *, InsertMode &);
+
+private:
+
+  /**
+   * label of the partner boundary
+   */
+  std::string _partner_label;
+
+  /**
+   * on processor node pairs with final master
+   */
+  std::vector<PeriodicPair> _pairs;
+
+  /**
+   * on processor node pairs with master on partner boundary
+   */
+  std::vector<PeriodicPair> _raw_pairs;
+
+  /**
+   * mesh revision the pairs built with
+   */
+  unsigned int _pair_mesh_revision;
+
+  /**
+   * mesh revision the raw pairs built with
+   */
+  unsigned int _raw_mesh_revision;
+
+  /**
+   * add slave rows to master rows and clear slave rows
+   */
+  void _periodic_preprocess(PeriodicDofs dofs, std::vector<PetscInt> &src_row, std::vector<PetscInt> &dst_row, std::vector<PetscInt> &clear_row);
+
+  /**
+   * x_slave - x_master to slave rows
+   */
+  void _periodic_function(PeriodicDofs dofs, PetscScalar *x, Vec f, InsertMode &add_value_flag);
+
+  /**
+   * reserve the slave pattern in master rows and master columns in slave rows
+   */
+  void _periodic_jacobian_reserve(PeriodicDofs dofs, Mat *jac, InsertMode &add_value_flag);
+
+  /**
+   * jacobian of x_slave - x_master
+   */
+  void _periodic_jacobian(PeriodicDofs dofs, Mat *jac, InsertMode &add_value_flag);
+};
+
+
+
+#endif
@@ -72,6 +72,12 @@ enum BCType
    */
   IF_PML_PML                  = 0x0007,
 
+  /**
+   * Periodic Boundary, the nodes are identified with the nodes of partner boundary.
+   * it has higher priority than Neumann Boundary
+   */
+  PeriodicBoundary            = 0x0008,
+
   /**
    * The interface of Electrode region to Insulator region.
    * we assume potential and temperature continuous on this boundary
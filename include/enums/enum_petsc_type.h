@@ -40,6 +40,7 @@ namespace SolverSpecify
     Newton=0,
     LineSearch,
     TrustRegion,
+    Broyden,
     INVALID_NONLINEAR_SOLVER};
 
 
@@ -75,6 +76,7 @@ namespace SolverSpecify
                          MUMPS,
                          SuperLU_DIST,
                          GSS,
+                         KLU,
                          INVALID_LINEAR_SOLVER};
 
  /**
@@ -108,6 +110,9 @@ namespace SolverSpecify
                            PARMS_PRECOND,
                            USER_PRECOND,
                            SHELL_PRECOND,
+                           FIELDSPLIT_PRECOND,
+                           GAMG_PRECOND,
+                           REGION_ASM_PRECOND,
                            INVALID_PRECONDITIONER};
 
 
@@ -88,6 +88,8 @@ namespace SolverSpecify
     TRANSIENT,
     ACSWEEP,
     TRACE,
+    BSWEEP,
+    HARMONIC,
     INVALID_SolutionType
   };
 
@@ -126,6 +128,16 @@ namespace SolverSpecify
   };
 
 
+  /**
+   * define step size controller of auto time step
+   */
+  enum StepController
+  {
+    STEP_HEURISTIC=0, // heuristic factor table by current truncate error
+    STEP_PI           // PI controller by current and previous truncate error
+  };
+
+
 
   /**
    * define carriers should be considered
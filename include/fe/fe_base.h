@@ -24,6 +24,8 @@
 
 // C++ includes
 #include <vector>
+#include <map>
+#include <utility>
 
 // Local includes
 //#include "reference_counted_object.h"
@@ -1114,6 +1116,44 @@ protected:
    */
   bool shapes_on_quadrature;
 
+  /**
+   * Shape and mapping function tables on the reference element,
+   * evaluated at the quadrature points of one element type and p level.
+   * Each table is stored flat, the value of function i at point p is at [i*n_qp + p].
+   */
+  struct ReferenceShapes
+  {
+    unsigned int n_qp;
+    unsigned int n_shape;
+    unsigned int n_map;
+    std::vector<Real> phi;
+    std::vector<Real> dphidxi;
+    std::vector<Real> dphideta;
+    std::vector<Real> dphidzeta;
+    std::vector<Real> phi_map;
+    std::vector<Real> dphidxi_map;
+    std::vector<Real> dphideta_map;
+    std::vector<Real> dphidzeta_map;
+  };
+
+  /**
+   * The reference tables of the element types met so far with the
+   * attached quadrature rule, keyed by element type and p level.
+   * Cleared when another quadrature rule is attached.
+   */
+  std::map<std::pair<ElemType, unsigned int>, ReferenceShapes> reference_shapes;
+
+  /**
+   * Save the tables computed by \p init_shape_functions for element type \p t and p level \p p
+   */
+  void store_reference_shapes(const ElemType t, const unsigned int p);
+
+  /**
+   * Restore the tables of element type \p t and p level \p p.
+   * @returns false if they have not been stored yet.
+   */
+  bool load_reference_shapes(const ElemType t, const unsigned int p);
+
 
 private:
 
@@ -38,6 +38,7 @@
 #include "enum_io_package.h"
 #include "enum_order.h"
 #include "auto_ptr.h"
+#include "object_pool.h"
 #include "multi_predicates.h"
 #include "variant_filter_iterator.h"
 
@@ -104,6 +105,19 @@ class Elem :    public DofObject
    */
   virtual ~Elem();
 
+  /**
+   * elements are allocated from the ObjectPool, so the elements built
+   * one after another are contiguous in memory
+   */
+  static void * operator new (std::size_t size)
+  { return ObjectPool::allocate(size); }
+
+  /**
+   * the virtual destructor passes the size of the derived element
+   */
+  static void operator delete (void * p, std::size_t size)
+  { ObjectPool::deallocate(p, size); }
+
   /**
    * @returns the \p Point associated with local \p Node \p i.
    */
@@ -1253,6 +1267,7 @@ public:
 
   /**
    * Pointers to this element's neighbors.
+   * it shares one pool block with \p _nodes, just after the node pointers.
    */
   Elem** _neighbors;
 
@@ -1294,6 +1309,12 @@ public:
 
 #endif
 
+  /**
+   * The number of node and neighbor pointers in the pool block of \p _nodes.
+   * n_nodes() can not be called in the destructor.
+   */
+  unsigned char _n_links;
+
   /**
    * The subdomain to which this element belongs.
    */
@@ -1337,26 +1358,29 @@ Elem::Elem(const unsigned int nn,
   this->subdomain_id() = 0;
   this->processor_id() = 0;
 
-  // Initialize the nodes data structure
+  // Initialize the nodes and neighbors data structure,
+  // both in one pool block
   _nodes = NULL;
-
-  if (nn != 0)
-    {
-      _nodes = new Node*[nn];
-
-      for (unsigned int n=0; n<nn; n++)
-        _nodes[n] = NULL;
-    }
-
-  // Initialize the neighbors data structure
   _neighbors = NULL;
+  _n_links = static_cast<unsigned char>(nn+ns);
 
-  if (ns != 0)
+  if (nn+ns != 0)
     {
-      _neighbors = new Elem*[ns];
+      void ** links = static_cast<void **>(ObjectPool::allocate(_n_links*sizeof(void *)));
+
+      if (nn != 0)
+        {
+          _nodes = reinterpret_cast<Node**>(links);
+          for (unsigned int n=0; n<nn; n++)
+            _nodes[n] = NULL;
+        }
 
-      for (unsigned int n=0; n<ns; n++)
-        _neighbors[n] = NULL;
+      if (ns != 0)
+        {
+          _neighbors = reinterpret_cast<Elem**>(links + nn);
+          for (unsigned int n=0; n<ns; n++)
+            _neighbors[n] = NULL;
+        }
     }
 
   // Optionally initialize data from the parent
@@ -1387,14 +1411,11 @@ Elem::Elem(const unsigned int nn,
 inline
 Elem::~Elem()
 {
-  // Delete my node storage
-  if (_nodes != NULL)
-    delete [] _nodes;
+  // Delete my node and neighbor storage
+  if (_n_links != 0)
+    ObjectPool::deallocate(_nodes != NULL ? static_cast<void *>(_nodes) : static_cast<void *>(_neighbors),
+                           _n_links*sizeof(void *));
   _nodes = NULL;
-
-  // Delete my neighbor storage
-  if (_neighbors != NULL)
-    delete [] _neighbors;
   _neighbors = NULL;
 
 #ifdef ENABLE_AMR
@@ -28,6 +28,7 @@
 #include "point.h"
 #include "dof_object.h"
 #include "auto_ptr.h"
+#include "object_pool.h"
 
 
 // forward declarations
@@ -77,6 +78,15 @@ public:
    */
   virtual ~Node ();
 
+  /**
+   * nodes are allocated from the ObjectPool, contiguous in build order
+   */
+  static void * operator new (std::size_t size)
+  { return ObjectPool::allocate(size); }
+
+  static void operator delete (void * p, std::size_t size)
+  { ObjectPool::deallocate(p, size); }
+
   /**
    * Assign to a node from a point
    */
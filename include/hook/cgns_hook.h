@@ -28,6 +28,7 @@
 #include <ctime>
 #include <vector>
 #include <string>
+#include <map>
 
 /**
  * write cgns file
@@ -96,6 +97,37 @@ private:
    */
   std::vector< std::pair<double, std::string> > time_sequence;
 
+  /**
+   * transient series mode: write mesh once to one file and append solutions of following steps
+   */
+  bool            _series;
+
+  /**
+   * write appended solutions as float32
+   */
+  bool            _single_precision;
+
+  /**
+   * the file name of transient series
+   */
+  std::string     _series_file;
+
+  /**
+   * time and FlowSolution name of each appended step
+   */
+  std::vector<double>       _series_time;
+  std::vector<std::string>  _series_sol_name;
+
+  /**
+   * digest of the last written arrays, unchanged array is not written again
+   */
+  std::map<std::string, unsigned long> _series_digest;
+
+  /**
+   * append current solution to the series file
+   */
+  void _append_series_step();
+
   /**
    * if we are in ddm mode
    */
@@ -29,16 +29,24 @@
 #include "hook.h"
 #include <time.h>
 
+// predefine
+class DDMACSolver;
+
 /**
- * write electrode IV into spice raw file (Ascii format).
- * then user can view the IV curve by some other program.
- * ( can we do real time display here? )
+ * write gate capacitance of DC sweep into file.
+ * by default, the capacitance is the small signal one computed by a single
+ * frequency AC solve at each DC bias point. with parameter ac=false, it is
+ * derived from the gate charge difference of neighbor bias points.
+ * hook parameters:
+ *   file = output file name
+ *   ac   = use AC small signal capacitance, default true
+ *   freq = frequency of AC solve in Hz, default 1e3
  */
 class CVHook : public Hook
 {
 
 public:
-  CVHook(SolverBase & solver, const std::string & name, void * file);
+  CVHook(SolverBase & solver, const std::string & name, void * param);
 
   virtual ~CVHook();
 
@@ -74,11 +82,6 @@ private:
   */
  time_t          _time;
 
- /**
-  * the input file name
-  */
- std::string     _input_file;
-
  /**
   * the raw file name
   */
@@ -101,6 +104,31 @@ private:
  std::vector<double> _vsweep;
  std::vector< std::vector<double> > _gate_charge;
 
+ /**
+  * use AC small signal solver
+  */
+ bool            _ac;
+
+ /**
+  * AC frequency, in Hz
+  */
+ double          _ac_freq;
+
+ /**
+  * the AC solver shares the system with DC solver, created at the first bias point
+  */
+ DDMACSolver *   _ac_solver;
+
+ /**
+  * gate capacitance of each bias point by AC solver
+  */
+ std::vector< std::vector<double> > _gate_cap;
+
+ /**
+  * do a single frequency AC solve at current DC solution and record gate capacitance
+  */
+ void _ac_capacitance();
+
  /**
   * the total number of values
   */
@@ -29,6 +29,7 @@
 #ifdef DLLHOOK
 
 #include "hook.h"
+#include "genius_hook_api.h"
 
 class DllHook : public Hook
 {
@@ -48,25 +49,45 @@ private:
 
   Hook             * hook;
 
+  /**
+   * callbacks of plain C hook, used when the dll exports genius_get_c_hook instead of get_hook
+   */
+  const GeniusHookCallbacks * c_hook;
+
+  /**
+   * @return opaque context passed to C hook
+   */
+  const GeniusHookContext * c_context() const
+  { return reinterpret_cast<const GeniusHookContext *>(&_solver); }
+
 
 public:
   /**
    *   This is executed before the initialization of the solver
    */
   virtual void on_init()
-  { if(hook) hook->on_init();        }
+  {
+    if(hook) hook->on_init();
+    if(c_hook && c_hook->on_init) c_hook->on_init(c_context(), c_hook->user_data);
+  }
 
   /**
    *   This is executed previously to each solution step.
    */
   virtual void pre_solve()
-  { if(hook) hook->pre_solve();      }
+  {
+    if(hook) hook->pre_solve();
+    if(c_hook && c_hook->pre_solve) c_hook->pre_solve(c_context(), c_hook->user_data);
+  }
 
   /**
    *  This is executed after each solution step.
    */
   virtual void post_solve()
-  { if(hook) hook->post_solve();     }
+  {
+    if(hook) hook->post_solve();
+    if(c_hook && c_hook->post_solve) c_hook->post_solve(c_context(), c_hook->user_data);
+  }
 
 
   /**
@@ -74,14 +95,20 @@ public:
    *  i.e. for analysis the condition number of jacobian matrix
    */
   virtual void pre_iteration()
-  { if(hook) hook->pre_iteration(); }
+  {
+    if(hook) hook->pre_iteration();
+    if(c_hook && c_hook->pre_iteration) c_hook->pre_iteration(c_context(), c_hook->user_data);
+  }
 
   /**
    *  This is executed after each (nonlinear) iteration
    *  i.e. for collecting convergence information or implementing various damping strategy
    */
   virtual void post_iteration()
-  { if(hook) hook->post_iteration(); }
+  {
+    if(hook) hook->post_iteration();
+    if(c_hook && c_hook->post_iteration) c_hook->post_iteration(c_context(), c_hook->user_data);
+  }
 
   /**
    *  This is executed after each (nonlinear) iteration
@@ -94,7 +121,16 @@ public:
    * This is executed after the finalization of the solver
    */
   virtual void on_close()
-  { if(hook) hook->on_close();       }
+  {
+    if(hook) hook->on_close();
+    if(c_hook && c_hook->on_close) c_hook->on_close(c_context(), c_hook->user_data);
+  }
+
+  /**
+   * This is executed when a hook raises an event
+   */
+  virtual void on_trigger(const std::string & source)
+  { if(hook) hook->on_trigger(source); }
 
 };
 
@@ -26,13 +26,19 @@
 #include <string>
 
 #include "config.h"
+#include "petscvec.h"
 #include "hook.h"
 
 
 
 /**
- * calculate eigen value for jacobian matrix on each nonlinear iteration
- * for check the condition number of device
+ * calculate eigen value for jacobian matrix after each solution step
+ * (or each nonlinear iteration with iteration=true) for check the condition number of device.
+ * parameters:
+ *   n         number of extreme eigen values, default 5
+ *   reuse.pc  shift-and-invert with the factorization of nonlinear solver, default true
+ *   iteration run on each nonlinear iteration instead of each solution step, default false
+ * together with HOOK every=N the diagnostic runs every N steps.
  */
 class EigenValueHook : public Hook
 {
@@ -96,6 +102,33 @@ private:
    */
   unsigned int solution_count;
 
+  /**
+   * number of extreme eigen values
+   */
+  int          _n_eigen;
+
+  /**
+   * use the factorization of nonlinear solver
+   */
+  bool         _reuse_pc;
+
+  /**
+   * run on each nonlinear iteration
+   */
+  bool         _on_iteration;
+
+  /**
+   * smallest and largest eigen vector of last run, restart the subspace of next run
+   */
+  Vec          _vs, _vl;
+
+  bool         _vec_created;
+
+  /**
+   * calculate the eigen values
+   */
+  void _eigen_value();
+
 private:
 
 
@@ -0,0 +1,148 @@
+/********************************************************************************/
+/*     888888    888888888   88     888  88888   888      888    88888888       */
+/*   8       8   8           8 8     8     8      8        8    8               */
+/*  8            8           8  8    8     8      8        8    8               */
+/*  8            888888888   8   8   8     8      8        8     8888888        */
+/*  8      8888  8           8    8  8     8      8        8            8       */
+/*   8       8   8           8     8 8     8      8        8            8       */
+/*     888888    888888888  888     88   88888     88888888     88888888        */
+/*                                                                              */
+/*       A Three-Dimensional General Purpose Semiconductor Simulator.           */
+/*                                                                              */
+/*                                                                              */
+/*  Copyright (C) 2007-2008                                                     */
+/*  Cogenda Pte Ltd                                                             */
+/*                                                                              */
+/*  Please contact Cogenda Pte Ltd for license information                      */
+/*                                                                              */
+/*  Author: Gong Ding   gdiso@ustc.edu                                          */
+/*                                                                              */
+/********************************************************************************/
+
+
+#ifndef __genius_hook_api_h__
+#define __genius_hook_api_h__
+
+/**
+ * A plain C interface for user hooks loaded from shared library.
+ *
+ * A C hook exports
+ *   const GeniusHookCallbacks * genius_get_c_hook(const char * name, void * fun_data);
+ * instead of the C++ get_hook. Each callback receives an opaque context, the
+ * genius_hook_* functions below give read only views of the solver data.
+ * Returned arrays point into the internal storage of genius and are valid
+ * until the next callback, they must not be freed or written by the hook.
+ * All the values are in genius internal unit, use the unit factor returned
+ * together with the array to convert them.
+ */
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+  /**
+   * opaque handle of the solver
+   */
+  typedef struct GeniusHookContext GeniusHookContext;
+
+  /**
+   * callbacks of C hook, any of them can be NULL
+   */
+  typedef struct
+  {
+    void * user_data;
+    void (*on_init)        (const GeniusHookContext *, void * user_data);
+    void (*pre_solve)      (const GeniusHookContext *, void * user_data);
+    void (*post_solve)     (const GeniusHookContext *, void * user_data);
+    void (*pre_iteration)  (const GeniusHookContext *, void * user_data);
+    void (*post_iteration) (const GeniusHookContext *, void * user_data);
+    void (*on_close)       (const GeniusHookContext *, void * user_data);
+  } GeniusHookCallbacks;
+
+  typedef const GeniusHookCallbacks * GENIUS_GET_C_HOOK(const char * name, void * fun_data);
+
+  /**
+   * @return processor id and number of processors
+   */
+  int genius_hook_processor_id(const GeniusHookContext *);
+  int genius_hook_n_processors(const GeniusHookContext *);
+
+  /**
+   * @return number of regions
+   */
+  unsigned int genius_hook_n_regions(const GeniusHookContext *);
+
+  /**
+   * @return label of region r
+   */
+  const char * genius_hook_region_label(const GeniusHookContext *, unsigned int r);
+
+  /**
+   * @return number of on local (on processor + ghost) nodes of region r,
+   * which is the length of the node arrays of this region
+   */
+  unsigned int genius_hook_region_n_nodes(const GeniusHookContext *, unsigned int r);
+
+  /**
+   * @return coordinates of the nodes of region r as xyz triples, length 3*n_nodes.
+   * the array is built once for each mesh and shared by all the hooks
+   */
+  const double * genius_hook_region_node_coordinates(const GeniusHookContext *, unsigned int r);
+
+  /**
+   * @return 1 if the node at index i of region r belongs to this processor, 0 for ghost node
+   */
+  int genius_hook_region_node_on_processor(const GeniusHookContext *, unsigned int r, unsigned int i);
+
+  /**
+   * @return the data of node variable v (i.e. "potential", "electron") of region r,
+   * length n_nodes, or NULL if the variable is not defined. unit is set to the unit factor of this variable.
+   * a variable stored in float is returned as a double copy, which is refreshed by the next call for the same variable
+   */
+  const double * genius_hook_region_node_variable(const GeniusHookContext *, unsigned int r, const char * v, double * unit);
+
+  /**
+   * compute the 2-norm and infinity-norm of the residual vector of the nonlinear solver.
+   * collective, all the processors should call it
+   * @return 0 on success, -1 if the solver is not a nonlinear solver
+   */
+  int genius_hook_residual_norm(const GeniusHookContext *, double * norm2, double * norm_inf);
+
+  /**
+   * @return number of electrodes
+   */
+  unsigned int genius_hook_n_electrodes(const GeniusHookContext *);
+
+  /**
+   * get the label, potential [V] and current [A] of electrode e
+   * @return 0 on success
+   */
+  int genius_hook_electrode_iv(const GeniusHookContext *, unsigned int e, const char ** label, double * V, double * I);
+
+  /**
+   * @return simulation time [s] of transient solver
+   */
+  double genius_hook_clock(const GeniusHookContext *);
+
+  /**
+   * @return value of solver counter \p name (i.e. "newton.iterations") on this processor, 0 if not exist
+   */
+  long genius_hook_counter(const GeniusHookContext *, const char * name);
+
+  /**
+   * add \p n to solver counter \p name, the counter is created if not exist.
+   * it is reported together with the builtin counters at the end of solve command
+   */
+  void genius_hook_add_counter(const GeniusHookContext *, const char * name, long n);
+
+  /**
+   * set solver gauge \p name to \p v, should be called on all the processors
+   */
+  void genius_hook_set_gauge(const GeniusHookContext *, const char * name, double v);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __genius_hook_api_h__
@@ -0,0 +1,118 @@
+/********************************************************************************/
+/*     888888    888888888   88     888  88888   888      888    88888888       */
+/*   8       8   8           8 8     8     8      8        8    8               */
+/*  8            8           8  8    8     8      8        8    8               */
+/*  8            888888888   8   8   8     8      8        8     8888888        */
+/*  8      8888  8           8    8  8     8      8        8            8       */
+/*   8       8   8           8     8 8     8      8        8            8       */
+/*     888888    888888888  888     88   88888     88888888     88888888        */
+/*                                                                              */
+/*       A Three-Dimensional General Purpose Semiconductor Simulator.           */
+/*                                                                              */
+/*                                                                              */
+/*  Copyright (C) 2007-2008                                                     */
+/*  Cogenda Pte Ltd                                                             */
+/*                                                                              */
+/*  Please contact Cogenda Pte Ltd for license information                      */
+/*                                                                              */
+/*  Author: Gong Ding   gdiso@ustc.edu                                          */
+/*                                                                              */
+/********************************************************************************/
+
+
+#ifndef __hdf5_hook_h__
+#define __hdf5_hook_h__
+
+
+#include "hook.h"
+#include <string>
+
+/**
+ * write the solutions as time steps of one HDF5 file with XDMF descriptor
+ */
+class HDF5Hook : public Hook
+{
+
+public:
+  HDF5Hook(SolverBase & solver, const std::string & name, void *);
+
+  virtual ~HDF5Hook();
+
+  /**
+   *   This is executed before the initialization of the solver
+   */
+  virtual void on_init();
+
+  /**
+   *   This is executed previously to each solution step.
+   */
+  virtual void pre_solve();
+
+  /**
+   *  This is executed after each solution step.
+   */
+  virtual void post_solve();
+
+  /**
+   *  This is executed after each (nonlinear) iteration
+   */
+  virtual void post_iteration();
+
+  /**
+   * This is executed after the finalization of the solver
+   */
+  virtual void on_close();
+
+private:
+
+  /**
+   * the output file name
+   */
+  std::string     _hdf5_file;
+
+  /**
+   * steps written
+   */
+  unsigned int count;
+
+  /**
+   * last value
+   */
+  double _t_last;
+  double _v_last;
+  double _i_last;
+
+  /**
+   * step
+   */
+  double _t_step;
+  double _v_step;
+  double _i_step;
+
+  /**
+   * write fields as float32
+   */
+  bool            _single_precision;
+
+  /**
+   * deflate level
+   */
+  int             _compression;
+
+  /**
+   * append current solution as a step with value t
+   */
+  void _write_step(double t);
+
+  /**
+   * if we are in ddm mode
+   */
+  bool            _ddm;
+
+  /**
+   * if we are in mixA mode
+   */
+  bool            _mixA;
+};
+
+#endif
@@ -45,7 +45,7 @@ public:
    *   @param name (input) the name of this hook
    */
   Hook(SolverBase & solver, const std::string & name)
-      :_solver(solver),  _name(name)
+      :_solver(solver),  _name(name), _every(1), _interval(0.0), _report(false)
   {}
 
   /**
@@ -91,6 +91,13 @@ public:
    */
   virtual void on_close() {}
 
+  /**
+   * This is executed when a hook raises an event by HookList::trigger,
+   * i.e. ThresholdHook when the threshold is exceeded
+   * @param source the name of the event
+   */
+  virtual void on_trigger(const std::string & /*source*/) {}
+
   /**
    * @return the name of the hook
    */
@@ -103,6 +110,35 @@ public:
    */
   const SolverBase  & get_solver() const  { return _solver; }
 
+  /**
+   * set the execution policy of this hook.
+   * @param every     only run the iteration/solve callbacks at every N-th call
+   * @param interval  skip the callbacks if less than interval seconds (wall time) passed since last run
+   * @param report    print the timing of this hook at on_close
+   * on_init, post_check and on_close are never throttled.
+   */
+  void set_schedule(unsigned int every, double interval, bool report)
+  {
+    _every = every ? every : 1;
+    _interval = interval;
+    _report = report;
+  }
+
+  /**
+   * @return run the hook at every N-th callback
+   */
+  unsigned int every() const { return _every; }
+
+  /**
+   * @return minimal wall time between two runs, in second
+   */
+  double interval() const { return _interval; }
+
+  /**
+   * @return true when timing report is required
+   */
+  bool report() const { return _report; }
+
 protected:
 
   /**
@@ -116,6 +152,23 @@ protected:
    */
   std::string        _name;
 
+private:
+
+  /**
+   * run the hook at every N-th callback
+   */
+  unsigned int       _every;
+
+  /**
+   * minimal wall time between two runs
+   */
+  double             _interval;
+
+  /**
+   * print timing report
+   */
+  bool               _report;
+
 };
 
 
@@ -26,12 +26,17 @@
 #define __hook_list_h__
 
 #include <map>
+#include <deque>
+#include <vector>
 
 #include "hook.h"
+#include "perf_log.h"
 
 
 /**
- * This is a list of hooks that are executed once at a time
+ * This is a list of hooks that are executed once at a time.
+ * The callbacks of each hook are scheduled by the policy set by Hook::set_schedule,
+ * and the time spent in each hook is accumulated for report.
  */
 class HookList
 {
@@ -51,60 +56,37 @@ public:
    * add hook to hook list
    */
   void   add_hook(Hook * hook)
-  { _hook_list.push_back(hook); }
+  {
+    _hook_list.push_back(hook);
+    _hook_stat.push_back(HookStat());
+  }
 
   /**
    *   This is executed before the initialization of the solver
    */
-  void on_init()
-  {
-    std::deque<Hook *>::iterator it;
-    for (it=_hook_list.begin(); it!=_hook_list.end(); ++it)
-      (*it)->on_init();
-  }
+  void on_init();
 
   /**
    *   This is executed previously to each solution step.
    */
-  void pre_solve()
-  {
-    std::deque<Hook *>::iterator it;
-    for (it=_hook_list.begin(); it!=_hook_list.end(); ++it)
-      (*it)->pre_solve();
-  }
+  void pre_solve();
 
   /**
    *  This is executed after each solution step.
    */
-  void post_solve()
-  {
-    std::deque<Hook *>::iterator it;
-    for (it=_hook_list.begin(); it!=_hook_list.end(); ++it)
-      (*it)->post_solve();
-  }
-
+  void post_solve();
 
   /**
    *  This is executed before each (nonlinear) iteration
    *  i.e. for analysis the condition number of jacobian matrix
    */
-  void pre_iteration()
-  {
-    std::deque<Hook *>::iterator it;
-    for (it=_hook_list.begin(); it!=_hook_list.end(); ++it)
-      (*it)->pre_iteration();
-  }
+  void pre_iteration();
 
   /**
    *  This is executed after each (nonlinear) iteration
    *  i.e. for collecting convergence information or implementing various damping strategy
    */
-  void post_iteration()
-  {
-    std::deque<Hook *>::iterator it;
-    for (it=_hook_list.begin(); it!=_hook_list.end(); ++it)
-      (*it)->post_iteration();
-  }
+  void post_iteration();
 
   /**
    *  This is executed after each (nonlinear) iteration
@@ -112,22 +94,26 @@ public:
    */
   void post_check(void * f, void * x, void * y, void * w, bool & change_y, bool &change_w)
   {
-    std::deque<Hook *>::iterator it;
-    for (it=_hook_list.begin(); it!=_hook_list.end(); ++it)
-      (*it)->post_check(f, x, y, w, change_y, change_w);
+    for (unsigned int i=0; i<_hook_list.size(); ++i)
+    {
+      Hook * hook = _hook_list[i];
+      START_LOG(hook->name(), "Hook::post_check");
+      double t0 = _wtime();
+      hook->post_check(f, x, y, w, change_y, change_w);
+      _hook_stat[i].time += _wtime() - t0;
+      STOP_LOG(hook->name(), "Hook::post_check");
+    }
   }
 
   /**
    * This is executed after the finalization of the solver
    */
-  void on_close()
-  {
-    std::deque<Hook *>::iterator it;
-    for (it=_hook_list.begin(); it!=_hook_list.end(); ++it)
-      (*it)->on_close();
+  void on_close();
 
-    this->clear();
-  }
+  /**
+   * pass an event raised by one hook to all the hooks, never throttled
+   */
+  void trigger(const std::string & source);
 
   /**
    * clear all the hooks
@@ -138,12 +124,50 @@ public:
     for ( it=_hook_list.begin(); it!=_hook_list.end(); ++it)
       delete (*it);
     _hook_list.clear();
+    _hook_stat.clear();
   }
 
 private:
 
   std::deque<Hook *>  _hook_list;
 
+  /**
+   * schedule state and timing of each hook
+   */
+  struct HookStat
+  {
+    HookStat() : n_solve(0), n_iteration(0), run_solve(true), run_iteration(true),
+                 solve_decided(false), iteration_decided(false),
+                 last_solve(-1e30), last_iteration(-1e30), calls(0), skips(0), time(0.0) {}
+
+    /// callback counters
+    unsigned int n_solve, n_iteration;
+
+    /// decision made at pre_* and reused by the matching post_*
+    bool   run_solve, run_iteration;
+    bool   solve_decided, iteration_decided;
+
+    /// wall time of last run
+    double last_solve, last_iteration;
+
+    /// statistics
+    unsigned int calls, skips;
+    double time;
+  };
+
+  std::vector<HookStat> _hook_stat;
+
+  /**
+   * decide if a throttled callback of hook should run.
+   * the decision is the same on all the processors
+   */
+  bool _schedule(const Hook * hook, unsigned int & counter, double & last);
+
+  /**
+   * wall time in second
+   */
+  static double _wtime();
+
 };
 
 
@@ -0,0 +1,107 @@
+/********************************************************************************/
+/*     888888    888888888   88     888  88888   888      888    88888888       */
+/*   8       8   8           8 8     8     8      8        8    8               */
+/*  8            8           8  8    8     8      8        8    8               */
+/*  8            888888888   8   8   8     8      8        8     8888888        */
+/*  8      8888  8           8    8  8     8      8        8            8       */
+/*   8       8   8           8     8 8     8      8        8            8       */
+/*     888888    888888888  888     88   88888     88888888     88888888        */
+/*                                                                              */
+/*       A Three-Dimensional General Purpose Semiconductor Simulator.           */
+/*                                                                              */
+/*                                                                              */
+/*  Copyright (C) 2007-2008                                                     */
+/*  Cogenda Pte Ltd                                                             */
+/*                                                                              */
+/*  Please contact Cogenda Pte Ltd for license information                      */
+/*                                                                              */
+/*  Author: Gong Ding   gdiso@ustc.edu                                          */
+/*                                                                              */
+/********************************************************************************/
+
+
+#ifndef __jdump_hook_h__
+#define __jdump_hook_h__
+
+
+#include "hook.h"
+#include <string>
+
+
+/**
+ * dump jacobian matrix and residual of the nonlinear solver in compressed CSR format
+ * (see CSRDumpWriter) when the Newton iteration diverges or ThresholdHook is violated.
+ * nothing is done for the normal solves, the file is written by a background thread.
+ */
+class JacobianDumpHook : public Hook
+{
+
+public:
+  JacobianDumpHook(SolverBase & solver, const std::string & name, void *);
+
+  virtual ~JacobianDumpHook();
+
+  /**
+   *   This is executed before the initialization of the solver
+   */
+  virtual void on_init();
+
+  /**
+   *   This is executed previously to each solution step.
+   */
+  virtual void pre_solve();
+
+  /**
+   *  This is executed after each solution step.
+   */
+  virtual void post_solve();
+
+  /**
+   *  This is executed after each (nonlinear) iteration
+   */
+  virtual void post_iteration();
+
+  /**
+   * This is executed after the finalization of the solver
+   */
+  virtual void on_close();
+
+  /**
+   * dump the jacobian matrix on "diverged" and "threshold" events
+   */
+  virtual void on_trigger(const std::string & source);
+
+private:
+
+  /**
+   * prefix of the dump files, the files are named as prefix.n.csr
+   */
+  std::string _prefix;
+
+  /**
+   * dump on Newton divergence
+   */
+  bool _on_diverged;
+
+  /**
+   * dump on threshold violation
+   */
+  bool _on_threshold;
+
+  /**
+   * also dump the residual vector
+   */
+  bool _rhs;
+
+  /**
+   * at most so many dumps are written
+   */
+  unsigned int _max_dumps;
+
+  /**
+   * dumps written
+   */
+  unsigned int _n_dumps;
+};
+
+#endif
@@ -24,8 +24,11 @@
 #define __probe_hook_h__
 
 
-#include "hook.h"
 #include <ctime>
+#include <vector>
+#include <sstream>
+
+#include "hook.h"
 
 /**
  * write electrode IV into file which can be plotted by probe
@@ -73,10 +76,43 @@ private:
   */
  Point _pp;
 
- const FVM_Node* _p_fvm_node;
+ /**
+  * interpolation stencil of probe point, as (fvm node, weight) pairs.
+  * it is only hold by processor _min_loc, and built once in on_init
+  */
+ std::vector<std::pair<const FVM_Node *, Real> > _stencil;
 
+ /**
+  * the processor holds the stencil
+  */
  unsigned int    _min_loc;
 
+ /**
+  * number of probed variables
+  */
+ int             _n_var;
+
+ /**
+  * build interpolation stencil from the elem contains probe point
+  * @return false if probe point is not in any elem owned by this processor
+  */
+ bool _build_elem_stencil();
+
+ /**
+  * output is buffered here and flushed to file by block
+  */
+ std::ostringstream _buffer;
+
+ /**
+  * lines in _buffer
+  */
+ unsigned int    _buffered_lines;
+
+ /**
+  * write buffered output to file
+  */
+ void _flush();
+
  /**
   * the output file name
   */
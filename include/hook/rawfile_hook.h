@@ -27,10 +27,17 @@
 
 
 #include "hook.h"
+#include "spice_raw_writer.h"
 #include <time.h>
 
 /**
- * write electrode IV into spice raw file (Ascii format).
+ * write electrode IV into spice raw file (Ascii or binary format).
+ * the values are streamed into the raw file during the solve.
+ * hook parameters:
+ *   file      = name of raw file
+ *   binary    = write values in binary format
+ *   electrode = electrode labels to be recorded, default all
+ *   quantity  = recorded quantities of electrode: vapp, potential, current, default all
  * then user can view the IV curve by some other program.
  * ( can we do real time display here? )
  */
@@ -75,19 +82,19 @@ private:
  time_t          _time;
 
  /**
-  * the input file name
+  * the raw file name
   */
- std::string     _input_file;
+ std::string     _raw_file;
 
  /**
-  * the raw file name
+  * write binary raw file
   */
- std::string     _raw_file;
+ bool            _binary;
 
  /**
-  * file stream
+  * the raw file writer, only on root processor
   */
- std::ofstream   _out;
+ SpiceRawWriter *_writer;
 
  /**
   * if we are in mixA mode
@@ -95,19 +102,30 @@ private:
  bool            _mixA;
 
  /**
-  * the variable name buffer
+  * electrodes to be recorded, empty for all
+  */
+ std::vector<std::string> _electrodes;
+
+ /**
+  * electrode quantities to be recorded, empty for all
+  */
+ std::vector<std::string> _quantities;
+
+ /**
+  * the variable name buffer, with the flag if it is write to file
   */
  std::vector<std::pair<std::string, std::string> >  _variables;
+ std::vector<bool> _variable_output;
 
  /**
-  * the variable value buffer
+  * add a variable, electrode and quantity are used for filtering
   */
- std::vector< std::vector<double> > _values;
+ void _add_variable(const std::string &name, const std::string &type, const std::string &electrode="", const std::string &quantity="");
 
  /**
-  * the total number of values
+  * the value buffer of current point
   */
- unsigned int _n_values;
+ std::vector<double> _values;
 
 };
 
@@ -31,8 +31,12 @@
 
 
 /**
- * calculate singular value for jacobian matrix on each nonlinear iteration
- * for check the condition number of device
+ * calculate singular value for jacobian matrix after each solution step
+ * (or each nonlinear iteration with iteration=true) for check the condition number of device.
+ * parameters:
+ *   reuse.pc  smallest singular value by the factorization of nonlinear solver, default true
+ *   iteration run on each nonlinear iteration instead of each solution step, default false
+ * together with HOOK every=N the diagnostic runs every N steps.
  */
 class SingularValueHook : public Hook
 {
@@ -59,9 +63,9 @@ public:
   virtual void post_solve();
 
   /**
-   *  This is executed before each (nonlinear) iteration
+   *  This is executed after each (nonlinear) iteration
    */
-  virtual void pre_iteration();
+  virtual void post_iteration();
 
   /**
    * This is executed after the finalization of the solver
@@ -90,6 +94,16 @@ private:
    */
   unsigned int solution_count;
 
+  /**
+   * use the factorization of nonlinear solver
+   */
+  bool         _reuse_pc;
+
+  /**
+   * run on each nonlinear iteration
+   */
+  bool         _on_iteration;
+
 private:
 
 
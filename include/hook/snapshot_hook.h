@@ -0,0 +1,159 @@
+/********************************************************************************/
+/*     888888    888888888   88     888  88888   888      888    88888888       */
+/*   8       8   8           8 8     8     8      8        8    8               */
+/*  8            8           8  8    8     8      8        8    8               */
+/*  8            888888888   8   8   8     8      8        8     8888888        */
+/*  8      8888  8           8    8  8     8      8        8            8       */
+/*   8       8   8           8     8 8     8      8        8            8       */
+/*     888888    888888888  888     88   88888     88888888     88888888        */
+/*                                                                              */
+/*       A Three-Dimensional General Purpose Semiconductor Simulator.           */
+/*                                                                              */
+/*                                                                              */
+/*  Copyright (C) 2007-2008                                                     */
+/*  Cogenda Pte Ltd                                                             */
+/*                                                                              */
+/*  Please contact Cogenda Pte Ltd for license information                      */
+/*                                                                              */
+/*  Author: Gong Ding   gdiso@ustc.edu                                          */
+/*                                                                              */
+/********************************************************************************/
+
+
+#ifndef __snapshot_hook_h__
+#define __snapshot_hook_h__
+
+
+#include "hook.h"
+#include "enum_solution.h"
+#include <vector>
+#include <string>
+
+class FVM_Node;
+
+/**
+ * keep the last solutions of selected variables in a bounded in-memory ring buffer,
+ * the buffer is written at the end of the solver or when another hook raises an event,
+ * i.e. ThresholdHook. each processor holds the nodes it owns, nothing is communicated
+ * until the buffer is written.
+ */
+class SnapshotHook : public Hook
+{
+
+public:
+  SnapshotHook(SolverBase & solver, const std::string & name, void *);
+
+  virtual ~SnapshotHook();
+
+  /**
+   *   This is executed before the initialization of the solver
+   */
+  virtual void on_init();
+
+  /**
+   *   This is executed previously to each solution step.
+   */
+  virtual void pre_solve();
+
+  /**
+   *  This is executed after each solution step.
+   */
+  virtual void post_solve();
+
+  /**
+   *  This is executed after each (nonlinear) iteration
+   */
+  virtual void post_iteration();
+
+  /**
+   * This is executed after the finalization of the solver
+   */
+  virtual void on_close();
+
+  /**
+   * write the buffer when triggered
+   */
+  virtual void on_trigger(const std::string & source);
+
+private:
+
+  /**
+   * the output file name
+   */
+  std::string     _snapshot_file;
+
+  /**
+   * the variables to be recorded
+   */
+  std::vector<SolutionVariable> _variables;
+
+  /**
+   * variable names as given by user
+   */
+  std::vector<std::string>      _variable_names;
+
+  /**
+   * only record nodes in these regions, all the regions when empty
+   */
+  std::vector<std::string> _regions;
+
+  /**
+   * the recorded nodes owned by this processor, a node on region interface
+   * appears once for each region
+   */
+  std::vector<const FVM_Node *> _nodes;
+
+  /**
+   * region of each recorded node
+   */
+  std::vector<unsigned int> _node_region;
+
+  /**
+   * max snapshots in buffer
+   */
+  unsigned int _capacity;
+
+  /**
+   * record every stride-th solution
+   */
+  unsigned int _stride;
+
+  /**
+   * write buffer on trigger
+   */
+  bool _flush_on_trigger;
+
+  /**
+   * solutions seen
+   */
+  unsigned int _n_solve;
+
+  /**
+   * files written
+   */
+  unsigned int _n_flush;
+
+  /**
+   * the ring buffer, time and values of [variable][node] for each slot
+   */
+  std::vector<double>              _time;
+  std::vector< std::vector<float> > _value;
+
+  /**
+   * position of the oldest snapshot and the number of snapshots in buffer
+   */
+  unsigned int _head;
+  unsigned int _size;
+
+  /**
+   * collect the nodes of the selected regions
+   */
+  void _build_node_list();
+
+  /**
+   * gather the buffer to processor 0 and write it, the buffer is empty afterwards
+   */
+  void _flush(const std::string & reason);
+};
+
+#endif
@@ -0,0 +1,123 @@
+/********************************************************************************/
+/*     888888    888888888   88     888  88888   888      888    88888888       */
+/*   8       8   8           8 8     8     8      8        8    8               */
+/*  8            8           8  8    8     8      8        8    8               */
+/*  8            888888888   8   8   8     8      8        8     8888888        */
+/*  8      8888  8           8    8  8     8      8        8            8       */
+/*   8       8   8           8     8 8     8      8        8            8       */
+/*     888888    888888888  888     88   88888     88888888     88888888        */
+/*                                                                              */
+/*       A Three-Dimensional General Purpose Semiconductor Simulator.           */
+/*                                                                              */
+/*                                                                              */
+/*  Copyright (C) 2007-2008                                                     */
+/*  Cogenda Pte Ltd                                                             */
+/*                                                                              */
+/*  Please contact Cogenda Pte Ltd for license information                      */
+/*                                                                              */
+/*  Author: Gong Ding   gdiso@ustc.edu                                          */
+/*                                                                              */
+/********************************************************************************/
+
+
+#ifndef __spice_raw_writer_h__
+#define __spice_raw_writer_h__
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include <ctime>
+
+
+/**
+ * streaming writer of SPICE raw file, in ascii or binary format.
+ * the header is written before the first point with a fixed width
+ * "No. Points" field, which is patched when the file is closed.
+ * points are collected in a memory buffer and written to file by block.
+ */
+class SpiceRawWriter
+{
+public:
+
+  /**
+   * @param filename     the raw file name
+   * @param binary       write values as native double instead of ascii
+   * @param buffer_size  size of memory buffer in bytes
+   */
+  SpiceRawWriter(const std::string & filename, bool binary, size_t buffer_size = 1<<20);
+
+  /**
+   * close the file
+   */
+  ~SpiceRawWriter();
+
+  /**
+   * add a variable with its type (i.e. voltage, current, time), should be called before write_header
+   */
+  void add_variable(const std::string & name, const std::string & type)
+  { _variables.push_back( std::make_pair(name, type) ); }
+
+  /**
+   * @return number of variables
+   */
+  unsigned int n_variables() const
+  { return _variables.size(); }
+
+  /**
+   * @return number of points written
+   */
+  unsigned int n_points() const
+  { return _n_points; }
+
+  /**
+   * write file head
+   */
+  void write_header(const std::string & title, const std::string & plotname, time_t t);
+
+  /**
+   * append a point, the size of values should equal to n_variables
+   */
+  void write_point(const std::vector<double> & values);
+
+  /**
+   * flush the buffer and patch the point number in file head
+   */
+  void flush();
+
+  /**
+   * flush and close the file
+   */
+  void close();
+
+private:
+
+  std::ofstream   _out;
+
+  bool            _binary;
+
+  size_t          _buffer_size;
+
+  /**
+   * the variable name and type
+   */
+  std::vector<std::pair<std::string, std::string> >  _variables;
+
+  /**
+   * memory buffer of values
+   */
+  std::string     _buffer;
+
+  /**
+   * total points
+   */
+  unsigned int    _n_points;
+
+  /**
+   * file position of the "No. Points" field
+   */
+  std::streampos  _n_points_pos;
+
+  bool            _header_written;
+};
+
+#endif
@@ -98,6 +98,11 @@ private:
    */
   std::vector< std::pair<double, std::string> > time_sequence;
 
+  /**
+   * max files waiting for the background writer, 0 for synchronous output
+   */
+  unsigned int    _async_queue;
+
   /**
    * if we are in ddm mode
    */
@@ -42,8 +42,54 @@ public:
    */
   double get_interpolated_value(const Point & point, int group) const;
 
+  /**
+   * get interpolated values with GROUP_ID group in a batch of points, evaluated in parallel
+   */
+  void get_interpolated_values(const std::vector<Point> & points, int group, std::vector<double> & values) const;
+
 private:
 
+  /**
+   * large point sets are fitted by a grid of overlapping tiles, each tile has its own csa.
+   * the tile values are blended by weights which fall to zero across the overlap.
+   */
+  struct Tile
+  {
+    CSA::csa * field;
+    /// the points in the tile, csa only keeps the pointers
+    std::vector<CSA::point> points;
+    /// extended box of the tile, clipped by the bounding box of the whole data set
+    double xmin, xmax, ymin, ymax;
+    /// width of the blending ramp at each side, 0 at the border of the whole data set
+    double ramp_xmin, ramp_xmax, ramp_ymin, ramp_ymax;
+    /// bounding box of the points, the domain of the csa
+    double dxmin, dxmax, dymin, dymax;
+  };
+
+  struct TileGrid
+  {
+    int nx, ny;
+    double x0, y0, dx, dy;
+    std::vector<Tile> tiles;
+  };
+
+  std::map<int, TileGrid> tile_map;
+
+  /**
+   * build the tiles of group, return false if the point set is small enough for a single csa
+   */
+  bool setup_tiles(int group);
+
+  /**
+   * interpolated value in the scaled space
+   */
+  double scaled_value(const Point & point, int group) const;
+
+  /**
+   * unscale and limit the interpolated value
+   */
+  double unscaled_value(double z, int group) const;
+
   std::map<int, CSA::csa *>  field_map;  //
 
   std::map<int, std::vector<CSA::point> > csa_points;
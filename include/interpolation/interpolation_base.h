@@ -4,6 +4,7 @@
 #include <cassert>
 #include <map>
 #include <string>
+#include <vector>
 
 #include "point.h"
 
@@ -67,6 +68,17 @@ public:
    */
   virtual double get_interpolated_value(const Point & point, int group)const=0;
 
+  /**
+   * get interpolated values with GROUP_ID group in a batch of points,
+   * dirived class can override it for faster evaluation
+   */
+  virtual void get_interpolated_values(const std::vector<Point> & points, int group, std::vector<double> & values) const
+  {
+    values.resize(points.size());
+    for(unsigned int i=0; i<points.size(); ++i)
+      values[i] = this->get_interpolated_value(points[i], group);
+  }
+
   /**
    * InterpolationType, should support linear (for potential, etc) and asinh (doping concentration and carrier density)
    */
@@ -0,0 +1,137 @@
+/********************************************************************************/
+/*     888888    888888888   88     888  88888   888      888    88888888       */
+/*   8       8   8           8 8     8     8      8        8    8               */
+/*  8            8           8  8    8     8      8        8    8               */
+/*  8            888888888   8   8   8     8      8        8     8888888        */
+/*  8      8888  8           8    8  8     8      8        8            8       */
+/*   8       8   8           8     8 8     8      8        8            8       */
+/*     888888    888888888  888     88   88888     88888888     88888888        */
+/*                                                                              */
+/*       A Three-Dimensional General Purpose Semiconductor Simulator.           */
+/*                                                                              */
+/*                                                                              */
+/*  Copyright (C) 2007-2008                                                     */
+/*  Cogenda Pte Ltd                                                             */
+/*                                                                              */
+/*  Please contact Cogenda Pte Ltd for license information                      */
+/*                                                                              */
+/*  Author: Gong Ding   gdiso@ustc.edu                                          */
+/*                                                                              */
+/********************************************************************************/
+
+#ifndef __interpolation_mesh_h__
+#define __interpolation_mesh_h__
+
+#include <vector>
+
+#include "auto_ptr.h"
+#include "interpolation_base.h"
+
+class MeshBase;
+class Elem;
+class PointLocatorTree;
+
+
+/**
+ * mesh-to-mesh interpolation. the source mesh (usually the mesh before refinement) is copied into
+ * this class, the scatter data is attached to the nodes of the copied mesh.
+ * the target point is located in the source mesh by walking across element neighbors from the
+ * element found last time, if the walk failed, the PointLocatorTree is asked.
+ * the value is interpolated by the shape functions of the source element.
+ *
+ * @note set_source_mesh() should be called before any scatter data is added
+ */
+class Interpolation_Mesh : public InterpolationBase
+{
+public:
+  Interpolation_Mesh ();
+
+  ~Interpolation_Mesh ();
+
+  /**
+   * clear internal interpolation data
+   */
+  void clear();
+
+  /**
+   * copy active elements of source mesh, build point locator
+   */
+  void set_source_mesh(const MeshBase & mesh);
+
+  /**
+   * build internal data structure
+   */
+  void setup(int group);
+
+  /**
+   * broadcast data to all the processor
+   * the source mesh should be set on all the processors, only the node data is broadcasted
+   */
+  virtual void broadcast(unsigned int root=0);
+
+  /**
+   * add the data with GROUP_ID group for interpolation
+   * the point should be a node of the source mesh.
+   */
+  void add_scatter_data(const Point & point, int group, double value);
+
+  /**
+   * get interpolated value with GROUP_ID group in location point
+   */
+  double get_interpolated_value(const Point & point, int group) const;
+
+  /**
+   * get interpolated values of a batch of points, parallel over points with OpenMP
+   */
+  virtual void get_interpolated_values(const std::vector<Point> & points, int group, std::vector<double> & values) const;
+
+private:
+
+  /**
+   * the copy of source mesh, only active elements are kept
+   */
+  AutoPtr<MeshBase> _mesh;
+
+  /**
+   * the master point locator of source mesh
+   */
+  AutoPtr<PointLocatorTree> _locator;
+
+  /**
+   * the last element found by get_interpolated_value()
+   */
+  mutable const Elem * _last_elem;
+
+  /**
+   * point locator works in out of mesh mode, only possible for affine elements
+   */
+  bool _out_of_mesh_mode;
+
+  /**
+   * scaled nodal value of each group, indexed by node id
+   */
+  std::map<int, std::vector<double> > _field;
+
+  /**
+   * flag of nodal value is set
+   */
+  std::map<int, std::vector<char> > _field_valid;
+
+  /**
+   * locate point p in the source mesh, start the neighbor walk from elem hint
+   */
+  const Elem * locate(const Point & p, const Elem * hint, const PointLocatorTree & locator) const;
+
+  /**
+   * interpolate scaled value of point p in element elem
+   */
+  double interpolate(const Elem * elem, const Point & p, int group) const;
+
+  /**
+   * max steps of neighbor walk
+   */
+  static const unsigned int _max_walk_step = 64;
+};
+
+
+#endif
@@ -32,6 +32,10 @@
 #include "adolc.h" // for automatic differentiation
 #include "variable_define.h"
 
+#ifdef HAVE_OPENMP
+#include <omp.h>
+#endif
+
 using namespace adtl;
 
 //predefine
@@ -52,29 +56,64 @@ class FVM_NodeData;
 // re-implemented virtual functions.
 
 /**
- * PMI_Environment, this structure will be passed to PMI class when initializing.
- * It contains interface information for linking main genius code to each PMI class
+ * the max number of threads which can map nodes of the same material concurrently
  */
-struct PMI_Environment
+#define PMI_MAX_THREADS 64
+
+/**
+ * @return the slot index of calling thread in the PMI context table
+ */
+inline unsigned int PMI_thread_id()
+{
+#ifdef HAVE_OPENMP
+  return static_cast<unsigned int>(omp_get_thread_num());
+#else
+  return 0;
+#endif
+}
+
+/**
+ * PMI_NodeContext, the node the PMI function is evaluated at.
+ * material class holds one context for each thread, filled by mapping function.
+ * only the context is per thread, PMI models which keep scratch members are still
+ * evaluated by one thread
+ */
+struct PMI_NodeContext
 {
   /**
-   * the location of current Point, use "pointer to pointer" method
-   * here pp_point point to p_point in the material class which point to
-   * current Point as a buffer.
+   * current Point
    */
-  const Point         **    pp_point;
+  const Point         *    point;
 
   /**
-   * the location of current node_data, use "pointer to pointer" method
-   * here pp_node_data point to pnode_data in the material class which point to
-   * current FVM_NodeData as a buffer.
+   * data of current node
    */
-  const FVM_NodeData **    pp_node_data;
+  const FVM_NodeData  *    node_data;
 
   /**
-   * the pointer to current time
+   * current time
    */
-  const PetscScalar  *     p_clock;
+  PetscScalar              clock;
+
+  /**
+   * constructor
+   */
+  PMI_NodeContext(const Point *p=0, const FVM_NodeData *data=0, PetscScalar time=0.0)
+  : point(p), node_data(data), clock(time)
+  {}
+};
+
+/**
+ * PMI_Environment, this structure will be passed to PMI class when initializing.
+ * It contains interface information for linking main genius code to each PMI class
+ */
+struct PMI_Environment
+{
+  /**
+   * the per-thread node context table in the material class, which has
+   * PMI_MAX_THREADS entries. each thread reads its own entry.
+   */
+  PMI_NodeContext *        p_context;
 
   /**
    * const pointer to region variables
@@ -109,17 +148,17 @@ struct PMI_Environment
   /**
    * constructor
    */
-  PMI_Environment(const Point** point, const FVM_NodeData **node_data, const PetscScalar *time,
+  PMI_Environment(PMI_NodeContext *context,
                   const std::map<std::string, SimulationVariable> ** variables,
                   double _m_, double _s_, double _V_, double _C_, double _K_)
-  : pp_point(point), pp_node_data(node_data), p_clock(time), pp_variables(variables), m(_m_), s(_s_), V(_V_), C(_C_), K(_K_)
+  : p_context(context), pp_variables(variables), m(_m_), s(_s_), V(_V_), C(_C_), K(_K_)
   {}
 
   /**
    * constructor
    */
   PMI_Environment(double _m_, double _s_, double _V_, double _C_, double _K_)
-  : pp_point(0), pp_node_data(0), p_clock(0), pp_variables(0), m(_m_), s(_s_), V(_V_), C(_C_), K(_K_)
+  : p_context(0), pp_variables(0), m(_m_), s(_s_), V(_V_), C(_C_), K(_K_)
   {}
 
 };
@@ -234,23 +273,28 @@ protected:
   const std::map<std::string, SimulationVariable>  ** pp_variables;
 
   /**
-   * the location of current point, use "pointer to pointer" method
-   * here pp_point point to p_point in the material class which point to
-   * current Point as a buffer.
+   * the per-thread node context table in the material class
+   */
+  PMI_NodeContext        *p_context;
+
+  /**
+   * @return the point of calling thread, 0 if not linked to material
    */
-  const Point            **pp_point;
+  const Point * current_point() const
+  { return p_context ? p_context[PMI_thread_id()].point : 0; }
 
   /**
-   * the location of current node_data, use "pointer to pointer" method
-   * here pp_node_data point to pnode_data in the material class which point to
-   * current FVM_NodeData as a buffer.
+   * @return the node data of calling thread, 0 if not linked to material
    */
-  const FVM_NodeData    **pp_node_data;
+  const FVM_NodeData * current_node_data() const
+  { return p_context ? p_context[PMI_thread_id()].node_data : 0; }
 
   /**
-   * the pointer to current time
+   * map the node context of calling thread to \p context, the same as Material::mapping.
+   * used by batched PMI functions which loop over several nodes.
+   * @return the previous context, which should be restored by the caller
    */
-  const PetscScalar     *p_clock;
+  PMI_NodeContext bind_context(const PMI_NodeContext &context) const;
 
 protected:
   /**
@@ -368,6 +412,46 @@ public:
 
 typedef PMI_Environment PMIS_Environment;
 
+
+/**
+ * per-node table of the PMI parameters which only depend on mole fraction, indexed by
+ * the data offset of the node in region storage. an entry is valid while the mole fraction
+ * it was evaluated at equals the one of the node, so it is filled once after mole
+ * initialization and refilled only if the mole fraction is changed later.
+ * the table is sized by init_mole_table() before assembly, so concurrent threads only
+ * touch the entries of their own nodes.
+ */
+template <typename T>
+class PMI_MoleTable
+{
+public:
+  /**
+   * allocate \p n invalid entries
+   */
+  void resize(unsigned int n)
+  {
+    _x.assign(n, -1.0);
+    _entry.assign(n, T());
+  }
+
+  /**
+   * @return the entry at \p offset, or 0 if the table does not cover it.
+   * \p stale is set when the entry was not evaluated at mole fraction \p x, the caller
+   * should fill it then.
+   */
+  T * entry(unsigned int offset, PetscScalar x, bool &stale)
+  {
+    if( offset >= _x.size() ) { stale = true; return 0; }
+    stale = ( _x[offset] != x );
+    _x[offset] = x;
+    return &_entry[offset];
+  }
+
+private:
+  std::vector<PetscScalar> _x;
+  std::vector<T>           _entry;
+};
+
 /**
  * PMIS_Server, the derived class of PMI_Server for semiconductor
  */
@@ -427,6 +511,28 @@ public:
    * aux function return total Donor concentration of current node
    */
   PetscScalar ReadDopingNd () const;
+
+  /**
+   * aux function return total Acceptor concentration of node described by \p context
+   */
+  PetscScalar ReadDopingNa (const PMI_NodeContext &context) const;
+
+  /**
+   * aux function return total Donor concentration of node described by \p context
+   */
+  PetscScalar ReadDopingNd (const PMI_NodeContext &context) const;
+
+  /**
+   * size the per-node tables of mole fraction dependent parameters for \p n node data.
+   * called by the region after the mole fraction is initialized, PMI without table ignores it.
+   */
+  virtual void init_mole_table(unsigned int ) {}
+
+protected:
+  /**
+   * @return data offset of current node in region storage, invalid_uint if not linked to a node
+   */
+  unsigned int current_node_offset() const;
 };
 
 
@@ -593,6 +699,22 @@ public:
    */
   virtual AutoDScalar nie            (const AutoDScalar &p, const AutoDScalar &n, const AutoDScalar &Tl) =0;
 
+  /**
+   * batched band gap of \p size nodes, node i is described by \p context[i].
+   * the default implementation maps each node and calls the scalar version,
+   * so it works for any PMI. built-in models may override it with a flat loop.
+   */
+  virtual void Eg                   (const unsigned int size, const PMI_NodeContext *context,
+                                     const PetscScalar *Tl, PetscScalar *result);
+
+  /**
+   * batched effective intrinsic carrier concentration of \p size nodes
+   * @see Eg(const unsigned int, const PMI_NodeContext *, const PetscScalar *, PetscScalar *)
+   */
+  virtual void nie                  (const unsigned int size, const PMI_NodeContext *context,
+                                     const PetscScalar *p, const PetscScalar *n, const PetscScalar *Tl,
+                                     PetscScalar *result);
+
   /**
    * @return the ion type by given species, the return value is defined as P-type < 0 and N-type >0
    * each semiconductor material can derive this function
@@ -949,6 +1071,25 @@ public:
   virtual AutoDScalar HoleMob (const AutoDScalar &p,  const AutoDScalar &n,  const AutoDScalar &Tl,
                                const AutoDScalar &Ep, const AutoDScalar &Et, const AutoDScalar &Tp) const=0;
 
+  /**
+   * batched electron mobility of \p size nodes, node i is described by \p context[i].
+   * the default implementation maps each node and calls the scalar version,
+   * so it works for any PMI. built-in models may override it with a flat loop.
+   */
+  virtual void ElecMob (const unsigned int size, const PMI_NodeContext *context,
+                        const PetscScalar *p,  const PetscScalar *n,  const PetscScalar *Tl,
+                        const PetscScalar *Ep, const PetscScalar *Et, const PetscScalar *Tn,
+                        PetscScalar *result) const;
+
+  /**
+   * batched hole mobility of \p size nodes
+   * @see ElecMob(const unsigned int, const PMI_NodeContext *, ...)
+   */
+  virtual void HoleMob (const unsigned int size, const PMI_NodeContext *context,
+                        const PetscScalar *p,  const PetscScalar *n,  const PetscScalar *Tl,
+                        const PetscScalar *Ep, const PetscScalar *Et, const PetscScalar *Tp,
+                        PetscScalar *result) const;
+
 };
 
 
@@ -1135,6 +1276,21 @@ public:
    */
   virtual void Update(const bool flag_bulk, const PetscScalar &p, const PetscScalar &n, const PetscScalar &ni, const PetscScalar &Tl) = 0;
 
+  /**
+   * advance trap occupancy over the last time step with the converged carrier densities.
+   * used when trap kinetics are decoupled from the Newton system, the occupancy (and its AD
+   * counterpart) is then kept frozen until the next call.
+   * the default falls back to Update()
+   */
+  virtual void Advance(const bool flag_bulk, const PetscScalar &p, const PetscScalar &n, const PetscScalar &ni, const PetscScalar &Tl)
+  { Update(flag_bulk, p, n, ni, Tl); }
+
+  /**
+   * scale the density of all the traps by \p factor, used by sensitivity analysis.
+   * @return false if the model does not support it
+   */
+  virtual bool ScaleDensity(const PetscScalar &) { return false; }
+
 };
 
 
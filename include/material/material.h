@@ -32,6 +32,7 @@
 #include "material_define.h"
 #include "physical_unit.h"
 #include "PMI.h"
+#include "solver_counters.h"
 
 #ifdef WINDOWS
   class HINSTANCE__; // Forward or never
@@ -71,17 +72,33 @@ public:
   virtual ~MaterialBase();
 
   /**
-   * mapping Point, its Data and current time to internal image.
-   * the PMI has second order pointer to these internal image.
-   * so PMI can read information
+   * mapping Point, its Data and current time to the node context of calling thread.
+   * the PMI holds pointer to the context table and reads the entry of its own thread,
+   * so different threads can map different nodes. it does not make the PMI models reentrant,
+   * a model may keep scratch members between calls
    */
   void mapping(const Point* point, const FVM_NodeData* node_data, PetscScalar time)
   {
-    p_point = point;
-    p_node_data = node_data;
-    clock = time;
+    this->mapping( PMI_NodeContext(point, node_data, time) );
   }
 
+  /**
+   * mapping a whole node context to calling thread
+   */
+  void mapping(const PMI_NodeContext & context)
+  {
+    const unsigned int tid = PMI_thread_id();
+    genius_assert(tid < PMI_MAX_THREADS);
+    node_context[tid] = context;
+    solver_counters.add(pmi_counter);
+  }
+
+  /**
+   * @return the node context of calling thread, can be used to save/restore the mapping
+   */
+  const PMI_NodeContext & current_context() const
+  { return node_context[PMI_thread_id()]; }
+
   /**
    * @return PMI_Environment
    */
@@ -139,19 +156,15 @@ protected:
   const std::string          material;
 
   /**
-   * pointer to current point, which is updated by mapping function
-   */
-  const Point                *p_point;
-
-  /**
-   * pointer to data of current node, which is updated by mapping function
+   * node context (current point, node data and time) of each thread,
+   * which is updated by mapping function
    */
-  const FVM_NodeData         *p_node_data;
+  PMI_NodeContext            node_context[PMI_MAX_THREADS];
 
   /**
-   * current time, which is updated by mapping function
+   * id of the solver counter of PMI evaluations (node mappings) of this material
    */
-  PetscScalar                clock;
+  unsigned int               pmi_counter;
 
   /**
    * region point based variables
@@ -244,6 +257,12 @@ public:
    */
   void init_bc_node(const std::string &type, const std::string & bc_label, const Point* point, FVM_NodeData* node_data);
 
+  /**
+   * size the per-node tables of mole fraction dependent parameters in the PMIs,
+   * should be called after mole fraction initialization
+   */
+  void init_mole_table(unsigned int n_node_data);
+
   /**
    * get an information string of the PMI models
    */
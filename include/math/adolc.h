@@ -67,6 +67,14 @@
 // However, using std::vector (or even new adval array) instead of fxied length array makes system performance greatly slow done.
 #define ADTL_NUMBER_DIRECTIONS 56
 
+// the number of active directions is a per-thread value, then
+// each assembly thread can set it for the element it processes
+#if defined(_MSC_VER)
+  #define ADTL_THREAD_LOCAL __declspec(thread)
+#else
+  #define ADTL_THREAD_LOCAL __thread
+#endif
+
 
 extern "C"
 {
@@ -234,7 +242,7 @@ namespace adtl
     inline friend std::ostream& operator << ( std::ostream&, const AutoDScalar& );
     inline friend std::istream& operator >> ( std::istream&, AutoDScalar& );
 
-    static unsigned int numdir;
+    static ADTL_THREAD_LOCAL unsigned int numdir;
     static void setNumDir(const unsigned int p)
     {
       if (p>ADTL_NUMBER_DIRECTIONS) numdir=ADTL_NUMBER_DIRECTIONS;
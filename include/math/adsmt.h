@@ -137,6 +137,9 @@ public:
   inline friend const AsmtDScalar fmin (const AsmtDScalar &a, PetscScalar v);
 
   inline friend const AsmtDScalar fermi_half (const AsmtDScalar &a);
+#ifndef WINDOWS
+  inline friend const AsmtDScalar erf (const AsmtDScalar &a);
+#endif
 
   /*******************  nontemporary results  ***************************/
   // assignment
@@ -658,7 +661,7 @@ const AsmtDScalar acosh (const AsmtDScalar &a)
 
 const AsmtDScalar atanh (const AsmtDScalar &a)
 {
-  AsmtDScalar tmp;
+  AsmtDScalar tmp(a);
   tmp._val=boost::math::atanh(a._val);
   PetscScalar tmp2=1-a._val*a._val;
   for (size_t _i=0; _i<tmp._occupied; ++_i)
@@ -911,6 +914,19 @@ const AsmtDScalar fermi_half (const AsmtDScalar &a)
 }
 
 
+#ifndef WINDOWS
+const AsmtDScalar erf (const AsmtDScalar &a)
+{
+  AsmtDScalar tmp(a);
+  tmp._val=::erf(a._val);
+  PetscScalar tmp2=2.0/std::sqrt(std::acos(-1.0))*std::exp(-a._val*a._val);
+  for (size_t _i=0; _i<tmp._occupied; ++_i)
+    tmp._deriv_value[_i]=tmp2*a._deriv_value[_i];
+  return tmp;
+}
+#endif
+
+
 /*******************  nontemporary results  *********************************/
 void AsmtDScalar::operator = (const PetscScalar v)
 {
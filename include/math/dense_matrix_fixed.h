@@ -0,0 +1,265 @@
+/********************************************************************************/
+/*     888888    888888888   88     888  88888   888      888    88888888       */
+/*   8       8   8           8 8     8     8      8        8    8               */
+/*  8            8           8  8    8     8      8        8    8               */
+/*  8            888888888   8   8   8     8      8        8     8888888        */
+/*  8      8888  8           8    8  8     8      8        8            8       */
+/*   8       8   8           8     8 8     8      8        8            8       */
+/*     888888    888888888  888     88   88888     88888888     88888888        */
+/*                                                                              */
+/*       A Three-Dimensional General Purpose Semiconductor Simulator.           */
+/*                                                                              */
+/*                                                                              */
+/*  Copyright (C) 2007-2008                                                     */
+/*  Cogenda Pte Ltd                                                             */
+/*                                                                              */
+/*  Please contact Cogenda Pte Ltd for license information                      */
+/*                                                                              */
+/*  Author: Gong Ding   gdiso@ustc.edu                                          */
+/*                                                                              */
+/********************************************************************************/
+
+#ifndef __dense_matrix_fixed_h__
+#define __dense_matrix_fixed_h__
+
+#include <cmath>
+#include <algorithm>
+
+#include "genius_common.h"
+
+
+/**
+ * dense matrix of compile time size N x M with stack storage, for the small local
+ * problems (gradient reconstruction, node level source terms, element least squares)
+ * where the size is known by element type. the loops have constant bounds and are
+ * unrolled by the compiler, no heap allocation happens.
+ */
+template <unsigned int N, unsigned int M, typename T=Real>
+class DenseMatrixFixed
+{
+public:
+  /**
+   * zero matrix
+   */
+  DenseMatrixFixed()
+  { this->zero(); }
+
+  /**
+   * @return the number of rows
+   */
+  static unsigned int m() { return N; }
+
+  /**
+   * @return the number of columns
+   */
+  static unsigned int n() { return M; }
+
+  const T & operator() (const unsigned int i, const unsigned int j) const
+  { return _val[i][j]; }
+
+  T & operator() (const unsigned int i, const unsigned int j)
+  { return _val[i][j]; }
+
+  void zero()
+  {
+    for(unsigned int i=0; i<N; ++i)
+      for(unsigned int j=0; j<M; ++j)
+        _val[i][j] = 0.0;
+  }
+
+  /**
+   * add \p v to the diagonal
+   */
+  void add_diagonal(const T &v)
+  {
+    for(unsigned int i=0; i<N && i<M; ++i)
+      _val[i][i] += v;
+  }
+
+  const DenseMatrixFixed<N,M,T> & operator *= (const T &factor)
+  {
+    for(unsigned int i=0; i<N; ++i)
+      for(unsigned int j=0; j<M; ++j)
+        _val[i][j] *= factor;
+    return *this;
+  }
+
+  /**
+   * y = A*x, \p x has M and \p y has N entries
+   */
+  void vector_mult(const T *x, T *y) const
+  {
+    for(unsigned int i=0; i<N; ++i)
+    {
+      T s = 0.0;
+      for(unsigned int j=0; j<M; ++j)
+        s += _val[i][j]*x[j];
+      y[i] = s;
+    }
+  }
+
+  /**
+   * @return the transpose
+   */
+  DenseMatrixFixed<M,N,T> transpose() const
+  {
+    DenseMatrixFixed<M,N,T> t;
+    for(unsigned int i=0; i<N; ++i)
+      for(unsigned int j=0; j<M; ++j)
+        t(j,i) = _val[i][j];
+    return t;
+  }
+
+  /**
+   * @return this*B
+   */
+  template <unsigned int K>
+  DenseMatrixFixed<N,K,T> operator * (const DenseMatrixFixed<M,K,T> &B) const
+  {
+    DenseMatrixFixed<N,K,T> C;
+    for(unsigned int i=0; i<N; ++i)
+      for(unsigned int l=0; l<M; ++l)
+      {
+        const T a = _val[i][l];
+        for(unsigned int k=0; k<K; ++k)
+          C(i,k) += a*B(l,k);
+      }
+    return C;
+  }
+
+  /**
+   * @return this'*this, the normal matrix of least squares problem
+   */
+  DenseMatrixFixed<M,M,T> normal() const
+  {
+    DenseMatrixFixed<M,M,T> C;
+    for(unsigned int i=0; i<M; ++i)
+      for(unsigned int j=i; j<M; ++j)
+      {
+        T s = 0.0;
+        for(unsigned int l=0; l<N; ++l)
+          s += _val[l][i]*_val[l][j];
+        C(i,j) = C(j,i) = s;
+      }
+    return C;
+  }
+
+private:
+  T _val[N][M];
+};
+
+
+
+/**
+ * LU decomposition with partial pivoting of a fixed size square matrix,
+ * works as JAMA::LU without heap storage.
+ */
+template <unsigned int N, typename T=Real>
+class DenseLUFixed
+{
+public:
+  /**
+   * decompose \p A
+   */
+  explicit DenseLUFixed(const DenseMatrixFixed<N,N,T> &A)
+    : _lu(A), _sign(1), _singular(false)
+  {
+    for(unsigned int i=0; i<N; ++i)
+      _piv[i] = i;
+
+    for(unsigned int j=0; j<N; ++j)
+    {
+      // find pivot
+      unsigned int p = j;
+      for(unsigned int i=j+1; i<N; ++i)
+        if( std::abs(_lu(i,j)) > std::abs(_lu(p,j)) ) p = i;
+
+      if( p != j )
+      {
+        for(unsigned int k=0; k<N; ++k)
+          std::swap(_lu(p,k), _lu(j,k));
+        std::swap(_piv[p], _piv[j]);
+        _sign = -_sign;
+      }
+
+      if( _lu(j,j) == 0.0 ) { _singular = true; continue; }
+
+      const T inv = 1.0/_lu(j,j);
+      for(unsigned int i=j+1; i<N; ++i)
+      {
+        const T l = (_lu(i,j) *= inv);
+        for(unsigned int k=j+1; k<N; ++k)
+          _lu(i,k) -= l*_lu(j,k);
+      }
+    }
+  }
+
+  /**
+   * @return true if the matrix is not singular
+   */
+  bool is_nonsingular() const
+  { return !_singular; }
+
+  /**
+   * solve A*x = b, \p x and \p b may be the same array
+   */
+  void solve(const T *b, T *x) const
+  {
+    T y[N];
+    for(unsigned int i=0; i<N; ++i)
+      y[i] = b[_piv[i]];
+
+    // forward substitution with unit lower triangle
+    for(unsigned int i=1; i<N; ++i)
+      for(unsigned int k=0; k<i; ++k)
+        y[i] -= _lu(i,k)*y[k];
+
+    // backward substitution
+    for(unsigned int i=N; i-- > 0; )
+    {
+      for(unsigned int k=i+1; k<N; ++k)
+        y[i] -= _lu(i,k)*y[k];
+      y[i] /= _lu(i,i);
+    }
+
+    for(unsigned int i=0; i<N; ++i)
+      x[i] = y[i];
+  }
+
+  /**
+   * @return the inverse of A
+   */
+  DenseMatrixFixed<N,N,T> inverse() const
+  {
+    DenseMatrixFixed<N,N,T> inv;
+    for(unsigned int j=0; j<N; ++j)
+    {
+      T e[N];
+      for(unsigned int i=0; i<N; ++i)
+        e[i] = (i==j ? 1.0 : 0.0);
+      this->solve(e, e);
+      for(unsigned int i=0; i<N; ++i)
+        inv(i,j) = e[i];
+    }
+    return inv;
+  }
+
+  /**
+   * @return determinant of A
+   */
+  T det() const
+  {
+    T d = static_cast<T>(_sign);
+    for(unsigned int j=0; j<N; ++j)
+      d *= _lu(j,j);
+    return d;
+  }
+
+private:
+  DenseMatrixFixed<N,N,T> _lu;
+  unsigned int _piv[N];
+  int  _sign;
+  bool _singular;
+};
+
+#endif // #define __dense_matrix_fixed_h__
@@ -71,8 +71,18 @@ public:
   double operator () (double x, double y, double z, double t)
   { return eval(x,y,z,t); }
 
+  /**
+   * evalute the expression at \p n points with the same time
+   */
+  void eval(unsigned int n, const double *x, const double *y, const double *z, double t, double *result);
+
 private:
 
+  /**
+   * address of the independent variables in vlist, resolved once at construction
+   */
+  double *_x, *_y, *_z, *_t;
+
   /**
    * all the variables
    */
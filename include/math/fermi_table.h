@@ -0,0 +1,242 @@
+/********************************************************************************/
+/*     888888    888888888   88     888  88888   888      888    88888888       */
+/*   8       8   8           8 8     8     8      8        8    8               */
+/*  8            8           8  8    8     8      8        8    8               */
+/*  8            888888888   8   8   8     8      8        8     8888888        */
+/*  8      8888  8           8    8  8     8      8        8            8       */
+/*   8       8   8           8     8 8     8      8        8            8       */
+/*     888888    888888888  888     88   88888     88888888     88888888        */
+/*                                                                              */
+/*       A Three-Dimensional General Purpose Semiconductor Simulator.           */
+/*                                                                              */
+/*                                                                              */
+/*  Copyright (C) 2007-2008                                                     */
+/*  Cogenda Pte Ltd                                                             */
+/*                                                                              */
+/*  Please contact Cogenda Pte Ltd for license information                      */
+/*                                                                              */
+/*  Author: Gong Ding   gdiso@ustc.edu                                          */
+/*                                                                              */
+/********************************************************************************/
+
+#ifndef __fermi_table_h__
+#define __fermi_table_h__
+
+#include <cmath>
+
+#include "mathfunc.h"
+
+
+/**
+ * tabulated Fermi-Dirac integrals of order 1/2 and -1/2 (normalized as 1/Gamma(j+1) \int ...)
+ * together with the log(gamma) factor used by the Fermi statistics in the edge flux.
+ *
+ * each quantity is stored as values and first derivatives on a uniform grid and evaluated by
+ * cubic Hermite interpolation, so the returned derivative is exactly the derivative of the
+ * returned value (the AD overloads stay consistent with the residual).
+ * the tables are generated once from the integral definition by trapezoidal quadrature,
+ * relative error is below 2e-7 (the old analytic fits reach 0.4% for F1/2 and 1.2% for F-1/2).
+ * outside the range the two term Boltzmann / Sommerfeld expansions are used.
+ *
+ * the analytic approximations in mathfunc.h are still the default, tables are enabled
+ * per region by MODEL Fermi.Table=true
+ */
+class FermiTable
+{
+public:
+
+  /**
+   * 1/2 order Fermi-Dirac integral
+   */
+  static double fermi_half(double eta)
+  {
+    double y, dy;
+    _fermi_half(eta, y, dy);
+    return y;
+  }
+
+  /**
+   * AD version of fermi_half, derivative is fermi_mhalf of the same interpolant
+   */
+  static AutoDScalar fermi_half(const AutoDScalar &eta)
+  {
+    double y, dy;
+    _fermi_half(eta.getValue(), y, dy);
+    return _ad(y, dy, eta);
+  }
+
+  /**
+   * -1/2 order Fermi-Dirac integral
+   */
+  static double fermi_mhalf(double eta)
+  {
+    double y, dy;
+    _fermi_mhalf(eta, y, dy);
+    return y;
+  }
+
+  /**
+   * AD version of fermi_mhalf
+   */
+  static AutoDScalar fermi_mhalf(const AutoDScalar &eta)
+  {
+    double y, dy;
+    _fermi_mhalf(eta.getValue(), y, dy);
+    return _ad(y, dy, eta);
+  }
+
+  /**
+   * log(gamma), gamma = f/exp(eta) with f = F1/2(eta) the normalized carrier density,
+   * replaces log(gamma_f(f))
+   */
+  static double log_gamma(double f)
+  {
+    double y, dy;
+    _log_gamma(f, y, dy);
+    return y;
+  }
+
+  /**
+   * AD version of log_gamma
+   */
+  static AutoDScalar log_gamma(const AutoDScalar &f)
+  {
+    double y, dy;
+    _log_gamma(f.getValue(), y, dy);
+    return _ad(y, dy, f);
+  }
+
+private:
+
+  /// eta range and grid of the F1/2, F-1/2 tables
+  static const double _eta_min;
+  static const double _eta_max;
+  static const double _eta_inv_h;
+  static const unsigned int _n_eta;
+
+  /// log(f) range and grid of the log(gamma) table
+  static const double _u_min;
+  static const double _u_max;
+  static const double _u_inv_h;
+  static const unsigned int _n_u;
+
+  /**
+   * tables, stored as interleaved (value, h*derivative) pairs for each grid point
+   */
+  static double _half[];
+  static double _mhalf[];
+  static double _lgamma[];
+
+  /**
+   * cubic Hermite interpolation on table with given origin and 1/h, returns value and df/dx
+   */
+  static void _hermite(const double *table, double x0, double inv_h, double x, double &y, double &dy)
+  {
+    double s = (x - x0)*inv_h;
+    unsigned int i = static_cast<unsigned int>(s);
+    double t = s - i;
+    const double *p = table + 2*i;
+
+    double t2 = t*t;
+    double t3 = t2*t;
+    double h00 = 2*t3 - 3*t2 + 1;
+    double h10 = t3 - 2*t2 + t;
+    double h01 = 3*t2 - 2*t3;
+    double h11 = t3 - t2;
+
+    y  = h00*p[0] + h10*p[1] + h01*p[2] + h11*p[3];
+    dy = ((6*t2 - 6*t)*(p[0] - p[2]) + (3*t2 - 4*t + 1)*p[1] + (3*t2 - 2*t)*p[3])*inv_h;
+  }
+
+  static void _fermi_half(double eta, double &y, double &dy)
+  {
+    if(eta < _eta_min)
+    {
+      // F = e^eta - e^(2eta)/2^(3/2)
+      double z = exp(eta);
+      y  = z*(1.0 - 0.35355339059327379*z);
+      dy = z*(1.0 - 0.70710678118654752*z);
+      return;
+    }
+    if(eta >= _eta_max)
+    {
+      // Sommerfeld expansion F = 4/(3sqrt(pi)) eta^(3/2) (1 + pi^2/(8 eta^2))
+      double s = sqrt(eta);
+      y  = 4.0/(3.0*SQRTPI)*eta*s*(1.0 + PI*PI/(8.0*eta*eta));
+      dy = 2.0/SQRTPI*s*(1.0 - PI*PI/(24.0*eta*eta));
+      return;
+    }
+    _hermite(_half, _eta_min, _eta_inv_h, eta, y, dy);
+  }
+
+  static void _fermi_mhalf(double eta, double &y, double &dy)
+  {
+    if(eta < _eta_min)
+    {
+      double z = exp(eta);
+      y  = z*(1.0 - 0.70710678118654752*z);
+      dy = z*(1.0 - 1.41421356237309505*z);
+      return;
+    }
+    if(eta >= _eta_max)
+    {
+      double s = sqrt(eta);
+      y  = 2.0/SQRTPI*s*(1.0 - PI*PI/(24.0*eta*eta));
+      dy = 1.0/SQRTPI/s*(1.0 + PI*PI/(8.0*eta*eta));
+      return;
+    }
+    _hermite(_mhalf, _eta_min, _eta_inv_h, eta, y, dy);
+  }
+
+  static void _log_gamma(double f, double &y, double &dy)
+  {
+    if(f <= 0.0) { y = 0.0; dy = -0.35355339059327379; return; }
+
+    double u = log(f);
+    if(u < _u_min)
+    {
+      // gamma = 1 - f/2^(3/2) + ...
+      y  = f*(-0.35355339059327379 + 0.0049500897298752622*f);
+      dy = -0.35355339059327379 + 0.0099001794597505244*f;
+      return;
+    }
+    if(u >= _u_max)
+    {
+      // inverse of the Sommerfeld expansion
+      double a  = std::pow(0.75*SQRTPI*f, 4.0/3.0);
+      double eta = sqrt(a - PI*PI/6.0);
+      y  = u - eta;
+      dy = 1.0/f - 2.0*a/(3.0*f*eta);
+      return;
+    }
+    double dy_du;
+    _hermite(_lgamma, _u_min, _u_inv_h, u, y, dy_du);
+    dy = dy_du/f;
+  }
+
+  static AutoDScalar _ad(double y, double dy, const AutoDScalar &x)
+  {
+    AutoDScalar tmp;
+    tmp.setValue(y);
+    for (unsigned int i=0; i<AutoDScalar::numdir; ++i)
+      tmp.setADValue(i, dy*x.getADValue(i));
+    return tmp;
+  }
+
+  friend struct FermiTableInit;
+};
+
+
+/**
+ * log(gamma_f(x)), evaluated from FermiTable when table is true
+ */
+inline double log_gamma_f(double x, bool table)
+{ return table ? FermiTable::log_gamma(x) : log(gamma_f(x)); }
+
+/**
+ * AD version of log_gamma_f
+ */
+inline AutoDScalar log_gamma_f(const AutoDScalar &x, bool table)
+{ return table ? FermiTable::log_gamma(x) : log(gamma_f(x)); }
+
+#endif
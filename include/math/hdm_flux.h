@@ -111,6 +111,11 @@ class HDMVector
 
 
 // inline function for discrete hydrodynamic equation
+// they work on plain arrays and are compiled for the device as well when offloaded
+
+#ifdef HAVE_OPENMP_OFFLOAD
+#pragma omp declare target
+#endif
 
 /**
  * flux function for AUSM+ scheme
@@ -156,58 +161,81 @@ inline Real PPolynomial5neg(Real M)
 
 
 /**
- * AUSM+ flux at interface
+ * AUSM+ flux at interface on plain arrays, U1 and U2 hold (n, mnv_x, mnv_y, mnv_z)
  * @param U1 hydrodynamic variable at left
  * @param U2 hydrodynamic variable at right
  * @param m  mass of carrier
- * @param kt Kb*T, we don't consider carrier tempeature
- * @param norm the norm of interface from left to right
+ * @param kT Kb*T, we don't consider carrier tempeature
  * @param d  distance from left to right
  * @param S  control volumn surface area
- * @param dt max time step
- *
+ * @param norm the norm of interface from left to right
+ * @param flux the flux, 4 components
+ * @return max time step
  */
-inline HDMVector AUSM_if_flux(const HDMVector &U1, const HDMVector &U2,
-                              Real m, Real kT, Real d, Real S, const Point &norm, Real &dt)
+inline Real AUSM_if_flux(const Real *U1, const Real *U2,
+                         Real m, Real kT, Real d, Real S, const Real *norm, Real *flux)
 {
-  HDMVector flux;
-
-  Real  n1 = U1.density();  //
-  Real  v1 = U1.speed()/(m*n1);
+  Real  n1 = U1[0];
+  Real  v1 = sqrt(U1[1]*U1[1] + U1[2]*U1[2] + U1[3]*U1[3])/(m*n1);
   Real  p1 = kT*n1;
 
-  Real  n2 = U2.density();  //
-  Real  v2 = U2.speed()/(m*n2);
+  Real  n2 = U2[0];
+  Real  v2 = sqrt(U2[1]*U2[1] + U2[2]*U2[2] + U2[3]*U2[3])/(m*n2);
   Real  p2 = kT*n2;
 
   Real  a  = sqrt(5.0/3.0*kT/m);
 
-  dt=d/(a+std::max(v1,v2));
+  Real dt = d/(a + (v1>v2 ? v1 : v2));
 
-  Real M1 = (U1.velocity()*norm)/n1/m/a;
-  Real M2 = (U2.velocity()*norm)/n2/m/a;
+  Real M1 = (U1[1]*norm[0] + U1[2]*norm[1] + U1[3]*norm[2])/n1/m/a;
+  Real M2 = (U2[1]*norm[0] + U2[2]*norm[1] + U2[3]*norm[2])/n2/m/a;
 
   Real Mavg = 0.5*(M1*M1+M2*M2);
-  Real M  = MPolynomial4plus(M1) + MPolynomial4neg(M2)-std::max(1.0-0.8*Mavg,0.0)*(p2-p1)/(p2+p1);
+  Real Mc   = 1.0-0.8*Mavg;
+  Real M  = MPolynomial4plus(M1) + MPolynomial4neg(M2)-(Mc>0.0 ? Mc : 0.0)*(p2-p1)/(p2+p1);
   Real massflow  = M>0? a*M*n1: a*M*n2;
 
-  if(massflow > 0)
-  {
-    flux.set_density(massflow);
-    flux.set_velocity(U1.velocity()/n1*massflow);
-  }
-  else
-  {
-    flux.set_density(massflow);
-    flux.set_velocity(U2.velocity()/n2*massflow);
-  }
+  const Real *U = massflow > 0 ? U1 : U2;
+  flux[0] = massflow;
+  flux[1] = U[1]/U[0]*massflow;
+  flux[2] = U[2]/U[0]*massflow;
+  flux[3] = U[3]/U[0]*massflow;
 
   Real p =  PPolynomial5plus(M1)*p1 + PPolynomial5neg(M2)*p2
            -PPolynomial5plus(M1)*PPolynomial5neg(M2)*m*sqrt(n1*n2)*a*a*(M2-M1);
 
-  flux.add_velocity(p*norm);
-  flux *= S;
+  flux[1] += p*norm[0];
+  flux[2] += p*norm[1];
+  flux[3] += p*norm[2];
+  for(unsigned int n=0; n<4; ++n)
+    flux[n] *= S;
+
+  return dt;
+}
 
+#ifdef HAVE_OPENMP_OFFLOAD
+#pragma omp end declare target
+#endif
+
+
+/**
+ * AUSM+ flux at interface
+ * @param U1 hydrodynamic variable at left
+ * @param U2 hydrodynamic variable at right
+ * @param m  mass of carrier
+ * @param kt Kb*T, we don't consider carrier tempeature
+ * @param norm the norm of interface from left to right
+ * @param d  distance from left to right
+ * @param S  control volumn surface area
+ * @param dt max time step
+ *
+ */
+inline HDMVector AUSM_if_flux(const HDMVector &U1, const HDMVector &U2,
+                              Real m, Real kT, Real d, Real S, const Point &norm, Real &dt)
+{
+  HDMVector flux;
+  const Real n[3] = { norm(0), norm(1), norm(2) };
+  dt = AUSM_if_flux(&U1[0], &U2[0], m, kT, d, S, n, &flux[0]);
   return flux;
 }
 
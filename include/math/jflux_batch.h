@@ -0,0 +1,94 @@
+/********************************************************************************/
+/*     888888    888888888   88     888  88888   888      888    88888888       */
+/*   8       8   8           8 8     8     8      8        8    8               */
+/*  8            8           8  8    8     8      8        8    8               */
+/*  8            888888888   8   8   8     8      8        8     8888888        */
+/*  8      8888  8           8    8  8     8      8        8            8       */
+/*   8       8   8           8     8 8     8      8        8            8       */
+/*     888888    888888888  888     88   88888     88888888     88888888        */
+/*                                                                              */
+/*       A Three-Dimensional General Purpose Semiconductor Simulator.           */
+/*                                                                              */
+/*                                                                              */
+/*  Copyright (C) 2007-2008                                                     */
+/*  Cogenda Pte Ltd                                                             */
+/*                                                                              */
+/*  Please contact Cogenda Pte Ltd for license information                      */
+/*                                                                              */
+/*  Author: Gong Ding   gdiso@ustc.edu                                          */
+/*                                                                              */
+/********************************************************************************/
+
+#ifndef __jflux_batch_h__
+#define __jflux_batch_h__
+
+// S-G flux of jflux1.h with explicit derivatives, the batched versions work on
+// contiguous edge arrays and are vectorized by the compiler.
+
+#include "mathfunc.h"
+#include "bern_nb.h"
+// generated from src/math/jflux.jac by build/jacgen.py
+#include "jflux_jac.h"
+
+
+//-----------------------------------------------------------------------------
+// S-G electron/hole flux of jflux1.h, In_dd(Vt,dV,n1,n2,h) and Ip_dd(Vt,dV,p1,p2,h),
+// with the partial derivatives to dV and the two carrier densities.
+// the straight-line code is generated from the model definition in jflux.jac.
+
+inline void In_dd_grad(PetscScalar Vt, PetscScalar dV, PetscScalar n1, PetscScalar n2, PetscScalar h,
+                       PetscScalar &J, PetscScalar &dJ_dV, PetscScalar &dJ_dn1, PetscScalar &dJ_dn2)
+{
+  J = In_dd_jac(Vt, dV, n1, n2, h, dJ_dV, dJ_dn1, dJ_dn2);
+}
+
+inline void Ip_dd_grad(PetscScalar Vt, PetscScalar dV, PetscScalar p1, PetscScalar p2, PetscScalar h,
+                       PetscScalar &J, PetscScalar &dJ_dV, PetscScalar &dJ_dp1, PetscScalar &dJ_dp2)
+{
+  J = Ip_dd_jac(Vt, dV, p1, p2, h, dJ_dV, dJ_dp1, dJ_dp2);
+}
+
+/**
+ * AD version of In_dd by the chain rule on the explicit derivatives,
+ * cheaper than propagating the AD directions through bern().
+ * checked against the AD evaluation of the definition in DEBUG build
+ */
+inline AutoDScalar In_dd_grad(PetscScalar Vt, const AutoDScalar &dV, const AutoDScalar &n1, const AutoDScalar &n2, PetscScalar h)
+{
+  return In_dd_jac(Vt, dV, n1, n2, h);
+}
+
+/**
+ * AD version of Ip_dd by the chain rule on the explicit derivatives
+ */
+inline AutoDScalar Ip_dd_grad(PetscScalar Vt, const AutoDScalar &dV, const AutoDScalar &p1, const AutoDScalar &p2, PetscScalar h)
+{
+  return Ip_dd_jac(Vt, dV, p1, p2, h);
+}
+
+
+//-----------------------------------------------------------------------------
+// batched versions over \p size edges. input and output arrays are contiguous,
+// the derivative outputs may be 0 when not required.
+// built with AVX-512 and AVX2 clones selected at run time where the compiler supports it.
+
+/**
+ * b[i] = B(x[i]), db[i] = B'(x[i])
+ */
+extern void bern_batch(const unsigned int size, const PetscScalar *x, PetscScalar *b, PetscScalar *db);
+
+/**
+ * J[i] = In_dd(Vt, dV[i], n1[i], n2[i], h[i]) and its derivatives
+ */
+extern void In_dd_batch(const unsigned int size, const PetscScalar Vt,
+                        const PetscScalar *dV, const PetscScalar *n1, const PetscScalar *n2, const PetscScalar *h,
+                        PetscScalar *J, PetscScalar *dJ_dV=0, PetscScalar *dJ_dn1=0, PetscScalar *dJ_dn2=0);
+
+/**
+ * J[i] = Ip_dd(Vt, dV[i], p1[i], p2[i], h[i]) and its derivatives
+ */
+extern void Ip_dd_batch(const unsigned int size, const PetscScalar Vt,
+                        const PetscScalar *dV, const PetscScalar *p1, const PetscScalar *p2, const PetscScalar *h,
+                        PetscScalar *J, PetscScalar *dJ_dV=0, PetscScalar *dJ_dp1=0, PetscScalar *dJ_dp2=0);
+
+#endif // #define __jflux_batch_h__
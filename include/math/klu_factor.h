@@ -0,0 +1,128 @@
+/********************************************************************************/
+/*     888888    888888888   88     888  88888   888      888    88888888       */
+/*   8       8   8           8 8     8     8      8        8    8               */
+/*  8            8           8  8    8     8      8        8    8               */
+/*  8            888888888   8   8   8     8      8        8     8888888        */
+/*  8      8888  8           8    8  8     8      8        8            8       */
+/*   8       8   8           8     8 8     8      8        8            8       */
+/*     888888    888888888  888     88   88888     88888888     88888888        */
+/*                                                                              */
+/*       A Three-Dimensional General Purpose Semiconductor Simulator.           */
+/*                                                                              */
+/*                                                                              */
+/*  Copyright (C) 2007-2008                                                     */
+/*  Cogenda Pte Ltd                                                             */
+/*                                                                              */
+/*  Please contact Cogenda Pte Ltd for license information                      */
+/*                                                                              */
+/*  Author: Gong Ding   gdiso@ustc.edu                                          */
+/*                                                                              */
+/********************************************************************************/
+
+#ifndef __klu_factor_h__
+#define __klu_factor_h__
+
+#include <vector>
+
+#include "petscksp.h"
+#include "klu.h"
+
+
+/**
+ * sparse direct solver of a sequential AIJ matrix by the vendored KLU.
+ *
+ * KLU orders the matrix to block triangular form and factors each diagonal block
+ * with AMD ordering and partial pivoting, which is fast for the small fill-in of
+ * 2D meshes and the nearly triangular circuit rows of mixed mode.
+ * the ordering is computed once and kept as long as the nonzero pattern is not changed,
+ * later factorizations only call klu_refactor, which reuses the pivot sequence as well.
+ *
+ * KLU takes compressed columns. the CSR arrays of A are the CSC arrays of A^T,
+ * so A^T is factored and A x = b is solved by the transposed solve.
+ */
+class KLUFactor
+{
+public:
+
+  /**
+   * @param reuse_symbolic  keep the ordering and pivot sequence while the pattern is not changed
+   */
+  KLUFactor(bool reuse_symbolic=true);
+
+  ~KLUFactor();
+
+  /**
+   * factor A. the symbolic analysis is reused if A has the same pattern as the last one
+   */
+  void factor(Mat A);
+
+  /**
+   * solve A x = b with the last factor
+   */
+  void solve(Vec b, Vec x);
+
+  /**
+   * free the factor and the symbolic analysis
+   */
+  void clear();
+
+  /**
+   * number of full factorizations and numeric refactorizations done
+   */
+  unsigned int n_factor() const { return _n_factor; }
+  unsigned int n_refactor() const { return _n_refactor; }
+
+  /**
+   * make pc a shell preconditioner applying a KLU factor of its Pmat, the factor is owned by pc
+   */
+  static void set_pc_shell(PC pc, bool reuse_symbolic=true);
+
+private:
+
+  klu_common _common;
+
+  bool _reuse_symbolic;
+
+  klu_symbolic * _symbolic;
+
+  klu_numeric * _numeric;
+
+  /**
+   * the nonzero pattern the symbolic analysis belongs to
+   */
+  std::vector<int> _ap;
+  std::vector<int> _ai;
+
+  /**
+   * numeric values of the last factored matrix
+   */
+  std::vector<double> _ax;
+
+  /**
+   * rhs and solution buffer
+   */
+  std::vector<double> _b;
+
+  /**
+   * the AIJ copy of a block matrix
+   */
+  Mat _aij;
+
+  /**
+   * reciprocal pivot ratio of the last full factorization
+   */
+  double _rcond;
+
+  unsigned int _n_factor;
+  unsigned int _n_refactor;
+
+  /**
+   * load the pattern and values of A, @return true if the pattern is the same as before
+   */
+  bool _load(Mat A);
+
+  void _full_factor();
+};
+
+
+#endif // #define __klu_factor_h__
@@ -0,0 +1,85 @@
+/********************************************************************************/
+/*     888888    888888888   88     888  88888   888      888    88888888       */
+/*   8       8   8           8 8     8     8      8        8    8               */
+/*  8            8           8  8    8     8      8        8    8               */
+/*  8            888888888   8   8   8     8      8        8     8888888        */
+/*  8      8888  8           8    8  8     8      8        8            8       */
+/*   8       8   8           8     8 8     8      8        8            8       */
+/*     888888    888888888  888     88   88888     88888888     88888888        */
+/*                                                                              */
+/*       A Three-Dimensional General Purpose Semiconductor Simulator.           */
+/*                                                                              */
+/*                                                                              */
+/*  Copyright (C) 2007-2008                                                     */
+/*  Cogenda Pte Ltd                                                             */
+/*                                                                              */
+/*  Please contact Cogenda Pte Ltd for license information                      */
+/*                                                                              */
+/*  Author: Gong Ding   gdiso@ustc.edu                                          */
+/*                                                                              */
+/********************************************************************************/
+
+#ifndef __mat_node_ordering_h__
+#define __mat_node_ordering_h__
+
+#include <vector>
+#include <map>
+
+#include "petscmat.h"
+
+
+/**
+ * fill-reducing ordering of the direct solvers, computed by nested dissection
+ * on the mesh node graph instead of the dof graph.
+ *
+ * the node graph is much smaller than the matrix graph and each separator keeps the
+ * dofs of a node together, which gives less fill than ordering the dofs one by one.
+ * the permutation is registered to the jacobian matrix and returned to PETSc as the
+ * ordering type "genius_nd" each time the matrix is factorized.
+ */
+class MatNodeOrdering
+{
+public:
+
+  /**
+   * the name of the ordering registered to PETSc
+   */
+  static const char * type();
+
+  /**
+   * register the ordering type to PETSc, it is safe to call it more than once
+   * @return false if the PETSc version can not register user ordering
+   */
+  static bool register_type();
+
+  /**
+   * nested dissection of the graph in CSR format by METIS. the graph should have no self loop.
+   * the vertex weight vwgt can be empty.
+   * @return false if METIS is not available, order is the vertex at each position otherwise
+   */
+  static bool nested_dissection(std::vector<int> &xadj, std::vector<int> &adjncy, std::vector<int> &vwgt,
+                                std::vector<int> &order);
+
+  /**
+   * register the row/column permutation of A, perm[i] is the row of A at position i.
+   * perm should be kept until detach() is called
+   */
+  static void attach(Mat A, const std::vector<PetscInt> &perm);
+
+  /**
+   * remove the permutation of A, should be called before A is destroyed
+   */
+  static void detach(Mat A);
+
+  /**
+   * @return the permutation of A, NULL if none is attached
+   */
+  static const std::vector<PetscInt> * get(Mat A);
+
+private:
+
+  static std::map<Mat, const std::vector<PetscInt> *> _perms;
+};
+
+
+#endif // #define __mat_node_ordering_h__
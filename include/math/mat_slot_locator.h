@@ -0,0 +1,120 @@
+/********************************************************************************/
+/*     888888    888888888   88     888  88888   888      888    88888888       */
+/*   8       8   8           8 8     8     8      8        8    8               */
+/*  8            8           8  8    8     8      8        8    8               */
+/*  8            888888888   8   8   8     8      8        8     8888888        */
+/*  8      8888  8           8    8  8     8      8        8            8       */
+/*   8       8   8           8     8 8     8      8        8            8       */
+/*     888888    888888888  888     88   88888     88888888     88888888        */
+/*                                                                              */
+/*       A Three-Dimensional General Purpose Semiconductor Simulator.           */
+/*                                                                              */
+/*                                                                              */
+/*  Copyright (C) 2007-2008                                                     */
+/*  Cogenda Pte Ltd                                                             */
+/*                                                                              */
+/*  Please contact Cogenda Pte Ltd for license information                      */
+/*                                                                              */
+/*  Author: Gong Ding   gdiso@ustc.edu                                          */
+/*                                                                              */
+/********************************************************************************/
+
+#ifndef __mat_slot_locator_h__
+#define __mat_slot_locator_h__
+
+#include <vector>
+#include <map>
+#include <utility>
+
+#include "petscmat.h"
+
+
+/**
+ * locate the entries of an assembled AIJ matrix in its local value arrays.
+ *
+ * the nonzero pattern of jacobian matrix is fixed after the first assembly, so a kernel
+ * can look up the slot of each (row, col) it adds once, then scatter-add its values into
+ * the value arrays by add_values() instead of calling MatSetValues, which does a binary
+ * search in the row for each entry.
+ *
+ * slots of diagonal block come first, followed by the ones of off-diagonal block.
+ * only rows owned by this processor have slot.
+ */
+class MatSlotLocator
+{
+public:
+
+  /**
+   * build the locator of assembled matrix A and register it to A. BAIJ matrix has no locator
+   */
+  static void attach(Mat A);
+
+  /**
+   * remove the locator of A, should be called before A is destroyed
+   */
+  static void detach(Mat A);
+
+  /**
+   * @return the locator of A, NULL if none is attached
+   */
+  static const MatSlotLocator * get(Mat A);
+
+  /**
+   * a number unique to each locator ever built, kernels keep it with
+   * their slots to know the slots are stale
+   */
+  unsigned int serial() const
+  { return _serial; }
+
+  /**
+   * @return slot of entry (row, col), -1 if the row is not local or the entry is not in the pattern
+   */
+  PetscInt slot(PetscInt row, PetscInt col) const;
+
+  /**
+   * add v[i] to the entry at slot[i] of A, negative slot is skipped.
+   * A should be the matrix this locator attached to
+   */
+  void add_values(Mat A, unsigned int n, const PetscInt * slots, const PetscScalar * v) const;
+
+private:
+
+  MatSlotLocator(Mat A);
+
+  /**
+   * row range of this processor
+   */
+  PetscInt _row_begin, _row_end;
+
+  /**
+   * column range of diagonal block
+   */
+  PetscInt _col_begin, _col_end;
+
+  /**
+   * CSR of diagonal block, column index is local
+   */
+  std::vector<PetscInt> _diag_i, _diag_j;
+
+  /**
+   * CSR of off-diagonal block, column index is the compressed one
+   */
+  std::vector<PetscInt> _off_i, _off_j;
+
+  /**
+   * global column of each compressed column of off-diagonal block, sorted by the global column
+   */
+  std::vector< std::pair<PetscInt, PetscInt> > _off_cols;
+
+  unsigned int _serial;
+
+  /**
+   * the diagonal and off-diagonal block of A, Ao is NULL for sequential matrix
+   */
+  static void local_blocks(Mat A, Mat &Ad, Mat &Ao, const PetscInt * &colmap);
+
+  static std::map<Mat, MatSlotLocator *> _locators;
+};
+
+
+#endif // #define __mat_slot_locator_h__
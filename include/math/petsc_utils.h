@@ -175,9 +175,13 @@ namespace PetscUtils
    * @param  clear_rows the rows to be cleared
    *
    * @note   If mat is not assembled, this function will do it for you. the src row should on local processor.
+   *         Source and clear rows are read in one pass and the clear rows are cancelled by their own
+   *         negative values, which keeps their nonzero pattern and saves the MatZeroRows pass.
+   *         It falls back to MatAddRowToRow and MatZeroRows when a destination row is also cleared
+   *         or some rows are not local.
    *
    */
-  //extern PetscErrorCode  MatAddClearRow(Mat mat, std::vector<PetscInt> & src_rows, std::vector<PetscInt> & dst_rows, std::vector<PetscInt> & clear_rows);
+  extern PetscErrorCode  MatAddClearRow(Mat mat, std::vector<PetscInt> & src_rows, std::vector<PetscInt> & dst_rows, std::vector<PetscInt> & clear_rows);
 
   /**
    * @brief add real DenseVector to PetscVec by dof_indices
@@ -0,0 +1,112 @@
+/********************************************************************************/
+/*     888888    888888888   88     888  88888   888      888    88888888       */
+/*   8       8   8           8 8     8     8      8        8    8               */
+/*  8            8           8  8    8     8      8        8    8               */
+/*  8            888888888   8   8   8     8      8        8     8888888        */
+/*  8      8888  8           8    8  8     8      8        8            8       */
+/*   8       8   8           8     8 8     8      8        8            8       */
+/*     888888    888888888  888     88   88888     88888888     88888888        */
+/*                                                                              */
+/*       A Three-Dimensional General Purpose Semiconductor Simulator.           */
+/*                                                                              */
+/*                                                                              */
+/*  Copyright (C) 2007-2008                                                     */
+/*  Cogenda Pte Ltd                                                             */
+/*                                                                              */
+/*  Please contact Cogenda Pte Ltd for license information                      */
+/*                                                                              */
+/*  Author: Gong Ding   gdiso@ustc.edu                                          */
+/*                                                                              */
+/********************************************************************************/
+
+#ifndef __type_vector_dim_h__
+#define __type_vector_dim_h__
+
+#include <cmath>
+
+#include "type_vector.h"
+
+/**
+ * dimension specialized arithmetic of TypeVector. TypeVector always has 3 components,
+ * while the vectors of a 2D mesh lie on xy plane with zero z component. the cell kernels
+ * call these functions with the element dimension as template argument, so a 2D cell
+ * does not carry the zero z component through the field calculation.
+ * the result is the same as the corresponding TypeVector function.
+ */
+template <unsigned int Dim>
+struct TypeVectorDim;
+
+
+template <>
+struct TypeVectorDim<2>
+{
+  /**
+   * @return a*b
+   */
+  template <typename T>
+  static T dot(const TypeVector<T> &a, const TypeVector<T> &b)
+  { return a(0)*b(0) + a(1)*b(1); }
+
+  /**
+   * @return |a|
+   */
+  template <typename T>
+  static T size(const TypeVector<T> &a)
+  { using std::sqrt; return sqrt(a(0)*a(0) + a(1)*a(1)); }
+
+  /**
+   * @return |a x b|, only z component of the cross product is nonzero
+   */
+  template <typename T>
+  static T cross_size(const TypeVector<T> &a, const TypeVector<T> &b)
+  { using std::fabs; return fabs(a(0)*b(1) - a(1)*b(0)); }
+};
+
+
+template <>
+struct TypeVectorDim<3>
+{
+  template <typename T>
+  static T dot(const TypeVector<T> &a, const TypeVector<T> &b)
+  { return a(0)*b(0) + a(1)*b(1) + a(2)*b(2); }
+
+  template <typename T>
+  static T size(const TypeVector<T> &a)
+  { using std::sqrt; return sqrt(a(0)*a(0) + a(1)*a(1) + a(2)*a(2)); }
+
+  template <typename T>
+  static T cross_size(const TypeVector<T> &a, const TypeVector<T> &b)
+  {
+    using std::sqrt;
+    const T cx = a(1)*b(2) - a(2)*b(1);
+    const T cy = a(2)*b(0) - a(0)*b(2);
+    const T cz = a(0)*b(1) - a(1)*b(0);
+    return sqrt(cx*cx + cy*cy + cz*cz);
+  }
+};
+
+
+/**
+ * @return a * b.unit(true), the projection of \p a on the direction of \p b
+ */
+template <unsigned int Dim, typename T>
+inline T dot_unit_dim(const TypeVector<T> &a, const TypeVector<T> &b)
+{
+  const T length = TypeVectorDim<Dim>::size(b);
+  if( length == 0.0 ) return T(0.0);
+  return TypeVectorDim<Dim>::dot(a, b)/length;
+}
+
+
+/**
+ * @return (a.cross(b.unit(true))).size(), the component of \p a vertical to \p b
+ */
+template <unsigned int Dim, typename T>
+inline T cross_unit_size_dim(const TypeVector<T> &a, const TypeVector<T> &b)
+{
+  const T length = TypeVectorDim<Dim>::size(b);
+  if( length == 0.0 ) return T(0.0);
+  return TypeVectorDim<Dim>::cross_size(a, b)/length;
+}
+
+#endif // #define __type_vector_dim_h__
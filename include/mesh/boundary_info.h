@@ -380,6 +380,53 @@ public:
    */
   void rebuild_ids();
 
+  /**
+   * approx memory usage, the node and side to boundary id maps dominate
+   */
+  size_t memory_size() const;
+
+  /**
+   * build the CSR index of the boundary nodes and active boundary sides by boundary id.
+   * the queries below build it on first use, any change of the boundary data drops it.
+   */
+  void build_index() const;
+
+  /**
+   * drop the CSR index. mesh refinement calls it since the active sides change
+   */
+  void invalidate_index() const
+  { _index_valid = false; }
+
+  /**
+   * @return the number of nodes with \p boundary_id
+   */
+  unsigned int n_nodes_with_boundary_id(short int boundary_id) const
+  {
+    const int slot = index_slot(boundary_id);
+    return slot < 0 ? 0 : _index_node_offset[slot+1] - _index_node_offset[slot];
+  }
+
+  /**
+   * @return the ith node with \p boundary_id, the nodes are in the order of node id
+   */
+  const Node * node_with_boundary_id(short int boundary_id, unsigned int i) const
+  { return _index_nodes[_index_node_offset[index_slot(boundary_id)] + i]; }
+
+  /**
+   * @return the number of active element sides with \p boundary_id
+   */
+  unsigned int n_active_sides_with_boundary_id(short int boundary_id) const
+  {
+    const int slot = index_slot(boundary_id);
+    return slot < 0 ? 0 : _index_side_offset[slot+1] - _index_side_offset[slot];
+  }
+
+  /**
+   * @return the ith active element side with \p boundary_id as (elem, side)
+   */
+  const std::pair<const Elem *, unsigned int> & active_side_with_boundary_id(short int boundary_id, unsigned int i) const
+  { return _index_sides[_index_side_offset[index_slot(boundary_id)] + i]; }
+
 
   /**
    * Number used for internal use. This is the return value
@@ -443,6 +490,43 @@ public:
    */
   std::vector<std::string> _extra_descriptions;
 
+  /**
+   * @return the slot of \p boundary_id in the CSR index, -1 if it has no node or side
+   */
+  int index_slot(short int boundary_id) const
+  {
+    if (!_index_valid) build_index();
+    const int i = static_cast<int>(boundary_id) - _index_min_id;
+    return (i < 0 || i >= static_cast<int>(_index_slot.size())) ? -1 : _index_slot[i];
+  }
+
+  /**
+   * the CSR index is valid
+   */
+  mutable bool _index_valid;
+
+  /**
+   * the smallest boundary id in the CSR index
+   */
+  mutable int _index_min_id;
+
+  /**
+   * boundary id - _index_min_id to slot, -1 for unused id
+   */
+  mutable std::vector<int> _index_slot;
+
+  /**
+   * nodes of slot s are _index_nodes[_index_node_offset[s], _index_node_offset[s+1])
+   */
+  mutable std::vector<unsigned int> _index_node_offset;
+  mutable std::vector<const Node *> _index_nodes;
+
+  /**
+   * active sides of slot s are _index_sides[_index_side_offset[s], _index_side_offset[s+1])
+   */
+  mutable std::vector<unsigned int> _index_side_offset;
+  mutable std::vector<std::pair<const Elem *, unsigned int> > _index_sides;
+
 
 
 //   /**
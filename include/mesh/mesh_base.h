@@ -27,6 +27,8 @@
 // C++ Includes   -----------------------------------
 #include <string>
 #include <map>
+#include <vector>
+#include <algorithm>
 
 // forward declarations
 class Elem;
@@ -375,10 +377,18 @@ public:
 
 
   /**
-   * reorder the elems index by Reverse Cuthill-McKee Algorithm
-   * which can reduce filling in LU (ILU) Factorization
+   * the ordering of elems (and the nodes followed) used by \p reorder_elems()
+   * BFS_ORDER    -- Breadth-First Search from the lower left corner
+   * RCM_ORDER    -- Reverse Cuthill-McKee, neighbors visited by increasing degree
+   * MORTON_ORDER -- elem centroid along Morton space filling curve
+   */
+  enum ElemOrdering {BFS_ORDER, RCM_ORDER, MORTON_ORDER};
+
+  /**
+   * reorder the elems index by given ordering, the nodes are numbered
+   * along the elem order, which can reduce filling in LU (ILU) Factorization
    */
-  virtual void reorder_elems () {}
+  virtual void reorder_elems (ElemOrdering /* ordering */ = BFS_ORDER) {}
 
 
   /**
@@ -507,6 +517,28 @@ public:
   int subdomain_weight(unsigned int id) const
   { genius_assert(id<_subdomain_materials.size()); return (*_subdomain_weight.find(id)).second; }
 
+  /**
+   * set the dof weight of subdomain, the partitioner balances both the (assembly cost)
+   * weight and dof weight when any dof weight is set
+   */
+  void set_subdomain_dof_weight(unsigned int id, int weight)
+  { genius_assert(id<_subdomain_materials.size()); _subdomain_dof_weight[id] = weight; }
+
+  /**
+   * @return subdomain dof weight by subdomain id, 1 if not set
+   */
+  int subdomain_dof_weight(unsigned int id) const
+  {
+    std::map<unsigned int, int>::const_iterator it = _subdomain_dof_weight.find(id);
+    return it != _subdomain_dof_weight.end() ? it->second : 1;
+  }
+
+  /**
+   * @return true if the partitioner should balance dof weight as the second constraint
+   */
+  bool multi_constraint_partition() const
+  { return !_subdomain_dof_weight.empty(); }
+
   /**
    * the subdomain interconnect graph
    */
@@ -620,6 +652,44 @@ public:
    */
   const Elem * element_have_point(const Point & p);
 
+  /**
+   * contiguous views of the active elements, in the order of element id.
+   * hot loops traverse them instead of the predicate filtered element iterators.
+   * they are built on first use and dropped by any change of the elements or
+   * of their processor id, see clear_elem_ranges().
+   */
+  const std::vector<Elem *> & active_elem_range () const
+  { if (!_elem_ranges_valid) build_elem_ranges(); return _active_elem_range; }
+
+  /**
+   * active elements on this processor, as active_this_pid_elements_begin()
+   */
+  const std::vector<Elem *> & active_this_pid_elem_range () const
+  { if (!_elem_ranges_valid) build_elem_ranges(); return _active_this_pid_elem_range; }
+
+  /**
+   * active elements on this processor and its ghost elements, as local_elements_begin(),
+   * grouped by subdomain and in the order of element id within each subdomain
+   */
+  const std::vector<Elem *> & local_elem_range () const
+  { if (!_elem_ranges_valid) build_elem_ranges(); return _local_elem_range; }
+
+  /**
+   * local elements of subdomain \p sbd are
+   * local_elem_range()[local_subdomain_elem_offset(sbd), local_subdomain_elem_offset(sbd+1))
+   */
+  unsigned int local_subdomain_elem_offset (unsigned int sbd) const
+  {
+    if (!_elem_ranges_valid) build_elem_ranges();
+    return _local_subdomain_elem_offset[std::min<unsigned int>(sbd, _local_subdomain_elem_offset.size()-1)];
+  }
+
+  /**
+   * drop the element ranges, they are rebuilt on next use
+   */
+  void clear_elem_ranges () const
+  { _elem_ranges_valid = false; }
+
 public:
 
 
@@ -784,6 +854,11 @@ protected:
    */
   std::map<unsigned int, int> _subdomain_weight;
 
+  /**
+   * the dof weight factor for each subdomain, used by multi-constraint partition
+   */
+  std::map<unsigned int, int> _subdomain_dof_weight;
+
 
   /**
    * The number of partitions the mesh has.  This is set by
@@ -826,6 +901,24 @@ protected:
    */
   mutable AutoPtr<SurfaceLocatorHub> _surface_locator;
 
+  /**
+   * fill the element ranges
+   */
+  void build_elem_ranges () const;
+
+  /**
+   * the element ranges are up to date
+   */
+  mutable bool _elem_ranges_valid;
+
+  /**
+   * element ranges, local ones are sorted by subdomain with offsets
+   */
+  mutable std::vector<Elem *> _active_elem_range;
+  mutable std::vector<Elem *> _active_this_pid_elem_range;
+  mutable std::vector<Elem *> _local_elem_range;
+  mutable std::vector<unsigned int> _local_subdomain_elem_offset;
+
   /**
    * The partitioner class is a friend so that it can set
    * the number of partitions.
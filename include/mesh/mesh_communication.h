@@ -114,8 +114,19 @@ private:
    * Packs the element \p elem at the end of vector \p conn.
    * This includes all the information needed to rebuild the element
    * on a remote processor, including refinement state.
+   * the entries are delta coded to the entries of the previous element kept in \p last
    */
-  void pack_element (std::vector<int> &conn, const Elem* elem) const;
+  void pack_element (std::vector<unsigned char> &conn, const Elem* elem, std::vector<int> &last) const;
+
+  /**
+   * Packs the node locations into \p pts and the elements level by level into \p conn
+   */
+  void pack_mesh (const MeshBase& mesh, std::vector<Real> &pts, std::vector<unsigned char> &conn) const;
+
+  /**
+   * hash of the packed mesh and the subdomain information
+   */
+  unsigned long long mesh_checksum (const MeshBase& mesh, const std::vector<Real> &pts, const std::vector<unsigned char> &conn) const;
 };
 
 
@@ -185,6 +185,37 @@ public:
 				     const Real coarsen_fraction = 0.0,
 				     const unsigned int max_level = invalid_uint);
 
+  /**
+   * Parallel version of \p flag_elements_by_error_fraction.
+   * \p error_per_cell only needs the entries of active elements
+   * belonging to this processor. The cutoffs are computed by global
+   * reduction, each processor flags its own elements and the flags
+   * are synchronized to all the processors at last.
+   * Coarsening by parents is not supported.
+   */
+  void flag_local_elements_by_error_fraction (const ErrorVector& error_per_cell,
+					      const Real refine_fraction  = 0.3,
+					      const Real coarsen_fraction = 0.0,
+					      const unsigned int max_level = invalid_uint);
+
+  /**
+   * Parallel version of \p flag_elements_by_elem_fraction.
+   * The error of the top/bottom element is searched by bisection
+   * with global counting, no error value is gathered.
+   */
+  void flag_local_elements_by_elem_fraction (const ErrorVector& error_per_cell,
+					     const Real refine_fraction  = 0.3,
+					     const Real coarsen_fraction = 0.0,
+					     const unsigned int max_level = invalid_uint);
+
+  /**
+   * Parallel version of \p flag_elements_by_error_threshold.
+   */
+  void flag_local_elements_by_error_threshold (const ErrorVector& error_per_cell,
+					       const Real refine_threshold,
+					       const Real coarsen_threshold,
+					       const unsigned int max_level = invalid_uint);
+
   /**
    * Takes a mesh whose elements are flagged for h refinement and coarsening,
    * and switches those flags to request p refinement and coarsening instead.
@@ -580,6 +611,17 @@ private:
    * for each element in the mesh.
    */
   void clean_refinement_flags ();
+
+  /**
+   * Copy the refinement flag of each active element from its
+   * owner processor to all the processors.
+   */
+  void sync_refinement_flags ();
+
+  /**
+   * @returns the k-th largest value of \p values over all the processors
+   */
+  static Real parallel_kth_largest (const std::vector<Real>& values, const unsigned int k);
   
   /**
    * Take user-specified coarsening flags and augment them
@@ -98,6 +98,42 @@ namespace MeshTools
    */
   void find_boundary_nodes (const MeshBase& mesh, std::vector<bool>& on_boundary);
 
+  /**
+   * Computes the bandwidth and profile (sum of the row bandwidth) of
+   * the nodal connection matrix by node id, coupling all the nodes of an element.
+   * It measures the locality of the node ordering.
+   */
+  void node_bandwidth (const MeshBase& mesh, unsigned int & bandwidth, double & profile);
+
+  /**
+   * Element quality and FVM validity statistics of the mesh.
+   * The angles are in degree and measured at the corners of the element faces.
+   */
+  struct ElemQualityStatistics
+  {
+    /// number of active elements examined
+    unsigned int n_elem;
+    /// longest to shortest edge ratio (ASPECT_RATIO)
+    Real aspect_ratio_min, aspect_ratio_max, aspect_ratio_mean;
+    /// extremum of corner angles (MIN_ANGLE / MAX_ANGLE)
+    Real min_angle, max_angle;
+    /// smallest and largest element size (CELL_SIZE)
+    Real hmin, hmax;
+    /// elements with non-positive volume (JACOBIAN)
+    unsigned int n_inverted;
+    /// elements with obtuse angle, the circumcenter lies outside
+    unsigned int n_obtuse;
+    /// FVM elements with negative partial CV area on some edge, which violates the Delaunay property
+    unsigned int n_negative_cv;
+  };
+
+  /**
+   * Gathers the quality statistics of the local active elements in one pass
+   * and reduces them over all the processors.
+   * The elements are processed in parallel with thread-local accumulation.
+   */
+  void elem_quality (const MeshBase& mesh, ElemQualityStatistics & stat);
+
   /**
    * @returns two points defining a cartesian box that bounds the
    * mesh.  The first entry in the pair is the mininum, the second
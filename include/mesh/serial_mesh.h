@@ -197,7 +197,7 @@ class SerialMesh : public UnstructuredMesh
   /**
    * functions for reordering elems
    */
-  virtual void reorder_elems();
+  virtual void reorder_elems(ElemOrdering ordering = BFS_ORDER);
 
   /**
    * functions for reordering nodes
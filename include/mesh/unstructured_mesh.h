@@ -111,9 +111,15 @@ class UnstructuredMesh : public MeshBase
   void subdomain_cluster(const std::vector<std::vector<unsigned int> > &cluster)
   { _subdomain_cluster = cluster; }
 
+  /**
+   * the elems touch the nodes of these boundaries are partitioned into the same block
+   */
+  void boundary_cluster(const std::vector<short int> &boundary_ids)
+  { _boundary_cluster = boundary_ids; }
+
   /**
    * build the partition cluster, the elems belongs to the same cluster will be partitioned into the same block
-   * here set subdomain with metal material as cluster
+   * here set subdomain with metal material as cluster, and the elems of boundary cluster
    */
   virtual void partition_cluster(std::vector<std::vector<unsigned int> > &);
 
@@ -146,6 +152,8 @@ private:
 
   std::vector< std::vector<unsigned int> > _subdomain_cluster;
 
+  std::vector<short int> _boundary_cluster;
+
 };
 
 
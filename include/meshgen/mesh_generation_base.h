@@ -26,6 +26,7 @@
 #ifndef __mesh_generation_base_h__
 #define __mesh_generation_base_h__
 
+#include "genius_env.h"
 #include "mesh_base.h"
 #include "mesh_modification.h"
 #include "mesh_refinement.h"
@@ -54,6 +55,18 @@ public:
    */
   virtual int do_refine(MeshRefinement & )=0;
 
+  /**
+   * refine existing mesh, collective on all the processors.
+   * the refine flags are only valid on processor 0, and the new mesh is only
+   * built on processor 0. The default one simply calls do_refine on processor 0
+   */
+  virtual int do_refine_parallel(MeshRefinement & mesh_refinement)
+  {
+    if ( Genius::processor_id() == 0 )
+      return this->do_refine(mesh_refinement);
+    return 0;
+  }
+
   /**
    * @return mesh generator magic number
    */
@@ -70,6 +70,14 @@ public:
    */
   int do_refine(MeshRefinement &);
 
+  /**
+   * refine existing mesh, collective on all the processors.
+   * the refined mesh is broadcasted and each processor triangulates a part of the regions
+   * with the region boundary kept unchanged, so the region interfaces stay conforming.
+   * at last, the new mesh is assembled on processor 0
+   */
+  int do_refine_parallel(MeshRefinement &);
+
 
   /**
    * return megh generator magic munber
@@ -169,6 +177,15 @@ private:
    */
   int  get_bc_id(const Elem *elem, int p1, int p2);
 
+  /**
+   * triangulate region r of current mesh with its boundary segments fixed.
+   * the new points are appended to steiner_points as (x,y) pairs.
+   * each triangle is appended to tri_data as (region, node0, node1, node2, bc0, bc1, bc2),
+   * where node index less than _mesh.n_nodes() is the id of old mesh node, else
+   * it is _mesh.n_nodes() + index in steiner_points. bc is BoundaryInfo::invalid_id for inner side.
+   */
+  void triangulate_region(unsigned int r, std::vector<double> & steiner_points, std::vector<int> & tri_data);
+
   /**
    * set user defined boundary face (segment in 2D), user should give a label to these faces
    */
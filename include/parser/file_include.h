@@ -54,9 +54,10 @@ public:
   void file_include( const char * filename );
 
   /**
-   * dump file processed by preprocessor
+   * dump file processed by preprocessor as filename.pp
+   * with optional suffix appended to the file name
    */
-  std::string output();
+  std::string output(const std::string &suffix="");
 };
 
 }
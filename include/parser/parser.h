@@ -25,6 +25,7 @@
 #define __parser_h_
 
 // C++ header file
+#include <cstdio>
 #include <stack>
 #include <list>
 
@@ -48,6 +49,23 @@ namespace Parser
      */
     int read_card_file(const char *filename);
 
+    /**
+     * read card from an opened stream, the stream is closed after read
+     */
+    int read_card_file(FILE *fp);
+
+    /**
+     * save the validated cards to binary file, stamp identifies the input deck and pattern
+     * @returns zero if successful
+     */
+    int save_cards(const std::string &fname, const std::string &stamp) const;
+
+    /**
+     * read the cards saved by save_cards(), no parse and pattern check is needed
+     * @returns zero if successful, nonzero if the file is missing, broken or its stamp differs
+     */
+    int load_cards(const std::string &fname, const std::string &stamp);
+
     /**
      * card search begin
      */
@@ -331,6 +331,17 @@ namespace Parser
     { _key = key; }
 
 
+    /**
+     * write the card to binary stream
+     */
+    void write_binary(std::ostream &out) const;
+
+    /**
+     * read the card from binary stream
+     * @return false if the stream is broken
+     */
+    bool read_binary(std::istream &in);
+
     /**
      * clear all the information
      */
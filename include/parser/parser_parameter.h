@@ -239,6 +239,17 @@ namespace Parser
     { return _do_not_check_me; }
 
 
+    /**
+     * write the parameter to binary stream
+     */
+    void write_binary(std::ostream &out) const;
+
+    /**
+     * read the parameter from binary stream
+     * @return false if the stream is broken
+     */
+    bool read_binary(std::istream &in);
+
     typedef std::set<std::string>::const_iterator StringEnumIterator;
     StringEnumIterator stringPatternBegin() const { return _string_pattern.begin(); }
     StringEnumIterator stringPatternEnd() const { return _string_pattern.end(); }
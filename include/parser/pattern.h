@@ -28,6 +28,21 @@
 
 namespace Parser
 {
+
+  /**
+   * @return size and modification time of file as a string, empty if file can't be stat
+   */
+  extern std::string file_stamp(const std::string &fname);
+
+  /**
+   * @return hash of the file content as a hex string, empty if file can't be read
+   */
+  extern std::string file_digest(const std::string &fname);
+
+  /**
+   * @return hash of \p size bytes at \p data as a hex string, same as file_digest of a file with this content
+   */
+  extern std::string data_digest(const char *data, size_t size);
   /**
    * The pattern of Card, read from file
    */
@@ -154,6 +169,19 @@ namespace Parser
      * @returns zero if successful
      */
     int get_from_XML(const std::string &);
+
+    /**
+     * save pattern to binary image, which is read much faster than xml file.
+     * stamp identifies the xml file the pattern comes from
+     * @returns zero if successful
+     */
+    int save_to_binary(const std::string &fname, const std::string &stamp) const;
+
+    /**
+     * read pattern from binary image saved by save_to_binary()
+     * @returns zero if successful, nonzero if the image is missing, broken or its stamp differs
+     */
+    int get_from_binary(const std::string &fname, const std::string &stamp);
   };
 
 }
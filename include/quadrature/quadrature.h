@@ -26,6 +26,7 @@
 #include <vector>
 #include <string>
 #include <utility>
+#include <map>
 
 // Local includes
 #include "genius_common.h"
@@ -322,6 +323,13 @@ protected:
    * The value of the quadrature weights.
    */
   std::vector<Real> _weights;
+
+  /**
+   * The points and weights of the element types met so far,
+   * keyed by element type and p level, so that meshes of mixed
+   * element types do not rebuild the rule at each type change.
+   */
+  std::map<std::pair<ElemType, unsigned int>, std::pair<std::vector<Point>, std::vector<Real> > > _rule_cache;
 };
 
 
@@ -56,14 +56,19 @@ struct AdvancedModel
     DIRTunneling = false;
     FNTunneling = false;
     BandBandTunneling = false;
+    BandBandTunnelingNonlocal = false;
+    BBTNonlocalDPsi = 0.0;
+    BBTNonlocalMaxLength = 0.0;
 
     ImpactIonization = false;
     II_Force = ModelSpecify::GradQf;
 
     Fermi=false;
+    FermiTable=false;
     IncompleteIonization=false;
 
     Trap=false;
+    TrapExplicit=false;
 
     QNFactor = 1.0;
     QPFactor = 1.0;
@@ -154,6 +159,22 @@ struct AdvancedModel
    */
   bool    BandBandTunneling;
 
+  /**
+   * specify if nonlocal band band tunneling along the field line should be supported
+   */
+  bool    BandBandTunnelingNonlocal;
+
+  /**
+   * the tunneling paths of nonlocal band band tunneling are rebuilt when
+   * the potential of any node changes more than this value
+   */
+  double  BBTNonlocalDPsi;
+
+  /**
+   * the max length of a nonlocal band band tunneling path
+   */
+  double  BBTNonlocalMaxLength;
+
 
   //-----------------------------------------------------------
   // parameters for impact ionization
@@ -179,6 +200,11 @@ struct AdvancedModel
    */
   bool    Fermi;
 
+  /**
+   * evaluate the Fermi-Dirac integrals from FermiTable instead of the analytic fits
+   */
+  bool    FermiTable;
+
   /**
    * specify if Incomplete Ionization should be supported
    */
@@ -193,6 +219,12 @@ struct AdvancedModel
    */
   bool    Trap;
 
+  /**
+   * advance trap occupancy explicitly after each converged step instead of
+   * solving it with the carriers. Trapped charge is frozen during Newton iteration.
+   */
+  bool    TrapExplicit;
+
   //------------------------------------------------------
   // parameters for DG-DDM simulation
   //------------------------------------------------------
@@ -77,8 +77,43 @@ public:
    */
   virtual void write (const std::string& );
 
+  /**
+   * let every processor open and read the cgns file by itself
+   * instead of reading on processor 0 and broadcasting the mesh.
+   * the file must be visible to all the processors, i.e. on a shared file system
+   */
+  void set_parallel_read(bool flag)
+  { _parallel_read = flag; }
+
+  /**
+   * digest of the last written solution array, indexed by "region/variable"
+   */
+  typedef std::map<std::string, unsigned long> SolutionDigest;
+
+  /**
+   * append the point based scalar solutions as a new FlowSolution node
+   * named sol_name to an existing cgns file written by write().
+   * an array is only written when it changed since the last append, which
+   * is tracked by the digest. when single_precision is true, data is written as float32
+   */
+  void append_solution(const std::string & filename, const std::string & sol_name,
+                       bool single_precision, SolutionDigest & digest);
+
+  /**
+   * write the time values and the FlowSolution names of each step,
+   * so that postprocessors recognize the appended solutions as a time series
+   */
+  void write_time_series(const std::string & filename, const std::vector<double> & time,
+                         const std::vector<std::string> & sol_name);
+
 
 private:
+
+  /**
+   * all the processors read the cgns file
+   */
+  bool _parallel_read;
+
 // some id for cgns file read/write
 
   /**
@@ -180,7 +215,8 @@ private:
 inline
 CGNSIO::CGNSIO (SimulationSystem& system) :
 	FieldInput<SimulationSystem> (system),
-	FieldOutput<SimulationSystem> (system)
+	FieldOutput<SimulationSystem> (system),
+	_parallel_read(false)
 {
 
 }
@@ -189,7 +225,8 @@ CGNSIO::CGNSIO (SimulationSystem& system) :
 
 inline
 CGNSIO::CGNSIO (const SimulationSystem& system) :
-	FieldOutput<SimulationSystem>(system)
+	FieldOutput<SimulationSystem>(system),
+	_parallel_read(false)
 {
 
 }
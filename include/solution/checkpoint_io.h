@@ -0,0 +1,97 @@
+/********************************************************************************/
+/*     888888    888888888   88     888  88888   888      888    88888888       */
+/*   8       8   8           8 8     8     8      8        8    8               */
+/*  8            8           8  8    8     8      8        8    8               */
+/*  8            888888888   8   8   8     8      8        8     8888888        */
+/*  8      8888  8           8    8  8     8      8        8            8       */
+/*   8       8   8           8     8 8     8      8        8            8       */
+/*     888888    888888888  888     88   88888     88888888     88888888        */
+/*                                                                              */
+/*       A Three-Dimensional General Purpose Semiconductor Simulator.           */
+/*                                                                              */
+/*                                                                              */
+/*  Copyright (C) 2007-2008                                                     */
+/*  Cogenda Pte Ltd                                                             */
+/*                                                                              */
+/*  Please contact Cogenda Pte Ltd for license information                      */
+/*                                                                              */
+/*  Author: Gong Ding   gdiso@ustc.edu                                          */
+/*                                                                              */
+/********************************************************************************/
+
+
+#ifndef __checkpoint_io_h__
+#define __checkpoint_io_h__
+
+
+// Local includes
+#include "genius_common.h"
+#include "field_input.h"
+#include "field_output.h"
+#include "simulation_system.h"
+
+
+
+/**
+ * This class write/read a binary checkpoint of the simulation system.
+ * Each processor writes its own file which contains the raw node/cell data
+ * blocks of all the regions, the transient clock and time step history,
+ * and the state of the electrode external circuits.
+ * The mesh and control volumes are not stored: the checkpoint is loaded into
+ * a system built from the same mesh with the same processor number,
+ * and the data blocks are copied back without reinit_after_import().
+ */
+class CheckpointIO : public FieldInput<SimulationSystem>,
+      public FieldOutput<SimulationSystem>
+{
+public:
+  /**
+   * Constructor.  Takes a writeable reference to a system object.
+   * This is the constructor required to read a checkpoint.
+   */
+  CheckpointIO (SimulationSystem& system);
+
+  /**
+   * Constructor.  Takes a read-only reference to a system object.
+   * This is the constructor required to write a checkpoint.
+   */
+  CheckpointIO (const SimulationSystem& system);
+
+  /**
+   * read checkpoint
+   */
+  virtual void read (const std::string&);
+
+  /**
+   * write checkpoint
+   */
+  virtual void write (const std::string&);
+
+private:
+
+  /**
+   * the file name of local processor
+   */
+  static std::string _local_file_name(const std::string & filename);
+};
+
+
+// ------------------------------------------------------------
+// CheckpointIO inline members
+inline
+CheckpointIO::CheckpointIO (SimulationSystem& system) :
+    FieldInput<SimulationSystem> (system),
+    FieldOutput<SimulationSystem> (system)
+{
+}
+
+
+
+inline
+CheckpointIO::CheckpointIO (const SimulationSystem& system) :
+    FieldOutput<SimulationSystem>(system)
+{
+}
+
+#endif // #define __checkpoint_io_h__
+
@@ -25,6 +25,8 @@
 #define __device_solver_control_h__
 
 
+#include <set>
+
 #include "auto_ptr.h"
 #include "mesh.h"
 #include "mesh_generation.h"
@@ -139,6 +141,45 @@ public:
    */
   int  do_solve   ( const Parser::Card & c );
 
+  /**
+   * build the solver of a "SOLVE" card and keep it alive. the dof map, jacobian pattern
+   * and preconditioner are reused by each run_solver() call, until close_solver().
+   * only the control hook is loaded, solutions are recorded to the solution dom.
+   * @note SolverSpecify is shared, the other solve commands close the open solver
+   */
+  int  open_solver ( const Parser::Card & c );
+
+  /**
+   * solve again with the open solver, warm started from the current solution
+   */
+  int  run_solver ();
+
+  /**
+   * destroy the open solver
+   */
+  int  close_solver ();
+
+  /**
+   * @return true when a solver is kept by open_solver()
+   */
+  bool has_open_solver () const { return _open_solver.get() != NULL; }
+
+  /**
+   * attach a DC voltage (in V) to electrode, used by the next run_solver()
+   */
+  int  set_electrode_voltage ( const std::string & electrode, double v );
+
+  /**
+   * attach a DC current (in A) to electrode, used by the next run_solver()
+   */
+  int  set_electrode_current ( const std::string & electrode, double i );
+
+  /**
+   * change a real parameter of boundary condition in place, i.e. workfunction or heat.transfer.
+   * the value is in genius internal unit, i.e. workfunction in V is scaled by PhysicalUnit::V
+   */
+  int  set_bc_parameter ( const std::string & bc_label, const std::string & name, double value );
+
   /**
    * process and do "EXPORT" card
    */
@@ -190,6 +231,27 @@ public:
    */
   int  do_refine_uniform  ( const Parser::Card & c );
 
+  /**
+   * nested iteration of "SOLVE" card with nested.level on hierarchical mesh. the bias point is solved on
+   * the mesh coarsened by nested.level levels, prolongated through the element hierarchy to the
+   * original mesh, and finished by the Newton iteration on the original mesh
+   */
+  int  do_nested_solve ( const Parser::Card & c );
+
+  /**
+   * statistical run of "SOLVE" card with ensemble.size. each instance restores the node data,
+   * draws random doping (and trap density), and solves again with the same solver, such that
+   * the mesh, dof map, jacobian pattern and symbolic factorization are shared by all the instances.
+   * the terminal potential and current of each instance are written to SolverSpecify::EnsembleFile
+   */
+  int  solve_ensemble ( SolverBase * solver );
+
+  /**
+   * rebuild the simulation system with a new partition weighted by node dofs of each subdomain.
+   * it is called after a solve command when the measured load is imbalanced
+   */
+  int  do_repartition ( const std::vector<unsigned int> & subdomain_node_dofs );
+
   /**
    * extend 2d mesh to 3d mesh
    */
@@ -244,12 +306,53 @@ private:
    */
   AutoPtr<SolverBase> MoleSolver;
 
+  /**
+   * the solver kept alive by open_solver()
+   */
+  AutoPtr<SolverBase> _open_solver;
+
+  /**
+   * solution group of the open solver
+   */
+  mxml_node_t *_open_solver_group;
+
+  /**
+   * true when do_nested_solve() calls do_solve()
+   */
+  bool _nested_solve;
+
+  /**
+   * rebuild the simulation system on the modified mesh, doping and mole fraction are set by
+   * their solver or the interpolator, the nodal solution saved by backup_node_solution is restored
+   */
+  void rebuild_system ( const InterpolationBase * interpolator );
+
+  /**
+   * set SolverSpecify by "SOLVE" card
+   */
+  int  set_solve_parameters ( const Parser::Card & c );
+
+  /**
+   * @return new solver selected by SolverSpecify::Solver, NULL if not supported
+   */
+  SolverBase * new_solver ();
+
   /**
    * solution records as a XML document
    */
   mxml_node_t *_dom_solution;
 
   std::string _fname_solution;
+
+  /**
+   * base name of IV tables written by this sweep group, only used in sweep farm mode
+   */
+  std::set<std::string> _sweep_prefix;
+
+  /**
+   * merge IV tables of all the sweep groups into one table on root processor
+   */
+  void merge_sweep_output();
 };
 
 class SolverControlHook : public Hook
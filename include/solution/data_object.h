@@ -120,6 +120,20 @@ public:
   template <typename T>
   const T & data(const std::string &) const;
 
+  /**
+   * universal data read function by variable index, converts scalar stored in float
+   */
+  template <typename T>
+  T get_data(const unsigned int v) const
+  { return _data_storage->get_data<T>(v, _offset); }
+
+  /**
+   * universal data read function by variable name, converts scalar stored in float
+   */
+  template <typename T>
+  T get_data(const std::string &v) const
+  { return _data_storage->get_data<T>(variable_index(v), _offset); }
+
 
 protected:
 
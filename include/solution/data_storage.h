@@ -23,6 +23,8 @@
 #define __data_storage_h__
 
 #include <vector>
+#include <algorithm>
+#include <iostream>
 #include "enum_data_type.h"
 #include "vector_value.h"
 #include "tensor_value.h"
@@ -43,7 +45,10 @@ public:
 
     for(unsigned int n=0; n<_scalar_fill.size(); ++n)
       if( _scalar_fill[n] )
-        _scalar_block[n].reserve(reserve_size);
+      {
+        if( _scalar_single[n] ) _float_block[n].reserve(reserve_size);
+        else _scalar_block[n].reserve(reserve_size);
+      }
 
     for(unsigned int n=0; n<_complex_fill.size(); ++n)
       if( _complex_fill[n] )
@@ -67,7 +72,10 @@ public:
 
     std::fill(_scalar_fill.begin(), _scalar_fill.end(), false);
     for(unsigned int n=0; n<_scalar_fill.size(); ++n)
+    {
       _scalar_block[n].clear();
+      _float_block[n].clear();
+    }
 
     std::fill(_complex_fill.begin(), _complex_fill.end(), false);
     for(unsigned int n=0; n<_complex_fill.size(); ++n)
@@ -92,7 +100,10 @@ public:
 
     for(unsigned int n=0; n<_scalar_fill.size(); ++n)
       if( _scalar_fill[n] )
-        _scalar_block[n].resize(_size);
+      {
+        if( _scalar_single[n] ) _float_block[n].resize(_size);
+        else _scalar_block[n].resize(_size);
+      }
 
     for(unsigned int n=0; n<_complex_fill.size(); ++n)
       if( _complex_fill[n] )
@@ -123,7 +134,9 @@ public:
   void allocate_scalar_variable(const std::vector<bool> & flags)
   {
     _scalar_fill = flags;
+    _scalar_single.assign(flags.size(), false);
     _scalar_block.resize(flags.size());
+    _float_block.resize(flags.size());
     for(unsigned int n=0; n<flags.size(); ++n)
       if(flags[n]) _scalar_block[n].resize(_size, 0.0);
   }
@@ -156,9 +169,10 @@ public:
    * add a data block for ith variable.
    * when i equals to static_cast<unsigned int>(-1), append to the variable list
    * when flag is true, memory is allocated
+   * when single is true, a scalar variable is stored in float
    * @return actual variable index
    */
-  unsigned int add_scalar_variable(unsigned int v, bool flag)
+  unsigned int add_scalar_variable(unsigned int v, bool flag, bool single=false)
   {
     if( v == static_cast<unsigned int>(-1) )
       v =  _scalar_fill.size();
@@ -166,14 +180,27 @@ public:
     if( v + 1 > _scalar_fill.size())
     {
       _scalar_fill.resize(v+1, false);
+      _scalar_single.resize(v+1, false);
       _scalar_block.resize(_scalar_fill.size());
+      _float_block.resize(_scalar_fill.size());
     }
 
+    // precision can only be changed before memory allocation
+    if(!_scalar_fill[v]) _scalar_single[v] = single;
+
     _scalar_fill[v] = flag;
     if(_scalar_fill[v])
     {
-      _scalar_block[v].reserve(_reserve_size);
-      _scalar_block[v].resize(_size);
+      if(_scalar_single[v])
+      {
+        _float_block[v].reserve(_reserve_size);
+        _float_block[v].resize(_size);
+      }
+      else
+      {
+        _scalar_block[v].reserve(_reserve_size);
+        _scalar_block[v].resize(_size);
+      }
     }
 
     return v;
@@ -267,18 +294,69 @@ public:
   unsigned int n_tensor() const
     { return _tensor_fill.size(); }
 
+  /**
+   * @return true when memory of scalar variable v is allocated
+   */
+  bool scalar_valid(const unsigned int v) const
+    { return v < _scalar_fill.size() && _scalar_fill[v]; }
+
   /**
    * data access function
    */
   const Real & scalar(const unsigned int v, const unsigned int offset) const
     { return _scalar_block[v][offset]; }
 
+  /**
+   * @return contiguous data of scalar variable v, NULL if not allocated or stored in float
+   */
+  const Real * scalar_block(const unsigned int v) const
+    { return (v < _scalar_fill.size() && _scalar_fill[v] && !_scalar_single[v] && _size) ? &_scalar_block[v][0] : NULL; }
+
   /**
    * data access function
    */
   Real & scalar(const unsigned int v, const unsigned int offset)
   { return _scalar_block[v][offset]; }
 
+  /**
+   * @return true when scalar variable v is stored in float
+   */
+  bool scalar_single(const unsigned int v) const
+    { return v < _scalar_single.size() && _scalar_single[v]; }
+
+  /**
+   * data access function of scalar variable stored in float
+   */
+  const float & scalar_f(const unsigned int v, const unsigned int offset) const
+    { return _float_block[v][offset]; }
+
+  /**
+   * data access function of scalar variable stored in float
+   */
+  float & scalar_f(const unsigned int v, const unsigned int offset)
+  { return _float_block[v][offset]; }
+
+  /**
+   * copy scalar variable v into data as double, converts the variable stored in float
+   * @return false if v is not allocated
+   */
+  bool scalar_to_vector(const unsigned int v, std::vector<Real> & data) const
+  {
+    if( !scalar_valid(v) ) return false;
+    if( _scalar_single[v] ) data.assign(_float_block[v].begin(), _float_block[v].end());
+    else data.assign(_scalar_block[v].begin(), _scalar_block[v].end());
+    return true;
+  }
+
+  /**
+   * copy scalar variable src to variable dst for all the data objects in one pass
+   */
+  void copy_scalar(const unsigned int src, const unsigned int dst)
+  {
+    if( _scalar_fill[src] && _scalar_fill[dst] && !_scalar_single[src] && !_scalar_single[dst] )
+      std::copy(_scalar_block[src].begin(), _scalar_block[src].end(), _scalar_block[dst].begin());
+  }
+
   /**
    * data access function
    */
@@ -291,6 +369,12 @@ public:
   std::complex<Real> & complex(const unsigned int v, const unsigned int offset)
   { return _complex_block[v][offset]; }
 
+  /**
+   * @return true when memory of vector variable v is allocated
+   */
+  bool vector_valid(const unsigned int v) const
+    { return v < _vector_fill.size() && _vector_fill[v]; }
+
   /**
    * data access function
    */
@@ -328,6 +412,20 @@ public:
   template <typename T>
   const T & data(const unsigned int , const unsigned int ) const;
 
+  /**
+   * universal data read function via template, converts scalar stored in float
+   */
+  template <typename T>
+  T get_data(const unsigned int v, const unsigned int offset) const
+  { return data<T>(v, offset); }
+
+  /**
+   * universal data write function via template, converts scalar stored in float
+   */
+  template <typename T>
+  void set_data(const unsigned int v, const unsigned int offset, const T &d)
+  { data<T>(v, offset) = d; }
+
   /**
    * approx memory usage
    */
@@ -338,6 +436,9 @@ public:
     for(unsigned int n=0; n<_scalar_block.size(); ++n)
       counter += _scalar_block[n].capacity()*sizeof(Real);
 
+    for(unsigned int n=0; n<_float_block.size(); ++n)
+      counter += _float_block[n].capacity()*sizeof(float);
+
     for(unsigned int n=0; n<_complex_block.size(); ++n)
       counter += _complex_block[n].capacity()*sizeof(std::complex<Real>);
 
@@ -350,8 +451,140 @@ public:
     return counter;
   }
 
+  /**
+   * write all the data blocks to binary stream, used by checkpoint
+   */
+  void write(std::ostream & out) const
+  {
+    out.write(reinterpret_cast<const char *>(&_size), sizeof(unsigned int));
+
+    _write_fill(out, _scalar_fill, &_scalar_single);
+    for(unsigned int n=0; n<_scalar_fill.size(); ++n)
+      if( _scalar_fill[n] && _size )
+      {
+        if( _scalar_single[n] )
+          out.write(reinterpret_cast<const char *>(&_float_block[n][0]), _size*sizeof(float));
+        else
+          out.write(reinterpret_cast<const char *>(&_scalar_block[n][0]), _size*sizeof(Real));
+      }
+
+    _write_fill(out, _complex_fill);
+    for(unsigned int n=0; n<_complex_fill.size(); ++n)
+      if( _complex_fill[n] && _size )
+        out.write(reinterpret_cast<const char *>(&_complex_block[n][0]), _size*sizeof(std::complex<Real>));
+
+    // VectorValue/TensorValue have virtual destructor, write their components
+    std::vector<Real> buffer;
+
+    _write_fill(out, _vector_fill);
+    for(unsigned int n=0; n<_vector_fill.size(); ++n)
+      if( _vector_fill[n] && _size )
+      {
+        buffer.resize(3*_size);
+        for(unsigned int i=0; i<_size; ++i)
+          for(unsigned int d=0; d<3; ++d)
+            buffer[3*i+d] = _vector_block[n][i](d);
+        out.write(reinterpret_cast<const char *>(&buffer[0]), buffer.size()*sizeof(Real));
+      }
+
+    _write_fill(out, _tensor_fill);
+    for(unsigned int n=0; n<_tensor_fill.size(); ++n)
+      if( _tensor_fill[n] && _size )
+      {
+        buffer.resize(9*_size);
+        for(unsigned int i=0; i<_size; ++i)
+          for(unsigned int d=0; d<9; ++d)
+            buffer[9*i+d] = _tensor_block[n][i](d/3, d%3);
+        out.write(reinterpret_cast<const char *>(&buffer[0]), buffer.size()*sizeof(Real));
+      }
+  }
+
+  /**
+   * read data blocks written by write().
+   * the storage must already be allocated with the same size and variables
+   * @return false when the layout in stream does not match this storage
+   */
+  bool read(std::istream & in)
+  {
+    unsigned int size;
+    in.read(reinterpret_cast<char *>(&size), sizeof(unsigned int));
+    if( !in.good() || size != _size ) return false;
+
+    if( !_check_fill(in, _scalar_fill, &_scalar_single) ) return false;
+    for(unsigned int n=0; n<_scalar_fill.size(); ++n)
+      if( _scalar_fill[n] && _size )
+      {
+        if( _scalar_single[n] )
+          in.read(reinterpret_cast<char *>(&_float_block[n][0]), _size*sizeof(float));
+        else
+          in.read(reinterpret_cast<char *>(&_scalar_block[n][0]), _size*sizeof(Real));
+      }
+
+    if( !_check_fill(in, _complex_fill) ) return false;
+    for(unsigned int n=0; n<_complex_fill.size(); ++n)
+      if( _complex_fill[n] && _size )
+        in.read(reinterpret_cast<char *>(&_complex_block[n][0]), _size*sizeof(std::complex<Real>));
+
+    std::vector<Real> buffer;
+
+    if( !_check_fill(in, _vector_fill) ) return false;
+    for(unsigned int n=0; n<_vector_fill.size(); ++n)
+      if( _vector_fill[n] && _size )
+      {
+        buffer.resize(3*_size);
+        in.read(reinterpret_cast<char *>(&buffer[0]), buffer.size()*sizeof(Real));
+        for(unsigned int i=0; i<_size; ++i)
+          _vector_block[n][i] = VectorValue<Real>(buffer[3*i+0], buffer[3*i+1], buffer[3*i+2]);
+      }
+
+    if( !_check_fill(in, _tensor_fill) ) return false;
+    for(unsigned int n=0; n<_tensor_fill.size(); ++n)
+      if( _tensor_fill[n] && _size )
+      {
+        buffer.resize(9*_size);
+        in.read(reinterpret_cast<char *>(&buffer[0]), buffer.size()*sizeof(Real));
+        for(unsigned int i=0; i<_size; ++i)
+          for(unsigned int d=0; d<9; ++d)
+            _tensor_block[n][i](d/3, d%3) = buffer[9*i+d];
+      }
+
+    return in.good();
+  }
+
 private:
 
+  /**
+   * write variable indicator, 2 for variable stored in float
+   */
+  static void _write_fill(std::ostream & out, const std::vector<bool> & fill, const std::vector<bool> * single=0)
+  {
+    unsigned int n_var = fill.size();
+    out.write(reinterpret_cast<const char *>(&n_var), sizeof(unsigned int));
+    for(unsigned int n=0; n<n_var; ++n)
+    {
+      char flag = fill[n] ? ( (single && (*single)[n]) ? 2 : 1 ) : 0;
+      out.write(&flag, 1);
+    }
+  }
+
+  /**
+   * read variable indicator and compare it with fill
+   */
+  static bool _check_fill(std::istream & in, const std::vector<bool> & fill, const std::vector<bool> * single=0)
+  {
+    unsigned int n_var;
+    in.read(reinterpret_cast<char *>(&n_var), sizeof(unsigned int));
+    if( !in.good() || n_var != fill.size() ) return false;
+    for(unsigned int n=0; n<n_var; ++n)
+    {
+      char flag;
+      in.read(&flag, 1);
+      char expect = fill[n] ? ( (single && (*single)[n]) ? 2 : 1 ) : 0;
+      if( flag != expect ) return false;
+    }
+    return in.good();
+  }
+
   /**
    * the size of data array
    */
@@ -368,6 +601,13 @@ private:
   std::vector<bool> _scalar_fill;
   std::vector< std::vector<Real> > _scalar_block;
 
+  /**
+   * indicator of scalar value stored in float, the data is kept in _float_block.
+   * used by auxiliary and output only variables
+   */
+  std::vector<bool> _scalar_single;
+  std::vector< std::vector<float> > _float_block;
+
   /**
    * indicator of complex value
    */
@@ -423,5 +663,17 @@ template<>
 inline const TensorValue<Real> & DataStorage::data< TensorValue<Real> >(const unsigned int v, const unsigned int offset) const { return _tensor_block[v][offset]; }
 
 
+template<>
+inline Real DataStorage::get_data< Real >(const unsigned int v, const unsigned int offset) const
+{ return _scalar_single[v] ? static_cast<Real>(_float_block[v][offset]) : _scalar_block[v][offset]; }
+
+template<>
+inline void DataStorage::set_data< Real >(const unsigned int v, const unsigned int offset, const Real &d)
+{
+  if( _scalar_single[v] ) _float_block[v][offset] = static_cast<float>(d);
+  else _scalar_block[v][offset] = d;
+}
+
+
 #endif
 
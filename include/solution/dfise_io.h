@@ -27,6 +27,7 @@
 // C++ includes
 #include <vector>
 #include <fstream>
+#include <algorithm>
 
 // Local includes
 #include "config.h"
@@ -129,26 +130,27 @@ private:
 
 
   /**
-   * the '<' operator used in set/map key
+   * direction free key of edge (n1, n2)
    */
-  struct _lt_pair_int
+  static unsigned long long _edge_key(int n1, int n2)
   {
-    bool operator()(const std::pair<int, int> &e1, const std::pair<int, int> &e2) const
-    {
-      int e1_min = std::min(e1.first, e1.second);
-      int e1_max = std::max(e1.first, e1.second);
-      int e2_min = std::min(e2.first, e2.second);
-      int e2_max = std::max(e2.first, e2.second);
-
-      if( e1_min != e2_min ) return e1_min < e2_min;
-      return e1_max < e2_max;
-    }
-  };
+    unsigned long long lo = static_cast<unsigned int>(std::min(n1, n2));
+    unsigned long long hi = static_cast<unsigned int>(std::max(n1, n2));
+    return (hi << 32) | lo;
+  }
+
+#if defined(HAVE_UNORDERED_MAP)
+  typedef std::unordered_map<unsigned long long, int> _edge_map_type;
+#elif defined(HAVE_TR1_UNORDERED_MAP) || defined(HAVE_TR1_UNORDERED_MAP_WITH_STD_HEADER)
+  typedef std::tr1::unordered_map<unsigned long long, int> _edge_map_type;
+#else
+  typedef std::map<unsigned long long, int>  _edge_map_type;
+#endif
 
   /**
-   * edge map
+   * edge key to edge index in _edges
    */
-  std::map< std::pair<int, int>, int, _lt_pair_int> _edges_map;
+  _edge_map_type _edges_map;
 
   /**
    * all the mesh edges
@@ -0,0 +1,113 @@
+/********************************************************************************/
+/*     888888    888888888   88     888  88888   888      888    88888888       */
+/*   8       8   8           8 8     8     8      8        8    8               */
+/*  8            8           8  8    8     8      8        8    8               */
+/*  8            888888888   8   8   8     8      8        8     8888888        */
+/*  8      8888  8           8    8  8     8      8        8            8       */
+/*   8       8   8           8     8 8     8      8        8            8       */
+/*     888888    888888888  888     88   88888     88888888     88888888        */
+/*                                                                              */
+/*       A Three-Dimensional General Purpose Semiconductor Simulator.           */
+/*                                                                              */
+/*                                                                              */
+/*  Copyright (C) 2007-2008                                                     */
+/*  Cogenda Pte Ltd                                                             */
+/*                                                                              */
+/*  Please contact Cogenda Pte Ltd for license information                      */
+/*                                                                              */
+/*  Author: Gong Ding   gdiso@ustc.edu                                          */
+/*                                                                              */
+/********************************************************************************/
+
+
+#ifndef __elem_node_deposition_h__
+#define __elem_node_deposition_h__
+
+// C++ includes
+#include <vector>
+
+// Local includes
+#include "genius_common.h"
+
+class SimulationSystem;
+class FVM_Node;
+class FVM_NodeData;
+
+
+/**
+ * Sparse operator which deposits a quantity integrated over each local element into
+ * the density of its FVM nodes. The share of node i is the truncated partial volume
+ * of elem at i over the elem volume, divided by the control volume of the FVM node.
+ * It only depends on the mesh, SimulationSystem builds it once for each mesh revision.
+ */
+class ElemNodeDeposition
+{
+public:
+
+  /**
+   * the writable node data field the quantity is deposited to, i.e. &FVM_NodeData::OptG
+   */
+  typedef Real & (FVM_NodeData::*Field)();
+
+  /**
+   * the auxiliary field stored in single precision, i.e. &FVM_NodeData::OptE
+   */
+  typedef float & (FVM_NodeData::*FloatField)();
+
+  /**
+   * build the operator of local elements
+   */
+  ElemNodeDeposition(const SimulationSystem & system);
+
+  /**
+   * node_data.*field += W * elem_value, elem_value is indexed by elem id and may cover the whole mesh.
+   * elems with zero value are skipped
+   */
+  void deposit(const std::vector<double> & elem_value, Field field) const;
+
+  /**
+   * node_data.*field += W * elem_value for the single precision field
+   */
+  void deposit(const std::vector<double> & elem_value, FloatField field) const;
+
+  /**
+   * deposit several quantities of the same elems in one pass over the operator
+   */
+  void deposit(const std::vector<const std::vector<double> *> & elem_values, const std::vector<Field> & fields) const;
+
+  /**
+   * @return number of nonzero entries
+   */
+  unsigned int n_entries() const
+  { return _node.size(); }
+
+private:
+
+  /**
+   * deposit to the field of type T
+   */
+  template <typename T>
+  void _deposit(const std::vector<double> & elem_value, T & (FVM_NodeData::*field)()) const;
+
+  /**
+   * elem id of each row
+   */
+  std::vector<unsigned int> _elem;
+
+  /**
+   * CSR row pointer, size of _elem + 1
+   */
+  std::vector<unsigned int> _row;
+
+  /**
+   * FVM node of each entry
+   */
+  std::vector<FVM_Node *>   _node;
+
+  /**
+   * weight of each entry
+   */
+  std::vector<Real>         _weight;
+};
+
+#endif // #define __elem_node_deposition_h__
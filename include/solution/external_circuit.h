@@ -25,6 +25,7 @@
 #define __external_circuit_h__
 
 #include <string>
+#include <vector>
 #include <complex>
 
 #include "genius_common.h"
@@ -292,6 +293,17 @@ public:
     _current_old = _current;
   }
 
+  /**
+   * append the state of this circuit (stimulation, potential and current history) to a flat array
+   */
+  virtual void save_state(std::vector<Real> & state) const;
+
+  /**
+   * restore the state written by save_state() from position pos of array
+   * @return the position after the state of this circuit
+   */
+  virtual unsigned int restore_state(const std::vector<Real> & state, unsigned int pos);
+
 
 protected:
   /**
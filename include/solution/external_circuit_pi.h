@@ -62,6 +62,7 @@ public:
   {
     _V1      = 0.0;
     _V1_last = 0.0;
+    _companion_dt = 0.0;
   }
 
   virtual ~ExternalCircuitPI() {}
@@ -193,6 +194,28 @@ public:
    */
   virtual void tran_op_init();
 
+  /**
+   * append the state of this circuit to a flat array
+   */
+  virtual void save_state(std::vector<Real> & state) const
+  {
+    ExternalCircuit::save_state(state);
+    state.push_back(_V1);
+    state.push_back(_V1_last);
+  }
+
+  /**
+   * restore the state written by save_state()
+   */
+  virtual unsigned int restore_state(const std::vector<Real> & state, unsigned int pos)
+  {
+    pos = ExternalCircuit::restore_state(state, pos);
+    genius_assert(pos + 2 <= state.size());
+    _V1      = state[pos++];
+    _V1_last = state[pos++];
+    return pos;
+  }
+
 private:
 
   Real _r_app;
@@ -208,6 +231,22 @@ private:
 
   Real _V1, _V1_last;
 
+  /**
+   * key of the cached companion coefficients: dt, drive mode and element values
+   */
+  Real _companion_dt, _companion_r_app, _companion_res, _companion_cap1, _companion_cap2;
+  bool _companion_vd;
+
+  /**
+   * backward euler companion of the 2x2 system | A B ; C D |,
+   * the diagonal A, D and schur complement A-B/D*C = dI/dV0
+   */
+  Real _companion_A, _companion_D, _companion_G;
+
+  /**
+   * refresh the companion coefficients when dt, drive mode or element value changed
+   */
+  void companion(Real dt);
 
 };
 
@@ -49,7 +49,8 @@ class ExternalCircuitRCL : public ExternalCircuit
 {
 public:
   ExternalCircuitRCL(Real R=0.0, Real C=0.0, Real L=0.0)
-  :_res(R), _cap(C), _ind(L),_cap_current(0.0),_cap_current_old(0.0)
+  :_res(R), _cap(C), _ind(L),_cap_current(0.0),_cap_current_old(0.0),
+   _companion_dt(0.0), _companion_res(0.0), _companion_cap(0.0), _companion_ind(0.0), _companion_g(0.0)
   {}
 
   virtual ~ExternalCircuitRCL() {}
@@ -191,6 +192,28 @@ public:
     _cap_current = _cap_current_old = 0.0;
   }
 
+  /**
+   * append the state of this circuit to a flat array
+   */
+  virtual void save_state(std::vector<Real> & state) const
+  {
+    ExternalCircuit::save_state(state);
+    state.push_back(_cap_current);
+    state.push_back(_cap_current_old);
+  }
+
+  /**
+   * restore the state written by save_state()
+   */
+  virtual unsigned int restore_state(const std::vector<Real> & state, unsigned int pos)
+  {
+    pos = ExternalCircuit::restore_state(state, pos);
+    genius_assert(pos + 2 <= state.size());
+    _cap_current     = state[pos++];
+    _cap_current_old = state[pos++];
+    return pos;
+  }
+
 private:
 
   Real _res;
@@ -209,6 +232,32 @@ private:
    */
   Real      _cap_current_old;
 
+  /**
+   * dt and RCL values the companion coefficient was computed with
+   */
+  Real      _companion_dt, _companion_res, _companion_cap, _companion_ind;
+
+  /**
+   * companion coefficient (L/dt+R)*C/dt of backward euler
+   */
+  Real      _companion_g;
+
+  /**
+   * refresh the companion coefficient when dt or RCL value changed
+   */
+  Real companion(Real dt)
+  {
+    if( dt != _companion_dt || _res != _companion_res || _cap != _companion_cap || _ind != _companion_ind )
+    {
+      _companion_dt  = dt;
+      _companion_res = _res;
+      _companion_cap = _cap;
+      _companion_ind = _ind;
+      _companion_g   = (_ind/dt+_res)*_cap/dt;
+    }
+    return _companion_g;
+  }
+
 };
 
 #endif
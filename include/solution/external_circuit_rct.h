@@ -164,6 +164,34 @@ public:
    */
   virtual void tran_op_init();
 
+  /**
+   * append the state of this circuit to a flat array
+   */
+  virtual void save_state(std::vector<Real> & state) const
+  {
+    ExternalCircuit::save_state(state);
+    state.push_back(_v.size());
+    state.insert(state.end(), _v.begin(), _v.end());
+    state.push_back(_v_last.size());
+    state.insert(state.end(), _v_last.begin(), _v_last.end());
+  }
+
+  /**
+   * restore the state written by save_state()
+   */
+  virtual unsigned int restore_state(const std::vector<Real> & state, unsigned int pos)
+  {
+    pos = ExternalCircuit::restore_state(state, pos);
+    genius_assert(pos < state.size());
+    _v.resize(static_cast<unsigned int>(state[pos++]));
+    genius_assert(pos + _v.size() < state.size());
+    for(unsigned int i=0; i<_v.size(); ++i)      _v[i] = state[pos++];
+    _v_last.resize(static_cast<unsigned int>(state[pos++]));
+    genius_assert(pos + _v_last.size() <= state.size());
+    for(unsigned int i=0; i<_v_last.size(); ++i) _v_last[i] = state[pos++];
+    return pos;
+  }
+
 private:
 
   Real _r_app;
@@ -183,6 +211,32 @@ private:
 
   std::vector<Real> _v_last;
 
+  /**
+   * key of the cached companion factorization: dt and line parameters
+   */
+  Real _companion_dt, _companion_r_app, _companion_r_per_um, _companion_c_per_um, _companion_length;
+
+  /**
+   * Thomas factorization of the backward euler tridiagonal matrix of the line,
+   * elimination multipliers and reduced diagonal
+   */
+  std::vector<Real> _companion_m, _companion_d;
+
+  /**
+   * dI/dV0 with this factorization
+   */
+  Real _companion_G;
+
+  /**
+   * refactorize the line when dt or line parameter changed
+   */
+  void companion(Real dt);
+
+  /**
+   * solve the line with the cached factorization, rhs is overwritten
+   */
+  void companion_solve(std::vector<Real> &r, std::vector<Real> &x) const;
+
 
   void solveMatrix (int n, std::vector<Real> a, std::vector<Real> b, std::vector<Real> c, std::vector<Real> v, std::vector<Real> &x)
   {
@@ -99,6 +99,55 @@ public:
   { return _vector_dummy_;}
 
 
+  /**
+   * @return the E field parallel to electron current of high field mobility
+   */
+  virtual PetscScalar Epn()       const
+  { return 0.0;}
+
+  /**
+   * @return the writable reference to E field parallel to electron current
+   */
+  virtual PetscScalar & Epn()
+  { return _scalar_dummy_;}
+
+  /**
+   * @return the E field parallel to hole current of high field mobility
+   */
+  virtual PetscScalar Epp()       const
+  { return 0.0;}
+
+  /**
+   * @return the writable reference to E field parallel to hole current
+   */
+  virtual PetscScalar & Epp()
+  { return _scalar_dummy_;}
+
+  /**
+   * @return the E field vertical to electron current of high field mobility
+   */
+  virtual PetscScalar Etn()       const
+  { return 0.0;}
+
+  /**
+   * @return the writable reference to E field vertical to electron current
+   */
+  virtual PetscScalar & Etn()
+  { return _scalar_dummy_;}
+
+  /**
+   * @return the E field vertical to hole current of high field mobility
+   */
+  virtual PetscScalar Etp()       const
+  { return 0.0;}
+
+  /**
+   * @return the writable reference to E field vertical to hole current
+   */
+  virtual PetscScalar & Etp()
+  { return _scalar_dummy_;}
+
+
 protected:
 
   /**
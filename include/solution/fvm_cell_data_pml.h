@@ -115,17 +115,17 @@ public:
 public:
 
   /**
-   * @return the electrical field
+   * @return the electrical field, zero when the cell field is not allocated
    */
   virtual VectorValue<PetscScalar> E()       const
-  { return _data_storage->vector(_E_, _offset);}
+  { return _data_storage->vector_valid(_E_) ? _data_storage->vector(_E_, _offset) : VectorValue<PetscScalar>(0,0,0);}
 
 
   /**
-   * @return the writable reference to electrical field
+   * @return the writable reference to electrical field, a dummy when the cell field is not allocated
    */
   virtual VectorValue<PetscScalar> & E()
-  { return _data_storage->vector(_E_, _offset);}
+  { return _data_storage->vector_valid(_E_) ? _data_storage->vector(_E_, _offset) : _vector_dummy_;}
 
 
 };
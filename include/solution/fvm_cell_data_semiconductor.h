@@ -36,6 +36,38 @@ class FVM_Semiconductor_CellData : public FVM_CellData
 
 public:
 
+  /**
+   * the scalar auxiliary variable for semiconductor region,
+   * the driving forces of high field mobility evaluated by the residual of the solver
+   */
+  enum SemiconductorAuxData
+  {
+    /**
+     * E field parallel to electron current
+     */
+    _Epn_=0,
+
+    /**
+     * E field parallel to hole current
+     */
+    _Epp_,
+
+    /**
+     * E field vertical to electron current
+     */
+    _Etn_,
+
+    /**
+     * E field vertical to hole current
+     */
+    _Etp_,
+
+    /**
+     * last enum number
+     */
+    ScalarDataCount
+  };
+
   /**
    * the vector auxiliary variable for semiconductor region
    */
@@ -83,7 +115,7 @@ public:
    * @return the solution variable number
    */
   static size_t n_scalar()
-  { return 0;  }
+  { return static_cast<unsigned int>(ScalarDataCount); }
 
   /**
    * @return the complex variable number
@@ -113,17 +145,17 @@ public:
 public:
 
   /**
-   * @return the electrical field
+   * @return the electrical field, zero when the cell field is not allocated
    */
   virtual VectorValue<PetscScalar> E()       const
-  { return _data_storage->vector(_E_, _offset);}
+  { return _data_storage->vector_valid(_E_) ? _data_storage->vector(_E_, _offset) : VectorValue<PetscScalar>(0,0,0);}
 
 
   /**
-   * @return the writable reference to electrical field
+   * @return the writable reference to electrical field, a dummy when the cell field is not allocated
    */
   virtual VectorValue<PetscScalar> & E()
-  { return _data_storage->vector(_E_, _offset);}
+  { return _data_storage->vector_valid(_E_) ? _data_storage->vector(_E_, _offset) : _vector_dummy_;}
 
 
   /**
@@ -154,6 +186,55 @@ public:
   { return _data_storage->vector(_Jp_, _offset);}
 
 
+  /**
+   * @return the E field parallel to electron current, zero when the cell data is not allocated
+   */
+  virtual PetscScalar Epn()       const
+  { return _data_storage->scalar_valid(_Epn_) ? _data_storage->scalar(_Epn_, _offset) : 0.0;}
+
+  /**
+   * @return the writable reference to E field parallel to electron current
+   */
+  virtual PetscScalar & Epn()
+  { return _data_storage->scalar_valid(_Epn_) ? _data_storage->scalar(_Epn_, _offset) : _scalar_dummy_;}
+
+  /**
+   * @return the E field parallel to hole current, zero when the cell data is not allocated
+   */
+  virtual PetscScalar Epp()       const
+  { return _data_storage->scalar_valid(_Epp_) ? _data_storage->scalar(_Epp_, _offset) : 0.0;}
+
+  /**
+   * @return the writable reference to E field parallel to hole current
+   */
+  virtual PetscScalar & Epp()
+  { return _data_storage->scalar_valid(_Epp_) ? _data_storage->scalar(_Epp_, _offset) : _scalar_dummy_;}
+
+  /**
+   * @return the E field vertical to electron current, zero when the cell data is not allocated
+   */
+  virtual PetscScalar Etn()       const
+  { return _data_storage->scalar_valid(_Etn_) ? _data_storage->scalar(_Etn_, _offset) : 0.0;}
+
+  /**
+   * @return the writable reference to E field vertical to electron current
+   */
+  virtual PetscScalar & Etn()
+  { return _data_storage->scalar_valid(_Etn_) ? _data_storage->scalar(_Etn_, _offset) : _scalar_dummy_;}
+
+  /**
+   * @return the E field vertical to hole current, zero when the cell data is not allocated
+   */
+  virtual PetscScalar Etp()       const
+  { return _data_storage->scalar_valid(_Etp_) ? _data_storage->scalar(_Etp_, _offset) : 0.0;}
+
+  /**
+   * @return the writable reference to E field vertical to hole current
+   */
+  virtual PetscScalar & Etp()
+  { return _data_storage->scalar_valid(_Etp_) ? _data_storage->scalar(_Etp_, _offset) : _scalar_dummy_;}
+
+
 
 };
 
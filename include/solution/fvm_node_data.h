@@ -627,8 +627,8 @@ public:
   /**
    * @return the writable optical energy
    */
-  virtual Real &       OptE()
-  { return FVM_NodeData::_scalar_dummy_; }
+  virtual float &      OptE()
+  { return FVM_NodeData::_float_dummy_; }
 
 
   /**
@@ -640,8 +640,8 @@ public:
   /**
    * @return the writable particle generation ratio
    */
-  virtual Real &       PatG()
-  { return FVM_NodeData::_scalar_dummy_; }
+  virtual float &      PatG()
+  { return FVM_NodeData::_float_dummy_; }
 
   /**
    * @return the particle energy
@@ -652,8 +652,8 @@ public:
   /**
    * @return the writable particle generation ratio
    */
-  virtual Real &       PatE()
-  { return FVM_NodeData::_scalar_dummy_; }
+  virtual float &      PatE()
+  { return FVM_NodeData::_float_dummy_; }
 
 
   /**
@@ -769,8 +769,8 @@ public:
   /**
    * @return the writable reference to recombnation rate
    */
-  virtual Real &       Recomb()
-  { return FVM_NodeData::_scalar_dummy_; }
+  virtual float &      Recomb()
+  { return FVM_NodeData::_float_dummy_; }
 
 
   /**
@@ -782,8 +782,8 @@ public:
   /**
    * @return the writable reference to direct(optical) recombnation rate
    */
-  virtual Real &       Recomb_Dir()
-  { return FVM_NodeData::_scalar_dummy_; }
+  virtual float &      Recomb_Dir()
+  { return FVM_NodeData::_float_dummy_; }
 
 
   /**
@@ -795,8 +795,8 @@ public:
   /**
    * @return the writable reference to SRH recombnation rate
    */
-  virtual Real &       Recomb_SRH()
-  { return FVM_NodeData::_scalar_dummy_; }
+  virtual float &      Recomb_SRH()
+  { return FVM_NodeData::_float_dummy_; }
 
 
   /**
@@ -808,8 +808,8 @@ public:
   /**
    * @return the writable reference to impact ionization
    */
-  virtual Real &       ImpactIonization()
-  { return FVM_NodeData::_scalar_dummy_; }
+  virtual float &      ImpactIonization()
+  { return FVM_NodeData::_float_dummy_; }
 
 
   /**
@@ -821,8 +821,8 @@ public:
   /**
    * @return the writable reference to Auger recombnation rate
    */
-  virtual Real &       Recomb_Auger()
-  { return FVM_NodeData::_scalar_dummy_; }
+  virtual float &      Recomb_Auger()
+  { return FVM_NodeData::_float_dummy_; }
 
 
   /**
@@ -873,6 +873,11 @@ protected:
    */
   static Real _scalar_dummy_;
 
+  /**
+   * dummy scalar parameter of float storage to avoid compile problem
+   */
+  static float _float_dummy_;
+
   /**
    * dummy scalar parameter to avoid compile problem
    */
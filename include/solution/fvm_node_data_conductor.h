@@ -328,13 +328,13 @@ class FVM_Conductor_NodeData : public FVM_NodeData
      * @return the optical energy
      */
     virtual Real         OptE()          const
-    { return _data_storage->scalar ( _OptE_, _offset ); }
+    { return _data_storage->scalar_f( _OptE_, _offset ); }
 
     /**
      * @return the writable optical energy
      */
-    virtual Real &       OptE()
-    { return _data_storage->scalar ( _OptE_, _offset ); }
+    virtual float &      OptE()
+    { return _data_storage->scalar_f( _OptE_, _offset ); }
 
 
     /**
@@ -246,13 +246,13 @@ class FVM_PML_NodeData : public FVM_NodeData
      * @return the statistic potential at previous time step
      */
     virtual Real         psi_last()          const
-    { return _data_storage->scalar ( _psi_last_, _offset ); }
+    { return _data_storage->scalar_valid(_psi_last_) ? _data_storage->scalar ( _psi_last_, _offset ) : 0.0; }
 
     /**
      * @return the writable reference to statistic potential at previous time step
      */
     virtual Real &       psi_last()
-    { return _data_storage->scalar ( _psi_last_, _offset ); }
+    { return _data_storage->scalar_valid(_psi_last_) ? _data_storage->scalar ( _psi_last_, _offset ) : _scalar_dummy_; }
 
 
     /**
@@ -339,14 +339,14 @@ class FVM_PML_NodeData : public FVM_NodeData
      * @return the electrical field
      */
     virtual VectorValue<Real> E()       const
-    { return _data_storage->vector ( _E_, _offset );}
+    { return _data_storage->vector_valid(_E_) ? _data_storage->vector ( _E_, _offset ) : VectorValue<Real>(0,0,0);}
 
 
     /**
      * @return the writable reference to electrical field
      */
     virtual VectorValue<Real> & E()
-    { return _data_storage->vector ( _E_, _offset );}
+    { return _data_storage->vector_valid(_E_) ? _data_storage->vector ( _E_, _offset ) : _vector_dummy_;}
 
 
 };
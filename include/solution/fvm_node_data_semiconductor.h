@@ -1127,64 +1127,64 @@ class FVM_Semiconductor_NodeData : public FVM_NodeData
      * @return the recombnation rate
      */
     virtual Real         Recomb()          const
-    { return _data_storage->scalar ( _Recomb_, _offset ); }
+    { return _data_storage->scalar_f( _Recomb_, _offset ); }
 
     /**
      * @return the writable reference to recombnation rate
      */
-    virtual Real &       Recomb()
-    { return _data_storage->scalar ( _Recomb_, _offset ); }
+    virtual float &      Recomb()
+    { return _data_storage->scalar_f( _Recomb_, _offset ); }
 
 
     /**
      * @return the direct(optical) recombnation rate
      */
     virtual Real         Recomb_Dir()          const
-    { return _data_storage->scalar ( _Recomb_Dir_, _offset ); }
+    { return _data_storage->scalar_f( _Recomb_Dir_, _offset ); }
 
     /**
      * @return the writable reference to direct(optical) recombnation rate
      */
-    virtual Real &       Recomb_Dir()
-    { return _data_storage->scalar ( _Recomb_Dir_, _offset ); }
+    virtual float &      Recomb_Dir()
+    { return _data_storage->scalar_f( _Recomb_Dir_, _offset ); }
 
 
     /**
      * @return the SRH recombnation rate
      */
     virtual Real         Recomb_SRH()          const
-    { return _data_storage->scalar ( _Recomb_SRH_, _offset ); }
+    { return _data_storage->scalar_f( _Recomb_SRH_, _offset ); }
 
     /**
      * @return the writable reference to SRH recombnation rate
      */
-    virtual Real &       Recomb_SRH()
-    { return _data_storage->scalar ( _Recomb_SRH_, _offset ); }
+    virtual float &      Recomb_SRH()
+    { return _data_storage->scalar_f( _Recomb_SRH_, _offset ); }
 
 
     /**
      * @return the Auger recombnation rate
      */
     virtual Real         Recomb_Auger()          const
-    { return _data_storage->scalar ( _Recomb_Auger_, _offset ); }
+    { return _data_storage->scalar_f( _Recomb_Auger_, _offset ); }
 
     /**
      * @return the writable reference to Auger recombnation rate
      */
-    virtual Real &       Recomb_Auger()
-    { return _data_storage->scalar ( _Recomb_Auger_, _offset ); }
+    virtual float &      Recomb_Auger()
+    { return _data_storage->scalar_f( _Recomb_Auger_, _offset ); }
 
     /**
      * @return the impact ionization
      */
     virtual Real         ImpactIonization()          const
-    { return _data_storage->scalar ( _ImpactIonization_, _offset ); }
+    { return _data_storage->scalar_f( _ImpactIonization_, _offset ); }
 
     /**
      * @return the writable reference to impact ionization
      */
-    virtual Real &       ImpactIonization()
-    { return _data_storage->scalar ( _ImpactIonization_, _offset ); }
+    virtual float &      ImpactIonization()
+    { return _data_storage->scalar_f( _ImpactIonization_, _offset ); }
 
 
     /**
@@ -1245,13 +1245,13 @@ class FVM_Semiconductor_NodeData : public FVM_NodeData
      * @return the optical generation ratio
      */
     virtual  Real OptG()       const
-    { return _data_storage->scalar ( _OptG_, _offset );}
+    { return _data_storage->scalar( _OptG_, _offset );}
 
     /**
      * @return the writable optical generation ratio
      */
     virtual  Real & OptG()
-    { return _data_storage->scalar ( _OptG_, _offset );}
+    { return _data_storage->scalar( _OptG_, _offset );}
 
     /**
      * @return the heat generation ratio due to optical incident
@@ -1270,38 +1270,38 @@ class FVM_Semiconductor_NodeData : public FVM_NodeData
      * @return the optical energy
      */
     virtual Real         OptE()          const
-    { return _data_storage->scalar ( _OptE_, _offset ); }
+    { return _data_storage->scalar_f( _OptE_, _offset ); }
 
     /**
      * @return the writable optical energy
      */
-    virtual Real &       OptE()
-    { return _data_storage->scalar ( _OptE_, _offset ); }
+    virtual float &      OptE()
+    { return _data_storage->scalar_f( _OptE_, _offset ); }
 
     /**
      * @return the particle generation ratio
      */
     virtual Real         PatG()          const
-    { return _data_storage->scalar ( _PatG_, _offset ); }
+    { return _data_storage->scalar_f( _PatG_, _offset ); }
 
     /**
      * @return the writable particle generation ratio
      */
-    virtual Real &       PatG()
-    { return _data_storage->scalar ( _PatG_, _offset ); }
+    virtual float &      PatG()
+    { return _data_storage->scalar_f( _PatG_, _offset ); }
 
 
     /**
      * @return the energy deposite of particle
      */
     virtual Real         PatE()          const
-    { return _data_storage->scalar ( _PatE_, _offset ); }
+    { return _data_storage->scalar_f( _PatE_, _offset ); }
 
     /**
      * @return the writable energy deposite of particle
      */
-    virtual Real &       PatE()
-    { return _data_storage->scalar ( _PatE_, _offset ); }
+    virtual float &      PatE()
+    { return _data_storage->scalar_f( _PatE_, _offset ); }
 
 
 
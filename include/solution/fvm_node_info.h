@@ -183,7 +183,12 @@ public:
   void truncate_cv_surface_area();
 
 
-  typedef std::map< FVM_Node *, std::pair<unsigned int, Real> >::const_iterator fvm_ghost_node_iterator;
+  /**
+   * ghost nodes stored as vector sorted by FVM_Node pointer, which is much smaller than std::map
+   */
+  typedef std::vector< std::pair<FVM_Node *, std::pair<unsigned int, Real> > > GhostNodeList;
+
+  typedef GhostNodeList::const_iterator fvm_ghost_node_iterator;
 
   /**
    * @return the number of ghost node, which in different region.
@@ -508,12 +513,24 @@ private:
       }
   };
 
+  /**
+   * weakly less test of two ghost node objects, by FVM_Node pointer
+   */
+  class GhostNodeLess
+  {
+    public:
+      bool operator () (const std::pair<FVM_Node *, std::pair<unsigned int, Real> > &a, const std::pair<FVM_Node *, std::pair<unsigned int, Real> > &b) const
+      {
+        return a.first < b.first;
+      }
+  };
+
   /**
    * the FVM Node with same root node, but in different region
    * record the region index of ghost node as well as the area of interface
    * the NULL ghost node means this node on the boundary
    */
-  std::map< FVM_Node *, std::pair<unsigned int, Real> > * _ghost_nodes ;
+  GhostNodeList * _ghost_nodes ;
 
   /**
    * when the CV lies on region boundary, this is the vector norm to region boundary
@@ -0,0 +1,184 @@
+/********************************************************************************/
+/*     888888    888888888   88     888  88888   888      888    88888888       */
+/*   8       8   8           8 8     8     8      8        8    8               */
+/*  8            8           8  8    8     8      8        8    8               */
+/*  8            888888888   8   8   8     8      8        8     8888888        */
+/*  8      8888  8           8    8  8     8      8        8            8       */
+/*   8       8   8           8     8 8     8      8        8            8       */
+/*     888888    888888888  888     88   88888     88888888     88888888        */
+/*                                                                              */
+/*       A Three-Dimensional General Purpose Semiconductor Simulator.           */
+/*                                                                              */
+/*                                                                              */
+/*  Copyright (C) 2007-2008                                                     */
+/*  Cogenda Pte Ltd                                                             */
+/*                                                                              */
+/*  Please contact Cogenda Pte Ltd for license information                      */
+/*                                                                              */
+/*  Author: Gong Ding   gdiso@ustc.edu                                          */
+/*                                                                              */
+/********************************************************************************/
+
+
+
+#ifndef __hdf5_io_h__
+#define __hdf5_io_h__
+
+// C++ includes
+#include <string>
+#include <vector>
+
+// Local includes
+#include "genius_common.h"
+#include "field_output.h"
+#include "simulation_system.h"
+
+
+// Forward declarations
+class MeshBase;
+
+
+
+/**
+ * This class implements writing solution data into a HDF5 file with a XDMF descriptor.
+ * Format description:
+ * cf. <a href="http://www.hdfgroup.org/">HDF5 home page</a> and
+ * <a href="http://www.xdmf.org/">XDMF home page</a>.
+ *
+ * The mesh is stored once as /Mesh/Geometry and /Mesh/Topology (XDMF mixed topology),
+ * each write adds a /Step_nnnnnn group with Node and Cell fields. All the datasets are
+ * chunked and compressed, a field of one step can be read without touching the others.
+ * With parallel HDF5, every processor writes the nodes and cells it owns by collective
+ * MPI-IO, nothing is gathered to processor 0.
+ */
+
+// ------------------------------------------------------------
+// HDF5IO class definition
+class HDF5IO : public FieldOutput<SimulationSystem>
+{
+public:
+
+  /**
+   * Constructor.  Takes a read-only reference to a mesh object.
+   * This is the constructor required to write a mesh.
+   */
+  HDF5IO (const SimulationSystem& system);
+
+  /**
+   * This method implements writing the mesh and solution to a specified file.
+   * the XDMF descriptor is written to the same name with .xmf extension
+   */
+  virtual void write (const std::string& );
+
+  /**
+   * append the solution as a new step when the file already holds the same mesh,
+   * otherwise the file is overwritten
+   */
+  void set_append(bool flag)
+  { _append = flag; }
+
+  /**
+   * the time (or voltage, current, frequency) value of the step in XDMF
+   */
+  void set_time(double t)
+  { _time = t; }
+
+  /**
+   * write the fields in Float32 instead of Float64
+   */
+  void set_float32(bool flag)
+  { _float32 = flag; }
+
+  /**
+   * deflate level of the datasets, 0 for no compression
+   */
+  void set_compression(int level)
+  { _compression = level; }
+
+private:
+
+  /**
+   * append to existing file
+   */
+  bool _append;
+
+  /**
+   * step value
+   */
+  double _time;
+
+  /**
+   * Float32 fields
+   */
+  bool _float32;
+
+  /**
+   * deflate level
+   */
+  int _compression;
+
+  /**
+   * fields of the nodes owned by this processor, in the order of _node_id
+   */
+  struct Field
+  {
+    std::string  name;
+    unsigned int n_components;
+    std::vector<double> data;
+  };
+
+  /**
+   * global id of the nodes owned by this processor
+   */
+  std::vector<unsigned int> _node_id;
+
+  /**
+   * node location of owned nodes
+   */
+  std::vector<double>       _node_location;
+
+  /**
+   * XDMF mixed topology of the elements owned by this processor
+   */
+  std::vector<long long>    _topology;
+
+  /**
+   * subdomain and processor of the owned elements
+   */
+  std::vector<int>          _subdomain;
+  std::vector<int>          _partition;
+
+  /**
+   * node and cell fields
+   */
+  std::vector<Field>        _node_fields;
+  std::vector<Field>        _cell_fields;
+
+  /**
+   * fill the owned mesh entities
+   */
+  void _collect_mesh(const MeshBase& mesh);
+
+  /**
+   * fill the node and cell fields
+   */
+  void _collect_fields(const MeshBase& mesh);
+
+  /**
+   * processor 0 writes the XDMF descriptor of all the steps in the file
+   */
+  void _write_xdmf(const std::string& name) const;
+};
+
+
+
+// ------------------------------------------------------------
+// HDF5IO inline members
+inline
+HDF5IO::HDF5IO (const SimulationSystem& system) :
+    FieldOutput<SimulationSystem>(system),
+    _append(false), _time(0.0), _float32(false), _compression(1)
+{}
+
+
+#endif // #define __hdf5_io_h__
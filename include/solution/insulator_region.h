@@ -150,6 +150,13 @@ private:
    */
   Material::MaterialInsulator *mt;
 
+  /**
+   * slots of the 4 jacobian entries of each edge in DDM1 jacobian matrix,
+   * and the serial of the matrix slot locator they come from
+   */
+  std::vector<PetscInt> _ddm1_edge_slots;
+  unsigned int _ddm1_edge_slots_serial;
+
 
 public:
 
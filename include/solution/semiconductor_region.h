@@ -114,6 +114,32 @@ public:
   Material::MaterialSemiconductor * material() const
     {return mt;}
 
+  /**
+   * band parameters of a node which only depend on lattice temperature, doping and mole fraction
+   */
+  struct BandCache
+  {
+    PetscScalar T;   ///< lattice temperature the entry is evaluated at, negative for invalid entry
+    PetscScalar Eg;  ///< band gap without narrowing
+    PetscScalar Nc;  ///< effective density of states in the conduction band
+    PetscScalar Nv;  ///< effective density of states in the valence band
+    PetscScalar ni;  ///< intrinsic carrier concentration
+  };
+
+  /**
+   * @return band parameters of \p fvm_node at lattice temperature \p T.
+   * the entry is reevaluated only when T differs from the cached one, so an isothermal
+   * solver calls the PMI once per node, and a solver with lattice temperature once per T change.
+   * @note the material is mapped to \p fvm_node when the entry is reevaluated
+   */
+  const BandCache & band_cache(const FVM_Node * fvm_node, PetscScalar T) const;
+
+  /**
+   * drop all cached band parameters, should be called when doping or material models changed
+   */
+  void clear_band_cache() const
+  { _band_cache.clear(); }
+
   /**
    * @return the base class of material database
    */
@@ -268,18 +294,28 @@ private:
    */
   Material::MaterialSemiconductor *mt;
 
+  /**
+   * band parameters, indexed by FVM_NodeData::offset()
+   */
+  mutable std::vector<BandCache> _band_cache;
 
-private:
+  /**
+   * the Epn, Epp, Etn and Etp cell data hold the driving forces of the last residual evaluation
+   */
+  bool _mob_force_cached;
 
   /**
-   * @return true when highfield mobility enabled
+   * allocate the cell data of driving forces when required
    */
-  bool highfield_mobility() const;
+  void _mob_force_cache_allocate();
+
+
+private:
 
   /**
-   * @return truncated partial area associated with edge ne of elem
+   * @return true when highfield mobility enabled
    */
-  Real truncated_partial_area(const Elem * elem, unsigned int ne) const;
+  bool highfield_mobility() const;
 
   /**
    * elem has its circumcircle center outside the region
@@ -348,6 +384,11 @@ public:
    */
   virtual void DDM1_Jacobian(PetscScalar * x, Mat *jac, InsertMode &add_value_flag);
 
+  /**
+   * build function and its jacobian for L1 DDM in one AD pass
+   */
+  virtual void DDM1_Function_Jacobian(PetscScalar * x, Vec f, Mat *jac, InsertMode &add_value_flag);
+
   /**
    * build time derivative term and its jacobian for L1 DDM
    */
@@ -358,6 +399,16 @@ public:
    */
   virtual void DDM1_Time_Dependent_Jacobian(PetscScalar * x, Mat *jac, InsertMode &add_value_flag);
 
+  /**
+   * build time derivative term of harmonic balance sample for L1 DDM
+   */
+  virtual void DDM1_HB_Time_Derivative_Function(const PetscScalar * dxdt, Vec f, InsertMode &add_value_flag);
+
+  /**
+   * build coefficient of harmonic balance time derivative for L1 DDM
+   */
+  virtual void DDM1_HB_Time_Derivative_Jacobian(Mat *jac, InsertMode &add_value_flag);
+
   /**
    * function for evaluating pseudo time step of level 1 DDM equation.
    */
@@ -701,6 +752,72 @@ public:
                                std::vector< std::pair<double, double> > & mob,
                                std::vector< double > & weight) const;
 
+  /**
+   * drop the cell driving forces cached by the residual
+   */
+  virtual void Mob_Force_Invalidate()
+  { _mob_force_cached = false; }
+
+  /**
+   * @return true when the cell driving forces of high field mobility are filled by the
+   * last residual evaluation and can be read from cell data instead of evaluating again
+   */
+  bool mob_force_cached() const
+  { return _mob_force_cached; }
+
+
+  //////////////////////////////////////////////////////////////////////////////////
+  //-----------------  functions for nonlocal band band tunneling  ---------------//
+  //////////////////////////////////////////////////////////////////////////////////
+
+private:
+
+  /**
+   * nonlocal band band tunneling path. the valence band electron at the begin node
+   * tunnels to the conduction band at the end node, which is reached by walking
+   * along grad(psi) until the potential rises by Eg/q.
+   * paths are stored as flat arrays, indexed by path.
+   */
+  std::vector<const FVM_Node *>  _bbt_path_begin;
+
+  /**
+   * the end node of each tunneling path
+   */
+  std::vector<const FVM_Node *>  _bbt_path_end;
+
+  /**
+   * the length of each tunneling path
+   */
+  std::vector<Real>              _bbt_path_length;
+
+  /**
+   * local nodes and their potential when the tunneling paths were built
+   */
+  std::vector<std::pair<const FVM_Node *, PetscScalar> > _bbt_path_psi;
+
+  /**
+   * rebuild tunneling paths when the potential changed more than BBTNonlocalDPsi since last build
+   * @return true when the paths are rebuilt
+   */
+  bool update_bbt_nonlocal_path(const PetscScalar * x);
+
+  /**
+   * add the nonlocal band band tunneling generation into the continuity equations.
+   * lattice temperature is read from x at T_dof of the begin node, invalid_uint for isothermal solver
+   */
+  void BBT_Nonlocal_Function(const PetscScalar * x, Vec f, unsigned int T_dof);
+
+  /**
+   * add the jacobian of nonlocal band band tunneling generation, each path only couples its two end nodes
+   */
+  void BBT_Nonlocal_Jacobian(const PetscScalar * x, Mat *jac, unsigned int T_dof);
+
+public:
+
+  /**
+   * @return true when nonlocal band band tunneling enabled
+   */
+  bool bbt_nonlocal() const;
 
 };
 
@@ -191,6 +191,12 @@ public:
   FVM_CellData * get_region_elem_data(unsigned int n)
   { return _region_cell_data[n]; }
 
+  /**
+   * @return the electrical field of nth region elem. it is only used for output,
+   * so it is not stored but evaluated from the potential of elem vertices here
+   */
+  VectorValue<PetscScalar> cell_efield(unsigned int n) const;
+
   /**
    * @return the FVM Node number in this region
    * @note all the node are count. no matter which processor_id the node is.
@@ -233,6 +239,12 @@ public:
    */
   FVM_NodeData * region_node_data(unsigned int id) const;
 
+  /**
+   * @return the data storage of node data, indexed by FVM_NodeData::offset()
+   */
+  const DataStorage & node_data_storage() const
+  { return _node_data_storage; }
+
   /**
    * @return region's name
    */
@@ -415,6 +427,38 @@ public:
     return _region_processor_node.end();
   }
 
+  /**
+   * ghost node (on local but not on processor) default const begin() accessor
+   */
+  const_local_node_iterator ghost_nodes_begin        () const
+  {
+    return _region_ghost_node.begin();
+  }
+
+  /**
+   * ghost node default const end() accessor
+   */
+  const_local_node_iterator ghost_nodes_end          () const
+  {
+    return _region_ghost_node.end();
+  }
+
+  /**
+   * image node (on processor node which is ghost node of other processor) default const begin() accessor
+   */
+  const_processor_node_iterator image_nodes_begin        () const
+  {
+    return _region_image_node.begin();
+  }
+
+  /**
+   * image node default const end() accessor
+   */
+  const_processor_node_iterator image_nodes_end          () const
+  {
+    return _region_image_node.end();
+  }
+
 
 
   /**
@@ -466,7 +510,74 @@ public:
    * by given an element pointer, and the local index of the edge
    */
   unsigned int elem_edge_index(const Elem* elem, unsigned int e) const
-  { return _region_elem_edge_in_edges_index.find(elem)->second[e]; }
+  { return _region_cell_edge_index[cell_edge_offset(elem) + e]; }
+
+  /**
+   * @return the offset of the edges of \p elem in the cell edge tables,
+   * its local edge e is at offset+e
+   */
+  unsigned int cell_edge_offset(const Elem* elem) const
+  { return _region_elem_edge_offset.find(elem)->second; }
+
+  /**
+   * @return the location in _region_edges of the cell edge at \p offset
+   */
+  unsigned int cell_edge_index(unsigned int offset) const
+  { return _region_cell_edge_index[offset]; }
+
+  /**
+   * @return the truncated partial area of the cell edge at \p offset.
+   * it is the partial area of the edge scaled by the ratio of the truncated to the absolute
+   * control volume surface area between the edge nodes, always positive. built in prepare_for_use_parallel
+   */
+  Real cell_edge_truncated_partial_area(unsigned int offset) const
+  { return _region_cell_edge_truncated_area[offset]; }
+
+  /**
+   * @return the truncated partial volume of the cell edge at \p offset,
+   * the same as Elem::partial_volume_with_edge_truncated
+   */
+  Real cell_edge_truncated_partial_volume(unsigned int offset) const
+  { return _region_cell_edge_truncated_volume[offset]; }
+
+  /**
+   * @return the truncated partial area associated with edge ne of elem
+   */
+  Real truncated_partial_area(const Elem * elem, unsigned int ne) const
+  { return _region_cell_edge_truncated_area[cell_edge_offset(elem) + ne]; }
+
+  /**
+   * @return the truncated partial volume associated with edge ne of elem
+   */
+  Real truncated_partial_volume(const Elem * elem, unsigned int ne) const
+  { return _region_cell_edge_truncated_volume[cell_edge_offset(elem) + ne]; }
+
+  /**
+   * @return the control volume surface area of the e-th edge in _region_edges,
+   * the same as edge.first->cv_surface_area(edge.second) but without searching neighbors
+   */
+  Real edge_cv_surface_area(unsigned int e) const
+  { return _region_edge_cv_surface_area[e]; }
+
+  /**
+   * @return the length of the e-th edge in _region_edges
+   */
+  Real edge_length(unsigned int e) const
+  { return _region_edge_length[e]; }
+
+  /**
+   * build the local pseudo time step factor of on processor nodes, dt_i = dt*s_i/<s>,
+   * where s_i = V_i/sum_j(A_ij/L_ij) is the diffusive time scale of the control volume
+   * and <s> its region average. the factor is limited to [1e-3, 1e3].
+   * clear the factors when \p local is false. collective call.
+   */
+  void build_pseudo_time_step_scale(bool local);
+
+  /**
+   * @return the local pseudo time step factor of the n-th on processor node, 1 when not built
+   */
+  Real pseudo_time_step_scale(unsigned int n) const
+  { return _pseudo_time_step_scale.empty() ? 1.0 : _pseudo_time_step_scale[n]; }
 
   /**
    * (re)build _region_local_node and _region_processor_node for fast iteration
@@ -599,6 +710,14 @@ public:
   template <typename T>
   bool sync_point_variable(const std::string &v);
 
+  /**
+   * sync several point variables (of any data type) with ghost node,
+   * all the variables are packed into one message for each neighbor processor.
+   * must executed in parallel.
+   * @return true for success
+   */
+  bool sync_point_variables(const std::vector<std::string> &vs);
+
   /**
    * @return the optical refraction index of the region
    */
@@ -680,6 +799,12 @@ public:
    */
   void add_hanging_node_on_edge(const Node * node, const Elem * elem, unsigned int e);
 
+  /**
+   * build the constraint of each hanging node, the FVM nodes on the element side/edge it depends on.
+   * call it after all the hanging nodes are added, it is a collective operation
+   */
+  void prepare_hanging_node();
+
   /**
    * @return the number of hanging nodes on element side
    */
@@ -694,8 +819,8 @@ public:
   { return _hanging_node_on_elem_edge.size(); }
 
 
-  typedef std::map<const FVM_Node *, std::pair<const Elem *, unsigned int> >::const_iterator       hanging_node_on_elem_side_iterator;
-  typedef std::map<const FVM_Node *, std::pair<const Elem *, unsigned int> >::const_iterator       hanging_node_on_elem_edge_iterator;
+  typedef std::vector< std::pair<const FVM_Node *, std::pair<const Elem *, unsigned int> > >::const_iterator       hanging_node_on_elem_side_iterator;
+  typedef std::vector< std::pair<const FVM_Node *, std::pair<const Elem *, unsigned int> > >::const_iterator       hanging_node_on_elem_edge_iterator;
 
   /**
    * const hanging_node_on_elem_side begin() accessor
@@ -729,12 +854,49 @@ public:
     return _hanging_node_on_elem_edge.end();
   }
 
+  /**
+   * @return the FVM nodes on the element side which the hanging node depends on, n is the number of them
+   */
+  const FVM_Node * const * hanging_node_on_elem_side_constraint(hanging_node_on_elem_side_iterator it, unsigned int &n) const
+  {
+    const unsigned int i = it - _hanging_node_on_elem_side.begin();
+    n = _hanging_node_on_elem_side_constraint_offset[i+1] - _hanging_node_on_elem_side_constraint_offset[i];
+    return &_hanging_node_on_elem_side_constraint[_hanging_node_on_elem_side_constraint_offset[i]];
+  }
+
+  /**
+   * @return the FVM nodes on the element edge which the hanging node depends on, n is the number of them
+   */
+  const FVM_Node * const * hanging_node_on_elem_edge_constraint(hanging_node_on_elem_edge_iterator it, unsigned int &n) const
+  {
+    const unsigned int i = it - _hanging_node_on_elem_edge.begin();
+    n = _hanging_node_on_elem_edge_constraint_offset[i+1] - _hanging_node_on_elem_edge_constraint_offset[i];
+    return &_hanging_node_on_elem_edge_constraint[_hanging_node_on_elem_edge_constraint_offset[i]];
+  }
+
 
   /**
    * approx memory usage
    */
   virtual size_t memory_size() const;
 
+  /**
+   * add the approx memory usage of this region to the breakdown, indexed by subsystem name
+   */
+  virtual void memory_usage(std::map<std::string, size_t> & usage) const;
+
+  /**
+   * write node and cell data blocks of this region to binary stream
+   */
+  void write_checkpoint(std::ostream & out) const;
+
+  /**
+   * read node and cell data blocks written by write_checkpoint().
+   * the region should be built from the same mesh and partition.
+   * @return false if the data layout does not match this region
+   */
+  bool read_checkpoint(std::istream & in);
+
 protected:
 
   /**
@@ -824,6 +986,16 @@ protected:
    */
   std::vector<FVM_Node *>    _region_image_node;
 
+  /**
+   * ghost sync plan, the image nodes to be sent to each neighbor processor, ordered by node id
+   */
+  std::map<unsigned int, std::vector<const FVM_Node *> > _ghost_sync_send;
+
+  /**
+   * ghost sync plan, the ghost nodes to be received from each neighbor processor, ordered by node id
+   */
+  std::map<unsigned int, std::vector<const FVM_Node *> > _ghost_sync_recv;
+
   /**
    * data block for node based value
    */
@@ -836,18 +1008,47 @@ protected:
   std::vector< std::pair<FVM_Node *, FVM_Node *> > _region_edges;
 
   /**
-   * the corresponding location of an element's edge in _region_edges
-   * by given an element pointer, and the local index of the edge
+   * control volume surface area of each edge in _region_edges, in the same order
+   * build once after fvm mesh is ready, for fast FVM integral
+   */
+  std::vector<Real> _region_edge_cv_surface_area;
+
+  /**
+   * length of each edge in _region_edges, in the same order
+   */
+  std::vector<Real> _region_edge_length;
+
+  /**
+   * local pseudo time step factor of each node in _region_processor_node, in the same order
+   */
+  std::vector<Real> _pseudo_time_step_scale;
+
+  /**
+   * the offset of the edges of an element in the cell edge tables below
    * use unordered_map when possible
    */
 #if defined(HAVE_UNORDERED_MAP)
-    std::unordered_map<const Elem *, std::vector<unsigned int> > _region_elem_edge_in_edges_index;
+    std::unordered_map<const Elem *, unsigned int> _region_elem_edge_offset;
 #elif defined(HAVE_TR1_UNORDERED_MAP) || defined(HAVE_TR1_UNORDERED_MAP_WITH_STD_HEADER)
-    std::tr1::unordered_map<const Elem *, std::vector<unsigned int> > _region_elem_edge_in_edges_index;
+    std::tr1::unordered_map<const Elem *, unsigned int> _region_elem_edge_offset;
 #else
-    std::map<const Elem *, std::vector<unsigned int> > _region_elem_edge_in_edges_index;
+    std::map<const Elem *, unsigned int> _region_elem_edge_offset;
 #endif
 
+  /**
+   * cell edge tables, the edges of each element in _region_cell order:
+   * the location of the edge in _region_edges, its truncated partial area and volume
+   */
+  std::vector<unsigned int> _region_cell_edge_index;
+  std::vector<Real> _region_cell_edge_truncated_area;
+  std::vector<Real> _region_cell_edge_truncated_volume;
+
+  /**
+   * @return truncated partial area associated with edge ne of elem, computed from the
+   * control volume surface areas
+   */
+  Real _truncated_partial_area(const Elem * elem, unsigned int ne) const;
+
 
   /**
    * the boundingbox of the region
@@ -864,7 +1065,17 @@ protected:
    * for 2D case, the side is an edge. hanging node lies on edge center
    * for 3D case, only the Quad4 side has center hanging node
    */
-  std::map<const FVM_Node *, std::pair<const Elem *, unsigned int> >  _hanging_node_on_elem_side;
+  std::vector< std::pair<const FVM_Node *, std::pair<const Elem *, unsigned int> > >  _hanging_node_on_elem_side;
+
+  /**
+   * the FVM nodes on the element side each hanging node depends on, in compressed row storage
+   */
+  std::vector<const FVM_Node *>  _hanging_node_on_elem_side_constraint;
+
+  /**
+   * offset of each hanging node in _hanging_node_on_elem_side_constraint
+   */
+  std::vector<unsigned int>      _hanging_node_on_elem_side_constraint_offset;
 
 
   /**
@@ -872,7 +1083,17 @@ protected:
    * this is for 3D case only.
    * maybe several elem shares the same hanging node. we record only one
    */
-  std::map<const FVM_Node *, std::pair<const Elem *, unsigned int> >  _hanging_node_on_elem_edge;
+  std::vector< std::pair<const FVM_Node *, std::pair<const Elem *, unsigned int> > >  _hanging_node_on_elem_edge;
+
+  /**
+   * the FVM nodes on the element edge each hanging node depends on, in compressed row storage
+   */
+  std::vector<const FVM_Node *>  _hanging_node_on_elem_edge_constraint;
+
+  /**
+   * offset of each hanging node in _hanging_node_on_elem_edge_constraint
+   */
+  std::vector<unsigned int>      _hanging_node_on_elem_edge_constraint_offset;
 
 
   bool _hanging_node_on_elem_side_flag;
@@ -990,7 +1211,8 @@ public:
    * @param x                global solution vector
    * @param L                the left scaling vector, usually contains the cell volumn
    * @note fill items of global solution vector with belongs to local processor
-   * each derived region should override it
+   * each derived region should override it. the dofs of on processor nodes are owned
+   * by this processor, so the DDM1/DDM2 regions write them to the local arrays of x and L directly
    */
   virtual void DDM1_Fill_Value(Vec x, Vec L)=0;
 
@@ -1016,6 +1238,23 @@ public:
    */
   virtual void DDM1_Jacobian(PetscScalar * x, Mat *jac, InsertMode &add_value_flag)=0;
 
+  /**
+   * @brief virtual function for evaluating function and Jacobian of level 1 DDM equation in one pass.
+   *
+   * @param x                local unknown vector
+   * @param f                petsc global function vector
+   * @param jac              petsc global jacobian matrix
+   * @param add_value_flag   flag for last operator is ADD_VALUES
+   *
+   * @note the default evaluates them separately, region with AD kernel may override it
+   */
+  virtual void DDM1_Function_Jacobian(PetscScalar * x, Vec f, Mat *jac, InsertMode &add_value_flag)
+  {
+    InsertMode jac_add_value_flag = add_value_flag;
+    this->DDM1_Function(x, f, add_value_flag);
+    this->DDM1_Jacobian(x, jac, jac_add_value_flag);
+  }
+
   /**
    * @brief virtual function for evaluating time derivative term of level 1 DDM equation.
    *
@@ -1038,6 +1277,29 @@ public:
    */
   virtual void DDM1_Time_Dependent_Jacobian(PetscScalar * x, Mat *jac, InsertMode &add_value_flag)=0;
 
+  /**
+   * @brief virtual function for evaluating time derivative term of level 1 DDM equation
+   * at a harmonic balance sample, the derivative of the solution is given.
+   *
+   * @param dxdt             local vector of the time derivative of unknowns
+   * @param f                petsc global function vector
+   * @param add_value_flag   flag for last operator is ADD_VALUES
+   *
+   * @note only region with time derivative term should override it
+   */
+  virtual void DDM1_HB_Time_Derivative_Function(const PetscScalar * , Vec , InsertMode &) {}
+
+  /**
+   * @brief virtual function for evaluating the coefficient of harmonic balance time derivative,
+   * which is the jacobian of DDM1_HB_Time_Derivative_Function to dxdt.
+   *
+   * @param jac              petsc global jacobian matrix
+   * @param add_value_flag   flag for last operator is ADD_VALUES
+   *
+   * @note only region with time derivative term should override it
+   */
+  virtual void DDM1_HB_Time_Derivative_Jacobian(Mat *, InsertMode &) {}
+
 
   /**
    * @brief virtual function for evaluating pseudo time step of level 1 DDM equation.
@@ -1904,6 +2166,14 @@ public:
                                std::vector< std::pair<double, double> > & mob,
                                std::vector< double > & weight) const {}
 
+  /**
+   * @brief virtual function, drop the cell driving forces of high field mobility cached by the residual.
+   *
+   * called before each solve action, the cache is valid again after the next residual evaluation
+   * of a solver which fills it
+   */
+  virtual void Mob_Force_Invalidate() {}
+
 
 };
 
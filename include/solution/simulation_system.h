@@ -24,7 +24,10 @@
 #ifndef __simulation_system_h__
 #define __simulation_system_h__
 
+#include <map>
+#include <vector>
 
+#include "point.h"
 #include "vector_value.h"
 #include "enum_solution.h"
 #include "enum_solver_specify.h"
@@ -43,6 +46,7 @@ class BoundaryConditionCollector;
 class ElectricalSource;
 class FieldSource;
 class SPICE_CKT;
+class ElemNodeDeposition;
 
 /**
  * @brief the main structure for mesh and solution data storage
@@ -130,8 +134,9 @@ public:
 
   /**
    * @brief the main saving / loading mechanism, from cgnsfile
+   * when parallel_read is true, every processor reads the file instead of processor 0 only
    */
-  void import_cgns(const std::string& filename);
+  void import_cgns(const std::string& filename, bool parallel_read=false);
 
   /**
    * @brief load system from xml vtk file, only for debug reason
@@ -164,6 +169,14 @@ public:
    */
   void export_cgns(const std::string& filename) const;
 
+  /**
+   * @brief write solution to HDF5 file with a XDMF descriptor.
+   * with append, the solution is added as a new step of time if the file holds the same mesh.
+   * each processor writes its own part, the mesh is not gathered
+   */
+  void export_hdf5(const std::string& filename, bool append=false, double time=0.0,
+                   bool float32=false, int compression=1) const;
+
   /**
    * @brief save mesh and doping to df-ise file
    */
@@ -171,8 +184,12 @@ public:
 
   /**
    * @brief export solution to vtk file
+   * when async_queue is not zero, XML VTK file is written by a background thread
+   * with at most async_queue files waiting.
+   * a .pvtu file name selects the parallel output, one .vtu piece per processor,
+   * with Float32 fields when float32 is true
    */
-  void export_vtk(const std::string& filename, bool ascii) const;
+  void export_vtk(const std::string& filename, bool ascii, unsigned int async_queue=0, bool float32=false) const;
 
   /**
    * @brief write geometry and material info to gdml file
@@ -189,6 +206,16 @@ public:
    */
   void export_node_location(const std::string& filename, const PetscScalar unit, const bool number=true) const;
 
+  /**
+   * @brief save binary checkpoint (region data, transient and external circuit state), one file per processor
+   */
+  void export_checkpoint(const std::string& filename) const;
+
+  /**
+   * @brief reload binary checkpoint into a system built from the same mesh and processor number
+   */
+  void import_checkpoint(const std::string& filename);
+
   /**
    * @return true if the system is empty
    */
@@ -279,6 +306,12 @@ public:
   const VectorValue<double> & get_magnetic_field() const
   { return _magnetic_field; }
 
+  /**
+   * set magnetic field, used by B sweep
+   */
+  void set_magnetic_field(const VectorValue<double> & B)
+  { _magnetic_field = B; }
+
   /**
    * @return circuit data
    */
@@ -312,6 +345,25 @@ public:
    */
   double z_width() const;
 
+  /**
+   * @return the number of identical devices, connected in parallel, this system stands for
+   * in mixed-mode simulation. electrode currents stamped into the circuit are scaled by it,
+   * so one mesh can represent a multi-finger or arrayed device.
+   */
+  double device_multiplicity() const { return _device_multiplicity; }
+
+  /**
+   * @return the revision of simulation data structure, it increases each time the system is built from mesh.
+   * solvers use it to judge if cached mesh dependent data is still valid
+   */
+  unsigned int mesh_revision() const { return _mesh_revision; }
+
+  /**
+   * @return the operator which deposits element integrated quantity to node density,
+   * built at the first call after each rebuild of the system
+   */
+  const ElemNodeDeposition & elem_node_deposition() const;
+
   /**
    * @return ture when system is self consistent (semiconductor region satisfy poisson's equation)
    */
@@ -323,6 +375,19 @@ public:
    */
   void estimate_error (const Parser::Card &c, ErrorVector & error_per_cell) const;
 
+  /**
+   * compute the error for each cell belongs to this processor, without any communication.
+   * "error_per_cell" is sized by max elem id, the entries of other processors' cells are zero.
+   */
+  void estimate_local_error (const Parser::Card &c, ErrorVector & error_per_cell) const;
+
+  /**
+   * set the partition weight of each subdomain from the node dofs of the solver,
+   * the assembly cost grows with the square of node dofs (jacobian block size).
+   * the dofs themselves are balanced as the second constraint
+   */
+  void set_partition_weight(const std::vector<unsigned int> & subdomain_node_dofs);
+
   /**
    * fill system data (mesh and node data) into interpolator for later usage
    * type can be -- linear interpolation
@@ -336,6 +401,20 @@ public:
    */
   void do_interpolation(const InterpolationBase *, const std::string &);
 
+  /**
+   * save the nodal solution (potential, carrier densities and temperatures) of each region
+   * before hierarchical mesh refinement, keyed by node location
+   */
+  void backup_node_solution();
+
+  /**
+   * restore the nodal solution after hierarchical mesh refinement. nodes existing before refinement
+   * get their old value, the new nodes get the value prolongated by the shape functions of parent elem,
+   * level by level through the element hierarchy. carrier densities are prolongated in log scale.
+   * should be called after init_region
+   */
+  void restore_node_solution();
+
   /**
    * set unique solver name to _solver_active_history
    */
@@ -354,6 +433,11 @@ public:
    */
   virtual size_t memory_size() const;
 
+  /**
+   * add the approx memory usage of mesh and all the regions to the breakdown, indexed by subsystem name
+   */
+  void memory_usage(std::map<std::string, size_t> & usage) const;
+
 private:
 
   /**
@@ -387,6 +471,27 @@ private:
    */
   bool _block_partition;
 
+  /**
+   * the elem/node ordering (MeshBase::ElemOrdering) applied before building fvm mesh
+   */
+  int _mesh_ordering;
+
+  /**
+   * delete remote elements on processor 0 as well, the whole mesh is
+   * only gathered to processor 0 temporarily by the exporters which need it
+   */
+  bool _distributed_mesh;
+
+  /**
+   * gather the whole mesh to processor 0 before writing a global mesh file
+   */
+  void _gather_mesh_for_output() const;
+
+  /**
+   * delete the remote elements gathered by _gather_mesh_for_output()
+   */
+  void _release_mesh_after_output() const;
+
   /**
    * data structure for fvm solver
    * only build nodes which belongs to local processor
@@ -430,6 +535,39 @@ private:
    */
   double  _z_width;
 
+  /**
+   * number of identical parallel devices represented by this system in mixed-mode simulation
+   */
+  double  _device_multiplicity;
+
+  /**
+   * revision of simulation data structure
+   */
+  unsigned int _mesh_revision;
+
+  /**
+   * elem to node deposition operator of current mesh revision
+   */
+  mutable ElemNodeDeposition * _elem_node_deposition;
+
+  /**
+   * lexicographic order of node location, used to find the same node after mesh refinement
+   */
+  struct PointLess
+  {
+    bool operator() (const Point &a, const Point &b) const
+    {
+      if( a(0) != b(0) ) return a(0) < b(0);
+      if( a(1) != b(1) ) return a(1) < b(1);
+      return a(2) < b(2);
+    }
+  };
+
+  /**
+   * nodal solution of each region saved by backup_node_solution
+   */
+  std::vector< std::map<Point, std::vector<Real>, PointLess> > _node_solution_backup;
+
   /**
    * each solver should record itself in this _solver_active_history vector when active
    * we can determine the solve sequence by this vector
@@ -0,0 +1,106 @@
+/********************************************************************************/
+/*     888888    888888888   88     888  88888   888      888    88888888       */
+/*   8       8   8           8 8     8     8      8        8    8               */
+/*  8            8           8  8    8     8      8        8    8               */
+/*  8            888888888   8   8   8     8      8        8     8888888        */
+/*  8      8888  8           8    8  8     8      8        8            8       */
+/*   8       8   8           8     8 8     8      8        8            8       */
+/*     888888    888888888  888     88   88888     88888888     88888888        */
+/*                                                                              */
+/*       A Three-Dimensional General Purpose Semiconductor Simulator.           */
+/*                                                                              */
+/*                                                                              */
+/*  Copyright (C) 2007-2008                                                     */
+/*  Cogenda Pte Ltd                                                             */
+/*                                                                              */
+/*  Please contact Cogenda Pte Ltd for license information                      */
+/*                                                                              */
+/*  Author: Gong Ding   gdiso@ustc.edu                                          */
+/*                                                                              */
+/********************************************************************************/
+
+
+#ifndef __solution_cache_h__
+#define __solution_cache_h__
+
+// C++ includes
+#include <string>
+#include <vector>
+
+// Local includes
+#include "genius_common.h"
+
+class SimulationSystem;
+
+
+/**
+ * On-disk cache of converged solutions, indexed by the electrode bias vector.
+ * The cache of a device lives in files named by prefix and a fingerprint of
+ * mesh, doping, temperature, materials and processor number, so solutions of a
+ * different device are never mixed in:
+ *   prefix.<fingerprint>.idx       bias vector of each cached point, written by processor 0
+ *   prefix.<fingerprint>.<k>[.p]   node data and external circuit state of point k, per processor
+ * A sweep is started from the nearest cached point instead of the solution in memory
+ * when it is closer to the first bias point.
+ */
+class SolutionCache
+{
+public:
+  /**
+   * constructor, read the index of the cache. the fingerprint is collective
+   */
+  SolutionCache(SimulationSystem & system, const std::string & prefix);
+
+  /**
+   * @return the applied voltage (current for current driven electrode) of all the electrodes, in V and A
+   */
+  std::vector<Real> bias() const;
+
+  /**
+   * load the cached point nearest to the current bias into the system when it is closer than
+   * the solution in memory, the electrode potential gives the bias of the solution in memory.
+   * @return true if a cached point is loaded
+   */
+  bool load_nearest();
+
+  /**
+   * store the converged solution of the current bias
+   */
+  void store();
+
+  /**
+   * @return number of cached points
+   */
+  unsigned int n_points() const
+  { return _n_points; }
+
+private:
+
+  SimulationSystem & _system;
+
+  /**
+   * prefix.fingerprint
+   */
+  std::string _stem;
+
+  /**
+   * bias vector of cached points, flat array of _n_points*_n_bias
+   */
+  std::vector<Real> _points;
+
+  unsigned int _n_points;
+
+  unsigned int _n_bias;
+
+  /**
+   * file of cached point k on this processor
+   */
+  std::string _data_file(unsigned int k) const;
+
+  /**
+   * euclidean distance of two bias vectors
+   */
+  static Real _distance(const Real * a, const Real * b, unsigned int n);
+};
+
+#endif // #define __solution_cache_h__
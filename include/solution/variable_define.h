@@ -34,7 +34,7 @@ struct SimulationVariable
 
   SimulationVariable(const std::string &name, DataType data_type, DataLocation data_location,
                      const std::string & unit_string="", unsigned int index=static_cast<unsigned int>(-1),
-                     bool valid=true, bool user_defined=false);
+                     bool valid=true, bool user_defined=false, bool single_precision=false);
 
   std::string   variable_name;
   DataType      variable_data_type;
@@ -44,6 +44,12 @@ struct SimulationVariable
   unsigned int  variable_index;
   bool          variable_valid;
   bool          variable_user_defined;
+
+  /**
+   * scalar variable stored in float. used by auxiliary and output only variables,
+   * they are converted to double at access.
+   */
+  bool          variable_single_precision;
 };
 
 
@@ -27,6 +27,7 @@
 // C++ includes
 #include <map>
 #include <fstream>
+#include <algorithm>
 
 // Local includes
 #include "genius_common.h"
@@ -81,8 +82,46 @@ public:
    */
   virtual void write (const std::string& );
 
+  /**
+   * when flag is true, processor 0 hands the assembled vtu grid to a background thread
+   * for writing and returns immediately. at most queue_size grids wait for writing,
+   * further write() calls block until the writer thread frees a slot.
+   * only effective for XML VTK output
+   */
+  void set_async(bool flag, unsigned int queue_size=2)
+  {
+    _async = flag;
+    _async_queue_size = std::max(queue_size, 1u);
+  }
+
+  /**
+   * block until all the queued vtu files are written
+   */
+  static void wait_async();
+
+  /**
+   * write the fields of the parallel .pvtu output in Float32 instead of Float64
+   */
+  void set_float32(bool flag)
+  { _float32 = flag; }
+
 private:
 
+  /**
+   * background writing
+   */
+  bool _async;
+
+  /**
+   * max grids in writing queue
+   */
+  unsigned int _async_queue_size;
+
+  /**
+   * Float32 fields in pvtu output
+   */
+  bool _float32;
+
   // boundary info
   std::vector<unsigned int>       _el;
   std::vector<unsigned short int> _sl;
@@ -97,6 +136,13 @@ private:
    */
   void _smooth_numerical_error(std::map<unsigned int, float> &, float tol);
 
+  /**
+   * every processor writes the elements it owns, with the nodes they use, into its own
+   * .vtu piece as raw appended binary data. processor 0 writes the .pvtu index.
+   * nothing is gathered, and the VTK library is not required
+   */
+  void write_pvtu(const MeshBase& mesh, const std::string& name);
+
 #ifdef HAVE_VTK
   /**
    * write the nodes from the mesh into a vtkUnstructuredGrid
@@ -163,6 +209,8 @@ private:
   vtkUnstructuredGrid* _vtk_grid;
 
   class XMLUnstructuredGridWriter;
+
+  class AsyncGridWriter;
 #endif
 
   /**
@@ -239,7 +287,8 @@ private:
 inline
 VTKIO::VTKIO (SimulationSystem& system) :
     FieldInput<SimulationSystem> (system),
-    FieldOutput<SimulationSystem> (system)
+    FieldOutput<SimulationSystem> (system),
+    _async(false), _async_queue_size(2), _float32(false)
 {
 #ifdef HAVE_VTK
   _vtk_grid = NULL;
@@ -250,7 +299,8 @@ VTKIO::VTKIO (SimulationSystem& system) :
 
 inline
 VTKIO::VTKIO (const SimulationSystem& system) :
-    FieldOutput<SimulationSystem>(system)
+    FieldOutput<SimulationSystem>(system),
+    _async(false), _async_queue_size(2), _float32(false)
 {
 #ifdef HAVE_VTK
   _vtk_grid = NULL;
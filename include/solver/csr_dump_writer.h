@@ -0,0 +1,94 @@
+/********************************************************************************/
+/*     888888    888888888   88     888  88888   888      888    88888888       */
+/*   8       8   8           8 8     8     8      8        8    8               */
+/*  8            8           8  8    8     8      8        8    8               */
+/*  8            888888888   8   8   8     8      8        8     8888888        */
+/*  8      8888  8           8    8  8     8      8        8            8       */
+/*   8       8   8           8     8 8     8      8        8            8       */
+/*     888888    888888888  888     88   88888     88888888     88888888        */
+/*                                                                              */
+/*       A Three-Dimensional General Purpose Semiconductor Simulator.           */
+/*                                                                              */
+/*                                                                              */
+/*  Copyright (C) 2007-2008                                                     */
+/*  Cogenda Pte Ltd                                                             */
+/*                                                                              */
+/*  Please contact Cogenda Pte Ltd for license information                      */
+/*                                                                              */
+/*  Author: Gong Ding   gdiso@ustc.edu                                          */
+/*                                                                              */
+/********************************************************************************/
+
+
+#ifndef __csr_dump_writer_h__
+#define __csr_dump_writer_h__
+
+#include <string>
+#include <vector>
+
+
+/**
+ * the local rows of a matrix in CSR form, with optional rhs entries of the same rows.
+ * a private copy, the solver may change the matrix as soon as the dump is queued
+ */
+struct CSRDump
+{
+  /// global size of the matrix
+  unsigned long long n_rows;
+  unsigned long long n_cols;
+
+  /// first global row held by this dump
+  unsigned long long row_begin;
+
+  /// n_local_rows+1 offsets into cols/vals
+  std::vector<unsigned long long> row_ptr;
+  std::vector<long long>          cols;
+  std::vector<double>             vals;
+
+  /// rhs entries of the local rows, may be empty
+  std::vector<double>             rhs;
+
+  std::string filename;
+};
+
+
+/**
+ * write CSRDump to binary file. the index part is compressed:
+ *
+ *   char[8]  "GCSR" 0 0 0 1
+ *   uint64   n_rows, n_cols, row_begin, n_local_rows, nnz, n_rhs
+ *   varint   nnz of each local row
+ *   varint   zigzag coded column delta of each entry, the first delta of a row
+ *            is taken to the (global) row index, the later ones to the previous column
+ *   double   nnz values
+ *   double   n_rhs rhs entries
+ *
+ * integers are little endian, varint is 7 bits per byte, low group first.
+ * most columns are close to their row, a column costs 1 or 2 bytes instead of 8.
+ *
+ * the coding and file io are done by a single background thread with a bounded queue,
+ * except on windows, where they are done by the caller.
+ */
+class CSRDumpWriter
+{
+public:
+
+  /**
+   * queue the dump for writing, take the ownership of dump.
+   * block when queue_size dumps are already waiting
+   */
+  static void push(CSRDump * dump, unsigned int queue_size=2);
+
+  /**
+   * wait until all the queued dumps are written
+   */
+  static void wait();
+
+  /**
+   * code and write the dump at once
+   */
+  static bool write(const CSRDump & dump);
+};
+
+
+#endif
@@ -34,7 +34,7 @@
 class DDM1Solver : public DDMSolverBase
 {
 public:
-  DDM1Solver(SimulationSystem & system): DDMSolverBase(system)
+  DDM1Solver(SimulationSystem & system): DDMSolverBase(system), _hb_dxdt(PETSC_NULL), _hb_mass_jacobian(false), _fused_pass(false)
   {system.record_active_solver(this->solver_type());}
 
 
@@ -177,6 +177,17 @@ public:
    */
   virtual void build_petsc_sens_jacobian(Vec x, Mat *jac, Mat *pc);
 
+  /**
+   * wrap function for evaluating the residual and Jacobian at x in one pass
+   */
+  virtual bool build_petsc_sens_residual_jacobian(Vec x, Vec r);
+
+  /**
+   * DDML1 regions build the Jacobian with the residual
+   */
+  virtual bool fused_assembly_support() const
+  { return true; }
+
   /**
    * set electrode dI/dV for IV trace
    */
@@ -228,6 +239,11 @@ public:
    */
   virtual void error_norm();
 
+  /**
+   * the local offsets of each variable for error norm and LTE
+   */
+  virtual void build_norm_index();
+
   /**
    * function for convergence test of pseudo time step method
    */
@@ -235,6 +251,29 @@ public:
 
 private:
 
+  friend class DDM1HarmonicBalance;
+
+  /**
+   * periodic steady state under periodic sources by harmonic balance
+   */
+  void solve_harmonic_balance();
+
+  /**
+   * local vector of the time derivative of solution at current harmonic balance sample,
+   * PETSC_NULL when harmonic balance is not running
+   */
+  Vec  _hb_dxdt;
+
+  /**
+   * assemble the coefficient of harmonic balance time derivative into jacobian
+   */
+  bool _hb_mass_jacobian;
+
+  /**
+   * the residual evaluation builds the region Jacobian as well
+   */
+  bool _fused_pass;
+
   /**
    * Potential Newton damping scheme
    */
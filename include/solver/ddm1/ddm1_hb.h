@@ -0,0 +1,195 @@
+/********************************************************************************/
+/*     888888    888888888   88     888  88888   888      888    88888888       */
+/*   8       8   8           8 8     8     8      8        8    8               */
+/*  8            8           8  8    8     8      8        8    8               */
+/*  8            888888888   8   8   8     8      8        8     8888888        */
+/*  8      8888  8           8    8  8     8      8        8            8       */
+/*   8       8   8           8     8 8     8      8        8            8       */
+/*     888888    888888888  888     88   88888     88888888     88888888        */
+/*                                                                              */
+/*       A Three-Dimensional General Purpose Semiconductor Simulator.           */
+/*                                                                              */
+/*                                                                              */
+/*  Copyright (C) 2007-2008                                                     */
+/*  Cogenda Pte Ltd                                                             */
+/*                                                                              */
+/*  Please contact Cogenda Pte Ltd for license information                      */
+/*                                                                              */
+/*  Author: Gong Ding   gdiso@ustc.edu                                          */
+/*                                                                              */
+/********************************************************************************/
+
+#ifndef __ddm1_hb_h__
+#define __ddm1_hb_h__
+
+#include <vector>
+
+#include "petscksp.h"
+
+class DDM1Solver;
+
+/**
+ * harmonic balance of level 1 DDM, solves the periodic steady state under periodic sources directly.
+ * the unknowns are the solutions at N=2H+1 equally spaced time points of one period. the residual of
+ * each sample is the steady-state residual of DDM1 with sources at the sample time, plus the carrier
+ * time derivative given by spectral differentiation over the samples.
+ *
+ * the newton equation J_k dx_k + C (D dx)_k = F_k is solved by GMRES with the matrix free operator
+ * built from the jacobian of each sample J_k and the coefficient C of time derivative.
+ * the preconditioner replaces J_k by the DC jacobian, then the operator is block-circulant and
+ * decouples by DFT over the samples into (J_dc + i h w C) for each harmonic h, which is solved
+ * in the real 2x2 form of DDMAC.
+ *
+ * lumped capacitance of external circuit is not included, the samples are solved as steady state.
+ */
+class DDM1HarmonicBalance
+{
+public:
+
+  DDM1HarmonicBalance(DDM1Solver & solver);
+
+  ~DDM1HarmonicBalance();
+
+  /**
+   * newton iteration from the present solution of solver as the initial guess of all the samples
+   * @return true when converged
+   */
+  bool solve();
+
+  /**
+   * write the samples to system one by one, each one calls post_solve_process of solver
+   */
+  void write_samples();
+
+  /**
+   * y = J_hb v
+   */
+  void jacobian_mult(Vec v, Vec y);
+
+  /**
+   * y = P^-1 r with the block-circulant preconditioner
+   */
+  void preconditioner_apply(Vec r, Vec y);
+
+private:
+
+  DDM1Solver & _solver;
+
+  /**
+   * number of harmonics
+   */
+  unsigned int _n_harmonic;
+
+  /**
+   * number of samples, 2*_n_harmonic+1
+   */
+  unsigned int _n_sample;
+
+  /**
+   * angular frequency of the fundamental
+   */
+  PetscScalar  _omega;
+
+  /**
+   * local size of the solution vector of each sample
+   */
+  PetscInt     _n_local;
+
+  /**
+   * spectral differentiation matrix over the samples, row major
+   */
+  std::vector<PetscScalar> _D;
+
+  /**
+   * cos and sin of h*w*t_k, row major in harmonic
+   */
+  std::vector<PetscScalar> _cos;
+  std::vector<PetscScalar> _sin;
+
+  /**
+   * harmonic components of preconditioner, the DC one followed by the real and imaginary
+   * parts of each harmonic
+   */
+  std::vector<PetscScalar> _spectrum;
+
+  /**
+   * unknowns, residual and newton update of all the samples, the local part of each
+   * sample is stored one after another. _X0 keeps the unknowns during line search
+   */
+  Vec _X, _F, _dX, _X0;
+
+  /**
+   * vectors of one sample, _xa and _xb have their array placed in the sample vectors
+   */
+  Vec _xa, _xb, _w, _b, _y;
+
+  /**
+   * local vector of time derivative, ghost entries included
+   */
+  Vec _ldxdt;
+
+  /**
+   * vectors of the 2x2 real form
+   */
+  Vec _b2, _y2;
+
+  /**
+   * jacobian of each sample
+   */
+  std::vector<Mat> _J;
+
+  /**
+   * DC jacobian and the coefficient of time derivative
+   */
+  Mat _Jdc, _C;
+
+  /**
+   * matrix of each harmonic in 2x2 real form, the first one is not used
+   */
+  std::vector<Mat> _K;
+
+  /**
+   * linear solver of each harmonic
+   */
+  std::vector<KSP> _sub_ksp;
+
+  /**
+   * matrix free operator and GMRES solver of the newton equation
+   */
+  Mat _A;
+  KSP _ksp;
+
+  /**
+   * set sources and clock to sample k
+   */
+  void set_sample(unsigned int k);
+
+  /**
+   * time derivative of sample k by spectral differentiation of x, into _ldxdt.
+   * _w holds the global one.
+   */
+  void time_derivative(const PetscScalar *x, unsigned int k);
+
+  /**
+   * residual of all the samples
+   */
+  void residual(Vec X, Vec F);
+
+  /**
+   * jacobian of each sample
+   */
+  void jacobian(Vec X);
+
+  /**
+   * DC jacobian, coefficient of time derivative and the matrix of each harmonic
+   */
+  void build_preconditioner();
+
+  /**
+   * assemble J_dc + i h w C in 2x2 real form
+   */
+  void build_harmonic_matrix(unsigned int h, Mat &K);
+};
+
+
+#endif // #define __ddm1_hb_h__
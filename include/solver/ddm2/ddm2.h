@@ -222,6 +222,11 @@ public:
    */
   virtual void error_norm();
 
+  /**
+   * the local offsets of each variable for error norm and LTE
+   */
+  virtual void build_norm_index();
+
   /**
    * function for convergence test of pseudo time step method
    */
@@ -23,6 +23,9 @@
 #ifndef __ddm_ac_solver_h__
 #define __ddm_ac_solver_h__
 
+#include <vector>
+#include <utility>
+
 #include "enum_petsc_type.h"
 #include "fvm_linear_solver.h"
 #include "petscksp.h"
@@ -41,7 +44,7 @@ public:
    * as well as parallel scatter
    */
   DDMACSolver(SimulationSystem & system)
-  : FVM_LinearSolver(system),_first_create(true)
+  : FVM_LinearSolver(system),_first_create(true),_operator_create(true),_split_create(true),_bc_create(true)
   {
     system.record_active_solver(this->solver_type());
   }
@@ -223,16 +226,136 @@ private:
    */
   Mat            T_;
 
+  /**
+   * frequency independent part of T_, T_ = T0_ + omega*T1_.
+   * both matrix share the nonzero pattern of T_
+   */
+  Mat            T0_;
+
+  /**
+   * the coefficient of omega in T_
+   */
+  Mat            T1_;
+
   /**
    * temp matrix
    */
   Mat            C_;
 
+  /**
+   * frequency independent part of the region contributions to A_,
+   * A_ = A0_ + omega*A1_ + boundary condition terms.
+   * both matrix share the nonzero pattern of A_
+   */
+  Mat            A0_;
+
+  /**
+   * the coefficient of omega in region contributions to A_
+   */
+  Mat            A1_;
+
+  /**
+   * boundary condition contributions to A_ only, used by the reduced order model
+   */
+  Mat            Abc_;
+
   /**
    * flag to show if A_ is created
    */
   bool           _first_create;
 
+  /**
+   * flag to show if the nonzero pattern of A is not the one of C_ yet
+   */
+  bool           _operator_create;
+
+  /**
+   * flag to show if A0_ and A1_ are not created yet
+   */
+  bool           _split_create;
+
+  /**
+   * flag to show if Abc_ is not created yet
+   */
+  bool           _bc_create;
+
+  /**
+   * local (to the ownership range) rows of Abc_ which have nonzero entries
+   */
+  std::vector<PetscInt>  _bc_rows;
+
+  /**
+   * global index of (real, imag) dof pairs owned by this processor
+   */
+  std::vector< std::pair<PetscInt, PetscInt> > _ac_dof_pairs;
+
+  /**
+   * create an AIJ matrix with the preallocation of the AC system
+   */
+  void create_ac_matrix(Mat &M) const;
+
+  /**
+   * @return the frequency points of this AC sweep
+   */
+  std::vector<double> ac_frequencies() const;
+
+  /**
+   * do the AC sweep on PETSC_COMM_WORLD, one frequency after another
+   */
+  void solve_frequency_serial(const std::vector<double> &freqs);
+
+  /**
+   * do the AC sweep with frequency points distributed to SolverSpecify::ACFreqGroups
+   * MPI sub-communicators, each one solves a redundant copy of the AC matrix
+   */
+  void solve_frequency_groups(const std::vector<double> &freqs);
+
+  /**
+   * do the AC sweep with a reduced order model. the projection basis is built from
+   * full solves and their moments at a few expansion frequencies, then each frequency
+   * only needs a small dense solve. the error is estimated by the residual of the full system
+   * and by comparing with full solves at SolverSpecify::ACMORCheck frequency points
+   */
+  void solve_frequency_mor(const std::vector<double> &freqs);
+
+  /**
+   * N-port AC sweep, the AC matrix of each frequency is factored once and all the electrodes
+   * of ACScan are driven in turn as multiple rhs. writes the admittance and scattering matrix
+   */
+  void solve_frequency_nport(const std::vector<double> &freqs);
+
+  /**
+   * fill _ac_dof_pairs from the dof layout of regions and boundary conditions
+   */
+  void build_ac_dof_pairs();
+
+  /**
+   * multiply the complex vector src by imaginary unit, the result is saved in dst
+   */
+  void rotate_ac_vector(Vec src, Vec dst) const;
+
+  /**
+   * orthonormalize v against basis and append a copy of it to basis
+   * @return false if v is (nearly) linear dependent to basis
+   */
+  bool add_mor_basis(Vec v, std::vector<Vec> &basis) const;
+
+  /**
+   * assemble the boundary condition contributions to Abc_ and b_ under certain freq omega
+   */
+  void build_ddm_ac_bc(double omega);
+
+  /**
+   * assemble the region contributions to A0_ and A1_,
+   * must be called after A_ has been assembled once
+   */
+  void build_ddm_ac_split();
+
+  /**
+   * fill the transformation matrix T with certain freq omega and assemble it
+   */
+  void fill_ac_transformation(Mat T, double omega);
+
   /**
    * building the Matrix A, RHS vector b under certain freq omega
    */
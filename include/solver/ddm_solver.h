@@ -68,6 +68,18 @@ public:
    */
   virtual int solve_transient();
 
+  /**
+   * periodic steady state by shooting method. the transient over one period is integrated,
+   * and the initial state is corrected by newton method with the monodromy matrix, whose
+   * action is given by the sensitivity through the factored jacobian of each step
+   */
+  int solve_transient_shooting();
+
+  /**
+   * y = (I - M) v, M is the monodromy matrix of the last integrated period
+   */
+  void shooting_mult(Vec v, Vec y);
+
   /**
    * IV curve automatically trace
    */
@@ -78,6 +90,12 @@ public:
    */
   virtual int snes_solve_pseudo_time_step();
 
+  /**
+   * @return 2-norm of the steady state residual at current solution x,
+   * where the pseudo time terms vanish
+   */
+  PetscReal steady_residual_norm();
+
   /**
    * virtual function, create the solver
    */
@@ -113,6 +131,12 @@ public:
    */
   virtual bool BDF2_positive_defined() const=0;
 
+  /**
+   * the quiescent part of the device, i.e. the quasi-neutral region, can be frozen during Newton iterations
+   */
+  virtual bool freeze_support() const
+  { return true; }
+
   /**
    * compute the norm of local truncate error (LTE)
    * each derived DDM solver should override it.
@@ -124,12 +148,141 @@ public:
    */
   virtual void projection_positive_density_check(Vec , Vec )  {}
 
+  /**
+   * first order predictor of DC sweep. with the bias of next step already assigned to electrode,
+   * the residual of current solution is -dF/dV*dV, one back-substitution with the factored
+   * jacobian gives dx = dx/dV*dV.
+   * @param x_ref  the converged solution for positive density check
+   */
+  void tangent_predict(Vec x_ref);
+
+  /**
+   * terminal conductance matrix G=dI/dV and quasi-static capacitance matrix C=dQ/dV of all the
+   * voltage driven electrodes at the converged solution, written to SolverSpecify::SmallSignalFile.
+   * the bias of each electrode is perturbed in turn, the residual gives dF/dV*dV and one
+   * back-substitution with the factored jacobian gives dx/dV*dV, as tangent_predict does.
+   */
+  void small_signal_extract();
+
+  /**
+   * current of \p electrodes updated by the last function evaluation and their charge at solution \p v,
+   * summed over processors
+   */
+  void electrode_current_charge(const std::vector<BoundaryCondition *> &electrodes, Vec v,
+                                std::vector<PetscScalar> &I, std::vector<PetscScalar> &Q);
+
+  /**
+   * adjoint sensitivity of the terminal current of SolverSpecify::AdjointCurrent electrodes to
+   * SolverSpecify::AdjointParameter at the converged solution, written to SolverSpecify::AdjointFile.
+   * J^T lambda = dI/dx takes one transposed back-substitution with the factored jacobian for each
+   * electrode, then dI/dp = pI/pp - lambda^T pF/pp takes one function evaluation for each parameter.
+   * @param append  append to the file instead of starting a new one
+   */
+  void adjoint_sensitivity(bool append);
+
+  /**
+   * adjoint vectors J^T lambda_j = (dI_j/dx)^T of the terminal current of \p electrodes, solved with the
+   * factored jacobian. the caller should destroy them
+   */
+  void adjoint_solve(const std::vector<BoundaryCondition *> &electrodes, std::vector<Vec> &lambda);
+
+  /**
+   * impedance field method at the converged solution. the green's function of the terminal current of
+   * SolverSpecify::IFMCurrent electrodes to local charge is taken from the adjoint, the variance and
+   * covariance by random dopant fluctuation and optional samples are written to SolverSpecify::IFMFile
+   * @param append  append to the file instead of starting a new one
+   */
+  void impedance_field(bool append);
+
+  /**
+   * apply or revert the perturbation of an adjoint parameter
+   * @return the step of the parameter, 0 if the parameter can't be perturbed
+   */
+  PetscScalar adjoint_perturb(const std::string &param, bool revert);
+
+  /**
+   * jacobian of each accepted step of the shooting period
+   */
+  struct ShootingStep
+  {
+    /// jacobian at the solution of this step and its linear solver, factored once
+    Mat         J;
+    KSP         ksp;
+    /// time step and last time step
+    PetscScalar dt;
+    PetscScalar dt_last;
+    /// second order step
+    bool        bdf2;
+  };
+
+  /**
+   * the steps of the integrated period
+   */
+  std::vector<ShootingStep> _shooting_steps;
+
+  /**
+   * record the steps of the period during shooting
+   */
+  bool _shooting_record;
+
+  /**
+   * coefficient of time derivative, jacobian of the time derivative term times dt
+   */
+  Mat  _shooting_C;
+
+  /**
+   * initial state of the period
+   */
+  Vec  _shooting_x0;
+
+  /**
+   * save the jacobian of the accepted step, called by solve_transient
+   */
+  void shooting_record_step();
+
+  /**
+   * free the recorded steps
+   */
+  void shooting_clear_steps();
+
+  /**
+   * lattice heat step of operator splitting, see SolverSpecify::HeatSplit. the heat equation is
+   * integrated by implicit euler over \p dt_heat with \p electrical_dofs held, the nodes still
+   * keep the lattice temperature of last heat step as old value.
+   * @return true if converged, otherwise x is restored
+   */
+  bool solve_heat_split_step(const std::vector<unsigned int> &electrical_dofs, PetscScalar dt_heat);
+
   /**
    * compute the abs and relative error norm of the solution
    * each derived DDM solver should override it.
    */
   virtual void error_norm()=0;
 
+  /**
+   * the solution variables of the per variable norms, listed in the order of norm buffer
+   */
+  enum NormVariable { NormPotential=0, NormElectron, NormHole, NormTemperature, NormElecTemperature, NormHoleTemperature, NormVariables };
+
+  /**
+   * fill norm_index, norm_divisor and lte_index with the local offsets of each variable,
+   * called by create_solver once the dof map is built. the solver which uses
+   * variable_error_norm() or variable_LTE_norm() should override it
+   */
+  virtual void build_norm_index() {}
+
+  /**
+   * compute the x and f norm of each variable over norm_index, in one pass over the
+   * index arrays and one allreduce. the residual of electrode bcs is added when electrode is true
+   */
+  void variable_error_norm(bool electrode);
+
+  /**
+   * the RMS of LTE scaled by relative & abs error over lte_index.
+   * LTE vector should hold x-xp already
+   */
+  PetscReal variable_LTE_norm();
+
   /**
    * virtual function for convergence test of pseudo time step method
    */
@@ -173,6 +326,19 @@ protected:
    */
   Vec            x_n2;
 
+  /**
+   * x_n holds the last accepted solution of transient simulation. the three history
+   * vectors form a ring, accepting a step rotates the handles and copies x once
+   */
+  bool           _x_history_valid;
+
+  /**
+   * load the last accepted transient solution into x, which is much cheaper than
+   * filling x from the node data of all the regions.
+   * @return false if there is no transient history, the caller should fill x itself
+   */
+  bool restore_from_history();
+
   /**
    * predict solution vector
    */
@@ -298,6 +464,28 @@ protected:
    */
   PetscScalar electrode_norm;
 
+  /**
+   * local offsets of each NormVariable in lx/lf
+   */
+  std::vector<unsigned int> norm_index[NormVariables];
+
+  /**
+   * when not empty, the x norm of the variable is taken over x[norm_index]/x[norm_divisor],
+   * i.e. carrier temperature from n*Tn
+   */
+  std::vector<unsigned int> norm_divisor[NormVariables];
+
+  /**
+   * local offsets of the variables in LTE estimation
+   */
+  std::vector<unsigned int> lte_index;
+
+  /**
+   * local offset of the first dof (potential) of each on processor semiconductor node,
+   * the newton damping and positive density guards loop over it without region dispatch
+   */
+  std::vector<unsigned int> semiconductor_offset;
+
   /**
    * nonlinear function norm
    */
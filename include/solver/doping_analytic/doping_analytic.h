@@ -121,14 +121,31 @@ private:
  double _do_doping_interp(int i, const Node *node, const std::string &msg=std::string());
 
  /**
-  * @return the acceptor concentration of node
+  * compare node index by x coordinate
   */
- double doping_Na(const Node * node);
+ struct NodeXLess
+ {
+   NodeXLess(const std::vector<const Node *> & nodes) : _nodes(nodes) {}
+   bool operator() (unsigned int a, unsigned int b) const { return (*_nodes[a])(0) < (*_nodes[b])(0); }
+   bool operator() (unsigned int a, double x) const { return (*_nodes[a])(0) < x; }
+   bool operator() (double x, unsigned int b) const { return x < (*_nodes[b])(0); }
+   const std::vector<const Node *> & _nodes;
+ };
 
  /**
-  * @return the donor concentration of node
+  * evaluate doping function at the nodes inside its bounding box,
+  * x_order is the node index sorted by x coordinate.
+  * the nonzero values are returned as (node index, value) in the order of node index
   */
- double doping_Nd(const Node * node);
+ void evaluate_doping_function(DopingFunction * df, const std::vector<const Node *> & nodes,
+                               const std::vector<unsigned int> & x_order,
+                               std::vector<std::pair<unsigned int, double> > & profile);
+
+ /**
+  * compute the acceptor and donor concentration of the nodes
+  */
+ void doping_profile(const std::vector<const Node *> & nodes, const std::vector<unsigned int> & x_order,
+                     std::vector<double> & Na, std::vector<double> & Nd);
 
  /**
   * the pointer vector to DopingFunction
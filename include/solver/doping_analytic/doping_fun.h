@@ -71,6 +71,13 @@ public:
    */
   virtual double profile(double x, double y, double z)=0;
 
+  /**
+   * the box out of which the profile is zero (or negligible)
+   * @return false if the profile is not bounded, then it should be evaluated everywhere
+   */
+  virtual bool bounding_box(Point &, Point &) const
+  { return false; }
+
 protected:
   /**
    * impurity ion type N-ion or P-ion
@@ -105,6 +112,11 @@ public:
    */
   double profile(double x,double y,double z);
 
+  /**
+   * the doping box
+   */
+  bool bounding_box(Point &p_min, Point &p_max) const;
+
 private:
   /**
    * the peak value of doping concentration
@@ -171,6 +183,11 @@ public:
    */
   double profile(double x, double y, double z);
 
+  /**
+   * the doping box extended by 8 characteristic lengths, the gauss/erfc tail is below 1e-27 of peak there
+   */
+  bool bounding_box(Point &p_min, Point &p_max) const;
+
 private:
   /**
    * the peak value of doping concentration
@@ -339,6 +356,11 @@ public:
    */
   double profile(double x, double y, double z);
 
+  /**
+   * the region swept by the mask (extended by the sampling range) along profile line
+   */
+  bool bounding_box(Point &p_min, Point &p_max) const;
+
 private:
 
   /**
@@ -121,6 +121,17 @@ public:
     }
   }
 
+  /**
+   * @return the solution variable of the dof-th nodal dof, layout is given by region's ebm_variable_offset
+   */
+  virtual SolutionVariable node_dof_variable(const SimulationRegion * region, unsigned int dof) const
+  {
+    const SolutionVariable variables[] = {POTENTIAL, ELECTRON, HOLE, TEMPERATURE, E_TEMP, H_TEMP};
+    for(unsigned int i=0; i<6; ++i)
+      if( region->ebm_variable_offset(variables[i]) == dof ) return variables[i];
+    return INVALID_Variable;
+  }
+
   /**
    * @return the dofs of each boundary condition.
    */
@@ -245,6 +256,11 @@ public:
    */
   virtual void error_norm();
 
+  /**
+   * the local offsets of each variable for error norm and LTE
+   */
+  virtual void build_norm_index();
+
   /**
    * function for convergence test of pseudo time step method
    */
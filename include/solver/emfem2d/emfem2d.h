@@ -27,6 +27,7 @@
 #include <vector>
 
 #include "enum_petsc_type.h"
+#include "point.h"
 #include "fem_linear_solver.h"
 #include "petscksp.h"
 
@@ -44,7 +45,7 @@ public:
    * as well as parallel scatter
    */
   EMFEM2DSolver(SimulationSystem & system, const Parser::Card & c)
-  : FEM_LinearSolver(system), _card(c)
+  : FEM_LinearSolver(system), _card(c), _last_mode(EM_NONE), _last_lambda(0.0), _pc_reuse_tol(0.0), _pad_lambda(0.0), _pad(0.0)
   {system.record_active_solver(this->solver_type());}
 
   /**
@@ -92,6 +93,11 @@ public:
    */
   virtual std::string ksp_prefix() const { return "FEM_"; }
 
+  /**
+   * PML region and the vacuum far away from the device are truncated from the fem domain
+   */
+  virtual bool elem_in_domain(const Elem *) const;
+
 private:
 
   /**
@@ -153,12 +159,12 @@ private:
   /**
    * build the matrix A, precondition matrix PC and RHS for TE scatter problem
    */
-  void build_TE_matrix_rhs(double lamda, double power, double phase0);
+  void build_TE_matrix_rhs(double lamda, double power, double phase0, bool build_matrix=true);
 
   /**
    * build the matrix A, precondition matrix PC and RHS for TM scatter problem
    */
-  void build_TM_matrix_rhs(double lamda, double power, double phase0);
+  void build_TM_matrix_rhs(double lamda, double power, double phase0, bool build_matrix=true);
 
   /**
    * save nodal solution to fvm node data structure
@@ -215,6 +221,28 @@ private:
 
   ABC_TYPE _abc_type;
 
+  /**
+   * the polarization of the problem in matrix A
+   */
+  enum EM_MODE {EM_NONE, EM_TE, EM_TM};
+
+  /**
+   * the polarization of last solved problem
+   */
+  EM_MODE _last_mode;
+
+  /**
+   * the wavelength of last solved problem.
+   * the matrix (and its factorization) is reused when next problem has the same wavelength and polarization
+   */
+  double _last_lambda;
+
+  /**
+   * when the relative difference of wavelength is less than this value,
+   * the preconditioner of previous wavelength is reused
+   */
+  double _pc_reuse_tol;
+
   /**
    * when we use Mu Absorbing Boundary, we have to build the curvature of the boundary
    * if we know the Absorbing Boundary is circle, things are much easier.
@@ -223,6 +251,27 @@ private:
 
   ABC_SHAPE _abc_shape;
 
+  /**
+   * the vacuum padding around the device, in the unit of the longest wavelength.
+   * no truncation when it is not positive
+   */
+  double _pad_lambda;
+
+  /**
+   * the vacuum padding distance
+   */
+  double _pad;
+
+  /**
+   * the bounding box of the regions except vacuum and PML
+   */
+  std::pair<Point, Point> _device_box;
+
+  /**
+   * compute the padding distance and device bounding box for domain truncation
+   */
+  void build_truncated_domain();
+
 };
 
 
@@ -100,6 +100,17 @@ public:
    */
   virtual void build_matrix(Mat , Mat ) {}
 
+  /**
+   * when true, A is a shell matrix applied element by element with matrix_free_mult(),
+   * and only the nodal diagonal blocks are assembled into the preconditioning matrix A_pc
+   */
+  virtual bool matrix_free() const { return false; }
+
+  /**
+   * y = A*x for the matrix-free operator
+   */
+  virtual void matrix_free_mult(Vec , Vec ) { genius_error(); }
+
 
 
 protected:
@@ -129,6 +140,11 @@ protected:
    */
   Mat            A;
 
+  /**
+   * the matrix to build preconditioner, the same as A except for matrix-free operator
+   */
+  Mat            A_pc;
+
   /**
    * the left scaling vector of J
    */
@@ -23,6 +23,8 @@
 #ifndef __fem_pde_solver_h__
 #define __fem_pde_solver_h__
 
+#include <set>
+
 #include "solver_base.h"
 
 
@@ -86,8 +88,31 @@ public:
    */
   void build_dof_indices (const Elem* const elem, std::vector<PetscInt>& di) const;
 
+  /**
+   * @return false when the element is truncated from the computational domain,
+   * no dof is assigned to the nodes only owned by truncated elements
+   */
+  virtual bool elem_in_domain(const Elem *) const
+  { return true; }
+
+  /**
+   * @return true when the node has dofs
+   */
+  bool node_in_domain(const Node * node) const
+  { return _truncated_nodes.empty() || !_truncated_nodes.count(node); }
+
 protected:
 
+  /**
+   * the nodes only owned by truncated elements
+   */
+  std::set<const Node *> _truncated_nodes;
+
+  /**
+   * fill _truncated_nodes by elem_in_domain()
+   */
+  void build_truncated_nodes();
+
   /**
    * the summary of node's dof, in global
    */
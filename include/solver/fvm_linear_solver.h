@@ -69,6 +69,11 @@ public:
    */
   void eigen_value_of_matrix(int n=1, int i=0, Vec = PETSC_NULL, int j=0, Vec = PETSC_NULL);
 
+  /**
+   * add the memory of PETSc Mat and Vec to the breakdown
+   */
+  virtual void memory_usage(std::map<std::string, size_t> & usage) const;
+
   /**
    * @return the jacobian_matrix
    */
@@ -33,6 +33,7 @@
 //#include "petscmat.h"
 //#include "petscksp.h"
 #include "petscsnes.h"
+#include "perf_log.h"
 
 
 
@@ -87,6 +88,14 @@ public:
     */
   virtual void dump_matrix_triplet(const Mat mat, const std::string &file) const;
 
+  /**
+   * dump jacobian matrix and rhs vector in compressed binary CSR format, see CSRDumpWriter.
+   * each processor writes its own rows to file.<processor id> when run in parallel.
+   * only the copy of local rows is done here, the file is written by a background thread
+   * when async is true.
+   */
+  virtual void dump_matrix_csr(const Mat mat, const Vec rhs, const std::string &file, bool async=true) const;
+
   /**
    * dump function to external file
    * for more detailed analysis of the properties
@@ -95,14 +104,18 @@ public:
 
   /**
    * @return the condition number of jacobian matrix
+   * @param reuse_pc  use the factorization of nonlinear solver for the smallest singular value
    */
-  double condition_number_of_jacobian_matrix();
+  double condition_number_of_jacobian_matrix(bool reuse_pc=false);
 
   /**
    * calculate the n largest and smallest eigen value of jacobian matrix
-   * optinally get the ith smallest vec and jth largest vec
+   * optinally get the ith smallest vec and jth largest vec.
+   * nonzero vecs given in are used as initial space, so the eigen vectors of
+   * last call restart the subspace iteration.
+   * with reuse_pc, shift-and-invert uses the factorization of nonlinear solver
    */
-  void eigen_value_of_jacobian_matrix(int n=1, int i=0, Vec = PETSC_NULL, int j=0, Vec = PETSC_NULL);
+  void eigen_value_of_jacobian_matrix(int n=1, int i=0, Vec = PETSC_NULL, int j=0, Vec = PETSC_NULL, bool reuse_pc=false);
 
   /**
    * @return the jacobian_matrix
@@ -119,6 +132,11 @@ public:
    */
   Vec solution_vector() const { return x; }
 
+  /**
+   * add the memory of PETSc Mat and Vec to the breakdown
+   */
+  virtual void memory_usage(std::map<std::string, size_t> & usage) const;
+
   /**
    * create a new vector with (compatable parallel) pattern
    */
@@ -134,11 +152,156 @@ public:
    */
   virtual void sens_solve();
 
+  /**
+   * rebuild the jacobian matrix (and its factorization) only every \p lag Newton iterations,
+   * the factored matrix is reused in between. lag=1 rebuilds every iteration.
+   */
+  void set_jacobian_lag(int lag);
+
+  /**
+   * @return the nonzero structure flag reported to PETSc with the new jacobian matrix.
+   * SAME_NONZERO_PATTERN lets the factorization reuse the ordering and symbolic phase,
+   * so only numeric factorization is redone
+   */
+  MatStructure jacobian_matrix_structure();
+
+  /**
+   * with Broyden nonlinear solver, decide if the jacobian matrix is assembled at this iteration.
+   * it is rebuilt when the residual norm decreases slowly, the secant memory is full,
+   * or the time step changed much since the last build.
+   * @return false when the last factored jacobian is reused
+   */
+  bool broyden_rebuild_jacobian();
+
+  /**
+   * with Broyden nonlinear solver, add the secant pair of the last step and apply the
+   * secant updates to the newton direction \p y, solved by the reused jacobian at \p x
+   */
+  void broyden_update_direction(Vec x, Vec y, PetscBool *changed_y);
+
+  /**
+   * evaluate the residual at \p x, with fused assembly the jacobian at \p x is built in the same pass
+   */
+  void fused_residual(Vec x, Vec r);
+
+  /**
+   * @return true when the jacobian matrix has been built by fused_residual() at \p x,
+   * the jacobian evaluation can be skipped then
+   */
+  bool fused_jacobian_valid(Vec x);
+
+  /**
+   * residual norm at the line search trial point x - t*y. only the residual is assembled,
+   * the fused jacobian, frozen dof release and monitor of a newton step are skipped
+   */
+  PetscReal trial_residual_norm(Vec x, Vec y, PetscReal t);
+
+  /**
+   * @return true and copy the residual into \p r when the last line search trial was evaluated at \p x
+   */
+  bool trial_residual_reuse(Vec x, Vec r);
+
+  /**
+   * Bank-Rose damping factor of the newton direction \p y at \p x, the factor is reduced
+   * until the trial residual norm decreases sufficiently
+   */
+  PetscReal bank_rose_factor(Vec x, Vec y);
+
+  /**
+   * time the residual and jacobian evaluation called by SNES, the rest of a nonlinear solve
+   * is spent in linear solver and line search
+   */
+  void assembly_timer_start()
+  { _assembly_timer.start(); }
+
+  void assembly_timer_stop()
+  { _assembly_timer.stopit(); }
+
+  /**
+   * with krylov linear solver, decide if the preconditioner is kept for the new jacobian matrix.
+   * it is rebuilt every SolverSpecify::PCLag jacobian matrices, across Newton iterations and time steps,
+   * or when the krylov iterations grow much since the last rebuild.
+   * @return true when the preconditioner is reused
+   */
+  bool lag_preconditioner();
+
+  /**
+   * check the krylov iterations of the last linear solve against the ones after the preconditioner rebuild
+   */
+  void lag_preconditioner_monitor(PetscInt its);
+
   /**
    * clear all the nonlinear solver contex
    */
   void clear_nonlinear_data();
 
+  /**
+   * hold the dofs at local offsets \p offsets (on processor only) on their present value in x,
+   * the equations of these dofs are replaced by x = x_hold. an empty list releases them
+   */
+  void hold_dofs(const std::vector<unsigned int> &offsets);
+
+  /**
+   * replace the residual of held dofs by x - x_hold
+   */
+  void held_dofs_residual(Vec x, Vec r);
+
+  /**
+   * replace the jacobian rows of held and frozen dofs by unit rows
+   */
+  void held_dofs_jacobian(Mat *pc);
+
+  /**
+   * solver supports freezing the quiescent dofs by freeze.tol
+   */
+  virtual bool freeze_support() const
+  { return false; }
+
+  /**
+   * freeze the dofs whose relative update stays below SolverSpecify::FreezeTol for
+   * SolverSpecify::FreezeIts Newton iterations, they are held like hold_dofs() until their residual grows
+   */
+  void freeze_dofs_monitor(PetscInt its);
+
+  /**
+   * replace the residual of frozen dofs by x - x_freeze, or release the dof when its residual grows
+   */
+  void frozen_dofs_residual(Vec x, Vec r);
+
+  /**
+   * release all the frozen dofs
+   */
+  void release_frozen_dofs();
+
+  /**
+   * the frozen equations are left out of the convergence test. when the solve converges with frozen dofs,
+   * release them and refill f with the full residual, the solve is accepted only if it passes the test again
+   */
+  void frozen_dofs_convergence(PetscInt its, PetscReal xnorm, PetscReal gnorm, SNESConvergedReason *reason);
+
+  /**
+   * @return true when the governing equations of the nth region can be skipped in the assembly,
+   * all the dofs of the region and of the boundary conditions it touches are frozen
+   */
+  bool region_frozen(unsigned int n) const
+  { return n < _frozen_regions.size() && _frozen_regions[n]; }
+
+  /**
+   * find the regions can be skipped by region_frozen(), and the dofs their skip leaves with
+   * an incomplete residual. must be called by all the processors
+   */
+  void update_frozen_regions();
+
+  /**
+   * local offsets of the node dofs of the region
+   */
+  void region_local_dofs(const SimulationRegion * region, std::vector<unsigned int> & dofs) const;
+
+  /**
+   * local offsets of the node dofs and extra dofs of the bc, and the subdomain of the regions it touches
+   */
+  void bc_local_dofs(const BoundaryCondition * bc, std::vector<unsigned int> & dofs, std::vector<unsigned int> & regions) const;
+
 
   /**
    * Sets the type of nonlinear solver to use.
@@ -189,11 +352,56 @@ public:
    */
   virtual void build_petsc_sens_jacobian(Vec x, Mat *jac, Mat *pc)=0;
 
+  /**
+   * virtual function for evaluating the residual of function f at x and the Jacobian J at x in one pass.
+   * the default evaluates the residual only, derived solver which supports it
+   * should override fused_assembly_support() as well
+   * @return true when the Jacobian is built
+   */
+  virtual bool build_petsc_sens_residual_jacobian(Vec x, Vec r)
+  { build_petsc_sens_residual(x, r); return false; }
+
+  /**
+   * @return true when the derived solver builds the Jacobian together with the residual
+   */
+  virtual bool fused_assembly_support() const
+  { return false; }
+
+  /**
+   * @return true when the residual evaluation should build the Jacobian as well.
+   * it only pays off when each residual is followed by a Jacobian at the same x,
+   * which is plain Newton without line search, lagged Jacobian or JFNK
+   */
+  bool fused_assembly() const;
+
   /**
    * virtual function for snes monitor. derived class can override it as needed.
    */
   virtual void petsc_snes_monitor(PetscInt its, PetscReal fnorm);
 
+  /**
+   * called at the beginning of each Newton iteration, time the linear solve
+   * and line search of the previous iteration, and mark the performance report
+   */
+  void log_newton_iteration(PetscInt its);
+
+  /**
+   * called at the beginning of each Newton iteration, set the initial guess of krylov solver
+   * to the Newton correction of previous iteration, scaled by the residual reduction
+   */
+  void warm_start_linear_solver(PetscInt its, PetscReal fnorm);
+
+  /**
+   * close the performance log event of the last Newton step,
+   * must be called after each SNESSolve
+   */
+  void log_newton_finish();
+
+  /**
+   * add the Newton and KSP iterations of the last SNESSolve to solver counters
+   */
+  void count_snes_solve(SNESConvergedReason reason);
+
   /**
    * virtual function for snes convergence test. derived class can override it as needed.
    */
@@ -228,6 +436,21 @@ protected:
    */
   bool jacobian_matrix_first_assemble;
 
+  /**
+   * indicate that ordering and symbolic factorization has been done for current dof map
+   */
+  bool symbolic_factorization_done;
+
+  /**
+   * indicate that the performance log event of a Newton step is open
+   */
+  bool newton_step_logged;
+
+  /**
+   * residual norm of previous Newton iteration, used to extrapolate the initial guess of krylov solver
+   */
+  PetscReal warm_start_fnorm;
+
   /**
    * which type of nonlinear solver to use.
    */
@@ -243,6 +466,53 @@ protected:
    */
   void set_petsc_preconditioner_type();
 
+  /**
+   * set single precision LU of SuperLU_DIST as preconditioner of GMRES or richardson,
+   * which refines the solution to double precision accuracy
+   * @return false if single precision LU is not available
+   */
+  bool set_petsc_mixed_precision_lu();
+
+  /**
+   * block low-rank compression of MUMPS factors
+   */
+  void set_petsc_mumps_options();
+
+  /**
+   * let the direct solver use nested dissection ordering of mesh nodes, see build_node_ordering()
+   * @param mumps  MUMPS only takes the ordering as user given one
+   */
+  void set_petsc_node_ordering(bool mumps);
+
+  /**
+   * set field split preconditioner, the dofs are grouped by physical field (psi, n, p, T ...)
+   * with AMG on Poisson block and ILU on the others
+   * @return false if the problem has less than two fields
+   */
+  bool set_petsc_fieldsplit_preconditioner();
+
+  /**
+   * set schur complement preconditioner for device-circuit co-simulation.
+   * the device block is factorized and reduced to terminal stamps of the circuit block,
+   * which groups the electrode circuit (bc dofs) and spice circuit (extra dofs) equations
+   * @return false if the problem has neither bc dofs nor extra dofs
+   */
+  bool set_petsc_circuit_schur_preconditioner();
+
+  /**
+   * set additive schwarz preconditioner whose subdomains are the on processor part of each region,
+   * with the bc and extra dofs as one more subdomain. the overlap of one layer crosses region
+   * interfaces, and each subdomain is solved by LU
+   * @return false if the problem has less than two subdomains
+   */
+  bool set_petsc_region_asm_preconditioner();
+
+  /**
+   * create a shell matrix applying J^-1 by the factorization held in the preconditioner
+   * @return false if the preconditioner is not a direct factorization
+   */
+  bool inverse_jacobian_operator(Mat &Jinv);
+
   /**
    * the global solution vector
    */
@@ -258,6 +528,11 @@ protected:
    */
   Mat            J;
 
+  /**
+   * the matrix-free jacobian of JFNK method, J is only used as preconditioner then
+   */
+  Mat            J_mf;
+
   /**
    * the left scaling vector of J
    */
@@ -288,6 +563,27 @@ protected:
    */
   VecScatter     scatter;
 
+  /**
+   * the part of scatter which reads entries owned by this processor, no communication
+   */
+  VecScatter     scatter_owned;
+
+  /**
+   * the part of scatter which reads ghost entries from other processors
+   */
+  VecScatter     scatter_ghost;
+
+  /**
+   * fill lx from \p v by scatter_owned and start scatter_ghost.
+   * before scatter_lx_end, only entries of on processor nodes in lx are valid
+   */
+  void scatter_lx_begin(Vec v);
+
+  /**
+   * finish scatter_ghost, all the entries of lx are valid
+   */
+  void scatter_lx_end(Vec v);
+
   /**
    * petsc nonlinear solver contex
    */
@@ -314,6 +610,192 @@ protected:
    */
   SolverSpecify::LinearSolverType   _linear_solver_type;
 
+  /**
+   * direct solver factors the jacobian in single precision,
+   * reset when refinement stalls
+   */
+  bool _lu_single_precision;
+
+  /**
+   * block size of jacobian matrix with matrix type baij. the size of the uniform node blocks,
+   * -1 for variable node blocks stored as aij, 0 for no block structure
+   */
+  PetscInt _node_block_size;
+
+  /**
+   * local offsets of the dofs held by hold_dofs()
+   */
+  std::vector<unsigned int> _held_dofs;
+
+  /**
+   * the values the held dofs are kept on
+   */
+  std::vector<PetscScalar> _held_values;
+
+  /**
+   * local offsets of the dofs frozen by freeze_dofs_monitor()
+   */
+  std::vector<unsigned int> _frozen_dofs;
+
+  /**
+   * the values the frozen dofs are kept on
+   */
+  std::vector<PetscScalar> _frozen_values;
+
+  /**
+   * the residual of frozen dofs when they were frozen, the reference of waking up
+   */
+  std::vector<PetscScalar> _frozen_residual;
+
+  /**
+   * consecutive Newton iterations each local dof stays quiet
+   */
+  std::vector<unsigned int> _freeze_count;
+
+  /**
+   * solution of previous Newton iteration
+   */
+  Vec _freeze_x;
+
+  /**
+   * the regions skipped in the assembly, see region_frozen()
+   */
+  std::vector<bool> _frozen_regions;
+
+  /**
+   * local dofs whose residual is incomplete since a frozen region is skipped, they are not waked up
+   */
+  std::vector<bool> _frozen_skipped;
+
+  /**
+   * the frozen dofs are released for the final convergence check, no more freezing in this solve
+   */
+  bool _freeze_closed;
+
+  /**
+   * the jacobian lag set by set_jacobian_lag()
+   */
+  int _jacobian_lag;
+
+  /**
+   * wall time of residual and jacobian evaluation
+   */
+  PerfData _assembly_timer;
+
+  /**
+   * jacobian matrices built since the last preconditioner rebuild
+   */
+  int _pc_age;
+
+  /**
+   * krylov iterations of the first linear solve after the preconditioner rebuild, -1 before it
+   */
+  PetscInt _pc_base_its;
+
+  /**
+   * the preconditioner should be rebuilt with the next jacobian matrix
+   */
+  bool _pc_rebuild;
+
+  /**
+   * the iterative linear solver replaced by direct solver, INVALID_LINEAR_SOLVER when none
+   */
+  SolverSpecify::LinearSolverType _adaptive_iterative_type;
+
+  /**
+   * the iterative linear solver failed in this solve command, keep the direct solver
+   */
+  bool _adaptive_iterative_failed;
+
+  /**
+   * number of successive nonlinear solves in which the direct linear solver dominates
+   */
+  unsigned int _adaptive_direct_dominant;
+
+  /**
+   * @return true when the linear solver is a direct factorization, or krylov with a complete factorization as preconditioner
+   */
+  bool direct_linear_solver() const;
+
+  /**
+   * change the linear solver and preconditioner between nonlinear solves
+   */
+  void switch_linear_solver(SolverSpecify::LinearSolverType ls, SolverSpecify::PreconditionerType pct);
+
+  /**
+   * choose the linear solver for the next nonlinear solve by the cost of this one,
+   * krylov solver with exploded iterations is replaced by direct solver, and direct solver
+   * which dominates the solve time is replaced by krylov solver
+   */
+  void adaptive_linear_solver(SNESConvergedReason reason, double solve_time, double linear_time);
+
+  /**
+   * the jacobian matrix was built with the residual at _fused_x
+   */
+  bool _fused_jacobian_valid;
+
+  /**
+   * solution of the last fused residual and jacobian evaluation, PETSC_NULL before the first use
+   */
+  Vec _fused_x;
+
+  /**
+   * solution and residual of the last line search trial, PETSC_NULL before the first use
+   */
+  Vec _trial_x, _trial_r;
+
+  /**
+   * the residual of the last line search trial is not used yet
+   */
+  bool _trial_valid;
+
+  /**
+   * Bank-Rose damping parameter, kept between newton iterations
+   */
+  PetscReal _bank_rose_K;
+
+  /**
+   * the last factored jacobian is valid to be reused by Broyden nonlinear solver
+   */
+  bool _broyden_jacobian_valid;
+
+  /**
+   * time step when the reused jacobian was built
+   */
+  Real _broyden_dt;
+
+  /**
+   * residual norm of previous Broyden iteration
+   */
+  PetscReal _broyden_fnorm_last;
+
+  /**
+   * solution, residual and newton direction H_0 F of the last Broyden iteration, PETSC_NULL before the first use
+   */
+  Vec _broyden_x, _broyden_f, _broyden_q;
+
+  /**
+   * _broyden_x/f/q hold the last iteration of the current secant sequence
+   */
+  bool _broyden_has_last;
+
+  /**
+   * secant pairs of Broyden's second method, the inverse jacobian is
+   * H = H_0 + sum_j w_j df_j^T/(df_j^T df_j), H_0 is the reused factored jacobian.
+   * the vectors are kept for reuse, only the first _broyden_n pairs are valid
+   */
+  std::vector<Vec> _broyden_w, _broyden_df;
+
+  /**
+   * df_j^T df_j of each secant pair
+   */
+  std::vector<PetscScalar> _broyden_df2;
+
+  /**
+   * number of valid secant pairs
+   */
+  unsigned int _broyden_n;
+
   /**
    * a stack for previous linear solvers
    */
@@ -100,6 +100,20 @@ public:
   virtual unsigned int node_dofs(const SimulationRegion * region) const
   { genius_assert(region!=NULL); return 1; }
 
+  /**
+   * @return the solution variable of the dof-th nodal dof in each simulation region.
+   * it is used by field split preconditioner to group the dofs of the same physical field.
+   * default layout is psi, n, p, T for semiconductor region and psi, T for others
+   */
+  virtual SolutionVariable node_dof_variable(const SimulationRegion * region, unsigned int dof) const
+  {
+    const SolutionVariable semiconductor_variables[] = {POTENTIAL, ELECTRON, HOLE, TEMPERATURE};
+    const SolutionVariable other_variables[] = {POTENTIAL, TEMPERATURE};
+    if( region->type() == SemiconductorRegion )
+      return dof < 4 ? semiconductor_variables[dof] : INVALID_Variable;
+    return dof < 2 ? other_variables[dof] : INVALID_Variable;
+  }
+
   /**
    * @return the (exact) dofs of each boundary condition
    */
@@ -131,8 +145,68 @@ public:
   virtual void set_extra_matrix_nonzero_pattern()
   { return; }
 
+  /**
+   * drop the nonzero pattern and ordering cached by all the solver classes,
+   * called when the simulation system is rebuilt
+   */
+  static void clear_solver_cache();
+
 protected:
 
+  /**
+   * restore n_nz and n_oz from the pattern cached by previous solver of the same class.
+   * the cache is valid only when mesh revision, dof layout and boundary conditions are not changed.
+   * @return true when the cached pattern is used
+   */
+  bool restore_nonzero_pattern();
+
+  /**
+   * restore the rows of node dofs from the pattern cached by previous solver of the same class,
+   * when only the boundary conditions are changed, i.e. electrode type or attached circuit.
+   * the rows of boundary nodes, bc and extra dofs should be computed again.
+   * @return true when the node rows are restored
+   */
+  bool restore_bulk_nonzero_pattern();
+
+  /**
+   * save n_nz and n_oz to the pattern cache of this solver class
+   */
+  void cache_nonzero_pattern() const;
+
+  /**
+   * add the coupling of periodic node pairs to n_nz
+   */
+  void set_periodic_nonzero_pattern();
+
+  /**
+   * @return the node dofs on this processor
+   */
+  unsigned int n_local_node_dofs() const;
+
+  /**
+   * @return the boundary condition and circuit settings the nonzero pattern depends on
+   */
+  std::vector<unsigned int> bc_nonzero_pattern_key() const;
+
+  /**
+   * fill-reducing ordering of the dofs by nested dissection of the node graph.
+   * the dofs of a node are kept together, bc and extra dofs are ordered at the end.
+   * the ordering is cached for each solver class as the nonzero pattern.
+   * @return false if METIS is not available or the dofs are distributed
+   */
+  bool build_node_ordering();
+
+  /**
+   * the dof at each position of the fill-reducing ordering
+   */
+  std::vector<PetscInt> node_ordering;
+
+  /**
+   * sizes of the consecutive dof blocks of this processor, one block for the dofs of each node
+   * and one for each bc or extra dof
+   */
+  void node_block_sizes(std::vector<PetscInt> &bsizes) const;
+
   /**
    * the summary of node's dof, in global
    */
@@ -0,0 +1,128 @@
+/********************************************************************************/
+/*     888888    888888888   88     888  88888   888      888    88888888       */
+/*   8       8   8           8 8     8     8      8        8    8               */
+/*  8            8           8  8    8     8      8        8    8               */
+/*  8            888888888   8   8   8     8      8        8     8888888        */
+/*  8      8888  8           8    8  8     8      8        8            8       */
+/*   8       8   8           8     8 8     8      8        8            8       */
+/*     888888    888888888  888     88   88888     88888888     88888888        */
+/*                                                                              */
+/*       A Three-Dimensional General Purpose Semiconductor Simulator.           */
+/*                                                                              */
+/*                                                                              */
+/*  Copyright (C) 2007-2008                                                     */
+/*  Cogenda Pte Ltd                                                             */
+/*                                                                              */
+/*  Please contact Cogenda Pte Ltd for license information                      */
+/*                                                                              */
+/*  Author: Gong Ding   gdiso@ustc.edu                                          */
+/*                                                                              */
+/********************************************************************************/
+
+
+#ifndef __ddm1_half_implicit_h__
+#define __ddm1_half_implicit_h__
+
+#include "fvm_explicit_solver.h"
+#include "enum_solver_specify.h"
+
+class PoissonSolver;
+
+/**
+ * Half implicit solver for transient drift-diffusion simulation.
+ * at each time step, the electron and hole densities are advanced by S-G flux explicitly,
+ * with recombination linearized and treated implicitly. then the nonlinear Poisson's equation
+ * is solved implicitly with frozen quasi-Fermi potential.
+ * the time step is limited by CFL condition of explicit flux. as a result, each step only costs
+ * one Poisson solve plus node updates, which is suitable for long, slow transient of large problem.
+ */
+class DDM1HalfImplicitSolver : public FVM_ExplicitSolver
+{
+  public:
+    DDM1HalfImplicitSolver ( SimulationSystem & system );
+
+    virtual ~DDM1HalfImplicitSolver();
+
+    /**
+     * @return the solver type
+     */
+    virtual SolverSpecify::SolverType solver_type() const
+    {return SolverSpecify::HALF_IMPLICIT;}
+
+    /**
+     * virtual function, create the solver
+     */
+    virtual int create_solver();
+
+    /**
+     * virtual function, do the solve process
+     */
+    virtual int solve();
+
+    /**
+     * virtual function, destroy the solver, release internal data
+     */
+    virtual int destroy_solver() ;
+
+    /**
+     * do pre-process before each solve action
+     */
+    virtual int pre_solve_process ( bool load_solution=true );
+
+    /**
+     * @return node's dof for each region. only Semiconductor Region has 2 dof (n, p) here
+     */
+    virtual unsigned int node_dofs ( const SimulationRegion * region ) const
+    {
+      assert ( region!=NULL );
+      switch ( region->type() )
+      {
+        case SemiconductorRegion : return 2;
+        default : return 0;
+      }
+    }
+
+    /**
+     * indicates if PDE involves all neighbor elements.
+     * when it is true, the matrix bandwidth will include all the nodes belongs to neighbor elements, i.e. DDM solver
+     * when it is false, only neighbor nodes (link local node by edge) are appeared in matrix bandwidth, i.e. poisson solver.
+     */
+    virtual bool all_neighbor_elements_involved ( const SimulationRegion * ) const
+    { return false; }
+
+  private:
+
+    /**
+     * internal poisson solver
+     */
+    PoissonSolver * poisson_solver;
+
+    /**
+     * transient simulation
+     */
+    void solve_transient();
+
+    /**
+     * advance carriers by one time step no longer than dt_max and solve poisson's equation
+     * @return the time step used
+     */
+    PetscScalar time_advance(PetscScalar dt_max);
+
+    /**
+     * build carrier flux into each node to f, and sum of outflow coefficient to t for CFL limit
+     */
+    void build_flux();
+
+    /**
+     * set carrier density of ohmic/schottky contact and compute the electrode current
+     */
+    void contact_boundary(PetscScalar *xx, const PetscScalar *ff, PetscInt rstart);
+
+    /**
+     * write carrier density to system
+     */
+    void update_solution();
+};
+
+
+#endif // #define __ddm1_half_implicit_h__
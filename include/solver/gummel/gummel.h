@@ -0,0 +1,82 @@
+/********************************************************************************/
+/*     888888    888888888   88     888  88888   888      888    88888888       */
+/*   8       8   8           8 8     8     8      8        8    8               */
+/*  8            8           8  8    8     8      8        8    8               */
+/*  8            888888888   8   8   8     8      8        8     8888888        */
+/*  8      8888  8           8    8  8     8      8        8            8       */
+/*   8       8   8           8     8 8     8      8        8            8       */
+/*     888888    888888888  888     88   88888     88888888     88888888        */
+/*                                                                              */
+/*       A Three-Dimensional General Purpose Semiconductor Simulator.           */
+/*                                                                              */
+/*                                                                              */
+/*  Copyright (C) 2007-2008                                                     */
+/*  Cogenda Pte Ltd                                                             */
+/*                                                                              */
+/*  Please contact Cogenda Pte Ltd for license information                      */
+/*                                                                              */
+/*  Author: Gong Ding   gdiso@ustc.edu                                          */
+/*                                                                              */
+/********************************************************************************/
+
+
+#ifndef __gummel_h__
+#define __gummel_h__
+
+#include "ddm1/ddm1.h"
+
+
+/**
+ * Decoupled (Gummel) solver for drift-diffusion equations.
+ * each gummel iteration solves the nonlinear Poisson's equation with frozen
+ * quasi-Fermi potential, then the linear electron and hole continuity equations
+ * with frozen potential. the memory of each sub-problem is about a third of
+ * coupled DDML1 jacobian.
+ * when gummel iteration converged, the solution is handed off to coupled DDML1
+ * newton solver (optional). as a result, this solver reports itself as DDML1.
+ */
+class GummelSolver : public DDM1Solver
+{
+public:
+  GummelSolver(SimulationSystem & system): DDM1Solver(system), _newton_created(false)
+  {}
+
+  ~GummelSolver()
+  {}
+
+  /**
+   * virtual function, create the solver. the coupled newton solver is created after gummel iteration
+   */
+  virtual int create_solver();
+
+  /**
+   * virtual function, do gummel iteration and then hand off to coupled DDML1 solver
+   */
+  virtual int solve();
+
+  /**
+   * virtual function, destroy the solver
+   */
+  virtual int destroy_solver();
+
+  /**
+   * only the coupled solver owns PETSc objects
+   */
+  virtual void memory_usage(std::map<std::string, size_t> & usage) const;
+
+private:
+
+  /**
+   * do gummel iteration until the potential update less than SolverSpecify::GummelPotentialToler
+   * @return true when converged
+   */
+  bool gummel_iteration();
+
+  /**
+   * coupled DDML1 solver has been created
+   */
+  bool _newton_created;
+};
+
+
+#endif // #define __gummel_h__
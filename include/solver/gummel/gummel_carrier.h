@@ -0,0 +1,120 @@
+/********************************************************************************/
+/*     888888    888888888   88     888  88888   888      888    88888888       */
+/*   8       8   8           8 8     8     8      8        8    8               */
+/*  8            8           8  8    8     8      8        8    8               */
+/*  8            888888888   8   8   8     8      8        8     8888888        */
+/*  8      8888  8           8    8  8     8      8        8            8       */
+/*   8       8   8           8     8 8     8      8        8            8       */
+/*     888888    888888888  888     88   88888     88888888     88888888        */
+/*                                                                              */
+/*       A Three-Dimensional General Purpose Semiconductor Simulator.           */
+/*                                                                              */
+/*                                                                              */
+/*  Copyright (C) 2007-2008                                                     */
+/*  Cogenda Pte Ltd                                                             */
+/*                                                                              */
+/*  Please contact Cogenda Pte Ltd for license information                      */
+/*                                                                              */
+/*  Author: Gong Ding   gdiso@ustc.edu                                          */
+/*                                                                              */
+/********************************************************************************/
+
+
+#ifndef __gummel_carrier_h__
+#define __gummel_carrier_h__
+
+#include "fvm_linear_solver.h"
+#include "enum_solver_specify.h"
+
+
+/**
+ * Solve the linear continuity equation of electron or hole for gummel method.
+ * electrostatic potential, mobility and recombination (linearized) are taken from
+ * the current solution. only semiconductor regions have dofs.
+ * ohmic contact fixes the carrier at its equilibrium value, schottky contact keeps
+ * the carrier of last iteration, other boundaries (and interfaces) are considered as reflect boundary.
+ */
+class GummelCarrierSolver : public FVM_LinearSolver
+{
+public:
+
+  /**
+   * the continuity equation to be solved
+   */
+  enum Carrier {ELECTRON_CARRIER, HOLE_CARRIER};
+
+  /**
+   * constructor
+   */
+  GummelCarrierSolver(SimulationSystem & system): FVM_LinearSolver(system), _carrier(ELECTRON_CARRIER)
+  {}
+
+  /**
+   * destructor, do nothing
+   */
+  ~GummelCarrierSolver()
+  { }
+
+  /**
+   * @return the solver type
+   */
+  virtual SolverSpecify::SolverType solver_type() const
+  {return SolverSpecify::GUMMEL;}
+
+  /**
+   * virtual function, create the solver
+   */
+  virtual int create_solver();
+
+  /**
+   * virtual function, solve the continuity equation of current carrier
+   */
+  virtual int solve();
+
+  /**
+   * virtual function, destroy the solver, release internal data
+   */
+  virtual int destroy_solver() ;
+
+  /**
+   * set the carrier to be solved
+   */
+  void set_carrier(Carrier c) { _carrier = c; }
+
+  /**
+   * @return node's dof for each region. only semiconductor region has 1 dof
+   */
+  virtual unsigned int node_dofs(const SimulationRegion * region) const
+  {
+    switch(region->type())
+    {
+      case SemiconductorRegion : return 1;
+      default : return 0;
+    }
+  }
+
+  /**
+   * PETSC KSP can have an individual prefix
+   */
+  virtual std::string ksp_prefix() const { return "gummel_carrier_"; }
+
+  /**
+   * build the matrix and RHS vector of continuity equation
+   */
+  void build_system(Mat A, Vec b);
+
+private:
+
+  /**
+   * the carrier to be solved
+   */
+  Carrier _carrier;
+
+  /**
+   * write solution to system
+   */
+  void update_solution();
+};
+
+
+#endif // #define __gummel_carrier_h__
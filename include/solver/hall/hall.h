@@ -57,6 +57,11 @@ public:
    */
   virtual int solve();
 
+  /**
+   * sweep the magnetic field at fixed bias
+   */
+  int solve_bsweep();
+
   /**
    * do pre-process before each solve action
    */
@@ -22,6 +22,8 @@
 #ifndef __hdm_solver_h__
 #define __hdm_solver_h__
 
+#include <vector>
+
 #include "fvm_explicit_solver.h"
 #include "enum_solver_specify.h"
 
@@ -128,6 +130,30 @@ class HDMSolver : public FVM_ExplicitSolver
      */
     void sync_rho();
 
+  private:
+
+    /**
+     * flat table of the semiconductor nodes and their edges for the flux kernel,
+     * built once by create_solver and kept between the steps.
+     * when offloaded, the table stays on the device until destroy_solver
+     */
+    std::vector<PetscInt> _flux_node_row;   // first row of the node in local part of f and t
+    std::vector<PetscInt> _flux_node_x;     // offset of the node in lx
+    std::vector<PetscInt> _flux_edge_ptr;   // edges of node i are [_flux_edge_ptr[i], _flux_edge_ptr[i+1])
+    std::vector<PetscInt> _flux_edge_x;     // offset of the neighbor node in lx
+    std::vector<Real>     _flux_edge_geom;  // distance, cv surface area and unit direction, 5 per edge
+    std::vector<Real>     _flux_node_mass;  // electron and hole effective mass, 2 per node
+
+    void build_flux_table();
+
+    void clear_flux_table();
+
+    /**
+     * AUSM+ flux and local time step of all the semiconductor nodes,
+     * the same as HDM_Flux of semiconductor region, but writes local array of f and t directly
+     */
+    void flux_kernel(const PetscScalar * lxx);
+
 };
 
 
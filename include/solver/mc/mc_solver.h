@@ -0,0 +1,198 @@
+/********************************************************************************/
+/*     888888    888888888   88     888  88888   888      888    88888888       */
+/*   8       8   8           8 8     8     8      8        8    8               */
+/*  8            8           8  8    8     8      8        8    8               */
+/*  8            888888888   8   8   8     8      8        8     8888888        */
+/*  8      8888  8           8    8  8     8      8        8            8       */
+/*   8       8   8           8     8 8     8      8        8            8       */
+/*     888888    888888888  888     88   88888     88888888     88888888        */
+/*                                                                              */
+/*       A Three-Dimensional General Purpose Semiconductor Simulator.           */
+/*                                                                              */
+/*                                                                              */
+/*  Copyright (C) 2007-2008                                                     */
+/*  Cogenda Pte Ltd                                                             */
+/*                                                                              */
+/*  Please contact Cogenda Pte Ltd for license information                      */
+/*                                                                              */
+/*  Author: Gong Ding   gdiso@ustc.edu                                          */
+/*                                                                              */
+/********************************************************************************/
+
+
+#ifndef __mc_solver_h__
+#define __mc_solver_h__
+
+#include <vector>
+
+#include "parser.h"
+#include "particle_solver.h"
+
+class Elem;
+class ObjectTree;
+
+/**
+ * Monte-Carlo energy deposition solver for radiation effect.
+ * each particle history starts from the incident point with a gaussian lateral offset,
+ * and is traced through the mesh by element adjacency. the energy loss along the path
+ * is given by LET with straggling, and the direction is perturbed by multiple scattering.
+ * histories are distributed to processors and threads, each history has its own
+ * random stream seeded by its index, so the result does not depend on the partition.
+ */
+class MonteCarloSolver : public ParticalSolver
+{
+public:
+
+  /**
+   * the constructor, take system and PARTICLE card as parameter
+   */
+  MonteCarloSolver(SimulationSystem & system, const Parser::Card & c);
+
+  /**
+   * destructor
+   */
+  ~MonteCarloSolver();
+
+  /**
+   * @return the solver type
+   */
+  virtual SolverSpecify::SolverType solver_type() const
+  {return SolverSpecify::MC;}
+
+  /**
+   * virtual function, create the solver
+   */
+  virtual int create_solver();
+
+  /**
+   * virtual function, trace all the particle histories
+   */
+  virtual int solve();
+
+  /**
+   * virtual function, destroy the solver, release internal data
+   */
+  virtual int destroy_solver();
+
+  /**
+   * @return the energy density deposited at each mesh node, which is lumped from the elems around it
+   */
+  void node_energy_density(std::vector<Point> & points, std::vector<double> & energy_density) const;
+
+private:
+
+  /**
+   * parameters for MC solver
+   */
+  const Parser::Card & _card;
+
+  /**
+   * BVH of boundary elems, find the entry elem of history starts outside the mesh
+   */
+  ObjectTree * _surface_elem_tree;
+
+  /**
+   * particle incident point
+   */
+  Point _start;
+
+  /**
+   * particle incident direction
+   */
+  Point _dir;
+
+  /**
+   * lateral char. length of history start point
+   */
+  double _lateral_char;
+
+  /**
+   * range of particle
+   */
+  double _length;
+
+  /**
+   * linear energy transfer
+   */
+  double _LET;
+
+  /**
+   * number of particle histories
+   */
+  unsigned int _histories;
+
+  /**
+   * seed of random stream
+   */
+  unsigned int _seed;
+
+  /**
+   * the max step length between two scattering event
+   */
+  double _step;
+
+  /**
+   * relative straggling of energy loss
+   */
+  double _straggling;
+
+  /**
+   * rms scattering angle per um
+   */
+  double _scatter;
+
+  /**
+   * material density of each region
+   */
+  std::vector<double> _region_density;
+
+  /**
+   * energy deposited in each elem, indexed by elem id
+   */
+  std::vector<double> _energy_in_elem;
+
+  /**
+   * energy deposited in an elem by one history
+   */
+  struct EnergyDeposit
+  {
+    unsigned int elem_id;
+    double energy;
+  };
+
+  /**
+   * the random stream of one history, splitmix64 generator
+   */
+  class RandomStream
+  {
+  public:
+    RandomStream(unsigned long long seed) : _state(seed) {}
+
+    /// uniform distribution in (0, 1)
+    double uniform();
+
+    /// standard normal distribution
+    double normal();
+
+  private:
+    unsigned long long _state;
+  };
+
+  /**
+   * find the elem the history starts in and move p to the entry point when the history starts outside the mesh
+   * @return NULL if the history missed the mesh
+   */
+  const Elem * locate_history(Point & p, const Point & d) const;
+
+  /**
+   * trace one history start from p in elem with direction d
+   */
+  void trace_history(const Elem * elem, Point p, Point d, RandomStream & rng, std::vector<EnergyDeposit> & deposits) const;
+
+  /**
+   * the exit distance of ray (p, d) inside elem, and the side it exits
+   */
+  static double exit_distance(const Elem * elem, const Point & p, const Point & d, unsigned int & side);
+};
+
+#endif
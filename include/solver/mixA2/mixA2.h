@@ -159,6 +159,11 @@ public:
    */
   virtual void error_norm();
 
+  /**
+   * the local offsets of each variable for error norm
+   */
+  virtual void build_norm_index();
+
   /**
    * @return the bandwidth contributed by each boundary node
    */
@@ -120,6 +120,17 @@ public:
     }
   }
 
+  /**
+   * @return the solution variable of the dof-th nodal dof, layout is given by region's ebm_variable_offset
+   */
+  virtual SolutionVariable node_dof_variable(const SimulationRegion * region, unsigned int dof) const
+  {
+    const SolutionVariable variables[] = {POTENTIAL, ELECTRON, HOLE, TEMPERATURE, E_TEMP, H_TEMP};
+    for(unsigned int i=0; i<6; ++i)
+      if( region->ebm_variable_offset(variables[i]) == dof ) return variables[i];
+    return INVALID_Variable;
+  }
+
   /**
    * indicates if PDE involves all neighbor elements.
    * when it is true, the matrix bandwidth will include all the nodes belongs to neighbor elements, i.e. DDM solver
@@ -182,6 +193,11 @@ public:
    */
   virtual void error_norm();
 
+  /**
+   * the local offsets of each variable for error norm
+   */
+  virtual void build_norm_index();
+
   /**
    * @return the bandwidth contributed by each boundary node
    */
@@ -35,7 +35,8 @@ public:
   /**
    * constructor
    */
-  MixASolverBase(SimulationSystem & system): DDMSolverBase(system), _circuit(system.get_circuit())
+  MixASolverBase(SimulationSystem & system): DDMSolverBase(system), _circuit(system.get_circuit()),
+      _spice_stamp_valid(false), _spice_bypass_count(0)
   {}
 
   /**
@@ -103,6 +104,11 @@ public:
    */
   void build_spice_function(PetscScalar *lxx, Vec f, InsertMode &add_value_flag);
 
+  /**
+   * @return true when the spice stamp of last circuit load can be reused for \p rhs
+   */
+  bool spice_bypass(const std::vector<double> &rhs) const;
+
   /**
    * add spice matrix to petsc matrix
    */
@@ -166,6 +172,22 @@ protected:
    */
   PetscScalar spice_norm;
 
+  /**
+   * spice node values of the last MODEINITFLOAT circuit load in transient,
+   * the matrix and rhs of spice keep this linearization while the load is bypassed
+   */
+  std::vector<double> _spice_stamp_rhs;
+
+  /**
+   * the stamp of last circuit load is valid for bypass in current time step
+   */
+  bool _spice_stamp_valid;
+
+  /**
+   * the number of bypassed circuit loads
+   */
+  unsigned int _spice_bypass_count;
+
 };
 
 #endif //#define __mixA_solver_h__
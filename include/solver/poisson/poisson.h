@@ -40,7 +40,7 @@ public:
   /**
    * the constructor of PoissonSolver, take system as parameter
    */
-  PoissonSolver(SimulationSystem & system): FVM_NonlinearSolver(system)
+  PoissonSolver(SimulationSystem & system): FVM_NonlinearSolver(system), _verbose(true)
   {system.record_active_solver(this->solver_type());}
 
   /**
@@ -70,6 +70,12 @@ public:
    */
   virtual int destroy_solver() ;
 
+  /**
+   * print the converged reason after each solve, used by solvers which call poisson solver frequently
+   */
+  void set_verbose(bool verbose)
+  { _verbose = verbose; }
+
   /**
    * do pre-process before each solve action
    */
@@ -172,6 +178,15 @@ private:
 
   void potential_damping(Vec x, Vec y, Vec w, PetscBool *changed_y, PetscBool *changed_w);
 
+  /**
+   * AMG options for poisson's equation, see SolverSpecify::PoissonAMG
+   */
+  void set_petsc_amg_options();
+
+  /**
+   * print the converged reason after each solve
+   */
+  bool _verbose;
 };
 
 
@@ -43,6 +43,7 @@ public:
       _init_power(init_power), _power(power)
   {
     hit_elem = NULL;
+    segment  = -1;
   }
 
   /**
@@ -140,11 +141,35 @@ public:
    */
   IntersectionResult result;
 
+  /**
+   * index of the last recorded path segment of this light, -1 for none.
+   * the reflect/refract light inherits it from the incident light
+   */
+  int segment;
+
   /**
    * factor to determine it is dead
    */
   static double dead_factor;
 
+  /**
+   * LightThread objects are allocated from a free-list pool, since a lot of
+   * secondary rays are created and deleted during ray tracing.
+   * each thread keeps its own free list, no lock is needed except for getting a new chunk.
+   */
+  static void * operator new(size_t size);
+
+  /**
+   * return the memory to the free list of current thread
+   */
+  static void operator delete(void * p, size_t size);
+
+  /**
+   * release all the memory hold by the pool.
+   * all the LightThread objects must have been deleted, and it should not be called in parallel region
+   */
+  static void release_pool();
+
 private:
 
   /**
@@ -23,7 +23,9 @@
 #ifndef __object_tree_h__
 #define __object_tree_h__
 
-#include "tree_base.h"
+#include <vector>
+
+#include "point.h"
 
 // Forward Declarations
 class MeshBase;
@@ -31,7 +33,9 @@ class Elem;
 class LightThread;
 
 /**
- * an octree/quad tree for fast ray-elem intersection test
+ * a bounding volume hierarchy (BVH) of boundary elems for fast ray-elem intersection test.
+ * the tree is built by surface area heuristic (SAH) and stored in a flattened node array,
+ * the left child of an interior node always follows its parent in the array.
  */
 class ObjectTree
 {
@@ -41,11 +45,17 @@ public:
 
   ~ObjectTree();
 
+  /**
+   * @return true if the mesh is a 3D one
+   */
   bool is_octree() const
-  { return _tree->n_leaf() == 8; }
+  { return !_planar_xy; }
 
+  /**
+   * @return true if the mesh lies on xy plane
+   */
   bool is_quadtree() const
-  { return _tree->n_leaf() == 4; }
+  { return _planar_xy; }
 
   /**
    * @return the first elem the light thread hit
@@ -57,6 +67,14 @@ public:
    */
   const Elem * hit(const Point & p, const Point & d) const;
 
+  /**
+   * trace a packet of parallel rays, which start from p[i] with the same direction d, together.
+   * the BVH is traversed once for the whole packet, a node is visited when any ray in the packet hits it.
+   * it is efficient for coherent rays, i.e. the primary rays emitted from a wave plane.
+   * @return the first elem each ray hit in elems, NULL for missed ray
+   */
+  void hit(const std::vector<Point> & p, const Point & d, std::vector<const Elem *> & elems) const;
+
   /**
    * @return true if the ray(p,d) hit the bounding box of the mesh
    */
@@ -65,12 +83,48 @@ public:
 private:
 
   /**
-   * Pointer to our tree.  The tree is built at run-time
-   * through \p init().  For servant PointLocators (not master),
-   * this simply points to the tree of the master.
+   * node of BVH
+   */
+  struct BVHNode
+  {
+    /// the bounding box of all the elems in this node
+    Point box_min, box_max;
+    /// leaf node: the first elem in _elems; interior node: index of right child
+    unsigned int offset;
+    /// number of elems for leaf node, 0 for interior node
+    unsigned int n_elems;
+  };
+
+  /**
+   * the mesh lies on xy plane
+   */
+  bool _planar_xy;
+
+  /**
+   * the flattened BVH, _nodes[0] is the root
    */
-  TreeBase* _tree;
+  std::vector<BVHNode> _nodes;
+
+  /**
+   * boundary elems, ordered by BVH leaf
+   */
+  std::vector<const Elem *> _elems;
+
+  /**
+   * bounding box of each elem in _elems
+   */
+  std::vector<std::pair<Point, Point> > _elem_boxes;
+
+  /**
+   * build BVH node for elems in [begin, end), recursively
+   */
+  void _build(unsigned int begin, unsigned int end);
+
+  /**
+   * ray-box slab test
+   * @return true if the ray(p, 1/d) hit the box at t in [0, t_max], t_near is the entry distance
+   */
+  static bool _hit_box(const BVHNode & node, const Point & p, const Point & inv_d, double t_max, double & t_near);
 };
 
 #endif
-
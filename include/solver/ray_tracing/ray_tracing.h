@@ -79,6 +79,18 @@ public:
    */
   virtual int destroy_solver();
 
+  /**
+   * @return true if the ray paths of last solve are recorded
+   */
+  bool has_ray_paths() const
+  { return !_ray_segments.empty(); }
+
+  /**
+   * recompute the optical generation with current carrier density by the recorded ray paths,
+   * instead of tracing all the rays again. only free carrier absorption is changed.
+   */
+  int update_free_carrier_absorption();
+
 
 private:
 
@@ -277,11 +289,16 @@ private:
 
     /**
      * the start point of each ray, each takes three double value as (X,Y,Z)
-     * only record the rays own by local processor
+     * all the rays are recorded, they are handed out to the processors by batch
      */
     std::vector<Point> ray_start_points;
 
-    unsigned int n_on_processor_rays() const
+    /**
+     * the grid index of each ray start point in the wave plane, (i, 0) for 2D mesh
+     */
+    std::vector< std::pair<int, int> > ray_grid;
+
+    unsigned int n_rays() const
     { return static_cast<unsigned int>(ray_start_points.size()); }
 
     const Point & ray_start_point(unsigned int n) const
@@ -328,26 +345,164 @@ private:
   void define_lenses();
 
   /**
-   * do ray tracing of a single ray
+   * energy deposit of a ray segment into an elem
+   */
+  struct EnergyDeposit
+  {
+    unsigned int elem_id;  // the elem which absorbs the energy
+    double       band;     // band-band absorption
+    double       total;    // total absorption
+  };
+
+  /**
+   * a segment of ray inside an elem. the power of the ray at segment start only depends on
+   * the power of its parent segment and the absorption along the ray path, since the
+   * reflection/refraction coefficients are proportional to the power.
+   */
+  struct RaySegment
+  {
+    int          parent;     // the segment this ray comes from, -1 for ray enters the mesh
+    unsigned int elem_id;    // the elem this segment passes
+    double       length;     // path length in the elem
+    double       power;      // power at segment start
+    double       a_band;     // band-band absorption coefficient
+    double       a_fc;       // free carrier absorption coefficient when traced
+    unsigned int n_deposits; // number of energy deposits of this segment
+  };
+
+  /**
+   * do ray tracing of a single ray, the energy deposit of the ray (and its secondary rays)
+   * is appended to deposits in tracing order.
+   * it doesn't modify any member of the solver, so rays can be traced concurrently.
+   * surface_elem is the first elem the ray hits if it is already known, i.e. by packet tracing.
+   * the ray path is appended to segments if it is not NULL.
+   */
+  void ray_tracing(LightThread *, std::vector<EnergyDeposit> & deposits, const Elem * surface_elem=NULL,
+                   std::vector<RaySegment> * segments=NULL, unsigned long long seed=0) const;
+
+  /**
+   * record the ray path, then the free carrier absorption can be updated without ray tracing
+   */
+  bool _record_ray_paths;
+
+  /**
+   * ray batches are handed out to the processors on request, otherwise each processor traces a fixed share
+   */
+  bool _dynamic_schedule;
+
+  /**
+   * number of coarse levels of adaptive ray density, 0 for the uniform ray grid
+   */
+  unsigned int _adaptive_level;
+
+  /**
+   * a cell of ray grid is refined when its absorbed fraction differs from a neighbor cell
+   * by more than this tolerance times the largest absorbed fraction
+   */
+  double _adaptive_tol;
+
+  /**
+   * survival probability of russian roulette for the rays below dead power, 0 to kill them all
+   */
+  double _roulette_survival;
+
+  /**
+   * the ray segments of each wavelength traced by this processor
+   */
+  std::vector< std::vector<RaySegment> > _ray_segments;
+
+  /**
+   * the energy deposit of each wavelength traced by this processor, in the order of ray segments
    */
-  void ray_tracing(LightThread *);
+  std::vector< std::vector<EnergyDeposit> > _ray_deposits;
 
   /**
-   * save the energy deposit. for parallel simulation, we must gather this vector
-   * from all the processors (call Parallel::sum(_band_absorption_energy_in_elem))
+   * recompute the energy deposit of the n-th optical source with recorded ray paths
+   */
+  void replay_ray_paths(unsigned int n);
+
+  /**
+   * save the energy deposit of current wavelength on this processor.
    */
   std::vector<double> _band_absorption_energy_in_elem;
 
   /**
-   * save the energy deposit. for parallel simulation, we must gather this vector
-   * from all the processors (call Parallel::sum(_total_absorption_energy_in_elem))
+   * save the energy deposit of current wavelength on this processor.
    */
   std::vector<double> _total_absorption_energy_in_elem;
 
   /**
-   * convert energy to optical Generation
+   * carrier generation in each elem, summed over all the wavelengths.
+   * for parallel simulation, it is gathered from all the processors only once after the whole spectrum
+   */
+  std::vector<double> _generation_in_elem;
+
+  /**
+   * heat of carrier generation in each elem, summed over all the wavelengths
+   */
+  std::vector<double> _heat_in_elem;
+
+  /**
+   * total absorbed energy in each elem, summed over all the wavelengths
+   */
+  std::vector<double> _energy_in_elem;
+
+  /**
+   * convert energy deposit of the n-th optical source to carrier generation, add it to the spectrum sum
+   */
+  void accumulate_optical_generation(unsigned int n);
+
+  /**
+   * gather the spectrum sum of all the processors, and set the optical generation to the nodes
+   */
+  void optical_generation();
+
+  /**
+   * trace all the rays of given wavelength and power, record energy deposit of this processor
+   */
+  void trace_rays(double lamda, double power);
+
+  /**
+   * trace the rays of wave plane in the list, each ray carries power*weight.
+   * energy deposit is recorded unless the absorbed energy of each ray is required (pilot pass)
+   */
+  void trace_ray_set(const std::vector<unsigned int> & rays, const std::vector<double> & weights,
+                     double lamda, double power, std::vector<double> * absorption);
+
+  /**
+   * build the rays of adaptive density by pilot passes on the coarse levels of ray grid.
+   * a cell is represented by one ray carrying the power of the whole cell, it is split
+   * when its absorption differs from the neighbors
+   */
+  void adaptive_ray_set(double lamda, double power, std::vector<unsigned int> & rays, std::vector<double> & weights);
+
+  /**
+   * file to save/reload the energy deposit of the whole spectrum, empty for no cache
+   */
+  std::string _cache_file;
+
+  /**
+   * the key of cache file, built from mesh, regions, source card and the spectrum.
+   * the cache can be reused only when the key matches
+   */
+  std::string cache_key() const;
+
+  /**
+   * reload energy deposit of all the wavelengths from cache file.
+   * @return false if file not exist or key mismatch
+   */
+  bool load_cache(std::vector<double> & total_absorption) const;
+
+  /**
+   * save energy deposit of all the wavelengths to cache file
+   */
+  void save_cache(const std::vector<double> & total_absorption) const;
+
+  /**
+   * set the energy deposit of the n-th optical source from cache,
+   * the band-band part is recomputed with free carrier absorption of current carrier density
    */
-  void optical_generation(unsigned int );
+  void restore_energy_deposit(unsigned int n, const std::vector<double> & total_absorption);
 };
 
 #endif
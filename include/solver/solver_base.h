@@ -104,6 +104,13 @@ public:
    */
   virtual SolverSpecify::SolverType solver_type()const=0;
 
+  /**
+   * add the approx memory usage of this processor to the breakdown, indexed by subsystem name.
+   * the default one reports the simulation system, derived solver should add its PETSc objects
+   */
+  virtual void memory_usage(std::map<std::string, size_t> & usage) const
+  { _system.memory_usage(usage); }
+
   /**
    * @return the label of the solver
    */
@@ -73,6 +73,12 @@ namespace SolverSpecify
    */
   extern std::map<std::string, std::pair<std::string, std::vector<Parser::Parameter> > > Hooks;
 
+  /**
+   * execution policy of hooks, \<id \<every, interval\> \>. hooks with id in HookReport print timing at close
+   */
+  extern std::map<std::string, std::pair<int, double> > HookSchedule;
+  extern std::map<std::string, bool> HookReport;
+
   /**
    * nonlinear solver scheme: basic, line search, trust region...
    */
@@ -83,6 +89,138 @@ namespace SolverSpecify
    */
   extern int     NSLagPCLU;
 
+  /**
+   * Determines when the jacobian matrix is rebuilt in DC sweep and transient nonlinear solve
+   */
+  extern int     NSLagJacobian;
+
+  /**
+   * max number of secant updates of Broyden nonlinear solver before the jacobian matrix is rebuilt
+   */
+  extern int     BroydenMemory;
+
+  /**
+   * Broyden nonlinear solver rebuilds the jacobian matrix when the residual norm
+   * decreases by less than this factor in one iteration
+   */
+  extern double  BroydenRestart;
+
+  /**
+   * inexact newton, the relative tolerance of linear solver is set by Eisenstat-Walker forcing term
+   */
+  extern bool    InexactNewton;
+
+  /**
+   * newton-AMG for poisson's equation, the linearized poisson's equation is solved by
+   * GMRES with algebraic multigrid preconditioner and Eisenstat-Walker tolerance
+   */
+  extern bool    PoissonAMG;
+
+  /**
+   * jacobian-free newton-krylov, the krylov operator is finite differenced residual,
+   * and the assembled jacobian matrix is only used as preconditioner
+   */
+  extern bool    JFNK;
+
+  /**
+   * rebuild the preconditioner of JFNK every n Newton iterations
+   */
+  extern int     JFNKLagPC;
+
+  /**
+   * build the jacobian matrix together with the residual by one AD pass, plain newton only
+   */
+  extern bool    FusedAssembly;
+
+  /**
+   * switch between krylov and direct linear solver by the cost of previous nonlinear solves
+   */
+  extern bool    AdaptiveLinearSolver;
+
+  /**
+   * krylov iterations per Newton step, above which adaptive linear solver switches to direct solver
+   */
+  extern int     AdaptiveKSPIts;
+
+  /**
+   * rebuild the preconditioner of krylov solver every n jacobian matrices, across time steps
+   */
+  extern int     PCLag;
+
+  /**
+   * rebuild the lagged preconditioner when krylov iterations exceed this factor of the ones after the last rebuild
+   */
+  extern double  PCLagGrowth;
+
+  /**
+   * freeze the dofs whose relative Newton update stays below this value, 0 disables freezing
+   */
+  extern double  FreezeTol;
+
+  /**
+   * the number of consecutive quiet Newton iterations before a dof is frozen
+   */
+  extern int     FreezeIts;
+
+  /**
+   * release a frozen dof when its residual grows by this factor
+   */
+  extern double  FreezeWake;
+
+  /**
+   * mixed-mode transient skips the spice circuit load when all the spice nodes moved below this
+   * relative value since the last load, the last stamp is reused. 0 disables the bypass
+   */
+  extern double  SpiceBypassTol;
+
+  /**
+   * reuse the ordering and symbolic factorization of jacobian matrix across Newton steps
+   */
+  extern bool    ReuseSymbolicFactorization;
+
+  /**
+   * cache the matrix nonzero pattern of each solver type, reuse it when the same solver is created again
+   */
+  extern bool    CacheNonzeroPattern;
+
+  /**
+   * krylov solver starts from the extrapolated Newton correction of previous iteration
+   */
+  extern bool    KSPWarmStart;
+
+  /**
+   * factor the jacobian matrix of direct solver in single precision,
+   * and recover double precision accuracy by iterative refinement
+   */
+  extern bool    LUSinglePrecision;
+
+  /**
+   * refinement of single precision LU: "gmres" (GMRES-IR) or "richardson" (classic iterative refinement)
+   */
+  extern std::string LURefinement;
+
+  /**
+   * block low-rank compression of MUMPS LU factors
+   */
+  extern bool    LUBlockLowRank;
+
+  /**
+   * dropping tolerance of block low-rank compression
+   */
+  extern double  LUBlockLowRankTol;
+
+  /**
+   * fill-reducing ordering of direct solver: "nd" for nested dissection of mesh nodes,
+   * "default" for the ordering of the solver package
+   */
+  extern std::string LUOrdering;
+
+  /**
+   * repartition the mesh after a solve command when the measured load imbalance
+   * (max/average solve time of processors) exceeds this ratio. disabled when less than 1
+   */
+  extern double  RepartitionImbalance;
+
   /**
    * linear solver scheme: LU, BCGS, GMRES ...
    */
@@ -93,6 +231,21 @@ namespace SolverSpecify
    */
   extern PreconditionerType      PC;
 
+  /**
+   * composition of field split preconditioner: additive, multiplicative or schur
+   */
+  extern std::string             FieldSplitType;
+
+  /**
+   * composition of region schwarz preconditioner: restrict, additive or multiplicative
+   */
+  extern std::string             RegionASMType;
+
+  /**
+   * matrix type of jacobian matrix: aij, baij for node blocks, or aijcusparse / aijkokkos to solve the linear system on the device
+   */
+  extern std::string             MatrixType;
+
   /**
    * Newton damping
    */
@@ -159,6 +312,30 @@ namespace SolverSpecify
    */
   extern double    PoissonCorrectionParameter;
 
+  /**
+   * safety factor of the CFL time step limit of half implicit method
+   */
+  extern double    HalfImplicitCFL;
+
+  //--------------------------------------------
+  // parameters for gummel method
+  //--------------------------------------------
+
+  /**
+   * max number of gummel (Poisson/electron/hole) iterations
+   */
+  extern unsigned int    GummelMaxIteration;
+
+  /**
+   * gummel iteration is converged when the max potential update less than this value
+   */
+  extern double    GummelPotentialToler;
+
+  /**
+   * hand off to coupled DDML1 newton solver after gummel iteration
+   */
+  extern bool      GummelNewton;
+
 
   //--------------------------------------------
   // linear solver convergence criteria
@@ -285,6 +462,44 @@ namespace SolverSpecify
    */
   extern TemporalScheme    TS_type;
 
+  /**
+   * step size controller used in AutoStep
+   */
+  extern StepController    TS_controller;
+
+  /**
+   * operator splitting of lattice heat equation in transient simulation. the lattice temperature
+   * is held during carrier steps, and the heat equation is solved every HeatSplit carrier steps
+   * over the elapsed time with the electrical variables held. 0 for fully coupled solution
+   */
+  extern int       HeatSplit;
+
+  /**
+   * solve the split heat step by GMRES with algebraic multigrid preconditioner
+   */
+  extern bool      HeatSplitAMG;
+
+  /**
+   * periodic steady state by shooting method, the transient of one period is integrated
+   * repeatedly and its initial state is corrected by newton method
+   */
+  extern bool      Shooting;
+
+  /**
+   * period of the sources for shooting method
+   */
+  extern double    ShootingPeriod;
+
+  /**
+   * max newton iterations of shooting method
+   */
+  extern unsigned int ShootingMaxIteration;
+
+  /**
+   * relative tolerance of GMRES for the monodromy equation of shooting method
+   */
+  extern double    ShootingKSPRelTol;
+
   /**
    * start time of transient simulation
    */
@@ -326,6 +541,82 @@ namespace SolverSpecify
    */
   extern bool      Predict;
 
+  /**
+   * predict next solution of DC sweep by the sensitivity dx/dV (or dx/dI) with factored jacobian,
+   * instead of projection from previous solutions
+   */
+  extern bool      PredictTangent;
+
+  /**
+   * extract the terminal conductance and quasi-static capacitance matrix at each converged
+   * point of DC sweep and write them to this file, empty for no extraction
+   */
+  extern std::string SmallSignalFile;
+
+  /**
+   * file prefix of the on-disk solution cache of DC sweep, empty for no cache
+   */
+  extern std::string SolutionCachePrefix;
+
+  /**
+   * electrodes whose terminal current is differentiated by adjoint method at the converged
+   * solution of steadystate and DC sweep, one transposed linear solve for each
+   */
+  extern std::vector<std::string> AdjointCurrent;
+
+  /**
+   * device parameters of adjoint sensitivity, doping:<region>, trap:<region>, workfunction:<electrode>
+   * or pmi:<region>:<model>:<parameter>. doping, trap and pmi are relative to the parameter value
+   */
+  extern std::vector<std::string> AdjointParameter;
+
+  /**
+   * file for the gradient of adjoint sensitivity
+   */
+  extern std::string AdjointFile;
+
+  /**
+   * electrodes of impedance field method, the green's function of their terminal current to local
+   * charge gives the current variability by random dopant fluctuation
+   */
+  extern std::vector<std::string> IFMCurrent;
+
+  /**
+   * number of random doping samples evaluated by the green's function, 0 for variance only
+   */
+  extern int         IFMSamples;
+
+  /**
+   * seed of random doping samples
+   */
+  extern int         IFMSeed;
+
+  /**
+   * file for the result of impedance field method
+   */
+  extern std::string IFMFile;
+
+  /**
+   * number of ensemble instances, each one solves the device with random doping
+   * (and trap density) over the same mesh and solver. 0 for normal solve
+   */
+  extern int         EnsembleSize;
+
+  /**
+   * seed of ensemble random doping
+   */
+  extern int         EnsembleSeed;
+
+  /**
+   * relative standard deviation of trap density of each ensemble instance
+   */
+  extern double      EnsembleTrapSigma;
+
+  /**
+   * file for the terminal potential and current of ensemble instances
+   */
+  extern std::string EnsembleFile;
+
   /**
    * relative tol of TS truncate error, used in AutoStep
    */
@@ -437,6 +728,32 @@ namespace SolverSpecify
    */
   extern double    IStop;
 
+  /**
+   * start magnetic field of B sweep (hall solver)
+   */
+  extern double    BStart;
+
+  /**
+   * magnetic field step
+   */
+  extern double    BStep;
+
+  /**
+   * stop magnetic field of B sweep
+   */
+  extern double    BStop;
+
+  /**
+   * direction of swept magnetic field, 0:x 1:y 2:z
+   */
+  extern unsigned int BDirection;
+
+  /**
+   * B sweep keeps the jacobian factored at the first point, and solves the
+   * other points by chord Newton iterations with it. valid for small B
+   */
+  extern bool      BPerturb;
+
   /**
    *  the simulation cycles
    */
@@ -512,6 +829,71 @@ namespace SolverSpecify
    */
   extern double    Freq;
 
+  /**
+   * number of processor groups, each group solves a disjoint subset of frequency points
+   */
+  extern unsigned int ACFreqGroups;
+
+  /**
+   * use reduced order model for AC sweep
+   */
+  extern bool      ACMOR;
+
+  /**
+   * number of expansion frequencies of the reduced order model
+   */
+  extern unsigned int ACMORPoints;
+
+  /**
+   * number of moments at each expansion frequency
+   */
+  extern unsigned int ACMORMoments;
+
+  /**
+   * number of frequency points verified by full solve
+   */
+  extern unsigned int ACMORCheck;
+
+  /**
+   * N-port AC sweep, each electrode of ACScan is driven in turn with the factored AC matrix
+   * of the frequency, the admittance and scattering matrix are written to ACNPortFile
+   */
+  extern bool      ACNPort;
+
+  /**
+   * file of the N-port admittance and scattering matrix
+   */
+  extern std::string ACNPortFile;
+
+  /**
+   * reference impedance of scattering matrix
+   */
+  extern double    ACNPortZ0;
+
+  //------------------------------------------------------
+  // parameters for harmonic balance
+  //------------------------------------------------------
+
+  /**
+   * fundamental frequency of the periodic excitation
+   */
+  extern double    HBFrequency;
+
+  /**
+   * number of harmonics, the period is sampled at 2*HBHarmonics+1 time points
+   */
+  extern unsigned int HBHarmonics;
+
+  /**
+   * relative reduction of the harmonic balance residual norm
+   */
+  extern double    HBRelTol;
+
+  /**
+   * relative tolerance of GMRES for each newton step of harmonic balance
+   */
+  extern double    HBKSPRelTol;
+
   //------------------------------------------------------
   // parameters for pseudo time stepping method
   //------------------------------------------------------
@@ -587,6 +969,31 @@ namespace SolverSpecify
    */
   extern int PseudoTimeSteps;
 
+  /**
+   * switched evolution relaxation of pseudo time step, dt grows with the ratio of successive steady residual norms
+   */
+  extern bool PseudoTimeSER;
+
+  /**
+   * exponent of the residual ratio in switched evolution relaxation
+   */
+  extern double PseudoTimeSERExponent;
+
+  /**
+   * max growth factor of pseudo time step in one step of switched evolution relaxation
+   */
+  extern double PseudoTimeSERGrowth;
+
+  /**
+   * use local pseudo time step scaled by the diffusive time scale of each control volume
+   */
+  extern bool PseudoTimeLocal;
+
+  /**
+   * switch to plain newton when the steady residual falls below this fraction of the initial one, 0 disables it
+   */
+  extern double PseudoTimeNewtonSwitch;
+
   //------------------------------------------------------
   // parameters for optical / particle effect
   //------------------------------------------------------
@@ -622,6 +1029,14 @@ namespace SolverSpecify
    * convert string to enum
    */
   extern SolutionType type_string_to_enum(const std::string s);
+
+  /**
+   * time step factor of PI controller.
+   * @param r       normalized truncate error of current step, as LTE^(-1/(k+1))
+   * @param r_last  the same value of previous accepted step
+   * @return the factor of next time step
+   */
+  extern double pi_step_factor(double r, double r_last);
 }
 
 
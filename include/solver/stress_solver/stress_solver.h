@@ -27,17 +27,21 @@
 #include <vector>
 
 #include "enum_petsc_type.h"
-#include "fvm_linear_solver.h"
+#include "fem_linear_solver.h"
 //#include "petscis.h"
 //#include "petscvec.h"
 //#include "petscmat.h"
 #include "petscksp.h"
 
+class Elem;
 
 /**
- * The linear solver contex.
+ * The linear elastic stress solver, 3 displacement dofs per node.
+ * The stiffness operator is applied element by element without storing
+ * the global matrix, only the 3x3 nodal diagonal blocks are assembled
+ * as the preconditioning matrix.
  */
-class StressSolver : public FVM_LinearSolver
+class StressSolver : public FEM_LinearSolver
 {
 public:
 
@@ -47,7 +51,7 @@ public:
    * as well as parallel scatter
    */
   StressSolver(SimulationSystem & system, Parser::InputParser & decks)
-  : FVM_LinearSolver(system), _decks(decks)
+  : FEM_LinearSolver(system), _decks(decks)
   {system.record_active_solver(this->solver_type());}
 
   /**
@@ -82,34 +86,40 @@ public:
   virtual void build_rhs(Vec b);
 
   /**
-   * virtual function for building the matrix A and precondition matrix PC
+   * virtual function for building the preconditioning matrix, the nodal diagonal blocks of stiffness matrix
    */
   virtual void build_matrix(Mat A, Mat pc);
 
-
   /**
-   * @return node's dof for each region. only 1 dof here
+   * the stiffness matrix is never assembled
    */
-  virtual unsigned int node_dofs(const SimulationRegion * region) const
-  { assert(region!=NULL); return 1; }
+  virtual bool matrix_free() const
+  { return true; }
 
   /**
-   * @return the dofs of each boundary condition
+   * y = K*x, summed element by element
    */
-  virtual unsigned int bc_dofs(const BoundaryCondition * bc) const
-  { assert(bc!=NULL); return 0; }
+  virtual void matrix_free_mult(Vec x, Vec y);
 
   /**
-   * @return the boundary condition dofs contributed by each boundary node
+   * @return node's dof, the 3 displacement components
    */
-  virtual unsigned int bc_node_dofs(const BoundaryCondition * bc) const
-  { assert(bc!=NULL); return 0; }
+  virtual unsigned int node_dofs() const
+  { return 3; }
 
-  virtual bool all_neighbor_elements_involved(const SimulationRegion *) const
-  { return false; }
+  /**
+   * PETSC KSP can have an individual prefix
+   */
+  virtual std::string ksp_prefix() const { return "STRESS_"; }
 
  private:
 
+  /**
+   * the elastic stiffness tensor C of element in Voigt notation, a 6x6 symmetry matrix.
+   * now only a sample is taken
+   */
+  void elastic_tensor(const Elem *elem, double C[6][6]) const;
+
    /**
   * since reading deck involves stack operate, we can not use const here
   */
@@ -119,4 +129,3 @@ public:
 
 
 #endif // #define __stress_solver_h__
-
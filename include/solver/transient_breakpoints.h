@@ -0,0 +1,69 @@
+/********************************************************************************/
+/*     888888    888888888   88     888  88888   888      888    88888888       */
+/*   8       8   8           8 8     8     8      8        8    8               */
+/*  8            8           8  8    8     8      8        8    8               */
+/*  8            888888888   8   8   8     8      8        8     8888888        */
+/*  8      8888  8           8    8  8     8      8        8            8       */
+/*   8       8   8           8     8 8     8      8        8            8       */
+/*     888888    888888888  888     88   88888     88888888     88888888        */
+/*                                                                              */
+/*       A Three-Dimensional General Purpose Semiconductor Simulator.           */
+/*                                                                              */
+/*                                                                              */
+/*  Copyright (C) 2007-2008                                                     */
+/*  Cogenda Pte Ltd                                                             */
+/*                                                                              */
+/*  Please contact Cogenda Pte Ltd for license information                      */
+/*                                                                              */
+/*  Author: Gong Ding   gdiso@ustc.edu                                          */
+/*                                                                              */
+/********************************************************************************/
+
+
+#ifndef __transient_breakpoints_h__
+#define __transient_breakpoints_h__
+
+#include <vector>
+
+class SimulationSystem;
+
+/**
+ * table of time points where the electrical sources, particle sources or the light
+ * envelope change slope. it is built once before a transient run, and the step
+ * controller uses it to land on each corner instead of stepping over it.
+ */
+class TransientBreakpoints
+{
+public:
+
+  TransientBreakpoints() {}
+
+  /**
+   * collect all the source corners in (t_start, t_stop]
+   */
+  void build(const SimulationSystem & system, double t_start, double t_stop);
+
+  /**
+   * @return number of breakpoints
+   */
+  unsigned int size() const { return _points.size(); }
+
+  /**
+   * limit the step dt from clock so it does not step over the next breakpoint.
+   * a breakpoint a little beyond the step is reached by two equal steps,
+   * and the first step after a breakpoint is limited to a fraction of the
+   * distance to the following one, since the slope changes there
+   */
+  double limit_dt(double clock, double dt, double dt_min) const;
+
+private:
+
+  std::vector<double> _points;
+
+  /**
+   * @return iterator to the first breakpoint later than t within tolerance
+   */
+  std::vector<double>::const_iterator _next(double t, double tol) const;
+};
+
+#endif
@@ -115,6 +115,11 @@ public:
    */
   double limit_dt(double time, double dt, double dt_min, double v_change, double i_change) const;
 
+  /**
+   * @return the first corner of the sources attached to electrodes later than t
+   */
+  double next_breakpoint(double t) const;
+
   /**
    * update Vapp or Iapp for all the electrode bcs to new time step
    * @note the default vapp/iapp is 0 for all the electrode
@@ -71,6 +71,11 @@ public:
    */
   double limit_dt(double time, double dt) const;
 
+  /**
+   * @return the first corner of particle sources and the light envelope later than t
+   */
+  double next_breakpoint(double t) const;
+
   /**
    * @return true when we have particle incident
    */
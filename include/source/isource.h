@@ -35,6 +35,7 @@
 
 #include "config.h"
 #include "expr_evaluate.h"
+#include "source_breakpoint.h"
 
 #ifdef WINDOWS
   class HINSTANCE__; // Forward or never
@@ -73,6 +74,12 @@ public:
    */
   virtual double iapp(double t)=0;
 
+  /**
+   * @return next corner of the source waveform later than t, infinity if none
+   */
+  virtual double next_breakpoint(double t) const
+  { return std::numeric_limits<double>::infinity(); }
+
   /**
    * @return the max value of iapp(t+delta_t)-iapp(t), delta_t in [0, dt]
    */
@@ -139,6 +146,12 @@ public:
   { return t>=td? Idc:0;}
 
 
+  /**
+   * @return next corner of the source waveform later than t
+   */
+  double next_breakpoint(double t) const
+  { return step_next_breakpoint(t, td); }
+
   /**
    * @return the max value of iapp(t+delta_t)-iapp(t), delta_t in [0, dt]
    */
@@ -201,6 +214,12 @@ public:
   { return t>=td? Iamp*exp(-alpha*(t-td))*sin(2*3.14159265358979323846*fre*(t-td)):0;}
 
 
+  /**
+   * @return next corner of the source waveform later than t
+   */
+  double next_breakpoint(double t) const
+  { return step_next_breakpoint(t, td); }
+
   /**
    * @return the max value of iapp(t+delta_t)-iapp(t), delta_t in [0, dt]
    */
@@ -315,6 +334,12 @@ public:
     }
   }
 
+  /**
+   * @return next corner of the source waveform later than t
+   */
+  double next_breakpoint(double t) const
+  { return pulse_next_breakpoint(t, td, tr, pw, tf, pr); }
+
   /**
    * @return the max value of iapp(t+delta_t)-iapp(t), delta_t in [0, dt]
    */
@@ -425,6 +450,12 @@ public:
   }
 
 
+  /**
+   * @return next corner of the source waveform later than t
+   */
+  double next_breakpoint(double t) const
+  { return t<td ? td : step_next_breakpoint(t, tfd); }
+
   /**
    * @return the max value of iapp(t+delta_t)-iapp(t), delta_t in [0, dt]
    */
@@ -61,7 +61,7 @@ public:
   Sphere bounding_sphere() const;
 
   /**
-   * apply lens to light thread
+   * apply lens to light thread, thread safe
    */
   LightThread * operator << (LightThread *) const;
 
@@ -78,6 +78,40 @@ private:
 
   std::vector<std::string> _effect_lenses;
   std::map<std::string, Lens *> _lenses;
+
+  /**
+   * the active lenses, in the order of _effect_lenses
+   */
+  std::vector<const Lens *> _active_lenses;
+
+  /**
+   * node of the bounding volume hierarchy over the active lens disks
+   */
+  struct LensBox
+  {
+    Point lo, hi;
+    /// child nodes, -1 for leaf
+    int left, right;
+    /// range in _lens_order for leaf
+    unsigned int begin, end;
+  };
+
+  std::vector<LensBox> _lens_tree;
+
+  /**
+   * index into _active_lenses, sorted by the tree
+   */
+  std::vector<unsigned int> _lens_order;
+
+  /**
+   * build the subtree of lenses in _lens_order[begin, end), @return its node index
+   */
+  int build_lens_tree(unsigned int begin, unsigned int end);
+
+  /**
+   * @return the first lens hit by the ray from \p p along \p dir, and the distance \p t. 0 for none
+   */
+  const Lens * nearest_lens(const Point &p, const Point &dir, double &t) const;
 };
 
 #endif
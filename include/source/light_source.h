@@ -37,6 +37,7 @@ namespace Parser{
 }
 class SimulationSystem;
 class Waveform;
+class RayTraceSolver;
 
 class Light_Source
 {
@@ -151,13 +152,13 @@ class Light_Source_RayTracing : public Light_Source
   public:
 
     Light_Source_RayTracing(SimulationSystem &system, const Parser::Card &c)
-    :Light_Source(system),_card(c)
+    :Light_Source(system),_card(c),_solver(0),_solver_mesh_revision(0)
     {}
 
     /**
-     * virtual destructor
+     * virtual destructor, release the ray tracing solver if kept
      */
-    virtual ~Light_Source_RayTracing() {}
+    virtual ~Light_Source_RayTracing();
 
 
    /**
@@ -174,6 +175,22 @@ class Light_Source_RayTracing : public Light_Source
 
     const Parser::Card _card;
 
+    /**
+     * the ray tracing solver is kept when it records the ray paths,
+     * later update only recomputes free carrier absorption along the paths
+     */
+    RayTraceSolver * _solver;
+
+    /**
+     * the mesh revision the solver is built on
+     */
+    unsigned int _solver_mesh_revision;
+
+    /**
+     * destroy and delete the solver
+     */
+    void release_solver();
+
 };
 
 
@@ -24,15 +24,15 @@
 #ifndef __particle_source_h__
 #define __particle_source_h__
 
+#include <vector>
+
 #include "auto_ptr.h"
 #include "point.h"
+#include "parser.h"
 #include "interpolation_base.h"
 
-namespace Parser{
-  class InputParser;
-  class Card;
-}
 class SimulationSystem;
+class FVM_Node;
 
 /**
  * set the carrier generation of Particle
@@ -43,7 +43,7 @@ public:
   /**
    *  constructor, do nothing
    */
-  Particle_Source(SimulationSystem &system) : _system(system) {}
+  Particle_Source(SimulationSystem &system) : _system(system), _deposition_mesh_revision(invalid_uint) {}
 
   /**
    * destructor
@@ -56,15 +56,32 @@ public:
   virtual double carrier_generation(double t) const;
 
   /**
-   * assign PatG to mesh node
+   * assign PatG to mesh node. the spatial deposition is only evaluated
+   * when mesh changed, otherwise the cached deposition is reused
+   */
+  virtual void update_system();
+
+  /**
+   * add cached PatG, scaled by time profile weight, to Field_G of mesh node
    */
-  virtual void update_system()=0;
+  void apply_carrier_generation(double weight) const;
 
   /**
    * virtual function for limit the time step
    */
   virtual double limit_dt(double time, double dt) const;
 
+  /**
+   * @return the incident time or the generation peak if t is before them,
+   * so a short particle pulse is not stepped over
+   */
+  virtual double next_breakpoint(double t) const;
+
+  /**
+   * @return true if this particle source requires a serial mesh
+   */
+  virtual bool request_serial_mesh() const { return false; }
+
 protected:
 
  /**
@@ -72,6 +89,17 @@ protected:
   */
  SimulationSystem & _system;
 
+ /**
+  * evaluate the spatial deposition of this particle source,
+  * each derived class should call add_deposition for nodes it impacts
+  */
+ virtual void build_deposition()=0;
+
+ /**
+  * record PatG and PatE of on processor node to the deposition cache
+  */
+ void add_deposition(FVM_Node *fvm_node, double PatG, double PatE=0.0);
+
   /**
   * the particle incident time
   */
@@ -92,6 +120,33 @@ protected:
   * how much energy can generate electron-hole pair
   */
  double _quan_eff;
+
+private:
+
+ /**
+  * the cached spatial deposition, as flat arrays indexed by deposition entry
+  */
+ std::vector<FVM_Node *> _deposition_node;
+
+ /**
+  * PatG of each deposition entry, not weighted by time profile
+  */
+ std::vector<double>     _deposition_PatG;
+
+ /**
+  * PatE of each deposition entry
+  */
+ std::vector<double>     _deposition_PatE;
+
+ /**
+  * index of deposition entries in semiconductor region, which contribute to carrier generation
+  */
+ std::vector<unsigned int> _generation_index;
+
+ /**
+  * the mesh revision the deposition is built on
+  */
+ unsigned int _deposition_mesh_revision;
 };
 
 
@@ -113,18 +168,39 @@ public:
   ~Particle_Source_DataFile() {}
 
   /**
-   * assign PatG to mesh node
+   * Monte-Carlo solver traces the particle histories in the whole mesh
    */
-  virtual void update_system();
+  virtual bool request_serial_mesh() const { return _montecarlo; }
 
 private:
 
+  /**
+   * interpolate energy deposition to mesh node
+   */
+  virtual void build_deposition();
+
  void set_particle_profile_fromfile2d(const Parser::Card &);
 
  void set_particle_profile_fromfile3d(const Parser::Card &);
 
+ /**
+  * run Monte-Carlo solver and take its energy deposit as the profile.
+  * it is delayed to the first build_deposition since the mesh is required
+  */
+ void set_particle_profile_montecarlo();
+
  AutoPtr<InterpolationBase> interpolator;
 
+ /**
+  * the PARTICLE card
+  */
+ const Parser::Card _card;
+
+ /**
+  * energy deposition is computed by Monte-Carlo solver
+  */
+ bool _montecarlo;
+
 };
 
 
@@ -145,12 +221,12 @@ public:
    */
   ~Particle_Source_Analytic() {}
 
+private:
+
   /**
-   * assign PatG to mesh node
+   * evaluate energy deposition of the analytic track
    */
-  virtual void update_system();
-
-private:
+  virtual void build_deposition();
 
   /**
    * particle incident point
@@ -197,12 +273,12 @@ public:
    */
   ~Particle_Source_Track() {}
 
+private:
+
   /**
-   * assign PatG to mesh node
+   * evaluate energy deposition of all the tracks
    */
-  virtual void update_system();
-
-private:
+  virtual void build_deposition();
 
   int _version;
 
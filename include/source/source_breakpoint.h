@@ -0,0 +1,61 @@
+/********************************************************************************/
+/*     888888    888888888   88     888  88888   888      888    88888888       */
+/*   8       8   8           8 8     8     8      8        8    8               */
+/*  8            8           8  8    8     8      8        8    8               */
+/*  8            888888888   8   8   8     8      8        8     8888888        */
+/*  8      8888  8           8    8  8     8      8        8            8       */
+/*   8       8   8           8     8 8     8      8        8            8       */
+/*     888888    888888888  888     88   88888     88888888     88888888        */
+/*                                                                              */
+/*       A Three-Dimensional General Purpose Semiconductor Simulator.           */
+/*                                                                              */
+/*                                                                              */
+/*  Copyright (C) 2007-2008                                                     */
+/*  Cogenda Pte Ltd                                                             */
+/*                                                                              */
+/*  Please contact Cogenda Pte Ltd for license information                      */
+/*                                                                              */
+/*  Author: Gong Ding   gdiso@ustc.edu                                          */
+/*                                                                              */
+/********************************************************************************/
+
+
+#ifndef __source_breakpoint_h__
+#define __source_breakpoint_h__
+
+#include <cmath>
+#include <limits>
+
+// corners of spice style source waveforms, where the slope jumps.
+// the transient step controller lands on them instead of stepping over.
+
+/**
+ * @return a time point t1 if t is before it, else infinity
+ */
+inline double step_next_breakpoint(double t, double t1)
+{ return t<t1 ? t1 : std::numeric_limits<double>::infinity(); }
+
+/**
+ * @return the first corner of a periodic pulse later than t.
+ * the corners within one period are at 0, tr, tr+pw and tr+pw+tf after the period begins,
+ * pr<=0 means a single pulse
+ */
+inline double pulse_next_breakpoint(double t, double td, double tr, double pw, double tf, double pr)
+{
+  if(t<td) return td;
+
+  const double corner[4] = { 0.0, tr, tr+pw, tr+pw+tf };
+  double period_begin = td;
+  if(pr>0 && t-td>=pr)
+    period_begin += std::floor((t-td)/pr)*pr;
+
+  for(int k=0; k<2; ++k, period_begin+=pr)
+  {
+    for(int i=0; i<4; ++i)
+      if(period_begin+corner[i] > t && (pr<=0 || corner[i] <= pr)) return period_begin+corner[i];
+    if(pr<=0) break;
+  }
+  return std::numeric_limits<double>::infinity();
+}
+
+#endif
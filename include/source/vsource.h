@@ -34,6 +34,7 @@
 
 #include "config.h"
 #include "expr_evaluate.h"
+#include "source_breakpoint.h"
 
 #ifdef WINDOWS
   class HINSTANCE__; // Forward or never
@@ -72,6 +73,12 @@ public:
    */
   virtual double vapp(double t)=0;
 
+  /**
+   * @return next corner of the source waveform later than t, infinity if none
+   */
+  virtual double next_breakpoint(double t) const
+  { return std::numeric_limits<double>::infinity(); }
+
   /**
    * @return the max value of vapp(t+delta_t)-vapp(t), delta_t in [0, dt]
    */
@@ -139,6 +146,12 @@ public:
   { return t>=td? Vdc:0;}
 
 
+  /**
+   * @return next corner of the source waveform later than t
+   */
+  double next_breakpoint(double t) const
+  { return step_next_breakpoint(t, td); }
+
   /**
    * @return the max value of vapp(t+delta_t)-vapp(t), delta_t in [0, dt]
    */
@@ -203,6 +216,12 @@ public:
   { return t>=td ? V0+Vamp*exp(-alpha*(t-td))*sin(2*3.14159265358979323846*fre*(t-td)) : V0; }
 
 
+  /**
+   * @return next corner of the source waveform later than t
+   */
+  double next_breakpoint(double t) const
+  { return step_next_breakpoint(t, td); }
+
   /**
    * @return the max value of vapp(t+delta_t)-vapp(t), delta_t in [0, dt]
    */
@@ -319,6 +338,12 @@ public:
   }
 
 
+  /**
+   * @return next corner of the source waveform later than t
+   */
+  double next_breakpoint(double t) const
+  { return pulse_next_breakpoint(t, td, tr, pw, tf, pr); }
+
   /**
    * @return the max value of vapp(t+delta_t)-vapp(t), delta_t in [0, dt]
    */
@@ -429,6 +454,12 @@ public:
   }
 
 
+  /**
+   * @return next corner of the source waveform later than t
+   */
+  double next_breakpoint(double t) const
+  { return t<td ? td : step_next_breakpoint(t, tfd); }
+
   /**
    * @return the max value of vapp(t+delta_t)-vapp(t), delta_t in [0, dt]
    */
@@ -2,18 +2,19 @@
 #define __waveform_h_
 
 #include <string>
+#include <vector>
 #include <cmath>
+#include <limits>
 
 #include "config.h"
 #include "expr_evaluate.h"
+#include "source_breakpoint.h"
 
 #ifdef WINDOWS
 class HINSTANCE__; // Forward or never
 typedef HINSTANCE__* HINSTANCE;
 #endif
 
-class MonotCubicInterpolator;
-
 /**
  * basic class of Waveform
  */
@@ -39,6 +40,14 @@ public:
 
   virtual double waveform(double )=0;
 
+  /**
+   * @return the first time later than t where the waveform has a corner,
+   * the transient step controller should not step over it.
+   * infinity if the waveform is smooth after t
+   */
+  virtual double next_breakpoint(double t) const
+  { return std::numeric_limits<double>::infinity(); }
+
 private:
 
   /**
@@ -88,6 +97,12 @@ public:
   double waveform(double t)
 { return t>=_td? _amplitude:0.0;}
 
+  /**
+   * @return td if t is before it
+   */
+  double next_breakpoint(double t) const
+  { return step_next_breakpoint(t, _td); }
+
 };
 
 
@@ -210,7 +225,12 @@ public:
     else
     {
       t-=_td;
-      while(t>_pr) t-=_pr;
+      // fold into (0, pr] as the repeated subtraction did
+      if(_pr>0 && t>_pr)
+      {
+        t = std::fmod(t, _pr);
+        if(t==0.0) t = _pr;
+      }
       if(t<_tr)
         return _amplitude_low+t*(_amplitude_high-_amplitude_low)/_tr;
       else if(t<_tr+_pw)
@@ -221,6 +241,12 @@ public:
     }
   }
 
+  /**
+   * @return next corner of the pulse
+   */
+  double next_breakpoint(double t) const
+  { return pulse_next_breakpoint(t, _td, _tr, _pw, _tf, _pr); }
+
 };
 
 
@@ -292,6 +318,12 @@ public:
 
   }
 
+  /**
+   * @return td or tfd, where the exponential edges start
+   */
+  double next_breakpoint(double t) const
+  { return t<_td ? _td : step_next_breakpoint(t, _tfd); }
+
 };
 
 
@@ -395,6 +427,17 @@ private:
    */
   double scale_t;
 
+  /**
+   * the last two (t, value) pairs, the solver evaluates the same times again
+   * in limit_dt, line search trials and the time averaged generation
+   */
+  double _cache_t[2], _cache_v[2];
+
+  /**
+   * the cache slot to be replaced next
+   */
+  unsigned int _cache_next;
+
 public:
 
   /**
@@ -412,7 +455,13 @@ public:
    */
   double waveform(double t)
   {
-    return Waveform_Shell(t/scale_t);
+    if(t==_cache_t[0]) return _cache_v[0];
+    if(t==_cache_t[1]) return _cache_v[1];
+    double v = Waveform_Shell(t/scale_t);
+    _cache_t[_cache_next] = t;
+    _cache_v[_cache_next] = v;
+    _cache_next ^= 1;
+    return v;
   }
 
 };
@@ -425,11 +474,21 @@ class WaveformFile: public Waveform
 {
 private:
 
+  /**
+   * sorted abscissa, value and derivative of the monotone cubic spline,
+   * derivative is empty when the spline falls back to linear interpolation
+   */
   std::vector<double> _time;
 
   std::vector<double> _wave;
 
-  MonotCubicInterpolator * _int;
+  std::vector<double> _dwave;
+
+  /**
+   * the interval [_time[_hint], _time[_hint+1]] of last evaluation,
+   * time steps advance monotonically so the next search usually starts here
+   */
+  unsigned int _hint;
 
 public:
 
@@ -444,9 +503,14 @@ public:
   ~WaveformFile();
 
   /**
-   * call Waveform_Shell to get the user provide value
+   * interpolate the waveform by the monotone cubic spline of the data
    */
   double waveform(double t);
+
+  /**
+   * @return next data point after t, the spline has a corner there in general
+   */
+  double next_breakpoint(double t) const;
 };
 
 
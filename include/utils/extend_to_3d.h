@@ -145,10 +145,15 @@ private:
    */
   void sync_solution(const std::string &sol);
 
+  /**
+   * broadcast the saved 2d mesh to all the processors
+   */
+  void broadcast_old_mesh();
+
   /**
    * map renumbered node id to original node id
    */
-  std::map<unsigned int, unsigned int> _node_to_old_node_id_map;
+  std::vector<unsigned int> _node_to_old_node_id_map;
 
   /**
    * setup new 3d system
@@ -22,6 +22,21 @@
 #ifndef __mat_analysis_h__
 #define __mat_analysis_h__
 
+/**
+ * structural summary of a matrix, only valid on the first processor
+ */
+struct MatAnalysisInfo
+{
+  PetscInt     M, N;                  // global rows and columns
+  PetscInt     nnz;                   // nonzero entries
+  PetscScalar  max_entry;             // max abs value of entries
+  PetscReal    unsymmetric_rate;      // rate of entries without the transposed entry
+  PetscInt     zero_diagonal_rows;    // rows with zero or missing diagonal
+  PetscInt     weak_diagonal_rows;    // rows not diagonally dominant
+};
+
+void mat_analysis(const Mat mat, MatAnalysisInfo &info);
+
 void mat_analysis(const Mat mat);
 
 void mat_to_image(const Mat mat, const std::string &image_file);
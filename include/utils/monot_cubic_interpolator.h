@@ -218,6 +218,16 @@ public:
   */
   std::vector<double> get_fVector() const ;
 
+  /**
+     Provide a copy of the derivative data of the Hermite spline as a vector
+
+     Same order as get_xVector. Empty if derivatives are not available,
+     in which case evaluate() interpolates linearly.
+
+     @return derivative values as a vector
+  */
+  std::vector<double> get_dVector() const ;
+
   /**
      @param factor Scaling constant
 
@@ -71,6 +71,19 @@ public:
    */
   void nearest_nodes(const Point &p1, const Point &p2, Real radius, unsigned int subdomain, std::set<const Node * >& nns) const;
 
+  /**
+   * batched version of nearest_node(), the points are sorted along space filling curve
+   * and searched in parallel. the kdtree is not modified by query, so it is thread safe
+   */
+  void nearest_node(const std::vector<Point> &points, unsigned int subdomain,
+                    std::vector<const Node *> &nodes, std::vector<Real> &dists) const;
+
+  /**
+   * batched version of nearest_nodes() inside given radius
+   */
+  void nearest_nodes(const std::vector<Point> &points, Real radius, unsigned int subdomain,
+                     std::vector< std::vector<const Node *> > &nns) const;
+
 private:
 
   const MeshBase& _mesh;
@@ -0,0 +1,108 @@
+/********************************************************************************/
+/*     888888    888888888   88     888  88888   888      888    88888888       */
+/*   8       8   8           8 8     8     8      8        8    8               */
+/*  8            8           8  8    8     8      8        8    8               */
+/*  8            888888888   8   8   8     8      8        8     8888888        */
+/*  8      8888  8           8    8  8     8      8        8            8       */
+/*   8       8   8           8     8 8     8      8        8            8       */
+/*     888888    888888888  888     88   88888     88888888     88888888        */
+/*                                                                              */
+/*       A Three-Dimensional General Purpose Semiconductor Simulator.           */
+/*                                                                              */
+/*                                                                              */
+/*  Copyright (C) 2007-2008                                                     */
+/*  Cogenda Pte Ltd                                                             */
+/*                                                                              */
+/*  Please contact Cogenda Pte Ltd for license information                      */
+/*                                                                              */
+/*  Author: Gong Ding   gdiso@ustc.edu                                          */
+/*                                                                              */
+/********************************************************************************/
+
+
+#ifndef __object_pool_h__
+#define __object_pool_h__
+
+// C++ includes
+#include <cstddef>
+
+
+/**
+ * Pool of small fixed size blocks for the mesh objects (Elem, Node and their
+ * pointer arrays). Each size class hands out blocks from large chunks in
+ * allocation order, so objects built one after another are contiguous in memory.
+ * Freed blocks are recycled by a free list of their size class, and the chunks
+ * of a size class are released in bulk when it has no live block.
+ *
+ * Blocks larger than max_block_size go to the global operator new.
+ * The pool is not thread safe, mesh objects are only built by the main thread.
+ */
+class ObjectPool
+{
+public:
+
+  /**
+   * @return a block of at least \p size bytes
+   */
+  static void * allocate(std::size_t size);
+
+  /**
+   * return the block \p p of \p size bytes to the pool, \p size must be the
+   * value given to allocate()
+   */
+  static void deallocate(void * p, std::size_t size);
+
+  /**
+   * free the chunks of the size classes without live block.
+   * called after the mesh is cleared.
+   */
+  static void release();
+
+  /**
+   * @return the number of live blocks
+   */
+  static std::size_t n_alive();
+
+  /**
+   * @return the bytes held in chunks
+   */
+  static std::size_t memory();
+
+  /**
+   * block size is rounded up to the alignment
+   */
+  static const std::size_t alignment = 16;
+
+  /**
+   * larger blocks are not pooled
+   */
+  static const std::size_t max_block_size = 1024;
+
+private:
+
+  /**
+   * plain data, so it is zero initialized before any static constructor
+   * may build a mesh object
+   */
+  struct SizeClass
+  {
+    /// singly linked list of the freed blocks
+    void * free_list;
+
+    /// unused part of the last chunk
+    char * cur;
+    char * end;
+
+    /// singly linked list of the chunks, the link is in the chunk header
+    char * chunks;
+    std::size_t n_chunks;
+
+    /// live blocks
+    std::size_t alive;
+  };
+
+  static SizeClass _size_class[max_block_size/alignment];
+};
+
+
+#endif
@@ -240,6 +240,23 @@ namespace Parallel
   template <typename T>
   inline void sum(std::vector<T> &r);
 
+  //-------------------------------------------------------------------
+  /**
+   * Nonblocking version of sum(std::vector<T> &r), r is valid after wait(req)
+   * and should not be accessed before. Blocking if MPI-3 is not available.
+   */
+  template <typename T>
+  inline void isum(std::vector<T> &r, request &req);
+
+  //-------------------------------------------------------------------
+  /**
+   * Hierarchical version of sum(std::vector<T> &r) for long vectors: reduce on each
+   * shared memory node, allreduce among the node leaders and broadcast on node.
+   * the same as sum() if Genius::comm_node() is not available.
+   */
+  template <typename T>
+  inline void sum_node_aware(std::vector<T> &r);
+
   //-------------------------------------------------------------------
   /**
    * Blocking-send vector to one processor.
@@ -311,6 +328,14 @@ namespace Parallel
    */
   inline void wait (std::vector<request> &r);
 
+  //-------------------------------------------------------------------
+  /**
+   * Nonblocking test for a message with tag from one processor.
+   * @return true if the message can be received
+   */
+  inline bool iprobe (const int src_processor_id,
+                      const int tag=any_tag);
+
   //-------------------------------------------------------------------
   /**
    * Send vector send to one processor while simultaneously receiving
@@ -815,6 +840,8 @@ namespace Parallel
   {
     if (Genius::n_processors() > 1)
     {
+      START_LOG("sum()", "Parallel");
+
       T temp = r;
       MPI_Allreduce (&temp,
                      &r,
@@ -822,6 +849,8 @@ namespace Parallel
                      datatype<T>(),
                      MPI_SUM,
                      Genius::comm_world());
+
+      STOP_LOG("sum()", "Parallel");
     }
   }
 
@@ -831,6 +860,8 @@ namespace Parallel
   {
     if (Genius::n_processors() > 1 && !r.empty())
     {
+      START_LOG("sum()", "Parallel");
+
       std::vector<T> temp(r);
       MPI_Allreduce (&temp[0],
                      &r[0],
@@ -838,10 +869,75 @@ namespace Parallel
                      datatype<T>(),
                      MPI_SUM,
                      Genius::comm_world());
+
+      STOP_LOG("sum()", "Parallel");
     }
   }
 
 
+  template <typename T>
+  inline void isum(std::vector<T> &r, request &req)
+  {
+    req = MPI_REQUEST_NULL;
+    if (Genius::n_processors() > 1 && !r.empty())
+    {
+#if MPI_VERSION >= 3
+      START_LOG("isum()", "Parallel");
+
+      MPI_Iallreduce (MPI_IN_PLACE,
+                      &r[0],
+                      r.size(),
+                      datatype<T>(),
+                      MPI_SUM,
+                      Genius::comm_world(),
+                      &req);
+
+      STOP_LOG("isum()", "Parallel");
+#else
+      sum(r);
+#endif
+    }
+  }
+
+
+  template <typename T>
+  inline void sum_node_aware(std::vector<T> &r)
+  {
+#if MPI_VERSION >= 3
+    if (Genius::comm_node() != MPI_COMM_NULL && !r.empty())
+    {
+      START_LOG("sum_node_aware()", "Parallel");
+
+      int node_rank;
+      MPI_Comm_rank (Genius::comm_node(), &node_rank);
+
+      std::vector<T> temp(r.size());
+      MPI_Reduce (&r[0],
+                  &temp[0],
+                  r.size(),
+                  datatype<T>(),
+                  MPI_SUM,
+                  0,
+                  Genius::comm_node());
+
+      if (node_rank == 0)
+        MPI_Allreduce (&temp[0],
+                       &r[0],
+                       r.size(),
+                       datatype<T>(),
+                       MPI_SUM,
+                       Genius::comm_node_leaders());
+
+      MPI_Bcast (&r[0], r.size(), datatype<T>(), 0, Genius::comm_node());
+
+      STOP_LOG("sum_node_aware()", "Parallel");
+      return;
+    }
+#endif
+    sum(r);
+  }
+
+
   template <typename T>
   inline void sum(std::complex<T> &r)
   {
@@ -1130,6 +1226,16 @@ namespace Parallel
 
 
 
+  inline bool iprobe (const int src_processor_id,
+                      const int tag)
+  {
+    int flag = 0;
+    MPI_Iprobe (src_processor_id, tag, Genius::comm_world(), &flag, MPI_STATUS_IGNORE);
+    return flag != 0;
+  }
+
+
+
   template <typename T>
   inline void send_receive(const unsigned int dest_processor_id,
                            T &send,
@@ -2411,11 +2517,17 @@ namespace Parallel
   template <typename T>
   inline void sum(std::vector<T> &) {}
 
+  template <typename T>
+  inline void isum(std::vector<T> &, request &) {}
+
+  template <typename T>
+  inline void sum_node_aware(std::vector<T> &) {}
+
   // Blocking sends don't make sense on one processor
   template <typename T>
   inline void send (const unsigned int,
                     std::vector<T> &,
-                    const unsigned int) { genius_error(); }
+                    const int) { genius_error(); }
 
   template <typename T>
   inline void isend (const unsigned int,
@@ -2439,6 +2551,8 @@ namespace Parallel
 
   inline void wait (std::vector<request> &) {}
 
+  inline bool iprobe (const int, const int) { return false; }
+
   template <typename T>
   inline void send_receive(const unsigned int send_tgt,
                            T &send,
@@ -2505,6 +2619,72 @@ namespace Parallel
 
 #endif // HAVE_MPI
 
+
+
+  //-------------------------------------------------------------------
+  /**
+   * Sum of many scalars over all the processors by a single reduction.
+   * the scalars are registered by add() and overwritten by their sums in reduce(),
+   * or in finish() when the reduction is started by start() and overlapped with local work.
+   * the registered scalars should not be accessed between start() and finish().
+   */
+  template <typename T>
+  class SumBatch
+  {
+  public:
+    SumBatch() {}
+
+    /**
+     * register a scalar
+     */
+    void add(T &r)
+    { _ref.push_back(&r); }
+
+    unsigned int size() const
+    { return _ref.size(); }
+
+    void clear()
+    { _ref.clear(); }
+
+    /**
+     * blocking reduction
+     */
+    void reduce()
+    {
+      start();
+      finish();
+    }
+
+    /**
+     * start the reduction
+     */
+    void start()
+    {
+      _buffer.resize(_ref.size());
+      for(unsigned int n=0; n<_ref.size(); ++n)
+        _buffer[n] = *_ref[n];
+      isum(_buffer, _request);
+    }
+
+    /**
+     * wait for the reduction and write the sums back
+     */
+    void finish()
+    {
+      wait(_request);
+      for(unsigned int n=0; n<_ref.size(); ++n)
+        *_ref[n] = _buffer[n];
+    }
+
+  private:
+
+    std::vector<T *> _ref;
+
+    std::vector<T>   _buffer;
+
+    request          _request;
+  };
+
 }
 
 #endif // #define __parallel_h__
@@ -101,6 +101,14 @@ public:
    */
   virtual const Elem* operator() (const Point& p) const = 0;
 
+  /**
+   * Locates the elements of a batch of points, fill the result into \p elems.
+   * Derived class can override it for faster (parallel) evaluation.
+   * The default implementation calls \p operator() for each point.
+   */
+  virtual void locate_points (const std::vector<Point>& points,
+                              std::vector<const Elem*>& elems) const;
+
   /**
    * @returns \p true when this object is properly initialized
    * and ready for use, \p false otherwise.
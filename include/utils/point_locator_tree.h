@@ -115,6 +115,16 @@ public:
    */
   virtual const Elem* operator() (const Point& p) const;
 
+  /**
+   * Locates the elements of a batch of points.  The points are
+   * sorted along a space filling curve and located in parallel,
+   * each thread uses its last found element as the start guess.
+   * This function does not touch the cached \p _element, thus
+   * it is safe to be called concurrently.
+   */
+  virtual void locate_points (const std::vector<Point>& points,
+                              std::vector<const Elem*>& elems) const;
+
   /**
    * Enables out-of-mesh mode.  In this mode, if asked to find a point
    * that is contained in no mesh at all, the point locator will
@@ -132,6 +142,12 @@ public:
 
 protected:
 
+  /**
+   * Locates point p, check the \p hint element first before asking the tree.
+   * It does not modify this object.
+   */
+  const Elem* locate (const Point& p, const Elem* hint) const;
+
   /**
    * Pointer to our tree.  The tree is built at run-time
    * through \p init().  For servant PointLocators (not master),
@@ -0,0 +1,65 @@
+/********************************************************************************/
+/*     888888    888888888   88     888  88888   888      888    88888888       */
+/*   8       8   8           8 8     8     8      8        8    8               */
+/*  8            8           8  8    8     8      8        8    8               */
+/*  8            888888888   8   8   8     8      8        8     8888888        */
+/*  8      8888  8           8    8  8     8      8        8            8       */
+/*   8       8   8           8     8 8     8      8        8            8       */
+/*     888888    888888888  888     88   88888     88888888     88888888        */
+/*                                                                              */
+/*       A Three-Dimensional General Purpose Semiconductor Simulator.           */
+/*                                                                              */
+/*                                                                              */
+/*  Copyright (C) 2007-2008                                                     */
+/*  Cogenda Pte Ltd                                                             */
+/*                                                                              */
+/*  Please contact Cogenda Pte Ltd for license information                      */
+/*                                                                              */
+/*  Author: Gong Ding   gdiso@ustc.edu                                          */
+/*                                                                              */
+/********************************************************************************/
+
+
+#ifndef __random_stream_h__
+#define __random_stream_h__
+
+// C++ includes
+#include <cmath>
+
+
+/**
+ * splitmix64 random stream. a stream seeded by the id of a mesh object gives
+ * the same sequence on all the processors, the result does not depend on partition.
+ */
+class RandomStream
+{
+public:
+  RandomStream(unsigned long long seed) : _state(seed) {}
+
+  /**
+   * uniform in (0, 1)
+   */
+  double uniform()
+  {
+    unsigned long long z = (_state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    z = z ^ (z >> 31);
+    return ((z >> 11) + 0.5) * (1.0/9007199254740992.0);
+  }
+
+  /**
+   * standard normal by Box-Muller
+   */
+  double normal()
+  {
+    const double u1 = uniform();
+    const double u2 = uniform();
+    return std::sqrt(-2.0*std::log(u1))*std::cos(2*3.14159265358979323846*u2);
+  }
+
+private:
+  unsigned long long _state;
+};
+
+#endif // #define __random_stream_h__
@@ -0,0 +1,201 @@
+/********************************************************************************/
+/*     888888    888888888   88     888  88888   888      888    88888888       */
+/*   8       8   8           8 8     8     8      8        8    8               */
+/*  8            8           8  8    8     8      8        8    8               */
+/*  8            888888888   8   8   8     8      8        8     8888888        */
+/*  8      8888  8           8    8  8     8      8        8            8       */
+/*   8       8   8           8     8 8     8      8        8            8       */
+/*     888888    888888888  888     88   88888     88888888     88888888        */
+/*                                                                              */
+/*       A Three-Dimensional General Purpose Semiconductor Simulator.           */
+/*                                                                              */
+/*                                                                              */
+/*  Copyright (C) 2007-2008                                                     */
+/*  Cogenda Pte Ltd                                                             */
+/*                                                                              */
+/*  Please contact Cogenda Pte Ltd for license information                      */
+/*                                                                              */
+/*  Author: Gong Ding   gdiso@ustc.edu                                          */
+/*                                                                              */
+/********************************************************************************/
+
+#ifndef __shared_array_h__
+#define __shared_array_h__
+
+#include <vector>
+#include <algorithm>
+#include <climits>
+
+#include "genius_common.h"
+#include "genius_env.h"
+#include "parallel.h"
+
+/**
+ * read only array which all the processors need, i.e. the packed mesh.
+ * the array is kept once per shared memory node in a MPI-3 shared memory window.
+ * it is filled by one processor, exchanged between the first processors of the nodes
+ * and the other processors of the node hold a view of it.
+ * without MPI-3 every processor keeps its own copy.
+ * T should be a plain data type.
+ */
+template <typename T>
+class SharedArray
+{
+public:
+
+  /**
+   * broadcast \p src of processor \p root_id, collective on all the processors.
+   * \p src is only read on processor \p root_id
+   */
+  SharedArray(const std::vector<T> &src, unsigned int root_id=0);
+
+  /**
+   * free the array, collective on all the processors
+   */
+  ~SharedArray();
+
+  /**
+   * @return the number of items
+   */
+  size_t size() const
+  { return _size; }
+
+  bool empty() const
+  { return _size == 0; }
+
+  /**
+   * @return the items, read only
+   */
+  const T * data() const
+  { return _data; }
+
+  const T & operator [] (size_t i) const
+  { return _data[i]; }
+
+  const T * begin() const
+  { return _data; }
+
+  const T * end() const
+  { return _data + _size; }
+
+private:
+
+  const T *    _data;
+
+  size_t       _size;
+
+  /**
+   * the items when they are not in shared memory
+   */
+  std::vector<T> _buffer;
+
+#ifdef HAVE_MPI
+  /**
+   * the shared memory window and its node communicator, MPI_COMM_NULL when not used
+   */
+  MPI_Comm     _comm_node;
+  MPI_Win      _win;
+#endif
+
+  // no copy
+  SharedArray(const SharedArray &);
+  SharedArray & operator= (const SharedArray &);
+};
+
+
+
+template <typename T>
+inline SharedArray<T>::SharedArray(const std::vector<T> &src, unsigned int root_id)
+  : _data(0), _size(0)
+{
+#ifdef HAVE_MPI
+  _comm_node = MPI_COMM_NULL;
+
+#if MPI_VERSION >= 3
+  if( Genius::n_processors() > 1 )
+  {
+    unsigned long long n = src.size();
+    MPI_Bcast(&n, 1, MPI_UNSIGNED_LONG_LONG, root_id, Genius::comm_world());
+    _size = static_cast<size_t>(n);
+
+    MPI_Comm_split_type(Genius::comm_world(), MPI_COMM_TYPE_SHARED, Genius::processor_id(), MPI_INFO_NULL, &_comm_node);
+    int node_rank;
+    MPI_Comm_rank(_comm_node, &node_rank);
+
+    // the first processor of the node owns the memory
+    T * base;
+    MPI_Win_allocate_shared(node_rank == 0 ? _size*sizeof(T) : 0, sizeof(T), MPI_INFO_NULL, _comm_node, &base, &_win);
+    MPI_Aint win_size;
+    int disp_unit;
+    MPI_Win_shared_query(_win, 0, &win_size, &disp_unit, &base);
+    _data = base;
+
+    // the root writes the items into the window of its node
+    MPI_Win_fence(0, _win);
+    if( Genius::processor_id() == root_id && _size )
+      std::copy(src.begin(), src.end(), base);
+    MPI_Win_fence(0, _win);
+
+    // the first processors of the nodes exchange the items
+    int has_root = (Genius::processor_id() == root_id);
+    MPI_Allreduce(MPI_IN_PLACE, &has_root, 1, MPI_INT, MPI_MAX, _comm_node);
+
+    MPI_Comm comm_leaders;
+    MPI_Comm_split(Genius::comm_world(), node_rank == 0 ? 0 : MPI_UNDEFINED, Genius::processor_id(), &comm_leaders);
+    if( comm_leaders != MPI_COMM_NULL )
+    {
+      int leader_rank, n_leaders;
+      MPI_Comm_rank(comm_leaders, &leader_rank);
+      MPI_Comm_size(comm_leaders, &n_leaders);
+      int root_leader = has_root ? leader_rank : -1;
+      MPI_Allreduce(MPI_IN_PLACE, &root_leader, 1, MPI_INT, MPI_MAX, comm_leaders);
+
+      if( n_leaders > 1 )
+      {
+        // the counts of MPI calls are int
+        char * buf = reinterpret_cast<char *>(base);
+        const size_t bytes = _size*sizeof(T);
+        const size_t chunk = INT_MAX/2;
+        for(size_t offset=0; offset<bytes; offset+=chunk)
+          MPI_Bcast(buf + offset, static_cast<int>(std::min(chunk, bytes-offset)), MPI_BYTE, root_leader, comm_leaders);
+      }
+      MPI_Comm_free(&comm_leaders);
+    }
+
+    // the items written by the first processor are visible to the node after the fence
+    MPI_Win_fence(0, _win);
+    return;
+  }
+#endif
+
+  if( Genius::processor_id() == root_id )
+    _buffer = src;
+  Parallel::broadcast(_buffer, root_id);
+  _size = _buffer.size();
+  _data = _buffer.empty() ? 0 : &_buffer[0];
+
+#else
+
+  _buffer = src;
+  _size = _buffer.size();
+  _data = _buffer.empty() ? 0 : &_buffer[0];
+
+#endif
+}
+
+
+template <typename T>
+inline SharedArray<T>::~SharedArray()
+{
+#ifdef HAVE_MPI
+#if MPI_VERSION >= 3
+  if( _comm_node != MPI_COMM_NULL )
+  {
+    MPI_Win_free(&_win);
+    MPI_Comm_free(&_comm_node);
+  }
+#endif
+#endif
+}
+
+#endif
@@ -0,0 +1,97 @@
+/********************************************************************************/
+/*     888888    888888888   88     888  88888   888      888    88888888       */
+/*   8       8   8           8 8     8     8      8        8    8               */
+/*  8            8           8  8    8     8      8        8    8               */
+/*  8            888888888   8   8   8     8      8        8     8888888        */
+/*  8      8888  8           8    8  8     8      8        8            8       */
+/*   8       8   8           8     8 8     8      8        8            8       */
+/*     888888    888888888  888     88   88888     88888888     88888888        */
+/*                                                                              */
+/*       A Three-Dimensional General Purpose Semiconductor Simulator.           */
+/*                                                                              */
+/*                                                                              */
+/*  Copyright (C) 2007-2008                                                     */
+/*  Cogenda Pte Ltd                                                             */
+/*                                                                              */
+/*  Please contact Cogenda Pte Ltd for license information                      */
+/*                                                                              */
+/*  Author: Gong Ding   gdiso@ustc.edu                                          */
+/*                                                                              */
+/********************************************************************************/
+
+#ifndef __space_filling_curve_h__
+#define __space_filling_curve_h__
+
+#include <vector>
+#include <algorithm>
+
+#include "point.h"
+
+/**
+ * order points along Morton (Z-order) space filling curve.
+ * batched geometry queries processed in this order visit the
+ * spatial tree in a cache friendly way, and neighbor queries of
+ * the same thread are likely to hit the same element.
+ */
+namespace SpaceFillingCurve
+{
+
+  /**
+   * spread the lower 21 bits of x so that there are two zero bits between each bit
+   */
+  inline unsigned long long spread_bits(unsigned long long x)
+  {
+    x &= 0x1fffffULL;
+    x = (x | x << 32) & 0x1f00000000ffffULL;
+    x = (x | x << 16) & 0x1f0000ff0000ffULL;
+    x = (x | x << 8)  & 0x100f00f00f00f00fULL;
+    x = (x | x << 4)  & 0x10c30c30c30c30c3ULL;
+    x = (x | x << 2)  & 0x1249249249249249ULL;
+    return x;
+  }
+
+  /**
+   * @return the 63 bit Morton key of point p inside bounding box [lo, hi]
+   */
+  inline unsigned long long morton_key(const Point &p, const Point &lo, const Point &hi)
+  {
+    unsigned long long key = 0;
+    for(unsigned int d=0; d<3; ++d)
+    {
+      const Real range = hi(d) - lo(d);
+      Real t = range > 0.0 ? (p(d) - lo(d))/range : 0.0;
+      t = std::max(0.0, std::min(1.0, t));
+      const unsigned long long c = static_cast<unsigned long long>(t*2097151.0);
+      key |= spread_bits(c) << d;
+    }
+    return key;
+  }
+
+  /**
+   * fill \p order with the index of \p points, sorted by Morton key
+   */
+  inline void morton_order(const std::vector<Point> &points, std::vector<unsigned int> &order)
+  {
+    order.resize(points.size());
+    if( points.empty() ) return;
+
+    Point lo = points[0], hi = points[0];
+    for(unsigned int i=1; i<points.size(); ++i)
+      for(unsigned int d=0; d<3; ++d)
+      {
+        lo(d) = std::min(lo(d), points[i](d));
+        hi(d) = std::max(hi(d), points[i](d));
+      }
+
+    std::vector<std::pair<unsigned long long, unsigned int> > keys(points.size());
+    for(unsigned int i=0; i<points.size(); ++i)
+      keys[i] = std::make_pair(morton_key(points[i], lo, hi), i);
+    std::sort(keys.begin(), keys.end());
+
+    for(unsigned int i=0; i<keys.size(); ++i)
+      order[i] = keys[i].second;
+  }
+
+}
+
+#endif
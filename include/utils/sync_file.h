@@ -24,11 +24,86 @@
 #ifndef __sync_file_h__
 #define __sync_file_h__
 
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "genius_env.h"
+
 /**
- * transport text file to other processor,
- * return local name as filename.processor_id 
+ * read only content of a file which all the processors need.
+ * the first processor of each shared memory node reads part of the file by collective
+ * MPI-IO and the parts are exchanged between these processors. the content is kept
+ * once per node in a MPI-3 shared memory window, the other processors of the node
+ * read it there. no local copy of the file is written.
  */
-extern const std::string sync_file(const char * filename);
+class SharedFile
+{
+public:
+
+  /**
+   * read the file, collective on all the processors
+   */
+  SharedFile(const std::string & filename);
+
+  /**
+   * free the content, collective on all the processors
+   */
+  ~SharedFile();
+
+  /**
+   * @return false when the file can not be read
+   */
+  bool good() const
+  { return _good; }
+
+  /**
+   * @return the content, not null terminated
+   */
+  const char * data() const
+  { return _data; }
+
+  /**
+   * @return the size of content
+   */
+  size_t size() const
+  { return _size; }
+
+  /**
+   * @return a stdio stream over the content for the readers which take FILE *,
+   * should be closed by fclose
+   */
+  FILE * open() const;
+
+private:
 
+  bool         _good;
+
+  const char * _data;
+
+  size_t       _size;
+
+  /**
+   * the content when it is not in shared memory
+   */
+  std::vector<char> _buffer;
+
+#ifdef HAVE_MPI
+  /**
+   * the shared memory window and its node communicator, MPI_COMM_NULL when not used
+   */
+  MPI_Comm     _comm_node;
+  MPI_Win      _win;
 #endif
+};
+
 
+/**
+ * transport text file to other processor,
+ * return local name as filename.processor_id.
+ * when \p processor is given, only that processor writes the local copy,
+ * the others return an empty name
+ */
+extern const std::string sync_file(const char * filename, int processor=-1);
+
+#endif
@@ -120,6 +120,17 @@ private:
    */
   std::vector<const Elem *> surface_elems;
 
+  /**
+   * flat image of the tree, used by find_element().
+   * it is read-only after construction, thus concurrent queries are safe
+   */
+  std::vector<Trees::FlatTreeNode> flat_nodes;
+
+  /**
+   * elements of all the leaves of flat tree
+   */
+  std::vector<const Elem *> flat_elems;
+
 };
 
 
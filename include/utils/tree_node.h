@@ -35,6 +35,52 @@ class MeshBase;
 class Node;
 class Elem;
 
+namespace Trees
+{
+  /**
+   * read-only, pointer free image of a TreeNode. the tree nodes are stored
+   * in breadth-first order in a single array, children of a node are adjacent,
+   * and the elements of all the leaves are stored in another single array.
+   */
+  struct FlatTreeNode
+  {
+    /**
+     * the Cartesian bounding box of the tree node
+     */
+    Point bbox_min, bbox_max;
+
+    /**
+     * index of first child in flat array, invalid_uint for leaf
+     */
+    unsigned int first_child;
+
+    /**
+     * number of children
+     */
+    unsigned int n_children;
+
+    /**
+     * elements of leaf are in range [elem_begin, elem_end) of flat element array
+     */
+    unsigned int elem_begin, elem_end;
+
+    /**
+     * Does this node contain any infinite elements.
+     */
+    bool contains_ifems;
+
+    /**
+     * @returns true if the bounding box contains point p
+     */
+    bool bounds_point (const Point &p) const
+    {
+      return p(0) >= bbox_min(0) && p(1) >= bbox_min(1) && p(2) >= bbox_min(2) &&
+             p(0) <= bbox_max(0) && p(1) <= bbox_max(1) && p(2) <= bbox_max(2);
+    }
+  };
+}
+
+
 /**
  * This class defines a node on a tree.  A tree node
  * contains a pointer to its parent (NULL if the node is
@@ -166,6 +212,13 @@ public:
    */
   const Elem* find_element (const Point& p) const;
 
+  /**
+   * build the flat image of this node and all the children,
+   * should be called on the root node
+   */
+  void flatten (std::vector<Trees::FlatTreeNode> & flat_nodes,
+                std::vector<const Elem*> & flat_elems) const;
+
   /**
    * @return true if the ray hit the bounding_box
    */
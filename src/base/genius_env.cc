@@ -26,6 +26,7 @@
 #include <ios>
 #include <fstream>
 #include <string>
+#include <algorithm>
 
 #ifdef HAVE_SLEPC
   #include "slepcsys.h"
@@ -39,8 +40,15 @@ int  Genius::GeniusPrivateData::_processor_id = 0;
 #ifdef HAVE_MPI
 MPI_Comm Genius::GeniusPrivateData::_comm_world;
 MPI_Comm Genius::GeniusPrivateData::_comm_self;
+MPI_Comm Genius::GeniusPrivateData::_comm_farm;
+MPI_Comm Genius::GeniusPrivateData::_comm_node = MPI_COMM_NULL;
+MPI_Comm Genius::GeniusPrivateData::_comm_node_leaders = MPI_COMM_NULL;
+bool     Genius::GeniusPrivateData::_own_mpi = false;
 #endif
 
+int  Genius::GeniusPrivateData::_n_sweep_groups = 1;
+int  Genius::GeniusPrivateData::_sweep_group = 0;
+
 std::string Genius::GeniusPrivateData::_input_file;
 std::string Genius::GeniusPrivateData::_genius_dir;
 
@@ -48,6 +56,35 @@ bool Genius::GeniusPrivateData::_experiment_code=true;
 
 bool Genius::init_processors(int *argc, char *** args)
 {
+#ifdef HAVE_MPI
+  // sweep farm: split MPI world into independent groups before PETSC init,
+  // PETSC_COMM_WORLD of each group is its sub-communicator
+  for(int i=1; i<*argc-1; ++i)
+    if( std::string((*args)[i]) == "-sweep_groups" )
+      GeniusPrivateData::_n_sweep_groups = std::max(1, atoi((*args)[i+1]));
+
+  if( GeniusPrivateData::_n_sweep_groups > 1 )
+  {
+    int initialized;
+    MPI_Initialized(&initialized);
+    if( !initialized )
+    {
+      MPI_Init(argc, args);
+      GeniusPrivateData::_own_mpi = true;
+    }
+
+    int world_size, world_rank;
+    MPI_Comm_size (MPI_COMM_WORLD, &world_size);
+    MPI_Comm_rank (MPI_COMM_WORLD, &world_rank);
+
+    // contiguous ranks form a group
+    GeniusPrivateData::_n_sweep_groups = std::min(GeniusPrivateData::_n_sweep_groups, world_size);
+    GeniusPrivateData::_sweep_group = world_rank*GeniusPrivateData::_n_sweep_groups/world_size;
+
+    MPI_Comm_split(MPI_COMM_WORLD, GeniusPrivateData::_sweep_group, world_rank, &PETSC_COMM_WORLD);
+  }
+#endif
+
   // GENIUS is built on top of PETSC, we should init PETSC first
 #ifdef HAVE_SLEPC
   // if we have slepc, call  SlepcInitialize instead of PetscInitialize
@@ -64,6 +101,35 @@ bool Genius::init_processors(int *argc, char *** args)
   // duplicate an other MPI_Comm for Genius parallel communication
   MPI_Comm_dup( PETSC_COMM_WORLD, &Genius::GeniusPrivateData::_comm_world );
   MPI_Comm_dup( PETSC_COMM_SELF, &Genius::GeniusPrivateData::_comm_self );
+
+  if( GeniusPrivateData::_n_sweep_groups > 1 )
+    MPI_Comm_dup( MPI_COMM_WORLD, &Genius::GeniusPrivateData::_comm_farm );
+  else
+    MPI_Comm_dup( PETSC_COMM_WORLD, &Genius::GeniusPrivateData::_comm_farm );
+
+#if MPI_VERSION >= 3
+  // shared memory nodes for hierarchical collectives, only useful with more than one
+  // node and more than one processor on each node
+  {
+    MPI_Comm node;
+    MPI_Comm_split_type( GeniusPrivateData::_comm_world, MPI_COMM_TYPE_SHARED, GeniusPrivateData::_processor_id, MPI_INFO_NULL, &node );
+    int node_size, node_rank;
+    MPI_Comm_size( node, &node_size );
+    MPI_Comm_rank( node, &node_rank );
+
+    int max_node_size = node_size;
+    MPI_Allreduce( &node_size, &max_node_size, 1, MPI_INT, MPI_MAX, GeniusPrivateData::_comm_world );
+
+    if( max_node_size > 1 && max_node_size < GeniusPrivateData::_n_processors )
+    {
+      GeniusPrivateData::_comm_node = node;
+      MPI_Comm_split( GeniusPrivateData::_comm_world, node_rank == 0 ? 0 : MPI_UNDEFINED,
+                      GeniusPrivateData::_processor_id, &GeniusPrivateData::_comm_node_leaders );
+    }
+    else
+      MPI_Comm_free( &node );
+  }
+#endif
 #endif
 
   return true;
@@ -75,6 +141,11 @@ bool Genius::clean_processors()
 #ifdef HAVE_MPI
   MPI_Comm_free(&Genius::GeniusPrivateData::_comm_world);
   MPI_Comm_free(&Genius::GeniusPrivateData::_comm_self);
+  MPI_Comm_free(&Genius::GeniusPrivateData::_comm_farm);
+  if( Genius::GeniusPrivateData::_comm_node != MPI_COMM_NULL )
+    MPI_Comm_free(&Genius::GeniusPrivateData::_comm_node);
+  if( Genius::GeniusPrivateData::_comm_node_leaders != MPI_COMM_NULL )
+    MPI_Comm_free(&Genius::GeniusPrivateData::_comm_node_leaders);
 #endif
 
   // end PETSC
@@ -84,6 +155,12 @@ bool Genius::clean_processors()
   PetscFinalize();
 #endif
 
+#ifdef HAVE_MPI
+  // PETSC does not finalize MPI it did not initialize
+  if( GeniusPrivateData::_own_mpi )
+    MPI_Finalize();
+#endif
+
 
   return true;
 }
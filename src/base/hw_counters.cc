@@ -0,0 +1,144 @@
+/********************************************************************************/
+/*     888888    888888888   88     888  88888   888      888    88888888       */
+/*   8       8   8           8 8     8     8      8        8    8               */
+/*  8            8           8  8    8     8      8        8    8               */
+/*  8            888888888   8   8   8     8      8        8     8888888        */
+/*  8      8888  8           8    8  8     8      8        8            8       */
+/*   8       8   8           8     8 8     8      8        8            8       */
+/*     888888    888888888  888     88   88888     88888888     88888888        */
+/*                                                                              */
+/*       A Three-Dimensional General Purpose Semiconductor Simulator.           */
+/*                                                                              */
+/*                                                                              */
+/*  Copyright (C) 2007-2008                                                     */
+/*  Cogenda Pte Ltd                                                             */
+/*                                                                              */
+/*  Please contact Cogenda Pte Ltd for license information                      */
+/*                                                                              */
+/*  Author: Gong Ding   gdiso@ustc.edu                                          */
+/*                                                                              */
+/********************************************************************************/
+
+#include <cstring>
+
+#include "hw_counters.h"
+
+#if defined(LINUX) && defined(HAVE_LINUX_PERF_EVENT_H)
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#include <cerrno>
+#endif
+
+
+HWCounters::HWCounters()
+{
+  for (unsigned int c=0; c<N_COUNTERS; ++c)
+    _fd[c] = -1;
+}
+
+
+HWCounters::~HWCounters()
+{
+  close();
+}
+
+
+const char * HWCounters::name(unsigned int c)
+{
+  static const char * names[N_COUNTERS] = { "cycles", "instructions", "L1D misses", "LLC misses" };
+  return c < N_COUNTERS ? names[c] : "";
+}
+
+
+#if defined(LINUX) && defined(HAVE_LINUX_PERF_EVENT_H)
+
+bool HWCounters::open(std::string &message)
+{
+  if (is_open()) return true;
+
+  const unsigned int l1d_read_miss = PERF_COUNT_HW_CACHE_L1D |
+                                     (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                                     (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+
+  const unsigned int types[N_COUNTERS]  = { PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE, PERF_TYPE_HW_CACHE, PERF_TYPE_HARDWARE };
+  const unsigned long long configs[N_COUNTERS] = { PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+                                                   l1d_read_miss, PERF_COUNT_HW_CACHE_MISSES };
+
+  for (unsigned int c=0; c<N_COUNTERS; ++c)
+  {
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size           = sizeof(attr);
+    attr.type           = types[c];
+    attr.config         = configs[c];
+    attr.disabled       = (c == 0);
+    attr.exclude_kernel = 1;
+    attr.exclude_hv     = 1;
+    attr.read_format    = PERF_FORMAT_GROUP;
+
+    // this thread on any cpu, in the group of the first counter
+    _fd[c] = static_cast<int>(syscall(__NR_perf_event_open, &attr, 0, -1, c == 0 ? -1 : _fd[0], 0));
+    if (_fd[c] < 0)
+    {
+      message = std::string("can not open hardware counter ") + name(c) + ": " + strerror(errno);
+      close();
+      return false;
+    }
+  }
+
+  ioctl(_fd[0], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+  ioctl(_fd[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+  return true;
+}
+
+
+void HWCounters::close()
+{
+  if (_fd[0] >= 0)
+    ioctl(_fd[0], PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+
+  for (unsigned int c=N_COUNTERS; c>0; --c)
+    if (_fd[c-1] >= 0)
+    {
+      ::close(_fd[c-1]);
+      _fd[c-1] = -1;
+    }
+}
+
+
+void HWCounters::read(unsigned long long *values) const
+{
+  // PERF_FORMAT_GROUP: the number of counters followed by their values
+  unsigned long long buffer[N_COUNTERS+1];
+  if (::read(_fd[0], buffer, sizeof(buffer)) != static_cast<ssize_t>(sizeof(buffer)))
+  {
+    for (unsigned int c=0; c<N_COUNTERS; ++c)
+      values[c] = 0;
+    return;
+  }
+  for (unsigned int c=0; c<N_COUNTERS; ++c)
+    values[c] = buffer[c+1];
+}
+
+#else
+
+bool HWCounters::open(std::string &message)
+{
+  message = "hardware counters are only supported with Linux perf events";
+  return false;
+}
+
+
+void HWCounters::close()
+{}
+
+
+void HWCounters::read(unsigned long long *values) const
+{
+  for (unsigned int c=0; c<N_COUNTERS; ++c)
+    values[c] = 0;
+}
+
+#endif
@@ -19,16 +19,35 @@
 /*                                                                              */
 /********************************************************************************/
 
+#include <cstdlib>
+#include <algorithm>
+
 #include "log.h"
 
 GENIUS_LOG_STREAM genius_log;
 
 GENIUS_LOG_STREAM::GENIUS_LOG_STREAM()
+  : _deferred(false), _level(LOG_INFO), _max_level(LOG_INFO)
+#ifndef WINDOWS
+  , _async(false), _running(false), _busy(false), _stop(false)
+#endif
 {
+#ifndef WINDOWS
+  pthread_mutex_init(&_mutex, NULL);
+  pthread_cond_init(&_msg_ready, NULL);
+  pthread_cond_init(&_written, NULL);
+#endif
 }
 
 GENIUS_LOG_STREAM::~GENIUS_LOG_STREAM()
 {
+#ifndef WINDOWS
+  _stop_thread();
+  pthread_cond_destroy(&_written);
+  pthread_cond_destroy(&_msg_ready);
+  pthread_mutex_destroy(&_mutex);
+#endif
+
   for (std::map<std::string, std::ostream*>::iterator it = _streams.begin();
        it != _streams.end(); it++)
   {
@@ -36,22 +55,176 @@ GENIUS_LOG_STREAM::~GENIUS_LOG_STREAM()
   }
 }
 
-void GENIUS_LOG_STREAM::record()
+void GENIUS_LOG_STREAM::_write(const std::string &msg)
 {
   for (std::map<std::string, std::ostream*>::iterator it = _streams.begin();
        it != _streams.end(); it++)
   {
-    std::string msg(_sstream.str());
     (*it->second) << msg;
     it->second->flush();
   }
+}
+
+void GENIUS_LOG_STREAM::record()
+{
+  const bool deferred = _deferred;
+  _deferred = false;
+
+  // nothing to record, i.e. a disabled MESSAGE_LOG
+  if (_sstream.tellp() <= 0) return;
+
+#ifndef WINDOWS
+  if (_running)
+  {
+    pthread_mutex_lock(&_mutex);
+    if (deferred)
+    {
+      _pending += _sstream.str();
+      pthread_cond_signal(&_msg_ready);
+      pthread_mutex_unlock(&_mutex);
+      _sstream.str("");
+      return;
+    }
+
+    // keep the order, wait for the pending messages
+    while (!_pending.empty() || _busy)
+      pthread_cond_wait(&_written, &_mutex);
+    pthread_mutex_unlock(&_mutex);
+  }
+#endif
+
+  _write(_sstream.str());
   _sstream.str("");
 }
 
+void GENIUS_LOG_STREAM::flush()
+{
+  record();
+
+#ifndef WINDOWS
+  if (_running)
+  {
+    pthread_mutex_lock(&_mutex);
+    while (!_pending.empty() || _busy)
+      pthread_cond_wait(&_written, &_mutex);
+    pthread_mutex_unlock(&_mutex);
+  }
+#endif
+}
+
+void GENIUS_LOG_STREAM::set_async(bool async)
+{
+#ifndef WINDOWS
+  if (async == _async) return;
+  _async = async;
+
+  if (_async)
+  {
+    _stop = false;
+    _running = (pthread_create(&_thread, NULL, _thread_main, this) == 0);
+  }
+  else
+  {
+    flush();
+    _stop_thread();
+  }
+#endif
+}
+
+#ifndef WINDOWS
+void * GENIUS_LOG_STREAM::_thread_main(void * ctx)
+{
+  static_cast<GENIUS_LOG_STREAM *>(ctx)->_run();
+  return NULL;
+}
+
+void GENIUS_LOG_STREAM::_run()
+{
+  std::string msg;
+  while (true)
+  {
+    pthread_mutex_lock(&_mutex);
+    while (_pending.empty() && !_stop)
+      pthread_cond_wait(&_msg_ready, &_mutex);
+
+    if (_pending.empty())
+    {
+      pthread_mutex_unlock(&_mutex);
+      break;
+    }
+
+    // take all the pending messages, the solver goes on appending
+    msg.swap(_pending);
+    _busy = true;
+    pthread_mutex_unlock(&_mutex);
+
+    _write(msg);
+    msg.clear();
+
+    pthread_mutex_lock(&_mutex);
+    _busy = false;
+    pthread_cond_broadcast(&_written);
+    pthread_mutex_unlock(&_mutex);
+  }
+}
+
+void GENIUS_LOG_STREAM::_stop_thread()
+{
+  if (!_running) return;
+
+  pthread_mutex_lock(&_mutex);
+  _stop = true;
+  pthread_cond_signal(&_msg_ready);
+  pthread_mutex_unlock(&_mutex);
+
+  // the thread writes out all the pending messages before exit
+  pthread_join(_thread, NULL);
+  _running = false;
+  _async = false;
+}
+#endif
+
+void GENIUS_LOG_STREAM::set_level(int level)
+{
+  _level = level;
+  _max_level = level;
+  for (std::map<std::string, int>::const_iterator it = _category_level.begin(); it != _category_level.end(); ++it)
+    _max_level = std::max(_max_level, it->second);
+}
+
+void GENIUS_LOG_STREAM::set_category_level(const std::string &category, int level)
+{
+  _category_level[category] = level;
+  set_level(_level);
+}
+
+void GENIUS_LOG_STREAM::set_category_levels(const std::string &list)
+{
+  std::stringstream ss(list);
+  std::string item;
+  while (std::getline(ss, item, ','))
+  {
+    std::string::size_type pos = item.find(':');
+    if (pos == std::string::npos || pos == 0) continue;
+    set_category_level(item.substr(0, pos), atoi(item.substr(pos+1).c_str()));
+  }
+}
+
+bool GENIUS_LOG_STREAM::_enabled(int level, const char *category) const
+{
+  if (category)
+  {
+    std::map<std::string, int>::const_iterator it = _category_level.find(category);
+    if (it != _category_level.end()) return level <= it->second;
+  }
+  return level <= _level;
+}
+
 void GENIUS_LOG_STREAM::addStream(const std::string &name, std::streambuf* buf)
 {
   if (buf)
   {
+    flush();
     std::ostream *os = new std::ostream(buf);
     os->setf(std::ios::scientific);
     _streams.insert(std::pair<std::string, std::ostream*>(name, os) );
@@ -60,6 +233,8 @@ void GENIUS_LOG_STREAM::addStream(const std::string &name, std::streambuf* buf)
 
 void GENIUS_LOG_STREAM::addStream(const std::string &name, const std::string &fname)
 {
+  flush();
+
   std::filebuf *buf = new std::filebuf;
   buf->open(fname.c_str(), std::ios::out);
 
@@ -71,6 +246,9 @@ void GENIUS_LOG_STREAM::addStream(const std::string &name, const std::string &fn
 
 void GENIUS_LOG_STREAM::removeStream(const std::string &name)
 {
+  // write out the pending messages before the stream goes away
+  flush();
+
   {
     std::map<std::string, std::ostream*>::iterator it = _streams.find(name);
     for (;it != _streams.end(); ++it)
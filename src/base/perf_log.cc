@@ -24,10 +24,14 @@
 #include <iomanip>
 #include <ctime>
 #include <vector>
+#include <sstream>
+#include <algorithm>
+#include <cstdlib>
 
 // Local includes
 #include "perf_log.h"
 #include "genius_env.h"
+#include "parallel.h"
 
 #ifdef ENABLE_PERFORMANCE_LOGGING
 
@@ -64,11 +68,15 @@ inline int gettimeofday(struct timeval_t *tp, void *tzp)
 
 
 
+HWCounters * PerfData::hw_counters = NULL;
+
+
 void PerfData::start ()
 {
   this->count++;
   this->called_recursively++;
   gettimeofday (&(this->tstart), NULL);
+  if (hw_counters) hw_counters->read(this->cstart);
 }
 
 
@@ -76,6 +84,7 @@ void PerfData::start ()
 void PerfData::restart ()
 {
   gettimeofday (&(this->tstart), NULL);
+  if (hw_counters) hw_counters->read(this->cstart);
 }
 
 
@@ -97,6 +106,17 @@ double PerfData::pause ()
 
   this->tot_time += elapsed_time;
 
+  if (hw_counters)
+    {
+      unsigned long long now[HWCounters::N_COUNTERS];
+      hw_counters->read(now);
+      for (unsigned int c=0; c<HWCounters::N_COUNTERS; ++c)
+        {
+          this->counters[c] += now[c] - this->cstart[c];
+          this->cstart[c] = now[c];
+        }
+    }
+
   return elapsed_time;
 }
 
@@ -121,7 +141,12 @@ PerfLog::PerfLog(const std::string& ln,
                  const bool le) :
   label_name(ln),
   log_events(le),
-  total_time(0.)
+  total_time(0.),
+  report_active(false),
+  report_time(0.),
+  trace_active(false),
+  trace_start(0.),
+  trace_depth(0)
 {
   if (log_events)
     this->clear();
@@ -164,6 +189,10 @@ void PerfLog::clear()
 
       while (!log_stack.empty())
         log_stack.pop();
+
+      // the trace refers to the events
+      trace_events.clear();
+      trace_depth = 0;
     }
 }
 
@@ -487,6 +516,111 @@ std::string PerfLog::get_perf_info() const
 
 
 
+bool PerfLog::enable_counters(std::string &message)
+{
+  // the events already running have no start values
+  if (!log_stack.empty())
+    {
+      message = "hardware counters can not be enabled inside a logged event";
+      return false;
+    }
+
+  if (!hw_counters.open(message))
+    return false;
+
+  PerfData::hw_counters = &hw_counters;
+  return true;
+}
+
+
+
+void PerfLog::disable_counters()
+{
+  PerfData::hw_counters = NULL;
+  hw_counters.close();
+}
+
+
+
+std::string PerfLog::get_counter_info() const
+{
+  OStringStream out;
+
+  if (!log_events || log.empty() || !counting())
+    return out.str();
+
+  unsigned int event_col_width = 30;
+  const unsigned int count_col_width = 14;
+  const unsigned int ratio_col_width = 10;
+
+  std::map<std::pair<std::string,std::string>, PerfData>::const_iterator pos;
+  for (pos = log.begin(); pos != log.end(); ++pos)
+    if (pos->first.second.size()+3 > event_col_width)
+      event_col_width = pos->first.second.size()+3;
+
+  const unsigned int total_col_width = event_col_width + HWCounters::N_COUNTERS*count_col_width + 3*ratio_col_width + 1;
+
+  out << ' ';
+  this->_character_line(total_col_width, '-', out);
+  out << "\n| " << label_name << " Hardware Counters (main thread)\n ";
+  this->_character_line(total_col_width, '-', out);
+  out << '\n';
+
+  out << "| ";
+  OSSStringleft(out,event_col_width,"Event");
+  for (unsigned int c=0; c<HWCounters::N_COUNTERS; ++c)
+    {
+      OSSStringleft(out,count_col_width,HWCounters::name(c));
+    }
+  OSSStringleft(out,ratio_col_width,"IPC");
+  OSSStringleft(out,ratio_col_width,"LLC MPKI");
+  OSSStringleft(out,ratio_col_width,"GB/s");
+  out << "|\n|";
+  this->_character_line(total_col_width, '-', out);
+  out << "|\n";
+
+  std::string last_header("");
+  for (pos = log.begin(); pos != log.end(); ++pos)
+    {
+      const PerfData& perf_data = pos->second;
+      if (perf_data.count == 0) continue;
+
+      if (pos->first.first != "" && last_header != pos->first.first)
+        {
+          last_header = pos->first.first;
+          out << "| ";
+          OSSStringleft(out,total_col_width-1,last_header);
+          out << "|\n";
+        }
+
+      out << "| ";
+      OSSStringleft(out,event_col_width,(pos->first.first == "" ? "" : "  ") + pos->first.second);
+      for (unsigned int c=0; c<HWCounters::N_COUNTERS; ++c)
+        {
+          OSSInt(out,count_col_width,perf_data.counters[c]);
+        }
+
+      const double cycles = static_cast<double>(perf_data.counters[HWCounters::Cycles]);
+      const double instructions = static_cast<double>(perf_data.counters[HWCounters::Instructions]);
+      const double llc_misses = static_cast<double>(perf_data.counters[HWCounters::LLCMisses]);
+
+      out.setf(std::ios::fixed);
+      OSSRealleft(out,ratio_col_width,2,(cycles > 0 ? instructions/cycles : 0.0));
+      OSSRealleft(out,ratio_col_width,2,(instructions > 0 ? 1e3*llc_misses/instructions : 0.0));
+      OSSRealleft(out,ratio_col_width,2,(perf_data.tot_time > 0 ? llc_misses*HWCounters::cache_line_size/perf_data.tot_time*1e-9 : 0.0));
+      out.unsetf(std::ios::fixed);
+      out << "|\n";
+    }
+
+  out << ' ';
+  this->_character_line(total_col_width, '-', out);
+  out << '\n';
+
+  return out.str();
+}
+
+
+
 std::string PerfLog::get_log() const
 {
   OStringStream out;
@@ -505,6 +639,7 @@ std::string PerfLog::get_log() const
               out << get_info_header();
             }
           out << get_perf_info();
+          out << get_counter_info();
         }
     }
 
@@ -554,6 +689,382 @@ void PerfLog::restart_event(const std::string &,
 
 
 
+// wall time in seconds
+static double _wall_time()
+{
+#ifdef WINDOWS
+  struct timeval_t tnow;
+#else
+  struct timeval tnow;
+#endif
+  gettimeofday (&tnow, NULL);
+  return static_cast<double>(tnow.tv_sec) + static_cast<double>(tnow.tv_usec)*1.e-6;
+}
+
+
+
+PerfLog::Snapshot PerfLog::_snapshot()
+{
+  // accumulate the running time of the active event
+  if (!log_stack.empty())
+    total_time += log_stack.top()->pause();
+
+  Snapshot snapshot;
+  std::map<std::pair<std::string,std::string>, PerfData>::const_iterator pos;
+  for (pos = log.begin(); pos != log.end(); ++pos)
+    snapshot[pos->first] = std::make_pair(pos->second.tot_time, pos->second.count);
+
+  return snapshot;
+}
+
+
+
+PerfLog::Snapshot PerfLog::_difference(const Snapshot &now, const Snapshot &before)
+{
+  Snapshot diff;
+  Snapshot::const_iterator pos;
+  for (pos = now.begin(); pos != now.end(); ++pos)
+    {
+      std::pair<double, unsigned int> d = pos->second;
+      Snapshot::const_iterator old = before.find(pos->first);
+      if (old != before.end())
+        {
+          d.first  -= old->second.first;
+          d.second -= old->second.second;
+        }
+      if (d.second != 0 || d.first > 0.)
+        diff[pos->first] = d;
+    }
+  return diff;
+}
+
+
+
+void PerfLog::begin_report()
+{
+  report_active = true;
+  report_sections.clear();
+  report_total.clear();
+  report_begin = _snapshot();
+  report_last_mark = report_begin;
+
+  report_time = _wall_time();
+}
+
+
+
+void PerfLog::end_report()
+{
+  if (!report_active) return;
+
+  report_total = _difference(_snapshot(), report_begin);
+  report_active = false;
+
+  report_time = _wall_time() - report_time;
+}
+
+
+
+void PerfLog::mark(const std::string &tag)
+{
+  if (!report_active || !log_events) return;
+
+  Snapshot now = _snapshot();
+  report_sections.push_back(std::make_pair(tag, _difference(now, report_last_mark)));
+  report_last_mark = now;
+}
+
+
+// escape a string for JSON output
+static std::string _json_string(const std::string &s)
+{
+  std::string out("\"");
+  for (unsigned int i=0; i<s.size(); ++i)
+    {
+      if (s[i] == '"' || s[i] == '\\') out += '\\';
+      out += s[i];
+    }
+  out += '"';
+  return out;
+}
+
+
+// escape a string for CSV output
+static std::string _csv_string(const std::string &s)
+{
+  std::string out("\"");
+  for (unsigned int i=0; i<s.size(); ++i)
+    {
+      if (s[i] == '"') out += '"';
+      out += s[i];
+    }
+  out += '"';
+  return out;
+}
+
+
+
+std::string PerfLog::get_report_json(const std::string &title) const
+{
+  OStringStream out;
+  out << std::setprecision(6);
+
+  out << "{\n";
+  out << "  \"title\": " << _json_string(title) << ",\n";
+  out << "  \"processor\": " << Genius::processor_id() << ",\n";
+  out << "  \"n_processors\": " << Genius::n_processors() << ",\n";
+  out << "  \"wall_time\": " << report_time << ",\n";
+
+  // events of the whole report and each section
+  std::vector<std::pair<std::string, const Snapshot *> > sections;
+  sections.push_back(std::make_pair(std::string("total"), &report_total));
+  for (unsigned int n=0; n<report_sections.size(); ++n)
+    sections.push_back(std::make_pair(report_sections[n].first, &report_sections[n].second));
+
+  out << "  \"sections\": [\n";
+  for (unsigned int n=0; n<sections.size(); ++n)
+    {
+      out << "    {\n";
+      out << "      \"section\": " << _json_string(sections[n].first) << ",\n";
+      out << "      \"events\": [\n";
+      Snapshot::const_iterator pos = sections[n].second->begin();
+      for (; pos != sections[n].second->end(); )
+        {
+          out << "        { \"header\": " << _json_string(pos->first.first)
+              << ", \"event\": " << _json_string(pos->first.second)
+              << ", \"calls\": " << pos->second.second
+              << ", \"time\": " << pos->second.first << " }";
+          if (++pos != sections[n].second->end()) out << ',';
+          out << '\n';
+        }
+      out << "      ]\n";
+      out << "    }" << (n+1 < sections.size() ? "," : "") << '\n';
+    }
+  out << "  ]\n";
+  out << "}\n";
+
+  return out.str();
+}
+
+
+
+std::string PerfLog::get_report_csv(const std::string &title) const
+{
+  OStringStream out;
+  out << std::setprecision(6);
+
+  out << "title,section,header,event,calls,time\n";
+
+  std::vector<std::pair<std::string, const Snapshot *> > sections;
+  sections.push_back(std::make_pair(std::string("total"), &report_total));
+  for (unsigned int n=0; n<report_sections.size(); ++n)
+    sections.push_back(std::make_pair(report_sections[n].first, &report_sections[n].second));
+
+  for (unsigned int n=0; n<sections.size(); ++n)
+    {
+      Snapshot::const_iterator pos = sections[n].second->begin();
+      for (; pos != sections[n].second->end(); ++pos)
+        out << _csv_string(title) << ','
+            << _csv_string(sections[n].first) << ','
+            << _csv_string(pos->first.first) << ','
+            << _csv_string(pos->first.second) << ','
+            << pos->second.second << ','
+            << pos->second.first << '\n';
+    }
+
+  return out.str();
+}
+
+
+
+
+void PerfLog::begin_trace()
+{
+  // common time origin of all the processors
+  Parallel::barrier();
+
+  trace_active = true;
+  trace_depth = 0;
+  trace_events.clear();
+  trace_total.clear();
+  trace_begin = _snapshot();
+
+  trace_start = _wall_time();
+}
+
+
+
+void PerfLog::end_trace()
+{
+  if (!trace_active) return;
+
+  trace_total = _difference(_snapshot(), trace_begin);
+  trace_active = false;
+}
+
+
+
+void PerfLog::_trace(const std::pair<std::string, std::string> *key, bool begin)
+{
+  if (begin)
+    trace_depth++;
+  else
+    {
+      // opened before the trace
+      if (trace_depth == 0) return;
+      trace_depth--;
+    }
+
+  TraceEvent event;
+  event.key   = key;
+  event.time  = _wall_time() - trace_start;
+  event.begin = begin;
+  trace_events.push_back(event);
+}
+
+
+
+std::string PerfLog::get_trace_json() const
+{
+  const unsigned int pid = Genius::processor_id();
+
+  // events of this processor, each one followed by ",\n"
+  std::string local;
+  {
+    OStringStream out;
+    out << std::fixed << std::setprecision(1);
+
+    out << "{ \"name\": \"process_name\", \"ph\": \"M\", \"pid\": " << pid
+        << ", \"tid\": 0, \"args\": { \"name\": \"processor " << pid << "\" } },\n";
+
+    for (unsigned int n=0; n<trace_events.size(); ++n)
+      {
+        const TraceEvent &event = trace_events[n];
+        out << "{ \"name\": " << _json_string(event.key->second)
+            << ", \"cat\": " << _json_string(event.key->first.empty() ? std::string("Genius") : event.key->first)
+            << ", \"ph\": \"" << (event.begin ? 'B' : 'E') << '"'
+            << ", \"ts\": " << event.time*1e6
+            << ", \"pid\": " << pid << ", \"tid\": 0 },\n";
+      }
+    local = out.str();
+  }
+
+  std::vector<char> buffer(local.begin(), local.end());
+  Parallel::gather(0, buffer);
+
+  if (Genius::processor_id() != 0) return std::string();
+
+  std::string events(buffer.begin(), buffer.end());
+  // remove the last ",\n"
+  if (events.size() >= 2) events.resize(events.size()-2);
+
+  return "{ \"traceEvents\": [\n" + events + "\n],\n  \"displayTimeUnit\": \"ms\" }\n";
+}
+
+
+
+std::string PerfLog::get_imbalance_summary() const
+{
+  // time of each event on this processor as "header \t event \t time \n"
+  std::string local;
+  {
+    OStringStream out;
+    out << std::setprecision(12);
+    Snapshot::const_iterator pos = trace_total.begin();
+    for (; pos != trace_total.end(); ++pos)
+      out << pos->first.first << '\t' << pos->first.second << '\t' << pos->second.first << '\n';
+    local = out.str();
+  }
+
+  std::vector<char> buffer(local.begin(), local.end());
+  std::vector<unsigned int> counts;
+  Parallel::gather(0, static_cast<unsigned int>(buffer.size()), counts);
+  Parallel::gather(0, buffer);
+
+  if (Genius::processor_id() != 0) return std::string();
+
+  // time of each event on each processor
+  const unsigned int n_procs = Genius::n_processors();
+  std::map<std::pair<std::string, std::string>, std::vector<double> > times;
+  {
+    unsigned int offset = 0;
+    for (unsigned int p=0; p<n_procs; ++p)
+      {
+        std::istringstream in(std::string(buffer.begin()+offset, buffer.begin()+offset+counts[p]));
+        offset += counts[p];
+
+        std::string header, event, time;
+        while (std::getline(in, header, '\t') && std::getline(in, event, '\t') && std::getline(in, time))
+          {
+            std::vector<double> &t = times[std::make_pair(header, event)];
+            t.resize(n_procs, 0.0);
+            t[p] = atof(time.c_str());
+          }
+      }
+  }
+
+  // sort the events by the max time
+  std::vector<std::pair<double, std::pair<std::string, std::string> > > order;
+  std::map<std::pair<std::string, std::string>, std::vector<double> >::const_iterator it;
+  for (it = times.begin(); it != times.end(); ++it)
+    order.push_back(std::make_pair(*std::max_element(it->second.begin(), it->second.end()), it->first));
+  std::sort(order.rbegin(), order.rend());
+
+  unsigned int event_col_width = 30;
+  for (unsigned int n=0; n<order.size(); ++n)
+    if (order[n].second.second.size() + order[n].second.first.size() + 5 > event_col_width)
+      event_col_width = order[n].second.second.size() + order[n].second.first.size() + 5;
+  const unsigned int col_width = 12;
+  const unsigned int total_col_width = event_col_width + 4*col_width + 1;
+
+  OStringStream out;
+  out << ' ';
+  this->_character_line(total_col_width, '-', out);
+  out << '\n';
+  out << "| Load imbalance over " << n_procs << " processors\n";
+  out << ' ';
+  this->_character_line(total_col_width, '-', out);
+  out << '\n';
+
+  out << "| ";
+  OSSStringleft(out, event_col_width, "Event");
+  OSSStringleft(out, col_width, "Max Time");
+  OSSStringleft(out, col_width, "Avg Time");
+  OSSStringleft(out, col_width, "Max/Avg");
+  OSSStringleft(out, col_width, "Slowest");
+  out << "|\n|";
+  this->_character_line(total_col_width, '-', out);
+  out << "|\n";
+
+  for (unsigned int n=0; n<order.size(); ++n)
+    {
+      const std::vector<double> &t = times[order[n].second];
+      const unsigned int slowest = std::max_element(t.begin(), t.end()) - t.begin();
+      double avg = 0.0;
+      for (unsigned int p=0; p<t.size(); ++p) avg += t[p];
+      avg /= n_procs;
+
+      const std::string name = order[n].second.first.empty() ? order[n].second.second :
+                               order[n].second.first + ": " + order[n].second.second;
+      out << "| ";
+      OSSStringleft(out, event_col_width, name);
+      OSSRealleft(out, col_width, 4, order[n].first);
+      OSSRealleft(out, col_width, 4, avg);
+      OSSRealleft(out, col_width, 2, avg > 0.0 ? order[n].first/avg : 1.0);
+      OSSInt(out, col_width, slowest);
+      out << "|\n";
+    }
+
+  out << ' ';
+  this->_character_line(total_col_width, '-', out);
+  out << '\n';
+
+  return out.str();
+}
+
+
+
+
 void PerfLog::_character_line(const unsigned int n,
                               const char c,
                               OStringStream& out) const
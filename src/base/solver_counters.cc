@@ -0,0 +1,153 @@
+/********************************************************************************/
+/*     888888    888888888   88     888  88888   888      888    88888888       */
+/*   8       8   8           8 8     8     8      8        8    8               */
+/*  8            8           8  8    8     8      8        8    8               */
+/*  8            888888888   8   8   8     8      8        8     8888888        */
+/*  8      8888  8           8    8  8     8      8        8            8       */
+/*   8       8   8           8     8 8     8      8        8            8       */
+/*     888888    888888888  888     88   88888     88888888     88888888        */
+/*                                                                              */
+/*       A Three-Dimensional General Purpose Semiconductor Simulator.           */
+/*                                                                              */
+/*                                                                              */
+/*  Copyright (C) 2007-2008                                                     */
+/*  Cogenda Pte Ltd                                                             */
+/*                                                                              */
+/*  Please contact Cogenda Pte Ltd for license information                      */
+/*                                                                              */
+/*  Author: Gong Ding   gdiso@ustc.edu                                          */
+/*                                                                              */
+/********************************************************************************/
+
+
+#include <algorithm>
+#include <iomanip>
+
+#include "solver_counters.h"
+#include "o_string_stream.h"
+#include "parallel.h"
+
+
+SolverCounters solver_counters;
+
+
+static const char * _predefined_counter_names[] =
+{
+  "newton.iterations",
+  "linesearch.steps",
+  "linesearch.cutbacks",
+  "linesearch.trials",
+  "ksp.iterations",
+  "nonlinear.solves",
+  "nonlinear.diverged",
+  "timestep.rejected",
+  "timestep.accepted",
+  "assembly.function",
+  "assembly.jacobian"
+};
+
+
+SolverCounters::SolverCounters()
+  : _slots(max_threads)
+{
+  for(unsigned int i=0; i<N_PREDEFINED_COUNTERS; ++i)
+    _names.push_back(_predefined_counter_names[i]);
+  reset();
+}
+
+
+unsigned int SolverCounters::counter(const std::string &name)
+{
+  std::vector<std::string>::const_iterator it = std::find(_names.begin(), _names.end(), name);
+  if( it != _names.end() ) return it - _names.begin();
+
+  genius_assert(_names.size() < max_counters);
+  _names.push_back(name);
+  return _names.size()-1;
+}
+
+
+long SolverCounters::value(unsigned int id) const
+{
+  long sum = 0;
+  for(unsigned int t=0; t<max_threads; ++t)
+    sum += _slots[t].value[id];
+  return sum;
+}
+
+
+long SolverCounters::value(const std::string &name) const
+{
+  std::vector<std::string>::const_iterator it = std::find(_names.begin(), _names.end(), name);
+  if( it == _names.end() ) return 0;
+  return value(it - _names.begin());
+}
+
+
+Real SolverCounters::gauge(const std::string &name) const
+{
+  std::map<std::string, Real>::const_iterator it = _gauges.find(name);
+  return it != _gauges.end() ? it->second : 0.0;
+}
+
+
+void SolverCounters::reset()
+{
+  for(unsigned int t=0; t<max_threads; ++t)
+    std::fill(_slots[t].value, _slots[t].value+max_counters, 0L);
+  _gauges.clear();
+}
+
+
+// escape a string for JSON output
+static std::string _json_string(const std::string &s)
+{
+  std::string out("\"");
+  for (unsigned int i=0; i<s.size(); ++i)
+  {
+    if (s[i] == '"' || s[i] == '\\') out += '\\';
+    out += s[i];
+  }
+  out += '"';
+  return out;
+}
+
+
+std::string SolverCounters::get_report_json(const std::string &title) const
+{
+  // named counters are registered in the same order on every processor
+  std::vector<Real> counters;
+  for(unsigned int i=0; i<_names.size(); ++i)
+    counters.push_back(static_cast<Real>(value(i)));
+  Parallel::sum(counters);
+
+  // gauges are set with the same names on every processor, report the maximum
+  std::vector<std::string> gauge_names;
+  std::vector<Real> gauges;
+  for(std::map<std::string, Real>::const_iterator it = _gauges.begin(); it != _gauges.end(); ++it)
+  {
+    gauge_names.push_back(it->first);
+    gauges.push_back(it->second);
+  }
+  Parallel::max(gauges);
+
+  OStringStream out;
+  out << std::setprecision(10);
+
+  out << "{\n";
+  out << "  \"title\": " << _json_string(title) << ",\n";
+  out << "  \"n_processors\": " << Genius::n_processors() << ",\n";
+
+  out << "  \"counters\": {\n";
+  for(unsigned int i=0; i<_names.size(); ++i)
+    out << "    " << _json_string(_names[i]) << ": " << static_cast<long>(counters[i]) << (i+1 < _names.size() ? "," : "") << '\n';
+  out << "  },\n";
+
+  out << "  \"gauges\": {\n";
+  for(unsigned int i=0; i<gauge_names.size(); ++i)
+    out << "    " << _json_string(gauge_names[i]) << ": " << gauges[i] << (i+1 < gauge_names.size() ? "," : "") << '\n';
+  out << "  }\n";
+  out << "}\n";
+
+  return out.str();
+}
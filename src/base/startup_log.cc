@@ -0,0 +1,108 @@
+/********************************************************************************/
+/*     888888    888888888   88     888  88888   888      888    88888888       */
+/*   8       8   8           8 8     8     8      8        8    8               */
+/*  8            8           8  8    8     8      8        8    8               */
+/*  8            888888888   8   8   8     8      8        8     8888888        */
+/*  8      8888  8           8    8  8     8      8        8            8       */
+/*   8       8   8           8     8 8     8      8        8            8       */
+/*     888888    888888888  888     88   88888     88888888     88888888        */
+/*                                                                              */
+/*       A Three-Dimensional General Purpose Semiconductor Simulator.           */
+/*                                                                              */
+/*                                                                              */
+/*  Copyright (C) 2007-2008                                                     */
+/*  Cogenda Pte Ltd                                                             */
+/*                                                                              */
+/*  Please contact Cogenda Pte Ltd for license information                      */
+/*                                                                              */
+/*  Author: Gong Ding   gdiso@ustc.edu                                          */
+/*                                                                              */
+/********************************************************************************/
+
+
+#include <iomanip>
+
+#include "startup_log.h"
+#include "genius_env.h"
+#include "parallel.h"
+#include "log.h"
+
+#ifdef WINDOWS
+  #include <time.h>
+#else
+  #include <sys/time.h>
+#endif
+
+
+StartupLog startup_log;
+
+
+// wall time in seconds
+static double _wall_time()
+{
+#ifdef WINDOWS
+  return static_cast<double>(clock())/CLOCKS_PER_SEC;
+#else
+  struct timeval tnow;
+  gettimeofday (&tnow, NULL);
+  return static_cast<double>(tnow.tv_sec) + static_cast<double>(tnow.tv_usec)*1.e-6;
+#endif
+}
+
+
+void StartupLog::begin(const std::string &phase)
+{
+  _current   = phase;
+  _t_begin   = _wall_time();
+  _rss_begin = Genius::memory_size().second;
+}
+
+
+void StartupLog::end()
+{
+  if( _current.empty() ) return;
+
+  const size_t rss = Genius::memory_size().second;
+
+  Phase phase;
+  phase.name      = _current;
+  phase.time      = _wall_time() - _t_begin;
+  phase.rss       = static_cast<double>(rss);
+  phase.rss_delta = static_cast<double>(rss) - static_cast<double>(_rss_begin);
+  _phases.push_back(phase);
+
+  _current.clear();
+}
+
+
+void StartupLog::print() const
+{
+  // all the processors run the same phases
+  std::vector<double> time, mem;
+  for(unsigned int n=0; n<_phases.size(); ++n)
+  {
+    time.push_back(_phases[n].time);
+    mem.push_back(_phases[n].rss_delta);
+    mem.push_back(_phases[n].rss);
+  }
+  Parallel::max(time);
+  Parallel::sum(mem);
+
+  const double MB = 1024.0*1024.0;
+  double total = 0.0;
+  const std::ios::fmtflags flags = MESSAGE.flags();
+  const std::streamsize precision = MESSAGE.precision();
+  MESSAGE<<"Startup phases, max time over processors (s) and resident memory of all the processors (MB):\n";
+  MESSAGE<<"  "<<std::setw(40)<<std::left<<"phase"<<std::right<<std::setw(10)<<"time"<<std::setw(12)<<"memory"<<std::setw(12)<<"total"<<'\n';
+  for(unsigned int n=0; n<_phases.size(); ++n)
+  {
+    MESSAGE<<"  "<<std::setw(40)<<std::left<<_phases[n].name<<std::right<<std::fixed
+           <<std::setprecision(3)<<std::setw(10)<<time[n]
+           <<std::setprecision(1)<<std::setw(12)<<mem[2*n]/MB<<std::setw(12)<<mem[2*n+1]/MB<<'\n';
+    total += time[n];
+  }
+  MESSAGE<<"  "<<std::setw(40)<<std::left<<"total"<<std::right<<std::setprecision(3)<<std::setw(10)<<total<<"\n\n";
+  MESSAGE.flags(flags);
+  MESSAGE.precision(precision);
+  RECORD();
+}
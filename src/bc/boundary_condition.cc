@@ -71,6 +71,7 @@ void init_bc_name_to_bc_type_map()
     bc_name_to_bc_type["heterojunction"           ]  = HeteroInterface;
     bc_name_to_bc_type["chargedcontact"           ]  = ChargedContact;
     bc_name_to_bc_type["absorbingboundary"        ]  = AbsorbingBoundary;
+    bc_name_to_bc_type["periodic"                 ]  = PeriodicBoundary;
     bc_name_to_bc_type["sourceboundary"           ]  = SourceBoundary;
     bc_name_to_bc_type["floatmetal"               ]  = ChargedContact;
   }
@@ -104,6 +105,7 @@ void init_bc_type_to_bc_name_map()
     bc_type_to_bc_name[IF_Metal_Vacuum                 ]  = std::string("IF_Metal_Vacuum");
     bc_type_to_bc_name[IF_PML_Scatter                  ]  = std::string("IF_PML_Scatter");
     bc_type_to_bc_name[IF_PML_PML                      ]  = std::string("IF_PML_PML");
+    bc_type_to_bc_name[PeriodicBoundary                ]  = std::string("PeriodicBoundary");
     bc_type_to_bc_name[IF_Electrode_Insulator          ]  = std::string("IF_Electrode_Insulator");
     bc_type_to_bc_name[IF_Insulator_Semiconductor      ]  = std::string("IF_Insulator_Semiconductor");
     bc_type_to_bc_name[IF_Insulator_Insulator          ]  = std::string("IF_Insulator_Insulator");
@@ -330,7 +332,7 @@ bool consistent_bc_by_subdomain(const std::string &mat1, const std::string &mat2
 BoundaryCondition::BoundaryCondition(SimulationSystem  & system, const std::string & label)
   : _system(system), _boundary_name(label), _boundary_id(BoundaryInfo::invalid_id), _bc_regions(NULL, NULL), _link_to_spice(false),
     _ext_circuit(NULL), _z_width(system.z_width()),
-    _T_Ext(system.T_external()), _inter_connect_hub(0)
+    _T_Ext(system.T_external()), _inter_connect_hub(0), _disp_mesh_revision(invalid_uint), _rn_mesh_revision(invalid_uint)
 {
   for(int i=0; i<4; ++i)
   {
@@ -538,6 +540,192 @@ bool BoundaryCondition::has_flag(const std::string & name) const
 }
 
 
+void BoundaryCondition::build_displacement_stencil(SimulationRegionType region_type)
+{
+  if( _disp_mesh_revision == _system.mesh_revision() && _disp_region_type == region_type ) return;
+
+  _disp_node.clear();
+  _disp_nb_node.clear();
+  _disp_coeff.clear();
+
+  BoundaryCondition::const_node_iterator node_it = nodes_begin();
+  BoundaryCondition::const_node_iterator end_it = nodes_end();
+  for(; node_it!=end_it; ++node_it )
+  {
+    // skip node not belongs to this processor
+    if( (*node_it)->processor_id()!=Genius::processor_id() ) continue;
+
+    BoundaryCondition::region_node_iterator  rnode_it     = region_node_begin(*node_it);
+    BoundaryCondition::region_node_iterator  end_rnode_it = region_node_end(*node_it);
+    for( ; rnode_it!=end_rnode_it; ++rnode_it  )
+    {
+      if( (*rnode_it).second.first->type() != region_type ) continue;
+
+      const FVM_Node * fvm_node = (*rnode_it).second.second;
+      const FVM_NodeData * node_data = fvm_node->node_data();
+
+      FVM_Node::fvm_neighbor_node_iterator nb_it = fvm_node->neighbor_node_begin();
+      for(; nb_it != fvm_node->neighbor_node_end(); ++nb_it)
+      {
+        const FVM_Node *nb_node = (*nb_it).first;
+        // distance from nb node to this node
+        PetscScalar distance = (*(fvm_node->root_node()) - *(nb_node->root_node())).size();
+        // area of out surface of control volume related with neighbor node
+        PetscScalar cv_boundary = fvm_node->cv_surface_area(nb_node);
+
+        _disp_node.push_back(fvm_node);
+        _disp_nb_node.push_back(nb_node);
+        _disp_coeff.push_back(cv_boundary*node_data->eps()/distance);
+      }
+    }
+  }
+
+  _disp_mesh_revision = _system.mesh_revision();
+  _disp_region_type = region_type;
+}
+
+
+void BoundaryCondition::build_region_node_table()
+{
+  if( _rn_mesh_revision == _system.mesh_revision() ) return;
+
+  _rn_node.clear();
+  _rn_ptr.clear();
+  _rn_entry.clear();
+  _rn_first.clear();
+  _rn_second.clear();
+
+  _rn_ptr.push_back(0);
+
+  BoundaryCondition::const_node_iterator node_it = nodes_begin();
+  BoundaryCondition::const_node_iterator end_it = nodes_end();
+  for(; node_it!=end_it; ++node_it )
+  {
+    // skip node not belongs to this processor
+    if( (*node_it)->processor_id()!=Genius::processor_id() ) continue;
+
+    unsigned int first = invalid_uint;
+    unsigned int second = invalid_uint;
+
+    BoundaryCondition::region_node_iterator  rnode_it     = region_node_begin(*node_it);
+    BoundaryCondition::region_node_iterator  end_rnode_it = region_node_end(*node_it);
+    for( ; rnode_it!=end_rnode_it; ++rnode_it  )
+    {
+      RegionNodeEntry entry;
+      entry.region   = (*rnode_it).second.first;
+      entry.fvm_node = (*rnode_it).second.second;
+      entry.ghost_node = NULL;
+      entry.area = 0.0;
+      // all the fvm_nodes on boundary have ghost node list, NULL ghost node indicates outside boundary
+      FVM_Node::fvm_ghost_node_iterator gn_it = entry.fvm_node->ghost_node_begin();
+      for(; gn_it != entry.fvm_node->ghost_node_end(); ++gn_it)
+      {
+        if( entry.ghost_node == NULL ) entry.ghost_node = (*gn_it).first;
+        entry.area += (*gn_it).second.second;
+      }
+
+      if( entry.region == _bc_regions.first  && first  == invalid_uint ) first  = _rn_entry.size();
+      if( entry.region == _bc_regions.second && second == invalid_uint ) second = _rn_entry.size();
+      _rn_entry.push_back(entry);
+    }
+
+    _rn_node.push_back(*node_it);
+    _rn_ptr.push_back(_rn_entry.size());
+    _rn_first.push_back(first);
+    _rn_second.push_back(second);
+  }
+
+  _rn_mesh_revision = _system.mesh_revision();
+}
+
+
+void BoundaryCondition::displacement_time_coefficients(PetscScalar &a, PetscScalar &b, PetscScalar &c, PetscScalar &dt)
+{
+  if(SolverSpecify::TS_type==SolverSpecify::BDF2 && SolverSpecify::BDF2_LowerOrder==false) //second order
+  {
+    PetscScalar r = SolverSpecify::dt_last/(SolverSpecify::dt_last + SolverSpecify::dt);
+    a = (2-r)/(1-r);
+    b = 1.0/(r*(1-r));
+    c = (1-r)/r;
+    dt = SolverSpecify::dt_last+SolverSpecify::dt;
+  }
+  else//first order
+  {
+    a = 1.0;
+    b = 1.0;
+    c = 0.0;
+    dt = SolverSpecify::dt;
+  }
+}
+
+
+PetscScalar BoundaryCondition::displacement_current(const PetscScalar *x, SimulationRegionType region_type)
+{
+  build_displacement_stencil(region_type);
+
+  PetscScalar a, b, c, dt;
+  displacement_time_coefficients(a, b, c, dt);
+
+  PetscScalar I = 0.0;
+  for(unsigned int k=0; k<_disp_coeff.size(); ++k)
+  {
+    const FVM_NodeData * node_data = _disp_node[k]->node_data();
+    const FVM_NodeData * nb_node_data = _disp_nb_node[k]->node_data();
+    const PetscScalar dV = x[_disp_node[k]->local_offset()] - x[_disp_nb_node[k]->local_offset()];
+    I += _disp_coeff[k]*( a*dV
+                          - b*(node_data->psi()-nb_node_data->psi())
+                          + c*(node_data->psi_last()-nb_node_data->psi_last()) );
+  }
+  return I/dt;
+}
+
+
+void BoundaryCondition::displacement_current_jacobian(Mat *jac, PetscInt row, PetscScalar scale, SimulationRegionType region_type)
+{
+  build_displacement_stencil(region_type);
+
+  PetscScalar a, b, c, dt;
+  displacement_time_coefficients(a, b, c, dt);
+
+  displacement_stencil_jacobian(jac, row, scale*a/dt);
+}
+
+
+PetscScalar BoundaryCondition::displacement_flux(const PetscScalar *x, SimulationRegionType region_type)
+{
+  build_displacement_stencil(region_type);
+
+  PetscScalar flux = 0.0;
+  for(unsigned int k=0; k<_disp_coeff.size(); ++k)
+    flux += _disp_coeff[k]*( x[_disp_nb_node[k]->local_offset()] - x[_disp_node[k]->local_offset()] );
+  return flux;
+}
+
+
+void BoundaryCondition::displacement_flux_jacobian(Mat *jac, PetscInt row, PetscScalar scale, SimulationRegionType region_type)
+{
+  build_displacement_stencil(region_type);
+  displacement_stencil_jacobian(jac, row, -scale);
+}
+
+
+void BoundaryCondition::displacement_stencil_jacobian(Mat *jac, PetscInt row, PetscScalar d)
+{
+  if( _disp_coeff.empty() ) return;
+
+  std::vector<PetscInt>    cols;
+  std::vector<PetscScalar> values;
+  cols.reserve(2*_disp_coeff.size());
+  values.reserve(2*_disp_coeff.size());
+  for(unsigned int k=0; k<_disp_coeff.size(); ++k)
+  {
+    cols.push_back(_disp_node[k]->global_offset());    values.push_back( d*_disp_coeff[k]);
+    cols.push_back(_disp_nb_node[k]->global_offset()); values.push_back(-d*_disp_coeff[k]);
+  }
+  MatSetValues(*jac, 1, &row, cols.size(), &cols[0], &values[0], ADD_VALUES);
+}
+
+
 //---------------------------------------------------------------------------------
 // constructors for each derived class
 //---------------------------------------------------------------------------------
@@ -559,6 +747,7 @@ bool BoundaryCondition::has_flag(const std::string & name) const
 #include "boundary_condition_simplegate.h"
 #include "boundary_condition_homo.h"
 #include "boundary_condition_solderpad.h"
+#include "boundary_condition_periodic.h"
 
 #include "boundary_condition_electrode_interconnect.h"
 #include "boundary_condition_charge_integral.h"
@@ -720,6 +909,13 @@ AbsorbingBC::AbsorbingBC(SimulationSystem  & system, const std::string & label):
 }
 
 
+PeriodicBC::PeriodicBC(SimulationSystem  & system, const std::string & label)
+  : BoundaryCondition(system,label), _pair_mesh_revision(invalid_uint), _raw_mesh_revision(invalid_uint)
+{
+  MESSAGE<<"  Initializing \""<< label <<"\" as Periodic boundary..."<<std::endl; RECORD();
+}
+
+
 //---------------------------------------------------------------------------------
 // the string which indicates the boundary condition
 //---------------------------------------------------------------------------------
@@ -1106,3 +1302,17 @@ std::string AbsorbingBC::boundary_condition_in_string() const
 
   return ss.str();
 }
+
+
+std::string PeriodicBC::boundary_condition_in_string() const
+{
+  std::stringstream ss;
+
+  ss <<"BOUNDARY "
+  <<"string<id>="<<this->label()<<" "
+  <<"enum<type>=Periodic "
+  <<"string<partner>="<<this->partner_label()<<" "
+  <<std::endl;
+
+  return ss.str();
+}
@@ -51,6 +51,7 @@
 #include "boundary_condition_simplegate.h"
 #include "boundary_condition_homo.h"
 #include "boundary_condition_solderpad.h"
+#include "boundary_condition_periodic.h"
 
 #include "boundary_condition_electrode_interconnect.h"
 #include "boundary_condition_charge_integral.h"
@@ -226,6 +227,7 @@ int  BoundaryConditionCollector::bc_setup()
         case IF_Insulator_Semiconductor  :  { if ( Set_BC_InsulatorInterface ( c ) )           return 1; break;}
         case HeteroInterface             :  { if ( Set_BC_HeteroInterface ( c ) )              return 1; break;}
         case AbsorbingBoundary           :  { if ( Set_BC_AbsorbingBoundary ( c ) )            return 1; break;}
+        case PeriodicBoundary            :  { if ( Set_BC_PeriodicBoundary ( c ) )             return 1; break;}
         default:
         {
           MESSAGE<<"ERROR: Unrecognized BOUNDARY "<< bc_string << "." << std::endl;  RECORD();
@@ -282,6 +284,7 @@ int  BoundaryConditionCollector::bc_setup()
         case IF_Insulator_Semiconductor  :  { if( Set_BC_InsulatorInterface(c) )               return 1; break;}
         case ChargedContact              :  { if( Set_BC_ChargedContact(c) )                   return 1; break;}
         case AbsorbingBoundary           :  { if( Set_BC_AbsorbingBoundary(c) )                return 1; break;}
+        case PeriodicBoundary            :  { if( Set_BC_PeriodicBoundary(c) )                 return 1; break;}
         default: break;
       }
     }
@@ -432,6 +435,26 @@ int  BoundaryConditionCollector::bc_setup()
     _bcs[i]->boundary_id() = boundary_id;
   }
 
+  // the partner of periodic boundary should be a region boundary of the same region type
+  for ( unsigned int i=0; i<_bcs.size(); i++ )
+  {
+    if( _bcs[i]->bc_type() != PeriodicBoundary ) continue;
+
+    const PeriodicBC * bc = dynamic_cast<const PeriodicBC *>(_bcs[i]);
+    const BoundaryCondition * partner = this->get_bc(bc->partner_label());
+    if( partner == NULL || partner == bc || partner->bc_type() == PeriodicBoundary ||
+        _boundary_subdomain_map[partner->boundary_id()].second != invalid_uint ||
+        _system.region(_boundary_subdomain_map[partner->boundary_id()].first)->type() !=
+        _system.region(_boundary_subdomain_map[bc->boundary_id()].first)->type() )
+    {
+      MESSAGE<<"ERROR: Partner boundary "<< bc->partner_label() << " of periodic boundary " << bc->label()
+             << " should be a non-periodic boundary face of the same region type."
+             <<std::endl;
+      RECORD();
+      genius_error();
+    }
+  }
+
   // reset boundary id to the nodes in boundary_info class with a priority order
   std::map<short int, unsigned int>  order;
   for ( unsigned int i=0; i<_bcs.size(); i++ )
@@ -543,6 +566,24 @@ int  BoundaryConditionCollector::bc_setup()
 
 
 
+std::vector<short int> BoundaryConditionCollector::periodic_boundary_ids()
+{
+  std::vector<short int> ids;
+  for ( _decks.begin(); !_decks.end(); _decks.next() )
+  {
+    Parser::Card c = _decks.get_current_card();
+    if ( c.key() != "BOUNDARY" || BC_string_to_enum ( c.get_string ( "type", "" ) ) != PeriodicBoundary ) continue;
+
+    // bad labels are reported by Set_BC_PeriodicBoundary
+    short int id = _mesh.boundary_info->get_id_by_label ( c.get_string ( "id", "" ) );
+    short int partner = _mesh.boundary_info->get_id_by_label ( c.get_string ( "partner", "" ) );
+    if ( id != BoundaryInfo::invalid_id )      ids.push_back ( id );
+    if ( partner != BoundaryInfo::invalid_id ) ids.push_back ( partner );
+  }
+  return ids;
+}
+
+
 unsigned int BoundaryConditionCollector::get_bc_from_card(const Parser::Card &c, std::string & Identifier)
 {
   if(c.is_parameter_exist("id"))
@@ -621,6 +662,46 @@ int BoundaryConditionCollector::Set_BC_NeumannBoundary ( const Parser::Card &c )
 
 
 
+int BoundaryConditionCollector::Set_BC_PeriodicBoundary ( const Parser::Card &c )
+{
+  std::string Identifier;
+  unsigned int bc_index = get_bc_from_card ( c, Identifier );
+
+  short int boundary_id = get_bd_id_by_bc_index(bc_index);
+  const std::pair<unsigned int, unsigned int > & sub_ids = _boundary_subdomain_map[boundary_id];
+  if( sub_ids.first == invalid_uint || sub_ids.second != invalid_uint )
+  {
+    MESSAGE<<"ERROR at " <<c.get_fileline()
+           << " Boundary ID="<< Identifier << ", Periodic BC should be set to region boundary face."
+           <<std::endl;
+    RECORD();
+    genius_error();
+    return 1;
+  }
+
+  std::string partner = c.get_string ( "partner", "" );
+  if ( _mesh.boundary_info->get_id_by_label ( partner ) == BoundaryInfo::invalid_id )
+  {
+    MESSAGE<<"ERROR at " <<c.get_fileline()
+           << " Boundary ID="<< Identifier << ", partner boundary "<< partner <<" can't be found in mesh boundaries."
+           <<std::endl;
+    RECORD();
+    genius_error();
+    return 1;
+  }
+
+  // build the boundary condition parameter for this boundary
+  PeriodicBC * bc = new PeriodicBC ( _system, Identifier );
+  bc->partner_label() = partner;
+  bc->T_external()    = c.get_real ( "ext.temp", _system.T_external() /K ) *K;
+  bc->z_width()       = c.get_real ( "z.width", bc->z_width() /um ) *um;
+  _bcs[bc_index] = bc;
+
+  return 0;
+}
+
+
+
 int BoundaryConditionCollector::Set_BC_OhmicContact ( const Parser::Card &c )
 {
   std::string Identifier;
@@ -61,6 +61,9 @@ void InsulatorSemiconductorInterfaceBC::_find_nearest_points_in_gate_region()
   // the nearst nodes <Node *, region>, some of them may not on processor, we must set them as on local later
   std::multimap<Node *, unsigned int> target_nodes;
 
+  // the nearest point of each node
+  std::vector< std::pair<const Node *, NearestPoint> > nearest_points;
+
   // build fast surface locator
   SurfaceLocatorHub & surface_locator = mesh.surface_locator();
 
@@ -109,7 +112,7 @@ void InsulatorSemiconductorInterfaceBC::_find_nearest_points_in_gate_region()
         loc.elem = surface_elem_pair.first;
         loc.side = surface_elem_pair.second;
         loc.p = project_point;
-        _node_nearest_point_map.insert(std::make_pair(nodes[n], loc));
+        nearest_points.push_back(std::make_pair(nodes[n], loc));
 
         Elem * loc_elem = const_cast<Elem *>(loc.elem);
         // save the target nodes
@@ -158,5 +161,36 @@ void InsulatorSemiconductorInterfaceBC::_find_nearest_points_in_gate_region()
     SimulationRegion * region = system.region(*region_it);
     region->rebuild_region_fvm_node_list();
   }
+
+  // build the tunneling path table, which is used by each gate current evaluation
+  _gate_paths.clear();
+  _gate_path_face_nodes.clear();
+  _gate_path_face_weights.clear();
+  for(unsigned int n=0; n<nearest_points.size(); ++n)
+  {
+    const Node * node = nearest_points[n].first;
+    const NearestPoint & loc = nearest_points[n].second;
+
+    GatePath path;
+    path.semiconductor_node = get_region_fvm_node(node, semiconductor_region);
+    path.insulator_node = get_region_fvm_node(node, bc_regions().second);
+    path.bc = loc.bc;
+    path.t = (*node - loc.p).size();
+    path.face_begin = _gate_path_face_nodes.size();
+
+    // the interpolation on gate face is linear to nodal values, record the weight of each face node
+    AutoPtr<Elem> face = loc.elem->build_side(loc.side, false);
+    std::vector<PetscScalar> unit(face->n_nodes(), 0.0);
+    for(unsigned int i=0; i<face->n_nodes(); ++i)
+    {
+      _gate_path_face_nodes.push_back(loc.region->region_fvm_node(face->get_node(i)));
+      unit[i] = 1.0;
+      _gate_path_face_weights.push_back(face->interpolation(unit, loc.p));
+      unit[i] = 0.0;
+    }
+    path.face_end = _gate_path_face_nodes.size();
+
+    _gate_paths.push_back(path);
+  }
 #endif
 }
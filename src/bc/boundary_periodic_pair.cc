@@ -0,0 +1,285 @@
+/********************************************************************************/
+/*     888888    888888888   88     888  88888   888      888    88888888       */
+/*   8       8   8           8 8     8     8      8        8    8               */
+/*  8            8           8  8    8     8      8        8    8               */
+/*  8            888888888   8   8   8     8      8        8     8888888        */
+/*  8      8888  8           8    8  8     8      8        8            8       */
+/*   8       8   8           8     8 8     8      8        8            8       */
+/*     888888    888888888  888     88   88888     88888888     88888888        */
+/*                                                                              */
+/*       A Three-Dimensional General Purpose Semiconductor Simulator.           */
+/*                                                                              */
+/*                                                                              */
+/*  Copyright (C) 2007-2008                                                     */
+/*  Cogenda Pte Ltd                                                             */
+/*                                                                              */
+/*  Please contact Cogenda Pte Ltd for license information                      */
+/*                                                                              */
+/*  Author: Gong Ding   gdiso@ustc.edu                                          */
+/*                                                                              */
+/********************************************************************************/
+#include "mesh_base.h"
+#include "boundary_info.h"
+#include "simulation_system.h"
+#include "simulation_region.h"
+#include "boundary_condition_periodic.h"
+#include "boundary_condition_collector.h"
+#include "parallel.h"
+
+
+// the bounding box of a set of nodes
+static std::pair<Point, Point> _node_bounding_box(const std::set<const Node *> & nodes)
+{
+  Point min(1.e30,   1.e30,  1.e30);
+  Point max(-1.e30, -1.e30, -1.e30);
+
+  std::set<const Node *>::const_iterator it = nodes.begin();
+  for( ; it != nodes.end(); ++it)
+    for (unsigned int i=0; i<3; i++)
+    {
+      min(i) = std::min(min(i), (**it)(i));
+      max(i) = std::max(max(i), (**it)(i));
+    }
+  return std::make_pair(min, max);
+}
+
+
+// match the nodes of this boundary to the nodes on partner boundary
+const std::vector<PeriodicBC::PeriodicPair> & PeriodicBC::raw_periodic_pairs()
+{
+  if( _raw_mesh_revision == system().mesh_revision() ) return _raw_pairs;
+
+  _raw_pairs.clear();
+  _raw_mesh_revision = system().mesh_revision();
+
+  const MeshBase & mesh = system().mesh();
+  const BoundaryCondition * partner = system().get_bcs()->get_bc(_partner_label);
+  genius_assert(partner);
+
+  const SimulationRegion * region = bc_regions().first;
+  const SimulationRegion * partner_region = partner->bc_regions().first;
+  genius_assert(region->type() == partner_region->type());
+
+  // all the nodes on the sides of this boundary and partner boundary
+  std::map<short int, std::set<const Node *> > boundary_side_nodes;
+  mesh.boundary_info->boundary_side_nodes_with_id(boundary_side_nodes);
+  const std::set<const Node *> & side_nodes = boundary_side_nodes[this->boundary_id()];
+  const std::set<const Node *> & partner_side_nodes = boundary_side_nodes[partner->boundary_id()];
+  if( side_nodes.empty() || partner_side_nodes.empty() ) return _raw_pairs;
+
+  // the partner boundary is this boundary translated by the distance of bounding box centers
+  std::pair<Point, Point> box = _node_bounding_box(side_nodes);
+  std::pair<Point, Point> partner_box = _node_bounding_box(partner_side_nodes);
+  Point shift = 0.5*(partner_box.first + partner_box.second) - 0.5*(box.first + box.second);
+
+  Point extent = box.second - box.first;
+  Real tol = 1e-6*std::max(extent.size(), (partner_box.second - partner_box.first).size());
+
+  // sort the partner nodes along the longest direction of this boundary
+  unsigned int axis = 0;
+  for (unsigned int i=1; i<3; i++)
+    if( extent(i) > extent(axis) ) axis = i;
+
+  std::vector< std::pair<Real, const Node *> > partner_nodes;
+  std::set<const Node *>::const_iterator pit = partner_side_nodes.begin();
+  for( ; pit != partner_side_nodes.end(); ++pit)
+    partner_nodes.push_back( std::make_pair((**pit)(axis), *pit) );
+  std::sort(partner_nodes.begin(), partner_nodes.end());
+
+  unsigned int unmatched = 0;
+  BoundaryCondition::const_node_iterator node_it = nodes_begin();
+  for( ; node_it != nodes_end(); ++node_it)
+  {
+    const Node * node = *node_it;
+    if( node->processor_id() != Genius::processor_id() ) continue;
+    Point target = *node + shift;
+
+    const Node * partner_node = NULL;
+    std::vector< std::pair<Real, const Node *> >::const_iterator it =
+      std::lower_bound(partner_nodes.begin(), partner_nodes.end(), std::make_pair(target(axis) - tol, static_cast<const Node *>(NULL)));
+    for( ; it != partner_nodes.end() && (*it).first <= target(axis) + tol; ++it)
+      if( ((*(*it).second) - target).size() <= tol )
+      { partner_node = (*it).second; break; }
+
+    // the partitioner keeps the periodic boundaries on one processor
+    if( partner_node == NULL || partner_node->processor_id() != Genius::processor_id() )
+    { unmatched++; continue; }
+
+    PeriodicPair pair;
+    pair.region = region;
+    pair.slave  = get_region_fvm_node(node, region);
+    pair.master = partner_region->region_fvm_node(partner_node);
+    if( pair.slave == NULL || pair.master == NULL || pair.slave == pair.master ) { unmatched++; continue; }
+
+    _raw_pairs.push_back(pair);
+  }
+
+  Parallel::sum(unmatched);
+  if( unmatched )
+  {
+    MESSAGE<<"ERROR: "<< unmatched <<" nodes of periodic boundary "<< label()
+           <<" have no partner node on boundary " << partner->label() << "." << std::endl;
+    RECORD();
+    genius_error();
+  }
+
+  return _raw_pairs;
+}
+
+
+// replace the master by the final master when it is a slave of other periodic boundary
+const std::vector<PeriodicBC::PeriodicPair> & PeriodicBC::periodic_pairs()
+{
+  if( _pair_mesh_revision == system().mesh_revision() ) return _pairs;
+
+  _pairs = raw_periodic_pairs();
+  _pair_mesh_revision = system().mesh_revision();
+
+  std::map<const FVM_Node *, const FVM_Node *> slave_to_master;
+  BoundaryConditionCollector * bcs = system().get_bcs();
+  for(unsigned int b=0; b<bcs->n_bcs(); ++b)
+  {
+    PeriodicBC * bc = dynamic_cast<PeriodicBC *>(bcs->get_bc(b));
+    if( bc == NULL ) continue;
+
+    const std::vector<PeriodicPair> & pairs = bc->raw_periodic_pairs();
+    for(unsigned int n=0; n<pairs.size(); ++n)
+      slave_to_master[pairs[n].slave] = pairs[n].master;
+  }
+
+  for(unsigned int n=0; n<_pairs.size(); ++n)
+  {
+    for(unsigned int step=0; step<slave_to_master.size(); ++step)
+    {
+      std::map<const FVM_Node *, const FVM_Node *>::const_iterator it = slave_to_master.find(_pairs[n].master);
+      if( it == slave_to_master.end() ) break;
+      _pairs[n].master = (*it).second;
+    }
+    genius_assert(_pairs[n].master != _pairs[n].slave);
+  }
+
+  return _pairs;
+}
+
+
+void PeriodicBC::_periodic_preprocess(PeriodicDofs dofs, std::vector<PetscInt> &src_row,
+                                      std::vector<PetscInt> &dst_row, std::vector<PetscInt> &clear_row)
+{
+  const std::vector<PeriodicPair> & pairs = periodic_pairs();
+  for(unsigned int n=0; n<pairs.size(); ++n)
+  {
+    const FVM_Node * slave  = pairs[n].slave;
+    const FVM_Node * master = pairs[n].master;
+
+    // the equation of slave node is added to master node
+    for(unsigned int i=0; i<dofs(pairs[n].region); ++i)
+    {
+      src_row.push_back(slave->global_offset()+i);
+      dst_row.push_back(master->global_offset()+i);
+      clear_row.push_back(slave->global_offset()+i);
+    }
+  }
+}
+
+
+void PeriodicBC::_periodic_function(PeriodicDofs dofs, PetscScalar *x, Vec f, InsertMode &add_value_flag)
+{
+  // note, we will use ADD_VALUES to set values of vec f
+  // if the previous operator is not ADD_VALUES, we should assembly the vec
+  if( (add_value_flag != ADD_VALUES) && (add_value_flag != NOT_SET_VALUES) )
+  {
+    VecAssemblyBegin(f);
+    VecAssemblyEnd(f);
+  }
+
+  std::vector<PetscInt> iy;
+  std::vector<PetscScalar> y_new;
+
+  const std::vector<PeriodicPair> & pairs = periodic_pairs();
+  for(unsigned int n=0; n<pairs.size(); ++n)
+  {
+    const FVM_Node * slave  = pairs[n].slave;
+    const FVM_Node * master = pairs[n].master;
+
+    // the solution of slave node equals to its master
+    for(unsigned int i=0; i<dofs(pairs[n].region); ++i)
+    {
+      iy.push_back(slave->global_offset()+i);
+      y_new.push_back(x[slave->local_offset()+i] - x[master->local_offset()+i]);
+    }
+  }
+
+  if( iy.size() )
+    VecSetValues(f, iy.size(), &(iy[0]), &(y_new[0]), ADD_VALUES);
+
+  add_value_flag = ADD_VALUES;
+}
+
+
+void PeriodicBC::_periodic_jacobian_reserve(PeriodicDofs dofs, Mat *jac, InsertMode &add_value_flag)
+{
+  // since we will use ADD_VALUES operat, check the matrix state.
+  if( (add_value_flag != ADD_VALUES) && (add_value_flag != NOT_SET_VALUES) )
+  {
+    MatAssemblyBegin(*jac, MAT_FLUSH_ASSEMBLY);
+    MatAssemblyEnd(*jac, MAT_FLUSH_ASSEMBLY);
+  }
+
+  const std::vector<PeriodicPair> & pairs = periodic_pairs();
+  for(unsigned int n=0; n<pairs.size(); ++n)
+  {
+    const FVM_Node * slave  = pairs[n].slave;
+    const FVM_Node * master = pairs[n].master;
+    const unsigned int n_dofs = dofs(pairs[n].region);
+
+    // master rows get the pattern of slave rows
+    std::vector<PetscInt> rows, cols;
+    for(unsigned int i=0; i<n_dofs; ++i)
+    {
+      rows.push_back(master->global_offset()+i);
+      cols.push_back(slave->global_offset()+i);
+    }
+
+    FVM_Node::fvm_neighbor_node_iterator  nb_it = slave->neighbor_node_begin();
+    for(; nb_it != slave->neighbor_node_end(); ++nb_it)
+      for(unsigned int i=0; i<n_dofs; ++i)
+        cols.push_back((*nb_it).first->global_offset()+i);
+
+    std::vector<PetscScalar> value(rows.size()*cols.size(), 0);
+    MatSetValues(*jac, rows.size(), &rows[0], cols.size(), &cols[0], &value[0], ADD_VALUES);
+
+    // slave rows couple to master
+    for(unsigned int i=0; i<n_dofs; ++i)
+      MatSetValue(*jac, slave->global_offset()+i, master->global_offset()+i, 0, ADD_VALUES);
+  }
+
+  // the last operator is ADD_VALUES
+  add_value_flag = ADD_VALUES;
+}
+
+
+void PeriodicBC::_periodic_jacobian(PeriodicDofs dofs, Mat *jac, InsertMode &add_value_flag)
+{
+  // since we will use ADD_VALUES operat, check the matrix state.
+  if( (add_value_flag != ADD_VALUES) && (add_value_flag != NOT_SET_VALUES) )
+  {
+    MatAssemblyBegin(*jac, MAT_FLUSH_ASSEMBLY);
+    MatAssemblyEnd(*jac, MAT_FLUSH_ASSEMBLY);
+  }
+
+  const std::vector<PeriodicPair> & pairs = periodic_pairs();
+  for(unsigned int n=0; n<pairs.size(); ++n)
+  {
+    const FVM_Node * slave  = pairs[n].slave;
+    const FVM_Node * master = pairs[n].master;
+
+    for(unsigned int i=0; i<dofs(pairs[n].region); ++i)
+    {
+      MatSetValue(*jac, slave->global_offset()+i, slave->global_offset()+i,  1.0, ADD_VALUES);
+      MatSetValue(*jac, slave->global_offset()+i, master->global_offset()+i, -1.0, ADD_VALUES);
+    }
+  }
+
+  // the last operator is ADD_VALUES
+  add_value_flag = ADD_VALUES;
+}
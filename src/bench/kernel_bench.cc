@@ -0,0 +1,651 @@
+/********************************************************************************/
+/*     888888    888888888   88     888  88888   888      888    88888888       */
+/*   8       8   8           8 8     8     8      8        8    8               */
+/*  8            8           8  8    8     8      8        8    8               */
+/*  8            888888888   8   8   8     8      8        8     8888888        */
+/*  8      8888  8           8    8  8     8      8        8            8       */
+/*   8       8   8           8     8 8     8      8        8            8       */
+/*     888888    888888888  888     88   88888     88888888     88888888        */
+/*                                                                              */
+/*       A Three-Dimensional General Purpose Semiconductor Simulator.           */
+/*                                                                              */
+/*                                                                              */
+/*  Copyright (C) 2007-2008                                                     */
+/*  Cogenda Pte Ltd                                                             */
+/*                                                                              */
+/*  Please contact Cogenda Pte Ltd for license information                      */
+/*                                                                              */
+/*  Author: Gong Ding   gdiso@ustc.edu                                          */
+/*                                                                              */
+/********************************************************************************/
+
+// micro-benchmark of the hot inner kernels: SG edge flux, fermi integrals and
+// the band structure / mobility PMIs of Si. no mesh, no PETSc solve.
+
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <iostream>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <new>
+
+#ifdef WINDOWS
+  #include <Windows.h>
+  #undef max
+  #undef min
+  #define LDFUN GetProcAddress
+#else
+  #include <dlfcn.h>
+  #include <sys/time.h>
+  #define LDFUN dlsym
+#endif
+
+#include "genius_common.h"
+#include "genius_env.h"
+#include "physical_unit.h"
+#include "PMI.h"
+#include "jflux1.h"
+#include "jflux2.h"
+#include "jflux3.h"
+#include "jflux_batch.h"
+
+using PhysicalUnit::kb;
+using PhysicalUnit::e;
+using PhysicalUnit::V;
+using PhysicalUnit::K;
+using PhysicalUnit::cm;
+
+#ifdef WINDOWS
+  typedef HINSTANCE  LibraryHandle;
+#else
+  typedef void *     LibraryHandle;
+#endif
+
+
+//------------------------------------------------------------------------------
+// options and results
+
+static unsigned int n_samples = 1<<16;   // inputs per kernel
+static unsigned int n_repeat  = 7;       // timed passes over the inputs, best and median are reported
+static unsigned int n_ad      = 6;       // active AD directions, 2 nodes x (V,n,p) as DDM1 edge
+static std::vector<std::string> filters; // only run kernels whose name contains one of them
+
+struct BenchResult
+{
+  std::string name;
+  double best;     // ns per evaluation
+  double median;   // ns per evaluation
+  double allocs;   // heap allocations per evaluation
+  double checksum;
+};
+
+static std::vector<BenchResult> results;
+
+// sink of kernel results, keeps the compiler from removing the kernel call
+static volatile double sink;
+
+
+//------------------------------------------------------------------------------
+// count the heap allocations, a kernel in the assembly loop should not allocate
+
+static size_t n_allocs = 0;
+
+void * operator new(std::size_t size) throw(std::bad_alloc)
+{
+  ++n_allocs;
+  void * p = malloc(size ? size : 1);
+  if( !p ) throw std::bad_alloc();
+  return p;
+}
+
+void * operator new[](std::size_t size) throw(std::bad_alloc)
+{
+  ++n_allocs;
+  void * p = malloc(size ? size : 1);
+  if( !p ) throw std::bad_alloc();
+  return p;
+}
+
+void operator delete(void * p) throw()
+{ free(p); }
+
+void operator delete[](void * p) throw()
+{ free(p); }
+
+
+static double wall_time()
+{
+#ifdef WINDOWS
+  return static_cast<double>(GetTickCount())*1e-3;
+#else
+  struct timeval tnow;
+  gettimeofday (&tnow, NULL);
+  return static_cast<double>(tnow.tv_sec) + static_cast<double>(tnow.tv_usec)*1.e-6;
+#endif
+}
+
+
+static bool selected(const std::string &name)
+{
+  if( filters.empty() ) return true;
+  for(unsigned int i=0; i<filters.size(); ++i)
+    if( name.find(filters[i]) != std::string::npos ) return true;
+  return false;
+}
+
+
+/**
+ * time \p kernel over all the samples, \p kernel(i) returns the value of sample i
+ */
+template <typename Kernel>
+static void run(const std::string &name, Kernel kernel)
+{
+  if( !selected(name) ) return;
+
+  // warm up, also counts the allocations
+  double sum = 0.0;
+  size_t allocs = n_allocs;
+  for(unsigned int i=0; i<n_samples; ++i)
+    sum += kernel(i);
+  allocs = n_allocs - allocs;
+
+  std::vector<double> t(n_repeat);
+  for(unsigned int r=0; r<n_repeat; ++r)
+  {
+    double s = 0.0;
+    double t0 = wall_time();
+    for(unsigned int i=0; i<n_samples; ++i)
+      s += kernel(i);
+    t[r] = (wall_time() - t0)*1e9/n_samples;
+    sink = s;
+  }
+  std::sort(t.begin(), t.end());
+
+  BenchResult res;
+  res.name = name;
+  res.best = t.front();
+  res.median = t[t.size()/2];
+  res.allocs = static_cast<double>(allocs)/n_samples;
+  res.checksum = sum;
+  results.push_back(res);
+
+  std::cout << "  " << std::left << std::setw(36) << name << std::right
+            << std::setw(12) << std::fixed << std::setprecision(2) << res.best
+            << std::setw(12) << res.median
+            << std::setw(10) << res.allocs
+            << std::setw(20) << std::scientific << std::setprecision(6) << res.checksum << '\n';
+}
+
+
+//------------------------------------------------------------------------------
+// input distributions, generated with a fixed seed so the runs are reproducible
+
+class Random
+{
+public:
+  Random(unsigned long seed) : _s(seed) {}
+
+  // uniform in [0,1)
+  double uniform()
+  {
+    _s = _s*6364136223846793005ULL + 1442695040888963407ULL;
+    return static_cast<double>(_s >> 11)*(1.0/9007199254740992.0);
+  }
+
+  double uniform(double a, double b) { return a + (b-a)*uniform(); }
+
+  // log-uniform in [a,b]
+  double log_uniform(double a, double b) { return a*std::exp(std::log(b/a)*uniform()); }
+
+  // approximate standard normal, Irwin-Hall with 12 terms
+  double normal()
+  {
+    double s = 0.0;
+    for(int i=0; i<12; ++i) s += uniform();
+    return s - 6.0;
+  }
+
+private:
+  unsigned long long _s;
+};
+
+
+/**
+ * node and edge variables as seen by the assembly of a device:
+ * doping spans 1e14~1e20 cm^-3 log-uniform with random type, the carrier of the
+ * minority side is set by n*p = ni^2 exp(injection), injection up to 10 kT.
+ * the potential drop along an edge is mostly within a few kT with a 10% tail up to
+ * 40 kT (junctions, contacts), edge length is 1nm~1um log-uniform.
+ * fields are 1e2~1e6 V/cm log-uniform, lattice temperature 300K +- 20K.
+ * all values are in the internal unit system.
+ */
+struct Samples
+{
+  std::vector<PetscScalar> Na, Nd;
+  std::vector<PetscScalar> n1, n2, p1, p2;
+  std::vector<PetscScalar> T1, T2, Tn1, Tn2;
+  std::vector<PetscScalar> dV, h;
+  std::vector<PetscScalar> Ep, Et;
+  std::vector<PetscScalar> eta;  // argument of fermi integrals
+
+  void generate(unsigned int size)
+  {
+    Random rnd(20120901);
+    Na.resize(size); Nd.resize(size);
+    n1.resize(size); n2.resize(size); p1.resize(size); p2.resize(size);
+    T1.resize(size); T2.resize(size); Tn1.resize(size); Tn2.resize(size);
+    dV.resize(size); h.resize(size);
+    Ep.resize(size); Et.resize(size);
+    eta.resize(size);
+
+    const PetscScalar ni = 1e10*std::pow(cm, -3);
+    for(unsigned int i=0; i<size; ++i)
+    {
+      PetscScalar N  = rnd.log_uniform(1e14, 1e20)*std::pow(cm, -3);
+      PetscScalar N2 = rnd.log_uniform(1e14, 1e20)*std::pow(cm, -3);
+      bool ptype = rnd.uniform() < 0.5;
+      Na[i] = ptype ? N : 0.1*N2;
+      Nd[i] = ptype ? 0.1*N2 : N;
+
+      PetscScalar inj1 = std::exp(rnd.uniform(0.0, 10.0));
+      PetscScalar inj2 = std::exp(rnd.uniform(0.0, 10.0));
+      PetscScalar maj1 = N, maj2 = N*rnd.log_uniform(0.1, 10.0);
+      n1[i] = ptype ? ni*ni/maj1*inj1 : maj1;
+      p1[i] = ptype ? maj1 : ni*ni/maj1*inj1;
+      n2[i] = ptype ? ni*ni/maj2*inj2 : maj2;
+      p2[i] = ptype ? maj2 : ni*ni/maj2*inj2;
+
+      T1[i] = std::max(250.0, std::min(450.0, 300.0 + 20.0*rnd.normal()))*K;
+      T2[i] = T1[i] + rnd.uniform(-1.0, 1.0)*K;
+      Tn1[i] = T1[i] + rnd.log_uniform(1e-3, 2000.0)*K;
+      Tn2[i] = T1[i] + rnd.log_uniform(1e-3, 2000.0)*K;
+
+      PetscScalar Vt = kb*T1[i]/e;
+      if( rnd.uniform() < 0.9 )
+        dV[i] = 2.0*rnd.normal()*Vt;
+      else
+        dV[i] = rnd.uniform(-40.0, 40.0)*Vt;
+      h[i] = rnd.log_uniform(1e-7, 1e-4)*cm;
+
+      Ep[i] = rnd.log_uniform(1e2, 1e6)*V/cm;
+      Et[i] = rnd.log_uniform(1e2, 1e6)*V/cm;
+
+      eta[i] = rnd.uniform(-12.0, 8.0);
+    }
+  }
+};
+
+static Samples S;
+
+
+//------------------------------------------------------------------------------
+// AD helpers, the independent variables are seeded as the assembly does
+
+static inline AutoDScalar ad(PetscScalar v, unsigned int dir)
+{
+  AutoDScalar x(v);
+  if( dir < AutoDScalar::numdir ) x.setADValue(dir, 1.0);
+  return x;
+}
+
+// sum of value and derivatives, so the derivative computation is not dead code
+static inline double ad_sum(const AutoDScalar &x)
+{
+  double s = x.getValue();
+  for(unsigned int k=0; k<AutoDScalar::numdir; ++k)
+    s += x.getADValue(k);
+  return s;
+}
+
+
+//------------------------------------------------------------------------------
+// kernels
+
+struct BernKernel
+{ double operator() (unsigned int i) const { const double Vt = kb*S.T1[i]/e; return bern(S.dV[i]/Vt); } };
+
+struct Aux1Kernel
+{ double operator() (unsigned int i) const { const double Vt = kb*S.T1[i]/e; return aux1(S.dV[i]/(2*Vt)); } };
+
+struct Aux2Kernel
+{ double operator() (unsigned int i) const { const double Vt = kb*S.T1[i]/e; return aux2(S.dV[i]/(2*Vt)); } };
+
+struct BernADKernel
+{ double operator() (unsigned int i) const { const double Vt = kb*S.T1[i]/e; return ad_sum(bern(ad(S.dV[i], 0)/Vt)); } };
+
+// jflux1, the form used by the DDM edge assembly
+struct InDDKernel
+{ double operator() (unsigned int i) const { return In_dd(kb*S.T1[i]/e, S.dV[i], S.n1[i], S.n2[i], S.h[i]); } };
+
+struct IpDDKernel
+{ double operator() (unsigned int i) const { return Ip_dd(kb*S.T1[i]/e, S.dV[i], S.p1[i], S.p2[i], S.h[i]); } };
+
+struct InDDADKernel
+{
+  double operator() (unsigned int i) const
+  {
+    AutoDScalar V1 = ad(0.0, 0), V2 = ad(S.dV[i], 3);
+    AutoDScalar n1 = ad(S.n1[i], 1), n2 = ad(S.n2[i], 4);
+    return ad_sum(In_dd(kb*S.T1[i]/e, V2-V1, n1, n2, S.h[i]));
+  }
+};
+
+struct IpDDADKernel
+{
+  double operator() (unsigned int i) const
+  {
+    AutoDScalar V1 = ad(0.0, 0), V2 = ad(S.dV[i], 3);
+    AutoDScalar p1 = ad(S.p1[i], 2), p2 = ad(S.p2[i], 5);
+    return ad_sum(Ip_dd(kb*S.T1[i]/e, V2-V1, p1, p2, S.h[i]));
+  }
+};
+
+// branchless Bernoulli and flux with explicit derivatives of jflux_batch.h
+struct BernNBKernel
+{ double operator() (unsigned int i) const { const double Vt = kb*S.T1[i]/e; double b, db; bern_nb(S.dV[i]/Vt, b, db); return b+db; } };
+
+struct InDDGradADKernel
+{
+  double operator() (unsigned int i) const
+  {
+    AutoDScalar V1 = ad(0.0, 0), V2 = ad(S.dV[i], 3);
+    AutoDScalar n1 = ad(S.n1[i], 1), n2 = ad(S.n2[i], 4);
+    return ad_sum(In_dd_grad(kb*S.T1[i]/e, V2-V1, n1, n2, S.h[i]));
+  }
+};
+
+// jflux1, the midpoint form with separate potentials
+struct InDDMidKernel
+{ double operator() (unsigned int i) const { return In_dd(kb*S.T1[i]/e, 0.0, S.dV[i], S.n1[i], S.n2[i], S.h[i]); } };
+
+struct InDDMidADKernel
+{
+  double operator() (unsigned int i) const
+  {
+    AutoDScalar V1 = ad(0.0, 0), V2 = ad(S.dV[i], 3);
+    AutoDScalar n1 = ad(S.n1[i], 1), n2 = ad(S.n2[i], 4);
+    return ad_sum(In_dd(kb*S.T1[i]/e, V1, V2, n1, n2, S.h[i]));
+  }
+};
+
+// jflux2, lattice temperature
+struct InLTKernel
+{ double operator() (unsigned int i) const { return In_lt(kb, e, -S.dV[i], S.n1[i], S.n2[i], 0.5*(S.T1[i]+S.T2[i]), S.T2[i]-S.T1[i], S.h[i]); } };
+
+struct InLTADKernel
+{
+  double operator() (unsigned int i) const
+  {
+    AutoDScalar V1 = ad(0.0, 0), V2 = ad(S.dV[i], 4);
+    AutoDScalar n1 = ad(S.n1[i], 1), n2 = ad(S.n2[i], 5);
+    AutoDScalar T1 = ad(S.T1[i], 3), T2 = ad(S.T2[i], 7);
+    return ad_sum(In_lt(kb, e, V1-V2, n1, n2, 0.5*(T1+T2), T2-T1, S.h[i]));
+  }
+};
+
+// jflux3, energy balance
+struct InEBKernel
+{ double operator() (unsigned int i) const { return In_eb(kb, e, 0.0, S.dV[i], S.n1[i], S.n2[i], S.Tn1[i], S.Tn2[i], S.h[i]); } };
+
+struct InEBADKernel
+{
+  double operator() (unsigned int i) const
+  {
+    AutoDScalar V1 = ad(0.0, 0), V2 = ad(S.dV[i], 6);
+    AutoDScalar n1 = ad(S.n1[i], 1), n2 = ad(S.n2[i], 7);
+    AutoDScalar Tn1 = ad(S.Tn1[i], 4), Tn2 = ad(S.Tn2[i], 10);
+    return ad_sum(In_eb(kb, e, V1, V2, n1, n2, Tn1, Tn2, S.h[i]));
+  }
+};
+
+// fermi integrals
+struct FermiHalfKernel
+{ double operator() (unsigned int i) const { return fermi_half(S.eta[i]); } };
+
+struct FermiMHalfKernel
+{ double operator() (unsigned int i) const { return fermi_mhalf(S.eta[i]); } };
+
+struct InvFermiHalfKernel
+{ double operator() (unsigned int i) const { return inv_fermi_half(fermi_half(S.eta[i])); } };
+
+struct FermiHalfADKernel
+{ double operator() (unsigned int i) const { return ad_sum(fermi_half(ad(S.eta[i], 0))); } };
+
+
+//------------------------------------------------------------------------------
+// PMI kernels, the PMI reads doping from its fake doping environment
+
+struct MobKernel
+{
+  PMIS_Mobility *mob;
+  double operator() (unsigned int i) const
+  {
+    mob->SetFakeDopingEnvironment(S.Na[i], S.Nd[i]);
+    return mob->ElecMob(S.p1[i], S.n1[i], S.T1[i], S.Ep[i], S.Et[i], S.T1[i]) +
+           mob->HoleMob(S.p1[i], S.n1[i], S.T1[i], S.Ep[i], S.Et[i], S.T1[i]);
+  }
+};
+
+struct MobADKernel
+{
+  PMIS_Mobility *mob;
+  double operator() (unsigned int i) const
+  {
+    mob->SetFakeDopingEnvironment(S.Na[i], S.Nd[i]);
+    AutoDScalar p = ad(S.p1[i], 2), n = ad(S.n1[i], 1), T = ad(S.T1[i], 3);
+    AutoDScalar Ep = ad(S.Ep[i], 0), Et = ad(S.Et[i], 4);
+    return ad_sum(mob->ElecMob(p, n, T, Ep, Et, T)) + ad_sum(mob->HoleMob(p, n, T, Ep, Et, T));
+  }
+};
+
+struct BandKernel
+{
+  PMIS_BandStructure *band;
+  double operator() (unsigned int i) const
+  {
+    band->SetFakeDopingEnvironment(S.Na[i], S.Nd[i]);
+    return band->Eg(S.T1[i]) + band->EgNarrow(S.p1[i], S.n1[i], S.T1[i]) + band->nie(S.p1[i], S.n1[i], S.T1[i]);
+  }
+};
+
+struct BandADKernel
+{
+  PMIS_BandStructure *band;
+  double operator() (unsigned int i) const
+  {
+    band->SetFakeDopingEnvironment(S.Na[i], S.Nd[i]);
+    AutoDScalar p = ad(S.p1[i], 2), n = ad(S.n1[i], 1), T = ad(S.T1[i], 3);
+    return ad_sum(band->Eg(T)) + ad_sum(band->EgNarrow(p, n, T)) + ad_sum(band->nie(p, n, T));
+  }
+};
+
+struct RecombKernel
+{
+  PMIS_BandStructure *band;
+  double operator() (unsigned int i) const
+  {
+    band->SetFakeDopingEnvironment(S.Na[i], S.Nd[i]);
+    return band->Recomb(S.p1[i], S.n1[i], S.T1[i]);
+  }
+};
+
+
+/**
+ * open the material library as Material::MaterialBase::load_material does
+ */
+static LibraryHandle open_material(const std::string &material)
+{
+#ifdef WINDOWS
+  std::string filename =  Genius::genius_dir() + "\\lib\\lib" + material + ".dll";
+  LibraryHandle dll = LoadLibrary(filename.c_str());
+#else
+  std::string filename =  Genius::genius_dir() + "/lib/lib" + material + ".so";
+#ifdef RTLD_DEEPBIND
+  LibraryHandle dll = dlopen(filename.c_str(), RTLD_LAZY|RTLD_DEEPBIND);
+#else
+  LibraryHandle dll = dlopen(filename.c_str(), RTLD_LAZY);
+#endif
+#endif
+  if( !dll )
+    std::cerr << "Open material file " << filename << " error, PMI kernels of " << material << " skipped.\n";
+  return dll;
+}
+
+
+static void run_pmi(const std::string &material)
+{
+  LibraryHandle dll = open_material(material);
+  if( !dll ) return;
+
+  // the library keeps its own AD direction number
+  void (*set_ad_num)(const unsigned int) = (void (*)(const unsigned int))LDFUN(dll, "set_ad_number");
+  if( set_ad_num ) set_ad_num(n_ad);
+
+  PMI_Environment env(PhysicalUnit::m, PhysicalUnit::s, PhysicalUnit::V, PhysicalUnit::C, PhysicalUnit::K);
+
+  const char * mob_models[]  = { "Philips", "Lombardi", "Analytic", "Constant", 0 };
+  const char * band_models[] = { "BandStructure_Default", "BandStructure_Schenk", 0 };
+
+  for(int k=0; mob_models[k]; ++k)
+  {
+    std::string fun = "PMIS_" + material + "_Mob_" + mob_models[k];
+    PMIS_Mobility* (*wmob) (const PMI_Environment& env) = (PMIS_Mobility* (*) (const PMI_Environment& env))LDFUN(dll, fun.c_str());
+    if( !wmob ) continue;
+
+    MobKernel mk; mk.mob = wmob(env);
+    MobADKernel mak; mak.mob = mk.mob;
+    run(material + "_mob_" + mob_models[k], mk);
+    run(material + "_mob_" + mob_models[k] + "/AD", mak);
+    delete mk.mob;
+  }
+
+  for(int k=0; band_models[k]; ++k)
+  {
+    std::string fun = "PMIS_" + material + "_" + band_models[k];
+    PMIS_BandStructure* (*wband) (const PMI_Environment& env) = (PMIS_BandStructure* (*) (const PMI_Environment& env))LDFUN(dll, fun.c_str());
+    if( !wband ) continue;
+
+    std::string name = material + (k==0 ? "_band_default" : "_band_schenk");
+    BandKernel bk; bk.band = wband(env);
+    BandADKernel bak; bak.band = bk.band;
+    RecombKernel rk; rk.band = bk.band;
+    run(name, bk);
+    run(name + "/AD", bak);
+    run(name + "_recomb", rk);
+    delete bk.band;
+  }
+}
+
+
+static void write_json(const std::string &filename)
+{
+  std::ofstream out(filename.c_str());
+  out << "{\n";
+  out << "  \"samples\": " << n_samples << ",\n";
+  out << "  \"repeat\": " << n_repeat << ",\n";
+  out << "  \"ad_directions\": " << n_ad << ",\n";
+  out << "  \"kernels\": [\n";
+  for(unsigned int i=0; i<results.size(); ++i)
+  {
+    out << "    { \"kernel\": \"" << results[i].name << "\""
+        << ", \"best_ns\": " << results[i].best
+        << ", \"median_ns\": " << results[i].median
+        << ", \"allocs_per_eval\": " << results[i].allocs
+        << ", \"checksum\": " << std::setprecision(12) << results[i].checksum << " }"
+        << (i+1 < results.size() ? "," : "") << '\n';
+  }
+  out << "  ]\n";
+  out << "}\n";
+}
+
+
+void printusage()
+{
+  std::cout<<"Usage: genius_kernel_bench [-n samples] [-r repeat] [-d ad_directions] [-m material] [-k kernel] [-o output]\n";
+  std::cout<<"Options\n";
+  std::cout<<"  -h\t\tDisplay this help\n";
+  std::cout<<"  -n\t\tNumber of input samples of each kernel, default is 65536\n";
+  std::cout<<"  -r\t\tNumber of timed passes, default is 7\n";
+  std::cout<<"  -d\t\tNumber of active AD directions, default is 6\n";
+  std::cout<<"  -m\t\tMaterial of PMI kernels, default is Si, can be repeated\n";
+  std::cout<<"  -k\t\tOnly run kernels whose name contains the string, can be repeated\n";
+  std::cout<<"  -o\t\tWrite the results to a JSON file\n";
+}
+
+
+/**
+ * a small tool for timing the inner kernels of assembly
+ */
+int main(int argc, char **argv)
+{
+  std::vector<std::string> materials;
+  std::string output_file;
+
+  for(int i=1; i<argc; ++i)
+  {
+    std::string opt(argv[i]);
+    if( opt == "-h" ) { printusage(); return 0; }
+    if( i+1 >= argc ) { printusage(); return 1; }
+    if     ( opt == "-n" ) n_samples = std::max(1, atoi(argv[++i]));
+    else if( opt == "-r" ) n_repeat  = std::max(1, atoi(argv[++i]));
+    else if( opt == "-d" ) n_ad      = std::min(ADTL_NUMBER_DIRECTIONS, std::max(1, atoi(argv[++i])));
+    else if( opt == "-m" ) materials.push_back(argv[++i]);
+    else if( opt == "-k" ) filters.push_back(argv[++i]);
+    else if( opt == "-o" ) output_file = argv[++i];
+    else { printusage(); return 1; }
+  }
+  if( materials.empty() ) materials.push_back("Si");
+
+  if( getenv("GENIUS_DIR") )
+    Genius::set_genius_dir(getenv("GENIUS_DIR"));
+  else
+    std::cerr << "GENIUS_DIR is not set, PMI kernels skipped.\n";
+
+  // the same unit system as SimulationSystem
+  PhysicalUnit::set_unit( std::pow(1e18,1.0/3.0) );
+  AutoDScalar::numdir = n_ad;
+
+  S.generate(n_samples);
+
+  std::cout << "  samples " << n_samples << ", repeat " << n_repeat << ", AD directions " << n_ad << "\n\n";
+  std::cout << "  " << std::left << std::setw(36) << "kernel" << std::right
+            << std::setw(12) << "best(ns)" << std::setw(12) << "median(ns)" << std::setw(10) << "allocs" << std::setw(20) << "checksum" << '\n';
+
+  run("bern",            BernKernel());
+  run("bern/AD",         BernADKernel());
+  run("aux1",            Aux1Kernel());
+  run("aux2",            Aux2Kernel());
+  run("In_dd",           InDDKernel());
+  run("In_dd/AD",        InDDADKernel());
+  run("Ip_dd",           IpDDKernel());
+  run("Ip_dd/AD",        IpDDADKernel());
+  run("bern_nb",         BernNBKernel());
+  run("In_dd_grad/AD",   InDDGradADKernel());
+  run("In_dd_mid",       InDDMidKernel());
+  run("In_dd_mid/AD",    InDDMidADKernel());
+  run("In_lt",           InLTKernel());
+  run("In_lt/AD",        InLTADKernel());
+  run("In_eb",           InEBKernel());
+  run("In_eb/AD",        InEBADKernel());
+  run("fermi_half",      FermiHalfKernel());
+  run("fermi_half/AD",   FermiHalfADKernel());
+  run("fermi_mhalf",     FermiMHalfKernel());
+  run("inv_fermi_half",  InvFermiHalfKernel());
+
+  if( !Genius::genius_dir().empty() )
+    for(unsigned int m=0; m<materials.size(); ++m)
+      run_pmi(materials[m]);
+
+  if( !output_file.empty() )
+  {
+    write_json(output_file);
+    std::cout << "\n  results are written to " << output_file << '\n';
+  }
+
+  return 0;
+}
@@ -0,0 +1,554 @@
+/********************************************************************************/
+/*     888888    888888888   88     888  88888   888      888    88888888       */
+/*   8       8   8           8 8     8     8      8        8    8               */
+/*  8            8           8  8    8     8      8        8    8               */
+/*  8            888888888   8   8   8     8      8        8     8888888        */
+/*  8      8888  8           8    8  8     8      8        8            8       */
+/*   8       8   8           8     8 8     8      8        8            8       */
+/*     888888    888888888  888     88   88888     88888888     88888888        */
+/*                                                                              */
+/*       A Three-Dimensional General Purpose Semiconductor Simulator.           */
+/*                                                                              */
+/*                                                                              */
+/*  Copyright (C) 2007-2008                                                     */
+/*  Cogenda Pte Ltd                                                             */
+/*                                                                              */
+/*  Please contact Cogenda Pte Ltd for license information                      */
+/*                                                                              */
+/*  Author: Gong Ding   gdiso@ustc.edu                                          */
+/*                                                                              */
+/********************************************************************************/
+
+// offline benchmark of linear solver configurations on jacobian matrices dumped by
+// FVM_NonlinearSolver::dump_matrix_petsc. the matrices are grouped by device family,
+// the fastest configuration which solves all the matrices of a family is recommended.
+
+#include <cstdlib>
+#include <cmath>
+#include <iostream>
+#include <fstream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <map>
+#include <algorithm>
+
+#include "genius_petsc.h"
+#include "genius_env.h"
+#include "parallel.h"
+#include "enum_petsc_type.h"
+#include "klu_factor.h"
+#include "mat_analysis.h"
+
+
+//------------------------------------------------------------------------------
+// options and results
+
+static unsigned int n_repeat = 3;        // timed solves of each configuration, the best is reported
+static PetscReal    rtol     = 1e-8;     // relative tolerance of iterative solvers
+static PetscInt     max_its  = 1000;     // max iterations of iterative solvers
+static PetscReal    robust_residual = 1e-6;   // max relative true residual of a successful solve
+static std::vector<std::string> filters; // only run configurations whose name contains one of them
+
+/**
+ * a linear solver configuration, in the enums the SOLVE command uses
+ */
+struct SolverConfig
+{
+  const char *                      name;
+  SolverSpecify::LinearSolverType   ls;
+  SolverSpecify::PreconditionerType pc;
+  const char *                      ordering;  // ordering of PETSc LU, 0 for default
+};
+
+static const SolverConfig configs[] =
+{
+  { "lu/nd",           SolverSpecify::LU,       SolverSpecify::LU_PRECOND,      MATORDERINGND },
+  { "lu/rcm",          SolverSpecify::LU,       SolverSpecify::LU_PRECOND,      MATORDERINGRCM },
+  { "lu/qmd",          SolverSpecify::LU,       SolverSpecify::LU_PRECOND,      MATORDERINGQMD },
+  { "klu",             SolverSpecify::KLU,      SolverSpecify::LU_PRECOND,      0 },
+  { "mumps",           SolverSpecify::MUMPS,    SolverSpecify::LU_PRECOND,      0 },
+  { "superlu",         SolverSpecify::SuperLU,  SolverSpecify::LU_PRECOND,      0 },
+  { "superlu_dist",    SolverSpecify::SuperLU_DIST, SolverSpecify::LU_PRECOND,  0 },
+  { "umfpack",         SolverSpecify::UMFPACK,  SolverSpecify::LU_PRECOND,      0 },
+  { "pastix",          SolverSpecify::PASTIX,   SolverSpecify::LU_PRECOND,      0 },
+  { "gmres/asm",       SolverSpecify::GMRES,    SolverSpecify::ASM_PRECOND,     0 },
+  { "gmres/asmilu1",   SolverSpecify::GMRES,    SolverSpecify::ASMILU1_PRECOND, 0 },
+  { "gmres/asmilu2",   SolverSpecify::GMRES,    SolverSpecify::ASMILU2_PRECOND, 0 },
+  { "gmres/ilu",       SolverSpecify::GMRES,    SolverSpecify::ILU_PRECOND,     0 },
+  { "gmres/bjacobi",   SolverSpecify::GMRES,    SolverSpecify::BLOCK_JACOBI_PRECOND, 0 },
+  { "bcgsl/asm",       SolverSpecify::BCGSL,    SolverSpecify::ASM_PRECOND,     0 },
+  { "bcgsl/asmilu1",   SolverSpecify::BCGSL,    SolverSpecify::ASMILU1_PRECOND, 0 },
+  { "bcgsl/ilu",       SolverSpecify::BCGSL,    SolverSpecify::ILU_PRECOND,     0 },
+  { "tfqmr/ilu",       SolverSpecify::TFQMR,    SolverSpecify::ILU_PRECOND,     0 },
+  { "fgmres/amg",      SolverSpecify::FGMRES,   SolverSpecify::BOOMERAMG_PRECOND, 0 },
+  { "gmres/gamg",      SolverSpecify::GMRES,    SolverSpecify::GAMG_PRECOND,    0 },
+  { 0,                 SolverSpecify::INVALID_LINEAR_SOLVER, SolverSpecify::INVALID_PRECONDITIONER, 0 }
+};
+
+
+struct BenchMatrix
+{
+  std::string family;
+  std::string file;
+  Mat         A;
+  MatAnalysisInfo info;
+};
+
+struct BenchResult
+{
+  unsigned int matrix;
+  unsigned int config;
+  bool         success;
+  double       setup;     // setup (factorization) time in second, best of the repeats
+  double       solve;     // solve time in second, best of the repeats
+  PetscInt     its;
+  PetscReal    residual;  // relative true residual |b-Ax|/|b|
+  double       memory;    // resident memory increased by the solver in MB
+  std::string  reason;
+};
+
+static std::vector<BenchMatrix> matrices;
+static std::vector<BenchResult> results;
+
+
+static bool selected(const std::string &name)
+{
+  if( filters.empty() ) return true;
+  for(unsigned int i=0; i<filters.size(); ++i)
+    if( name.find(filters[i]) != std::string::npos ) return true;
+  return false;
+}
+
+
+/**
+ * the family of a matrix given as family=file, or the directory the file is in
+ */
+static void parse_matrix_arg(const std::string &arg, std::string &family, std::string &file)
+{
+  std::string::size_type eq = arg.find('=');
+  if( eq != std::string::npos )
+  {
+    family = arg.substr(0, eq);
+    file = arg.substr(eq+1);
+    return;
+  }
+
+  file = arg;
+  std::string::size_type slash = arg.find_last_of("/\\");
+  if( slash == std::string::npos || slash == 0 ) { family = "default"; return; }
+  std::string dir = arg.substr(0, slash);
+  std::string::size_type slash2 = dir.find_last_of("/\\");
+  family = (slash2 == std::string::npos) ? dir : dir.substr(slash2+1);
+}
+
+
+static PetscErrorCode load_matrix(const std::string &file, Mat *A)
+{
+  PetscErrorCode ierr;
+  PetscViewer viewer;
+  ierr = PetscViewerBinaryOpen(PETSC_COMM_WORLD, file.c_str(), FILE_MODE_READ, &viewer); if(ierr) return ierr;
+#if PETSC_VERSION_GE(3,2,0)
+  ierr = MatCreate(PETSC_COMM_WORLD, A); if(ierr) return ierr;
+  ierr = MatSetType(*A, MATAIJ); if(ierr) return ierr;
+  ierr = MatLoad(*A, viewer);
+#else
+  ierr = MatLoad(viewer, MATAIJ, A);
+#endif
+  PetscViewerDestroy(PetscDestroyObject(viewer));
+  return ierr;
+}
+
+
+/**
+ * set the KSP and PC as FVM_NonlinearSolver does for the linear solver and preconditioner types,
+ * @return nonzero when the configuration is not available
+ */
+static PetscErrorCode set_solver(KSP ksp, const SolverConfig &config)
+{
+  PetscErrorCode ierr;
+  PC pc;
+  ierr = KSPGetPC(ksp, &pc); if(ierr) return ierr;
+
+  switch(config.ls)
+  {
+    case SolverSpecify::KLU:
+      if( Genius::n_processors() > 1 ) return 1;
+      ierr = KSPSetType(ksp, (char*) KSPPREONLY); if(ierr) return ierr;
+      KLUFactor::set_pc_shell(pc, true);
+      return 0;
+    case SolverSpecify::LU:
+    case SolverSpecify::MUMPS:
+    case SolverSpecify::SuperLU:
+    case SolverSpecify::SuperLU_DIST:
+    case SolverSpecify::UMFPACK:
+    case SolverSpecify::PASTIX:
+    {
+      ierr = KSPSetType(ksp, (char*) KSPPREONLY); if(ierr) return ierr;
+      ierr = PCSetType(pc, (char*) PCLU); if(ierr) return ierr;
+      const char * package = 0;
+      switch(config.ls)
+      {
+        case SolverSpecify::LU           : if( Genius::n_processors() > 1 ) return 1; break;
+        case SolverSpecify::MUMPS        : package = "mumps"; break;
+        case SolverSpecify::SuperLU      : if( Genius::n_processors() > 1 ) return 1; package = "superlu"; break;
+        case SolverSpecify::SuperLU_DIST : package = "superlu_dist"; break;
+        case SolverSpecify::UMFPACK      : if( Genius::n_processors() > 1 ) return 1; package = "umfpack"; break;
+        case SolverSpecify::PASTIX       : package = "pastix"; break;
+        default: break;
+      }
+      if( package ) { ierr = PCFactorSetMatSolverPackage(pc, package); if(ierr) return ierr; }
+      if( config.ordering ) { ierr = PCFactorSetMatOrderingType(pc, config.ordering); if(ierr) return ierr; }
+      // the jacobian may have zero diagonals
+      ierr = PCFactorSetShiftType(pc, MAT_SHIFT_NONZERO);
+      return ierr;
+    }
+    case SolverSpecify::GMRES   : ierr = KSPSetType(ksp, (char*) KSPGMRES);  if(!ierr) ierr = KSPGMRESSetRestart(ksp, 60); break;
+    case SolverSpecify::FGMRES  : ierr = KSPSetType(ksp, (char*) KSPFGMRES); if(!ierr) ierr = KSPGMRESSetRestart(ksp, 60); break;
+    case SolverSpecify::BCGSL   : ierr = KSPSetType(ksp, (char*) KSPBCGSL);  break;
+    case SolverSpecify::TFQMR   : ierr = KSPSetType(ksp, (char*) KSPTFQMR);  break;
+    default : return 1;
+  }
+  if(ierr) return ierr;
+
+  ierr = KSPSetTolerances(ksp, rtol, 1e-30, PETSC_DEFAULT, max_its); if(ierr) return ierr;
+
+  switch(config.pc)
+  {
+    case SolverSpecify::ASM_PRECOND          : ierr = PCSetType(pc, (char*) PCASM); break;
+    case SolverSpecify::BLOCK_JACOBI_PRECOND : ierr = PCSetType(pc, (char*) PCBJACOBI); break;
+    case SolverSpecify::ILU_PRECOND          : ierr = PCSetType(pc, (char*) PCILU); break;
+    case SolverSpecify::GAMG_PRECOND         : ierr = PCSetType(pc, (char*) PCGAMG); break;
+    case SolverSpecify::BOOMERAMG_PRECOND    :
+#ifdef PETSC_HAVE_HYPRE
+      ierr = PCSetType(pc, (char*) PCHYPRE); if(ierr) return ierr;
+      ierr = PCHYPRESetType(pc, "boomeramg"); break;
+#else
+      return 1;
+#endif
+    case SolverSpecify::ASMILU1_PRECOND      :
+    case SolverSpecify::ASMILU2_PRECOND      :
+    {
+      // sub ilu levels by options with the prefix of this ksp
+      ierr = PCSetType(pc, (char*) PCASM); if(ierr) return ierr;
+      ierr = PetscOptionsSetValue("-bench_sub_pc_type", "ilu"); if(ierr) return ierr;
+      ierr = PetscOptionsSetValue("-bench_sub_pc_factor_levels", config.pc == SolverSpecify::ASMILU1_PRECOND ? "1" : "2"); if(ierr) return ierr;
+      break;
+    }
+    default : return 1;
+  }
+  return ierr;
+}
+
+
+static void clear_solver_options()
+{
+  PetscOptionsClearValue("-bench_sub_pc_type");
+  PetscOptionsClearValue("-bench_sub_pc_factor_levels");
+}
+
+
+/**
+ * solve A x = b with b = A*1 by \p config, n_repeat times
+ */
+static void run(unsigned int m, unsigned int c)
+{
+  const SolverConfig &config = configs[c];
+  Mat A = matrices[m].A;
+
+  BenchResult res;
+  res.matrix = m;
+  res.config = c;
+  res.success = false;
+  res.setup = res.solve = 1e30;
+  res.its = 0;
+  res.residual = 1e30;
+  res.memory = 0.0;
+
+  Vec x, b, r;
+  MatGetVecs(A, &x, &b);
+  VecDuplicate(b, &r);
+  VecSet(x, 1.0);
+  MatMult(A, x, b);
+  PetscReal bnorm;
+  VecNorm(b, NORM_2, &bnorm);
+  if( bnorm == 0.0 ) bnorm = 1.0;
+
+  for(unsigned int k=0; k<n_repeat; ++k)
+  {
+    PetscLogDouble mem0, mem1;
+    PetscMemoryGetCurrentUsage(&mem0);
+
+    KSP ksp;
+    KSPCreate(PETSC_COMM_WORLD, &ksp);
+    KSPSetOptionsPrefix(ksp, "bench_");
+    KSPSetOperators(ksp, A, A, SAME_NONZERO_PATTERN);
+
+    PetscErrorCode ierr = set_solver(ksp, config);
+    const bool available = !ierr;
+    if(!ierr) ierr = KSPSetFromOptions(ksp);
+
+    double t0 = MPI_Wtime();
+    if(!ierr) ierr = KSPSetUp(ksp);
+    double t1 = MPI_Wtime();
+    if(!ierr)
+    {
+      VecZeroEntries(x);
+      ierr = KSPSolve(ksp, b, x);
+    }
+    double t2 = MPI_Wtime();
+
+    PetscMemoryGetCurrentUsage(&mem1);
+    Parallel::sum(mem0);
+    Parallel::sum(mem1);
+
+    if( ierr )
+    {
+      // zero pivot of factorization and breakdown of setup are failures of the configuration
+      res.reason = available ? "error" : "unavailable";
+      KSPDestroy(PetscDestroyObject(ksp));
+      clear_solver_options();
+      break;
+    }
+
+    KSPConvergedReason reason;
+    KSPGetConvergedReason(ksp, &reason);
+    KSPGetIterationNumber(ksp, &res.its);
+    res.reason = KSPConvergedReasons[reason];
+
+    // true residual
+    MatMult(A, x, r);
+    VecAYPX(r, -1.0, b);
+    PetscReal rnorm;
+    VecNorm(r, NORM_2, &rnorm);
+
+    res.residual = rnorm/bnorm;
+    res.success = reason > 0 && res.residual < robust_residual;
+    res.setup = std::min(res.setup, t1-t0);
+    res.solve = std::min(res.solve, t2-t1);
+    res.memory = std::max(res.memory, (mem1-mem0)/1048576.0);
+
+    KSPDestroy(PetscDestroyObject(ksp));
+    clear_solver_options();
+
+    // failed solve is not repeated
+    if( !res.success ) break;
+  }
+
+  VecDestroy(PetscDestroyObject(x));
+  VecDestroy(PetscDestroyObject(b));
+  VecDestroy(PetscDestroyObject(r));
+
+  results.push_back(res);
+
+  if( Genius::is_first_processor() )
+  {
+    std::cout << "  " << std::left << std::setw(18) << config.name << std::right;
+    if( res.reason == "unavailable" || res.reason == "error" )
+      std::cout << "  " << res.reason << '\n';
+    else
+      std::cout << std::setw(12) << std::fixed << std::setprecision(4) << res.setup
+                << std::setw(12) << res.solve
+                << std::setw(8)  << res.its
+                << std::setw(14) << std::scientific << std::setprecision(3) << res.residual
+                << std::setw(10) << std::fixed << std::setprecision(1) << res.memory
+                << "  " << (res.success ? "" : "FAILED ") << res.reason << '\n';
+  }
+}
+
+
+/**
+ * the fastest configuration which solves all the matrices of each family
+ */
+static void recommend(std::map<std::string, std::string> &best_config)
+{
+  std::map<std::string, std::vector<unsigned int> > family_matrices;
+  for(unsigned int m=0; m<matrices.size(); ++m)
+    family_matrices[matrices[m].family].push_back(m);
+
+  if( Genius::is_first_processor() )
+    std::cout << "\n  recommended configurations\n";
+
+  std::map<std::string, std::vector<unsigned int> >::const_iterator it = family_matrices.begin();
+  for(; it!=family_matrices.end(); ++it)
+  {
+    const std::vector<unsigned int> & ms = it->second;
+
+    // total time of each configuration, negative when it fails on any matrix
+    std::map<unsigned int, double> total;
+    std::map<unsigned int, unsigned int> n_solved;
+    for(unsigned int i=0; i<results.size(); ++i)
+    {
+      if( std::find(ms.begin(), ms.end(), results[i].matrix) == ms.end() ) continue;
+      if( !results[i].success ) { total[results[i].config] = -1.0; continue; }
+      if( total.count(results[i].config) && total[results[i].config] < 0 ) continue;
+      total[results[i].config] += results[i].setup + results[i].solve;
+      n_solved[results[i].config]++;
+    }
+
+    int best = -1;
+    std::map<unsigned int, double>::const_iterator c = total.begin();
+    for(; c!=total.end(); ++c)
+    {
+      if( c->second < 0 || n_solved[c->first] != ms.size() ) continue;
+      if( best < 0 || c->second < total[best] ) best = c->first;
+    }
+
+    best_config[it->first] = best < 0 ? "" : configs[best].name;
+    if( Genius::is_first_processor() )
+    {
+      std::cout << "  " << std::left << std::setw(24) << it->first << std::right << std::setw(4) << ms.size() << " matrices  ";
+      if( best < 0 ) std::cout << "no configuration solves all the matrices\n";
+      else std::cout << std::setw(18) << configs[best].name << std::setw(12) << std::fixed << std::setprecision(4) << total[best] << " s\n";
+    }
+  }
+}
+
+
+static void write_json(const std::string &filename, const std::map<std::string, std::string> &best_config)
+{
+  if( !Genius::is_first_processor() ) return;
+
+  std::ofstream out(filename.c_str());
+  out << "{\n";
+  out << "  \"processors\": " << Genius::n_processors() << ",\n";
+  out << "  \"repeat\": " << n_repeat << ",\n";
+  out << "  \"rtol\": " << rtol << ",\n";
+  out << "  \"matrices\": [\n";
+  for(unsigned int m=0; m<matrices.size(); ++m)
+  {
+    const MatAnalysisInfo & info = matrices[m].info;
+    out << "    { \"family\": \"" << matrices[m].family << "\", \"file\": \"" << matrices[m].file << "\""
+        << ", \"rows\": " << info.M << ", \"nnz\": " << info.nnz
+        << ", \"unsymmetric_rate\": " << info.unsymmetric_rate
+        << ", \"zero_diagonal_rows\": " << info.zero_diagonal_rows
+        << ", \"weak_diagonal_rows\": " << info.weak_diagonal_rows << " }"
+        << (m+1 < matrices.size() ? "," : "") << '\n';
+  }
+  out << "  ],\n";
+  out << "  \"results\": [\n";
+  for(unsigned int i=0; i<results.size(); ++i)
+  {
+    const BenchResult & res = results[i];
+    out << "    { \"matrix\": " << res.matrix << ", \"config\": \"" << configs[res.config].name << "\""
+        << ", \"success\": " << (res.success ? "true" : "false")
+        << ", \"setup_s\": " << res.setup << ", \"solve_s\": " << res.solve
+        << ", \"its\": " << res.its << ", \"residual\": " << res.residual
+        << ", \"memory_mb\": " << res.memory << ", \"reason\": \"" << res.reason << "\" }"
+        << (i+1 < results.size() ? "," : "") << '\n';
+  }
+  out << "  ],\n";
+  out << "  \"recommended\": {";
+  std::map<std::string, std::string>::const_iterator it = best_config.begin();
+  for(; it!=best_config.end(); ++it)
+    out << (it==best_config.begin() ? " " : ", ") << "\"" << it->first << "\": \"" << it->second << "\"";
+  out << " }\n";
+  out << "}\n";
+}
+
+
+void printusage()
+{
+  std::cout<<"Usage: genius_solver_bench [-r repeat] [-t rtol] [-i max_its] [-c config] [-o output] [family=]matrix ...\n";
+  std::cout<<"Options\n";
+  std::cout<<"  -h\t\tDisplay this help\n";
+  std::cout<<"  -r\t\tNumber of timed solves, default is 3\n";
+  std::cout<<"  -t\t\tRelative tolerance of iterative solvers, default is 1e-8\n";
+  std::cout<<"  -i\t\tMax iterations of iterative solvers, default is 1000\n";
+  std::cout<<"  -c\t\tOnly run configurations whose name contains the string, can be repeated\n";
+  std::cout<<"  -o\t\tWrite the results to a JSON file\n";
+  std::cout<<"Matrices are PETSc binary files written by dump_matrix_petsc, the family is the\n";
+  std::cout<<"directory name of the file when it is not given\n";
+}
+
+
+/**
+ * a tool for choosing the linear solver by a library of jacobian matrices
+ */
+int main(int argc, char **argv)
+{
+  std::vector<std::string> args(argv+1, argv+argc);
+
+  Genius::init_processors(&argc, &argv);
+
+  std::string output_file;
+  for(unsigned int i=0; i<args.size(); ++i)
+  {
+    const std::string & opt = args[i];
+    if( opt == "-h" ) { if( Genius::is_first_processor() ) printusage(); Genius::clean_processors(); return 0; }
+    if( opt[0] != '-' )
+    {
+      BenchMatrix bm;
+      parse_matrix_arg(opt, bm.family, bm.file);
+      matrices.push_back(bm);
+      continue;
+    }
+    if( i+1 >= args.size() ) break;
+    if     ( opt == "-r" ) n_repeat = std::max(1, atoi(args[++i].c_str()));
+    else if( opt == "-t" ) rtol     = atof(args[++i].c_str());
+    else if( opt == "-i" ) max_its  = std::max(1, atoi(args[++i].c_str()));
+    else if( opt == "-c" ) filters.push_back(args[++i]);
+    else if( opt == "-o" ) output_file = args[++i];
+    // others are PETSc options
+  }
+
+  if( matrices.empty() )
+  {
+    if( Genius::is_first_processor() ) printusage();
+    Genius::clean_processors();
+    return 1;
+  }
+
+  // a configuration which is not available returns an error code, it should not abort the run
+  PetscPushErrorHandler(PetscIgnoreErrorHandler, PETSC_NULL);
+
+  for(unsigned int m=0; m<matrices.size(); ++m)
+  {
+    BenchMatrix & bm = matrices[m];
+    if( load_matrix(bm.file, &bm.A) )
+    {
+      if( Genius::is_first_processor() )
+        std::cerr << "Load matrix " << bm.file << " error, skipped.\n";
+      matrices.erase(matrices.begin()+m);
+      --m;
+      continue;
+    }
+    mat_analysis(bm.A, bm.info);
+  }
+
+  for(unsigned int m=0; m<matrices.size(); ++m)
+  {
+    const MatAnalysisInfo & info = matrices[m].info;
+    if( Genius::is_first_processor() )
+    {
+      std::cout << "\n  " << matrices[m].file << " (" << matrices[m].family << "), " << info.M << " rows, " << info.nnz << " nonzeros, "
+                << "unsymmetric rate " << std::setprecision(3) << info.unsymmetric_rate << ", "
+                << info.zero_diagonal_rows << " zero diagonals, " << info.weak_diagonal_rows << " weak diagonals\n";
+      std::cout << "  " << std::left << std::setw(18) << "config" << std::right
+                << std::setw(12) << "setup(s)" << std::setw(12) << "solve(s)" << std::setw(8) << "its"
+                << std::setw(14) << "residual" << std::setw(10) << "mem(MB)" << '\n';
+    }
+
+    for(unsigned int c=0; configs[c].name; ++c)
+      if( selected(configs[c].name) )
+        run(m, c);
+  }
+
+  std::map<std::string, std::string> best_config;
+  recommend(best_config);
+
+  if( !output_file.empty() )
+  {
+    write_json(output_file, best_config);
+    if( Genius::is_first_processor() )
+      std::cout << "\n  results are written to " << output_file << '\n';
+  }
+
+  PetscPopErrorHandler();
+
+  for(unsigned int m=0; m<matrices.size(); ++m)
+    MatDestroy(PetscDestroyObject(matrices[m].A));
+
+  Genius::clean_processors();
+  return 0;
+}
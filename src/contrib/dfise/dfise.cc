@@ -29,6 +29,7 @@
 #include <fstream>
 
 #include "dfise_block.h"
+#include "dfise_scan.h"
 #include "dfise.h"
 
 #include "config.h"
@@ -91,6 +92,15 @@ namespace DFISE
     //parse dataset file
     if(parse_dfise_dataset_file(data_file)) return 1;
 
+    assert(data_info.dimension   == grid_info.dimension);
+    assert(data_info.nb_vertices == grid_info.nb_vertices);
+    assert(data_info.nb_edges    == grid_info.nb_edges);
+    assert(data_info.nb_faces    == grid_info.nb_faces);
+    assert(data_info.nb_elements == grid_info.nb_elements);
+    assert(data_info.nb_regions  == grid_info.nb_regions);
+
+    build_dataset_index();
+
     return 0;
   }
 
@@ -123,6 +133,25 @@ namespace DFISE
 
 
 
+  void DFISE_MESH::parse_file(const std::string & file, BLOCK * block)
+  {
+    {
+      SCANNER scanner;
+      assert( scanner.open(file) );
+      if( scanner.parse(block) ) return;
+      std::cout<<"  Warning: " << file << " " << scanner.error() << ", retry with DF-ISE parser."<< std::endl;
+      block->clear();
+    }
+
+    yyin = fopen(file.c_str(), "r");
+    assert( yyin != NULL );
+    assert(!yyparse(block));
+    fclose(yyin);
+    YY_FLUSH_BUFFER;
+  }
+
+
+
   int DFISE_MESH::parse_dfise_grid_file(const std::string & grid_file)
   {
     std::cout<<"  Reading DF-ISE grid file " << grid_file << "..."<< std::endl;
@@ -130,11 +159,7 @@ namespace DFISE
     // top block
     BLOCK *block= new BLOCK;
 
-    yyin = fopen(grid_file.c_str(), "r");
-    assert( yyin != NULL );
-    assert(!yyparse(block));
-    fclose(yyin);
-    YY_FLUSH_BUFFER;
+    parse_file(grid_file, block);
 
     for(unsigned int n=0; n<block->n_sub_blocks(); ++n)
     {
@@ -410,11 +435,7 @@ namespace DFISE
 
     BLOCK *block = new BLOCK;
 
-    yyin = fopen(dataset_file.c_str(), "r");
-    assert( yyin != NULL );
-    assert(!yyparse(block));
-    fclose(yyin);
-    YY_FLUSH_BUFFER;
+    parse_file(dataset_file, block);
 
     for(unsigned int n=0; n<block->n_sub_blocks(); ++n)
     {
@@ -445,13 +466,6 @@ namespace DFISE
     data_info.nb_elements  = (block->get_int_parameter("nb_elements", 0));
     data_info.nb_regions   = (block->get_int_parameter("nb_regions", 0));
 
-    assert(data_info.dimension   == grid_info.dimension);
-    assert(data_info.nb_vertices == grid_info.nb_vertices);
-    assert(data_info.nb_edges    == grid_info.nb_edges);
-    assert(data_info.nb_faces    == grid_info.nb_faces);
-    assert(data_info.nb_elements == grid_info.nb_elements);
-    assert(data_info.nb_regions  == grid_info.nb_regions);
-
     unsigned int datasets  = block->n_values_in_parameter("datasets");
     unsigned int functions = block->n_values_in_parameter("functions");
     assert(datasets == functions);
@@ -480,16 +494,10 @@ namespace DFISE
       dataset->dimension= dataset_block->get_int_parameter("dimension",0);
       dataset->location=DATASET::location_string_to_enum(dataset_block->get_string_parameter("location",0));
 
+      // region index is set by build_dataset_index
       int n_validity = dataset_block->n_values_in_parameter("validity");
       for(int i=0; i<n_validity; ++i)
-      {
-        std::string region = fix_region_name(dataset_block->get_string_parameter("validity", i));
-        int region_index = grid_info.fieldregion_index_by_label(region);
-        assert(region_index>=0);
-
-        dataset->validity.push_back(region);
-        dataset->Regions.push_back(static_cast<unsigned int>(region_index));
-      }
+        dataset->validity.push_back(fix_region_name(dataset_block->get_string_parameter("validity", i)));
 
       //read data
       if(dataset->type==DATASET::scalar)
@@ -497,8 +505,11 @@ namespace DFISE
         BLOCK * Values = dataset_block->get_sub_block("Values");
         dataset->n_data = Values->index();
         assert(Values->n_values()==dataset->n_data);
-        for(unsigned int i=0; i<dataset->n_data; ++i)
-          dataset->Scalar_Values.push_back(Values->get_float_value(i));
+        if(!Values->_numbers.empty())
+          dataset->Scalar_Values = Values->_numbers;
+        else
+          for(unsigned int i=0; i<dataset->n_data; ++i)
+            dataset->Scalar_Values.push_back(Values->get_float_value(i));
       }
 
       //
@@ -520,32 +531,53 @@ namespace DFISE
         }
       }
 
-      // build dataset value -> grid vertex map
-      //dataset->node_to_value_index_vector.resize(dataset->n_data);
-      std::set<unsigned int> node_set;
-      for(unsigned int r=0; r<grid_info.nb_regions; ++r)
+      data_sets.push_back(dataset);
+    }
+  }
+
+
+  void DFISE_MESH::build_dataset_index()
+  {
+    // datasets valid in the same regions share the vertex list
+    std::map< std::vector<std::string>, std::vector<unsigned int> > vertex_cache;
+
+    for(unsigned int n=0; n<data_sets.size(); ++n)
+    {
+      DATASET * dataset = data_sets[n];
+
+      dataset->Regions.clear();
+      for(unsigned int i=0; i<dataset->validity.size(); ++i)
       {
-        if(!dataset->is_valid(grid_info.region_label(r))) continue;
+        int region_index = grid_info.fieldregion_index_by_label(dataset->validity[i]);
+        assert(region_index>=0);
+        dataset->Regions.push_back(static_cast<unsigned int>(region_index));
+      }
 
-        for(unsigned int e=0; e<grid.region_elements[r].size(); ++e)
+      // build dataset value -> grid vertex map, value index is the order of vertex index
+      std::map< std::vector<std::string>, std::vector<unsigned int> >::iterator cache_it = vertex_cache.find(dataset->validity);
+      if( cache_it == vertex_cache.end() )
+      {
+        std::vector<char> in_region(grid.Vertices.size(), 0);
+        for(unsigned int r=0; r<grid_info.nb_regions; ++r)
         {
-          unsigned int elem_id = grid.region_elements[r][e];
-          const  Element & elem = grid.Elements[elem_id];
+          if(!dataset->is_valid(grid_info.region_label(r))) continue;
 
-          for(unsigned int m=0; m<elem.vertices.size(); ++m)
+          for(unsigned int e=0; e<grid.region_elements[r].size(); ++e)
           {
-            unsigned int id = elem.vertices[m];
-            node_set.insert(id);
+            const  Element & elem = grid.Elements[grid.region_elements[r][e]];
+            for(unsigned int m=0; m<elem.vertices.size(); ++m)
+              in_region[elem.vertices[m]] = 1;
           }
         }
-      }
 
-      for(std::set<unsigned int>::iterator it=node_set.begin(); it!=node_set.end(); ++it)
-          dataset->node_to_value_index_map.insert(std::make_pair(*it, dataset->node_to_value_index_map.size()));
+        std::vector<unsigned int> vertices;
+        for(unsigned int v=0; v<in_region.size(); ++v)
+          if(in_region[v]) vertices.push_back(v);
+        cache_it = vertex_cache.insert(std::make_pair(dataset->validity, vertices)).first;
+      }
 
+      dataset->set_node_to_value_index(cache_it->second);
       assert(dataset->node_to_value_index_map.size() == dataset->n_data);
-
-      data_sets.push_back(dataset);
     }
   }
 
@@ -62,6 +62,25 @@ namespace DFISE
      */
     int parse_dfise(const std::string & file);
 
+    /**
+     * read grid file only
+     */
+    int parse_dfise_grid(const std::string & file)
+    { return parse_dfise_grid_file(file + ".grd"); }
+
+    /**
+     * read dataset file only. it does not need the grid, so it can be read
+     * on another processor at the same time. call build_dataset_index() later
+     * where the grid is
+     */
+    int parse_dfise_dataset(const std::string & file)
+    { return parse_dfise_dataset_file(file + ".dat"); }
+
+    /**
+     * set region index and node to value index map of all the datasets from the grid
+     */
+    void build_dataset_index();
+
     /**
      * write dfise file
      */
@@ -209,6 +228,11 @@ namespace DFISE
 
     int parse_dfise_dataset_file(const std::string & dataset_file);
 
+    /**
+     * read file into block tree, by SCANNER, or by the bison parser when SCANNER fails
+     */
+    void parse_file(const std::string & file, BLOCK * block);
+
     void read_grid_info(BLOCK *);
 
     void read_grid_data(BLOCK *);
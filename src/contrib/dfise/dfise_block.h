@@ -25,10 +25,12 @@
 #define __dfise_block_h__
 
 #include <cassert>
+#include <cmath>
 
 #include <map>
 #include <vector>
 #include <string>
+#include <iostream>
 
 
 namespace DFISE
@@ -93,6 +95,35 @@ namespace DFISE
         _values.push_back(new_value[n]);
     }
 
+    /**
+     * add a number to values. numbers are kept in _numbers without TOKEN
+     * as long as the block has no string value
+     */
+    void add_number(double d)
+    {
+      if(_values.empty())
+      {
+        _numbers.push_back(d);
+        return;
+      }
+      _values.push_back(number_token(d));
+    }
+
+    /**
+     * add a string value, the numbers before it are converted to TOKEN to keep the order
+     */
+    void add_string_value(const std::string & str)
+    {
+      for(unsigned int n=0; n<_numbers.size(); ++n)
+        _values.push_back(number_token(_numbers[n]));
+      _numbers.clear();
+
+      TOKEN * token = new TOKEN;
+      token->token_type = TOKEN::string_token;
+      token->value = new std::string(str);
+      _values.push_back(token);
+    }
+
     void add_sub_block(BLOCK * sub_block)
     { _sub_blocks.push_back(sub_block); }
 
@@ -105,6 +136,9 @@ namespace DFISE
       for(unsigned int n=0; n<block._values.size(); ++n)
         _values.push_back(block._values[n]);
 
+      for(unsigned int n=0; n<block._numbers.size(); ++n)
+        add_number(block._numbers[n]);
+
       for(unsigned int n=0; n<block._sub_blocks.size(); ++n)
         _sub_blocks.push_back(block._sub_blocks[n]);
     }
@@ -120,6 +154,7 @@ namespace DFISE
       _parameters.clear();
 
       clear(_values);
+      _numbers.clear();
 
       for(unsigned int n=0; n<_sub_blocks.size(); ++n)
       {
@@ -133,7 +168,7 @@ namespace DFISE
     {
       std::cout<<_keyword<<std::endl;
       std::cout<<" parameters:"<< _parameters.size() <<std::endl;
-      std::cout<<" values:"<< _values.size() <<std::endl;
+      std::cout<<" values:"<< n_values() <<std::endl;
       std::cout<<" sub blocks:"<< _sub_blocks.size() <<std::endl;
       for(unsigned int n=0; n<_sub_blocks.size(); ++n)
         _sub_blocks[n]->print();
@@ -184,7 +219,7 @@ namespace DFISE
      */
     unsigned int n_values() const
     {
-      return _values.size();
+      return _values.size() + _numbers.size();
     }
 
     /**
@@ -227,6 +262,7 @@ namespace DFISE
 
     std::string get_string_value(unsigned int i)
     {
+      assert(_numbers.empty());
       assert(i<_values.size());
       assert(_values[i]->token_type == TOKEN::string_token);
       return *(std::string*)_values[i]->value;
@@ -234,6 +270,12 @@ namespace DFISE
 
     int get_int_value(unsigned int i)
     {
+      if(!_numbers.empty())
+      {
+        assert(i<_numbers.size());
+        assert(_numbers[i] == std::floor(_numbers[i]));
+        return static_cast<int>(_numbers[i]);
+      }
       assert(i<_values.size());
       assert(_values[i]->token_type == TOKEN::int_token);
       return *(int*)_values[i]->value;
@@ -241,6 +283,11 @@ namespace DFISE
 
     double get_float_value(unsigned int i)
     {
+      if(!_numbers.empty())
+      {
+        assert(i<_numbers.size());
+        return _numbers[i];
+      }
       assert(i<_values.size());
       assert(_values[i]->token_type == TOKEN::int_token || _values[i]->token_type == TOKEN::float_token);
       if(_values[i]->token_type == TOKEN::int_token)
@@ -275,11 +322,35 @@ namespace DFISE
      */
     std::vector<TOKEN *>  _values;
 
+    /**
+     * the individual values when they are all numbers, i.e. Vertices, Elements and Values
+     */
+    std::vector<double>   _numbers;
+
     /**
      * the sub blocks
      */
     std::vector<BLOCK *> _sub_blocks;
 
+    /**
+     * int token when d is an integer in int range, float token otherwise, as the lexer does
+     */
+    static TOKEN * number_token(double d)
+    {
+      TOKEN * token = new TOKEN;
+      if( d == std::floor(d) && std::fabs(d) < 2147483647.0 )
+      {
+        token->token_type = TOKEN::int_token;
+        token->value = new int(static_cast<int>(d));
+      }
+      else
+      {
+        token->token_type = TOKEN::float_token;
+        token->value = new double(d);
+      }
+      return token;
+    }
+
     /**
      * free tokens and the value in tokens!
      */
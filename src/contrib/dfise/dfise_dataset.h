@@ -73,6 +73,29 @@ namespace DFISE
       return Scalar_Values[node_to_value_index_map.find(node_index)->second];
     }
 
+    /**
+     * set node_to_value_index_map, the ith value is on the ith vertex of the sorted \p vertices
+     */
+    void set_node_to_value_index(const std::vector<unsigned int> & vertices)
+    {
+      node_to_value_index_map.clear();
+      // insert at the end is constant time
+      for(unsigned int v=0; v<vertices.size(); ++v)
+        node_to_value_index_map.insert(node_to_value_index_map.end(), std::make_pair(vertices[v], v));
+    }
+
+    /**
+     * @return the vertices of node_to_value_index_map in value order
+     */
+    std::vector<unsigned int> value_vertices() const
+    {
+      std::vector<unsigned int> vertices(node_to_value_index_map.size());
+      std::map<unsigned int, unsigned int>::const_iterator it = node_to_value_index_map.begin();
+      for(; it!=node_to_value_index_map.end(); ++it)
+        vertices[it->second] = it->first;
+      return vertices;
+    }
+
     /**
      * output
      */
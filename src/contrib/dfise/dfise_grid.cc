@@ -286,7 +286,7 @@ namespace DFISE
     for(unsigned int m=0; m<face3_nodes.size(); ++m)
     {
       for(unsigned int n=0; n<face4_nodes.size(); ++n)
-        if( _edge_set.find(std::make_pair(face3_nodes[m], face4_nodes[n])) != _edge_set.end())
+        if( _edge_set.find(edge_key(face3_nodes[m], face4_nodes[n])) != _edge_set.end())
         {
           elem.vertices.push_back(face4_nodes[n]);
         }
@@ -308,7 +308,7 @@ namespace DFISE
     for(unsigned int m=0; m<face4_nodes.size(); ++m)
     {
       for(unsigned int n=0; n<face5_nodes.size(); ++n)
-        if( _edge_set.find(std::make_pair(face4_nodes[m], face5_nodes[n])) != _edge_set.end())
+        if( _edge_set.find(edge_key(face4_nodes[m], face5_nodes[n])) != _edge_set.end())
         {
           elem.vertices.push_back(face5_nodes[n]);
         }
@@ -21,7 +21,17 @@
 
 
 #include <vector>
-#include <set>
+#include <algorithm>
+
+#include "config.h"
+
+#if defined(HAVE_TR1_UNORDERED_SET)
+# include <tr1/unordered_set>
+#elif defined(HAVE_TR1_UNORDERED_SET_WITH_STD_HEADER) || defined(HAVE_UNORDERED_SET)
+# include <unordered_set>
+#else
+# include <set>
+#endif
 
 
 
@@ -136,7 +146,7 @@ namespace DFISE
     void add_edge(const std::pair<int, int> & edge)
     {
       Edges.push_back(edge);
-      _edge_set.insert(edge);
+      _edge_set.insert(edge_key(edge.first, edge.second));
     }
 
 
@@ -195,23 +205,22 @@ namespace DFISE
   private:
 
     /**
-     * the '<' operator used in set/map key
+     * direction free key of edge (n1, n2)
      */
-    struct _lt_pair_int
+    static unsigned long long edge_key(int n1, int n2)
     {
-      bool operator()(const std::pair<int, int> &e1, const std::pair<int, int> &e2) const
-      {
-        int e1_min = std::min(e1.first, e1.second);
-        int e1_max = std::max(e1.first, e1.second);
-        int e2_min = std::min(e2.first, e2.second);
-        int e2_max = std::max(e2.first, e2.second);
-
-        if( e1_min != e2_min ) return e1_min < e2_min;
-        return e1_max < e2_max;
-      }
-    };
-
-    std::set< std::pair<int, int>,  _lt_pair_int> _edge_set;
+      unsigned long long lo = static_cast<unsigned int>(std::min(n1, n2));
+      unsigned long long hi = static_cast<unsigned int>(std::max(n1, n2));
+      return (hi << 32) | lo;
+    }
+
+#if defined(HAVE_TR1_UNORDERED_SET)
+    std::tr1::unordered_set<unsigned long long> _edge_set;
+#elif defined(HAVE_TR1_UNORDERED_SET_WITH_STD_HEADER) || defined(HAVE_UNORDERED_SET)
+    std::unordered_set<unsigned long long> _edge_set;
+#else
+    std::set<unsigned long long> _edge_set;
+#endif
 
     /**
      * build each element
@@ -0,0 +1,381 @@
+/********************************************************************************/
+/*     888888    888888888   88     888  88888   888      888    88888888       */
+/*   8       8   8           8 8     8     8      8        8    8               */
+/*  8            8           8  8    8     8      8        8    8               */
+/*  8            888888888   8   8   8     8      8        8     8888888        */
+/*  8      8888  8           8    8  8     8      8        8            8       */
+/*   8       8   8           8     8 8     8      8        8            8       */
+/*     888888    888888888  888     88   88888     88888888     88888888        */
+/*                                                                              */
+/*       A Three-Dimensional General Purpose Semiconductor Simulator.           */
+/*                                                                              */
+/*                                                                              */
+/*  Copyright (C) 2007-2008                                                     */
+/*  Cogenda Pte Ltd                                                             */
+/*                                                                              */
+/*  Please contact Cogenda Pte Ltd for license information                      */
+/*                                                                              */
+/*  Author: Gong Ding   gdiso@ustc.edu                                          */
+/*                                                                              */
+/********************************************************************************/
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+#include <cctype>
+
+#include "config.h"
+#include "dfise_scan.h"
+
+#ifndef WINDOWS
+  #include <fcntl.h>
+  #include <unistd.h>
+  #include <sys/mman.h>
+  #include <sys/stat.h>
+#endif
+
+
+namespace DFISE
+{
+
+  // chars which end a word, see dfise_lex.l
+  static inline bool is_delimiter(char c)
+  {
+    switch(c)
+    {
+      case ' ': case '\t': case '\r': case '\n':
+      case '{': case '}': case '[': case ']': case '(': case ')':
+      case '=': case '#': case '"':
+        return true;
+    }
+    return false;
+  }
+
+
+  // compare with lower case string
+  static bool same_nocase(const std::string & word, const char * lower)
+  {
+    if(word.size() != strlen(lower)) return false;
+    for(unsigned int n=0; n<word.size(); ++n)
+      if( tolower(word[n]) != lower[n] ) return false;
+    return true;
+  }
+
+
+  SCANNER::SCANNER()
+    : _begin(0), _end(0), _p(0), _map(0), _map_size(0)
+  {}
+
+
+  SCANNER::~SCANNER()
+  {
+    close();
+  }
+
+
+  void SCANNER::close()
+  {
+#ifndef WINDOWS
+    if(_map)
+      munmap(_map, _map_size);
+#endif
+    _map = 0;
+    _map_size = 0;
+    _buffer.clear();
+    _begin = _end = _p = 0;
+  }
+
+
+  bool SCANNER::open(const std::string & file)
+  {
+    close();
+
+#ifndef WINDOWS
+    int fd = ::open(file.c_str(), O_RDONLY);
+    if(fd < 0) return false;
+
+    struct stat st;
+    if( fstat(fd, &st) == 0 && st.st_size > 0 )
+    {
+      void * p = mmap(0, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+      if( p != MAP_FAILED )
+      {
+        _map = p;
+        _map_size = st.st_size;
+#ifdef MADV_SEQUENTIAL
+        madvise(_map, _map_size, MADV_SEQUENTIAL);
+#endif
+        _begin = static_cast<const char *>(_map);
+        _end   = _begin + _map_size;
+      }
+    }
+    ::close(fd);
+    if(_map) { _p = _begin; return true; }
+#endif
+
+    // no mmap, read the whole file
+    FILE * fp = fopen(file.c_str(), "rb");
+    if(!fp) return false;
+    char buf[65536];
+    size_t n;
+    while( (n = fread(buf, 1, sizeof(buf), fp)) > 0 )
+      _buffer.insert(_buffer.end(), buf, buf+n);
+    fclose(fp);
+
+    _begin = _buffer.empty() ? 0 : &_buffer[0];
+    _end   = _begin + _buffer.size();
+    _p = _begin;
+    return true;
+  }
+
+
+  bool SCANNER::fail(const std::string & msg)
+  {
+    unsigned int line = 1;
+    for(const char * c=_begin; c<_p; ++c)
+      if(*c=='\n') line++;
+    std::stringstream ss;
+    ss << "line " << line << ": " << msg;
+    _error = ss.str();
+    return false;
+  }
+
+
+  void SCANNER::skip_blank()
+  {
+    while(_p < _end)
+    {
+      char c = *_p;
+      if( c==' ' || c=='\t' || c=='\r' || c=='\n' ) { ++_p; continue; }
+      if( c=='#' )
+      {
+        while(_p < _end && *_p!='\n') ++_p;
+        continue;
+      }
+      break;
+    }
+  }
+
+
+  bool SCANNER::read_word(std::string & word, bool & quoted)
+  {
+    skip_blank();
+    quoted = false;
+    if(_p >= _end) return false;
+
+    if(*_p == '"')
+    {
+      const char * e = static_cast<const char *>(memchr(_p+1, '"', _end-_p-1));
+      if(!e) return false;
+      word.assign(_p+1, e);
+      _p = e+1;
+      quoted = true;
+      return true;
+    }
+
+    const char * e = _p;
+    while(e < _end && !is_delimiter(*e)) ++e;
+    if(e == _p) return false;
+    word.assign(_p, e);
+    _p = e;
+    return true;
+  }
+
+
+  bool SCANNER::to_number(const std::string & word, double & d, bool & is_int)
+  {
+    const char c = word[0];
+    if( !( (c>='0' && c<='9') || c=='+' || c=='-' || c=='.' ) ) return false;
+    // strtod also takes hex, inf and nan, the lexer does not
+    if( word.find_first_of("xXnNiI") != std::string::npos ) return false;
+
+    char * q;
+    d = strtod(word.c_str(), &q);
+    if( q == word.c_str() || *q != '\0' ) return false;
+
+    // the lexer reads integer larger than int as float
+    is_int = word.find_first_of(".eE") == std::string::npos && d == static_cast<double>(static_cast<int>(d));
+    return true;
+  }
+
+
+  bool SCANNER::read_data(std::vector<TOKEN *> & tokens)
+  {
+    skip_blank();
+    bool list = false;
+    if(_p < _end && *_p == '[') { list = true; ++_p; }
+
+    std::string word;
+    bool quoted;
+    while(true)
+    {
+      skip_blank();
+      if(list && _p < _end && *_p == ']') { ++_p; break; }
+      if(!read_word(word, quoted))
+      {
+        for(unsigned int n=0; n<tokens.size(); ++n)
+        {
+          tokens[n]->free_value();
+          delete tokens[n];
+        }
+        tokens.clear();
+        return fail("unexpected char in parameter value");
+      }
+
+      TOKEN * token = new TOKEN;
+      double d;
+      bool is_int;
+      if( !quoted && to_number(word, d, is_int) )
+      {
+        token->token_type = is_int ? TOKEN::int_token : TOKEN::float_token;
+        if(is_int) token->value = new int(static_cast<int>(d));
+        else       token->value = new double(d);
+      }
+      else
+      {
+        token->token_type = TOKEN::string_token;
+        token->value = new std::string(word);
+      }
+      tokens.push_back(token);
+
+      if(!list) break;
+    }
+    return true;
+  }
+
+
+  BLOCK * SCANNER::read_block(const std::string & keyword)
+  {
+    BLOCK * block = new BLOCK(keyword);
+
+    skip_blank();
+    if(_p < _end && *_p == '(')
+    {
+      ++_p;
+      std::string word;
+      bool quoted;
+      if(!read_word(word, quoted)) { fail("block index expected"); block->clear(); delete block; return 0; }
+      double d;
+      bool is_int;
+      if(!quoted && to_number(word, d, is_int) && is_int)
+        block->set_index(static_cast<int>(d));
+      else
+        block->set_label(word);
+      skip_blank();
+      if(_p >= _end || *_p != ')') { fail("')' expected"); block->clear(); delete block; return 0; }
+      ++_p;
+      skip_blank();
+    }
+
+    if(_p >= _end || *_p != '{') { fail("'{' expected after " + keyword); block->clear(); delete block; return 0; }
+    ++_p;
+
+    if(!read_body(block)) { block->clear(); delete block; return 0; }
+    return block;
+  }
+
+
+  bool SCANNER::read_body(BLOCK * block)
+  {
+    std::string word;
+    while(true)
+    {
+      skip_blank();
+      if(_p >= _end) return fail("unexpected end of file, '}' expected");
+
+      const char c = *_p;
+      if(c == '}') { ++_p; return true; }
+
+      // bare values in [ ]
+      if(c == '[')
+      {
+        std::vector<TOKEN *> tokens;
+        if(!read_data(tokens)) return false;
+        block->add_values(tokens);
+        continue;
+      }
+
+      // numbers are the bulk of the file, convert them in place
+      if( (c>='0' && c<='9') || c=='+' || c=='-' || c=='.' )
+      {
+        const char * e = _p;
+        while(e < _end && !is_delimiter(*e)) ++e;
+        if(e < _end)
+        {
+          bool plain = true;
+          for(const char * s=_p; s<e; ++s)
+            if( *s=='x' || *s=='X' || *s=='n' || *s=='N' || *s=='i' || *s=='I' ) { plain = false; break; }
+          char * q;
+          const double d = plain ? strtod(_p, &q) : 0.0;
+          if( plain && q == e )
+          {
+            block->add_number(d);
+            _p = e;
+            continue;
+          }
+        }
+      }
+
+      bool quoted;
+      if(!read_word(word, quoted)) return fail("unexpected char");
+      if(quoted)
+      {
+        block->add_string_value(word);
+        continue;
+      }
+
+      skip_blank();
+      const char next = _p < _end ? *_p : '\0';
+      if( next == '{' || next == '(' )
+      {
+        BLOCK * sub = read_block(word);
+        if(!sub) return false;
+        block->add_sub_block(sub);
+      }
+      else if( next == '=' )
+      {
+        ++_p;
+        std::vector<TOKEN *> tokens;
+        if(!read_data(tokens)) return false;
+        block->add_parameter(word, tokens);
+      }
+      else
+      {
+        double d;
+        bool is_int;
+        if(to_number(word, d, is_int))
+          block->add_number(d);
+        else
+          block->add_string_value(word);
+      }
+    }
+    return true;
+  }
+
+
+  bool SCANNER::parse(BLOCK * top)
+  {
+    _p = _begin;
+    _error.clear();
+
+    std::string word;
+    bool quoted;
+    // the lexer is case insensitive
+    if(!read_word(word, quoted) || !same_nocase(word, "df-ise")) return fail("DF-ISE header expected");
+    top->set_keyword(word);
+    if(!read_word(word, quoted) || !same_nocase(word, "text")) return fail("only DF-ISE text format is supported");
+
+    while(true)
+    {
+      skip_blank();
+      if(_p >= _end) break;
+      if(!read_word(word, quoted) || quoted) return fail("block keyword expected");
+      BLOCK * block = read_block(word);
+      if(!block) return false;
+      top->add_sub_block(block);
+    }
+    return true;
+  }
+
+}
@@ -0,0 +1,130 @@
+/********************************************************************************/
+/*     888888    888888888   88     888  88888   888      888    88888888       */
+/*   8       8   8           8 8     8     8      8        8    8               */
+/*  8            8           8  8    8     8      8        8    8               */
+/*  8            888888888   8   8   8     8      8        8     8888888        */
+/*  8      8888  8           8    8  8     8      8        8            8       */
+/*   8       8   8           8     8 8     8      8        8            8       */
+/*     888888    888888888  888     88   88888     88888888     88888888        */
+/*                                                                              */
+/*       A Three-Dimensional General Purpose Semiconductor Simulator.           */
+/*                                                                              */
+/*                                                                              */
+/*  Copyright (C) 2007-2008                                                     */
+/*  Cogenda Pte Ltd                                                             */
+/*                                                                              */
+/*  Please contact Cogenda Pte Ltd for license information                      */
+/*                                                                              */
+/*  Author: Gong Ding   gdiso@ustc.edu                                          */
+/*                                                                              */
+/********************************************************************************/
+
+
+
+#ifndef __dfise_scan_h__
+#define __dfise_scan_h__
+
+#include <string>
+#include <vector>
+
+#include "dfise_block.h"
+
+namespace DFISE
+{
+
+  /**
+   * hand written reader of DF-ISE text file, accepts the syntax of dfise_parser.y.
+   * the file is memory mapped and the numbers in value blocks go into BLOCK::_numbers
+   * directly, without a heap TOKEN for each of them.
+   */
+  class SCANNER
+  {
+  public:
+
+    SCANNER();
+
+    ~SCANNER();
+
+    /**
+     * map the file into memory
+     * @return false when the file can not be opened
+     */
+    bool open(const std::string & file);
+
+    /**
+     * parse the whole file into top block
+     * @return false on syntax error, see error()
+     */
+    bool parse(BLOCK * top);
+
+    /**
+     * @return the error message of last parse
+     */
+    const std::string & error() const
+    { return _error; }
+
+  private:
+
+    /**
+     * the mapped file
+     */
+    const char * _begin;
+    const char * _end;
+
+    /**
+     * current position
+     */
+    const char * _p;
+
+    /**
+     * mapped region, 0 when the file is read into _buffer
+     */
+    void * _map;
+    size_t _map_size;
+
+    std::vector<char> _buffer;
+
+    std::string _error;
+
+    /**
+     * skip blank chars and # comments
+     */
+    void skip_blank();
+
+    /**
+     * read an unquoted word or a quoted string
+     * @return false at end of file or at a delimiter
+     */
+    bool read_word(std::string & word, bool & quoted);
+
+    /**
+     * @return true when the unquoted word is a number, the lexer rule of dfise_lex.l
+     */
+    static bool to_number(const std::string & word, double & d, bool & is_int);
+
+    /**
+     * read "KEYWORD ( index|label ) { body }", the keyword is already read
+     */
+    BLOCK * read_block(const std::string & keyword);
+
+    /**
+     * read body items until '}'
+     */
+    bool read_body(BLOCK * block);
+
+    /**
+     * read value or [ values ] as TOKENs
+     */
+    bool read_data(std::vector<TOKEN *> & tokens);
+
+    /**
+     * set error message with line number of current position
+     */
+    bool fail(const std::string & msg);
+
+    void close();
+  };
+
+}
+
+#endif //__dfise_scan_h__
@@ -36,6 +36,11 @@ namespace
                 SetArgumentCount(1, 1, 0, 0);
                 }
 
+            UnaryFunction GetUnary() const
+                {
+                return static_cast<UnaryFunction>(::fabs);
+                }
+
             double DoEvaluate()
                 {
                 return fabs(m_nodes[0]->Evaluate());
@@ -253,6 +258,11 @@ namespace
                 SetArgumentCount(1, 1, 0, 0);
                 }
 
+            UnaryFunction GetUnary() const
+                {
+                return static_cast<UnaryFunction>(::sqrt);
+                }
+
             double DoEvaluate()
                 {
                 errno = 0;
@@ -290,6 +300,11 @@ namespace
                 SetArgumentCount(1, 1, 0, 0);
                 }
 
+            UnaryFunction GetUnary() const
+                {
+                return static_cast<UnaryFunction>(::sin);
+                }
+
             double DoEvaluate()
                 {
                 errno = 0;
@@ -327,6 +342,11 @@ namespace
                 SetArgumentCount(1, 1, 0, 0);
                 }
 
+            UnaryFunction GetUnary() const
+                {
+                return static_cast<UnaryFunction>(::cos);
+                }
+
             double DoEvaluate()
                 {
                 errno = 0;
@@ -364,6 +384,11 @@ namespace
                 SetArgumentCount(1, 1, 0, 0);
                 }
 
+            UnaryFunction GetUnary() const
+                {
+                return static_cast<UnaryFunction>(::tan);
+                }
+
             double DoEvaluate()
                 {
                 errno = 0;
@@ -401,6 +426,11 @@ namespace
                 SetArgumentCount(1, 1, 0, 0);
                 }
 
+            UnaryFunction GetUnary() const
+                {
+                return static_cast<UnaryFunction>(::sinh);
+                }
+
             double DoEvaluate()
                 {
                 errno = 0;
@@ -438,6 +468,11 @@ namespace
                 SetArgumentCount(1, 1, 0, 0);
                 }
 
+            UnaryFunction GetUnary() const
+                {
+                return static_cast<UnaryFunction>(::cosh);
+                }
+
             double DoEvaluate()
                 {
                 errno = 0;
@@ -475,6 +510,11 @@ namespace
                 SetArgumentCount(1, 1, 0, 0);
                 }
 
+            UnaryFunction GetUnary() const
+                {
+                return static_cast<UnaryFunction>(::tanh);
+                }
+
             double DoEvaluate()
                 {
                 errno = 0;
@@ -512,6 +552,11 @@ namespace
                 SetArgumentCount(1, 1, 0, 0);
                 }
 
+            UnaryFunction GetUnary() const
+                {
+                return static_cast<UnaryFunction>(::asin);
+                }
+
             double DoEvaluate()
                 {
                 errno = 0;
@@ -549,6 +594,11 @@ namespace
                 SetArgumentCount(1, 1, 0, 0);
                 }
 
+            UnaryFunction GetUnary() const
+                {
+                return static_cast<UnaryFunction>(::acos);
+                }
+
             double DoEvaluate()
                 {
                 errno = 0;
@@ -586,6 +636,11 @@ namespace
                 SetArgumentCount(1, 1, 0, 0);
                 }
 
+            UnaryFunction GetUnary() const
+                {
+                return static_cast<UnaryFunction>(::atan);
+                }
+
             double DoEvaluate()
                 {
                 errno = 0;
@@ -773,6 +828,11 @@ namespace
                 SetArgumentCount(1, 1, 0, 0);
                 }
 
+            UnaryFunction GetUnary() const
+                {
+                return static_cast<UnaryFunction>(::log10);
+                }
+
             double DoEvaluate()
                 {
                 errno = 0;
@@ -810,6 +870,11 @@ namespace
                 SetArgumentCount(1, 1, 0, 0);
                 }
 
+            UnaryFunction GetUnary() const
+                {
+                return static_cast<UnaryFunction>(::log);
+                }
+
             double DoEvaluate()
                 {
                 errno = 0;
@@ -847,6 +912,11 @@ namespace
                 SetArgumentCount(1, 1, 0, 0);
                 }
 
+            UnaryFunction GetUnary() const
+                {
+                return static_cast<UnaryFunction>(::exp);
+                }
+
             double DoEvaluate()
                 {
                 errno = 0;
@@ -1036,6 +1106,11 @@ namespace
                 SetArgumentCount(1, 1, 0, 0);
                 }
 
+            UnaryFunction GetUnary() const
+                {
+                return static_cast<UnaryFunction>(::ceil);
+                }
+
             double DoEvaluate()
                 {
                 return ceil(m_nodes[0]->Evaluate());
@@ -1066,6 +1141,11 @@ namespace
                 SetArgumentCount(1, 1, 0, 0);
                 }
 
+            UnaryFunction GetUnary() const
+                {
+                return static_cast<UnaryFunction>(::floor);
+                }
+
             double DoEvaluate()
                 {
                 return floor(m_nodes[0]->Evaluate());
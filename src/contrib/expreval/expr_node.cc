@@ -43,6 +43,12 @@ double Node::Evaluate()
     return DoEvaluate();
     }
 
+// Compile
+void Node::Compile(Program &program)
+    {
+    program.EmitNode(this);
+    }
+
 // Function node
 //------------------------------------------------------------------------------
 
@@ -70,6 +76,26 @@ string FunctionNode::GetName() const
     return m_factory->GetName();
     }
 
+// No compiled form by default
+UnaryFunction FunctionNode::GetUnary() const
+    {
+    return 0;
+    }
+
+// Compile
+void FunctionNode::Compile(Program &program)
+    {
+    UnaryFunction func = GetUnary();
+    if(func == 0 || m_nodes.size() != 1 || !m_refs.empty() || !m_data.empty())
+        {
+        program.EmitNode(this);
+        return;
+        }
+
+    m_nodes[0]->Compile(program);
+    program.EmitCall(func, GetName());
+    }
+
 // Set argument count
 void FunctionNode::SetArgumentCount(long argMin, long argMax, long refMin, long refMax,
         long dataMin, long dataMax)
@@ -563,6 +589,14 @@ double AddNode::DoEvaluate()
     return m_lhs->Evaluate() + m_rhs->Evaluate();
     }
 
+// Compile
+void AddNode::Compile(Program &program)
+    {
+    m_lhs->Compile(program);
+    m_rhs->Compile(program);
+    program.EmitOperator(Program::OP_ADD);
+    }
+
 // Parse
 void AddNode::Parse(Parser &parser, Parser::size_type start, Parser::size_type end,
         Parser::size_type v1)
@@ -607,6 +641,14 @@ double SubtractNode::DoEvaluate()
     return m_lhs->Evaluate() - m_rhs->Evaluate();
     }
 
+// Compile
+void SubtractNode::Compile(Program &program)
+    {
+    m_lhs->Compile(program);
+    m_rhs->Compile(program);
+    program.EmitOperator(Program::OP_SUB);
+    }
+
 // Parse
 void SubtractNode::Parse(Parser &parser, Parser::size_type start, Parser::size_type end,
         Parser::size_type v1)
@@ -651,6 +693,14 @@ double MultiplyNode::DoEvaluate()
     return m_lhs->Evaluate() * m_rhs->Evaluate();
     }
 
+// Compile
+void MultiplyNode::Compile(Program &program)
+    {
+    m_lhs->Compile(program);
+    m_rhs->Compile(program);
+    program.EmitOperator(Program::OP_MUL);
+    }
+
 // Parse
 void MultiplyNode::Parse(Parser &parser, Parser::size_type start, Parser::size_type end,
         Parser::size_type v1)
@@ -704,6 +754,14 @@ double DivideNode::DoEvaluate()
         }
     }
 
+// Compile
+void DivideNode::Compile(Program &program)
+    {
+    m_lhs->Compile(program);
+    m_rhs->Compile(program);
+    program.EmitOperator(Program::OP_DIV);
+    }
+
 // Parse
 void DivideNode::Parse(Parser &parser, Parser::size_type start, Parser::size_type end,
         Parser::size_type v1)
@@ -747,6 +805,13 @@ double NegateNode::DoEvaluate()
     return -(m_rhs->Evaluate());
     }
 
+// Compile
+void NegateNode::Compile(Program &program)
+    {
+    m_rhs->Compile(program);
+    program.EmitOperator(Program::OP_NEG);
+    }
+
 // Parse
 void NegateNode::Parse(Parser &parser, Parser::size_type start, Parser::size_type end,
         Parser::size_type v1)
@@ -796,6 +861,14 @@ double ExponentNode::DoEvaluate()
     return result;
     }
 
+// Compile
+void ExponentNode::Compile(Program &program)
+    {
+    m_lhs->Compile(program);
+    m_rhs->Compile(program);
+    program.EmitOperator(Program::OP_POW);
+    }
+
 // Parse
 void ExponentNode::Parse(Parser &parser, Parser::size_type start, Parser::size_type end,
         Parser::size_type v1)
@@ -837,6 +910,12 @@ double VariableNode::DoEvaluate()
     return *m_var;
     }
 
+// Compile
+void VariableNode::Compile(Program &program)
+    {
+    program.EmitLoad(m_var);
+    }
+
 // Parse
 void VariableNode::Parse(Parser &parser, Parser::size_type start, Parser::size_type end,
         Parser::size_type v1)
@@ -907,6 +986,12 @@ double ValueNode::DoEvaluate()
     return m_val;
     }
 
+// Compile
+void ValueNode::Compile(Program &program)
+    {
+    program.EmitConst(m_val);
+    }
+
 // Parse
 void ValueNode::Parse(Parser &parser, Parser::size_type start, Parser::size_type end,
         Parser::size_type v1)
@@ -0,0 +1,204 @@
+// File:    program.cc
+// Purpose: Flat stack program compiled from an expression tree
+//------------------------------------------------------------------------------
+
+
+// Includes
+#include <cmath>
+#include <cerrno>
+
+#include "expr_program.h"
+#include "expr_node.h"
+#include "expr_except.h"
+
+using namespace std;
+using namespace ExprEval;
+
+// Program
+//------------------------------------------------------------------------------
+
+// Constructor
+Program::Program() : m_depth(0), m_maxDepth(0)
+    {
+    }
+
+// Clear
+void Program::Clear()
+    {
+    m_code.clear();
+    m_names.clear();
+    m_depth = 0;
+    m_maxDepth = 0;
+    }
+
+// Valid program leaves exactly one value on a bounded stack
+bool Program::IsValid() const
+    {
+    return !m_code.empty() && m_depth == 1 && m_maxDepth <= MaxStack;
+    }
+
+// Push instruction
+void Program::Push(const Instruction &ins, int depth)
+    {
+    m_code.push_back(ins);
+    m_depth += depth;
+    if(m_depth > m_maxDepth)
+        m_maxDepth = m_depth;
+    }
+
+// Constant
+void Program::EmitConst(double value)
+    {
+    Instruction ins = { OP_CONST, value, 0, 0, 0, 0 };
+    Push(ins, 1);
+    }
+
+// Variable
+void Program::EmitLoad(double *var)
+    {
+    Instruction ins = { OP_LOAD, 0.0, var, 0, 0, 0 };
+    Push(ins, 1);
+    }
+
+// Subtree without compiled form
+void Program::EmitNode(Node *node)
+    {
+    Instruction ins = { OP_NODE, 0.0, 0, node, 0, 0 };
+    Push(ins, 1);
+    }
+
+// Operator, fold when the operands are constant
+void Program::EmitOperator(OpCode op)
+    {
+    vector<Instruction>::size_type n = m_code.size();
+
+    if(op == OP_NEG)
+        {
+        if(n >= 1 && m_code[n-1].op == OP_CONST)
+            {
+            m_code[n-1].value = -m_code[n-1].value;
+            return;
+            }
+        Instruction ins = { OP_NEG, 0.0, 0, 0, 0, 0 };
+        Push(ins, 0);
+        return;
+        }
+
+    if(n >= 2 && m_code[n-1].op == OP_CONST && m_code[n-2].op == OP_CONST)
+        {
+        double value = Binary(op, m_code[n-2].value, m_code[n-1].value);
+        m_code.pop_back();
+        m_code.back().value = value;
+        m_depth--;
+        return;
+        }
+
+    Instruction ins = { op, 0.0, 0, 0, 0, 0 };
+    Push(ins, -1);
+    }
+
+// Function call, fold when the argument is constant
+void Program::EmitCall(UnaryFunction func, const string &name)
+    {
+    Instruction ins = { OP_CALL, 0.0, 0, 0, func, m_names.size() };
+    m_names.push_back(name);
+
+    vector<Instruction>::size_type n = m_code.size();
+    if(n >= 1 && m_code[n-1].op == OP_CONST)
+        {
+        m_code[n-1].value = Call(ins, m_code[n-1].value);
+        return;
+        }
+
+    Push(ins, 0);
+    }
+
+// Binary operator with the same error handling as the tree nodes
+double Program::Binary(OpCode op, double a, double b)
+    {
+    switch(op)
+        {
+        case OP_ADD:
+            return a + b;
+        case OP_SUB:
+            return a - b;
+        case OP_MUL:
+            return a * b;
+        case OP_DIV:
+            if(b == 0.0)
+                throw(DivideByZeroException());
+            return a / b;
+        case OP_POW:
+            {
+            errno = 0;
+            double result = pow(a, b);
+            if(errno)
+                throw(MathException("^"));
+            return result;
+            }
+        default:
+            break;
+        }
+
+    throw(NullPointerException("Program::Binary"));
+    }
+
+// Function
+double Program::Call(const Instruction &ins, double a) const
+    {
+    errno = 0;
+    double result = ins.func(a);
+    if(errno)
+        throw(MathException(m_names[ins.name]));
+    return result;
+    }
+
+// Run
+double Program::Run() const
+    {
+    double stack[MaxStack];
+    int top = -1;
+
+    vector<Instruction>::const_iterator it = m_code.begin();
+    vector<Instruction>::const_iterator end = m_code.end();
+    for(; it != end; ++it)
+        {
+        switch(it->op)
+            {
+            case OP_CONST:
+                stack[++top] = it->value;
+                break;
+            case OP_LOAD:
+                stack[++top] = *(it->var);
+                break;
+            case OP_NODE:
+                stack[++top] = it->node->Evaluate();
+                break;
+            case OP_ADD:
+                top--;
+                stack[top] += stack[top+1];
+                break;
+            case OP_SUB:
+                top--;
+                stack[top] -= stack[top+1];
+                break;
+            case OP_MUL:
+                top--;
+                stack[top] *= stack[top+1];
+                break;
+            case OP_DIV:
+            case OP_POW:
+                top--;
+                stack[top] = Binary(it->op, stack[top], stack[top+1]);
+                break;
+            case OP_NEG:
+                stack[top] = -stack[top];
+                break;
+            case OP_CALL:
+                stack[top] = Call(*it, stack[top]);
+                break;
+            }
+        }
+
+    return stack[0];
+    }
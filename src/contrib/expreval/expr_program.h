@@ -0,0 +1,94 @@
+// File:    program.h
+// Purpose: Flat stack program compiled from an expression tree
+//------------------------------------------------------------------------------
+
+
+#ifndef __EXPREVAL_PROGRAM_H
+#define __EXPREVAL_PROGRAM_H
+
+// Includes
+#include <vector>
+#include <string>
+
+// Part of expreval namespace
+namespace ExprEval
+    {
+    // Forward declarations
+    class Node;
+
+    // Single argument math function, used by compiled function calls
+    typedef double (*UnaryFunction)(double);
+
+    // Program class
+    //--------------------------------------------------------------------------
+    // The expression tree is flattened once after parsing into postfix
+    // instructions that run on a small value stack. Constant operands are
+    // folded while the program is emitted. Nodes without a compiled form
+    // are kept as a single instruction which evaluates the subtree.
+    class Program
+        {
+        public:
+            enum OpCode
+                {
+                OP_CONST,   // push value
+                OP_LOAD,    // push *var
+                OP_NODE,    // push node->Evaluate()
+                OP_ADD,
+                OP_SUB,
+                OP_MUL,
+                OP_DIV,
+                OP_POW,
+                OP_NEG,
+                OP_CALL     // replace top with func(top)
+                };
+
+            // Maximum stack depth of a program
+            enum { MaxStack = 64 };
+
+            Program();
+
+            // Remove all instructions
+            void Clear();
+
+            // True when the program can replace the expression tree
+            bool IsValid() const;
+
+            // Emit instructions
+            void EmitConst(double value);
+            void EmitLoad(double *var);
+            void EmitNode(Node *node);
+            void EmitOperator(OpCode op);
+            void EmitCall(UnaryFunction func, const ::std::string &name);
+
+            // Run the program
+            double Run() const;
+
+        private:
+            struct Instruction
+                {
+                OpCode op;
+                double value;
+                double *var;
+                Node *node;
+                UnaryFunction func;
+                ::std::string::size_type name;
+                };
+
+            // Push an instruction and track the stack depth
+            void Push(const Instruction &ins, int depth);
+
+            // Evaluate an operator on two values
+            static double Binary(OpCode op, double a, double b);
+
+            // Evaluate a function, throw MathException on error
+            double Call(const Instruction &ins, double a) const;
+
+            ::std::vector<Instruction> m_code;
+            ::std::vector< ::std::string> m_names;
+            int m_depth;
+            int m_maxDepth;
+        };
+
+    } // namespace ExprEval
+
+#endif // __EXPREVAL_PROGRAM_H
@@ -44,6 +44,7 @@ void FE<Dim,T>::attach_quadrature_rule (QBase* q)
   qrule = q;
   // make sure we don't cache results from a previous quadrature rule
   elem_type = INVALID_ELEM;
+  reference_shapes.clear();
   return;
 }
 
@@ -150,8 +151,15 @@ void FE<Dim,T>::reinit(const Elem* elem,
     {
       // Set the type and p level for this element
       elem_type = elem->type();
-      // Initialize the shape functions
-      this->init_shape_functions (qrule->get_points(), elem);
+      // Initialize the shape functions, the tables of an element type
+      // seen before are taken from the reference cache
+      if (this->shapes_need_reinit())
+        this->init_shape_functions (qrule->get_points(), elem);
+      else if (!this->load_reference_shapes(elem_type, elem->p_level()))
+      {
+        this->init_shape_functions (qrule->get_points(), elem);
+        this->store_reference_shapes(elem_type, elem->p_level());
+      }
 
 
       if (this->shapes_need_reinit())
@@ -424,8 +432,10 @@ void FE<Dim,T>::init_shape_functions(const std::vector<Point>& qp,
   }
 #endif // ifdef ENABLE_INFINITE_ELEMENTS
 
-  // Optimize for the affine elements case:
-  bool has_affine_map = elem->has_affine_map();
+  // Optimize for the affine elements case. Not when the tables go to the
+  // reference cache, they are shared with the non-affine elements of the same type
+  const bool to_reference_cache = !this->shapes_need_reinit() && qrule != NULL && &qp == &qrule->get_points();
+  bool has_affine_map = elem->has_affine_map() && !to_reference_cache;
 
   switch (Dim)
   {
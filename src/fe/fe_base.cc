@@ -21,6 +21,7 @@
 
 // Local includes
 #include "fe.h"
+#include "elem.h"
 #include "perf_log.h"
 // For projection code:
 //#include "boundary_info.h"
@@ -116,7 +117,7 @@ AutoPtr<FEBase> FEBase::build (const unsigned int dim,
 
 
 
-void FEBase::compute_shape_functions (const Elem*)
+void FEBase::compute_shape_functions (const Elem* elem)
 {
   //-------------------------------------------------------------------------
   // Compute the shape function values (and derivatives)
@@ -130,6 +131,41 @@ void FEBase::compute_shape_functions (const Elem*)
 
   calculate_phi = calculate_dphi = true;
 
+  // the inverse jacobian of an affine element is the same at all the
+  // quadrature points, take it once from point 0
+  if (elem != NULL && elem->has_affine_map() && dim > 1 && calculate_dphi)
+  {
+    const Real xx = dxidx_map[0],  xy = dxidy_map[0],  xz = dxidz_map[0];
+    const Real ex = detadx_map[0], ey = detady_map[0], ez = detadz_map[0];
+    const Real zx = dim > 2 ? dzetadx_map[0] : 0.;
+    const Real zy = dim > 2 ? dzetady_map[0] : 0.;
+    const Real zz = dim > 2 ? dzetadz_map[0] : 0.;
+
+    for (unsigned int i=0; i<dphi.size(); i++)
+    {
+      const unsigned int n_qp = dphi[i].size();
+      const Real * dxi   = &dphidxi[i][0];
+      const Real * deta  = &dphideta[i][0];
+      const Real * dzeta = dim > 2 ? &dphidzeta[i][0] : deta;
+      const Real zeta_on = dim > 2 ? 1. : 0.;
+      for (unsigned int p=0; p<n_qp; p++)
+      {
+        const Real dz = zeta_on*dzeta[p];
+        dphidx[i][p] = dxi[p]*xx + deta[p]*ex + dz*zx;
+        dphidy[i][p] = dxi[p]*xy + deta[p]*ey + dz*zy;
+        dphidz[i][p] = dxi[p]*xz + deta[p]*ez + dz*zz;
+        dphi[i][p](0) = dphidx[i][p];
+        dphi[i][p](1) = dphidy[i][p];
+#if DIM == 3
+        dphi[i][p](2) = dphidz[i][p];
+#endif
+      }
+    }
+
+    STOP_LOG("compute_shape_functions()", "FE");
+    return;
+  }
+
   // Compute the value of the derivative shape function i at quadrature point p
   switch (dim)
   {
@@ -222,6 +258,101 @@ void FEBase::compute_shape_functions (const Elem*)
 
 
 
+// flat [i*n_qp + p] storage <-> the nested shape function vectors
+static void flatten_table(const std::vector<std::vector<Real> > & v, std::vector<Real> & flat)
+{
+  flat.clear();
+  for (unsigned int i=0; i<v.size(); i++)
+    flat.insert(flat.end(), v[i].begin(), v[i].end());
+}
+
+static void unflatten_table(const std::vector<Real> & flat, unsigned int n, unsigned int n_qp,
+                            std::vector<std::vector<Real> > & v)
+{
+  v.resize(n);
+  for (unsigned int i=0; i<n; i++)
+    v[i].assign(flat.begin() + i*n_qp, flat.begin() + (i+1)*n_qp);
+}
+
+
+void FEBase::store_reference_shapes(const ElemType t, const unsigned int p)
+{
+#ifndef ENABLE_SECOND_DERIVATIVES
+  // only complete tables can be reused
+  if (!calculate_phi || !calculate_dphi || phi.empty() || phi_map.empty()) return;
+
+  ReferenceShapes & ref = reference_shapes[std::make_pair(t, p)];
+  ref.n_shape = phi.size();
+  ref.n_map   = phi_map.size();
+  ref.n_qp    = phi_map[0].size();
+
+  flatten_table(phi, ref.phi);
+  flatten_table(dphidxi, ref.dphidxi);
+  flatten_table(phi_map, ref.phi_map);
+  flatten_table(dphidxi_map, ref.dphidxi_map);
+  if (dim > 1)
+  {
+    flatten_table(dphideta, ref.dphideta);
+    flatten_table(dphideta_map, ref.dphideta_map);
+  }
+  if (dim > 2)
+  {
+    flatten_table(dphidzeta, ref.dphidzeta);
+    flatten_table(dphidzeta_map, ref.dphidzeta_map);
+  }
+#endif
+}
+
+
+bool FEBase::load_reference_shapes(const ElemType t, const unsigned int p)
+{
+#ifdef ENABLE_SECOND_DERIVATIVES
+  return false;
+#else
+  std::map<std::pair<ElemType, unsigned int>, ReferenceShapes>::const_iterator it =
+    reference_shapes.find(std::make_pair(t, p));
+  if (it == reference_shapes.end()) return false;
+
+  const ReferenceShapes & ref = it->second;
+  const unsigned int n_qp = ref.n_qp;
+
+  calculations_started = true;
+  calculate_phi = calculate_dphi = true;
+
+  unflatten_table(ref.phi, ref.n_shape, n_qp, phi);
+  unflatten_table(ref.dphidxi, ref.n_shape, n_qp, dphidxi);
+  unflatten_table(ref.phi_map, ref.n_map, n_qp, phi_map);
+  unflatten_table(ref.dphidxi_map, ref.n_map, n_qp, dphidxi_map);
+  if (dim > 1)
+  {
+    unflatten_table(ref.dphideta, ref.n_shape, n_qp, dphideta);
+    unflatten_table(ref.dphideta_map, ref.n_map, n_qp, dphideta_map);
+  }
+  if (dim > 2)
+  {
+    unflatten_table(ref.dphidzeta, ref.n_shape, n_qp, dphidzeta);
+    unflatten_table(ref.dphidzeta_map, ref.n_map, n_qp, dphidzeta_map);
+  }
+
+  // physical derivatives, filled by compute_shape_functions
+  dphi.resize(ref.n_shape);
+  dphidx.resize(ref.n_shape);
+  dphidy.resize(ref.n_shape);
+  dphidz.resize(ref.n_shape);
+  for (unsigned int i=0; i<ref.n_shape; i++)
+  {
+    dphi[i].resize(n_qp);
+    dphidx[i].resize(n_qp);
+    dphidy[i].resize(n_qp);
+    dphidz[i].resize(n_qp);
+  }
+
+  return true;
+#endif
+}
+
+
+
 
 
 void FEBase::print_JxW(std::ostream& os) const
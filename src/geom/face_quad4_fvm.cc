@@ -25,9 +25,7 @@
 #include "face_quad4_fvm.h"
 #include "edge_edge2_fvm.h"
 
-// TNT matrix-vector library
-#include <TNT/tnt.h>
-#include <TNT/jama_lu.h>
+#include "dense_matrix_fixed.h"
 
 
 AutoPtr<Elem> Quad4_FVM::build_fvm_side (const unsigned int i, bool proxy) const
@@ -243,32 +241,24 @@ void Quad4_FVM::prepare_for_fvm()
 void Quad4_FVM::prepare_for_least_squares()
 {
   //FIXME NOT work for 3D quad
-  TNT::Array2D<Real> A (n_nodes(), 3, 0.0);
-  TNT::Array2D<Real> AT(3, n_nodes(), 0.0);
+  DenseMatrixFixed<4,3> A;
 
   for( unsigned int i=0; i<n_nodes(); i++ )
   {
-    A[i][0] = 1.0;
-    A[i][1] = (this->point(i))(0);
-    A[i][2] = (this->point(i))(1);
-
-    AT[0][i] = 1.0;
-    AT[1][i] = (this->point(i))(0);
-    AT[2][i] = (this->point(i))(1);
+    A(i,0) = 1.0;
+    A(i,1) = (this->point(i))(0);
+    A(i,2) = (this->point(i))(1);
   }
 
-  TNT::Array2D<Real> ATA = TNT::matmult(AT, A);
-
-  JAMA::LU<Real> solver(ATA);
+  DenseLUFixed<3> solver(A.normal());
 
-  if( solver.isNonsingular() )
+  if( solver.is_nonsingular() )
   {
-    TNT::Array2D<Real> inv_ATA = solver.inv();
-    TNT::Array2D<Real>  M = TNT::matmult(inv_ATA, AT);
+    DenseMatrixFixed<3,4> M = solver.inverse()*A.transpose();
 
-    for(int m=0; m<M.dim1()-1; m++)
-      for(int n=0; n<M.dim2(); n++ )
-        least_squares_gradient_matrix[m][n] = M[m+1][n];
+    for(int m=0; m<2; m++)
+      for(int n=0; n<4; n++ )
+        least_squares_gradient_matrix[m][n] = M(m+1,n);
   }
   else
   {
@@ -343,33 +333,26 @@ VectorValue<AutoDScalar> Quad4_FVM::gradient( const std::vector<AutoDScalar> & v
 void Quad4_FVM::prepare_for_vector_reconstruct()
 {
   //FIXME NOT work for 3D quad
-  TNT::Array2D<Real> A (n_edges(), 2, 0.0);
-  TNT::Array2D<Real> AT(2, n_edges(), 0.0);
+  DenseMatrixFixed<4,2> A;
 
   for( unsigned int e=0; e<n_edges(); e++ )
   {
     AutoPtr<Elem> edge = this->build_edge (e);
     VectorValue<double> dir = (edge->point(1) - edge->point(0)).unit(); // unit direction of the edge
 
-    A[e][0] = dir(0);
-    A[e][1] = dir(1);
-
-    AT[0][e] = dir(0);
-    AT[1][e] = dir(1);
+    A(e,0) = dir(0);
+    A(e,1) = dir(1);
   }
 
-  TNT::Array2D<Real> ATA = TNT::matmult(AT, A);
-
-  JAMA::LU<Real> solver(ATA);
+  DenseLUFixed<2> solver(A.normal());
 
-  if( solver.isNonsingular() )
+  if( solver.is_nonsingular() )
   {
-    TNT::Array2D<Real> inv_ATA = solver.inv();
-    TNT::Array2D<Real>  M = TNT::matmult(inv_ATA, AT);
+    DenseMatrixFixed<2,4> M = solver.inverse()*A.transpose();
 
-    for(int m=0; m<M.dim1(); m++)
-      for(int e=0; e<M.dim2(); e++ )
-        least_squares_vector_reconstruct_matrix[m][e] = M[m][e];
+    for(int m=0; m<2; m++)
+      for(int e=0; e<4; e++ )
+        least_squares_vector_reconstruct_matrix[m][e] = M(m,e);
   }
   else
   {
@@ -24,9 +24,7 @@
 #include "face_tri3_fvm.h"
 #include "edge_edge2_fvm.h"
 
-// TNT matrix-vector library
-#include <TNT/tnt.h>
-#include <TNT/jama_lu.h>
+#include "dense_matrix_fixed.h"
 
 /*
  *   TRI3:  2               TRI3:  C
@@ -383,32 +381,26 @@ VectorValue<AutoDScalar> Tri3_FVM::gradient( const std::vector<AutoDScalar> & va
 void Tri3_FVM::prepare_for_vector_reconstruct()
 {
    //FIXME NOT work for 3D triangle
-   TNT::Array2D<Real> A (n_edges(), 2, 0.0);
-   TNT::Array2D<Real> AT(2, n_edges(), 0.0);
+   DenseMatrixFixed<3,2> A;
 
    for( unsigned int e=0; e<n_edges(); e++ )
    {
      AutoPtr<Elem> edge = this->build_edge (e);
      VectorValue<double> dir = (edge->point(1) - edge->point(0)).unit(); // unit direction of the edge
 
-     A[e][0] = dir(0);
-     A[e][1] = dir(1);
-
-     AT[0][e] = dir(0);
-     AT[1][e] = dir(1);
+     A(e,0) = dir(0);
+     A(e,1) = dir(1);
    }
 
-   TNT::Array2D<Real> ATA = TNT::matmult(AT, A);
-   JAMA::LU<Real> solver(ATA);
+   DenseLUFixed<2> solver(A.normal());
 
-   if( solver.isNonsingular() )
+   if( solver.is_nonsingular() )
    {
-     TNT::Array2D<Real> inv_ATA = solver.inv();
-     TNT::Array2D<Real>  M = TNT::matmult(inv_ATA, AT);
+     DenseMatrixFixed<2,3> M = solver.inverse()*A.transpose();
 
-     for(unsigned int m=0; m<M.dim1(); m++)
-       for( unsigned int e=0; e<M.dim2(); e++ )
-         least_squares_vector_reconstruct_matrix[m][e] = M[m][e];
+     for(unsigned int m=0; m<2; m++)
+       for( unsigned int e=0; e<3; e++ )
+         least_squares_vector_reconstruct_matrix[m][e] = M(m,e);
    }
    else
    {
@@ -24,6 +24,7 @@
 
 #include "solver_base.h"
 #include "cgns_hook.h"
+#include "cgns_io.h"
 #include "spice_ckt.h"
 #include "MXMLUtil.h"
 
@@ -32,7 +33,8 @@
  * constructor, open the file for writing
  */
 CGNSHook::CGNSHook ( SolverBase & solver, const std::string & name, void * param)
-    : Hook ( solver, name ), _cgns_prefix ( SolverSpecify::out_prefix ), _mixA ( false )
+    : Hook ( solver, name ), _cgns_prefix ( SolverSpecify::out_prefix ), _series ( false ), _single_precision ( false ),
+      _ddm ( false ), _mixA ( false ), _ddm_ac ( false )
 {
   this->count  =0;
   this->_t_step=0;
@@ -52,14 +54,30 @@ CGNSHook::CGNSHook ( SolverBase & solver, const std::string & name, void * param
       _v_step=parm_it->get_real() * PhysicalUnit::V;
     if ( parm_it->name() == "istep" && parm_it->type() == Parser::REAL )
       _i_step=parm_it->get_real() * PhysicalUnit::A;
+    if ( parm_it->name() == "series" && parm_it->type() == Parser::BOOL )
+      _series=parm_it->get_bool();
+    if ( parm_it->name() == "single" && parm_it->type() == Parser::BOOL )
+      _single_precision=parm_it->get_bool();
   }
 
+  // series mode only makes sense for transient simulation
+  _series = _series && SolverSpecify::Type==SolverSpecify::TRANSIENT;
 
   const SimulationSystem &system = get_solver().get_system();
 
-  std::ostringstream cgns_filename;
-  cgns_filename << _cgns_prefix << '.' << ( this->count++ ) << ".cgns";
-  system.export_cgns ( cgns_filename.str() );
+  if ( _series )
+  {
+    // mesh and the full initial solution, transient steps are appended later
+    _series_file = _cgns_prefix + ".series.cgns";
+    system.export_cgns ( _series_file );
+    _append_series_step();
+  }
+  else
+  {
+    std::ostringstream cgns_filename;
+    cgns_filename << _cgns_prefix << '.' << ( this->count++ ) << ".cgns";
+    system.export_cgns ( cgns_filename.str() );
+  }
 
   SolverSpecify::SolverType solver_type = this->get_solver().solver_type();
 
@@ -175,10 +193,18 @@ void CGNSHook::post_solve()
   {
     if ( SolverSpecify::clock - this->_t_last >= this->_t_step )
     {
-      const SimulationSystem &system = get_solver().get_system();
-
-      cgns_filename << _cgns_prefix << '.' << ( this->count++ ) << ".cgns";
-      system.export_cgns ( cgns_filename.str() );
+      if ( _series )
+      {
+        _append_series_step();
+        cgns_filename << _series_file;
+      }
+      else
+      {
+        const SimulationSystem &system = get_solver().get_system();
+
+        cgns_filename << _cgns_prefix << '.' << ( this->count++ ) << ".cgns";
+        system.export_cgns ( cgns_filename.str() );
+      }
 
       _t_last = SolverSpecify::clock;
 
@@ -214,7 +240,30 @@ void CGNSHook::post_iteration()
  * This is executed after the finalization of the solver
  */
 void CGNSHook::on_close()
-{}
+{
+  if ( _series )
+  {
+    const SimulationSystem &system = get_solver().get_system();
+    CGNSIO ( system ).write_time_series ( _series_file, _series_time, _series_sol_name );
+  }
+}
+
+
+
+/*----------------------------------------------------------------------
+ * append the solution of current time step to the series file
+ */
+void CGNSHook::_append_series_step()
+{
+  std::ostringstream sol_name;
+  sol_name << "Step_" << _series_sol_name.size();
+
+  const SimulationSystem &system = get_solver().get_system();
+  CGNSIO ( system ).append_solution ( _series_file, sol_name.str(), _single_precision, _series_digest );
+
+  _series_time.push_back ( SolverSpecify::clock/PhysicalUnit::s );
+  _series_sol_name.push_back ( sol_name.str() );
+}
 
 
 #ifdef DLLHOOK
@@ -27,22 +27,50 @@
 
 #include "solver_base.h"
 #include "cv_hook.h"
+#include "ddm_ac/ddm_ac.h"
+#include "mathfunc.h"  // for PI
 #include "parallel.h"
 
 
 /*----------------------------------------------------------------------
  * constructor, open the rawfile for writing
  */
-CVHook::CVHook(SolverBase & solver, const std::string & name, void * file)
-    : Hook(solver, name), _input_file((const char *)file), _raw_file(SolverSpecify::out_prefix + ".cv"), _out(_raw_file.c_str()), _n_values(0)
-{}
+CVHook::CVHook(SolverBase & solver, const std::string & name, void * param)
+    : Hook(solver, name), _raw_file(SolverSpecify::out_prefix + ".cv"), _n_values(0),
+      _ac(true), _ac_freq(1e3), _ac_solver(0)
+{
+  if( param )
+  {
+    const std::vector<Parser::Parameter> & parm_list = *((std::vector<Parser::Parameter> *)param);
+    for(std::vector<Parser::Parameter>::const_iterator parm_it = parm_list.begin();
+        parm_it != parm_list.end(); parm_it++)
+    {
+      if(parm_it->name() == "file" && parm_it->type() == Parser::STRING)
+        _raw_file = parm_it->get_string();
+      if(parm_it->name() == "ac" && parm_it->type() == Parser::BOOL)
+        _ac = parm_it->get_bool();
+      if(parm_it->name() == "freq" && parm_it->type() == Parser::REAL)
+        _ac_freq = parm_it->get_real();
+    }
+  }
+
+  if ( !Genius::processor_id() )
+    _out.open(_raw_file.c_str());
+}
 
 
 /*----------------------------------------------------------------------
  * destructor, close the raw file
  */
 CVHook::~CVHook()
-{ _out.close(); }
+{
+  if( _ac_solver )
+  {
+    _ac_solver->destroy_solver();
+    delete _ac_solver;
+  }
+  _out.close();
+}
 
 
 /*----------------------------------------------------------------------
@@ -72,6 +100,7 @@ void CVHook::on_init()
       }
     }
     _gate_charge.resize( _gate_electrodes.size() );
+    _gate_cap.resize( _gate_electrodes.size() );
   }
 
 }
@@ -108,8 +137,8 @@ void CVHook::post_solve()
         _vsweep.push_back(bc->ext_circuit()->Vapp()/PhysicalUnit::V);
       }
 
-      // skip bc which is not gate
-      if( bc->bc_type() != GateContact ) continue;
+      // skip bc which is not gate, gate charge is not required by AC capacitance
+      if( bc->bc_type() != GateContact || _ac ) continue;
 
       std::vector<double> flux_buffer;
 
@@ -169,12 +198,71 @@ void CVHook::post_solve()
       PetscScalar charge = std::accumulate(flux_buffer.begin(), flux_buffer.end(), 0.0);
       _gate_charge[elec_count++].push_back(charge/PhysicalUnit::C);
     }
+    if( _ac && !_gate_electrodes.empty() )
+    {
+      _ac_capacitance();
+      elec_count = _gate_electrodes.size();
+    }
     if (elec_count) _n_values++;
   }
 }
 
 
 
+/*----------------------------------------------------------------------
+ *  small signal gate capacitance at current DC bias, by a single frequency AC solve.
+ *  the AC matrix is built from the DC solution in the system, so the DC solver
+ *  is not disturbed except the AC variables of regions.
+ */
+void CVHook::_ac_capacitance()
+{
+  // save the AC settings and the active dof index of the DC solver
+  std::vector<std::string> electrode_acscan = SolverSpecify::Electrode_ACScan;
+  double fstart = SolverSpecify::FStart, fstop = SolverSpecify::FStop, fmultiple = SolverSpecify::FMultiple;
+  double freq = SolverSpecify::Freq;
+  bool   acmor = SolverSpecify::ACMOR;
+  bool   acnport = SolverSpecify::ACNPort;
+  unsigned int solver_index = FVM_Node::solver_index();
+
+  SolverSpecify::Electrode_ACScan.assign(1, _sweep_electrode);
+  SolverSpecify::FStart    = _ac_freq/PhysicalUnit::s;
+  SolverSpecify::FStop     = _ac_freq/PhysicalUnit::s;
+  SolverSpecify::FMultiple = 2.0;
+  SolverSpecify::ACMOR     = false;
+  SolverSpecify::ACNPort   = false;
+
+  if( !_ac_solver )
+  {
+    _ac_solver = new DDMACSolver(_solver.get_system());
+    _ac_solver->create_solver();
+  }
+  _ac_solver->solve();
+
+  const BoundaryConditionCollector * bcs = _solver.get_system().get_bcs();
+  const BoundaryCondition * ac_bc = bcs->get_bc(_sweep_electrode);
+  const double omega = 2*PI*_ac_freq;
+  for(unsigned int n=0; n<_gate_electrodes.size(); ++n)
+  {
+    const BoundaryCondition * bc = bcs->get_bc(_gate_electrodes[n]);
+    std::complex<PetscScalar> Y = 0.0;
+    if(ac_bc->ext_circuit()->potential_ac() != 0.0)
+      Y = (bc->ext_circuit()->current_ac()/PhysicalUnit::A)/(ac_bc->ext_circuit()->potential_ac()/PhysicalUnit::V);
+    _gate_cap[n].push_back( Y.imag()/omega );
+  }
+
+  SolverSpecify::Electrode_ACScan = electrode_acscan;
+  SolverSpecify::FStart    = fstart;
+  SolverSpecify::FStop     = fstop;
+  SolverSpecify::FMultiple = fmultiple;
+  SolverSpecify::Freq      = freq;
+  SolverSpecify::ACMOR     = acmor;
+  SolverSpecify::ACNPort   = acnport;
+  FVM_Node::set_solver_index(solver_index);
+  BoundaryCondition::set_solver_index(solver_index);
+}
+
+
+
 /*----------------------------------------------------------------------
  *  This is executed after each (nonlinear) iteration
  */
@@ -206,6 +294,21 @@ void CVHook::on_close()
 
       _out << std::endl;
 
+      if( _ac )
+      {
+        for(unsigned int i=0; i<_n_values; i++)
+        {
+          _out << _vsweep[i];
+          for (unsigned int n=0; n<_gate_cap.size(); n++)
+            _out << "\t" << _gate_cap[n][i];
+          _out << std::endl;
+        }
+        return;
+      }
+
+      // quasi-static capacitance needs at least 2 points
+      if( _n_values < 2 ) return;
+
       {
         unsigned int i=0;
         _out << _vsweep[i];
@@ -29,7 +29,7 @@
 #include <dlfcn.h>
 
 DllHook::DllHook(SolverBase & solver, const std::string & name, void * fun_data)
-:Hook(solver, name), dll_handle(0), hook(0)
+:Hook(solver, name), dll_handle(0), hook(0), c_hook(0)
 {
   char * error;
 
@@ -55,6 +55,15 @@ DllHook::DllHook(SolverBase & solver, const std::string & name, void * fun_data)
   error = dlerror();
   if(error)
   {
+    // plain C hook
+    GENIUS_GET_C_HOOK * get_c_hook = (GENIUS_GET_C_HOOK *) dlsym(dll_handle, "genius_get_c_hook");
+    if( !dlerror() && get_c_hook )
+    {
+      c_hook = (*get_c_hook)(_name.c_str(), fun_data);
+      genius_assert(c_hook);
+      return;
+    }
+
     std::cerr<< "Load hook faild: "<< error << std::endl;
     dll_handle = NULL;
     return;
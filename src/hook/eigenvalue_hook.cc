@@ -20,6 +20,7 @@
 /********************************************************************************/
 
 #include "genius_common.h"
+#include "parser.h"
 #include "fvm_nonlinear_solver.h"
 #include "eigenvalue_hook.h"
 
@@ -28,12 +29,24 @@
  * constructor, open the file for writing
  */
 EigenValueHook::EigenValueHook ( SolverBase & solver, const std::string & name, void * param )
-    : Hook ( solver, name )
+    : Hook ( solver, name ), _n_eigen(5), _reuse_pc(true), _on_iteration(false), _vec_created(false)
 {
   this->_poisson_solver = false;
   this->_ddm_solver = false;
   this->solution_count=0;
   this->iteration_count=0;
+
+  if( param )
+  {
+    const std::vector<Parser::Parameter> & parm_list = *((std::vector<Parser::Parameter> *)param);
+    for ( std::vector<Parser::Parameter>::const_iterator parm_it = parm_list.begin();
+          parm_it != parm_list.end(); parm_it++ )
+    {
+      if( parm_it->name() == "n" )         _n_eigen = std::max(1, parm_it->get_int());
+      if( parm_it->name() == "reuse.pc" )  _reuse_pc = parm_it->get_bool();
+      if( parm_it->name() == "iteration" ) _on_iteration = parm_it->get_bool();
+    }
+  }
 }
 
 
@@ -87,6 +100,9 @@ void EigenValueHook::pre_solve()
  */
 void EigenValueHook::post_solve()
 {
+  // the jacobian and its factorization of the last newton iteration are still there
+  if( !_on_iteration ) this->_eigen_value();
+
   this->solution_count++;
   this->iteration_count=0;
 }
@@ -104,16 +120,32 @@ void EigenValueHook::pre_iteration()
  *  This is executed after each (nonlinear) iteration
  */
 void EigenValueHook::post_iteration()
+{
+  if( _on_iteration ) this->_eigen_value();
+  this->iteration_count++;
+}
+
+
+
+/*----------------------------------------------------------------------
+ *  calculate the eigen values of current jacobian matrix
+ */
+void EigenValueHook::_eigen_value()
 {
   FVM_NonlinearSolver & nonlinear_solver = dynamic_cast<FVM_NonlinearSolver &>(_solver);
-  const SimulationSystem &system = nonlinear_solver.get_system();
 
-  // create a vector for eigenvector
-  Vec Vrs;
-  nonlinear_solver.create_vector(Vrs);
+  // eigen vectors are kept between runs, the ones of last run are the initial space of next run
+  if( !_vec_created )
+  {
+    nonlinear_solver.create_vector(_vs);
+    nonlinear_solver.create_vector(_vl);
+    VecSet(_vs, 0.0);
+    VecSet(_vl, 0.0);
+    _vec_created = true;
+  }
 
   // calculate the eigen value as well as the smallest eigen vector
-  nonlinear_solver.eigen_value_of_jacobian_matrix(5, 0, Vrs);
+  nonlinear_solver.eigen_value_of_jacobian_matrix(_n_eigen, 0, _vs, 0, _vl, _reuse_pc);
 
 #if 0
   // export the value of eigen vector to vtk file
@@ -123,7 +155,7 @@ void EigenValueHook::post_iteration()
     std::ostringstream vtk_filename;
     vtk_filename << vtk_prefix << '.' << this->solution_count<< '.' << this->iteration_count << ".vtu";
     // save the value of eigen vector to mesh nodes
-    nonlinear_solver.flush_system(Vrs);
+    nonlinear_solver.flush_system(_vs);
     system.export_vtk ( vtk_filename.str(), false );
   }
 #endif
@@ -134,13 +166,9 @@ void EigenValueHook::post_iteration()
     std::string vector_prefix = SolverSpecify::out_prefix+".eigenvector";
     std::ostringstream vector_filename;
     vector_filename << vector_prefix << '.' << this->solution_count<< '.' << this->iteration_count << ".vec";
-    nonlinear_solver.dump_vector_petsc(Vrs, vector_filename.str());
+    nonlinear_solver.dump_vector_petsc(_vs, vector_filename.str());
   }
 #endif
-
-  this->iteration_count++;
-
-  nonlinear_solver.destroy_vector(Vrs);
 }
 
 
@@ -149,7 +177,15 @@ void EigenValueHook::post_iteration()
  * This is executed after the finalization of the solver
  */
 void EigenValueHook::on_close()
-{}
+{
+  if( _vec_created )
+  {
+    FVM_NonlinearSolver & nonlinear_solver = dynamic_cast<FVM_NonlinearSolver &>(_solver);
+    nonlinear_solver.destroy_vector(_vs);
+    nonlinear_solver.destroy_vector(_vl);
+    _vec_created = false;
+  }
+}
 
 
 #ifdef DLLHOOK
@@ -111,6 +111,7 @@ void GnuplotHook::post_solve()
     _out<< std::scientific << std::right;
 
     if( SolverSpecify::Type==SolverSpecify::DCSWEEP ||
+        SolverSpecify::Type==SolverSpecify::BSWEEP  ||
         SolverSpecify::Type==SolverSpecify::OP      ||
         SolverSpecify::Type==SolverSpecify::TRACE   ||
         SolverSpecify::Type==SolverSpecify::TRANSIENT )
@@ -122,6 +123,13 @@ void GnuplotHook::post_solve()
         _out << std::setw(15) << SolverSpecify::dt/PhysicalUnit::s;
       }
 
+      // the swept magnetic field
+      if (SolverSpecify::Type == SolverSpecify::BSWEEP)
+      {
+        const VectorValue<double> & B = this->get_solver().get_system().get_magnetic_field();
+        _out << B(SolverSpecify::BDirection)/(PhysicalUnit::V/(PhysicalUnit::m*PhysicalUnit::m)*PhysicalUnit::s) << '\t';
+      }
+
 
       if( _mixA )
       {
@@ -274,6 +282,8 @@ void  GnuplotHook::_write_gnuplot_head()
         _out << "# Plotname: OP" << std::endl; break;
       case SolverSpecify::TRACE     :
         _out << "# Plotname: DC curve trace" << std::endl; break;
+      case SolverSpecify::BSWEEP    :
+        _out << "# Plotname: Magnetic field sweep" << std::endl; break;
       case SolverSpecify::TRANSIENT :
         _out << "# Plotname: Transient Analysis" << std::endl; break;
       case SolverSpecify::ACSWEEP   :
@@ -285,6 +295,7 @@ void  GnuplotHook::_write_gnuplot_head()
     _out << "# Variables: " << std::endl;
 
     if( SolverSpecify::Type==SolverSpecify::DCSWEEP ||
+        SolverSpecify::Type==SolverSpecify::BSWEEP  ||
         SolverSpecify::Type==SolverSpecify::OP      ||
         SolverSpecify::Type==SolverSpecify::TRACE   ||
         SolverSpecify::Type==SolverSpecify::TRANSIENT )
@@ -297,6 +308,12 @@ void  GnuplotHook::_write_gnuplot_head()
         _out << '#' <<'\t' << ++n_var <<'\t' << "time_step" << " [s]"<< std::endl;
       }
 
+      if ( SolverSpecify::Type == SolverSpecify::BSWEEP )
+      {
+        std::string component = std::string("B") + "xyz"[SolverSpecify::BDirection];
+        _out << '#' <<'\t' << ++n_var <<'\t' << component << " [T]"<< std::endl;
+      }
+
       if( _mixA ) // mix mode
       {
         const SPICE_CKT * spice_ckt = this->get_solver().get_system().get_circuit();
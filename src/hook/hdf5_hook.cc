@@ -0,0 +1,224 @@
+/********************************************************************************/
+/*     888888    888888888   88     888  88888   888      888    88888888       */
+/*   8       8   8           8 8     8     8      8        8    8               */
+/*  8            8           8  8    8     8      8        8    8               */
+/*  8            888888888   8   8   8     8      8        8     8888888        */
+/*  8      8888  8           8    8  8     8      8        8            8       */
+/*   8       8   8           8     8 8     8      8        8            8       */
+/*     888888    888888888  888     88   88888     88888888     88888888        */
+/*                                                                              */
+/*       A Three-Dimensional General Purpose Semiconductor Simulator.           */
+/*                                                                              */
+/*                                                                              */
+/*  Copyright (C) 2007-2008                                                     */
+/*  Cogenda Pte Ltd                                                             */
+/*                                                                              */
+/*  Please contact Cogenda Pte Ltd for license information                      */
+/*                                                                              */
+/*  Author: Gong Ding   gdiso@ustc.edu                                          */
+/*                                                                              */
+/********************************************************************************/
+
+#include <cstdlib>
+#include <iomanip>
+
+#include "solver_base.h"
+#include "hdf5_hook.h"
+#include "spice_ckt.h"
+#include "MXMLUtil.h"
+
+
+/*----------------------------------------------------------------------
+ * constructor, write the mesh and the initial solution
+ */
+HDF5Hook::HDF5Hook ( SolverBase & solver, const std::string & name, void * param)
+    : Hook ( solver, name ), _hdf5_file ( SolverSpecify::out_prefix + ".h5" ),
+      _single_precision ( false ), _compression ( 1 ), _ddm ( false ), _mixA ( false )
+{
+  this->count  =0;
+  this->_t_step=0;
+  this->_v_step=0;
+  this->_i_step=0;
+  this->_t_last=0;
+  this->_v_last=0;
+  this->_i_last=0;
+
+  const std::vector<Parser::Parameter> & parm_list = *((std::vector<Parser::Parameter> *)param);
+  for ( std::vector<Parser::Parameter>::const_iterator parm_it = parm_list.begin();
+        parm_it != parm_list.end(); parm_it++ )
+  {
+    if ( parm_it->name() == "tstep" && parm_it->type() == Parser::REAL )
+      _t_step=parm_it->get_real() * PhysicalUnit::s;
+    if ( parm_it->name() == "vstep" && parm_it->type() == Parser::REAL )
+      _v_step=parm_it->get_real() * PhysicalUnit::V;
+    if ( parm_it->name() == "istep" && parm_it->type() == Parser::REAL )
+      _i_step=parm_it->get_real() * PhysicalUnit::A;
+    if ( parm_it->name() == "single" && parm_it->type() == Parser::BOOL )
+      _single_precision=parm_it->get_bool();
+    if ( parm_it->name() == "compress" && parm_it->type() == Parser::INTEGER )
+      _compression=std::max ( parm_it->get_int(), 0 );
+  }
+
+  SolverSpecify::SolverType solver_type = this->get_solver().solver_type();
+
+  // if we are called by mixA solver?
+  switch ( solver_type )
+  {
+    case SolverSpecify::DDML1     :
+    case SolverSpecify::DDML2     :
+    case SolverSpecify::EBML3     :   _ddm = true; break;
+    case SolverSpecify::DDML1MIXA :
+    case SolverSpecify::DDML2MIXA :
+    case SolverSpecify::EBML3MIXA :   _mixA = true; break;
+    default : break;
+  }
+
+  _write_step ( SolverSpecify::clock/PhysicalUnit::ps );
+}
+
+
+/*----------------------------------------------------------------------
+ * destructor, close file
+ */
+HDF5Hook::~HDF5Hook()
+{}
+
+
+/*----------------------------------------------------------------------
+ *   This is executed before the initialization of the solver
+ */
+void HDF5Hook::on_init()
+{}
+
+
+
+/*----------------------------------------------------------------------
+ *   This is executed previously to each solution step.
+ */
+void HDF5Hook::pre_solve()
+{}
+
+
+
+/*----------------------------------------------------------------------
+ *  This is executed after each solution step.
+ */
+void HDF5Hook::post_solve()
+{
+  if ( SolverSpecify::Type==SolverSpecify::DCSWEEP && SolverSpecify::Electrode_VScan.size() )
+  {
+    double Vscan = 0;
+
+    // DDM solver
+    if ( _ddm )
+    {
+      const BoundaryConditionCollector * bcs = _solver.get_system().get_bcs();
+      const BoundaryCondition * bc = bcs->get_bc ( SolverSpecify::Electrode_VScan[0] );
+      Vscan = bc->ext_circuit()->Vapp();
+    }
+
+    // MIXA solver
+    if ( _mixA )
+    {
+      SPICE_CKT * spice_ckt = _solver.get_system().get_circuit();
+      Vscan = spice_ckt->get_voltage_from_sync ( SolverSpecify::Electrode_VScan[0] );
+    }
+
+    if ( std::fabs ( Vscan - this->_v_last ) >= this->_v_step )
+    {
+      _write_step ( Vscan/PhysicalUnit::V );
+      _v_last = Vscan;
+    }
+  }
+
+  if ( SolverSpecify::Type==SolverSpecify::DCSWEEP && SolverSpecify::Electrode_IScan.size() )
+  {
+    double Iscan = 0;
+
+    // DDM solver
+    if ( _ddm )
+    {
+      const BoundaryConditionCollector * bcs = _solver.get_system().get_bcs();
+      const BoundaryCondition * bc = bcs->get_bc ( SolverSpecify::Electrode_IScan[0] );
+      Iscan = bc->ext_circuit()->Iapp();
+    }
+
+    // MIXA solver
+    if ( _mixA )
+    {
+      SPICE_CKT * spice_ckt = _solver.get_system().get_circuit();
+      Iscan = spice_ckt->get_current_from_sync ( SolverSpecify::Electrode_IScan[0] );
+    }
+
+    if ( std::fabs ( Iscan - this->_i_last ) >= this->_i_step )
+    {
+      _write_step ( Iscan/PhysicalUnit::A );
+      _i_last = Iscan;
+    }
+  }
+
+  if ( SolverSpecify::Type==SolverSpecify::OP || SolverSpecify::Type==SolverSpecify::TRACE )
+    _write_step ( this->count );
+
+  if ( SolverSpecify::Type==SolverSpecify::TRANSIENT )
+  {
+    if ( SolverSpecify::clock - this->_t_last >= this->_t_step )
+    {
+      _write_step ( SolverSpecify::clock/PhysicalUnit::ps );
+      _t_last = SolverSpecify::clock;
+    }
+  }
+
+  if ( SolverSpecify::Type==SolverSpecify::ACSWEEP )
+    _write_step ( SolverSpecify::Freq*PhysicalUnit::us );
+}
+
+
+
+/*----------------------------------------------------------------------
+ *  This is executed after each (nonlinear) iteration
+ */
+void HDF5Hook::post_iteration()
+{}
+
+
+
+/*----------------------------------------------------------------------
+ * This is executed after the finalization of the solver
+ */
+void HDF5Hook::on_close()
+{}
+
+
+
+void HDF5Hook::_write_step(double t)
+{
+  // the first step overwrites the file, the mesh is written only once
+  const SimulationSystem &system = get_solver().get_system();
+  system.export_hdf5 ( _hdf5_file, this->count++ > 0, t, _single_precision, _compression );
+
+  mxml_node_t *eSolution = get_solver().current_dom_solution_elem();
+  if ( eSolution )
+  {
+    mxml_node_t *eOutput  = mxmlFindElement ( eSolution, eSolution, "output", NULL, NULL, MXML_DESCEND_FIRST );
+    mxml_node_t *eHDF5    = mxmlNewElement ( eOutput, "hdf5" );
+    mxml_node_t *eFile    = mxmlNewElement ( eHDF5, "file" );
+    mxmlAdd ( eFile, MXML_ADD_AFTER, NULL, MXMLQVariant::makeQVString ( _hdf5_file ) );
+  }
+}
+
+
+#ifdef DLLHOOK
+
+// dll interface
+extern "C"
+{
+  Hook* get_hook ( SolverBase & solver, const std::string & name, void * fun_data )
+  {
+    return new HDF5Hook ( solver, name, fun_data );
+  }
+
+}
+
+#endif
+
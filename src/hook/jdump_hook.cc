@@ -0,0 +1,156 @@
+/********************************************************************************/
+/*     888888    888888888   88     888  88888   888      888    88888888       */
+/*   8       8   8           8 8     8     8      8        8    8               */
+/*  8            8           8  8    8     8      8        8    8               */
+/*  8            888888888   8   8   8     8      8        8     8888888        */
+/*  8      8888  8           8    8  8     8      8        8            8       */
+/*   8       8   8           8     8 8     8      8        8            8       */
+/*     888888    888888888  888     88   88888     88888888     88888888        */
+/*                                                                              */
+/*       A Three-Dimensional General Purpose Semiconductor Simulator.           */
+/*                                                                              */
+/*                                                                              */
+/*  Copyright (C) 2007-2008                                                     */
+/*  Cogenda Pte Ltd                                                             */
+/*                                                                              */
+/*  Please contact Cogenda Pte Ltd for license information                      */
+/*                                                                              */
+/*  Author: Gong Ding   gdiso@ustc.edu                                          */
+/*                                                                              */
+/********************************************************************************/
+
+#include <sstream>
+#include <algorithm>
+#include <iostream>
+
+#include "solver_base.h"
+#include "fvm_nonlinear_solver.h"
+#include "csr_dump_writer.h"
+#include "jdump_hook.h"
+#include "parallel.h"
+
+/*
+ * usage: HOOK Load=jdump string<file>=(file prefix) bool<diverged>=(true|false) bool<threshold>=(true|false)
+ *        bool<rhs>=(true|false) int<max>=(max dumps)
+ * <file>      the dumps are written to prefix.n.csr, or prefix.n.csr.<processor id> in parallel. default is out_prefix.jac
+ * <diverged>  dump when the Newton iteration diverges, default true
+ * <threshold> dump when ThresholdHook is violated, default true
+ * <rhs>       also dump the residual vector, default true
+ * <max>       at most max dumps are written, default 5
+ */
+
+/*----------------------------------------------------------------------
+ * constructor
+ */
+JacobianDumpHook::JacobianDumpHook ( SolverBase & solver, const std::string & name, void * param)
+    : Hook ( solver, name ), _prefix ( SolverSpecify::out_prefix + ".jac" ),
+      _on_diverged(true), _on_threshold(true), _rhs(true), _max_dumps(5), _n_dumps(0)
+{
+  const std::vector<Parser::Parameter> & parm_list = *((std::vector<Parser::Parameter> *)param);
+  for ( std::vector<Parser::Parameter>::const_iterator parm_it = parm_list.begin();
+        parm_it != parm_list.end(); parm_it++ )
+  {
+    if( parm_it->name() == "file" && parm_it->type() == Parser::STRING )
+      _prefix = parm_it->get_string();
+    if( parm_it->name() == "diverged" && parm_it->type() == Parser::BOOL )
+      _on_diverged = parm_it->get_bool();
+    if( parm_it->name() == "threshold" && parm_it->type() == Parser::BOOL )
+      _on_threshold = parm_it->get_bool();
+    if( parm_it->name() == "rhs" && parm_it->type() == Parser::BOOL )
+      _rhs = parm_it->get_bool();
+    if( parm_it->name() == "max" && parm_it->type() == Parser::INTEGER )
+      _max_dumps = std::max(parm_it->get_int(), 0);
+  }
+
+  if( dynamic_cast<FVM_NonlinearSolver *>(&solver) == NULL )
+  {
+    if( Genius::is_first_processor() )
+      std::cerr<<"JacobianDumpHook: the solver has no jacobian matrix, no dump will be written." << std::endl;
+    _max_dumps = 0;
+  }
+}
+
+
+/*----------------------------------------------------------------------
+ * destructor
+ */
+JacobianDumpHook::~JacobianDumpHook()
+{}
+
+
+/*----------------------------------------------------------------------
+ *   This is executed before the initialization of the solver
+ */
+void JacobianDumpHook::on_init()
+{}
+
+
+
+/*----------------------------------------------------------------------
+ *   This is executed previously to each solution step.
+ */
+void JacobianDumpHook::pre_solve()
+{}
+
+
+
+/*----------------------------------------------------------------------
+ *  This is executed after each solution step.
+ */
+void JacobianDumpHook::post_solve()
+{}
+
+
+
+/*----------------------------------------------------------------------
+ *  This is executed after each (nonlinear) iteration
+ */
+void JacobianDumpHook::post_iteration()
+{}
+
+
+
+/*----------------------------------------------------------------------
+ * This is executed after the finalization of the solver
+ */
+void JacobianDumpHook::on_close()
+{
+  // the files are complete before the next solver reads them
+  CSRDumpWriter::wait();
+}
+
+
+
+void JacobianDumpHook::on_trigger(const std::string & source)
+{
+  if( source == "diverged"  && !_on_diverged  ) return;
+  if( source == "threshold" && !_on_threshold ) return;
+  if( source != "diverged"  && source != "threshold" ) return;
+  if( _n_dumps >= _max_dumps ) return;
+
+  const FVM_NonlinearSolver & nonlinear_solver = dynamic_cast<const FVM_NonlinearSolver &>(_solver);
+
+  std::stringstream ss;
+  ss << _prefix << '.' << _n_dumps << ".csr";
+
+  nonlinear_solver.dump_matrix_csr(nonlinear_solver.jacobian_matrix(), _rhs ? nonlinear_solver.rhs_vector() : PETSC_NULL, ss.str());
+  _n_dumps++;
+
+  if( Genius::is_first_processor() )
+    std::cout << "JacobianDumpHook: " << source << ", jacobian matrix dumped to " << ss.str() << std::endl;
+}
+
+
+#ifdef DLLHOOK
+
+// dll interface
+extern "C"
+{
+  Hook* get_hook ( SolverBase & solver, const std::string & name, void * fun_data )
+  {
+    return new JacobianDumpHook ( solver, name, fun_data );
+  }
+
+}
+
+#endif
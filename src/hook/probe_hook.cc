@@ -23,6 +23,7 @@
 #include <cstdlib>
 #include <ctime>
 #include <iomanip>
+#include <algorithm>
 
 #include "solver_base.h"
 #include "probe_hook.h"
@@ -36,8 +37,9 @@ ProbeHook::ProbeHook(SolverBase & solver, const std::string & name, void * param
     : Hook(solver, name), _probe_file(SolverSpecify::out_prefix + ".probe")
 {
   _p_solver = & solver;
-  _p_fvm_node   = NULL;
   _min_loc = invalid_uint;
+  _n_var = 0;
+  _buffered_lines = 0;
 
   const std::vector<Parser::Parameter> & parm_list = *((std::vector<Parser::Parameter> *)param);
   for(std::vector<Parser::Parameter>::const_iterator parm_it = parm_list.begin();
@@ -66,61 +68,169 @@ ProbeHook::ProbeHook(SolverBase & solver, const std::string & name, void * param
 ProbeHook::~ProbeHook()
 {
   if ( !Genius::processor_id() )
+  {
+    _flush();
     _out.close();
+  }
 }
 
 
 /*----------------------------------------------------------------------
- *   This is executed before the initialization of the solver
+ * write buffered lines to file
  */
-void ProbeHook::on_init()
+void ProbeHook::_flush()
 {
+  if( !_buffered_lines ) return;
+  _out << _buffer.str();
+  _out.flush();
+  _buffer.str("");
+  _buffered_lines = 0;
+}
+
+
+/*----------------------------------------------------------------------
+ * find the local elem contains probe point, and build the interpolation
+ * stencil on its nodes. barycentric weights are used for simplex elems,
+ * inverse distance weights for others.
+ */
+bool ProbeHook::_build_elem_stencil()
+{
+  _stencil.clear();
 
-  double min_dis = 1e100;
   for( unsigned int r=0; r<_p_solver->get_system().n_regions(); r++)
   {
     const SimulationRegion * region = _p_solver->get_system().region(r);
 
-    SimulationRegion::const_processor_node_iterator node_it = region->on_processor_nodes_begin();
-    SimulationRegion::const_processor_node_iterator node_it_end = region->on_processor_nodes_end();
-    for(; node_it!=node_it_end; ++node_it)
+    SimulationRegion::const_element_iterator it = region->elements_begin();
+    SimulationRegion::const_element_iterator it_end = region->elements_end();
+    for(; it!=it_end; ++it)
     {
-      const FVM_Node * fvm_node = *node_it;
-      const Node * node = fvm_node->root_node();
+      const Elem * elem = *it;
+      if( elem->processor_id() != Genius::processor_id() ) continue;
+      if( !elem->contains_point(_pp) ) continue;
 
-      double dis = ((*node)-_pp).size();
-      if(dis<min_dis)
+      std::vector<Real> w(elem->n_nodes(), 0.0);
+      const Point & a = elem->point(0);
+      if( elem->dim()==2 && elem->n_nodes()==3 )
+      {
+        const Point & b = elem->point(1);
+        const Point & c = elem->point(2);
+        Point A = (b-a).cross(c-a);
+        Real A2 = A*A;
+        w[0] = ((b-_pp).cross(c-_pp))*A/A2;
+        w[1] = ((c-_pp).cross(a-_pp))*A/A2;
+        w[2] = 1.0 - w[0] - w[1];
+      }
+      else if( elem->dim()==3 && elem->n_nodes()==4 )
       {
-        min_dis = dis;
-        _p_fvm_node = fvm_node;
+        const Point & b = elem->point(1);
+        const Point & c = elem->point(2);
+        const Point & d = elem->point(3);
+        Real V  = (b-a)*((c-a).cross(d-a));
+        w[1] = (_pp-a)*((c-a).cross(d-a))/V;
+        w[2] = (b-a)*((_pp-a).cross(d-a))/V;
+        w[3] = (b-a)*((c-a).cross(_pp-a))/V;
+        w[0] = 1.0 - w[1] - w[2] - w[3];
       }
+      else
+      {
+        Real sum = 0.0;
+        for(unsigned int n=0; n<elem->n_nodes(); ++n)
+        {
+          Real dis = (elem->point(n)-_pp).size();
+          // probe point on the node
+          if( dis < 1e-6*elem->hmax() )
+          {
+            std::fill(w.begin(), w.end(), 0.0);
+            w[n] = 1.0; sum = 1.0;
+            break;
+          }
+          w[n] = 1.0/dis;
+          sum += w[n];
+        }
+        for(unsigned int n=0; n<elem->n_nodes(); ++n)
+          w[n] /= sum;
+      }
+
+      for(unsigned int n=0; n<elem->n_nodes(); ++n)
+      {
+        const FVM_Node * fvm_node = region->region_fvm_node(elem->get_node(n));
+        if( fvm_node && w[n]!=0.0 )
+          _stencil.push_back( std::make_pair(fvm_node, w[n]) );
+      }
+      return !_stencil.empty();
     }
   }
 
-  // after this call, the _min_loc contains processor_id with minimal min_dis
-  Parallel::min_loc(min_dis, _min_loc);
+  return false;
+}
+
+
+/*----------------------------------------------------------------------
+ *   This is executed before the initialization of the solver
+ */
+void ProbeHook::on_init()
+{
+  // the processor owns the elem contains probe point holds the stencil
+  bool found = _build_elem_stencil();
+  double flag = found ? 0.0 : 1.0;
+  Parallel::min_loc(flag, _min_loc);
+
+  // probe point out of mesh, fall back to the nearest node
+  if( flag > 0.0 )
+  {
+    _stencil.clear();
+    const FVM_Node * nearest_node = NULL;
+    double min_dis = 1e100;
+    for( unsigned int r=0; r<_p_solver->get_system().n_regions(); r++)
+    {
+      const SimulationRegion * region = _p_solver->get_system().region(r);
+
+      SimulationRegion::const_processor_node_iterator node_it = region->on_processor_nodes_begin();
+      SimulationRegion::const_processor_node_iterator node_it_end = region->on_processor_nodes_end();
+      for(; node_it!=node_it_end; ++node_it)
+      {
+        const FVM_Node * fvm_node = *node_it;
+        const Node * node = fvm_node->root_node();
+
+        double dis = ((*node)-_pp).size();
+        if(dis<min_dis)
+        {
+          min_dis = dis;
+          nearest_node = fvm_node;
+        }
+      }
+    }
+
+    // after this call, the _min_loc contains processor_id with minimal min_dis
+    Parallel::min_loc(min_dis, _min_loc);
+
+    if (Genius::processor_id() == _min_loc)
+    {
+      _stencil.push_back( std::make_pair(nearest_node, 1.0) );
+      _pp = *nearest_node->root_node();
+    }
+  }
+  else if (Genius::processor_id() != _min_loc)
+    _stencil.clear();
 
   double x,y,z;
   std::string region;
   std::vector<std::string> var_name;
-  int n_var;
-
-  x = (*_p_fvm_node->root_node())(0);
-  y = (*_p_fvm_node->root_node())(1);
-  z = (*_p_fvm_node->root_node())(2);
-  region = _p_solver->get_system().region(_p_fvm_node->subdomain_id())->label();
-  Parallel::broadcast(x, _min_loc);
-  Parallel::broadcast(y, _min_loc);
-  Parallel::broadcast(z, _min_loc);
-  Parallel::broadcast(region, _min_loc);
+  int n_stencil = _stencil.size();
 
   if (Genius::processor_id() == _min_loc)
   {
-    const FVM_NodeData * node_data = _p_fvm_node->node_data();
+    x = _pp(0);
+    y = _pp(1);
+    z = _pp(2);
+    region = _p_solver->get_system().region(_stencil[0].first->subdomain_id())->label();
+
+    const FVM_NodeData * node_data = _stencil[0].first->node_data();
     switch (node_data->type())
     {
       case FVM_NodeData::SemiconductorData:
-        n_var = 3;
+        _n_var = 3;
         var_name.push_back("psi [V]");
         var_name.push_back("n [cm^-3]");
         var_name.push_back("p [cm^-3]");
@@ -128,18 +238,22 @@ void ProbeHook::on_init()
       case FVM_NodeData::InsulatorData:
       case FVM_NodeData::ConductorData:
       case FVM_NodeData::ResistanceData:
-        n_var = 1;
+        _n_var = 1;
         var_name.push_back("psi [V]");
         break;
       default:
-        n_var = 0;
+        _n_var = 0;
     }
-
   }
 
-  Parallel::broadcast(n_var, _min_loc);
-  var_name.resize(n_var);
-  for(int i=0; i<n_var; i++)
+  Parallel::broadcast(x, _min_loc);
+  Parallel::broadcast(y, _min_loc);
+  Parallel::broadcast(z, _min_loc);
+  Parallel::broadcast(region, _min_loc);
+  Parallel::broadcast(n_stencil, _min_loc);
+  Parallel::broadcast(_n_var, _min_loc);
+  var_name.resize(_n_var);
+  for(int i=0; i<_n_var; i++)
     Parallel::broadcast(var_name[i], _min_loc);
 
   if ( !Genius::processor_id() )
@@ -150,9 +264,10 @@ void ProbeHook::on_init()
     _out << "# Title: Gnuplot File Created by Genius TCAD Simulation" << std::endl;
     _out << "# Date: " << ctime(&_time) << std::endl;
     _out << "# Plotname: Probe"  << std::endl;
-    _out << "# Node location (um): ";
+    _out << "# Probe location (um): ";
     _out << "x=" << x/PhysicalUnit::um << "\ty=" << y/PhysicalUnit::um << "\tz=" << z/PhysicalUnit::um << std::endl;
-    _out << "# Node in region: " << region << std::endl;
+    _out << "# Probe in region: " << region << std::endl;
+    _out << "# Interpolated from " << n_stencil << " node(s)" << std::endl;
     _out << "# Variables: " << std::endl;
     int cCnt=0;
 
@@ -174,7 +289,7 @@ void ProbeHook::on_init()
       _out << '#' << std::setw(10) << ++cCnt << std::setw(20) << "Time [s]"  << std::endl;
     }
 
-    for(int i=0; i<n_var; i++)
+    for(int i=0; i<_n_var; i++)
     {
       _out << '#' << std::setw(10) << ++cCnt << std::setw(20) << var_name[i]  << std::endl;
     }
@@ -196,43 +311,44 @@ void ProbeHook::pre_solve()
  */
 void ProbeHook::post_solve()
 {
-  int n_var;
-  std::vector<double> var;
-  if (Genius::processor_id() == _min_loc)
+  if(!_n_var) return;
+
+  // only the stencil owner has nonzero contribution, a single sum collects it
+  std::vector<double> var(_n_var, 0.0);
+  for(unsigned int i=0; i<_stencil.size(); ++i)
   {
-    const FVM_NodeData * node_data = _p_fvm_node->node_data();
+    const FVM_NodeData * node_data = _stencil[i].first->node_data();
+    const Real w = _stencil[i].second;
     switch (node_data->type())
     {
       case FVM_NodeData::SemiconductorData:
-        n_var = 3;
-        var.push_back(node_data->psi()/PhysicalUnit::V);
-        var.push_back(node_data->n()/std::pow(PhysicalUnit::cm, -3));
-        var.push_back(node_data->p()/std::pow(PhysicalUnit::cm, -3));
+        var[0] += w*node_data->psi()/PhysicalUnit::V;
+        if(_n_var == 3)
+        {
+          var[1] += w*node_data->n()/std::pow(PhysicalUnit::cm, -3);
+          var[2] += w*node_data->p()/std::pow(PhysicalUnit::cm, -3);
+        }
         break;
       case FVM_NodeData::InsulatorData:
       case FVM_NodeData::ConductorData:
       case FVM_NodeData::ResistanceData:
-        n_var = 1;
-        var.push_back(node_data->psi()/PhysicalUnit::V);
+        var[0] += w*node_data->psi()/PhysicalUnit::V;
         break;
-      default:
-        n_var = 0;
+      default: break;
     }
   }
 
-  Parallel::broadcast(n_var,_min_loc);
-  if(n_var)
-    Parallel::broadcast(var,_min_loc);
+  Parallel::sum(var);
 
   if ( !Genius::processor_id() )
   {
     // set the float number precision
-    _out.precision(6);
+    _buffer.precision(6);
 
     // set output width and format
-    _out<< std::scientific << std::right;
+    _buffer<< std::scientific << std::right;
 
-    _out<<' ';
+    _buffer<<' ';
 
     // DC Sweep
     if( SolverSpecify::Type==SolverSpecify::DCSWEEP || SolverSpecify::Type==SolverSpecify::TRACE )
@@ -243,26 +359,30 @@ void ProbeHook::post_solve()
         for(unsigned int n=0; n<SolverSpecify::Electrode_VScan.size(); ++n)
       {
         const BoundaryCondition * bc = bcs->get_bc(SolverSpecify::Electrode_VScan[n]);
-        _out << std::setw(20) << bc->ext_circuit()->Vapp()/PhysicalUnit::V;
+        _buffer << std::setw(20) << bc->ext_circuit()->Vapp()/PhysicalUnit::V;
       }
 
       if ( SolverSpecify::Electrode_IScan.size() )
         for(unsigned int n=0; n<SolverSpecify::Electrode_IScan.size(); ++n)
       {
         const BoundaryCondition * bc = bcs->get_bc(SolverSpecify::Electrode_IScan[n]);
-        _out << std::setw(20) << bc->ext_circuit()->Iapp()/PhysicalUnit::A;
+        _buffer << std::setw(20) << bc->ext_circuit()->Iapp()/PhysicalUnit::A;
       }
     }
 
     if(SolverSpecify::Type==SolverSpecify::TRANSIENT)
     {
-      _out << std::setw(15) << SolverSpecify::clock/PhysicalUnit::s;
+      _buffer << std::setw(15) << SolverSpecify::clock/PhysicalUnit::s;
     }
 
     for(unsigned int i=0; i<var.size(); i++)
-      _out << std::setw(15) << var[i];
+      _buffer << std::setw(15) << var[i];
 
-    _out << std::endl;
+    _buffer << '\n';
+
+    // flush by block
+    if( ++_buffered_lines >= 64 )
+      _flush();
   }
 }
 
@@ -280,7 +400,10 @@ void ProbeHook::post_iteration()
  * This is executed after the finalization of the solver
  */
 void ProbeHook::on_close()
-{}
+{
+  if ( !Genius::processor_id() )
+    _flush();
+}
 
 
 #ifdef DLLHOOK
@@ -24,6 +24,7 @@
 #include <string>
 #include <cstdlib>
 #include <iomanip>
+#include <algorithm>
 
 #include "solver_base.h"
 #include "rawfile_hook.h"
@@ -32,11 +33,28 @@
 /*----------------------------------------------------------------------
  * constructor, open the rawfile for writing
  */
-RawFileHook::RawFileHook(SolverBase & solver, const std::string & name, void * file)
-    : Hook(solver, name), _input_file((const char *)file), _raw_file(SolverSpecify::out_prefix + ".raw"), _mixA(false), _n_values(0)
+RawFileHook::RawFileHook(SolverBase & solver, const std::string & name, void * param)
+    : Hook(solver, name), _raw_file(SolverSpecify::out_prefix + ".raw"), _binary(false), _writer(0), _mixA(false)
 {
+  if( param )
+  {
+    const std::vector<Parser::Parameter> & parm_list = *((std::vector<Parser::Parameter> *)param);
+    for(std::vector<Parser::Parameter>::const_iterator parm_it = parm_list.begin();
+        parm_it != parm_list.end(); parm_it++)
+    {
+      if(parm_it->name() == "file" && parm_it->type() == Parser::STRING)
+        _raw_file = parm_it->get_string();
+      if(parm_it->name() == "binary" && parm_it->type() == Parser::BOOL)
+        _binary = parm_it->get_bool();
+      if(parm_it->name() == "electrode" && parm_it->type() == Parser::STRING)
+        _electrodes = parm_it->get_array<std::string>();
+      if(parm_it->name() == "quantity" && parm_it->type() == Parser::STRING)
+        _quantities = parm_it->get_array<std::string>();
+    }
+  }
+
   if ( !Genius::processor_id() )
-    _out.open(_raw_file.c_str());
+    _writer = new SpiceRawWriter(_raw_file, _binary);
 
   SolverSpecify::SolverType solver_type = this->get_solver().solver_type();
 
@@ -55,7 +73,25 @@ RawFileHook::RawFileHook(SolverBase & solver, const std::string & name, void * f
  */
 RawFileHook::~RawFileHook()
 {
+  delete _writer;
+}
 
+
+/*----------------------------------------------------------------------
+ * add a variable, filter it by the electrode and quantity selection
+ */
+void RawFileHook::_add_variable(const std::string &name, const std::string &type, const std::string &electrode, const std::string &quantity)
+{
+  bool output = true;
+  if( !electrode.empty() && !_electrodes.empty() )
+    output = output && std::find(_electrodes.begin(), _electrodes.end(), electrode) != _electrodes.end();
+  if( !quantity.empty() && !_quantities.empty() )
+    output = output && std::find(_quantities.begin(), _quantities.end(), quantity) != _quantities.end();
+
+  _variables.push_back( std::make_pair(name, type) );
+  _variable_output.push_back(output);
+  if( output && _writer )
+    _writer->add_variable(name, type);
 }
 
 
@@ -69,7 +105,8 @@ void RawFileHook::on_init()
   if ( !Genius::processor_id() )
   {
     // get simulation time
-    time(&_time);
+    time_t t;
+    time(&t);
 
     if( SolverSpecify::Type==SolverSpecify::DCSWEEP ||
         SolverSpecify::Type==SolverSpecify::TRACE   ||
@@ -78,8 +115,8 @@ void RawFileHook::on_init()
       // if transient simulation, we need to record time
       if ( SolverSpecify::Type == SolverSpecify::TRANSIENT )
       {
-        _variables.push_back( std::pair<std::string, std::string>("time", "time") );
-        _variables.push_back( std::pair<std::string, std::string>("time_step", "time") );
+        _add_variable("time", "time");
+        _add_variable("time_step", "time");
       }
 
       if( !_mixA )
@@ -97,31 +134,31 @@ void RawFileHook::on_init()
             if(!bc->electrode_label().empty())
               bc_label = bc->electrode_label();
 
-            _variables.push_back( std::pair<std::string, std::string>(bc_label + "_Vapp", "voltage") );
-            _variables.push_back( std::pair<std::string, std::string>(bc_label + "_potential", "voltage")  );
-            _variables.push_back( std::pair<std::string, std::string>(bc_label + "_current", "current") );
+            _add_variable(bc_label + "_Vapp", "voltage", bc_label, "vapp");
+            _add_variable(bc_label + "_potential", "voltage", bc_label, "potential");
+            _add_variable(bc_label + "_current", "current", bc_label, "current");
             continue;
           }
 
           if( bc->has_current_flow() )
           {
             std::string bc_label = bc->label();
-            _variables.push_back( std::pair<std::string, std::string>(bc_label + "_current", "current") );
+            _add_variable(bc_label + "_current", "current", bc_label, "current");
           }
 
 
           if( bc->bc_type() == IF_Metal_Ohmic || bc->bc_type() == IF_Metal_Schottky)
           {
             std::string bc_label = bc->label();
-            _variables.push_back( std::pair<std::string, std::string>(bc_label + "_average_potential", "voltage") );
+            _add_variable(bc_label + "_average_potential", "voltage", bc_label, "potential");
           }
 
           // charge integral interface
           if( bc->bc_type() == ChargeIntegral )
           {
             std::string bc_label = bc->label();
-            _variables.push_back( std::pair<std::string, std::string>(bc_label + "_Q", "charge") );
-            _variables.push_back( std::pair<std::string, std::string>(bc_label + "_potential", "voltage")  );
+            _add_variable(bc_label + "_Q", "charge", bc_label, "charge");
+            _add_variable(bc_label + "_potential", "voltage", bc_label, "potential");
             continue;
           }
         }
@@ -132,9 +169,9 @@ void RawFileHook::on_init()
         for(unsigned int n=0; n<spice_ckt->n_ckt_nodes(); n++)
         {
           if(spice_ckt->is_voltage_node(n))
-            _variables.push_back( std::pair<std::string, std::string>(spice_ckt->ckt_node_name(n), "voltage") );
+            _add_variable(spice_ckt->ckt_node_name(n), "voltage", spice_ckt->ckt_node_name(n), "potential");
           else
-            _variables.push_back( std::pair<std::string, std::string>(spice_ckt->ckt_node_name(n), "current") );
+            _add_variable(spice_ckt->ckt_node_name(n), "current", spice_ckt->ckt_node_name(n), "current");
         }
       }
 
@@ -143,7 +180,7 @@ void RawFileHook::on_init()
     if( SolverSpecify::Type==SolverSpecify::ACSWEEP)
     {
 
-      _variables.push_back( std::pair<std::string, std::string>("frequency", "Hz") );
+      _add_variable("frequency", "Hz");
 
       // record electrode IV information
       const BoundaryConditionCollector * bcs = this->get_solver().get_system().get_bcs();
@@ -158,15 +195,29 @@ void RawFileHook::on_init()
         if(!bc->electrode_label().empty())
           bc_label = bc->electrode_label();
         //
-        _variables.push_back( std::pair<std::string, std::string>(bc_label + "_potential_magnitude", "voltage") );
-        _variables.push_back( std::pair<std::string, std::string>(bc_label + "_potential_angle",     "")  );
-        _variables.push_back( std::pair<std::string, std::string>(bc_label + "_current_magnitude",   "current") );
-        _variables.push_back( std::pair<std::string, std::string>(bc_label + "_current_angle",       "") );
+        _add_variable(bc_label + "_potential_magnitude", "voltage", bc_label, "potential");
+        _add_variable(bc_label + "_potential_angle", "", bc_label, "potential");
+        _add_variable(bc_label + "_current_magnitude", "current", bc_label, "current");
+        _add_variable(bc_label + "_current_angle", "", bc_label, "current");
       }
     }
 
     _values.resize( _variables.size() );
 
+    const char * plotname = "";
+    switch (SolverSpecify::Type)
+    {
+        case SolverSpecify::DCSWEEP :
+          plotname = "DC transfer characteristic"; break;
+        case SolverSpecify::TRACE     :
+          plotname = "DC curve trace"; break;
+        case SolverSpecify::TRANSIENT :
+          plotname = "Transient Analysis"; break;
+        case SolverSpecify::ACSWEEP   :
+          plotname = "AC small signal Analysis"; break;
+        default: break;
+    }
+    _writer->write_header("SPICE Raw File Created by Genius TCAD Simulation", plotname, t);
   }
 
 }
@@ -201,8 +252,8 @@ void RawFileHook::post_solve()
       // if transient simulation, we need to record time
       if (SolverSpecify::Type == SolverSpecify::TRANSIENT)
       {
-        _values[i++].push_back( SolverSpecify::clock/PhysicalUnit::s );
-        _values[i++].push_back( SolverSpecify::dt/PhysicalUnit::s );
+        _values[i++] = SolverSpecify::clock/PhysicalUnit::s;
+        _values[i++] = SolverSpecify::dt/PhysicalUnit::s;
       }
 
       if( !_mixA )
@@ -215,27 +266,27 @@ void RawFileHook::post_solve()
           // electrode
           if( bc->is_electrode() )
           {
-            _values[i++].push_back( bc->ext_circuit()->Vapp()/PhysicalUnit::V );
-            _values[i++].push_back( bc->ext_circuit()->potential()/PhysicalUnit::V );
-            _values[i++].push_back( bc->ext_circuit()->current()/PhysicalUnit::A );
+            _values[i++] = bc->ext_circuit()->Vapp()/PhysicalUnit::V;
+            _values[i++] = bc->ext_circuit()->potential()/PhysicalUnit::V;
+            _values[i++] = bc->ext_circuit()->current()/PhysicalUnit::A;
             continue;
           }
 
           if( bc->has_current_flow() )
           {
-            _values[i++].push_back( bc->current()/PhysicalUnit::A );
+            _values[i++] = bc->current()/PhysicalUnit::A;
           }
 
           if( bc->bc_type() == IF_Metal_Ohmic || bc->bc_type() == IF_Metal_Schottky)
           {
-            _values[i++].push_back( bc->psi()/PhysicalUnit::V );
+            _values[i++] = bc->psi()/PhysicalUnit::V;
           }
 
           // charge integral interface
           if( bc->bc_type() == ChargeIntegral )
           {
-            _values[i++].push_back( bc->scalar("qf")/PhysicalUnit::C );
-            _values[i++].push_back( bc->psi()/PhysicalUnit::V );
+            _values[i++] = bc->scalar("qf")/PhysicalUnit::C;
+            _values[i++] = bc->psi()/PhysicalUnit::V;
           }
         }
       }
@@ -245,9 +296,9 @@ void RawFileHook::post_solve()
         for(unsigned int n=0; n<spice_ckt->n_ckt_nodes(); n++)
         {
           if(spice_ckt->is_voltage_node(n))
-            _values[i++].push_back(spice_ckt->get_solution(n));
+            _values[i++] = spice_ckt->get_solution(n);
           else
-            _values[i++].push_back(spice_ckt->get_solution(n));
+            _values[i++] = spice_ckt->get_solution(n);
         }
       }
     }
@@ -255,7 +306,7 @@ void RawFileHook::post_solve()
     if( SolverSpecify::Type==SolverSpecify::ACSWEEP)
     {
       //record frequency
-      _values[i++].push_back( SolverSpecify::Freq*PhysicalUnit::s );
+      _values[i++] = SolverSpecify::Freq*PhysicalUnit::s;
 
       // record electrode IV information
       const BoundaryConditionCollector * bcs = this->get_solver().get_system().get_bcs();
@@ -266,14 +317,21 @@ void RawFileHook::post_solve()
         // skip bc which is not electrode
         if( !bc->is_electrode() ) continue;
         //
-        _values[i++].push_back( std::abs(bc->ext_circuit()->potential_ac())/PhysicalUnit::V );
-        _values[i++].push_back( std::arg(bc->ext_circuit()->potential_ac()) );
-        _values[i++].push_back( std::abs(bc->ext_circuit()->current_ac())/PhysicalUnit::A );
-        _values[i++].push_back( std::arg(bc->ext_circuit()->current_ac()) );
+        _values[i++] = std::abs(bc->ext_circuit()->potential_ac())/PhysicalUnit::V;
+        _values[i++] = std::arg(bc->ext_circuit()->potential_ac());
+        _values[i++] = std::abs(bc->ext_circuit()->current_ac())/PhysicalUnit::A;
+        _values[i++] = std::arg(bc->ext_circuit()->current_ac());
       }
     }
 
-    if(i)  _n_values++;
+    // stream the selected values to raw file
+    if(i)
+    {
+      std::vector<double> values;
+      for(unsigned int n=0; n<_values.size(); ++n)
+        if( _variable_output[n] ) values.push_back( _values[n] );
+      _writer->write_point(values);
+    }
   }
 
 }
@@ -293,56 +351,9 @@ void RawFileHook::post_iteration()
  */
 void RawFileHook::on_close()
 {
-  // write spice raw file
   // only root processor do this command
   if ( !Genius::processor_id() )
-  {
-    // write raw file head
-    _out << "Title: SPICE Raw File Created by Genius TCAD Simulation" << std::endl;
-    _out << "Date: " << ctime(&_time) << std::endl;
-
-    switch (SolverSpecify::Type)
-    {
-        case SolverSpecify::DCSWEEP :
-          _out << "Plotname: DC transfer characteristic" << std::endl; break;
-        case SolverSpecify::TRACE     :
-          _out << "Plotname: DC curve trace" << std::endl; break;
-        case SolverSpecify::TRANSIENT :
-          _out << "Plotname: Transient Analysis" << std::endl; break;
-        case SolverSpecify::ACSWEEP   :
-          _out << "Plotname: AC small signal Analysis" << std::endl; break;
-        default: break;
-    }
-
-    _out <<  "Flags: real" << std::endl;
-
-    _out <<  "No. Variables: " << _variables.size()    << std::endl;
-    _out <<  "No. Points: "    << _n_values  << '\n'   << std::endl;
-
-    // write variables
-    _out << "Variables:"<<std::endl;
-    for(unsigned int n=0; n<_variables.size(); n++)
-    {
-      _out << '\t' << n << '\t' << _variables[n].first << '\t' << _variables[n].second << std::endl;
-    }
-
-    _out << std::endl;
-
-    // write values
-    _out << "Values:"<<std::endl;
-
-    _out << std::setprecision(15) << std::scientific << std::right;
-
-    for(unsigned int i=0; i<_n_values; i++)
-    {
-      _out << " " << i;
-      for(unsigned int n=0; n<_variables.size(); n++)
-        _out  << '\t' << std::setw(25) << _values[n][i] << std::endl;
-    }
-
-    _out.close();
-  }
-
+    _writer->close();
 }
 
 
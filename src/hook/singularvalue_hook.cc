@@ -19,6 +19,7 @@
 /*                                                                              */
 /********************************************************************************/
 
+#include "parser.h"
 #include "fvm_nonlinear_solver.h"
 #include "singularvalue_hook.h"
 
@@ -27,12 +28,23 @@
  * constructor, open the file for writing
  */
 SingularValueHook::SingularValueHook ( SolverBase & solver, const std::string & name, void * param )
-  : Hook ( solver, name )
+  : Hook ( solver, name ), _reuse_pc(true), _on_iteration(false)
 {
   this->_poisson_solver = false;
   this->_ddm_solver = false;
   this->solution_count=0;
   this->iteration_count=0;
+
+  if( param )
+  {
+    const std::vector<Parser::Parameter> & parm_list = *((std::vector<Parser::Parameter> *)param);
+    for ( std::vector<Parser::Parameter>::const_iterator parm_it = parm_list.begin();
+          parm_it != parm_list.end(); parm_it++ )
+    {
+      if( parm_it->name() == "reuse.pc" )  _reuse_pc = parm_it->get_bool();
+      if( parm_it->name() == "iteration" ) _on_iteration = parm_it->get_bool();
+    }
+  }
 }
 
 
@@ -86,6 +98,13 @@ void SingularValueHook::pre_solve()
  */
 void SingularValueHook::post_solve()
 {
+  // the jacobian and its factorization of the last newton iteration are still there
+  if( !_on_iteration )
+  {
+    FVM_NonlinearSolver & nonlinear_solver = dynamic_cast<FVM_NonlinearSolver &>(_solver);
+    nonlinear_solver.condition_number_of_jacobian_matrix(_reuse_pc);
+  }
+
   this->solution_count++;
   this->iteration_count=0;
 }
@@ -93,15 +112,18 @@ void SingularValueHook::post_solve()
 
 
 /*----------------------------------------------------------------------
- *  This is executed before each (nonlinear) iteration
+ *  This is executed after each (nonlinear) iteration,
+ *  the jacobian matrix and its factorization of this iteration are ready
  */
-void SingularValueHook::pre_iteration()
+void SingularValueHook::post_iteration()
 {
+  if( !_on_iteration ) return;
+
   FVM_NonlinearSolver & nonlinear_solver = dynamic_cast<FVM_NonlinearSolver &>(_solver);
-  const SimulationSystem &system = nonlinear_solver.get_system();
 
-  // calculate the eigen value as well as the smallest eigen vector
-  nonlinear_solver.condition_number_of_jacobian_matrix();
+  // calculate the smallest and largest singular value
+  nonlinear_solver.condition_number_of_jacobian_matrix(_reuse_pc);
+  this->iteration_count++;
 }
 
 
@@ -0,0 +1,313 @@
+/********************************************************************************/
+/*     888888    888888888   88     888  88888   888      888    88888888       */
+/*   8       8   8           8 8     8     8      8        8    8               */
+/*  8            8           8  8    8     8      8        8    8               */
+/*  8            888888888   8   8   8     8      8        8     8888888        */
+/*  8      8888  8           8    8  8     8      8        8            8       */
+/*   8       8   8           8     8 8     8      8        8            8       */
+/*     888888    888888888  888     88   88888     88888888     88888888        */
+/*                                                                              */
+/*       A Three-Dimensional General Purpose Semiconductor Simulator.           */
+/*                                                                              */
+/*                                                                              */
+/*  Copyright (C) 2007-2008                                                     */
+/*  Cogenda Pte Ltd                                                             */
+/*                                                                              */
+/*  Please contact Cogenda Pte Ltd for license information                      */
+/*                                                                              */
+/*  Author: Gong Ding   gdiso@ustc.edu                                          */
+/*                                                                              */
+/********************************************************************************/
+
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <algorithm>
+
+#include "solver_base.h"
+#include "snapshot_hook.h"
+#include "parallel.h"
+
+/*
+ * usage: HOOK Load=snapshot string<variable>=(psi,electron,...) string<region>=(region_name)
+ *        int<capacity>=(snapshots in buffer) int<stride>=(record every n-th solution)
+ *        string<file>=(file name) bool<trigger>=(true|false)
+ * <variable> solution variables to record, can be given as array or several times
+ * <region>   only record the nodes of these regions. If ommited, all the regions are recorded
+ * <capacity> the buffer keeps the last capacity snapshots, default 100
+ * <trigger>  write the buffer when another hook raises an event, i.e. ThresholdHook. default true
+ */
+
+/*----------------------------------------------------------------------
+ * constructor
+ */
+SnapshotHook::SnapshotHook ( SolverBase & solver, const std::string & name, void * param)
+    : Hook ( solver, name ), _snapshot_file ( SolverSpecify::out_prefix + ".snapshot" ),
+      _capacity(100), _stride(1), _flush_on_trigger(true), _n_solve(0), _n_flush(0), _head(0), _size(0)
+{
+  const SimulationSystem & system = get_solver().get_system();
+
+  const std::vector<Parser::Parameter> & parm_list = *((std::vector<Parser::Parameter> *)param);
+  for ( std::vector<Parser::Parameter>::const_iterator parm_it = parm_list.begin();
+        parm_it != parm_list.end(); parm_it++ )
+  {
+    if( parm_it->name() == "variable" && parm_it->type() == Parser::STRING )
+    {
+      for(unsigned int i=0; i<std::max(parm_it->array_size(), 1u); ++i)
+      {
+        SolutionVariable var = solution_string_to_enum (FormatVariableString(parm_it->get_string(i)));
+        if( var == INVALID_Variable )
+        {
+          if( Genius::is_first_processor() )
+            std::cerr<<"SnapshotHook: Invalid given variable "<< parm_it->get_string(i) <<  " to be recorded." << std::endl;
+          continue;
+        }
+        _variables.push_back(var);
+        _variable_names.push_back(parm_it->get_string(i));
+      }
+      continue;
+    }
+    if( parm_it->name() == "region" && parm_it->type() == Parser::STRING )
+    {
+      for(unsigned int i=0; i<std::max(parm_it->array_size(), 1u); ++i)
+      {
+        if( system.region(parm_it->get_string(i)) == NULL )
+        {
+          if( Genius::is_first_processor() )
+            std::cerr<<"SnapshotHook: Invalid given region "<< parm_it->get_string(i) <<  " to be recorded." << std::endl;
+          continue;
+        }
+        _regions.push_back(parm_it->get_string(i));
+      }
+      continue;
+    }
+    if( parm_it->name() == "capacity" && parm_it->type() == Parser::INTEGER )
+      _capacity = std::max(parm_it->get_int(), 1);
+    if( parm_it->name() == "stride" && parm_it->type() == Parser::INTEGER )
+      _stride = std::max(parm_it->get_int(), 1);
+    if( parm_it->name() == "file" && parm_it->type() == Parser::STRING )
+      _snapshot_file = parm_it->get_string();
+    if( parm_it->name() == "trigger" && parm_it->type() == Parser::BOOL )
+      _flush_on_trigger = parm_it->get_bool();
+  }
+
+  if( _variables.empty() )
+  {
+    _variables.push_back(POTENTIAL);
+    _variable_names.push_back("potential");
+  }
+
+  _build_node_list();
+
+  _time.resize(_capacity);
+  _value.resize(_capacity);
+
+  unsigned int n_nodes = _nodes.size();
+  Parallel::sum(n_nodes);
+  if( Genius::is_first_processor() )
+    std::cout << "SnapshotHook: " << n_nodes << " nodes, " << _variables.size() << " variables, buffer of "
+              << _capacity << " snapshots (" << (4.0*_capacity*_variables.size()*n_nodes)/(1024*1024) << " MB)" << std::endl;
+}
+
+
+/*----------------------------------------------------------------------
+ * destructor
+ */
+SnapshotHook::~SnapshotHook()
+{}
+
+
+/*----------------------------------------------------------------------
+ *   This is executed before the initialization of the solver
+ */
+void SnapshotHook::on_init()
+{}
+
+
+
+/*----------------------------------------------------------------------
+ *   This is executed previously to each solution step.
+ */
+void SnapshotHook::pre_solve()
+{}
+
+
+
+/*----------------------------------------------------------------------
+ *  This is executed after each solution step.
+ */
+void SnapshotHook::post_solve()
+{
+  if( (_n_solve++) % _stride ) return;
+
+  // overwrite the oldest snapshot when the buffer is full
+  const unsigned int slot = (_head + _size) % _capacity;
+  if( _size < _capacity )
+    _size++;
+  else
+    _head = (_head + 1) % _capacity;
+
+  _time[slot] = SolverSpecify::Type==SolverSpecify::TRANSIENT ? SolverSpecify::clock/PhysicalUnit::s : _n_solve-1;
+
+  std::vector<float> & value = _value[slot];
+  value.resize(_variables.size()*_nodes.size());
+  for(unsigned int v=0; v<_variables.size(); ++v)
+  {
+    const SolutionVariable var = _variables[v];
+    const double unit = variable_unit(var);
+    for(unsigned int n=0; n<_nodes.size(); ++n)
+    {
+      const FVM_NodeData * node_data = _nodes[n]->node_data();
+      value[v*_nodes.size()+n] = node_data->is_variable_valid(var) ? static_cast<float>(node_data->get_variable_real(var)/unit) : 0.0f;
+    }
+  }
+}
+
+
+
+/*----------------------------------------------------------------------
+ *  This is executed after each (nonlinear) iteration
+ */
+void SnapshotHook::post_iteration()
+{}
+
+
+
+/*----------------------------------------------------------------------
+ * This is executed after the finalization of the solver
+ */
+void SnapshotHook::on_close()
+{
+  _flush("end of solve");
+}
+
+
+
+void SnapshotHook::on_trigger(const std::string & source)
+{
+  if( _flush_on_trigger )
+    _flush(source);
+}
+
+
+
+void SnapshotHook::_build_node_list()
+{
+  const SimulationSystem & system = get_solver().get_system();
+
+  for( unsigned int r=0; r<system.n_regions(); ++r )
+  {
+    const SimulationRegion * region = system.region(r);
+    if( !_regions.empty() && std::find(_regions.begin(), _regions.end(), region->name()) == _regions.end() ) continue;
+
+    SimulationRegion::const_processor_node_iterator node_it = region->on_processor_nodes_begin();
+    SimulationRegion::const_processor_node_iterator node_it_end = region->on_processor_nodes_end();
+    for(; node_it!=node_it_end; ++node_it)
+    {
+      _nodes.push_back(*node_it);
+      _node_region.push_back(r);
+    }
+  }
+}
+
+
+
+void SnapshotHook::_flush(const std::string & reason)
+{
+  // all the processors hold the same number of snapshots
+  if( _size == 0 ) return;
+
+  const SimulationSystem & system = get_solver().get_system();
+  const unsigned int n_var = _variables.size();
+
+  std::vector<unsigned int> n_nodes;
+  Parallel::allgather(static_cast<unsigned int>(_nodes.size()), n_nodes);
+
+  // node information
+  std::vector<unsigned int> node_info;
+  std::vector<double> node_location;
+  for(unsigned int n=0; n<_nodes.size(); ++n)
+  {
+    const Node * node = _nodes[n]->root_node();
+    node_info.push_back(node->id());
+    node_info.push_back(_node_region[n]);
+    for(unsigned int d=0; d<3; ++d)
+      node_location.push_back((*node)(d)/PhysicalUnit::um);
+  }
+  Parallel::gather(0, node_info);
+  Parallel::gather(0, node_location);
+
+  // values of all the snapshots, ordered by processor
+  std::vector<float> value;
+  value.reserve(_size*n_var*_nodes.size());
+  for(unsigned int i=0; i<_size; ++i)
+  {
+    const std::vector<float> & v = _value[(_head + i) % _capacity];
+    value.insert(value.end(), v.begin(), v.end());
+  }
+  Parallel::gather(0, value);
+
+  if( Genius::is_first_processor() )
+  {
+    std::ostringstream filename;
+    filename << _snapshot_file;
+    if( _n_flush ) filename << '.' << _n_flush;
+
+    std::ofstream out(filename.str().c_str());
+    out << "# snapshots of the last " << _size << " recorded solutions, written by " << reason << '\n';
+    out << "# variables:";
+    for(unsigned int v=0; v<n_var; ++v)
+      out << ' ' << _variable_names[v] << '(' << variable_unit_string(_variables[v]) << ')';
+    out << '\n';
+
+    const unsigned int n_total = node_info.size()/2;
+    out << "# nodes: " << n_total << ", columns of each line are "
+        << (SolverSpecify::Type==SolverSpecify::TRANSIENT ? "time(s)" : "step") << " and the nodes for each variable\n";
+    out << "# node id region x(um) y(um) z(um)\n";
+    for(unsigned int n=0; n<n_total; ++n)
+      out << "# " << node_info[2*n] << ' ' << system.region(node_info[2*n+1])->name() << ' '
+          << node_location[3*n] << ' ' << node_location[3*n+1] << ' ' << node_location[3*n+2] << '\n';
+
+    // offset of each processor's block
+    std::vector<unsigned int> offset(n_nodes.size(), 0);
+    for(unsigned int p=1; p<n_nodes.size(); ++p)
+      offset[p] = offset[p-1] + _size*n_var*n_nodes[p-1];
+
+    out << std::setprecision(8) << std::scientific;
+    for(unsigned int i=0; i<_size; ++i)
+    {
+      out << _time[(_head + i) % _capacity];
+      for(unsigned int v=0; v<n_var; ++v)
+        for(unsigned int p=0; p<n_nodes.size(); ++p)
+        {
+          if( n_nodes[p] == 0 ) continue;
+          const float * block = &value[0] + offset[p] + (i*n_var + v)*n_nodes[p];
+          for(unsigned int n=0; n<n_nodes[p]; ++n)
+            out << ' ' << block[n];
+        }
+      out << '\n';
+    }
+    out.close();
+  }
+
+  _n_flush++;
+  _head = 0;
+  _size = 0;
+}
+
+
+#ifdef DLLHOOK
+
+// dll interface
+extern "C"
+{
+  Hook* get_hook ( SolverBase & solver, const std::string & name, void * fun_data )
+  {
+    return new SnapshotHook ( solver, name, fun_data );
+  }
+
+}
+
+#endif
+
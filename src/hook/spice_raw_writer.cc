@@ -0,0 +1,121 @@
+/********************************************************************************/
+/*     888888    888888888   88     888  88888   888      888    88888888       */
+/*   8       8   8           8 8     8     8      8        8    8               */
+/*  8            8           8  8    8     8      8        8    8               */
+/*  8            888888888   8   8   8     8      8        8     8888888        */
+/*  8      8888  8           8    8  8     8      8        8            8       */
+/*   8       8   8           8     8 8     8      8        8            8       */
+/*     888888    888888888  888     88   88888     88888888     88888888        */
+/*                                                                              */
+/*       A Three-Dimensional General Purpose Semiconductor Simulator.           */
+/*                                                                              */
+/*                                                                              */
+/*  Copyright (C) 2007-2008                                                     */
+/*  Cogenda Pte Ltd                                                             */
+/*                                                                              */
+/*  Please contact Cogenda Pte Ltd for license information                      */
+/*                                                                              */
+/*  Author: Gong Ding   gdiso@ustc.edu                                          */
+/*                                                                              */
+/********************************************************************************/
+
+#include <cstdio>
+#include <cstring>
+
+#include "spice_raw_writer.h"
+
+
+/*----------------------------------------------------------------------
+ * width of the "No. Points" field, enough for any unsigned int
+ */
+static const int points_field_width = 12;
+
+
+SpiceRawWriter::SpiceRawWriter(const std::string & filename, bool binary, size_t buffer_size)
+  : _out(filename.c_str(), std::ios::out | std::ios::binary), _binary(binary), _buffer_size(buffer_size),
+    _n_points(0), _header_written(false)
+{
+  _buffer.reserve(_buffer_size);
+}
+
+
+SpiceRawWriter::~SpiceRawWriter()
+{
+  this->close();
+}
+
+
+void SpiceRawWriter::write_header(const std::string & title, const std::string & plotname, time_t t)
+{
+  _out << "Title: " << title << '\n';
+  _out << "Date: " << ctime(&t) << '\n';
+  if( !plotname.empty() )
+    _out << "Plotname: " << plotname << '\n';
+  _out << "Flags: real" << '\n';
+  _out << "No. Variables: " << _variables.size() << '\n';
+  _out << "No. Points: ";
+  _n_points_pos = _out.tellp();
+  char field[32];
+  sprintf(field, "%-*u", points_field_width, 0u);
+  _out << field << '\n' << '\n';
+
+  _out << "Variables:" << '\n';
+  for(unsigned int n=0; n<_variables.size(); n++)
+    _out << '\t' << n << '\t' << _variables[n].first << '\t' << _variables[n].second << '\n';
+
+  if( _binary )
+    _out << "Binary:" << '\n';
+  else
+    _out << '\n' << "Values:" << '\n';
+
+  _header_written = true;
+}
+
+
+void SpiceRawWriter::write_point(const std::vector<double> & values)
+{
+  if( _binary )
+    _buffer.append( reinterpret_cast<const char *>(&values[0]), values.size()*sizeof(double) );
+  else
+  {
+    char line[64];
+    sprintf(line, " %u", _n_points);
+    _buffer.append(line);
+    for(unsigned int n=0; n<values.size(); n++)
+    {
+      sprintf(line, "\t%25.15e\n", values[n]);
+      _buffer.append(line);
+    }
+  }
+
+  _n_points++;
+
+  if( _buffer.size() >= _buffer_size )
+    this->flush();
+}
+
+
+void SpiceRawWriter::flush()
+{
+  if( !_out.is_open() || !_header_written ) return;
+
+  _out.write(_buffer.data(), _buffer.size());
+  _buffer.clear();
+
+  // patch the number of points, so the file is valid even if we are killed later
+  std::streampos end = _out.tellp();
+  char field[32];
+  sprintf(field, "%-*u", points_field_width, _n_points);
+  _out.seekp(_n_points_pos);
+  _out.write(field, strlen(field));
+  _out.seekp(end);
+  _out.flush();
+}
+
+
+void SpiceRawWriter::close()
+{
+  if( !_out.is_open() ) return;
+  this->flush();
+  _out.close();
+}
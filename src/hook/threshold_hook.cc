@@ -203,8 +203,7 @@ void ThresholdHook::_check_E_threshold()
 
       if(box && !_in_bound_box(elem->centroid())) continue;
 
-      const FVM_CellData * elem_data = region->get_region_elem_data(e);
-      const Real E = elem_data->E().size();
+      const Real E = region->cell_efield(e).size();
       if( E > E_magnitude )
       {
         E_magnitude = E;
@@ -244,6 +243,8 @@ void ThresholdHook::_check_E_threshold()
         system.export_vtk ( _threshold_prefix + "device_violate_E_threshold.vtu", false );
         system.export_cgns ( _threshold_prefix + "device_violate_E_threshold.cgns" );
         _violate_threshold = true;
+        // let the other hooks, i.e. snapshot, save what they hold
+        _solver.hook_list()->trigger("threshold");
       }
 
       if( _violate_threshold && _stop_when_violate_threshold )
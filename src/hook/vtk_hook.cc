@@ -24,6 +24,7 @@
 
 #include "solver_base.h"
 #include "vtk_hook.h"
+#include "vtk_io.h"
 #include "spice_ckt.h"
 #include "MXMLUtil.h"
 
@@ -33,7 +34,7 @@
  */
 VTKHook::VTKHook ( SolverBase & solver, const std::string & name, void * param)
     : Hook ( solver, name ), _vtk_prefix ( SolverSpecify::out_prefix ),
-      _ddm ( false ), _mixA ( false ), _ddm_ac ( false )
+      _async_queue ( 0 ), _ddm ( false ), _mixA ( false ), _ddm_ac ( false )
 {
   this->count  =0;
   this->_t_step=0;
@@ -55,13 +56,18 @@ VTKHook::VTKHook ( SolverBase & solver, const std::string & name, void * param)
       _v_step=parm_it->get_real() * PhysicalUnit::V;
     if ( parm_it->name() == "istep" && parm_it->type() == Parser::REAL )
       _i_step=parm_it->get_real() * PhysicalUnit::A;
+    // write vtu files by background thread, the solver only waits when the queue is full
+    if ( parm_it->name() == "async" && parm_it->type() == Parser::BOOL && parm_it->get_bool() && !_async_queue )
+      _async_queue = 2;
+    if ( parm_it->name() == "async.queue" && parm_it->type() == Parser::INTEGER )
+      _async_queue = std::max ( parm_it->get_int(), 0 );
   }
 
   const SimulationSystem &system = get_solver().get_system();
 
   std::ostringstream vtk_filename;
   vtk_filename << _vtk_prefix << ( this->count++ ) << ".vtu";
-  system.export_vtk ( vtk_filename.str(), false );
+  system.export_vtk ( vtk_filename.str(), false, _async_queue );
 
   SolverSpecify::SolverType solver_type = this->get_solver().solver_type();
 
@@ -137,7 +143,7 @@ void VTKHook::post_solve()
       const SimulationSystem &system = get_solver().get_system();
 
       vtk_filename << _vtk_prefix << ( this->count++ ) << ".vtu";
-      system.export_vtk ( vtk_filename.str(),false );
+      system.export_vtk ( vtk_filename.str(), false, _async_queue );
 
       time_sequence.push_back ( std::make_pair ( Vscan/PhysicalUnit::V, vtk_filename.str() ) );
       _v_last = Vscan;
@@ -168,7 +174,7 @@ void VTKHook::post_solve()
       const SimulationSystem &system = get_solver().get_system();
 
       vtk_filename << _vtk_prefix << ( this->count++ ) << ".vtu";
-      system.export_vtk ( vtk_filename.str(),false );
+      system.export_vtk ( vtk_filename.str(), false, _async_queue );
 
       time_sequence.push_back ( std::make_pair ( Iscan/PhysicalUnit::A, vtk_filename.str() ) );
       _i_last = Iscan;
@@ -181,7 +187,7 @@ void VTKHook::post_solve()
     const SimulationSystem &system = get_solver().get_system();
 
     vtk_filename << _vtk_prefix << ( this->count++ ) << ".vtu";
-    system.export_vtk ( vtk_filename.str(), false );
+    system.export_vtk ( vtk_filename.str(), false, _async_queue );
   }
 
   if ( SolverSpecify::Type==SolverSpecify::TRACE )
@@ -189,7 +195,7 @@ void VTKHook::post_solve()
     const SimulationSystem &system = get_solver().get_system();
 
     vtk_filename << _vtk_prefix << ( this->count++ ) << ".vtu";
-    system.export_vtk ( vtk_filename.str(), false );
+    system.export_vtk ( vtk_filename.str(), false, _async_queue );
   }
 
   if ( SolverSpecify::Type==SolverSpecify::TRANSIENT )
@@ -199,7 +205,7 @@ void VTKHook::post_solve()
       const SimulationSystem &system = get_solver().get_system();
 
       vtk_filename << _vtk_prefix << ( this->count++ ) << ".vtu";
-      system.export_vtk ( vtk_filename.str(), false );
+      system.export_vtk ( vtk_filename.str(), false, _async_queue );
 
       time_sequence.push_back ( std::make_pair ( SolverSpecify::clock/PhysicalUnit::ps, vtk_filename.str() ) );
       _t_last = SolverSpecify::clock;
@@ -213,7 +219,7 @@ void VTKHook::post_solve()
     const SimulationSystem &system = get_solver().get_system();
 
     vtk_filename << _vtk_prefix << ( this->count++ ) << ".vtu";
-    system.export_vtk ( vtk_filename.str(), false );
+    system.export_vtk ( vtk_filename.str(), false, _async_queue );
 
     time_sequence.push_back ( std::make_pair ( SolverSpecify::Freq*PhysicalUnit::us, vtk_filename.str() ) );
     _f_last = SolverSpecify::Freq;
@@ -225,7 +231,7 @@ void VTKHook::post_solve()
     const SimulationSystem &system = get_solver().get_system();
 
     vtk_filename << _vtk_prefix << ( this->count++ ) << ".vtu";
-    system.export_vtk ( vtk_filename.str(),false );
+    system.export_vtk ( vtk_filename.str(), false, _async_queue );
   }
   */
 
@@ -258,6 +264,10 @@ void VTKHook::post_iteration()
  */
 void VTKHook::on_close()
 {
+  // all the vtu files should be on disk before the solver returns
+  if ( _async_queue )
+    VTKIO::wait_async();
+
   if ( time_sequence.size() ==0 ) return;
 
   if ( !Genius::processor_id() )
@@ -1,11 +1,19 @@
 #include <cassert>
 #include <cmath>
+#include <algorithm>
 
 #include "config.h"
 #include "asinh.hpp"
 #include "interpolation_2d_csa.h"
 #include "parallel.h"
 
+// target number of points in each tile of the tiled fit
+static const unsigned int csa_tile_points = 50000;
+// overlap of the neighboring tiles, relative to the tile size
+static const double csa_tile_overlap = 0.2;
+// minimal number of points for the fit of a tile
+static const unsigned int csa_tile_min_points = 16;
+
 Interpolation2D_CSA::Interpolation2D_CSA()
 {}
 
@@ -21,6 +29,14 @@ void Interpolation2D_CSA::clear()
   std::map<int, CSA::csa *>::iterator it = field_map.begin();
   for(; it != field_map.end(); ++it)
     CSA::csa_destroy(it->second);
+  field_map.clear();
+
+  std::map<int, TileGrid>::iterator tit = tile_map.begin();
+  for(; tit != tile_map.end(); ++tit)
+    for(unsigned int n=0; n<tit->second.tiles.size(); ++n)
+      CSA::csa_destroy(tit->second.tiles[n].field);
+  tile_map.clear();
+
   csa_points.clear();
 }
 
@@ -56,6 +72,8 @@ void Interpolation2D_CSA::add_scatter_data(const Point & point, int group, doubl
 
 void Interpolation2D_CSA::setup(int group)
 {
+  if( setup_tiles(group) ) return;
+
   CSA::csa * field=CSA::csa_create();
   field_map[group] = field;
   CSA::csa_addpoints(field, csa_points[group].size(), &(csa_points[group][0]));
@@ -66,6 +84,106 @@ void Interpolation2D_CSA::setup(int group)
 }
 
 
+bool Interpolation2D_CSA::setup_tiles(int group)
+{
+  const std::vector<CSA::point> & pts = csa_points[group];
+  if( pts.size() <= 2*csa_tile_points ) return false;
+
+  double xmin=pts[0].x, xmax=pts[0].x, ymin=pts[0].y, ymax=pts[0].y;
+  for(unsigned int i=1; i<pts.size(); ++i)
+  {
+    xmin = std::min(xmin, pts[i].x); xmax = std::max(xmax, pts[i].x);
+    ymin = std::min(ymin, pts[i].y); ymax = std::max(ymax, pts[i].y);
+  }
+  double lx = xmax - xmin, ly = ymax - ymin;
+  if( lx <= 0.0 || ly <= 0.0 ) return false;
+
+  // tile grid follows the aspect ratio of the bounding box
+  double ntile = std::ceil(double(pts.size())/csa_tile_points);
+  TileGrid & grid = tile_map[group];
+  grid.nx = std::max(1, int(std::floor(std::sqrt(ntile*lx/ly)+0.5)));
+  grid.ny = std::max(1, int(std::ceil(ntile/grid.nx)));
+  grid.x0 = xmin;
+  grid.y0 = ymin;
+  grid.dx = lx/grid.nx;
+  grid.dy = ly/grid.ny;
+  grid.tiles.resize(grid.nx*grid.ny);
+
+  // each point goes to all the tiles whose extended box contains it
+  const double ox = csa_tile_overlap*grid.dx;
+  const double oy = csa_tile_overlap*grid.dy;
+  for(unsigned int n=0; n<pts.size(); ++n)
+  {
+    int i0 = std::max(0,         int(std::floor((pts[n].x - xmin - ox)/grid.dx)));
+    int i1 = std::min(grid.nx-1, int(std::floor((pts[n].x - xmin + ox)/grid.dx)));
+    int j0 = std::max(0,         int(std::floor((pts[n].y - ymin - oy)/grid.dy)));
+    int j1 = std::min(grid.ny-1, int(std::floor((pts[n].y - ymin + oy)/grid.dy)));
+    for(int j=j0; j<=j1; ++j)
+      for(int i=i0; i<=i1; ++i)
+        grid.tiles[j*grid.nx+i].points.push_back(pts[n]);
+  }
+
+  for(int j=0; j<grid.ny; ++j)
+    for(int i=0; i<grid.nx; ++i)
+    {
+      Tile & tile = grid.tiles[j*grid.nx+i];
+
+      double scale = 1.0;
+      // sparse tile, widen the extended box until it has enough points
+      while( tile.points.size() < csa_tile_min_points && tile.points.size() < pts.size() )
+      {
+        scale *= 2.0;
+        double exmin = xmin + i*grid.dx - scale*ox, exmax = xmin + (i+1)*grid.dx + scale*ox;
+        double eymin = ymin + j*grid.dy - scale*oy, eymax = ymin + (j+1)*grid.dy + scale*oy;
+        tile.points.clear();
+        for(unsigned int n=0; n<pts.size(); ++n)
+          if( pts[n].x >= exmin && pts[n].x <= exmax && pts[n].y >= eymin && pts[n].y <= eymax )
+            tile.points.push_back(pts[n]);
+      }
+
+      tile.field = 0;
+      tile.xmin = std::max(xmin, xmin + i*grid.dx - scale*ox);
+      tile.xmax = std::min(xmax, xmin + (i+1)*grid.dx + scale*ox);
+      tile.ymin = std::max(ymin, ymin + j*grid.dy - scale*oy);
+      tile.ymax = std::min(ymax, ymin + (j+1)*grid.dy + scale*oy);
+
+      // no blending ramp at the border of the data set, the tile is alone there
+      tile.ramp_xmin = i > 0         ? 2*scale*ox : 0.0;
+      tile.ramp_xmax = i < grid.nx-1 ? 2*scale*ox : 0.0;
+      tile.ramp_ymin = j > 0         ? 2*scale*oy : 0.0;
+      tile.ramp_ymax = j < grid.ny-1 ? 2*scale*oy : 0.0;
+
+      tile.dxmin = tile.dxmax = 0.5*(tile.xmin+tile.xmax);
+      tile.dymin = tile.dymax = 0.5*(tile.ymin+tile.ymax);
+      for(unsigned int n=0; n<tile.points.size(); ++n)
+      {
+        if(n==0) { tile.dxmin = tile.dxmax = tile.points[n].x; tile.dymin = tile.dymax = tile.points[n].y; }
+        tile.dxmin = std::min(tile.dxmin, tile.points[n].x); tile.dxmax = std::max(tile.dxmax, tile.points[n].x);
+        tile.dymin = std::min(tile.dymin, tile.points[n].y); tile.dymax = std::max(tile.dymax, tile.points[n].y);
+      }
+    }
+
+  // the tiles are fitted independently
+#ifdef HAVE_OPENMP
+  #pragma omp parallel for schedule(dynamic)
+#endif
+  for(int n=0; n<int(grid.tiles.size()); ++n)
+  {
+    Tile & tile = grid.tiles[n];
+    if( tile.points.size() < 3 ) continue;
+    CSA::csa * field = CSA::csa_create();
+    CSA::csa_addpoints(field, tile.points.size(), &(tile.points[0]));
+    CSA::csa_calculatespline(field);
+    tile.field = field;
+  }
+
+#if defined(HAVE_FENV_H) && defined(DEBUG)
+  feclearexcept(FE_INVALID);
+#endif
+  return true;
+}
+
+
 void Interpolation2D_CSA::broadcast(unsigned int root)
 {
   std::vector<int> groups;
@@ -109,33 +227,105 @@ void Interpolation2D_CSA::broadcast(unsigned int root)
 }
 
 
-double Interpolation2D_CSA::get_interpolated_value(const Point & point, int group) const
+double Interpolation2D_CSA::scaled_value(const Point & point, int group) const
 {
-  CSA::csa * field = field_map.find(group)->second;
-
   CSA::point pout;
   pout.x = point.x();
   pout.y = point.y();
-  CSA::csa_approximatepoints(field, 1, &pout);
+  pout.z = 0.0;
 
+  std::map<int, TileGrid>::const_iterator tit = tile_map.find(group);
+  if( tit == tile_map.end() )
+  {
+    CSA::csa * field = field_map.find(group)->second;
+    CSA::csa_approximatepoints(field, 1, &pout);
+    return pout.z;
+  }
+
+  // blend the tiles around the point, the weight of a tile is the product of the
+  // linear ramps from the sides of its box
+  const TileGrid & grid = tit->second;
+  int ic = std::max(0, std::min(grid.nx-1, int(std::floor((pout.x - grid.x0)/grid.dx))));
+  int jc = std::max(0, std::min(grid.ny-1, int(std::floor((pout.y - grid.y0)/grid.dy))));
+
+  double z = 0.0, w = 0.0;
+  for(int j=std::max(0, jc-1); j<=std::min(grid.ny-1, jc+1); ++j)
+    for(int i=std::max(0, ic-1); i<=std::min(grid.nx-1, ic+1); ++i)
+    {
+      const Tile & tile = grid.tiles[j*grid.nx+i];
+      if( !tile.field ) continue;
+      if( pout.x < tile.xmin || pout.x > tile.xmax || pout.y < tile.ymin || pout.y > tile.ymax ) continue;
+
+      double wt = 1.0;
+      if( tile.ramp_xmin > 0.0 ) wt *= std::min(1.0, (pout.x - tile.xmin)/tile.ramp_xmin);
+      if( tile.ramp_xmax > 0.0 ) wt *= std::min(1.0, (tile.xmax - pout.x)/tile.ramp_xmax);
+      if( tile.ramp_ymin > 0.0 ) wt *= std::min(1.0, (pout.y - tile.ymin)/tile.ramp_ymin);
+      if( tile.ramp_ymax > 0.0 ) wt *= std::min(1.0, (tile.ymax - pout.y)/tile.ramp_ymax);
+      if( wt <= 0.0 ) continue;
+
+      // the csa covers only the bounding box of the tile points, which may be
+      // a bit smaller than the tile box when the data is sparse near its sides
+      CSA::point p = pout;
+      p.x = std::max(tile.dxmin, std::min(tile.dxmax, p.x));
+      p.y = std::max(tile.dymin, std::min(tile.dymax, p.y));
+      CSA::csa_approximatepoint(tile.field, &p);
+      // csa gives exact zero in the squares without spline, leave it to the neighbor tiles
+      if( p.z == 0.0 ) continue;
+      z += wt*p.z;
+      w += wt;
+    }
+
+  if( w > 0.0 ) return z/w;
+
+  // out of the data set
+  return 0.0;
+}
+
+
+double Interpolation2D_CSA::unscaled_value(double z, int group) const
+{
   InterpolationType type = _interpolation_type.find(group)->second;
 
   switch(type)
   {
   case Linear    : break;
-  case SignedLog : pout.z = pout.z>0 ? exp(pout.z)-1 : 1-exp(-pout.z) ; break;
-  case Asinh     : pout.z = sinh(pout.z); break;
+  case SignedLog : z = z>0 ? exp(z)-1 : 1-exp(-z) ; break;
+  case Asinh     : z = sinh(z); break;
   }
 
   double vmin = field_limit.find(group)->second.first;
   double vmax = field_limit.find(group)->second.second;
-  if(pout.z<vmin) pout.z = vmin;
-  if(pout.z>vmax) pout.z = vmax;
+  if(z<vmin) z = vmin;
+  if(z>vmax) z = vmax;
+
+  return z;
+}
+
+
+double Interpolation2D_CSA::get_interpolated_value(const Point & point, int group) const
+{
+  double z = unscaled_value(scaled_value(point, group), group);
 
 #if defined(HAVE_FENV_H) && defined(DEBUG)
   feclearexcept(FE_INVALID);
 #endif
 
-  return pout.z;
+  return z;
 }
 
+
+void Interpolation2D_CSA::get_interpolated_values(const std::vector<Point> & points, int group, std::vector<double> & values) const
+{
+  values.resize(points.size());
+
+  // csa evaluation only reads the fitted data
+#ifdef HAVE_OPENMP
+  #pragma omp parallel for schedule(static)
+#endif
+  for(int i=0; i<int(points.size()); ++i)
+    values[i] = unscaled_value(scaled_value(points[i], group), group);
+
+#if defined(HAVE_FENV_H) && defined(DEBUG)
+  feclearexcept(FE_INVALID);
+#endif
+}
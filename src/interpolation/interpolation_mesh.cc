@@ -0,0 +1,291 @@
+/********************************************************************************/
+/*     888888    888888888   88     888  88888   888      888    88888888       */
+/*   8       8   8           8 8     8     8      8        8    8               */
+/*  8            8           8  8    8     8      8        8    8               */
+/*  8            888888888   8   8   8     8      8        8     8888888        */
+/*  8      8888  8           8    8  8     8      8        8            8       */
+/*   8       8   8           8     8 8     8      8        8            8       */
+/*     888888    888888888  888     88   88888     88888888     88888888        */
+/*                                                                              */
+/*       A Three-Dimensional General Purpose Semiconductor Simulator.           */
+/*                                                                              */
+/*                                                                              */
+/*  Copyright (C) 2007-2008                                                     */
+/*  Cogenda Pte Ltd                                                             */
+/*                                                                              */
+/*  Please contact Cogenda Pte Ltd for license information                      */
+/*                                                                              */
+/*  Author: Gong Ding   gdiso@ustc.edu                                          */
+/*                                                                              */
+/********************************************************************************/
+
+#include <cmath>
+#include <limits>
+
+#include "genius_common.h"
+#include "asinh.hpp"
+#include "mesh.h"
+#include "elem.h"
+#include "fe_type.h"
+#include "fe_interface.h"
+#include "point_locator_tree.h"
+#include "parallel.h"
+#include "interpolation_mesh.h"
+
+
+Interpolation_Mesh::Interpolation_Mesh()
+  : _last_elem(NULL), _out_of_mesh_mode(false)
+{
+}
+
+
+Interpolation_Mesh::~Interpolation_Mesh()
+{
+  this->clear();
+}
+
+
+void Interpolation_Mesh::clear()
+{
+  // the locator refers to the mesh, destroy it first
+  _locator.reset();
+  _mesh.reset();
+  _last_elem = NULL;
+  _out_of_mesh_mode = false;
+  _field.clear();
+  _field_valid.clear();
+}
+
+
+void Interpolation_Mesh::set_source_mesh(const MeshBase & mesh)
+{
+  this->clear();
+
+  genius_assert(mesh.is_serial());
+
+  _mesh = AutoPtr<MeshBase>(new Mesh(mesh.mesh_dimension()));
+
+  // copy nodes, keep node id
+  MeshBase::const_node_iterator node_it = mesh.nodes_begin();
+  MeshBase::const_node_iterator node_it_end = mesh.nodes_end();
+  for(; node_it!=node_it_end; ++node_it)
+  {
+    const Node * node = *node_it;
+    _mesh->add_point(*node, node->id());
+  }
+
+  // copy active elements as level 0 elements, the hanging nodes of
+  // hierarchical mesh are interpolated by their coarse neighbors
+  bool affine_map = true;
+  MeshBase::const_element_iterator elem_it = mesh.active_elements_begin();
+  MeshBase::const_element_iterator elem_it_end = mesh.active_elements_end();
+  for(; elem_it!=elem_it_end; ++elem_it)
+  {
+    const Elem * old_elem = *elem_it;
+    Elem * elem = Elem::build(old_elem->type()).release();
+    for(unsigned int n=0; n<old_elem->n_nodes(); ++n)
+      elem->set_node(n) = _mesh->node_ptr(old_elem->node(n));
+    elem->subdomain_id() = old_elem->subdomain_id();
+    _mesh->add_elem(elem);
+    affine_map = affine_map && elem->has_affine_map();
+  }
+
+  // neighbor information is required by neighbor walk
+  _mesh->find_neighbors();
+
+  _locator = AutoPtr<PointLocatorTree>(new PointLocatorTree(*_mesh, Trees::ELEMENTS));
+  // out of mesh mode only works for affine elements
+  _out_of_mesh_mode = affine_map;
+  if(_out_of_mesh_mode)
+    _locator->enable_out_of_mesh_mode();
+}
+
+
+void Interpolation_Mesh::broadcast(unsigned int root)
+{
+  std::vector<int> groups;
+  std::map<int, std::vector<double> >::iterator it=_field.begin();
+  for(; it!=_field.end(); ++it)
+    groups.push_back(it->first);
+  Parallel::broadcast(groups, root);
+
+  for(unsigned int n=0; n<groups.size(); ++n)
+  {
+    Parallel::broadcast(_field[groups[n]], root);
+
+    std::vector<char> & valid = _field_valid[groups[n]];
+    std::vector<int> valid_int(valid.begin(), valid.end());
+    Parallel::broadcast(valid_int, root);
+    valid.assign(valid_int.begin(), valid_int.end());
+
+    std::vector<int> type(1, static_cast<int>(_interpolation_type[groups[n]]));
+    Parallel::broadcast(type, root);
+    _interpolation_type[groups[n]] = static_cast<InterpolationType>(type[0]);
+  }
+}
+
+
+void Interpolation_Mesh::add_scatter_data(const Point & point, int group, double value)
+{
+  genius_assert(_mesh.get());
+
+  std::vector<double> & field = _field[group];
+  std::vector<char> & valid = _field_valid[group];
+  if( field.empty() )
+  {
+    field.resize(_mesh->max_node_id(), 0.0);
+    valid.resize(_mesh->max_node_id(), 0);
+  }
+
+  const Elem * elem = this->locate(point, _last_elem, *_locator);
+  if( elem == NULL ) return;
+  _last_elem = elem;
+
+  // the point should be one of the element nodes
+  unsigned int node_id = elem->node(0);
+  Real dist = std::numeric_limits<Real>::max();
+  for(unsigned int n=0; n<elem->n_nodes(); ++n)
+  {
+    Real d = (elem->point(n) - point).size();
+    if( d < dist ) { dist = d; node_id = elem->node(n); }
+  }
+
+  InterpolationType type = _interpolation_type[group];
+  field[node_id] = scaleValue(type, value);
+  valid[node_id] = 1;
+}
+
+
+void Interpolation_Mesh::setup(int group)
+{
+  // nothing to do, the point locator is built with source mesh
+}
+
+
+const Elem * Interpolation_Mesh::locate(const Point & p, const Elem * hint, const PointLocatorTree & locator) const
+{
+  // walk from the hint element toward p. each step we leave the element by
+  // the side whose outer region (respect to element centroid) contains p most deeply
+  const Elem * elem = hint;
+  for(unsigned int step=0; elem!=NULL && step<_max_walk_step; ++step)
+  {
+    if( elem->contains_point(p) )
+      return elem;
+
+    const Point centroid = elem->centroid();
+
+    unsigned int exit_side = invalid_uint;
+    Real max_distance = -std::numeric_limits<Real>::max();
+    for(unsigned int s=0; s<elem->n_sides(); ++s)
+    {
+      Point side_centroid;
+      unsigned int n_side_nodes = 0;
+      for(unsigned int n=0; n<elem->n_vertices(); ++n)
+        if( elem->is_node_on_side(n, s) )
+        { side_centroid += elem->point(n); n_side_nodes++; }
+      side_centroid /= n_side_nodes;
+
+      const Point norm = side_centroid - centroid;
+      const Real distance = ((p - side_centroid)*norm)/norm.size_sq();
+      if( distance > max_distance )
+      { max_distance = distance; exit_side = s; }
+    }
+
+    elem = exit_side != invalid_uint ? elem->neighbor(exit_side) : NULL;
+  }
+
+  // walk failed (reached boundary, hanging node or too far away), ask the tree
+  return locator(p);
+}
+
+
+double Interpolation_Mesh::interpolate(const Elem * elem, const Point & p, int group) const
+{
+  const std::vector<double> & field = _field.find(group)->second;
+  const std::vector<char> & valid = _field_valid.find(group)->second;
+
+  const FEType fe_type(elem->default_order());
+  const Point ref = FEInterface::inverse_map(elem->dim(), fe_type, elem, p, TOLERANCE, false);
+
+  // nodes without data (i.e. region doesn't have this variable) are excluded,
+  // the remaining shape functions are renormalized
+  double value = 0.0, weight = 0.0;
+  double average = 0.0;
+  unsigned int n_valid = 0;
+  for(unsigned int n=0; n<elem->n_nodes(); ++n)
+  {
+    const unsigned int id = elem->node(n);
+    if( !valid[id] ) continue;
+    const Real phi = FEInterface::shape(elem->dim(), fe_type, elem, n, ref);
+    value  += phi*field[id];
+    weight += phi;
+    average += field[id];
+    n_valid++;
+  }
+
+  if( std::abs(weight) > 1e-3 )
+    return value/weight;
+  if( n_valid )
+    return average/n_valid;
+  return 0.0;
+}
+
+
+double Interpolation_Mesh::get_interpolated_value(const Point & point, int group) const
+{
+  genius_assert(_field.find(group)!=_field.end());
+
+  InterpolationType type = _interpolation_type.find(group)->second;
+
+  const Elem * elem = this->locate(point, _last_elem, *_locator);
+  if( elem == NULL )
+  {
+    // out of source mesh, use the nearest element we know
+    if( _last_elem == NULL ) return unscaleValue(type, 0.0);
+    elem = _last_elem;
+  }
+  _last_elem = elem;
+
+  return unscaleValue(type, this->interpolate(elem, point, group));
+}
+
+
+void Interpolation_Mesh::get_interpolated_values(const std::vector<Point> & points, int group, std::vector<double> & values) const
+{
+  genius_assert(_field.find(group)!=_field.end());
+
+  InterpolationType type = _interpolation_type.find(group)->second;
+
+  const int n_points = static_cast<int>(points.size());
+  values.resize(points.size());
+
+  // each thread owns a servant locator which shares the tree of master locator,
+  // and keeps its own walk hint. target points are usually ordered by locality so
+  // static schedule keeps the hint close to the next point
+#ifdef HAVE_OPENMP
+  #pragma omp parallel
+#endif
+  {
+    PointLocatorTree locator(*_mesh, _locator.get());
+    if(_out_of_mesh_mode)
+      locator.enable_out_of_mesh_mode();
+    const Elem * hint = NULL;
+
+#ifdef HAVE_OPENMP
+    #pragma omp for schedule(static)
+#endif
+    for(int i=0; i<n_points; ++i)
+    {
+      const Elem * elem = this->locate(points[i], hint, locator);
+      if( elem == NULL ) elem = hint;
+      if( elem == NULL )
+      {
+        values[i] = unscaleValue(type, 0.0);
+        continue;
+      }
+      hint = elem;
+      values[i] = unscaleValue(type, this->interpolate(elem, points[i], group));
+    }
+  }
+}
+
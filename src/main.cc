@@ -68,9 +68,7 @@ int main(int argc, char ** args)
 #ifndef COGENDA_COMMERCIAL_PRODUCT
   if( Genius::n_processors() > 1 )
   {
-    PetscPrintf(PETSC_COMM_WORLD,"ERROR: Open Source Version does not support multi-processor.\n");
-    PetscFinalize();
-    exit(0);
+    PetscPrintf(PETSC_COMM_WORLD,"WARNING: Multi-processor support of Open Source Version is experimental.\n");
   }
 #endif
 
@@ -128,14 +126,53 @@ int main(int argc, char ** args)
   std::ofstream logfs;
   if (Genius::processor_id() == 0)
   {
-    genius_log.addStream("console", std::cerr.rdbuf());
+    // in sweep farm mode, only the first group writes to console, each group has its own log file
+    if (Genius::sweep_group() == 0)
+      genius_log.addStream("console", std::cerr.rdbuf());
     std::stringstream log_file;
     log_file << Genius::input_file() << ".log";
+    if (Genius::n_sweep_groups() > 1)
+      log_file << ".g" << Genius::sweep_group();
     logfs.open(log_file.str().c_str());
     genius_log.addStream("file", logfs.rdbuf());
   }
 
+  // log levels and asynchronous writing of the solver loop messages
+  {
+    PetscInt  log_level;
+    PetscBool level_flg;
+    PetscOptionsGetInt(PETSC_NULL, "-log_level", &log_level, &level_flg);
+    if(level_flg) genius_log.set_level(log_level);
+
+    char log_category[1024];
+    PetscBool category_flg;
+    PetscOptionsGetString(PETSC_NULL, "-log_category", log_category, 1023, &category_flg);
+    if(category_flg) genius_log.set_category_levels(log_category);
+
+    PetscBool async_flg;
+    PetscOptionsHasName(PETSC_NULL, "-async_log", &async_flg);
+    if(async_flg) genius_log.set_async(true);
+  }
+
   MESSAGE<<"Genius boot with " << Genius::n_processors() << " MPI thread.\n\n";  RECORD();
+  if (Genius::n_sweep_groups() > 1)
+  {
+    MESSAGE<<"Sweep farm: this is group " << Genius::sweep_group() << " of " << Genius::n_sweep_groups() << " sweep groups.\n\n";  RECORD();
+  }
+
+  // hardware counters of the logged events, needs -p
+  {
+    PetscBool counter_flg;
+    PetscOptionsHasName(PETSC_NULL, "-perf_counters", &counter_flg);
+    if(counter_flg && perflog.logging())
+    {
+      std::string message;
+      if(!perflog.enable_counters(message))
+      {
+        MESSAGE<<"Warning: " << message << ", hardware counters disabled.\n\n";  RECORD();
+      }
+    }
+  }
 
   // test if input file can be opened on processor 0 for read
   if ( Genius::processor_id() == 0 )
@@ -157,13 +194,17 @@ int main(int argc, char ** args)
   if (Genius::processor_id() == 0)
   {
     Parser::FilePreProcess * file_preprocess = new Parser::FilePreProcess(Genius::input_file());
-    input_file_pp = file_preprocess->output();
+    std::stringstream suffix;
+    if (Genius::n_sweep_groups() > 1)
+      suffix << ".g" << Genius::sweep_group();
+    input_file_pp = file_preprocess->output(suffix.str());
     delete file_preprocess;
   }
   Parallel::broadcast(input_file_pp);
 
-  // sync input file to other processor
-  const std::string localfile = sync_file(input_file_pp.c_str());
+  // share input file with other processor, without local copy
+  AutoPtr<SharedFile> input_text(new SharedFile(input_file_pp));
+  genius_assert(input_text->good());
 
   // read card specification file
   Parser::Pattern pt;
@@ -182,33 +223,64 @@ int main(int argc, char ** args)
   }
 
 
-  if (pt.get_from_XML(pattern_file) )
+  AutoPtr<Parser::InputParser> input = AutoPtr<Parser::InputParser>(new Parser::InputParser(pt));
+
+  // the validated cards of a previous run with the same input deck and pattern file.
+  // the cache is keyed by the content of preprocessed input file, not its time stamp
+  PetscBool     card_cache_flg;
+  PetscOptionsHasName(PETSC_NULL,"-card_cache", &card_cache_flg);
+  const std::string pattern_stamp = Parser::file_stamp(pattern_file);
+  std::string card_file, card_stamp;
+  bool cards_loaded = false;
+  if(card_cache_flg)
   {
-    PetscPrintf(PETSC_COMM_WORLD,"ERROR: I can't parse pattern file 'GeniusSyntax.xml'.\n" );
-    genius_error();
+    std::stringstream fcard;
+    fcard << Genius::input_file() << ".cards";
+    if (Genius::n_sweep_groups() > 1)
+      fcard << ".g" << Genius::sweep_group();
+    card_file  = fcard.str();
+    card_stamp = pattern_stamp + ":" + Parser::data_digest(input_text->data(), input_text->size());
+    cards_loaded = (input->load_cards(card_file, card_stamp) == 0);
+  }
+
+  if (!cards_loaded)
+  {
+    // binary image of the pattern file, rebuilt when GeniusSyntax.xml changed
+    std::string pattern_image = Genius::genius_dir() +  "/lib/GeniusSyntax.bin";
+    if (pt.get_from_binary(pattern_image, pattern_stamp) )
+    {
+      if (pt.get_from_XML(pattern_file) )
+      {
+        PetscPrintf(PETSC_COMM_WORLD,"ERROR: I can't parse pattern file 'GeniusSyntax.xml'.\n" );
+        genius_error();
+      }
+      // install dir may be read only, failure is silently ignored
+      if (Genius::processor_id() == 0 && Genius::sweep_group() == 0)
+        pt.save_to_binary(pattern_image, pattern_stamp);
+    }
   }
 
   // parse the input file
-  AutoPtr<Parser::InputParser> input = AutoPtr<Parser::InputParser>(new Parser::InputParser(pt));
-  if (input->read_card_file(localfile.c_str()) )
+  if (!cards_loaded && input->read_card_file(input_text->open()) )
   {
     // remove preprocessed file
     if (Genius::processor_id() == 0)
       remove(input_file_pp.c_str());
 
-    remove(localfile.c_str());
-
     PetscPrintf(PETSC_COMM_WORLD,"ERROR: I can't parse input file.\n");
     PetscFinalize();
     exit(0);
   }
 
+  if (card_cache_flg && !cards_loaded && Genius::processor_id() == 0)
+    input->save_cards(card_file, card_stamp);
+
   // remove preprocessed file
   if (Genius::processor_id() == 0)
     remove(input_file_pp.c_str());
 
-  // after that, remove local copy of input file
-  remove(localfile.c_str());
+  // free the shared input text, collective
+  input_text.reset();
 
   // set material define
   std::string material_file = Genius::genius_dir() +  "/lib/material.def";
@@ -256,7 +328,8 @@ int main(int argc, char ** args)
   //finish log system
   if (Genius::processor_id() == 0)
   {
-    genius_log.removeStream("console");
+    if (Genius::sweep_group() == 0)
+      genius_log.removeStream("console");
     genius_log.removeStream("file");
     logfs.close();
   }
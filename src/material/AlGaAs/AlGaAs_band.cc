@@ -184,60 +184,92 @@ private:
     parameter_map.insert(para_item("CON.BGN",  PARA("CON.BGN",  "The const parameter used in Slotboom's band-gap narrowing model", "-", 1.0, &CON_BGN)) );
 #endif
   }
+private:
+  /**
+   * band parameters which only depend on mole fraction
+   */
+  struct MoleParam
+  {
+    PetscScalar EG_Gamma, EG_X, EG_L;  // valley energy at 300K
+    PetscScalar TC_Gamma, TC_X, TC_L;  // coefficient of the temperature term of each valley
+    PetscScalar ME_Gamma, ME_X, ME_L;  // valley electron mass to the power of pm
+    PetscScalar MH;                    // hole effective mass
+  };
+
+  /**
+   * per-node table of MoleParam, filled at first evaluation after mole initialization
+   */
+  PMI_MoleTable<MoleParam> _mole_table;
+
+  MoleParam mole_param()
+  {
+    const PetscScalar x = ReadxMoleFraction();
+    bool stale;
+    MoleParam * entry = _mole_table.entry(current_node_offset(), x, stale);
+    if( entry && !stale ) return *entry;
+
+    MoleParam param;
+    param.EG_Gamma = EG300 + EG_X0 + EG_X1*x + EG_X2*x*x + EG_X3*x*x*x + EG_X4*x*x*x*x;
+    param.EG_X     = EG300 + EG_X5 + EG_X6*x + EG_X7*x*x + EG_X8*x*x*x + EG_X9*x*x*x*x;
+    param.EG_L     = EG300 + EG_X10 + EG_X11*x + EG_X12*x*x + EG_X13*x*x*x + EG_X14*x*x*x*x;
+    param.TC_Gamma = EGALPH+EGGAMM*x;
+    param.TC_X     = EGALX+EGGAX*x;
+    param.TC_L     = EGALL+EGGAL*x;
+    param.ME_Gamma = std::pow(MEG+MEG_X1*x,pm);
+    param.ME_X     = std::pow(MEX+MEX_X1*x,pm);
+    param.ME_L     = std::pow(MEL+MEL_X1*x,pm);
+    param.MH       = std::pow(std::pow(MH0+MH0_X1*x,pm)+std::pow(ML0+ML0_X1*x,pm),1.0/pm);
+    if( entry ) *entry = param;
+    return param;
+  }
+
+  template <typename T>
+  T E_Gamma(const MoleParam &m, const T &Tl)
+  { return m.EG_Gamma + (T300*T300/(T300+EGBETA)-Tl*Tl/(Tl+EGBETA))*m.TC_Gamma; }
+
+  template <typename T>
+  T E_X(const MoleParam &m, const T &Tl)
+  { return m.EG_X + (T300*T300/(T300+EGBEX)-Tl*Tl/(Tl+EGBEX))*m.TC_X; }
+
+  template <typename T>
+  T E_L(const MoleParam &m, const T &Tl)
+  { return m.EG_L + (T300*T300/(T300+EGBEL)-Tl*Tl/(Tl+EGBEL))*m.TC_L; }
+
 public:
+  void init_mole_table(unsigned int n)
+  { _mole_table.resize(n); }
+
   //---------------------------------------------------------------------------
   // we need calculate all the bandgap valley and choose lowest
   PetscScalar E_Gamma(const PetscScalar &Tl)
-  {
-        PetscScalar x = ReadxMoleFraction();
-        return EG300 + EG_X0 + EG_X1*x + EG_X2*x*x + EG_X3*x*x*x + EG_X4*x*x*x*x
-               + (T300*T300/(T300+EGBETA)-Tl*Tl/(Tl+EGBETA))*(EGALPH+EGGAMM*x);
-  }
+  { return E_Gamma(mole_param(), Tl); }
   AutoDScalar E_Gamma(const AutoDScalar &Tl)
-  {
-        PetscScalar x = ReadxMoleFraction();
-        return EG300 + EG_X0 + EG_X1*x + EG_X2*x*x + EG_X3*x*x*x + EG_X4*x*x*x*x
-               + (T300*T300/(T300+EGBETA)-Tl*Tl/(Tl+EGBETA))*(EGALPH+EGGAMM*x);
-  }
+  { return E_Gamma(mole_param(), Tl); }
 
   PetscScalar E_X(const PetscScalar &Tl)
-  {
-        PetscScalar x = ReadxMoleFraction();
-        return EG300 + EG_X5 + EG_X6*x + EG_X7*x*x + EG_X8*x*x*x + EG_X9*x*x*x*x
-               + (T300*T300/(T300+EGBEX)-Tl*Tl/(Tl+EGBEX))*(EGALX+EGGAX*x);
-  }
+  { return E_X(mole_param(), Tl); }
   AutoDScalar E_X(const AutoDScalar &Tl)
-  {
-        PetscScalar x = ReadxMoleFraction();
-        return EG300 + EG_X5 + EG_X6*x + EG_X7*x*x + EG_X8*x*x*x + EG_X9*x*x*x*x
-               + (T300*T300/(T300+EGBEX)-Tl*Tl/(Tl+EGBEX))*(EGALX+EGGAX*x);
-  }
+  { return E_X(mole_param(), Tl); }
 
   PetscScalar E_L(const PetscScalar &Tl)
-  {
-        PetscScalar x = ReadxMoleFraction();
-        return EG300 + EG_X10 + EG_X11*x + EG_X12*x*x + EG_X13*x*x*x + EG_X14*x*x*x*x
-               + (T300*T300/(T300+EGBEL)-Tl*Tl/(Tl+EGBEL))*(EGALL+EGGAL*x);
-  }
+  { return E_L(mole_param(), Tl); }
   AutoDScalar E_L(const AutoDScalar &Tl)
-  {
-        PetscScalar x = ReadxMoleFraction();
-        return EG300 + EG_X10 + EG_X11*x + EG_X12*x*x + EG_X13*x*x*x + EG_X14*x*x*x*x
-               + (T300*T300/(T300+EGBEL)-Tl*Tl/(Tl+EGBEL))*(EGALL+EGGAL*x);
-  }
+  { return E_L(mole_param(), Tl); }
 
   //---------------------------------------------------------------------------
   // procedure of Bandgap, return the lowest valley
   PetscScalar Eg (const PetscScalar &Tl)
   {
-    PetscScalar Eg1 = E_Gamma(Tl);
-    PetscScalar Eg2 = E_X(Tl);
+    const MoleParam m = mole_param();
+    PetscScalar Eg1 = E_Gamma(m, Tl);
+    PetscScalar Eg2 = E_X(m, Tl);
     return Eg1 < Eg2 ? Eg1 : Eg2;
   }
   AutoDScalar Eg (const AutoDScalar &Tl)
   {
-    AutoDScalar Eg1 = E_Gamma(Tl);
-    AutoDScalar Eg2 = E_X(Tl);
+    const MoleParam m = mole_param();
+    AutoDScalar Eg1 = E_Gamma(m, Tl);
+    AutoDScalar Eg2 = E_X(m, Tl);
     return fmin( Eg1 , Eg2);
   }
 
@@ -271,34 +303,38 @@ public:
   //electron and hole effect mass
   PetscScalar EffecElecMass(const PetscScalar &Tl)
   {
-        PetscScalar x = ReadxMoleFraction();
-        PetscScalar bandgap = Eg(Tl);
+        const MoleParam m = mole_param();
+        PetscScalar E1 = E_Gamma(m, Tl);
+        PetscScalar E2 = E_X(m, Tl);
+        PetscScalar E3 = E_L(m, Tl);
+        PetscScalar bandgap = E1 < E2 ? E1 : E2;
 
-        PetscScalar m_Gamma = std::pow(std::pow(MEG+MEG_X1*x,pm)*exp((bandgap-E_Gamma(Tl))/(kb*Tl)),1.0/pm);
-        PetscScalar m_X = std::pow(std::pow(MEX+MEX_X1*x,pm)*exp((bandgap-E_X(Tl))/(kb*Tl)),1.0/pm);
-        PetscScalar m_L = std::pow(std::pow(MEL+MEL_X1*x,pm)*exp((bandgap-E_L(Tl))/(kb*Tl)),1.0/pm);
+        PetscScalar m_Gamma = std::pow(m.ME_Gamma*exp((bandgap-E1)/(kb*Tl)),1.0/pm);
+        PetscScalar m_X = std::pow(m.ME_X*exp((bandgap-E2)/(kb*Tl)),1.0/pm);
+        PetscScalar m_L = std::pow(m.ME_L*exp((bandgap-E3)/(kb*Tl)),1.0/pm);
         return std::pow(std::pow(m_Gamma,pm)+std::pow(m_X,pm)+std::pow(m_L,pm),1.0/pm);
   }
   AutoDScalar EffecElecMass(const AutoDScalar &Tl)
   {
-        PetscScalar x = ReadxMoleFraction();
-        AutoDScalar bandgap = Eg(Tl);
+        const MoleParam m = mole_param();
+        AutoDScalar E1 = E_Gamma(m, Tl);
+        AutoDScalar E2 = E_X(m, Tl);
+        AutoDScalar E3 = E_L(m, Tl);
+        AutoDScalar bandgap = fmin(E1, E2);
 
-        AutoDScalar m_Gamma = adtl::pow(std::pow(MEG+MEG_X1*x,pm)*exp((bandgap-E_Gamma(Tl))/(kb*Tl)),1.0/pm);
-        AutoDScalar m_X = adtl::pow(std::pow(MEX+MEX_X1*x,pm)*exp((bandgap-E_X(Tl))/(kb*Tl)),1.0/pm);
-        AutoDScalar m_L = adtl::pow(std::pow(MEL+MEL_X1*x,pm)*exp((bandgap-E_L(Tl))/(kb*Tl)),1.0/pm);
+        AutoDScalar m_Gamma = adtl::pow(m.ME_Gamma*exp((bandgap-E1)/(kb*Tl)),1.0/pm);
+        AutoDScalar m_X = adtl::pow(m.ME_X*exp((bandgap-E2)/(kb*Tl)),1.0/pm);
+        AutoDScalar m_L = adtl::pow(m.ME_L*exp((bandgap-E3)/(kb*Tl)),1.0/pm);
         return adtl::pow(adtl::pow(m_Gamma,pm)+adtl::pow(m_X,pm)+adtl::pow(m_L,pm),1.0/pm);
   }
 
   PetscScalar EffecHoleMass(const PetscScalar &Tl)
   {
-        PetscScalar x = ReadxMoleFraction();
-        return std::pow(std::pow(MH0+MH0_X1*x,pm)+std::pow(ML0+ML0_X1*x,pm),1.0/pm);
+        return mole_param().MH;
   }
   AutoDScalar EffecHoleMass(const AutoDScalar &Tl)
   {
-        PetscScalar x = ReadxMoleFraction();
-        return std::pow(std::pow(MH0+MH0_X1*x,pm)+std::pow(ML0+ML0_X1*x,pm),1.0/pm);
+        return mole_param().MH;
   }
 
 
@@ -73,15 +73,49 @@ private:
     parameter_map.insert(para_item("AF.XL", PARA("AF.XL", "", "-",1.0 , &AF_XL)) );
 #endif
   }
+
+  /**
+   * basic parameters which only depend on mole fraction
+   */
+  struct MoleParam
+  {
+    PetscScalar permittivity;
+    PetscScalar affinity;
+  };
+
+  /**
+   * per-node table of MoleParam, filled at first evaluation after mole initialization
+   */
+  mutable PMI_MoleTable<MoleParam> _mole_table;
+
+  MoleParam mole_param() const
+  {
+    const PetscScalar mole_x = ReadxMoleFraction();
+    bool stale;
+    MoleParam * entry = _mole_table.entry(current_node_offset(), mole_x, stale);
+    if( entry && !stale ) return *entry;
+
+    MoleParam param;
+    param.permittivity = PERMITTI + EPS_X1*mole_x + EPS_X2*mole_x*mole_x;
+    if(mole_x<AF_XL)
+      param.affinity = AFFINITY + AF_X0 + AF_X1*mole_x + AF_X2*mole_x*mole_x;
+    else
+      param.affinity = AFFINITY + AF_X3 + AF_X4*mole_x + AF_X5*mole_x*mole_x;
+    if( entry ) *entry = param;
+    return param;
+  }
+
 public:
+  void init_mole_table(unsigned int n)
+  { _mole_table.resize(n); }
+
   PetscScalar Density       (const PetscScalar &Tl) const
   {
   	return DENSITY;
   }
   PetscScalar Permittivity() const
   {
-        PetscScalar mole_x = ReadxMoleFraction();
-        return PERMITTI + EPS_X1*mole_x + EPS_X2*mole_x*mole_x;
+        return mole_param().permittivity;
   }
   PetscScalar Permeability() const
   {
@@ -89,11 +123,7 @@ public:
   }
   PetscScalar Affinity      (const PetscScalar &Tl) const
   {
-        PetscScalar mole_x = ReadxMoleFraction();
-        if(mole_x<AF_XL)
-                return AFFINITY + AF_X0 + AF_X1*mole_x + AF_X2*mole_x*mole_x;
-        else
-                return AFFINITY + AF_X3 + AF_X4*mole_x + AF_X5*mole_x*mole_x;
+        return mole_param().affinity;
   }
 
   void atom_fraction(std::vector<std::string> &atoms, std::vector<double> & fraction) const
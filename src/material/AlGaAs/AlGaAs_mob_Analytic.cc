@@ -139,16 +139,53 @@ private:
 #endif
   }
 
+  /**
+   * mobility parameters which only depend on mole fraction
+   */
+  struct MoleParam
+  {
+    PetscScalar mun_min, mun_max;
+    PetscScalar mup_min, mup_max;
+    PetscScalar vsatn, E0n, E0n_4;
+  };
+
+  /**
+   * per-node table of MoleParam, filled at first evaluation after mole initialization
+   */
+  mutable PMI_MoleTable<MoleParam> _mole_table;
+
+  MoleParam mole_param() const
+  {
+    const PetscScalar x = ReadxMoleFraction();
+    bool stale;
+    MoleParam * entry = _mole_table.entry(current_node_offset(), x, stale);
+    if( entry && !stale ) return *entry;
+
+    MoleParam param;
+    param.mun_min = MUN_MIN*(1+MIN_X1*x+MIN_X2*x*x);
+    param.mun_max = MUN_MAX*(1+MAN_X1*x+MAN_X2*x*x);
+    param.mup_min = MUP_MIN*(1+MIP_X1*x+MIP_X2*x*x);
+    param.mup_max = MUP_MAX*(1+MAP_X1*x+MAP_X2*x*x);
+    param.vsatn   = VSATN*(1+ VSN1*x + VSN2*x*x);
+    param.E0n     = E0N*(1+EN1*x+EN2*x*x);
+    param.E0n_4   = std::pow(param.E0n,4);
+    if( entry ) *entry = param;
+    return param;
+  }
+
 public:
+  void init_mole_table(unsigned int n)
+  { _mole_table.resize(n); }
+
   //---------------------------------------------------------------------------
   // Electron low field mobility
   PetscScalar ElecMobLowField(const PetscScalar &Tl) const
   {
     PetscScalar Na = ReadDopingNa();
     PetscScalar Nd = ReadDopingNd();
-    PetscScalar x = ReadxMoleFraction();
-    PetscScalar mu_min = MUN_MIN*(1+MIN_X1*x+MIN_X2*x*x);
-    PetscScalar mu_max = MUN_MAX*(1+MAN_X1*x+MAN_X2*x*x);
+    const MoleParam m = mole_param();
+    PetscScalar mu_min = m.mun_min;
+    PetscScalar mu_max = m.mun_max;
     return mu_min+(mu_max*std::pow(Tl/T300,NUN)-mu_min)/ \
            (1+std::pow(Tl/T300,XIN)*(std::pow((Na+Nd)/NREFN,ALPHAN)+std::pow((Na+Nd)/NREFN2,3)));
   }
@@ -156,9 +193,9 @@ public:
   {
     PetscScalar Na = ReadDopingNa();
     PetscScalar Nd = ReadDopingNd();
-    PetscScalar x = ReadxMoleFraction();
-    PetscScalar mu_min = MUN_MIN*(1+MIN_X1*x+MIN_X2*x*x);
-    PetscScalar mu_max = MUN_MAX*(1+MAN_X1*x+MAN_X2*x*x);
+    const MoleParam m = mole_param();
+    PetscScalar mu_min = m.mun_min;
+    PetscScalar mu_max = m.mun_max;
     return mu_min+(mu_max*adtl::pow(Tl/T300,NUN)-mu_min)/ \
            (1+adtl::pow(Tl/T300,XIN)*(std::pow((Na+Nd)/NREFN,ALPHAN)+std::pow((Na+Nd)/NREFN2,3)));
   }
@@ -169,9 +206,9 @@ public:
   {
     PetscScalar Na = ReadDopingNa();
     PetscScalar Nd = ReadDopingNd();
-    PetscScalar x = ReadxMoleFraction();
-    PetscScalar mu_min = MUP_MIN*(1+MIP_X1*x+MIP_X2*x*x);
-    PetscScalar mu_max = MUP_MAX*(1+MAP_X1*x+MAP_X2*x*x);
+    const MoleParam m = mole_param();
+    PetscScalar mu_min = m.mup_min;
+    PetscScalar mu_max = m.mup_max;
     return mu_min+(mu_max*std::pow(Tl/T300,NUP)-mu_min)/ \
            (1+std::pow(Tl/T300,XIP)*(std::pow((Na+Nd)/NREFP,ALPHAP)+std::pow((Na+Nd)/NREFP2,3)));
   }
@@ -179,9 +216,9 @@ public:
   {
     PetscScalar Na = ReadDopingNa();
     PetscScalar Nd = ReadDopingNd();
-    PetscScalar x = ReadxMoleFraction();
-    PetscScalar mu_min = MUP_MIN*(1+MIP_X1*x+MIP_X2*x*x);
-    PetscScalar mu_max = MUP_MAX*(1+MAP_X1*x+MAP_X2*x*x);
+    const MoleParam m = mole_param();
+    PetscScalar mu_min = m.mup_min;
+    PetscScalar mu_max = m.mup_max;
     return mu_min+(mu_max*adtl::pow(Tl/T300,NUP)-mu_min)/ \
            (1+adtl::pow(Tl/T300,XIP)*(std::pow((Na+Nd)/NREFP,ALPHAP)+std::pow((Na+Nd)/NREFP2,3)));
   }
@@ -193,20 +230,16 @@ public:
   PetscScalar ElecMob(const PetscScalar &p, const PetscScalar &n, const PetscScalar &Tl,
                       const PetscScalar &Ep, const PetscScalar &Et, const PetscScalar &Tn) const
   {
-    PetscScalar x = ReadxMoleFraction();
-    PetscScalar vsat = VSATN*(1+ VSN1*x + VSN2*x*x);
-    PetscScalar E0   = E0N*(1+EN1*x+EN2*x*x);
+    const MoleParam m = mole_param();
     PetscScalar mu0  = ElecMobLowField(Tl);
-    return (mu0+vsat*std::pow(Ep,3)/std::pow(E0,4))/(1+std::pow(Ep/E0,4));
+    return (mu0+m.vsatn*std::pow(Ep,3)/m.E0n_4)/(1+std::pow(Ep/m.E0n,4));
   }
   AutoDScalar ElecMob(const AutoDScalar &p, const AutoDScalar &n, const AutoDScalar &Tl,
                       const AutoDScalar &Ep, const AutoDScalar &Et, const AutoDScalar &Tn) const
   {
-    PetscScalar x = ReadxMoleFraction();
-    PetscScalar vsat = VSATN*(1+ VSN1*x + VSN2*x*x);
-    PetscScalar E0   = E0N*(1+EN1*x+EN2*x*x);
+    const MoleParam m = mole_param();
     AutoDScalar mu0  = ElecMobLowField(Tl);
-    return (mu0+vsat*adtl::pow(Ep,3)/std::pow(E0,4))/(1+adtl::pow(Ep/E0,4));
+    return (mu0+m.vsatn*adtl::pow(Ep,3)/m.E0n_4)/(1+adtl::pow(Ep/m.E0n,4));
   }
 
   //---------------------------------------------------------------------------
@@ -253,7 +253,7 @@ public:
    */
   PetscScalar Charge(const bool flag_bulk)
   {
-    TrapLocation tloc = TrapLocation((*pp_point)->x(), (*pp_point)->y(), (*pp_point)->z(), flag_bulk?Bulk:Interface);
+    TrapLocation tloc = TrapLocation(current_point()->x(), current_point()->y(), current_point()->z(), flag_bulk?Bulk:Interface);
 
     TrapStore_t::iterator it = TrapStore.find(tloc);
 
@@ -286,7 +286,7 @@ public:
    */
   AutoDScalar ChargeAD(const bool flag_bulk)
   {
-    TrapLocation tloc = TrapLocation((*pp_point)->x(), (*pp_point)->y(), (*pp_point)->z(), flag_bulk?Bulk:Interface);
+    TrapLocation tloc = TrapLocation(current_point()->x(), current_point()->y(), current_point()->z(), flag_bulk?Bulk:Interface);
 
     TrapStore_t::iterator it = TrapStore.find(tloc);
 
@@ -317,7 +317,7 @@ public:
   {
     PetscScalar theta_n = 1.0e7*cm/s * sqrt(Tl/300/K);     // electron thermal velocity
 
-    TrapLocation tloc = TrapLocation((*pp_point)->x(), (*pp_point)->y(), (*pp_point)->z(), flag_bulk?Bulk:Interface);
+    TrapLocation tloc = TrapLocation(current_point()->x(), current_point()->y(), current_point()->z(), flag_bulk?Bulk:Interface);
 
     TrapStore_t::iterator it = TrapStore.find(tloc);
 
@@ -356,7 +356,7 @@ public:
   {
     AutoDScalar theta_n = 1.0e7*cm/s * sqrt(Tl/300/K);
 
-    TrapLocation tloc = TrapLocation((*pp_point)->x(), (*pp_point)->y(), (*pp_point)->z(), flag_bulk?Bulk:Interface);
+    TrapLocation tloc = TrapLocation(current_point()->x(), current_point()->y(), current_point()->z(), flag_bulk?Bulk:Interface);
 
     TrapStore_t::iterator it = TrapStore.find(tloc);
 
@@ -393,7 +393,7 @@ public:
   {
     PetscScalar theta_p = 1.0e7*cm/s * sqrt(Tl/300/K);     // hole thermal velocity
 
-    TrapLocation tloc = TrapLocation((*pp_point)->x(), (*pp_point)->y(), (*pp_point)->z(), flag_bulk?Bulk:Interface);
+    TrapLocation tloc = TrapLocation(current_point()->x(), current_point()->y(), current_point()->z(), flag_bulk?Bulk:Interface);
 
     TrapStore_t::iterator it = TrapStore.find(tloc);
 
@@ -432,7 +432,7 @@ public:
   {
     AutoDScalar theta_p = 1.0e7*cm/s * sqrt(Tl/300/K);
 
-    TrapLocation tloc = TrapLocation((*pp_point)->x(), (*pp_point)->y(), (*pp_point)->z(), flag_bulk?Bulk:Interface);
+    TrapLocation tloc = TrapLocation(current_point()->x(), current_point()->y(), current_point()->z(), flag_bulk?Bulk:Interface);
 
     TrapStore_t::iterator it = TrapStore.find(tloc);
 
@@ -465,7 +465,7 @@ public:
     PetscScalar theta_n = 1.0e7*cm/s * sqrt(Tl/300/K);     // electron thermal velocity
     PetscScalar theta_p = 1.0e7*cm/s * sqrt(Tl/300/K);     // hole thermal velocity
 
-    TrapLocation tloc = TrapLocation((*pp_point)->x(), (*pp_point)->y(), (*pp_point)->z(), flag_bulk?Bulk:Interface);
+    TrapLocation tloc = TrapLocation(current_point()->x(), current_point()->y(), current_point()->z(), flag_bulk?Bulk:Interface);
 
     TrapStore_t::iterator it = TrapStore.find(tloc);
 
@@ -509,7 +509,7 @@ public:
     AutoDScalar theta_n = 1.0e7*cm/s * sqrt(Tl/300/K);     // electron thermal velocity
     AutoDScalar theta_p = 1.0e7*cm/s * sqrt(Tl/300/K);     // hole thermal velocity
 
-    TrapLocation tloc = TrapLocation((*pp_point)->x(), (*pp_point)->y(), (*pp_point)->z(), flag_bulk?Bulk:Interface);
+    TrapLocation tloc = TrapLocation(current_point()->x(), current_point()->y(), current_point()->z(), flag_bulk?Bulk:Interface);
 
     TrapStore_t::iterator it = TrapStore.find(tloc);
 
@@ -552,7 +552,7 @@ public:
   {
     AutoDScalar theta_n = 1.0e7*cm/s * sqrt(Tl/300/K);     // electron thermal velocity
 
-    TrapLocation tloc = TrapLocation((*pp_point)->x(), (*pp_point)->y(), (*pp_point)->z(), flag_bulk?Bulk:Interface);
+    TrapLocation tloc = TrapLocation(current_point()->x(), current_point()->y(), current_point()->z(), flag_bulk?Bulk:Interface);
 
     TrapStore_t::iterator it = TrapStore.find(tloc);
 
@@ -598,7 +598,7 @@ public:
       PetscScalar conc = ReadRealVariable(TrapSpecs[i].profile_name); // read concentration from profile
       conc=conc*TrapSpecs[i].prefactor;     // concentration is scaled by the prefactor
       if (conc>0)
-        AddTrap(*(*pp_point),i,conc);
+        AddTrap(*current_point(),i,conc);
     }
   }
   // }}}
@@ -620,7 +620,7 @@ public:
 
       PetscScalar conc = TrapSpecs[i].interface_density;
       if (conc>0)
-        AddTrap(*(*pp_point),i,conc);
+        AddTrap(*current_point(),i,conc);
     }
   }
   // }}}
@@ -632,7 +632,7 @@ public:
   void Calculate(const bool flag_bulk, const PetscScalar &p, const PetscScalar &n, const PetscScalar &ni, const PetscScalar &Tl)
   {
 
-    TrapLocation tloc = TrapLocation((*pp_point)->x(), (*pp_point)->y(), (*pp_point)->z(), flag_bulk?Bulk:Interface);
+    TrapLocation tloc = TrapLocation(current_point()->x(), current_point()->y(), current_point()->z(), flag_bulk?Bulk:Interface);
 
     TrapStore_t::iterator it = TrapStore.find(tloc);
 
@@ -691,7 +691,7 @@ public:
   void Calculate(const bool flag_bulk, const AutoDScalar &p, const AutoDScalar &n, const AutoDScalar &ni, const AutoDScalar &Tl)
   {
 
-    TrapLocation tloc = TrapLocation((*pp_point)->x(), (*pp_point)->y(), (*pp_point)->z(), flag_bulk?Bulk:Interface);
+    TrapLocation tloc = TrapLocation(current_point()->x(), current_point()->y(), current_point()->z(), flag_bulk?Bulk:Interface);
 
     TrapStore_t::iterator it = TrapStore.find(tloc);
 
@@ -740,13 +740,23 @@ public:
   }
   // }}}
 
+  // {{{ bool ScaleDensity(const PetscScalar &factor)
+  bool ScaleDensity(const PetscScalar &factor)
+  {
+    for (TrapStore_t::iterator it = TrapStore.begin(); it != TrapStore.end(); ++it)
+      for (std::vector<Trap>::iterator t = it->second.begin(); t != it->second.end(); ++t)
+        t->N_tt *= factor;
+    return true;
+  }
+  // }}}
+
   // {{{ void Update(const bool flag_bulk, const PetscScalar &p, const PetscScalar &n, const PetscScalar &ni, const PetscScalar &Tl)
   /**
    * Converged results are obtained, so we should update the solution
    */
   void Update(const bool flag_bulk, const PetscScalar &p, const PetscScalar &n, const PetscScalar &ni, const PetscScalar &Tl)
   {
-    TrapLocation tloc = TrapLocation((*pp_point)->x(), (*pp_point)->y(), (*pp_point)->z(), flag_bulk?Bulk:Interface);
+    TrapLocation tloc = TrapLocation(current_point()->x(), current_point()->y(), current_point()->z(), flag_bulk?Bulk:Interface);
 
     TrapStore_t::iterator it = TrapStore.find(tloc);
 
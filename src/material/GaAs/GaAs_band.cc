@@ -180,6 +180,26 @@ public:
     return sqrt(Nc*Nv)*exp(-bandgap/(2*kb*Tl))*exp(EgNarrow(p, n, Tl));
   }
 
+  // batched nie, doping of all the nodes is gathered first
+  // so that the arithmetic loop has no function call and can be vectorized
+  void nie (const unsigned int size, const PMI_NodeContext *context,
+            const PetscScalar *p, const PetscScalar *n, const PetscScalar *Tl, PetscScalar *result)
+  {
+    const PetscScalar N0 = 1.0*std::pow(cm,-3);
+    for(unsigned int i=0; i<size; ++i)
+      result[i] = ReadDopingNa(context[i]) + ReadDopingNd(context[i]) + N0;
+
+    for(unsigned int i=0; i<size; ++i)
+    {
+      const PetscScalar T = Tl[i];
+      const PetscScalar x = log(result[i]/N0_BGN);
+      const PetscScalar bandgap = EG300+EGALPH*(T300*T300/(T300+EGBETA) - T*T/(T+EGBETA));
+      const PetscScalar Nc = NC300*std::pow(T/T300,NC_F);
+      const PetscScalar Nv = NV300*std::pow(T/T300,NV_F);
+      result[i] = sqrt(Nc*Nv)*exp(-bandgap/(2*kb*T))*exp(V0_BGN*(x+sqrt(x*x+CON_BGN)));
+    }
+  }
+
   //end of Bandgap
 
 private:
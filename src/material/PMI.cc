@@ -36,11 +36,12 @@ using namespace adtl;
  */
 void PMI_Server::ReadCoordinate (PetscScalar& x, PetscScalar& y, PetscScalar& z) const
 {
-  if(pp_point)
+  const Point * p = current_point();
+  if(p)
   {
-    x = (*pp_point)->x();
-    y = (*pp_point)->y();
-    z = (*pp_point)->z();
+    x = p->x();
+    y = p->y();
+    z = p->z();
   }
   else
   {
@@ -50,13 +51,25 @@ void PMI_Server::ReadCoordinate (PetscScalar& x, PetscScalar& y, PetscScalar& z)
   }
 }
 
+/**
+ * map the node context of calling thread
+ */
+PMI_NodeContext PMI_Server::bind_context(const PMI_NodeContext &context) const
+{
+  if( !p_context ) return PMI_NodeContext();
+  PMI_NodeContext & slot = p_context[PMI_thread_id()];
+  PMI_NodeContext old = slot;
+  slot = context;
+  return old;
+}
+
 /**
  * aux function return current time.
  */
 PetscScalar PMI_Server::ReadTime () const
 {
-  if( p_clock )
-    return *p_clock;
+  if( p_context )
+    return p_context[PMI_thread_id()].clock;
   return 0.0;
 }
 
@@ -86,8 +99,8 @@ unsigned int PMI_Server::VariableIndex(const std::string &v) const
  */
 PetscScalar PMI_Server::ReadRealVariable (const unsigned int v) const
 {
-  if( pp_node_data )
-    return (*pp_node_data)->data<Real>(v);
+  if( current_node_data() )
+    return current_node_data()->get_data<Real>(v);
   return 0.0;
 }
 
@@ -97,8 +110,8 @@ PetscScalar PMI_Server::ReadRealVariable (const unsigned int v) const
  */
 PetscScalar PMI_Server::ReadRealVariable (const std::string & v) const
 {
-  if( pp_node_data )
-    return (*pp_node_data)->data<Real>(v);
+  if( current_node_data() )
+    return current_node_data()->get_data<Real>(v);
   return 0.0;
 }
 
@@ -236,7 +249,7 @@ const std::string & PMI_Server::get_parameter_string(const int verbosity)
  * also set the physical constants
  */
 PMI_Server::PMI_Server(const PMI_Environment &env)
-  : pp_variables(env.pp_variables), pp_point(env.pp_point), pp_node_data(env.pp_node_data), p_clock(env.p_clock)
+  : pp_variables(env.pp_variables), p_context(env.p_context)
 {
 
   m  = env.m;
@@ -283,12 +296,21 @@ void PMIS_Server::SetFakeMoleEnvironment(PetscScalar mole_x, PetscScalar mole_y)
 }
 
 
+/**
+ * data offset of current node in region storage
+ */
+unsigned int PMIS_Server::current_node_offset() const
+{
+  if(current_node_data()) return current_node_data()->offset();
+  return invalid_uint;
+}
+
 /**
  * aux function return first mole function of current node.
  */
 PetscScalar PMIS_Server::ReadxMoleFraction () const
 {
-  if(pp_node_data) return (*pp_node_data)->mole_x();
+  if(current_node_data()) return current_node_data()->mole_x();
   return _mole_x;
 }
 
@@ -297,9 +319,9 @@ PetscScalar PMIS_Server::ReadxMoleFraction () const
  */
 PetscScalar PMIS_Server::ReadxMoleFraction (const PetscScalar mole_xmin, const PetscScalar mole_xmax) const
 {
-  if(pp_node_data)
+  if(current_node_data())
   {
-    PetscScalar mole_x=(*pp_node_data)->mole_x();
+    PetscScalar mole_x=current_node_data()->mole_x();
     if( mole_x < mole_xmin ) return mole_xmin;
     if( mole_x > mole_xmax ) return mole_xmax;
     return mole_x;
@@ -312,7 +334,7 @@ PetscScalar PMIS_Server::ReadxMoleFraction (const PetscScalar mole_xmin, const P
  */
 PetscScalar PMIS_Server::ReadyMoleFraction () const
 {
-  if(pp_node_data) return (*pp_node_data)->mole_y();
+  if(current_node_data()) return current_node_data()->mole_y();
   return _mole_y;
 }
 
@@ -321,9 +343,9 @@ PetscScalar PMIS_Server::ReadyMoleFraction () const
  */
 PetscScalar PMIS_Server::ReadyMoleFraction (const PetscScalar mole_ymin, const PetscScalar mole_ymax) const
 {
-  if(pp_node_data)
+  if(current_node_data())
   {
-    PetscScalar mole_y=(*pp_node_data)->mole_y();
+    PetscScalar mole_y=current_node_data()->mole_y();
     if( mole_y < mole_ymin ) return mole_ymin;
     if( mole_y > mole_ymax ) return mole_ymax;
     return mole_y;
@@ -336,7 +358,7 @@ PetscScalar PMIS_Server::ReadyMoleFraction (const PetscScalar mole_ymin, const P
  */
 PetscScalar PMIS_Server::ReadDopingNa () const
 {
-  if(pp_node_data)  return (*pp_node_data)->Total_Na();
+  if(current_node_data())  return current_node_data()->Total_Na();
   return _Na;
 }
 
@@ -345,10 +367,102 @@ PetscScalar PMIS_Server::ReadDopingNa () const
  */
 PetscScalar PMIS_Server::ReadDopingNd () const
 {
-  if(pp_node_data) return (*pp_node_data)->Total_Nd();
+  if(current_node_data()) return current_node_data()->Total_Nd();
   return _Nd;
 }
 
+/**
+ * aux function return total Acceptor concentration of node described by context
+ */
+PetscScalar PMIS_Server::ReadDopingNa (const PMI_NodeContext &context) const
+{
+  if(context.node_data) return context.node_data->Total_Na();
+  return _Na;
+}
+
+/**
+ * aux function return total Donor concentration of node described by context
+ */
+PetscScalar PMIS_Server::ReadDopingNd (const PMI_NodeContext &context) const
+{
+  if(context.node_data) return context.node_data->Total_Nd();
+  return _Nd;
+}
+
+
+/*****************************************************************************
+ *               Batched Band Structure and Mobility
+ ****************************************************************************/
+
+/**
+ * batched band gap, map each node and call the scalar version
+ */
+void PMIS_BandStructure::Eg(const unsigned int size, const PMI_NodeContext *context,
+                            const PetscScalar *Tl, PetscScalar *result)
+{
+  if( !size ) return;
+  const PMI_NodeContext old = bind_context(context[0]);
+  for(unsigned int i=0; i<size; ++i)
+  {
+    bind_context(context[i]);
+    result[i] = Eg(Tl[i]);
+  }
+  bind_context(old);
+}
+
+/**
+ * batched effective intrinsic carrier concentration, map each node and call the scalar version
+ */
+void PMIS_BandStructure::nie(const unsigned int size, const PMI_NodeContext *context,
+                             const PetscScalar *p, const PetscScalar *n, const PetscScalar *Tl,
+                             PetscScalar *result)
+{
+  if( !size ) return;
+  const PMI_NodeContext old = bind_context(context[0]);
+  for(unsigned int i=0; i<size; ++i)
+  {
+    bind_context(context[i]);
+    result[i] = nie(p[i], n[i], Tl[i]);
+  }
+  bind_context(old);
+}
+
+/**
+ * batched electron mobility, map each node and call the scalar version
+ */
+void PMIS_Mobility::ElecMob(const unsigned int size, const PMI_NodeContext *context,
+                            const PetscScalar *p,  const PetscScalar *n,  const PetscScalar *Tl,
+                            const PetscScalar *Ep, const PetscScalar *Et, const PetscScalar *Tn,
+                            PetscScalar *result) const
+{
+  if( !size ) return;
+  const PMI_NodeContext old = bind_context(context[0]);
+  for(unsigned int i=0; i<size; ++i)
+  {
+    bind_context(context[i]);
+    result[i] = ElecMob(p[i], n[i], Tl[i], Ep[i], Et[i], Tn[i]);
+  }
+  bind_context(old);
+}
+
+/**
+ * batched hole mobility, map each node and call the scalar version
+ */
+void PMIS_Mobility::HoleMob(const unsigned int size, const PMI_NodeContext *context,
+                            const PetscScalar *p,  const PetscScalar *n,  const PetscScalar *Tl,
+                            const PetscScalar *Ep, const PetscScalar *Et, const PetscScalar *Tp,
+                            PetscScalar *result) const
+{
+  if( !size ) return;
+  const PMI_NodeContext old = bind_context(context[0]);
+  for(unsigned int i=0; i<size; ++i)
+  {
+    bind_context(context[i]);
+    result[i] = HoleMob(p[i], n[i], Tl[i], Ep[i], Et[i], Tp[i]);
+  }
+  bind_context(old);
+}
+
 
 /*****************************************************************************
  *               Physical Model Interface for Optical
@@ -23,6 +23,8 @@
 
 
 #include "PMI.h"
+// generated from src/math/mob_field.jac by build/jacgen.py
+#include "mob_field_jac.h"
 
 class GSS_Si_Mob_Analytic : public PMIS_Mobility
 {
@@ -149,7 +151,7 @@ public:
   {
     AutoDScalar vsat = VSATN0/(1+VSATN_A*exp(Tl/(2*T300)));
     AutoDScalar mu0  = ElecMobLowField(Tl);
-    return mu0/adtl::pow(1+adtl::pow(mu0*fabs(Ep)/vsat,BETAN),1.0/BETAN);
+    return mob_caughey_thomas_jac(mu0, Ep, vsat, BETAN);
   }
 
   //---------------------------------------------------------------------------
@@ -166,7 +168,7 @@ public:
   {
     AutoDScalar vsat = VSATP0/(1+VSATP_A*exp(Tl/(2*T300)));
     AutoDScalar mu0  = HoleMobLowField(Tl);
-    return mu0/adtl::pow(1+adtl::pow(mu0*fabs(Ep)/vsat,BETAP),1.0/BETAP);
+    return mob_caughey_thomas_jac(mu0, Ep, vsat, BETAP);
   }
 
 
@@ -146,7 +146,10 @@ private:
   {
     PetscScalar Na = ReadDopingNa();
     PetscScalar Nd = ReadDopingNd();
-    PetscScalar N_total = Na+Nd+1e0*std::pow(cm,-3);
+    return ElecMobLowField(Tl, Na+Nd+1e0*std::pow(cm,-3));
+  }
+  PetscScalar ElecMobLowField(const PetscScalar &Tl, const PetscScalar &N_total) const
+  {
     PetscScalar mu_max = MUN2_LSM*std::pow(Tl/T300,-EXN3_LSM);
     return MUN0_LSM+(mu_max-MUN0_LSM)/(1+std::pow(N_total/CRN_LSM,EXN1_LSM))-MUN1_LSM/(1+std::pow(CSN_LSM/N_total,EXN2_LSM));
   }
@@ -165,7 +168,10 @@ private:
   {
     PetscScalar Na = ReadDopingNa();
     PetscScalar Nd = ReadDopingNd();
-    PetscScalar N_total = Na+Nd+1e0*std::pow(cm,-3);
+    return HoleMobLowField(Tl, Na+Nd+1e0*std::pow(cm,-3));
+  }
+  PetscScalar HoleMobLowField(const PetscScalar &Tl, const PetscScalar &N_total) const
+  {
     PetscScalar mu_max = MUP2_LSM*std::pow(Tl/T300,-EXP3_LSM);
     return MUP0_LSM*exp(-PC_LSM/N_total)+mu_max/(1+std::pow(N_total/CRP_LSM,EXP1_LSM))-MUP1_LSM/(1+std::pow(CSP_LSM/N_total,EXP2_LSM));
   }
@@ -184,7 +190,10 @@ private:
   {
     PetscScalar Na = ReadDopingNa();
     PetscScalar Nd = ReadDopingNd();
-    PetscScalar N_total = Na+Nd+1e0*std::pow(cm,-3);
+    return ElecMobSurface(Tl, Et, Na+Nd+1e0*std::pow(cm,-3));
+  }
+  PetscScalar ElecMobSurface(const PetscScalar &Tl,const PetscScalar &Et, const PetscScalar &N_total) const
+  {
     PetscScalar ET = Et+1.0*V/cm;
     PetscScalar mu_ac = BN_LSM/ET + CN_LSM*std::pow(N_total,EXN4_LSM)/Tl*std::pow(ET,PetscScalar(-1.0/3.0));
     PetscScalar mu_sr = DN_LSM*std::pow(ET,-EXN8_LSM);
@@ -207,7 +216,10 @@ private:
   {
     PetscScalar Na = ReadDopingNa();
     PetscScalar Nd = ReadDopingNd();
-    PetscScalar N_total = Na+Nd+1e0*std::pow(cm,-3);
+    return HoleMobSurface(Tl, Et, Na+Nd+1e0*std::pow(cm,-3));
+  }
+  PetscScalar HoleMobSurface(const PetscScalar &Tl,const PetscScalar &Et, const PetscScalar &N_total) const
+  {
     PetscScalar ET = Et+1.0*V/cm;
     PetscScalar mu_ac = BP_LSM/ET + CP_LSM*std::pow(N_total,EXP4_LSM)/Tl*std::pow(ET,PetscScalar(-1.0/3.0));
     PetscScalar mu_sr = DP_LSM*std::pow(ET,-EXP8_LSM);
@@ -292,6 +304,45 @@ public:
     return mu0/adtl::pow(1+adtl::pow(mu0*fabs(Ep)/vsat,BETAP),1.0/BETAP);
   }
 
+  //---------------------------------------------------------------------------
+  // batched electron mobility, total doping of all the nodes is gathered first
+  // so that the arithmetic loop has no virtual call and can be vectorized
+  void ElecMob(const unsigned int size, const PMI_NodeContext *context,
+               const PetscScalar *p,  const PetscScalar *n,  const PetscScalar *Tl,
+               const PetscScalar *Ep, const PetscScalar *Et, const PetscScalar *Tn,
+               PetscScalar *result) const
+  {
+    const PetscScalar N0 = 1e0*std::pow(cm,-3);
+    for(unsigned int i=0; i<size; ++i)
+      result[i] = ReadDopingNa(context[i]) + ReadDopingNd(context[i]) + N0;
+
+    for(unsigned int i=0; i<size; ++i)
+    {
+      PetscScalar vsat = VSATN0/(1+VSATN_A*exp(Tl[i]/(2*T300)));
+      PetscScalar mu0  = 1.0/(1.0/ElecMobLowField(Tl[i], result[i])+1.0/ElecMobSurface(Tl[i], Et[i], result[i]));
+      result[i] = mu0/std::pow(1+std::pow(mu0*fabs(Ep[i])/vsat,BETAN),1.0/BETAN);
+    }
+  }
+
+  //---------------------------------------------------------------------------
+  // batched hole mobility
+  void HoleMob(const unsigned int size, const PMI_NodeContext *context,
+               const PetscScalar *p,  const PetscScalar *n,  const PetscScalar *Tl,
+               const PetscScalar *Ep, const PetscScalar *Et, const PetscScalar *Tp,
+               PetscScalar *result) const
+  {
+    const PetscScalar N0 = 1e0*std::pow(cm,-3);
+    for(unsigned int i=0; i<size; ++i)
+      result[i] = ReadDopingNa(context[i]) + ReadDopingNd(context[i]) + N0;
+
+    for(unsigned int i=0; i<size; ++i)
+    {
+      PetscScalar vsat = VSATP0/(1+VSATP_A*exp(Tl[i]/(2*T300)));
+      PetscScalar mu0  = 1.0/(1.0/HoleMobLowField(Tl[i], result[i])+1.0/HoleMobSurface(Tl[i], Et[i], result[i]));
+      result[i] = mu0/std::pow(1+std::pow(mu0*fabs(Ep[i])/vsat,BETAP),1.0/BETAP);
+    }
+  }
+
   // constructor
 public:
   GSS_Si_Mob_Lombardi(const PMIS_Environment &env):PMIS_Mobility(env)
@@ -22,6 +22,8 @@
 // Material Type: Silicon
 
 
+#include <algorithm>
+
 #include "PMI.h"
 
 class GSS_Si_Mob_Philips : public PMIS_Mobility
@@ -202,12 +204,17 @@ private:
   //---------------------------------------------------------------------------
   // Electron low field mobility
   PetscScalar ElecMobPhilips(const PetscScalar &p,const PetscScalar &n,const PetscScalar &Tl) const
+  {
+    PetscScalar Na  = ReadDopingNa()+1e0*std::pow(cm,-3);
+    PetscScalar Nd  = ReadDopingNd()+1e0*std::pow(cm,-3);
+    return ElecMobPhilips(p, n, Tl, Na, Nd);
+  }
+  PetscScalar ElecMobPhilips(const PetscScalar &p,const PetscScalar &n,const PetscScalar &Tl,
+                           const PetscScalar &Na, const PetscScalar &Nd) const
   {
     PetscScalar mu_lattice = MMXN_UM*std::pow(Tl/T300,-TETN_UM);
     PetscScalar mu1 = MMXN_UM*MMXN_UM/(MMXN_UM-MMNN_UM)*std::pow(Tl/T300,3*ALPN_UM-1.5);
     PetscScalar mu2 = MMXN_UM*MMNN_UM/(MMXN_UM-MMNN_UM)*sqrt(T300/Tl);
-    PetscScalar Na  = ReadDopingNa()+1e0*std::pow(cm,-3);
-    PetscScalar Nd  = ReadDopingNd()+1e0*std::pow(cm,-3);
     PetscScalar Nds = Nd*(1.0+1.0/(CRFD_UM+(NRFD_UM/Nd)*(NRFD_UM/Nd)));
     PetscScalar Nas = Na*(1.0+1.0/(CRFA_UM+(NRFA_UM/Na)*(NRFA_UM/Na)));
     PetscScalar Nsc = Nds+Nas+fabs(p);
@@ -249,12 +256,17 @@ private:
   //---------------------------------------------------------------------------
   // Hole low field mobility
   PetscScalar HoleMobPhilips(const PetscScalar &p,const PetscScalar &n,const PetscScalar &Tl) const
+  {
+    PetscScalar Na  = ReadDopingNa()+1e0*std::pow(cm,-3);
+    PetscScalar Nd  = ReadDopingNd()+1e0*std::pow(cm,-3);
+    return HoleMobPhilips(p, n, Tl, Na, Nd);
+  }
+  PetscScalar HoleMobPhilips(const PetscScalar &p,const PetscScalar &n,const PetscScalar &Tl,
+                           const PetscScalar &Na, const PetscScalar &Nd) const
   {
     PetscScalar mu_lattice = MMXP_UM*std::pow(Tl/T300,-TETP_UM);
     PetscScalar mu1 = MMXP_UM*MMXP_UM/(MMXP_UM-MMNP_UM)*std::pow(Tl/T300,3*ALPP_UM-1.5);
     PetscScalar mu2 = MMXP_UM*MMNP_UM/(MMXP_UM-MMNP_UM)*sqrt(T300/Tl);
-    PetscScalar Na  = ReadDopingNa()+1e0*std::pow(cm,-3);
-    PetscScalar Nd  = ReadDopingNd()+1e0*std::pow(cm,-3);
     PetscScalar Nds = Nd*(1.0+1.0/(CRFD_UM+(NRFD_UM/Nd)*(NRFD_UM/Nd)));
     PetscScalar Nas = Na*(1.0+1.0/(CRFA_UM+(NRFA_UM/Na)*(NRFA_UM/Na)));
     PetscScalar Nsc = Nds+Nas+fabs(n);
@@ -335,6 +347,61 @@ public:
     return mu0/adtl::pow(1+adtl::pow(mu0*fabs(Ep)/vsat,BETAP),1.0/BETAP);
   }
 
+  //---------------------------------------------------------------------------
+  // batched electron mobility, doping of all the nodes is gathered chunk by chunk
+  // so that the arithmetic loop has no virtual call
+  void ElecMob(const unsigned int size, const PMI_NodeContext *context,
+               const PetscScalar *p,  const PetscScalar *n,  const PetscScalar *Tl,
+               const PetscScalar *Ep, const PetscScalar *Et, const PetscScalar *Tn,
+               PetscScalar *result) const
+  {
+    const unsigned int chunk = 64;
+    PetscScalar Na[chunk], Nd[chunk];
+    for(unsigned int b=0; b<size; b+=chunk)
+    {
+      const unsigned int m = std::min(chunk, size-b);
+      for(unsigned int i=0; i<m; ++i)
+      {
+        Na[i] = ReadDopingNa(context[b+i])+1e0*std::pow(cm,-3);
+        Nd[i] = ReadDopingNd(context[b+i])+1e0*std::pow(cm,-3);
+      }
+      for(unsigned int i=0; i<m; ++i)
+      {
+        const unsigned int k = b+i;
+        PetscScalar vsat = VSATN0/(1+VSATN_A*exp(Tl[k]/(2*T300)));
+        PetscScalar mu0  = ElecMobPhilips(p[k], n[k], Tl[k], Na[i], Nd[i]);
+        result[k] = mu0/std::pow(1+std::pow(mu0*fabs(Ep[k])/vsat,BETAN),1.0/BETAN);
+      }
+    }
+  }
+
+  //---------------------------------------------------------------------------
+  // batched hole mobility
+  void HoleMob(const unsigned int size, const PMI_NodeContext *context,
+               const PetscScalar *p,  const PetscScalar *n,  const PetscScalar *Tl,
+               const PetscScalar *Ep, const PetscScalar *Et, const PetscScalar *Tp,
+               PetscScalar *result) const
+  {
+    const unsigned int chunk = 64;
+    PetscScalar Na[chunk], Nd[chunk];
+    for(unsigned int b=0; b<size; b+=chunk)
+    {
+      const unsigned int m = std::min(chunk, size-b);
+      for(unsigned int i=0; i<m; ++i)
+      {
+        Na[i] = ReadDopingNa(context[b+i])+1e0*std::pow(cm,-3);
+        Nd[i] = ReadDopingNd(context[b+i])+1e0*std::pow(cm,-3);
+      }
+      for(unsigned int i=0; i<m; ++i)
+      {
+        const unsigned int k = b+i;
+        PetscScalar vsat = VSATP0/(1+VSATP_A*exp(Tl[k]/(2*T300)));
+        PetscScalar mu0  = HoleMobPhilips(p[k], n[k], Tl[k], Na[i], Nd[i]);
+        result[k] = mu0/std::pow(1+std::pow(mu0*fabs(Ep[k])/vsat,BETAP),1.0/BETAP);
+      }
+    }
+  }
+
 // constructor
 public:
   GSS_Si_Mob_Philips(const PMIS_Environment &env):PMIS_Mobility(env)
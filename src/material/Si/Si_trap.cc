@@ -33,6 +33,13 @@
 class GSS_Si_Trap_Default : public PMIS_Trap
 {
 private:
+  /**
+   * energy distribution of a trap spec. A Level spec is a single discrete level,
+   * Uniform and Gaussian specs spread the density over an energy band which is
+   * integrated with Gauss-Legendre quadrature.
+   */
+  enum TrapDistribution {Level, Uniform, Gaussian};
+
   // {{{ class TrapSpec
   class TrapSpec
   {
@@ -60,6 +67,17 @@ private:
       PetscScalar g_n;      // degeneracy factor with conduction band
       PetscScalar g_p;      // degeneracy factor with valance band
 
+
+      /******** for energy distributed traps *********************************/
+      TrapDistribution distribution;
+      // full width of uniform band, or standard deviation of gaussian band
+      PetscScalar width;
+      // number of quadrature levels
+      unsigned int n_level;
+
+      // range of this spec in TrapLevels
+      unsigned int level_begin, level_end;
+
     public:
       TrapSpec()
       {
@@ -74,8 +92,13 @@ private:
         sigma_p = 0;
         g_n = 1.0;
         g_p = 1.0;
+        distribution = Level;
+        width = 0;
+        n_level = 1;
+        level_begin = level_end = 0;
       }
-      TrapSpec(const std::string &name, const PetscScalar &pf, const PetscScalar &dit, const TrapChargeType ct, const TrapType t, const PetscScalar &Et, const PetscScalar &sn, const PetscScalar &sp, const PetscScalar &gn, const PetscScalar &gp)
+      TrapSpec(const std::string &name, const PetscScalar &pf, const PetscScalar &dit, const TrapChargeType ct, const TrapType t, const PetscScalar &Et, const PetscScalar &sn, const PetscScalar &sp, const PetscScalar &gn, const PetscScalar &gp,
+               const TrapDistribution dist, const PetscScalar &w, const unsigned int nl)
       {
         if (t==Bulk)
         {
@@ -98,63 +121,133 @@ private:
         sigma_p = sp;
         g_n     = gn;
         g_p     = gp;
+        distribution = dist;
+        width   = w;
+        n_level = nl;
+        level_begin = level_end = 0;
       }
   };
   // }}}
 
   std::vector<TrapSpec> TrapSpecs;
 
-  // {{{ class Trap
-  class Trap
+  // {{{ class TrapLevel
+  /**
+   * a discrete energy level of a trap spec. The weights of all the levels
+   * of one spec sum to one.
+   */
+  class TrapLevel
   {
     public:
-      int spec;
-      PetscScalar N_tt;     // total trap density
+      unsigned int spec;
+      PetscScalar E_t;
+      PetscScalar weight;
+
+      TrapLevel(const unsigned int spc, const PetscScalar &Et, const PetscScalar &w)
+      : spec(spc), E_t(Et), weight(w)
+      {}
+  };
+  // }}}
+
+  std::vector<TrapLevel> TrapLevels;
+
+  // {{{ class TrapGroup
+  /**
+   * all the trap levels at one location. Level data is kept as contiguous arrays
+   * so that occupancy, charge and rates of every level are evaluated in one
+   * flat loop without per-level lookup or branches.
+   */
+  class TrapGroup
+  {
+    public:
+      std::vector<PetscScalar> N_tt;     // total trap density
+      std::vector<PetscScalar> E_t;
+      std::vector<PetscScalar> sigma_n;
+      std::vector<PetscScalar> sigma_p;
+      std::vector<PetscScalar> inv_g_n;  // 1/g_n
+      std::vector<PetscScalar> inv_g_p;  // 1/g_p
+
+      // charge per trapped electron / per empty trap, in unit of e
+      // acceptor: (-1, 0), donor: (0, +1), neutral: (0, 0)
+      std::vector<PetscScalar> q_a;
+      std::vector<PetscScalar> q_d;
 
       // density of trapped electron in the current iteration
-      PetscScalar n_t;
-      AutoDScalar n_t_AD;
+      std::vector<PetscScalar> n_t;
+      std::vector<AutoDScalar> n_t_AD;
 
       // density of trapped electron (convergenced value) at the last time step
       // We use BDF2 discretization here, two previous values is needed.
-      PetscScalar n_t_last;
-      PetscScalar n_t_last_last;
+      std::vector<PetscScalar> n_t_last;
+      std::vector<PetscScalar> n_t_last_last;
 
-      // timestamp of the last two steps
+      // all the traps at one location share the timestamp of the last two steps
       PetscScalar clock_last;
       PetscScalar clock_last_last;
 
+      // exp(E_t/kT)/g_n and exp(-E_t/kT)/g_p, evaluated at temperature T_exp
+      std::vector<PetscScalar> exp_n;
+      std::vector<PetscScalar> exp_p;
+      PetscScalar T_exp;
+
     public:
-      Trap() : n_t_AD(0)
+      TrapGroup() : clock_last(0), clock_last_last(0), T_exp(-1)
+      {}
+
+      unsigned int size() const
+      { return N_tt.size(); }
+
+      void push_back(const TrapSpec &spec, const PetscScalar &Et, const PetscScalar &Ntt, const PetscScalar &nt)
       {
-        spec = 0;
-        N_tt = 0;
-        n_t  = 0;
-        n_t_last = 0;
-        n_t_last_last = 0;
-        clock_last = 0;
-        clock_last_last = 0;
+        N_tt.push_back(Ntt);
+        E_t.push_back(Et);
+        sigma_n.push_back(spec.sigma_n);
+        sigma_p.push_back(spec.sigma_p);
+        inv_g_n.push_back(1.0/spec.g_n);
+        inv_g_p.push_back(1.0/spec.g_p);
+        q_a.push_back(spec.charge_type == Acceptor ? -1.0 : 0.0);
+        q_d.push_back(spec.charge_type == Donor    ?  1.0 : 0.0);
+        n_t.push_back(nt);
+        n_t_AD.push_back(AutoDScalar(nt));
+        n_t_last.push_back(nt);
+        n_t_last_last.push_back(nt);
+        exp_n.push_back(0);
+        exp_p.push_back(0);
+        T_exp = -1;
       }
-      Trap(const unsigned int spc, const PetscScalar &Ntt, const PetscScalar &nt) : n_t_AD(nt)
+
+      /**
+       * refresh the cached emission exponentials when lattice temperature changes
+       */
+      void update_exp(const PetscScalar &Tl, const PetscScalar &kb)
       {
-        spec = spc;
-        N_tt = Ntt;
-        n_t  = nt;
-        n_t_last = nt;
-        n_t_last_last = nt;
-        clock_last = 0;
-        clock_last_last = 0;
+        if (Tl == T_exp) return;
+        const PetscScalar beta = 1.0/(kb*Tl);
+        const unsigned int n = size();
+        for (unsigned int i=0; i<n; ++i)
+        {
+          exp_n[i] = inv_g_n[i]*exp( E_t[i]*beta);
+          exp_p[i] = inv_g_p[i]*exp(-E_t[i]*beta);
+        }
+        T_exp = Tl;
       }
   };
   // }}}
 
-  typedef std::map<TrapLocation, std::vector<Trap>, TrapLocationComp> TrapStore_t;
+  typedef std::map<TrapLocation, TrapGroup, TrapLocationComp> TrapStore_t;
 
   TrapStore_t TrapStore;
-  Trap dummy_trap;
+
+  // the residual and jacobian routines call several member functions for the same
+  // node in a row, cache the last lookup
+  TrapLocation _last_location;
+  TrapGroup *  _last_group;
+  bool         _last_valid;
 
   void 	Trap_Init()
   {
+    _last_group = 0;
+    _last_valid = false;
   }
 
   struct ToLower
@@ -162,87 +255,219 @@ private:
     char operator() (char c) const  { return tolower(c); }
   };
 
+  // {{{ TrapGroup * find_group(const bool flag_bulk)
+  /**
+   * @return the traps at current point, NULL if there are none
+   */
+  TrapGroup * find_group(const bool flag_bulk)
+  {
+    TrapLocation tloc = TrapLocation(current_point()->x(), current_point()->y(), current_point()->z(), flag_bulk?Bulk:Interface);
+
+    TrapLocationComp comp;
+    if (_last_valid && !comp(tloc, _last_location) && !comp(_last_location, tloc))
+      return _last_group;
+
+    TrapStore_t::iterator it = TrapStore.find(tloc);
+    _last_location = tloc;
+    _last_group = (it != TrapStore.end()) ? &(it->second) : 0;
+    _last_valid = true;
+    return _last_group;
+  }
+  // }}}
+
+  // {{{ void time_coefficients(const TrapGroup &g, PetscScalar &a0, PetscScalar &a1, PetscScalar &a2)
+  /**
+   * coefficients of the discretized time derivative of trap occupancy,
+   * dn_t/dt ~ a0*n_t - a1*n_t_last - a2*n_t_last_last
+   */
+  void time_coefficients(const TrapGroup &g, PetscScalar &a0, PetscScalar &a1, PetscScalar &a2) const
+  {
+    a0 = a1 = a2 = 0;
+    if (ReadTime() > g.clock_last)
+    {
+      // we should consider the time derivative of trap occupancy
+      if (g.clock_last > g.clock_last_last)
+      {
+        // We have two previous time step available, use BDF2 discretization
+        PetscScalar d =  1.0 / (ReadTime() - g.clock_last_last);
+        PetscScalar r = (g.clock_last - g.clock_last_last) * d;
+        a0 = d * (2-r)/(1-r);
+        a1 = d / r/(1-r);
+        a2 = -d * (1-r)/r;
+      }
+      else
+      {
+        // only one previous time step available, use BDF1 discretization
+        PetscScalar d =  1.0 / (ReadTime() - g.clock_last);
+        a0 = d;
+        a1 = d;
+      }
+    }
+  }
+  // }}}
+
+  // {{{ AutoDScalar dbeta(const AutoDScalar &Tl)
+  /**
+   * the derivative part of 1/kT. With the cached exponentials, exp(E_t/kT) is
+   * linearized as exp_n*(1 + E_t*dbeta), which carries the exact first derivative.
+   */
+  AutoDScalar dbeta(const AutoDScalar &Tl) const
+  {
+    AutoDScalar beta = 1.0/(kb*Tl);
+    return beta - beta.getValue();
+  }
+  // }}}
+
+  // {{{ static void gauss_legendre(const unsigned int n, std::vector<PetscScalar> &x, std::vector<PetscScalar> &w)
+  /**
+   * nodes and weights of n-point Gauss-Legendre quadrature on [-1, 1]
+   */
+  static void gauss_legendre(const unsigned int n, std::vector<PetscScalar> &x, std::vector<PetscScalar> &w)
+  {
+    x.resize(n);
+    w.resize(n);
+    for (unsigned int i=0; i<n; ++i)
+    {
+      PetscScalar z = cos(3.14159265358979323846*(i+0.75)/(n+0.5));
+      PetscScalar dp = 1.0;
+      for (int iter=0; iter<100; ++iter)
+      {
+        PetscScalar p0 = 1.0, p1 = z;
+        for (unsigned int j=2; j<=n; ++j)
+        {
+          PetscScalar p2 = ((2.0*j-1.0)*z*p1 - (j-1.0)*p0)/j;
+          p0 = p1;
+          p1 = p2;
+        }
+        dp = n*(z*p1 - p0)/(z*z - 1.0);
+        PetscScalar dz = p1/dp;
+        z -= dz;
+        if (fabs(dz) < 1e-15) break;
+      }
+      x[i] = z;
+      w[i] = 2.0/((1.0 - z*z)*dp*dp);
+    }
+  }
+  // }}}
+
+  // {{{ void add_levels(const unsigned int spec)
+  /**
+   * expand a trap spec into discrete levels.
+   * uniform band covers [E_t-width/2, E_t+width/2], gaussian band is truncated at 3 sigma
+   */
+  void add_levels(const unsigned int spec)
+  {
+    TrapSpec & s = TrapSpecs[spec];
+    s.level_begin = TrapLevels.size();
+
+    if (s.distribution == Level || s.n_level < 2 || s.width <= 0)
+    {
+      TrapLevels.push_back(TrapLevel(spec, s.E_t, 1.0));
+      s.level_end = TrapLevels.size();
+      return;
+    }
+
+    std::vector<PetscScalar> x, w;
+    gauss_legendre(s.n_level, x, w);
+
+    PetscScalar sum = 0;
+    for (unsigned int k=0; k<s.n_level; ++k)
+    {
+      PetscScalar Et, wt;
+      if (s.distribution == Uniform)
+      {
+        Et = s.E_t + 0.5*s.width*x[k];
+        wt = 0.5*w[k];
+      }
+      else
+      {
+        Et = s.E_t + 3.0*s.width*x[k];
+        wt = w[k]*exp(-4.5*x[k]*x[k]);
+      }
+      TrapLevels.push_back(TrapLevel(spec, Et, wt));
+      sum += wt;
+    }
+
+    // normalize so that the total trap density is preserved
+    for (unsigned int l=s.level_begin; l<TrapLevels.size(); ++l)
+      TrapLevels[l].weight /= sum;
+    s.level_end = TrapLevels.size();
+  }
+  // }}}
+
 public:
 
 //----------------------------------------------------------------
 // constructor and destructor
 public:
 
-  GSS_Si_Trap_Default(const PMIS_Environment &env):PMIS_Trap(env)
+  GSS_Si_Trap_Default(const PMIS_Environment &env):PMIS_Trap(env), _last_location(0, 0, 0, Bulk)
   {
     PMI_Info = "This is the Default carrier trapping model of Silicon";
     Trap_Init();
   }
 
-  // {{{ int AddBulkTrapSpec(const std::string &profile_name, const PetscScalar &prefactor, const TrapChargeType ct, const PetscScalar &Et, const PetscScalar &sn, const PetscScalar &sp, const PetscScalar &gn, const PetscScalar &gp)
+  // {{{ int AddBulkTrapSpec(const std::string &profile_name, const PetscScalar &prefactor, const TrapChargeType ct, const PetscScalar &Et, const PetscScalar &sn, const PetscScalar &sp, const PetscScalar &gn, const PetscScalar &gp, ...)
   /**
    * declare a class of bulk traps as specified in the PMI command
    * But the traps are not actually created until the PMIs are initilized with init_node().
    */
-  int AddBulkTrapSpec(const std::string &profile_name, const PetscScalar &prefactor, const TrapChargeType ct, const PetscScalar &Et, const PetscScalar &sn, const PetscScalar &sp, const PetscScalar &gn, const PetscScalar &gp)
+  int AddBulkTrapSpec(const std::string &profile_name, const PetscScalar &prefactor, const TrapChargeType ct, const PetscScalar &Et, const PetscScalar &sn, const PetscScalar &sp, const PetscScalar &gn, const PetscScalar &gp,
+                      const TrapDistribution dist=Level, const PetscScalar &width=0, const unsigned int n_level=1)
   {
-    TrapSpec s(profile_name, prefactor, 0, ct, Bulk, Et,sn,sp,gn,gp);
+    TrapSpec s(profile_name, prefactor, 0, ct, Bulk, Et,sn,sp,gn,gp, dist,width,n_level);
     TrapSpecs.push_back(s);
+    add_levels(TrapSpecs.size()-1);
     return (TrapSpecs.size()-1);
   }
   // }}}
 
-  // {{{ int AddInterfaceTrapSpec(const std::string &if_name, const PetscScalar &interface_density, const TrapChargeType ct, const PetscScalar &Et, const PetscScalar &sn, const PetscScalar &sp, const PetscScalar &gn, const PetscScalar &gp)
+  // {{{ int AddInterfaceTrapSpec(const std::string &if_name, const PetscScalar &interface_density, const TrapChargeType ct, const PetscScalar &Et, const PetscScalar &sn, const PetscScalar &sp, const PetscScalar &gn, const PetscScalar &gp, ...)
   /**
    * declare a class of interface traps as specified in the PMI command
    * But the traps are not actually created until the PMIs are initilized with init_bc_node().
    */
-  int AddInterfaceTrapSpec(const std::string &if_name, const PetscScalar &interface_density, const TrapChargeType ct, const PetscScalar &Et, const PetscScalar &sn, const PetscScalar &sp, const PetscScalar &gn, const PetscScalar &gp)
+  int AddInterfaceTrapSpec(const std::string &if_name, const PetscScalar &interface_density, const TrapChargeType ct, const PetscScalar &Et, const PetscScalar &sn, const PetscScalar &sp, const PetscScalar &gn, const PetscScalar &gp,
+                           const TrapDistribution dist=Level, const PetscScalar &width=0, const unsigned int n_level=1)
   {
-    TrapSpec s(if_name, 0, interface_density, ct, Interface, Et,sn,sp,gn,gp);
+    TrapSpec s(if_name, 0, interface_density, ct, Interface, Et,sn,sp,gn,gp, dist,width,n_level);
     TrapSpecs.push_back(s);
+    add_levels(TrapSpecs.size()-1);
     return (TrapSpecs.size()-1);
   }
   // }}}
 
-  // {{{ void AddTrap (const Point &point, int &spec, const PetscScalar &Ntt)
+  // {{{ void AddTrap (const Point &point, const unsigned int &level, const PetscScalar &Ntt)
   /**
-   * Append a trap to TrapStore
+   * Append a trap level to TrapStore
    *
    * @Point  the coordinate of the node, which is used as the identifier of the trap
-   * @spec   the spec index of the trap
+   * @level  the index of the trap level in TrapLevels
    * @Ntt    the concentration of the trap
    */
-  void AddTrap (const Point &point, const unsigned int &spec, const PetscScalar &Ntt)
+  void AddTrap (const Point &point, const unsigned int &level, const PetscScalar &Ntt)
   {
-    genius_assert(spec<TrapSpecs.size());
+    genius_assert(level<TrapLevels.size());
+    const TrapSpec & spec = TrapSpecs[TrapLevels[level].spec];
 
     // trap location is used as the key in TrapStore
-    TrapLocation tloc = TrapLocation(point.x(), point.y(), point.z(), TrapSpecs[spec].type);
+    TrapLocation tloc = TrapLocation(point.x(), point.y(), point.z(), spec.type);
 
     PetscScalar n_t;
-    if (TrapSpecs[spec].charge_type == Acceptor)
+    if (spec.charge_type == Acceptor)
       n_t = 0;        // Acceptors are assumed to be initially empty
-    else if (TrapSpecs[spec].charge_type == Donor)
+    else if (spec.charge_type == Donor)
       n_t = Ntt;      // Donors are assumed to be initially occupied
     else
       n_t = 0.5*Ntt;
 
-    Trap trap=Trap(spec, Ntt, n_t);   // create the trap
+    // create an entry in the map for the first trap at the location
+    TrapStore_t::iterator it = TrapStore.find(tloc);
+    if (it == TrapStore.end())
+      it = TrapStore.insert(std::pair<TrapLocation, TrapGroup>(tloc, TrapGroup())).first;
+    it->second.push_back(spec, TrapLevels[level].E_t, Ntt, n_t);
 
-    TrapStore_t::iterator it;
-    it = TrapStore.find(tloc);
-    if (it != TrapStore.end())
-    {
-      // we already have some traps defined at this location, append the new trap
-      it->second.push_back(trap);
-    }
-    else
-    {
-      std::pair<TrapStore_t::iterator, bool> ret;
-      std::vector<Trap> vec_trap;
-
-      // this is the first trap at the location.
-      // Create an entry in the map first, which is itself a vector
-      // then insert an trap to the vector
-      ret = TrapStore.insert(std::pair< TrapLocation,std::vector<Trap> >(tloc,vec_trap));
-      ret.first->second.push_back(trap);
-    }
+    _last_valid = false;
   }
   // }}}
 
@@ -253,28 +478,16 @@ public:
    */
   PetscScalar Charge(const bool flag_bulk)
   {
-    TrapLocation tloc = TrapLocation((*pp_point)->x(), (*pp_point)->y(), (*pp_point)->z(), flag_bulk?Bulk:Interface);
-
-    TrapStore_t::iterator it = TrapStore.find(tloc);
-
-    if (it != TrapStore.end())
-    {
-      // yes there are some traps at this node
-      PetscScalar Q=0;
-      std::vector<Trap> & traps = it->second;
-
-      // loop over all traps at this location
-      for (std::vector<Trap>::iterator ptrap=traps.begin(); ptrap!=traps.end(); ptrap++)
-      {
-        if (TrapSpecs[ptrap->spec].charge_type == Acceptor)
-          Q = Q - ptrap->n_t;                   // Acceptor: neutral when empty, negatively charged when occupied
-        else if (TrapSpecs[ptrap->spec].charge_type == Donor)
-          Q = Q + (ptrap->N_tt - ptrap->n_t);   // Donor: positively charged when empty, neutral when occupied
-      }
-      return Q*e;
-    }
-    else
-      return 0;
+    const TrapGroup * g = find_group(flag_bulk);
+    if (!g) return 0;
+
+    // Acceptor: neutral when empty, negatively charged when occupied
+    // Donor: positively charged when empty, neutral when occupied
+    PetscScalar Q=0;
+    const unsigned int N = g->size();
+    for (unsigned int i=0; i<N; ++i)
+      Q += g->q_a[i]*g->n_t[i] + g->q_d[i]*(g->N_tt[i] - g->n_t[i]);
+    return Q*e;
   }
   // }}}
 
@@ -286,25 +499,14 @@ public:
    */
   AutoDScalar ChargeAD(const bool flag_bulk)
   {
-    TrapLocation tloc = TrapLocation((*pp_point)->x(), (*pp_point)->y(), (*pp_point)->z(), flag_bulk?Bulk:Interface);
-
-    TrapStore_t::iterator it = TrapStore.find(tloc);
-
-    if (it != TrapStore.end())
-    {
-      AutoDScalar Q=0;
-      std::vector<Trap> & traps = it->second;
-      for (std::vector<Trap>::iterator ptrap=traps.begin(); ptrap!=traps.end(); ptrap++)
-      {
-        if (TrapSpecs[ptrap->spec].charge_type == Acceptor)
-          Q = Q - ptrap->n_t_AD;
-        else if (TrapSpecs[ptrap->spec].charge_type == Donor)
-          Q = Q + (ptrap->N_tt - ptrap->n_t_AD);
-      }
-      return Q*e;
-    }
-    else
-      return 0;
+    const TrapGroup * g = find_group(flag_bulk);
+    if (!g) return 0;
+
+    AutoDScalar Q=0;
+    const unsigned int N = g->size();
+    for (unsigned int i=0; i<N; ++i)
+      Q += (g->q_a[i] - g->q_d[i])*g->n_t_AD[i] + g->q_d[i]*g->N_tt[i];
+    return Q*e;
   }
   // }}}
 
@@ -315,35 +517,18 @@ public:
    */
   PetscScalar ElectronTrapRate(const bool flag_bulk, const PetscScalar &n, const PetscScalar &ni, const PetscScalar &Tl)
   {
-    PetscScalar theta_n = 1.0e7*cm/s * sqrt(Tl/300/K);     // electron thermal velocity
-
-    TrapLocation tloc = TrapLocation((*pp_point)->x(), (*pp_point)->y(), (*pp_point)->z(), flag_bulk?Bulk:Interface);
-
-    TrapStore_t::iterator it = TrapStore.find(tloc);
-
-    if (it != TrapStore.end())
-    {
-      // yes we have some traps at this location
-      PetscScalar Cn=0, En=0;
-      std::vector<Trap> & traps = it->second;
+    TrapGroup * g = find_group(flag_bulk);
+    if (!g) return 0.;
 
-      // loop over all traps at this location
-      for (std::vector<Trap>::iterator ptrap=traps.begin(); ptrap!=traps.end(); ptrap++)
-      {
-        PetscScalar sigma_n,g_n,E_t;
-        sigma_n = TrapSpecs[ptrap->spec].sigma_n;
-        g_n     = TrapSpecs[ptrap->spec].g_n;
-        E_t     = TrapSpecs[ptrap->spec].E_t;
-
-        Cn += sigma_n * theta_n * n * (ptrap->N_tt - ptrap->n_t);   // capture rate
-        En += sigma_n * theta_n / g_n * ni * ptrap->n_t * exp(E_t/kb/Tl);  // emission rate
-      }
-      return Cn-En;
-    }
-    else
-    {
-      return 0.;
-    }
+    PetscScalar theta_n = 1.0e7*cm/s * sqrt(Tl/300/K);     // electron thermal velocity
+    g->update_exp(Tl, kb);
+
+    // capture rate - emission rate
+    PetscScalar R=0;
+    const unsigned int N = g->size();
+    for (unsigned int i=0; i<N; ++i)
+      R += g->sigma_n[i] * (n * (g->N_tt[i] - g->n_t[i]) - ni * g->n_t[i] * g->exp_n[i]);
+    return R*theta_n;
   }
   // }}}
 
@@ -354,33 +539,21 @@ public:
    */
   AutoDScalar ElectronTrapRate(const bool flag_bulk, const AutoDScalar &n, const AutoDScalar &ni, const AutoDScalar &Tl)
   {
-    AutoDScalar theta_n = 1.0e7*cm/s * sqrt(Tl/300/K);
-
-    TrapLocation tloc = TrapLocation((*pp_point)->x(), (*pp_point)->y(), (*pp_point)->z(), flag_bulk?Bulk:Interface);
-
-    TrapStore_t::iterator it = TrapStore.find(tloc);
+    TrapGroup * g = find_group(flag_bulk);
+    if (!g) return 0.;
 
-    if (it != TrapStore.end())
-    {
-      AutoDScalar Cn,En;
-      Cn=0; En=0;
-      std::vector<Trap> & traps = it->second;
-      for (std::vector<Trap>::iterator ptrap=traps.begin(); ptrap!=traps.end(); ptrap++)
-      {
-        PetscScalar sigma_n,g_n,E_t;
-        sigma_n = TrapSpecs[ptrap->spec].sigma_n;
-        g_n     = TrapSpecs[ptrap->spec].g_n;
-        E_t     = TrapSpecs[ptrap->spec].E_t;
+    AutoDScalar theta_n = 1.0e7*cm/s * sqrt(Tl/300/K);
+    g->update_exp(Tl.getValue(), kb);
+    AutoDScalar ni_db = ni*dbeta(Tl);
 
-        Cn += sigma_n * theta_n * n * (ptrap->N_tt - ptrap->n_t_AD);
-        En += sigma_n * theta_n / g_n * ni * ptrap->n_t_AD * exp(E_t/kb/Tl);
-      }
-      return Cn-En;
-    }
-    else
+    AutoDScalar R=0;
+    const unsigned int N = g->size();
+    for (unsigned int i=0; i<N; ++i)
     {
-      return 0.;
+      AutoDScalar en = g->exp_n[i]*(ni + g->E_t[i]*ni_db);   // ni/g_n*exp(E_t/kT)
+      R += g->sigma_n[i] * (n * (g->N_tt[i] - g->n_t_AD[i]) - g->n_t_AD[i] * en);
     }
+    return R*theta_n;
   }
   // }}}
 
@@ -391,35 +564,18 @@ public:
    */
   PetscScalar HoleTrapRate(const bool flag_bulk, const PetscScalar &p, const PetscScalar &ni, const PetscScalar &Tl)
   {
-    PetscScalar theta_p = 1.0e7*cm/s * sqrt(Tl/300/K);     // hole thermal velocity
+    TrapGroup * g = find_group(flag_bulk);
+    if (!g) return 0.;
 
-    TrapLocation tloc = TrapLocation((*pp_point)->x(), (*pp_point)->y(), (*pp_point)->z(), flag_bulk?Bulk:Interface);
-
-    TrapStore_t::iterator it = TrapStore.find(tloc);
-
-    if (it != TrapStore.end())
-    {
-      // yes we have some traps at this location
-      PetscScalar Cp=0, Ep=0;
-      std::vector<Trap> & traps = it->second;
-
-      // loop over all traps at this location
-      for (std::vector<Trap>::iterator ptrap=traps.begin(); ptrap!=traps.end(); ptrap++)
-      {
-        PetscScalar sigma_p,g_p,E_t;
-        sigma_p = TrapSpecs[ptrap->spec].sigma_p;
-        g_p     = TrapSpecs[ptrap->spec].g_p;
-        E_t     = TrapSpecs[ptrap->spec].E_t;
-
-        Cp += sigma_p * theta_p * p * ptrap->n_t;                                     // capture rate
-        Ep += sigma_p * theta_p / g_p * ni * (ptrap->N_tt - ptrap->n_t) * exp(-E_t/kb/Tl);   // emission rate
-      }
-      return Cp-Ep;
-    }
-    else
-    {
-      return 0.;
-    }
+    PetscScalar theta_p = 1.0e7*cm/s * sqrt(Tl/300/K);     // hole thermal velocity
+    g->update_exp(Tl, kb);
+
+    // capture rate - emission rate
+    PetscScalar R=0;
+    const unsigned int N = g->size();
+    for (unsigned int i=0; i<N; ++i)
+      R += g->sigma_p[i] * (p * g->n_t[i] - ni * (g->N_tt[i] - g->n_t[i]) * g->exp_p[i]);
+    return R*theta_p;
   }
   // }}}
 
@@ -430,157 +586,88 @@ public:
    */
   AutoDScalar HoleTrapRate(const bool flag_bulk, const AutoDScalar &p, const AutoDScalar &ni, const AutoDScalar &Tl)
   {
-    AutoDScalar theta_p = 1.0e7*cm/s * sqrt(Tl/300/K);
+    TrapGroup * g = find_group(flag_bulk);
+    if (!g) return 0.;
 
-    TrapLocation tloc = TrapLocation((*pp_point)->x(), (*pp_point)->y(), (*pp_point)->z(), flag_bulk?Bulk:Interface);
-
-    TrapStore_t::iterator it = TrapStore.find(tloc);
+    AutoDScalar theta_p = 1.0e7*cm/s * sqrt(Tl/300/K);
+    g->update_exp(Tl.getValue(), kb);
+    AutoDScalar ni_db = ni*dbeta(Tl);
 
-    if (it != TrapStore.end())
+    AutoDScalar R=0;
+    const unsigned int N = g->size();
+    for (unsigned int i=0; i<N; ++i)
     {
-      AutoDScalar Cp=0, Ep=0;
-      std::vector<Trap> & traps = it->second;
-      for (std::vector<Trap>::iterator ptrap=traps.begin(); ptrap!=traps.end(); ptrap++)
-      {
-        PetscScalar sigma_p,g_p,E_t;
-        sigma_p = TrapSpecs[ptrap->spec].sigma_p;
-        g_p     = TrapSpecs[ptrap->spec].g_p;
-        E_t     = TrapSpecs[ptrap->spec].E_t;
-
-        Cp += sigma_p * theta_p * p * ptrap->n_t_AD;
-        Ep += sigma_p * theta_p / g_p * ni * (ptrap->N_tt - ptrap->n_t_AD) * exp(-E_t/kb/Tl);
-      }
-      return Cp-Ep;
-    }
-    else
-    {
-      return 0.;
+      AutoDScalar ep = g->exp_p[i]*(ni - g->E_t[i]*ni_db);   // ni/g_p*exp(-E_t/kT)
+      R += g->sigma_p[i] * (p * g->n_t_AD[i] - (g->N_tt[i] - g->n_t_AD[i]) * ep);
     }
+    return R*theta_p;
   }
   // }}}
 
   // {{{ PetscScalar TrapHeat(const bool flag_bulk, const PetscScalar &p, const PetscScalar &n, const PetscScalar &ni, const PetscScalar &Tp, const PetscScalar &Tn, const PetscScalar &Tl, const PetscScalar &EcEi, const PetscScalar &EiEv)
   PetscScalar TrapHeat(const bool flag_bulk, const PetscScalar &p, const PetscScalar &n, const PetscScalar &ni, const PetscScalar &Tp, const PetscScalar &Tn, const PetscScalar &Tl, const PetscScalar &EcEi, const PetscScalar &EiEv)
   {
+    TrapGroup * g = find_group(flag_bulk);
+    if (!g) return 0.;
+
     PetscScalar theta_n = 1.0e7*cm/s * sqrt(Tl/300/K);     // electron thermal velocity
     PetscScalar theta_p = 1.0e7*cm/s * sqrt(Tl/300/K);     // hole thermal velocity
+    g->update_exp(Tl, kb);
 
-    TrapLocation tloc = TrapLocation((*pp_point)->x(), (*pp_point)->y(), (*pp_point)->z(), flag_bulk?Bulk:Interface);
-
-    TrapStore_t::iterator it = TrapStore.find(tloc);
-
-    if (it != TrapStore.end())
+    // net electron and hole capture rates summed over all levels
+    PetscScalar Rn=0, Rp=0;
+    const unsigned int N = g->size();
+    for (unsigned int i=0; i<N; ++i)
     {
-      // yes we have some traps at this location
-      std::vector<Trap> & traps = it->second;
-
-      PetscScalar H=0;
-      // loop over all traps at this location
-      for (std::vector<Trap>::iterator ptrap=traps.begin(); ptrap!=traps.end(); ptrap++)
-      {
-        PetscScalar sigma_n,sigma_p,g_n,g_p,E_t;
-        sigma_n = TrapSpecs[ptrap->spec].sigma_n;
-        sigma_p = TrapSpecs[ptrap->spec].sigma_p;
-        g_n     = TrapSpecs[ptrap->spec].g_n;
-        g_p     = TrapSpecs[ptrap->spec].g_p;
-        E_t     = TrapSpecs[ptrap->spec].E_t;
-
-        PetscScalar Cn = sigma_n * theta_n * n * (ptrap->N_tt - ptrap->n_t);   // capture rate
-        PetscScalar En = sigma_n * theta_n / g_n * ni * ptrap->n_t * exp(E_t/kb/Tl);  // emission rate
-
-        PetscScalar Cp = sigma_p * theta_p * p * ptrap->n_t;                                     // capture rate
-        PetscScalar Ep = sigma_p * theta_p / g_p * ni * (ptrap->N_tt - ptrap->n_t) * exp(-E_t/kb/Tl);   // emission rate
-
-        H += (Cn-En) * (1.5*kb*Tn + EcEi);
-        H += (Cp-Ep) * (1.5*kb*Tp + EiEv);
-      }
-      return H;
-    }
-    else
-    {
-      return 0.;
+      Rn += g->sigma_n[i] * (n * (g->N_tt[i] - g->n_t[i]) - ni * g->n_t[i] * g->exp_n[i]);
+      Rp += g->sigma_p[i] * (p * g->n_t[i] - ni * (g->N_tt[i] - g->n_t[i]) * g->exp_p[i]);
     }
+    return Rn*theta_n*(1.5*kb*Tn + EcEi) + Rp*theta_p*(1.5*kb*Tp + EiEv);
   }
   // }}}
 
   // {{{ AutoDScalar TrapHeat(const bool flag_bulk, const AutoDScalar &p, const AutoDScalar &n, const AutoDScalar &ni, const AutoDScalar &Tp, const AutoDScalar &Tn, const AutoDScalar &Tl, const AutoDScalar &EcEi, const AutoDScalar &EiEv)
   AutoDScalar TrapHeat(const bool flag_bulk, const AutoDScalar &p, const AutoDScalar &n, const AutoDScalar &ni, const AutoDScalar &Tp, const AutoDScalar &Tn, const AutoDScalar &Tl, const AutoDScalar &EcEi, const AutoDScalar &EiEv)
   {
+    TrapGroup * g = find_group(flag_bulk);
+    if (!g) return 0.;
+
     AutoDScalar theta_n = 1.0e7*cm/s * sqrt(Tl/300/K);     // electron thermal velocity
     AutoDScalar theta_p = 1.0e7*cm/s * sqrt(Tl/300/K);     // hole thermal velocity
+    g->update_exp(Tl.getValue(), kb);
+    AutoDScalar ni_db = ni*dbeta(Tl);
 
-    TrapLocation tloc = TrapLocation((*pp_point)->x(), (*pp_point)->y(), (*pp_point)->z(), flag_bulk?Bulk:Interface);
-
-    TrapStore_t::iterator it = TrapStore.find(tloc);
-
-    if (it != TrapStore.end())
+    AutoDScalar Rn=0, Rp=0;
+    const unsigned int N = g->size();
+    for (unsigned int i=0; i<N; ++i)
     {
-      // yes we have some traps at this location
-      std::vector<Trap> & traps = it->second;
-
-      AutoDScalar H=0;
-      // loop over all traps at this location
-      for (std::vector<Trap>::iterator ptrap=traps.begin(); ptrap!=traps.end(); ptrap++)
-      {
-        PetscScalar sigma_n,sigma_p,g_n,g_p,E_t;
-        sigma_n = TrapSpecs[ptrap->spec].sigma_n;
-        sigma_p = TrapSpecs[ptrap->spec].sigma_p;
-        g_n     = TrapSpecs[ptrap->spec].g_n;
-        g_p     = TrapSpecs[ptrap->spec].g_p;
-        E_t     = TrapSpecs[ptrap->spec].E_t;
-
-        AutoDScalar Cn = sigma_n * theta_n * n * (ptrap->N_tt - ptrap->n_t);   // capture rate
-        AutoDScalar En = sigma_n * theta_n / g_n * ni * ptrap->n_t * exp(E_t/kb/Tl);  // emission rate
-
-        AutoDScalar Cp = sigma_p * theta_p * p * ptrap->n_t;                                     // capture rate
-        AutoDScalar Ep = sigma_p * theta_p / g_p * ni * (ptrap->N_tt - ptrap->n_t) * exp(-E_t/kb/Tl);   // emission rate
-
-        H += (Cn-En) * (1.5*kb*Tn + EcEi);
-        H += (Cp-Ep) * (1.5*kb*Tp + EiEv);
-      }
-      return H;
-    }
-    else
-    {
-      return 0.;
+      AutoDScalar en = g->exp_n[i]*(ni + g->E_t[i]*ni_db);
+      AutoDScalar ep = g->exp_p[i]*(ni - g->E_t[i]*ni_db);
+      Rn += g->sigma_n[i] * (n * (g->N_tt[i] - g->n_t[i]) - g->n_t[i] * en);
+      Rp += g->sigma_p[i] * (p * g->n_t[i] - (g->N_tt[i] - g->n_t[i]) * ep);
     }
+    return Rn*theta_n*(1.5*kb*Tn + EcEi) + Rp*theta_p*(1.5*kb*Tp + EiEv);
   }
   // }}}
 
   // {{{ AutoDScalar ElectronTrapHeat(const bool flag_bulk, const AutoDScalar &n, const AutoDScalar &ni, const AutoDScalar &Tn, const AutoDScalar &Tl, const AutoDScalar &EcEi)
   AutoDScalar ElectronTrapHeat(const bool flag_bulk, const AutoDScalar &n, const AutoDScalar &ni, const AutoDScalar &Tn, const AutoDScalar &Tl, const AutoDScalar &EcEi)
   {
-    AutoDScalar theta_n = 1.0e7*cm/s * sqrt(Tl/300/K);     // electron thermal velocity
-
-    TrapLocation tloc = TrapLocation((*pp_point)->x(), (*pp_point)->y(), (*pp_point)->z(), flag_bulk?Bulk:Interface);
+    TrapGroup * g = find_group(flag_bulk);
+    if (!g) return 0.;
 
-    TrapStore_t::iterator it = TrapStore.find(tloc);
+    AutoDScalar theta_n = 1.0e7*cm/s * sqrt(Tl/300/K);     // electron thermal velocity
+    g->update_exp(Tl.getValue(), kb);
+    AutoDScalar ni_db = ni*dbeta(Tl);
 
-    if (it != TrapStore.end())
+    AutoDScalar Rn=0;
+    const unsigned int N = g->size();
+    for (unsigned int i=0; i<N; ++i)
     {
-      // yes we have some traps at this location
-      std::vector<Trap> & traps = it->second;
-
-      AutoDScalar H=0;
-      // loop over all traps at this location
-      for (std::vector<Trap>::iterator ptrap=traps.begin(); ptrap!=traps.end(); ptrap++)
-      {
-        PetscScalar sigma_n,g_n,E_t;
-        sigma_n = TrapSpecs[ptrap->spec].sigma_n;
-        g_n     = TrapSpecs[ptrap->spec].g_n;
-        E_t     = TrapSpecs[ptrap->spec].E_t;
-
-        AutoDScalar Cn = sigma_n * theta_n * n * (ptrap->N_tt - ptrap->n_t);   // capture rate
-        AutoDScalar En = sigma_n * theta_n / g_n * ni * ptrap->n_t * exp(E_t/kb/Tl);  // emission rate
-
-        H += (Cn-En) * (1.5*kb*Tn + EcEi);
-      }
-      return H;
-    }
-    else
-    {
-      return 0.;
+      AutoDScalar en = g->exp_n[i]*(ni + g->E_t[i]*ni_db);
+      Rn += g->sigma_n[i] * (n * (g->N_tt[i] - g->n_t[i]) - g->n_t[i] * en);
     }
+    return Rn*theta_n*(1.5*kb*Tn + EcEi);
   }
   // }}}
 
@@ -597,7 +684,8 @@ public:
       PetscScalar conc = ReadRealVariable(TrapSpecs[i].profile_name); // read concentration from profile
       conc=conc*TrapSpecs[i].prefactor;     // concentration is scaled by the prefactor
       if (conc>0)
-        AddTrap(*(*pp_point),i,conc);
+        for (unsigned int l=TrapSpecs[i].level_begin; l<TrapSpecs[i].level_end; l++)
+          AddTrap(*current_point(), l, conc*TrapLevels[l].weight);
     }
   }
   // }}}
@@ -619,65 +707,36 @@ public:
 
       PetscScalar conc = TrapSpecs[i].interface_density;
       if (conc>0)
-        AddTrap(*(*pp_point),i,conc);
+        for (unsigned int l=TrapSpecs[i].level_begin; l<TrapSpecs[i].level_end; l++)
+          AddTrap(*current_point(), l, conc*TrapLevels[l].weight);
     }
   }
   // }}}
 
   // {{{void Calculate(const bool flag_bulk, const PetscScalar &p, const PetscScalar &n, const PetscScalar &ni, const PetscScalar &Tl)
   /**
-   * Calculate trap occupancy. The time-derivative term is included with BDF1 discretization
+   * Calculate trap occupancy. The time-derivative term is included with BDF1/BDF2 discretization
    */
   void Calculate(const bool flag_bulk, const PetscScalar &p, const PetscScalar &n, const PetscScalar &ni, const PetscScalar &Tl)
   {
+    TrapGroup * g = find_group(flag_bulk);
+    if (!g) return;
 
-    TrapLocation tloc = TrapLocation((*pp_point)->x(), (*pp_point)->y(), (*pp_point)->z(), flag_bulk?Bulk:Interface);
+    PetscScalar theta_n = 1.0e7*cm/s * sqrt(Tl/300/K); // electron thermal velocity
+    PetscScalar theta_p = 1.0e7*cm/s * sqrt(Tl/300/K); // hole thermal velocity
+    g->update_exp(Tl, kb);
 
-    TrapStore_t::iterator it = TrapStore.find(tloc);
+    PetscScalar a0, a1, a2;
+    time_coefficients(*g, a0, a1, a2);
 
-    if (it!=TrapStore.end())
+    const unsigned int N = g->size();
+    for (unsigned int i=0; i<N; ++i)
     {
-      PetscScalar theta_n = 1.0e7*cm/s * sqrt(Tl/300/K); // electron thermal velocity
-      PetscScalar theta_p = 1.0e7*cm/s * sqrt(Tl/300/K); // hole thermal velocity
-      std::vector<Trap> & traps = it->second;
-      for (std::vector<Trap>::iterator ptrap=traps.begin(); ptrap!=traps.end(); ptrap++)
-      {
-        PetscScalar sigma_n,sigma_p,g_n,g_p,E_t;
-        sigma_n = TrapSpecs[ptrap->spec].sigma_n;
-        sigma_p = TrapSpecs[ptrap->spec].sigma_p;
-        g_n     = TrapSpecs[ptrap->spec].g_n;
-        g_p     = TrapSpecs[ptrap->spec].g_p;
-        E_t     = TrapSpecs[ptrap->spec].E_t;
-
-
-        PetscScalar A,B;
-        A = sigma_n * theta_n * (n + ni/g_n*exp( E_t/kb/Tl)) + sigma_p * theta_p * (p + ni/g_p*exp(-E_t/kb/Tl));
-        B = ptrap->N_tt * ( sigma_n * theta_n * n + sigma_p * theta_p * ni / g_p * exp(-E_t/kb/Tl) );
-
-        if (ReadTime() > ptrap->clock_last)
-        {
-          // we should consider the time derivative of trap occupancy
-          if (ptrap->clock_last > ptrap->clock_last_last)
-          {
-            // We have two previous time step available, use BDF2 discretization
-            PetscScalar d =  1.0 / (ReadTime() - ptrap->clock_last_last);
-            PetscScalar r = (ptrap->clock_last - ptrap->clock_last_last) * d;
-
-            A = A + d * (2-r)/(1-r);
-            B = B + d * ( 1/r/(1-r) * ptrap->n_t_last - (1-r)/r * ptrap->n_t_last_last );
-          }
-          else
-          {
-            // We have two previous time step available, use BDF1 discretization
-            PetscScalar d =  1.0 / (ReadTime() - ptrap->clock_last);
-            A = A + d;
-            B = B + ptrap->n_t_last * d;
-
-          }
-        }
-
-        ptrap->n_t = B/A;
-      }
+      PetscScalar cn = g->sigma_n[i] * theta_n;
+      PetscScalar cp = g->sigma_p[i] * theta_p;
+      PetscScalar A = cn * (n + ni*g->exp_n[i]) + cp * (p + ni*g->exp_p[i]) + a0;
+      PetscScalar B = g->N_tt[i] * (cn * n + cp * ni*g->exp_p[i]) + a1*g->n_t_last[i] + a2*g->n_t_last_last[i];
+      g->n_t[i] = B/A;
     }
   }
   // }}}
@@ -685,57 +744,49 @@ public:
   // {{{ void Calculate(const bool flag_bulk, const AutoDScalar &p, const AutoDScalar &n, const AutoDScalar &ni, const AutoDScalar &Tl)
   /**
    * partial derivatives of trap occupancy w.r.t. local V,n,p,
-   * The time-derivative term is included with BDF1 discretization
+   * The time-derivative term is included with BDF1/BDF2 discretization
    */
   void Calculate(const bool flag_bulk, const AutoDScalar &p, const AutoDScalar &n, const AutoDScalar &ni, const AutoDScalar &Tl)
   {
+    TrapGroup * g = find_group(flag_bulk);
+    if (!g) return;
 
-    TrapLocation tloc = TrapLocation((*pp_point)->x(), (*pp_point)->y(), (*pp_point)->z(), flag_bulk?Bulk:Interface);
+    AutoDScalar theta_n = 1.0e7*cm/s * sqrt(Tl/300/K);
+    AutoDScalar theta_p = 1.0e7*cm/s * sqrt(Tl/300/K);
+    g->update_exp(Tl.getValue(), kb);
+    AutoDScalar ni_db = ni*dbeta(Tl);
 
-    TrapStore_t::iterator it = TrapStore.find(tloc);
+    // level independent products, hoisted out of the loop
+    AutoDScalar thn_n = theta_n*n;
+    AutoDScalar thp_p = theta_p*p;
+
+    PetscScalar a0, a1, a2;
+    time_coefficients(*g, a0, a1, a2);
 
-    if (it!=TrapStore.end())
+    const unsigned int N = g->size();
+    for (unsigned int i=0; i<N; ++i)
     {
-      AutoDScalar theta_n = 1.0e7*cm/s * sqrt(Tl/300/K);
-      AutoDScalar theta_p = 1.0e7*cm/s * sqrt(Tl/300/K);
-      std::vector<Trap> & traps = it->second;
-      for (std::vector<Trap>::iterator ptrap=traps.begin(); ptrap!=traps.end(); ptrap++)
-      {
-        PetscScalar sigma_n,sigma_p,g_n,g_p,E_t;
-        sigma_n = TrapSpecs[ptrap->spec].sigma_n;
-        sigma_p = TrapSpecs[ptrap->spec].sigma_p;
-        g_n     = TrapSpecs[ptrap->spec].g_n;
-        g_p     = TrapSpecs[ptrap->spec].g_p;
-        E_t     = TrapSpecs[ptrap->spec].E_t;
-
-        AutoDScalar A,B;
-        A = sigma_n * theta_n * (n + ni/g_n*exp( E_t/kb/Tl)) + sigma_p * theta_p * (p + ni/g_p*exp(-E_t/kb/Tl));
-        B = ptrap->N_tt * ( sigma_n * theta_n * n + sigma_p * theta_p * ni / g_p * exp(-E_t/kb/Tl) );
-
-        if (ReadTime() > ptrap->clock_last)
-        {
-          // we should consider the time derivative of trap occupancy
-          if (ptrap->clock_last > ptrap->clock_last_last)
-          {
-            // We have two previous time step available, use BDF2 discretization
-            PetscScalar d =  1.0 / (ReadTime() - ptrap->clock_last_last);
-            PetscScalar r = (ptrap->clock_last - ptrap->clock_last_last) * d;
-
-            A = A + d * (2-r)/(1-r);
-            B = B + d * ( 1/r/(1-r) * ptrap->n_t_last - (1-r)/r * ptrap->n_t_last_last );
-          }
-          else
-          {
-            // We have two previous time step available, use BDF1 discretization
-            PetscScalar d =  1.0 / (ReadTime() - ptrap->clock_last);
-            A = A + d;
-            B = B + ptrap->n_t_last * d;
-          }
-        }
+      AutoDScalar en = g->exp_n[i]*(ni + g->E_t[i]*ni_db);   // ni/g_n*exp( E_t/kT)
+      AutoDScalar ep = g->exp_p[i]*(ni - g->E_t[i]*ni_db);   // ni/g_p*exp(-E_t/kT)
+      AutoDScalar cp_ep = g->sigma_p[i] * theta_p * ep;
+      AutoDScalar cn_n  = g->sigma_n[i] * thn_n;
+      AutoDScalar A = cn_n + g->sigma_n[i] * theta_n * en + g->sigma_p[i] * thp_p + cp_ep + a0;
+      AutoDScalar B = g->N_tt[i] * (cn_n + cp_ep) + a1*g->n_t_last[i] + a2*g->n_t_last_last[i];
+      g->n_t_AD[i] = B/A;
+    }
+  }
+  // }}}
 
-        ptrap->n_t_AD = B/A;
-      }
+  // {{{ bool ScaleDensity(const PetscScalar &factor)
+  bool ScaleDensity(const PetscScalar &factor)
+  {
+    for (TrapStore_t::iterator it = TrapStore.begin(); it != TrapStore.end(); ++it)
+    {
+      std::vector<PetscScalar> & N_tt = it->second.N_tt;
+      for (unsigned int i=0; i<N_tt.size(); ++i)
+        N_tt[i] *= factor;
     }
+    return true;
   }
   // }}}
 
@@ -745,27 +796,60 @@ public:
    */
   void Update(const bool flag_bulk, const PetscScalar &p, const PetscScalar &n, const PetscScalar &ni, const PetscScalar &Tl)
   {
-    TrapLocation tloc = TrapLocation((*pp_point)->x(), (*pp_point)->y(), (*pp_point)->z(), flag_bulk?Bulk:Interface);
+    TrapGroup * g = find_group(flag_bulk);
+    if (!g) return;
 
-    TrapStore_t::iterator it = TrapStore.find(tloc);
+    // n_t should already contain the correct solution, however let's play safe and calculate again
+    Calculate(flag_bulk, p, n, ni, Tl);
 
-    if (it != TrapStore.end())
-    {
-      // Trap::n_t should already contain the correct solution, however let's play safe and calculate again
-      Calculate(flag_bulk, p, n, ni, Tl);
+    // update trap occupancy
+    g->n_t_last_last = g->n_t_last;
+    g->n_t_last = g->n_t;
 
-      std::vector<Trap> & traps = it->second;
-      for (std::vector<Trap>::iterator ptrap=traps.begin(); ptrap!=traps.end(); ptrap++)
-      {
-        // update trap occupancy
-        ptrap->n_t_last_last = ptrap->n_t_last;
-        ptrap->n_t_last = ptrap->n_t;
+    // update timestamp
+    g->clock_last_last = g->clock_last;
+    g->clock_last = ReadTime();
+  }
+  // }}}
 
-        // update timestamp
-        ptrap->clock_last_last = ptrap->clock_last;
-        ptrap->clock_last = ReadTime();
-      }
+  // {{{ void Advance(const bool flag_bulk, const PetscScalar &p, const PetscScalar &n, const PetscScalar &ni, const PetscScalar &Tl)
+  /**
+   * advance trap occupancy over the last step with carrier densities held at the converged values.
+   * dn_t/dt = B - A*n_t is integrated exactly, n_t = B/A + (n_t_last - B/A)*exp(-A*dt),
+   * which is stable for any step size. Without a time step the traps relax to steady state.
+   */
+  void Advance(const bool flag_bulk, const PetscScalar &p, const PetscScalar &n, const PetscScalar &ni, const PetscScalar &Tl)
+  {
+    TrapGroup * g = find_group(flag_bulk);
+    if (!g) return;
+
+    PetscScalar theta_n = 1.0e7*cm/s * sqrt(Tl/300/K); // electron thermal velocity
+    PetscScalar theta_p = 1.0e7*cm/s * sqrt(Tl/300/K); // hole thermal velocity
+    g->update_exp(Tl, kb);
+
+    const PetscScalar dt = ReadTime() - g->clock_last;
+
+    const unsigned int N = g->size();
+    for (unsigned int i=0; i<N; ++i)
+    {
+      PetscScalar cn = g->sigma_n[i] * theta_n;
+      PetscScalar cp = g->sigma_p[i] * theta_p;
+      PetscScalar A = cn * (n + ni*g->exp_n[i]) + cp * (p + ni*g->exp_p[i]);
+      PetscScalar B = g->N_tt[i] * (cn * n + cp * ni*g->exp_p[i]);
+      PetscScalar n_inf = B/A;
+      PetscScalar decay = dt > 0 ? exp(-A*dt) : 0.0;
+      g->n_t[i] = n_inf + (g->n_t_last[i] - n_inf)*decay;
+      // occupancy is frozen until the next step, no derivatives w.r.t. local variables
+      g->n_t_AD[i] = AutoDScalar(g->n_t[i]);
     }
+
+    // update trap occupancy
+    g->n_t_last_last = g->n_t_last;
+    g->n_t_last = g->n_t;
+
+    // update timestamp
+    g->clock_last_last = g->clock_last;
+    g->clock_last = ReadTime();
   }
   // }}}
 
@@ -787,6 +871,9 @@ public:
     PetscScalar sigmap = 4e-16 * cm * cm;
     PetscScalar gn=1.0, gp=1.0;
     PetscScalar Dit=0;
+    TrapDistribution distribution = Level;
+    PetscScalar width = 0;
+    unsigned int n_level = 8;
     bool has_profile_name=false, has_interface_name=false,
          has_charge_type=false, has_interface_density=false;
     bool has_some_param=false;
@@ -826,6 +913,13 @@ public:
         if (val=="interface")
           type = Interface;
       }
+      if (name == "distribution")
+      {
+        if (val=="uniform")
+          distribution = Uniform;
+        if (val=="gaussian")
+          distribution = Gaussian;
+      }
     }
 
     if (!has_some_param)
@@ -843,12 +937,12 @@ public:
     // then numerical parameters
     for (it=pmi_parameter.begin(); it!=pmi_parameter.end(); it++)
     {
-      if(it->type()!=Parser::REAL) continue;
+      if(it->type()!=Parser::REAL && it->type()!=Parser::INTEGER) continue;
 
       std::string name;
       PetscScalar val;
       name = it->name();
-      val  = it->get_real();
+      val  = it->type()==Parser::REAL ? it->get_real() : it->get_int();
       std::transform (name.begin(), name.end(), name.begin(), ToLower());
       if (name == "prefactor")
         prefactor = val;
@@ -867,6 +961,10 @@ public:
         Dit= val / (cm*cm);
         has_interface_density = true;
       }
+      if (name == "width")
+        width = val * eV;
+      if (name == "levels")
+        n_level = std::max(1, static_cast<int>(val+0.5));
     }
 
     if (type==Interface)
@@ -876,15 +974,16 @@ public:
 
       // append a new class of interface traps,
       // actual traps are created later on
-      AddInterfaceTrapSpec(interface_name,Dit,charge_type,Et,sigman,sigmap,gn,gp);
+      AddInterfaceTrapSpec(interface_name,Dit,charge_type,Et,sigman,sigmap,gn,gp,distribution,width,n_level);
     }
     else
     {
       // append a new class of bulk traps,
       // actual traps are created later on
-      AddBulkTrapSpec(profile_name,prefactor,charge_type,Et,sigman,sigmap,gn,gp);
+      AddBulkTrapSpec(profile_name,prefactor,charge_type,Et,sigman,sigmap,gn,gp,distribution,width,n_level);
     }
     TrapStore.clear();
+    _last_valid = false;
     return 0;
   }
   // }}}
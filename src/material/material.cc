@@ -24,6 +24,7 @@
 #include <cstdlib>
 #include <cmath>
 #include <iomanip>
+#include <map>
 
 #include "genius_common.h"
 #include "genius_env.h"
@@ -50,27 +51,42 @@
 namespace Material
 {
 
+#ifdef WINDOWS
+  typedef HINSTANCE  LibraryHandle;
+#else
+  typedef void *     LibraryHandle;
+#endif
+
+  /**
+   * material libraries opened by this process, indexed by material name.
+   * a library is opened once and shared by all the regions of this material,
+   * it keeps open until the process exits, since PMI objects created from it
+   * may outlive a single region.
+   */
+  static std::map<std::string, LibraryHandle> & material_library_cache()
+  {
+    static std::map<std::string, LibraryHandle> cache;
+    return cache;
+  }
+
+
   MaterialBase::MaterialBase(const SimulationRegion * reg)
-  : set_ad_num(0),  region(reg) , material(reg->material()), p_point(0), p_node_data(0), dll_file(0)
+  : set_ad_num(0),  region(reg) , material(reg->material()), dll_file(0)
   {
     point_variables = &(region->region_point_variables());
     cell_variables = &(region->region_cell_variables());
+    pmi_counter = solver_counters.counter("pmi." + material);
   }
 
   MaterialBase::~MaterialBase()
   {
-#ifdef WINDOWS
-    FreeLibrary(dll_file);
-#else
-    if ( dll_file )
-      dlclose( dll_file );
-#endif
+    // dll_file is owned by material_library_cache()
   }
 
 
   PMI_Environment MaterialBase::build_PMI_Environment()
   {
-     PMI_Environment env(  &p_point, &p_node_data, &clock, &point_variables,
+     PMI_Environment env(  node_context, &point_variables,
                             PhysicalUnit::m, PhysicalUnit::s, PhysicalUnit::V, PhysicalUnit::C, PhysicalUnit::K);
      return env;
   }
@@ -78,6 +94,31 @@ namespace Material
 
   void MaterialBase::load_material( const std::string & _material )
   {
+    std::map<std::string, LibraryHandle>::const_iterator it = material_library_cache().find(_material);
+    if( it != material_library_cache().end() )
+    {
+      dll_file = it->second;
+      return;
+    }
+
+#ifdef STATIC_MATERIAL
+    // material prelinked into the executable
+    {
+#ifdef WINDOWS
+      LibraryHandle self = GetModuleHandle(NULL);
+#else
+      LibraryHandle self = dlopen(NULL, RTLD_LAZY);
+#endif
+      std::string probe = "PMIS_" + _material + "_BasicParameter_Default";
+      if( self && LDFUN(self, probe.c_str()) )
+      {
+        dll_file = self;
+        material_library_cache()[_material] = dll_file;
+        return;
+      }
+    }
+#endif
+
 #ifdef WINDOWS
     std::string filename =  Genius::genius_dir() + "\\lib\\lib" + _material + ".dll";
 #else
@@ -105,6 +146,8 @@ namespace Material
       genius_error();
     }
 #endif
+
+    material_library_cache()[_material] = dll_file;
   }
 
 
@@ -201,7 +244,7 @@ namespace Material
 
   void MaterialSemiconductor::init_node(const std::string &type, const Point* point, FVM_NodeData* node_data)
   {
-    mapping(point, node_data, clock);
+    mapping(point, node_data, current_context().clock);
     switch ( PMI_Type_string_to_enum(type) )
     {
     case Basic:
@@ -231,7 +274,7 @@ namespace Material
 
   void MaterialSemiconductor::init_bc_node(const std::string &type, const std::string & bc_label, const Point* point, FVM_NodeData* node_data)
   {
-    this->mapping(point,node_data,clock);
+    this->mapping(point, node_data, current_context().clock);
 
     switch(PMI_Type_string_to_enum(type))
     {
@@ -250,6 +293,13 @@ namespace Material
 
   }
 
+  void MaterialSemiconductor::init_mole_table(unsigned int n_node_data)
+  {
+    basic->init_mole_table(n_node_data);
+    band->init_mole_table(n_node_data);
+    mob->init_mole_table(n_node_data);
+  }
+
   std::string MaterialSemiconductor::get_pmi_info(const std::string& type, const int verbosity)
   {
     std::string _material = FormatMaterialString(material);
@@ -500,7 +550,7 @@ namespace Material
 
   void MaterialInsulator::init_node(const std::string &type, const Point* point, FVM_NodeData* node_data)
   {
-    mapping(point, node_data, clock);
+    mapping(point, node_data, current_context().clock);
     switch ( PMI_Type_string_to_enum(type) )
     {
     case Basic:
@@ -522,7 +572,7 @@ namespace Material
   void MaterialInsulator::init_bc_node(const std::string &type, const std::string & bc_label, const Point* point, FVM_NodeData* node_data)
   {
     genius_assert(bc_label.length()); //prevent compiler warning
-    this->mapping(point, node_data, clock);
+    this->mapping(point, node_data, current_context().clock);
 
     switch(PMI_Type_string_to_enum(type))
     {
@@ -709,7 +759,7 @@ namespace Material
 
   void MaterialConductor::init_node(const std::string &type, const Point* point, FVM_NodeData* node_data)
   {
-    mapping(point, node_data, clock);
+    mapping(point, node_data, current_context().clock);
     switch ( PMI_Type_string_to_enum(type) )
     {
     case Basic:
@@ -729,7 +779,7 @@ namespace Material
   {
     genius_assert(bc_label.length()); //prevent compiler warning
 
-    this->mapping(point,node_data,clock);
+    this->mapping(point, node_data, current_context().clock);
 
     switch(PMI_Type_string_to_enum(type))
     {
@@ -897,7 +947,7 @@ namespace Material
 
   void MaterialVacuum::init_node(const std::string &type, const Point* point, FVM_NodeData* node_data)
   {
-    mapping(point, node_data, clock);
+    mapping(point, node_data, current_context().clock);
     switch ( PMI_Type_string_to_enum(type) )
     {
     case Basic:
@@ -917,7 +967,7 @@ namespace Material
   {
     genius_assert(bc_label.length()); //prevent compiler warning
 
-    this->mapping(point,node_data,clock);
+    this->mapping(point, node_data, current_context().clock);
 
     switch(PMI_Type_string_to_enum(type))
     {
@@ -1076,7 +1126,7 @@ namespace Material
 
   void MaterialPML::init_node(const std::string &type, const Point* point, FVM_NodeData* node_data)
   {
-    mapping(point, node_data, clock);
+    mapping(point, node_data, current_context().clock);
     switch ( PMI_Type_string_to_enum(type) )
     {
     case Basic:
@@ -1093,7 +1143,7 @@ namespace Material
   {
     genius_assert(bc_label.length()); //prevent compiler warning
 
-    this->mapping(point,node_data,clock);
+    this->mapping(point, node_data, current_context().clock);
 
     switch(PMI_Type_string_to_enum(type))
     {
@@ -95,7 +95,13 @@ ExprEvalute::ExprEvalute(const std::string & expr)
 
   e.SetValueList(&vlist);
 
+  // the expression is compiled into a flat program with constants folded
   e.Parse(expr);
+
+  _x = vlist.GetAddress("x");
+  _y = vlist.GetAddress("y");
+  _z = vlist.GetAddress("z");
+  _t = vlist.GetAddress("t");
 }
 
 
@@ -103,11 +109,24 @@ ExprEvalute::ExprEvalute(const std::string & expr)
 double ExprEvalute::eval(double x, double y, double z, double t)
 {
   //assign variable value to the expr
-  *(vlist.GetAddress("x")) = x;
-  *(vlist.GetAddress("y")) = y;
-  *(vlist.GetAddress("z")) = z;
-  *(vlist.GetAddress("t")) = t;
+  *_x = x;
+  *_y = y;
+  *_z = z;
+  *_t = t;
 
   return e.Evaluate();
 }
 
+
+void ExprEvalute::eval(unsigned int n, const double *x, const double *y, const double *z, double t, double *result)
+{
+  *_t = t;
+  for(unsigned int i=0; i<n; ++i)
+  {
+    *_x = x[i];
+    *_y = y[i];
+    *_z = z[i];
+    result[i] = e.Evaluate();
+  }
+}
+
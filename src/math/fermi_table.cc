@@ -0,0 +1,108 @@
+/********************************************************************************/
+/*     888888    888888888   88     888  88888   888      888    88888888       */
+/*   8       8   8           8 8     8     8      8        8    8               */
+/*  8            8           8  8    8     8      8        8    8               */
+/*  8            888888888   8   8   8     8      8        8     8888888        */
+/*  8      8888  8           8    8  8     8      8        8            8       */
+/*   8       8   8           8     8 8     8      8        8            8       */
+/*     888888    888888888  888     88   88888     88888888     88888888        */
+/*                                                                              */
+/*       A Three-Dimensional General Purpose Semiconductor Simulator.           */
+/*                                                                              */
+/*                                                                              */
+/*  Copyright (C) 2007-2008                                                     */
+/*  Cogenda Pte Ltd                                                             */
+/*                                                                              */
+/*  Please contact Cogenda Pte Ltd for license information                      */
+/*                                                                              */
+/*  Author: Gong Ding   gdiso@ustc.edu                                          */
+/*                                                                              */
+/********************************************************************************/
+
+
+#include <cmath>
+#include <algorithm>
+
+#include "fermi_table.h"
+
+
+const double FermiTable::_eta_min   = -10.0;
+const double FermiTable::_eta_max   =  60.0;
+const double FermiTable::_eta_inv_h =  16.0;
+const unsigned int FermiTable::_n_eta = 1120;
+
+const double FermiTable::_u_min   = -12.0;
+const double FermiTable::_u_max   =   6.0;
+const double FermiTable::_u_inv_h =  32.0;
+const unsigned int FermiTable::_n_u = 576;
+
+double FermiTable::_half[2*(1120+1)];
+double FermiTable::_mhalf[2*(1120+1)];
+double FermiTable::_lgamma[2*(576+1)];
+
+
+/**
+ * fill the tables at program start up
+ */
+struct FermiTableInit
+{
+  FermiTableInit()
+  {
+    const double h = 1.0/FermiTable::_eta_inv_h;
+    for(unsigned int i=0; i<=FermiTable::_n_eta; ++i)
+    {
+      double f_half, f_mhalf, f_m3half;
+      integral(FermiTable::_eta_min + i*h, f_half, f_mhalf, f_m3half);
+      FermiTable::_half[2*i]    = f_half;
+      FermiTable::_half[2*i+1]  = h*f_mhalf;
+      FermiTable::_mhalf[2*i]   = f_mhalf;
+      FermiTable::_mhalf[2*i+1] = h*f_m3half;
+    }
+
+    // log(gamma) as function of u = log(f): solve F1/2(eta) = exp(u) on the table above
+    const double hu = 1.0/FermiTable::_u_inv_h;
+    for(unsigned int i=0; i<=FermiTable::_n_u; ++i)
+    {
+      double u = FermiTable::_u_min + i*hu;
+      double eta = inv_fermi_half(exp(u));
+      double y=0, dy=1;
+      for(int it=0; it<20; ++it)
+      {
+        FermiTable::_fermi_half(eta, y, dy);
+        double d = (log(y) - u)*y/dy;
+        eta -= d;
+        if(std::abs(d) < 1e-14*std::max(1.0, std::abs(eta))) break;
+      }
+      FermiTable::_fermi_half(eta, y, dy);
+      FermiTable::_lgamma[2*i]   = u - eta;
+      FermiTable::_lgamma[2*i+1] = hu*(1.0 - y/dy);
+    }
+  }
+
+  /**
+   * F1/2, F-1/2 and F-3/2 at eta from the integral definition, with e = t^2.
+   * the integrands are even, smooth functions of t, the trapezoidal rule converges exponentially
+   */
+  static void integral(double eta, double &f_half, double &f_mhalf, double &f_m3half)
+  {
+    const double dt = 0.02;
+    const double t_max = sqrt(std::max(eta, 0.0) + 40.0);
+
+    double s2=0, s0=0, s1=0;
+    for(unsigned int k=0; k*dt <= t_max; ++k)
+    {
+      double t = k*dt;
+      double w = exp(t*t - eta);
+      double f = 1.0/(1.0 + w);
+      double c = (k==0 ? 0.5 : 1.0);
+      s2 += c*t*t*f;
+      s0 += c*f;
+      s1 += c*w*f*f;
+    }
+    f_half   = 4.0/SQRTPI*dt*s2;
+    f_mhalf  = 2.0/SQRTPI*dt*s0;
+    f_m3half = 2.0/SQRTPI*dt*s1;
+  }
+};
+
+static FermiTableInit _fermi_table_init;
@@ -0,0 +1,115 @@
+/********************************************************************************/
+/*     888888    888888888   88     888  88888   888      888    88888888       */
+/*   8       8   8           8 8     8     8      8        8    8               */
+/*  8            8           8  8    8     8      8        8    8               */
+/*  8            888888888   8   8   8     8      8        8     8888888        */
+/*  8      8888  8           8    8  8     8      8        8            8       */
+/*   8       8   8           8     8 8     8      8        8            8       */
+/*     888888    888888888  888     88   88888     88888888     88888888        */
+/*                                                                              */
+/*       A Three-Dimensional General Purpose Semiconductor Simulator.           */
+/*                                                                              */
+/*                                                                              */
+/*  Copyright (C) 2007-2008                                                     */
+/*  Cogenda Pte Ltd                                                             */
+/*                                                                              */
+/*  Please contact Cogenda Pte Ltd for license information                      */
+/*                                                                              */
+/*  Author: Gong Ding   gdiso@ustc.edu                                          */
+/*                                                                              */
+/********************************************************************************/
+
+#include <cmath>
+#include <algorithm>
+#include "mathfunc.h"
+
+// the loops below have no branch and no library call, gcc vectorizes them
+// with the dynamic cost model. the default -O2 only allows very cheap loops.
+// the inline flux kernels are included under the same options, since gcc
+// does not inline a function with different optimize options.
+#if defined(__GNUC__) && !defined(__INTEL_COMPILER) && !defined(__clang__)
+  #pragma GCC push_options
+  #pragma GCC optimize ("O3", "no-trapping-math")
+#endif
+
+#include "bern_nb.h"
+#include "jflux_jac.h"
+#include "jflux_batch.h"
+
+// AVX-512 and AVX2 clones of the batched kernels, selected by the loader on the running cpu.
+// icc does the same with -ax options.
+#if defined(__GNUC__) && !defined(__INTEL_COMPILER) && !defined(__clang__) && (__GNUC__ >= 6) && defined(__x86_64__) && defined(LINUX)
+  #define JFLUX_TARGET_CLONES __attribute__((target_clones("avx512f","avx2","default")))
+#else
+  #define JFLUX_TARGET_CLONES
+#endif
+
+
+JFLUX_TARGET_CLONES
+void bern_batch(const unsigned int size, const PetscScalar * __restrict x, PetscScalar * __restrict b, PetscScalar * __restrict db)
+{
+  if( db )
+  {
+    for(unsigned int i=0; i<size; ++i)
+      bern_nb(x[i], b[i], db[i]);
+  }
+  else
+  {
+    for(unsigned int i=0; i<size; ++i)
+    {
+      PetscScalar d;
+      bern_nb(x[i], b[i], d);
+    }
+  }
+}
+
+
+JFLUX_TARGET_CLONES
+void In_dd_batch(const unsigned int size, const PetscScalar Vt,
+                 const PetscScalar * __restrict dV, const PetscScalar * __restrict n1, const PetscScalar * __restrict n2, const PetscScalar * __restrict h,
+                 PetscScalar * __restrict J, PetscScalar * __restrict dJ_dV, PetscScalar * __restrict dJ_dn1, PetscScalar * __restrict dJ_dn2)
+{
+  if( dJ_dV && dJ_dn1 && dJ_dn2 )
+  {
+    for(unsigned int i=0; i<size; ++i)
+      In_dd_grad(Vt, dV[i], n1[i], n2[i], h[i], J[i], dJ_dV[i], dJ_dn1[i], dJ_dn2[i]);
+    return;
+  }
+
+  const PetscScalar inv_Vt = 1.0/Vt;
+  for(unsigned int i=0; i<size; ++i)
+  {
+    const PetscScalar u = dV[i]*inv_Vt;
+    PetscScalar B, dB;
+    bern_nb(u, B, dB);
+    J[i] = Vt*(n2[i]*(B+u) - n1[i]*B)/h[i];
+  }
+}
+
+
+JFLUX_TARGET_CLONES
+void Ip_dd_batch(const unsigned int size, const PetscScalar Vt,
+                 const PetscScalar * __restrict dV, const PetscScalar * __restrict p1, const PetscScalar * __restrict p2, const PetscScalar * __restrict h,
+                 PetscScalar * __restrict J, PetscScalar * __restrict dJ_dV, PetscScalar * __restrict dJ_dp1, PetscScalar * __restrict dJ_dp2)
+{
+  if( dJ_dV && dJ_dp1 && dJ_dp2 )
+  {
+    for(unsigned int i=0; i<size; ++i)
+      Ip_dd_grad(Vt, dV[i], p1[i], p2[i], h[i], J[i], dJ_dV[i], dJ_dp1[i], dJ_dp2[i]);
+    return;
+  }
+
+  const PetscScalar inv_Vt = 1.0/Vt;
+  for(unsigned int i=0; i<size; ++i)
+  {
+    const PetscScalar u = dV[i]*inv_Vt;
+    PetscScalar B, dB;
+    bern_nb(u, B, dB);
+    J[i] = Vt*(p1[i]*(B+u) - p2[i]*B)/h[i];
+  }
+}
+
+
+#if defined(__GNUC__) && !defined(__INTEL_COMPILER) && !defined(__clang__)
+  #pragma GCC pop_options
+#endif
@@ -0,0 +1,228 @@
+/********************************************************************************/
+/*     888888    888888888   88     888  88888   888      888    88888888       */
+/*   8       8   8           8 8     8     8      8        8    8               */
+/*  8            8           8  8    8     8      8        8    8               */
+/*  8            888888888   8   8   8     8      8        8     8888888        */
+/*  8      8888  8           8    8  8     8      8        8            8       */
+/*   8       8   8           8     8 8     8      8        8            8       */
+/*     888888    888888888  888     88   88888     88888888     88888888        */
+/*                                                                              */
+/*       A Three-Dimensional General Purpose Semiconductor Simulator.           */
+/*                                                                              */
+/*                                                                              */
+/*  Copyright (C) 2007-2008                                                     */
+/*  Cogenda Pte Ltd                                                             */
+/*                                                                              */
+/*  Please contact Cogenda Pte Ltd for license information                      */
+/*                                                                              */
+/*  Author: Gong Ding   gdiso@ustc.edu                                          */
+/*                                                                              */
+/********************************************************************************/
+
+#include <string>
+#include <algorithm>
+
+#include "genius_common.h"
+#include "genius_petsc.h"
+#include "klu_factor.h"
+
+
+extern "C"
+{
+  //---------------------------------------------------------------
+  // this function is called by PETSc when the operator of the shell preconditioner is changed
+  static PetscErrorCode  __genius_petsc_klu_pc_setup (PC pc)
+  {
+    void * ctx;
+    PCShellGetContext(pc, &ctx);
+
+    Mat A, P;
+#if PETSC_VERSION_GE(3,5,0)
+    PCGetOperators(pc, &A, &P);
+#else
+    MatStructure flag;
+    PCGetOperators(pc, &A, &P, &flag);
+#endif
+
+    KLUFactor * klu = (KLUFactor *)ctx;
+    klu->factor(P);
+
+    return 0;
+  }
+
+  //---------------------------------------------------------------
+  // this function is called by PETSc to apply the KLU factor
+  static PetscErrorCode  __genius_petsc_klu_pc_apply (PC pc, Vec x, Vec y)
+  {
+    void * ctx;
+    PCShellGetContext(pc, &ctx);
+
+    KLUFactor * klu = (KLUFactor *)ctx;
+    klu->solve(x, y);
+
+    return 0;
+  }
+
+  //---------------------------------------------------------------
+  // this function is called by PETSc when the shell preconditioner is destroyed
+  static PetscErrorCode  __genius_petsc_klu_pc_destroy (PC pc)
+  {
+    void * ctx;
+    PCShellGetContext(pc, &ctx);
+
+    delete (KLUFactor *)ctx;
+
+    return 0;
+  }
+}
+
+
+
+KLUFactor::KLUFactor(bool reuse_symbolic)
+  : _reuse_symbolic(reuse_symbolic), _symbolic(0), _numeric(0), _aij(PETSC_NULL),
+    _rcond(0.0), _n_factor(0), _n_refactor(0)
+{
+  klu_defaults(&_common);
+  // keep going on a singular matrix, the newton iteration reports the failure
+  _common.halt_if_singular = 0;
+}
+
+
+KLUFactor::~KLUFactor()
+{
+  clear();
+  if( _aij ) MatDestroy(PetscDestroyObject(_aij));
+}
+
+
+void KLUFactor::clear()
+{
+  if( _numeric )  klu_free_numeric(&_numeric, &_common);
+  if( _symbolic ) klu_free_symbolic(&_symbolic, &_common);
+  _ap.clear();
+  _ai.clear();
+}
+
+
+bool KLUFactor::_load(Mat A)
+{
+  PetscErrorCode ierr;
+
+  // the value array of block matrix is not indexed by entries
+  MatType type;
+  ierr = MatGetType(A, &type); genius_assert(!ierr);
+  if( std::string(type).find("baij") != std::string::npos )
+  {
+    ierr = MatConvert(A, MATSEQAIJ, _aij ? MAT_REUSE_MATRIX : MAT_INITIAL_MATRIX, &_aij); genius_assert(!ierr);
+    A = _aij;
+  }
+
+  PetscInt n;
+  const PetscInt *ia, *ja;
+  PetscBool done;
+  ierr = MatGetRowIJ(A, 0, PETSC_FALSE, PETSC_FALSE, &n, &ia, &ja, &done); genius_assert(!ierr);
+  genius_assert(done);
+
+  bool same_pattern = _ap.size() == static_cast<size_t>(n+1) &&
+                      std::equal(ia, ia+n+1, _ap.begin()) &&
+                      std::equal(ja, ja+ia[n], _ai.begin());
+  if( !same_pattern )
+  {
+    _ap.assign(ia, ia+n+1);
+    _ai.assign(ja, ja+ia[n]);
+  }
+  ierr = MatRestoreRowIJ(A, 0, PETSC_FALSE, PETSC_FALSE, &n, &ia, &ja, &done); genius_assert(!ierr);
+
+  PetscScalar *a;
+  ierr = MatSeqAIJGetArray(A, &a); genius_assert(!ierr);
+  _ax.assign(a, a+_ap[n]);
+  ierr = MatSeqAIJRestoreArray(A, &a); genius_assert(!ierr);
+
+  return same_pattern;
+}
+
+
+void KLUFactor::_full_factor()
+{
+  if( _numeric ) klu_free_numeric(&_numeric, &_common);
+
+  const int n = _ap.size()-1;
+  if( !_symbolic )
+  {
+    _symbolic = klu_analyze(n, &_ap[0], &_ai[0], &_common);
+    genius_assert(_symbolic);
+  }
+
+  _numeric = klu_factor(&_ap[0], &_ai[0], &_ax[0], _symbolic, &_common);
+  genius_assert(_numeric);
+
+  klu_rcond(_symbolic, _numeric, &_common);
+  _rcond = _common.rcond;
+  _n_factor++;
+}
+
+
+void KLUFactor::factor(Mat A)
+{
+  const bool same_pattern = _load(A);
+
+  if( !same_pattern || !_reuse_symbolic )
+  {
+    if( _numeric )  klu_free_numeric(&_numeric, &_common);
+    if( _symbolic ) klu_free_symbolic(&_symbolic, &_common);
+  }
+
+  if( !_numeric )
+  {
+    _full_factor();
+    return;
+  }
+
+  // the pivot sequence of last factorization is kept by refactor. the values of a newton
+  // step change a little, but a refactor with pivot ratio far worse than the last full
+  // factorization means the old pivots are no longer stable
+  if( klu_refactor(&_ap[0], &_ai[0], &_ax[0], _symbolic, _numeric, &_common) )
+  {
+    klu_rcond(_symbolic, _numeric, &_common);
+    if( _common.rcond > 1e-3*_rcond )
+    {
+      _n_refactor++;
+      return;
+    }
+  }
+
+  _full_factor();
+}
+
+
+void KLUFactor::solve(Vec b, Vec x)
+{
+  PetscErrorCode ierr;
+
+  const PetscScalar *bb;
+  PetscInt n;
+  ierr = VecGetLocalSize(b, &n); genius_assert(!ierr);
+  ierr = VecGetArray(b, (PetscScalar **)&bb); genius_assert(!ierr);
+  _b.assign(bb, bb+n);
+  ierr = VecRestoreArray(b, (PetscScalar **)&bb); genius_assert(!ierr);
+
+  // A^T is factored, transposed solve gives A x = b
+  klu_tsolve(_symbolic, _numeric, n, 1, &_b[0], &_common);
+
+  PetscScalar *xx;
+  ierr = VecGetArray(x, &xx); genius_assert(!ierr);
+  std::copy(_b.begin(), _b.end(), xx);
+  ierr = VecRestoreArray(x, &xx); genius_assert(!ierr);
+}
+
+
+void KLUFactor::set_pc_shell(PC pc, bool reuse_symbolic)
+{
+  PetscErrorCode ierr;
+  ierr = PCSetType(pc, (char*) PCSHELL); genius_assert(!ierr);
+  ierr = PCShellSetContext(pc, (void *)new KLUFactor(reuse_symbolic)); genius_assert(!ierr);
+  ierr = PCShellSetSetUp(pc, __genius_petsc_klu_pc_setup); genius_assert(!ierr);
+  ierr = PCShellSetApply(pc, __genius_petsc_klu_pc_apply); genius_assert(!ierr);
+  ierr = PCShellSetDestroy(pc, __genius_petsc_klu_pc_destroy); genius_assert(!ierr);
+  ierr = PCShellSetName(pc, "KLU"); genius_assert(!ierr);
+}
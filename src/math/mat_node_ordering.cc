@@ -0,0 +1,145 @@
+/********************************************************************************/
+/*     888888    888888888   88     888  88888   888      888    88888888       */
+/*   8       8   8           8 8     8     8      8        8    8               */
+/*  8            8           8  8    8     8      8        8    8               */
+/*  8            888888888   8   8   8     8      8        8     8888888        */
+/*  8      8888  8           8    8  8     8      8        8            8       */
+/*   8       8   8           8     8 8     8      8        8            8       */
+/*     888888    888888888  888     88   88888     88888888     88888888        */
+/*                                                                              */
+/*       A Three-Dimensional General Purpose Semiconductor Simulator.           */
+/*                                                                              */
+/*                                                                              */
+/*  Copyright (C) 2007-2008                                                     */
+/*  Cogenda Pte Ltd                                                             */
+/*                                                                              */
+/*  Please contact Cogenda Pte Ltd for license information                      */
+/*                                                                              */
+/*  Author: Gong Ding   gdiso@ustc.edu                                          */
+/*                                                                              */
+/********************************************************************************/
+
+#include "genius_common.h"
+#include "mat_node_ordering.h"
+#include "petscis.h"
+
+#if (defined(PETSC_HAVE_PARMETIS) || defined(PETSC_HAVE_METIS))
+
+namespace Metis
+{
+  extern "C"
+  {
+#     include "metis.h"
+
+  }
+}
+
+#endif
+
+
+std::map<Mat, const std::vector<PetscInt> *> MatNodeOrdering::_perms;
+
+
+#if PETSC_VERSION_GE(3,4,0)
+/**
+ * the ordering routine called by PETSc before symbolic factorization.
+ * falls back to nested dissection of the matrix graph when no permutation
+ * is attached to the matrix, i.e. a copy of jacobian.
+ */
+extern "C" PetscErrorCode MatGetOrdering_GeniusND(Mat mat, MatOrderingType, IS *irow, IS *icol)
+{
+  PetscErrorCode ierr;
+  PetscInt m, n;
+  ierr = MatGetSize(mat, &m, &n); CHKERRQ(ierr);
+
+  const std::vector<PetscInt> * perm = MatNodeOrdering::get(mat);
+  if( perm==NULL || m!=n || static_cast<PetscInt>(perm->size())!=m )
+  {
+    ierr = MatGetOrdering(mat, MATORDERINGND, irow, icol); CHKERRQ(ierr);
+    return 0;
+  }
+
+  ierr = ISCreateGeneral(PETSC_COMM_SELF, m, &(*perm)[0], PETSC_COPY_VALUES, irow); CHKERRQ(ierr);
+  ierr = ISCreateGeneral(PETSC_COMM_SELF, m, &(*perm)[0], PETSC_COPY_VALUES, icol); CHKERRQ(ierr);
+  ierr = ISSetPermutation(*irow); CHKERRQ(ierr);
+  ierr = ISSetPermutation(*icol); CHKERRQ(ierr);
+  return 0;
+}
+#endif
+
+
+const char * MatNodeOrdering::type()
+{
+  return "genius_nd";
+}
+
+
+bool MatNodeOrdering::register_type()
+{
+#if PETSC_VERSION_GE(3,4,0)
+  static bool registered = false;
+  if( !registered )
+  {
+    PetscErrorCode ierr = MatOrderingRegister(type(), MatGetOrdering_GeniusND); genius_assert(!ierr);
+    registered = true;
+  }
+  return true;
+#else
+  return false;
+#endif
+}
+
+
+bool MatNodeOrdering::nested_dissection(std::vector<int> &xadj, std::vector<int> &adjncy, std::vector<int> &vwgt,
+                                        std::vector<int> &order)
+{
+#if (defined(PETSC_HAVE_PARMETIS) || defined(PETSC_HAVE_METIS))
+  int n = static_cast<int>(xadj.size()) - 1;
+  order.resize(n);
+  if( n <= 0 ) return true;
+
+  std::vector<int> perm(n);
+  if (adjncy.empty())
+    adjncy.push_back(0);
+
+#if PETSC_VERSION_GE(3,3,0)
+  // METIS-5 interface, METIS_NodeND takes vertex weight
+  int metis_error = Metis::METIS_NodeND(&n, &xadj[0], &adjncy[0], vwgt.empty() ? NULL : &vwgt[0], NULL/*options*/,
+                                        &perm[0], &order[0]);
+  return metis_error == Metis::METIS_OK;
+#else
+  // old METIS-4 interface
+  int numflag = 0;
+  int options[8];
+  options[0] = 0;
+  if( vwgt.empty() )
+    Metis::METIS_NodeND(&n, &xadj[0], &adjncy[0], &numflag, &options[0], &perm[0], &order[0]);
+  else
+    Metis::METIS_NodeWND(&n, &xadj[0], &adjncy[0], &vwgt[0], &numflag, &options[0], &perm[0], &order[0]);
+  return true;
+#endif
+
+#else
+  return false;
+#endif
+}
+
+
+void MatNodeOrdering::attach(Mat A, const std::vector<PetscInt> &perm)
+{
+  _perms[A] = &perm;
+}
+
+
+void MatNodeOrdering::detach(Mat A)
+{
+  _perms.erase(A);
+}
+
+
+const std::vector<PetscInt> * MatNodeOrdering::get(Mat A)
+{
+  std::map<Mat, const std::vector<PetscInt> *>::const_iterator it = _perms.find(A);
+  return it == _perms.end() ? NULL : it->second;
+}
+
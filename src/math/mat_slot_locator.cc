@@ -0,0 +1,165 @@
+/********************************************************************************/
+/*     888888    888888888   88     888  88888   888      888    88888888       */
+/*   8       8   8           8 8     8     8      8        8    8               */
+/*  8            8           8  8    8     8      8        8    8               */
+/*  8            888888888   8   8   8     8      8        8     8888888        */
+/*  8      8888  8           8    8  8     8      8        8            8       */
+/*   8       8   8           8     8 8     8      8        8            8       */
+/*     888888    888888888  888     88   88888     88888888     88888888        */
+/*                                                                              */
+/*       A Three-Dimensional General Purpose Semiconductor Simulator.           */
+/*                                                                              */
+/*                                                                              */
+/*  Copyright (C) 2007-2008                                                     */
+/*  Cogenda Pte Ltd                                                             */
+/*                                                                              */
+/*  Please contact Cogenda Pte Ltd for license information                      */
+/*                                                                              */
+/*  Author: Gong Ding   gdiso@ustc.edu                                          */
+/*                                                                              */
+/********************************************************************************/
+
+#include <algorithm>
+#include <string>
+
+#include "genius_common.h"
+#include "genius_env.h"
+#include "mat_slot_locator.h"
+
+
+std::map<Mat, MatSlotLocator *> MatSlotLocator::_locators;
+
+
+void MatSlotLocator::attach(Mat A)
+{
+  detach(A);
+
+  // the value arrays of block matrix are not indexed by entries
+  MatType type;
+  PetscErrorCode ierr = MatGetType(A, &type); genius_assert(!ierr);
+  if( std::string(type).find("baij") != std::string::npos ) return;
+
+  _locators[A] = new MatSlotLocator(A);
+}
+
+
+void MatSlotLocator::detach(Mat A)
+{
+  std::map<Mat, MatSlotLocator *>::iterator it = _locators.find(A);
+  if( it == _locators.end() ) return;
+  delete it->second;
+  _locators.erase(it);
+}
+
+
+const MatSlotLocator * MatSlotLocator::get(Mat A)
+{
+  std::map<Mat, MatSlotLocator *>::const_iterator it = _locators.find(A);
+  return it == _locators.end() ? NULL : it->second;
+}
+
+
+void MatSlotLocator::local_blocks(Mat A, Mat &Ad, Mat &Ao, const PetscInt * &colmap)
+{
+  Ad = A;
+  Ao = PETSC_NULL;
+  colmap = PETSC_NULL;
+  if( Genius::n_processors() > 1 )
+  {
+    PetscErrorCode ierr = MatMPIAIJGetSeqAIJ(A, &Ad, &Ao, &colmap); genius_assert(!ierr);
+  }
+}
+
+
+static void copy_csr(Mat A, std::vector<PetscInt> &i, std::vector<PetscInt> &j)
+{
+  PetscInt n;
+  const PetscInt *ia, *ja;
+  PetscBool done;
+  PetscErrorCode ierr = MatGetRowIJ(A, 0, PETSC_FALSE, PETSC_FALSE, &n, &ia, &ja, &done); genius_assert(!ierr);
+  genius_assert(done);
+  i.assign(ia, ia+n+1);
+  j.assign(ja, ja+ia[n]);
+  ierr = MatRestoreRowIJ(A, 0, PETSC_FALSE, PETSC_FALSE, &n, &ia, &ja, &done); genius_assert(!ierr);
+}
+
+
+MatSlotLocator::MatSlotLocator(Mat A)
+{
+  static unsigned int serial = 0;
+  _serial = ++serial;
+
+  PetscErrorCode ierr;
+  ierr = MatGetOwnershipRange(A, &_row_begin, &_row_end); genius_assert(!ierr);
+  ierr = MatGetOwnershipRangeColumn(A, &_col_begin, &_col_end); genius_assert(!ierr);
+
+  Mat Ad, Ao;
+  const PetscInt * colmap;
+  local_blocks(A, Ad, Ao, colmap);
+
+  copy_csr(Ad, _diag_i, _diag_j);
+  if( Ao )
+  {
+    copy_csr(Ao, _off_i, _off_j);
+
+    PetscInt m, n;
+    ierr = MatGetLocalSize(Ao, &m, &n); genius_assert(!ierr);
+    for(PetscInt c=0; c<n; ++c)
+      _off_cols.push_back(std::make_pair(colmap[c], c));
+    std::sort(_off_cols.begin(), _off_cols.end());
+  }
+}
+
+
+PetscInt MatSlotLocator::slot(PetscInt row, PetscInt col) const
+{
+  if( row < _row_begin || row >= _row_end ) return -1;
+  const PetscInt r = row - _row_begin;
+
+  // the columns of each row are sorted in AIJ matrix
+  if( col >= _col_begin && col < _col_end )
+  {
+    if( _diag_j.empty() ) return -1;
+    const PetscInt * begin = &_diag_j[0] + _diag_i[r];
+    const PetscInt * end   = &_diag_j[0] + _diag_i[r+1];
+    const PetscInt * it = std::lower_bound(begin, end, col - _col_begin);
+    if( it == end || *it != col - _col_begin ) return -1;
+    return it - &_diag_j[0];
+  }
+
+  if( _off_cols.empty() ) return -1;
+
+  std::vector< std::pair<PetscInt, PetscInt> >::const_iterator c =
+    std::lower_bound(_off_cols.begin(), _off_cols.end(), std::make_pair(col, static_cast<PetscInt>(-1)));
+  if( c == _off_cols.end() || c->first != col ) return -1;
+
+  const PetscInt * begin = &_off_j[0] + _off_i[r];
+  const PetscInt * end   = &_off_j[0] + _off_i[r+1];
+  const PetscInt * it = std::find(begin, end, c->second);
+  if( it == end ) return -1;
+  return static_cast<PetscInt>(_diag_j.size()) + (it - &_off_j[0]);
+}
+
+
+void MatSlotLocator::add_values(Mat A, unsigned int n, const PetscInt * slots, const PetscScalar * v) const
+{
+  Mat Ad, Ao;
+  const PetscInt * colmap;
+  local_blocks(A, Ad, Ao, colmap);
+
+  PetscScalar *a, *b=PETSC_NULL;
+  PetscErrorCode ierr = MatSeqAIJGetArray(Ad, &a); genius_assert(!ierr);
+  if( Ao ) { ierr = MatSeqAIJGetArray(Ao, &b); genius_assert(!ierr); }
+
+  const PetscInt n_diag = _diag_j.size();
+  for(unsigned int k=0; k<n; ++k)
+  {
+    const PetscInt s = slots[k];
+    if( s < 0 ) continue;
+    if( s < n_diag ) a[s] += v[k];
+    else             b[s-n_diag] += v[k];
+  }
+
+  ierr = MatSeqAIJRestoreArray(Ad, &a); genius_assert(!ierr);
+  if( Ao ) { ierr = MatSeqAIJRestoreArray(Ao, &b); genius_assert(!ierr); }
+}
@@ -41,6 +41,7 @@ namespace SolverSpecify
       NonLinearSolverName_to_NonLinearSolverType["basic"      ]  = Newton;
       NonLinearSolverName_to_NonLinearSolverType["linesearch" ]  = LineSearch;
       NonLinearSolverName_to_NonLinearSolverType["trustregion"]  = TrustRegion;
+      NonLinearSolverName_to_NonLinearSolverType["broyden"    ]  = Broyden;
     }
 
   }
@@ -93,6 +94,7 @@ namespace SolverSpecify
       LinearSolverName_to_LinearSolverType["mumps"       ]  = MUMPS;
       LinearSolverName_to_LinearSolverType["superlu_dist"]  = SuperLU_DIST;
       LinearSolverName_to_LinearSolverType["gss"         ]  = GSS;
+      LinearSolverName_to_LinearSolverType["klu"         ]  = KLU;
     }
 
   }
@@ -130,6 +132,9 @@ namespace SolverSpecify
       PreconditionerName_to_PreconditionerType["ilut"        ]  = ILUT_PRECOND;
       PreconditionerName_to_PreconditionerType["lu"          ]  = LU_PRECOND;
       PreconditionerName_to_PreconditionerType["parms"       ]  = PARMS_PRECOND;
+      PreconditionerName_to_PreconditionerType["fieldsplit"  ]  = FIELDSPLIT_PRECOND;
+      PreconditionerName_to_PreconditionerType["gamg"        ]  = GAMG_PRECOND;
+      PreconditionerName_to_PreconditionerType["regionasm"   ]  = REGION_ASM_PRECOND;
     }
   }
 
@@ -173,7 +178,8 @@ namespace SolverSpecify
       case PASTIX       :
       case MUMPS        :
       case SuperLU_DIST :
-      case GSS          : return DIRECT;
+      case GSS          :
+      case KLU          : return DIRECT;
     }
 
     return HYBRID;
@@ -21,11 +21,13 @@
 
 //  $Id: petsc_utils.cc,v 1.5 2008/07/09 05:58:16 gdiso Exp $
 
+#include <algorithm>
 #include <map>
 #include <vector>
 
 #include "genius_petsc.h"
 #include "petsc_utils.h"
+#include "perf_log.h"
 
 
 namespace PetscUtils
@@ -35,11 +37,14 @@ namespace PetscUtils
    */
   PetscErrorCode MatZeroRows(Mat mat,PetscInt numRows,const PetscInt rows[],PetscScalar diag)
   {
+    START_LOG("MatZeroRows()", "PetscUtils");
 #if PETSC_VERSION_GE(3,2,0)
-      return ::MatZeroRows(mat, numRows, rows, diag, PETSC_NULL, PETSC_NULL);
+    PetscErrorCode ierr = ::MatZeroRows(mat, numRows, rows, diag, PETSC_NULL, PETSC_NULL);
 #else
-      return ::MatZeroRows(mat, numRows, rows, diag);
+    PetscErrorCode ierr = ::MatZeroRows(mat, numRows, rows, diag);
 #endif
+    STOP_LOG("MatZeroRows()", "PetscUtils");
+    return ierr;
   }
 
   /*-------------------------------------------------------------------
@@ -254,6 +259,7 @@ namespace PetscUtils
    */
   PetscErrorCode  MatAddRowToRow(Mat mat, PetscInt rows, PetscInt src_rows[], PetscInt dst_rows[], PetscScalar alpha[])
   {
+    START_LOG("MatAddRowToRow()", "PetscUtils");
 
     // test if the matrix is assembled
     // note: the test is not work properly! if it is a bug...
@@ -306,6 +312,8 @@ namespace PetscUtils
     MatAssemblyBegin(mat, MAT_FINAL_ASSEMBLY);
     MatAssemblyEnd(mat, MAT_FINAL_ASSEMBLY);
 
+    STOP_LOG("MatAddRowToRow()", "PetscUtils");
+
     return 0;
   }
 
@@ -324,6 +332,7 @@ namespace PetscUtils
    */
   PetscErrorCode  MatAddRowToRow(Mat mat, PetscInt rows, PetscInt src_rows[], PetscInt dst_rows[], PetscScalar alpha)
   {
+    START_LOG("MatAddRowToRow()", "PetscUtils");
 
     // test if the matrix is assembled
     // note: the test is not work properly! if it is a bug...
@@ -378,6 +387,8 @@ namespace PetscUtils
     MatAssemblyBegin(mat, MAT_FINAL_ASSEMBLY);
     MatAssemblyEnd(mat, MAT_FINAL_ASSEMBLY);
 
+    STOP_LOG("MatAddRowToRow()", "PetscUtils");
+
     return 0;
   }
 
@@ -396,6 +407,7 @@ namespace PetscUtils
    */
   PetscErrorCode  MatAddRowToRow(Mat mat, std::vector<PetscInt> & src_rows, std::vector<PetscInt> & dst_rows, PetscScalar alpha)
   {
+    START_LOG("MatAddRowToRow()", "PetscUtils");
 
     // test if the matrix is assembled
     // note: the test is not work properly! if it is a bug...
@@ -455,6 +467,8 @@ namespace PetscUtils
     MatAssemblyBegin(mat, MAT_FINAL_ASSEMBLY);
     MatAssemblyEnd(mat, MAT_FINAL_ASSEMBLY);
 
+    STOP_LOG("MatAddRowToRow()", "PetscUtils");
+
     return 0;
   }
 
@@ -472,6 +486,7 @@ namespace PetscUtils
    */
   PetscErrorCode  MatAddRowToRow(Mat mat, std::vector<PetscInt> & src_rows, std::vector<PetscInt> & dst_rows, std::vector<PetscScalar> & alpha)
   {
+    START_LOG("MatAddRowToRow()", "PetscUtils");
 
     // test if the matrix is assembled
     // note: the test is not work properly! if it is a bug...
@@ -531,11 +546,109 @@ namespace PetscUtils
     MatAssemblyBegin(mat, MAT_FINAL_ASSEMBLY);
     MatAssemblyEnd(mat, MAT_FINAL_ASSEMBLY);
 
+    STOP_LOG("MatAddRowToRow()", "PetscUtils");
+
+    return 0;
+  }
+
+  /*-------------------------------------------------------------------
+   * @brief add source rows to destination rows, and clear some rows
+   *
+   * @param  mat        Petsc Matrix
+   * @param  src_rows   source rows
+   * @param  dst_rows   the destination rows will be added to
+   * @param  clear_rows the rows to be cleared
+   *
+   * @note   If mat is not assembled, this function will do it for you. the src row should on local processor.
+   *
+   */
+  PetscErrorCode  MatAddClearRow(Mat mat, std::vector<PetscInt> & src_rows, std::vector<PetscInt> & dst_rows, std::vector<PetscInt> & clear_rows)
+  {
+    genius_assert(src_rows.size() == dst_rows.size());
+
+    START_LOG("MatAddClearRow()", "PetscUtils");
+
+    // MatGetRow requires an assembled matrix
+    MatAssemblyBegin(mat, MAT_FINAL_ASSEMBLY);
+    MatAssemblyEnd(mat, MAT_FINAL_ASSEMBLY);
+
+    // duplicated clear rows must be cancelled only once
+    std::vector<PetscInt> clear(clear_rows);
+    std::sort(clear.begin(), clear.end());
+    clear.erase(std::unique(clear.begin(), clear.end()), clear.end());
+
+    // the single pass is only valid when all the rows are local
+    // and no destination row will be cleared afterwards
+    PetscInt row_begin, row_end;
+    MatGetOwnershipRange(mat, &row_begin, &row_end);
+
+    int fused = 1;
+    for(unsigned int n=0; n<src_rows.size() && fused; n++)
+    {
+      if( src_rows[n] < row_begin || src_rows[n] >= row_end ) fused = 0;
+      if( dst_rows[n] < row_begin || dst_rows[n] >= row_end ) fused = 0;
+      if( std::binary_search(clear.begin(), clear.end(), dst_rows[n]) ) fused = 0;
+    }
+    if( !clear.empty() && (clear.front() < row_begin || clear.back() >= row_end) ) fused = 0;
+
+    // all the processors should go the same way since assembly is collective
+    MPI_Comm comm;
+    PetscObjectGetComm((PetscObject)mat, &comm);
+    int fused_all;
+    MPI_Allreduce(&fused, &fused_all, 1, MPI_INT, MPI_MIN, comm);
+
+    if( !fused_all )
+    {
+      STOP_LOG("MatAddClearRow()", "PetscUtils");
+      MatAddRowToRow(mat, src_rows, dst_rows);
+      PetscUtils::MatZeroRows(mat, clear_rows.size(), clear_rows.empty() ? NULL : &clear_rows[0], 0.0);
+      return 0;
+    }
+
+    // read source and clear rows into one flat buffer before any value is changed
+    std::vector<PetscInt>    row_offset(1, 0);
+    std::vector<PetscInt>    row_cols;
+    std::vector<PetscScalar> row_vals;
+    for(unsigned int n=0; n<src_rows.size()+clear.size(); n++)
+    {
+      PetscInt row = n < src_rows.size() ? src_rows[n] : clear[n-src_rows.size()];
+      PetscScalar alpha = n < src_rows.size() ? 1.0 : -1.0;
+
+      PetscInt ncols;
+      const PetscInt * row_cols_pointer;
+      const PetscScalar * row_vals_pointer;
+
+      MatGetRow(mat, row, &ncols, &row_cols_pointer, &row_vals_pointer);
+      for(PetscInt i=0; i<ncols; i++)
+      {
+        row_cols.push_back(row_cols_pointer[i]);
+        row_vals.push_back(row_vals_pointer[i]*alpha);
+      }
+      row_offset.push_back(row_cols.size());
+      MatRestoreRow(mat, row, &ncols, &row_cols_pointer, &row_vals_pointer);
+    }
+
+    // add source rows to destination rows, and cancel the clear rows by their negative values.
+    // the nonzero pattern of clear rows is kept for later insertion
+    for(unsigned int n=0; n<src_rows.size()+clear.size(); n++)
+    {
+      PetscInt row = n < src_rows.size() ? dst_rows[n] : clear[n-src_rows.size()];
+      PetscInt ncols = row_offset[n+1] - row_offset[n];
+      if( !ncols ) continue;
+      MatSetValues(mat, 1, &row, ncols, &row_cols[row_offset[n]], &row_vals[row_offset[n]], ADD_VALUES);
+    }
+
+    MatAssemblyBegin(mat, MAT_FINAL_ASSEMBLY);
+    MatAssemblyEnd(mat, MAT_FINAL_ASSEMBLY);
+
+    STOP_LOG("MatAddClearRow()", "PetscUtils");
+
     return 0;
   }
 
 
 
+
   /*-------------------------------------------------------------------
    * @brief add real DenseVector to PetscVec by dof_indices
    *
@@ -20,6 +20,7 @@
 
 
 // C++ includes
+#include <algorithm>
 
 
 // Local includes
@@ -47,7 +48,9 @@ const short int BoundaryInfo::invalid_id = -1234;
 //------------------------------------------------------
 // BoundaryInfo functions
 BoundaryInfo::BoundaryInfo(const MeshBase& m) :
-    _mesh (m)
+    _mesh (m),
+    _index_valid (false),
+    _index_min_id (0)
 {}
 
 
@@ -69,6 +72,160 @@ void BoundaryInfo::clear()
   _boundary_id_has_user_defined_label.clear();
   _boundary_ids_to_descriptions.clear();
   _extra_descriptions.clear();
+
+  _index_valid = false;
+  _index_slot.clear();
+  _index_node_offset.clear();
+  _index_nodes.clear();
+  _index_side_offset.clear();
+  _index_sides.clear();
+}
+
+
+
+size_t BoundaryInfo::memory_size() const
+{
+  // approx overhead of a tree node besides its value
+  const size_t tree_node = 4*sizeof(void *);
+
+  size_t counter = sizeof(*this);
+  counter += _boundary_node_id.size()*(sizeof(std::pair<const Node*, short int>) + tree_node);
+  counter += _boundary_side_id.size()*(sizeof(std::pair<const Elem*, std::pair<unsigned short int, short int> >) + tree_node);
+  counter += _index_slot.capacity()*sizeof(int);
+  counter += (_index_node_offset.capacity() + _index_side_offset.capacity())*sizeof(unsigned int);
+  counter += _index_nodes.capacity()*sizeof(const Node *);
+  counter += _index_sides.capacity()*sizeof(std::pair<const Elem *, unsigned int>);
+  return counter;
+}
+
+
+
+namespace {
+  // order the boundary nodes by their id
+  struct NodeIdLess
+  {
+    bool operator() (const Node *a, const Node *b) const
+    { return a->id() < b->id(); }
+  };
+}
+
+
+void BoundaryInfo::build_index() const
+{
+  START_LOG("build_index()", "BoundaryInfo");
+
+  _index_slot.clear();
+  _index_node_offset.clear();
+  _index_nodes.clear();
+  _index_side_offset.clear();
+  _index_sides.clear();
+
+  // the range of boundary ids
+  int min_id = 0, max_id = -1;
+  {
+    bool first = true;
+    std::map<const Node*, short int>::const_iterator node_it = _boundary_node_id.begin();
+    for(; node_it != _boundary_node_id.end(); ++node_it)
+    {
+      const int id = node_it->second;
+      if( first || id < min_id ) min_id = id;
+      if( first || id > max_id ) max_id = id;
+      first = false;
+    }
+    std::multimap<const Elem*, std::pair<unsigned short int, short int> >::const_iterator side_it = _boundary_side_id.begin();
+    for(; side_it != _boundary_side_id.end(); ++side_it)
+    {
+      const int id = side_it->second.second;
+      if( first || id < min_id ) min_id = id;
+      if( first || id > max_id ) max_id = id;
+      first = false;
+    }
+  }
+  _index_min_id = min_id;
+  _index_slot.resize(max_id - min_id + 1, -1);
+
+  // active sides, the sides of a refined element go to its active family
+  std::vector<int> side_slot;
+  std::vector<std::pair<const Elem *, unsigned int> > sides;
+  {
+    std::multimap<const Elem*, std::pair<unsigned short int, short int> >::const_iterator pos;
+    for (pos=_boundary_side_id.begin(); pos != _boundary_side_id.end(); ++pos)
+    {
+      const Elem * elem = pos->first;
+      const unsigned short int side = pos->second.first;
+      const int i = pos->second.second - min_id;
+
+      if (elem->active())
+      {
+        side_slot.push_back(i);
+        sides.push_back(std::make_pair(elem, static_cast<unsigned int>(side)));
+      }
+      else
+      {
+        std::vector<const Elem*> family;
+        elem->active_family_tree_by_side(family, side);
+        for(unsigned int n=0; n<family.size(); ++n)
+        {
+          side_slot.push_back(i);
+          sides.push_back(std::make_pair(family[n], static_cast<unsigned int>(side)));
+        }
+      }
+    }
+  }
+
+  // slots in the order of boundary id
+  std::vector<unsigned int> n_nodes, n_sides;
+  {
+    std::vector<bool> used(_index_slot.size(), false);
+    std::map<const Node*, short int>::const_iterator node_it = _boundary_node_id.begin();
+    for(; node_it != _boundary_node_id.end(); ++node_it)
+      used[node_it->second - min_id] = true;
+    for(unsigned int n=0; n<side_slot.size(); ++n)
+      used[side_slot[n]] = true;
+
+    int n_slot = 0;
+    for(unsigned int i=0; i<used.size(); ++i)
+      if( used[i] ) _index_slot[i] = n_slot++;
+
+    n_nodes.resize(n_slot, 0);
+    n_sides.resize(n_slot, 0);
+  }
+
+  // counting sort of the nodes and sides by slot
+  {
+    std::map<const Node*, short int>::const_iterator node_it = _boundary_node_id.begin();
+    for(; node_it != _boundary_node_id.end(); ++node_it)
+      n_nodes[_index_slot[node_it->second - min_id]]++;
+    for(unsigned int n=0; n<side_slot.size(); ++n)
+      n_sides[_index_slot[side_slot[n]]]++;
+
+    _index_node_offset.resize(n_nodes.size()+1, 0);
+    _index_side_offset.resize(n_sides.size()+1, 0);
+    for(unsigned int s=0; s<n_nodes.size(); ++s)
+    {
+      _index_node_offset[s+1] = _index_node_offset[s] + n_nodes[s];
+      _index_side_offset[s+1] = _index_side_offset[s] + n_sides[s];
+    }
+
+    std::vector<unsigned int> node_fill(_index_node_offset.begin(), _index_node_offset.end()-1);
+    std::vector<unsigned int> side_fill(_index_side_offset.begin(), _index_side_offset.end()-1);
+
+    _index_nodes.resize(_boundary_node_id.size());
+    for(node_it = _boundary_node_id.begin(); node_it != _boundary_node_id.end(); ++node_it)
+      _index_nodes[node_fill[_index_slot[node_it->second - min_id]]++] = node_it->first;
+
+    _index_sides.resize(sides.size());
+    for(unsigned int n=0; n<sides.size(); ++n)
+      _index_sides[side_fill[_index_slot[side_slot[n]]]++] = sides[n];
+  }
+
+  // nodes of each boundary in the order of node id
+  for(unsigned int s=0; s+1<_index_node_offset.size(); ++s)
+    std::sort(_index_nodes.begin() + _index_node_offset[s], _index_nodes.begin() + _index_node_offset[s+1], NodeIdLess());
+
+  _index_valid = true;
+
+  STOP_LOG("build_index()", "BoundaryInfo");
 }
 
 
@@ -227,6 +384,7 @@ void BoundaryInfo::add_node(const Node* node, const short int id)
 
   _boundary_node_id[node] = id;
   _boundary_ids.insert(id);
+  _index_valid = false;
 }
 
 
@@ -275,6 +433,7 @@ void BoundaryInfo::add_side(const Elem* elem,
 
   _boundary_side_id.insert(kv);
   _boundary_ids.insert(id);
+  _index_valid = false;
 
   // Possilby add the nodes of the side,
   // no matter they are already there.
@@ -325,6 +484,7 @@ void BoundaryInfo::boundary_side_nodes_with_id ( std::map<short int, std::set<co
 void BoundaryInfo::build_node_ids_from_priority_order(const std::map<short int, unsigned int> & order)
 {
   _boundary_node_id.clear();
+  _index_valid = false;
 
   std::multimap<const Elem*, std::pair<unsigned short int, short int> >::const_iterator pos;
 
@@ -382,6 +542,7 @@ void BoundaryInfo::remove (const Node* node)
 
   // Erase everything associated with node
   _boundary_node_id.erase (node);
+  _index_valid = false;
 
   // for efficency reason, we don't do it here.
   // please call rebuild_ids() after all the remove operator
@@ -398,6 +559,7 @@ void BoundaryInfo::remove (const Elem* elem)
 
   // Erase everything associated with elem
   _boundary_side_id.erase (elem);
+  _index_valid = false;
 
 
   // for efficency reason, we don't do it here.
@@ -430,6 +592,7 @@ void BoundaryInfo::remove (const Elem* elem, unsigned short int side)
   // erase here
   for(size_t n=0; n<its.size(); n++)
     _boundary_side_id.erase (its[n]);
+  _index_valid = false;
 
 
   // for efficency reason, we don't do it here.
@@ -664,19 +827,11 @@ void BoundaryInfo::build_on_processor_side_list (std::vector<unsigned int>&
 
 void BoundaryInfo::nodes_with_boundary_id (std::vector<unsigned int>& nl, short int boundary_id) const
 {
-  nl.clear();
-  // use set to reorder the nodes by their id
-  std::set<unsigned int> bd_node_set;
-
-  std::map<const Node*, short int>::const_iterator pos = _boundary_node_id.begin();
-  for (; pos != _boundary_node_id.end(); ++pos)
-  {
-    if( pos->second==boundary_id )
-      bd_node_set.insert(pos->first->id());
-  }
-
-  for(std::set<unsigned int>::iterator it=bd_node_set.begin(); it!=bd_node_set.end(); ++it)
-      nl.push_back(*it);
+  // the index keeps the nodes in the order of node id
+  const unsigned int n_nodes = this->n_nodes_with_boundary_id(boundary_id);
+  nl.resize(n_nodes);
+  for(unsigned int n=0; n<n_nodes; ++n)
+    nl[n] = this->node_with_boundary_id(boundary_id, n)->id();
 }
 
 
@@ -684,18 +839,11 @@ void BoundaryInfo::nodes_with_boundary_id (std::vector<unsigned int>& nl, short
 void BoundaryInfo::nodes_with_boundary_id (std::vector<const Node *>& nl, short int boundary_id) const
 {
   nl.clear();
-  // use map to reorder the nodes by their id
-  std::map<unsigned int, const Node *> bd_node_map;
-
-  std::map<const Node*, short int>::const_iterator pos = _boundary_node_id.begin();
-  for (; pos != _boundary_node_id.end(); ++pos)
-  {
-    if( pos->second==boundary_id )
-      bd_node_map[pos->first->id()] = pos->first;
-  }
+  const unsigned int n_nodes = this->n_nodes_with_boundary_id(boundary_id);
+  if( n_nodes == 0 ) return;
 
-  for(std::map<unsigned int, const Node *>::iterator it=bd_node_map.begin(); it!=bd_node_map.end(); ++it)
-    nl.push_back((*it).second);
+  const Node * const * begin = &_index_nodes[_index_node_offset[index_slot(boundary_id)]];
+  nl.assign(begin, begin + n_nodes);
 }
 
 
@@ -703,10 +851,14 @@ void BoundaryInfo::nodes_with_boundary_id ( std::map<short int, std::vector<cons
 {
   node_boundary_id_map.clear();
 
-  std::map<const Node*, short int>::const_iterator pos = _boundary_node_id.begin();
-  for (; pos != _boundary_node_id.end(); ++pos)
+  if (!_index_valid) build_index();
+  for(unsigned int i=0; i<_index_slot.size(); ++i)
   {
-    node_boundary_id_map[pos->second].push_back(pos->first);
+    const int slot = _index_slot[i];
+    if( slot < 0 || _index_node_offset[slot] == _index_node_offset[slot+1] ) continue;
+    const short int boundary_id = static_cast<short int>(i + _index_min_id);
+    node_boundary_id_map[boundary_id].assign(_index_nodes.begin() + _index_node_offset[slot],
+                                             _index_nodes.begin() + _index_node_offset[slot+1]);
   }
 }
 
@@ -745,43 +897,15 @@ void BoundaryInfo::node_in_regions ( std::map<const Node *, std::set<unsigned in
 
 void BoundaryInfo::active_elem_with_boundary_id (std::vector<const Elem *>& el, std::vector<unsigned int>& sl, short int boundary_id) const
 {
-  el.clear();
-  sl.clear();
-
-  std::multimap<const Elem*, std::pair<unsigned short int, short int> >::const_iterator pos;
-
-  for (pos=_boundary_side_id.begin(); pos != _boundary_side_id.end();
-       ++pos)
+  const unsigned int n_sides = this->n_active_sides_with_boundary_id(boundary_id);
+  el.resize(n_sides);
+  sl.resize(n_sides);
+  for(unsigned int n=0; n<n_sides; ++n)
   {
-    const Elem * elem = pos->first;
-    if (elem->active() )
-    {
-      if( pos->second.second == boundary_id )
-      {
-        el.push_back (pos->first);
-        sl.push_back (pos->second.first);
-      }
-    }
-    // this element has child
-    else
-    {
-      unsigned short int side = pos->second.first;
-      std::vector<const Elem*> family;
-
-      elem->active_family_tree_by_side(family, side);
-
-      for(unsigned int n=0; n<family.size(); ++n)
-      {
-        if( pos->second.second == boundary_id )
-        {
-          el.push_back (family[n]);
-          sl.push_back (side);
-        }
-      }
-
-    }
+    const std::pair<const Elem *, unsigned int> & side = this->active_side_with_boundary_id(boundary_id, n);
+    el[n] = side.first;
+    sl[n] = side.second;
   }
-
 }
 
 void BoundaryInfo::active_elem_with_boundary_id (
@@ -789,27 +913,14 @@ void BoundaryInfo::active_elem_with_boundary_id (
 {
   boundary_elem_side_map.clear();
 
-  std::multimap<const Elem*, std::pair<unsigned short int, short int> >::const_iterator pos;
-  for (pos=_boundary_side_id.begin(); pos != _boundary_side_id.end(); ++pos)
+  if (!_index_valid) build_index();
+  for(unsigned int i=0; i<_index_slot.size(); ++i)
   {
-    const Elem * elem = pos->first;
-    if (elem->active() )
-    {
-      boundary_elem_side_map[pos->second.second].push_back(std::make_pair(pos->first, pos->second.first));
-    }
-    // this element has child
-    else
-    {
-      unsigned short int side = pos->second.first;
-      std::vector<const Elem*> family;
-
-      elem->active_family_tree_by_side(family, side);
-
-      for(unsigned int n=0; n<family.size(); ++n)
-      {
-        boundary_elem_side_map[pos->second.second].push_back(std::make_pair(pos->first, pos->second.first));
-      }
-    }
+    const int slot = _index_slot[i];
+    if( slot < 0 || _index_side_offset[slot] == _index_side_offset[slot+1] ) continue;
+    const short int boundary_id = static_cast<short int>(i + _index_min_id);
+    boundary_elem_side_map[boundary_id].assign(_index_sides.begin() + _index_side_offset[slot],
+                                               _index_sides.begin() + _index_side_offset[slot+1]);
   }
 }
 
@@ -48,7 +48,8 @@ MeshBase::MeshBase (unsigned int d) :
     _mesh_dim       (0),
     _is_prepared    (false),
     _point_locator  (NULL),
-    _surface_locator(NULL)
+    _surface_locator(NULL),
+    _elem_ranges_valid(false)
 {
   assert (DIM <= 3);
   assert (DIM >= _dim);
@@ -65,7 +66,8 @@ MeshBase::MeshBase (const MeshBase& other_mesh) :
     _mesh_dim       (other_mesh._mesh_dim),
     _is_prepared    (other_mesh._is_prepared),
     _point_locator  (NULL),
-    _surface_locator(NULL)
+    _surface_locator(NULL),
+    _elem_ranges_valid(false)
 
 {}
 
@@ -109,6 +111,9 @@ void MeshBase::prepare_for_use (const bool skip_renumber_nodes_and_elements)
   this->clear_point_locator();
   this->clear_surface_locator();
 
+  // Element ranges with the new processor ids
+  this->build_elem_ranges();
+
   // The mesh is now prepared for use.
   _is_prepared = true;
 }
@@ -161,6 +166,13 @@ void MeshBase::clear ()
   // Reset the _is_prepared flag
   _is_prepared = false;
 
+  // Clear element ranges
+  this->clear_elem_ranges();
+  _active_elem_range.clear();
+  _active_this_pid_elem_range.clear();
+  _local_elem_range.clear();
+  _local_subdomain_elem_offset.clear();
+
   // Clear boundary information
   this->boundary_info->clear();
 
@@ -176,6 +188,8 @@ void MeshBase::clear ()
   _subdomain_materials.clear();
 
   _subdomain_weight.clear();
+
+  _subdomain_dof_weight.clear();
 }
 
 
@@ -294,6 +308,47 @@ std::ostream& operator << (std::ostream& os, const MeshBase& m)
 
 
 
+void MeshBase::build_elem_ranges () const
+{
+  _active_elem_range.clear();
+  _active_this_pid_elem_range.clear();
+  _local_elem_range.clear();
+
+  std::vector<unsigned int> n_local(_n_sbd+1, 0);
+
+  const_element_iterator       el  = this->elements_begin();
+  const const_element_iterator end = this->elements_end();
+  for (; el!=end; ++el)
+  {
+    Elem * elem = *el;
+    if (elem == NULL || !elem->active()) continue;
+
+    _active_elem_range.push_back(elem);
+    if (elem->on_processor())
+      _active_this_pid_elem_range.push_back(elem);
+    if (elem->on_local())
+    {
+      _local_elem_range.push_back(elem);
+      n_local[std::min(elem->subdomain_id(), _n_sbd)]++;
+    }
+  }
+
+  // counting sort of the local elements by subdomain, keeps the id order in each subdomain
+  _local_subdomain_elem_offset.assign(_n_sbd+2, 0);
+  for (unsigned int s=0; s<=_n_sbd; ++s)
+    _local_subdomain_elem_offset[s+1] = _local_subdomain_elem_offset[s] + n_local[s];
+
+  std::vector<unsigned int> fill(_local_subdomain_elem_offset.begin(), _local_subdomain_elem_offset.end()-1);
+  std::vector<Elem *> local(_local_elem_range.size());
+  for (unsigned int n=0; n<_local_elem_range.size(); ++n)
+    local[fill[std::min(_local_elem_range[n]->subdomain_id(), _n_sbd)]++] = _local_elem_range[n];
+  _local_elem_range.swap(local);
+
+  _elem_ranges_valid = true;
+}
+
+
+
 void MeshBase::partition (const unsigned int n_parts)
 {
   START_LOG("partition()", "Mesh");
@@ -312,6 +367,9 @@ void MeshBase::partition (const unsigned int n_parts)
   MetisPartitioner partitioner;
   partitioner.partition (*this, &cluster, n_parts);
 
+  // processor ids changed
+  this->clear_elem_ranges();
+
   STOP_LOG("partition()", "Mesh");
 }
 
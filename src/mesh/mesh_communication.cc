@@ -32,6 +32,7 @@
 #include "boundary_info.h"
 #include "mesh_communication.h"
 #include "parallel.h"
+#include "shared_array.h"
 #include "elem.h"
 #include "sphere.h"
 
@@ -46,6 +47,54 @@ namespace
   const unsigned int packed_elem_header_size = 4;
 #endif
 
+  /**
+   * append \p value as the zigzag varint of its difference to \p last.
+   * ids are numbered in order, the most entries take one byte.
+   */
+  inline void pack_delta (std::vector<unsigned char> &conn, int value, int &last)
+  {
+    const int d = static_cast<int>(static_cast<unsigned int>(value) - static_cast<unsigned int>(last));
+    unsigned int z = (static_cast<unsigned int>(d) << 1) ^ static_cast<unsigned int>(d >> 31);
+    last = value;
+    while (z >= 0x80)
+    {
+      conn.push_back(static_cast<unsigned char>(z | 0x80));
+      z >>= 7;
+    }
+    conn.push_back(static_cast<unsigned char>(z));
+  }
+
+  /**
+   * read the entry at \p cnt written by pack_delta()
+   */
+  inline int unpack_delta (const SharedArray<unsigned char> &conn, size_t &cnt, int &last)
+  {
+    unsigned int z = 0;
+    for (unsigned int shift=0; ; shift+=7)
+    {
+      const unsigned char b = conn[cnt++];
+      z |= static_cast<unsigned int>(b & 0x7f) << shift;
+      if (!(b & 0x80)) break;
+    }
+    const unsigned int d = (z >> 1) ^ (0u - (z & 1));
+    last = static_cast<int>(static_cast<unsigned int>(last) + d);
+    return last;
+  }
+
+  /**
+   * 64 bit FNV-1a hash of \p n bytes
+   */
+  inline unsigned long long hash_bytes (unsigned long long h, const void *data, size_t n)
+  {
+    const unsigned char *p = static_cast<const unsigned char *>(data);
+    for (size_t i=0; i<n; ++i)
+    {
+      h ^= p[i];
+      h *= 1099511628211ULL;
+    }
+    return h;
+  }
+
 }
 
 
@@ -151,81 +200,69 @@ void MeshCommunication::broadcast_mesh (MeshBase&) const
 
   START_LOG("broadcast_mesh()","MeshCommunication");
 
-  // Explicitly clear the mesh on all but processor 0.
-  if (Genius::processor_id() != 0)
-    mesh.clear();
-
   // broadcast magic number
   Parallel::broadcast (mesh.magic_num());
 
   // Get important sizes
   unsigned int n_nodes      = mesh.n_nodes();
   unsigned int n_elem       = mesh.n_elem();
-  unsigned int n_levels     = MeshTools::n_levels(mesh);
-  unsigned int total_weight = MeshTools::total_weight(mesh);
   unsigned int n_subdomains = mesh.n_subdomains ();
 
   // Broadcast the sizes
+  std::vector<unsigned int> buf (3);
+  if (Genius::processor_id() == 0)
   {
-    std::vector<unsigned int> buf (4);
-
-    if (Genius::processor_id() == 0)
-    {
-      buf[0] = n_nodes;
-      buf[1] = n_elem;
-      buf[2] = total_weight;
-      buf[3] = n_subdomains;
-    }
-    // Broadcast
-    Parallel::broadcast (buf);
-
-    if (Genius::processor_id() != 0)
-    {
-      n_nodes      = buf[0];
-      n_elem       = buf[1];
-      total_weight = buf[2];
-      mesh.set_n_subdomains () = buf[3];
-    }
+    buf[0] = n_nodes;
+    buf[1] = n_elem;
+    buf[2] = n_subdomains;
   }
+  Parallel::broadcast (buf);
 
+  // pts vector contains the spatial locations of all the nodes,
+  // conn vector contains the element types and the delta coded connectivity
+  std::vector<Real> pts;
+  std::vector<unsigned char> conn;
 
+  // the system may be rebuilt without changing the mesh. when all the processors
+  // hold the same serial mesh as processor 0, it is kept and nothing is sent.
+  bool mesh_present = (Genius::processor_id() == 0) ||
+                      (mesh.is_serial() && n_nodes == buf[0] && n_elem == buf[1] && n_subdomains == buf[2]);
+  Parallel::min(mesh_present);
 
-  // First build up the pts vector which contains
-  // the spatial locations of all the nodes
-  {
-    std::vector<Real> pts;
-
-    // If we are processor 0, we must populate this vector and
-    // broadcast it to the other processors.
-    if (Genius::processor_id() == 0)
-    {
-      pts.reserve (3*n_nodes);
+  if (Genius::processor_id() == 0 || mesh_present)
+    this->pack_mesh (mesh, pts, conn);
 
-      MeshBase::node_iterator       it     = mesh.nodes_begin();
-      const MeshBase::node_iterator it_end = mesh.nodes_end();
+  if (mesh_present)
+    mesh_present = Parallel::verify(this->mesh_checksum (mesh, pts, conn));
 
-      for (; it != it_end; ++it)
-      {
-        assert (*it != NULL);
-        assert ((*it)->id()*3 == pts.size());
-
-        const Point& p = **it;
+  if (mesh_present)
+  {
+    MESSAGE<<"Mesh is present on all the processors, skip the mesh transfer."<<std::endl;  RECORD();
+    mesh.set_serial(true);
+    STOP_LOG("broadcast_mesh()","MeshCommunication");
+    return;
+  }
 
-        pts.push_back ( p(0) ); // x
-        pts.push_back ( p(1) ); // y
-        pts.push_back ( p(2) ); // z
+  // Explicitly clear the mesh on all but processor 0.
+  if (Genius::processor_id() != 0)
+  {
+    mesh.clear();
+    n_nodes = buf[0];
+    n_elem  = buf[1];
+    mesh.set_n_subdomains () = buf[2];
+    std::vector<Real>().swap(pts);
+    std::vector<unsigned char>().swap(conn);
+  }
 
-      }
 
-    }
-    else
-      pts.resize (3*n_nodes);
+  // First distribute the nodes
+  {
+    // Broadcast the pts vector, it is kept once on each shared memory node
+    const SharedArray<Real> shared_pts(pts);
+    std::vector<Real>().swap(pts);
 
     // Sanity check for all processors
-    assert (pts.size() == (3*n_nodes));
-
-    // Broadcast the pts vector
-    Parallel::broadcast (pts);
+    assert (shared_pts.size() == (3*n_nodes));
 
     // Add the nodes we just received if we are not
     // processor 0.
@@ -233,11 +270,11 @@ void MeshCommunication::broadcast_mesh (MeshBase&) const
     {
       assert (mesh.n_nodes() == 0);
 
-      for (unsigned int i=0; i<pts.size(); i += 3)
+      for (unsigned int i=0; i<shared_pts.size(); i += 3)
       {
-        mesh.add_point (Point(pts[i+0],
-                              pts[i+1],
-                              pts[i+2]),
+        mesh.add_point (Point(shared_pts[i+0],
+                              shared_pts[i+1],
+                              shared_pts[i+2]),
                         i/3);
 
       }
@@ -247,51 +284,11 @@ void MeshCommunication::broadcast_mesh (MeshBase&) const
   } // Done distributing the nodes
 
 
-  // Now build up the elements vector which
-  // contains the element types and connectivity
+  // Now distribute the elements
   {
-    // The conn array contains the information needed to construct each element.
-    // Pack all this information into one communication to avoid two latency hits
-    // For each element it is of the form
-    // [ level p_level r_flag p_flag etype subdomain_id
-    //   self_ID parent_ID which_child node_0 node_1 ... node_n]
-    // We cannot use unsigned int because parent_ID can be negative
-    std::vector<int> conn;
-
-    // If we are processor 0, we must populate this vector and
-    // broadcast it to the other processors.
-    if (Genius::processor_id() == 0)
-    {
-      conn.reserve (packed_elem_header_size*n_elem + total_weight);
-
-      // We start from level 0. This is a bit simpler than in xdr_io.C
-      // because we do not have to worry about economizing by group elements
-      // of the same type. Element type is simply specified as an
-      // entry in the connectivity vector, "conn".
-      // By filling conn in order of levels, parents should exist before children
-      // are built when we reconstruct the elements on the other processors.
-
-      for (unsigned int level=0; level<=n_levels; ++level)
-      {
-        MeshBase::element_iterator it = mesh.level_elements_begin(level);
-        const MeshBase::element_iterator it_end = mesh.level_elements_end(level);
-
-        for (; it != it_end; ++it)
-        {
-          assert (*it);
-          const Elem* elem = *it;
-          pack_element (conn, elem);
-        }
-      }
-    }
-    else
-      conn.resize (packed_elem_header_size*n_elem + total_weight);
-
-    // Sanity check for all processors
-    assert (conn.size() == (packed_elem_header_size*n_elem + total_weight));
-
-    // Broadcast the element connectivity
-    Parallel::broadcast (conn);
+    // Broadcast the element connectivity, it is kept once on each shared memory node
+    const SharedArray<unsigned char> shared_conn(conn);
+    std::vector<unsigned char>().swap(conn);
 
     // Build the elements we just received if we are not
     // processor 0.
@@ -299,33 +296,41 @@ void MeshCommunication::broadcast_mesh (MeshBase&) const
     {
       assert (mesh.n_elem() == 0);
 
-      unsigned int cnt = 0;
+      size_t cnt = 0;
+
+      // the entries are coded as the difference to the previous element
+      std::vector<int> last(packed_elem_header_size+1, 0);
+      std::vector<int> header(packed_elem_header_size);
 
       // This map keeps track of elements we've previously added to the mesh
       // to avoid O(n) lookup times for parent pointers.
       std::map<unsigned int, Elem*> parents;
 
-      while (cnt < conn.size())
+      while (cnt < shared_conn.size())
       {
         // Declare the element that we will add
         Elem* elem = NULL;
 
         // Unpack the element header
+        for (unsigned int i=0; i<packed_elem_header_size; ++i)
+          header[i] = unpack_delta (shared_conn, cnt, last[i]);
+
+        unsigned int h = 0;
 #ifdef ENABLE_AMR
-        const int level             = conn[cnt++];
-        const int p_level           = conn[cnt++];
+        const int level             = header[h++];
+        const int p_level           = header[h++];
         const Elem::RefinementState refinement_flag =
-          static_cast<Elem::RefinementState>(conn[cnt++]);
+          static_cast<Elem::RefinementState>(header[h++]);
         const Elem::RefinementState p_refinement_flag =
-          static_cast<Elem::RefinementState>(conn[cnt++]);
+          static_cast<Elem::RefinementState>(header[h++]);
 #endif
-        const ElemType elem_type    = static_cast<ElemType>(conn[cnt++]);
-        const unsigned int elem_PID = conn[cnt++];
-        const int subdomain_ID      = conn[cnt++];
-        const int self_ID           = conn[cnt++];
+        const ElemType elem_type    = static_cast<ElemType>(header[h++]);
+        const unsigned int elem_PID = header[h++];
+        const int subdomain_ID      = header[h++];
+        const int self_ID           = header[h++];
 #ifdef ENABLE_AMR
-        const int parent_ID         = conn[cnt++];
-        const int which_child       = conn[cnt++];
+        const int parent_ID         = header[h++];
+        const int which_child       = header[h++];
 
         if (parent_ID != -1) // Do a log(n) search for the parent
         {
@@ -376,9 +381,9 @@ void MeshCommunication::broadcast_mesh (MeshBase&) const
         // Assign the connectivity
         for (unsigned int n=0; n<elem->n_nodes(); n++)
         {
-          assert (cnt < conn.size());
+          assert (cnt < shared_conn.size());
 
-          elem->set_node(n) = mesh.node_ptr (conn[cnt++]);
+          elem->set_node(n) = mesh.node_ptr (unpack_delta (shared_conn, cnt, last[packed_elem_header_size]));
         }
         elem->prepare_for_fvm();
       } // end while cnt < conn.size
@@ -479,46 +484,31 @@ void MeshCommunication::broadcast_bcs (MeshBase&,
     assert (el_id.size() == side_id.size());
     assert (el_id.size() == bc_id.size());
 
-    unsigned int n_bcs = el_id.size();
+    // Broadcast the element identities, the side ids for those elements
+    // and the bc ids for each side, they are kept once on each shared memory node
+    const SharedArray<unsigned int>       shared_el_id(el_id);
+    const SharedArray<unsigned short int> shared_side_id(side_id);
+    const SharedArray<short int>          shared_bc_id(bc_id);
 
-    // Broadcast the number of bcs to expect from processor 0.
-    Parallel::broadcast (n_bcs);
+    const unsigned int n_bcs = shared_el_id.size();
 
-    // Only continue if we have element BCs
-    if (n_bcs > 0)
-    {
-      // Allocate space. On CPU 0, these vectors should already have size n_bcs.
-      el_id.resize   (n_bcs);
-      side_id.resize (n_bcs);
-      bc_id.resize   (n_bcs);
-
-      // Broadcast the element identities
-      Parallel::broadcast (el_id);
-
-      // Broadcast the side ids for those elements
-      Parallel::broadcast (side_id);
-
-      // Broadcast the bc ids for each side
-      Parallel::broadcast (bc_id);
-
-      // Build the boundary_info structure if we aren't processor 0
-      if (Genius::processor_id() != 0)
-        for (unsigned int e=0; e<n_bcs; e++)
-        {
-          assert (el_id[e] < mesh.n_elem());
+    // Build the boundary_info structure if we aren't processor 0
+    if (Genius::processor_id() != 0)
+      for (unsigned int e=0; e<n_bcs; e++)
+      {
+        assert (shared_el_id[e] < mesh.n_elem());
 
-          const Elem* elem = mesh.elem(el_id[e]);
+        const Elem* elem = mesh.elem(shared_el_id[e]);
 
-          assert (elem != NULL);
+        assert (elem != NULL);
 
-          // sanity: be sure that the element returned by mesh.elem() really has id()==el_id[e]
-          genius_assert(elem->id() == el_id[e]);
+        // sanity: be sure that the element returned by mesh.elem() really has id()==el_id[e]
+        genius_assert(elem->id() == shared_el_id[e]);
 
-          assert (side_id[e] < elem->n_sides());
+        assert (shared_side_id[e] < elem->n_sides());
 
-          boundary_info.add_side (elem, side_id[e], bc_id[e]);
-        }
-    }
+        boundary_info.add_side (elem, shared_side_id[e], shared_bc_id[e]);
+      }
   }
 
 
@@ -576,40 +566,28 @@ void MeshCommunication::broadcast_bcs (MeshBase&,
 
     assert (node_id.size() == bc_id.size());
 
-    unsigned int n_bcs = node_id.size();
+    // Broadcast the node ids and the bc ids for each node,
+    // they are kept once on each shared memory node
+    const SharedArray<unsigned int> shared_node_id(node_id);
+    const SharedArray<short int>    shared_bc_id(bc_id);
 
-    // Broadcast the number of bcs to expect from processor 0.
-    Parallel::broadcast (n_bcs);
+    const unsigned int n_bcs = shared_node_id.size();
 
-    // Only continue if we have nodal BCs
-    if (n_bcs > 0)
-    {
-      // Allocate space, again on CPU 0 this should be a no-op.
-      node_id.resize (n_bcs);
-      bc_id.resize   (n_bcs);
-
-      // Broadcast the node ids
-      Parallel::broadcast (node_id);
-
-      // Broadcast the bc ids for each side
-      Parallel::broadcast (bc_id);
-
-      // Build the boundary_info structure if we aren't processor 0
-      if (Genius::processor_id() != 0)
-        for (unsigned int n=0; n<n_bcs; n++)
-        {
-          assert (node_id[n] < mesh.n_nodes());
+    // Build the boundary_info structure if we aren't processor 0
+    if (Genius::processor_id() != 0)
+      for (unsigned int n=0; n<n_bcs; n++)
+      {
+        assert (shared_node_id[n] < mesh.n_nodes());
 
-          const Node* node = mesh.node_ptr (node_id[n]);
+        const Node* node = mesh.node_ptr (shared_node_id[n]);
 
-          assert (node != NULL);
+        assert (node != NULL);
 
-          // sanity: be sure that the node returned by mesh.node_ptr() really has id()==node_id[n]
-          genius_assert(node->id() == node_id[n]);
+        // sanity: be sure that the node returned by mesh.node_ptr() really has id()==node_id[n]
+        genius_assert(node->id() == shared_node_id[n]);
 
-          boundary_info.add_node (node, bc_id[n]);
-        }
-    }
+        boundary_info.add_node (node, shared_bc_id[n]);
+      }
   }
 
   STOP_LOG("broadcast_bcs()","MeshCommunication");
@@ -627,36 +605,94 @@ void MeshCommunication::broadcast_bcs (MeshBase&,
 // For each element it is of the form
 // [ level p_level r_flag p_flag etype subdomain_id
 //   self_ID parent_ID which_child node_0 node_1 ... node_n]
-// We cannot use unsigned int because parent_ID can be negative
-void MeshCommunication::pack_element (std::vector<int> &conn, const Elem* elem) const
+// each entry is delta coded to the same entry of the previous element,
+// the nodes to the previous node. parent_ID can be negative
+void MeshCommunication::pack_element (std::vector<unsigned char> &conn, const Elem* elem, std::vector<int> &last) const
 {
   assert (elem != NULL);
+  assert (last.size() == packed_elem_header_size+1);
 
+  unsigned int h = 0;
 #ifdef ENABLE_AMR
-  conn.push_back (static_cast<int>(elem->level()));
-  conn.push_back (static_cast<int>(elem->p_level()));
-  conn.push_back (static_cast<int>(elem->refinement_flag()));
-  conn.push_back (static_cast<int>(elem->p_refinement_flag()));
+  pack_delta (conn, static_cast<int>(elem->level()), last[h++]);
+  pack_delta (conn, static_cast<int>(elem->p_level()), last[h++]);
+  pack_delta (conn, static_cast<int>(elem->refinement_flag()), last[h++]);
+  pack_delta (conn, static_cast<int>(elem->p_refinement_flag()), last[h++]);
 #endif
-  conn.push_back (static_cast<int>(elem->type()));
-  conn.push_back (static_cast<int>(elem->processor_id()));
-  conn.push_back (static_cast<int>(elem->subdomain_id()));
-  conn.push_back (elem->id());
+  pack_delta (conn, static_cast<int>(elem->type()), last[h++]);
+  pack_delta (conn, static_cast<int>(elem->processor_id()), last[h++]);
+  pack_delta (conn, static_cast<int>(elem->subdomain_id()), last[h++]);
+  pack_delta (conn, static_cast<int>(elem->id()), last[h++]);
 
 #ifdef ENABLE_AMR
   // use parent_ID of -1 to indicate a level 0 element
   if (elem->level() == 0)
   {
-    conn.push_back(-1);
-    conn.push_back(-1);
+    pack_delta (conn, -1, last[h++]);
+    pack_delta (conn, -1, last[h++]);
   }
   else
   {
-    conn.push_back(elem->parent()->id());
-    conn.push_back(elem->parent()->which_child_am_i(elem));
+    pack_delta (conn, static_cast<int>(elem->parent()->id()), last[h++]);
+    pack_delta (conn, static_cast<int>(elem->parent()->which_child_am_i(elem)), last[h++]);
   }
 #endif
 
   for (unsigned int n=0; n<elem->n_nodes(); n++)
-    conn.push_back (elem->node(n));
+    pack_delta (conn, static_cast<int>(elem->node(n)), last[packed_elem_header_size]);
+}
+
+
+
+void MeshCommunication::pack_mesh (const MeshBase& mesh, std::vector<Real> &pts, std::vector<unsigned char> &conn) const
+{
+  pts.reserve (3*mesh.n_nodes());
+
+  MeshBase::const_node_iterator       nd     = mesh.nodes_begin();
+  const MeshBase::const_node_iterator nd_end = mesh.nodes_end();
+  for (; nd != nd_end; ++nd)
+  {
+    assert (*nd != NULL);
+    assert ((*nd)->id()*3 == pts.size());
+
+    const Point& p = **nd;
+    pts.push_back ( p(0) ); // x
+    pts.push_back ( p(1) ); // y
+    pts.push_back ( p(2) ); // z
+  }
+
+  // By filling conn in order of levels, parents should exist before children
+  // are built when we reconstruct the elements on the other processors.
+  std::vector<int> last(packed_elem_header_size+1, 0);
+  const unsigned int n_levels = MeshTools::n_levels(mesh);
+  for (unsigned int level=0; level<=n_levels; ++level)
+  {
+    MeshBase::const_element_iterator it = mesh.level_elements_begin(level);
+    const MeshBase::const_element_iterator it_end = mesh.level_elements_end(level);
+    for (; it != it_end; ++it)
+    {
+      assert (*it);
+      pack_element (conn, *it, last);
+    }
+  }
+}
+
+
+
+unsigned long long MeshCommunication::mesh_checksum (const MeshBase& mesh, const std::vector<Real> &pts, const std::vector<unsigned char> &conn) const
+{
+  unsigned long long h = 14695981039346656037ULL;
+  if (!pts.empty())
+    h = hash_bytes (h, &pts[0], pts.size()*sizeof(Real));
+  if (!conn.empty())
+    h = hash_bytes (h, &conn[0], conn.size());
+
+  for (unsigned int n_sub = 0; n_sub < mesh.n_subdomains (); n_sub++)
+  {
+    const std::string & label = mesh.subdomain_label_by_id(n_sub);
+    const std::string material = mesh.subdomain_material(n_sub);
+    h = hash_bytes (h, label.c_str(), label.size()+1);
+    h = hash_bytes (h, material.c_str(), material.size()+1);
+  }
+  return h;
 }
@@ -1164,6 +1164,13 @@ bool MeshRefinement::_coarsen_elements ()
 
   STOP_LOG ("_coarsen_elements()", "MeshRefinement");
 
+  // the active sides of the boundaries and the active elements changed
+  if (mesh_changed)
+  {
+    _mesh.boundary_info->invalidate_index();
+    _mesh.clear_elem_ranges();
+  }
+
   return mesh_changed;
 }
 
@@ -1227,6 +1234,13 @@ bool MeshRefinement::_refine_elements ()
 
   STOP_LOG ("_refine_elements()", "MeshRefinement");
 
+  // the active sides of the boundaries and the active elements changed
+  if (mesh_changed)
+  {
+    _mesh.boundary_info->invalidate_index();
+    _mesh.clear_elem_ranges();
+  }
+
   return mesh_changed;
 }
 
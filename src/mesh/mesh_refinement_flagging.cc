@@ -34,6 +34,7 @@
 #include "mesh_refinement.h"
 #include "mesh_base.h"
 #include "elem.h"
+#include "parallel.h"
 
 
 
@@ -676,4 +677,226 @@ void MeshRefinement::clean_refinement_flags ()
     }
 }
 
+//-----------------------------------------------------------------
+// Parallel flagging methods
+
+// count the values no less than v over all the processors
+static unsigned int parallel_count_no_less(const std::vector<Real>& values, const Real v)
+{
+  unsigned int count = 0;
+  for (unsigned int i=0; i<values.size(); ++i)
+    if (values[i] >= v) ++count;
+  Parallel::sum(count);
+  return count;
+}
+
+
+
+Real MeshRefinement::parallel_kth_largest (const std::vector<Real>& values, const unsigned int k)
+{
+  Real lo =  1.e30;
+  Real hi = -1.e30;
+  for (unsigned int i=0; i<values.size(); ++i)
+    {
+      lo = std::min(lo, values[i]);
+      hi = std::max(hi, values[i]);
+    }
+  Parallel::min(lo);
+  Parallel::max(hi);
+
+  if (k == 0 || parallel_count_no_less(values, hi) >= k)
+    return hi;
+
+  // bisection, keep count(>=lo) >= k and count(>=hi) < k
+  for (unsigned int it=0; it<128; ++it)
+    {
+      const Real mid = 0.5*(lo + hi);
+      if (mid <= lo || mid >= hi) break;
+      if (parallel_count_no_less(values, mid) >= k)
+        lo = mid;
+      else
+        hi = mid;
+    }
+
+  // the k-th largest value is the smallest one in [lo, hi)
+  Real kth = hi;
+  for (unsigned int i=0; i<values.size(); ++i)
+    if (values[i] >= lo && values[i] < kth)
+      kth = values[i];
+  Parallel::min(kth);
+
+  return kth;
+}
+
+
+
+void MeshRefinement::sync_refinement_flags ()
+{
+  // flag+1 of the elements owned by this processor, 0 for others
+  std::vector<int> flags (_mesh.max_elem_id(), 0);
+
+  MeshBase::element_iterator       elem_it  = _mesh.active_this_pid_elements_begin();
+  const MeshBase::element_iterator elem_end = _mesh.active_this_pid_elements_end();
+  for (; elem_it != elem_end; ++elem_it)
+    flags[(*elem_it)->id()] = static_cast<int>((*elem_it)->refinement_flag()) + 1;
+
+  Parallel::max(flags);
+
+  MeshBase::element_iterator       it  = _mesh.active_elements_begin();
+  const MeshBase::element_iterator end = _mesh.active_elements_end();
+  for (; it != end; ++it)
+    if (flags[(*it)->id()] > 0)
+      (*it)->set_refinement_flag(static_cast<Elem::RefinementState>(flags[(*it)->id()] - 1));
+}
+
+
+
+void MeshRefinement::flag_local_elements_by_error_fraction (const ErrorVector& error_per_cell,
+							    const Real refine_frac,
+							    const Real coarsen_frac,
+							    const unsigned int max_l)
+{
+  if (!_use_member_parameters)
+  {
+    _refine_fraction = refine_frac;
+    _coarsen_fraction = coarsen_frac;
+    _max_h_level = max_l;
+  }
+
+  assert (_refine_fraction  >= 0. && _refine_fraction  <= 1.);
+  assert (_coarsen_fraction >= 0. && _coarsen_fraction <= 1.);
+  genius_assert (!_coarsen_by_parents);
+
+  this->clean_refinement_flags();
+
+  // the minimum and maximum error values of all the active elements
+  Real error_min = 1.e30;
+  Real error_max = 0.;
+
+  MeshBase::element_iterator       elem_it  = _mesh.active_this_pid_elements_begin();
+  const MeshBase::element_iterator elem_end = _mesh.active_this_pid_elements_end();
+  for (; elem_it != elem_end; ++elem_it)
+  {
+    const unsigned int id  = (*elem_it)->id();
+    assert (id < error_per_cell.size());
+
+    error_max = std::max (error_max, static_cast<Real>(error_per_cell[id]));
+    error_min = std::min (error_min, static_cast<Real>(error_per_cell[id]));
+  }
+  Parallel::max(error_max);
+  Parallel::min(error_min);
+
+  const Real error_delta    = (error_max - error_min);
+  const Real refine_cutoff  = (1.0 - _refine_fraction)*error_max;
+  const Real coarsen_cutoff = _coarsen_fraction*error_delta + error_min;
+
+  elem_it  = _mesh.active_this_pid_elements_begin();
+  for (; elem_it != elem_end; ++elem_it)
+  {
+    Elem* elem             = *elem_it;
+    const float elem_error = error_per_cell[elem->id()];
+
+    if (elem_error <= coarsen_cutoff)
+      elem->set_refinement_flag(Elem::COARSEN);
+
+    if (elem_error >= refine_cutoff)
+      if (elem->level() < _max_h_level)
+	elem->set_refinement_flag(Elem::REFINE);
+  }
+
+  this->sync_refinement_flags();
+}
+
+
+
+void MeshRefinement::flag_local_elements_by_elem_fraction (const ErrorVector& error_per_cell,
+							   const Real refine_frac,
+							   const Real coarsen_frac,
+							   const unsigned int max_l)
+{
+  if (!_use_member_parameters)
+  {
+    _refine_fraction = refine_frac;
+    _coarsen_fraction = coarsen_frac;
+    _max_h_level = max_l;
+  }
+
+  assert (_refine_fraction  >= 0. && _refine_fraction  <= 1.);
+  assert (_coarsen_fraction >= 0. && _coarsen_fraction <= 1.);
+  genius_assert (!_coarsen_by_parents);
+
+  // The number of active elements in the mesh
+  const unsigned int n_active_elem  = _mesh.n_elem();
+
+  // The number of elements to flag for coarsening and refinement
+  const unsigned int n_elem_coarsen = static_cast<unsigned int>(_coarsen_fraction * n_active_elem);
+  const unsigned int n_elem_refine  = static_cast<unsigned int>(_refine_fraction  * n_active_elem);
+
+  this->clean_refinement_flags();
+
+  // the error of local active elements, and its negative for searching the bottom elements
+  std::vector<Real> local_error, local_neg_error;
+  MeshBase::element_iterator       elem_it  = _mesh.active_this_pid_elements_begin();
+  const MeshBase::element_iterator elem_end = _mesh.active_this_pid_elements_end();
+  for (; elem_it != elem_end; ++elem_it)
+  {
+    local_error.push_back(error_per_cell[(*elem_it)->id()]);
+    local_neg_error.push_back(-local_error.back());
+  }
+
+  // the same elements as selected by flag_elements_by_elem_fraction
+  Real top_error = 0., bottom_error = 0.;
+  if (n_elem_coarsen)
+    bottom_error = -parallel_kth_largest(local_neg_error, n_elem_coarsen);
+  if (n_elem_refine)
+    top_error = parallel_kth_largest(local_error, n_elem_refine - 1);
+
+  elem_it  = _mesh.active_this_pid_elements_begin();
+  for (; elem_it != elem_end; ++elem_it)
+  {
+    Elem* elem = *elem_it;
+
+    if (n_elem_coarsen && error_per_cell[elem->id()] <= bottom_error)
+      elem->set_refinement_flag(Elem::COARSEN);
+
+    if (n_elem_refine && elem->level() < _max_h_level &&
+        error_per_cell[elem->id()] >= top_error)
+      elem->set_refinement_flag(Elem::REFINE);
+  }
+
+  this->sync_refinement_flags();
+}
+
+
+
+void MeshRefinement::flag_local_elements_by_error_threshold (const ErrorVector& error_per_cell,
+							     const Real refine_threshold,
+							     const Real coarsen_threshold,
+							     const unsigned int max_level)
+{
+  if (!_use_member_parameters)
+  {
+     _max_h_level = max_level;
+  }
+
+  genius_assert (!_coarsen_by_parents);
+
+  MeshBase::element_iterator       elem_it  = _mesh.active_this_pid_elements_begin();
+  const MeshBase::element_iterator elem_end = _mesh.active_this_pid_elements_end();
+  for (; elem_it != elem_end; ++elem_it)
+  {
+    Elem* elem = *elem_it;
+    const float elem_error = error_per_cell[elem->id()];
+
+    if (elem_error > refine_threshold && elem->level() < _max_h_level)
+      elem->set_refinement_flag(Elem::REFINE);
+
+    if (elem_error < coarsen_threshold)
+      elem->set_refinement_flag(Elem::COARSEN);
+  }
+
+  this->sync_refinement_flags();
+}
+
+
 #endif
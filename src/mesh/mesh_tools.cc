@@ -21,12 +21,15 @@
 
 // C++ includes
 #include <set>
+#include <algorithm>
+#include <cmath>
 
 // Local includes
 #include "mesh_tools.h"
 #include "mesh_base.h"
 #include "elem.h"
 #include "sphere.h"
+#include "parallel.h"
 
 
 
@@ -115,6 +118,182 @@ void MeshTools::find_boundary_nodes (const MeshBase& mesh,
 
 
 
+void MeshTools::node_bandwidth (const MeshBase& mesh, unsigned int & bandwidth, double & profile)
+{
+  // the lowest node id coupled with each node
+  std::vector<unsigned int> lowest(mesh.max_node_id(), invalid_uint);
+
+  MeshBase::const_element_iterator       el  = mesh.active_elements_begin();
+  const MeshBase::const_element_iterator end = mesh.active_elements_end();
+  for (; el != end; ++el)
+  {
+    const Elem* elem = *el;
+
+    unsigned int min_id = elem->node(0);
+    for (unsigned int n=1; n<elem->n_nodes(); n++)
+      min_id = std::min(min_id, elem->node(n));
+
+    for (unsigned int n=0; n<elem->n_nodes(); n++)
+      lowest[elem->node(n)] = std::min(lowest[elem->node(n)], min_id);
+  }
+
+  bandwidth = 0;
+  profile = 0.0;
+  for (unsigned int i=0; i<lowest.size(); i++)
+  {
+    if (lowest[i] == invalid_uint) continue;
+    bandwidth = std::max(bandwidth, i - lowest[i]);
+    profile += i - lowest[i];
+  }
+}
+
+
+
+namespace {
+
+  /**
+   * accumulate corner angles of a face (2D element or side of a 3D element), in degree
+   */
+  void face_angles(const Elem * face, Real & min_angle, Real & max_angle)
+  {
+    const unsigned int nv = face->n_vertices();
+    for (unsigned int v=0; v<nv; v++)
+    {
+      const Point & p  = face->point(v);
+      const Point & p1 = face->point((v+nv-1)%nv);
+      const Point & p2 = face->point((v+1)%nv);
+      Real c = (p1-p).cos_angle(p2-p);
+      c = std::max(-1.0, std::min(1.0, c));
+      const Real angle = std::acos(c)*180.0/3.14159265358979323846;
+      min_angle = std::min(min_angle, angle);
+      max_angle = std::max(max_angle, angle);
+    }
+  }
+
+}
+
+
+void MeshTools::elem_quality (const MeshBase& mesh, ElemQualityStatistics & stat)
+{
+  // thread parallel loop needs random access
+  std::vector<const Elem *> elems;
+  {
+    MeshBase::const_element_iterator       el  = mesh.active_this_pid_elements_begin();
+    const MeshBase::const_element_iterator end = mesh.active_this_pid_elements_end();
+    for (; el != end; ++el)
+      elems.push_back(*el);
+  }
+
+  stat.n_elem = elems.size();
+  stat.aspect_ratio_min = 1e30;
+  stat.aspect_ratio_max = 0.0;
+  stat.aspect_ratio_mean = 0.0;
+  stat.min_angle = 180.0;
+  stat.max_angle = 0.0;
+  stat.hmin = 1e30;
+  stat.hmax = 0.0;
+  stat.n_inverted = 0;
+  stat.n_obtuse = 0;
+  stat.n_negative_cv = 0;
+
+  const int n_elems = static_cast<int>(elems.size());
+
+#ifdef HAVE_OPENMP
+  #pragma omp parallel
+#endif
+  {
+    // thread local accumulation
+    Real ar_min = 1e30, ar_max = 0.0, ar_sum = 0.0;
+    Real min_angle = 180.0, max_angle = 0.0;
+    Real hmin = 1e30, hmax = 0.0;
+    unsigned int n_inverted = 0, n_obtuse = 0, n_negative_cv = 0;
+
+#ifdef HAVE_OPENMP
+    #pragma omp for schedule(static)
+#endif
+    for (int i=0; i<n_elems; ++i)
+    {
+      const Elem * elem = elems[i];
+
+      // edge length ratio
+      Real lmin = 1e30, lmax = 0.0;
+      for (unsigned int e=0; e<elem->n_edges(); e++)
+      {
+        std::pair<unsigned int, unsigned int> edge_nodes;
+        elem->nodes_on_edge(e, edge_nodes);
+        const Real l = (elem->point(edge_nodes.first) - elem->point(edge_nodes.second)).size();
+        lmin = std::min(lmin, l);
+        lmax = std::max(lmax, l);
+      }
+      const Real ar = lmin > 0.0 ? lmax/lmin : 1e30;
+      ar_min = std::min(ar_min, ar);
+      ar_max = std::max(ar_max, ar);
+      ar_sum += ar;
+
+      hmin = std::min(hmin, lmin);
+      hmax = std::max(hmax, lmax);
+
+      // corner angles
+      Real elem_min_angle = 180.0, elem_max_angle = 0.0;
+      if (elem->dim() == 2)
+        face_angles(elem, elem_min_angle, elem_max_angle);
+      else if (elem->dim() == 3)
+      {
+        for (unsigned int s=0; s<elem->n_sides(); s++)
+        {
+          AutoPtr<Elem> side = elem->build_side(s);
+          face_angles(side.get(), elem_min_angle, elem_max_angle);
+        }
+      }
+      min_angle = std::min(min_angle, elem_min_angle);
+      max_angle = std::max(max_angle, elem_max_angle);
+      if (elem_max_angle > 90.0) n_obtuse++;
+
+      if (elem->dim() > 1 && elem->volume() <= 0.0) n_inverted++;
+
+      // negative partial CV area, only FVM elements have it
+      if (elem->dim() > 1)
+        for (unsigned int e=0; e<elem->n_edges(); e++)
+          if (elem->partial_area_with_edge(e) < 0.0)
+          { n_negative_cv++; break; }
+    }
+
+#ifdef HAVE_OPENMP
+    #pragma omp critical
+#endif
+    {
+      stat.aspect_ratio_min = std::min(stat.aspect_ratio_min, ar_min);
+      stat.aspect_ratio_max = std::max(stat.aspect_ratio_max, ar_max);
+      stat.aspect_ratio_mean += ar_sum;
+      stat.min_angle = std::min(stat.min_angle, min_angle);
+      stat.max_angle = std::max(stat.max_angle, max_angle);
+      stat.hmin = std::min(stat.hmin, hmin);
+      stat.hmax = std::max(stat.hmax, hmax);
+      stat.n_inverted += n_inverted;
+      stat.n_obtuse += n_obtuse;
+      stat.n_negative_cv += n_negative_cv;
+    }
+  }
+
+  // reduce over all the processors
+  Parallel::sum(stat.n_elem);
+  Parallel::min(stat.aspect_ratio_min);
+  Parallel::max(stat.aspect_ratio_max);
+  Parallel::sum(stat.aspect_ratio_mean);
+  Parallel::min(stat.min_angle);
+  Parallel::max(stat.max_angle);
+  Parallel::min(stat.hmin);
+  Parallel::max(stat.hmax);
+  Parallel::sum(stat.n_inverted);
+  Parallel::sum(stat.n_obtuse);
+  Parallel::sum(stat.n_negative_cv);
+
+  if (stat.n_elem)
+    stat.aspect_ratio_mean /= stat.n_elem;
+}
+
+
+
 MeshTools::BoundingBox MeshTools::bounding_box(const MeshBase& mesh)
 {
   // processor bounding box with no arguments
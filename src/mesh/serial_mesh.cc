@@ -28,6 +28,7 @@
 #include "serial_mesh.h"
 #include "mesh_tools.h"
 #include "parallel.h"
+#include "space_filling_curve.h"
 
 // ------------------------------------------------------------
 // SerialMesh class member functions
@@ -132,6 +133,7 @@ Elem* SerialMesh::add_elem (Elem* e)
     e->set_id (_elements.size());
 
   _elements.push_back(e);
+  this->clear_elem_ranges();
 
   return e;
 }
@@ -145,6 +147,7 @@ Elem* SerialMesh::add_elem (Elem* e, unsigned int id)
 
   genius_assert(id < _elements.size());
   _elements[id] = e;
+  this->clear_elem_ranges();
 
   return e;
 }
@@ -163,6 +166,7 @@ Elem* SerialMesh::insert_elem (Elem* e)
   }
 
   _elements[e->id()] = e;
+  this->clear_elem_ranges();
 
   return e;
 }
@@ -207,6 +211,7 @@ void SerialMesh::delete_elem(Elem* e)
 
   // explicitly NULL the pointer
   *pos = NULL;
+  this->clear_elem_ranges();
 }
 
 
@@ -312,7 +317,16 @@ void SerialMesh::delete_node(Node* n)
 
 
 
-void SerialMesh::reorder_elems()
+namespace {
+  // compare elem by degree only, keep the BFS order for elems with same degree
+  struct DegreeLess
+  {
+    bool operator()(const std::pair<unsigned int, const Elem *> &a, const std::pair<unsigned int, const Elem *> &b) const
+    { return a.first < b.first; }
+  };
+}
+
+void SerialMesh::reorder_elems(ElemOrdering ordering)
 {
   START_LOG("reorder_elems()", "Mesh");
 
@@ -320,44 +334,82 @@ void SerialMesh::reorder_elems()
   assert(_is_serial);
 
   {
-    const Elem * elem_begin = _elements[0];
-    for(unsigned int n=0; n<_elements.size(); ++n)
-      if( _elements[n]->centroid().all_less(elem_begin->centroid()) )
-        elem_begin = _elements[n];
-
-    // the visited flag array
-    std::vector<bool> visit_flag(n_elem(), false);
-    unsigned int new_index = 0;
-    // a queue for Breadth-First Search
-    std::queue<const Elem *> Q;
     std::vector<unsigned int> new_order(n_elem(), invalid_uint);
 
-    // do Breadth-First Search
-    // begin at this node.
-    visit_flag[elem_begin->id()] = true;
-    Q.push( elem_begin );
-
-    while(!Q.empty())
+    if( ordering == MORTON_ORDER )
+    {
+      // sort elem centroids along Morton curve
+      std::vector<Point> centroids(_elements.size());
+      for(unsigned int n=0; n<_elements.size(); ++n)
+        centroids[n] = _elements[n]->centroid();
+
+      std::vector<unsigned int> order;
+      SpaceFillingCurve::morton_order(centroids, order);
+      for(unsigned int n=0; n<order.size(); ++n)
+        new_order[_elements[order[n]]->id()] = n;
+    }
+    else
     {
-      const Elem * current = Q.front();
-      Q.pop();
-      new_order[current->id()] = new_index++;
-
-      // here just use a simple neighbor search method.
-      // the neighbor is in arbitrary ordered.
-      // however, one may use other nodal reordering
-      // i.e. sort neighbor nodes by Degree of the neighboring nodes,
-      // Physical distance of the neighboring nodes to current node
-      // or even the solution based sort
-      for(unsigned int e=0; e<current->n_neighbors(); ++e)
+      // the visited flag array
+      std::vector<bool> visit_flag(n_elem(), false);
+      unsigned int new_index = 0;
+      // a queue for Breadth-First Search
+      std::queue<const Elem *> Q;
+
+      // the degree (number of neighbors) of elem, used by Cuthill-McKee
+      std::vector<unsigned int> degree(n_elem(), 0);
+      for(unsigned int n=0; n<_elements.size(); ++n)
+        for(unsigned int e=0; e<_elements[n]->n_neighbors(); ++e)
+          if(_elements[n]->neighbor(e)) degree[_elements[n]->id()]++;
+
+      // the mesh may have several disconnected parts, start a new search for each part
+      while( new_index < n_elem() )
       {
-        const Elem * neighbor = current->neighbor(e);
-        if(neighbor && !visit_flag[neighbor->id()] )
+        // begin at the lower left corner of unvisited elems.
+        const Elem * elem_begin = NULL;
+        for(unsigned int n=0; n<_elements.size(); ++n)
         {
-          Q.push(neighbor);
-          visit_flag[neighbor->id()] = true;
+          if( visit_flag[_elements[n]->id()] ) continue;
+          if( elem_begin == NULL || _elements[n]->centroid().all_less(elem_begin->centroid()) )
+            elem_begin = _elements[n];
+        }
+
+        // do Breadth-First Search
+        visit_flag[elem_begin->id()] = true;
+        Q.push( elem_begin );
+
+        while(!Q.empty())
+        {
+          const Elem * current = Q.front();
+          Q.pop();
+          new_order[current->id()] = new_index++;
+
+          // collect unvisited neighbors.
+          // for BFS ordering, the neighbor is in arbitrary ordered.
+          // Cuthill-McKee visits neighbors with lower degree first
+          std::vector<std::pair<unsigned int, const Elem *> > neighbors;
+          for(unsigned int e=0; e<current->n_neighbors(); ++e)
+          {
+            const Elem * neighbor = current->neighbor(e);
+            if(neighbor && !visit_flag[neighbor->id()] )
+            {
+              neighbors.push_back(std::make_pair(degree[neighbor->id()], neighbor));
+              visit_flag[neighbor->id()] = true;
+            }
+          }
+
+          if( ordering == RCM_ORDER )
+            std::stable_sort(neighbors.begin(), neighbors.end(), DegreeLess());
+
+          for(unsigned int e=0; e<neighbors.size(); ++e)
+            Q.push(neighbors[e].second);
         }
       }
+
+      // reverse the Cuthill-McKee ordering
+      if( ordering == RCM_ORDER )
+        for(unsigned int n=0; n<new_order.size(); ++n)
+          new_order[n] = n_elem() - 1 - new_order[n];
     }
 
     // ok, assign ordered index to each elem
@@ -573,6 +625,9 @@ void SerialMesh::renumber_nodes_and_elements ()
 
   START_LOG("renumber_nodes_and_elem()", "Mesh");
 
+  // ids and the element vector change
+  this->clear_elem_ranges();
+
   assert(_is_serial);
 
   // node and element id counters
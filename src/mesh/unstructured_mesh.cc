@@ -554,6 +554,9 @@ bool UnstructuredMesh::convert_to_fvm_mesh (std::string &error)
 {
   genius_assert(this->_is_prepared);
 
+  // the new FVM elements, their geometry information is built after the conversion
+  std::vector<Elem *> fvm_elems;
+
   // here we convert all the active FEM element to FVM element, maybe only element belongs to local
   // procesor needs to be converted.
   const_element_iterator endit = local_elements_end();
@@ -614,9 +617,9 @@ bool UnstructuredMesh::convert_to_fvm_mesh (std::string &error)
       fvm_elem->set_node(v) = fem_elem->get_node(v);
 
     /*
-     * build cell's geometry information for FVM usage
+     * cell's geometry information for FVM usage is built later
      */
-    fvm_elem->prepare_for_fvm();
+    fvm_elems.push_back(fvm_elem);
 
     /*
      * set the subdomain id
@@ -674,6 +677,15 @@ bool UnstructuredMesh::convert_to_fvm_mesh (std::string &error)
   }
 
 
+  // build cell's geometry information for FVM usage.
+  // each element only reads its own nodes, so it can be done in parallel
+  const int n_fvm_elems = static_cast<int>(fvm_elems.size());
+#ifdef HAVE_OPENMP
+  #pragma omp parallel for schedule(static)
+#endif
+  for (int i=0; i<n_fvm_elems; ++i)
+    fvm_elems[i]->prepare_for_fvm();
+
   return true;
 }
 
@@ -684,6 +696,9 @@ bool UnstructuredMesh::convert_to_cylindrical_fvm_mesh (std::string &error)
 {
   genius_assert(this->_is_prepared);
 
+  // the new FVM elements, their geometry information is built after the conversion
+  std::vector<Elem *> fvm_elems;
+
   // here we convert all the active FEM element to FVM element, maybe only element belongs to local
   // procesor needs to be converted.
   const_element_iterator endit = local_elements_end();
@@ -763,9 +778,9 @@ bool UnstructuredMesh::convert_to_cylindrical_fvm_mesh (std::string &error)
       fvm_elem->set_node(v) = fem_elem->get_node(v);
 
     /*
-     * build cell's geometry information for FVM usage
+     * cell's geometry information for FVM usage is built later
      */
-    fvm_elem->prepare_for_fvm();
+    fvm_elems.push_back(fvm_elem);
 
     /*
      * set the subdomain id
@@ -822,6 +837,15 @@ bool UnstructuredMesh::convert_to_cylindrical_fvm_mesh (std::string &error)
 
   }
 
+  // build cell's geometry information for FVM usage.
+  // each element only reads its own nodes, so it can be done in parallel
+  const int n_fvm_elems = static_cast<int>(fvm_elems.size());
+#ifdef HAVE_OPENMP
+  #pragma omp parallel for schedule(static)
+#endif
+  for (int i=0; i<n_fvm_elems; ++i)
+    fvm_elems[i]->prepare_for_fvm();
+
   return true;
 }
 
@@ -964,7 +988,6 @@ void UnstructuredMesh::create_submesh (UnstructuredMesh& new_mesh,
 void UnstructuredMesh::partition_cluster(std::vector<std::vector<unsigned int> > & clusters)
 {
   clusters.resize(_subdomain_cluster.size());
-  if(_subdomain_cluster.empty()) return;
 
 
   // map subdomain to clusters
@@ -988,6 +1011,56 @@ void UnstructuredMesh::partition_cluster(std::vector<std::vector<unsigned int> >
     }
   }
 
+  if(_boundary_cluster.empty()) return;
+
+  // all the elems share a node with these boundaries, then the boundary nodes are on one processor
+  std::map<short int, std::set<const Node *> > boundary_side_nodes;
+  boundary_info->boundary_side_nodes_with_id(boundary_side_nodes);
+  std::set<const Node *> nodes;
+  for(unsigned int n=0; n<_boundary_cluster.size(); ++n)
+  {
+    const std::set<const Node *> & side_nodes = boundary_side_nodes[_boundary_cluster[n]];
+    nodes.insert(side_nodes.begin(), side_nodes.end());
+  }
+  if(nodes.empty()) return;
+
+  std::vector<unsigned int> boundary_cluster;
+  std::vector<bool> in_cluster(max_elem_id(), false);
+  for (elem_it = active_elements_begin(); elem_it != elem_end; ++elem_it)
+  {
+    const Elem* elem = *elem_it;
+    for(unsigned int n=0; n<elem->n_nodes(); ++n)
+      if( nodes.find(elem->get_node(n)) != nodes.end() )
+      {
+        boundary_cluster.push_back(elem->id());
+        in_cluster[elem->id()] = true;
+        break;
+      }
+  }
+
+  // an elem belongs to one cluster, the subdomain clusters overlap with it are merged
+  std::vector<std::vector<unsigned int> > merged_clusters;
+  for(unsigned int n=0; n<clusters.size(); ++n)
+  {
+    bool overlap = false;
+    for(unsigned int m=0; m<clusters[n].size() && !overlap; ++m)
+      overlap = in_cluster[clusters[n][m]];
+
+    if( !overlap )
+    {
+      merged_clusters.push_back(clusters[n]);
+      continue;
+    }
+
+    for(unsigned int m=0; m<clusters[n].size(); ++m)
+      if( !in_cluster[clusters[n][m]] )
+      {
+        boundary_cluster.push_back(clusters[n][m]);
+        in_cluster[clusters[n][m]] = true;
+      }
+  }
+  merged_clusters.push_back(boundary_cluster);
+  clusters.swap(merged_clusters);
 }
 
 
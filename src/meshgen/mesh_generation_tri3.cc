@@ -37,6 +37,8 @@
 
 #include "point.h"
 #include "boundary_info.h"
+#include "mesh_communication.h"
+#include "parallel.h"
 
 
 #include "perf_log.h"
@@ -1459,3 +1461,294 @@ int MeshGeneratorTri3::do_refine(MeshRefinement & mesh_refinement)
   return 0;
 
 }
+
+
+
+/* ----------------------------------------------------------------------------
+ * triangulate one region with its boundary segments fixed
+ */
+void MeshGeneratorTri3::triangulate_region(unsigned int r, std::vector<double> & steiner_points, std::vector<int> & tri_data)
+{
+  const unsigned int n_nodes = _mesh.n_nodes();
+
+  // nodes and boundary segments of this region
+  std::map<unsigned int, int> node_local_index;
+  std::vector<unsigned int>   local_node_id;
+  // segment by sorted node id -> boundary id
+  std::map<std::pair<unsigned int, unsigned int>, short int> segments;
+  Point region_point;
+  bool  region_point_set = false;
+
+  MeshBase::element_iterator       el  = _mesh.active_elements_begin();
+  const MeshBase::element_iterator end = _mesh.active_elements_end();
+  for (; el != end; ++el)
+  {
+    const Elem * elem = *el;
+    if( elem->subdomain_id() != r ) continue;
+
+    if( !region_point_set )
+    {
+      region_point = elem->centroid();
+      region_point_set = true;
+    }
+
+    for (unsigned int n=0; n<elem->n_nodes(); n++)
+      if( node_local_index.find(elem->node(n)) == node_local_index.end() )
+      {
+        node_local_index.insert( std::make_pair(elem->node(n), static_cast<int>(local_node_id.size())) );
+        local_node_id.push_back(elem->node(n));
+      }
+
+    for (unsigned int s=0; s<elem->n_sides(); s++)
+    {
+      const Elem * neighbor = elem->neighbor(s);
+      short int bd = _mesh.boundary_info->boundary_id(elem, s);
+      // the region boundary and the user defined inner faces
+      bool region_boundary = (neighbor == NULL || neighbor->subdomain_id() != r);
+      if( !region_boundary && bd == BoundaryInfo::invalid_id ) continue;
+      if( bd == BoundaryInfo::invalid_id && neighbor )
+        bd = _mesh.boundary_info->boundary_id(neighbor, neighbor->which_neighbor_am_i(elem));
+
+      unsigned int n1 = elem->node(s);
+      unsigned int n2 = elem->node((s+1)%3);
+      segments[std::make_pair(std::min(n1, n2), std::max(n1, n2))] = bd;
+    }
+  }
+
+  if( !region_point_set ) return;
+
+  triangulateio_init();
+
+  in.numberofpoints           = local_node_id.size();
+  in.numberofpointattributes  = 0;
+  in.pointattributelist       = NULL;
+#ifdef __triangle_h__
+  in.pointlist                = (double *)calloc(in.numberofpoints*2, sizeof(double));
+  in.pointmarkerlist          = (int *) calloc(in.numberofpoints, sizeof(int));
+#else
+  in.pointlist                = new double[in.numberofpoints*2];
+  in.pointmarkerlist          = new int[in.numberofpoints];
+#endif
+  for(int i=0; i<in.numberofpoints; i++)
+  {
+    const Node * node = _mesh.node_ptr(local_node_id[i]);
+    in.pointlist[2*i+0] = (*node)(0);
+    in.pointlist[2*i+1] = (*node)(1);
+    in.pointmarkerlist[i] = 0;
+  }
+
+  in.numberofholes   = 0;
+  in.numberofregions = 1;
+#ifdef __triangle_h__
+  in.regionlist = (double *) calloc(4, sizeof(double));
+#else
+  in.regionlist = new double[4];
+#endif
+  in.regionlist[0] = region_point(0);
+  in.regionlist[1] = region_point(1);
+  in.regionlist[2] = double(r);
+  in.regionlist[3] = 0;
+
+  // Triangle changes zero marker of boundary segment to 1,
+  // so we use 1 for segment without boundary id and shift the boundary id by 2
+  in.numberofsegments = segments.size();
+#ifdef __triangle_h__
+  in.segmentlist =  (int *) calloc(in.numberofsegments*2, sizeof(int));
+  in.segmentmarkerlist = (int *) calloc(in.numberofsegments, sizeof(int));
+#else
+  in.segmentlist =  new int[in.numberofsegments*2];
+  in.segmentmarkerlist = new int[in.numberofsegments];
+#endif
+  {
+    std::map<std::pair<unsigned int, unsigned int>, short int>::const_iterator it = segments.begin();
+    for(int i=0; it != segments.end(); ++it, ++i)
+    {
+      in.segmentlist[2*i]   = node_local_index[it->first.first];
+      in.segmentlist[2*i+1] = node_local_index[it->first.second];
+      in.segmentmarkerlist[i] = (it->second == BoundaryInfo::invalid_id) ? 1 : it->second + 2;
+    }
+  }
+
+  // no steiner point on the region boundary, which keeps the region interface conforming
+  std::string cmd = tri_cmd;
+  if( cmd.find('Y') == std::string::npos ) cmd += "Y";
+
+#ifdef __triangle_h__
+  triangulate(const_cast<char *>(cmd.c_str()), &in, &out, (struct triangulateio *) NULL);
+#else
+  ctri_triangulate(const_cast<char *>(cmd.c_str()), &in, &out);
+#endif
+
+  out_edge_table.clear();
+  for(int i=0; i<out.numberofsegments; i++)
+  {
+    OutEdge edge;
+    edge.pointno = out.numberofpoints;
+    edge.p1 = std::min(out.segmentlist[2*i+0], out.segmentlist[2*i+1]);
+    edge.p2 = std::max(out.segmentlist[2*i+0], out.segmentlist[2*i+1]);
+    edge.mark = out.segmentmarkerlist[i];
+    out_edge_table[edge] = edge.mark;
+  }
+
+  // Triangle keeps the order of input points, the new points follow them
+  const int steiner_offset = static_cast<int>(n_nodes + steiner_points.size()/2) - in.numberofpoints;
+  for(int i = in.numberofpoints; i < out.numberofpoints; i++)
+  {
+    steiner_points.push_back(out.pointlist[2*i+0]);
+    steiner_points.push_back(out.pointlist[2*i+1]);
+  }
+
+  for(int i = 0; i < out.numberoftriangles; i++)
+  {
+    tri_data.push_back(r);
+    for(int v=0; v<3; v++)
+    {
+      int p = out.trianglelist[3*i+v];
+      tri_data.push_back( p < in.numberofpoints ? static_cast<int>(local_node_id[p]) : steiner_offset + p );
+    }
+    for(int v=0; v<3; v++)
+    {
+      int mark = get_bc_id(NULL, out.trianglelist[3*i+v], out.trianglelist[3*i+(v+1)%3]);
+      tri_data.push_back( mark >= 2 ? mark - 2 : BoundaryInfo::invalid_id );
+    }
+  }
+
+  triangulateio_finalize();
+}
+
+
+
+/* ----------------------------------------------------------------------------
+ * over write the do_refine_parallel() virtual function in meshgen base class
+ */
+int MeshGeneratorTri3::do_refine_parallel(MeshRefinement & mesh_refinement)
+{
+  if( Genius::n_processors() == 1 )
+    return this->do_refine(mesh_refinement);
+
+  START_LOG("do_refine_parallel()", "MeshGenerator");
+
+  MESSAGE<<"Regriding Tri3 mesh region by region in parallel...\n"; RECORD();
+
+  // call MeshRefinement class to do FEM refine on processor 0
+  if( Genius::processor_id() == 0 )
+  {
+    mesh_refinement.refine_and_coarsen_elements ();
+    _mesh.find_neighbors();
+    MeshTools::Modification::flatten(_mesh);
+  }
+
+  // all the processors use the triangle command of processor 0
+  {
+    std::vector<char> cmd(tri_cmd.begin(), tri_cmd.end());
+    Parallel::broadcast(cmd);
+    tri_cmd = std::string(cmd.begin(), cmd.end());
+  }
+
+  // sync the refined mesh, its region boundaries are fixed from now on
+  MeshCommunication mesh_comm;
+  mesh_comm.broadcast(_mesh);
+  if( Genius::processor_id() != 0 )
+    _mesh.find_neighbors();
+
+  // triangulate the regions owned by this processor
+  std::vector<double> steiner_points;
+  std::vector<int>    tri_data;
+  for(unsigned int r=0; r<_mesh.n_subdomains(); r++)
+    if( r % Genius::n_processors() == Genius::processor_id() )
+      triangulate_region(r, steiner_points, tri_data);
+
+  // collect all the regions to processor 0
+  std::vector<unsigned int> n_steiner_points, n_tri_data;
+  Parallel::gather(0, static_cast<unsigned int>(steiner_points.size()/2), n_steiner_points);
+  Parallel::gather(0, static_cast<unsigned int>(tri_data.size()), n_tri_data);
+  Parallel::gather(0, steiner_points);
+  Parallel::gather(0, tri_data);
+
+  if( Genius::processor_id() == 0 )
+  {
+    const unsigned int n_nodes = _mesh.n_nodes();
+
+    // save old mesh information
+    std::vector<Point> points(n_nodes);
+    {
+      MeshBase::node_iterator node_it = _mesh.nodes_begin();
+      for(; node_it != _mesh.nodes_end() ; ++node_it)
+        points[(*node_it)->id()] = *(*node_it);
+    }
+    for(unsigned int i=0; i<steiner_points.size()/2; i++)
+      points.push_back(Point(steiner_points[2*i+0], steiner_points[2*i+1], 0.0));
+
+    std::map<unsigned int, std::pair<std::string, std::string> > region_info_map;
+    for(unsigned int n_sub=0; n_sub<_mesh.n_subdomains(); n_sub++)
+      region_info_map[n_sub] = std::make_pair( _mesh.subdomain_label_by_id(n_sub),_mesh.subdomain_material(n_sub) );
+
+    std::map<short int, std::string> bd_label_map;
+    std::set<short int>  bd_user_defined;
+    {
+      const std::set<short int>& boundary_ids = _mesh.boundary_info->get_boundary_ids();
+      std::set<short int>::const_iterator it = boundary_ids.begin();
+      for(; it != boundary_ids.end(); ++it)
+      {
+        bd_label_map[*it] =  _mesh.boundary_info->get_label_by_id(*it);
+        if( _mesh.boundary_info->boundary_id_has_user_defined_label(*it) )
+          bd_user_defined.insert(*it);
+      }
+    }
+
+    // clear old mesh structure
+    _mesh.clear();
+    _mesh.magic_num() = this->magic_num();
+
+    _mesh.reserve_nodes( points.size() );
+    for(unsigned int i = 0; i < points.size(); i++)
+      _mesh.add_point(points[i]);
+
+    // the new points of each processor are numbered after the ones of previous processors
+    unsigned int steiner_offset = 0;
+    unsigned int cnt = 0;
+    for(unsigned int p=0; p<Genius::n_processors(); p++)
+    {
+      const unsigned int proc_end = cnt + n_tri_data[p];
+      for( ; cnt < proc_end; cnt += 7)
+      {
+        Elem* elem = _mesh.add_elem(Elem::build(TRI3).release());
+        for(unsigned int v=0; v<3; v++)
+        {
+          unsigned int id = tri_data[cnt+1+v];
+          if( id >= n_nodes ) id += steiner_offset;
+          elem->set_node(v) = _mesh.node_ptr(id);
+        }
+        elem->subdomain_id() = tri_data[cnt];
+
+        for(unsigned int v=0; v<3; v++)
+          if( tri_data[cnt+4+v] != BoundaryInfo::invalid_id )
+            _mesh.boundary_info->add_side(elem, v, tri_data[cnt+4+v]);
+      }
+      steiner_offset += n_steiner_points[p];
+    }
+
+    // write region label and material info to _mesh
+    _mesh.set_n_subdomains() = region_info_map.size();
+    std::map<unsigned int, std::pair<std::string, std::string> >::iterator region_it = region_info_map.begin();
+    for(; region_it != region_info_map.end(); ++region_it)
+    {
+      _mesh.set_subdomain_label((*region_it).first, (*region_it).second.first );
+      _mesh.set_subdomain_material((*region_it).first, (*region_it).second.second);
+    }
+
+    // write boundary label into mesh.boundary_info structure
+    std::map<short int, std::string>::iterator bd_it = bd_label_map.begin();
+    for(; bd_it != bd_label_map.end(); ++bd_it)
+    {
+      bool user_defined = (bd_user_defined.find((*bd_it).first) != bd_user_defined.end());
+      _mesh.boundary_info->set_label_to_id( (*bd_it).first, (*bd_it).second, user_defined );
+    }
+  }
+
+  MESSAGE<<"Tri3 mesh successfully Regrided.\n"<<std::endl; RECORD();
+
+  STOP_LOG("do_refine_parallel()", "MeshGenerator");
+
+  return 0;
+}
@@ -105,10 +105,10 @@ void FilePreProcess::file_include( const char * filename  )
 }
 
 
-std::string FilePreProcess::output()
+std::string FilePreProcess::output(const std::string &suffix)
 {
   // write down
-  std::string out_file = _filename + ".pp";
+  std::string out_file = _filename + ".pp" + suffix;
   std::ofstream   out( out_file.c_str() );
   out << _contex;
   out.close();
@@ -33,7 +33,13 @@ namespace Parser
 
 int InputParser::read_card_file(const char *filename)
 {
-  InputYY::yyin = fopen(filename, "r");
+  return read_card_file(fopen(filename, "r"));
+}
+
+
+int InputParser::read_card_file(FILE *fp)
+{
+  InputYY::yyin = fp;
 
   if( InputYY::yyin == NULL )
     return 1;
@@ -0,0 +1,348 @@
+/********************************************************************************/
+/*     888888    888888888   88     888  88888   888      888    88888888       */
+/*   8       8   8           8 8     8     8      8        8    8               */
+/*  8            8           8  8    8     8      8        8    8               */
+/*  8            888888888   8   8   8     8      8        8     8888888        */
+/*  8      8888  8           8    8  8     8      8        8            8       */
+/*   8       8   8           8     8 8     8      8        8            8       */
+/*     888888    888888888  888     88   88888     88888888     88888888        */
+/*                                                                              */
+/*       A Three-Dimensional General Purpose Semiconductor Simulator.           */
+/*                                                                              */
+/*                                                                              */
+/*  Copyright (C) 2007-2008                                                     */
+/*  Cogenda Pte Ltd                                                             */
+/*                                                                              */
+/*  Please contact Cogenda Pte Ltd for license information                      */
+/*                                                                              */
+/*  Author: Gong Ding   gdiso@ustc.edu                                          */
+/*                                                                              */
+/********************************************************************************/
+
+// binary image of syntax pattern and validated cards, for fast startup of repeated runs
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#include "parser.h"
+#include "pattern.h"
+
+
+namespace Parser
+{
+
+  static const char * pattern_magic = "GENIUS-PATTERN-1";
+  static const char * cards_magic   = "GENIUS-CARDS-1";
+
+  //----------------------------------------------------------------------
+  // primitive binary io, the image is only read by the same build on the same machine
+
+  static void write_uint(std::ostream &out, unsigned int v)
+  { out.write(reinterpret_cast<const char *>(&v), sizeof(v)); }
+
+  static bool read_uint(std::istream &in, unsigned int &v)
+  { return !!in.read(reinterpret_cast<char *>(&v), sizeof(v)); }
+
+  static void write_string(std::ostream &out, const std::string &s)
+  {
+    write_uint(out, s.size());
+    out.write(s.data(), s.size());
+  }
+
+  static bool read_string(std::istream &in, std::string &s)
+  {
+    unsigned int size;
+    if( !read_uint(in, size) ) return false;
+    s.resize(size);
+    return size==0 || !!in.read(&s[0], size);
+  }
+
+  /**
+   * write the file to a temporary file and rename it, so a concurrent reader never sees a partial image
+   */
+  static int commit_file(const std::string &tmp, const std::string &fname, bool good)
+  {
+    if( !good )
+    {
+      std::remove(tmp.c_str());
+      return 1;
+    }
+#ifdef WINDOWS
+    std::remove(fname.c_str());
+#endif
+    return std::rename(tmp.c_str(), fname.c_str()) ? 1 : 0;
+  }
+
+
+  std::string file_stamp(const std::string &fname)
+  {
+    struct stat st;
+    if( stat(fname.c_str(), &st) ) return std::string();
+    std::stringstream ss;
+    ss << st.st_size << ':' << st.st_mtime;
+    return ss.str();
+  }
+
+
+  std::string file_digest(const std::string &fname)
+  {
+    std::ifstream in(fname.c_str(), std::ios::binary);
+    if( !in.good() ) return std::string();
+
+    // 64bit FNV-1a
+    unsigned long long h = 14695981039346656037ULL;
+    char buffer[4096];
+    while( in.read(buffer, sizeof(buffer)) || in.gcount() )
+    {
+      for(std::streamsize i=0; i<in.gcount(); ++i)
+      {
+        h ^= static_cast<unsigned char>(buffer[i]);
+        h *= 1099511628211ULL;
+      }
+    }
+
+    std::stringstream ss;
+    ss << std::hex << h;
+    return ss.str();
+  }
+
+
+  std::string data_digest(const char *data, size_t size)
+  {
+    unsigned long long h = 14695981039346656037ULL;
+    for(size_t i=0; i<size; ++i)
+    {
+      h ^= static_cast<unsigned char>(data[i]);
+      h *= 1099511628211ULL;
+    }
+
+    std::stringstream ss;
+    ss << std::hex << h;
+    return ss.str();
+  }
+
+
+  //----------------------------------------------------------------------
+
+  void Parameter::write_binary(std::ostream &out) const
+  {
+    write_string(out, _name);
+    write_string(out, _description);
+    write_uint(out, _et);
+    write_uint(out, _do_not_check_me);
+
+    write_uint(out, _string_pattern.size());
+    for(std::set<std::string>::const_iterator it=_string_pattern.begin(); it!=_string_pattern.end(); ++it)
+      write_string(out, *it);
+
+    // each value is tagged with its own type
+    write_uint(out, _values.size());
+    for(unsigned int n=0; n<_values.size(); ++n)
+    {
+      if( Value<bool> * v = dynamic_cast<Value<bool> *>(_values[n]) )
+      { write_uint(out, BOOL); write_uint(out, v->get()); }
+      else if( Value<int> * v = dynamic_cast<Value<int> *>(_values[n]) )
+      { write_uint(out, INTEGER); write_uint(out, static_cast<unsigned int>(v->get())); }
+      else if( Value<double> * v = dynamic_cast<Value<double> *>(_values[n]) )
+      { write_uint(out, REAL); double d = v->get(); out.write(reinterpret_cast<const char *>(&d), sizeof(d)); }
+      else if( Value<std::string> * v = dynamic_cast<Value<std::string> *>(_values[n]) )
+      { write_uint(out, STRING); write_string(out, v->get()); }
+      else
+        write_uint(out, INVALID);
+    }
+  }
+
+
+  bool Parameter::read_binary(std::istream &in)
+  {
+    this->clear();
+
+    unsigned int et, user_defined, size;
+    if( !read_string(in, _name) || !read_string(in, _description) ) return false;
+    if( !read_uint(in, et) || !read_uint(in, user_defined) ) return false;
+    _et = static_cast<ElemType>(et);
+    _do_not_check_me = user_defined!=0;
+
+    if( !read_uint(in, size) ) return false;
+    for(unsigned int n=0; n<size; ++n)
+    {
+      std::string s;
+      if( !read_string(in, s) ) return false;
+      _string_pattern.insert(s);
+    }
+
+    if( !read_uint(in, size) ) return false;
+    for(unsigned int n=0; n<size; ++n)
+    {
+      unsigned int type, v;
+      if( !read_uint(in, type) ) return false;
+      switch(type)
+      {
+        case BOOL    : if( !read_uint(in, v) ) return false; this->set<bool>(n) = v!=0; break;
+        case INTEGER : if( !read_uint(in, v) ) return false; this->set<int>(n) = static_cast<int>(v); break;
+        case REAL    :
+        {
+          double d;
+          if( !in.read(reinterpret_cast<char *>(&d), sizeof(d)) ) return false;
+          this->set<double>(n) = d;
+          break;
+        }
+        case STRING  : if( !read_string(in, this->set<std::string>(n)) ) return false; break;
+        default      : return false;
+      }
+    }
+    return true;
+  }
+
+
+  void Card::write_binary(std::ostream &out) const
+  {
+    write_string(out, _key);
+    write_uint(out, static_cast<unsigned int>(_line_number));
+    write_string(out, _file_line_info);
+    write_uint(out, _parameter_vec.size());
+    for(unsigned int n=0; n<_parameter_vec.size(); ++n)
+      _parameter_vec[n].write_binary(out);
+  }
+
+
+  bool Card::read_binary(std::istream &in)
+  {
+    this->clear();
+
+    unsigned int line, size;
+    if( !read_string(in, _key) || !read_uint(in, line) || !read_string(in, _file_line_info) ) return false;
+    _line_number = static_cast<int>(line);
+
+    if( !read_uint(in, size) ) return false;
+    _parameter_vec.resize(size);
+    for(unsigned int n=0; n<size; ++n)
+      if( !_parameter_vec[n].read_binary(in) ) return false;
+    rebuild_parameter_map();
+    return true;
+  }
+
+
+  //----------------------------------------------------------------------
+
+  int Pattern::save_to_binary(const std::string &fname, const std::string &stamp) const
+  {
+    const std::string tmp = fname + ".tmp";
+    std::ofstream out(tmp.c_str(), std::ios::binary);
+    if( !out.good() ) return 1;
+
+    write_string(out, pattern_magic);
+    write_string(out, stamp);
+    write_uint(out, _pattern_card_map.size());
+    for(std::map<std::string, PatternCard>::const_iterator it=_pattern_card_map.begin(); it!=_pattern_card_map.end(); ++it)
+    {
+      const PatternCard & card = it->second;
+      write_string(out, card._key);
+      write_string(out, card._description);
+      write_uint(out, card._parameter_map.size());
+      for(std::map<std::string, Parameter>::const_iterator p=card._parameter_map.begin(); p!=card._parameter_map.end(); ++p)
+        p->second.write_binary(out);
+    }
+    out.close();
+
+    return commit_file(tmp, fname, !out.fail());
+  }
+
+
+  int Pattern::get_from_binary(const std::string &fname, const std::string &stamp)
+  {
+    std::ifstream in(fname.c_str(), std::ios::binary);
+    if( !in.good() ) return 1;
+
+    std::string magic, image_stamp;
+    if( !read_string(in, magic) || magic != pattern_magic ) return 1;
+    if( !read_string(in, image_stamp) || stamp.empty() || image_stamp != stamp ) return 1;
+
+    std::map<std::string, PatternCard> pattern_card_map;
+    unsigned int n_cards;
+    if( !read_uint(in, n_cards) ) return 1;
+    for(unsigned int c=0; c<n_cards; ++c)
+    {
+      PatternCard card;
+      unsigned int n_parameters;
+      if( !read_string(in, card._key) || !read_string(in, card._description) || !read_uint(in, n_parameters) ) return 1;
+      for(unsigned int n=0; n<n_parameters; ++n)
+      {
+        Parameter p;
+        if( !p.read_binary(in) ) return 1;
+        card._parameter_map.insert(std::make_pair(p.name(), p));
+      }
+      pattern_card_map.insert(std::make_pair(card._key, card));
+    }
+
+    _pattern_card_map.swap(pattern_card_map);
+    return 0;
+  }
+
+
+  //----------------------------------------------------------------------
+
+  int InputParser::save_cards(const std::string &fname, const std::string &stamp) const
+  {
+    const std::string tmp = fname + ".tmp";
+    std::ofstream out(tmp.c_str(), std::ios::binary);
+    if( !out.good() ) return 1;
+
+    write_string(out, cards_magic);
+    write_string(out, stamp);
+
+    write_uint(out, _card_list.size());
+    for(std::list<Card>::const_iterator it=_card_list.begin(); it!=_card_list.end(); ++it)
+      it->write_binary(out);
+
+    // the keys of card map are the ones before pattern check
+    write_uint(out, _card_map.size());
+    for(std::multimap<std::string, Card>::const_iterator it=_card_map.begin(); it!=_card_map.end(); ++it)
+    {
+      write_string(out, it->first);
+      it->second.write_binary(out);
+    }
+    out.close();
+
+    return commit_file(tmp, fname, !out.fail());
+  }
+
+
+  int InputParser::load_cards(const std::string &fname, const std::string &stamp)
+  {
+    std::ifstream in(fname.c_str(), std::ios::binary);
+    if( !in.good() ) return 1;
+
+    std::string magic, image_stamp;
+    if( !read_string(in, magic) || magic != cards_magic ) return 1;
+    if( !read_string(in, image_stamp) || stamp.empty() || image_stamp != stamp ) return 1;
+
+    std::list<Card> card_list;
+    std::multimap<std::string, Card> card_map;
+
+    unsigned int size;
+    if( !read_uint(in, size) ) return 1;
+    for(unsigned int n=0; n<size; ++n)
+    {
+      card_list.push_back(Card());
+      if( !card_list.back().read_binary(in) ) return 1;
+    }
+
+    if( !read_uint(in, size) ) return 1;
+    for(unsigned int n=0; n<size; ++n)
+    {
+      std::string key;
+      Card card;
+      if( !read_string(in, key) || !card.read_binary(in) ) return 1;
+      card_map.insert(std::make_pair(key, card));
+    }
+
+    _card_list.swap(card_list);
+    _card_map.swap(card_map);
+    return 0;
+  }
+
+}
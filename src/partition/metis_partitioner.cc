@@ -75,12 +75,13 @@ void MetisPartitioner::_do_partition (MeshBase& mesh,
     std::vector<int> xadj;          // the adjacency structure of the graph
     std::vector<int> adjncy;        // the adjacency structure of the graph
     std::vector<int> options(8);
-    std::vector<int> vwgt(n_cluster);  // the weights of the vertices
+    // The number of balancing constraints. the second one is dof weight if required
+    int ncon    = mesh.multi_constraint_partition() ? 2 : 1;
+    std::vector<int> vwgt(ncon*n_cluster);  // the weights of the vertices
 
     xadj.reserve(n_cluster+1);
 
     int n = static_cast<int>(n_cluster);  // number of "nodes" (elements) in the graph
-    int ncon    = 1;                          // The number of balancing constraints. It should be at least 1.
     int wgtflag = 2;                          // weights on vertices only, none on edges
     int numflag = 0;                          // C-style 0-based numbering
     int nparts  = static_cast<int>(n_pieces); // number of subdomains to create
@@ -101,11 +102,14 @@ void MetisPartitioner::_do_partition (MeshBase& mesh,
         const Cluster * cluster = _clusters[n];
 
         // The weight is used to define what a balanced graph is
-        vwgt[n] = 0;
+        vwgt[ncon*n] = 0;
+        if (ncon > 1) vwgt[ncon*n+1] = 0;
         for (unsigned int mn=0; mn<cluster->elems.size(); mn++)
         {
           const Elem * elem = cluster->elems[mn];
-          vwgt[n] += mesh.subdomain_weight( elem->subdomain_id () ) * elem->n_nodes();
+          vwgt[ncon*n] += mesh.subdomain_weight( elem->subdomain_id () ) * elem->n_nodes();
+          if (ncon > 1)
+            vwgt[ncon*n+1] += mesh.subdomain_dof_weight( elem->subdomain_id () ) * elem->n_nodes();
         }
 
         // The beginning of the adjacency array for this elem
@@ -138,8 +142,15 @@ void MetisPartitioner::_do_partition (MeshBase& mesh,
                                              &nparts, NULL, NULL, NULL, &edgecut, &part[0]);
 #else
     // old METIS-4 interface
-    Metis::METIS_PartGraphKway(&n, &xadj[0], &adjncy[0], &vwgt[0], NULL, &wgtflag, &numflag,
-                                             &nparts, &options[0], &edgecut, &part[0]);
+    if (ncon > 1)
+    {
+      std::vector<float> ubvec(ncon, 1.05f); // load imbalance tolerance of each constraint
+      Metis::METIS_mCPartGraphKway(&n, &ncon, &xadj[0], &adjncy[0], &vwgt[0], NULL, &wgtflag, &numflag,
+                                   &nparts, &ubvec[0], &options[0], &edgecut, &part[0]);
+    }
+    else
+      Metis::METIS_PartGraphKway(&n, &xadj[0], &adjncy[0], &vwgt[0], NULL, &wgtflag, &numflag,
+                                               &nparts, &options[0], &edgecut, &part[0]);
 #endif
 
   }
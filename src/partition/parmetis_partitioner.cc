@@ -161,7 +161,7 @@ void ParmetisPartitioner::initialize (const MeshBase& mesh,
 
   // Set parameters.
   _wgtflag = 2;                          // weights on vertices only
-  _ncon    = 1;                          // one weight per vertex
+  _ncon    = mesh.multi_constraint_partition() ? 2 : 1; // weight and optional dof weight per vertex
   _numflag = 0;                          // C-style 0-based numbering
   _nparts  = static_cast<int>(n_sbdmns); // number of subdomains to create
   _edgecut = 0;                          // the numbers of edges cut by the
@@ -169,11 +169,11 @@ void ParmetisPartitioner::initialize (const MeshBase& mesh,
 
   // Initialize data structures for ParMETIS
   _vtxdist.resize (n_procs+1);     std::fill (_vtxdist.begin(), _vtxdist.end(), 0);
-  _tpwgts.resize  (_nparts);       std::fill (_tpwgts.begin(),  _tpwgts.end(),  1./_nparts);
-  _ubvec.resize   (_ncon);         std::fill (_ubvec.begin(),   _ubvec.end(),   1.);
+  _tpwgts.resize  (_nparts*_ncon); std::fill (_tpwgts.begin(),  _tpwgts.end(),  1./_nparts);
+  _ubvec.resize   (_ncon);         std::fill (_ubvec.begin(),   _ubvec.end(),   _ncon > 1 ? 1.05 : 1.);
   _part.resize    (n_active_elem); std::fill (_part.begin(),    _part.end(), 0);
   _options.resize (5);
-  _vwgt.resize    (n_active_on_processor_elem);
+  _vwgt.resize    (_ncon*n_active_on_processor_elem);
 
 
   // Set the options
@@ -220,7 +220,12 @@ void ParmetisPartitioner::initialize (const MeshBase& mesh,
 
 	  // maybe there is a better weight?
           if (proc_id == Genius::processor_id())
-            _vwgt[on_processor_el_num++] = mesh.subdomain_weight( (*elem_it)->subdomain_id () ) * (*elem_it)->n_nodes();
+          {
+            _vwgt[_ncon*on_processor_el_num] = mesh.subdomain_weight( (*elem_it)->subdomain_id () ) * (*elem_it)->n_nodes();
+            if (_ncon > 1)
+              _vwgt[_ncon*on_processor_el_num+1] = mesh.subdomain_dof_weight( (*elem_it)->subdomain_id () ) * (*elem_it)->n_nodes();
+            on_processor_el_num++;
+          }
 	}
     }
 
@@ -36,33 +36,44 @@ void QBase::init(const ElemType t,
       _p_level = p;
     }
 
-
+  // the rule was built for this element type before
+  const std::pair<ElemType, unsigned int> key(_type, _p_level);
+  std::map<std::pair<ElemType, unsigned int>, std::pair<std::vector<Point>, std::vector<Real> > >::const_iterator it
+    = _rule_cache.find(key);
+  if (it != _rule_cache.end())
+    {
+      _points  = it->second.first;
+      _weights = it->second.second;
+      return;
+    }
 
   switch(_dim)
     {
     case 0:
       this->init_0D(_type,_p_level);
 
-      return;
+      break;
 
     case 1:
       this->init_1D(_type,_p_level);
 
-      return;
+      break;
 
     case 2:
       this->init_2D(_type,_p_level);
 
-      return;
+      break;
 
     case 3:
       this->init_3D(_type,_p_level);
 
-      return;
+      break;
 
     default:
       genius_error();
     }
+
+  _rule_cache[key] = std::make_pair(_points, _weights);
 }
 
 
@@ -21,6 +21,7 @@
 
 // C++ includes
 #include <numeric>
+#include <algorithm>
 
 // cgns lib include
 #include <cgnslib.h>
@@ -63,7 +64,11 @@ void CGNSIO::read (const std::string& filename)
   // we will change it to unique id() for all the processor later.
   std::map<int, Node*>   global_id_to_node;
 
-  if( Genius::processor_id() == 0)
+  // with parallel read, every processor owns a full copy of the file data
+  // and no broadcast is needed
+  const bool read_here = ( Genius::processor_id() == 0 || _parallel_read );
+
+  if( read_here )
   {
     // open CGNS file for read
     genius_assert(!cg_open(filename.c_str(), MODE_READ, &fn));
@@ -589,13 +594,16 @@ void CGNSIO::read (const std::string& filename)
 
     cg_close(fn);
 
-  } //if( Genius::processor_id() == 0)
+  } //if( read_here )
 
 
 
   // broadcast mesh to all the processor
-  MeshCommunication mesh_comm;
-  mesh_comm.broadcast(mesh);
+  if( !_parallel_read )
+  {
+    MeshCommunication mesh_comm;
+    mesh_comm.broadcast(mesh);
+  }
 
 
   // build simulation system
@@ -603,8 +611,8 @@ void CGNSIO::read (const std::string& filename)
   system.sync_print_info();
 
   // after mesh setup, the node id() may be changed. we get the new node id() by Node * we record before
-  // this is done only for processor 0.
-  if( Genius::processor_id() == 0)
+  // this is done only for processor 0 (or all the processors for parallel read).
+  if( read_here )
   {
     for(unsigned int r=0; r<region_solutions.size(); r++)
     {
@@ -617,54 +625,58 @@ void CGNSIO::read (const std::string& filename)
     }
   }
 
-  //distribute (solution's) global id to all the processor
-  if(Genius::processor_id() != 0)
-    region_global_id.resize(system.n_regions());
-  for(unsigned int r=0; r<system.n_regions(); r++)
-    Parallel::broadcast(region_global_id[r] , 0);
+  // the solution data only lives on processor 0 when it reads the file alone
+  if( !_parallel_read )
+  {
+    //distribute (solution's) global id to all the processor
+    if(Genius::processor_id() != 0)
+      region_global_id.resize(system.n_regions());
+    for(unsigned int r=0; r<system.n_regions(); r++)
+      Parallel::broadcast(region_global_id[r] , 0);
 
 
-  //distribute (solution's) global id to node id information to all the processor
-  if(Genius::processor_id() != 0)
-    region_global_id_to_node_id.resize(system.n_regions());
-  for(unsigned int r=0; r<system.n_regions(); r++)
-    Parallel::broadcast(region_global_id_to_node_id[r] , 0);
+    //distribute (solution's) global id to node id information to all the processor
+    if(Genius::processor_id() != 0)
+      region_global_id_to_node_id.resize(system.n_regions());
+    for(unsigned int r=0; r<system.n_regions(); r++)
+      Parallel::broadcast(region_global_id_to_node_id[r] , 0);
 
-  // distribute solution data to all the processor
-  if(Genius::processor_id() != 0)
-    region_solutions.resize(system.n_regions());
+    // distribute solution data to all the processor
+    if(Genius::processor_id() != 0)
+      region_solutions.resize(system.n_regions());
 
-  for(unsigned int r=0; r<region_solutions.size(); r++)
-  {
-    unsigned int n_solutions = region_solutions[r].size();
-    Parallel::broadcast(n_solutions , 0);
+    for(unsigned int r=0; r<region_solutions.size(); r++)
+    {
+      unsigned int n_solutions = region_solutions[r].size();
+      Parallel::broadcast(n_solutions , 0);
 
-    std::string sol_name;
-    std::string field_name;
-    std::vector<double> sol_array;
+      std::string sol_name;
+      std::string field_name;
+      std::vector<double> sol_array;
 
-    std::map<std::pair<std::string,std::string>, std::vector<double> >::iterator it = region_solutions[r].begin();
+      std::map<std::pair<std::string,std::string>, std::vector<double> >::iterator it = region_solutions[r].begin();
 
-    for(unsigned int n=0; n<n_solutions; n++)
-    {
-      if(Genius::processor_id() == 0)
+      for(unsigned int n=0; n<n_solutions; n++)
       {
-        sol_name  = (*it).first.first;
-        field_name  = (*it).first.second;
-        sol_array = (*it).second;
-        ++it;
-      }
+        if(Genius::processor_id() == 0)
+        {
+          sol_name  = (*it).first.first;
+          field_name  = (*it).first.second;
+          sol_array = (*it).second;
+          ++it;
+        }
 
-      Parallel::broadcast(sol_name   , 0);
-      Parallel::broadcast(field_name , 0);
-      Parallel::broadcast(sol_array  , 0);
+        Parallel::broadcast(sol_name   , 0);
+        Parallel::broadcast(field_name , 0);
+        Parallel::broadcast(sol_array  , 0);
 
-      if(Genius::processor_id() != 0)
-        (region_solutions[r])[std::pair<std::string,std::string>(sol_name,field_name)] = sol_array;
+        if(Genius::processor_id() != 0)
+          (region_solutions[r])[std::pair<std::string,std::string>(sol_name,field_name)] = sol_array;
+      }
     }
-  }
 
-  Parallel::broadcast(region_solution_units   , 0);
+    Parallel::broadcast(region_solution_units   , 0);
+  }
 
 
   // now all the processor have enough information for
@@ -1599,3 +1611,152 @@ std::vector<double> & CGNSIO::_sort_it (std::vector<double> & x, const std::vect
 
 
 
+
+
+
+void CGNSIO::append_solution(const std::string & filename, const std::string & sol_name,
+                             bool single_precision, SolutionDigest & digest)
+{
+  const SimulationSystem & system = FieldOutput<SimulationSystem>::system();
+
+  if( Genius::processor_id() == 0)
+  {
+    genius_assert(!cg_open(filename.c_str(), MODE_MODIFY, &fn));
+    B = 1;
+  }
+
+  for( unsigned int r=0; r<system.n_regions(); r++)
+  {
+    const SimulationRegion * region = system.region(r);
+
+    // all the valid point based scalar, they are written in the order of name
+    std::vector<SimulationVariable> variables;
+    const std::map<std::string, SimulationVariable> & point_variables = region->region_point_variables();
+    std::map<std::string, SimulationVariable>::const_iterator var_it = point_variables.begin();
+    for( ; var_it != point_variables.end(); ++var_it)
+      if( var_it->second.variable_valid && var_it->second.variable_data_type == SCALAR )
+        variables.push_back(var_it->second);
+
+    std::vector<unsigned int> region_node_id;
+    std::vector< std::vector<double> > region_data(variables.size());
+
+    SimulationRegion::const_processor_node_iterator node_it = region->on_processor_nodes_begin();
+    SimulationRegion::const_processor_node_iterator node_it_end = region->on_processor_nodes_end();
+    for(; node_it!=node_it_end; ++node_it)
+    {
+      const FVM_NodeData * node_data = (*node_it)->node_data();
+      region_node_id.push_back((*node_it)->root_node()->id());
+      for(unsigned int v=0; v<variables.size(); ++v)
+        region_data[v].push_back( node_data->data<double>( variables[v].variable_index ) / variables[v].variable_unit );
+    }
+
+    Parallel::gather(0, region_node_id);
+    for(unsigned int v=0; v<variables.size(); ++v)
+      Parallel::gather(0, region_data[v]);
+
+    if( Genius::processor_id() != 0) continue;
+
+    Z = r+1;
+    {
+      char zone_name[32];
+      int  isize[3];
+      genius_assert(!cg_zone_read(fn, B, Z, zone_name, isize));
+      genius_assert(region->name() == zone_name);
+    }
+
+    // the zone node order is kept in Global_Node_Index
+    std::map<unsigned int, unsigned int> node_id_to_region_node_id;
+    {
+      genius_assert(!cg_goto(fn, B, "Zone_t", Z, "UserDefinedData_t", 1, "end"));
+      char       ArrayName[32];
+      DataType_t DataType;
+      int        DataDimension;
+      int        DimensionVector;
+      genius_assert(!cg_array_info(1, ArrayName , &DataType , &DataDimension , &DimensionVector ));
+      std::vector<int> global_node_id(DimensionVector);
+      genius_assert(!cg_array_read_as(1, Integer, &global_node_id[0] ));
+      for(unsigned int n=0; n<global_node_id.size(); ++n)
+        node_id_to_region_node_id[global_node_id[n]] = n;
+    }
+
+    std::vector<unsigned int> region_node_local_id;
+    for(unsigned int n=0; n<region_node_id.size(); ++n)
+      region_node_local_id.push_back( node_id_to_region_node_id[region_node_id[n]] );
+
+    // every step has its FlowSolution node, even if no array changed
+    genius_assert(!cg_sol_write(fn, B, Z, sol_name.c_str(), Vertex, &SOL));
+
+    for(unsigned int v=0; v<variables.size(); ++v)
+    {
+      std::vector<double> & data = _sort_it(region_data[v], region_node_local_id);
+      std::vector<float>  data_float;
+      const char * bytes = reinterpret_cast<const char *>(&data[0]);
+      size_t n_bytes = data.size()*sizeof(double);
+      if( single_precision )
+      {
+        data_float.assign(data.begin(), data.end());
+        bytes = reinterpret_cast<const char *>(&data_float[0]);
+        n_bytes = data_float.size()*sizeof(float);
+      }
+
+      // FNV-1a hash of the array, skip the array not changed since last write
+      unsigned long hash = 2166136261ul;
+      for(size_t i=0; i<n_bytes; ++i)
+        hash = (hash ^ static_cast<unsigned char>(bytes[i])) * 16777619ul;
+
+      std::string key = region->name() + "/" + variables[v].variable_name;
+      SolutionDigest::iterator digest_it = digest.find(key);
+      if( digest_it != digest.end() && digest_it->second == hash ) continue;
+      digest[key] = hash;
+
+      if( single_precision )
+      {
+        genius_assert(!cg_field_write(fn, B, Z, SOL, RealSingle, variables[v].variable_name.c_str(), &data_float[0], &F));
+      }
+      else
+      {
+        genius_assert(!cg_field_write(fn, B, Z, SOL, RealDouble, variables[v].variable_name.c_str(), &data[0], &F));
+      }
+    }
+  }
+
+  if( Genius::processor_id() == 0)
+    cg_close(fn);
+}
+
+
+
+void CGNSIO::write_time_series(const std::string & filename, const std::vector<double> & time,
+                               const std::vector<std::string> & sol_name)
+{
+  if( Genius::processor_id() != 0 || time.empty() ) return;
+
+  const SimulationSystem & system = FieldOutput<SimulationSystem>::system();
+
+  genius_assert(time.size() == sol_name.size());
+  int n_steps = time.size();
+
+  genius_assert(!cg_open(filename.c_str(), MODE_MODIFY, &fn));
+  B = 1;
+
+  genius_assert(!cg_simulation_type_write(fn, B, TimeAccurate));
+  genius_assert(!cg_biter_write(fn, B, "TimeIterValues", n_steps));
+  genius_assert(!cg_goto(fn, B, "BaseIterativeData_t", 1, "end"));
+  genius_assert(!cg_array_write("TimeValues", RealDouble, 1, &n_steps, &time[0]));
+
+  // FlowSolutionPointers is a 32 x n_steps character array
+  std::vector<char> pointers(32*n_steps, ' ');
+  for(int n=0; n<n_steps; ++n)
+    sol_name[n].copy(&pointers[32*n], std::min<size_t>(sol_name[n].size(), 32));
+  int dims[2] = {32, n_steps};
+
+  for( unsigned int r=0; r<system.n_regions(); r++)
+  {
+    Z = r+1;
+    genius_assert(!cg_ziter_write(fn, B, Z, "ZoneIterativeData"));
+    genius_assert(!cg_goto(fn, B, "Zone_t", Z, "ZoneIterativeData_t", 1, "end"));
+    genius_assert(!cg_array_write("FlowSolutionPointers", Character, 2, dims, &pointers[0]));
+  }
+
+  cg_close(fn);
+}
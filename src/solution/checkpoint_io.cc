@@ -0,0 +1,181 @@
+/********************************************************************************/
+/*     888888    888888888   88     888  88888   888      888    88888888       */
+/*   8       8   8           8 8     8     8      8        8    8               */
+/*  8            8           8  8    8     8      8        8    8               */
+/*  8            888888888   8   8   8     8      8        8     8888888        */
+/*  8      8888  8           8    8  8     8      8        8            8       */
+/*   8       8   8           8     8 8     8      8        8            8       */
+/*     888888    888888888  888     88   88888     88888888     88888888        */
+/*                                                                              */
+/*       A Three-Dimensional General Purpose Semiconductor Simulator.           */
+/*                                                                              */
+/*                                                                              */
+/*  Copyright (C) 2007-2008                                                     */
+/*  Cogenda Pte Ltd                                                             */
+/*                                                                              */
+/*  Please contact Cogenda Pte Ltd for license information                      */
+/*                                                                              */
+/*  Author: Gong Ding   gdiso@ustc.edu                                          */
+/*                                                                              */
+/********************************************************************************/
+
+#include <fstream>
+#include <sstream>
+
+#include "mesh_base.h"
+#include "checkpoint_io.h"
+#include "boundary_condition_collector.h"
+#include "boundary_condition.h"
+#include "external_circuit.h"
+#include "solver_specify.h"
+#include "parallel.h"
+
+
+// magic string at the head of checkpoint file
+static const char checkpoint_tag[] = "GENIUS_CHECKPOINT_1";
+
+
+std::string CheckpointIO::_local_file_name(const std::string & filename)
+{
+  if( Genius::n_processors() == 1 ) return filename;
+
+  std::stringstream ss;
+  ss << filename << '.' << Genius::processor_id();
+  return ss.str();
+}
+
+
+void CheckpointIO::write (const std::string& filename)
+{
+  const SimulationSystem & system = FieldOutput<SimulationSystem>::system();
+  const MeshBase & mesh = system.mesh();
+
+  std::ofstream out(_local_file_name(filename).c_str(), std::ios::out | std::ios::binary);
+  genius_assert(out.good());
+
+  out.write(checkpoint_tag, sizeof(checkpoint_tag));
+
+  // topology check information
+  unsigned int header[4];
+  header[0] = Genius::n_processors();
+  header[1] = Genius::processor_id();
+  header[2] = mesh.magic_num();
+  header[3] = system.n_regions();
+  out.write(reinterpret_cast<const char *>(header), sizeof(header));
+
+  // transient state
+  double clock[4];
+  clock[0] = SolverSpecify::clock;
+  clock[1] = SolverSpecify::dt;
+  clock[2] = SolverSpecify::dt_last;
+  clock[3] = SolverSpecify::dt_last_last;
+  out.write(reinterpret_cast<const char *>(clock), sizeof(clock));
+
+  int flags[3];
+  flags[0] = SolverSpecify::T_Cycles;
+  flags[1] = SolverSpecify::BDF2_LowerOrder;
+  flags[2] = SolverSpecify::tran_histroy;
+  out.write(reinterpret_cast<const char *>(flags), sizeof(flags));
+
+  // region data blocks
+  for(unsigned int r=0; r<system.n_regions(); r++)
+    system.region(r)->write_checkpoint(out);
+
+  // external circuit state, in the order of bc index
+  std::vector<Real> state;
+  const BoundaryConditionCollector * bcs = system.get_bcs();
+  for(unsigned int b=0; b<bcs->n_bcs(); b++)
+  {
+    const BoundaryCondition * bc = bcs->get_bc(b);
+    if( bc->is_electrode() )
+      bc->ext_circuit()->save_state(state);
+  }
+  unsigned int n_state = state.size();
+  out.write(reinterpret_cast<const char *>(&n_state), sizeof(unsigned int));
+  if( n_state )
+    out.write(reinterpret_cast<const char *>(&state[0]), n_state*sizeof(Real));
+
+  genius_assert(out.good());
+  out.close();
+}
+
+
+
+void CheckpointIO::read (const std::string& filename)
+{
+  SimulationSystem & system = FieldInput<SimulationSystem>::system();
+  const MeshBase & mesh = system.mesh();
+
+  std::ifstream in(_local_file_name(filename).c_str(), std::ios::in | std::ios::binary);
+
+  bool match = in.good();
+
+  if( match )
+  {
+    char tag[sizeof(checkpoint_tag)];
+    in.read(tag, sizeof(tag));
+    match = in.good() && std::string(tag) == checkpoint_tag;
+  }
+
+  if( match )
+  {
+    unsigned int header[4];
+    in.read(reinterpret_cast<char *>(header), sizeof(header));
+    match = in.good() &&
+            header[0] == Genius::n_processors() &&
+            header[1] == Genius::processor_id() &&
+            header[2] == mesh.magic_num() &&
+            header[3] == system.n_regions();
+  }
+
+  double clock[4];
+  int flags[3];
+  if( match )
+  {
+    in.read(reinterpret_cast<char *>(clock), sizeof(clock));
+    in.read(reinterpret_cast<char *>(flags), sizeof(flags));
+    match = in.good();
+  }
+
+  for(unsigned int r=0; match && r<system.n_regions(); r++)
+    match = system.region(r)->read_checkpoint(in);
+
+  std::vector<Real> state;
+  if( match )
+  {
+    unsigned int n_state;
+    in.read(reinterpret_cast<char *>(&n_state), sizeof(unsigned int));
+    state.resize(n_state);
+    if( n_state )
+      in.read(reinterpret_cast<char *>(&state[0]), n_state*sizeof(Real));
+    match = in.good();
+  }
+
+  // all the processors should agree
+  Parallel::min(match);
+  if( !match )
+  {
+    MESSAGE<<"ERROR: Checkpoint "<< filename << " does not match current mesh, region or processor number." << std::endl; RECORD();
+    genius_error();
+  }
+
+  SolverSpecify::clock        = clock[0];
+  SolverSpecify::dt           = clock[1];
+  SolverSpecify::dt_last      = clock[2];
+  SolverSpecify::dt_last_last = clock[3];
+
+  SolverSpecify::T_Cycles        = flags[0];
+  SolverSpecify::BDF2_LowerOrder = (flags[1] != 0);
+  SolverSpecify::tran_histroy    = (flags[2] != 0);
+
+  unsigned int pos = 0;
+  BoundaryConditionCollector * bcs = system.get_bcs();
+  for(unsigned int b=0; b<bcs->n_bcs(); b++)
+  {
+    BoundaryCondition * bc = bcs->get_bc(b);
+    if( bc->is_electrode() )
+      pos = bc->ext_circuit()->restore_state(state, pos);
+  }
+  genius_assert(pos == state.size());
+}
+
@@ -21,6 +21,10 @@
 
 //  $Id: control.cc,v 1.54 2008/07/09 12:56:23 gdiso Exp $
 
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+
 #include "genius_common.h"
 
 #ifdef WINDOWS
@@ -67,11 +71,8 @@
 #include "mixA3/mixA3.h"
 
 #include "hall/hall.h"
-
-// only commercial product support half implicit method
-#ifdef COGENDA_COMMERCIAL_PRODUCT
-  #include  "gummel/ddm1_half_implicit.h"
-#endif
+#include "gummel/gummel.h"
+#include "gummel/ddm1_half_implicit.h"
 
 
 #include "stress_solver/stress_solver.h"
@@ -80,10 +81,12 @@
 #include "solver_specify.h"
 #include "advanced_model.h"
 #include "petsc_type.h"
+#include "fvm_pde_solver.h"
 
 #include "interpolation_2d_csa.h"
 #include "interpolation_3d_qshep.h"
 #include "interpolation_3d_nbtet.h"
+#include "interpolation_mesh.h"
 
 #include "dlhook.h"
 #ifndef DLLHOOK
@@ -93,6 +96,9 @@
  #include "probe_hook.h"
  #include "vtk_hook.h"
 #include "cgns_hook.h"
+#include "hdf5_hook.h"
+#include "snapshot_hook.h"
+#include "jdump_hook.h"
 #endif
 
 
@@ -102,6 +108,11 @@
 #endif
 
 #include "parallel.h"
+#include "random_stream.h"
+#include "semiconductor_region.h"
+#include "material.h"
+#include "solver_counters.h"
+#include "startup_log.h"
 #include "MXMLUtil.h"
 #include "TRexpp.h"
 
@@ -119,7 +130,7 @@ using PhysicalUnit::cm;
 
 //------------------------------------------------------------------------------
 SolverControl::SolverControl()
-    : _decks(NULL), _mesh(NULL), _system(NULL)
+    : _decks(NULL), _mesh(NULL), _system(NULL), _open_solver(NULL), _open_solver_group(NULL), _nested_solve(false)
 {
   _dom_solution = mxmlNewXML("1.0");
   mxmlNewElement(_dom_solution, "genius-solutions");
@@ -127,6 +138,7 @@ SolverControl::SolverControl()
 
 SolverControl::~SolverControl()
 {
+  close_solver();
   mxmlDelete(_dom_solution);
   _dom_solution=NULL;
 }
@@ -160,6 +172,9 @@ void SolverControl::setDecks(Parser::InputParser *input)
 
 int SolverControl::reset_simulation_system()
 {
+  // the open solver holds the old system
+  close_solver();
+
   if (_decks == NULL)
     return 0;
 
@@ -245,16 +260,86 @@ int SolverControl::mainloop()
       this->plot_mesh( c );
   }
 
+  if( Genius::n_sweep_groups() > 1 )
+    this->merge_sweep_output();
+
   return 0;
 }
 
 
+//------------------------------------------------------------------------------
+void SolverControl::merge_sweep_output()
+{
+#ifdef HAVE_MPI
+  // wait for all the groups finish their sweep branch
+  MPI_Barrier(Genius::comm_farm());
+
+  int farm_rank, farm_size;
+  MPI_Comm_rank(Genius::comm_farm(), &farm_rank);
+  MPI_Comm_size(Genius::comm_farm(), &farm_size);
+
+  // only the root of each group holds the IV table, pack the base names as '\n' separated string
+  std::string names;
+  if( Genius::processor_id() == 0 )
+    for(std::set<std::string>::const_iterator it=_sweep_prefix.begin(); it!=_sweep_prefix.end(); ++it)
+      names += *it + '\n';
+
+  int length = names.size();
+  std::vector<int> lengths(farm_size, 0);
+  MPI_Gather(&length, 1, MPI_INT, &lengths[0], 1, MPI_INT, 0, Genius::comm_farm());
+
+  std::vector<int> offsets(farm_size, 0);
+  for(int i=1; i<farm_size; ++i)
+    offsets[i] = offsets[i-1] + lengths[i-1];
+
+  std::vector<char> buffer(offsets[farm_size-1] + lengths[farm_size-1] + 1, '\0');
+  MPI_Gatherv(const_cast<char *>(names.c_str()), length, MPI_CHAR, &buffer[0], &lengths[0], &offsets[0], MPI_CHAR, 0, Genius::comm_farm());
+
+  if( farm_rank != 0 ) return;
+
+  std::set<std::string> prefix;
+  {
+    std::stringstream ss(std::string(&buffer[0]));
+    std::string name;
+    while( std::getline(ss, name) )
+      if( !name.empty() ) prefix.insert(name);
+  }
+
+  for(std::set<std::string>::const_iterator it=prefix.begin(); it!=prefix.end(); ++it)
+  {
+    std::ofstream out((*it + ".dat").c_str());
+    bool header = true;
+    for(unsigned int g=0; g<Genius::n_sweep_groups(); ++g)
+    {
+      std::stringstream fname;
+      fname << *it << ".g" << g << ".dat";
+      std::ifstream in(fname.str().c_str());
+      if( !in.good() ) continue;
+
+      out << std::endl << "# sweep group " << g << std::endl;
+      std::string line;
+      while( std::getline(in, line) )
+      {
+        // keep the column header of the first table only
+        if( !line.empty() && line[0] == '#' && !header ) continue;
+        out << line << std::endl;
+      }
+      header = false;
+    }
+    MESSAGE<<"Sweep farm: merge IV table of " << Genius::n_sweep_groups() << " groups into " << *it << ".dat" << std::endl; RECORD();
+  }
+#endif
+}
+
+
 //------------------------------------------------------------------------------
 int  SolverControl::do_mesh()
 {
 
   if ( decks().is_card_exist("MESH") )
   {
+    startup_log.begin("mesh generation");
+
     // build meshgenerator only on processor 0
     // I am afraid about mesh generator may have different
     // behavior due to float point round-off error
@@ -309,8 +394,11 @@ int  SolverControl::do_mesh()
     // since we only build mesh on processor 0,
     // sync mesh to other processors.
     // this procedure also prepare the mesh for using
+    startup_log.end();
+    startup_log.begin("mesh broadcast");
     MeshCommunication mesh_comm;
     mesh_comm.broadcast(mesh());
+    startup_log.end();
 
     // please note, until here, mesh is still not prepared
     // mesh.is_prepared() will return false
@@ -332,23 +420,27 @@ int SolverControl::do_process()
   // if doping profile card exist
   if ( decks().is_card_exist("DOPING") )
   {
+    startup_log.begin("doping profile");
     DopingSolver = AutoPtr<SolverBase>( new DopingAnalytic(system(), decks()) );
     // parse "PROFILE" card
     DopingSolver->create_solver();
     // set doping profile to semiconductor region
     DopingSolver->solve();
     // we will not destroy the doping solver here
+    startup_log.end();
   }
 
   // if mole card exist
   if ( decks().is_card_exist("MOLE") )
   {
+    startup_log.begin("mole fraction");
     MoleSolver = AutoPtr<SolverBase>( new MoleAnalytic(system(), decks()) );
     // parse "MOLE" card
     MoleSolver->create_solver();
     // set mole fraction to semiconductor region
     MoleSolver->solve();
     // we will not destroy the mole solver here
+    startup_log.end();
   }
 
   // after doping profile and mole is set, we can init system data.
@@ -356,8 +448,10 @@ int SolverControl::do_process()
 
   // note: even no mesh and/or process are done, we can still call it safely
   // although it will do nothing
+  startup_log.begin("region init");
   system().init_region();
   system().init_region_post_process();
+  startup_log.end();
 
   return 0;
 }
@@ -380,9 +474,65 @@ int SolverControl::set_method ( const Parser::Card & c )
   // set preconditioner type
   SolverSpecify::PC = SolverSpecify::preconditioner_type(c.get_string("pc", "lu"));
 
+  // set the composition of field split preconditioner
+  SolverSpecify::FieldSplitType = c.get_string("fieldsplit.type", "multiplicative");
+
+  // set the composition of region schwarz preconditioner
+  SolverSpecify::RegionASMType = c.get_string("regionasm.type", "restrict");
+
+  // set matrix type of jacobian matrix, device matrix types move the linear solver to the device
+  SolverSpecify::MatrixType = c.get_string("matrix.type", "aij");
+
   // set preconditioner lag
   SolverSpecify::NSLagPCLU                  = c.get_int("pclu.lag", 10);
 
+  // set jacobian lag for dcsweep and transient
+  SolverSpecify::NSLagJacobian              = c.get_int("jacobian.lag", 1);
+
+  // secant updates of broyden nonlinear solver
+  SolverSpecify::BroydenMemory              = c.get_int("broyden.memory", 10);
+  SolverSpecify::BroydenRestart             = c.get_real("broyden.restart", 0.5);
+
+  // inexact newton and jacobian-free newton-krylov
+  SolverSpecify::InexactNewton              = c.get_bool("inexact.newton", false);
+  SolverSpecify::PoissonAMG                 = c.get_bool("poisson.amg", false);
+  SolverSpecify::JFNK                       = c.get_bool("jfnk", false);
+  SolverSpecify::JFNKLagPC                  = c.get_int("jfnk.lag", 5);
+
+  // residual and jacobian by one pass
+  SolverSpecify::FusedAssembly              = c.get_bool("fused.assembly", false);
+
+  // choose krylov or direct linear solver by the measured cost
+  SolverSpecify::AdaptiveLinearSolver       = c.get_bool("ls.adaptive", false);
+  SolverSpecify::AdaptiveKSPIts             = c.get_int("ls.adaptive.its", 100);
+
+  // reuse the preconditioner of krylov solver
+  SolverSpecify::PCLag                      = c.get_int("pc.lag", 1);
+  SolverSpecify::PCLagGrowth                = c.get_real("pc.lag.growth", 3.0);
+  SolverSpecify::FreezeTol                  = c.get_real("freeze.tol", 0.0);
+  SolverSpecify::FreezeIts                  = c.get_int("freeze.its", 3);
+  SolverSpecify::FreezeWake                 = c.get_real("freeze.wake", 10.0);
+  SolverSpecify::SpiceBypassTol             = c.get_real("spice.bypass.tol", 0.0);
+
+  // reuse symbolic factorization of jacobian matrix
+  SolverSpecify::ReuseSymbolicFactorization = c.get_bool("symbolic.reuse", true);
+
+  // reuse cached nonzero pattern of jacobian matrix
+  SolverSpecify::CacheNonzeroPattern        = c.get_bool("pattern.cache", true);
+
+  // warm start of krylov solver
+  SolverSpecify::KSPWarmStart               = c.get_bool("ksp.warmstart", false);
+
+  // mixed precision direct solver and compression of LU factors
+  SolverSpecify::LUSinglePrecision          = c.is_enum_value("lu.precision", "single");
+  SolverSpecify::LURefinement               = c.get_string("lu.refine", "gmres");
+  SolverSpecify::LUBlockLowRank             = c.get_bool("lu.blr", false);
+  SolverSpecify::LUBlockLowRankTol          = c.get_real("lu.blr.tol", 1e-8);
+  SolverSpecify::LUOrdering                 = c.get_string("lu.ordering", "nd");
+
+  // repartition the mesh when the load of solve command turns out imbalanced
+  SolverSpecify::RepartitionImbalance       = c.get_real("repartition.imbalance", 0.0);
+
   // set Newton damping type
   if(c.is_parameter_exist("damping"))
   {
@@ -415,6 +565,12 @@ int SolverControl::set_method ( const Parser::Card & c )
   SolverSpecify::ArtificialCarrier          = c.get_bool("halfimplicit.artificialcarrier", true);
   SolverSpecify::ReSolveCarrier             = c.get_bool("halfimplicit.resolvecarrier", false);
   SolverSpecify::PoissonCorrectionParameter = c.get_real("halfimplicit.carrierweight", 0.0);
+  SolverSpecify::HalfImplicitCFL            = c.get_real("halfimplicit.cfl", 0.5);
+
+  // gummel method
+  SolverSpecify::GummelMaxIteration         = c.get_int("gummel.maxit", 50);
+  SolverSpecify::GummelPotentialToler       = c.get_real("gummel.tol", 1e-4)*V;
+  SolverSpecify::GummelNewton               = c.get_bool("gummel.newton", true);
 
 
   // ksp convergence test
@@ -459,6 +615,7 @@ int SolverControl::set_method ( const Parser::Card & c )
     else if (c.is_enum_value("type", "ebml3m"))             SolverSpecify::Solver = SolverSpecify::EBML3MIXA;
     else if (c.is_enum_value("type", "ddmac"))              SolverSpecify::Solver = SolverSpecify::DDMAC;
     else if (c.is_enum_value("type", "halfimplicit"))       SolverSpecify::Solver = SolverSpecify::HALF_IMPLICIT;
+    else if (c.is_enum_value("type", "gummel"))             SolverSpecify::Solver = SolverSpecify::GUMMEL;
   }
 
   return 0;
@@ -518,20 +675,29 @@ int SolverControl::set_model ( const Parser::Card & c )
 
   // band to band tunneling
   model.BandBandTunneling = false;
+  model.BandBandTunnelingNonlocal = false;
   if(c.is_parameter_exist("bandbandtunneling") || c.is_parameter_exist("bbt"))
   {
     if(c.is_enum_value("bandbandtunneling", "local") || c.is_enum_value("bbt", "local"))
     {
       model.BandBandTunneling = true;
     }
+    if(c.is_enum_value("bandbandtunneling", "nonlocal") || c.is_enum_value("bbt", "nonlocal"))
+    {
+      model.BandBandTunnelingNonlocal = true;
+    }
   }
+  model.BBTNonlocalDPsi      = c.get_real("bbt.dpsi", 0.02)*V;
+  model.BBTNonlocalMaxLength = c.get_real("bbt.maxlength", 0.1)*um;
 
   // fermi statistics and incomplete ionization
   model.Fermi                 = c.get_bool("fermi", false);
+  model.FermiTable            = c.get_bool("fermi.table", false);
   model.IncompleteIonization  = c.get_bool("incompleteionization", false);
 
   // charge trapping model
   model.Trap                  = c.get_bool("trap",false);
+  model.TrapExplicit          = c.get_bool("trap.explicit",false);
 
   //energy balance advanced model
   if(c.is_parameter_exist("eb.level"))
@@ -614,6 +780,17 @@ int SolverControl::do_hook( const Parser::Card & c )
         plist.push_back(p);
     }
     SolverSpecify::Hooks.insert( std::make_pair(id, std::make_pair(dll_name, plist)));
+
+    // execution policy
+    int every = c.get_int("every", 1);
+    double interval = c.get_real("interval", 0.0);
+    if( every < 1 )
+    {
+      MESSAGE<<"ERROR at " <<c.get_fileline()<< " HOOK: every should be a positive integer." << std::endl; RECORD();
+      genius_error();
+    }
+    SolverSpecify::HookSchedule[id] = std::make_pair(every, interval);
+    SolverSpecify::HookReport[id]   = c.get_bool("report", false);
   }
 
 
@@ -626,7 +803,11 @@ int SolverControl::do_hook( const Parser::Card & c )
       id = c.get_string("unload", "");
 
     if (SolverSpecify::Hooks.find(id) != SolverSpecify::Hooks.end())
+    {
       SolverSpecify::Hooks.erase(id);
+      SolverSpecify::HookSchedule.erase(id);
+      SolverSpecify::HookReport.erase(id);
+    }
     else
     {
       MESSAGE<<"Warning at " <<c.get_fileline()<< " HOOK: hook " << id << " can't be found for unloading." << std::endl; RECORD();
@@ -640,6 +821,287 @@ int SolverControl::do_hook( const Parser::Card & c )
 int SolverControl::do_solve( const Parser::Card & c )
 {
 
+  // in sweep farm mode, each group only does its own sweep branch
+  if( Genius::n_sweep_groups() > 1 && c.is_parameter_exist("branch") )
+  {
+    int branch = c.get_int("branch", 0);
+    if( branch % static_cast<int>(Genius::n_sweep_groups()) != static_cast<int>(Genius::sweep_group()) )
+    {
+      MESSAGE<<"Sweep farm: skip SOLVE branch " << branch << " at " << c.get_fileline() << ", it belongs to another sweep group." << std::endl; RECORD();
+      return 0;
+    }
+  }
+
+  // nested iteration: solve on the coarse levels of the hierarchical mesh first
+  if( c.get_int("nested.level", 0) > 0 && !_nested_solve &&
+      ( c.is_enum_value("type", "equilibrium") || c.is_enum_value("type", "steadystate") || c.is_enum_value("type", "op") ) )
+    return this->do_nested_solve(c);
+
+  // SolverSpecify is shared with the open solver
+  close_solver();
+
+  // set the parameters of solve command to SolverSpecify
+  this->set_solve_parameters(c);
+
+  SolverBase * solver = this->new_solver();
+
+  if (solver)
+  {
+    solver->set_label(SolverSpecify::label);
+
+    // create a solution group;
+    mxml_node_t *eGroup = NULL;
+    {
+      mxml_node_t *eRoot = mxmlFindElement(_dom_solution, _dom_solution, "genius-solutions", NULL, NULL, MXML_DESCEND_FIRST);
+      eGroup = mxmlNewElement(eRoot, "solution-group");
+      mxml_node_t *eLabel = mxmlNewElement(eGroup, "label");
+      mxmlAdd(eLabel, MXML_ADD_AFTER, NULL, MXMLQVariant::makeQVString(solver->label()));
+
+      solver->set_solution_dom_root(eGroup);
+    }
+
+    // init (user defined) hook functions here
+
+    if( SolverSpecify::Type == SolverSpecify::DCSWEEP   ||
+        SolverSpecify::Type == SolverSpecify::BSWEEP    ||
+        SolverSpecify::Type == SolverSpecify::OP        ||
+        SolverSpecify::Type == SolverSpecify::TRANSIENT ||
+        SolverSpecify::Type == SolverSpecify::HARMONIC  ||
+        SolverSpecify::Type == SolverSpecify::TRACE     ||
+        SolverSpecify::Solver == SolverSpecify::DDMAC
+      )
+    {
+      // gnuplot hook, write electrode IV in gnuplot file format, as default hook
+#ifdef DLLHOOK
+      Hook * gnuplot_hook =  new DllHook(*solver, "gnuplot_hook", (void *)(Genius::input_file()));
+      solver->add_hook(gnuplot_hook);
+#else
+      // for windows platform, dynamic link is not supported. we have to use static link.
+      // it is not as flexible as unix/linux platform.
+      Hook * gnuplot_hook =  new GnuplotHook(*solver, "gnuplot_hook", (void *)Genius::input_file());
+      solver->add_hook(gnuplot_hook);
+#endif
+
+    }
+
+#ifdef DLLHOOK
+    // dynamic load user defined hooks, stupid win32 platform does not support this function.
+    for (std::map<std::string, std::pair<std::string, std::vector<Parser::Parameter> > >::iterator it=SolverSpecify::Hooks.begin();
+         it!=SolverSpecify::Hooks.end(); it++)
+    {
+      const std::vector<Parser::Parameter> & parm_list = it->second.second;
+      Hook * hook = new DllHook(*solver, (it->second.first)+"_hook", (void *)&parm_list);
+      hook->set_schedule(SolverSpecify::HookSchedule[it->first].first, SolverSpecify::HookSchedule[it->first].second,
+                         SolverSpecify::HookReport[it->first]);
+      solver->add_hook( hook );
+    }
+
+#else
+    // load static user defined hooks, only support predefined hooks, sigh
+    for (std::map<std::string, std::pair<std::string, std::vector<Parser::Parameter> > >::iterator it=SolverSpecify::Hooks.begin();
+         it!=SolverSpecify::Hooks.end(); it++)
+    {
+      Hook * hook=NULL;
+
+      if((*it).second.first=="cgns")
+        hook = new CGNSHook(*solver, "cgns_hook", (void *)(&(it->second.second)));
+      if((*it).second.first=="vtk")
+        hook = new VTKHook(*solver, "vtk_hook", (void *)(&(it->second.second)));
+      if((*it).second.first=="hdf5")
+        hook = new HDF5Hook(*solver, "hdf5_hook", (void *)(&(it->second.second)));
+      if((*it).second.first=="snapshot")
+        hook = new SnapshotHook(*solver, "snapshot_hook", (void *)(&(it->second.second)));
+      if((*it).second.first=="jdump")
+        hook = new JacobianDumpHook(*solver, "jdump_hook", (void *)(&(it->second.second)));
+      if((*it).second.first=="cv")
+        hook = new CVHook (*solver, "cv_hook",  (void *)(&(it->second.second)));
+      if((*it).second.first=="probe")
+        hook = new ProbeHook (*solver, "probe_hook",  (void *)(&(it->second.second)));
+      if((*it).second.first=="rawfile")
+        hook = new RawFileHook (*solver, "rawfile_hook",  (void *)(&(it->second.second)));
+
+      if(hook)
+      {
+        hook->set_schedule(SolverSpecify::HookSchedule[it->first].first, SolverSpecify::HookSchedule[it->first].second,
+                           SolverSpecify::HookReport[it->first]);
+        solver->add_hook(hook);
+      }
+    }
+
+#endif
+
+    {
+      // always load the control hook. We load it last, such that it is called last
+      SolverControlHook * control_hook =  new SolverControlHook(*solver, "control_hook", *this, _fname_solution);
+      solver->add_hook(control_hook);
+    }
+
+    // user requires performance report of this solve command
+    const std::string perf_report = c.get_string("perf.report", "");
+    const bool perf_logging = perflog.logging();
+    if( !perf_report.empty() )
+    {
+      perflog.enable_logging();
+      perflog.begin_report();
+    }
+
+    // user requires the event timeline of all the processors
+    const std::string perf_trace = c.get_string("perf.trace", "");
+    if( !perf_trace.empty() )
+    {
+      perflog.enable_logging();
+      perflog.begin_trace();
+    }
+
+    // counters of solver internals are collected for each solve command
+    solver_counters.reset();
+
+    startup_log.begin("solver setup");
+    solver->create_solver();
+    startup_log.end();
+
+    // user requires the breakdown of startup phases, the phases since last report are printed
+    if( c.get_bool("startup.report", false) && !startup_log.empty() )
+    {
+      startup_log.print();
+      startup_log.clear();
+    }
+
+    // user requires memory breakdown at solve start
+    if( c.get_bool("memory.report", false) )
+    {
+      std::map<std::string, size_t> usage;
+      solver->memory_usage(usage);
+
+      // sum over all the processors, the entries are the same on each processor
+      std::vector<Real> mem;
+      std::map<std::string, size_t>::const_iterator it = usage.begin();
+      for( ; it != usage.end(); ++it)
+        mem.push_back( static_cast<Real>(it->second) );
+      mem.push_back( static_cast<Real>(Genius::memory_size().second) );
+      Parallel::sum(mem);
+
+      const Real MB = 1024.0*1024.0;
+      Real total = 0.0;
+      const std::ios::fmtflags flags = MESSAGE.flags();
+      const std::streamsize precision = MESSAGE.precision();
+      MESSAGE<<"Memory usage of all the processors (MB):\n";
+      unsigned int i = 0;
+      for( it = usage.begin(); it != usage.end(); ++it, ++i)
+      {
+        MESSAGE<<"  "<<std::setw(45)<<std::left<<it->first<<std::right<<std::fixed<<std::setprecision(1)<<std::setw(10)<<mem[i]/MB<<'\n';
+        total += mem[i];
+      }
+      MESSAGE<<"  "<<std::setw(45)<<std::left<<"total (estimated)"<<std::right<<std::setw(10)<<total/MB<<'\n';
+      MESSAGE<<"  "<<std::setw(45)<<std::left<<"resident set size"<<std::right<<std::setw(10)<<mem.back()/MB<<"\n\n";
+      MESSAGE.flags(flags);
+      MESSAGE.precision(precision);
+      RECORD();
+    }
+
+    PetscLogDouble t_solve_start, t_solve_end;
+    PetscGetTime(&t_solve_start);
+
+    if( SolverSpecify::EnsembleSize > 0 )
+      this->solve_ensemble(solver);
+    else
+      solver->solve();
+
+    PetscGetTime(&t_solve_end);
+
+    // node dofs of each region, used for partition weight
+    std::vector<unsigned int> subdomain_node_dofs;
+    if( const FVM_PDESolver * pde_solver = dynamic_cast<const FVM_PDESolver *>(solver) )
+      for(unsigned int r=0; r<system().n_regions(); ++r)
+        subdomain_node_dofs.push_back(pde_solver->node_dofs(system().region(r)));
+
+    solver->destroy_solver(); // hooks are deleted here
+
+    if( !perf_report.empty() )
+    {
+      perflog.end_report();
+
+      // the report is written in CSV format if the file name ends with .csv, otherwise JSON
+      if (Genius::processor_id()==0)
+      {
+        const std::string title = c.get_string("type", "") + " at " + c.get_fileline();
+        const bool csv = perf_report.size() > 4 && perf_report.substr(perf_report.size()-4) == ".csv";
+        std::ofstream fout(perf_report.c_str());
+        fout << (csv ? perflog.get_report_csv(title) : perflog.get_report_json(title));
+      }
+
+      MESSAGE<<"Performance report of this solve command is written to "<<perf_report<<"\n\n"; RECORD();
+
+      if( !perf_logging && perf_trace.empty() ) perflog.disable_logging();
+    }
+
+    if( !perf_trace.empty() )
+    {
+      perflog.end_trace();
+
+      // both are collective
+      const std::string trace = perflog.get_trace_json();
+      const std::string summary = perflog.get_imbalance_summary();
+      if (Genius::processor_id()==0)
+      {
+        std::ofstream fout(perf_trace.c_str());
+        fout << trace;
+      }
+
+      MESSAGE<<summary<<"Event timeline of this solve command is written to "<<perf_trace<<"\n\n"; RECORD();
+
+      if( !perf_logging ) perflog.disable_logging();
+    }
+
+    // user requires counters of solver internals
+    const std::string counters_report = c.get_string("counters.report", "");
+    if( !counters_report.empty() )
+    {
+      const std::string title = c.get_string("type", "") + " at " + c.get_fileline();
+      const std::string json = solver_counters.get_report_json(title); // collective
+      if (Genius::processor_id()==0)
+      {
+        std::ofstream fout(counters_report.c_str());
+        fout << json;
+      }
+
+      MESSAGE<<"Solver counters of this solve command are written to "<<counters_report<<"\n\n"; RECORD();
+    }
+
+    {
+      // if there is a solution in the group, add it to the solution document
+      if (mxmlFindElement(eGroup, eGroup, "solution", NULL, NULL, MXML_DESCEND_FIRST)==NULL)
+      {
+        mxmlDelete(eGroup);
+      }
+    }
+
+    delete solver;
+
+    // measured load imbalance of this solve command, repartition the mesh if required
+    if( SolverSpecify::RepartitionImbalance >= 1.0 && Genius::n_processors() > 1 && !subdomain_node_dofs.empty() )
+    {
+      Real t_max = t_solve_end - t_solve_start;
+      Real t_sum = t_max;
+      Parallel::max(t_max);
+      Parallel::sum(t_sum);
+      const Real imbalance = t_sum > 0.0 ? t_max/(t_sum/Genius::n_processors()) : 1.0;
+
+      MESSAGE<<"Load imbalance of solve command (max/average time): " << imbalance << "\n" << std::endl; RECORD();
+
+      if( imbalance > SolverSpecify::RepartitionImbalance )
+        this->do_repartition(subdomain_node_dofs);
+    }
+  }
+
+  return 0;
+}
+
+
+
+
+int SolverControl::set_solve_parameters( const Parser::Card & c )
+{
   // set solution type solver will do
   SolverSpecify::Type = SolverSpecify::INVALID_SolutionType;
   if(c.is_parameter_exist("type"))
@@ -648,6 +1110,53 @@ int SolverControl::do_solve( const Parser::Card & c )
   if(c.is_parameter_exist("label"))
     SolverSpecify::label = c.get_string("label", "");
 
+  // adjoint sensitivity of terminal current to device parameters
+  SolverSpecify::AdjointCurrent.clear();
+  SolverSpecify::AdjointParameter.clear();
+  for(unsigned int n=0; n<c.parameter_count("adjoint.current"); n++)
+  {
+    std::string electrode = c.get_n_string("adjoint.current", "", n, 0);
+    if( system().get_bcs()->get_bc(electrode) == NULL || system().get_bcs()->get_bc(electrode)->is_electrode() == false )
+    {
+      MESSAGE<<"ERROR at " <<c.get_fileline()<< " SOLVE: Electrode " << electrode << " can't be found in device structure." << std::endl; RECORD();
+      genius_error();
+    }
+    SolverSpecify::AdjointCurrent.push_back(electrode);
+  }
+  for(unsigned int n=0; n<c.parameter_count("adjoint.param"); n++)
+  {
+    std::string param = c.get_n_string("adjoint.param", "", n, 0);
+    if( param.find("doping:") != 0 && param.find("trap:") != 0 && param.find("workfunction:") != 0 && param.find("pmi:") != 0 )
+    {
+      MESSAGE<<"ERROR at " <<c.get_fileline()<< " SOLVE: Unknown adjoint parameter " << param << "." << std::endl; RECORD();
+      genius_error();
+    }
+    SolverSpecify::AdjointParameter.push_back(param);
+  }
+  SolverSpecify::AdjointFile = c.get_string("adjoint.file", "adjoint.dat");
+
+  // impedance field method of random dopant fluctuation
+  SolverSpecify::IFMCurrent.clear();
+  for(unsigned int n=0; n<c.parameter_count("ifm.current"); n++)
+  {
+    std::string electrode = c.get_n_string("ifm.current", "", n, 0);
+    if( system().get_bcs()->get_bc(electrode) == NULL || system().get_bcs()->get_bc(electrode)->is_electrode() == false )
+    {
+      MESSAGE<<"ERROR at " <<c.get_fileline()<< " SOLVE: Electrode " << electrode << " can't be found in device structure." << std::endl; RECORD();
+      genius_error();
+    }
+    SolverSpecify::IFMCurrent.push_back(electrode);
+  }
+  SolverSpecify::IFMSamples = c.get_int("ifm.samples", 0);
+  SolverSpecify::IFMSeed    = c.get_int("ifm.seed", 0);
+  SolverSpecify::IFMFile    = c.get_string("ifm.file", "ifm.dat");
+
+  // ensemble of random doping instances
+  SolverSpecify::EnsembleSize      = c.get_int("ensemble.size", 0);
+  SolverSpecify::EnsembleSeed      = c.get_int("ensemble.seed", 0);
+  SolverSpecify::EnsembleTrapSigma = c.get_real("ensemble.trap.sigma", 0.0);
+  SolverSpecify::EnsembleFile      = c.get_string("ensemble.file", "ensemble.dat");
+
   // set more detailed solution parameters
   switch (SolverSpecify::Type)
   {
@@ -717,6 +1226,11 @@ int SolverControl::do_solve( const Parser::Card & c )
         SolverSpecify::PseudoTimeStepMetal         = c.get_real("pseudotime.step.metal", 1e-10)*s;
         SolverSpecify::PseudoTimeStepMax           = c.get_real("pseudotime.stepmax", 1e-6)*s;
         SolverSpecify::PseudoTimeSteps             = c.get_int("pseudotime.iteration", 50);
+        SolverSpecify::PseudoTimeSER               = c.get_bool("pseudotime.ser", false);
+        SolverSpecify::PseudoTimeSERExponent       = c.get_real("pseudotime.ser.exponent", 1.0);
+        SolverSpecify::PseudoTimeSERGrowth         = c.get_real("pseudotime.ser.growth", 10.0);
+        SolverSpecify::PseudoTimeLocal             = c.get_bool("pseudotime.local", false);
+        SolverSpecify::PseudoTimeNewtonSwitch      = c.get_real("pseudotime.newton.switch", 0.0);
         SolverSpecify::VStepMax                    = c.get_real("vstepmax", 0.1)*V;
         SolverSpecify::IStepMax                    = c.get_real("istepmax", 1e-6)*A;
         break;
@@ -841,6 +1355,9 @@ int SolverControl::do_solve( const Parser::Card & c )
         }
 
         SolverSpecify::Predict       = c.get_bool("predict", true);
+        SolverSpecify::PredictTangent= c.is_enum_value("predict.type", "tangent");
+        SolverSpecify::SmallSignalFile = c.get_string("smallsignal.file", "");
+        SolverSpecify::SolutionCachePrefix = c.get_string("cache.prefix", "");
 
         SolverSpecify::OptG          = c.get_bool("optical.gen", false);
         SolverSpecify::PatG          = c.get_bool("particle.gen", false);
@@ -920,6 +1437,14 @@ int SolverControl::do_solve( const Parser::Card & c )
         SolverSpecify::FStop     = c.get_real("f.stop", 10e9)/s;
         SolverSpecify::FMultiple = c.get_real("f.multiple", 1.1);
         SolverSpecify::VAC       = c.get_real("vac", 0.0026)*V;
+        SolverSpecify::ACFreqGroups = c.get_int("f.groups", 1) > 1 ? c.get_int("f.groups", 1) : 1;
+        SolverSpecify::ACMOR        = c.get_bool("mor", false);
+        SolverSpecify::ACMORPoints  = c.get_int("mor.points", 4) > 1 ? c.get_int("mor.points", 4) : 1;
+        SolverSpecify::ACMORMoments = c.get_int("mor.moments", 2) > 0 ? c.get_int("mor.moments", 2) : 0;
+        SolverSpecify::ACMORCheck   = c.get_int("mor.check", 2) > 0 ? c.get_int("mor.check", 2) : 0;
+        SolverSpecify::ACNPort      = c.get_bool("nport", false);
+        SolverSpecify::ACNPortFile  = c.get_string("nport.file", "nport.dat");
+        SolverSpecify::ACNPortZ0    = c.get_real("nport.z0", 50.0)*V/A;
 
         unsigned int elec_num = c.parameter_count("acscan");
         for(unsigned int n=0; n<elec_num; n++)
@@ -933,9 +1458,9 @@ int SolverControl::do_solve( const Parser::Card & c )
           SolverSpecify::Electrode_ACScan.push_back(electrode);
         }
 
-        if( SolverSpecify::Electrode_ACScan.size() != 1 )
+        if( SolverSpecify::Electrode_ACScan.empty() || (SolverSpecify::Electrode_ACScan.size() > 1 && !SolverSpecify::ACNPort) )
         {
-          MESSAGE<<"ERROR at " <<c.get_fileline()<< " SOLVE: You must specify one electrode for AC scan."<<std::endl; RECORD();
+          MESSAGE<<"ERROR at " <<c.get_fileline()<< " SOLVE: You must specify one electrode for AC scan, or set nport for more electrodes."<<std::endl; RECORD();
           genius_error();
         }
 
@@ -944,6 +1469,48 @@ int SolverControl::do_solve( const Parser::Card & c )
         break;
       }
 
+      case SolverSpecify::BSWEEP     :
+      {
+        if( SolverSpecify::Solver != SolverSpecify::HALLDDML1 )
+        {
+          MESSAGE<<"ERROR at " <<c.get_fileline()<< " SOLVE: Magnetic field sweep requires hall solver." << std::endl; RECORD();
+          genius_error();
+        }
+
+        // magnetic field in tesla
+        const double T = V/(PhysicalUnit::m*PhysicalUnit::m)*s;
+        SolverSpecify::BStart    = c.get_real("bstart", 0.0)*T;
+        SolverSpecify::BStep     = c.get_real("bstep", 0.1)*T;
+        SolverSpecify::BStop     = c.get_real("bstop", 1.0)*T;
+        SolverSpecify::BDirection = 2;
+        if (c.is_enum_value("b.dir", "x"))  SolverSpecify::BDirection = 0;
+        if (c.is_enum_value("b.dir", "y"))  SolverSpecify::BDirection = 1;
+        SolverSpecify::BPerturb  = c.get_bool("b.perturb", false);
+        SolverSpecify::Predict   = c.get_bool("predict", true);
+
+        if(SolverSpecify::BStep == 0.0)
+        {
+          MESSAGE<<"ERROR at " <<c.get_fileline()<< " SOLVE: BStep shoud not be zero."<<std::endl; RECORD();
+          genius_error();
+        }
+        break;
+      }
+
+      case SolverSpecify::HARMONIC  :
+      {
+        if( SolverSpecify::Solver != SolverSpecify::DDML1 )
+        {
+          MESSAGE<<"ERROR at " <<c.get_fileline()<< " SOLVE: Harmonic balance requires DDML1 solver." << std::endl; RECORD();
+          genius_error();
+        }
+
+        SolverSpecify::HBFrequency = c.get_real("hb.freq", 1e6)/s;
+        SolverSpecify::HBHarmonics = c.get_int("hb.harmonics", 3) > 0 ? c.get_int("hb.harmonics", 3) : 1;
+        SolverSpecify::HBRelTol    = c.get_real("hb.rtol", 1e-6);
+        SolverSpecify::HBKSPRelTol = c.get_real("hb.ksp.rtol", 1e-4);
+        break;
+      }
+
       case SolverSpecify::TRANSIENT  :
       {
         SolverSpecify::TimeDependent = true;
@@ -980,6 +1547,28 @@ int SolverControl::do_solve( const Parser::Card & c )
           if (c.is_enum_value("ts", "bdf2"))            SolverSpecify::TS_type = SolverSpecify::BDF2;
         }
 
+        SolverSpecify::TS_controller = SolverSpecify::STEP_HEURISTIC;
+        if(c.is_parameter_exist("ts.controller"))
+        {
+          if (c.is_enum_value("ts.controller", "heuristic")) SolverSpecify::TS_controller = SolverSpecify::STEP_HEURISTIC;
+          if (c.is_enum_value("ts.controller", "pi"))        SolverSpecify::TS_controller = SolverSpecify::STEP_PI;
+        }
+
+        // lattice heat equation solved every heat.split carrier steps
+        SolverSpecify::HeatSplit    = c.get_int("heat.split", 0);
+        SolverSpecify::HeatSplitAMG = c.get_bool("heat.amg", true);
+
+        // periodic steady state by shooting method
+        SolverSpecify::Shooting             = c.get_bool("shooting", false);
+        SolverSpecify::ShootingPeriod       = c.get_real("shooting.period", 0.0)*s;
+        SolverSpecify::ShootingMaxIteration = c.get_int("shooting.maxit", 10);
+        SolverSpecify::ShootingKSPRelTol    = c.get_real("shooting.ksp.rtol", 1e-3);
+        if( SolverSpecify::Shooting && SolverSpecify::ShootingPeriod <= 0.0 )
+        {
+          MESSAGE<<"ERROR at " <<c.get_fileline()<< " SOLVE: Shooting method requires a positive shooting.period."<<std::endl; RECORD();
+          genius_error();
+        }
+
         SolverSpecify::OptG          = c.get_bool("optical.gen", false);
         SolverSpecify::PatG          = c.get_bool("particle.gen", false);
         SolverSpecify::SourceCoupled = c.get_bool("source.coupled", false);
@@ -1007,11 +1596,26 @@ int SolverControl::do_solve( const Parser::Card & c )
   }
 
   SolverSpecify::out_prefix = c.get_string("out.prefix", "result");
+  if( Genius::n_sweep_groups() > 1 )
+  {
+    // each sweep group writes its own IV table, merged at the end of main loop
+    _sweep_prefix.insert(SolverSpecify::out_prefix);
+    std::stringstream ss;
+    ss << SolverSpecify::out_prefix << ".g" << Genius::sweep_group();
+    SolverSpecify::out_prefix = ss.str();
+  }
   SolverSpecify::out_append = c.get_bool("out.append", false);
 
-  SolverBase * solver = NULL;
+  return 0;
+}
 
-  // call each solver here
+
+
+SolverBase * SolverControl::new_solver()
+{
+  SolverBase * solver = NULL;
+
+  // call each solver here
   switch (SolverSpecify::Solver)
   {
       case SolverSpecify::POISSON :
@@ -1066,107 +1670,195 @@ int SolverControl::do_solve( const Parser::Card & c )
         solver = new DDMACSolver(system());
         break;
       }
-#ifdef COGENDA_COMMERCIAL_PRODUCT
+      case SolverSpecify::GUMMEL :
+      {
+        solver = new GummelSolver(system());
+        break;
+      }
       case SolverSpecify::HALF_IMPLICIT :
       {
         solver = new DDM1HalfImplicitSolver(system());
         break;
       }
-#endif
       default: break;
       MESSAGE<<"ERROR: Selected solver is not supported at present." << std::endl; RECORD();
       break;
   }
 
-  if (solver)
+  return solver;
+}
+
+
+
+int SolverControl::open_solver( const Parser::Card & c )
+{
+  close_solver();
+
+  this->set_solve_parameters(c);
+
+  _open_solver.reset(this->new_solver());
+  if( _open_solver.get() == NULL ) return 1;
+
+  _open_solver->set_label(SolverSpecify::label);
+
+  // all the runs of the open solver share one solution group
   {
-    solver->set_label(SolverSpecify::label);
+    mxml_node_t *eRoot = mxmlFindElement(_dom_solution, _dom_solution, "genius-solutions", NULL, NULL, MXML_DESCEND_FIRST);
+    _open_solver_group = mxmlNewElement(eRoot, "solution-group");
+    mxml_node_t *eLabel = mxmlNewElement(_open_solver_group, "label");
+    mxmlAdd(eLabel, MXML_ADD_AFTER, NULL, MXMLQVariant::makeQVString(_open_solver->label()));
 
-    // create a solution group;
-    mxml_node_t *eGroup = NULL;
-    {
-      mxml_node_t *eRoot = mxmlFindElement(_dom_solution, _dom_solution, "genius-solutions", NULL, NULL, MXML_DESCEND_FIRST);
-      eGroup = mxmlNewElement(eRoot, "solution-group");
-      mxml_node_t *eLabel = mxmlNewElement(eGroup, "label");
-      mxmlAdd(eLabel, MXML_ADD_AFTER, NULL, MXMLQVariant::makeQVString(solver->label()));
+    _open_solver->set_solution_dom_root(_open_solver_group);
+  }
 
-      solver->set_solution_dom_root(eGroup);
-    }
+  SolverControlHook * control_hook =  new SolverControlHook(*_open_solver, "control_hook", *this, _fname_solution);
+  _open_solver->add_hook(control_hook);
 
-    // init (user defined) hook functions here
+  solver_counters.reset();
 
-    if( SolverSpecify::Type == SolverSpecify::DCSWEEP   ||
-        SolverSpecify::Type == SolverSpecify::OP        ||
-        SolverSpecify::Type == SolverSpecify::TRANSIENT ||
-        SolverSpecify::Type == SolverSpecify::TRACE     ||
-        SolverSpecify::Solver == SolverSpecify::DDMAC
-      )
-    {
-      // gnuplot hook, write electrode IV in gnuplot file format, as default hook
-#ifdef DLLHOOK
-      Hook * gnuplot_hook =  new DllHook(*solver, "gnuplot_hook", (void *)(Genius::input_file()));
-      solver->add_hook(gnuplot_hook);
-#else
-      // for windows platform, dynamic link is not supported. we have to use static link.
-      // it is not as flexible as unix/linux platform.
-      Hook * gnuplot_hook =  new GnuplotHook(*solver, "gnuplot_hook", (void *)Genius::input_file());
-      solver->add_hook(gnuplot_hook);
-#endif
+  _open_solver->create_solver();
 
-    }
+  return 0;
+}
 
-#ifdef DLLHOOK
-    // dynamic load user defined hooks, stupid win32 platform does not support this function.
-    for (std::map<std::string, std::pair<std::string, std::vector<Parser::Parameter> > >::iterator it=SolverSpecify::Hooks.begin();
-         it!=SolverSpecify::Hooks.end(); it++)
-    {
-      const std::vector<Parser::Parameter> & parm_list = it->second.second;
-      solver->add_hook( new DllHook(*solver, (it->second.first)+"_hook", (void *)&parm_list) );
-    }
 
-#else
-    // load static user defined hooks, only support predefined hooks, sigh
-    for (std::map<std::string, std::pair<std::string, std::vector<Parser::Parameter> > >::iterator it=SolverSpecify::Hooks.begin();
-         it!=SolverSpecify::Hooks.end(); it++)
-    {
-      Hook * hook=NULL;
 
-      if((*it).second.first=="cgns")
-        hook = new CGNSHook(*solver, "cgns_hook", (void *)(&(it->second.second)));
-      if((*it).second.first=="vtk")
-        hook = new VTKHook(*solver, "vtk_hook", (void *)(&(it->second.second)));
-      if((*it).second.first=="cv")
-        hook = new CVHook (*solver, "cv_hook",  (void *)(&(it->second.second)));
-      if((*it).second.first=="probe")
-        hook = new ProbeHook (*solver, "probe_hook",  (void *)(&(it->second.second)));
+int SolverControl::run_solver()
+{
+  if( _open_solver.get() == NULL ) return 1;
 
-      if(hook) solver->add_hook(hook);
-    }
+  // the solution of last run is the initial guess
+  return _open_solver->solve();
+}
 
-#endif
 
-    {
-      // always load the control hook. We load it last, such that it is called last
-      SolverControlHook * control_hook =  new SolverControlHook(*solver, "control_hook", *this, _fname_solution);
-      solver->add_hook(control_hook);
-    }
 
-    solver->create_solver();
-    solver->solve();
-    solver->destroy_solver(); // hooks are deleted here
+int SolverControl::close_solver()
+{
+  if( _open_solver.get() == NULL ) return 0;
 
-    {
-      // if there is a solution in the group, add it to the solution document
-      if (mxmlFindElement(eGroup, eGroup, "solution", NULL, NULL, MXML_DESCEND_FIRST)==NULL)
-      {
-        mxmlDelete(eGroup);
-      }
-    }
+  _open_solver->destroy_solver(); // hooks are deleted here
+  _open_solver.reset();
 
-    delete solver;
+  if (mxmlFindElement(_open_solver_group, _open_solver_group, "solution", NULL, NULL, MXML_DESCEND_FIRST)==NULL)
+    mxmlDelete(_open_solver_group);
+  _open_solver_group = NULL;
+
+  return 0;
+}
+
+
+
+int SolverControl::set_electrode_voltage( const std::string & electrode, double v )
+{
+  BoundaryCondition * bc = system().get_bcs()->get_bc(electrode);
+  if( bc == NULL || !bc->is_electrode() ) return 1;
+
+  system().get_electrical_source()->attach_voltage_to_electrode(electrode, v*V);
+  return 0;
+}
+
+
+
+int SolverControl::set_electrode_current( const std::string & electrode, double i )
+{
+  BoundaryCondition * bc = system().get_bcs()->get_bc(electrode);
+  if( bc == NULL || !bc->is_electrode() ) return 1;
+
+  system().get_electrical_source()->attach_current_to_electrode(electrode, i*A);
+  return 0;
+}
+
+
+
+int SolverControl::set_bc_parameter( const std::string & bc_label, const std::string & name, double value )
+{
+  BoundaryCondition * bc = system().get_bcs()->get_bc(bc_label);
+  if( bc == NULL || !bc->has_scalar(name) ) return 1;
+
+  bc->scalar(name) = value;
+  return 0;
+}
+
+
+
+int SolverControl::do_repartition(const std::vector<unsigned int> & subdomain_node_dofs)
+{
+  // the open solver holds the old system
+  close_solver();
+
+  MESSAGE<<"Repartition mesh with dof based weights...\n"<<std::endl; RECORD();
+
+  // save doping and mole fraction, the mesh is not changed, we only have to
+  // transfer node data to the processors own them after repartition
+  AutoPtr<InterpolationBase> interpolator;
+  if( mesh().mesh_dimension() == 2 )
+    interpolator = AutoPtr<InterpolationBase>(new Interpolation2D_CSA);
+  else
+    interpolator = AutoPtr<InterpolationBase>(new Interpolation3D_nbtet);
 
+  if( DopingSolver.get() == NULL )
+  {
+    system().fill_interpolator(interpolator.get(), "doping.na", InterpolationBase::Asinh);
+    system().fill_interpolator(interpolator.get(), "doping.nd", InterpolationBase::Asinh);
+  }
+
+  if(system().has_single_compound_semiconductor_region()  && MoleSolver.get() == NULL )
+  {
+    system().fill_interpolator(interpolator.get(), "mole.x", InterpolationBase::Linear);
+  }
+  if(system().has_complex_compound_semiconductor_region()  && MoleSolver.get() == NULL )
+  {
+    system().fill_interpolator(interpolator.get(), "mole.y", InterpolationBase::Linear);
   }
 
+  // save nodal solution, keyed by node location
+  system().backup_node_solution();
+
+  // gather mesh to processor 0 since we may have a distributed mesh
+  mesh().gather(0);
+
+  // clear the system. however we should reserve mesh information
+  system().clear(false);
+
+  // sync mesh to other processors.
+  MeshCommunication mesh_comm;
+  mesh_comm.broadcast(mesh());
+
+  // the weights are used by partitioner when building the simulation system
+  system().set_partition_weight(subdomain_node_dofs);
+
+  // now we can build solution system again
+  system().build_simulation_system();
+  system().sync_print_info();
+
+  // set doping profile to semiconductor region
+  if( DopingSolver.get() != NULL )
+    DopingSolver->solve();
+  else
+  {
+    system().do_interpolation(interpolator.get(), "doping.na");
+    system().do_interpolation(interpolator.get(), "doping.nd");
+  }
+
+  // set mole fraction to semiconductor region
+  if( MoleSolver.get() != NULL )
+    MoleSolver->solve();
+  else
+  {
+    if(system().has_single_compound_semiconductor_region())
+      system().do_interpolation(interpolator.get(), "mole.x");
+    if(system().has_complex_compound_semiconductor_region())
+      system().do_interpolation(interpolator.get(), "mole.y");
+  }
+
+  // after doping profile is set, we can init system data.
+  system().init_region();
+  system().init_region_post_process();
+
+  // continue from previous solution
+  system().restore_node_solution();
+
   return 0;
 }
 
@@ -1322,7 +2014,8 @@ int SolverControl::do_export( const Parser::Card & c )
   {
     std::string vtk_filename = c.get_string("vtkfile", "");
     bool ascii = c.get_bool("ascii", false);
-    system().export_vtk(vtk_filename, ascii);
+    bool float32 = c.get_bool("float32", false);
+    system().export_vtk(vtk_filename, ascii, 0, float32);
   }
 
   // if export to CGNS format is required
@@ -1332,6 +2025,21 @@ int SolverControl::do_export( const Parser::Card & c )
     system().export_cgns(cgns_filename);
   }
 
+  // if export to HDF5/XDMF format is required
+  if(c.is_parameter_exist("hdf5file"))
+  {
+    std::string hdf5_filename = c.get_string("hdf5file", "");
+    system().export_hdf5(hdf5_filename, c.get_bool("append", false), SolverSpecify::clock/PhysicalUnit::ps,
+                         c.get_bool("float32", false), c.get_int("compress", 1));
+  }
+
+  // if binary checkpoint is required
+  if(c.is_parameter_exist("checkpoint"))
+  {
+    std::string checkpoint_filename = c.get_string("checkpoint", "");
+    system().export_checkpoint(checkpoint_filename);
+  }
+
   // if export to DF-ISE format is required
   if(c.is_parameter_exist("isefile"))
   {
@@ -1410,7 +2118,19 @@ int SolverControl::do_import( const Parser::Card & c )
       MESSAGE<<"ERROR at " <<c.get_fileline()<< " IMPORT: CGNSFile " << cgns_filename << " doesn't exist." << std::endl; RECORD();
       genius_error();
     }
-    system().import_cgns(cgns_filename);
+    system().import_cgns(cgns_filename, c.get_bool("parallel.read", false));
+  }
+
+  // checkpoint is loaded into current system, which should be built from the same mesh
+  if(c.is_parameter_exist("checkpoint"))
+  {
+    std::string checkpoint_filename = c.get_string("checkpoint", "");
+    if( system().empty() )
+    {
+      MESSAGE<<"ERROR at " <<c.get_fileline()<< " IMPORT: checkpoint requires a simulation system built from the same mesh." << std::endl; RECORD();
+      genius_error();
+    }
+    system().import_checkpoint(checkpoint_filename);
   }
 
   if(c.is_parameter_exist("vtkfile"))
@@ -1514,11 +2234,21 @@ int  SolverControl::set_initial_node_voltage  ( const Parser::Card & c )
 
 int SolverControl::do_refine_conform(const Parser::Card & c)
 {
+  // the open solver holds the old system
+  close_solver();
+
   // TODO can we refine during the solver solution processing?
 
   // save previous solution
   AutoPtr<InterpolationBase> interpolator;
-  if( mesh().mesh_dimension() == 2 )
+  if( c.is_enum_value("interpolation", "mesh") && mesh().is_serial() )
+  {
+    // locate new nodes in the old mesh and interpolate by element shape function
+    Interpolation_Mesh * mesh_interpolator = new Interpolation_Mesh;
+    mesh_interpolator->set_source_mesh(mesh());
+    interpolator = AutoPtr<InterpolationBase>(mesh_interpolator);
+  }
+  else if( mesh().mesh_dimension() == 2 )
     interpolator = AutoPtr<InterpolationBase>(new Interpolation2D_CSA);
   else
     interpolator = AutoPtr<InterpolationBase>(new Interpolation3D_nbtet);
@@ -1545,11 +2275,17 @@ int SolverControl::do_refine_conform(const Parser::Card & c)
   // gather mesh to processor 0 since we may have a distributed mesh
   mesh().gather(0);
 
+  // regrid the 2D mesh region by region on all the processors
+  int parallel_mesh = c.get_bool("parallel.mesh", false) && mesh().mesh_dimension() == 2 && Genius::n_processors() > 1;
+  if ( parallel_mesh && Genius::processor_id() == 0 && meshgen.get() != NULL )
+    parallel_mesh = ( dynamic_cast<MeshGeneratorTri3 *>(meshgen.get()) != NULL );
+  Parallel::broadcast(parallel_mesh);
+
+  MeshRefinement mesh_refinement(mesh());
+
   if (Genius::processor_id() == 0)
   {
 
-    MeshRefinement mesh_refinement(mesh());
-
     // at least one refine criterion should be exist!
     genius_assert(c.is_parameter_exist("error.fraction") || c.is_parameter_exist("cell.fraction") || c.is_parameter_exist("error.threshold"));
 
@@ -1562,30 +2298,46 @@ int SolverControl::do_refine_conform(const Parser::Card & c)
     if(c.is_parameter_exist("error.threshold") )
       mesh_refinement.flag_elements_by_error_threshold(error_per_cell, c.get_real("error.threshold",0.1), 0.0);
 
-    // if mesh generator exist, we call it to do particular refine
-    if( meshgen.get() != NULL )
-      meshgen->do_refine(mesh_refinement);
-    // else, we have to do general mesh refinement
-    else
+    // the parallel regrid is done by all the processors later
+    if( !parallel_mesh )
     {
-      genius_assert(mesh().magic_num() != invalid_uint);
-
-      // for 2D, we call triangle
-      if( mesh().mesh_dimension() == 2 )
-      {
-        MeshGenerator *meshgen = new MeshGeneratorTri3(mesh(), decks());
+      // if mesh generator exist, we call it to do particular refine
+      if( meshgen.get() != NULL )
         meshgen->do_refine(mesh_refinement);
-        delete meshgen;
-      }
-      // for 3D, we still have no idea here.
+      // else, we have to do general mesh refinement
       else
       {
-        MESSAGE<<"ERROR at " <<c.get_fileline()<< " Refine: Genius still can not do 3D conform refine without mesh generator exist." << std::endl; RECORD();
-        genius_error();
+        genius_assert(mesh().magic_num() != invalid_uint);
+
+        // for 2D, we call triangle
+        if( mesh().mesh_dimension() == 2 )
+        {
+          MeshGenerator *meshgen = new MeshGeneratorTri3(mesh(), decks());
+          meshgen->do_refine(mesh_refinement);
+          delete meshgen;
+        }
+        // for 3D, we still have no idea here.
+        else
+        {
+          MESSAGE<<"ERROR at " <<c.get_fileline()<< " Refine: Genius still can not do 3D conform refine without mesh generator exist." << std::endl; RECORD();
+          genius_error();
+        }
       }
     }
 
   }
+
+  if( parallel_mesh )
+  {
+    if( meshgen.get() != NULL )
+      meshgen->do_refine_parallel(mesh_refinement);
+    else
+    {
+      MeshGeneratorTri3 tri3_meshgen(mesh(), decks());
+      tri3_meshgen.do_refine_parallel(mesh_refinement);
+    }
+  }
+
 #if defined(HAVE_FENV_H) && defined(DEBUG)
   genius_assert( !fetestexcept(FE_INVALID) );
 #endif
@@ -1641,12 +2393,22 @@ int SolverControl::do_refine_conform(const Parser::Card & c)
 
 int SolverControl::do_refine_hierarchical(const Parser::Card & c)
 {
+  // the open solver holds the old system
+  close_solver();
+
 
   MESSAGE<<"Hierarchical mesh refinement...\n"<<std::endl; RECORD();
 
   // save previous solution
   AutoPtr<InterpolationBase> interpolator;
-  if( mesh().mesh_dimension() == 2 )
+  if( c.is_enum_value("interpolation", "mesh") && mesh().is_serial() )
+  {
+    // locate new nodes in the old mesh and interpolate by element shape function
+    Interpolation_Mesh * mesh_interpolator = new Interpolation_Mesh;
+    mesh_interpolator->set_source_mesh(mesh());
+    interpolator = AutoPtr<InterpolationBase>(mesh_interpolator);
+  }
+  else if( mesh().mesh_dimension() == 2 )
     interpolator = AutoPtr<InterpolationBase>(new Interpolation2D_CSA);
   else
     interpolator = AutoPtr<InterpolationBase>(new Interpolation3D_nbtet);
@@ -1666,29 +2428,34 @@ int SolverControl::do_refine_hierarchical(const Parser::Card & c)
     system().fill_interpolator(interpolator.get(), "mole.y", InterpolationBase::Linear);
   }
 
-  // fill error vector from system level
+  // fill error vector of local cells from system level
   ErrorVector error_per_cell;
-  system().estimate_error(c, error_per_cell);
+  system().estimate_local_error(c, error_per_cell);
 
-  if (Genius::processor_id() == 0)
-  {
+  // save previous nodal solution, it will be transferred to the refined mesh by parent-child projection
+  bool keep_solution = c.get_bool("keep.solution", true);
+  if( keep_solution )
+    system().backup_node_solution();
 
+  {
     MeshRefinement mesh_refinement(mesh());
 
     // at least one refine criterion should be exist!
     genius_assert(c.is_parameter_exist("error.refine.fraction") || c.is_parameter_exist("cell.refine.fraction") || c.is_parameter_exist("error.refine.threshold"));
 
+    // each processor flags its own cells, the cutoffs are determined by global reduction
     if(c.is_parameter_exist("error.refine.fraction") )
-      mesh_refinement.flag_elements_by_error_fraction (error_per_cell, c.get_real("error.refine.fraction", 0.3), c.get_real("error.coarsen.fraction", 0.0));
+      mesh_refinement.flag_local_elements_by_error_fraction (error_per_cell, c.get_real("error.refine.fraction", 0.3), c.get_real("error.coarsen.fraction", 0.0));
 
     if(c.is_parameter_exist("cell.refine.fraction") )
-      mesh_refinement.flag_elements_by_elem_fraction  (error_per_cell, c.get_real("cell.refine.fraction",  0.3), c.get_real("cell.coarsen.fraction",  0.0));
+      mesh_refinement.flag_local_elements_by_elem_fraction  (error_per_cell, c.get_real("cell.refine.fraction",  0.3), c.get_real("cell.coarsen.fraction",  0.0));
 
     if(c.is_parameter_exist("error.refine.threshold") )
-      mesh_refinement.flag_elements_by_error_threshold(error_per_cell, c.get_real("error.refine.threshold",0.1), c.get_real("error.coarsen.threshold",0.0));
+      mesh_refinement.flag_local_elements_by_error_threshold(error_per_cell, c.get_real("error.refine.threshold",0.1), c.get_real("error.coarsen.threshold",0.0));
 
-    // call MeshRefinement class to do FEM refine
-    mesh_refinement.refine_and_coarsen_elements ();
+    // the flags are synchronized, call MeshRefinement class to do FEM refine
+    if (Genius::processor_id() == 0)
+      mesh_refinement.refine_and_coarsen_elements ();
   }
 
   // clear the system(). however we should reserve mesh information
@@ -1731,6 +2498,11 @@ int SolverControl::do_refine_hierarchical(const Parser::Card & c)
   // after doping profile is set, we can init system data.
   system().init_region();
   system().init_region_post_process();
+
+  // the refined mesh starts from previous solution instead of initial guess
+  if( keep_solution )
+    system().restore_node_solution();
+
   return 0;
 
 }
@@ -1741,6 +2513,9 @@ int SolverControl::do_refine_hierarchical(const Parser::Card & c)
  */
 int SolverControl::do_refine_uniform(const Parser::Card & c)
 {
+  // the open solver holds the old system
+  close_solver();
+
 
   if (Genius::processor_id() == 0)
   {
@@ -1779,6 +2554,288 @@ int SolverControl::do_refine_uniform(const Parser::Card & c)
 
 
 
+/**
+ * compare points by coordinates, used to find the same elem after coarsen and refine again
+ */
+struct CentroidLess
+{
+  bool operator() (const Point &a, const Point &b) const
+  {
+    if( a(0) != b(0) ) return a(0) < b(0);
+    if( a(1) != b(1) ) return a(1) < b(1);
+    return a(2) < b(2);
+  }
+};
+
+
+int SolverControl::do_nested_solve(const Parser::Card & c)
+{
+  // the open solver holds the old system
+  close_solver();
+
+  const unsigned int levels = c.get_int("nested.level", 1);
+
+  // gather mesh to processor 0 since we may have a distributed mesh
+  mesh().gather(0);
+
+  // the coarse mesh only exists when the refinement hierarchy is kept
+  bool hierarchical = mesh().n_elem() != mesh().n_active_elem();
+  Parallel::broadcast(hierarchical);
+  if( !hierarchical )
+  {
+    MESSAGE<<"Warning at " <<c.get_fileline()<< " SOLVE: nested iteration requires hierarchical mesh, solve on the current mesh." << std::endl; RECORD();
+    _nested_solve = true;
+    int ierr = this->do_solve(c);
+    _nested_solve = false;
+    return ierr;
+  }
+
+  MESSAGE<<"Nested iteration: solve on coarse mesh and prolongate to the current mesh...\n"<<std::endl; RECORD();
+
+  // doping and mole fraction are always interpolated from the current (fine) mesh
+  AutoPtr<InterpolationBase> interpolator;
+  if( mesh().mesh_dimension() == 2 )
+    interpolator = AutoPtr<InterpolationBase>(new Interpolation2D_CSA);
+  else
+    interpolator = AutoPtr<InterpolationBase>(new Interpolation3D_nbtet);
+
+  if( DopingSolver.get() == NULL )
+  {
+    system().fill_interpolator(interpolator.get(), "doping.na", InterpolationBase::Asinh);
+    system().fill_interpolator(interpolator.get(), "doping.nd", InterpolationBase::Asinh);
+  }
+  if(system().has_single_compound_semiconductor_region()  && MoleSolver.get() == NULL )
+    system().fill_interpolator(interpolator.get(), "mole.x", InterpolationBase::Linear);
+  if(system().has_complex_compound_semiconductor_region()  && MoleSolver.get() == NULL )
+    system().fill_interpolator(interpolator.get(), "mole.y", InterpolationBase::Linear);
+
+  // the coarse mesh is restricted from current solution by injection
+  system().backup_node_solution();
+
+  // coarsen the mesh level by level, record the elems which become active,
+  // they are refined again after the coarse solve
+  MeshRefinement mesh_refinement(mesh());
+  std::vector< std::set<Point, CentroidLess> > coarsened;
+  if (Genius::processor_id() == 0)
+  {
+    for(unsigned int l=0; l<levels; ++l)
+    {
+      std::set<Point, CentroidLess> parents;
+      MeshBase::element_iterator elem_it = mesh().active_elements_begin();
+      const MeshBase::element_iterator elem_it_end = mesh().active_elements_end();
+      for( ; elem_it != elem_it_end; ++elem_it)
+        if( (*elem_it)->parent() )
+          parents.insert( (*elem_it)->parent()->centroid() );
+      if( parents.empty() ) break;
+
+      coarsened.push_back(parents);
+      mesh_refinement.uniformly_coarsen(1);
+    }
+  }
+  this->rebuild_system(interpolator.get());
+
+  // coarse solve
+  _nested_solve = true;
+  this->do_solve(c);
+
+  // refine back to the original mesh, the coarse solution is prolongated through the element hierarchy
+  system().backup_node_solution();
+  if (Genius::processor_id() == 0)
+  {
+    for(unsigned int l=coarsened.size(); l>0; --l)
+    {
+      const std::set<Point, CentroidLess> & parents = coarsened[l-1];
+      MeshBase::element_iterator elem_it = mesh().active_elements_begin();
+      const MeshBase::element_iterator elem_it_end = mesh().active_elements_end();
+      for( ; elem_it != elem_it_end; ++elem_it)
+        if( parents.find((*elem_it)->centroid()) != parents.end() )
+          (*elem_it)->set_refinement_flag(Elem::REFINE);
+      mesh_refinement.refine_elements();
+    }
+  }
+  this->rebuild_system(interpolator.get());
+
+  // a few Newton steps finish the bias point on the fine mesh
+  int ierr = this->do_solve(c);
+  _nested_solve = false;
+
+  return ierr;
+}
+
+
+int SolverControl::solve_ensemble(SolverBase * solver)
+{
+  const unsigned int N = SolverSpecify::EnsembleSize;
+  const unsigned int n_groups = Genius::n_sweep_groups();
+  const unsigned int group = Genius::sweep_group();
+  BoundaryConditionCollector * bcs = system().get_bcs();
+
+  // the node data and external circuit state of the nominal device
+  std::stringstream nominal(std::ios::in | std::ios::out | std::ios::binary);
+  for(unsigned int r=0; r<system().n_regions(); r++)
+    system().region(r)->write_checkpoint(nominal);
+  std::vector<Real> nominal_state;
+  for(unsigned int b=0; b<bcs->n_bcs(); b++)
+    if( bcs->get_bc(b)->is_electrode() )
+      bcs->get_bc(b)->ext_circuit()->save_state(nominal_state);
+
+  std::vector<const BoundaryCondition *> electrodes;
+  for(unsigned int b=0; b<bcs->n_bcs(); b++)
+    if( bcs->get_bc(b)->is_electrode() )
+      electrodes.push_back(bcs->get_bc(b));
+
+  std::string fname = SolverSpecify::EnsembleFile;
+  if( n_groups > 1 )
+  {
+    std::stringstream ss;
+    ss << fname << ".g" << group;
+    fname = ss.str();
+  }
+
+  std::ofstream fout;
+  if( Genius::processor_id() == 0 )
+  {
+    fout.open(fname.c_str(), std::ios::trunc);
+    fout << "# instance";
+    for(unsigned int n=0; n<electrodes.size(); ++n)
+      fout << "  " << electrodes[n]->label() << ":V(V)  " << electrodes[n]->label() << ":I(A)";
+    fout << '\n';
+    fout << std::scientific << std::setprecision(8);
+  }
+
+  const Real W = system().z_width();
+  int ierr = 0;
+
+  // instances are distributed over the sweep groups, each group owns a full copy of the device
+  for(unsigned int i=group; i<N; i+=n_groups)
+  {
+    MESSAGE<<"Ensemble instance " << i+1 << " of " << N << "...\n" << std::endl; RECORD();
+
+    nominal.clear();
+    nominal.seekg(0);
+    for(unsigned int r=0; r<system().n_regions(); r++)
+      system().region(r)->read_checkpoint(nominal);
+    unsigned int pos = 0;
+    for(unsigned int b=0; b<bcs->n_bcs(); b++)
+      if( bcs->get_bc(b)->is_electrode() )
+        pos = bcs->get_bc(b)->ext_circuit()->restore_state(nominal_state, pos);
+
+    const unsigned long long seed = ( static_cast<unsigned long long>(SolverSpecify::EnsembleSeed) << 32 ) ^
+                                    ( static_cast<unsigned long long>(i+1)*0x9E3779B97F4A7C15ULL );
+
+    std::vector<Real> trap_factor(system().n_regions(), 1.0);
+    for(unsigned int r=0; r<system().n_regions(); r++)
+    {
+      SimulationRegion * region = system().region(r);
+      if( region->type() != SemiconductorRegion ) continue;
+
+      // the dopant count in the control volume is poisson distributed, take its gaussian limit.
+      // the stream only depends on the node, ghost nodes get the same value as their owner
+      SimulationRegion::local_node_iterator node_it = region->on_local_nodes_begin();
+      SimulationRegion::local_node_iterator node_it_end = region->on_local_nodes_end();
+      for( ; node_it!=node_it_end; ++node_it)
+      {
+        FVM_Node * fvm_node = *node_it;
+        FVM_NodeData * node_data = fvm_node->node_data();
+        const Real volume = fvm_node->volume()*W;
+        if( volume <= 0.0 ) continue;
+
+        RandomStream rng( seed ^ ( fvm_node->root_node()->id()*0xD1B54A32D192ED03ULL ) );
+        const Real Na = node_data->Na();
+        const Real Nd = node_data->Nd();
+        node_data->Na() = std::max(0.0, Na + std::sqrt(Na/volume)*rng.normal());
+        node_data->Nd() = std::max(0.0, Nd + std::sqrt(Nd/volume)*rng.normal());
+      }
+
+      if( SolverSpecify::EnsembleTrapSigma > 0.0 )
+      {
+        RandomStream rng( seed ^ ( (r+1)*0xBF58476D1CE4E5B9ULL ) );
+        const Real factor = std::max(1e-3, 1.0 + SolverSpecify::EnsembleTrapSigma*rng.normal());
+        Material::MaterialSemiconductor * mt = dynamic_cast<SemiconductorSimulationRegion *>(region)->material();
+        if( mt->trap->ScaleDensity(factor) )
+          trap_factor[r] = factor;
+      }
+    }
+
+    ierr = solver->solve();
+
+    std::vector<Real> result;
+    for(unsigned int n=0; n<electrodes.size(); ++n)
+    {
+      result.push_back(electrodes[n]->ext_circuit()->potential()/PhysicalUnit::V);
+      result.push_back(electrodes[n]->ext_circuit()->current()/PhysicalUnit::A);
+    }
+    if( Genius::processor_id() == 0 )
+    {
+      fout << std::setw(10) << i;
+      for(unsigned int n=0; n<result.size(); ++n)
+        fout << "  " << std::setw(16) << result[n];
+      fout << '\n' << std::flush;
+    }
+
+    for(unsigned int r=0; r<system().n_regions(); r++)
+      if( trap_factor[r] != 1.0 )
+        dynamic_cast<SemiconductorSimulationRegion *>(system().region(r))->material()->trap->ScaleDensity(1.0/trap_factor[r]);
+  }
+
+  // back to the nominal device
+  nominal.clear();
+  nominal.seekg(0);
+  for(unsigned int r=0; r<system().n_regions(); r++)
+    system().region(r)->read_checkpoint(nominal);
+  unsigned int pos = 0;
+  for(unsigned int b=0; b<bcs->n_bcs(); b++)
+    if( bcs->get_bc(b)->is_electrode() )
+      pos = bcs->get_bc(b)->ext_circuit()->restore_state(nominal_state, pos);
+
+  MESSAGE<<"Ensemble: " << N << " instances, terminal potential and current are written to " << fname << "\n" << std::endl; RECORD();
+
+  return ierr;
+}
+
+
+void SolverControl::rebuild_system(const InterpolationBase * interpolator)
+{
+  // clear the system. however we should reserve mesh information
+  system().clear(false);
+
+  // sync mesh to other processors.
+  MeshCommunication mesh_comm;
+  mesh_comm.broadcast(mesh());
+
+  system().build_simulation_system();
+  system().sync_print_info();
+
+  // set doping profile to semiconductor region
+  if( DopingSolver.get() != NULL )
+    DopingSolver->solve();
+  else
+  {
+    system().do_interpolation(interpolator, "doping.na");
+    system().do_interpolation(interpolator, "doping.nd");
+  }
+
+  // set mole fraction to semiconductor region
+  if( MoleSolver.get() != NULL )
+    MoleSolver->solve();
+  else
+  {
+    if(system().has_single_compound_semiconductor_region())
+      system().do_interpolation(interpolator, "mole.x");
+    if(system().has_complex_compound_semiconductor_region())
+      system().do_interpolation(interpolator, "mole.y");
+  }
+
+  // after doping profile is set, we can init system data.
+  system().init_region();
+  system().init_region_post_process();
+
+  // continue from the saved solution
+  system().restore_node_solution();
+}
+
+
+
 int SolverControl::do_region_set ( const Parser::Card & c)
 {
   std::string region_name = c.get_string("region", "");
@@ -1830,6 +2887,9 @@ int SolverControl::do_region_set ( const Parser::Card & c)
 
 int SolverControl::extend_to_3d ( const Parser::Card & c )
 {
+  // the open solver holds the old system
+  close_solver();
+
   MESSAGE<<"Extend mesh to 3D...\n"<<std::endl; RECORD();
   ExtendTo3D(system(), c)();
   return 0;
@@ -61,9 +61,13 @@ void DFISEIO::read (const std::string& filename)
 
   ise_reader = new DFISE::DFISE_MESH;
 
+  // the dataset file does not depend on the grid, read it on another processor
+  // while processor 0 reads the grid file and builds the mesh
+  const unsigned int data_processor = Genius::n_processors() > 1 ? 1 : 0;
+
   if( Genius::processor_id() == 0)
   {
-    ise_reader->parse_dfise(filename);
+    if( ise_reader->parse_dfise_grid(filename) ) genius_error();
 
     const DFISE::INFO & grid_info = ise_reader->get_grid_info();
     const DFISE::GRID & grid      = ise_reader->get_grid();
@@ -111,6 +115,11 @@ void DFISEIO::read (const std::string& filename)
   }
 
 
+  if( Genius::processor_id() == data_processor )
+  {
+    if( ise_reader->parse_dfise_dataset(filename) ) genius_error();
+  }
+
   /*
    * set mesh structure for all processors, and build simulation system
    */
@@ -130,27 +139,54 @@ void DFISEIO::read (const std::string& filename)
    * after that, set doping infomation, this should be done for all the processors
    */
   unsigned int n_datasets = ise_reader->n_datasets();
-  Parallel::broadcast(n_datasets);
+  Parallel::broadcast(n_datasets, data_processor);
 
   //for each dataset
   for(unsigned int n=0; n<n_datasets; ++n)
   {
     DFISE::DATASET * dataset = NULL;
-    if(Genius::processor_id() == 0)
+    if(Genius::processor_id() == data_processor)
       dataset = ise_reader->get_dataset(n);
     else
       dataset = new DFISE::DATASET;
 
     // broadcast critical data in this dataset
-    Parallel::broadcast(dataset->name);
-    Parallel::broadcast(dataset->Regions);
-    Parallel::broadcast(dataset->Scalar_Values);
-    Parallel::broadcast(dataset->node_to_value_index_map);
+    Parallel::broadcast(dataset->name, data_processor);
+    Parallel::broadcast(dataset->validity, data_processor);
+    Parallel::broadcast(dataset->n_data, data_processor);
+    Parallel::broadcast(dataset->Scalar_Values, data_processor);
 
-    if(Genius::processor_id() != 0)
+    if(Genius::processor_id() != data_processor)
       ise_reader->add_dataset(dataset);
   }
 
+  // region index and value index need the grid, which is on processor 0.
+  // broadcast the value vertices as a plain vector, each processor builds the map itself
+  unsigned int data_vertices  = ise_reader->get_dataset_info().nb_vertices;
+  unsigned int data_elements  = ise_reader->get_dataset_info().nb_elements;
+  Parallel::broadcast(data_vertices, data_processor);
+  Parallel::broadcast(data_elements, data_processor);
+  if( Genius::processor_id() == 0 )
+  {
+    genius_assert( data_vertices == ise_reader->get_grid_info().nb_vertices );
+    genius_assert( data_elements == ise_reader->get_grid_info().nb_elements );
+    ise_reader->build_dataset_index();
+  }
+
+  for(unsigned int n=0; n<n_datasets; ++n)
+  {
+    DFISE::DATASET * dataset = ise_reader->get_dataset(n);
+    std::vector<unsigned int> vertices;
+    if( Genius::processor_id() == 0 )
+      vertices = dataset->value_vertices();
+
+    Parallel::broadcast(dataset->Regions);
+    Parallel::broadcast(vertices);
+
+    if( Genius::processor_id() != 0 )
+      dataset->set_node_to_value_index(vertices);
+  }
+
 
   // set node id to dfise node index map, this should be same for all the processors
   if( Genius::processor_id() == 0)
@@ -1036,11 +1072,10 @@ bool DFISEIO::_add_face( Elem *face )
 
 bool DFISEIO::_add_edge( int n1, int n2 )
 {
-  std::pair<int, int> edge(n1, n2);
-  if( _edges_map.find(edge) == _edges_map.end() ) // edge not exist
+  // edge not exist
+  if( _edges_map.insert( std::make_pair(_edge_key(n1, n2), static_cast<int>(_edges.size())) ).second )
   {
-    _edges_map.insert( std::make_pair(edge, static_cast<int>(_edges_map.size()) ) );
-    _edges.push_back(edge);
+    _edges.push_back(std::make_pair(n1, n2));
     return true;
   }
   return false;
@@ -1058,11 +1093,11 @@ std::vector<int> DFISEIO::_edge_index(const Elem *face) const
 
     std::pair<int, int> face_edge(face->get_node(nodes.first)->id(), face->get_node(nodes.second)->id());
 
-    std::map< std::pair<int, int>, int, _lt_pair_int>::const_iterator it  = _edges_map.find(face_edge);
+    _edge_map_type::const_iterator it  = _edges_map.find(_edge_key(face_edge.first, face_edge.second));
     assert( it != _edges_map.end() );
 
     int index = it->second;
-    const std::pair<int, int> & edge = it->first;
+    const std::pair<int, int> & edge = _edges[index];
 
     if( edge.first == face_edge.first )
     {
@@ -0,0 +1,109 @@
+/********************************************************************************/
+/*     888888    888888888   88     888  88888   888      888    88888888       */
+/*   8       8   8           8 8     8     8      8        8    8               */
+/*  8            8           8  8    8     8      8        8    8               */
+/*  8            888888888   8   8   8     8      8        8     8888888        */
+/*  8      8888  8           8    8  8     8      8        8            8       */
+/*   8       8   8           8     8 8     8      8        8            8       */
+/*     888888    888888888  888     88   88888     88888888     88888888        */
+/*                                                                              */
+/*       A Three-Dimensional General Purpose Semiconductor Simulator.           */
+/*                                                                              */
+/*                                                                              */
+/*  Copyright (C) 2007-2008                                                     */
+/*  Cogenda Pte Ltd                                                             */
+/*                                                                              */
+/*  Please contact Cogenda Pte Ltd for license information                      */
+/*                                                                              */
+/*  Author: Gong Ding   gdiso@ustc.edu                                          */
+/*                                                                              */
+/********************************************************************************/
+
+#include "elem_node_deposition.h"
+#include "simulation_system.h"
+#include "simulation_region.h"
+#include "mesh_base.h"
+#include "elem.h"
+
+
+ElemNodeDeposition::ElemNodeDeposition(const SimulationSystem & system)
+{
+  const MeshBase & mesh = system.mesh();
+
+  _row.push_back(0);
+
+  for(unsigned int i=0; i<mesh.n_elem(); i++)
+  {
+    const Elem * elem = mesh.elem(i);
+    if(!elem->on_local()) continue; //skip nonlocal elements
+
+    const SimulationRegion * region = system.region(elem->subdomain_id());
+
+    double volume = 0;
+    for(unsigned int nd=0; nd<elem->n_nodes(); nd++)
+      volume += elem->partial_volume_truncated(nd);
+
+    for(unsigned int nd=0; nd<elem->n_nodes(); nd++)
+    {
+      FVM_Node * fvm_node = region->region_fvm_node(elem->get_node(nd));
+      genius_assert(fvm_node->node_data());
+      _node.push_back(fvm_node);
+      _weight.push_back( elem->partial_volume_truncated(nd)/(volume+1e-10)/fvm_node->volume() );
+    }
+
+    _elem.push_back(elem->id());
+    _row.push_back(_node.size());
+  }
+}
+
+
+
+void ElemNodeDeposition::deposit(const std::vector<double> & elem_value, Field field) const
+{
+  _deposit(elem_value, field);
+}
+
+
+
+void ElemNodeDeposition::deposit(const std::vector<double> & elem_value, FloatField field) const
+{
+  _deposit(elem_value, field);
+}
+
+
+
+template <typename T>
+void ElemNodeDeposition::_deposit(const std::vector<double> & elem_value, T & (FVM_NodeData::*field)()) const
+{
+  for(unsigned int i=0; i<_elem.size(); ++i)
+  {
+    const double value = elem_value[_elem[i]];
+    if( value == 0.0 ) continue;
+
+    for(unsigned int k=_row[i]; k<_row[i+1]; ++k)
+      (_node[k]->node_data()->*field)() += value*_weight[k];
+  }
+}
+
+
+
+void ElemNodeDeposition::deposit(const std::vector<const std::vector<double> *> & elem_values, const std::vector<Field> & fields) const
+{
+  genius_assert(elem_values.size() == fields.size());
+  const unsigned int n_fields = fields.size();
+
+  for(unsigned int i=0; i<_elem.size(); ++i)
+  {
+    bool nonzero = false;
+    for(unsigned int f=0; f<n_fields; ++f)
+      nonzero = nonzero || (*elem_values[f])[_elem[i]] != 0.0;
+    if( !nonzero ) continue;
+
+    for(unsigned int k=_row[i]; k<_row[i+1]; ++k)
+    {
+      FVM_NodeData * node_data = _node[k]->node_data();
+      for(unsigned int f=0; f<n_fields; ++f)
+        (node_data->*fields[f])() += (*elem_values[f])[_elem[i]]*_weight[k];
+    }
+  }
+}
@@ -35,6 +35,40 @@ using PhysicalUnit::C;
 using PhysicalUnit::s;
 using PhysicalUnit::um;
 
+void ExternalCircuit::save_state(std::vector<Real> & state) const
+{
+  state.push_back(_Vapp);
+  state.push_back(_Iapp);
+  state.push_back(static_cast<Real>(_drv));
+  state.push_back(_potential);
+  state.push_back(_potential_old);
+  state.push_back(_current);
+  state.push_back(_current_old);
+  state.push_back(_current_displacement);
+  state.push_back(_current_conductance);
+  state.push_back(_current_electron);
+  state.push_back(_current_hole);
+}
+
+
+unsigned int ExternalCircuit::restore_state(const std::vector<Real> & state, unsigned int pos)
+{
+  genius_assert(pos + 11 <= state.size());
+  _Vapp                 = state[pos++];
+  _Iapp                 = state[pos++];
+  _drv                  = static_cast<DRIVEN>(static_cast<int>(state[pos++]));
+  _potential            = state[pos++];
+  _potential_old        = state[pos++];
+  _current              = state[pos++];
+  _current_old          = state[pos++];
+  _current_displacement = state[pos++];
+  _current_conductance  = state[pos++];
+  _current_electron     = state[pos++];
+  _current_hole         = state[pos++];
+  return pos;
+}
+
+
 ExternalCircuit * ExternalCircuit::build_default()
 { return new ExternalCircuitRCL(); }
 
@@ -44,87 +44,60 @@ Real ExternalCircuitPI::inter_connect_resistance() const
 
 
 
-Real ExternalCircuitPI::mna_function(Real dt)
+void ExternalCircuitPI::companion(Real dt)
 {
-  if( this->is_voltage_driven() )
-  {
-    //  (V0-V1)/R + C2*dV0/dt - I         = 0
-    //  (V1-Va)/r + C1*dV1/dt + (V1-V0)/R = 0
-    //| A B | V0 = a + I
-    //| C D | V1 = b
-    Real A = 1/_res + _cap2/dt;
-    Real B = -1/_res;
-    Real C = -1/_res;
-    Real D = 1/_res + 1/_r_app + _cap1/dt;
-    Real a =  _cap2*_V0_last/dt;
-    Real b = _Vapp/_r_app + _cap1*_V1_last/dt;
+  const bool vd = this->is_voltage_driven();
+  if( dt == _companion_dt && vd == _companion_vd &&
+      _r_app == _companion_r_app && _res == _companion_res &&
+      _cap1 == _companion_cap1 && _cap2 == _companion_cap2 ) return;
+
+  _companion_dt    = dt;
+  _companion_vd    = vd;
+  _companion_r_app = _r_app;
+  _companion_res   = _res;
+  _companion_cap1  = _cap1;
+  _companion_cap2  = _cap2;
+
+  // voltage driven
+  //  (V0-V1)/R + C2*dV0/dt - I         = 0
+  //  (V1-Va)/r + C1*dV1/dt + (V1-V0)/R = 0
+  // current driven
+  //  (V0-V1)/R + C2*dV0/dt - I  = 0
+  //  -Ia + C1*dV1/dt + (V1-V0)/R = 0
+  //| A B | V0 = a + I
+  //| C D | V1 = b
+  // with B = C = -1/R
+  _companion_A = 1/_res + _cap2/dt;
+  _companion_D = 1/_res + _cap1/dt + (vd ? 1/_r_app : 0.0);
+  _companion_G = _companion_A - 1/(_res*_res*_companion_D);
+}
 
-    _V1 = (b-C*_V0)/D;
-    Real I = (A-B/D*C)*_V0 + B/D*b - a;
-    return I;
-  }
 
-  if( this->is_current_driven() )
-  {
-    //  (V0-V1)/R + C2*dV0/dt - I  = 0
-    //  -Ia + C1*dV1/dt + (V1-V0)/R = 0
-    //| A B | V0 = a + I
-    //| C D | V1 = b
-    Real A = 1/_res + _cap2/dt;
-    Real B = -1/_res;
-    Real C = -1/_res;
-    Real D = 1/_res + _cap1/dt;
-    Real a =  _cap2*_V0_last/dt;
-    Real b = _Iapp + _cap1*_V1_last/dt;
+Real ExternalCircuitPI::mna_function(Real dt)
+{
+  if( !this->is_voltage_driven() && !this->is_current_driven() )
+    return 0.0;
 
-    _V1 = (b-C*_V0)/D;
-    Real I = (A-B/D*C)*_V0 + B/D*b - a;
-    return I;
-  }
+  companion(dt);
+
+  const Real B = -1/_res;
+  const Real C = -1/_res;
+  const Real a = _cap2*_V0_last/dt;
+  const Real b = (this->is_voltage_driven() ? _Vapp/_r_app : _Iapp) + _cap1*_V1_last/dt;
 
-  return 0.0;
+  _V1 = (b-C*_V0)/_companion_D;
+  Real I = _companion_G*_V0 + B/_companion_D*b - a;
+  return I;
 }
 
 
 Real ExternalCircuitPI::mna_jacobian(Real dt)
 {
-  if( this->is_voltage_driven() )
-  {
-    //  (V0-V1)/R + C2*dV0/dt - I         = 0
-    //  (V1-Va)/r + C1*dV1/dt + (V1-V0)/R = 0
-    //| A B | V0 = a + I
-    //| C D | V1 = b
-    Real A = 1/_res + _cap2/dt;
-    Real B = -1/_res;
-    Real C = -1/_res;
-    Real D = 1/_res + 1/_r_app + _cap1/dt;
-    //Real a =  _cap2*_V0_last/dt;
-    //Real b = _Vapp/_r_app + _cap1*_V1_last/dt;
-
-    //_V1 = (b-C*_V0)/D;
-    //Real I = (A-B/D*C)*_V0 + B/D*b - a;
-    return (A-B/D*C); //dI/dV0
-  }
-
-  if( this->is_current_driven() )
-  {
-    //  (V0-V1)/R + C2*dV0/dt - I  = 0
-    //  -Ia + C1*dV1/dt + (V1-V0)/R = 0
-    //| A B | V0 = a + I
-    //| C D | V1 = b
-    Real A = 1/_res + _cap2/dt;
-    Real B = -1/_res;
-    Real C = -1/_res;
-    Real D = 1/_res + _cap1/dt;
-    //Real a =  _cap2*_V0_last/dt;
-    //Real b = _Iapp + _cap1*_V1_last/dt;
-
-    //_V1 = (b-C*_V0)/D;
-    //Real I = (A-B/D*C)*_V0 + B/D*b - a;
-    return (A-B/D*C); //dI/dV0
-  }
+  if( !this->is_voltage_driven() && !this->is_current_driven() )
+    return 0.0;
 
-  return 0.0;
+  companion(dt);
+  return _companion_G; //dI/dV0
 }
 
 
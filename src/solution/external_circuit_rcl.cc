@@ -45,7 +45,10 @@ Real ExternalCircuitRCL::inter_connect_resistance() const
 Real ExternalCircuitRCL::mna_function(Real dt)
 {
   if( this->is_voltage_driven() )
-    return  (_potential-_Vapp) + (_ind/dt+_res)*_cap/dt*_potential - (_ind/dt+_res)*_cap/dt*_potential_old - _ind/dt*(_current_old+_cap_current_old);
+  {
+    const Real g = companion(dt);
+    return  (_potential-_Vapp) + g*(_potential - _potential_old) - _ind/dt*(_current_old+_cap_current_old);
+  }
   else if( this->is_current_driven() )
     return _cap_current_old - _Iapp;
   else
@@ -56,7 +59,7 @@ Real ExternalCircuitRCL::mna_function(Real dt)
 Real ExternalCircuitRCL:: mna_jacobian(Real dt)
 {
   if( this->is_voltage_driven() )
-    return 1+(_ind/dt+_res)*_cap/dt;
+    return 1+companion(dt);
   else if( this->is_current_driven() )
     return 0.0;
   else
@@ -26,7 +26,7 @@
 #include "physical_unit.h"
 
 ExternalCircuitRCTLine::ExternalCircuitRCTLine(Real r, Real Rl, Real Cl, Real length, int div)
-  :_r_app(r),_r_per_um(Rl),_c_per_um(Cl),_length(length), N(div)
+  :_r_app(r),_r_per_um(Rl),_c_per_um(Cl),_length(length), N(div), _companion_dt(0.0), _companion_G(0.0)
 {
   _v.resize(N, 0.0);
   _v_last.resize(N, 0.0);
@@ -53,41 +53,82 @@ Real ExternalCircuitRCTLine::inter_connect_resistance() const
 
 
 
+void ExternalCircuitRCTLine::companion(Real dt)
+{
+  if( dt == _companion_dt && _r_app == _companion_r_app && _r_per_um == _companion_r_per_um &&
+      _c_per_um == _companion_c_per_um && _length == _companion_length ) return;
+
+  _companion_dt       = dt;
+  _companion_r_app    = _r_app;
+  _companion_r_per_um = _r_per_um;
+  _companion_c_per_um = _c_per_um;
+  _companion_length   = _length;
+
+  Real res = _r_per_um*_length/N;
+  Real cap = _c_per_um*_length/N;
+
+  // diagonal of the line matrix, off diagonals are all -1/res
+  _companion_m.assign(N, 0.0);
+  _companion_d.assign(N, 0.0);
+  for(int i=0; i<N; i++)
+  {
+    if(i==0)
+      _companion_d[i] = 1.0/res + 1.0/res;
+    else if(i==N-1)
+      _companion_d[i] = 1.0/res + 1.0/_r_app + cap/dt;
+    else
+      _companion_d[i] = 1.0/res + 1.0/res + cap/dt;
+  }
+
+  for(int i=1; i<N; i++)
+  {
+    _companion_m[i] = (-1.0/res)/_companion_d[i-1];
+    _companion_d[i] -= _companion_m[i]*(-1.0/res);
+  }
+
+  //I = (V0-v[0])/res, v = D^-1*(V0/res*e0 + b)
+  // so dI/dV0 = 1/res - (D^-1*e0)[0]/res^2
+  std::vector<Real> e0(N, 0.0), x(N);
+  e0[0] = 1.0;
+  companion_solve(e0, x);
+  _companion_G = 1.0/res - x[0]/(res*res);
+}
+
+
+void ExternalCircuitRCTLine::companion_solve(std::vector<Real> &r, std::vector<Real> &x) const
+{
+  Real res = _r_per_um*_length/N;
+
+  for(int i=1; i<N; i++)
+    r[i] -= _companion_m[i]*r[i-1];
+
+  x[N-1] = r[N-1]/_companion_d[N-1];
+  for(int i=N-2; i>=0; --i)
+    x[i] = (r[i] + x[i+1]/res)/_companion_d[i];
+}
+
+
 Real ExternalCircuitRCTLine::mna_function(Real dt)
 {
+  companion(dt);
+
   Real res = _r_per_um*_length/N;
   Real cap = _c_per_um*_length/N;
 
   Real _V0 = _potential;
 
-  std::vector<Real> A(N-1, 0.0); // low diag
-  std::vector<Real> B(N,   0.0); // diag
-  std::vector<Real> C(N-1, 0.0); // up diag
   std::vector<Real> r(N, 0.0);   // rhs
   for(int i=0; i<N; i++)
   {
     if(i==0)
-    {
-      B[i] = 1.0/res + 1.0/res;
-      C[i] = -1.0/res;
       r[i] = _V0/res;
-    }
     else if(i==N-1)
-    {
-      B[i] = 1.0/res + 1.0/_r_app + cap/dt;
-      A[i-1] = -1.0/res;
       r[i] = _Vapp/_r_app+cap*_v_last[i]/dt;
-    }
     else
-    {
-      B[i]   = 1.0/res + 1.0/res + cap/dt;
-      C[i]   = -1.0/res;
-      A[i-1] = -1.0/res;
       r[i] = cap*_v_last[i]/dt;
-    }
   }
 
-  solveMatrix(N, A, B, C, r, _v);
+  companion_solve(r, _v);
 
   return (_V0-_v[0])/res;
 }
@@ -95,33 +136,8 @@ Real ExternalCircuitRCTLine::mna_function(Real dt)
 
 Real ExternalCircuitRCTLine::mna_jacobian(Real dt)
 {
-  Real res = _r_per_um*_length/N;
-  Real cap = _c_per_um*_length/N;
-
-  Real A = 1.0/res;
-  std::vector<Real> B(N, 0.0);
-  B[0] = -1.0/res;
-  std::vector<Real> C(N, 0.0);
-  C[0] = -1.0/res;
-
-  std::vector<Real> Da(N-1, -1.0/res);
-  std::vector<Real> Db(N, 2.0/res+cap/dt);
-  std::vector<Real> Dc(N-1,-1.0/res);
-  Db[N-1] = 1.0/res + 1.0/_r_app + cap/dt;
-
-  //Real I = (A-B*D^-1*C)*_V0 + B/D*b - a
-  // we need dI/d_V0 = (A-B*D^-1*C)
-
-  // assume D^-1*C=M we solve DM=C
-  std::vector<Real> M(N);
-  solveMatrix(N, Da, Db, Dc, C, M);
-
-  //Q=B*M
-  Real Q = 0;
-  for(int i=0; i<N; i++)
-    Q += B[i]*M[i];
-
-  return A-Q;
+  companion(dt);
+  return _companion_G;
 }
 
 
@@ -36,6 +36,8 @@ using PhysicalUnit::e;
 // the static member in simulation region
 PetscScalar FVM_NodeData::_scalar_dummy_ = 0.0;
 
+float FVM_NodeData::_float_dummy_ = 0.0f;
+
 std::complex<PetscScalar> FVM_NodeData::_complex_dummy_ = std::complex<PetscScalar>(0.0, 0.0);
 
 VectorValue<PetscScalar> FVM_NodeData::_vector_dummy_(0,0,0);
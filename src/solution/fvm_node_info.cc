@@ -27,9 +27,7 @@
 #include "fvm_node_info.h"
 #include "boundary_info.h"
 
-// TNT matrix-vector library
-#include <TNT/tnt.h>
-#include <TNT/jama_lu.h>
+#include "dense_matrix_fixed.h"
 
 
 unsigned int FVM_Node::_solver_index=0;
@@ -101,10 +99,13 @@ void FVM_Node::set_fvm_node_neighbor(FVM_Node *nb, Real s, Real abs)
 void FVM_Node::set_ghost_node(FVM_Node * fn, unsigned int sub_id, Real area)
 {
   if( _ghost_nodes == NULL)
-    _ghost_nodes = new std::map< FVM_Node *, std::pair<unsigned int, Real> >;
+    _ghost_nodes = new GhostNodeList;
 
-  std::pair<unsigned int, Real> gf(sub_id,area);
-  _ghost_nodes->insert( std::pair< FVM_Node *, std::pair<unsigned int, Real> >(fn, gf) );
+  // keep the list sorted by pointer and skip the existing one, just as std::map::insert
+  std::pair<FVM_Node *, std::pair<unsigned int, Real> > gn(fn, std::pair<unsigned int, Real>(sub_id,area));
+  GhostNodeList::iterator it = std::lower_bound(_ghost_nodes->begin(), _ghost_nodes->end(), gn, GhostNodeLess());
+  if( it != _ghost_nodes->end() && (*it).first == fn ) return;
+  _ghost_nodes->insert(it, gn);
 }
 
 
@@ -114,15 +115,15 @@ void FVM_Node::set_ghost_node_area(unsigned int sub_id, Real area)
   // this is a boundary face, not interface face
   if( sub_id == _subdomain_id && _ghost_nodes==NULL )
   {
-    _ghost_nodes = new std::map< FVM_Node *, std::pair<unsigned int, Real> >;
+    _ghost_nodes = new GhostNodeList;
     std::pair<unsigned int, Real> gf(invalid_uint, area);
-    _ghost_nodes->insert( std::pair< FVM_Node *, std::pair<unsigned int, Real> >((FVM_Node *)NULL, gf) );
+    _ghost_nodes->push_back( std::pair< FVM_Node *, std::pair<unsigned int, Real> >((FVM_Node *)NULL, gf) );
     return;
   }
 
   // else we find in ghost nodes which matches sub_id
   genius_assert(_ghost_nodes);
-  std::map< FVM_Node *, std::pair<unsigned int, Real> >::iterator it = _ghost_nodes->begin();
+  GhostNodeList::iterator it = _ghost_nodes->begin();
   for(; it!=_ghost_nodes->end(); ++it)
     if( (*it).second.first ==  sub_id )
     {
@@ -133,9 +134,7 @@ void FVM_Node::set_ghost_node_area(unsigned int sub_id, Real area)
 
 FVM_Node * FVM_Node::ghost_fvm_node(unsigned int i) const
 {
-  fvm_ghost_node_iterator  it = ghost_node_begin();
-  for(unsigned int l=0; l<i; ++i, ++it);
-  return (*it).first;
+  return (*_ghost_nodes)[i].first;
 }
 
 
@@ -231,7 +230,7 @@ bool FVM_Node::posotive_cv_surface_area_to_each_neighbor(bool fix)
 
   if(_ghost_nodes)
   {
-    std::map< FVM_Node *, std::pair<unsigned int, Real> >::const_iterator it = _ghost_nodes->begin();
+    GhostNodeList::const_iterator it = _ghost_nodes->begin();
     for(; it != _ghost_nodes->end(); ++it)
     {
       const FVM_Node * ghost_fvm_node = it->first;
@@ -272,7 +271,7 @@ bool FVM_Node::posotive_cv_surface_area_to_each_neighbor(bool fix)
 
     if(_ghost_nodes)
     {
-      std::map< FVM_Node *, std::pair<unsigned int, Real> >::const_iterator it = _ghost_nodes->begin();
+      GhostNodeList::const_iterator it = _ghost_nodes->begin();
       for(; it != _ghost_nodes->end(); ++it)
       {
         FVM_Node * ghost_fvm_node = it->first;
@@ -333,7 +332,7 @@ std::vector<unsigned int> FVM_Node::subdomains() const
 
   std::set<unsigned int> subdomains_set;
   subdomains_set.insert(_subdomain_id);
-  std::map< FVM_Node *, std::pair<unsigned int, Real> >::const_iterator it = _ghost_nodes->begin();
+  GhostNodeList::const_iterator it = _ghost_nodes->begin();
   for( ; it != _ghost_nodes->end(); ++it)
   {
     if( !it->first ) continue;
@@ -385,7 +384,8 @@ Real FVM_Node::sup_laplace_unit() const
 unsigned int FVM_Node::n_pure_ghost_node() const
 {
   // sun NULL ghost node
-  if( _ghost_nodes->find(NULL)!=_ghost_nodes->end() )
+  // NULL ghost node is always the first one since the list is sorted by pointer
+  if( !_ghost_nodes->empty() && _ghost_nodes->front().first == NULL )
     return _ghost_nodes->size() -1 ;
   return _ghost_nodes->size();
 }
@@ -685,7 +685,7 @@ VectorValue<PetscScalar> FVM_Node::gradient(SolutionVariable var, bool ghost) co
 
   if(ghost)
   {
-    std::map< FVM_Node *, std::pair<unsigned int, Real> >::const_iterator g_it = _ghost_nodes->begin();
+    GhostNodeList::const_iterator g_it = _ghost_nodes->begin();
     for( ; g_it != _ghost_nodes->end(); ++ g_it)
     {
       const FVM_Node *ghost_node = g_it->first;
@@ -721,18 +721,14 @@ VectorValue<PetscScalar> FVM_Node::gradient(SolutionVariable var, bool ghost) co
   // so we set it to 1.0
   if(fabs(f)<1e-6) f=1.0;
 
-  TNT::Array2D<Real> A (3, 3);
-  TNT::Array1D<Real> r (3);
-  A[0][0] = a; A[0][1] = b; A[0][2] = c;
-  A[1][0] = b; A[1][1] = d; A[1][2] = e;
-  A[2][0] = c; A[2][1] = e; A[2][2] = f;
-
-  r[0] = r1;
-  r[1] = r2;
-  r[2] = r3;
+  DenseMatrixFixed<3,3> A;
+  Real dphi[3] = {r1, r2, r3};
+  A(0,0) = a; A(0,1) = b; A(0,2) = c;
+  A(1,0) = b; A(1,1) = d; A(1,2) = e;
+  A(2,0) = c; A(2,1) = e; A(2,2) = f;
 
-  JAMA::LU<Real> solver(A);
-  TNT::Array1D<Real> dphi = solver.solve(r);
+  DenseLUFixed<3> solver(A);
+  solver.solve(dphi, dphi);
 
   return VectorValue<PetscScalar>(dphi[0], dphi[1], dphi[2]);
 }
@@ -780,9 +776,7 @@ size_t FVM_Node::memory_size() const
 
   if(_ghost_nodes)
   {
-    std::map< FVM_Node *, std::pair<unsigned int, Real> >::const_iterator it = _ghost_nodes->begin();
-    for( ; it != _ghost_nodes->end(); ++it )
-      counter += sizeof(it->first) + sizeof(it->second);
+    counter += sizeof(GhostNodeList) + _ghost_nodes->capacity()*sizeof(GhostNodeList::value_type);
   }
 
   return counter;
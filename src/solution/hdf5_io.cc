@@ -0,0 +1,745 @@
+/********************************************************************************/
+/*     888888    888888888   88     888  88888   888      888    88888888       */
+/*   8       8   8           8 8     8     8      8        8    8               */
+/*  8            8           8  8    8     8      8        8    8               */
+/*  8            888888888   8   8   8     8      8        8     8888888        */
+/*  8      8888  8           8    8  8     8      8        8            8       */
+/*   8       8   8           8     8 8     8      8        8            8       */
+/*     888888    888888888  888     88   88888     88888888     88888888        */
+/*                                                                              */
+/*       A Three-Dimensional General Purpose Semiconductor Simulator.           */
+/*                                                                              */
+/*                                                                              */
+/*  Copyright (C) 2007-2008                                                     */
+/*  Cogenda Pte Ltd                                                             */
+/*                                                                              */
+/*  Please contact Cogenda Pte Ltd for license information                      */
+/*                                                                              */
+/*  Author: Gong Ding   gdiso@ustc.edu                                          */
+/*                                                                              */
+/********************************************************************************/
+
+
+#ifdef HAVE_HDF5
+
+// C++ includes
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <map>
+
+// Local includes
+#include "hdf5_io.h"
+#include "elem.h"
+#include "mesh_base.h"
+#include "boundary_info.h"
+#include "parallel.h"
+#include "simulation_system.h"
+#include "simulation_region.h"
+#include "boundary_condition_collector.h"
+#include "field_source.h"
+#include "material.h"
+#include "solver_specify.h"
+
+#include "hdf5.h"
+
+
+using PhysicalUnit::s;
+using PhysicalUnit::eV;
+using PhysicalUnit::cm;
+using PhysicalUnit::um;
+using PhysicalUnit::V;
+using PhysicalUnit::A;
+using PhysicalUnit::K;
+
+
+namespace
+{
+  // rows of one chunk
+  const hsize_t chunk_rows = 65536;
+
+  /**
+   * XDMF mixed topology type of genius element
+   */
+  int xdmf_cell_type(ElemType type)
+  {
+    switch(type)
+    {
+        case EDGE2:
+        case EDGE2_FVM:    return 2;  // Polyline
+        case EDGE3:        return 34; // Edge_3
+        case TRI3:
+        case TRI3_FVM:
+        case TRI3_CY_FVM:  return 4;  // Triangle
+        case TRI6:         return 36; // Triangle_6
+        case QUAD4:
+        case QUAD4_FVM:
+        case QUAD4_CY_FVM: return 5;  // Quadrilateral
+        case QUAD8:        return 37; // Quadrilateral_8
+        case TET4:
+        case TET4_FVM:     return 6;  // Tetrahedron
+        case TET10:        return 38; // Tetrahedron_10
+        case HEX8:
+        case HEX8_FVM:     return 9;  // Hexahedron
+        case HEX20:        return 48; // Hexahedron_20
+        case PRISM6:
+        case PRISM6_FVM:   return 8;  // Wedge
+        case PYRAMID5:
+        case PYRAMID5_FVM: return 7;  // Pyramid
+        default:
+        {
+          std::cerr<<"element type "<<type<<" not implemented"<<std::endl;
+          genius_error();
+        }
+    }
+    return 0;
+  }
+
+
+  /**
+   * parallel access when genius runs on more than one processor and HDF5 supports it
+   */
+  bool h5_parallel()
+  {
+#ifdef H5_HAVE_PARALLEL
+    return Genius::n_processors() > 1;
+#else
+    return false;
+#endif
+  }
+
+  hid_t h5_file_access()
+  {
+    hid_t fapl = H5Pcreate(H5P_FILE_ACCESS);
+#ifdef H5_HAVE_PARALLEL
+    if( h5_parallel() )
+      H5Pset_fapl_mpio(fapl, Genius::comm_world(), MPI_INFO_NULL);
+#endif
+    return fapl;
+  }
+
+  hid_t h5_transfer()
+  {
+    hid_t dxpl = H5Pcreate(H5P_DATASET_XFER);
+#ifdef H5_HAVE_PARALLEL
+    if( h5_parallel() )
+      H5Pset_dxpl_mpio(dxpl, H5FD_MPIO_COLLECTIVE);
+#endif
+    return dxpl;
+  }
+
+
+  /**
+   * chunked dataset of rows x cols, deflated with level
+   */
+  hid_t h5_create_dataset(hid_t loc, const char * name, hid_t type, hsize_t rows, hsize_t cols, int level)
+  {
+    const int rank = cols > 1 ? 2 : 1;
+    hsize_t dims[2]  = {rows, cols};
+    hsize_t chunk[2] = {std::min(std::max(rows, hsize_t(1)), chunk_rows), cols};
+
+    hid_t space = H5Screate_simple(rank, dims, NULL);
+    hid_t dcpl  = H5Pcreate(H5P_DATASET_CREATE);
+    if( rows > 0 )
+    {
+      H5Pset_chunk(dcpl, rank, chunk);
+      // parallel writes to filtered datasets need HDF5 1.10.2 or later
+#if defined(H5_HAVE_PARALLEL) && !H5_VERSION_GE(1,10,2)
+      if( h5_parallel() ) level = 0;
+#endif
+      if( level > 0 )
+      {
+        H5Pset_shuffle(dcpl);
+        H5Pset_deflate(dcpl, std::min(level, 9));
+      }
+    }
+    hid_t dset = H5Dcreate2(loc, name, type, space, H5P_DEFAULT, dcpl, H5P_DEFAULT);
+    H5Pclose(dcpl);
+    H5Sclose(space);
+    return dset;
+  }
+
+
+  /**
+   * write rows [offset, offset+n) of a dataset
+   */
+  void h5_write_rows(hid_t dset, hid_t mem_type, const void * data, hsize_t offset, hsize_t n, hsize_t cols)
+  {
+    hid_t file_space = H5Dget_space(dset);
+    hsize_t start[2] = {offset, 0};
+    hsize_t count[2] = {n, cols};
+    hsize_t mem_dims[1] = {std::max(n*cols, hsize_t(1))};
+    hid_t mem_space = H5Screate_simple(1, mem_dims, NULL);
+    if( n > 0 )
+      H5Sselect_hyperslab(file_space, H5S_SELECT_SET, start, NULL, count, NULL);
+    else
+    {
+      H5Sselect_none(file_space);
+      H5Sselect_none(mem_space);
+    }
+
+    hid_t dxpl = h5_transfer();
+    H5Dwrite(dset, mem_type, mem_space, file_space, dxpl, data);
+    H5Pclose(dxpl);
+    H5Sclose(mem_space);
+    H5Sclose(file_space);
+  }
+
+
+  /**
+   * write the rows of given (global node) index
+   */
+  void h5_write_index(hid_t dset, hid_t mem_type, const void * data, const std::vector<unsigned int> & index, hsize_t cols)
+  {
+    hid_t file_space = H5Dget_space(dset);
+    const int rank = H5Sget_simple_extent_ndims(file_space);
+    const hsize_t n = index.size();
+    hsize_t mem_dims[1] = {std::max(n*cols, hsize_t(1))};
+    hid_t mem_space = H5Screate_simple(1, mem_dims, NULL);
+    if( n > 0 )
+    {
+      // element coordinates in the order of memory buffer
+      std::vector<hsize_t> coord;
+      coord.reserve(n*cols*rank);
+      for(unsigned int i=0; i<n; ++i)
+        for(unsigned int c=0; c<cols; ++c)
+        {
+          coord.push_back(index[i]);
+          if( rank == 2 ) coord.push_back(c);
+        }
+      H5Sselect_elements(file_space, H5S_SELECT_SET, n*cols, &coord[0]);
+    }
+    else
+    {
+      H5Sselect_none(file_space);
+      H5Sselect_none(mem_space);
+    }
+
+    hid_t dxpl = h5_transfer();
+    H5Dwrite(dset, mem_type, mem_space, file_space, dxpl, data);
+    H5Pclose(dxpl);
+    H5Sclose(mem_space);
+    H5Sclose(file_space);
+  }
+
+
+  void h5_write_attribute(hid_t loc, const char * name, hid_t type, const void * value)
+  {
+    if( H5Aexists(loc, name) > 0 )
+      H5Adelete(loc, name);
+    hid_t space = H5Screate(H5S_SCALAR);
+    hid_t attr  = H5Acreate2(loc, name, type, space, H5P_DEFAULT, H5P_DEFAULT);
+    H5Awrite(attr, type, value);
+    H5Aclose(attr);
+    H5Sclose(space);
+  }
+
+
+  bool h5_read_attribute(hid_t loc, const char * name, hid_t type, void * value)
+  {
+    if( H5Aexists(loc, name) <= 0 ) return false;
+    hid_t attr = H5Aopen(loc, name, H5P_DEFAULT);
+    H5Aread(attr, type, value);
+    H5Aclose(attr);
+    return true;
+  }
+
+
+  hsize_t h5_dataset_rows(hid_t loc, const char * name)
+  {
+    if( H5Lexists(loc, name, H5P_DEFAULT) <= 0 ) return hsize_t(-1);
+    hid_t dset  = H5Dopen2(loc, name, H5P_DEFAULT);
+    hid_t space = H5Dget_space(dset);
+    hsize_t dims[2] = {0, 0};
+    H5Sget_simple_extent_dims(space, dims, NULL);
+    H5Sclose(space);
+    H5Dclose(dset);
+    return dims[0];
+  }
+
+
+  std::string step_name(unsigned int step)
+  {
+    std::stringstream ss;
+    ss << "Step_" << std::setw(6) << std::setfill('0') << step;
+    return ss.str();
+  }
+}
+
+
+
+void HDF5IO::_collect_mesh(const MeshBase& mesh)
+{
+  _node_id.clear();
+  _node_location.clear();
+  _topology.clear();
+  _subdomain.clear();
+  _partition.clear();
+
+  MeshBase::const_node_iterator nd = mesh.this_pid_nodes_begin();
+  MeshBase::const_node_iterator nd_end = mesh.this_pid_nodes_end();
+  for (; nd != nd_end; ++nd)
+  {
+    const Node * node = *nd;
+    _node_id.push_back(node->id());
+    for(unsigned int d=0; d<3; ++d)
+      _node_location.push_back((*node)(d)/um);
+  }
+
+  const std::vector<Elem *> & elems = mesh.active_this_pid_elem_range();
+  for (unsigned int ne=0; ne<elems.size(); ++ne)
+  {
+    const Elem * elem = elems[ne];
+    const int type = xdmf_cell_type(elem->type());
+    _topology.push_back(type);
+    // polyline is followed by its node count
+    if( type == 2 ) _topology.push_back(elem->n_nodes());
+    for(unsigned int i=0; i<elem->n_nodes(); ++i)
+      _topology.push_back(elem->node(i));
+    _subdomain.push_back(elem->subdomain_id());
+    _partition.push_back(elem->processor_id());
+  }
+}
+
+
+
+void HDF5IO::_collect_fields(const MeshBase& mesh)
+{
+  const SimulationSystem & system = FieldOutput<SimulationSystem>::system();
+
+  // check which data should be export
+  bool semiconductor_material = false;
+  for(unsigned int n=0; n<system.n_regions(); ++n)
+    if(Material::IsSemiconductor(system.region(n)->material()))
+      semiconductor_material=true;
+
+  bool ebm_solution_data     = false;
+  bool optical_generation    = false;
+  bool particle_generation   = false;
+  bool ddm_ac_data           = false;
+
+  const std::vector<SolverSpecify::SolverType> & solve_history = system.solve_history();
+  for(unsigned int n=0; n<solve_history.size(); ++n)
+  {
+    switch  (solve_history[n])
+    {
+        case SolverSpecify::EBML3      :
+        case SolverSpecify::EBML3MIX   :
+        ebm_solution_data = true;
+        break;
+        case SolverSpecify::EM_FEM_2D  :
+        case SolverSpecify::EM_FEM_3D  :
+        case SolverSpecify::RAY_TRACE  :
+        optical_generation = true;
+        break;
+        case SolverSpecify::DDMAC      :
+        ddm_ac_data = true;
+        break;
+        default : break;
+    }
+  }
+
+  if(system.get_field_source()->is_light_source_exist())
+    optical_generation = true;
+
+  if(system.get_field_source()->is_particle_source_exist())
+    particle_generation = true;
+
+  // node fields, the list must be the same on all the processors
+  std::vector<std::string> names;
+  names.push_back("psi");
+  names.push_back("Ec");
+  names.push_back("Ev");
+  names.push_back("elec_quasi_Fermi_level");
+  names.push_back("hole_quasi_Fermi_level");
+  names.push_back("temperature");
+  if(semiconductor_material)
+  {
+    names.push_back("Na");
+    names.push_back("Nd");
+    names.push_back("electron_density");
+    names.push_back("hole_density");
+    names.push_back("net_doping");
+    names.push_back("net_charge");
+    names.push_back("mole_x");
+    names.push_back("mole_y");
+    names.push_back("recombination");
+  }
+  if(ebm_solution_data)
+  {
+    names.push_back("elec_temperature");
+    names.push_back("hole_temperature");
+  }
+  if(optical_generation)
+    names.push_back("Optical_Generation");
+  if(particle_generation)
+    names.push_back("Radiation_Generation");
+  if(ddm_ac_data)
+  {
+    names.push_back("psi_AC_abs");
+    names.push_back("psi_AC_angle");
+    names.push_back("electron_AC_abs");
+    names.push_back("electron_AC_angle");
+    names.push_back("hole_AC_abs");
+    names.push_back("hole_AC_angle");
+  }
+
+  _node_fields.resize(names.size());
+  for(unsigned int f=0; f<names.size(); ++f)
+  {
+    _node_fields[f].name = names[f];
+    _node_fields[f].n_components = 1;
+    _node_fields[f].data.assign(_node_id.size(), 0.0);
+  }
+
+  std::map<unsigned int, unsigned int> node_index;
+  for(unsigned int n=0; n<_node_id.size(); ++n)
+    node_index.insert(std::make_pair(_node_id[n], n));
+
+  double concentration_scale = pow(cm, -3);
+
+  std::vector<bool> filled(_node_id.size(), false);
+  for( unsigned int r=0; r<system.n_regions(); r++)
+  {
+    const SimulationRegion * region = system.region(r);
+    SimulationRegion::const_processor_node_iterator node_it = region->on_processor_nodes_begin();
+    SimulationRegion::const_processor_node_iterator node_it_end = region->on_processor_nodes_end();
+    for(; node_it!=node_it_end; ++node_it)
+    {
+      const FVM_Node * fvm_node = *node_it;
+      std::map<unsigned int, unsigned int>::const_iterator it = node_index.find(fvm_node->root_node()->id());
+      if( it == node_index.end() || filled[it->second] ) continue;
+
+      const unsigned int i = it->second;
+      filled[i] = true;
+
+      // if the fvm_node lies on the interface of two material regions,
+      // we shall use the node data in the more important region.
+      const FVM_NodeData * node_data = fvm_node->node_data();
+      if( fvm_node->boundary_id() != BoundaryInfo::invalid_id )
+      {
+        unsigned int bc_index = system.get_bcs()->get_bc_index_by_bd_id(fvm_node->boundary_id());
+        const BoundaryCondition * bc = system.get_bcs()->get_bc(bc_index);
+        const FVM_Node * primary_fvm_node = (*bc->region_node_begin(fvm_node->root_node())).second.second;
+        node_data = primary_fvm_node->node_data();
+      }
+      assert ( node_data != NULL );
+
+      unsigned int f = 0;
+      _node_fields[f++].data[i] = node_data->psi()/V;
+      _node_fields[f++].data[i] = node_data->Ec()/eV;
+      _node_fields[f++].data[i] = node_data->Ev()/eV;
+      _node_fields[f++].data[i] = node_data->qFn()/eV;
+      _node_fields[f++].data[i] = node_data->qFp()/eV;
+      _node_fields[f++].data[i] = node_data->T()/K;
+      if(semiconductor_material)
+      {
+        _node_fields[f++].data[i] = node_data->Total_Na()/concentration_scale;
+        _node_fields[f++].data[i] = node_data->Total_Nd()/concentration_scale;
+        _node_fields[f++].data[i] = node_data->n()/concentration_scale;
+        _node_fields[f++].data[i] = node_data->p()/concentration_scale;
+        _node_fields[f++].data[i] = node_data->Net_doping()/concentration_scale;
+        _node_fields[f++].data[i] = node_data->Net_charge()/concentration_scale;
+        _node_fields[f++].data[i] = node_data->mole_x();
+        _node_fields[f++].data[i] = node_data->mole_y();
+        _node_fields[f++].data[i] = node_data->Recomb()/(concentration_scale/s);
+      }
+      if(ebm_solution_data)
+      {
+        _node_fields[f++].data[i] = node_data->Tn()/K;
+        _node_fields[f++].data[i] = node_data->Tp()/K;
+      }
+      if(optical_generation)
+        _node_fields[f++].data[i] = node_data->OptG()/(concentration_scale/s);
+      if(particle_generation)
+        _node_fields[f++].data[i] = node_data->PatG()/(concentration_scale/s);
+      if(ddm_ac_data)
+      {
+        _node_fields[f++].data[i] = std::abs(node_data->psi_ac())/V;
+        _node_fields[f++].data[i] = std::arg(node_data->psi_ac());
+        _node_fields[f++].data[i] = std::abs(node_data->n_ac())/concentration_scale;
+        _node_fields[f++].data[i] = std::arg(node_data->n_ac());
+        _node_fields[f++].data[i] = std::abs(node_data->p_ac())/concentration_scale;
+        _node_fields[f++].data[i] = std::arg(node_data->p_ac());
+      }
+    }
+  }
+
+  // cell fields, in the order of active_this_pid_elements
+  std::map<unsigned int, unsigned int> cell_index;
+  {
+    MeshBase::const_element_iterator       elem_it  = mesh.active_this_pid_elements_begin();
+    const MeshBase::const_element_iterator elem_it_end = mesh.active_this_pid_elements_end();
+    for (; elem_it != elem_it_end; ++elem_it)
+      cell_index.insert(std::make_pair((*elem_it)->id(), static_cast<unsigned int>(cell_index.size())));
+  }
+
+  _cell_fields.resize(3);
+  _cell_fields[0].name = "electrical_field";
+  _cell_fields[1].name = "electron_current";
+  _cell_fields[2].name = "hole_current";
+  for(unsigned int f=0; f<3; ++f)
+  {
+    _cell_fields[f].n_components = 3;
+    _cell_fields[f].data.assign(3*cell_index.size(), 0.0);
+  }
+
+  for( unsigned int r=0; r<system.n_regions(); r++)
+  {
+    const SimulationRegion * region = system.region(r);
+    for(unsigned int n=0; n<region->n_cell(); ++n)
+    {
+      const Elem * elem = region->get_region_elem(n);
+      if( elem->processor_id() != Genius::processor_id() ) continue;
+
+      std::map<unsigned int, unsigned int>::const_iterator it = cell_index.find(elem->id());
+      if( it == cell_index.end() ) continue;
+
+      const FVM_CellData * elem_data = region->get_region_elem_data(n);
+      const VectorValue<PetscScalar> E = region->cell_efield(n);
+      for(unsigned int d=0; d<3; ++d)
+      {
+        _cell_fields[0].data[3*it->second+d] = E(d)/(V/cm);
+        _cell_fields[1].data[3*it->second+d] = elem_data->Jn()(d)/(A/cm);
+        _cell_fields[2].data[3*it->second+d] = elem_data->Jp()(d)/(A/cm);
+      }
+    }
+  }
+}
+
+
+
+void HDF5IO::write(const std::string& name)
+{
+  const MeshBase& mesh = FieldOutput<SimulationSystem>::system().mesh();
+
+  _collect_mesh(mesh);
+  _collect_fields(mesh);
+
+  // offset of this processor in the cell ordered datasets
+  std::vector<unsigned int> n_cells, n_topology;
+  Parallel::allgather(static_cast<unsigned int>(_subdomain.size()), n_cells);
+  Parallel::allgather(static_cast<unsigned int>(_topology.size()), n_topology);
+
+  hsize_t cell_total = 0, cell_offset = 0, topology_total = 0, topology_offset = 0;
+  for(unsigned int p=0; p<Genius::n_processors(); ++p)
+  {
+    if( p < Genius::processor_id() )
+    {
+      cell_offset     += n_cells[p];
+      topology_offset += n_topology[p];
+    }
+    cell_total     += n_cells[p];
+    topology_total += n_topology[p];
+  }
+  const hsize_t node_total = mesh.n_nodes();
+
+  // processor 0 checks if the file holds the same mesh, and counts the steps
+  int append = 0;
+  unsigned int step = 0;
+  if( Genius::processor_id() == 0 && _append && H5Fis_hdf5(name.c_str()) > 0 )
+  {
+    hid_t file = H5Fopen(name.c_str(), H5F_ACC_RDONLY, H5P_DEFAULT);
+    if( file >= 0 )
+    {
+      if( h5_dataset_rows(file, "/Mesh/Geometry") == node_total &&
+          h5_dataset_rows(file, "/Mesh/Topology") == topology_total &&
+          h5_dataset_rows(file, "/Mesh/Region")   == cell_total &&
+          h5_read_attribute(file, "n_steps", H5T_NATIVE_UINT, &step) )
+        append = 1;
+      H5Fclose(file);
+    }
+    if( !append ) step = 0;
+  }
+  Parallel::broadcast(append);
+  Parallel::broadcast(step);
+
+  const hid_t field_type = _float32 ? H5T_IEEE_F32LE : H5T_IEEE_F64LE;
+
+  // with parallel HDF5 all the processors write at once, otherwise they take turns
+  const unsigned int turns = h5_parallel() ? 1 : Genius::n_processors();
+  for(unsigned int turn=0; turn<turns; ++turn)
+  {
+    if( h5_parallel() || turn == Genius::processor_id() )
+    {
+      // the first writer creates the datasets
+      const bool first = h5_parallel() || turn == 0;
+
+      hid_t fapl = h5_file_access();
+      hid_t file;
+      if( first && !append )
+        file = H5Fcreate(name.c_str(), H5F_ACC_TRUNC, H5P_DEFAULT, fapl);
+      else
+        file = H5Fopen(name.c_str(), H5F_ACC_RDWR, fapl);
+      H5Pclose(fapl);
+
+      if( file < 0 )
+      {
+        std::cerr<<"ERROR: can't open HDF5 file " << name << " for writing." << std::endl;
+        genius_error();
+      }
+
+      // mesh
+      if( !append )
+      {
+        hid_t group = first ? H5Gcreate2(file, "Mesh", H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT) : H5Gopen2(file, "Mesh", H5P_DEFAULT);
+
+        hid_t geometry  = first ? h5_create_dataset(group, "Geometry", H5T_IEEE_F64LE, node_total, 3, _compression) : H5Dopen2(group, "Geometry", H5P_DEFAULT);
+        hid_t topology  = first ? h5_create_dataset(group, "Topology", H5T_STD_I64LE, topology_total, 1, _compression) : H5Dopen2(group, "Topology", H5P_DEFAULT);
+        hid_t region    = first ? h5_create_dataset(group, "Region", H5T_STD_I32LE, cell_total, 1, _compression) : H5Dopen2(group, "Region", H5P_DEFAULT);
+        hid_t partition = first ? h5_create_dataset(group, "Partition", H5T_STD_I32LE, cell_total, 1, _compression) : H5Dopen2(group, "Partition", H5P_DEFAULT);
+
+        h5_write_index(geometry, H5T_NATIVE_DOUBLE, _node_location.empty() ? NULL : &_node_location[0], _node_id, 3);
+        h5_write_rows(topology, H5T_NATIVE_LLONG, _topology.empty() ? NULL : &_topology[0], topology_offset, _topology.size(), 1);
+        h5_write_rows(region, H5T_NATIVE_INT, _subdomain.empty() ? NULL : &_subdomain[0], cell_offset, _subdomain.size(), 1);
+        h5_write_rows(partition, H5T_NATIVE_INT, _partition.empty() ? NULL : &_partition[0], cell_offset, _partition.size(), 1);
+
+        H5Dclose(geometry);
+        H5Dclose(topology);
+        H5Dclose(region);
+        H5Dclose(partition);
+        H5Gclose(group);
+      }
+
+      // solution of this step
+      const std::string sname = step_name(step);
+      hid_t group = first ? H5Gcreate2(file, sname.c_str(), H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT) : H5Gopen2(file, sname.c_str(), H5P_DEFAULT);
+      hid_t node_group = first ? H5Gcreate2(group, "Node", H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT) : H5Gopen2(group, "Node", H5P_DEFAULT);
+      hid_t cell_group = first ? H5Gcreate2(group, "Cell", H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT) : H5Gopen2(group, "Cell", H5P_DEFAULT);
+      if( first )
+      {
+        h5_write_attribute(group, "time", H5T_NATIVE_DOUBLE, &_time);
+        const unsigned int n_steps = step + 1;
+        h5_write_attribute(file, "n_steps", H5T_NATIVE_UINT, &n_steps);
+      }
+
+      for(unsigned int f=0; f<_node_fields.size(); ++f)
+      {
+        const Field & field = _node_fields[f];
+        hid_t dset = first ? h5_create_dataset(node_group, field.name.c_str(), field_type, node_total, field.n_components, _compression)
+                           : H5Dopen2(node_group, field.name.c_str(), H5P_DEFAULT);
+        h5_write_index(dset, H5T_NATIVE_DOUBLE, field.data.empty() ? NULL : &field.data[0], _node_id, field.n_components);
+        H5Dclose(dset);
+      }
+
+      for(unsigned int f=0; f<_cell_fields.size(); ++f)
+      {
+        const Field & field = _cell_fields[f];
+        hid_t dset = first ? h5_create_dataset(cell_group, field.name.c_str(), field_type, cell_total, field.n_components, _compression)
+                           : H5Dopen2(cell_group, field.name.c_str(), H5P_DEFAULT);
+        h5_write_rows(dset, H5T_NATIVE_DOUBLE, field.data.empty() ? NULL : &field.data[0], cell_offset, n_cells[Genius::processor_id()], field.n_components);
+        H5Dclose(dset);
+      }
+
+      H5Gclose(cell_group);
+      H5Gclose(node_group);
+      H5Gclose(group);
+      H5Fclose(file);
+    }
+
+    if( !h5_parallel() )
+      Parallel::barrier();
+  }
+
+  if( h5_parallel() )
+    Parallel::barrier();
+
+  if( Genius::processor_id() == 0 )
+    _write_xdmf(name);
+}
+
+
+
+void HDF5IO::_write_xdmf(const std::string& name) const
+{
+  hid_t file = H5Fopen(name.c_str(), H5F_ACC_RDONLY, H5P_DEFAULT);
+  if( file < 0 ) return;
+
+  // the data items refer to the HDF5 file relative to the xmf file
+  std::string::size_type slash = name.find_last_of("/\\");
+  const std::string h5_name = (slash == std::string::npos) ? name : name.substr(slash+1);
+  const std::string xmf_name = name.substr(0, name.rfind('.')) + ".xmf";
+
+  unsigned int n_steps = 0;
+  h5_read_attribute(file, "n_steps", H5T_NATIVE_UINT, &n_steps);
+
+  const hsize_t n_nodes    = h5_dataset_rows(file, "/Mesh/Geometry");
+  const hsize_t n_cells    = h5_dataset_rows(file, "/Mesh/Region");
+  const hsize_t n_topology = h5_dataset_rows(file, "/Mesh/Topology");
+
+  std::ofstream out(xmf_name.c_str(), std::ofstream::trunc);
+  out << "<?xml version=\"1.0\" ?>\n";
+  out << "<Xdmf Version=\"3.0\">\n";
+  out << "  <Domain>\n";
+  out << "    <Grid Name=\"Genius\" GridType=\"Collection\" CollectionType=\"Temporal\">\n";
+
+  for(unsigned int step=0; step<n_steps; ++step)
+  {
+    const std::string sname = step_name(step);
+    if( H5Lexists(file, sname.c_str(), H5P_DEFAULT) <= 0 ) continue;
+
+    hid_t group = H5Gopen2(file, sname.c_str(), H5P_DEFAULT);
+    double time = step;
+    h5_read_attribute(group, "time", H5T_NATIVE_DOUBLE, &time);
+
+    out << "      <Grid Name=\"" << sname << "\" GridType=\"Uniform\">\n";
+    out << "        <Time Value=\"" << time << "\"/>\n";
+    out << "        <Topology TopologyType=\"Mixed\" NumberOfElements=\"" << n_cells << "\">\n";
+    out << "          <DataItem Dimensions=\"" << n_topology << "\" NumberType=\"Int\" Precision=\"8\" Format=\"HDF\">" << h5_name << ":/Mesh/Topology</DataItem>\n";
+    out << "        </Topology>\n";
+    out << "        <Geometry GeometryType=\"XYZ\">\n";
+    out << "          <DataItem Dimensions=\"" << n_nodes << " 3\" NumberType=\"Float\" Precision=\"8\" Format=\"HDF\">" << h5_name << ":/Mesh/Geometry</DataItem>\n";
+    out << "        </Geometry>\n";
+    out << "        <Attribute Name=\"region\" AttributeType=\"Scalar\" Center=\"Cell\">\n";
+    out << "          <DataItem Dimensions=\"" << n_cells << "\" NumberType=\"Int\" Precision=\"4\" Format=\"HDF\">" << h5_name << ":/Mesh/Region</DataItem>\n";
+    out << "        </Attribute>\n";
+    out << "        <Attribute Name=\"partition\" AttributeType=\"Scalar\" Center=\"Cell\">\n";
+    out << "          <DataItem Dimensions=\"" << n_cells << "\" NumberType=\"Int\" Precision=\"4\" Format=\"HDF\">" << h5_name << ":/Mesh/Partition</DataItem>\n";
+    out << "        </Attribute>\n";
+
+    const char * centers[2] = {"Node", "Cell"};
+    for(unsigned int c=0; c<2; ++c)
+    {
+      hid_t fields = H5Gopen2(group, centers[c], H5P_DEFAULT);
+      H5G_info_t info;
+      H5Gget_info(fields, &info);
+      for(hsize_t n=0; n<info.nlinks; ++n)
+      {
+        char field_name[256];
+        H5Lget_name_by_idx(fields, ".", H5_INDEX_NAME, H5_ITER_INC, n, field_name, sizeof(field_name), H5P_DEFAULT);
+
+        hid_t dset  = H5Dopen2(fields, field_name, H5P_DEFAULT);
+        hid_t space = H5Dget_space(dset);
+        hid_t type  = H5Dget_type(dset);
+        hsize_t dims[2] = {0, 1};
+        const int rank = H5Sget_simple_extent_dims(space, dims, NULL);
+        const size_t precision = H5Tget_size(type);
+        H5Tclose(type);
+        H5Sclose(space);
+        H5Dclose(dset);
+
+        out << "        <Attribute Name=\"" << field_name << "\" AttributeType=\"" << (rank == 2 ? "Vector" : "Scalar")
+            << "\" Center=\"" << centers[c] << "\">\n";
+        out << "          <DataItem Dimensions=\"" << dims[0];
+        if( rank == 2 ) out << " " << dims[1];
+        out << "\" NumberType=\"Float\" Precision=\"" << precision << "\" Format=\"HDF\">"
+            << h5_name << ":/" << sname << "/" << centers[c] << "/" << field_name << "</DataItem>\n";
+        out << "        </Attribute>\n";
+      }
+      H5Gclose(fields);
+    }
+
+    out << "      </Grid>\n";
+    H5Gclose(group);
+  }
+
+  out << "    </Grid>\n";
+  out << "  </Domain>\n";
+  out << "</Xdmf>\n";
+  out.close();
+
+  H5Fclose(file);
+}
+
+#endif // HAVE_HDF5
@@ -43,7 +43,7 @@ using PhysicalUnit::mu0;
 
 
 InsulatorSimulationRegion::InsulatorSimulationRegion(const std::string &name, const std::string &material, const double T, const double z)
-:SimulationRegion(name, material, T, z)
+:SimulationRegion(name, material, T, z), _ddm1_edge_slots_serial(0)
 {
   // material should be initializted after region variables
   this->set_region_variables();
@@ -98,8 +98,8 @@ void InsulatorSimulationRegion::set_region_variables()
   _region_point_variables["eps"             ] = SimulationVariable("eps", SCALAR, POINT_CENTER, "C/V/m", FVM_Insulator_NodeData::_eps_, true);
   _region_point_variables["mu"              ] = SimulationVariable("mu", SCALAR, POINT_CENTER, "s^2*V/C/m", FVM_Insulator_NodeData::_mu_, true);
 
-  _region_point_variables["optical_energy"  ] = SimulationVariable("optical_energy", SCALAR, POINT_CENTER, "eV", FVM_Insulator_NodeData::_OptE_, true);
-  _region_point_variables["particle_energy" ] = SimulationVariable("particle_energy", SCALAR, POINT_CENTER, "eV", FVM_Insulator_NodeData::_PatE_, true);
+  _region_point_variables["optical_energy"  ] = SimulationVariable("optical_energy", SCALAR, POINT_CENTER, "eV", FVM_Insulator_NodeData::_OptE_, true, false, true);
+  _region_point_variables["particle_energy" ] = SimulationVariable("particle_energy", SCALAR, POINT_CENTER, "eV", FVM_Insulator_NodeData::_PatE_, true, false, true);
 
   _region_point_variables["potential.last"  ] = SimulationVariable("potential.last", SCALAR, POINT_CENTER, "V", FVM_Insulator_NodeData::_psi_last_, true);
   _region_point_variables["potential.old"     ] = SimulationVariable("potential.old", SCALAR, POINT_CENTER, "V", FVM_Insulator_NodeData::_psi_old_, true);
@@ -113,7 +113,7 @@ void InsulatorSimulationRegion::set_region_variables()
   _region_point_variables["optical_hfield"] = SimulationVariable("optical_hfield", COMPLEX, POINT_CENTER, "A/cm", FVM_Insulator_NodeData::_OpH_complex_, false);
 
   // define _region_cell_variables
-  _region_cell_variables["efield"        ] = SimulationVariable("efield", VECTOR, CELL_CENTER, "V/cm", FVM_Insulator_CellData::_E_, true);
+  _region_cell_variables["efield"        ] = SimulationVariable("efield", VECTOR, CELL_CENTER, "V/cm", FVM_Insulator_CellData::_E_, false);
   _region_cell_variables["elec_current"  ] = SimulationVariable("elec_current", VECTOR, CELL_CENTER, "A/cm", FVM_Insulator_CellData::_Jn_, true);
   _region_cell_variables["hole_current"  ] = SimulationVariable("hole_current", VECTOR, CELL_CENTER, "A/cm", FVM_Insulator_CellData::_Jp_, true);
 
@@ -90,15 +90,16 @@ void PMLSimulationRegion::set_region_variables()
   _region_point_variables["density"       ] = SimulationVariable("density", SCALAR, POINT_CENTER, "g/cm^3", FVM_PML_NodeData::_density_, true);
   _region_point_variables["eps"           ] = SimulationVariable("eps", SCALAR, POINT_CENTER, "C/V/m", FVM_PML_NodeData::_eps_, true);
   _region_point_variables["mu"            ] = SimulationVariable("mu", SCALAR, POINT_CENTER, "s^2*V/C/m", FVM_PML_NodeData::_mu_, true);
-  _region_point_variables["potential.last"] = SimulationVariable("potential.last", SCALAR, POINT_CENTER, "V", FVM_PML_NodeData::_psi_last_, true);
+  // PML region is optical only, it has no electrical dofs. the transient and field data are not allocated
+  _region_point_variables["potential.last"] = SimulationVariable("potential.last", SCALAR, POINT_CENTER, "V", FVM_PML_NodeData::_psi_last_, false);
 
-  _region_point_variables["efield"        ] = SimulationVariable("efield", VECTOR, POINT_CENTER, "V/cm", FVM_PML_NodeData::_E_, true);
+  _region_point_variables["efield"        ] = SimulationVariable("efield", VECTOR, POINT_CENTER, "V/cm", FVM_PML_NodeData::_E_, false);
 
   _region_point_variables["optical_efield"] = SimulationVariable("optical_efield", COMPLEX, POINT_CENTER, "V/cm", FVM_PML_NodeData::_OpE_complex_, false);
   _region_point_variables["optical_hfield"] = SimulationVariable("optical_hfield", COMPLEX, POINT_CENTER, "A/cm", FVM_PML_NodeData::_OpH_complex_, false);
 
   // define _region_cell_variables
-  _region_cell_variables["efield"        ] = SimulationVariable("efield", VECTOR, CELL_CENTER, "V/cm", FVM_PML_CellData::_E_, true);
+  _region_cell_variables["efield"        ] = SimulationVariable("efield", VECTOR, CELL_CENTER, "V/cm", FVM_PML_CellData::_E_, false);
 
     // allocate variables
   std::map<std::string, SimulationVariable>::iterator it;
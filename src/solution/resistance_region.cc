@@ -116,8 +116,8 @@ void MetalSimulationRegion::set_region_variables()
   _region_point_variables["eps"             ] = SimulationVariable("eps", SCALAR, POINT_CENTER, "C/V/m", FVM_Resistance_NodeData::_eps_, true);
   _region_point_variables["mu"              ] = SimulationVariable("mu", SCALAR, POINT_CENTER, "s^2*V/C/m", FVM_Resistance_NodeData::_mu_, true);
 
-  _region_point_variables["optical_energy"  ] = SimulationVariable("optical_energy", SCALAR, POINT_CENTER, "eV", FVM_Resistance_NodeData::_OptE_, true);
-  _region_point_variables["particle_energy" ] = SimulationVariable("particle_energy", SCALAR, POINT_CENTER, "eV", FVM_Resistance_NodeData::_PatE_, true);
+  _region_point_variables["optical_energy"  ] = SimulationVariable("optical_energy", SCALAR, POINT_CENTER, "eV", FVM_Resistance_NodeData::_OptE_, true, false, true);
+  _region_point_variables["particle_energy" ] = SimulationVariable("particle_energy", SCALAR, POINT_CENTER, "eV", FVM_Resistance_NodeData::_PatE_, true, false, true);
 
   _region_point_variables["electron.last"   ] = SimulationVariable("electron.last", SCALAR, POINT_CENTER, "cm^-3", FVM_Resistance_NodeData::_n_last_, true);
   _region_point_variables["potential.last"  ] = SimulationVariable("potential.last", SCALAR, POINT_CENTER, "V", FVM_Resistance_NodeData::_psi_last_, true);
@@ -132,7 +132,7 @@ void MetalSimulationRegion::set_region_variables()
   _region_point_variables["optical_hfield"] = SimulationVariable("optical_hfield", COMPLEX, POINT_CENTER, "A/cm", FVM_Resistance_NodeData::_OpH_complex_, false);
 
   // define _region_cell_variables
-  _region_cell_variables["efield"        ] = SimulationVariable("efield", VECTOR, CELL_CENTER, "V/cm", FVM_Resistance_CellData::_E_, true);
+  _region_cell_variables["efield"        ] = SimulationVariable("efield", VECTOR, CELL_CENTER, "V/cm", FVM_Resistance_CellData::_E_, false);
 
   // allocate variables
   std::map<std::string, SimulationVariable>::iterator it;
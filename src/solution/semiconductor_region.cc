@@ -21,6 +21,8 @@
 
 //  $Id: semiconductor_region.cc,v 1.18 2008/07/09 05:58:16 gdiso Exp $
 
+#include <algorithm>
+
 #include "asinh.hpp" // for asinh
 
 #include "elem.h"
@@ -30,6 +32,7 @@
 #include "fvm_node_data_semiconductor.h"
 #include "fvm_cell_data_semiconductor.h"
 #include "parallel.h"
+#include "solver_specify.h"
 #include "log.h"
 
 using PhysicalUnit::cm;
@@ -50,7 +53,7 @@ using PhysicalUnit::mu0;
 
 
 SemiconductorSimulationRegion::SemiconductorSimulationRegion(const std::string &name, const std::string &material, const double T, const double z)
-    :SimulationRegion(name, material, T, z)
+    :SimulationRegion(name, material, T, z), _mob_force_cached(false)
 {
   // material should be initializted after region variables
   this->set_region_variables();
@@ -62,11 +65,19 @@ void SemiconductorSimulationRegion::clear()
 {
   SimulationRegion::clear();
 
+  _band_cache.clear();
+  _mob_force_cached = false;
+
   // clear previous value
   _elem_on_insulator_interface.clear();
   _elem_in_mos_channel.clear();
   _nearest_interface_normal.clear();
   _elem_touch_boundary.clear();
+
+  _bbt_path_begin.clear();
+  _bbt_path_end.clear();
+  _bbt_path_length.clear();
+  _bbt_path_psi.clear();
 }
 
 void SemiconductorSimulationRegion::insert_cell (const Elem * e)
@@ -131,22 +142,24 @@ void SemiconductorSimulationRegion::set_region_variables()
   _region_point_variables["mole_x"             ] = SimulationVariable("mole_x", SCALAR, POINT_CENTER, "1", FVM_Semiconductor_NodeData::_mole_x_, true);
   _region_point_variables["mole_y"             ] = SimulationVariable("mole_y", SCALAR, POINT_CENTER, "1", FVM_Semiconductor_NodeData::_mole_y_, true);
 
+  // mobility, optical generation and heat enter the residual, they are kept in double
   _region_point_variables["mun"                ] = SimulationVariable("mun", SCALAR, POINT_CENTER, "cm^2/V/s", FVM_Semiconductor_NodeData::_mun_, true);
   _region_point_variables["mup"                ] = SimulationVariable("mup", SCALAR, POINT_CENTER, "cm^2/V/s", FVM_Semiconductor_NodeData::_mup_, true);
 
-  _region_point_variables["recombination"      ] = SimulationVariable("recombination", SCALAR, POINT_CENTER, "cm^-3/s", FVM_Semiconductor_NodeData::_Recomb_, true);
-  _region_point_variables["recombination_dir"  ] = SimulationVariable("recombination_dir", SCALAR, POINT_CENTER, "cm^-3/s", FVM_Semiconductor_NodeData::_Recomb_Dir_, true);
-  _region_point_variables["recombination_srh"  ] = SimulationVariable("recombination_srh", SCALAR, POINT_CENTER, "cm^-3/s", FVM_Semiconductor_NodeData::_Recomb_SRH_, true);
-  _region_point_variables["recombination_auger"] = SimulationVariable("recombination_auger", SCALAR, POINT_CENTER, "cm^-3/s", FVM_Semiconductor_NodeData::_Recomb_Auger_, true);
+  // recombination, impact ionization, optical energy and particle ratios are auxiliary, they are stored in float
+  _region_point_variables["recombination"      ] = SimulationVariable("recombination", SCALAR, POINT_CENTER, "cm^-3/s", FVM_Semiconductor_NodeData::_Recomb_, true, false, true);
+  _region_point_variables["recombination_dir"  ] = SimulationVariable("recombination_dir", SCALAR, POINT_CENTER, "cm^-3/s", FVM_Semiconductor_NodeData::_Recomb_Dir_, true, false, true);
+  _region_point_variables["recombination_srh"  ] = SimulationVariable("recombination_srh", SCALAR, POINT_CENTER, "cm^-3/s", FVM_Semiconductor_NodeData::_Recomb_SRH_, true, false, true);
+  _region_point_variables["recombination_auger"] = SimulationVariable("recombination_auger", SCALAR, POINT_CENTER, "cm^-3/s", FVM_Semiconductor_NodeData::_Recomb_Auger_, true, false, true);
 
-  _region_point_variables["impact_ionization"  ] = SimulationVariable("impact_ionization", SCALAR, POINT_CENTER, "cm^-3/s", FVM_Semiconductor_NodeData::_ImpactIonization_, true);
+  _region_point_variables["impact_ionization"  ] = SimulationVariable("impact_ionization", SCALAR, POINT_CENTER, "cm^-3/s", FVM_Semiconductor_NodeData::_ImpactIonization_, true, false, true);
 
   _region_point_variables["field_generation"   ] = SimulationVariable("field_generation", SCALAR, POINT_CENTER, "cm^-3/s", FVM_Semiconductor_NodeData::_Field_G_, true);
   _region_point_variables["optical_generation" ] = SimulationVariable("optical_generation", SCALAR, POINT_CENTER, "cm^-3/s", FVM_Semiconductor_NodeData::_OptG_, true);
   _region_point_variables["optical_heat"       ] = SimulationVariable("optical_heat", SCALAR, POINT_CENTER, "eV/s", FVM_Semiconductor_NodeData::_OptQ_, true);
-  _region_point_variables["optical_energy"     ] = SimulationVariable("optical_energy", SCALAR, POINT_CENTER, "eV", FVM_Semiconductor_NodeData::_OptE_, true);
-  _region_point_variables["particle_generation"] = SimulationVariable("particle_generation", SCALAR, POINT_CENTER, "cm^-3/s", FVM_Semiconductor_NodeData::_PatG_, true);
-  _region_point_variables["particle_energy"    ] = SimulationVariable("particle_energy", SCALAR, POINT_CENTER, "eV", FVM_Semiconductor_NodeData::_PatE_, true);
+  _region_point_variables["optical_energy"     ] = SimulationVariable("optical_energy", SCALAR, POINT_CENTER, "eV", FVM_Semiconductor_NodeData::_OptE_, true, false, true);
+  _region_point_variables["particle_generation"] = SimulationVariable("particle_generation", SCALAR, POINT_CENTER, "cm^-3/s", FVM_Semiconductor_NodeData::_PatG_, true, false, true);
+  _region_point_variables["particle_energy"    ] = SimulationVariable("particle_energy", SCALAR, POINT_CENTER, "eV", FVM_Semiconductor_NodeData::_PatE_, true, false, true);
 
   _region_point_variables["elec_injection"     ] = SimulationVariable("elec_injection", SCALAR, POINT_CENTER, "A", FVM_Semiconductor_NodeData::_EIn_, true);
   _region_point_variables["hole_injection"     ] = SimulationVariable("hole_injection", SCALAR, POINT_CENTER, "A", FVM_Semiconductor_NodeData::_HIn_, true);
@@ -181,9 +194,13 @@ void SemiconductorSimulationRegion::set_region_variables()
   _region_point_variables["optical_hfield"     ] = SimulationVariable("optical_hfield", COMPLEX, POINT_CENTER, "A/cm", FVM_Semiconductor_NodeData::_OpH_complex_, false);
 
   // define _region_cell_variables
-  _region_cell_variables["efield"        ] = SimulationVariable("efield", VECTOR, CELL_CENTER, "V/cm", FVM_Semiconductor_CellData::_E_, true);
+  _region_cell_variables["efield"        ] = SimulationVariable("efield", VECTOR, CELL_CENTER, "V/cm", FVM_Semiconductor_CellData::_E_, false);
   _region_cell_variables["elec_current"  ] = SimulationVariable("elec_current", VECTOR, CELL_CENTER, "A/cm", FVM_Semiconductor_CellData::_Jn_, true);
   _region_cell_variables["hole_current"  ] = SimulationVariable("hole_current", VECTOR, CELL_CENTER, "A/cm", FVM_Semiconductor_CellData::_Jp_, true);
+  _region_cell_variables["elec_driving_force"] = SimulationVariable("elec_driving_force", SCALAR, CELL_CENTER, "V/cm", FVM_Semiconductor_CellData::_Epn_, false);
+  _region_cell_variables["hole_driving_force"] = SimulationVariable("hole_driving_force", SCALAR, CELL_CENTER, "V/cm", FVM_Semiconductor_CellData::_Epp_, false);
+  _region_cell_variables["elec_vertical_field"] = SimulationVariable("elec_vertical_field", SCALAR, CELL_CENTER, "V/cm", FVM_Semiconductor_CellData::_Etn_, false);
+  _region_cell_variables["hole_vertical_field"] = SimulationVariable("hole_vertical_field", SCALAR, CELL_CENTER, "V/cm", FVM_Semiconductor_CellData::_Etp_, false);
 
 
   // allocate variables
@@ -200,12 +217,15 @@ void SemiconductorSimulationRegion::set_region_variables()
 
 void SemiconductorSimulationRegion::init(PetscScalar T_external)
 {
-  //init FVM_NodeData
-  local_node_iterator node_it = on_local_nodes_begin();
-  local_node_iterator node_it_end = on_local_nodes_end();
-  for(; node_it!=node_it_end; ++node_it)
+  // doping profile may changed
+  _band_cache.clear();
+  mt->init_mole_table(_node_data_storage.size());
+
+  //init FVM_NodeData. the loop stays serial, PMI models may keep scratch members between calls
+  const int n_local_nodes = static_cast<int>(_region_local_node.size());
+  for(int i=0; i<n_local_nodes; ++i)
   {
-    FVM_Node * fvm_node = *node_it;
+    FVM_Node * fvm_node = _region_local_node[i];
     FVM_NodeData * node_data = fvm_node->node_data();
 
     // set the initial temperature of lattice, electron and hole to external temperature
@@ -285,12 +305,14 @@ void SemiconductorSimulationRegion::init(PetscScalar T_external)
 
 void SemiconductorSimulationRegion::reinit_after_import()
 {
-  //init FVM_NodeData
-  local_node_iterator node_it = on_local_nodes_begin();
-  local_node_iterator node_it_end = on_local_nodes_end();
-  for(; node_it!=node_it_end; ++node_it)
+  _band_cache.clear();
+  mt->init_mole_table(_node_data_storage.size());
+
+  //init FVM_NodeData, serial as init()
+  const int n_local_nodes = static_cast<int>(_region_local_node.size());
+  for(int i=0; i<n_local_nodes; ++i)
   {
-    FVM_Node * fvm_node = *node_it;
+    FVM_Node * fvm_node = _region_local_node[i];
     FVM_NodeData * node_data = fvm_node->node_data();
 
     // lattice temperature, have been read from data file!
@@ -324,6 +346,9 @@ void SemiconductorSimulationRegion::reinit_after_import()
 void SemiconductorSimulationRegion::set_pmi(const std::string &type, const std::string &model_name, std::vector<Parser::Parameter> & pmi_parameters)
 {
   get_material_base()->set_pmi(type,model_name,pmi_parameters);
+  _band_cache.clear();
+  // the new PMI object starts without table
+  mt->init_mole_table(_node_data_storage.size());
 
   local_node_iterator it = on_local_nodes_begin();
   for ( ; it!=on_local_nodes_end(); ++it)
@@ -452,86 +477,48 @@ void SemiconductorSimulationRegion::elem_on_insulator_interface(const Elem *elem
 }
 
 
+const SemiconductorSimulationRegion::BandCache & SemiconductorSimulationRegion::band_cache(const FVM_Node * fvm_node, PetscScalar T) const
+{
+  const FVM_NodeData * node_data = fvm_node->node_data();
+  const unsigned int offset = node_data->offset();
+  if( offset >= _band_cache.size() )
+  {
+    BandCache invalid;
+    invalid.T = -1.0;
+    _band_cache.resize(std::max(offset+1, _node_data_storage.size()), invalid);
+  }
+
+  BandCache & cache = _band_cache[offset];
+  if( cache.T != T )
+  {
+    mt->mapping(fvm_node->root_node(), node_data, SolverSpecify::clock);
+    cache.T  = T;
+    cache.Eg = mt->band->Eg(T);
+    cache.Nc = mt->band->Nc(T);
+    cache.Nv = mt->band->Nv(T);
+    cache.ni = mt->band->ni(T);
+  }
+  return cache;
+}
+
+
 bool SemiconductorSimulationRegion::highfield_mobility() const
 {
   return ( _advanced_model.HighFieldMobility || _advanced_model.ImpactIonization || _advanced_model.BandBandTunneling) ;
 }
 
 
-Real SemiconductorSimulationRegion::truncated_partial_area(const Elem * elem, unsigned int ne) const
+void SemiconductorSimulationRegion::_mob_force_cache_allocate()
 {
-  // overestimate
-  //return std::abs(elem->partial_area_with_edge(ne));
-
-#if 0
-
-  Real partial_area =  elem->partial_area_with_edge_truncated(ne); // underestimate
-
-  std::pair<unsigned int, unsigned int> edge_nodes;
-  elem->nodes_on_edge(ne, edge_nodes);
-  const FVM_Node * fvm_n1 = elem->get_fvm_node(edge_nodes.first);   // fvm_node of node1
-  const FVM_Node * fvm_n2 = elem->get_fvm_node(edge_nodes.second);  // fvm_node of node2
-
-  unsigned int dim = elem->dim();
-  Real min_area = 0;
-  if( dim == 2)
-    min_area = 0.1*nm;
-  if( dim == 3)
-    min_area = 0.01*nm*nm;
-
-  // however, zero truncated partial area on surface will cut the current path, we here set an average "partial area"
-  if(fvm_n1->cv_surface_area(fvm_n2) < min_area)
-    partial_area = elem->partial_area_with_edge_average();
-  if(partial_area<min_area && (fvm_n1->boundary_id() != BoundaryInfo::invalid_id && fvm_n2->boundary_id() != BoundaryInfo::invalid_id) )
-    partial_area = elem->partial_area_with_edge_average();
-
-  return std::max(min_area, partial_area);
-#endif
-
-#if 0
-  // truncation when required. the result is accurate enough. however, not positive guaranty
-  Real partial_area =  elem->partial_area_with_edge(ne);
-
-  std::pair<unsigned int, unsigned int> edge_nodes;
-  elem->nodes_on_edge(ne, edge_nodes);
-  const FVM_Node * fvm_n1 = elem->get_fvm_node(edge_nodes.first);   // fvm_node of node1
-  const FVM_Node * fvm_n2 = elem->get_fvm_node(edge_nodes.second);  // fvm_node of node2
-
-  unsigned int dim = elem->dim();
-  Real min_area = 0;
-  if( dim == 2)
-    min_area = 0.1*nm;
-  if( dim == 3)
-    min_area = 0.01*nm*nm;
-
-  if(fvm_n1->cv_surface_area(fvm_n2) < min_area)
-    partial_area = std::max(min_area, elem->partial_area_with_edge_truncated(ne));
-
-  return partial_area;
-#endif
-
-  Real partial_area =  elem->partial_area_with_edge(ne);
-
-  std::pair<unsigned int, unsigned int> edge_nodes;
-  elem->nodes_on_edge(ne, edge_nodes);
-  const FVM_Node * fvm_n1 = elem->get_fvm_node(edge_nodes.first);   // fvm_node of node1
-  const FVM_Node * fvm_n2 = elem->get_fvm_node(edge_nodes.second);  // fvm_node of node2
-
-  unsigned int dim = elem->dim();
-  Real min_area = 0;
-  if( dim == 2)
-    min_area = 0.1*nm;
-  if( dim == 3)
-    min_area = 0.01*nm*nm;
-
-  double S  = std::max(min_area, fvm_n1->cv_abs_surface_area(fvm_n2));
-  double CV = std::max(min_area, fvm_n1->cv_surface_area(fvm_n2));
-  return std::abs(partial_area)/S*CV;
+  if( _cell_data_storage.scalar_valid(FVM_Semiconductor_CellData::_Epn_) ) return;
 
+  this->add_variable("elec_driving_force", CELL_CENTER);
+  this->add_variable("hole_driving_force", CELL_CENTER);
+  this->add_variable("elec_vertical_field", CELL_CENTER);
+  this->add_variable("hole_vertical_field", CELL_CENTER);
 }
 
 
-
 void SemiconductorSimulationRegion::zero_node_current()
 {
   local_node_iterator node_it = on_local_nodes_begin();
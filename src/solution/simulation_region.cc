@@ -19,6 +19,8 @@
 /*                                                                              */
 /********************************************************************************/
 
+#include <algorithm>
+
 #include "elem.h"
 #include "simulation_region.h"
 #include "boundary_condition.h"
@@ -32,7 +34,10 @@ std::map<unsigned int,  SimulationRegion *>  SimulationRegion::_subdomain_id_to_
 
 SimulationRegion::SimulationRegion(const std::string &name, const std::string &material, const double T, const double z)
   :_region_name(name), _region_material(material), _T_external(T), _z_width(z)
-{}
+{
+  _hanging_node_on_elem_side_flag = false;
+  _hanging_node_on_elem_edge_flag = false;
+}
 
 
 SimulationRegion::~SimulationRegion()
@@ -144,19 +149,31 @@ void SimulationRegion::clear()
   _region_processor_node.clear();
   _region_ghost_node.clear();
   _region_image_node.clear();
+  _ghost_sync_send.clear();
+  _ghost_sync_recv.clear();
 
 
   _cell_data_storage.clear();
   _node_data_storage.clear();
 
   _region_edges.clear();
-  _region_elem_edge_in_edges_index.clear();
+  _region_edge_cv_surface_area.clear();
+  _region_edge_length.clear();
+  _pseudo_time_step_scale.clear();
+  _region_elem_edge_offset.clear();
+  _region_cell_edge_index.clear();
+  _region_cell_edge_truncated_area.clear();
+  _region_cell_edge_truncated_volume.clear();
   _region_neighbors.clear();
   _region_boundaries.clear();
   _region_bounding_box = std::make_pair(Point(), Point());
 
   _hanging_node_on_elem_side.clear();
+  _hanging_node_on_elem_side_constraint.clear();
+  _hanging_node_on_elem_side_constraint_offset.clear();
   _hanging_node_on_elem_edge.clear();
+  _hanging_node_on_elem_edge_constraint.clear();
+  _hanging_node_on_elem_edge_constraint_offset.clear();
 }
 
 
@@ -167,12 +184,24 @@ void SimulationRegion::reserve_data_block(unsigned int n_cell_data, unsigned int
 }
 
 
+namespace {
+  // order FVM_Node by root node id
+  struct FVMNodeIdLess
+  {
+    bool operator()(const FVM_Node *a, const FVM_Node *b) const { return a->root_node()->id() < b->root_node()->id(); }
+  };
+}
+
+
 void SimulationRegion::rebuild_region_fvm_node_list()
 {
   _region_local_node.clear();
   _region_processor_node.clear();
   _region_ghost_node.clear();
   _region_image_node.clear();
+  _ghost_sync_send.clear();
+  _ghost_sync_recv.clear();
+  _pseudo_time_step_scale.clear();
 
 
   // fill on_local and on_processor node vector
@@ -190,21 +219,40 @@ void SimulationRegion::rebuild_region_fvm_node_list()
       _region_ghost_node.push_back(fvm_node);
   }
 
-  std::set<unsigned int> ghost_nodes;
+  // (node id, processor) pair of all the ghost nodes
+  std::vector<unsigned int> ghost_nodes;
   for(unsigned int n=0; n<_region_ghost_node.size(); ++n)
-    ghost_nodes.insert( _region_ghost_node[n]->root_node()->id() );
+  {
+    const FVM_Node * fvm_node = _region_ghost_node[n];
+    ghost_nodes.push_back( fvm_node->root_node()->id() );
+    ghost_nodes.push_back( Genius::processor_id() );
+    _ghost_sync_recv[fvm_node->root_node()->processor_id()].push_back(fvm_node);
+  }
   Parallel::allgather(ghost_nodes);
 
-  std::set<unsigned int>::const_iterator it = ghost_nodes.begin();
-  for( ; it != ghost_nodes.end(); ++it)
+  std::set<unsigned int> image_nodes;
+  for(unsigned int n=0; n<ghost_nodes.size(); n+=2)
   {
-    unsigned int id = *it;
+    unsigned int id = ghost_nodes[n];
     if( _region_node.find(id) == _region_node.end() ) continue;
 
     FVM_Node * fvm_node = _region_node.find(id)->second;
-    if( fvm_node->on_processor() )
-      _region_image_node.push_back(fvm_node);
+    if( !fvm_node->on_processor() ) continue;
+
+    image_nodes.insert(id);
+    _ghost_sync_send[ghost_nodes[n+1]].push_back(fvm_node);
   }
+
+  std::set<unsigned int>::const_iterator it = image_nodes.begin();
+  for( ; it != image_nodes.end(); ++it)
+    _region_image_node.push_back(_region_node.find(*it)->second);
+
+  // both sides of the sync plan are ordered by node id
+  std::map<unsigned int, std::vector<const FVM_Node *> >::iterator plan_it;
+  for( plan_it = _ghost_sync_send.begin(); plan_it != _ghost_sync_send.end(); ++plan_it )
+    std::sort(plan_it->second.begin(), plan_it->second.end(), FVMNodeIdLess());
+  for( plan_it = _ghost_sync_recv.begin(); plan_it != _ghost_sync_recv.end(); ++plan_it )
+    std::sort(plan_it->second.begin(), plan_it->second.end(), FVMNodeIdLess());
 }
 
 
@@ -212,14 +260,42 @@ void SimulationRegion::prepare_for_use()
 {
   START_LOG("prepare_for_use()", "SimulationRegion");
 
+  // thread parallel loop needs random access
+  std::vector<FVM_Node *> fvm_nodes;
+  fvm_nodes.reserve(_region_node.size());
   std::map<unsigned int, FVM_Node *>::iterator nodes_it = _region_node.begin();
   for(; nodes_it != _region_node.end(); ++nodes_it)
-  {
-    FVM_Node * fvm_node = (*nodes_it).second;
-    fvm_node->prepare_for_use();
+    fvm_nodes.push_back((*nodes_it).second);
+
+  const int n_fvm_nodes = static_cast<int>(fvm_nodes.size());
 
+  // each FVM_Node only sorts its own neighbor list
+#ifdef HAVE_OPENMP
+  #pragma omp parallel for schedule(static)
+#endif
+  for(int i=0; i<n_fvm_nodes; ++i)
+    fvm_nodes[i]->prepare_for_use();
+
+  // read only check for FVM_Node with negative laplace operator or negative surface area to its neighbor.
+  // the fix below only turns cv surface area to positive, so a node passes this check will never need fix.
+  std::vector<char> need_fix(n_fvm_nodes, 0);
+#ifdef HAVE_OPENMP
+  #pragma omp parallel for schedule(static)
+#endif
+  for(int i=0; i<n_fvm_nodes; ++i)
+  {
+    FVM_Node * fvm_node = fvm_nodes[i];
     // skip not on processor fvm_node
     if( !fvm_node->on_processor() ) continue;
+    if( fvm_node->laplace_unit() < 0.0 || !fvm_node->posotive_cv_surface_area_to_each_neighbor(false) )
+      need_fix[i] = 1;
+  }
+
+  // the fix also modifies the neighbors, do it in serial with the original order
+  for(int i=0; i<n_fvm_nodes; ++i)
+  {
+    if( !need_fix[i] ) continue;
+    FVM_Node * fvm_node = fvm_nodes[i];
 
      // fix FVM_Node if laplace operator < 0.0
     if( fvm_node->laplace_unit() < 0.0 )
@@ -262,6 +338,8 @@ void SimulationRegion::prepare_for_use()
     for(element_iterator elem_it = elements_begin(); elem_it != elements_end(); elem_it++)
     {
       const Elem * elem = *elem_it; // elem are on local
+      _region_elem_edge_offset[elem] = _region_cell_edge_index.size();
+      _region_cell_edge_index.resize(_region_cell_edge_index.size() + elem->n_edges());
       for(unsigned int n=0; n<elem->n_edges(); ++n)
       {
         std::pair<unsigned int, unsigned int> local_edge_nodes;
@@ -287,14 +365,7 @@ void SimulationRegion::prepare_for_use()
       {
         const Elem * elem = elem_shares_edge[n].first;
         unsigned int local_edge_index = elem_shares_edge[n].second;
-
-        if(_region_elem_edge_in_edges_index.find(elem) == _region_elem_edge_in_edges_index.end())
-        {
-          _region_elem_edge_in_edges_index[elem].resize(elem->n_edges());
-          _region_elem_edge_in_edges_index[elem][local_edge_index] = edge_index;
-        }
-        else
-          _region_elem_edge_in_edges_index[elem][local_edge_index] = edge_index;
+        _region_cell_edge_index[_region_elem_edge_offset[elem] + local_edge_index] = edge_index;
       }
     }
   }
@@ -379,20 +450,112 @@ void SimulationRegion::prepare_for_use_parallel()
     }
   }
 
-  // hanging node flag
+  // edge geometry, all the cv surface area has been fixed in prepare_for_use
   {
-    std::vector<int> hanging_node_flags;
-    hanging_node_flags.push_back(static_cast<int>( _hanging_node_on_elem_side.size() != 0 && _hanging_node_on_elem_edge.size() == 0 ));
-    hanging_node_flags.push_back(static_cast<int>(  _hanging_node_on_elem_edge.size() != 0 ));
-    Parallel::max(hanging_node_flags);
-    _hanging_node_on_elem_side_flag = static_cast<bool>(hanging_node_flags[0]);
-    _hanging_node_on_elem_edge_flag = static_cast<bool>(hanging_node_flags[1]);
+    _region_edge_cv_surface_area.resize(_region_edges.size());
+    _region_edge_length.resize(_region_edges.size());
+    for(unsigned int e=0; e<_region_edges.size(); ++e)
+    {
+      const FVM_Node * fvm_n1 = _region_edges[e].first;
+      const FVM_Node * fvm_n2 = _region_edges[e].second;
+      _region_edge_cv_surface_area[e] = fvm_n1->cv_surface_area(fvm_n2);
+      _region_edge_length[e] = fvm_n1->distance(fvm_n2);
+    }
+  }
+
+  // truncated partial area and volume of each cell edge, used when the voronoi cell is truncated
+  {
+    _region_cell_edge_truncated_area.resize(_region_cell_edge_index.size());
+    _region_cell_edge_truncated_volume.resize(_region_cell_edge_index.size());
+    for(element_iterator elem_it = elements_begin(); elem_it != elements_end(); elem_it++)
+    {
+      const Elem * elem = *elem_it;
+      const unsigned int offset = cell_edge_offset(elem);
+      for(unsigned int ne=0; ne<elem->n_edges(); ++ne)
+      {
+        _region_cell_edge_truncated_area[offset+ne] = _truncated_partial_area(elem, ne);
+        _region_cell_edge_truncated_volume[offset+ne] = elem->partial_volume_with_edge_truncated(ne);
+      }
+    }
   }
 
   STOP_LOG("prepare_for_use_parallel()", "SimulationRegion");
 }
 
 
+Real SimulationRegion::_truncated_partial_area(const Elem * elem, unsigned int ne) const
+{
+  // overestimate
+  //return std::abs(elem->partial_area_with_edge(ne));
+
+#if 0
+
+  Real partial_area =  elem->partial_area_with_edge_truncated(ne); // underestimate
+
+  std::pair<unsigned int, unsigned int> edge_nodes;
+  elem->nodes_on_edge(ne, edge_nodes);
+  const FVM_Node * fvm_n1 = elem->get_fvm_node(edge_nodes.first);   // fvm_node of node1
+  const FVM_Node * fvm_n2 = elem->get_fvm_node(edge_nodes.second);  // fvm_node of node2
+
+  unsigned int dim = elem->dim();
+  Real min_area = 0;
+  if( dim == 2)
+    min_area = 0.1*PhysicalUnit::nm;
+  if( dim == 3)
+    min_area = 0.01*PhysicalUnit::nm*PhysicalUnit::nm;
+
+  // however, zero truncated partial area on surface will cut the current path, we here set an average "partial area"
+  if(fvm_n1->cv_surface_area(fvm_n2) < min_area)
+    partial_area = elem->partial_area_with_edge_average();
+  if(partial_area<min_area && (fvm_n1->boundary_id() != BoundaryInfo::invalid_id && fvm_n2->boundary_id() != BoundaryInfo::invalid_id) )
+    partial_area = elem->partial_area_with_edge_average();
+
+  return std::max(min_area, partial_area);
+#endif
+
+#if 0
+  // truncation when required. the result is accurate enough. however, not positive guaranty
+  Real partial_area =  elem->partial_area_with_edge(ne);
+
+  std::pair<unsigned int, unsigned int> edge_nodes;
+  elem->nodes_on_edge(ne, edge_nodes);
+  const FVM_Node * fvm_n1 = elem->get_fvm_node(edge_nodes.first);   // fvm_node of node1
+  const FVM_Node * fvm_n2 = elem->get_fvm_node(edge_nodes.second);  // fvm_node of node2
+
+  unsigned int dim = elem->dim();
+  Real min_area = 0;
+  if( dim == 2)
+    min_area = 0.1*PhysicalUnit::nm;
+  if( dim == 3)
+    min_area = 0.01*PhysicalUnit::nm*PhysicalUnit::nm;
+
+  if(fvm_n1->cv_surface_area(fvm_n2) < min_area)
+    partial_area = std::max(min_area, elem->partial_area_with_edge_truncated(ne));
+
+  return partial_area;
+#endif
+
+  Real partial_area =  elem->partial_area_with_edge(ne);
+
+  std::pair<unsigned int, unsigned int> edge_nodes;
+  elem->nodes_on_edge(ne, edge_nodes);
+  const FVM_Node * fvm_n1 = elem->get_fvm_node(edge_nodes.first);   // fvm_node of node1
+  const FVM_Node * fvm_n2 = elem->get_fvm_node(edge_nodes.second);  // fvm_node of node2
+
+  unsigned int dim = elem->dim();
+  Real min_area = 0;
+  if( dim == 2)
+    min_area = 0.1*PhysicalUnit::nm;
+  if( dim == 3)
+    min_area = 0.01*PhysicalUnit::nm*PhysicalUnit::nm;
+
+  double S  = std::max(min_area, fvm_n1->cv_abs_surface_area(fvm_n2));
+  double CV = std::max(min_area, fvm_n1->cv_surface_area(fvm_n2));
+  return std::abs(partial_area)/S*CV;
+
+}
+
+
 Real SimulationRegion::fvm_cell_quality() const
 {
 #if 0
@@ -412,6 +575,44 @@ Real SimulationRegion::fvm_cell_quality() const
 
 
 
+void SimulationRegion::build_pseudo_time_step_scale(bool local)
+{
+  _pseudo_time_step_scale.clear();
+  if( !local ) return;
+
+  std::vector<Real> scale;
+  scale.reserve(_region_processor_node.size());
+
+  Real sum = 0.0;
+  Real count = 0.0;
+  for(unsigned int n=0; n<_region_processor_node.size(); ++n)
+  {
+    const FVM_Node * fvm_node = _region_processor_node[n];
+
+    Real coupling = 0.0;
+    FVM_Node::fvm_neighbor_node_iterator nb_it = fvm_node->neighbor_node_begin();
+    for(; nb_it != fvm_node->neighbor_node_end(); ++nb_it)
+      coupling += std::abs((*nb_it).second.first)/fvm_node->distance((*nb_it).first);
+
+    // isolated node, keep the global step
+    Real s = coupling > 0.0 ? fvm_node->volume()/coupling : 0.0;
+    scale.push_back(s);
+    if( s > 0.0 ) { sum += s; count += 1.0; }
+  }
+
+  Parallel::sum(sum);
+  Parallel::sum(count);
+  if( count == 0.0 ) return;
+
+  const Real mean = sum/count;
+  for(unsigned int n=0; n<scale.size(); ++n)
+    scale[n] = scale[n] > 0.0 ? std::min(std::max(scale[n]/mean, 1e-3), 1e3) : 1.0;
+
+  _pseudo_time_step_scale.swap(scale);
+}
+
+
+
 bool SimulationRegion::is_neighbor(const SimulationRegion *r) const
 {
   for(unsigned int n=0; n<_region_neighbors.size(); ++n)
@@ -443,6 +644,25 @@ void SimulationRegion::remove_remote_object()
 
 
 
+VectorValue<PetscScalar> SimulationRegion::cell_efield(unsigned int n) const
+{
+  // metal regions are equipotential
+  if( type() != SemiconductorRegion && type() != InsulatorRegion )
+    return VectorValue<PetscScalar>(0.0, 0.0, 0.0);
+
+  const Elem * elem = _region_cell[n];
+
+  std::vector<PetscScalar> psi_vertex;
+  psi_vertex.reserve(elem->n_nodes());
+  for(unsigned int nd=0; nd<elem->n_nodes(); ++nd)
+    psi_vertex.push_back( elem->get_fvm_node(nd)->node_data()->psi() );
+
+  // E = - grad(psi)
+  return - elem->gradient(psi_vertex);
+}
+
+
+
 unsigned int SimulationRegion::add_variable(const SimulationVariable &v)
 {
   std::string var_name = v.variable_name;
@@ -459,7 +679,7 @@ unsigned int SimulationRegion::add_variable(const SimulationVariable &v)
 
     switch( v.variable_data_type )
     {
-        case SCALAR  :  it->second.variable_index = _node_data_storage.add_scalar_variable(var_index, it->second.variable_valid); break;
+        case SCALAR  :  it->second.variable_index = _node_data_storage.add_scalar_variable(var_index, it->second.variable_valid, it->second.variable_single_precision); break;
         case COMPLEX :  it->second.variable_index = _node_data_storage.add_complex_variable(var_index, it->second.variable_valid); break;
         case VECTOR  :  it->second.variable_index = _node_data_storage.add_vector_variable(var_index, it->second.variable_valid); break;
         case TENSOR  :  it->second.variable_index = _node_data_storage.add_tensor_variable(var_index, it->second.variable_valid); break;
@@ -480,7 +700,7 @@ unsigned int SimulationRegion::add_variable(const SimulationVariable &v)
 
     switch( v.variable_data_type )
     {
-        case SCALAR  :  it->second.variable_index = _cell_data_storage.add_scalar_variable(var_index, it->second.variable_valid); break;
+        case SCALAR  :  it->second.variable_index = _cell_data_storage.add_scalar_variable(var_index, it->second.variable_valid, it->second.variable_single_precision); break;
         case COMPLEX :  it->second.variable_index = _cell_data_storage.add_complex_variable(var_index, it->second.variable_valid); break;
         case VECTOR  :  it->second.variable_index = _cell_data_storage.add_vector_variable(var_index, it->second.variable_valid); break;
         case TENSOR  :  it->second.variable_index = _cell_data_storage.add_tensor_variable(var_index, it->second.variable_valid); break;
@@ -507,7 +727,7 @@ bool SimulationRegion::add_variable(const std::string &var_name, DataLocation lo
     if(!it->second.variable_valid) it->second.variable_valid = true;
     switch( it->second.variable_data_type )
     {
-        case SCALAR  :  it->second.variable_index = _node_data_storage.add_scalar_variable(it->second.variable_index, it->second.variable_valid); break;
+        case SCALAR  :  it->second.variable_index = _node_data_storage.add_scalar_variable(it->second.variable_index, it->second.variable_valid, it->second.variable_single_precision); break;
         case COMPLEX :  it->second.variable_index = _node_data_storage.add_complex_variable(it->second.variable_index, it->second.variable_valid); break;
         case VECTOR  :  it->second.variable_index = _node_data_storage.add_vector_variable(it->second.variable_index, it->second.variable_valid); break;
         case TENSOR  :  it->second.variable_index = _node_data_storage.add_tensor_variable(it->second.variable_index, it->second.variable_valid); break;
@@ -525,7 +745,7 @@ bool SimulationRegion::add_variable(const std::string &var_name, DataLocation lo
     if(!it->second.variable_valid) it->second.variable_valid = true;
     switch( it->second.variable_data_type )
     {
-        case SCALAR  :  it->second.variable_index = _cell_data_storage.add_scalar_variable(it->second.variable_index, it->second.variable_valid); break;
+        case SCALAR  :  it->second.variable_index = _cell_data_storage.add_scalar_variable(it->second.variable_index, it->second.variable_valid, it->second.variable_single_precision); break;
         case COMPLEX :  it->second.variable_index = _cell_data_storage.add_complex_variable(it->second.variable_index, it->second.variable_valid); break;
         case VECTOR  :  it->second.variable_index = _cell_data_storage.add_vector_variable(it->second.variable_index, it->second.variable_valid); break;
         case TENSOR  :  it->second.variable_index = _cell_data_storage.add_tensor_variable(it->second.variable_index, it->second.variable_valid); break;
@@ -629,7 +849,7 @@ bool SimulationRegion::get_variable_data(const std::string &var_name, DataLocati
     {
       const FVM_Node * fvm_node = _region_processor_node[n];
       unsigned int offset = fvm_node->node_data()->offset();
-      value.insert( std::make_pair(fvm_node->root_node()->id(), _node_data_storage.data<T>(variable_index, offset)/unit ) );
+      value.insert( std::make_pair(fvm_node->root_node()->id(), _node_data_storage.get_data<T>(variable_index, offset)/unit ) );
     }
     Parallel::allgather(value);
 
@@ -654,7 +874,7 @@ bool SimulationRegion::get_variable_data(const std::string &var_name, DataLocati
       if( elem->on_processor() )
       {
         unsigned int offset = _region_cell_data[n]->offset();
-        value.insert( std::make_pair(elem->id(), _cell_data_storage.data<T>(variable_index, offset)/unit ) );
+        value.insert( std::make_pair(elem->id(), _cell_data_storage.get_data<T>(variable_index, offset)/unit ) );
       }
     }
     Parallel::allgather(value);
@@ -687,7 +907,7 @@ bool SimulationRegion::set_variable_data(const std::string &var_name, DataLocati
     {
       const FVM_Node * fvm_node = _region_processor_node[n];
       unsigned int offset = fvm_node->node_data()->offset();
-      _node_data_storage.data<T>(variable_index, offset) = val*unit;
+      _node_data_storage.set_data<T>(variable_index, offset, val*unit);
     }
   }
 
@@ -706,7 +926,7 @@ bool SimulationRegion::set_variable_data(const std::string &var_name, DataLocati
       if( elem->on_processor() )
       {
         unsigned int offset = _region_cell_data[n]->offset();
-        _cell_data_storage.data<T>(variable_index, offset) = val*unit;
+        _cell_data_storage.set_data<T>(variable_index, offset, val*unit);
       }
     }
   }
@@ -718,31 +938,137 @@ bool SimulationRegion::set_variable_data(const std::string &var_name, DataLocati
 
 template <typename T>
 bool SimulationRegion::sync_point_variable(const std::string &var_name)
+{
+  return sync_point_variables(std::vector<std::string>(1, var_name));
+}
+
+
+namespace {
+  // message tag of the ghost node sync
+  const int ghost_sync_tag = 2701;
+
+  // the number of Real of each data type in the sync message
+  unsigned int sync_data_size(DataType type)
+  {
+    switch(type)
+    {
+      case SCALAR  : return 1;
+      case COMPLEX : return 2;
+      case VECTOR  : return 3;
+      case TENSOR  : return 9;
+      default      : return 0;
+    }
+  }
+}
+
+
+bool SimulationRegion::sync_point_variables(const std::vector<std::string> &var_names)
 {
   parallel_only();
 
-  if( _region_point_variables.find(var_name) == _region_point_variables.end() ) return false;
+  std::vector<const SimulationVariable *> variables;
+  unsigned int block_size = 0;
+  for(unsigned int v=0; v<var_names.size(); ++v)
+  {
+    std::map<std::string, SimulationVariable>::const_iterator it = _region_point_variables.find(var_names[v]);
+    if( it == _region_point_variables.end() ) return false;
+    variables.push_back(&it->second);
+    block_size += sync_data_size(it->second.variable_data_type);
+  }
+
+  if( Genius::n_processors() == 1 || block_size == 0 ) return true;
+
+  START_LOG("sync_point_variables()", "SimulationRegion");
 
-  const SimulationVariable & variable = _region_point_variables.find(var_name)->second;
-  unsigned int variable_index = variable.variable_index;
+  std::vector<Parallel::request> requests;
 
-  std::map<unsigned int, T> ghost_values;
-  for(unsigned int n=0; n<_region_image_node.size(); ++n)
+  // post receives of ghost nodes
+  std::map<unsigned int, std::vector<Real> > recv_buffers;
+  std::map<unsigned int, std::vector<const FVM_Node *> >::const_iterator plan_it;
+  for( plan_it = _ghost_sync_recv.begin(); plan_it != _ghost_sync_recv.end(); ++plan_it )
   {
-    const FVM_Node * fvm_node = _region_image_node[n];
-    unsigned int offset = fvm_node->node_data()->offset();
-    ghost_values.insert( std::make_pair(fvm_node->root_node()->id(), _node_data_storage.data<T>(variable_index, offset)) );
+    std::vector<Real> & buffer = recv_buffers[plan_it->first];
+    buffer.resize(plan_it->second.size()*block_size);
+    requests.push_back(Parallel::request());
+    Parallel::irecv(plan_it->first, buffer, requests.back(), ghost_sync_tag);
   }
-  Parallel::allgather(ghost_values);
 
-  for(unsigned int n=0; n<_region_ghost_node.size(); ++n)
+  // pack image nodes, node by node
+  std::map<unsigned int, std::vector<Real> > send_buffers;
+  for( plan_it = _ghost_sync_send.begin(); plan_it != _ghost_sync_send.end(); ++plan_it )
   {
-    const FVM_Node * fvm_node = _region_ghost_node[n];
-    T value = ghost_values.find(fvm_node->root_node()->id())->second;
-    unsigned int offset = fvm_node->node_data()->offset();
-    _node_data_storage.data<T>(variable_index, offset) = value;
+    std::vector<Real> & buffer = send_buffers[plan_it->first];
+    buffer.reserve(plan_it->second.size()*block_size);
+    for(unsigned int n=0; n<plan_it->second.size(); ++n)
+    {
+      unsigned int offset = plan_it->second[n]->node_data()->offset();
+      for(unsigned int v=0; v<variables.size(); ++v)
+      {
+        unsigned int index = variables[v]->variable_index;
+        switch(variables[v]->variable_data_type)
+        {
+          case SCALAR  :
+            buffer.push_back(_node_data_storage.get_data<Real>(index, offset)); break;
+          case COMPLEX :
+          {
+            const std::complex<Real> & c = _node_data_storage.data< std::complex<Real> >(index, offset);
+            buffer.push_back(c.real());
+            buffer.push_back(c.imag());
+            break;
+          }
+          case VECTOR  :
+          {
+            const VectorValue<Real> & d = _node_data_storage.data< VectorValue<Real> >(index, offset);
+            for(unsigned int i=0; i<3; ++i) buffer.push_back(d(i));
+            break;
+          }
+          case TENSOR  :
+          {
+            const TensorValue<Real> & d = _node_data_storage.data< TensorValue<Real> >(index, offset);
+            for(unsigned int i=0; i<3; ++i)
+              for(unsigned int j=0; j<3; ++j) buffer.push_back(d(i,j));
+            break;
+          }
+          default: break;
+        }
+      }
+    }
+    requests.push_back(Parallel::request());
+    Parallel::isend(plan_it->first, buffer, requests.back(), ghost_sync_tag);
+  }
+
+  Parallel::wait(requests);
+
+  // unpack ghost nodes
+  for( plan_it = _ghost_sync_recv.begin(); plan_it != _ghost_sync_recv.end(); ++plan_it )
+  {
+    const Real * p = recv_buffers[plan_it->first].empty() ? 0 : &recv_buffers[plan_it->first][0];
+    for(unsigned int n=0; n<plan_it->second.size(); ++n)
+    {
+      unsigned int offset = plan_it->second[n]->node_data()->offset();
+      for(unsigned int v=0; v<variables.size(); ++v)
+      {
+        unsigned int index = variables[v]->variable_index;
+        switch(variables[v]->variable_data_type)
+        {
+          case SCALAR  :
+            _node_data_storage.set_data<Real>(index, offset, p[0]); break;
+          case COMPLEX :
+            _node_data_storage.data< std::complex<Real> >(index, offset) = std::complex<Real>(p[0], p[1]); break;
+          case VECTOR  :
+            _node_data_storage.data< VectorValue<Real> >(index, offset) = VectorValue<Real>(p[0], p[1], p[2]); break;
+          case TENSOR  :
+            _node_data_storage.data< TensorValue<Real> >(index, offset) = TensorValue<Real>(p); break;
+          default: break;
+        }
+        p += sync_data_size(variables[v]->variable_data_type);
+      }
+    }
   }
 
+  STOP_LOG("sync_point_variables()", "SimulationRegion");
+
+  return true;
 }
 
 
@@ -784,7 +1110,7 @@ void SimulationRegion::add_hanging_node_on_side(const Node * node, const Elem *
   genius_assert( it!=_region_node.end() );
 
   const FVM_Node * fvm_node = (*it).second;
-  _hanging_node_on_elem_side[fvm_node] = std::pair<const Elem *, unsigned int>(elem, s);
+  _hanging_node_on_elem_side.push_back( std::make_pair(fvm_node, std::pair<const Elem *, unsigned int>(elem, s)) );
 }
 
 
@@ -794,8 +1120,77 @@ void SimulationRegion::add_hanging_node_on_edge(const Node * node, const Elem *
   genius_assert( it!=_region_node.end() );
 
   const FVM_Node * fvm_node = (*it).second;
-  _hanging_node_on_elem_edge[fvm_node] = std::pair<const Elem *, unsigned int>(elem, e);
+  _hanging_node_on_elem_edge.push_back( std::make_pair(fvm_node, std::pair<const Elem *, unsigned int>(elem, e)) );
+
+}
 
+
+namespace {
+  typedef std::pair<const FVM_Node *, std::pair<const Elem *, unsigned int> > HangingNode;
+
+  // order hanging node by FVM_Node
+  struct HangingNodeLess
+  {
+    bool operator()(const HangingNode &a, const HangingNode &b) const { return a.first < b.first; }
+  };
+
+  // same FVM_Node
+  struct HangingNodeEqual
+  {
+    bool operator()(const HangingNode &a, const HangingNode &b) const { return a.first == b.first; }
+  };
+}
+
+
+void SimulationRegion::prepare_hanging_node()
+{
+  // several elem may share the same hanging node. we record only one
+  std::stable_sort(_hanging_node_on_elem_side.begin(), _hanging_node_on_elem_side.end(), HangingNodeLess());
+  _hanging_node_on_elem_side.erase( std::unique(_hanging_node_on_elem_side.begin(), _hanging_node_on_elem_side.end(), HangingNodeEqual()),
+                                    _hanging_node_on_elem_side.end() );
+  std::stable_sort(_hanging_node_on_elem_edge.begin(), _hanging_node_on_elem_edge.end(), HangingNodeLess());
+  _hanging_node_on_elem_edge.erase( std::unique(_hanging_node_on_elem_edge.begin(), _hanging_node_on_elem_edge.end(), HangingNodeEqual()),
+                                    _hanging_node_on_elem_edge.end() );
+
+  // the FVM nodes on the side, the hanging node lies on the side center
+  _hanging_node_on_elem_side_constraint.clear();
+  _hanging_node_on_elem_side_constraint_offset.clear();
+  _hanging_node_on_elem_side_constraint_offset.push_back(0);
+  for(unsigned int i=0; i<_hanging_node_on_elem_side.size(); ++i)
+  {
+    const Elem * elem = _hanging_node_on_elem_side[i].second.first;
+    AutoPtr<Elem> side = elem->build_side(_hanging_node_on_elem_side[i].second.second);
+    for(unsigned int n=0; n<side->n_nodes(); n++)
+      _hanging_node_on_elem_side_constraint.push_back( region_fvm_node(side->get_node(n)) );
+    _hanging_node_on_elem_side_constraint_offset.push_back(_hanging_node_on_elem_side_constraint.size());
+  }
+
+  // the FVM nodes on the edge, the hanging node lies on the edge center
+  _hanging_node_on_elem_edge_constraint.clear();
+  _hanging_node_on_elem_edge_constraint_offset.clear();
+  _hanging_node_on_elem_edge_constraint_offset.push_back(0);
+  for(unsigned int i=0; i<_hanging_node_on_elem_edge.size(); ++i)
+  {
+    const Elem * elem = _hanging_node_on_elem_edge[i].second.first;
+    AutoPtr<Elem> edge = elem->build_edge(_hanging_node_on_elem_edge[i].second.second);
+    for(unsigned int n=0; n<edge->n_nodes(); n++)
+    {
+      const FVM_Node * edge_fvm_node = region_fvm_node(edge->get_node(n));
+      genius_assert(edge_fvm_node!=NULL);
+      _hanging_node_on_elem_edge_constraint.push_back( edge_fvm_node );
+    }
+    _hanging_node_on_elem_edge_constraint_offset.push_back(_hanging_node_on_elem_edge_constraint.size());
+  }
+
+  // hanging node flag
+  {
+    std::vector<int> hanging_node_flags;
+    hanging_node_flags.push_back(static_cast<int>( _hanging_node_on_elem_side.size() != 0 && _hanging_node_on_elem_edge.size() == 0 ));
+    hanging_node_flags.push_back(static_cast<int>(  _hanging_node_on_elem_edge.size() != 0 ));
+    Parallel::max(hanging_node_flags);
+    _hanging_node_on_elem_side_flag = static_cast<bool>(hanging_node_flags[0]);
+    _hanging_node_on_elem_edge_flag = static_cast<bool>(hanging_node_flags[1]);
+  }
 }
 
 
@@ -819,6 +1214,11 @@ size_t SimulationRegion::memory_size() const
   counter += _region_processor_node.capacity()*sizeof(FVM_Node *);
   counter += _region_ghost_node.capacity()*sizeof(FVM_Node *);
   counter += _region_image_node.capacity()*sizeof(FVM_Node *);
+  std::map<unsigned int, std::vector<const FVM_Node *> >::const_iterator plan_it;
+  for( plan_it = _ghost_sync_send.begin(); plan_it != _ghost_sync_send.end(); ++plan_it )
+    counter += plan_it->second.capacity()*sizeof(FVM_Node *);
+  for( plan_it = _ghost_sync_recv.begin(); plan_it != _ghost_sync_recv.end(); ++plan_it )
+    counter += plan_it->second.capacity()*sizeof(FVM_Node *);
   counter +=  _node_data_storage.memory_size();
   counter += _region_edges.capacity()*sizeof(std::pair<FVM_Node *, FVM_Node *>);
 
@@ -826,6 +1226,65 @@ size_t SimulationRegion::memory_size() const
 }
 
 
+void SimulationRegion::memory_usage(std::map<std::string, size_t> & usage) const
+{
+  // approx overhead of a tree node besides its value
+  const size_t tree_node = 4*sizeof(void *);
+
+  size_t fvm_nodes = 0;
+  std::map<unsigned int, FVM_Node *>::const_iterator it = _region_node.begin();
+  for( ; it != _region_node.end(); it++ )
+    fvm_nodes += it->second->memory_size();
+  usage["fvm node (with neighbor and ghost lists)"] += fvm_nodes;
+
+  usage["region node map"] += _region_node.size()*(sizeof(std::pair<unsigned int, FVM_Node *>) + tree_node) +
+                              ( _region_local_node.capacity() + _region_processor_node.capacity() +
+                                _region_ghost_node.capacity() + _region_image_node.capacity() )*sizeof(FVM_Node *);
+
+  usage["hanging node map"] += (_hanging_node_on_elem_side.capacity() + _hanging_node_on_elem_edge.capacity())*
+                               sizeof(std::pair<const FVM_Node *, std::pair<const Elem *, unsigned int> >) +
+                               (_hanging_node_on_elem_side_constraint.capacity() + _hanging_node_on_elem_edge_constraint.capacity())*sizeof(const FVM_Node *) +
+                               (_hanging_node_on_elem_side_constraint_offset.capacity() + _hanging_node_on_elem_edge_constraint_offset.capacity())*sizeof(unsigned int);
+
+  usage["node data"] += _node_data_storage.memory_size();
+
+  usage["cell data"] += _cell_data_storage.memory_size() +
+                        _region_cell.capacity()*sizeof(const Elem *) + _region_cell_data.capacity()*sizeof(FVM_CellData *);
+
+  size_t edges = _region_edges.capacity()*sizeof(std::pair<FVM_Node *, FVM_Node *>);
+  edges += (_region_edge_cv_surface_area.capacity() + _region_edge_length.capacity())*sizeof(Real);
+  edges += _region_elem_edge_offset.size()*(sizeof(const Elem *) + sizeof(unsigned int) + tree_node);
+  edges += _region_cell_edge_index.capacity()*sizeof(unsigned int) +
+           (_region_cell_edge_truncated_area.capacity() + _region_cell_edge_truncated_volume.capacity())*sizeof(Real);
+  usage["region edges"] += edges;
+}
+
+
+void SimulationRegion::write_checkpoint(std::ostream & out) const
+{
+  unsigned int name_length = _region_name.size();
+  out.write(reinterpret_cast<const char *>(&name_length), sizeof(unsigned int));
+  out.write(_region_name.c_str(), name_length);
+
+  _node_data_storage.write(out);
+  _cell_data_storage.write(out);
+}
+
+
+bool SimulationRegion::read_checkpoint(std::istream & in)
+{
+  unsigned int name_length;
+  in.read(reinterpret_cast<char *>(&name_length), sizeof(unsigned int));
+  if( !in.good() || name_length != _region_name.size() ) return false;
+
+  std::string name(name_length, ' ');
+  if( name_length ) in.read(&name[0], name_length);
+  if( name != _region_name ) return false;
+
+  return _node_data_storage.read(in) && _cell_data_storage.read(in);
+}
+
+
 
 
 //explicit instantiation
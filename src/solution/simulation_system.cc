@@ -24,10 +24,15 @@
 #include <sstream>
 #include <numeric>
 #include <queue>
+#include <set>
+#include <cmath>
 #include <algorithm>
 
 #include "parser.h"
 #include "unstructured_mesh.h"
+#include "mesh_tools.h"
+#include "fe_type.h"
+#include "fe_interface.h"
 #include "simulation_system.h"
 #include "simulation_region.h"
 #include "semiconductor_region.h"
@@ -37,24 +42,30 @@
 #include "vacuum_region.h"
 #include "pml_region.h"
 #include "parallel.h"
+#include "object_pool.h"
 #include "boundary_info.h"
 #include "boundary_condition_collector.h"
 #include "electrical_source.h"
 #include "field_source.h"
+#include "elem_node_deposition.h"
 
 #include "vtk_io.h"
 #include "cgns_io.h"
+#include "hdf5_io.h"
 #include "stanford_io.h"
 #include "tif_io.h"
 #include "tif3d_io.h"
 #include "gdml_io.h"
 #include "dfise_io.h"
 #include "spice_ckt.h"
+#include "fvm_pde_solver.h"
 #include "location_io.h"
+#include "checkpoint_io.h"
 
 #include "interpolation_2d_csa.h"
 
 #include "perf_log.h"
+#include "startup_log.h"
 #include "sync_file.h"
 
 
@@ -69,9 +80,10 @@
 
 
 SimulationSystem::SimulationSystem(MeshBase & mesh)
-  : _mesh(mesh), _cylindrical_mesh(false), _resistive_metal_mode(false), _block_partition(true),
+  : _mesh(mesh), _cylindrical_mesh(false), _resistive_metal_mode(false), _block_partition(true), _mesh_ordering(MeshBase::BFS_ORDER), _distributed_mesh(false),
     _bcs(0), _electrical_source(0),
-    _field_source(0), _spice_ckt(0), _global_z_width(false)
+    _field_source(0), _spice_ckt(0), _global_z_width(false), _device_multiplicity(1.0), _mesh_revision(0),
+    _elem_node_deposition(0)
 {
   // set PhysicalUnit
   PhysicalUnit::set_unit( std::pow(1e18,1.0/3.0) );
@@ -83,9 +95,10 @@ SimulationSystem::SimulationSystem(MeshBase & mesh)
 
 
 SimulationSystem::SimulationSystem(MeshBase & mesh, Parser::InputParser & _decks)
-  :  _T_external(300.0), _mesh(mesh), _cylindrical_mesh(false), _resistive_metal_mode(false), _block_partition(true),
+  :  _T_external(300.0), _mesh(mesh), _cylindrical_mesh(false), _resistive_metal_mode(false), _block_partition(true), _mesh_ordering(MeshBase::BFS_ORDER), _distributed_mesh(false),
     _bcs(0), _electrical_source(0),
-    _field_source(0), _spice_ckt(0), _global_z_width(false), _z_width(1.0)
+    _field_source(0), _spice_ckt(0), _global_z_width(false), _z_width(1.0), _device_multiplicity(1.0), _mesh_revision(0),
+    _elem_node_deposition(0)
 {
 
   MESSAGE<<"Constructing Simulation System...\n"<<std::endl;  RECORD();
@@ -122,9 +135,15 @@ SimulationSystem::SimulationSystem(MeshBase & mesh, Parser::InputParser & _decks
         _z_width = c.get_real("z.width", 1.0)*PhysicalUnit::um;
       }
 
+      _device_multiplicity = std::max(c.get_real("device.m", 1.0), 1.0);
+
       _cylindrical_mesh = c.get_bool("cylindricalmesh", false);
       _resistive_metal_mode = c.get_bool("resistivemetal", false);
       _block_partition = c.get_bool("blockpartition", false);
+      _distributed_mesh = c.get_bool("distributed.mesh", false);
+
+      if( c.is_enum_value("mesh.ordering", "rcm") )    _mesh_ordering = MeshBase::RCM_ORDER;
+      if( c.is_enum_value("mesh.ordering", "morton") ) _mesh_ordering = MeshBase::MORTON_ORDER;
 
       double res = c.get_real("leakage.res", 1e12)*PhysicalUnit::V/PhysicalUnit::A;
       double cap = c.get_real("leakage.cap", 1e-18)*PhysicalUnit::C/PhysicalUnit::V;
@@ -136,6 +155,8 @@ SimulationSystem::SimulationSystem(MeshBase & mesh, Parser::InputParser & _decks
 
 
   MESSAGE<< "External Temperature = " << _T_external/PhysicalUnit::K << 'K' <<std::endl; RECORD();
+  if(_device_multiplicity > 1.0)
+  { MESSAGE<< "Device Multiplicity = " << _device_multiplicity <<std::endl; RECORD(); }
 
   // electrical source
   _electrical_source = new ElectricalSource( _decks );
@@ -162,17 +183,17 @@ SimulationSystem::SimulationSystem(MeshBase & mesh, Parser::InputParser & _decks
     if( c.key() == "CIRCUIT" && (c.is_parameter_exist("netlist") || c.is_parameter_exist("spice.file")))
     {
       std::string ckt_file = c.get_string("netlist", "", "spice.file");
-      std::string local_ckt_file = sync_file(ckt_file.c_str());
-      // only the last processor link to ngspice
+      // only the last processor link to ngspice, and needs a local copy
+      std::string local_ckt_file = sync_file(ckt_file.c_str(), Genius::n_processors()-1);
       if(Genius::processor_id()==Genius::n_processors()-1)
       {
         _spice_ckt = new SPICE_CKT(local_ckt_file);
         _spice_ckt->set_temperature(_T_external/PhysicalUnit::K);
+        remove(local_ckt_file.c_str());
       }
       else // create empty SPICE_CKT
         _spice_ckt = new SPICE_CKT;
 
-      remove(local_ckt_file.c_str());
       // sync information between processors
       _spice_ckt->sync();
 
@@ -195,6 +216,16 @@ SimulationSystem::~SimulationSystem()
   delete _electrical_source;
   delete _field_source;
   delete _spice_ckt;
+  delete _elem_node_deposition;
+}
+
+
+
+const ElemNodeDeposition & SimulationSystem::elem_node_deposition() const
+{
+  if( !_elem_node_deposition )
+    _elem_node_deposition = new ElemNodeDeposition(*this);
+  return *_elem_node_deposition;
 }
 
 
@@ -216,8 +247,15 @@ void SimulationSystem::clear(bool clear_mesh)
 
   _electrical_source->clear_bc_source_map();
 
+  delete _elem_node_deposition;
+  _elem_node_deposition = 0;
+
   //since we cleared all the solution data, previous solve histroy is meaningless
   _solver_active_history.clear();
+
+  // bulk release of the pool chunks without live mesh object
+  if(clear_mesh)
+    ObjectPool::release();
 }
 
 
@@ -324,11 +362,21 @@ bool SimulationSystem::has_complex_compound_semiconductor_region() const
 
 void SimulationSystem::build_simulation_system()
 {
+  // the fvm mesh will be rebuilt, invalidate mesh dependent data cached by solvers
+  ++_mesh_revision;
+  FVM_PDESolver::clear_solver_cache();
+  delete _elem_node_deposition;
+  _elem_node_deposition = 0;
+
   // each region has its own FVM mesh
+  startup_log.begin("fvm mesh");
   build_region_fvm_mesh();
+  startup_log.end();
 
   // boundary condition
+  startup_log.begin("boundary setup");
   _bcs->bc_setup();
+  startup_log.end();
 
   // electrical source should konw where is the (electrode) bc
   _electrical_source->link_to_bcs( _bcs );
@@ -337,7 +385,8 @@ void SimulationSystem::build_simulation_system()
   _mesh.clear_surface_locator();
 
   // totally delete remote elems
-  if(!_field_source->request_serial_mesh() && Genius::processor_id() !=0 )
+  // processor 0 keeps the whole mesh for output unless distributed mesh is requested
+  if(!_field_source->request_serial_mesh() && (Genius::processor_id() !=0 || _distributed_mesh) )
     _mesh.delete_remote_elements(true, true);
 
   // remove remote object in each region
@@ -376,15 +425,24 @@ void SimulationSystem::build_region_fvm_mesh()
     // let all the elements find their neighbors
     mesh.find_neighbors();
 
-    // reorder the elem/node index by Reverse Cuthill-McKee Algorithm
-    mesh.reorder_elems();
+    // reorder the elem/node index for locality, the dofs are numbered along node index
+    unsigned int bandwidth_before, bandwidth_after;
+    double profile_before, profile_after;
+    MeshTools::node_bandwidth(mesh, bandwidth_before, profile_before);
+    mesh.reorder_elems(static_cast<MeshBase::ElemOrdering>(_mesh_ordering));
+    MeshTools::node_bandwidth(mesh, bandwidth_after, profile_after);
     MESSAGE<<std::endl;  RECORD();
+    MESSAGE<<"  Node bandwidth " << bandwidth_before << " -> " << bandwidth_after
+           <<", profile " << profile_before << " -> " << profile_after << std::endl;  RECORD();
 
 
     MESSAGE<<"  Partition mesh...";  RECORD();
     // prepare for partition
     if(_block_partition)
       mesh.subdomain_cluster(this->build_subdomain_cluster());
+    // periodic BC couples the node pairs on its boundary and the partner boundary, they should be on one processor
+    if(_bcs)
+      mesh.boundary_cluster(_bcs->periodic_boundary_ids());
 
     // partition the mesh.
     mesh.partition(Genius::n_processors());
@@ -392,9 +450,9 @@ void SimulationSystem::build_region_fvm_mesh()
     // ok, mesh is prepared
     mesh.set_prepared();
 
-    // remove remote mesh elements when processor_id > 1
+    // remove remote mesh elements when processor_id > 1 (or on all processors for distributed mesh)
     // however, keep boundary elems for later bc setup
-    if(!_field_source->request_serial_mesh() && Genius::processor_id() !=0 )
+    if(!_field_source->request_serial_mesh() && (Genius::processor_id() !=0 || _distributed_mesh) )
       _mesh.delete_remote_elements(true, false);
 
     MESSAGE<<std::endl;  RECORD();
@@ -517,12 +575,12 @@ void SimulationSystem::build_region_fvm_mesh()
   // A convenient typedef
   typedef map_type::iterator Iter;
 
-  // search in all the LOCAL element
-  MeshBase::element_iterator       el  = _mesh.local_elements_begin();
-  const MeshBase::element_iterator end = _mesh.local_elements_end();
-  for (; el != end; ++el)
+  // search in all the LOCAL element, they are grouped by subdomain
+  // and an FVM_Node only collects the elements of its subdomain
+  const std::vector<Elem *> & local_elems = _mesh.local_elem_range();
+  for (unsigned int ne=0; ne<local_elems.size(); ++ne)
   {
-    Elem * elem = *el;
+    Elem * elem = local_elems[ne];
     genius_assert(elem->on_local());
 
     std::vector<FVM_Node *> elem_fvm_nodes(elem->n_nodes());
@@ -758,11 +816,11 @@ void SimulationSystem::build_region_fvm_mesh()
       // the vector norm to boundary/interface
       VectorValue<Real> norm = elem->outside_unit_normal(sides[nbd]);
 
-      // get the side
-      AutoPtr<Elem> side (elem->build_side(sides[nbd]));
-      for (unsigned int v=0; v < side->n_vertices(); v++)
+      // the vertices of the side, without building the side element
+      for (unsigned int v=0; v < elem->n_vertices(); v++)
       {
-        const Node * node = side->get_node(v);
+        if( !elem->is_node_on_side(v, sides[nbd]) ) continue;
+        const Node * node = elem->get_node(v);
         bd_norm_map.insert(std::make_pair(node, std::make_pair(elem->subdomain_id(), norm)));
       }
     }
@@ -815,11 +873,8 @@ void SimulationSystem::build_region_fvm_mesh()
   // reserve memory for data block
   {
     std::vector<unsigned int> region_cells(this->n_regions(), 0);
-    for (el=_mesh.local_elements_begin(); el != end; ++el)
-    {
-      unsigned int region_index = (*el)-> subdomain_id ();
-      region_cells[region_index]++;
-    }
+    for(unsigned int n = 0; n < this->n_regions(); n++)
+      region_cells[n] = _mesh.local_subdomain_elem_offset(n+1) - _mesh.local_subdomain_elem_offset(n);
 
     std::vector<unsigned int> region_nodes(this->n_regions(), 0);
     Iter it_fvm_end = _node_to_fvm_node_map.end();
@@ -839,10 +894,10 @@ void SimulationSystem::build_region_fvm_mesh()
 
   // insert element / FVM_Node pointer into each region
   {
-    for (el=_mesh.local_elements_begin(); el != end; ++el)
+    for (unsigned int ne=0; ne<local_elems.size(); ++ne)
     {
-      unsigned int region_index = (*el)-> subdomain_id ();
-      _simulation_regions[region_index]->insert_cell(*el);
+      unsigned int region_index = local_elems[ne]-> subdomain_id ();
+      _simulation_regions[region_index]->insert_cell(local_elems[ne]);
     }
 
     // this is overkill for parallel simulation since
@@ -869,6 +924,20 @@ void SimulationSystem::build_region_fvm_mesh()
   }
 
   MESSAGE<<std::endl;  RECORD();
+
+  // mesh quality and FVM validity report
+  {
+    MeshTools::ElemQualityStatistics stat;
+    MeshTools::elem_quality(_mesh, stat);
+    MESSAGE<<"  Mesh quality: " << stat.n_elem << " elements, edge ratio min/mean/max "
+           << stat.aspect_ratio_min << "/" << stat.aspect_ratio_mean << "/" << stat.aspect_ratio_max
+           << ", angle min/max " << stat.min_angle << "/" << stat.max_angle << " degree"
+           << ", edge length min/max " << stat.hmin/PhysicalUnit::um << "/" << stat.hmax/PhysicalUnit::um << " um" << std::endl;
+    MESSAGE<<"                " << stat.n_obtuse << " obtuse, " << stat.n_negative_cv << " non-Delaunay (negative CV area), "
+           << stat.n_inverted << " inverted elements" << std::endl;
+    RECORD();
+  }
+
   STOP_LOG("build_region_fvm_mesh(6)", "SimulationSystem");
 
 
@@ -897,6 +966,8 @@ void SimulationSystem::build_region_fvm_mesh()
         if ( (node = (*it)->is_hanging_node_on_edge(e))!=NULL )
           region->add_hanging_node_on_edge(node, *it, e);
     }
+
+    region->prepare_hanging_node();
   }
   MESSAGE<<std::endl;  RECORD();
   STOP_LOG("build_region_fvm_mesh(7)", "SimulationSystem");
@@ -918,6 +989,35 @@ bool SimulationSystem::self_consistent() const
 
 
 void SimulationSystem::estimate_error (const Parser::Card &c, ErrorVector & error_per_cell) const
+{
+  ErrorVector local_error_per_cell;
+  estimate_local_error(c, local_error_per_cell);
+
+  std::map<unsigned int, ErrorVectorReal> cell_error_map;
+  for(unsigned int i=0; i<local_error_per_cell.size(); ++i)
+    if( local_error_per_cell[i] != 0.0 )
+      cell_error_map[i] = local_error_per_cell[i];
+
+  // gather from all the processors
+  Parallel::gather(0, cell_error_map);
+
+  if( Genius::processor_id() == 0)
+  {
+    // reserve memory for error_per_cell vector
+    error_per_cell.resize (_mesh.max_elem_id());
+    // fill error_per_cell with 0 as init value
+    std::fill(error_per_cell.begin(), error_per_cell.end(), 0.0);
+
+    // fill into error_per_cell
+    std::map<unsigned int, ErrorVectorReal>::iterator it = cell_error_map.begin();
+    for(; it!=cell_error_map.end(); ++it)
+      error_per_cell[(*it).first] = (*it).second;
+  }
+}
+
+
+
+void SimulationSystem::estimate_local_error (const Parser::Card &c, ErrorVector & error_per_cell) const
 {
 
   // get the refinement depedent variable from input card
@@ -969,7 +1069,9 @@ void SimulationSystem::estimate_error (const Parser::Card &c, ErrorVector & erro
   }
 
 
-  std::map<unsigned int, ErrorVectorReal> cell_error_map;
+  // fill error_per_cell with 0 as init value
+  error_per_cell.resize (_mesh.max_elem_id());
+  std::fill(error_per_cell.begin(), error_per_cell.end(), 0.0);
 
   bool refine_flag = true;
   // if regions array is not empty, we only refine region in the regions array!
@@ -1030,7 +1132,7 @@ void SimulationSystem::estimate_error (const Parser::Card &c, ErrorVector & erro
       {
         if (v_volume)
         {
-          cell_error_map[(*it)->id()] = static_cast<ErrorVectorReal>((*it)->volume()/std::pow(PhysicalUnit::um,3.0)); // use cell volume as error
+          error_per_cell[(*it)->id()] = static_cast<ErrorVectorReal>((*it)->volume()/std::pow(PhysicalUnit::um,3.0)); // use cell volume as error
         }
         else
         {
@@ -1038,40 +1140,35 @@ void SimulationSystem::estimate_error (const Parser::Card &c, ErrorVector & erro
           if(gradient)
           {
             VectorValue<PetscScalar> grad_var   = (*it)->gradient(var_vertex);
-            cell_error_map[(*it)->id()] = static_cast<ErrorVectorReal>(grad_var.size()*(*it)->hmax()); // use gradient*hmax as error
+            error_per_cell[(*it)->id()] = static_cast<ErrorVectorReal>(grad_var.size()*(*it)->hmax()); // use gradient*hmax as error
           }
           // use cell average value as error
           else
           {
-            cell_error_map[(*it)->id()] = std::accumulate(var_vertex.begin(), var_vertex.end(), 0.0)/var_vertex.size();
+            error_per_cell[(*it)->id()] = std::accumulate(var_vertex.begin(), var_vertex.end(), 0.0)/var_vertex.size();
           }
         }
       }
       else
-        cell_error_map[(*it)->id()] = 0.0;
+        error_per_cell[(*it)->id()] = 0.0;
     }
   }
 
-  // gather from all the processors
-  Parallel::gather(0, cell_error_map);
+}
 
-  if( Genius::processor_id() == 0)
-  {
-    // reserve memory for error_per_cell vector
-    error_per_cell.resize (_mesh.max_elem_id());
-    // fill error_per_cell with 0 as init value
-    std::fill(error_per_cell.begin(), error_per_cell.end(), 0.0);
 
-    // fill into error_per_cell
-    std::map<unsigned int, ErrorVectorReal>::iterator it = cell_error_map.begin();
-    for(; it!=cell_error_map.end(); ++it)
-      error_per_cell[(*it).first] = (*it).second;
-  }
 
+void SimulationSystem::set_partition_weight(const std::vector<unsigned int> & subdomain_node_dofs)
+{
+  for(unsigned int r=0; r<_mesh.n_subdomains() && r<subdomain_node_dofs.size(); r++)
+  {
+    const int dofs = std::max(1, static_cast<int>(subdomain_node_dofs[r]));
+    _mesh.set_subdomain_weight(r, Material::material_weight(_mesh.subdomain_material(r))*dofs*dofs);
+    _mesh.set_subdomain_dof_weight(r, dofs);
+  }
 }
 
 
-
 /**
  * fill system data (mesh and node data) into interpolator for later usage
  * type 0 -- linear interpolation
@@ -1142,6 +1239,9 @@ void SimulationSystem::do_interpolation(const InterpolationBase * interpolator ,
   {
     SimulationRegion * region = this->region(n);
 
+    // collect the nodes first, the interpolator may evaluate them in batch
+    std::vector<FVM_NodeData *> node_data_array;
+    std::vector<Point> points;
     SimulationRegion::local_node_iterator node_it = region->on_local_nodes_begin();
     SimulationRegion::local_node_iterator node_it_end = region->on_local_nodes_end();
     for(; node_it!=node_it_end; ++node_it)
@@ -1151,14 +1251,180 @@ void SimulationSystem::do_interpolation(const InterpolationBase * interpolator ,
       FVM_NodeData * node_data = fvm_node->node_data();
       if(node_data->is_variable_valid(variable))
       {
-        double value = interpolator->get_interpolated_value(*(fvm_node->root_node()), group_code);
-        node_data->set_variable_real(variable, value);
+        node_data_array.push_back(node_data);
+        points.push_back(*(fvm_node->root_node()));
       }
     }
+
+    std::vector<double> values;
+    interpolator->get_interpolated_values(points, group_code, values);
+    for(unsigned int i=0; i<node_data_array.size(); ++i)
+      node_data_array[i]->set_variable_real(variable, values[i]);
+  }
+}
+
+
+
+/**
+ * the nodal solution variables kept during hierarchical mesh refinement
+ */
+static const SolutionVariable refine_solution_variables[] = {POTENTIAL, ELECTRON, HOLE, TEMPERATURE, E_TEMP, H_TEMP};
+static const unsigned int n_refine_solution_variables = sizeof(refine_solution_variables)/sizeof(SolutionVariable);
+
+
+void SimulationSystem::backup_node_solution()
+{
+  _node_solution_backup.clear();
+  _node_solution_backup.resize(this->n_regions());
+
+  for( unsigned int r=0; r<this->n_regions(); r++)
+  {
+    const SimulationRegion * region = this->region(r);
+
+    // pack location and solution of on processor nodes
+    std::vector<Real> locations;
+    std::vector<Real> values;
+    SimulationRegion::const_processor_node_iterator node_it = region->on_processor_nodes_begin();
+    SimulationRegion::const_processor_node_iterator node_it_end = region->on_processor_nodes_end();
+    for(; node_it!=node_it_end; ++node_it)
+    {
+      const FVM_Node * fvm_node = *node_it;
+      const FVM_NodeData * node_data = fvm_node->node_data();
+      const Node * node = fvm_node->root_node();
+      for(unsigned int i=0; i<3; ++i)
+        locations.push_back((*node)(i));
+      for(unsigned int v=0; v<n_refine_solution_variables; ++v)
+        values.push_back(node_data->is_variable_valid(refine_solution_variables[v]) ?
+                         node_data->get_variable_real(refine_solution_variables[v]) : 0.0);
+    }
+
+    Parallel::allgather(locations);
+    Parallel::allgather(values);
+
+    std::map<Point, std::vector<Real>, PointLess> & backup = _node_solution_backup[r];
+    for(unsigned int n=0; n<locations.size()/3; ++n)
+    {
+      Point p(locations[3*n], locations[3*n+1], locations[3*n+2]);
+      backup[p] = std::vector<Real>(values.begin()+n*n_refine_solution_variables, values.begin()+(n+1)*n_refine_solution_variables);
+    }
   }
 }
 
 
+void SimulationSystem::restore_node_solution()
+{
+  if( _node_solution_backup.size() != this->n_regions() ) return;
+
+  for( unsigned int r=0; r<this->n_regions(); r++)
+  {
+    SimulationRegion * region = this->region(r);
+    const std::map<Point, std::vector<Real>, PointLess> & backup = _node_solution_backup[r];
+
+    // the solution of new nodes, prolongated from the parent elem by its shape functions.
+    // the ancestors are visited from the coarsest level, so that a multi-level refinement
+    // prolongates through each level of the hierarchy
+    std::map<const Node *, std::vector<Real> > projection;
+    std::vector< std::pair<unsigned int, const Elem *> > ancestors;
+    {
+      std::set<const Elem *> ancestor_set;
+      SimulationRegion::const_element_iterator elem_it = region->elements_begin();
+      SimulationRegion::const_element_iterator elem_it_end = region->elements_end();
+      for(; elem_it != elem_it_end; ++elem_it)
+        for(const Elem * parent = (*elem_it)->parent(); parent != NULL; parent = parent->parent())
+          if( !ancestor_set.insert(parent).second ) break;
+
+      std::set<const Elem *>::const_iterator it = ancestor_set.begin();
+      for(; it != ancestor_set.end(); ++it)
+        ancestors.push_back(std::make_pair((*it)->level(), *it));
+      std::sort(ancestors.begin(), ancestors.end());
+    }
+
+    for(unsigned int a=0; a<ancestors.size(); ++a)
+    {
+      const Elem * parent = ancestors[a].second;
+
+      // solution at the parent nodes, carrier densities are prolongated in log scale
+      std::vector<const std::vector<Real> *> parent_values(parent->n_nodes(), static_cast<const std::vector<Real> *>(0));
+      std::vector<bool> log_scale(n_refine_solution_variables);
+      for(unsigned int v=0; v<n_refine_solution_variables; ++v)
+        log_scale[v] = refine_solution_variables[v] == ELECTRON || refine_solution_variables[v] == HOLE;
+      for(unsigned int i=0; i<parent->n_nodes(); ++i)
+      {
+        const Node * node = parent->get_node(i);
+        std::map<Point, std::vector<Real>, PointLess>::const_iterator it = backup.find(*node);
+        if( it != backup.end() ) parent_values[i] = &it->second;
+        else if( projection.find(node) != projection.end() ) parent_values[i] = &projection.find(node)->second;
+        if( parent_values[i] == NULL ) continue;
+        for(unsigned int v=0; v<n_refine_solution_variables; ++v)
+          if( (*parent_values[i])[v] <= 0.0 ) log_scale[v] = false;
+      }
+
+      const FEType fe_type(parent->default_order());
+      for(unsigned int c=0; c<parent->n_children(); ++c)
+      {
+        const Elem * child = parent->child(c);
+        for(unsigned int nd=0; nd<child->n_nodes(); ++nd)
+        {
+          const Node * node = child->get_node(nd);
+          if( backup.find(*node) != backup.end() || projection.find(node) != projection.end() ) continue;
+
+          const Point ref = FEInterface::inverse_map(parent->dim(), fe_type, parent, *node, TOLERANCE, false);
+
+          // parent nodes without solution are excluded, the remaining shape functions are renormalized
+          std::vector<Real> value(n_refine_solution_variables, 0.0);
+          Real weight = 0.0;
+          for(unsigned int i=0; i<parent->n_nodes(); ++i)
+          {
+            if( parent_values[i] == NULL ) continue;
+            const Real phi = FEInterface::shape(parent->dim(), fe_type, parent, i, ref);
+            for(unsigned int v=0; v<n_refine_solution_variables; ++v)
+              value[v] += phi*( log_scale[v] ? std::log((*parent_values[i])[v]) : (*parent_values[i])[v] );
+            weight += phi;
+          }
+          if( std::abs(weight) < 1e-3 ) continue;
+
+          for(unsigned int v=0; v<n_refine_solution_variables; ++v)
+          {
+            value[v] /= weight;
+            if( log_scale[v] ) value[v] = std::exp(value[v]);
+          }
+          projection[node] = value;
+        }
+      }
+    }
+
+    SimulationRegion::local_node_iterator node_it = region->on_local_nodes_begin();
+    SimulationRegion::local_node_iterator node_it_end = region->on_local_nodes_end();
+    for(; node_it!=node_it_end; ++node_it)
+    {
+      FVM_Node * fvm_node = (*node_it);
+      FVM_NodeData * node_data = fvm_node->node_data();
+      const Node * node = fvm_node->root_node();
+
+      const std::vector<Real> * value = NULL;
+      std::map<Point, std::vector<Real>, PointLess>::const_iterator it = backup.find(*node);
+      if( it != backup.end() )
+        value = &it->second;
+      else if( projection.find(node) != projection.end() )
+        value = &projection.find(node)->second;
+      if( value == NULL ) continue;
+
+      for(unsigned int v=0; v<n_refine_solution_variables; ++v)
+        if( node_data->is_variable_valid(refine_solution_variables[v]) )
+          node_data->set_variable_real(refine_solution_variables[v], (*value)[v]);
+
+      node_data->psi_last() = node_data->psi();
+      node_data->n_last()   = node_data->n();
+      node_data->p_last()   = node_data->p();
+      node_data->T_last()   = node_data->T();
+      node_data->Tn_last()  = node_data->Tn();
+      node_data->Tp_last()  = node_data->Tp();
+    }
+  }
+
+  _node_solution_backup.clear();
+}
+
 
 std::vector< std::vector<unsigned int > > SimulationSystem::build_subdomain_cluster()
 {
@@ -1310,9 +1576,29 @@ size_t SimulationSystem::memory_size() const
 }
 
 
+void SimulationSystem::memory_usage(std::map<std::string, size_t> & usage) const
+{
+  usage["mesh nodes and elems"] += _mesh.memory_size();
+  usage["mesh boundary info"]   += _mesh.boundary_info->memory_size();
+
+  for(unsigned int n=0; n<_simulation_regions.size(); ++n)
+    _simulation_regions[n]->memory_usage(usage);
+}
+
+
 
-void SimulationSystem::export_vtk(const std::string& filename, bool ascii) const
+void SimulationSystem::export_vtk(const std::string& filename, bool ascii, unsigned int async_queue, bool float32) const
 {
+  // parallel XML VTK, does not need the VTK library
+  if(filename.rfind(".pvtu") < filename.size())
+  {
+    MESSAGE<<"Write System to parallel XML VTK file "<< filename << "...\n" << std::endl; RECORD();
+    VTKIO vtk_io(*this);
+    vtk_io.set_float32(float32);
+    vtk_io.write (filename);
+    return;
+  }
+
   if(!ascii)
   {
 #ifdef HAVE_VTK
@@ -1336,7 +1622,9 @@ void SimulationSystem::export_vtk(const std::string& filename, bool ascii) const
     }
 
     MESSAGE<<"Write System to XML VTK file "<< file_name << "...\n" << std::endl; RECORD();
-    VTKIO(*this).write (file_name);
+    VTKIO vtk_io(*this);
+    vtk_io.set_async(async_queue > 0, async_queue);
+    vtk_io.write (file_name);
 #else
     MESSAGE<<"Genius is not compiled with XML VTK support, skip VTK export... "<< std::endl; RECORD();
 #endif
@@ -1381,11 +1669,39 @@ void SimulationSystem::export_node_location(const std::string& filename, const P
 }
 
 
+void SimulationSystem::export_checkpoint(const std::string& filename) const
+{
+  MESSAGE<<"Write checkpoint to file "<< filename << "...\n" << std::endl; RECORD();
+
+  CheckpointIO(*this).write (filename);
+}
+
+
 void SimulationSystem::export_cgns(const std::string& filename) const
 {
   MESSAGE<<"Write System to CGNS file "<< filename << "...\n" << std::endl; RECORD();
 
+  _gather_mesh_for_output();
   CGNSIO(*this).write (filename);
+  _release_mesh_after_output();
+}
+
+
+void SimulationSystem::export_hdf5(const std::string& filename, bool append, double time,
+                                   bool float32, int compression) const
+{
+#ifdef HAVE_HDF5
+  MESSAGE<<"Write System to HDF5 file "<< filename << "...\n" << std::endl; RECORD();
+
+  HDF5IO hdf5_io(*this);
+  hdf5_io.set_append(append);
+  hdf5_io.set_time(time);
+  hdf5_io.set_float32(float32);
+  hdf5_io.set_compression(compression);
+  hdf5_io.write (filename);
+#else
+  MESSAGE<<"Genius is not compiled with HDF5 support, skip HDF5 export... "<< std::endl; RECORD();
+#endif
 }
 
 
@@ -1393,7 +1709,9 @@ void SimulationSystem::export_ise(const std::string& filename) const
 {
   MESSAGE<<"Write System to DF-ISE file "<< filename << "...\n"; RECORD();
 
+  _gather_mesh_for_output();
   DFISEIO(*this).write (filename);
+  _release_mesh_after_output();
 }
 
 
@@ -1407,7 +1725,9 @@ void SimulationSystem::export_gdml_surface(const std::string& filename) const
 
   MESSAGE<<"Write geometry information (region) to GDML file "<< filename << "...\n" << std::endl; RECORD();
 
+  _gather_mesh_for_output();
   GDMLIO(*this, true).write (filename);
+  _release_mesh_after_output();
 }
 
 
@@ -1421,15 +1741,41 @@ void SimulationSystem::export_gdml_body(const std::string& filename) const
 
   MESSAGE<<"Write geometry information (cell) to GDML file "<< filename << "...\n" << std::endl; RECORD();
 
+  _gather_mesh_for_output();
   GDMLIO(*this, false).write (filename);
+  _release_mesh_after_output();
 }
 
-void SimulationSystem::import_cgns(const std::string& filename)
+void SimulationSystem::_gather_mesh_for_output() const
+{
+  // writers which walk the global element list need the whole mesh on processor 0
+  if( _distributed_mesh && !_mesh.is_serial() )
+    _mesh.gather(0);
+}
+
+
+void SimulationSystem::_release_mesh_after_output() const
+{
+  if( _distributed_mesh && !_field_source->request_serial_mesh() )
+    _mesh.delete_remote_elements(true, true);
+}
+
+
+void SimulationSystem::import_cgns(const std::string& filename, bool parallel_read)
 {
 
   MESSAGE<<"Import System from CGNS file "<< filename << "...\n" << std::endl; RECORD();
 
-  CGNSIO(*this).read (filename);
+  CGNSIO cgns_io(*this);
+  cgns_io.set_parallel_read(parallel_read);
+  cgns_io.read (filename);
+}
+
+void SimulationSystem::import_checkpoint(const std::string& filename)
+{
+  MESSAGE<<"Load checkpoint from file "<< filename << "...\n" << std::endl; RECORD();
+
+  CheckpointIO(*this).read (filename);
 }
 
 void SimulationSystem::import_vtk(const std::string& filename)
@@ -0,0 +1,268 @@
+/********************************************************************************/
+/*     888888    888888888   88     888  88888   888      888    88888888       */
+/*   8       8   8           8 8     8     8      8        8    8               */
+/*  8            8           8  8    8     8      8        8    8               */
+/*  8            888888888   8   8   8     8      8        8     8888888        */
+/*  8      8888  8           8    8  8     8      8        8            8       */
+/*   8       8   8           8     8 8     8      8        8            8       */
+/*     888888    888888888  888     88   88888     88888888     88888888        */
+/*                                                                              */
+/*       A Three-Dimensional General Purpose Semiconductor Simulator.           */
+/*                                                                              */
+/*                                                                              */
+/*  Copyright (C) 2007-2008                                                     */
+/*  Cogenda Pte Ltd                                                             */
+/*                                                                              */
+/*  Please contact Cogenda Pte Ltd for license information                      */
+/*                                                                              */
+/*  Author: Gong Ding   gdiso@ustc.edu                                          */
+/*                                                                              */
+/********************************************************************************/
+
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <cmath>
+
+#include "solution_cache.h"
+#include "mesh_base.h"
+#include "simulation_system.h"
+#include "simulation_region.h"
+#include "boundary_condition_collector.h"
+#include "boundary_condition.h"
+#include "external_circuit.h"
+#include "solver_specify.h"
+#include "physical_unit.h"
+#include "parallel.h"
+
+
+SolutionCache::SolutionCache(SimulationSystem & system, const std::string & prefix)
+    : _system(system), _n_points(0), _n_bias(0)
+{
+  // doping checksum, weighted by node id such that moved doping also changes it
+  std::vector<Real> checksum;
+  for(unsigned int r=0; r<_system.n_regions(); r++)
+  {
+    const SimulationRegion * region = _system.region(r);
+    Real sum = 0.0;
+    SimulationRegion::const_processor_node_iterator it = region->on_processor_nodes_begin();
+    SimulationRegion::const_processor_node_iterator it_end = region->on_processor_nodes_end();
+    for( ; it!=it_end; ++it)
+    {
+      const FVM_NodeData * node_data = (*it)->node_data();
+      const Real w = 1.0 + (*it)->root_node()->id()%97;
+      sum += w*(node_data->Na() + 2.0*node_data->Nd());
+    }
+    checksum.push_back(sum*pow(PhysicalUnit::cm, 3));
+  }
+  Parallel::sum(checksum);
+
+  std::stringstream fp;
+  fp << Genius::n_processors() << ' ' << _system.mesh().magic_num() << ' '
+     << SolverSpecify::Solver << ' ' << _system.T_external()/PhysicalUnit::K;
+  fp << std::setprecision(10);
+  for(unsigned int r=0; r<_system.n_regions(); r++)
+  {
+    const SimulationRegion * region = _system.region(r);
+    fp << ' ' << region->name() << ' ' << region->material() << ' ' << region->n_node() << ' ' << checksum[r];
+  }
+
+  // FNV-1a hash of the fingerprint
+  const std::string s = fp.str();
+  unsigned long long hash = 0xCBF29CE484222325ULL;
+  for(unsigned int i=0; i<s.size(); ++i)
+  {
+    hash ^= static_cast<unsigned char>(s[i]);
+    hash *= 0x100000001B3ULL;
+  }
+
+  std::stringstream ss;
+  ss << prefix << '.' << std::hex << std::setw(16) << std::setfill('0') << hash;
+  _stem = ss.str();
+
+  _n_bias = this->bias().size();
+
+  // processor 0 reads the index
+  if( Genius::processor_id() == 0 )
+  {
+    std::ifstream in((_stem + ".idx").c_str());
+    std::string line;
+    while( std::getline(in, line) )
+    {
+      std::stringstream ls(line);
+      unsigned int k;
+      std::vector<Real> b(_n_bias);
+      ls >> k;
+      for(unsigned int n=0; n<_n_bias; ++n)
+        ls >> b[n];
+      if( ls.fail() || k != _n_points ) break;
+      _points.insert(_points.end(), b.begin(), b.end());
+      _n_points++;
+    }
+  }
+  Parallel::broadcast(_n_points);
+  Parallel::broadcast(_points);
+
+  MESSAGE<<"Solution cache " << _stem << " has " << _n_points << " points.\n"; RECORD();
+}
+
+
+
+std::vector<Real> SolutionCache::bias() const
+{
+  std::vector<Real> b;
+  const BoundaryConditionCollector * bcs = _system.get_bcs();
+  for(unsigned int n=0; n<bcs->n_bcs(); n++)
+  {
+    const BoundaryCondition * bc = bcs->get_bc(n);
+    if( !bc->is_electrode() ) continue;
+    if( bc->ext_circuit()->is_current_driven() )
+      b.push_back(bc->ext_circuit()->Iapp()/PhysicalUnit::A);
+    else
+      b.push_back(bc->ext_circuit()->Vapp()/PhysicalUnit::V);
+  }
+  return b;
+}
+
+
+
+bool SolutionCache::load_nearest()
+{
+  if( _n_points == 0 || _n_bias == 0 ) return false;
+
+  const std::vector<Real> target = this->bias();
+
+  // bias of the solution in memory
+  std::vector<Real> current;
+  const BoundaryConditionCollector * bcs = _system.get_bcs();
+  for(unsigned int n=0; n<bcs->n_bcs(); n++)
+  {
+    const BoundaryCondition * bc = bcs->get_bc(n);
+    if( !bc->is_electrode() ) continue;
+    if( bc->ext_circuit()->is_current_driven() )
+      current.push_back(bc->ext_circuit()->current()/PhysicalUnit::A);
+    else
+      current.push_back(bc->ext_circuit()->potential()/PhysicalUnit::V);
+  }
+
+  unsigned int nearest = 0;
+  Real d_min = _distance(&target[0], &_points[0], _n_bias);
+  for(unsigned int k=1; k<_n_points; ++k)
+  {
+    const Real d = _distance(&target[0], &_points[k*_n_bias], _n_bias);
+    if( d < d_min ) { d_min = d; nearest = k; }
+  }
+
+  if( d_min >= _distance(&target[0], &current[0], _n_bias) ) return false;
+
+  std::ifstream in(_data_file(nearest).c_str(), std::ios::in | std::ios::binary);
+  bool match = in.good();
+  std::stringstream backup(std::ios::in | std::ios::out | std::ios::binary);
+  for(unsigned int r=0; r<_system.n_regions(); r++)
+    _system.region(r)->write_checkpoint(backup);
+
+  for(unsigned int r=0; match && r<_system.n_regions(); r++)
+    match = _system.region(r)->read_checkpoint(in);
+
+  std::vector<Real> state;
+  if( match )
+  {
+    unsigned int n_state;
+    in.read(reinterpret_cast<char *>(&n_state), sizeof(unsigned int));
+    state.resize(n_state);
+    if( n_state )
+      in.read(reinterpret_cast<char *>(&state[0]), n_state*sizeof(Real));
+    match = in.good();
+  }
+
+  // all the processors should agree, otherwise keep the solution in memory
+  Parallel::min(match);
+  if( !match )
+  {
+    for(unsigned int r=0; r<_system.n_regions(); r++)
+      _system.region(r)->read_checkpoint(backup);
+    MESSAGE<<"Warning: Solution cache point " << nearest << " can't be read, ignored.\n"; RECORD();
+    return false;
+  }
+
+  // the external circuit state except the applied source of this bias
+  unsigned int pos = 0;
+  BoundaryConditionCollector * bcs_w = _system.get_bcs();
+  for(unsigned int n=0; n<bcs_w->n_bcs(); n++)
+  {
+    BoundaryCondition * bc = bcs_w->get_bc(n);
+    if( !bc->is_electrode() ) continue;
+    const Real Vapp = bc->ext_circuit()->Vapp();
+    const Real Iapp = bc->ext_circuit()->Iapp();
+    pos = bc->ext_circuit()->restore_state(state, pos);
+    bc->ext_circuit()->Vapp() = Vapp;
+    bc->ext_circuit()->Iapp() = Iapp;
+  }
+
+  MESSAGE<<"Solution cache: start from cached point " << nearest << ", bias distance " << d_min << "\n"; RECORD();
+  return true;
+}
+
+
+
+void SolutionCache::store()
+{
+  const std::vector<Real> b = this->bias();
+  if( b.empty() ) return;
+
+  // the same bias is stored only once
+  for(unsigned int k=0; k<_n_points; ++k)
+    if( _distance(&b[0], &_points[k*_n_bias], _n_bias) < 1e-12 ) return;
+
+  const unsigned int k = _n_points;
+  {
+    std::ofstream out(_data_file(k).c_str(), std::ios::out | std::ios::binary);
+    for(unsigned int r=0; r<_system.n_regions(); r++)
+      _system.region(r)->write_checkpoint(out);
+
+    std::vector<Real> state;
+    const BoundaryConditionCollector * bcs = _system.get_bcs();
+    for(unsigned int n=0; n<bcs->n_bcs(); n++)
+      if( bcs->get_bc(n)->is_electrode() )
+        bcs->get_bc(n)->ext_circuit()->save_state(state);
+    unsigned int n_state = state.size();
+    out.write(reinterpret_cast<const char *>(&n_state), sizeof(unsigned int));
+    if( n_state )
+      out.write(reinterpret_cast<const char *>(&state[0]), n_state*sizeof(Real));
+  }
+
+  // the index is updated after all the data files are written
+  Parallel::barrier();
+  if( Genius::processor_id() == 0 )
+  {
+    std::ofstream idx((_stem + ".idx").c_str(), std::ios::app);
+    idx << k << std::scientific << std::setprecision(12);
+    for(unsigned int n=0; n<_n_bias; ++n)
+      idx << ' ' << b[n];
+    idx << '\n';
+  }
+
+  _points.insert(_points.end(), b.begin(), b.end());
+  _n_points++;
+}
+
+
+
+std::string SolutionCache::_data_file(unsigned int k) const
+{
+  std::stringstream ss;
+  ss << _stem << '.' << k;
+  if( Genius::n_processors() > 1 )
+    ss << '.' << Genius::processor_id();
+  return ss.str();
+}
+
+
+
+Real SolutionCache::_distance(const Real * a, const Real * b, unsigned int n)
+{
+  Real d = 0.0;
+  for(unsigned int i=0; i<n; ++i)
+    d += (a[i]-b[i])*(a[i]-b[i]);
+  return std::sqrt(d);
+}
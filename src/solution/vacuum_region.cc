@@ -98,7 +98,7 @@ void VacuumSimulationRegion::set_region_variables()
   _region_point_variables["optical_hfield"] = SimulationVariable("optical_hfield", COMPLEX, POINT_CENTER, "A/cm", FVM_Vacuum_NodeData::_OpH_complex_, false);
 
   // define _region_cell_variables
-  _region_cell_variables["efield"        ] = SimulationVariable("efield", VECTOR, CELL_CENTER, "V/cm", FVM_Vacuum_CellData::_E_, true);
+  _region_cell_variables["efield"        ] = SimulationVariable("efield", VECTOR, CELL_CENTER, "V/cm", FVM_Vacuum_CellData::_E_, false);
 
   // allocate variables
   std::map<std::string, SimulationVariable>::iterator it;
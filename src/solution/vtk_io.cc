@@ -91,6 +91,160 @@ public:
 private:
   std::string _header;
 };
+
+
+#ifndef WINDOWS
+#include <deque>
+#include <pthread.h>
+
+/**
+ * a single writer thread with bounded queue.
+ * the queued vtkUnstructuredGrid is a private snapshot of the solution,
+ * so the solver can go on while the file is written
+ */
+class VTKIO::AsyncGridWriter
+{
+public:
+
+  static AsyncGridWriter & instance()
+  {
+    static AsyncGridWriter writer;
+    return writer;
+  }
+
+  /**
+   * queue grid for writing, take the ownership of grid.
+   * block when queue_size grids are already waiting
+   */
+  void push(vtkUnstructuredGrid * grid, const std::string & header, const std::string & filename, unsigned int queue_size)
+  {
+    pthread_mutex_lock(&_mutex);
+    if( !_running )
+    {
+      _running = (pthread_create(&_thread, NULL, _thread_main, this) == 0);
+      if( !_running )
+      {
+        // can not start the thread, write it here
+        pthread_mutex_unlock(&_mutex);
+        _write(grid, header, filename);
+        return;
+      }
+    }
+
+    while( _queue.size() >= queue_size )
+      pthread_cond_wait(&_slot_free, &_mutex);
+
+    Job job;
+    job.grid = grid;
+    job.header = header;
+    job.filename = filename;
+    _queue.push_back(job);
+
+    pthread_cond_signal(&_job_ready);
+    pthread_mutex_unlock(&_mutex);
+  }
+
+  /**
+   * wait until queue is empty and no file is in writing
+   */
+  void wait()
+  {
+    pthread_mutex_lock(&_mutex);
+    while( !_queue.empty() || _busy )
+      pthread_cond_wait(&_slot_free, &_mutex);
+    pthread_mutex_unlock(&_mutex);
+  }
+
+private:
+
+  struct Job
+  {
+    vtkUnstructuredGrid * grid;
+    std::string header;
+    std::string filename;
+  };
+
+  AsyncGridWriter() : _running(false), _busy(false), _stop(false)
+  {
+    pthread_mutex_init(&_mutex, NULL);
+    pthread_cond_init(&_job_ready, NULL);
+    pthread_cond_init(&_slot_free, NULL);
+  }
+
+  ~AsyncGridWriter()
+  {
+    pthread_mutex_lock(&_mutex);
+    _stop = true;
+    pthread_cond_signal(&_job_ready);
+    pthread_mutex_unlock(&_mutex);
+
+    // the thread writes out all the queued jobs before exit
+    if( _running )
+      pthread_join(_thread, NULL);
+
+    pthread_cond_destroy(&_slot_free);
+    pthread_cond_destroy(&_job_ready);
+    pthread_mutex_destroy(&_mutex);
+  }
+
+  static void * _thread_main(void * ctx)
+  {
+    static_cast<AsyncGridWriter *>(ctx)->_run();
+    return NULL;
+  }
+
+  void _run()
+  {
+    while(true)
+    {
+      pthread_mutex_lock(&_mutex);
+      while( _queue.empty() && !_stop )
+        pthread_cond_wait(&_job_ready, &_mutex);
+
+      if( _queue.empty() )
+      {
+        pthread_mutex_unlock(&_mutex);
+        break;
+      }
+
+      Job job = _queue.front();
+      _queue.pop_front();
+      _busy = true;
+      pthread_mutex_unlock(&_mutex);
+
+      _write(job.grid, job.header, job.filename);
+
+      pthread_mutex_lock(&_mutex);
+      _busy = false;
+      pthread_cond_broadcast(&_slot_free);
+      pthread_mutex_unlock(&_mutex);
+    }
+  }
+
+  static void _write(vtkUnstructuredGrid * grid, const std::string & header, const std::string & filename)
+  {
+    XMLUnstructuredGridWriter* writer = XMLUnstructuredGridWriter::New();
+    writer->SetInput(grid);
+    writer->setExtraHeader(header);
+    writer->SetFileName(filename.c_str());
+    writer->Write();
+    writer->Delete();
+    grid->Delete();
+  }
+
+  std::deque<Job> _queue;
+
+  pthread_t       _thread;
+  pthread_mutex_t _mutex;
+  pthread_cond_t  _job_ready;
+  pthread_cond_t  _slot_free;
+
+  bool _running;
+  bool _busy;
+  bool _stop;
+};
+#endif // WINDOWS
+
 #endif
 
 // private functions
@@ -834,6 +988,17 @@ void VTKIO::solution_to_vtk(const MeshBase& mesh, vtkUnstructuredGrid* grid)
     std::vector<float> Ex,  Ey,  Ez;
     std::vector<float> Jnx,  Jny,  Jnz;
     std::vector<float> Jpx,  Jpy,  Jpz;
+    std::vector<float> Fn,  Fp;
+
+    // driving forces of high field mobility, kept by the residual of the last solve
+    bool mob_force = false;
+    for( unsigned int r=0; r<system.n_regions(); r++)
+    {
+      const SimulationRegion * region = system.region(r);
+      if( region->type()==SemiconductorRegion )
+        mob_force = mob_force || dynamic_cast<const SemiconductorSimulationRegion *>(region)->mob_force_cached();
+    }
+    Parallel::max(mob_force);
 
     for( unsigned int r=0; r<system.n_regions(); r++)
     {
@@ -855,9 +1020,10 @@ void VTKIO::solution_to_vtk(const MeshBase& mesh, vtkUnstructuredGrid* grid)
           mos_channel_flag.push_back(0.0);
         */
 
-        Ex.push_back(static_cast<float>(elem_data->E()(0)/(V/cm)));
-        Ey.push_back(static_cast<float>(elem_data->E()(1)/(V/cm)));
-        Ez.push_back(static_cast<float>(elem_data->E()(2)/(V/cm)));
+        const VectorValue<PetscScalar> E = region->cell_efield(n);
+        Ex.push_back(static_cast<float>(E(0)/(V/cm)));
+        Ey.push_back(static_cast<float>(E(1)/(V/cm)));
+        Ez.push_back(static_cast<float>(E(2)/(V/cm)));
 
         Jnx.push_back(static_cast<float>(elem_data->Jn()(0)/(A/cm)));
         Jny.push_back(static_cast<float>(elem_data->Jn()(1)/(A/cm)));
@@ -867,6 +1033,11 @@ void VTKIO::solution_to_vtk(const MeshBase& mesh, vtkUnstructuredGrid* grid)
         Jpy.push_back(static_cast<float>(elem_data->Jp()(1)/(A/cm)));
         Jpz.push_back(static_cast<float>(elem_data->Jp()(2)/(A/cm)));
 
+        if(mob_force)
+        {
+          Fn.push_back(static_cast<float>(elem_data->Epn()/(V/cm)));
+          Fp.push_back(static_cast<float>(elem_data->Epp()/(V/cm)));
+        }
       }
     }
 
@@ -930,6 +1101,12 @@ void VTKIO::solution_to_vtk(const MeshBase& mesh, vtkUnstructuredGrid* grid)
         Jpy.push_back(0);
         Jpz.push_back(0);
 #endif
+
+        if(mob_force)
+        {
+          Fn.push_back(0);
+          Fp.push_back(0);
+        }
       }
     }
 
@@ -938,6 +1115,11 @@ void VTKIO::solution_to_vtk(const MeshBase& mesh, vtkUnstructuredGrid* grid)
     write_cell_vector_solution(order, Ex,  Ey,  Ez,  "electrical_field", grid);
     write_cell_vector_solution(order, Jnx, Jny, Jnz, "electron_current", grid);
     write_cell_vector_solution(order, Jpx, Jpy, Jpz, "hole_current", grid);
+    if(mob_force)
+    {
+      write_cell_scaler_solution(order, Fn, "electron_driving_force", grid);
+      write_cell_scaler_solution(order, Fp, "hole_driving_force", grid);
+    }
   }
 }
 
@@ -1192,11 +1374,10 @@ void VTKIO::cells_to_vtk(const MeshBase& mesh,  std::ofstream & out)
 
   int cell_nodes = 0;
   std::map<unsigned int, unsigned int> elem_type;
-  MeshBase::const_element_iterator       elem_it  = mesh.active_this_pid_elements_begin();
-  const MeshBase::const_element_iterator elem_it_end = mesh.active_this_pid_elements_end();
-  for (; elem_it != elem_it_end; ++elem_it)
+  const std::vector<Elem *> & elems = mesh.active_this_pid_elem_range();
+  for (unsigned int ne=0; ne<elems.size(); ++ne)
   {
-    const Elem * elem = *elem_it;
+    const Elem * elem = elems[ne];
     cell_nodes += elem->n_nodes();
     elem_type.insert( std::make_pair( elem->id(), static_cast<unsigned int>(elem->type())) );
   }
@@ -1308,11 +1489,10 @@ void VTKIO::meshinfo_cell_to_vtk(const MeshBase& mesh, std::ofstream & out)
   std::map<unsigned int, unsigned int> cell_processor_id;
   std::map<unsigned int, unsigned int> cell_subdomain_id;
 
-  MeshBase::const_element_iterator       elem_it  = mesh.active_this_pid_elements_begin();
-  const MeshBase::const_element_iterator elem_it_end = mesh.active_this_pid_elements_end();
-  for (; elem_it != elem_it_end; ++elem_it)
+  const std::vector<Elem *> & elems = mesh.active_this_pid_elem_range();
+  for (unsigned int ne=0; ne<elems.size(); ++ne)
   {
-    const Elem * elem = *elem_it;
+    const Elem * elem = elems[ne];
     cell_processor_id.insert( std::make_pair(elem->id(), elem->processor_id()) );
     cell_subdomain_id.insert( std::make_pair(elem->id(), elem->subdomain_id()) );
   }
@@ -1459,6 +1639,17 @@ void VTKIO::solution_to_vtk(const MeshBase& mesh, std::ofstream & out)
     std::vector<float> Ex,  Ey,  Ez;
     std::vector<float> Jnx,  Jny,  Jnz;
     std::vector<float> Jpx,  Jpy,  Jpz;
+    std::vector<float> Fn,  Fp;
+
+    // driving forces of high field mobility, kept by the residual of the last solve
+    bool mob_force = false;
+    for( unsigned int r=0; r<system.n_regions(); r++)
+    {
+      const SimulationRegion * region = system.region(r);
+      if( region->type()==SemiconductorRegion )
+        mob_force = mob_force || dynamic_cast<const SemiconductorSimulationRegion *>(region)->mob_force_cached();
+    }
+    Parallel::max(mob_force);
 
     for( unsigned int r=0; r<system.n_regions(); r++)
     {
@@ -1472,9 +1663,10 @@ void VTKIO::solution_to_vtk(const MeshBase& mesh, std::ofstream & out)
 
         const FVM_CellData * elem_data = region->get_region_elem_data(n);
 
-        Ex.push_back(static_cast<float>(elem_data->E()(0)/(V/cm)));
-        Ey.push_back(static_cast<float>(elem_data->E()(1)/(V/cm)));
-        Ez.push_back(static_cast<float>(elem_data->E()(2)/(V/cm)));
+        const VectorValue<PetscScalar> E = region->cell_efield(n);
+        Ex.push_back(static_cast<float>(E(0)/(V/cm)));
+        Ey.push_back(static_cast<float>(E(1)/(V/cm)));
+        Ez.push_back(static_cast<float>(E(2)/(V/cm)));
 
         Jnx.push_back(static_cast<float>(elem_data->Jn()(0)/(A/cm)));
         Jny.push_back(static_cast<float>(elem_data->Jn()(1)/(A/cm)));
@@ -1483,12 +1675,23 @@ void VTKIO::solution_to_vtk(const MeshBase& mesh, std::ofstream & out)
         Jpx.push_back(static_cast<float>(elem_data->Jp()(0)/(A/cm)));
         Jpy.push_back(static_cast<float>(elem_data->Jp()(1)/(A/cm)));
         Jpz.push_back(static_cast<float>(elem_data->Jp()(2)/(A/cm)));
+
+        if(mob_force)
+        {
+          Fn.push_back(static_cast<float>(elem_data->Epn()/(V/cm)));
+          Fp.push_back(static_cast<float>(elem_data->Epp()/(V/cm)));
+        }
       }
     }
     Parallel::gather(0, order);
     write_cell_vector_solution(order, Ex,  Ey,  Ez,  "electrical_field", out);
     write_cell_vector_solution(order, Jnx, Jny, Jnz, "electron_current", out);
     write_cell_vector_solution(order, Jpx, Jpy, Jpz, "hole_current", out);
+    if(mob_force)
+    {
+      write_cell_scaler_solution(order, Fn, "electron_driving_force", out);
+      write_cell_scaler_solution(order, Fp, "hole_driving_force", out);
+    }
   }
 
 
@@ -1839,6 +2042,470 @@ void VTKIO::_smooth_numerical_error(std::map<unsigned int, float> &dataset, floa
 }
 
 
+// ------------------------------------------------------------
+// parallel XML writer, each processor writes its own .vtu piece
+
+namespace
+{
+  /**
+   * one DataArray of a vtu piece, kept as raw bytes for the appended section
+   */
+  struct VTUArray
+  {
+    std::string  name;
+    std::string  type;
+    unsigned int n_components;
+    std::string  data;
+  };
+
+  template <typename T>
+  void vtu_array(std::vector<VTUArray> & arrays, const std::string & name, const char * type,
+                 unsigned int n_components, const std::vector<T> & v)
+  {
+    arrays.push_back(VTUArray());
+    VTUArray & a = arrays.back();
+    a.name = name;
+    a.type = type;
+    a.n_components = n_components;
+    if(!v.empty())
+      a.data.assign(reinterpret_cast<const char *>(&v[0]), v.size()*sizeof(T));
+  }
+
+  /**
+   * field data in Float32 or Float64
+   */
+  void vtu_field(std::vector<VTUArray> & arrays, const std::string & name, unsigned int n_components,
+                 const std::vector<double> & v, bool float32)
+  {
+    if(float32)
+    {
+      std::vector<float> f(v.begin(), v.end());
+      vtu_array(arrays, name, "Float32", n_components, f);
+    }
+    else
+      vtu_array(arrays, name, "Float64", n_components, v);
+  }
+
+  /**
+   * complex field as magnitude and angle, the same as the vtkUnstructuredGrid output
+   */
+  void vtu_field(std::vector<VTUArray> & arrays, const std::string & name,
+                 const std::vector<std::complex<double> > & v, bool float32)
+  {
+    std::vector<double> abs(v.size()), arg(v.size());
+    for(unsigned int n=0; n<v.size(); ++n)
+    {
+      abs[n] = std::abs(v[n]);
+      arg[n] = std::arg(v[n]);
+    }
+    vtu_field(arrays, name+" abs",   1, abs, float32);
+    vtu_field(arrays, name+" angle", 1, arg, float32);
+  }
+
+  void vtu_header(std::ostream & out, const std::vector<VTUArray> & arrays, const char * tag,
+                  unsigned long long & offset)
+  {
+    out << "      <" << tag << ">\n";
+    for(unsigned int n=0; n<arrays.size(); ++n)
+    {
+      const VTUArray & a = arrays[n];
+      out << "        <DataArray type=\"" << a.type << "\"";
+      if(!a.name.empty()) out << " Name=\"" << a.name << "\"";
+      out << " NumberOfComponents=\"" << a.n_components << "\" format=\"appended\" offset=\"" << offset << "\"/>\n";
+      offset += sizeof(unsigned long long) + a.data.size();
+    }
+    out << "      </" << tag << ">\n";
+  }
+
+  void pvtu_header(std::ostream & out, const std::vector<VTUArray> & arrays, const char * tag)
+  {
+    out << "    <" << tag << ">\n";
+    for(unsigned int n=0; n<arrays.size(); ++n)
+    {
+      const VTUArray & a = arrays[n];
+      out << "      <PDataArray type=\"" << a.type << "\"";
+      if(!a.name.empty()) out << " Name=\"" << a.name << "\"";
+      out << " NumberOfComponents=\"" << a.n_components << "\"/>\n";
+    }
+    out << "    </" << tag << ">\n";
+  }
+
+  // raw encoding, each block is led by its byte count
+  void vtu_append(std::ostream & out, const std::vector<VTUArray> & arrays)
+  {
+    for(unsigned int n=0; n<arrays.size(); ++n)
+    {
+      const unsigned long long size = arrays[n].data.size();
+      out.write(reinterpret_cast<const char *>(&size), sizeof(size));
+      out.write(arrays[n].data.data(), arrays[n].data.size());
+    }
+  }
+
+  const char * vtu_byte_order()
+  {
+    const unsigned short int i = 1;
+    return *reinterpret_cast<const unsigned char *>(&i) ? "LittleEndian" : "BigEndian";
+  }
+
+  unsigned char vtu_cell_type(ElemType type)
+  {
+    switch(type)
+    {
+        case EDGE2:
+        case EDGE2_FVM:    return 3;  //VTK_LINE;
+        case EDGE3:        return 21; //VTK_QUADRATIC_EDGE;
+        case TRI3:
+        case TRI3_FVM:
+        case TRI3_CY_FVM:  return 5;  //VTK_TRIANGLE;
+        case TRI6:         return 22; //VTK_QUADRATIC_TRIANGLE;
+        case QUAD4:
+        case QUAD4_FVM:
+        case QUAD4_CY_FVM: return 9;  //VTK_QUAD;
+        case QUAD8:        return 23; //VTK_QUADRATIC_QUAD;
+        case TET4:
+        case TET4_FVM:     return 10; //VTK_TETRA;
+        case TET10:        return 24; //VTK_QUADRATIC_TETRA;
+        case HEX8:
+        case HEX8_FVM:     return 12; //VTK_HEXAHEDRON;
+        case HEX20:        return 25; //VTK_QUADRATIC_HEXAHEDRON;
+        case PRISM6:
+        case PRISM6_FVM:   return 13; //VTK_WEDGE;
+        case PYRAMID5:
+        case PYRAMID5_FVM: return 14; //VTK_PYRAMID;
+        default:
+        {
+          std::cerr<<"element type "<<type<<" not implemented"<<std::endl;
+          genius_error();
+        }
+    }
+    return 0;
+  }
+}
+
+
+void VTKIO::write_pvtu(const MeshBase& mesh, const std::string& name)
+{
+  const SimulationSystem & system = FieldOutput<SimulationSystem>::system();
+
+  // check which data should be export
+  bool semiconductor_material = false;
+  for(unsigned int n=0; n<system.n_regions(); ++n)
+    if(Material::IsSemiconductor(system.region(n)->material()))
+      semiconductor_material=true;
+
+  bool ebm_solution_data     = false;
+  bool optical_generation    = false;
+  bool particle_generation   = false;
+  bool ddm_ac_data           = false;
+  bool optical_complex_field = false;
+
+  const std::vector<SolverSpecify::SolverType> & solve_history = system.solve_history();
+  for(unsigned int n=0; n<solve_history.size(); ++n)
+  {
+    switch  (solve_history[n])
+    {
+        case SolverSpecify::EBML3      :
+        case SolverSpecify::EBML3MIX   :
+        ebm_solution_data = true;
+        break;
+        case SolverSpecify::EM_FEM_2D  :
+        case SolverSpecify::EM_FEM_3D  :
+        optical_complex_field = true;
+        optical_generation = true;
+        break;
+        case SolverSpecify::RAY_TRACE  :
+        optical_generation = true;
+        break;
+        case SolverSpecify::DDMAC      :
+        ddm_ac_data = true;
+        break;
+        default : break;
+    }
+  }
+
+  if(system.get_field_source()->is_light_source_exist())
+    optical_generation = true;
+
+  if(system.get_field_source()->is_particle_source_exist())
+    particle_generation = true;
+
+  // the piece holds the elements of this processor and all the nodes they use,
+  // nodes are renumbered in the order of first appearance
+  std::map<unsigned int, unsigned int> cell_index;
+  std::map<unsigned int, unsigned int> node_index;
+  std::vector<const Node *> nodes;
+
+  std::vector<long long> connectivity, offsets;
+  std::vector<unsigned char> types;
+  std::vector<int> subdomain, partition;
+
+  const std::vector<Elem *> & elems = mesh.active_this_pid_elem_range();
+  for (unsigned int ne=0; ne<elems.size(); ++ne)
+  {
+    const Elem * elem = elems[ne];
+    cell_index.insert( std::make_pair(elem->id(), static_cast<unsigned int>(types.size())) );
+    for(unsigned int i=0; i<elem->n_nodes(); ++i)
+    {
+      const Node * node = elem->get_node(i);
+      std::pair<std::map<unsigned int, unsigned int>::iterator, bool> pos =
+        node_index.insert( std::make_pair(node->id(), static_cast<unsigned int>(nodes.size())) );
+      if(pos.second) nodes.push_back(node);
+      connectivity.push_back(pos.first->second);
+    }
+    offsets.push_back(connectivity.size());
+    types.push_back(vtu_cell_type(elem->type()));
+    subdomain.push_back(elem->subdomain_id());
+    partition.push_back(elem->processor_id());
+  }
+
+  const unsigned int n_points = nodes.size();
+  const unsigned int n_cells  = types.size();
+
+  std::vector<double> pts(3*n_points);
+  for(unsigned int n=0; n<n_points; ++n)
+    for(unsigned int d=0; d<3; ++d)
+      pts[3*n+d] = (*nodes[n])(d)/um;
+
+  // cell based data
+  std::vector<double> E(3*n_cells), Jn(3*n_cells), Jp(3*n_cells);
+  for( unsigned int r=0; r<system.n_regions(); r++)
+  {
+    const SimulationRegion * region = system.region(r);
+    for(unsigned int n=0; n<region->n_cell(); ++n)
+    {
+      const Elem * elem = region->get_region_elem(n);
+      if( elem->processor_id() != Genius::processor_id() ) continue;
+
+      std::map<unsigned int, unsigned int>::const_iterator it = cell_index.find(elem->id());
+      if( it == cell_index.end() ) continue;
+
+      const FVM_CellData * elem_data = region->get_region_elem_data(n);
+      const VectorValue<PetscScalar> Ec = region->cell_efield(n);
+      for(unsigned int d=0; d<3; ++d)
+      {
+        E [3*it->second+d] = Ec(d)/(V/cm);
+        Jn[3*it->second+d] = elem_data->Jn()(d)/(A/cm);
+        Jp[3*it->second+d] = elem_data->Jp()(d)/(A/cm);
+      }
+    }
+  }
+
+  // node based data. ghost nodes of the piece also hold the node data updated by the solver,
+  // so no value has to be fetched from other processors
+  double concentration_scale = pow(cm, -3);
+
+  std::vector<double> Na(n_points), Nd(n_points), net_doping(n_points), net_charge(n_points);
+  std::vector<double> psi(n_points), Ec(n_points), Ev(n_points), qFn(n_points), qFp(n_points);
+  std::vector<double> n(n_points), p(n_points), T(n_points), Tn(n_points), Tp(n_points);
+  std::vector<double> mole_x(n_points), mole_y(n_points);
+  std::vector<double> OptG(n_points), PatG(n_points);
+  std::vector<double> R(n_points);
+
+  std::vector<std::complex<double> > psi_ac(n_points), n_ac(n_points), p_ac(n_points);
+  std::vector<std::complex<double> > T_ac(n_points), Tn_ac(n_points), Tp_ac(n_points);
+  std::vector<std::complex<double> > OptE_complex(n_points), OptH_complex(n_points);
+
+  std::vector<bool> filled(n_points, false);
+  for( unsigned int r=0; r<system.n_regions(); r++)
+  {
+    const SimulationRegion * region = system.region(r);
+    SimulationRegion::const_local_node_iterator node_it = region->on_local_nodes_begin();
+    SimulationRegion::const_local_node_iterator node_it_end = region->on_local_nodes_end();
+    for(; node_it!=node_it_end; ++node_it)
+    {
+      const FVM_Node * fvm_node = *node_it;
+      std::map<unsigned int, unsigned int>::const_iterator it = node_index.find(fvm_node->root_node()->id());
+      if( it == node_index.end() || filled[it->second] ) continue;
+
+      const unsigned int i = it->second;
+      filled[i] = true;
+
+      // use the node data in the more important region, as the legacy output
+      const FVM_NodeData * node_data = fvm_node->node_data();
+      if( fvm_node->boundary_id() != BoundaryInfo::invalid_id )
+      {
+        unsigned int bc_index = system.get_bcs()->get_bc_index_by_bd_id(fvm_node->boundary_id());
+        const BoundaryCondition * bc = system.get_bcs()->get_bc(bc_index);
+        if( bc->has_node(fvm_node->root_node()) )
+        {
+          const FVM_Node * primary_fvm_node = (*bc->region_node_begin(fvm_node->root_node())).second.second;
+          if( primary_fvm_node && primary_fvm_node->node_data() )
+            node_data = primary_fvm_node->node_data();
+        }
+      }
+
+      assert ( node_data != NULL );
+
+      if(semiconductor_material)
+      {
+        Na[i]         = node_data->Total_Na()/concentration_scale;
+        Nd[i]         = node_data->Total_Nd()/concentration_scale;
+        net_doping[i] = node_data->Net_doping()/concentration_scale;
+        net_charge[i] = node_data->Net_charge()/concentration_scale;
+        n[i]          = node_data->n()/concentration_scale;
+        p[i]          = node_data->p()/concentration_scale;
+        mole_x[i]     = node_data->mole_x();
+        mole_y[i]     = node_data->mole_y();
+        R[i]          = node_data->Recomb()/(concentration_scale/s);
+      }
+
+      psi[i] = node_data->psi()/V;
+      Ec[i]  = node_data->Ec()/eV;
+      Ev[i]  = node_data->Ev()/eV;
+      qFn[i] = node_data->qFn()/eV;
+      qFp[i] = node_data->qFp()/eV;
+      T[i]   = node_data->T()/K;
+
+      if(ebm_solution_data)
+      {
+        Tn[i] = node_data->Tn()/K;
+        Tp[i] = node_data->Tp()/K;
+      }
+
+      if(optical_generation)
+        OptG[i] = node_data->OptG()/(concentration_scale/s);
+
+      if(particle_generation)
+        PatG[i] = node_data->PatG()/(concentration_scale/s);
+
+      if(ddm_ac_data)
+      {
+        psi_ac[i] = node_data->psi_ac()/V;
+        n_ac[i]   = node_data->n_ac()/concentration_scale;
+        p_ac[i]   = node_data->p_ac()/concentration_scale;
+        T_ac[i]   = node_data->T_ac()/K;
+        Tn_ac[i]  = node_data->Tn_ac()/K;
+        Tp_ac[i]  = node_data->Tp_ac()/K;
+      }
+
+      if(optical_complex_field)
+      {
+        OptE_complex[i] = node_data->OptE_complex()/(V/cm);
+        OptH_complex[i] = node_data->OptH_complex()/(A/cm);
+      }
+    }
+  }
+
+  // the array list must be the same on all the processors, the pvtu index is built from it
+  std::vector<VTUArray> point_data, cell_data, points, cells;
+
+  vtu_field(point_data, "psi", 1, psi, _float32);
+  vtu_field(point_data, "Ec",  1, Ec,  _float32);
+  vtu_field(point_data, "Ev",  1, Ev,  _float32);
+  vtu_field(point_data, "elec_quasi_Fermi_level", 1, qFn, _float32);
+  vtu_field(point_data, "hole_quasi_Fermi_level", 1, qFp, _float32);
+  if(semiconductor_material)
+  {
+    vtu_field(point_data, "Na", 1, Na, _float32);
+    vtu_field(point_data, "Nd", 1, Nd, _float32);
+    vtu_field(point_data, "electron_density", 1, n, _float32);
+    vtu_field(point_data, "hole_density", 1, p, _float32);
+    vtu_field(point_data, "net_doping", 1, net_doping, _float32);
+    vtu_field(point_data, "net_charge", 1, net_charge, _float32);
+    vtu_field(point_data, "mole_x", 1, mole_x, _float32);
+    vtu_field(point_data, "mole_y", 1, mole_y, _float32);
+    vtu_field(point_data, "recombination", 1, R, true);  // stored in float
+  }
+  vtu_field(point_data, "temperature", 1, T, _float32);
+  if(ebm_solution_data)
+  {
+    vtu_field(point_data, "elec_temperature", 1, Tn, _float32);
+    vtu_field(point_data, "hole_temperature", 1, Tp, _float32);
+  }
+  if(ddm_ac_data)
+  {
+    vtu_field(point_data, "psi_AC", psi_ac, _float32);
+    vtu_field(point_data, "electron_AC", n_ac, _float32);
+    vtu_field(point_data, "hole_AC", p_ac, _float32);
+    vtu_field(point_data, "temperature_AC", T_ac, _float32);
+    vtu_field(point_data, "elec_temperature_AC", Tn_ac, _float32);
+    vtu_field(point_data, "hole_temperature_AC", Tp_ac, _float32);
+  }
+  if(optical_complex_field)
+  {
+    vtu_field(point_data, "Optical_E", OptE_complex, _float32);
+    vtu_field(point_data, "Optical_H", OptH_complex, _float32);
+  }
+  // these auxiliary fields are stored in float, Float64 would not carry more digits
+  if(optical_generation)
+    vtu_field(point_data, "Optical_Generation", 1, OptG, true);
+  if(particle_generation)
+    vtu_field(point_data, "Radiation_Generation", 1, PatG, true);
+
+  vtu_array(cell_data, "region", "Int32", 1, subdomain);
+  vtu_array(cell_data, "partition", "Int32", 1, partition);
+  vtu_field(cell_data, "electrical_field", 3, E,  _float32);
+  vtu_field(cell_data, "electron_current", 3, Jn, _float32);
+  vtu_field(cell_data, "hole_current",     3, Jp, _float32);
+
+  vtu_array(points, "", "Float64", 3, pts);
+
+  vtu_array(cells, "connectivity", "Int64", 1, connectivity);
+  vtu_array(cells, "offsets", "Int64", 1, offsets);
+  vtu_array(cells, "types", "UInt8", 1, types);
+
+  // piece file name, base_pid.vtu in the directory of the pvtu file
+  std::string base = name.substr(0, name.rfind(".pvtu"));
+  std::string::size_type slash = base.find_last_of("/\\");
+  std::string base_name = (slash == std::string::npos) ? base : base.substr(slash+1);
+
+  {
+    std::stringstream ss;
+    ss << base << "_" << Genius::processor_id() << ".vtu";
+
+    std::ofstream out(ss.str().c_str(), std::ofstream::trunc | std::ofstream::binary);
+    if(!out.good())
+    {
+      std::cerr<<"ERROR: can't open file " << ss.str() << " for writing." << std::endl;
+      genius_error();
+    }
+
+    unsigned long long offset = 0;
+    out << "<?xml version=\"1.0\"?>\n";
+    out << "<VTKFile type=\"UnstructuredGrid\" version=\"1.0\" byte_order=\"" << vtu_byte_order() << "\" header_type=\"UInt64\">\n";
+    out << "  <UnstructuredGrid>\n";
+    out << "    <Piece NumberOfPoints=\"" << n_points << "\" NumberOfCells=\"" << n_cells << "\">\n";
+    vtu_header(out, point_data, "PointData", offset);
+    vtu_header(out, cell_data,  "CellData",  offset);
+    vtu_header(out, points,     "Points",    offset);
+    vtu_header(out, cells,      "Cells",     offset);
+    out << "    </Piece>\n";
+    out << "  </UnstructuredGrid>\n";
+    out << "  <AppendedData encoding=\"raw\">\n";
+    out << "_";
+    vtu_append(out, point_data);
+    vtu_append(out, cell_data);
+    vtu_append(out, points);
+    vtu_append(out, cells);
+    out << "\n  </AppendedData>\n";
+    out << "</VTKFile>\n";
+    out.close();
+  }
+
+  // processor 0 writes the index of all the pieces
+  if(Genius::processor_id() == 0)
+  {
+    std::ofstream out(name.c_str(), std::ofstream::trunc);
+
+    out << "<?xml version=\"1.0\"?>\n";
+    out << "<VTKFile type=\"PUnstructuredGrid\" version=\"1.0\" byte_order=\"" << vtu_byte_order() << "\" header_type=\"UInt64\">\n";
+    out << "  <PUnstructuredGrid GhostLevel=\"0\">\n";
+    pvtu_header(out, point_data, "PPointData");
+    pvtu_header(out, cell_data,  "PCellData");
+    pvtu_header(out, points,     "PPoints");
+    for(unsigned int pid=0; pid<Genius::n_processors(); ++pid)
+      out << "    <Piece Source=\"" << base_name << "_" << pid << ".vtu\"/>\n";
+    out << "  </PUnstructuredGrid>\n";
+    out << "</VTKFile>\n";
+    out.close();
+  }
+
+  // the pvtu file is complete when all the pieces are
+  Parallel::barrier();
+}
+
+
+
 // ------------------------------------------------------------
 // vtkIO class members
 //
@@ -1852,6 +2519,13 @@ void VTKIO::write (const std::string& name)
 {
 
   const MeshBase& mesh = FieldOutput<SimulationSystem>::system().mesh();
+  // parallel pieces with a ".pvtu" index?
+  if(name.rfind(".pvtu") < name.size())
+  {
+    write_pvtu(mesh, name);
+    return;
+  }
+
   mesh.boundary_info->build_on_processor_side_list (_el, _sl, _il);
 
   // vtk file extension have a ".vtu" format?
@@ -1867,6 +2541,19 @@ void VTKIO::write (const std::string& name)
     solution_to_vtk(mesh, _vtk_grid);
 
 
+#ifndef WINDOWS
+    // processor 0 queues the grid for the writer thread, which also deletes it
+    if(_async)
+    {
+      if(Genius::processor_id() == 0)
+        AsyncGridWriter::instance().push(_vtk_grid, this->export_extra_info(), name, _async_queue_size);
+      else
+        _vtk_grid->Delete();
+      _vtk_grid = NULL;
+      return;
+    }
+#endif
+
     // only processor 0 write VTK file
     if(Genius::processor_id() == 0)
     {
@@ -1916,6 +2603,16 @@ void VTKIO::write (const std::string& name)
 
 
 
+void VTKIO::wait_async()
+{
+#if defined(HAVE_VTK) && !defined(WINDOWS)
+  if(Genius::processor_id() == 0)
+    AsyncGridWriter::instance().wait();
+#endif
+}
+
+
+
 void VTKIO::read (const std::string& name)
 {
 #ifdef HAVE_VTK
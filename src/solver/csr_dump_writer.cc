@@ -0,0 +1,253 @@
+/********************************************************************************/
+/*     888888    888888888   88     888  88888   888      888    88888888       */
+/*   8       8   8           8 8     8     8      8        8    8               */
+/*  8            8           8  8    8     8      8        8    8               */
+/*  8            888888888   8   8   8     8      8        8     8888888        */
+/*  8      8888  8           8    8  8     8      8        8            8       */
+/*   8       8   8           8     8 8     8      8        8            8       */
+/*     888888    888888888  888     88   88888     88888888     88888888        */
+/*                                                                              */
+/*       A Three-Dimensional General Purpose Semiconductor Simulator.           */
+/*                                                                              */
+/*                                                                              */
+/*  Copyright (C) 2007-2008                                                     */
+/*  Cogenda Pte Ltd                                                             */
+/*                                                                              */
+/*  Please contact Cogenda Pte Ltd for license information                      */
+/*                                                                              */
+/*  Author: Gong Ding   gdiso@ustc.edu                                          */
+/*                                                                              */
+/********************************************************************************/
+
+
+#include <fstream>
+#include <cstring>
+
+#include "csr_dump_writer.h"
+
+
+namespace
+{
+  void put_uint64(std::string & buf, unsigned long long v)
+  {
+    for(unsigned int i=0; i<8; ++i)
+      buf.push_back(static_cast<char>((v >> (8*i)) & 0xff));
+  }
+
+  void put_double(std::string & buf, double v)
+  {
+    unsigned long long bits;
+    std::memcpy(&bits, &v, sizeof(double));
+    put_uint64(buf, bits);
+  }
+
+  void put_varint(std::string & buf, unsigned long long v)
+  {
+    while( v >= 0x80 )
+    {
+      buf.push_back(static_cast<char>((v & 0x7f) | 0x80));
+      v >>= 7;
+    }
+    buf.push_back(static_cast<char>(v));
+  }
+
+  unsigned long long zigzag(long long v)
+  {
+    return (static_cast<unsigned long long>(v) << 1) ^ static_cast<unsigned long long>(v >> 63);
+  }
+}
+
+
+bool CSRDumpWriter::write(const CSRDump & dump)
+{
+  const unsigned long long n_local_rows = dump.row_ptr.empty() ? 0 : dump.row_ptr.size()-1;
+  const unsigned long long nnz = dump.cols.size();
+
+  std::string buf;
+  buf.reserve(64 + 3*n_local_rows + 2*nnz + 8*(nnz + dump.rhs.size()));
+
+  const char magic[8] = {'G', 'C', 'S', 'R', 0, 0, 0, 1};
+  buf.append(magic, 8);
+  put_uint64(buf, dump.n_rows);
+  put_uint64(buf, dump.n_cols);
+  put_uint64(buf, dump.row_begin);
+  put_uint64(buf, n_local_rows);
+  put_uint64(buf, nnz);
+  put_uint64(buf, dump.rhs.size());
+
+  for(unsigned long long r=0; r<n_local_rows; ++r)
+    put_varint(buf, dump.row_ptr[r+1] - dump.row_ptr[r]);
+
+  for(unsigned long long r=0; r<n_local_rows; ++r)
+  {
+    long long prev = static_cast<long long>(dump.row_begin + r);
+    for(unsigned long long k=dump.row_ptr[r]; k<dump.row_ptr[r+1]; ++k)
+    {
+      put_varint(buf, zigzag(dump.cols[k] - prev));
+      prev = dump.cols[k];
+    }
+  }
+
+  for(unsigned long long k=0; k<nnz; ++k)
+    put_double(buf, dump.vals[k]);
+  for(unsigned int k=0; k<dump.rhs.size(); ++k)
+    put_double(buf, dump.rhs[k]);
+
+  std::ofstream out(dump.filename.c_str(), std::ios::binary);
+  if( !out.good() ) return false;
+  out.write(buf.data(), buf.size());
+  return out.good();
+}
+
+
+
+#ifndef WINDOWS
+#include <deque>
+#include <pthread.h>
+
+namespace
+{
+  /**
+   * a single writer thread with bounded queue, the same as the one of VTK output
+   */
+  class AsyncCSRWriter
+  {
+  public:
+
+    static AsyncCSRWriter & instance()
+    {
+      static AsyncCSRWriter writer;
+      return writer;
+    }
+
+    void push(CSRDump * dump, unsigned int queue_size)
+    {
+      pthread_mutex_lock(&_mutex);
+      if( !_running )
+      {
+        _running = (pthread_create(&_thread, NULL, _thread_main, this) == 0);
+        if( !_running )
+        {
+          // can not start the thread, write it here
+          pthread_mutex_unlock(&_mutex);
+          CSRDumpWriter::write(*dump);
+          delete dump;
+          return;
+        }
+      }
+
+      while( _queue.size() >= queue_size )
+        pthread_cond_wait(&_slot_free, &_mutex);
+
+      _queue.push_back(dump);
+
+      pthread_cond_signal(&_job_ready);
+      pthread_mutex_unlock(&_mutex);
+    }
+
+    void wait()
+    {
+      pthread_mutex_lock(&_mutex);
+      while( !_queue.empty() || _busy )
+        pthread_cond_wait(&_slot_free, &_mutex);
+      pthread_mutex_unlock(&_mutex);
+    }
+
+  private:
+
+    AsyncCSRWriter() : _running(false), _busy(false), _stop(false)
+    {
+      pthread_mutex_init(&_mutex, NULL);
+      pthread_cond_init(&_job_ready, NULL);
+      pthread_cond_init(&_slot_free, NULL);
+    }
+
+    ~AsyncCSRWriter()
+    {
+      pthread_mutex_lock(&_mutex);
+      _stop = true;
+      pthread_cond_signal(&_job_ready);
+      pthread_mutex_unlock(&_mutex);
+
+      // the thread writes out all the queued dumps before exit
+      if( _running )
+        pthread_join(_thread, NULL);
+
+      pthread_cond_destroy(&_slot_free);
+      pthread_cond_destroy(&_job_ready);
+      pthread_mutex_destroy(&_mutex);
+    }
+
+    static void * _thread_main(void * ctx)
+    {
+      static_cast<AsyncCSRWriter *>(ctx)->_run();
+      return NULL;
+    }
+
+    void _run()
+    {
+      while(true)
+      {
+        pthread_mutex_lock(&_mutex);
+        while( _queue.empty() && !_stop )
+          pthread_cond_wait(&_job_ready, &_mutex);
+
+        if( _queue.empty() )
+        {
+          pthread_mutex_unlock(&_mutex);
+          break;
+        }
+
+        CSRDump * dump = _queue.front();
+        _queue.pop_front();
+        _busy = true;
+        pthread_mutex_unlock(&_mutex);
+
+        CSRDumpWriter::write(*dump);
+        delete dump;
+
+        pthread_mutex_lock(&_mutex);
+        _busy = false;
+        pthread_cond_broadcast(&_slot_free);
+        pthread_mutex_unlock(&_mutex);
+      }
+    }
+
+    std::deque<CSRDump *> _queue;
+
+    pthread_t       _thread;
+    pthread_mutex_t _mutex;
+    pthread_cond_t  _job_ready;
+    pthread_cond_t  _slot_free;
+
+    bool _running;
+    bool _busy;
+    bool _stop;
+  };
+}
+
+
+void CSRDumpWriter::push(CSRDump * dump, unsigned int queue_size)
+{
+  AsyncCSRWriter::instance().push(dump, queue_size);
+}
+
+
+void CSRDumpWriter::wait()
+{
+  AsyncCSRWriter::instance().wait();
+}
+
+#else
+
+void CSRDumpWriter::push(CSRDump * dump, unsigned int)
+{
+  write(*dump);
+  delete dump;
+}
+
+
+void CSRDumpWriter::wait()
+{}
+
+#endif // WINDOWS
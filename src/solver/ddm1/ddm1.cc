@@ -25,6 +25,7 @@
 
 #include "ddm1/ddm1.h"
 #include "parallel.h"
+#include "solver_counters.h"
 #include "petsc_utils.h"
 #include "mat_analysis.h"
 
@@ -128,6 +129,10 @@ int DDM1Solver::solve()
       solve_iv_trace();
       break;
 
+      case SolverSpecify::HARMONIC:
+      solve_harmonic_balance();
+      break;
+
       default:
       MESSAGE<< '\n' << "DDM1Solver: Unsupported solve type.";
       RECORD();
@@ -210,6 +215,9 @@ void DDM1Solver::flush_system(Vec v)
  */
 int DDM1Solver::diverged_recovery()
 {
+  // rejected transient step, x_n is the last accepted solution
+  if( restore_from_history() ) return 0;
+
   // for all the regions
   for(unsigned int n=0; n<_system.n_regions(); n++)
   {
@@ -253,25 +261,9 @@ void DDM1Solver::potential_damping(Vec x, Vec y, PetscBool *changed_y)
   const PetscScalar onePerCMC = 1.0*std::pow(cm,-3);
 
   // we should find dV_max;
-  // first, we find in local
-  for(unsigned int n=0; n<_system.n_regions(); n++)
-  {
-    // only consider semiconductor region
-    const SimulationRegion * region = _system.region(n);
-    if( region->type() == SemiconductorRegion )
-    {
-      SimulationRegion::const_processor_node_iterator it = region->on_processor_nodes_begin();
-      SimulationRegion::const_processor_node_iterator it_end = region->on_processor_nodes_end();
-      for(; it!=it_end; ++it)
-      {
-        const FVM_Node * fvm_node = *it;
-
-        // we konw the fvm_node->local_offset() is psi in semiconductor region
-        unsigned int local_offset = fvm_node->local_offset();
-        dV_max = std::max(dV_max, std::abs(yy[local_offset]));
-      }
-    }
-  }
+  // first, we find in local, only consider semiconductor region
+  for(unsigned int i=0; i<semiconductor_offset.size(); ++i)
+    dV_max = std::max(dV_max, std::abs(yy[semiconductor_offset[i]]));
 
   // for parallel situation, we should find the dv_max in global.
   Parallel::max( dV_max );
@@ -281,41 +273,12 @@ void DDM1Solver::potential_damping(Vec x, Vec y, PetscBool *changed_y)
     // compute logarithmic potential damping factor f;
     PetscScalar Vut = kb*T/e * SolverSpecify::potential_update;
     PetscScalar f = log(1+dV_max/Vut)/(dV_max/Vut);
+    if( f < 1.0 ) solver_counters.add(SolverCounters::LineSearchCutbacks);
 
-    // do newton damping here
-    for(unsigned int n=0; n<_system.n_regions(); n++)
-    {
-      const SimulationRegion * region = _system.region(n);
-      switch ( region->type() )
-      {
-          case SemiconductorRegion :
-          {
-            SimulationRegion::const_processor_node_iterator it = region->on_processor_nodes_begin();
-            SimulationRegion::const_processor_node_iterator it_end = region->on_processor_nodes_end();
-            for(; it!=it_end; ++it)
-            {
-              const FVM_Node * fvm_node = *it;
-              unsigned int local_offset = fvm_node->local_offset();
-              yy[local_offset+0] *= f;
-            }
-            break;
-          }
-          case InsulatorRegion :
-          case ElectrodeRegion :
-          case MetalRegion     :
-          {
-            SimulationRegion::const_processor_node_iterator it = region->on_processor_nodes_begin();
-            SimulationRegion::const_processor_node_iterator it_end = region->on_processor_nodes_end();
-            for(; it!=it_end; ++it)
-            {
-              const FVM_Node * fvm_node = *it;
-              yy[fvm_node->local_offset()+0] *= f;
-            }
-            break;
-          }
-          default: break;
-      }
-    }
+    // do newton damping here, potential of all the regions
+    const std::vector<unsigned int> & psi_index = norm_index[NormPotential];
+    for(unsigned int i=0; i<psi_index.size(); ++i)
+      yy[psi_index[i]] *= f;
 
     /*
     // only the last processor do this
@@ -348,9 +311,18 @@ void DDM1Solver::potential_damping(Vec x, Vec y, PetscBool *changed_y)
 /*------------------------------------------------------------------
  * Bank-Rose Newton Damping
  */
-void DDM1Solver::bank_rose_damping(Vec , Vec , PetscBool *changed_y)
+void DDM1Solver::bank_rose_damping(Vec x, Vec y, PetscBool *changed_y)
 {
   *changed_y = PETSC_FALSE;
+
+  PetscReal t = bank_rose_factor(x, y);
+  if( t < 1.0 )
+  {
+    solver_counters.add(SolverCounters::LineSearchCutbacks);
+    VecScale(y, t);
+    *changed_y = PETSC_TRUE;
+  }
+
   return;
 }
 
@@ -371,27 +343,16 @@ void DDM1Solver::check_positive_density(Vec x, Vec y, Vec w, PetscBool *changed_
   const PetscScalar T = this->get_system().T_external();
   const PetscScalar onePerCMC = 1.0*std::pow(cm,-3);
 
-  for(unsigned int n=0; n<_system.n_regions(); n++)
+  // only consider semiconductor region
+  for(unsigned int i=0; i<semiconductor_offset.size(); ++i)
   {
-    // only consider semiconductor region
-    const SimulationRegion * region = _system.region(n);
-    if( region->type() == SemiconductorRegion )
-    {
-      SimulationRegion::const_processor_node_iterator it = region->on_processor_nodes_begin();
-      SimulationRegion::const_processor_node_iterator it_end = region->on_processor_nodes_end();
-      for(; it!=it_end; ++it)
-      {
-        const FVM_Node * fvm_node = *it;
-        unsigned int local_offset = fvm_node->local_offset();
-
-        //prevent negative carrier density
-        if ( ww[local_offset+1] < 0 )
-        { ww[local_offset+1] = 1e-2*fabs(xx[local_offset+1]) + onePerCMC; changed_flag++; }
-        if ( ww[local_offset+2] < 0 )
-        { ww[local_offset+2] = 1e-2*fabs(xx[local_offset+2]) + onePerCMC; changed_flag++; }
+    unsigned int local_offset = semiconductor_offset[i];
 
-      }
-    }
+    //prevent negative carrier density
+    if ( ww[local_offset+1] < 0 )
+    { ww[local_offset+1] = 1e-2*fabs(xx[local_offset+1]) + onePerCMC; changed_flag++; }
+    if ( ww[local_offset+2] < 0 )
+    { ww[local_offset+2] = 1e-2*fabs(xx[local_offset+2]) + onePerCMC; changed_flag++; }
   }
   VecRestoreArray(x, &xx);
   VecRestoreArray(w, &ww);
@@ -418,26 +379,16 @@ void DDM1Solver::projection_positive_density_check(Vec x, Vec xo)
   VecGetArray(x, &xx);
   VecGetArray(xo, &oo);
 
-  for(unsigned int n=0; n<_system.n_regions(); n++)
+  // only consider semiconductor region
+  for(unsigned int i=0; i<semiconductor_offset.size(); ++i)
   {
-    // only consider semiconductor region
-    const SimulationRegion * region = _system.region(n);
-    if( region->type() == SemiconductorRegion )
-    {
-      SimulationRegion::const_processor_node_iterator it = region->on_processor_nodes_begin();
-      SimulationRegion::const_processor_node_iterator it_end = region->on_processor_nodes_end();
-      for(; it!=it_end; ++it)
-      {
-        const FVM_Node * fvm_node = *it;
-        unsigned int local_offset = fvm_node->local_offset();
+    unsigned int local_offset = semiconductor_offset[i];
 
-        //prevent negative carrier density
-        if ( xx[local_offset+1] < 0 )
-          xx[local_offset+1]= fabs(0.01*oo[local_offset+1]);
-        if ( xx[local_offset+2] < 0 )
-          xx[local_offset+2]= fabs(0.01*oo[local_offset+2]);
-      }
-    }
+    //prevent negative carrier density
+    if ( xx[local_offset+1] < 0 )
+      xx[local_offset+1]= fabs(0.01*oo[local_offset+1]);
+    if ( xx[local_offset+2] < 0 )
+      xx[local_offset+2]= fabs(0.01*oo[local_offset+2]);
   }
 
   VecRestoreArray(x,&xx);
@@ -491,11 +442,6 @@ PetscReal DDM1Solver::LTE_norm()
   PetscReal hn1 = SolverSpecify::dt_last;
   PetscReal hn2 = SolverSpecify::dt_last_last;
 
-  // relative error
-  PetscReal eps_r = SolverSpecify::TS_rtol;
-  // abs error
-  PetscReal eps_a = SolverSpecify::TS_atol;
-
   VecZeroEntries(xp);
   VecZeroEntries(LTE);
 
@@ -530,127 +476,26 @@ PetscReal DDM1Solver::LTE_norm()
     }
   }
 
-  int N=0; //total variable number for LTE evaluation
-  PetscReal r;
-
-
   // with LTE vector and relative & abs error, we get the error estimate here
-  PetscScalar    *xx, *ll;
-  VecGetArray(x, &xx);
-  VecGetArray(LTE, &ll);
-
-  // error estimate for each region
-  for(unsigned int n=0; n<_system.n_regions(); n++)
-  {
-    const SimulationRegion * region = _system.region(n);
-    switch ( region->type() )
-    {
-        case SemiconductorRegion :
-        {
-          SimulationRegion::const_processor_node_iterator it = region->on_processor_nodes_begin();
-          SimulationRegion::const_processor_node_iterator it_end = region->on_processor_nodes_end();
-          for(; it!=it_end; ++it)
-          {
-            const FVM_Node * fvm_node = *it;
-            unsigned int local_offset = fvm_node->local_offset();
-
-            ll[local_offset+0] = 0;
-            ll[local_offset+1] = std::abs(ll[local_offset+1])/(eps_r*std::abs(xx[local_offset+1])+eps_a);
-            ll[local_offset+2] = std::abs(ll[local_offset+2])/(eps_r*std::abs(xx[local_offset+2])+eps_a);
-            N += 2;
-          }
-          break;
-        }
-        case InsulatorRegion :
-        case ElectrodeRegion :
-        case MetalRegion :
-        {
-          SimulationRegion::const_processor_node_iterator it = region->on_processor_nodes_begin();
-          SimulationRegion::const_processor_node_iterator it_end = region->on_processor_nodes_end();
-          for(; it!=it_end; ++it)
-          {
-            const FVM_Node * fvm_node = *it;
-            unsigned int local_offset = fvm_node->local_offset();
-
-            ll[local_offset] = 0;
-          }
-          break;
-        }
-        case VacuumRegion:
-        break;
-        default:
-        genius_error();
-    }
-  }
-
-
-  // error estimate for each bc
-  if(Genius::is_last_processor())
-    for(unsigned int b=0; b<_system.get_bcs()->n_bcs(); b++)
-    {
-      const BoundaryCondition * bc = _system.get_bcs()->get_bc(b);
-      unsigned int array_offset = bc->array_offset();
-      if( array_offset != invalid_uint )
-        ll[array_offset] = 0;
-    }
-
-  VecRestoreArray(x, &xx);
-  VecRestoreArray(LTE, &ll);
-
-  VecNorm(LTE, NORM_2, &r);
-
-  //for parallel situation, we should sum N of all the processor
-  Parallel::sum( N );
-
-  if( N>0 )
-  {
-    r /= sqrt(static_cast<double>(N));
-    return r;
-  }
-
-  return 1.0;
-
+  return variable_LTE_norm();
 }
 
 
 
 void DDM1Solver::error_norm()
 {
-  PetscScalar    *xx;
-  PetscScalar    *ff;
-
-  // scatte global solution vector x to local vector lx
-  // this is not necessary since it had already done in function evaluation
-  //VecScatterBegin(scatter, x, lx, INSERT_VALUES, SCATTER_FORWARD);
-  //VecScatterEnd  (scatter, x, lx, INSERT_VALUES, SCATTER_FORWARD);
-
-  // scatte global function vector f to local vector lf
-  VecScatterBegin(scatter, f, lf, INSERT_VALUES, SCATTER_FORWARD);
-  VecScatterEnd  (scatter, f, lf, INSERT_VALUES, SCATTER_FORWARD);
-
-
-  VecGetArray(lx, &xx);  // solution value
-  VecGetArray(lf, &ff);  // function value
-
-  // do clear
-  potential_norm        = 0;
-  electron_norm         = 0;
-  hole_norm             = 0;
-  temperature_norm      = 0;
-  elec_temperature_norm = 0;
-  hole_temperature_norm = 0;
+  // x and f norm of each variable, electrode norm from bc rows
+  variable_error_norm(true);
+}
 
-  poisson_norm              = 0;
-  elec_continuity_norm      = 0;
-  hole_continuity_norm      = 0;
-  heat_equation_norm        = 0;
-  elec_energy_equation_norm = 0;
-  hole_energy_equation_norm = 0;
-  electrode_norm            = 0;
 
+/*------------------------------------------------------------------
+ * the local offsets of each variable for error norm and LTE
+ */
+void DDM1Solver::build_norm_index()
+{
   for(unsigned int n=0; n<_system.n_regions(); n++)
   {
-    // only consider semiconductor region
     const SimulationRegion * region = _system.region(n);
 
     SimulationRegion::const_processor_node_iterator it = region->on_processor_nodes_begin();
@@ -664,31 +509,19 @@ void DDM1Solver::error_norm()
       {
           case SemiconductorRegion :
           {
-            potential_norm += xx[offset+0]*xx[offset+0];
-            electron_norm  += xx[offset+1]*xx[offset+1];
-            hole_norm      += xx[offset+2]*xx[offset+2];
+            norm_index[NormPotential].push_back(offset+0);
+            norm_index[NormElectron].push_back(offset+1);
+            norm_index[NormHole].push_back(offset+2);
 
-            poisson_norm         += ff[offset+0]*ff[offset+0];
-            elec_continuity_norm += ff[offset+1]*ff[offset+1];
-            hole_continuity_norm += ff[offset+2]*ff[offset+2];
+            lte_index.push_back(offset+1);
+            lte_index.push_back(offset+2);
             break;
           }
           case InsulatorRegion :
-          {
-            potential_norm += xx[offset]*xx[offset];
-            poisson_norm   += ff[offset]*ff[offset];
-            break;
-          }
           case ElectrodeRegion :
-          {
-            potential_norm += xx[offset]*xx[offset];
-            poisson_norm   += ff[offset]*ff[offset];
-            break;
-          }
           case MetalRegion :
           {
-            potential_norm += xx[offset]*xx[offset];
-            poisson_norm   += ff[offset]*ff[offset];
+            norm_index[NormPotential].push_back(offset);
             break;
           }
           case VacuumRegion:
@@ -698,55 +531,6 @@ void DDM1Solver::error_norm()
       }
     }
   }
-
-  if(Genius::is_last_processor())
-  {
-    for(unsigned int b=0; b<_system.get_bcs()->n_bcs(); b++)
-    {
-      const BoundaryCondition * bc = _system.get_bcs()->get_bc(b);
-      unsigned int offset = bc->local_offset();
-      if( offset != invalid_uint )
-      {
-        potential_norm += xx[offset]*xx[offset];
-
-        PetscScalar scaling = 1.0;
-        if(bc->is_electrode())
-          scaling = bc->ext_circuit()->mna_scaling(SolverSpecify::dt);
-
-        electrode_norm += scaling*ff[offset]*scaling*ff[offset];
-      }
-    }
-  }
-
-
-  // sum of variable value on all processors
-  std::vector<PetscScalar> norm_buffer;
-
-  norm_buffer.push_back(potential_norm);
-  norm_buffer.push_back(electron_norm);
-  norm_buffer.push_back(hole_norm);
-
-  norm_buffer.push_back(poisson_norm);
-  norm_buffer.push_back(elec_continuity_norm);
-  norm_buffer.push_back(hole_continuity_norm);
-  norm_buffer.push_back(electrode_norm);
-
-  Parallel::sum(norm_buffer);
-
-  // sqrt to get L2 norm
-  potential_norm = sqrt(norm_buffer[0]);
-  electron_norm  = sqrt(norm_buffer[1]);
-  hole_norm      = sqrt(norm_buffer[2]);
-
-  poisson_norm         = sqrt(norm_buffer[3]);
-  elec_continuity_norm = sqrt(norm_buffer[4]);
-  hole_continuity_norm = sqrt(norm_buffer[5]);
-  electrode_norm       = sqrt(norm_buffer[6]);
-
-
-  VecRestoreArray(lx, &xx);
-  VecRestoreArray(lf, &ff);
-
 }
 
 
@@ -793,9 +577,8 @@ void DDM1Solver::build_petsc_sens_residual(Vec x, Vec r)
 
   START_LOG("DDM1Solver_Residual()", "DDM1Solver");
 
-  // scatte global solution vector x to local vector lx
-  VecScatterBegin(scatter, x, lx, INSERT_VALUES, SCATTER_FORWARD);
-  VecScatterEnd  (scatter, x, lx, INSERT_VALUES, SCATTER_FORWARD);
+  // scatte global solution vector x to local vector lx, the ghost entries are still in flight
+  scatter_lx_begin(x);
 
   PetscScalar *lxx;
   // get PetscScalar array contains solution from local solution vector lx
@@ -803,20 +586,14 @@ void DDM1Solver::build_petsc_sens_residual(Vec x, Vec r)
 
   // clear old data
   VecZeroEntries (r);
+  if(_fused_pass)
+    MatZeroEntries(J);
 
   // flag for indicate ADD_VALUES operator.
   InsertMode add_value_flag = NOT_SET_VALUES;
 
-  // evaluate governing equations of DDML1 in all the regions
-  for(unsigned int n=0; n<_system.n_regions(); n++)
-  {
-    SimulationRegion * region = _system.region(n);
-    region->DDM1_Function(lxx, r, add_value_flag);
-  }
-
-#if defined(HAVE_FENV_H) && defined(DEBUG)
-  genius_assert( !fetestexcept(FE_INVALID) );
-#endif
+  // the time derivative and pseudo time step terms only read the on processor node itself,
+  // evaluate them while the ghost entries are received
 
   // evaluate time derivative if necessary
   if(SolverSpecify::TimeDependent == true)
@@ -826,6 +603,19 @@ void DDM1Solver::build_petsc_sens_residual(Vec x, Vec r)
       region->DDM1_Time_Dependent_Function(lxx, r, add_value_flag);
     }
 
+  // time derivative of harmonic balance sample
+  if(_hb_dxdt != PETSC_NULL)
+  {
+    PetscScalar *ldxdt;
+    VecGetArray(_hb_dxdt, &ldxdt);
+    for(unsigned int n=0; n<_system.n_regions(); n++)
+    {
+      SimulationRegion * region = _system.region(n);
+      region->DDM1_HB_Time_Derivative_Function(ldxdt, r, add_value_flag);
+    }
+    VecRestoreArray(_hb_dxdt, &ldxdt);
+  }
+
 
   // evaluate pseudo time step if necessary
   if(SolverSpecify::Type == SolverSpecify::OP && SolverSpecify::PseudoTimeMethod == true)
@@ -835,6 +625,26 @@ void DDM1Solver::build_petsc_sens_residual(Vec x, Vec r)
       region->DDM1_Pseudo_Time_Step_Function(lxx, r, add_value_flag);
     }
 
+  // the edge terms below need ghost entries
+  scatter_lx_end(x);
+
+  // evaluate governing equations of DDML1 in all the regions
+  for(unsigned int n=0; n<_system.n_regions(); n++)
+  {
+    if( region_frozen(n) ) continue;
+    SimulationRegion * region = _system.region(n);
+    START_LOG("DDM1_Function(" + region->type_name() + ")", "DDM1Solver");
+    if(_fused_pass)
+      region->DDM1_Function_Jacobian(lxx, r, &J, add_value_flag);
+    else
+      region->DDM1_Function(lxx, r, add_value_flag);
+    STOP_LOG("DDM1_Function(" + region->type_name() + ")", "DDM1Solver");
+  }
+
+#if defined(HAVE_FENV_H) && defined(DEBUG)
+  genius_assert( !fetestexcept(FE_INVALID) );
+#endif
+
   // process hanging node here
   for(unsigned int n=0; n<_system.n_regions(); n++)
   {
@@ -863,7 +673,9 @@ void DDM1Solver::build_petsc_sens_residual(Vec x, Vec r)
   for(unsigned int b=0; b<_system.get_bcs()->n_bcs(); b++)
   {
     BoundaryCondition * bc = _system.get_bcs()->get_bc(b);
+    START_LOG("DDM1_Function(" + bc->bc_type_name() + ")", "DDM1Solver");
     bc->DDM1_Function(lxx, r, add_value_flag);
+    STOP_LOG("DDM1_Function(" + bc->bc_type_name() + ")", "DDM1Solver");
   }
 
 
@@ -890,6 +702,29 @@ void DDM1Solver::build_petsc_sens_residual(Vec x, Vec r)
 
 
 
+/*------------------------------------------------------------------
+ * evaluate the residual of function f and the Jacobian J at x,
+ * the region Jacobian is built by the AD pass of residual
+ */
+bool DDM1Solver::build_petsc_sens_residual_jacobian(Vec x, Vec r)
+{
+  // the first assembly reserves the nonzero pattern of boundaries, do it separately
+  if( !jacobian_matrix_first_assemble )
+  {
+    build_petsc_sens_residual(x, r);
+    return false;
+  }
+
+  _fused_pass = true;
+  build_petsc_sens_residual(x, r);
+  build_petsc_sens_jacobian(x, &J, &J);
+  _fused_pass = false;
+
+  return true;
+}
+
+
+
 /*------------------------------------------------------------------
  * evaluate the Jacobian J of function f at x
  */
@@ -898,26 +733,34 @@ void DDM1Solver::build_petsc_sens_jacobian(Vec x, Mat *, Mat *)
 
   START_LOG("DDM1Solver_Jacobian()", "DDM1Solver");
 
-  // scatte global solution vector x to local vector lx
-  VecScatterBegin(scatter, x, lx, INSERT_VALUES, SCATTER_FORWARD);
-  VecScatterEnd  (scatter, x, lx, INSERT_VALUES, SCATTER_FORWARD);
+  // scatte global solution vector x to local vector lx, the fused residual evaluation has done it
+  if(!_fused_pass)
+  {
+    VecScatterBegin(scatter, x, lx, INSERT_VALUES, SCATTER_FORWARD);
+    VecScatterEnd  (scatter, x, lx, INSERT_VALUES, SCATTER_FORWARD);
+  }
 
   PetscScalar *lxx;
   // get PetscScalar array contains solution from local solution vector lx
   VecGetArray(lx, &lxx);
 
-  MatZeroEntries(J);
+  if(!_fused_pass)
+    MatZeroEntries(J);
 
   START_LOG("DDM1Solver_Jacobian(R)", "DDM1Solver");
 
   // flag for indicate ADD_VALUES operator.
-  InsertMode add_value_flag = NOT_SET_VALUES;
+  InsertMode add_value_flag = _fused_pass ? ADD_VALUES : NOT_SET_VALUES;
 
-  // evaluate Jacobian matrix of governing equations of DDML1 in all the regions
-  for(unsigned int n=0; n<_system.n_regions(); n++)
+  // evaluate Jacobian matrix of governing equations of DDML1 in all the regions,
+  // they are already added by the fused residual evaluation
+  for(unsigned int n=0; n<_system.n_regions() && !_fused_pass; n++)
   {
+    if( region_frozen(n) ) continue;
     SimulationRegion * region = _system.region(n);
+    START_LOG("DDM1_Jacobian(" + region->type_name() + ")", "DDM1Solver");
     region->DDM1_Jacobian(lxx, &J, add_value_flag);
+    STOP_LOG("DDM1_Jacobian(" + region->type_name() + ")", "DDM1Solver");
   }
 
 
@@ -933,6 +776,14 @@ void DDM1Solver::build_petsc_sens_jacobian(Vec x, Mat *, Mat *)
       region->DDM1_Time_Dependent_Jacobian(lxx, &J, add_value_flag);
     }
 
+  // coefficient of harmonic balance time derivative
+  if(_hb_mass_jacobian)
+    for(unsigned int n=0; n<_system.n_regions(); n++)
+    {
+      SimulationRegion * region = _system.region(n);
+      region->DDM1_HB_Time_Derivative_Jacobian(&J, add_value_flag);
+    }
+
 
   // evaluate pseudo time step if necessary
   if(SolverSpecify::Type == SolverSpecify::OP && SolverSpecify::PseudoTimeMethod == true)
@@ -987,16 +838,16 @@ void DDM1Solver::build_petsc_sens_jacobian(Vec x, Mat *, Mat *)
     bc->DDM1_Jacobian_Preprocess(lxx, &J, src_row, dst_row, clear_row);
   }
 
-  //add source rows to destination rows
-  PetscUtils::MatAddRowToRow(J, src_row, dst_row);
-  // clear row
-  PetscUtils::MatZeroRows(J, clear_row.size(), clear_row.empty() ? NULL : &clear_row[0], 0.0);
+  //add source rows to destination rows, and clear rows
+  PetscUtils::MatAddClearRow(J, src_row, dst_row, clear_row);
 
   add_value_flag = NOT_SET_VALUES;
   for(unsigned int b=0; b<_system.get_bcs()->n_bcs(); b++)
   {
     BoundaryCondition * bc = _system.get_bcs()->get_bc(b);
+    START_LOG("DDM1_Jacobian(" + bc->bc_type_name() + ")", "DDM1Solver");
     bc->DDM1_Jacobian(lxx, &J, add_value_flag);
+    STOP_LOG("DDM1_Jacobian(" + bc->bc_type_name() + ")", "DDM1Solver");
   }
 
   STOP_LOG("DDM1Solver_Jacobian(B)", "DDM1Solver");
@@ -151,7 +151,6 @@ void GateContactBC::DDM1_Function(PetscScalar * x, Vec f, InsertMode &add_value_
           case InsulatorRegion:
           {
 
-            const FVM_NodeData * node_data = fvm_nodes[i]->node_data();
 
             // psi of this node
             PetscScalar V = x[fvm_nodes[i]->local_offset()];
@@ -163,37 +162,7 @@ void GateContactBC::DDM1_Function(PetscScalar * x, Vec f, InsertMode &add_value_
             VecSetValue(f, fvm_nodes[i]->global_offset(), f_psi, ADD_VALUES);
 
             // MOS gate can have displacement current and tunneling current
-
-            // displacement current
-            if(SolverSpecify::TimeDependent == true)
-            {
-              FVM_Node::fvm_neighbor_node_iterator nb_it = fvm_nodes[i]->neighbor_node_begin();
-              for(; nb_it != fvm_nodes[i]->neighbor_node_end(); ++nb_it)
-              {
-                const FVM_Node *nb_node = (*nb_it).first;
-                const FVM_NodeData * nb_node_data = nb_node->node_data();
-                // the psi of neighbor node
-                PetscScalar V_nb = x[nb_node->local_offset()+0];
-                // distance from nb node to this node
-                PetscScalar distance = (*(fvm_nodes[i]->root_node()) - *(nb_node->root_node())).size();
-                // area of out surface of control volume related with neighbor node
-                PetscScalar cv_boundary = fvm_nodes[i]->cv_surface_area(nb_node);
-                PetscScalar dEdt;
-                if(SolverSpecify::TS_type==SolverSpecify::BDF2 && SolverSpecify::BDF2_LowerOrder==false) //second order
-                {
-                  PetscScalar r = SolverSpecify::dt_last/(SolverSpecify::dt_last + SolverSpecify::dt);
-                  dEdt = ( (2-r)/(1-r)*(V-V_nb)
-                           - 1.0/(r*(1-r))*(node_data->psi()-nb_node_data->psi())
-                           + (1-r)/r*(node_data->psi_last()-nb_node_data->psi_last()))/distance/(SolverSpecify::dt_last+SolverSpecify::dt);
-                }
-                else//first order
-                {
-                  dEdt = ((V-V_nb)-(node_data->psi()-nb_node_data->psi()))/distance/SolverSpecify::dt;
-                }
-
-                current_buffer.push_back( cv_boundary*node_data->eps()*dEdt );
-              }
-            }
+            // displacement current is evaluated by the flux stencil after the loop
             // FIXME: tunneling current.
 
             break;
@@ -264,6 +233,10 @@ void GateContactBC::DDM1_Function(PetscScalar * x, Vec f, InsertMode &add_value_
   // NOTE: only statistic current flow belongs to on processor node
   PetscScalar current = current_scale*std::accumulate(current_buffer.begin(), current_buffer.end(), 0.0 );
 
+  // displacement current, by the precomputed flux stencil
+  if(SolverSpecify::TimeDependent == true)
+    current += current_scale*displacement_current(x, InsulatorRegion);
+
   ext_circuit()->potential() = Ve;
   ext_circuit()->current() = current;
 
@@ -482,6 +455,19 @@ void GateContactBC::DDM1_Jacobian(PetscScalar * x, Mat *jac, InsertMode &add_val
   // for 2D mesh, z_width() is the device dimension in Z direction; for 3D mesh, z_width() is 1.0
   PetscScalar current_scale = this->z_width();
 
+  // displacement current, by the precomputed flux stencil
+  if(SolverSpecify::TimeDependent == true)
+  {
+    PetscScalar bc_current_scale = current_scale;
+    //for inter connect electrode
+    if(this->is_inter_connect_bc())
+      bc_current_scale *= ext_circuit()->inter_connect_resistance();
+    // for stand alone electrode
+    else
+      bc_current_scale *= ext_circuit()->mna_scaling(SolverSpecify::dt);
+    displacement_current_jacobian(jac, bc_global_offset, bc_current_scale, InsulatorRegion);
+  }
+
 
   // loop again
   BoundaryCondition::const_node_iterator node_it = nodes_begin();
@@ -510,7 +496,6 @@ void GateContactBC::DDM1_Jacobian(PetscScalar * x, Mat *jac, InsertMode &add_val
           case InsulatorRegion:
           {
 
-            const FVM_NodeData * node_data = fvm_nodes[i]->node_data();
 
             //the indepedent variable number, we need 2 here.
             adtl::AutoDScalar::numdir=2;
@@ -534,68 +519,7 @@ void GateContactBC::DDM1_Jacobian(PetscScalar * x, Mat *jac, InsertMode &add_val
             // set Jacobian of governing equation ff
             MatSetValues(*jac, 1, &row[0], col.size(), &col[0], f_psi.getADValue(), ADD_VALUES);
 
-            /*
-             * process the Jacobian of current flow out of gate electrode
-             */
-
-            // compute displacement current
-
-            //the indepedent variable number, we need 2 here.
-            adtl::AutoDScalar::numdir=2;
-
-            // displacement current
-            if(SolverSpecify::TimeDependent == true)
-            {
-              FVM_Node::fvm_neighbor_node_iterator nb_it = fvm_nodes[i]->neighbor_node_begin();
-              for(; nb_it != fvm_nodes[i]->neighbor_node_end(); ++nb_it)
-              {
-                const FVM_Node *nb_node = (*nb_it).first;
-                const FVM_NodeData * nb_node_data = nb_node->node_data();
-
-                // the psi of this node
-                AutoDScalar  V = x[fvm_nodes[i]->local_offset()]; V.setADValue(0, 1.0);
-                // the psi of neighbor node
-                AutoDScalar V_nb = x[nb_node->local_offset()+0]; V_nb.setADValue(1, 1.0);
-
-                // distance from nb node to this node
-                PetscScalar distance = (*(fvm_nodes[i]->root_node()) - *(nb_node->root_node())).size();
-
-                // area of out surface of control volume related with neighbor node
-                PetscScalar cv_boundary = fvm_nodes[i]->cv_surface_area(nb_node);
-                AutoDScalar dEdt;
-                if(SolverSpecify::TS_type==SolverSpecify::BDF2 && SolverSpecify::BDF2_LowerOrder==false) //second order
-                {
-                  PetscScalar r = SolverSpecify::dt_last/(SolverSpecify::dt_last + SolverSpecify::dt);
-                  dEdt = ( (2-r)/(1-r)*(V-V_nb)
-                           - 1.0/(r*(1-r))*(node_data->psi()-nb_node_data->psi())
-                           + (1-r)/r*(node_data->psi_last()-nb_node_data->psi_last()))/distance/(SolverSpecify::dt_last+SolverSpecify::dt);
-                }
-                else//first order
-                {
-                  dEdt = ((V-V_nb)-(node_data->psi()-nb_node_data->psi()))/distance/SolverSpecify::dt;
-                }
-
-                AutoDScalar current_disp = cv_boundary*node_data->eps()*dEdt*current_scale;
-
-                // consider electrode connect
-
-                //for inter connect electrode
-                if(this->is_inter_connect_bc())
-                {
-                  PetscScalar R = ext_circuit()->inter_connect_resistance();
-                  current_disp = R*current_disp;
-                }
-                // for stand alone electrode
-                else
-                {
-                  PetscScalar mna_scaling = ext_circuit()->mna_scaling(SolverSpecify::dt);
-                  current_disp = mna_scaling*current_disp;
-                }
-
-                MatSetValue(*jac, bc_global_offset, fvm_nodes[i]->global_offset(), current_disp.getADValue(0), ADD_VALUES);
-                MatSetValue(*jac, bc_global_offset, nb_node->global_offset(), current_disp.getADValue(1), ADD_VALUES);
-              }
-            }
+            // the Jacobian of displacement current is set by the flux stencil after the loop
 
             //FIXME tunneling current should be considered here
 
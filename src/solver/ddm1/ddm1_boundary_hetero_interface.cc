@@ -43,27 +43,16 @@ using PhysicalUnit::e;
 void HeteroInterfaceBC::DDM1_Function_Preprocess(PetscScalar *, Vec f, std::vector<PetscInt> &src_row,
     std::vector<PetscInt> &dst_row, std::vector<PetscInt> &clear_row)
 {
-  // search for all the node with this boundary type
-  BoundaryCondition::const_node_iterator node_it = nodes_begin();
-  BoundaryCondition::const_node_iterator end_it = nodes_end();
-  for(; node_it!=end_it; ++node_it )
+  // search for all the on processor node with this boundary type
+  for(TableWalk node(*this); node.valid(); node.next() )
   {
-    // skip node not belongs to this processor
-    if( (*node_it)->processor_id()!=Genius::processor_id() ) continue;
+    // the first fvm_node is in semiconductor region
+    const FVM_Node * fvm_node0 = node[0].fvm_node;
 
-    // buffer for saving regions and fvm_nodes this *node_it involves
-    std::vector<const FVM_Node *> fvm_nodes;
-
-    // search all the fvm_node which has *node_it as root node, these fvm_nodes have the same location in geometry,
-    // but belong to different regions in logic.
-    BoundaryCondition::region_node_iterator  rnode_it     = region_node_begin(*node_it);
-    BoundaryCondition::region_node_iterator  end_rnode_it = region_node_end(*node_it);
-    for(unsigned int i=0 ; rnode_it!=end_rnode_it; ++i, ++rnode_it  )
+    for(unsigned int i=0; i<node.size(); ++i )
     {
-      const SimulationRegion * region = (*rnode_it).second.first;
-      const FVM_Node * fvm_node = (*rnode_it).second.second;
-
-      fvm_nodes.push_back( fvm_node );
+      const SimulationRegion * region = node[i].region;
+      const FVM_Node * fvm_node = node[i].fvm_node;
 
       // the first semiconductor region
       if(i==0) continue;
@@ -76,17 +65,17 @@ void HeteroInterfaceBC::DDM1_Function_Preprocess(PetscScalar *, Vec f, std::vect
           case SemiconductorRegion :
           {
               // record the source row and dst row
-            src_row.push_back(fvm_nodes[i]->global_offset()+0);
-            dst_row.push_back(fvm_nodes[0]->global_offset()+0);
-            clear_row.push_back(fvm_nodes[i]->global_offset()+0);
+            src_row.push_back(fvm_node->global_offset()+0);
+            dst_row.push_back(fvm_node0->global_offset()+0);
+            clear_row.push_back(fvm_node->global_offset()+0);
             break;
           }
           case InsulatorRegion:
           {
               // record the source row and dst row
-            src_row.push_back(fvm_nodes[i]->global_offset()+0);
-            dst_row.push_back(fvm_nodes[0]->global_offset()+0);
-            clear_row.push_back(fvm_nodes[i]->global_offset()+0);
+            src_row.push_back(fvm_node->global_offset()+0);
+            dst_row.push_back(fvm_node0->global_offset()+0);
+            clear_row.push_back(fvm_node->global_offset()+0);
             break;
           }
           default: genius_error();
@@ -126,15 +115,9 @@ void HeteroInterfaceBC::DDM1_Function(PetscScalar * x, Vec f, InsertMode &add_va
   std::vector<PetscInt> iy;
   std::vector<PetscScalar> y_new;
 
-  // search for all the node with this boundary type
-  BoundaryCondition::const_node_iterator node_it = nodes_begin();
-  BoundaryCondition::const_node_iterator end_it = nodes_end();
-
-  for(; node_it!=end_it; ++node_it )
+  // search for all the on processor node with this boundary type
+  for(TableWalk node(*this); node.valid(); node.next() )
   {
-    // skip node not belongs to this processor
-    if( (*node_it)->processor_id()!=Genius::processor_id() ) continue;
-
     // the variable for first region
     const FVM_Node * fvm_node0;
     PetscScalar V0;
@@ -143,15 +126,10 @@ void HeteroInterfaceBC::DDM1_Function(PetscScalar * x, Vec f, InsertMode &add_va
     Material::MaterialSemiconductor * mt0;
     PetscScalar Ec0,Ev0;
 
-    // search all the fvm_node which has *node_it as root node, these nodes are the same in geometry,
-    // but in different region.
-    BoundaryCondition::region_node_iterator  rnode_it     = region_node_begin(*node_it);
-    BoundaryCondition::region_node_iterator  end_rnode_it = region_node_end(*node_it);
-
-    for(unsigned int i=0 ; rnode_it!=end_rnode_it; ++i, ++rnode_it  )
+    for(unsigned int i=0; i<node.size(); ++i )
     {
-      const SimulationRegion * region = (*rnode_it).second.first;
-      const FVM_Node * fvm_node = (*rnode_it).second.second;
+      const SimulationRegion * region = node[i].region;
+      const FVM_Node * fvm_node = node[i].fvm_node;
 
       // the first semiconductor region
       if(i==0)
@@ -175,7 +153,7 @@ void HeteroInterfaceBC::DDM1_Function(PetscScalar * x, Vec f, InsertMode &add_va
           Ev0 = Ev0 + e*Vt*log(gamma_f(fabs(p0)/n0_data->Nv()));
         }
 
-        PetscScalar boundary_area = std::abs(fvm_node->outside_boundary_surface_area());
+        PetscScalar boundary_area = std::abs(node[i].area);
         VecSetValue(f, fvm_node->global_offset(), qf*boundary_area, ADD_VALUES);
       }
 
@@ -215,7 +193,7 @@ void HeteroInterfaceBC::DDM1_Function(PetscScalar * x, Vec f, InsertMode &add_va
               y_new.push_back(ff1);
 
               // area of out surface of control volume related with neighbor node
-              PetscScalar cv_boundary = fvm_node->outside_boundary_surface_area();
+              PetscScalar cv_boundary = node[i].area;
 
               // thermal emit current
               if(Ec0 > Ec)
@@ -303,28 +281,16 @@ void HeteroInterfaceBC::DDM1_Jacobian_Reserve(Mat *jac, InsertMode &add_value_fl
     MatAssemblyEnd(*jac, MAT_FLUSH_ASSEMBLY);
   }
 
-  // search for all the node with this boundary type
-  BoundaryCondition::const_node_iterator node_it = nodes_begin();
-  BoundaryCondition::const_node_iterator end_it = nodes_end();
-
-  for(; node_it!=end_it; ++node_it )
+  // search for all the on processor node with this boundary type
+  for(TableWalk node(*this); node.valid(); node.next() )
   {
-    // skip node not belongs to this processor
-    if( (*node_it)->processor_id()!=Genius::processor_id() ) continue;
+    // the first fvm_node is in semiconductor region
+    const FVM_Node * fvm_node0 = node[0].fvm_node;
 
-    // buffer for saving regions and fvm_nodes this *node_it involves
-    std::vector<const FVM_Node *> fvm_nodes;
-
-    // search all the fvm_node which has *node_it as root node, these fvm_nodes have the same location in geometry,
-    // but belong to different regions in logic.
-    BoundaryCondition::region_node_iterator  rnode_it     = region_node_begin(*node_it);
-    BoundaryCondition::region_node_iterator  end_rnode_it = region_node_end(*node_it);
-    for(unsigned int i=0 ; rnode_it!=end_rnode_it; ++i, ++rnode_it  )
+    for(unsigned int i=0; i<node.size(); ++i )
     {
-      const SimulationRegion * region = (*rnode_it).second.first;
-      const FVM_Node * fvm_node = (*rnode_it).second.second;
-
-      fvm_nodes.push_back( fvm_node );
+      const SimulationRegion * region = node[i].region;
+      const FVM_Node * fvm_node = node[i].fvm_node;
 
       // the first semiconductor region
       if(i==0)
@@ -342,16 +308,16 @@ void HeteroInterfaceBC::DDM1_Jacobian_Reserve(Mat *jac, InsertMode &add_value_fl
             {
               // reserve items for all the ghost nodes
               std::vector<int> rows, cols;
-              rows.push_back(fvm_nodes[0]->global_offset()+0);
-              rows.push_back(fvm_nodes[0]->global_offset()+1);
-              rows.push_back(fvm_nodes[0]->global_offset()+2);
+              rows.push_back(fvm_node0->global_offset()+0);
+              rows.push_back(fvm_node0->global_offset()+1);
+              rows.push_back(fvm_node0->global_offset()+2);
 
-              cols.push_back(fvm_nodes[i]->global_offset()+0);
-              cols.push_back(fvm_nodes[i]->global_offset()+1);
-              cols.push_back(fvm_nodes[i]->global_offset()+2);
+              cols.push_back(fvm_node->global_offset()+0);
+              cols.push_back(fvm_node->global_offset()+1);
+              cols.push_back(fvm_node->global_offset()+2);
 
-              FVM_Node::fvm_neighbor_node_iterator  nb_it = fvm_nodes[i]->neighbor_node_begin();
-              for(; nb_it != fvm_nodes[i]->neighbor_node_end(); ++nb_it)
+              FVM_Node::fvm_neighbor_node_iterator  nb_it = fvm_node->neighbor_node_begin();
+              for(; nb_it != fvm_node->neighbor_node_end(); ++nb_it)
               {
                 cols.push_back((*nb_it).first->global_offset()+0);
                 cols.push_back((*nb_it).first->global_offset()+1);
@@ -363,20 +329,20 @@ void HeteroInterfaceBC::DDM1_Jacobian_Reserve(Mat *jac, InsertMode &add_value_fl
               MatSetValues(*jac, rows.size(), &rows[0], cols.size(), &cols[0], &value[0], ADD_VALUES);
 
               // reserve for later operator
-              MatSetValue(*jac, fvm_nodes[i]->global_offset()+0, fvm_nodes[0]->global_offset()+0, 0, ADD_VALUES);
-              MatSetValue(*jac, fvm_nodes[i]->global_offset()+1, fvm_nodes[0]->global_offset()+1, 0, ADD_VALUES);
-              MatSetValue(*jac, fvm_nodes[i]->global_offset()+2, fvm_nodes[0]->global_offset()+2, 0, ADD_VALUES);
+              MatSetValue(*jac, fvm_node->global_offset()+0, fvm_node0->global_offset()+0, 0, ADD_VALUES);
+              MatSetValue(*jac, fvm_node->global_offset()+1, fvm_node0->global_offset()+1, 0, ADD_VALUES);
+              MatSetValue(*jac, fvm_node->global_offset()+2, fvm_node0->global_offset()+2, 0, ADD_VALUES);
               break;
             }
             case InsulatorRegion:
             {
               // reserve items for all the ghost nodes
               std::vector<int> rows, cols;
-              rows.push_back(fvm_nodes[0]->global_offset()+0);
-              cols.push_back(fvm_nodes[i]->global_offset()+0);
+              rows.push_back(fvm_node0->global_offset()+0);
+              cols.push_back(fvm_node->global_offset()+0);
 
-              FVM_Node::fvm_neighbor_node_iterator  nb_it = fvm_nodes[i]->neighbor_node_begin();
-              for(; nb_it != fvm_nodes[i]->neighbor_node_end(); ++nb_it)
+              FVM_Node::fvm_neighbor_node_iterator  nb_it = fvm_node->neighbor_node_begin();
+              for(; nb_it != fvm_node->neighbor_node_end(); ++nb_it)
               {
                 cols.push_back((*nb_it).first->global_offset()+0);
               }
@@ -385,7 +351,7 @@ void HeteroInterfaceBC::DDM1_Jacobian_Reserve(Mat *jac, InsertMode &add_value_fl
 
               MatSetValues(*jac, rows.size(), &rows[0], cols.size(), &cols[0], &value[0], ADD_VALUES);
 
-              MatSetValue(*jac, fvm_nodes[i]->global_offset()+0, fvm_nodes[0]->global_offset()+0, 0, ADD_VALUES);
+              MatSetValue(*jac, fvm_node->global_offset()+0, fvm_node0->global_offset()+0, 0, ADD_VALUES);
               break;
             }
             default: genius_error();
@@ -408,27 +374,16 @@ void HeteroInterfaceBC::DDM1_Jacobian_Reserve(Mat *jac, InsertMode &add_value_fl
 void HeteroInterfaceBC::DDM1_Jacobian_Preprocess(PetscScalar *, Mat *jac, std::vector<PetscInt> &src_row,
     std::vector<PetscInt> &dst_row, std::vector<PetscInt> &clear_row)
 {
-  // search for all the node with this boundary type
-  BoundaryCondition::const_node_iterator node_it = nodes_begin();
-  BoundaryCondition::const_node_iterator end_it = nodes_end();
-  for(; node_it!=end_it; ++node_it )
+  // search for all the on processor node with this boundary type
+  for(TableWalk node(*this); node.valid(); node.next() )
   {
-    // skip node not belongs to this processor
-    if( (*node_it)->processor_id()!=Genius::processor_id() ) continue;
+    // the first fvm_node is in semiconductor region
+    const FVM_Node * fvm_node0 = node[0].fvm_node;
 
-    // buffer for saving regions and fvm_nodes this *node_it involves
-    std::vector<const FVM_Node *> fvm_nodes;
-
-    // search all the fvm_node which has *node_it as root node, these fvm_nodes have the same location in geometry,
-    // but belong to different regions in logic.
-    BoundaryCondition::region_node_iterator  rnode_it     = region_node_begin(*node_it);
-    BoundaryCondition::region_node_iterator  end_rnode_it = region_node_end(*node_it);
-    for(unsigned int i=0 ; rnode_it!=end_rnode_it; ++i, ++rnode_it  )
+    for(unsigned int i=0; i<node.size(); ++i )
     {
-      const SimulationRegion * region = (*rnode_it).second.first;
-      const FVM_Node * fvm_node = (*rnode_it).second.second;
-
-      fvm_nodes.push_back( fvm_node );
+      const SimulationRegion * region = node[i].region;
+      const FVM_Node * fvm_node = node[i].fvm_node;
 
       // the first semiconductor region
       if(i==0) continue;
@@ -441,17 +396,17 @@ void HeteroInterfaceBC::DDM1_Jacobian_Preprocess(PetscScalar *, Mat *jac, std::v
             case SemiconductorRegion :
             {
               // record the source row and dst row
-              src_row.push_back(fvm_nodes[i]->global_offset()+0);
-              dst_row.push_back(fvm_nodes[0]->global_offset()+0);
-              clear_row.push_back(fvm_nodes[i]->global_offset()+0);
+              src_row.push_back(fvm_node->global_offset()+0);
+              dst_row.push_back(fvm_node0->global_offset()+0);
+              clear_row.push_back(fvm_node->global_offset()+0);
               break;
             }
             case InsulatorRegion:
             {
               // record the source row and dst row
-              src_row.push_back(fvm_nodes[i]->global_offset()+0);
-              dst_row.push_back(fvm_nodes[0]->global_offset()+0);
-              clear_row.push_back(fvm_nodes[i]->global_offset()+0);
+              src_row.push_back(fvm_node->global_offset()+0);
+              dst_row.push_back(fvm_node0->global_offset()+0);
+              clear_row.push_back(fvm_node->global_offset()+0);
               break;
             }
             default: genius_error();
@@ -483,13 +438,9 @@ void HeteroInterfaceBC::DDM1_Jacobian(PetscScalar * x, Mat *jac, InsertMode &add
   adtl::AutoDScalar::numdir=6;
 
   // after that, set values to source rows
-  BoundaryCondition::const_node_iterator node_it = nodes_begin();
-  BoundaryCondition::const_node_iterator end_it = nodes_end();
-  for(; node_it!=end_it; ++node_it )
+  // search for all the on processor node with this boundary type
+  for(TableWalk node(*this); node.valid(); node.next() )
   {
-    // skip node not belongs to this processor
-    if( (*node_it)->processor_id()!=Genius::processor_id() ) continue;
-
     // the variable for first region
     const FVM_Node * fvm_node0;
     AutoDScalar V0;
@@ -498,15 +449,10 @@ void HeteroInterfaceBC::DDM1_Jacobian(PetscScalar * x, Mat *jac, InsertMode &add
     Material::MaterialSemiconductor * mt0;
     AutoDScalar Ec0,Ev0;
 
-    // search all the fvm_node which has *node_it as root node, these nodes are the same in geometry,
-    // but in different region.
-    BoundaryCondition::region_node_iterator  rnode_it     = region_node_begin(*node_it);
-    BoundaryCondition::region_node_iterator  end_rnode_it = region_node_end(*node_it);
-
-    for(unsigned int i=0; rnode_it!=end_rnode_it; ++i, ++rnode_it  )
+    for(unsigned int i=0; i<node.size(); ++i )
     {
-      const SimulationRegion * region = (*rnode_it).second.first;
-      const FVM_Node * fvm_node = (*rnode_it).second.second;
+      const SimulationRegion * region = node[i].region;
+      const FVM_Node * fvm_node = node[i].fvm_node;
 
       // the first semiconductor region
       if(i==0)
@@ -574,7 +520,7 @@ void HeteroInterfaceBC::DDM1_Jacobian(PetscScalar * x, Mat *jac, InsertMode &add
               MatSetValues(*jac, 1, &rows[3], cols.size(), &cols[0], ff1.getADValue(), ADD_VALUES);
 
               // area of out surface of control volume related with neighbor node
-              PetscScalar cv_boundary = fvm_node->outside_boundary_surface_area();
+              PetscScalar cv_boundary = node[i].area;
 
               // thermal emit current
               if(Ec0 > Ec)
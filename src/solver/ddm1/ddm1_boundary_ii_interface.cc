@@ -43,25 +43,14 @@ using PhysicalUnit::e;
 void InsulatorInsulatorInterfaceBC::DDM1_Function_Preprocess(PetscScalar *, Vec f, std::vector<PetscInt> &src_row,
     std::vector<PetscInt> &dst_row, std::vector<PetscInt> &clear_row)
 {
-  // search for all the node with this boundary type
-  BoundaryCondition::const_node_iterator node_it = nodes_begin();
-  BoundaryCondition::const_node_iterator end_it = nodes_end();
-
-  for(; node_it!=end_it; ++node_it )
+  // search for all the on processor node with this boundary type
+  for(TableWalk node(*this); node.valid(); node.next() )
   {
-
-    // skip node not belongs to this processor
-    if( (*node_it)->processor_id()!=Genius::processor_id() ) continue;
-
     const FVM_Node * first_node;
 
-    // search all the fvm_node which has *node_it as root node, these fvm_nodes have the same location in geometry,
-    // but belong to different regions in logic.
-    BoundaryCondition::region_node_iterator  rnode_it     = region_node_begin(*node_it);
-    BoundaryCondition::region_node_iterator  end_rnode_it = region_node_end(*node_it);
-    for(unsigned int i=0 ; rnode_it!=end_rnode_it; ++i, ++rnode_it  )
+    for(unsigned int i=0; i<node.size(); ++i )
     {
-      const FVM_Node * fvm_node = (*rnode_it).second.second;
+      const FVM_Node * fvm_node = node[i].fvm_node;
 
       // the first insulator region
       if(i==0)
@@ -101,33 +90,17 @@ void InsulatorInsulatorInterfaceBC::DDM1_Function(PetscScalar * x, Vec f, Insert
   // buffer for Vec value
   std::vector<PetscScalar> y_new;
 
-  // search for all the node with this boundary type
-  BoundaryCondition::const_node_iterator node_it = nodes_begin();
-  BoundaryCondition::const_node_iterator end_it = nodes_end();
-  for(; node_it!=end_it; ++node_it )
+  // search for all the on processor node with this boundary type
+  for(TableWalk node(*this); node.valid(); node.next() )
   {
+    // the fvm_node of the first region
+    const FVM_Node * fvm_node0 = node[0].fvm_node;
 
-    // skip node not belongs to this processor
-    if( (*node_it)->processor_id()!=Genius::processor_id() ) continue;
-
-    // buffer for saving regions and fvm_nodes this *node_it involves
-    std::vector<const SimulationRegion *> regions;
-    std::vector<const FVM_Node *> fvm_nodes;
-
-    // search all the fvm_node which has *node_it as root node, these fvm_nodes have the same location in geometry,
-    // but belong to different regions in logic.
-    BoundaryCondition::region_node_iterator  rnode_it     = region_node_begin(*node_it);
-    BoundaryCondition::region_node_iterator  end_rnode_it = region_node_end(*node_it);
-
-    for(unsigned int i=0 ; rnode_it!=end_rnode_it; ++i, ++rnode_it  )
+    for(unsigned int i=0; i<node.size(); ++i )
     {
-      const SimulationRegion * region = (*rnode_it).second.first;
-      const FVM_Node * fvm_node = (*rnode_it).second.second;
+      const FVM_Node * fvm_node = node[i].fvm_node;
       if(!fvm_node->is_valid()) continue;
 
-      regions.push_back( region );
-      fvm_nodes.push_back( fvm_node );
-
       // we may have several regions with insulator material
 
       // the first insulator region
@@ -139,15 +112,15 @@ void InsulatorInsulatorInterfaceBC::DDM1_Function(PetscScalar * x, Vec f, Insert
       // other insulator regions
       else
       {
-        iy.push_back(fvm_nodes[i]->global_offset());
+        iy.push_back(fvm_node->global_offset());
 
         // the governing equation of this fvm node --
 
         // psi of this node
-        PetscScalar V = x[fvm_nodes[i]->local_offset()];
+        PetscScalar V = x[fvm_node->local_offset()];
 
         // psi for ghost node
-        PetscScalar V_in = x[fvm_nodes[0]->local_offset()];
+        PetscScalar V_in = x[fvm_node0->local_offset()];
 
         // the psi of this node is equal to corresponding psi of  node in the first insulator region
         // since psi should be continuous for the interface
@@ -186,45 +159,30 @@ void InsulatorInsulatorInterfaceBC::DDM1_Jacobian_Reserve(Mat *jac, InsertMode &
     MatAssemblyEnd(*jac, MAT_FLUSH_ASSEMBLY);
   }
 
-  // search for all the node with this boundary type
-  BoundaryCondition::const_node_iterator node_it = nodes_begin();
-  BoundaryCondition::const_node_iterator end_it = nodes_end();
-
-  for(; node_it!=end_it; ++node_it )
+  // search for all the on processor node with this boundary type
+  for(TableWalk node(*this); node.valid(); node.next() )
   {
-    // skip node not belongs to this processor
-    if( (*node_it)->processor_id()!=Genius::processor_id() ) continue;
-
-    // buffer for saving regions and fvm_nodes this *node_it involves
-    std::vector<const SimulationRegion *> regions;
-    std::vector<const FVM_Node *> fvm_nodes;
-
-    // search all the fvm_node which has *node_it as root node, these fvm_nodes have the same location in geometry,
-    // but belong to different regions in logic.
-    BoundaryCondition::region_node_iterator  rnode_it     = region_node_begin(*node_it);
-    BoundaryCondition::region_node_iterator  end_rnode_it = region_node_end(*node_it);
-    for(unsigned int i=0 ; rnode_it!=end_rnode_it; ++i, ++rnode_it  )
+    // the fvm_node of the first region
+    const FVM_Node * fvm_node0 = node[0].fvm_node;
+
+    for(unsigned int i=0; i<node.size(); ++i )
     {
-      const SimulationRegion * region = (*rnode_it).second.first;
-      const FVM_Node * fvm_node = (*rnode_it).second.second;
+      const FVM_Node * fvm_node = node[i].fvm_node;
       genius_assert(fvm_node->is_valid());
 
-      regions.push_back( region );
-      fvm_nodes.push_back( fvm_node );
-
       // the first insulator region
       if(i==0)
       {
         // reserve items for all the ghost nodes
-        FVM_Node::fvm_ghost_node_iterator gn_it = fvm_nodes[i]->ghost_node_begin();
-        for(; gn_it != fvm_nodes[i]->ghost_node_end(); ++gn_it)
+        FVM_Node::fvm_ghost_node_iterator gn_it = fvm_node->ghost_node_begin();
+        for(; gn_it != fvm_node->ghost_node_end(); ++gn_it)
         {
           const FVM_Node * ghost_fvm_node = (*gn_it).first;
-          MatSetValue(*jac, fvm_nodes[i]->global_offset(), ghost_fvm_node->global_offset(), 0, ADD_VALUES);
+          MatSetValue(*jac, fvm_node->global_offset(), ghost_fvm_node->global_offset(), 0, ADD_VALUES);
 
           FVM_Node::fvm_neighbor_node_iterator  gnb_it = ghost_fvm_node->neighbor_node_begin();
           for(; gnb_it != ghost_fvm_node->neighbor_node_end(); ++gnb_it)
-            MatSetValue(*jac, fvm_nodes[i]->global_offset(), (*gnb_it).first->global_offset(), 0, ADD_VALUES);
+            MatSetValue(*jac, fvm_node->global_offset(), (*gnb_it).first->global_offset(), 0, ADD_VALUES);
         }
       }
 
@@ -232,7 +190,7 @@ void InsulatorInsulatorInterfaceBC::DDM1_Jacobian_Reserve(Mat *jac, InsertMode &
       else
       {
         // reserve for later operator
-        MatSetValue(*jac, fvm_nodes[i]->global_offset(), fvm_nodes[0]->global_offset(), 0, ADD_VALUES);
+        MatSetValue(*jac, fvm_node->global_offset(), fvm_node0->global_offset(), 0, ADD_VALUES);
       }
     }
 
@@ -251,25 +209,14 @@ void InsulatorInsulatorInterfaceBC::DDM1_Jacobian_Reserve(Mat *jac, InsertMode &
 void InsulatorInsulatorInterfaceBC::DDM1_Jacobian_Preprocess(PetscScalar *, Mat *jac, std::vector<PetscInt> &src_row,
     std::vector<PetscInt> &dst_row, std::vector<PetscInt> &clear_row)
 {
-  // search for all the node with this boundary type
-  BoundaryCondition::const_node_iterator node_it = nodes_begin();
-  BoundaryCondition::const_node_iterator end_it = nodes_end();
-
-  for(; node_it!=end_it; ++node_it )
+  // search for all the on processor node with this boundary type
+  for(TableWalk node(*this); node.valid(); node.next() )
   {
-
-    // skip node not belongs to this processor
-    if( (*node_it)->processor_id()!=Genius::processor_id() ) continue;
-
     const FVM_Node * first_node;
 
-    // search all the fvm_node which has *node_it as root node, these fvm_nodes have the same location in geometry,
-    // but belong to different regions in logic.
-    BoundaryCondition::region_node_iterator  rnode_it     = region_node_begin(*node_it);
-    BoundaryCondition::region_node_iterator  end_rnode_it = region_node_end(*node_it);
-    for(unsigned int i=0 ; rnode_it!=end_rnode_it; ++i, ++rnode_it  )
+    for(unsigned int i=0; i<node.size(); ++i )
     {
-      const FVM_Node * fvm_node = (*rnode_it).second.second;
+      const FVM_Node * fvm_node = node[i].fvm_node;
 
       // the first insulator region
       if(i==0)
@@ -304,31 +251,17 @@ void InsulatorInsulatorInterfaceBC::DDM1_Jacobian(PetscScalar * x, Mat *jac, Ins
   }
 
 
-  BoundaryCondition::const_node_iterator node_it = nodes_begin();
-  BoundaryCondition::const_node_iterator end_it = nodes_end();
-  for(node_it = nodes_begin(); node_it!=end_it; ++node_it )
+  // search for all the on processor node with this boundary type
+  for(TableWalk node(*this); node.valid(); node.next() )
   {
-    // skip node not belongs to this processor
-    if( (*node_it)->processor_id()!=Genius::processor_id() ) continue;
-
-    // buffer for saving regions and fvm_nodes this *node_it involves
-    std::vector<const SimulationRegion *> regions;
-    std::vector<const FVM_Node *> fvm_nodes;
-
-    // search all the fvm_node which has *node_it as root node, these fvm_nodes have the same location in geometry,
-    // but belong to different regions in logic.
-    BoundaryCondition::region_node_iterator  rnode_it     = region_node_begin(*node_it);
-    BoundaryCondition::region_node_iterator  end_rnode_it = region_node_end(*node_it);
-    for(unsigned int i=0 ; rnode_it!=end_rnode_it; ++i, ++rnode_it  )
+    // the fvm_node of the first region
+    const FVM_Node * fvm_node0 = node[0].fvm_node;
+
+    for(unsigned int i=0; i<node.size(); ++i )
     {
-      const SimulationRegion * region = (*rnode_it).second.first;
-      const FVM_Node * fvm_node = (*rnode_it).second.second;
+      const FVM_Node * fvm_node = node[i].fvm_node;
       if(!fvm_node->is_valid()) continue;
 
-      regions.push_back( region );
-      fvm_nodes.push_back( fvm_node );
-
-
       // the first insulator region
       if(i==0) continue;
 
@@ -340,17 +273,17 @@ void InsulatorInsulatorInterfaceBC::DDM1_Jacobian(PetscScalar * x, Mat *jac, Ins
         adtl::AutoDScalar::numdir=2;
 
         // psi of this node
-        AutoDScalar  V    = x[fvm_nodes[i]->local_offset()]; V.setADValue(0,1.0);
+        AutoDScalar  V    = x[fvm_node->local_offset()]; V.setADValue(0,1.0);
 
         // psi for ghost node
-        AutoDScalar  V_in = x[fvm_nodes[0]->local_offset()]; V_in.setADValue(1,1.0);
+        AutoDScalar  V_in = x[fvm_node0->local_offset()]; V_in.setADValue(1,1.0);
 
         // the psi of this node is equal to corresponding psi of insulator node int the other region
         AutoDScalar  ff = V - V_in;
 
         // set Jacobian of governing equation ff
-        MatSetValue(*jac, fvm_nodes[i]->global_offset(), fvm_nodes[i]->global_offset(), ff.getADValue(0), ADD_VALUES);
-        MatSetValue(*jac, fvm_nodes[i]->global_offset(), fvm_nodes[0]->global_offset(), ff.getADValue(1), ADD_VALUES);
+        MatSetValue(*jac, fvm_node->global_offset(), fvm_node->global_offset(), ff.getADValue(0), ADD_VALUES);
+        MatSetValue(*jac, fvm_node->global_offset(), fvm_node0->global_offset(), ff.getADValue(1), ADD_VALUES);
 
       }
 
@@ -44,23 +44,14 @@ using PhysicalUnit::C;
  */
 void InsulatorSemiconductorInterfaceBC::DDM1_Fill_Value(Vec , Vec L)
 {
-  BoundaryCondition::const_node_iterator node_it = nodes_begin();
-  BoundaryCondition::const_node_iterator end_it = nodes_end();
-  for(; node_it!=end_it; ++node_it )
+  for(TableWalk node(*this); node.valid(); node.next() )
   {
-    // skip node not belongs to this processor
-    if( (*node_it)->processor_id()!=Genius::processor_id() ) continue;
-
-    // search all the fvm_node which has *node_it as root node, these fvm_nodes have the same location in geometry,
-    // but belong to different regions in logic.
-    BoundaryCondition::region_node_iterator  rnode_it     = region_node_begin(*node_it);
-    BoundaryCondition::region_node_iterator  end_rnode_it = region_node_end(*node_it);
-    for(unsigned int i=0 ; rnode_it!=end_rnode_it; ++i, ++rnode_it  )
+    for(unsigned int i=0; i<node.size(); ++i )
     {
-      const SimulationRegion * region = (*rnode_it).second.first;
+      const SimulationRegion * region = node[i].region;
       if( region->type() != InsulatorRegion ) continue;
 
-      const FVM_Node * fvm_node = (*rnode_it).second.second;
+      const FVM_Node * fvm_node = node[i].fvm_node;
       VecSetValue(L, fvm_node->global_offset(), 1.0, INSERT_VALUES);
     }
   }
@@ -77,28 +68,17 @@ void InsulatorSemiconductorInterfaceBC::DDM1_Function_Preprocess(PetscScalar *,
     std::vector<PetscInt> &dst_row, std::vector<PetscInt> &clear_row)
 {
 
-  // search for all the node with this boundary type
-  BoundaryCondition::const_node_iterator node_it = nodes_begin();
-  BoundaryCondition::const_node_iterator end_it = nodes_end();
-  for(; node_it!=end_it; ++node_it )
+  // search for all the on processor node with this boundary type
+  for(TableWalk node(*this); node.valid(); node.next() )
   {
-    // skip node not belongs to this processor
-    if( (*node_it)->processor_id()!=Genius::processor_id() ) continue;
-
-    // buffer for saving regions and fvm_nodes this *node_it involves
-    std::vector<const SimulationRegion *> regions;
-    std::vector<const FVM_Node *> fvm_nodes;
-
-    // search all the fvm_node which has *node_it as root node, these fvm_nodes have the same location in geometry,
-    // but belong to different regions in logic.
-    BoundaryCondition::region_node_iterator  rnode_it     = region_node_begin(*node_it);
-    BoundaryCondition::region_node_iterator  end_rnode_it = region_node_end(*node_it);
-    for(unsigned int i=0 ; rnode_it!=end_rnode_it; ++i, ++rnode_it  )
+    // the first fvm_node is in semiconductor region
+    const FVM_Node * fvm_node0 = node[0].fvm_node;
+
+    for(unsigned int i=0; i<node.size(); ++i )
     {
-      regions.push_back( (*rnode_it).second.first );
-      fvm_nodes.push_back( (*rnode_it).second.second );
+      const FVM_Node * fvm_node = node[i].fvm_node;
 
-      switch ( regions[i]->type() )
+      switch ( node[i].region->type() )
       {
           // Insulator-Semiconductor interface at Semiconductor side, do nothing
           case SemiconductorRegion:  break;
@@ -107,9 +87,9 @@ void InsulatorSemiconductorInterfaceBC::DDM1_Function_Preprocess(PetscScalar *,
           case InsulatorRegion:
           {
             // record the source row and dst row
-            src_row.push_back(fvm_nodes[i]->global_offset());
-            dst_row.push_back(fvm_nodes[0]->global_offset());
-            clear_row.push_back(fvm_nodes[i]->global_offset());
+            src_row.push_back(fvm_node->global_offset());
+            dst_row.push_back(fvm_node0->global_offset());
+            clear_row.push_back(fvm_node->global_offset());
             break;
           }
           case VacuumRegion:
@@ -155,21 +135,14 @@ void InsulatorSemiconductorInterfaceBC::DDM1_Function(PetscScalar * x, Vec f, In
 
   const PetscScalar qf = this->scalar("qf");
 
-  // search for all the node with this boundary type
-  BoundaryCondition::const_node_iterator node_it = nodes_begin();
-  BoundaryCondition::const_node_iterator end_it = nodes_end();
-  for(; node_it!=end_it; ++node_it )
+  // search for all the on processor node with this boundary type
+  for(TableWalk node(*this); node.valid(); node.next() )
   {
-
-    // skip node not belongs to this processor
-    if( (*node_it)->processor_id()!=Genius::processor_id() ) continue;
-
-
-    const FVM_Node * semiconductor_node  = get_region_fvm_node ( ( *node_it ), _r1 );
+    const RegionNodeEntry * semiconductor_entry = node.first();
+    const FVM_Node * semiconductor_node  = semiconductor_entry->fvm_node;
     const FVM_NodeData * semiconductor_node_data = semiconductor_node->node_data();
 
-    const FVM_Node * insulator_node = get_region_fvm_node ( ( *node_it ), _r2 );
-    const FVM_NodeData * insulator_node_data = insulator_node->node_data();
+    const FVM_Node * insulator_node = node.second()->fvm_node;
 
     // Insulator-Semiconductor interface at Semiconductor side, do nothing
 
@@ -179,7 +152,7 @@ void InsulatorSemiconductorInterfaceBC::DDM1_Function(PetscScalar * x, Vec f, In
 
 
     // process interface fixed charge density
-    PetscScalar boundary_area = std::abs(semiconductor_node->outside_boundary_surface_area());
+    PetscScalar boundary_area = std::abs(semiconductor_entry->area);
     VecSetValue(f, semiconductor_node->global_offset(), qf*boundary_area, ADD_VALUES);
 
     {
@@ -195,7 +168,9 @@ void InsulatorSemiconductorInterfaceBC::DDM1_Function(PetscScalar * x, Vec f, In
     {
       // calculate interface trap occupancy
       PetscScalar ni = semiconductor_region->material()->band->nie(p, n, T);
-      semiconductor_region->material()->trap->Calculate(false,p,n,ni,T);
+      // trap occupancy is frozen between steps when advanced explicitly
+      if (!semiconductor_region->get_advanced_model()->TrapExplicit)
+        semiconductor_region->material()->trap->Calculate(false,p,n,ni,T);
 
       // contribution of trapped charge to Poisson's eqn
       PetscScalar TrappedC = semiconductor_region->material()->trap->Charge(false) * boundary_area;
@@ -258,29 +233,17 @@ void InsulatorSemiconductorInterfaceBC::DDM1_Jacobian_Reserve(Mat *jac, InsertMo
     MatAssemblyEnd(*jac, MAT_FLUSH_ASSEMBLY);
   }
 
-  // search for all the node with this boundary type
-  BoundaryCondition::const_node_iterator node_it = nodes_begin();
-  BoundaryCondition::const_node_iterator end_it = nodes_end();
-
-  for(; node_it!=end_it; ++node_it )
+  // search for all the on processor node with this boundary type
+  for(TableWalk node(*this); node.valid(); node.next() )
   {
-    // skip node not belongs to this processor
-    if( (*node_it)->processor_id()!=Genius::processor_id() ) continue;
-
-    // buffer for saving regions and fvm_nodes this *node_it involves
-    std::vector<const SimulationRegion *> regions;
-    std::vector<const FVM_Node *> fvm_nodes;
-
-    // search all the fvm_node which has *node_it as root node, these fvm_nodes have the same location in geometry,
-    // but belong to different regions in logic.
-    BoundaryCondition::region_node_iterator  rnode_it     = region_node_begin(*node_it);
-    BoundaryCondition::region_node_iterator  end_rnode_it = region_node_end(*node_it);
-    for(unsigned int i=0 ; rnode_it!=end_rnode_it; ++i, ++rnode_it  )
+    // the first fvm_node is in semiconductor region
+    const FVM_Node * fvm_node0 = node[0].fvm_node;
+
+    for(unsigned int i=0; i<node.size(); ++i )
     {
-      regions.push_back( (*rnode_it).second.first );
-      fvm_nodes.push_back( (*rnode_it).second.second );
+      const FVM_Node * fvm_node = node[i].fvm_node;
 
-      switch ( regions[i]->type() )
+      switch ( node[i].region->type() )
       {
           // Insulator-Semiconductor interface at Semiconductor side, we should reserve entrance for later add operator
           case SemiconductorRegion:
@@ -288,14 +251,13 @@ void InsulatorSemiconductorInterfaceBC::DDM1_Jacobian_Reserve(Mat *jac, InsertMo
             // semiconductor region should be the first region
             genius_assert(i==0);
 
-            // since we know only one ghost node exit, there is ghost_node_begin()
-            FVM_Node::fvm_ghost_node_iterator gn_it = fvm_nodes[i]->ghost_node_begin();
-            const FVM_Node * ghost_fvm_node = (*gn_it).first;
-            MatSetValue(*jac, fvm_nodes[i]->global_offset(), ghost_fvm_node->global_offset(), 0, ADD_VALUES);
+            // since we know only one ghost node exit, it is the ghost node of table entry
+            const FVM_Node * ghost_fvm_node = node[i].ghost_node;
+            MatSetValue(*jac, fvm_node->global_offset(), ghost_fvm_node->global_offset(), 0, ADD_VALUES);
 
             FVM_Node::fvm_neighbor_node_iterator  gnb_it = ghost_fvm_node->neighbor_node_begin();
             for(; gnb_it != ghost_fvm_node->neighbor_node_end(); ++gnb_it)
-              MatSetValue(*jac, fvm_nodes[i]->global_offset(), (*gnb_it).first->global_offset(), 0, ADD_VALUES);
+              MatSetValue(*jac, fvm_node->global_offset(), (*gnb_it).first->global_offset(), 0, ADD_VALUES);
 
             break;
           }
@@ -304,7 +266,7 @@ void InsulatorSemiconductorInterfaceBC::DDM1_Jacobian_Reserve(Mat *jac, InsertMo
           case InsulatorRegion:
           {
             // reserve for later operator
-            MatSetValue(*jac, fvm_nodes[i]->global_offset(), fvm_nodes[0]->global_offset(), 0, ADD_VALUES);
+            MatSetValue(*jac, fvm_node->global_offset(), fvm_node0->global_offset(), 0, ADD_VALUES);
 
             break;
           }
@@ -329,25 +291,16 @@ void InsulatorSemiconductorInterfaceBC::DDM1_Jacobian_Reserve(Mat *jac, InsertMo
 void InsulatorSemiconductorInterfaceBC::DDM1_Jacobian_Preprocess(PetscScalar *, Mat *jac, std::vector<PetscInt> &src_row,
     std::vector<PetscInt> &dst_row, std::vector<PetscInt> &clear_row)
 {
-  const SimulationRegion * _r1 = bc_regions().first;
-  const SimulationRegion * _r2 = bc_regions().second;
-
-  // search for all the node with this boundary type
-  BoundaryCondition::const_node_iterator node_it = nodes_begin();
-  BoundaryCondition::const_node_iterator end_it = nodes_end();
-  for(; node_it!=end_it; ++node_it )
+  // search for all the on processor node with this boundary type
+  for(TableWalk node(*this); node.valid(); node.next() )
   {
-    // skip node not belongs to this processor
-    if( (*node_it)->processor_id()!=Genius::processor_id() ) continue;
-
-    const FVM_Node * semiconductor_node  = get_region_fvm_node ( ( *node_it ), _r1 );
-    const FVM_Node * insulator_node = get_region_fvm_node ( ( *node_it ), _r2 );
+    const FVM_Node * semiconductor_node  = node.first()->fvm_node;
+    const FVM_Node * insulator_node = node.second()->fvm_node;
 
     // record the source row and dst row
     src_row.push_back(insulator_node->global_offset());
 
     // find the position matrix row will be add to
-    // since we know only one ghost node exit, there is ghost_node_begin()
     dst_row.push_back(semiconductor_node->global_offset());
 
     clear_row.push_back(insulator_node->global_offset());
@@ -380,25 +333,20 @@ void InsulatorSemiconductorInterfaceBC::DDM1_Jacobian(PetscScalar * x, Mat *jac,
   adtl::AutoDScalar::numdir = 3;
 
   // after that, set values to source rows
-  BoundaryCondition::const_node_iterator node_it = nodes_begin();
-  BoundaryCondition::const_node_iterator end_it = nodes_end();
-  for(node_it = nodes_begin(); node_it!=end_it; ++node_it )
+  for(TableWalk node(*this); node.valid(); node.next() )
   {
-    // skip node not belongs to this processor
-    if( (*node_it)->processor_id()!=Genius::processor_id() ) continue;
-
-    const FVM_Node * semiconductor_node  = get_region_fvm_node ( ( *node_it ), _r1 );
+    const RegionNodeEntry * semiconductor_entry = node.first();
+    const FVM_Node * semiconductor_node  = semiconductor_entry->fvm_node;
     const FVM_NodeData * semiconductor_node_data = semiconductor_node->node_data();
 
-    const FVM_Node * insulator_node = get_region_fvm_node ( ( *node_it ), _r2 );
-    const FVM_NodeData * insulator_node_data = insulator_node->node_data();
+    const FVM_Node * insulator_node = node.second()->fvm_node;
 
     PetscInt index[3] = {semiconductor_node->global_offset()+0, semiconductor_node->global_offset()+1, semiconductor_node->global_offset()+2};
     AutoDScalar V_semiconductor = x[semiconductor_node->local_offset()];        V_semiconductor.setADValue(0,1.0);
     AutoDScalar n   =  x[semiconductor_node->local_offset()+1];   n.setADValue(1, 1.0);              // electron density
     AutoDScalar p   =  x[semiconductor_node->local_offset()+2];   p.setADValue(2, 1.0);              // hole density
 
-    PetscScalar boundary_area = std::abs(semiconductor_node->outside_boundary_surface_area());
+    PetscScalar boundary_area = std::abs(semiconductor_entry->area);
 
     Material::MaterialSemiconductor *mt =  semiconductor_region->material();
 
@@ -418,7 +366,9 @@ void InsulatorSemiconductorInterfaceBC::DDM1_Jacobian(PetscScalar * x, Mat *jac,
     if (semiconductor_region->get_advanced_model()->Trap)
     {
       AutoDScalar ni = mt->band->nie(p, n, T);
-      mt->trap->Calculate(false,p,n,ni,T);
+      // trap occupancy is frozen between steps when advanced explicitly
+      if (!semiconductor_region->get_advanced_model()->TrapExplicit)
+        mt->trap->Calculate(false,p,n,ni,T);
       AutoDScalar TrappedC = mt->trap->ChargeAD(false) * boundary_area;
       MatSetValues(*jac, 1, &index[0], 3, &index[0], TrappedC.getADValue(), ADD_VALUES);
 
@@ -168,7 +168,6 @@ void OhmicContactBC::DDM1_Function(PetscScalar * x, Vec f, InsertMode &add_value
 
   // for 2D mesh, z_width() is the device dimension in Z direction; for 3D mesh, z_width() is 1.0
   const PetscScalar current_scale = this->z_width();
-  std::vector<PetscScalar>   displacement_current_buffer;
 
   // the electrode potential in current iteration
   genius_assert( local_offset()!=invalid_uint );
@@ -215,11 +214,12 @@ void OhmicContactBC::DDM1_Function(PetscScalar * x, Vec f, InsertMode &add_value
             // mapping this node to material library
             semi_region->material()->mapping(fvm_nodes[i]->root_node(), node_data, SolverSpecify::clock);
 
-            PetscScalar ni  = semi_region->material()->band->ni(T);
+            const SemiconductorSimulationRegion::BandCache & band = semi_region->band_cache(fvm_nodes[i], T);
+            PetscScalar ni  = band.ni;
             PetscScalar nie = semi_region->material()->band->nie(p, n, T);
-            PetscScalar Nc  = semi_region->material()->band->Nc(T);
-            PetscScalar Nv  = semi_region->material()->band->Nv(T);
-            PetscScalar Eg  = semi_region->material()->band->Eg(T);
+            PetscScalar Nc  = band.Nc;
+            PetscScalar Nv  = band.Nv;
+            PetscScalar Eg  = band.Eg;
             PetscScalar dEg = semi_region->material()->band->EgNarrow(p, n, T);
 
             //governing equation for Ohmic contact boundary
@@ -271,38 +271,6 @@ void OhmicContactBC::DDM1_Function(PetscScalar * x, Vec f, InsertMode &add_value
             iy.push_back(global_offset+1);
             iy.push_back(global_offset+2);
 
-
-            // displacement current
-            if(SolverSpecify::TimeDependent == true)
-            {
-              PetscScalar I_displacement = 0.0;
-              FVM_Node::fvm_neighbor_node_iterator nb_it = fvm_nodes[i]->neighbor_node_begin();
-              for(; nb_it != fvm_nodes[i]->neighbor_node_end(); ++nb_it)
-              {
-                const FVM_Node *nb_node = (*nb_it).first;
-                const FVM_NodeData * nb_node_data = nb_node->node_data();
-                // the psi of neighbor node
-                PetscScalar V_nb = x[nb_node->local_offset()+0];
-                // distance from nb node to this node
-                PetscScalar distance = (*(fvm_nodes[i]->root_node()) - *(nb_node->root_node())).size();
-                // area of out surface of control volume related with neighbor node
-                PetscScalar cv_boundary = fvm_nodes[i]->cv_surface_area(nb_node);
-                PetscScalar dEdt;
-                if(SolverSpecify::TS_type==SolverSpecify::BDF2 && SolverSpecify::BDF2_LowerOrder==false) //second order
-                {
-                  PetscScalar r = SolverSpecify::dt_last/(SolverSpecify::dt_last + SolverSpecify::dt);
-                  dEdt = ( (2-r)/(1-r)*(V-V_nb)
-                           - 1.0/(r*(1-r))*(node_data->psi()-nb_node_data->psi())
-                           + (1-r)/r*(node_data->psi_last()-nb_node_data->psi_last()))/distance/(SolverSpecify::dt_last+SolverSpecify::dt);
-                }
-                else//first order
-                {
-                  dEdt = ((V-V_nb)-(node_data->psi()-nb_node_data->psi()))/distance/SolverSpecify::dt;
-                }
-                I_displacement += cv_boundary*node_data->eps() *dEdt;
-              }
-              displacement_current_buffer.push_back( I_displacement );
-            }
             break;
           }
           // conductor region which has an interface with OhmicContact boundary to semiconductor region
@@ -392,7 +360,10 @@ void OhmicContactBC::DDM1_Function(PetscScalar * x, Vec f, InsertMode &add_value
 
   const std::vector<PetscScalar> & current_buffer = this->_current_buffer;
   PetscScalar current_conductance  = current_scale*std::accumulate(current_buffer.begin(), current_buffer.end(), 0.0 );
-  PetscScalar current_displacement = current_scale*std::accumulate(displacement_current_buffer.begin(), displacement_current_buffer.end(), 0.0 );
+  // displacement current, by the precomputed flux stencil
+  PetscScalar current_displacement = 0.0;
+  if(SolverSpecify::TimeDependent == true)
+    current_displacement = current_scale*displacement_current(x, SemiconductorRegion);
   PetscScalar current = current_conductance + current_displacement;
 
   ext_circuit()->potential() = Ve;
@@ -747,6 +718,10 @@ void OhmicContactBC::DDM1_Jacobian(PetscScalar * x, Mat *jac, InsertMode &add_va
         bc_current_jacobian[k] *= bc_current_scale;
       MatSetValues(*jac, 1, &bc_global_offset, _buffer_cols[n].size(), &(_buffer_cols[n])[0], &(bc_current_jacobian)[0], ADD_VALUES);
     }
+
+    // displacement current, by the precomputed flux stencil
+    if(SolverSpecify::TimeDependent == true)
+      displacement_current_jacobian(jac, bc_global_offset, bc_current_scale, SemiconductorRegion);
   }
 
 
@@ -792,11 +767,12 @@ void OhmicContactBC::DDM1_Jacobian(PetscScalar * x, Mat *jac, InsertMode &add_va
 
             semi_region->material()->mapping(fvm_nodes[i]->root_node(), node_data, SolverSpecify::clock);
 
-            PetscScalar ni  = semi_region->material()->band->ni(T);
+            const SemiconductorSimulationRegion::BandCache & band = semi_region->band_cache(fvm_nodes[i], T);
+            PetscScalar ni  = band.ni;
             AutoDScalar nie = semi_region->material()->band->nie(p, n, T);
-            PetscScalar Nc  = semi_region->material()->band->Nc(T);
-            PetscScalar Nv  = semi_region->material()->band->Nv(T);
-            PetscScalar Eg  = semi_region->material()->band->Eg(T);
+            PetscScalar Nc  = band.Nc;
+            PetscScalar Nv  = band.Nv;
+            PetscScalar Eg  = band.Eg;
             AutoDScalar dEg = semi_region->material()->band->EgNarrow(p, n, T);
 
             //governing equation for Ohmic contact boundary
@@ -855,54 +831,6 @@ void OhmicContactBC::DDM1_Jacobian(PetscScalar * x, Mat *jac, InsertMode &add_va
             MatSetValues(*jac, 1, &row[1], 4, &col[0], ff2.getADValue(), ADD_VALUES);
             MatSetValues(*jac, 1, &row[2], 4, &col[0], ff3.getADValue(), ADD_VALUES);
 
-            // displacement current
-            if(SolverSpecify::TimeDependent == true)
-            {
-              FVM_Node::fvm_neighbor_node_iterator nb_it = fvm_nodes[i]->neighbor_node_begin();
-              for(; nb_it != fvm_nodes[i]->neighbor_node_end(); ++nb_it)
-              {
-                FVM_Node *nb_node = (*nb_it).first;
-                FVM_NodeData * nb_node_data = nb_node->node_data();
-                // the psi of neighbor node
-                AutoDScalar V_nb = x[nb_node->local_offset()+0]; V_nb.setADValue(1, 1.0);
-                // distance from nb node to this node
-                PetscScalar distance = (*(fvm_nodes[i]->root_node()) - *(nb_node->root_node())).size();
-                // area of out surface of control volume related with neighbor node
-                PetscScalar cv_boundary = fvm_nodes[i]->cv_surface_area(nb_node);
-
-                AutoDScalar dEdt;
-                if(SolverSpecify::TS_type==SolverSpecify::BDF2 && SolverSpecify::BDF2_LowerOrder==false) //second order
-                {
-                  PetscScalar r = SolverSpecify::dt_last/(SolverSpecify::dt_last + SolverSpecify::dt);
-                  dEdt = ( (2-r)/(1-r)*(V-V_nb)
-                           - 1.0/(r*(1-r))*(node_data->psi()-nb_node_data->psi())
-                           + (1-r)/r*(node_data->psi_last()-nb_node_data->psi_last()))/distance/(SolverSpecify::dt_last+SolverSpecify::dt);
-                }
-                else//first order
-                {
-                  dEdt = ((V-V_nb)-(node_data->psi()-nb_node_data->psi()))/distance/SolverSpecify::dt;
-                }
-
-                AutoDScalar current_disp = cv_boundary*node_data->eps()*dEdt*current_scale;
-
-                //for inter connect electrode
-                if(this->is_inter_connect_bc())
-                {
-                  PetscScalar R = ext_circuit()->inter_connect_resistance();
-                  current_disp = R*current_disp;
-                }
-                // for stand alone electrode
-                else
-                {
-                  PetscScalar mna_scaling = ext_circuit()->mna_scaling(SolverSpecify::dt);
-                  current_disp = mna_scaling*current_disp;
-                }
-
-                MatSetValue(*jac, bc_global_offset, fvm_nodes[i]->global_offset()+0, current_disp.getADValue(0), ADD_VALUES);
-                MatSetValue(*jac, bc_global_offset, nb_node->global_offset()+0, current_disp.getADValue(1), ADD_VALUES);
-              }
-            }
-
             break;
           }
           // conductor region which has an interface with OhmicContact boundary to semiconductor region
@@ -1063,12 +991,15 @@ void OhmicContactBC::DDM1_Electrode_Trace(Vec, Mat *jac, Vec pdI_pdx, Vec pdF_pd
  */
 void OhmicContactBC::DDM1_Update_Solution(PetscScalar *)
 {
-  Parallel::sum(ext_circuit()->current());
-  this->ext_circuit()->update();
+  // electrode current, also statistic displacement current, electron current and hole current.
+  // all of them are summed by one reduction
+  Parallel::SumBatch<Real> batch;
+  batch.add(ext_circuit()->current());
+  batch.add(ext_circuit()->current_displacement());
+  batch.add(ext_circuit()->current_electron());
+  batch.add(ext_circuit()->current_hole());
+  batch.reduce();
 
-  // also statistic displacement current, electron current and hole current
-  Parallel::sum(ext_circuit()->current_displacement());
-  Parallel::sum(ext_circuit()->current_electron());
-  Parallel::sum(ext_circuit()->current_hole());
+  this->ext_circuit()->update();
 }
 
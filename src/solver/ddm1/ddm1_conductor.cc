@@ -42,13 +42,12 @@ using PhysicalUnit::e;
  */
 void ElectrodeSimulationRegion::DDM1_Fill_Value(Vec x, Vec L)
 {
-  std::vector<int> ix;
-  std::vector<PetscScalar> y;
-  std::vector<PetscScalar> s;
+  PetscInt start;
+  VecGetOwnershipRange(x, &start, PETSC_NULL);
 
-  ix.reserve(this->n_node());
-  y.reserve(this->n_node());
-  s.reserve(this->n_node());
+  PetscScalar *xx, *ll;
+  VecGetArray(x, &xx);
+  VecGetArray(L, &ll);
 
   const_processor_node_iterator node_it = on_processor_nodes_begin();
   const_processor_node_iterator node_it_end = on_processor_nodes_end();
@@ -56,17 +55,14 @@ void ElectrodeSimulationRegion::DDM1_Fill_Value(Vec x, Vec L)
   {
     const FVM_Node * fvm_node = *node_it;
     const FVM_NodeData * node_data = fvm_node->node_data();
+    const PetscInt offset = fvm_node->global_offset() - start;
 
-    ix.push_back(fvm_node->global_offset());
-    y.push_back(node_data->psi());
-    s.push_back(1.0/(node_data->eps()*fvm_node->volume()));
+    xx[offset] = node_data->psi();
+    ll[offset] = 1.0/(node_data->eps()*fvm_node->volume());
   }
 
-  if( ix.size() )
-  {
-    VecSetValues(x, ix.size(), &ix[0], &y[0], INSERT_VALUES) ;
-    VecSetValues(L, ix.size(), &ix[0], &s[0], INSERT_VALUES) ;
-  }
+  VecRestoreArray(x, &xx);
+  VecRestoreArray(L, &ll);
 }
 
 
@@ -98,6 +94,7 @@ void ElectrodeSimulationRegion::DDM1_Function(PetscScalar * x, Vec f, InsertMode
   {
     // fvm_node of node1
     const FVM_Node * fvm_n1 = (*it).first;
+    const unsigned int edge_index = it - edges_begin();
     // fvm_node of node2
     const FVM_Node * fvm_n2 = (*it).second;
 
@@ -121,7 +118,7 @@ void ElectrodeSimulationRegion::DDM1_Function(PetscScalar * x, Vec f, InsertMode
       PetscScalar eps = 0.5*(eps1+eps2);
 
       // "flux" from node 2 to node 1
-      PetscScalar f =  eps*fvm_n1->cv_surface_area(fvm_n2)*(V2 - V1)/fvm_n1->distance(fvm_n2) ;
+      PetscScalar f =  eps*this->edge_cv_surface_area(edge_index)*(V2 - V1)/this->edge_length(edge_index) ;
 
       // ignore thoese ghost nodes
       if( fvm_n1->on_processor() )
@@ -178,6 +175,7 @@ void ElectrodeSimulationRegion::DDM1_Jacobian(PetscScalar * x, Mat *jac, InsertM
   {
     // fvm_node of node1
     const FVM_Node * fvm_n1 = (*it).first;
+    const unsigned int edge_index = it - edges_begin();
     // fvm_node of node2
     const FVM_Node * fvm_n2 = (*it).second;
 
@@ -206,7 +204,7 @@ void ElectrodeSimulationRegion::DDM1_Jacobian(PetscScalar * x, Mat *jac, InsertM
 
       PetscScalar eps = 0.5*(eps1+eps2);
 
-      AutoDScalar f =  eps*fvm_n1->cv_surface_area(fvm_n2)*(V2 - V1)/fvm_n1->distance(fvm_n2) ;
+      AutoDScalar f =  eps*this->edge_cv_surface_area(edge_index)*(V2 - V1)/this->edge_length(edge_index) ;
 
       // ignore thoese ghost nodes
       if( fvm_n1->on_processor() )
@@ -0,0 +1,655 @@
+/********************************************************************************/
+/*     888888    888888888   88     888  88888   888      888    88888888       */
+/*   8       8   8           8 8     8     8      8        8    8               */
+/*  8            8           8  8    8     8      8        8    8               */
+/*  8            888888888   8   8   8     8      8        8     8888888        */
+/*  8      8888  8           8    8  8     8      8        8            8       */
+/*   8       8   8           8     8 8     8      8        8            8       */
+/*     888888    888888888  888     88   88888     88888888     88888888        */
+/*                                                                              */
+/*       A Three-Dimensional General Purpose Semiconductor Simulator.           */
+/*                                                                              */
+/*                                                                              */
+/*  Copyright (C) 2007-2008                                                     */
+/*  Cogenda Pte Ltd                                                             */
+/*                                                                              */
+/*  Please contact Cogenda Pte Ltd for license information                      */
+/*                                                                              */
+/*  Author: Gong Ding   gdiso@ustc.edu                                          */
+/*                                                                              */
+/********************************************************************************/
+
+#include <cmath>
+#include <algorithm>
+#include <iomanip>
+
+#include "ddm1/ddm1.h"
+#include "ddm1/ddm1_hb.h"
+#include "electrical_source.h"
+#include "field_source.h"
+#include "parallel.h"
+#include "mathfunc.h"  // for PI
+
+
+extern "C"
+{
+  //---------------------------------------------------------------
+  // this function is called by PETSc to apply the harmonic balance jacobian
+  static PetscErrorCode  __genius_petsc_hb_jacobian_mult (Mat mat, Vec x, Vec y)
+  {
+    void * ctx;
+    MatShellGetContext(mat, &ctx);
+
+    DDM1HarmonicBalance * hb = (DDM1HarmonicBalance *)ctx;
+    hb->jacobian_mult(x, y);
+
+    return 0;
+  }
+
+  //---------------------------------------------------------------
+  // this function is called by PETSc to apply the block-circulant preconditioner
+  static PetscErrorCode  __genius_petsc_hb_pc_apply (PC pc, Vec x, Vec y)
+  {
+    void * ctx;
+    PCShellGetContext(pc, &ctx);
+
+    DDM1HarmonicBalance * hb = (DDM1HarmonicBalance *)ctx;
+    hb->preconditioner_apply(x, y);
+
+    return 0;
+  }
+}
+
+
+
+DDM1HarmonicBalance::DDM1HarmonicBalance(DDM1Solver & solver)
+  : _solver(solver), _Jdc(PETSC_NULL), _C(PETSC_NULL)
+{
+  PetscErrorCode ierr;
+
+  _n_harmonic = SolverSpecify::HBHarmonics;
+  _n_sample   = 2*_n_harmonic+1;
+  _omega      = 2*PI*SolverSpecify::HBFrequency;
+
+  const unsigned int N = _n_sample;
+
+  // spectral differentiation matrix for odd number of samples,
+  // D_kj = w/2 (-1)^(k-j) / sin(pi(k-j)/N), zero diagonal
+  _D.assign(N*N, 0.0);
+  for(unsigned int k=0; k<N; ++k)
+    for(unsigned int j=0; j<N; ++j)
+    {
+      if( k == j ) continue;
+      const int d = static_cast<int>(k) - static_cast<int>(j);
+      const PetscScalar sign = (std::abs(d)%2) ? -1.0 : 1.0;
+      _D[k*N+j] = 0.5*_omega*sign/std::sin(PI*d/N);
+    }
+
+  _cos.resize((_n_harmonic+1)*N);
+  _sin.resize((_n_harmonic+1)*N);
+  for(unsigned int h=0; h<=_n_harmonic; ++h)
+    for(unsigned int k=0; k<N; ++k)
+    {
+      const PetscScalar theta = 2*PI*h*k/N;
+      _cos[h*N+k] = std::cos(theta);
+      _sin[h*N+k] = std::sin(theta);
+    }
+
+  ierr = VecGetLocalSize(_solver.x, &_n_local); genius_assert(!ierr);
+  _spectrum.resize(N*_n_local);
+
+  ierr = VecCreateMPI(PETSC_COMM_WORLD, N*_n_local, PETSC_DETERMINE, &_X); genius_assert(!ierr);
+  ierr = VecDuplicate(_X, &_F); genius_assert(!ierr);
+  ierr = VecDuplicate(_X, &_dX); genius_assert(!ierr);
+  ierr = VecDuplicate(_X, &_X0); genius_assert(!ierr);
+
+  ierr = VecDuplicate(_solver.x, &_xa); genius_assert(!ierr);
+  ierr = VecDuplicate(_solver.x, &_xb); genius_assert(!ierr);
+  ierr = VecDuplicate(_solver.x, &_w); genius_assert(!ierr);
+  ierr = VecDuplicate(_solver.x, &_b); genius_assert(!ierr);
+  ierr = VecDuplicate(_solver.x, &_y); genius_assert(!ierr);
+  ierr = VecDuplicate(_solver.lx, &_ldxdt); genius_assert(!ierr);
+
+  ierr = VecCreateMPI(PETSC_COMM_WORLD, 2*_n_local, PETSC_DETERMINE, &_b2); genius_assert(!ierr);
+  ierr = VecDuplicate(_b2, &_y2); genius_assert(!ierr);
+
+  _J.resize(N);
+  for(unsigned int k=0; k<N; ++k)
+  {
+    ierr = MatDuplicate(_solver.J, MAT_DO_NOT_COPY_VALUES, &_J[k]); genius_assert(!ierr);
+  }
+
+  // GMRES with matrix free operator and the block-circulant preconditioner
+  PetscInt M;
+  ierr = VecGetSize(_X, &M); genius_assert(!ierr);
+  ierr = MatCreateShell(PETSC_COMM_WORLD, N*_n_local, N*_n_local, M, M, (void *)this, &_A); genius_assert(!ierr);
+  ierr = MatShellSetOperation(_A, MATOP_MULT, (void(*)(void))__genius_petsc_hb_jacobian_mult); genius_assert(!ierr);
+
+  PC pc;
+  ierr = KSPCreate(PETSC_COMM_WORLD, &_ksp); genius_assert(!ierr);
+  ierr = KSPSetType(_ksp, KSPGMRES); genius_assert(!ierr);
+  ierr = KSPGMRESSetRestart(_ksp, 50); genius_assert(!ierr);
+  ierr = KSPSetOperators(_ksp, _A, _A, SAME_PRECONDITIONER); genius_assert(!ierr);
+  ierr = KSPGetPC(_ksp, &pc); genius_assert(!ierr);
+  ierr = PCSetType(pc, (char*) PCSHELL); genius_assert(!ierr);
+  ierr = PCShellSetApply(pc, __genius_petsc_hb_pc_apply); genius_assert(!ierr);
+  ierr = PCShellSetContext(pc, (void *)this); genius_assert(!ierr);
+  ierr = KSPSetTolerances(_ksp, SolverSpecify::HBKSPRelTol, 1e-30, PETSC_DEFAULT, 200); genius_assert(!ierr);
+  ierr = KSPSetOptionsPrefix(_ksp, "hb_"); genius_assert(!ierr);
+  ierr = KSPSetFromOptions(_ksp); genius_assert(!ierr);
+
+  // the time derivative of current sample is read by the residual of solver
+  _solver._hb_dxdt = _ldxdt;
+}
+
+
+
+DDM1HarmonicBalance::~DDM1HarmonicBalance()
+{
+  _solver._hb_dxdt = PETSC_NULL;
+  _solver._hb_mass_jacobian = false;
+
+  KSPDestroy(PetscDestroyObject(_ksp));
+  MatDestroy(PetscDestroyObject(_A));
+
+  for(unsigned int h=0; h<_sub_ksp.size(); ++h)
+    KSPDestroy(PetscDestroyObject(_sub_ksp[h]));
+  for(unsigned int h=1; h<_K.size(); ++h)
+    MatDestroy(PetscDestroyObject(_K[h]));
+  for(unsigned int k=0; k<_J.size(); ++k)
+    MatDestroy(PetscDestroyObject(_J[k]));
+  if(_Jdc != PETSC_NULL) MatDestroy(PetscDestroyObject(_Jdc));
+  if(_C   != PETSC_NULL) MatDestroy(PetscDestroyObject(_C));
+
+  VecDestroy(PetscDestroyObject(_X));
+  VecDestroy(PetscDestroyObject(_F));
+  VecDestroy(PetscDestroyObject(_dX));
+  VecDestroy(PetscDestroyObject(_X0));
+  VecDestroy(PetscDestroyObject(_xa));
+  VecDestroy(PetscDestroyObject(_xb));
+  VecDestroy(PetscDestroyObject(_w));
+  VecDestroy(PetscDestroyObject(_b));
+  VecDestroy(PetscDestroyObject(_y));
+  VecDestroy(PetscDestroyObject(_ldxdt));
+  VecDestroy(PetscDestroyObject(_b2));
+  VecDestroy(PetscDestroyObject(_y2));
+}
+
+
+
+void DDM1HarmonicBalance::set_sample(unsigned int k)
+{
+  SolverSpecify::clock = k/(SolverSpecify::HBFrequency*_n_sample);
+  _solver._system.get_electrical_source()->update ( SolverSpecify::clock );
+  _solver._system.get_field_source()->update ( SolverSpecify::clock, SolverSpecify::SourceCoupled );
+}
+
+
+
+void DDM1HarmonicBalance::time_derivative(const PetscScalar *x, unsigned int k)
+{
+  PetscScalar *ww;
+  VecGetArray(_w, &ww);
+  std::fill(ww, ww+_n_local, 0.0);
+  for(unsigned int j=0; j<_n_sample; ++j)
+  {
+    const PetscScalar d = _D[k*_n_sample+j];
+    if( d == 0.0 ) continue;
+    const PetscScalar *xj = x + j*_n_local;
+    for(PetscInt i=0; i<_n_local; ++i)
+      ww[i] += d*xj[i];
+  }
+  VecRestoreArray(_w, &ww);
+
+  VecScatterBegin(_solver.scatter, _w, _ldxdt, INSERT_VALUES, SCATTER_FORWARD);
+  VecScatterEnd  (_solver.scatter, _w, _ldxdt, INSERT_VALUES, SCATTER_FORWARD);
+}
+
+
+
+void DDM1HarmonicBalance::residual(Vec X, Vec F)
+{
+  PetscScalar *xx, *ff;
+  VecGetArray(X, &xx);
+  VecGetArray(F, &ff);
+
+  for(unsigned int k=0; k<_n_sample; ++k)
+  {
+    set_sample(k);
+    time_derivative(xx, k);
+
+    VecPlaceArray(_xa, xx + k*_n_local);
+    VecPlaceArray(_xb, ff + k*_n_local);
+    _solver.build_petsc_sens_residual(_xa, _xb);
+    VecResetArray(_xa);
+    VecResetArray(_xb);
+  }
+
+  VecRestoreArray(X, &xx);
+  VecRestoreArray(F, &ff);
+}
+
+
+
+void DDM1HarmonicBalance::jacobian(Vec X)
+{
+  PetscScalar *xx;
+  VecGetArray(X, &xx);
+
+  for(unsigned int k=0; k<_n_sample; ++k)
+  {
+    set_sample(k);
+    VecPlaceArray(_xa, xx + k*_n_local);
+    _solver.build_petsc_sens_jacobian(_xa, &_solver.J, &_solver.J);
+    VecResetArray(_xa);
+    MatCopy(_solver.J, _J[k], SAME_NONZERO_PATTERN);
+  }
+
+  VecRestoreArray(X, &xx);
+}
+
+
+
+void DDM1HarmonicBalance::jacobian_mult(Vec v, Vec y)
+{
+  PetscScalar *vv, *yy;
+  VecGetArray(v, &vv);
+  VecGetArray(y, &yy);
+
+  for(unsigned int k=0; k<_n_sample; ++k)
+  {
+    // (J v)_k = J_k v_k + C (D v)_k, the scatter to _ldxdt is not used here
+    PetscScalar *ww;
+    VecGetArray(_w, &ww);
+    std::fill(ww, ww+_n_local, 0.0);
+    for(unsigned int j=0; j<_n_sample; ++j)
+    {
+      const PetscScalar d = _D[k*_n_sample+j];
+      if( d == 0.0 ) continue;
+      const PetscScalar *vj = vv + j*_n_local;
+      for(PetscInt i=0; i<_n_local; ++i)
+        ww[i] += d*vj[i];
+    }
+    VecRestoreArray(_w, &ww);
+
+    VecPlaceArray(_xa, vv + k*_n_local);
+    VecPlaceArray(_xb, yy + k*_n_local);
+    MatMult(_J[k], _xa, _xb);
+    MatMultAdd(_C, _w, _xb, _xb);
+    VecResetArray(_xa);
+    VecResetArray(_xb);
+  }
+
+  VecRestoreArray(v, &vv);
+  VecRestoreArray(y, &yy);
+}
+
+
+
+void DDM1HarmonicBalance::preconditioner_apply(Vec r, Vec y)
+{
+  const unsigned int N = _n_sample;
+  const PetscInt n = _n_local;
+
+  PetscScalar *rr, *yy;
+  VecGetArray(r, &rr);
+  VecGetArray(y, &yy);
+
+  // DFT over the samples, R_h = 1/N sum_k R_k exp(-i h w t_k)
+  std::fill(_spectrum.begin(), _spectrum.end(), 0.0);
+  for(unsigned int k=0; k<N; ++k)
+  {
+    const PetscScalar *rk = rr + k*n;
+    for(PetscInt i=0; i<n; ++i)
+      _spectrum[i] += rk[i]/N;
+    for(unsigned int h=1; h<=_n_harmonic; ++h)
+    {
+      const PetscScalar c = _cos[h*N+k]/N;
+      const PetscScalar s = _sin[h*N+k]/N;
+      PetscScalar *re = &_spectrum[(2*h-1)*n];
+      PetscScalar *im = &_spectrum[2*h*n];
+      for(PetscInt i=0; i<n; ++i)
+      {
+        re[i] += c*rk[i];
+        im[i] -= s*rk[i];
+      }
+    }
+  }
+
+  // solve each harmonic
+  for(unsigned int h=0; h<=_n_harmonic; ++h)
+  {
+    Vec b = h ? _b2 : _b;
+    Vec x = h ? _y2 : _y;
+    const PetscInt size = h ? 2*n : n;
+    PetscScalar *s = h ? &_spectrum[(2*h-1)*n] : &_spectrum[0];
+
+    PetscScalar *bb;
+    VecGetArray(b, &bb);
+    std::copy(s, s+size, bb);
+    VecRestoreArray(b, &bb);
+
+    KSPSolve(_sub_ksp[h], b, x);
+
+    PetscScalar *xx;
+    VecGetArray(x, &xx);
+    std::copy(xx, xx+size, s);
+    VecRestoreArray(x, &xx);
+  }
+
+  // back to samples, Y_k = Y_0 + 2 sum_h Re(Y_h exp(i h w t_k))
+  for(unsigned int k=0; k<N; ++k)
+  {
+    PetscScalar *yk = yy + k*n;
+    std::copy(_spectrum.begin(), _spectrum.begin()+n, yk);
+    for(unsigned int h=1; h<=_n_harmonic; ++h)
+    {
+      const PetscScalar c = 2*_cos[h*N+k];
+      const PetscScalar s = 2*_sin[h*N+k];
+      const PetscScalar *re = &_spectrum[(2*h-1)*n];
+      const PetscScalar *im = &_spectrum[2*h*n];
+      for(PetscInt i=0; i<n; ++i)
+        yk[i] += c*re[i] - s*im[i];
+    }
+  }
+
+  VecRestoreArray(r, &rr);
+  VecRestoreArray(y, &yy);
+}
+
+
+
+void DDM1HarmonicBalance::build_preconditioner()
+{
+  PetscErrorCode ierr;
+
+  // DC jacobian at the present solution
+  set_sample(0);
+  _solver.build_petsc_sens_jacobian(_solver.x, &_solver.J, &_solver.J);
+  ierr = MatDuplicate(_solver.J, MAT_COPY_VALUES, &_Jdc); genius_assert(!ierr);
+
+  // C is the difference of the jacobian with and without the coefficient of time derivative,
+  // which passes the same boundary row process as the transient term
+  _solver._hb_mass_jacobian = true;
+  _solver.build_petsc_sens_jacobian(_solver.x, &_solver.J, &_solver.J);
+  _solver._hb_mass_jacobian = false;
+  ierr = MatDuplicate(_solver.J, MAT_COPY_VALUES, &_C); genius_assert(!ierr);
+  ierr = MatAXPY(_C, -1.0, _Jdc, SAME_NONZERO_PATTERN); genius_assert(!ierr);
+
+  _K.resize(_n_harmonic+1, PETSC_NULL);
+  for(unsigned int h=1; h<=_n_harmonic; ++h)
+    build_harmonic_matrix(h, _K[h]);
+
+  // the linear solver of each harmonic follows the one of nonlinear solver
+  const char * ksp_type = PETSC_NULL;
+  const char * pc_type  = PETSC_NULL;
+  ierr = KSPGetType ( _solver.ksp, &ksp_type );  genius_assert ( !ierr );
+  ierr = PCGetType ( _solver.pc, &pc_type );  genius_assert ( !ierr );
+
+  _sub_ksp.resize(_n_harmonic+1);
+  for(unsigned int h=0; h<=_n_harmonic; ++h)
+  {
+    PC sub_pc;
+    ierr = KSPCreate ( PETSC_COMM_WORLD, &_sub_ksp[h] );  genius_assert ( !ierr );
+    ierr = KSPGetPC ( _sub_ksp[h], &sub_pc );  genius_assert ( !ierr );
+    ierr = KSPSetType ( _sub_ksp[h], ksp_type );  genius_assert ( !ierr );
+    ierr = PCSetType ( sub_pc, pc_type );  genius_assert ( !ierr );
+    if ( std::string ( pc_type ) == PCLU || std::string ( pc_type ) == PCCHOLESKY )
+    {
+      const char * package = PETSC_NULL;
+      ierr = PCFactorGetMatSolverPackage ( _solver.pc, &package );  genius_assert ( !ierr );
+      ierr = PCFactorSetMatSolverPackage ( sub_pc, package );  genius_assert ( !ierr );
+    }
+    Mat K = h ? _K[h] : _Jdc;
+    ierr = KSPSetOperators ( _sub_ksp[h], K, K, SAME_NONZERO_PATTERN );  genius_assert ( !ierr );
+    ierr = KSPSetOptionsPrefix ( _sub_ksp[h], "hb_sub_" );  genius_assert ( !ierr );
+    ierr = KSPSetTolerances ( _sub_ksp[h], 1e-10, SolverSpecify::ksp_atol, PETSC_DEFAULT, PETSC_DEFAULT );  genius_assert ( !ierr );
+    ierr = KSPSetFromOptions ( _sub_ksp[h] );  genius_assert ( !ierr );
+    ierr = KSPSetUp ( _sub_ksp[h] );  genius_assert ( !ierr );
+  }
+}
+
+
+
+void DDM1HarmonicBalance::build_harmonic_matrix(unsigned int h, Mat &K)
+{
+  PetscErrorCode ierr;
+
+  // each processor holds the real rows of its own dofs followed by the imaginary ones,
+  // so a dof j owned by processor q goes to j+ranges[q] and j+ranges[q+1]
+  const PetscInt * ranges;
+  ierr = VecGetOwnershipRanges(_solver.x, &ranges); genius_assert(!ierr);
+  const PetscInt n_proc = Genius::n_processors();
+  const PetscInt rank   = Genius::processor_id();
+
+  PetscInt rstart, rend;
+  ierr = MatGetOwnershipRange(_Jdc, &rstart, &rend); genius_assert(!ierr);
+
+  // the processor own dof j
+  #define HB_OWNER(j) (std::upper_bound(ranges, ranges+n_proc+1, (j)) - ranges - 1)
+
+  // preallocation, the entries of real and imaginary rows are the same
+  std::vector<PetscInt> d_nz(2*_n_local, 0), o_nz(2*_n_local, 0);
+  for(PetscInt r=rstart; r<rend; ++r)
+  {
+    PetscInt nc;
+    const PetscInt *cols;
+    const PetscScalar *vals;
+    PetscInt d=0, o=0;
+
+    MatGetRow(_Jdc, r, &nc, &cols, &vals);
+    for(PetscInt c=0; c<nc; ++c)
+      HB_OWNER(cols[c]) == rank ? ++d : ++o;
+    MatRestoreRow(_Jdc, r, &nc, &cols, &vals);
+
+    MatGetRow(_C, r, &nc, &cols, &vals);
+    for(PetscInt c=0; c<nc; ++c)
+      if( vals[c] != 0.0 ) HB_OWNER(cols[c]) == rank ? ++d : ++o;
+    MatRestoreRow(_C, r, &nc, &cols, &vals);
+
+    d_nz[r-rstart] = d_nz[r-rstart+_n_local] = d;
+    o_nz[r-rstart] = o_nz[r-rstart+_n_local] = o;
+  }
+
+  ierr = MatCreate(PETSC_COMM_WORLD, &K); genius_assert(!ierr);
+  ierr = MatSetSizes(K, 2*_n_local, 2*_n_local, PETSC_DETERMINE, PETSC_DETERMINE); genius_assert(!ierr);
+  if (Genius::n_processors()>1)
+  {
+    ierr = MatSetType(K, MATMPIAIJ); genius_assert(!ierr);
+    ierr = MatMPIAIJSetPreallocation(K, 0, &d_nz[0], 0, &o_nz[0]); genius_assert(!ierr);
+  }
+  else
+  {
+    ierr = MatSetType(K, MATSEQAIJ); genius_assert(!ierr);
+    ierr = MatSeqAIJSetPreallocation(K, 0, &d_nz[0]); genius_assert(!ierr);
+  }
+
+  //  | J    -hwC |
+  //  | hwC   J   |
+  const PetscScalar hw = h*_omega;
+  std::vector<PetscInt> re_cols, im_cols;
+  std::vector<PetscScalar> scaled;
+  for(PetscInt r=rstart; r<rend; ++r)
+  {
+    const PetscInt re_row = r + ranges[rank];
+    const PetscInt im_row = r + ranges[rank+1];
+
+    PetscInt nc;
+    const PetscInt *cols;
+    const PetscScalar *vals;
+
+    MatGetRow(_Jdc, r, &nc, &cols, &vals);
+    re_cols.resize(nc);
+    im_cols.resize(nc);
+    for(PetscInt c=0; c<nc; ++c)
+    {
+      const PetscInt q = HB_OWNER(cols[c]);
+      re_cols[c] = cols[c] + ranges[q];
+      im_cols[c] = cols[c] + ranges[q+1];
+    }
+    if(nc)
+    {
+      MatSetValues(K, 1, &re_row, nc, &re_cols[0], vals, INSERT_VALUES);
+      MatSetValues(K, 1, &im_row, nc, &im_cols[0], vals, INSERT_VALUES);
+    }
+    MatRestoreRow(_Jdc, r, &nc, &cols, &vals);
+
+    MatGetRow(_C, r, &nc, &cols, &vals);
+    re_cols.clear();
+    im_cols.clear();
+    scaled.clear();
+    for(PetscInt c=0; c<nc; ++c)
+    {
+      if( vals[c] == 0.0 ) continue;
+      const PetscInt q = HB_OWNER(cols[c]);
+      re_cols.push_back(cols[c] + ranges[q]);
+      im_cols.push_back(cols[c] + ranges[q+1]);
+      scaled.push_back(hw*vals[c]);
+    }
+    MatRestoreRow(_C, r, &nc, &cols, &vals);
+    if(scaled.size())
+    {
+      MatSetValues(K, 1, &im_row, scaled.size(), &re_cols[0], &scaled[0], INSERT_VALUES);
+      for(unsigned int c=0; c<scaled.size(); ++c) scaled[c] = -scaled[c];
+      MatSetValues(K, 1, &re_row, scaled.size(), &im_cols[0], &scaled[0], INSERT_VALUES);
+    }
+  }
+
+  #undef HB_OWNER
+
+  ierr = MatAssemblyBegin(K, MAT_FINAL_ASSEMBLY); genius_assert(!ierr);
+  ierr = MatAssemblyEnd(K, MAT_FINAL_ASSEMBLY); genius_assert(!ierr);
+}
+
+
+
+bool DDM1HarmonicBalance::solve()
+{
+  // all the samples start from the present solution
+  {
+    PetscScalar *xx, *x0;
+    VecGetArray(_X, &xx);
+    VecGetArray(_solver.x, &x0);
+    for(unsigned int k=0; k<_n_sample; ++k)
+      std::copy(x0, x0+_n_local, xx+k*_n_local);
+    VecRestoreArray(_solver.x, &x0);
+    VecRestoreArray(_X, &xx);
+  }
+
+  build_preconditioner();
+
+  residual(_X, _F);
+  PetscReal fnorm0;
+  VecNorm(_F, NORM_2, &fnorm0);
+  PetscReal fnorm = fnorm0;
+
+  MESSAGE<<"  "<<"its " <<" | residual | "<<"| Delta x |"<<"  GMRES its"<<'\n'
+  <<"--------------------------------------------------------------------------------\n";
+  MESSAGE<<"  "<<std::setw(3)<<0<<"    "<<std::scientific<<std::setprecision(2)<<fnorm<<'\n';
+  RECORD();
+
+  bool converged = fnorm <= SolverSpecify::absolute_toler;
+  for(unsigned int its=1; !converged && its<=SolverSpecify::MaxIteration; ++its)
+  {
+    jacobian(_X);
+
+    KSPSolve(_ksp, _F, _dX);
+
+    KSPConvergedReason ksp_reason;
+    PetscInt lits;
+    KSPGetConvergedReason(_ksp, &ksp_reason);
+    KSPGetIterationNumber(_ksp, &lits);
+    if( ksp_reason < 0 )
+    {
+      MESSAGE <<"------> linear solver "<<KSPConvergedReasons[ksp_reason]<<"\n\n"; RECORD();
+    }
+
+    // backtrack the newton step until the residual decreases
+    PetscReal lambda = 1.0, fnorm_new = fnorm;
+    VecCopy(_X, _X0);
+    for(unsigned int ls=0; ls<6; ++ls, lambda*=0.5)
+    {
+      VecWAXPY(_X, -lambda, _dX, _X0);
+      residual(_X, _F);
+      VecNorm(_F, NORM_2, &fnorm_new);
+      if( fnorm_new < fnorm ) break;
+    }
+
+    PetscReal dxnorm;
+    VecNorm(_dX, NORM_2, &dxnorm);
+    fnorm = fnorm_new;
+
+    MESSAGE<<"  "<<std::setw(3)<<its<<"    "<<std::scientific<<std::setprecision(2)<<fnorm
+    <<"   "<<lambda*dxnorm<<"   "<<lits<<'\n';
+    RECORD();
+
+    converged = fnorm <= std::max(SolverSpecify::HBRelTol*fnorm0, SolverSpecify::absolute_toler);
+  }
+
+  MESSAGE<<"--------------------------------------------------------------------------------\n"
+  <<"  Harmonic balance "<<(converged ? "converged" : "diverged")<<", residual norm "<<fnorm<<"\n\n\n";
+  RECORD();
+
+  return converged;
+}
+
+
+
+void DDM1HarmonicBalance::write_samples()
+{
+  PetscScalar *xx;
+  VecGetArray(_X, &xx);
+
+  for(unsigned int k=0; k<_n_sample; ++k)
+  {
+    set_sample(k);
+    // the first sample pairs with the pre_solve_process before harmonic balance
+    if( k ) _solver.pre_solve_process(false);
+
+    PetscScalar *x0;
+    VecGetArray(_solver.x, &x0);
+    std::copy(xx+k*_n_local, xx+(k+1)*_n_local, x0);
+    VecRestoreArray(_solver.x, &x0);
+
+    // evaluate the residual of this sample for the electrode current
+    time_derivative(xx, k);
+    _solver.build_petsc_sens_residual(_solver.x, _w);
+
+    _solver.post_solve_process();
+  }
+
+  VecRestoreArray(_X, &xx);
+}
+
+
+
+//////////////////////////////////////////////////////////////////
+
+
+void DDM1Solver::solve_harmonic_balance()
+{
+  START_LOG("DDM1Solver_Harmonic_Balance()", "DDM1Solver");
+
+  MESSAGE<<"Harmonic balance at "<<SolverSpecify::HBFrequency*PhysicalUnit::s<<" Hz with "
+  <<SolverSpecify::HBHarmonics<<" harmonics"<<'\n'
+  <<"--------------------------------------------------------------------------------\n";
+  RECORD();
+
+  // samples are solved as steady state plus the harmonic balance time derivative
+  const bool time_dependent = SolverSpecify::TimeDependent;
+  SolverSpecify::TimeDependent = false;
+
+  this->pre_solve_process();
+
+  {
+    DDM1HarmonicBalance hb(*this);
+    if( hb.solve() )
+      hb.write_samples();
+    else
+      this->diverged_recovery();
+  }
+
+  SolverSpecify::TimeDependent = time_dependent;
+
+  STOP_LOG("DDM1Solver_Harmonic_Balance()", "DDM1Solver");
+}
@@ -24,6 +24,7 @@
 #include "elem.h"
 #include "simulation_system.h"
 #include "insulator_region.h"
+#include "mat_slot_locator.h"
 
 using PhysicalUnit::kb;
 using PhysicalUnit::e;
@@ -38,13 +39,12 @@ using PhysicalUnit::e;
 
 void InsulatorSimulationRegion::DDM1_Fill_Value(Vec x, Vec L)
 {
-  std::vector<int> ix;
-  std::vector<PetscScalar> y;
-  std::vector<PetscScalar> s;
+  PetscInt start;
+  VecGetOwnershipRange(x, &start, PETSC_NULL);
 
-  ix.reserve(this->n_node());
-  y.reserve(this->n_node());
-  s.reserve(this->n_node());
+  PetscScalar *xx, *ll;
+  VecGetArray(x, &xx);
+  VecGetArray(L, &ll);
 
   const_processor_node_iterator node_it = on_processor_nodes_begin();
   const_processor_node_iterator node_it_end = on_processor_nodes_end();
@@ -52,17 +52,14 @@ void InsulatorSimulationRegion::DDM1_Fill_Value(Vec x, Vec L)
   {
     const FVM_Node * fvm_node = *node_it;
     const FVM_NodeData * node_data = fvm_node->node_data();
+    const PetscInt offset = fvm_node->global_offset() - start;
 
-    ix.push_back(fvm_node->global_offset());
-    y.push_back(node_data->psi());
-    s.push_back(1.0/(node_data->eps()*fvm_node->volume()));
+    xx[offset] = node_data->psi();
+    ll[offset] = 1.0/(node_data->eps()*fvm_node->volume());
   }
 
-  if( ix.size() )
-  {
-    VecSetValues(x, ix.size(), &ix[0], &y[0], INSERT_VALUES) ;
-    VecSetValues(L, ix.size(), &ix[0], &s[0], INSERT_VALUES) ;
-  }
+  VecRestoreArray(x, &xx);
+  VecRestoreArray(L, &ll);
 }
 
 
@@ -81,56 +78,59 @@ void InsulatorSimulationRegion::DDM1_Function(PetscScalar * x, Vec f, InsertMode
     VecAssemblyEnd(f);
   }
 
-  // set local buf here
-  std::vector<int>          iy;
-  std::vector<PetscScalar>  y;
-  iy.reserve(2*n_edge());
-  y.reserve(2*n_edge());
+  // the flux of each edge is evaluated independently (in parallel when OpenMP is enabled),
+  // then they are merged into the local buffer by one thread.
+  const int n_edges = static_cast<int>(n_edge());
+  std::vector<PetscScalar> edge_flux(n_edges);
 
-  // search all the edges of this region, do integral over control volume...
-  const_edge_iterator it = edges_begin();
-  const_edge_iterator it_end = edges_end();
-  for(; it!=it_end; ++it)
+#ifdef HAVE_OPENMP
+  #pragma omp parallel for schedule(static)
+#endif
+  for(int e=0; e<n_edges; ++e)
   {
+    const_edge_iterator it = edges_begin() + e;
+
     // fvm_node of node1
     const FVM_Node * fvm_n1 = (*it).first;
     // fvm_node of node2
     const FVM_Node * fvm_n2 = (*it).second;
 
-    // fvm_node_data of node1
-    const FVM_NodeData * n1_data =  fvm_n1->node_data();
-    // fvm_node_data of node2
-    const FVM_NodeData * n2_data =  fvm_n2->node_data();
+    // electrostatic potential, as independent variable
+    PetscScalar V1   =  x[fvm_n1->local_offset()];
+    PetscScalar eps1 =  fvm_n1->node_data()->eps();
 
-    const unsigned int n1_local_offset = fvm_n1->local_offset();
-    const unsigned int n2_local_offset = fvm_n2->local_offset();
-
-    {
-      // electrostatic potential, as independent variable
-      PetscScalar V1   =  x[n1_local_offset];
-      PetscScalar eps1 =  n1_data->eps();
+    PetscScalar V2   =  x[fvm_n2->local_offset()];
+    PetscScalar eps2 =  fvm_n2->node_data()->eps();
 
+    PetscScalar eps = 0.5*(eps1+eps2);
 
-      PetscScalar V2   =  x[n2_local_offset];
-      PetscScalar eps2 =  n2_data->eps();
+    // "flux" from node 2 to node 1
+    edge_flux[e] = eps*this->edge_cv_surface_area(e)*(V2 - V1)/this->edge_length(e) ;
+  }
 
-      PetscScalar eps = 0.5*(eps1+eps2);
+  // set local buf here
+  std::vector<int>          iy;
+  std::vector<PetscScalar>  y;
+  iy.reserve(2*n_edges);
+  y.reserve(2*n_edges);
 
-      // "flux" from node 2 to node 1
-      PetscScalar f =  eps*fvm_n1->cv_surface_area(fvm_n2)*(V2 - V1)/fvm_n1->distance(fvm_n2) ;
+  for(int e=0; e<n_edges; ++e)
+  {
+    const_edge_iterator it = edges_begin() + e;
+    const FVM_Node * fvm_n1 = (*it).first;
+    const FVM_Node * fvm_n2 = (*it).second;
 
-      // ignore thoese ghost nodes
-      if( fvm_n1->on_processor() )
-      {
-        iy.push_back(fvm_n1->global_offset());
-        y.push_back(f);
-      }
+    // ignore thoese ghost nodes
+    if( fvm_n1->on_processor() )
+    {
+      iy.push_back(fvm_n1->global_offset());
+      y.push_back(edge_flux[e]);
+    }
 
-      if( fvm_n2->on_processor() )
-      {
-        iy.push_back(fvm_n2->global_offset());
-        y.push_back(-f);
-      }
+    if( fvm_n2->on_processor() )
+    {
+      iy.push_back(fvm_n2->global_offset());
+      y.push_back(-edge_flux[e]);
     }
   }
 
@@ -160,60 +160,92 @@ void InsulatorSimulationRegion::DDM1_Jacobian(PetscScalar * x, Mat *jac, InsertM
     MatAssemblyEnd(*jac, MAT_FLUSH_ASSEMBLY);
   }
 
-  //the indepedent variable number, since we only process edges, 2 is enough
-  adtl::AutoDScalar::numdir=2;
+  // the flux between node 1 and node 2 is linear to (V2 - V1),
+  // so the jacobian entries of each edge only depend on the geometry
+  // and can be evaluated independently (in parallel when OpenMP is enabled)
+  const int n_edges = static_cast<int>(n_edge());
+  std::vector<PetscScalar> edge_coeff(n_edges);
 
-  //synchronize with material database
-  mt->set_ad_num(adtl::AutoDScalar::numdir);
-
-
-  // search all the edges of this region, do integral over control volume...
-  const_edge_iterator it = edges_begin();
-  const_edge_iterator it_end = edges_end();
-  for(; it!=it_end; ++it)
+#ifdef HAVE_OPENMP
+  #pragma omp parallel for schedule(static)
+#endif
+  for(int e=0; e<n_edges; ++e)
   {
+    const_edge_iterator it = edges_begin() + e;
+
     // fvm_node of node1
     const FVM_Node * fvm_n1 = (*it).first;
     // fvm_node of node2
     const FVM_Node * fvm_n2 = (*it).second;
 
-    // fvm_node_data of node1
-    const FVM_NodeData * n1_data =  fvm_n1->node_data();
-    // fvm_node_data of node2
-    const FVM_NodeData * n2_data =  fvm_n2->node_data();
-
-    const unsigned int n1_local_offset = fvm_n1->local_offset();
-    const unsigned int n2_local_offset = fvm_n2->local_offset();
+    PetscScalar eps = 0.5*(fvm_n1->node_data()->eps() + fvm_n2->node_data()->eps());
+    edge_coeff[e] = eps*this->edge_cv_surface_area(e)/this->edge_length(e);
+  }
 
-    // the row/colume position of variables in the matrix
-    PetscInt row[2],col[2];
-    row[0] = col[0] = fvm_n1->global_offset();
-    row[1] = col[1] = fvm_n2->global_offset();
+  // the pattern is fixed after first assembly, scatter-add the entries by their slots
+  const MatSlotLocator * slots = MatSlotLocator::get(*jac);
+  if( slots )
+  {
+    if( _ddm1_edge_slots_serial != slots->serial() )
+    {
+      _ddm1_edge_slots.resize(4*n_edges);
+      for(int e=0; e<n_edges; ++e)
+      {
+        const_edge_iterator it = edges_begin() + e;
+        const FVM_Node * fvm_n1 = (*it).first;
+        const FVM_Node * fvm_n2 = (*it).second;
+        const PetscInt n1 = fvm_n1->global_offset();
+        const PetscInt n2 = fvm_n2->global_offset();
+        // ghost nodes have no local row, their slots are -1
+        _ddm1_edge_slots[4*e+0] = fvm_n1->on_processor() ? slots->slot(n1, n1) : -1;
+        _ddm1_edge_slots[4*e+1] = fvm_n1->on_processor() ? slots->slot(n1, n2) : -1;
+        _ddm1_edge_slots[4*e+2] = fvm_n2->on_processor() ? slots->slot(n2, n1) : -1;
+        _ddm1_edge_slots[4*e+3] = fvm_n2->on_processor() ? slots->slot(n2, n2) : -1;
+      }
+      _ddm1_edge_slots_serial = slots->serial();
+    }
 
-    // here we use AD, however it is great overkill for such a simple problem.
+    std::vector<PetscScalar> values(4*n_edges);
+    for(int e=0; e<n_edges; ++e)
     {
-      // electrostatic potential, as independent variable
-      AutoDScalar V1   =  x[n1_local_offset];   V1.setADValue(0,1.0);
-      PetscScalar eps1 =  n1_data->eps();
+      values[4*e+0] = -edge_coeff[e];
+      values[4*e+1] =  edge_coeff[e];
+      values[4*e+2] =  edge_coeff[e];
+      values[4*e+3] = -edge_coeff[e];
+    }
+    if( n_edges )
+      slots->add_values(*jac, 4*n_edges, &_ddm1_edge_slots[0], &values[0]);
 
+    // the last operator is ADD_VALUES
+    add_value_flag = ADD_VALUES;
+    return;
+  }
 
-      AutoDScalar V2   =  x[n2_local_offset];   V2.setADValue(1,1.0);
-      PetscScalar eps2 =  n2_data->eps();
+  // MatSetValues is not thread safe, fill the matrix by one thread
+  for(int e=0; e<n_edges; ++e)
+  {
+    const_edge_iterator it = edges_begin() + e;
+    const FVM_Node * fvm_n1 = (*it).first;
+    const FVM_Node * fvm_n2 = (*it).second;
 
-      PetscScalar eps = 0.5*(eps1+eps2);
+    // the row/colume position of variables in the matrix
+    PetscInt row[2],col[2];
+    row[0] = col[0] = fvm_n1->global_offset();
+    row[1] = col[1] = fvm_n2->global_offset();
 
-      AutoDScalar f =  eps*fvm_n1->cv_surface_area(fvm_n2)*(V2 - V1)/fvm_n1->distance(fvm_n2) ;
+    // d(flux)/d(V1), d(flux)/d(V2)
+    PetscScalar df[2] = { -edge_coeff[e], edge_coeff[e] };
 
-      // ignore thoese ghost nodes
-      if( fvm_n1->on_processor() )
-      {
-        MatSetValues(*jac, 1, &row[0], 2, &col[0], f.getADValue(), ADD_VALUES);
-      }
+    // ignore thoese ghost nodes
+    if( fvm_n1->on_processor() )
+    {
+      MatSetValues(*jac, 1, &row[0], 2, &col[0], &df[0], ADD_VALUES);
+    }
 
-      if( fvm_n2->on_processor() )
-      {
-        MatSetValues(*jac, 1, &row[1], 2, &col[0], (-f).getADValue(), ADD_VALUES);
-      }
+    if( fvm_n2->on_processor() )
+    {
+      PetscScalar mdf[2] = { -df[0], -df[1] };
+      MatSetValues(*jac, 1, &row[1], 2, &col[0], &mdf[0], ADD_VALUES);
     }
   }
 
@@ -243,25 +275,6 @@ void InsulatorSimulationRegion::DDM1_Update_Solution(PetscScalar *lxx)
     node_data->psi() = lxx[fvm_node->local_offset()];
   }
 
-  // addtional work: compute electrical field for all the node.
-  // Since this value is only used for reference.
-  // It can be done simply by weighted average of cell's electrical field
-  for(unsigned int n=0; n<n_cell(); ++n)
-  {
-    const Elem * elem = this->get_region_elem(n);
-    FVM_CellData * elem_data = this->get_region_elem_data(n);
-
-    std::vector<PetscScalar> psi_vertex;
-    for(unsigned int nd=0; nd<elem->n_nodes(); ++nd)
-    {
-      const FVM_Node * fvm_node = elem->get_fvm_node(nd);
-      const FVM_NodeData * fvm_node_data = fvm_node->node_data();
-      psi_vertex.push_back  ( fvm_node_data->psi() );
-    }
-    // compute the gradient in the cell
-    elem_data->E() = - elem->gradient(psi_vertex);  // E = - grad(psi)
-  }
-
 }
 
 
@@ -43,13 +43,12 @@ using PhysicalUnit::ns;
  */
 void MetalSimulationRegion::DDM1_Fill_Value(Vec x, Vec L)
 {
-  std::vector<int> ix;
-  std::vector<PetscScalar> y;
-  std::vector<PetscScalar> s;
+  PetscInt start;
+  VecGetOwnershipRange(x, &start, PETSC_NULL);
 
-  ix.reserve(this->n_node());
-  y.reserve(this->n_node());
-  s.reserve(this->n_node());
+  PetscScalar *xx, *ll;
+  VecGetArray(x, &xx);
+  VecGetArray(L, &ll);
 
   const double sigma = this->get_conductance();
 
@@ -59,17 +58,14 @@ void MetalSimulationRegion::DDM1_Fill_Value(Vec x, Vec L)
   {
     const FVM_Node * fvm_node = *node_it;
     const FVM_NodeData * node_data = fvm_node->node_data();
+    const PetscInt offset = fvm_node->global_offset() - start;
 
-    ix.push_back(fvm_node->global_offset());
-    y.push_back(node_data->psi());
-    s.push_back(1.0/(sigma*fvm_node->volume()));
+    xx[offset] = node_data->psi();
+    ll[offset] = 1.0/(sigma*fvm_node->volume());
   }
 
-  if( ix.size() )
-  {
-    VecSetValues(x, ix.size(), &ix[0], &y[0], INSERT_VALUES) ;
-    VecSetValues(L, ix.size(), &ix[0], &s[0], INSERT_VALUES) ;
-  }
+  VecRestoreArray(x, &xx);
+  VecRestoreArray(L, &ll);
 }
 
 
@@ -104,6 +100,7 @@ void MetalSimulationRegion::DDM1_Function(PetscScalar * x, Vec f, InsertMode &ad
   {
     // fvm_node of node1
     const FVM_Node * fvm_n1 = (*it).first;
+    const unsigned int edge_index = it - edges_begin();
     // fvm_node of node2
     const FVM_Node * fvm_n2 = (*it).second;
 
@@ -121,10 +118,10 @@ void MetalSimulationRegion::DDM1_Function(PetscScalar * x, Vec f, InsertMode &ad
       PetscScalar V2   =  x[n2_local_offset];
 
       // truncated to positive
-      double S = std::abs(fvm_n1->cv_surface_area(fvm_n2));
+      double S = std::abs(this->edge_cv_surface_area(edge_index));
 
       // "flux" from node 2 to node 1
-      PetscScalar f = sigma*S*(V2 - V1)/fvm_n1->distance(fvm_n2) ;
+      PetscScalar f = sigma*S*(V2 - V1)/this->edge_length(edge_index) ;
 
       // ignore thoese ghost nodes
       if( fvm_n1->on_processor() )
@@ -205,6 +202,7 @@ void MetalSimulationRegion::DDM1_Jacobian(PetscScalar * x, Mat *jac, InsertMode
   {
     // fvm_node of node1
     const FVM_Node * fvm_n1 = (*it).first;
+    const unsigned int edge_index = it - edges_begin();
     // fvm_node of node2
     const FVM_Node * fvm_n2 = (*it).second;
 
@@ -228,8 +226,8 @@ void MetalSimulationRegion::DDM1_Jacobian(PetscScalar * x, Mat *jac, InsertMode
       AutoDScalar V2   =  x[n2_local_offset];   V2.setADValue(1,1.0);
 
       // truncated to positive
-      double S = std::abs(fvm_n1->cv_surface_area(fvm_n2));
-      AutoDScalar f =  sigma*S*(V2 - V1)/fvm_n1->distance(fvm_n2) ;
+      double S = std::abs(this->edge_cv_surface_area(edge_index));
+      AutoDScalar f =  sigma*S*(V2 - V1)/this->edge_length(edge_index) ;
 
       // ignore thoese ghost nodes
 
@@ -24,10 +24,14 @@
 #include "elem.h"
 #include "simulation_system.h"
 #include "semiconductor_region.h"
+#include "fvm_node_data_semiconductor.h"
 #include "solver_specify.h"
 #include "log.h"
+#include "fermi_table.h"
 
 #include "jflux1.h"
+#include "jflux_batch.h"
+#include "type_vector_dim.h"
 
 using PhysicalUnit::kb;
 using PhysicalUnit::e;
@@ -39,6 +43,45 @@ using PhysicalUnit::us;
 //#define DEBUG
 
 
+namespace
+{
+  inline PetscScalar positive_part(PetscScalar v)
+  { return std::max(v, 0.0); }
+
+  inline AutoDScalar positive_part(const AutoDScalar &v)
+  { return adtl::fmax(v, 0.0); }
+
+  /**
+   * E field parallel and vertical to current flow of a cell not on insulator interface.
+   * \p Dim is the dimension of the cell, a 2D cell skips the zero z component.
+   */
+  template <unsigned int Dim, typename T>
+  void mobility_force(ModelSpecify::MobilityForce mob_force, bool mos_channel_elem,
+                      const VectorValue<T> &E, const VectorValue<T> &Jnv, const VectorValue<T> &Jpv,
+                      T &Epn, T &Epp, T &Etn, T &Etp)
+  {
+    if(mob_force == ModelSpecify::EQF)
+    {
+      Epn = TypeVectorDim<Dim>::size(Jnv);
+      Epp = TypeVectorDim<Dim>::size(Jpv);
+    }
+    else if(mob_force == ModelSpecify::EJ)
+    {
+      Epn = positive_part(dot_unit_dim<Dim>(E, Jnv));
+      Epp = positive_part(dot_unit_dim<Dim>(E, Jpv));
+    }
+    else
+      return;
+
+    if(mos_channel_elem)
+    {
+      Etn = cross_unit_size_dim<Dim>(E, Jnv);
+      Etp = cross_unit_size_dim<Dim>(E, Jpv);
+    }
+  }
+}
+
+
 ///////////////////////////////////////////////////////////////////////
 //----------------Function and Jacobian evaluate---------------------//
 ///////////////////////////////////////////////////////////////////////
@@ -46,13 +89,12 @@ using PhysicalUnit::us;
 
 void SemiconductorSimulationRegion::DDM1_Fill_Value(Vec x, Vec L)
 {
-  std::vector<int> ix;
-  std::vector<PetscScalar> y;
-  std::vector<PetscScalar> s;
+  PetscInt start;
+  VecGetOwnershipRange(x, &start, PETSC_NULL);
 
-  ix.reserve(3*this->n_node());
-  y.reserve(3*this->n_node());
-  s.reserve(3*this->n_node());
+  PetscScalar *xx, *ll;
+  VecGetArray(x, &xx);
+  VecGetArray(L, &ll);
 
   const_processor_node_iterator node_it = on_processor_nodes_begin();
   const_processor_node_iterator node_it_end = on_processor_nodes_end();
@@ -60,30 +102,25 @@ void SemiconductorSimulationRegion::DDM1_Fill_Value(Vec x, Vec L)
   {
     const FVM_Node * fvm_node = *node_it;
     const FVM_NodeData * node_data = fvm_node->node_data();
+    const PetscInt offset = fvm_node->global_offset() - start;
 
     mt->mapping(fvm_node->root_node(), node_data, 0.0);
 
     // the first variable, psi
-    ix.push_back(fvm_node->global_offset()+0);
-    y.push_back(node_data->psi());
-    s.push_back(1.0/(node_data->eps()*fvm_node->volume()));
+    xx[offset+0] = node_data->psi();
+    ll[offset+0] = 1.0/(node_data->eps()*fvm_node->volume());
 
     // the second variable, n
-    ix.push_back(fvm_node->global_offset()+1);
-    y.push_back(node_data->n());
-    s.push_back(1.0/fvm_node->volume());
+    xx[offset+1] = node_data->n();
+    ll[offset+1] = 1.0/fvm_node->volume();
 
     // the third variable, p
-    ix.push_back(fvm_node->global_offset()+2);
-    y.push_back(node_data->p());
-    s.push_back(1.0/fvm_node->volume());
+    xx[offset+2] = node_data->p();
+    ll[offset+2] = 1.0/fvm_node->volume();
   }
 
-  if( ix.size() )
-  {
-    VecSetValues(x, ix.size(), &ix[0], &y[0], INSERT_VALUES) ;
-    VecSetValues(L, ix.size(), &ix[0], &s[0], INSERT_VALUES) ;
-  }
+  VecRestoreArray(x, &xx);
+  VecRestoreArray(L, &ll);
 }
 
 
@@ -151,12 +188,82 @@ void SemiconductorSimulationRegion::DDM1_Function(PetscScalar * x, Vec f, Insert
   const PetscScalar Vt  = kb*T/e;
   bool  highfield_mob   = highfield_mobility() && SolverSpecify::Type!=SolverSpecify::EQUILIBRIUM;
 
+  // keep the cell driving forces in cell data, the mobility evaluation of hooks and
+  // exporters reads them instead of building the gradients again.
+  // ESimple takes the force along each edge, nothing to keep for the cell
+  const bool cache_mob_force = highfield_mob && get_advanced_model()->Mob_Force != ModelSpecify::ESimple;
+  if(cache_mob_force) _mob_force_cache_allocate();
+
+  // effective intrinsic carrier concentration of each local node, indexed by local_offset.
+  // evaluate it by one batched PMI call instead of twice for each edge.
+  // the low field mobility only depends on the node, it is batched the same way
+  std::vector<PetscScalar> nie_buffer;
+  std::vector<PetscScalar> mun_buffer;
+  std::vector<PetscScalar> mup_buffer;
+  {
+    std::vector<PMI_NodeContext> context;
+    std::vector<PetscScalar> nb, pb, Tb, nie, mun, mup;
+    std::vector<unsigned int> offset;
+
+    const_local_node_iterator node_it = on_local_nodes_begin();
+    const_local_node_iterator node_it_end = on_local_nodes_end();
+    for(; node_it!=node_it_end; ++node_it)
+    {
+      const FVM_Node * fvm_node = *node_it;
+      const unsigned int local_offset = fvm_node->local_offset();
+      context.push_back( PMI_NodeContext(fvm_node->root_node(), fvm_node->node_data(), SolverSpecify::clock) );
+      nb.push_back(x[local_offset+1]);
+      pb.push_back(x[local_offset+2]);
+      Tb.push_back(T);
+      offset.push_back(local_offset);
+    }
+
+    nie.resize(context.size());
+    if( !context.empty() )
+      mt->band->nie(context.size(), &context[0], &pb[0], &nb[0], &Tb[0], &nie[0]);
+
+    unsigned int max_offset = 0;
+    for(unsigned int i=0; i<offset.size(); ++i)
+      max_offset = std::max(max_offset, offset[i]);
+    nie_buffer.resize(max_offset+1, 0.0);
+    for(unsigned int i=0; i<offset.size(); ++i)
+      nie_buffer[offset[i]] = nie[i];
+
+    if(!highfield_mob)
+    {
+      std::vector<PetscScalar> zero(context.size(), 0.0);
+      mun.resize(context.size());
+      mup.resize(context.size());
+      if( !context.empty() )
+      {
+        mt->mob->ElecMob(context.size(), &context[0], &pb[0], &nb[0], &Tb[0], &zero[0], &zero[0], &Tb[0], &mun[0]);
+        mt->mob->HoleMob(context.size(), &context[0], &pb[0], &nb[0], &Tb[0], &zero[0], &zero[0], &Tb[0], &mup[0]);
+      }
+
+      mun_buffer.resize(max_offset+1, 0.0);
+      mup_buffer.resize(max_offset+1, 0.0);
+      for(unsigned int i=0; i<offset.size(); ++i)
+      {
+        mun_buffer[offset[i]] = mun[i];
+        mup_buffer[offset[i]] = mup[i];
+      }
+    }
+  }
+
   // precompute S-G current on each edge
   std::vector<PetscScalar> Jn_edge_buffer;
   std::vector<PetscScalar> Jp_edge_buffer;
   {
-    Jn_edge_buffer.reserve(n_edge());
-    Jp_edge_buffer.reserve(n_edge());
+    // driving potential, carrier densities and length of each edge,
+    // the S-G currents are evaluated by batched kernels after the edge loop
+    std::vector<PetscScalar> dVn_edge, dVp_edge, n1_edge, n2_edge, p1_edge, p2_edge, length_edge;
+    dVn_edge.reserve(n_edge());
+    dVp_edge.reserve(n_edge());
+    n1_edge.reserve(n_edge());
+    n2_edge.reserve(n_edge());
+    p1_edge.reserve(n_edge());
+    p2_edge.reserve(n_edge());
+    length_edge.reserve(n_edge());
 
     // search all the edges of this region
     const_edge_iterator it = edges_begin();
@@ -165,6 +272,7 @@ void SemiconductorSimulationRegion::DDM1_Function(PetscScalar * x, Vec f, Insert
     {
       // fvm_node of node1
       const FVM_Node * fvm_n1 = (*it).first;
+      const unsigned int edge_index = it - edges_begin();
       // fvm_node of node2
       const FVM_Node * fvm_n2 = (*it).second;
 
@@ -176,13 +284,11 @@ void SemiconductorSimulationRegion::DDM1_Function(PetscScalar * x, Vec f, Insert
       const unsigned int n1_local_offset = fvm_n1->local_offset();
       const unsigned int n2_local_offset = fvm_n2->local_offset();
 
-      const double length = fvm_n1->distance(fvm_n2);
+      const double length = this->edge_length(edge_index);
 
       // build S-G current along edge
 
       //for node 1 of the edge
-      mt->mapping(fvm_n1->root_node(), n1_data, SolverSpecify::clock);
-
       const PetscScalar V1   =  x[n1_local_offset+0];                  // electrostatic potential
       const PetscScalar n1   =  x[n1_local_offset+1];                  // electron density
       const PetscScalar p1   =  x[n1_local_offset+2];                  // hole density
@@ -193,34 +299,37 @@ void SemiconductorSimulationRegion::DDM1_Function(PetscScalar * x, Vec f, Insert
       // takes care of the change effective DOS.
       // Ec/Ev should not be used except when its difference between two nodes.
       // The same comment applies to Ec2/Ev2.
-      PetscScalar Ec1 =  -(e*V1 + n1_data->affinity() + kb*T*log(mt->band->nie(p1, n1, T)));
-      PetscScalar Ev1 =  -(e*V1 + n1_data->affinity() - kb*T*log(mt->band->nie(p1, n1, T)));
+      PetscScalar Ec1 =  -(e*V1 + n1_data->affinity() + kb*T*log(nie_buffer[n1_local_offset]));
+      PetscScalar Ev1 =  -(e*V1 + n1_data->affinity() - kb*T*log(nie_buffer[n1_local_offset]));
       if(get_advanced_model()->Fermi)
       {
-        Ec1 = Ec1 - e*Vt*log(gamma_f(fabs(n1)/n1_data->Nc()));
-        Ev1 = Ev1 + e*Vt*log(gamma_f(fabs(p1)/n1_data->Nv()));
+        Ec1 = Ec1 - e*Vt*log_gamma_f(fabs(n1)/n1_data->Nc(), get_advanced_model()->FermiTable);
+        Ev1 = Ev1 + e*Vt*log_gamma_f(fabs(p1)/n1_data->Nv(), get_advanced_model()->FermiTable);
       }
       const PetscScalar eps1 =  n1_data->eps();
 
       //for node 2 of the edge
-      mt->mapping(fvm_n2->root_node(), n2_data, SolverSpecify::clock);
-
       const PetscScalar V2   =  x[n2_local_offset+0];                   // electrostatic potential
       const PetscScalar n2   =  x[n2_local_offset+1];                   // electron density
       const PetscScalar p2   =  x[n2_local_offset+2];                   // hole density
 
-      PetscScalar Ec2 =  -(e*V2 + n2_data->affinity() + kb*T*log(mt->band->nie(p2, n2, T)));
-      PetscScalar Ev2 =  -(e*V2 + n2_data->affinity() - kb*T*log(mt->band->nie(p2, n2, T)));
+      PetscScalar Ec2 =  -(e*V2 + n2_data->affinity() + kb*T*log(nie_buffer[n2_local_offset]));
+      PetscScalar Ev2 =  -(e*V2 + n2_data->affinity() - kb*T*log(nie_buffer[n2_local_offset]));
       if(get_advanced_model()->Fermi)
       {
-        Ec2 = Ec2 - e*Vt*log(gamma_f(fabs(n2)/n2_data->Nc()));
-        Ev2 = Ev2 + e*Vt*log(gamma_f(fabs(p2)/n2_data->Nv()));
+        Ec2 = Ec2 - e*Vt*log_gamma_f(fabs(n2)/n2_data->Nc(), get_advanced_model()->FermiTable);
+        Ev2 = Ev2 + e*Vt*log_gamma_f(fabs(p2)/n2_data->Nv(), get_advanced_model()->FermiTable);
       }
       const PetscScalar eps2 =  n2_data->eps();
 
       // S-G current along the edge
-      Jn_edge_buffer.push_back( In_dd(Vt,(Ec2-Ec1)/e,n1,n2,length) );
-      Jp_edge_buffer.push_back( Ip_dd(Vt,(Ev2-Ev1)/e,p1,p2,length) );
+      dVn_edge.push_back((Ec2-Ec1)/e);
+      dVp_edge.push_back((Ev2-Ev1)/e);
+      n1_edge.push_back(n1);
+      n2_edge.push_back(n2);
+      p1_edge.push_back(p1);
+      p2_edge.push_back(p2);
+      length_edge.push_back(length);
 
 
       // poisson's equation
@@ -228,7 +337,7 @@ void SemiconductorSimulationRegion::DDM1_Function(PetscScalar * x, Vec f, Insert
       PetscScalar eps = 0.5*(eps1+eps2);
 
       // "flux" from node 2 to node 1
-      PetscScalar f =  eps*fvm_n1->cv_surface_area(fvm_n2)*(V2 - V1)/fvm_n1->distance(fvm_n2) ;
+      PetscScalar f =  eps*this->edge_cv_surface_area(edge_index)*(V2 - V1)/this->edge_length(edge_index) ;
 
       // ignore thoese ghost nodes
       if( fvm_n1->on_processor() )
@@ -243,11 +352,30 @@ void SemiconductorSimulationRegion::DDM1_Function(PetscScalar * x, Vec f, Insert
         flux.push_back(-f);
       }
     }
+
+    Jn_edge_buffer.resize(length_edge.size());
+    Jp_edge_buffer.resize(length_edge.size());
+    if( !length_edge.empty() )
+    {
+      In_dd_batch(length_edge.size(), Vt, &dVn_edge[0], &n1_edge[0], &n2_edge[0], &length_edge[0], &Jn_edge_buffer[0]);
+      Ip_dd_batch(length_edge.size(), Vt, &dVp_edge[0], &p1_edge[0], &p2_edge[0], &length_edge[0], &Jp_edge_buffer[0]);
+    }
   }
 
   // then, search all the element in this region and process "cell" related terms
   // note, they are all local element, thus must be processed
+  // the loop is not threaded: the mobility models may keep scratch members between calls
+
 
+  // hoisted out of the element loop to reuse their storage
+  std::vector<PetscScalar> psi_vertex;
+  std::vector<PetscScalar> phin_vertex;
+  std::vector<PetscScalar> phip_vertex;
+  std::vector<PetscScalar> Jn_edge_cell;
+  std::vector<PetscScalar> Jp_edge_cell;
+  std::vector<unsigned int> sides;
+  std::vector<SimulationRegion *> regions;
+  std::vector<PetscScalar> psi_vertex_neighbor;
 
   const_element_iterator it = elements_begin();
   const_element_iterator it_end = elements_end();
@@ -261,8 +389,8 @@ void SemiconductorSimulationRegion::DDM1_Function(PetscScalar * x, Vec f, Insert
     bool truncation =  SolverSpecify::VoronoiTruncation == SolverSpecify::VoronoiTruncationAlways ||
         (SolverSpecify::VoronoiTruncation == SolverSpecify::VoronoiTruncationBoundary && is_elem_touch_boundary(elem)) ;
 
-    std::vector<PetscScalar> Jn_edge_cell; //store all the edge Jn
-    std::vector<PetscScalar> Jp_edge_cell; //store all the edge Jp
+    Jn_edge_cell.clear(); //store all the edge Jn
+    Jp_edge_cell.clear(); //store all the edge Jp
 
     // E field parallel to current flow
     PetscScalar Epn=0;
@@ -282,9 +410,9 @@ void SemiconductorSimulationRegion::DDM1_Function(PetscScalar * x, Vec f, Insert
     {
       // build the gradient of psi and fermi potential in this cell.
       // which are the vector of electric field and current density.
-      std::vector<PetscScalar> psi_vertex(elem->n_nodes());
-      std::vector<PetscScalar> phin_vertex(elem->n_nodes());
-      std::vector<PetscScalar> phip_vertex(elem->n_nodes());
+      psi_vertex.resize(elem->n_nodes());
+      phin_vertex.resize(elem->n_nodes());
+      phip_vertex.resize(elem->n_nodes());
 
       for(unsigned int nd=0; nd<elem->n_nodes(); ++nd)
       {
@@ -331,13 +459,13 @@ void SemiconductorSimulationRegion::DDM1_Function(PetscScalar * x, Vec f, Insert
       if(get_advanced_model()->ESurface && insulator_interface_elem)
       {
         // get all the sides on insulator interface
-        std::vector<unsigned int> sides;
-        std::vector<SimulationRegion *> regions;
+        sides.clear();
+        regions.clear();
         elem_on_insulator_interface(elem, sides, regions);
         const Elem * elem_insul=elem->neighbor(sides[0]);
         SimulationRegion * region_insul=regions[0];
 
-        std::vector<PetscScalar> psi_vertex_neighbor;
+        psi_vertex_neighbor.clear();
         for(unsigned int nd=0; nd<elem_insul->n_nodes(); ++nd)
         {
           const FVM_Node * fvm_node_neighbor = elem_insul->get_fvm_node(nd);
@@ -371,36 +499,27 @@ void SemiconductorSimulationRegion::DDM1_Function(PetscScalar * x, Vec f, Insert
       }
       else // elem NOT on insulator interface
       {
-        if(get_advanced_model()->Mob_Force == ModelSpecify::EQF)
-        {
-          // E field parallel to current flow
-          Epn = Jnv.size();
-          Epp = Jpv.size();
+        if(elem->dim() == 2)
+          mobility_force<2>(get_advanced_model()->Mob_Force, mos_channel_elem, E, Jnv, Jpv, Epn, Epp, Etn, Etp);
+        else
+          mobility_force<3>(get_advanced_model()->Mob_Force, mos_channel_elem, E, Jnv, Jpv, Epn, Epp, Etn, Etp);
+      }
+    }
 
-          if(mos_channel_elem)
-          {
-            // E field vertical to current flow
-            Etn = (E.cross(Jnv.unit(true))).size();
-            Etp = (E.cross(Jpv.unit(true))).size();
-          }
-        }
+    if(cache_mob_force)
+    {
+      elem_data->Epn() = Epn;
+      elem_data->Epp() = Epp;
+      elem_data->Etn() = Etn;
+      elem_data->Etp() = Etp;
+    }
 
-        if(get_advanced_model()->Mob_Force == ModelSpecify::EJ)
-        {
-          // E field parallel to current flow
-          Epn = std::max(E.dot(Jnv.unit(true)), 0.0);
-          Epp = std::max(E.dot(Jpv.unit(true)), 0.0);
 
-          if(mos_channel_elem)
-          {
-            // E field vertical to current flow
-            Etn = (E.cross(Jnv.unit(true))).size();
-            Etp = (E.cross(Jpv.unit(true))).size();
-          }
-        }
-      }
-    }
+    // magnitude of E field, for band to band tunneling and impact ionization
+    const PetscScalar E_size = elem->dim() == 2 ? TypeVectorDim<2>::size(E) : TypeVectorDim<3>::size(E);
 
+    // the edges of this cell in the region edge tables
+    const unsigned int cell_edge = this->cell_edge_offset(elem);
 
     // process \nabla psi and S-G current along the cell's edge
     // search for all the edges this cell own
@@ -409,7 +528,7 @@ void SemiconductorSimulationRegion::DDM1_Function(PetscScalar * x, Vec f, Insert
       std::pair<unsigned int, unsigned int> edge_nodes;
       elem->nodes_on_edge(ne, edge_nodes);
 
-      const unsigned int edge_index = this->elem_edge_index(elem, ne);
+      const unsigned int edge_index = this->cell_edge_index(cell_edge+ne);
 
       const double length = elem->edge_length(ne);                         // the length of this edge
 
@@ -423,8 +542,8 @@ void SemiconductorSimulationRegion::DDM1_Function(PetscScalar * x, Vec f, Insert
       if(truncation)
       {
         // use truncated partial area to avoid negative area due to bad mesh elem
-        truncated_partial_area =  this->truncated_partial_area(elem, ne);
-        truncated_partial_volume =  elem->partial_volume_with_edge_truncated(ne);
+        truncated_partial_area =  this->cell_edge_truncated_partial_area(cell_edge+ne);
+        truncated_partial_volume =  this->cell_edge_truncated_partial_volume(cell_edge+ne);
       }
 
 
@@ -503,15 +622,16 @@ void SemiconductorSimulationRegion::DDM1_Function(PetscScalar * x, Vec f, Insert
             }
           }
         }
-        else // low field mobility
+        else // low field mobility, use the batched node value
         {
-          mt->mapping(fvm_n1->root_node(), n1_data, SolverSpecify::clock);
-          mun1 = mt->mob->ElecMob(p1, n1, T, 0, 0, T);
-          mup1 = mt->mob->HoleMob(p1, n1, T, 0, 0, T);
+          mun1 = mun_buffer[n1_local_offset];
+          mup1 = mup_buffer[n1_local_offset];
+
+          mun2 = mun_buffer[n2_local_offset];
+          mup2 = mup_buffer[n2_local_offset];
 
+          // the band to band tunneling and impact ionization below are evaluated at node 2
           mt->mapping(fvm_n2->root_node(), n2_data, SolverSpecify::clock);
-          mun2 = mt->mob->ElecMob(p2, n2, T, 0, 0, T);
-          mup2 = mt->mob->HoleMob(p2, n2, T, 0, 0, T);
         }
 
 
@@ -563,8 +683,8 @@ void SemiconductorSimulationRegion::DDM1_Function(PetscScalar * x, Vec f, Insert
         if (get_advanced_model()->BandBandTunneling && SolverSpecify::Type!=SolverSpecify::EQUILIBRIUM)
         {
 
-          PetscScalar GBTBT1 = mt->band->BB_Tunneling(T, E.size());
-          PetscScalar GBTBT2 = mt->band->BB_Tunneling(T, E.size());
+          PetscScalar GBTBT1 = mt->band->BB_Tunneling(T, E_size);
+          PetscScalar GBTBT2 = mt->band->BB_Tunneling(T, E_size);
 
           if( fvm_n1->on_processor() )
           {
@@ -603,14 +723,14 @@ void SemiconductorSimulationRegion::DDM1_Function(PetscScalar * x, Vec f, Insert
           switch (get_advanced_model()->II_Force)
           {
               case ModelSpecify::IIForce_EdotJ:
-              Epn = std::max(E.dot(Jnv.unit(true)), 0.0);
-              Epp = std::max(E.dot(Jpv.unit(true)), 0.0);
+              Epn = positive_part(elem->dim() == 2 ? dot_unit_dim<2>(E, Jnv) : dot_unit_dim<3>(E, Jnv));
+              Epp = positive_part(elem->dim() == 2 ? dot_unit_dim<2>(E, Jpv) : dot_unit_dim<3>(E, Jpv));
               IIn = mt->gen->ElecGenRate(T,Epn,Eg);
               IIp = mt->gen->HoleGenRate(T,Epp,Eg);
               break;
               case ModelSpecify::EVector:
-              IIn = mt->gen->ElecGenRate(T,E.size(),Eg);
-              IIp = mt->gen->HoleGenRate(T,E.size(),Eg);
+              IIn = mt->gen->ElecGenRate(T,E_size,Eg);
+              IIp = mt->gen->HoleGenRate(T,E_size,Eg);
               break;
               case ModelSpecify::ESide:
               IIn = mt->gen->ElecGenRate(T,fabs((V2-V1)/length),Eg);
@@ -713,7 +833,9 @@ void SemiconductorSimulationRegion::DDM1_Function(PetscScalar * x, Vec f, Insert
 
       // call the Trap MPI to calculate trap occupancy using the local carrier densities and lattice temperature
       PetscScalar ni = mt->band->nie(p, n, T);
-      mt->trap->Calculate(true,p,n,ni,T);
+      // trap occupancy is frozen between steps when advanced explicitly
+      if (!get_advanced_model()->TrapExplicit)
+        mt->trap->Calculate(true,p,n,ni,T);
 
       // calculate the contribution of trapped charge to Poisson's equation
       PetscScalar TrappedC = mt->trap->Charge(true) * fvm_node->volume();
@@ -745,10 +867,20 @@ void SemiconductorSimulationRegion::DDM1_Function(PetscScalar * x, Vec f, Insert
   // add into petsc vector, we should prevent zero length vector add here.
   if(isource.size())  VecSetValues(f, isource.size(), &isource[0], &source[0], ADD_VALUES);
 
+  // nonlocal band band tunneling along the cached tunneling paths
+  if( bbt_nonlocal() )
+  {
+    update_bbt_nonlocal_path(x);
+    BBT_Nonlocal_Function(x, f, invalid_uint);
+  }
+
 
   // after the first scan, every nodes are updated.
   // however, boundary condition should be processed later.
 
+  // SNES evaluates the residual at the accepted solution last, the cached forces belong to it
+  _mob_force_cached = cache_mob_force;
+
   // the last operator is ADD_VALUES
   add_value_flag = ADD_VALUES;
 
@@ -763,24 +895,62 @@ void SemiconductorSimulationRegion::DDM1_Function(PetscScalar * x, Vec f, Insert
 
 
 /*---------------------------------------------------------------------
- * build function and its jacobian for DDML1 solver
- * AD is fully used here
+ * build jacobian for DDML1 solver
  */
 void SemiconductorSimulationRegion::DDM1_Jacobian(PetscScalar * x, Mat *jac, InsertMode &add_value_flag)
 {
-  // note, we will use ADD_VALUES to set values of matrix J
-  // if the previous operator is not ADD_VALUES, we should flush the matrix
+  this->DDM1_Function_Jacobian(x, PETSC_NULL, jac, add_value_flag);
+}
+
+
+/*---------------------------------------------------------------------
+ * build function and its jacobian for DDML1 solver
+ * AD is fully used here, the function is assembled from the values of AD pass when f is given
+ */
+void SemiconductorSimulationRegion::DDM1_Function_Jacobian(PetscScalar * x, Vec f, Mat *jac, InsertMode &add_value_flag)
+{
+  // note, we will use ADD_VALUES to set values of vec f and matrix J
+  // if the previous operator is not ADD_VALUES, we should flush them
   if( (add_value_flag != ADD_VALUES) && (add_value_flag != NOT_SET_VALUES) )
   {
+    if(f)
+    {
+      VecAssemblyBegin(f);
+      VecAssemblyEnd(f);
+    }
     MatAssemblyBegin(*jac, MAT_FLUSH_ASSEMBLY);
     MatAssemblyEnd(*jac, MAT_FLUSH_ASSEMBLY);
   }
 
+  // the function value and its side effects on node and cell data are the same as DDM1_Function
+  const bool residual = (f != PETSC_NULL);
+
+  // buffer for function value
+  std::vector<PetscInt>          iresidual;
+  std::vector<PetscScalar>       residual_value;
+  if(residual)
+  {
+    iresidual.reserve(3*(24*this->n_cell()) + 3*this->n_node());
+    residual_value.reserve(3*(24*this->n_cell()) + 3*this->n_node());
+
+    if (get_advanced_model()->ImpactIonization && SolverSpecify::Type!=SolverSpecify::EQUILIBRIUM)
+    {
+      processor_node_iterator node_it = on_processor_nodes_begin();
+      processor_node_iterator node_it_end = on_processor_nodes_end();
+      for(; node_it!=node_it_end; ++node_it)
+        (*node_it)->node_data()->ImpactIonization() = 0.0;
+    }
+  }
+
   //common used variable
   const PetscScalar T   = T_external();
   const PetscScalar Vt  = kb*T/e;
   bool  highfield_mob   = highfield_mobility() && SolverSpecify::Type!=SolverSpecify::EQUILIBRIUM;
 
+  // keep the cell driving forces in cell data as DDM1_Function does
+  const bool cache_mob_force = residual && highfield_mob && get_advanced_model()->Mob_Force != ModelSpecify::ESimple;
+  if(cache_mob_force) _mob_force_cache_allocate();
+
   // precompute S-G current on each edge
   std::vector<AutoDScalar> Jn_edge_buffer;
   std::vector<AutoDScalar> Jp_edge_buffer;
@@ -801,6 +971,7 @@ void SemiconductorSimulationRegion::DDM1_Jacobian(PetscScalar * x, Mat *jac, Ins
     {
       // fvm_node of node1
       const FVM_Node * fvm_n1 = (*it).first;
+      const unsigned int edge_index = it - edges_begin();
       // fvm_node of node2
       const FVM_Node * fvm_n2 = (*it).second;
 
@@ -812,7 +983,7 @@ void SemiconductorSimulationRegion::DDM1_Jacobian(PetscScalar * x, Mat *jac, Ins
       const unsigned int n1_local_offset = fvm_n1->local_offset();
       const unsigned int n2_local_offset = fvm_n2->local_offset();
 
-      const double length = fvm_n1->distance(fvm_n2);
+      const double length = this->edge_length(edge_index);
 
       // build S-G current along edge
 
@@ -834,8 +1005,8 @@ void SemiconductorSimulationRegion::DDM1_Jacobian(PetscScalar * x, Mat *jac, Ins
       AutoDScalar Ev1 =  -(e*V1 + n1_data->affinity() - kb*T*log(mt->band->nie(p1, n1, T)) );
       if(get_advanced_model()->Fermi)
       {
-        Ec1 = Ec1 - e*Vt*log(gamma_f(fabs(n1)/n1_data->Nc()));
-        Ev1 = Ev1 + e*Vt*log(gamma_f(fabs(p1)/n1_data->Nv()));
+        Ec1 = Ec1 - e*Vt*log_gamma_f(fabs(n1)/n1_data->Nc(), get_advanced_model()->FermiTable);
+        Ev1 = Ev1 + e*Vt*log_gamma_f(fabs(p1)/n1_data->Nv(), get_advanced_model()->FermiTable);
       }
       const PetscScalar eps1 =  n1_data->eps();
 
@@ -850,19 +1021,19 @@ void SemiconductorSimulationRegion::DDM1_Jacobian(PetscScalar * x, Mat *jac, Ins
       AutoDScalar Ev2 =  -(e*V2 + n2_data->affinity() - kb*T*log(mt->band->nie(p2, n2, T)) );
       if(get_advanced_model()->Fermi)
       {
-        Ec2 = Ec2 - e*Vt*log(gamma_f(fabs(n2)/n2_data->Nc()));
-        Ev2 = Ev2 + e*Vt*log(gamma_f(fabs(p2)/n2_data->Nv()));
+        Ec2 = Ec2 - e*Vt*log_gamma_f(fabs(n2)/n2_data->Nc(), get_advanced_model()->FermiTable);
+        Ev2 = Ev2 + e*Vt*log_gamma_f(fabs(p2)/n2_data->Nv(), get_advanced_model()->FermiTable);
       }
       const PetscScalar eps2 =  n2_data->eps();
 
-      // S-G current along the edge
-      Jn_edge_buffer.push_back( In_dd(Vt,(Ec2-Ec1)/e,n1,n2,length) );
-      Jp_edge_buffer.push_back( Ip_dd(Vt,(Ev2-Ev1)/e,p1,p2,length) );
+      // S-G current along the edge, AD by the explicit flux derivatives
+      Jn_edge_buffer.push_back( In_dd_grad(Vt,(Ec2-Ec1)/e,n1,n2,length) );
+      Jp_edge_buffer.push_back( Ip_dd_grad(Vt,(Ev2-Ev1)/e,p1,p2,length) );
 
       // poisson's equation
 
       const PetscScalar eps = 0.5*(eps1+eps2);
-      AutoDScalar f_phi =  eps*fvm_n1->cv_surface_area(fvm_n2)*(V2 - V1)/length ;
+      AutoDScalar f_phi =  eps*this->edge_cv_surface_area(edge_index)*(V2 - V1)/length ;
 
       PetscInt row[2],col[2];
       row[0] = col[0] = fvm_n1->global_offset();
@@ -873,12 +1044,22 @@ void SemiconductorSimulationRegion::DDM1_Jacobian(PetscScalar * x, Mat *jac, Ins
       {
         MatSetValue(*jac, row[0], col[0], f_phi.getADValue(0), ADD_VALUES);
         MatSetValue(*jac, row[0], col[1], f_phi.getADValue(3), ADD_VALUES);
+        if(residual)
+        {
+          iresidual.push_back(row[0]);
+          residual_value.push_back(f_phi.getValue());
+        }
       }
 
       if( fvm_n2->on_processor() )
       {
         MatSetValue(*jac, row[1], col[0], -f_phi.getADValue(0), ADD_VALUES);
         MatSetValue(*jac, row[1], col[1], -f_phi.getADValue(3), ADD_VALUES);
+        if(residual)
+        {
+          iresidual.push_back(row[1]);
+          residual_value.push_back(-f_phi.getValue());
+        }
       }
 
     }
@@ -886,10 +1067,20 @@ void SemiconductorSimulationRegion::DDM1_Jacobian(PetscScalar * x, Mat *jac, Ins
 
   // search all the element in this region.
   // note, they are all local element, thus must be processed
+  // not threaded, as in DDM1_Function
+
+  std::vector<AutoDScalar> psi_vertex;
+  std::vector<AutoDScalar> phin_vertex;
+  std::vector<AutoDScalar> phip_vertex;
+  std::vector<unsigned int> sides;
+  std::vector<SimulationRegion *> regions;
+  std::vector<AutoDScalar> psi_vertex_neighbor;
+  std::vector<PetscScalar> Jn_edge_cell;
+  std::vector<PetscScalar> Jp_edge_cell;
 
   const_element_iterator it = elements_begin();
   const_element_iterator it_end = elements_end();
-  for(; it!=it_end; ++it)
+  for(unsigned int nelem=0; it!=it_end; ++it, ++nelem)
   {
     const Elem * elem = *it;
     bool insulator_interface_elem = is_elem_on_insulator_interface(elem);
@@ -936,9 +1127,9 @@ void SemiconductorSimulationRegion::DDM1_Jacobian(PetscScalar * x, Mat *jac, Ins
       // which are the vector of electric field and current density.
       // here use type AutoDScalar, we should make sure the order of independent variable keeps the
       // same all the time
-      std::vector<AutoDScalar> psi_vertex;
-      std::vector<AutoDScalar> phin_vertex;
-      std::vector<AutoDScalar> phip_vertex;
+      psi_vertex.clear();
+      phin_vertex.clear();
+      phip_vertex.clear();
 
       for(unsigned int nd=0; nd<elem->n_nodes(); ++nd)
       {
@@ -989,14 +1180,14 @@ void SemiconductorSimulationRegion::DDM1_Jacobian(PetscScalar * x, Mat *jac, Ins
       if(get_advanced_model()->ESurface && insulator_interface_elem)
       {
         // get all the sides on insulator interface
-        std::vector<unsigned int> sides;
-        std::vector<SimulationRegion *> regions;
+        sides.clear();
+        regions.clear();
         elem_on_insulator_interface(elem, sides, regions);
         genius_assert(!sides.empty());
         const Elem * elem_insul=elem->neighbor(sides[0]);
         SimulationRegion * region_insul=regions[0];
 
-        std::vector<AutoDScalar> psi_vertex_neighbor;
+        psi_vertex_neighbor.clear();
         for(unsigned int nd=0; nd<elem_insul->n_nodes(); ++nd)
         {
           const FVM_Node * fvm_node_neighbor = elem_insul->get_fvm_node(nd);
@@ -1043,36 +1234,31 @@ void SemiconductorSimulationRegion::DDM1_Jacobian(PetscScalar * x, Mat *jac, Ins
       }
       else // elem NOT on insulator interface
       {
-        if(get_advanced_model()->Mob_Force == ModelSpecify::EQF)
-        {
-          // E field parallel to current flow
-          Epn = Jnv.size();
-          Epp = Jpv.size();
+        if(elem->dim() == 2)
+          mobility_force<2>(get_advanced_model()->Mob_Force, mos_channel_elem, E, Jnv, Jpv, Epn, Epp, Etn, Etp);
+        else
+          mobility_force<3>(get_advanced_model()->Mob_Force, mos_channel_elem, E, Jnv, Jpv, Epn, Epp, Etn, Etp);
+      }
+    }
 
-          if(mos_channel_elem)
-          {
-            // E field vertical to current flow
-            Etn = (E.cross(Jnv.unit(true))).size();
-            Etp = (E.cross(Jpv.unit(true))).size();
-          }
-        }
+    FVM_CellData * elem_data = this->get_region_elem_data(nelem);
+    if(cache_mob_force)
+    {
+      elem_data->Epn() = Epn.getValue();
+      elem_data->Epp() = Epp.getValue();
+      elem_data->Etn() = Etn.getValue();
+      elem_data->Etp() = Etp.getValue();
+    }
 
-        if(get_advanced_model()->Mob_Force == ModelSpecify::EJ)
-        {
-          // E field parallel to current flow
-          Epn = adtl::fmax(E.dot(Jnv.unit(true)), 0.0);
-          Epp = adtl::fmax(E.dot(Jpv.unit(true)), 0.0);
+    Jn_edge_cell.clear(); //store all the edge Jn
+    Jp_edge_cell.clear(); //store all the edge Jp
 
-          if(mos_channel_elem)
-          {
-            // E field vertical to current flow
-            Etn = (E.cross(Jnv.unit(true))).size();
-            Etp = (E.cross(Jpv.unit(true))).size();
-          }
-        }
-      }
-    }
 
+    // magnitude of E field, for band to band tunneling and impact ionization
+    const AutoDScalar E_size = elem->dim() == 2 ? TypeVectorDim<2>::size(E) : TypeVectorDim<3>::size(E);
+
+    // the edges of this cell in the region edge tables
+    const unsigned int cell_edge = this->cell_edge_offset(elem);
 
     // process conservation terms: laplace operator of poisson's equation and div operator of continuation equation
     // search for all the Edge this cell own
@@ -1081,13 +1267,13 @@ void SemiconductorSimulationRegion::DDM1_Jacobian(PetscScalar * x, Mat *jac, Ins
       std::pair<unsigned int, unsigned int> edge_nodes;
       elem->nodes_on_edge(ne, edge_nodes);
 
-      const unsigned int edge_index = this->elem_edge_index(elem, ne);
+      const unsigned int edge_index = this->cell_edge_index(cell_edge+ne);
 
       // the length of this edge
       const double length = elem->edge_length(ne);
 
-      const FVM_Node * fvm_n1 = elem->get_fvm_node(edge_nodes.first);   // fvm_node of node1
-      const FVM_Node * fvm_n2 = elem->get_fvm_node(edge_nodes.second);  // fvm_node of node2
+      FVM_Node * fvm_n1 = elem->get_fvm_node(edge_nodes.first);   // fvm_node of node1
+      FVM_Node * fvm_n2 = elem->get_fvm_node(edge_nodes.second);  // fvm_node of node2
 
       double partial_area = elem->partial_area_with_edge(ne);        // partial area associated with this edge
       double partial_volume = elem->partial_volume_with_edge(ne);    // partial volume associated with this edge
@@ -1096,17 +1282,17 @@ void SemiconductorSimulationRegion::DDM1_Jacobian(PetscScalar * x, Mat *jac, Ins
       if(truncation)
       {
         // use truncated partial area to avoid negative area due to bad mesh elem
-        truncated_partial_area =  this->truncated_partial_area(elem, ne);
-        truncated_partial_volume =  elem->partial_volume_with_edge_truncated(ne);
+        truncated_partial_area =  this->cell_edge_truncated_partial_area(cell_edge+ne);
+        truncated_partial_volume =  this->cell_edge_truncated_partial_volume(cell_edge+ne);
       }
 
       bool inverse = fvm_n1->root_node()->id() > fvm_n2->root_node()->id();       // find the correct order
 
 
       // fvm_node_data of node1
-      const FVM_NodeData * n1_data =  fvm_n1->node_data();
+      FVM_NodeData * n1_data =  fvm_n1->node_data();
       // fvm_node_data of node2
-      const FVM_NodeData * n2_data =  fvm_n2->node_data();
+      FVM_NodeData * n2_data =  fvm_n2->node_data();
 
       const unsigned int n1_local_offset = fvm_n1->local_offset();
       const unsigned int n2_local_offset = fvm_n2->local_offset();
@@ -1225,6 +1411,12 @@ void SemiconductorSimulationRegion::DDM1_Jacobian(PetscScalar * x, Mat *jac, Ins
         AutoDScalar Jn = (inverse ? -1.0 : 1.0)*mun*AutoDScalar(Jn_edge, order, 6);
         AutoDScalar Jp = (inverse ? -1.0 : 1.0)*mup*AutoDScalar(Jp_edge, order, 6);
 
+        if(residual)
+        {
+          Jn_edge_cell.push_back(Jn.getValue());
+          Jp_edge_cell.push_back(Jp.getValue());
+        }
+
         // ignore thoese ghost nodes (ghost nodes is local but with different processor_id())
         if( fvm_n1->on_processor() )
         {
@@ -1234,6 +1426,11 @@ void SemiconductorSimulationRegion::DDM1_Jacobian(PetscScalar * x, Mat *jac, Ins
           // general coding always has some overkill... bypass it.
           MatSetValues(*jac, 1, &row[1], cell_col.size(), &cell_col[0], f_Jn.getADValue(), ADD_VALUES);
           MatSetValues(*jac, 1, &row[2], cell_col.size(), &cell_col[0], f_Jp.getADValue(), ADD_VALUES);
+          if(residual)
+          {
+            iresidual.push_back(row[1]);  residual_value.push_back(f_Jn.getValue());
+            iresidual.push_back(row[2]);  residual_value.push_back(f_Jp.getValue());
+          }
         }
 
         if( fvm_n2->on_processor() )
@@ -1243,14 +1440,19 @@ void SemiconductorSimulationRegion::DDM1_Jacobian(PetscScalar * x, Mat *jac, Ins
           AutoDScalar f_Jp  =  Jp*truncated_partial_area;
           MatSetValues(*jac, 1, &row[4], cell_col.size(), &cell_col[0], f_Jn.getADValue(), ADD_VALUES);
           MatSetValues(*jac, 1, &row[5], cell_col.size(), &cell_col[0], f_Jp.getADValue(), ADD_VALUES);
+          if(residual)
+          {
+            iresidual.push_back(row[4]);  residual_value.push_back(f_Jn.getValue());
+            iresidual.push_back(row[5]);  residual_value.push_back(f_Jp.getValue());
+          }
         }
 
         // BandBandTunneling && ImpactIonization
 
         if (get_advanced_model()->BandBandTunneling && SolverSpecify::Type!=SolverSpecify::EQUILIBRIUM)
         {
-          AutoDScalar GBTBT1 = mt->band->BB_Tunneling(T, E.size());
-          AutoDScalar GBTBT2 = mt->band->BB_Tunneling(T, E.size());
+          AutoDScalar GBTBT1 = mt->band->BB_Tunneling(T, E_size);
+          AutoDScalar GBTBT2 = mt->band->BB_Tunneling(T, E_size);
 
           if( fvm_n1->on_processor() )
           {
@@ -1258,6 +1460,11 @@ void SemiconductorSimulationRegion::DDM1_Jacobian(PetscScalar * x, Mat *jac, Ins
             AutoDScalar continuity = 0.5*GBTBT1*truncated_partial_volume;
             MatSetValues(*jac, 1, &row[1], cell_col.size(), &cell_col[0], continuity.getADValue(), ADD_VALUES);
             MatSetValues(*jac, 1, &row[2], cell_col.size(), &cell_col[0], continuity.getADValue(), ADD_VALUES);
+            if(residual)
+            {
+              iresidual.push_back(row[1]);  residual_value.push_back(continuity.getValue());
+              iresidual.push_back(row[2]);  residual_value.push_back(continuity.getValue());
+            }
           }
 
           if( fvm_n2->on_processor() )
@@ -1266,6 +1473,11 @@ void SemiconductorSimulationRegion::DDM1_Jacobian(PetscScalar * x, Mat *jac, Ins
             AutoDScalar continuity = 0.5*GBTBT2*truncated_partial_volume;
             MatSetValues(*jac, 1, &row[4], cell_col.size(), &cell_col[0], continuity.getADValue(), ADD_VALUES);
             MatSetValues(*jac, 1, &row[5], cell_col.size(), &cell_col[0], continuity.getADValue(), ADD_VALUES);
+            if(residual)
+            {
+              iresidual.push_back(row[4]);  residual_value.push_back(continuity.getValue());
+              iresidual.push_back(row[5]);  residual_value.push_back(continuity.getValue());
+            }
           }
         }
 
@@ -1288,14 +1500,14 @@ void SemiconductorSimulationRegion::DDM1_Jacobian(PetscScalar * x, Mat *jac, Ins
           switch (get_advanced_model()->II_Force)
           {
               case ModelSpecify::IIForce_EdotJ:
-              Epn = adtl::fmax(E.dot(Jnv.unit(true)), 0.0);
-              Epp = adtl::fmax(E.dot(Jpv.unit(true)), 0.0);
+              Epn = positive_part(elem->dim() == 2 ? dot_unit_dim<2>(E, Jnv) : dot_unit_dim<3>(E, Jnv));
+              Epp = positive_part(elem->dim() == 2 ? dot_unit_dim<2>(E, Jpv) : dot_unit_dim<3>(E, Jpv));
               IIn = mt->gen->ElecGenRate(T,Epn,Eg);
               IIp = mt->gen->HoleGenRate(T,Epp,Eg);
               break;
               case ModelSpecify::EVector:
-              IIn = mt->gen->ElecGenRate(T,E.size(),Eg);
-              IIp = mt->gen->HoleGenRate(T,E.size(),Eg);
+              IIn = mt->gen->ElecGenRate(T,E_size,Eg);
+              IIp = mt->gen->HoleGenRate(T,E_size,Eg);
               break;
               case ModelSpecify::ESide:
               IIn = mt->gen->ElecGenRate(T,fabs((V2-V1)/length),Eg);
@@ -1321,6 +1533,12 @@ void SemiconductorSimulationRegion::DDM1_Jacobian(PetscScalar * x, Mat *jac, Ins
             AutoDScalar hole_continuity     = (riin1*GIIn+riip1*GIIp)*truncated_partial_volume ;
             MatSetValues(*jac, 1, &row[1], cell_col.size(), &cell_col[0], electron_continuity.getADValue(), ADD_VALUES);
             MatSetValues(*jac, 1, &row[2], cell_col.size(), &cell_col[0], hole_continuity.getADValue(), ADD_VALUES);
+            if(residual)
+            {
+              iresidual.push_back(row[1]);  residual_value.push_back(electron_continuity.getValue());
+              iresidual.push_back(row[2]);  residual_value.push_back(hole_continuity.getValue());
+              n1_data->ImpactIonization() += electron_continuity.getValue()/fvm_n1->volume();
+            }
           }
 
           if( fvm_n2->on_processor() )
@@ -1330,12 +1548,25 @@ void SemiconductorSimulationRegion::DDM1_Jacobian(PetscScalar * x, Mat *jac, Ins
             AutoDScalar hole_continuity     = (riin2*GIIn+riip2*GIIp)*truncated_partial_volume ;
             MatSetValues(*jac, 1, &row[4], cell_col.size(), &cell_col[0], electron_continuity.getADValue(), ADD_VALUES);
             MatSetValues(*jac, 1, &row[5], cell_col.size(), &cell_col[0], hole_continuity.getADValue(), ADD_VALUES);
+            if(residual)
+            {
+              iresidual.push_back(row[4]);  residual_value.push_back(electron_continuity.getValue());
+              iresidual.push_back(row[5]);  residual_value.push_back(hole_continuity.getValue());
+              n2_data->ImpactIonization() += electron_continuity.getValue()/fvm_n2->volume();
+            }
           }
         }
 
       }
     }// end of scan all edges of the cell
 
+    // the average cell electron/hole current density vector
+    if(residual)
+    {
+      elem_data->Jn() = -elem->reconstruct_vector(Jn_edge_cell);
+      elem_data->Jp() =  elem->reconstruct_vector(Jp_edge_cell);
+    }
+
   }// end of scan all the cell
 
 
@@ -1384,10 +1615,22 @@ void SemiconductorSimulationRegion::DDM1_Jacobian(PetscScalar * x, Mat *jac, Ins
     MatSetValues(*jac, 1, &index[1], 3, &index[0], R.getADValue(), ADD_VALUES);
     MatSetValues(*jac, 1, &index[2], 3, &index[0], R.getADValue(), ADD_VALUES);
 
+    if(residual)
+    {
+      // consider carrier generation
+      PetscScalar Field_G = node_data->Field_G()*fvm_node->volume();
+
+      iresidual.push_back(index[0]);  residual_value.push_back(rho.getValue());
+      iresidual.push_back(index[1]);  residual_value.push_back(R.getValue() + Field_G + node_data->EIn());
+      iresidual.push_back(index[2]);  residual_value.push_back(R.getValue() + Field_G + node_data->HIn());
+    }
+
     if (get_advanced_model()->Trap)
     {
       AutoDScalar ni = mt->band->nie(p, n, T);
-      mt->trap->Calculate(true,p,n,ni,T);
+      // trap occupancy is frozen between steps when advanced explicitly
+      if (!get_advanced_model()->TrapExplicit)
+        mt->trap->Calculate(true,p,n,ni,T);
 
       AutoDScalar TrappedC = mt->trap->ChargeAD(true) * fvm_node->volume();
       MatSetValues(*jac, 1, &index[0], 3, &index[0], TrappedC.getADValue(), ADD_VALUES);
@@ -1397,9 +1640,31 @@ void SemiconductorSimulationRegion::DDM1_Jacobian(PetscScalar * x, Mat *jac, Ins
 
       MatSetValues(*jac, 1, &index[1], 3, &index[0], GElec.getADValue(), ADD_VALUES);
       MatSetValues(*jac, 1, &index[2], 3, &index[0], GHole.getADValue(), ADD_VALUES);
+
+      if(residual)
+      {
+        iresidual.push_back(index[0]);  residual_value.push_back(TrappedC.getValue());
+        iresidual.push_back(index[1]);  residual_value.push_back(GElec.getValue());
+        iresidual.push_back(index[2]);  residual_value.push_back(GHole.getValue());
+      }
     }
   }
 
+  // add into petsc vector, we should prevent zero length vector add here.
+  if(iresidual.size())  VecSetValues(f, iresidual.size(), &iresidual[0], &residual_value[0], ADD_VALUES);
+
+  // nonlocal band band tunneling along the cached tunneling paths
+  if( bbt_nonlocal() )
+  {
+    update_bbt_nonlocal_path(x);
+    if(residual)
+      BBT_Nonlocal_Function(x, f, invalid_uint);
+    BBT_Nonlocal_Jacobian(x, jac, invalid_uint);
+  }
+
+  // the cached forces belong to this solution, see DDM1_Function
+  if(residual)
+    _mob_force_cached = cache_mob_force;
 
   // boundary condition should be processed later!
 
@@ -1548,6 +1813,69 @@ void SemiconductorSimulationRegion::DDM1_Time_Dependent_Jacobian(PetscScalar * x
 }
 
 
+void SemiconductorSimulationRegion::DDM1_HB_Time_Derivative_Function(const PetscScalar * dxdt, Vec f, InsertMode &add_value_flag)
+{
+  // note, we will use ADD_VALUES to set values of vec f
+  // if the previous operator is not ADD_VALUES, we should assembly the vec first!
+  if( (add_value_flag != ADD_VALUES) && (add_value_flag != NOT_SET_VALUES) )
+  {
+    VecAssemblyBegin(f);
+    VecAssemblyEnd(f);
+  }
+
+  // set local buf here
+  std::vector<int>          iy;
+  std::vector<PetscScalar>  y;
+  iy.reserve(2*this->n_node());
+  y.reserve(2*this->n_node());
+
+  const_processor_node_iterator node_it = on_processor_nodes_begin();
+  const_processor_node_iterator node_it_end = on_processor_nodes_end();
+  for(; node_it!=node_it_end; ++node_it)
+  {
+    const FVM_Node * fvm_node = *node_it;
+
+    // the same sign as the transient term, -dn/dt and -dp/dt
+    iy.push_back(fvm_node->global_offset()+1);
+    iy.push_back(fvm_node->global_offset()+2);
+    y.push_back( -dxdt[fvm_node->local_offset()+1]*fvm_node->volume() );
+    y.push_back( -dxdt[fvm_node->local_offset()+2]*fvm_node->volume() );
+  }
+
+  // add into petsc vector, we should prevent zero length vector add here.
+  if(iy.size())  VecSetValues(f, iy.size(), &iy[0], &y[0], ADD_VALUES);
+
+  // the last operator is ADD_VALUES
+  add_value_flag = ADD_VALUES;
+}
+
+
+
+
+void SemiconductorSimulationRegion::DDM1_HB_Time_Derivative_Jacobian(Mat *jac, InsertMode &add_value_flag)
+{
+  // note, we will use ADD_VALUES to set values of matrix J
+  // if the previous operator is not ADD_VALUES, we should flush the matrix
+  if( (add_value_flag != ADD_VALUES) && (add_value_flag != NOT_SET_VALUES) )
+  {
+    MatAssemblyBegin(*jac, MAT_FLUSH_ASSEMBLY);
+    MatAssemblyEnd(*jac, MAT_FLUSH_ASSEMBLY);
+  }
+
+  const_processor_node_iterator node_it = on_processor_nodes_begin();
+  const_processor_node_iterator node_it_end = on_processor_nodes_end();
+  for(; node_it!=node_it_end; ++node_it)
+  {
+    const FVM_Node * fvm_node = *node_it;
+    MatSetValue(*jac, fvm_node->global_offset()+1, fvm_node->global_offset()+1, -fvm_node->volume(), ADD_VALUES);
+    MatSetValue(*jac, fvm_node->global_offset()+2, fvm_node->global_offset()+2, -fvm_node->volume(), ADD_VALUES);
+  }
+
+  // the last operator is ADD_VALUES
+  add_value_flag = ADD_VALUES;
+}
+
+
 void SemiconductorSimulationRegion::DDM1_Pseudo_Time_Step_Function(PetscScalar * x, Vec f, InsertMode &add_value_flag)
 {
   // note, we will use ADD_VALUES to set values of vec f
@@ -1564,6 +1892,7 @@ void SemiconductorSimulationRegion::DDM1_Pseudo_Time_Step_Function(PetscScalar *
   for(; node_it!=node_it_end; ++node_it)
   {
     const FVM_Node * fvm_node = *node_it;
+    const Real dt_scale = pseudo_time_step_scale(node_it - on_processor_nodes_begin());
     //if( fvm_node->boundary_id() == BoundaryInfo::invalid_id ) continue;
 
     const FVM_NodeData * node_data = fvm_node->node_data();
@@ -1572,13 +1901,14 @@ void SemiconductorSimulationRegion::DDM1_Pseudo_Time_Step_Function(PetscScalar *
     const unsigned int global_offset = fvm_node->global_offset();
 
     PetscScalar V   =  x[local_offset];                         // phi
-    PetscScalar f_V = -node_data->eps()*(V-node_data->psi())/SolverSpecify::PseudoTimeStepPotential*fvm_node->volume();
+    PetscScalar f_V = -node_data->eps()*(V-node_data->psi())/(SolverSpecify::PseudoTimeStepPotential*dt_scale)*fvm_node->volume();
     VecSetValue(f, global_offset, f_V, ADD_VALUES);
   }
 
   for(node_it = on_processor_nodes_begin(); node_it!=node_it_end; ++node_it)
   {
     const FVM_Node * fvm_node = *node_it;
+    const Real dt_scale = pseudo_time_step_scale(node_it - on_processor_nodes_begin());
     //if( fvm_node->boundary_id() != BoundaryInfo::invalid_id ) continue;
 
     const FVM_NodeData * node_data = fvm_node->node_data();
@@ -1589,10 +1919,10 @@ void SemiconductorSimulationRegion::DDM1_Pseudo_Time_Step_Function(PetscScalar *
     PetscScalar n   =  x[local_offset+1];                         // electron density
     PetscScalar p   =  x[local_offset+2];                         // hole density
 
-    PetscScalar f_n   =  -(n-node_data->n())/SolverSpecify::PseudoTimeStepCarrier*fvm_node->volume();
+    PetscScalar f_n   =  -(n-node_data->n())/(SolverSpecify::PseudoTimeStepCarrier*dt_scale)*fvm_node->volume();
     VecSetValue(f, global_offset+1, f_n, ADD_VALUES);
 
-    PetscScalar f_p   =  -(p-node_data->p())/SolverSpecify::PseudoTimeStepCarrier*fvm_node->volume();
+    PetscScalar f_p   =  -(p-node_data->p())/(SolverSpecify::PseudoTimeStepCarrier*dt_scale)*fvm_node->volume();
     VecSetValue(f, global_offset+2, f_p, ADD_VALUES);
   }
 
@@ -1623,6 +1953,7 @@ void SemiconductorSimulationRegion::DDM1_Pseudo_Time_Step_Jacobian(PetscScalar *
   for(; node_it!=node_it_end; ++node_it)
   {
     const FVM_Node * fvm_node = *node_it;
+    const Real dt_scale = pseudo_time_step_scale(node_it - on_processor_nodes_begin());
     //if( fvm_node->boundary_id() == BoundaryInfo::invalid_id ) continue;
 
     const FVM_NodeData * node_data = fvm_node->node_data();
@@ -1631,7 +1962,7 @@ void SemiconductorSimulationRegion::DDM1_Pseudo_Time_Step_Jacobian(PetscScalar *
     const unsigned int global_offset = fvm_node->global_offset();
 
     AutoDScalar V(x[local_offset]);   V.setADValue(0, 1.0);              // psi
-    AutoDScalar f_V = -node_data->eps()*(V-node_data->psi())/SolverSpecify::PseudoTimeStepPotential*fvm_node->volume();
+    AutoDScalar f_V = -node_data->eps()*(V-node_data->psi())/(SolverSpecify::PseudoTimeStepPotential*dt_scale)*fvm_node->volume();
     MatSetValue(*jac, global_offset, global_offset, f_V.getADValue(0), ADD_VALUES);
   }
 
@@ -1639,6 +1970,7 @@ void SemiconductorSimulationRegion::DDM1_Pseudo_Time_Step_Jacobian(PetscScalar *
   for(node_it = on_processor_nodes_begin(); node_it!=node_it_end; ++node_it)
   {
     const FVM_Node * fvm_node = *node_it;
+    const Real dt_scale = pseudo_time_step_scale(node_it - on_processor_nodes_begin());
     //if( fvm_node->boundary_id() != BoundaryInfo::invalid_id ) continue;
 
     const FVM_NodeData * node_data = fvm_node->node_data();
@@ -1649,10 +1981,10 @@ void SemiconductorSimulationRegion::DDM1_Pseudo_Time_Step_Jacobian(PetscScalar *
     AutoDScalar n(x[local_offset+1]);   n.setADValue(0, 1.0);              // electron density
     AutoDScalar p(x[local_offset+2]);   p.setADValue(0, 1.0);              // hole density
 
-    AutoDScalar f_n = -(n-node_data->n())/SolverSpecify::PseudoTimeStepCarrier*fvm_node->volume();
+    AutoDScalar f_n = -(n-node_data->n())/(SolverSpecify::PseudoTimeStepCarrier*dt_scale)*fvm_node->volume();
     MatSetValue(*jac, global_offset+1, global_offset+1, f_n.getADValue(0), ADD_VALUES);
 
-    AutoDScalar f_p = -(p-node_data->p())/SolverSpecify::PseudoTimeStepCarrier*fvm_node->volume();
+    AutoDScalar f_p = -(p-node_data->p())/(SolverSpecify::PseudoTimeStepCarrier*dt_scale)*fvm_node->volume();
     MatSetValue(*jac, global_offset+2, global_offset+2, f_p.getADValue(0), ADD_VALUES);
   }
 
@@ -1673,6 +2005,7 @@ int SemiconductorSimulationRegion::DDM1_Pseudo_Time_Step_Convergence_Test(PetscS
   for(; node_it!=node_it_end; ++node_it)
   {
     const FVM_Node * fvm_node = *node_it;
+    const Real dt_scale = pseudo_time_step_scale(node_it - on_processor_nodes_begin());
     //if( fvm_node->boundary_id() == BoundaryInfo::invalid_id ) continue;
 
     const FVM_NodeData * node_data = fvm_node->node_data();
@@ -1682,7 +2015,7 @@ int SemiconductorSimulationRegion::DDM1_Pseudo_Time_Step_Convergence_Test(PetscS
 
     PetscScalar V   =  x[local_offset];                         // phi
 
-    PetscScalar fV_abs = std::abs(-node_data->eps()*(V-node_data->psi())/SolverSpecify::PseudoTimeStepPotential);
+    PetscScalar fV_abs = std::abs(-node_data->eps()*(V-node_data->psi())/(SolverSpecify::PseudoTimeStepPotential*dt_scale));
     PetscScalar V_rel  = std::abs(node_data->eps()*(V-node_data->psi()))/(std::abs(V) + 1e-30);
 
     if( fV_abs > SolverSpecify::PseudoTimeTolRelax*SolverSpecify::poisson_abs_toler && V_rel > SolverSpecify::relative_toler )
@@ -1693,6 +2026,7 @@ int SemiconductorSimulationRegion::DDM1_Pseudo_Time_Step_Convergence_Test(PetscS
   for(node_it = on_processor_nodes_begin(); node_it!=node_it_end; ++node_it)
   {
     const FVM_Node * fvm_node = *node_it;
+    const Real dt_scale = pseudo_time_step_scale(node_it - on_processor_nodes_begin());
     //if( fvm_node->boundary_id() != BoundaryInfo::invalid_id ) continue;
 
     const FVM_NodeData * node_data = fvm_node->node_data();
@@ -1702,10 +2036,10 @@ int SemiconductorSimulationRegion::DDM1_Pseudo_Time_Step_Convergence_Test(PetscS
     PetscScalar n   =  x[local_offset+1];                         // electron density
     PetscScalar p   =  x[local_offset+2];                         // hole density
 
-    PetscScalar fn_abs   = std::abs(-(n-node_data->n())/SolverSpecify::PseudoTimeStepCarrier);
+    PetscScalar fn_abs   = std::abs(-(n-node_data->n())/(SolverSpecify::PseudoTimeStepCarrier*dt_scale));
     PetscScalar n_rel    = std::abs((n-node_data->n())/node_data->n());
 
-    PetscScalar fp_abs   = std::abs(-(p-node_data->p())/SolverSpecify::PseudoTimeStepCarrier);
+    PetscScalar fp_abs   = std::abs(-(p-node_data->p())/(SolverSpecify::PseudoTimeStepCarrier*dt_scale));
     PetscScalar p_rel    = std::abs((p-node_data->p())/node_data->p());
 
     if( fn_abs > SolverSpecify::PseudoTimeTolRelax*SolverSpecify::elec_continuity_abs_toler && n_rel  > SolverSpecify::relative_toler )
@@ -1725,6 +2059,11 @@ void SemiconductorSimulationRegion::DDM1_Update_Solution(PetscScalar *lxx)
   const PetscScalar T   = T_external();
   const PetscScalar Vt  = kb*T/e;
 
+  // save the last solution column by column, all the on local nodes hold a node data
+  _node_data_storage.copy_scalar(FVM_Semiconductor_NodeData::_psi_, FVM_Semiconductor_NodeData::_psi_last_);
+  _node_data_storage.copy_scalar(FVM_Semiconductor_NodeData::_n_,   FVM_Semiconductor_NodeData::_n_last_);
+  _node_data_storage.copy_scalar(FVM_Semiconductor_NodeData::_p_,   FVM_Semiconductor_NodeData::_p_last_);
+
   local_node_iterator node_it = on_local_nodes_begin();
   local_node_iterator node_it_end = on_local_nodes_end();
   for(; node_it!=node_it_end; ++node_it)
@@ -1739,33 +2078,31 @@ void SemiconductorSimulationRegion::DDM1_Update_Solution(PetscScalar *lxx)
     mt->mapping(fvm_node->root_node(), node_data, SolverSpecify::clock);
 
     //update psi
-    node_data->psi_last() =  node_data->psi();
     node_data->psi()      =  V;
     // clear E. for later electrical field computation
     node_data->E() = VectorValue<PetscScalar>(0.0, 0.0, 0.0);
 
     // electron density
-    node_data->n_last()   = node_data->n();
     node_data->n()        =  n;
 
     // hole density
-    node_data->p_last()   = node_data->p();
     node_data->p()        =  p;
 
 
-    node_data->Eg() = mt->band->Eg(T) - mt->band->EgNarrow(p, n, T);
+    const PetscScalar Eg = band_cache(fvm_node, T).Eg;
+    node_data->Eg() = Eg - mt->band->EgNarrow(p, n, T);
     node_data->Ec() = -(e*V + node_data->affinity() + mt->band->EgNarrowToEc(p, n, T));
-    node_data->Ev() = -(e*V + node_data->affinity() + mt->band->Eg(T) - mt->band->EgNarrowToEv(p, n, T) );
+    node_data->Ev() = -(e*V + node_data->affinity() + Eg - mt->band->EgNarrowToEv(p, n, T) );
 
     if(get_advanced_model()->Fermi)
     {
       node_data->qFn() = -(e*V + node_data->affinity()) + inv_fermi_half(fabs(n/node_data->Nc()))*kb*T;
-      node_data->qFp() = -(e*V + node_data->affinity() + mt->band->Eg(T)) - inv_fermi_half(fabs(p/node_data->Nv()))*kb*T;
+      node_data->qFp() = -(e*V + node_data->affinity() + Eg) - inv_fermi_half(fabs(p/node_data->Nv()))*kb*T;
     }
     else
     {
       node_data->qFn() = -(e*V + node_data->affinity()) + log(fabs(n/node_data->Nc()))*kb*T;
-      node_data->qFp() = -(e*V + node_data->affinity() + mt->band->Eg(T)) - log(fabs(p/node_data->Nv()))*kb*T;
+      node_data->qFp() = -(e*V + node_data->affinity() + Eg) - log(fabs(p/node_data->Nv()))*kb*T;
     }
 
     node_data->Recomb() = mt->band->Recomb(p, n, T);
@@ -1777,30 +2114,17 @@ void SemiconductorSimulationRegion::DDM1_Update_Solution(PetscScalar *lxx)
     {
       // update traps
       mt->mapping(fvm_node->root_node(), node_data, SolverSpecify::clock);
-      mt->trap->Update(true, p, n, node_data->ni(), T_external());
-      mt->trap->Update(false, p, n, node_data->ni(), T_external());
-    }
-  }
-
-  // addtional work: compute electrical field for all the cell.
-  // Since this value is only used for reference.
-  // It can be done simply by weighted average of cell's electrical field
-  for(unsigned int n=0; n<n_cell(); ++n)
-  {
-    const Elem * elem = this->get_region_elem(n);
-    FVM_CellData * elem_data = this->get_region_elem_data(n);
-
-    std::vector<PetscScalar> psi_vertex;
-    psi_vertex.reserve(elem->n_nodes());
-
-    for(unsigned int nd=0; nd<elem->n_nodes(); ++nd)
-    {
-      const FVM_Node * fvm_node = elem->get_fvm_node(nd);
-      const FVM_NodeData * fvm_node_data = fvm_node->node_data();
-      psi_vertex.push_back  ( fvm_node_data->psi() );
+      if (get_advanced_model()->TrapExplicit)
+      {
+        mt->trap->Advance(true, p, n, node_data->ni(), T_external());
+        mt->trap->Advance(false, p, n, node_data->ni(), T_external());
+      }
+      else
+      {
+        mt->trap->Update(true, p, n, node_data->ni(), T_external());
+        mt->trap->Update(false, p, n, node_data->ni(), T_external());
+      }
     }
-    // compute the gradient in the cell
-    elem_data->E()  = - elem->gradient(psi_vertex);  // E = - grad(psi)
   }
 
 
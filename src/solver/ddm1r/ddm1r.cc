@@ -209,6 +209,9 @@ void DDM1RSolver::flush_system(Vec v)
  */
 int DDM1RSolver::diverged_recovery()
 {
+  // rejected transient step, x_n is the last accepted solution
+  if( restore_from_history() ) return 0;
+
   // for all the regions
   for(unsigned int n=0; n<_system.n_regions(); n++)
   {
@@ -831,6 +834,7 @@ void DDM1RSolver::build_petsc_sens_residual(Vec x, Vec r)
   // evaluate governing equations of DDML1 in all the regions
   for(unsigned int n=0; n<_system.n_regions(); n++)
   {
+    if( region_frozen(n) ) continue;
     SimulationRegion * region = _system.region(n);
     region->DDM1R_Function(lxx, r, add_value_flag);
   }
@@ -935,6 +939,7 @@ void DDM1RSolver::build_petsc_sens_jacobian(Vec x, Mat *, Mat *)
   // evaluate Jacobian matrix of governing equations of DDML1 in all the regions
   for(unsigned int n=0; n<_system.n_regions(); n++)
   {
+    if( region_frozen(n) ) continue;
     SimulationRegion * region = _system.region(n);
     region->DDM1R_Jacobian(lxx, &J, add_value_flag);
   }
@@ -1005,10 +1010,8 @@ void DDM1RSolver::build_petsc_sens_jacobian(Vec x, Mat *, Mat *)
     bc->DDM1R_Jacobian_Preprocess(lxx, &J, src_row, dst_row, clear_row);
   }
 
-  //add source rows to destination rows
-  PetscUtils::MatAddRowToRow(J, src_row, dst_row);
-  // clear row
-  PetscUtils::MatZeroRows(J, clear_row.size(), clear_row.empty() ? NULL : &clear_row[0], 0.0);
+  //add source rows to destination rows, and clear rows
+  PetscUtils::MatAddClearRow(J, src_row, dst_row, clear_row);
 
   add_value_flag = NOT_SET_VALUES;
   for(unsigned int b=0; b<_system.get_bcs()->n_bcs(); b++)
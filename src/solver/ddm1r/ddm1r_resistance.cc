@@ -112,6 +112,7 @@ void MetalSimulationRegion::DDM1R_Function(PetscScalar * x, Vec f, InsertMode &a
   {
     // fvm_node of node1
     const FVM_Node * fvm_n1 = (*it).first;
+    const unsigned int edge_index = it - edges_begin();
     // fvm_node of node2
     const FVM_Node * fvm_n2 = (*it).second;
 
@@ -124,8 +125,8 @@ void MetalSimulationRegion::DDM1R_Function(PetscScalar * x, Vec f, InsertMode &a
     const unsigned int n2_local_offset = fvm_n2->local_offset();
 
     {
-      double length = fvm_n1->distance(fvm_n2);
-      double cv_surface_area = fvm_n1->cv_surface_area(fvm_n2);
+      double length = this->edge_length(edge_index);
+      double cv_surface_area = this->edge_cv_surface_area(edge_index);
       // electrostatic potential, as independent variable
       PetscScalar V1   =  x[n1_local_offset];
       PetscScalar V2   =  x[n2_local_offset];
@@ -230,6 +231,7 @@ void MetalSimulationRegion::DDM1R_Jacobian(PetscScalar * x, Mat *jac, InsertMode
   {
     // fvm_node of node1
     const FVM_Node * fvm_n1 = (*it).first;
+    const unsigned int edge_index = it - edges_begin();
     // fvm_node of node2
     const FVM_Node * fvm_n2 = (*it).second;
 
@@ -243,8 +245,8 @@ void MetalSimulationRegion::DDM1R_Jacobian(PetscScalar * x, Mat *jac, InsertMode
 
     // here we use AD, however it is great overkill for such a simple problem.
     {
-      double length = fvm_n1->distance(fvm_n2);
-      double cv_surface_area = fvm_n1->cv_surface_area(fvm_n2);
+      double length = this->edge_length(edge_index);
+      double cv_surface_area = this->edge_cv_surface_area(edge_index);
 
       // electrostatic potential, as independent variable
       AutoDScalar V1   =  x[n1_local_offset];    V1.setADValue(0,1.0);
@@ -208,6 +208,9 @@ void DDM2Solver::flush_system(Vec v)
  */
 int DDM2Solver::diverged_recovery()
 {
+  // rejected transient step, x_n is the last accepted solution
+  if( restore_from_history() ) return 0;
+
   // for all the regions
   for(unsigned int n=0; n<_system.n_regions(); n++)
   {
@@ -296,54 +299,28 @@ void DDM2Solver::potential_damping(Vec x, Vec y, Vec w, PetscBool *changed_y, Pe
   PetscScalar TemperatureLimit = std::max(1*K, this->get_system().T_external() - 50*K);
 
   // we should find dV_max;
-  // first, we find in local
-  for(unsigned int n=0; n<_system.n_regions(); n++)
+  // first, we find in local, only consider semiconductor region
+  for(unsigned int i=0; i<semiconductor_offset.size(); ++i)
   {
-    // only consider semiconductor region
-    const SimulationRegion * region = _system.region(n);
-    if( region->type() == SemiconductorRegion )
-    {
-      SimulationRegion::const_processor_node_iterator it = region->on_processor_nodes_begin();
-      SimulationRegion::const_processor_node_iterator it_end = region->on_processor_nodes_end();
-      for(; it!=it_end; ++it)
-      {
-        const FVM_Node * fvm_node = *it;
-
-        // we konw the fvm_node->local_offset() is psi in semiconductor region
-        unsigned int local_offset = fvm_node->local_offset();
-        dV_max = std::max(dV_max, std::abs(yy[local_offset]));
-
-        // the lattice temperature limit
-        if ( std::abs(yy[local_offset+3]) > 10*K )
-          ww[local_offset+3] = xx[local_offset+3] - std::sign(yy[local_offset+3])*10*K;
-        if ( ww[local_offset+3] < TemperatureLimit )
-          ww[local_offset+3] = TemperatureLimit;
-
-        //prevent negative carrier density
-        if ( ww[local_offset+1] < onePerCMC )
-          ww[local_offset+1] = onePerCMC;
-        if ( ww[local_offset+2] < onePerCMC )
-          ww[local_offset+2] = onePerCMC;
-      }
-    }
-    else
-    {
-      SimulationRegion::const_processor_node_iterator it = region->on_processor_nodes_begin();
-      SimulationRegion::const_processor_node_iterator it_end = region->on_processor_nodes_end();
-      for(; it!=it_end; ++it)
-      {
-        const FVM_Node * fvm_node = *it;
-
-        // we konw the fvm_node->local_offset() is psi in semiconductor region
-        unsigned int local_offset = fvm_node->local_offset();
+    unsigned int local_offset = semiconductor_offset[i];
+    dV_max = std::max(dV_max, std::abs(yy[local_offset]));
+
+    //prevent negative carrier density
+    if ( ww[local_offset+1] < onePerCMC )
+      ww[local_offset+1] = onePerCMC;
+    if ( ww[local_offset+2] < onePerCMC )
+      ww[local_offset+2] = onePerCMC;
+  }
 
-        // the lattice temperature limit
-        if ( std::abs(yy[local_offset+1]) > 10*K )
-          ww[local_offset+1] = xx[local_offset+1] - std::sign(yy[local_offset+1])*10*K;
-        if ( ww[local_offset+1] < TemperatureLimit )
-          ww[local_offset+1] = TemperatureLimit;
-      }
-    }
+  // the lattice temperature limit of all the regions
+  const std::vector<unsigned int> & T_index = norm_index[NormTemperature];
+  for(unsigned int i=0; i<T_index.size(); ++i)
+  {
+    unsigned int local_offset = T_index[i];
+    if ( std::abs(yy[local_offset]) > 10*K )
+      ww[local_offset] = xx[local_offset] - std::sign(yy[local_offset])*10*K;
+    if ( ww[local_offset] < TemperatureLimit )
+      ww[local_offset] = TemperatureLimit;
   }
 
   // for parallel situation, we should find the dv_max in global.
@@ -355,29 +332,12 @@ void DDM2Solver::potential_damping(Vec x, Vec y, Vec w, PetscBool *changed_y, Pe
     PetscScalar Vut = kb*this->get_system().T_external()/e * SolverSpecify::potential_update;
     PetscScalar f = log(1+dV_max/Vut)/(dV_max/Vut);
 
-    // do newton damping here
-    for(unsigned int n=0; n<_system.n_regions(); n++)
+    // do newton damping here, potential of all the regions
+    const std::vector<unsigned int> & psi_index = norm_index[NormPotential];
+    for(unsigned int i=0; i<psi_index.size(); ++i)
     {
-      const SimulationRegion * region = _system.region(n);
-      switch ( region->type() )
-      {
-          case SemiconductorRegion :
-          case InsulatorRegion :
-          case ElectrodeRegion :
-          case MetalRegion :
-          {
-            SimulationRegion::const_processor_node_iterator it = region->on_processor_nodes_begin();
-            SimulationRegion::const_processor_node_iterator it_end = region->on_processor_nodes_end();
-            for(; it!=it_end; ++it)
-            {
-              const FVM_Node * fvm_node = *it;
-              unsigned int local_offset = fvm_node->local_offset();
-              ww[local_offset] = xx[local_offset] - f*yy[local_offset];
-            }
-            break;
-          }
-          default: break;
-      }
+      unsigned int local_offset = psi_index[i];
+      ww[local_offset] = xx[local_offset] - f*yy[local_offset];
     }
 
     // only the last processor do this
@@ -408,11 +368,20 @@ void DDM2Solver::potential_damping(Vec x, Vec y, Vec w, PetscBool *changed_y, Pe
 /*------------------------------------------------------------------
  * Bank-Rose Newton Damping
  */
-void DDM2Solver::bank_rose_damping(Vec , Vec , Vec , PetscBool *changed_y, PetscBool *changed_w)
+void DDM2Solver::bank_rose_damping(Vec x, Vec y, Vec w, PetscBool *changed_y, PetscBool *changed_w)
 {
   *changed_y = PETSC_FALSE;
   *changed_w = PETSC_FALSE;
 
+  PetscReal t = bank_rose_factor(x, y);
+  if( t < 1.0 )
+  {
+    VecScale(y, t);
+    VecWAXPY(w, -1.0, y, x);
+    *changed_y = PETSC_TRUE;
+    *changed_w = PETSC_TRUE;
+  }
+
   return;
 }
 
@@ -439,36 +408,24 @@ void DDM2Solver::positive_density_damping(Vec x, Vec y, Vec w, PetscBool *change
   // I think 50K under T_external is ok even for semiconductor cooling.
   PetscScalar TemperatureLimit = std::max(1*K, this->get_system().T_external() - 50*K);
 
-  // do newton damping here
-  for(unsigned int n=0; n<_system.n_regions(); n++)
+  // do newton damping here, only consider semiconductor region
+  for(unsigned int i=0; i<semiconductor_offset.size(); ++i)
   {
-    // only consider semiconductor region
-    const SimulationRegion * region = _system.region(n);
-    if( region->type() == SemiconductorRegion )
-    {
-      SimulationRegion::const_processor_node_iterator it = region->on_processor_nodes_begin();
-      SimulationRegion::const_processor_node_iterator it_end = region->on_processor_nodes_end();
-      for(; it!=it_end; ++it)
-      {
-        const FVM_Node * fvm_node = *it;
-        unsigned int local_offset = fvm_node->local_offset();
+    unsigned int local_offset = semiconductor_offset[i];
 
-        // the maximum potential update is limited to 1V
-        if ( fabs(yy[local_offset]) > 1.0 )
-        { ww[local_offset] = xx[local_offset] - std::sign(yy[local_offset])*1.0; changed_flag = 1; }
+    // the maximum potential update is limited to 1V
+    if ( fabs(yy[local_offset]) > 1.0 )
+    { ww[local_offset] = xx[local_offset] - std::sign(yy[local_offset])*1.0; changed_flag = 1; }
 
-        // the lattice temperature limit
-        if ( ww[local_offset+3] < TemperatureLimit )
-        { ww[local_offset+3] = TemperatureLimit; changed_flag=1; }
+    // the lattice temperature limit
+    if ( ww[local_offset+3] < TemperatureLimit )
+    { ww[local_offset+3] = TemperatureLimit; changed_flag=1; }
 
-
-        //prevent negative carrier density
-        if ( ww[local_offset+1] < 0 )
-        { ww[local_offset+1] = onePerCMC; changed_flag = 1;}
-        if ( ww[local_offset+2] < 0 )
-        { ww[local_offset+2] = onePerCMC; changed_flag = 1;}
-      }
-    }
+    //prevent negative carrier density
+    if ( ww[local_offset+1] < 0 )
+    { ww[local_offset+1] = onePerCMC; changed_flag = 1;}
+    if ( ww[local_offset+2] < 0 )
+    { ww[local_offset+2] = onePerCMC; changed_flag = 1;}
   }
 
   VecRestoreArray(x, &xx);
@@ -503,29 +460,19 @@ void DDM2Solver::projection_positive_density_check(Vec x, Vec xo)
   // I think 50K under T_external is ok even for semiconductor cooling.
   PetscScalar TemperatureLimit = std::max(1*K, this->get_system().T_external() - 50*K);
 
-  for(unsigned int n=0; n<_system.n_regions(); n++)
+  // only consider semiconductor region
+  for(unsigned int i=0; i<semiconductor_offset.size(); ++i)
   {
-    // only consider semiconductor region
-    const SimulationRegion * region = _system.region(n);
-    if( region->type() == SemiconductorRegion )
-    {
-      SimulationRegion::const_processor_node_iterator it = region->on_processor_nodes_begin();
-      SimulationRegion::const_processor_node_iterator it_end = region->on_processor_nodes_end();
-      for(; it!=it_end; ++it)
-      {
-        const FVM_Node * fvm_node = *it;
-        unsigned int local_offset = fvm_node->local_offset();
+    unsigned int local_offset = semiconductor_offset[i];
 
-        // lattice temperature limit
-        if ( xx[local_offset+3] < TemperatureLimit ) xx[local_offset+3] = TemperatureLimit;
+    // lattice temperature limit
+    if ( xx[local_offset+3] < TemperatureLimit ) xx[local_offset+3] = TemperatureLimit;
 
-        //prevent negative carrier density
-        if ( xx[local_offset+1] < 0 )
-          xx[local_offset+1]= onePerCMC;
-        if ( xx[local_offset+2] < 0 )
-          xx[local_offset+2]= onePerCMC;
-      }
-    }
+    //prevent negative carrier density
+    if ( xx[local_offset+1] < 0 )
+      xx[local_offset+1]= onePerCMC;
+    if ( xx[local_offset+2] < 0 )
+      xx[local_offset+2]= onePerCMC;
   }
 
   VecRestoreArray(x,&xx);
@@ -578,11 +525,6 @@ PetscReal DDM2Solver::LTE_norm()
   PetscReal hn1 = SolverSpecify::dt_last;
   PetscReal hn2 = SolverSpecify::dt_last_last;
 
-  // relative error
-  PetscReal eps_r = SolverSpecify::TS_rtol;
-  // abs error
-  PetscReal eps_a = SolverSpecify::TS_atol;
-
   VecZeroEntries(xp);
   VecZeroEntries(LTE);
 
@@ -617,89 +559,8 @@ PetscReal DDM2Solver::LTE_norm()
     }
   }
 
-  int N=0;
-  PetscReal r;
-
-
   // with LTE vector and relative & abs error, we get the error estimate here
-  PetscScalar    *xx, *ll;
-  VecGetArray(x, &xx);
-  VecGetArray(LTE, &ll);
-
-  // error estimate for each region
-  for(unsigned int n=0; n<_system.n_regions(); n++)
-  {
-    const SimulationRegion * region = _system.region(n);
-
-    switch ( region->type() )
-    {
-        case SemiconductorRegion :
-        {
-          SimulationRegion::const_processor_node_iterator it = region->on_processor_nodes_begin();
-          SimulationRegion::const_processor_node_iterator it_end = region->on_processor_nodes_end();
-          for(; it!=it_end; ++it)
-          {
-            const FVM_Node * fvm_node = *it;
-            unsigned int local_offset = fvm_node->local_offset();
-
-            ll[local_offset+0] = 0;
-            ll[local_offset+1] = ll[local_offset+1]/(eps_r*xx[local_offset+1]+eps_a); // current jn
-            ll[local_offset+2] = ll[local_offset+2]/(eps_r*xx[local_offset+2]+eps_a); // current jp
-            ll[local_offset+3] = ll[local_offset+3]/(eps_r*xx[local_offset+3]+eps_a); // temperature
-          }
-          N += 3*region->n_on_processor_node();
-          break;
-        }
-        case InsulatorRegion :
-        case ElectrodeRegion :
-        case MetalRegion     :
-        {
-          SimulationRegion::const_processor_node_iterator it = region->on_processor_nodes_begin();
-          SimulationRegion::const_processor_node_iterator it_end = region->on_processor_nodes_end();
-          for(; it!=it_end; ++it)
-          {
-            const FVM_Node * fvm_node = *it;
-            unsigned int local_offset = fvm_node->local_offset();
-
-            ll[local_offset+0] = 0;
-            ll[local_offset+1] = ll[local_offset+1]/(eps_r*xx[local_offset+1]+eps_a); // temperature
-          }
-          N += region->n_on_processor_node();
-          break;
-        }
-        case VacuumRegion:
-        break;
-        default: genius_error();
-    }
-  }
-
-
-  // error estimate for each bc
-  if(Genius::is_last_processor())
-    for(unsigned int b=0; b<_system.get_bcs()->n_bcs(); b++)
-    {
-      BoundaryCondition * bc = _system.get_bcs()->get_bc(b);
-      unsigned int array_offset = bc->array_offset();
-      if( array_offset != invalid_uint )
-        ll[array_offset] = 0;
-    }
-
-  VecRestoreArray(x, &xx);
-  VecRestoreArray(LTE, &ll);
-
-  VecNorm(LTE, NORM_2, &r);
-
-  //for parallel situation, we should sum N of all the processor
-  Parallel::sum( N );
-
-  if( N>0 )
-  {
-    r /= sqrt(static_cast<double>(N));
-    return r;
-  }
-
-  return 1.0;
-
+  return variable_LTE_norm();
 }
 
 
@@ -707,42 +568,18 @@ PetscReal DDM2Solver::LTE_norm()
 
 void DDM2Solver::error_norm()
 {
-  PetscScalar    *xx;
-  PetscScalar    *ff;
-
-  // scatte global solution vector x to local vector lx
-  // this is not necessary since it had already done in function evaluation
-  //VecScatterBegin(scatter, x, lx, INSERT_VALUES, SCATTER_FORWARD);
-  //VecScatterEnd  (scatter, x, lx, INSERT_VALUES, SCATTER_FORWARD);
-
-  // scatte global function vector f to local vector lf
-  VecScatterBegin(scatter, f, lf, INSERT_VALUES, SCATTER_FORWARD);
-  VecScatterEnd  (scatter, f, lf, INSERT_VALUES, SCATTER_FORWARD);
-
-
-
-  VecGetArray(lx, &xx);  // solution value
-  VecGetArray(lf, &ff);  // function value
-
-  // do clear
-  potential_norm        = 0;
-  electron_norm         = 0;
-  hole_norm             = 0;
-  temperature_norm      = 0;
-  elec_temperature_norm = 0;
-  hole_temperature_norm = 0;
+  // x and f norm of each variable, electrode norm from bc rows
+  variable_error_norm(true);
+}
 
-  poisson_norm              = 0;
-  elec_continuity_norm      = 0;
-  hole_continuity_norm      = 0;
-  heat_equation_norm        = 0;
-  elec_energy_equation_norm = 0;
-  hole_energy_equation_norm = 0;
-  electrode_norm            = 0;
 
+/*------------------------------------------------------------------
+ * the local offsets of each variable for error norm and LTE
+ */
+void DDM2Solver::build_norm_index()
+{
   for(unsigned int n=0; n<_system.n_regions(); n++)
   {
-    // only consider semiconductor region
     const SimulationRegion * region = _system.region(n);
 
     SimulationRegion::const_processor_node_iterator it = region->on_processor_nodes_begin();
@@ -756,42 +593,24 @@ void DDM2Solver::error_norm()
       {
           case SemiconductorRegion :
           {
-            potential_norm   += xx[offset+0]*xx[offset+0];
-            electron_norm    += xx[offset+1]*xx[offset+1];
-            hole_norm        += xx[offset+2]*xx[offset+2];
-            temperature_norm += xx[offset+3]*xx[offset+3];
-
-            poisson_norm         += ff[offset+0]*ff[offset+0];
-            elec_continuity_norm += ff[offset+1]*ff[offset+1];
-            hole_continuity_norm += ff[offset+2]*ff[offset+2];
-            heat_equation_norm   += ff[offset+3]*ff[offset+3];
+            norm_index[NormPotential].push_back(offset+0);
+            norm_index[NormElectron].push_back(offset+1);
+            norm_index[NormHole].push_back(offset+2);
+            norm_index[NormTemperature].push_back(offset+3);
+
+            lte_index.push_back(offset+1);
+            lte_index.push_back(offset+2);
+            lte_index.push_back(offset+3);
             break;
           }
           case InsulatorRegion :
-          {
-            potential_norm   += xx[offset]*xx[offset];
-            temperature_norm += xx[offset+1]*xx[offset+1];
-
-            poisson_norm        += ff[offset]*ff[offset];
-            heat_equation_norm  += ff[offset+1]*ff[offset+1];
-            break;
-          }
           case ElectrodeRegion :
-          {
-            potential_norm   += xx[offset]*xx[offset];
-            temperature_norm += xx[offset+1]*xx[offset+1];
-
-            poisson_norm        += ff[offset]*ff[offset];
-            heat_equation_norm  += ff[offset+1]*ff[offset+1];
-            break;
-          }
           case MetalRegion :
           {
-            potential_norm   += xx[offset]*xx[offset];
-            temperature_norm += xx[offset+1]*xx[offset+1];
+            norm_index[NormPotential].push_back(offset);
+            norm_index[NormTemperature].push_back(offset+1);
 
-            poisson_norm        += ff[offset]*ff[offset];
-            heat_equation_norm  += ff[offset+1]*ff[offset+1];
+            lte_index.push_back(offset+1);
             break;
           }
           case VacuumRegion:
@@ -800,56 +619,6 @@ void DDM2Solver::error_norm()
       }
     }
   }
-
-  if(Genius::is_last_processor())
-    for(unsigned int b=0; b<_system.get_bcs()->n_bcs(); b++)
-    {
-      const BoundaryCondition * bc = _system.get_bcs()->get_bc(b);
-      unsigned int offset = bc->local_offset();
-      if( offset != invalid_uint )
-      {
-        potential_norm += xx[offset]*xx[offset];
-
-        PetscScalar scaling = 1.0;
-        if(bc->is_electrode())
-          scaling = bc->ext_circuit()->mna_scaling(SolverSpecify::dt);
-
-        electrode_norm += scaling*ff[offset]*scaling*ff[offset];
-      }
-    }
-
-  // sum of variable value on all processors
-  std::vector<PetscScalar> norm_buffer;
-
-  norm_buffer.push_back(potential_norm);
-  norm_buffer.push_back(electron_norm);
-  norm_buffer.push_back(hole_norm);
-  norm_buffer.push_back(temperature_norm);
-
-  norm_buffer.push_back(poisson_norm);
-  norm_buffer.push_back(elec_continuity_norm);
-  norm_buffer.push_back(hole_continuity_norm);
-  norm_buffer.push_back(heat_equation_norm);
-  norm_buffer.push_back(electrode_norm);
-
-  Parallel::sum(norm_buffer);
-
-
-  // sqrt to get L2 norm
-  potential_norm   = sqrt(norm_buffer[0]);
-  electron_norm    = sqrt(norm_buffer[1]);
-  hole_norm        = sqrt(norm_buffer[2]);
-  temperature_norm = sqrt(norm_buffer[3]);
-
-  poisson_norm        = sqrt(norm_buffer[4]);
-  elec_continuity_norm = sqrt(norm_buffer[5]);
-  hole_continuity_norm = sqrt(norm_buffer[6]);
-  heat_equation_norm  = sqrt(norm_buffer[7]);
-  electrode_norm      = sqrt(norm_buffer[8]);
-
-  VecRestoreArray(lx, &xx);
-  VecRestoreArray(lf, &ff);
-
 }
 
 
@@ -912,8 +681,11 @@ void DDM2Solver::build_petsc_sens_residual(Vec x, Vec r)
   // evaluate governing equations of DDML1 in all the regions
   for(unsigned int n=0; n<_system.n_regions(); n++)
   {
+    if( region_frozen(n) ) continue;
     SimulationRegion * region = _system.region(n);
+    START_LOG("DDM2_Function(" + region->type_name() + ")", "DDM2Solver");
     region->DDM2_Function(lxx, r, add_value_flag);
+    STOP_LOG("DDM2_Function(" + region->type_name() + ")", "DDM2Solver");
   }
 
 #if defined(HAVE_FENV_H) && defined(DEBUG)
@@ -968,7 +740,9 @@ void DDM2Solver::build_petsc_sens_residual(Vec x, Vec r)
   for(unsigned int b=0; b<_system.get_bcs()->n_bcs(); b++)
   {
     BoundaryCondition * bc = _system.get_bcs()->get_bc(b);
+    START_LOG("DDM2_Function(" + bc->bc_type_name() + ")", "DDM2Solver");
     bc->DDM2_Function(lxx, r, add_value_flag);
+    STOP_LOG("DDM2_Function(" + bc->bc_type_name() + ")", "DDM2Solver");
   }
 
 
@@ -1015,8 +789,11 @@ void DDM2Solver::build_petsc_sens_jacobian(Vec x, Mat *, Mat *)
   // evaluate Jacobian matrix of governing equations of DDML2 in all the regions
   for(unsigned int n=0; n<_system.n_regions(); n++)
   {
+    if( region_frozen(n) ) continue;
     SimulationRegion * region = _system.region(n);
+    START_LOG("DDM2_Jacobian(" + region->type_name() + ")", "DDM2Solver");
     region->DDM2_Jacobian(lxx, &J, add_value_flag);
+    STOP_LOG("DDM2_Jacobian(" + region->type_name() + ")", "DDM2Solver");
   }
 
 #if defined(HAVE_FENV_H) && defined(DEBUG)
@@ -1082,16 +859,16 @@ void DDM2Solver::build_petsc_sens_jacobian(Vec x, Mat *, Mat *)
     bc->DDM2_Jacobian_Preprocess(lxx, &J, src_row, dst_row, clear_row);
   }
 
-  //add source rows to destination rows
-  PetscUtils::MatAddRowToRow(J, src_row, dst_row);
-  // clear row
-  PetscUtils::MatZeroRows(J, clear_row.size(), clear_row.empty() ? NULL : &clear_row[0], 0.0);
+  //add source rows to destination rows, and clear rows
+  PetscUtils::MatAddClearRow(J, src_row, dst_row, clear_row);
   add_value_flag = NOT_SET_VALUES;
 
   for(unsigned int b=0; b<_system.get_bcs()->n_bcs(); b++)
   {
     BoundaryCondition * bc = _system.get_bcs()->get_bc(b);
+    START_LOG("DDM2_Jacobian(" + bc->bc_type_name() + ")", "DDM2Solver");
     bc->DDM2_Jacobian(lxx, &J, add_value_flag);
+    STOP_LOG("DDM2_Jacobian(" + bc->bc_type_name() + ")", "DDM2Solver");
   }
 
 
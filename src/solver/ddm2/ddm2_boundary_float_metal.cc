@@ -19,9 +19,6 @@
 /*                                                                              */
 /********************************************************************************/
 
-// C++ includes
-#include <numeric>
-
 #include "simulation_system.h"
 #include "semiconductor_region.h"
 #include "conductor_region.h"
@@ -99,9 +96,6 @@ void ChargedContactBC::DDM2_Function(PetscScalar * x, Vec f, InsertMode &add_val
   // for 2D mesh, z_width() is the device dimension in Z direction; for 3D mesh, z_width() is 1.0
   PetscScalar z_width = this->z_width();
 
-  // buffer for float metal surface potential equation \integral {\eps \frac{\partial P}{\partial n} } + \sigma = 0
-  std::vector<PetscScalar> surface_equ;
-
   const SimulationRegion * _r1 = bc_regions().first;
   genius_assert(_r1->type() == InsulatorRegion);
   const SimulationRegion * _r2 = bc_regions().second;
@@ -144,7 +138,6 @@ void ChargedContactBC::DDM2_Function(PetscScalar * x, Vec f, InsertMode &add_val
       if( region->type() != InsulatorRegion ) continue;
 
       const FVM_Node * insulator_node  = (*rnode_it).second.second;
-      const FVM_NodeData * insulator_node_data = insulator_node->node_data();
 
       // psi of insulator node
       PetscScalar V_insulator = x[insulator_node->local_offset()];
@@ -160,27 +153,6 @@ void ChargedContactBC::DDM2_Function(PetscScalar * x, Vec f, InsertMode &add_val
       PetscScalar f_T = T_insulator - T_metal;
       VecSetValue(f,  insulator_node->global_offset()+1, f_T, ADD_VALUES);
 
-      // process float metal surface equation
-      {
-        FVM_Node::fvm_neighbor_node_iterator nb_it = insulator_node->neighbor_node_begin();
-        FVM_Node::fvm_neighbor_node_iterator nb_it_end = insulator_node->neighbor_node_end();
-        for(; nb_it != nb_it_end; ++nb_it)
-        {
-          const FVM_Node *nb_node = (*nb_it).first;
-          // the psi of neighbor node
-          PetscScalar V_nb = x[nb_node->local_offset()];
-          // distance from nb node to this node
-          PetscScalar distance = insulator_node->distance(nb_node);
-          // area of out surface of control volume related with neighbor node,
-          // here we should consider the difference of 2D/3D by multiply z_width
-          PetscScalar cv_boundary = insulator_node->cv_surface_area(nb_node)*z_width;
-          // surface electric field
-          PetscScalar E = (V_nb-V_insulator)/distance;
-          PetscScalar D = insulator_node_data->eps()*E;
-          // insert surface integral of electric displacement of this node into surface_equ buffer
-          surface_equ.push_back(cv_boundary*D);
-        }
-      }
     }
 
   }
@@ -188,8 +160,9 @@ void ChargedContactBC::DDM2_Function(PetscScalar * x, Vec f, InsertMode &add_val
 
 
 
-  // we sum all the terms in surface_equ buffer, that is surface integral of electric displacement for this boundary
-  PetscScalar surface_integral_electric_displacement = std::accumulate(surface_equ.begin(), surface_equ.end(), 0.0 );
+  // surface integral of electric displacement for this boundary, the flux is linear in psi and
+  // evaluated by the precomputed stencil of insulator side boundary nodes
+  PetscScalar surface_integral_electric_displacement = z_width*displacement_flux(x, InsulatorRegion);
 
   // add to ChargeIntegralBC
   VecSetValue(f, this->inter_connect_hub()->global_offset(), surface_integral_electric_displacement, ADD_VALUES);
@@ -247,18 +220,12 @@ void ChargedContactBC::DDM2_Jacobian_Reserve(Mat *jac, InsertMode &add_value_fla
 
       MatSetValue(*jac, insulator_node->global_offset()+1, metal_node->global_offset()+1, 0, ADD_VALUES);
       MatSetValue(*jac, insulator_node->global_offset()+1, insulator_node->global_offset()+1, 0, ADD_VALUES);
-
-      MatSetValue(*jac, this->inter_connect_hub()->global_offset(), insulator_node->global_offset(), 0, ADD_VALUES);
-      FVM_Node::fvm_neighbor_node_iterator nb_it = insulator_node->neighbor_node_begin();
-      FVM_Node::fvm_neighbor_node_iterator nb_it_end = insulator_node->neighbor_node_end();
-      for(; nb_it != nb_it_end; ++nb_it)
-      {
-        const FVM_Node *nb_node = (*nb_it).first;
-        MatSetValue(*jac, this->inter_connect_hub()->global_offset(), nb_node->global_offset(), 0, ADD_VALUES);
-      }
     }
   }
 
+  // the row of ChargeIntegralBC, one entry for each edge of the flux stencil
+  displacement_flux_jacobian(jac, this->inter_connect_hub()->global_offset(), 0.0, InsulatorRegion);
+
   // the last operator is ADD_VALUES
   add_value_flag = ADD_VALUES;
 }
@@ -366,7 +333,6 @@ void ChargedContactBC::DDM2_Jacobian(PetscScalar * x, Mat *jac, InsertMode &add_
       if( region->type() != InsulatorRegion ) continue;
 
       const FVM_Node * insulator_node  = (*rnode_it).second.second;
-      const FVM_NodeData * insulator_node_data = insulator_node->node_data();
       // psi of insulator node
       AutoDScalar V_insulator = x[insulator_node->local_offset()];  V_insulator.setADValue(2, 1.0);
 
@@ -384,32 +350,13 @@ void ChargedContactBC::DDM2_Jacobian(PetscScalar * x, Mat *jac, InsertMode &add_
       // set Jacobian of governing equation f_T
       MatSetValue(*jac, insulator_node->global_offset()+1, insulator_node->global_offset()+1, f_T.getADValue(2), ADD_VALUES);
       MatSetValue(*jac, insulator_node->global_offset()+1, metal_node->global_offset()+1, f_T.getADValue(1), ADD_VALUES);
-
-      FVM_Node::fvm_neighbor_node_iterator nb_it = insulator_node->neighbor_node_begin();
-      FVM_Node::fvm_neighbor_node_iterator nb_it_end = insulator_node->neighbor_node_end();
-      for(; nb_it != nb_it_end; ++nb_it)
-      {
-        const FVM_Node *nb_node = (*nb_it).first;
-        // the psi of neighbor node
-        AutoDScalar V_nb = x[nb_node->local_offset()];  V_nb.setADValue(0, 1.0);
-        // distance from nb node to this node
-        PetscScalar distance = insulator_node->distance(nb_node);
-        // area of out surface of control volume related with neighbor node,
-        // here we should consider the difference of 2D/3D by multiply z_width
-        PetscScalar cv_boundary = insulator_node->cv_surface_area(nb_node)*z_width;
-        // surface electric field and electrc displacement
-        AutoDScalar E = (V_nb-V_insulator)/distance;
-        AutoDScalar D = insulator_node_data->eps()*E;
-
-        // since the governing equation is \sum \integral D + \sigma = 0
-        // and \integral D = \sum cv_boundary*D
-        // here we use MatSetValue ADD_VALUES to process \sum \integral D one by one
-        MatSetValue(*jac, this->inter_connect_hub()->global_offset(), insulator_node->global_offset(), (cv_boundary*D).getADValue(2), ADD_VALUES);
-        MatSetValue(*jac, this->inter_connect_hub()->global_offset(), nb_node->global_offset(), (cv_boundary*D).getADValue(0), ADD_VALUES);
-      }
     }
   }
 
+  // since the governing equation is \sum \integral D + \sigma = 0, the row of ChargeIntegralBC
+  // takes the constant derivative of surface integral of electric displacement in one MatSetValues call
+  displacement_flux_jacobian(jac, this->inter_connect_hub()->global_offset(), z_width, InsulatorRegion);
+
   // the last operator is ADD_VALUES
   add_value_flag = ADD_VALUES;
 
@@ -48,27 +48,16 @@ using PhysicalUnit::e;
 void HeteroInterfaceBC::DDM2_Function_Preprocess(PetscScalar * ,Vec f, std::vector<PetscInt> &src_row,
     std::vector<PetscInt> &dst_row, std::vector<PetscInt> &clear_row)
 {
-  // search for all the node with this boundary type
-  BoundaryCondition::const_node_iterator node_it = nodes_begin();
-  BoundaryCondition::const_node_iterator end_it = nodes_end();
-  for(; node_it!=end_it; ++node_it )
+  // search for all the on processor node with this boundary type
+  for(TableWalk node(*this); node.valid(); node.next() )
   {
-    // skip node not belongs to this processor
-    if( (*node_it)->processor_id()!=Genius::processor_id() ) continue;
+    // the fvm_node of the first region
+    const FVM_Node * fvm_node0 = node[0].fvm_node;
 
-    // buffer for saving regions and fvm_nodes this *node_it involves
-    std::vector<const FVM_Node *> fvm_nodes;
-
-    // search all the fvm_node which has *node_it as root node, these fvm_nodes have the same location in geometry,
-    // but belong to different regions in logic.
-    BoundaryCondition::region_node_iterator  rnode_it     = region_node_begin(*node_it);
-    BoundaryCondition::region_node_iterator  end_rnode_it = region_node_end(*node_it);
-    for(unsigned int i=0 ; rnode_it!=end_rnode_it; ++i, ++rnode_it  )
+    for(unsigned int i=0; i<node.size(); ++i )
     {
-      const SimulationRegion * region = (*rnode_it).second.first;
-      const FVM_Node * fvm_node = (*rnode_it).second.second;
-
-      fvm_nodes.push_back( fvm_node );
+      const SimulationRegion * region = node[i].region;
+      const FVM_Node * fvm_node = node[i].fvm_node;
 
       // the first semiconductor region
       if(i==0) continue;
@@ -81,27 +70,27 @@ void HeteroInterfaceBC::DDM2_Function_Preprocess(PetscScalar * ,Vec f, std::vect
             case SemiconductorRegion :
             {
               // record the source row and dst row
-              src_row.push_back(fvm_nodes[i]->global_offset()+0);
-              src_row.push_back(fvm_nodes[i]->global_offset()+3);
+              src_row.push_back(fvm_node->global_offset()+0);
+              src_row.push_back(fvm_node->global_offset()+3);
 
-              dst_row.push_back(fvm_nodes[0]->global_offset()+0);
-              dst_row.push_back(fvm_nodes[0]->global_offset()+3);
+              dst_row.push_back(fvm_node0->global_offset()+0);
+              dst_row.push_back(fvm_node0->global_offset()+3);
 
-              clear_row.push_back(fvm_nodes[i]->global_offset()+0);
-              clear_row.push_back(fvm_nodes[i]->global_offset()+3);
+              clear_row.push_back(fvm_node->global_offset()+0);
+              clear_row.push_back(fvm_node->global_offset()+3);
               break;
             }
             case InsulatorRegion:
             {
               // record the source row and dst row
-              src_row.push_back(fvm_nodes[i]->global_offset()+0);
-              src_row.push_back(fvm_nodes[i]->global_offset()+1);
+              src_row.push_back(fvm_node->global_offset()+0);
+              src_row.push_back(fvm_node->global_offset()+1);
 
-              dst_row.push_back(fvm_nodes[0]->global_offset()+0);
-              dst_row.push_back(fvm_nodes[0]->global_offset()+3);
+              dst_row.push_back(fvm_node0->global_offset()+0);
+              dst_row.push_back(fvm_node0->global_offset()+3);
 
-              clear_row.push_back(fvm_nodes[i]->global_offset()+0);
-              clear_row.push_back(fvm_nodes[i]->global_offset()+1);
+              clear_row.push_back(fvm_node->global_offset()+0);
+              clear_row.push_back(fvm_node->global_offset()+1);
               break;
             }
             default: genius_error();
@@ -134,20 +123,10 @@ void HeteroInterfaceBC::DDM2_Function(PetscScalar * x, Vec f, InsertMode &add_va
 
   const PetscScalar qf = this->scalar("qf");
 
-  // search for all the node with this boundary type
-  BoundaryCondition::const_node_iterator node_it = nodes_begin();
-  BoundaryCondition::const_node_iterator end_it = nodes_end();
-
-  for(; node_it!=end_it; ++node_it )
+  // search for all the on processor node with this boundary type
+  for(TableWalk node(*this); node.valid(); node.next() )
   {
 
-    // skip node not belongs to this processor
-    if( (*node_it)->processor_id()!=Genius::processor_id() ) continue;
-
-
-    std::vector<const SimulationRegion *> regions;
-    std::vector<const FVM_Node *> fvm_nodes;
-
     // the variable for first region
     const FVM_Node * fvm_node0;
     PetscScalar V0;
@@ -157,35 +136,27 @@ void HeteroInterfaceBC::DDM2_Function(PetscScalar * x, Vec f, InsertMode &add_va
     Material::MaterialSemiconductor * mt0;
     PetscScalar Ec0,Ev0;
 
-    // search all the fvm_node which has *node_it as root node, these nodes are the same in geometry,
-    // but in different region.
-    BoundaryCondition::region_node_iterator  rnode_it     = region_node_begin(*node_it);
-    BoundaryCondition::region_node_iterator  end_rnode_it = region_node_end(*node_it);
-
-    for(unsigned int i=0 ; rnode_it!=end_rnode_it; ++i, ++rnode_it  )
+    for(unsigned int i=0; i<node.size(); ++i )
     {
-      const SimulationRegion * region = (*rnode_it).second.first;
-      const FVM_Node * fvm_node = (*rnode_it).second.second;
+      const SimulationRegion * region = node[i].region;
+      const FVM_Node * fvm_node = node[i].fvm_node;
       if(!fvm_node->is_valid()) continue;
 
-      regions.push_back( region );
-      fvm_nodes.push_back( fvm_node );
-
       // the first semiconductor region
       if(i==0)
       {
-        const SemiconductorSimulationRegion * semi_region = dynamic_cast<const SemiconductorSimulationRegion *>(regions[i]);
+        const SemiconductorSimulationRegion * semi_region = dynamic_cast<const SemiconductorSimulationRegion *>(region);
 
-        const FVM_NodeData * n0_data = fvm_nodes[i]->node_data();
+        const FVM_NodeData * n0_data = fvm_node->node_data();
 
         fvm_node0 = fvm_node;
-        V0 = x[fvm_nodes[i]->local_offset()+0];
-        n0 = x[fvm_nodes[i]->local_offset()+1];  // electron density
-        p0 = x[fvm_nodes[i]->local_offset()+2];  // hole density
-        T0 = x[fvm_nodes[i]->local_offset()+3];
+        V0 = x[fvm_node->local_offset()+0];
+        n0 = x[fvm_node->local_offset()+1];  // electron density
+        p0 = x[fvm_node->local_offset()+2];  // hole density
+        T0 = x[fvm_node->local_offset()+3];
 
         mt0 = semi_region->material();
-        mt0->mapping(fvm_nodes[i]->root_node(), n0_data, SolverSpecify::clock);
+        mt0->mapping(fvm_node->root_node(), n0_data, SolverSpecify::clock);
 
         Ec0 =  -(e*V0 + n0_data->affinity() + mt0->band->EgNarrowToEc(p0, n0, T0) + kb*T0*log(n0_data->Nc()));
         Ev0 =  -(e*V0 + n0_data->affinity() - mt0->band->EgNarrowToEv(p0, n0, T0) - kb*T0*log(n0_data->Nv()) + mt0->band->Eg(T0));
@@ -195,31 +166,31 @@ void HeteroInterfaceBC::DDM2_Function(PetscScalar * x, Vec f, InsertMode &add_va
           Ev0 = Ev0 + kb*T0*log(gamma_f(fabs(p0)/n0_data->Nv()));
         }
 
-        PetscScalar boundary_area = std::abs(fvm_nodes[i]->outside_boundary_surface_area());
-        VecSetValue(f, fvm_nodes[i]->global_offset(), qf*boundary_area, ADD_VALUES);
+        PetscScalar boundary_area = std::abs(node[i].area);
+        VecSetValue(f, fvm_node->global_offset(), qf*boundary_area, ADD_VALUES);
       }
 
       // other semiconductor region
       else
       {
         // the ghost node should have the same processor_id with me
-        genius_assert(fvm_nodes[i]->root_node()->processor_id() == fvm_nodes[0]->root_node()->processor_id() );
+        genius_assert(fvm_node->root_node()->processor_id() == fvm_node0->root_node()->processor_id() );
 
         switch( region->type() )
         {
             case SemiconductorRegion :
             {
-              const SemiconductorSimulationRegion * semi_region = dynamic_cast<const SemiconductorSimulationRegion *>(regions[i]);
-              const FVM_NodeData * n_data = fvm_nodes[i]->node_data();
+              const SemiconductorSimulationRegion * semi_region = dynamic_cast<const SemiconductorSimulationRegion *>(region);
+              const FVM_NodeData * n_data = fvm_node->node_data();
 
-              PetscScalar V = x[fvm_nodes[i]->local_offset()+0];  // psi of this node
-              PetscScalar n = x[fvm_nodes[i]->local_offset()+1];  // electron density
-              PetscScalar p = x[fvm_nodes[i]->local_offset()+2];  // hole density
-              PetscScalar T = x[fvm_nodes[i]->local_offset()+3];
+              PetscScalar V = x[fvm_node->local_offset()+0];  // psi of this node
+              PetscScalar n = x[fvm_node->local_offset()+1];  // electron density
+              PetscScalar p = x[fvm_node->local_offset()+2];  // hole density
+              PetscScalar T = x[fvm_node->local_offset()+3];
 
               // mapping this node to material library
               Material::MaterialSemiconductor *mt = semi_region->material();
-              mt->mapping(fvm_nodes[i]->root_node(), n_data, SolverSpecify::clock);
+              mt->mapping(fvm_node->root_node(), n_data, SolverSpecify::clock);
               PetscScalar Ec =  -(e*V + n_data->affinity() + mt->band->EgNarrowToEc(p, n, T) + kb*T*log(n_data->Nc()));
               PetscScalar Ev =  -(e*V + n_data->affinity() - mt->band->EgNarrowToEv(p, n, T) - kb*T*log(n_data->Nv()) + mt->band->Eg(T));
               if(semi_region->get_advanced_model()->Fermi)
@@ -231,16 +202,16 @@ void HeteroInterfaceBC::DDM2_Function(PetscScalar * x, Vec f, InsertMode &add_va
 
               // the solution value of this node is equal to corresponding node value in the first semiconductor region
               PetscScalar ff1 = V - V0;
-              iy.push_back(fvm_nodes[i]->global_offset()+0);
+              iy.push_back(fvm_node->global_offset()+0);
               y_new.push_back(ff1);
 
               PetscScalar ff4 = T - T0;
-              iy.push_back(fvm_nodes[i]->global_offset()+3);
+              iy.push_back(fvm_node->global_offset()+3);
               y_new.push_back(ff4);
 
 
               // area of out surface of control volume related with neighbor node
-              PetscScalar cv_boundary = fvm_nodes[i]->outside_boundary_surface_area();
+              PetscScalar cv_boundary = node[i].area;
 
               if(Ec0 > Ec)
               {
@@ -281,16 +252,16 @@ void HeteroInterfaceBC::DDM2_Function(PetscScalar * x, Vec f, InsertMode &add_va
             case InsulatorRegion:
             {
               // the governing equation of this fvm node
-              PetscScalar V = x[fvm_nodes[i]->local_offset()+0];  // psi of this node
-              PetscScalar T = x[fvm_nodes[i]->local_offset()+1];  // lattice temperature
-              PetscScalar V_semi = x[fvm_nodes[0]->local_offset()+0];
-              PetscScalar T_semi = x[fvm_nodes[0]->local_offset()+3];  // lattice temperature
+              PetscScalar V = x[fvm_node->local_offset()+0];  // psi of this node
+              PetscScalar T = x[fvm_node->local_offset()+1];  // lattice temperature
+              PetscScalar V_semi = x[fvm_node0->local_offset()+0];
+              PetscScalar T_semi = x[fvm_node0->local_offset()+3];  // lattice temperature
               // the solution value of this node is equal to corresponding node value in the first semiconductor region
               PetscScalar ff1 = V - V_semi;
               PetscScalar ff2 = T - T_semi;
-              iy.push_back(fvm_nodes[i]->global_offset()+0);
+              iy.push_back(fvm_node->global_offset()+0);
               y_new.push_back(ff1);
-              iy.push_back(fvm_nodes[i]->global_offset()+1);
+              iy.push_back(fvm_node->global_offset()+1);
               y_new.push_back(ff2);
               break;
             }
@@ -326,28 +297,16 @@ void HeteroInterfaceBC::DDM2_Jacobian_Reserve(Mat *jac, InsertMode &add_value_fl
     MatAssemblyEnd(*jac, MAT_FLUSH_ASSEMBLY);
   }
 
-  // search for all the node with this boundary type
-  BoundaryCondition::const_node_iterator node_it = nodes_begin();
-  BoundaryCondition::const_node_iterator end_it = nodes_end();
-
-  for(; node_it!=end_it; ++node_it )
+  // search for all the on processor node with this boundary type
+  for(TableWalk node(*this); node.valid(); node.next() )
   {
-    // skip node not belongs to this processor
-    if( (*node_it)->processor_id()!=Genius::processor_id() ) continue;
-
-    // buffer for saving regions and fvm_nodes this *node_it involves
-    std::vector<const FVM_Node *> fvm_nodes;
+    // the fvm_node of the first region
+    const FVM_Node * fvm_node0 = node[0].fvm_node;
 
-    // search all the fvm_node which has *node_it as root node, these fvm_nodes have the same location in geometry,
-    // but belong to different regions in logic.
-    BoundaryCondition::region_node_iterator  rnode_it     = region_node_begin(*node_it);
-    BoundaryCondition::region_node_iterator  end_rnode_it = region_node_end(*node_it);
-    for(unsigned int i=0 ; rnode_it!=end_rnode_it; ++i, ++rnode_it  )
+    for(unsigned int i=0; i<node.size(); ++i )
     {
-      const SimulationRegion * region = (*rnode_it).second.first;
-      const FVM_Node * fvm_node = (*rnode_it).second.second;
-
-      fvm_nodes.push_back( fvm_node );
+      const SimulationRegion * region = node[i].region;
+      const FVM_Node * fvm_node = node[i].fvm_node;
 
       // the first semiconductor region
       if(i==0)
@@ -365,18 +324,18 @@ void HeteroInterfaceBC::DDM2_Jacobian_Reserve(Mat *jac, InsertMode &add_value_fl
             {
               // reserve items for all the ghost nodes
               std::vector<int> rows, cols;
-              rows.push_back(fvm_nodes[0]->global_offset()+0);
-              rows.push_back(fvm_nodes[0]->global_offset()+1);
-              rows.push_back(fvm_nodes[0]->global_offset()+2);
-              rows.push_back(fvm_nodes[0]->global_offset()+3);
-
-              cols.push_back(fvm_nodes[i]->global_offset()+0);
-              cols.push_back(fvm_nodes[i]->global_offset()+1);
-              cols.push_back(fvm_nodes[i]->global_offset()+2);
-              cols.push_back(fvm_nodes[i]->global_offset()+3);
-
-              FVM_Node::fvm_neighbor_node_iterator  nb_it = fvm_nodes[i]->neighbor_node_begin();
-              for(; nb_it != fvm_nodes[i]->neighbor_node_end(); ++nb_it)
+              rows.push_back(fvm_node0->global_offset()+0);
+              rows.push_back(fvm_node0->global_offset()+1);
+              rows.push_back(fvm_node0->global_offset()+2);
+              rows.push_back(fvm_node0->global_offset()+3);
+
+              cols.push_back(fvm_node->global_offset()+0);
+              cols.push_back(fvm_node->global_offset()+1);
+              cols.push_back(fvm_node->global_offset()+2);
+              cols.push_back(fvm_node->global_offset()+3);
+
+              FVM_Node::fvm_neighbor_node_iterator  nb_it = fvm_node->neighbor_node_begin();
+              for(; nb_it != fvm_node->neighbor_node_end(); ++nb_it)
               {
                 cols.push_back((*nb_it).first->global_offset()+0);
                 cols.push_back((*nb_it).first->global_offset()+1);
@@ -389,23 +348,23 @@ void HeteroInterfaceBC::DDM2_Jacobian_Reserve(Mat *jac, InsertMode &add_value_fl
               MatSetValues(*jac, rows.size(), &rows[0], cols.size(), &cols[0], &value[0], ADD_VALUES);
 
               // reserve for later operator
-              MatSetValue(*jac, fvm_nodes[i]->global_offset()+0, fvm_nodes[0]->global_offset()+0, 0, ADD_VALUES);
-              MatSetValue(*jac, fvm_nodes[i]->global_offset()+1, fvm_nodes[0]->global_offset()+1, 0, ADD_VALUES);
-              MatSetValue(*jac, fvm_nodes[i]->global_offset()+2, fvm_nodes[0]->global_offset()+2, 0, ADD_VALUES);
-              MatSetValue(*jac, fvm_nodes[i]->global_offset()+3, fvm_nodes[0]->global_offset()+3, 0, ADD_VALUES);
+              MatSetValue(*jac, fvm_node->global_offset()+0, fvm_node0->global_offset()+0, 0, ADD_VALUES);
+              MatSetValue(*jac, fvm_node->global_offset()+1, fvm_node0->global_offset()+1, 0, ADD_VALUES);
+              MatSetValue(*jac, fvm_node->global_offset()+2, fvm_node0->global_offset()+2, 0, ADD_VALUES);
+              MatSetValue(*jac, fvm_node->global_offset()+3, fvm_node0->global_offset()+3, 0, ADD_VALUES);
               break;
             }
             case InsulatorRegion:
             {
               // reserve items for all the ghost nodes
               std::vector<int> rows, cols;
-              rows.push_back(fvm_nodes[0]->global_offset()+0);
-              rows.push_back(fvm_nodes[0]->global_offset()+3);
-              cols.push_back(fvm_nodes[i]->global_offset()+0);
-              cols.push_back(fvm_nodes[i]->global_offset()+1);
+              rows.push_back(fvm_node0->global_offset()+0);
+              rows.push_back(fvm_node0->global_offset()+3);
+              cols.push_back(fvm_node->global_offset()+0);
+              cols.push_back(fvm_node->global_offset()+1);
 
-              FVM_Node::fvm_neighbor_node_iterator  nb_it = fvm_nodes[i]->neighbor_node_begin();
-              for(; nb_it != fvm_nodes[i]->neighbor_node_end(); ++nb_it)
+              FVM_Node::fvm_neighbor_node_iterator  nb_it = fvm_node->neighbor_node_begin();
+              for(; nb_it != fvm_node->neighbor_node_end(); ++nb_it)
               {
                 cols.push_back((*nb_it).first->global_offset()+0);
                 cols.push_back((*nb_it).first->global_offset()+1);
@@ -415,8 +374,8 @@ void HeteroInterfaceBC::DDM2_Jacobian_Reserve(Mat *jac, InsertMode &add_value_fl
 
               MatSetValues(*jac, rows.size(), &rows[0], cols.size(), &cols[0], &value[0], ADD_VALUES);
 
-              MatSetValue(*jac, fvm_nodes[i]->global_offset()+0, fvm_nodes[0]->global_offset()+0, 0, ADD_VALUES);
-              MatSetValue(*jac, fvm_nodes[i]->global_offset()+1, fvm_nodes[0]->global_offset()+3, 0, ADD_VALUES);
+              MatSetValue(*jac, fvm_node->global_offset()+0, fvm_node0->global_offset()+0, 0, ADD_VALUES);
+              MatSetValue(*jac, fvm_node->global_offset()+1, fvm_node0->global_offset()+3, 0, ADD_VALUES);
               break;
             }
             default: genius_error();
@@ -439,27 +398,16 @@ void HeteroInterfaceBC::DDM2_Jacobian_Reserve(Mat *jac, InsertMode &add_value_fl
 void HeteroInterfaceBC::DDM2_Jacobian_Preprocess(PetscScalar *,Mat *jac, std::vector<PetscInt> &src_row,
     std::vector<PetscInt> &dst_row, std::vector<PetscInt> &clear_row)
 {
-  // search for all the node with this boundary type
-  BoundaryCondition::const_node_iterator node_it = nodes_begin();
-  BoundaryCondition::const_node_iterator end_it = nodes_end();
-  for(; node_it!=end_it; ++node_it )
+  // search for all the on processor node with this boundary type
+  for(TableWalk node(*this); node.valid(); node.next() )
   {
-    // skip node not belongs to this processor
-    if( (*node_it)->processor_id()!=Genius::processor_id() ) continue;
-
-    // buffer for saving regions and fvm_nodes this *node_it involves
-    std::vector<const FVM_Node *> fvm_nodes;
+    // the fvm_node of the first region
+    const FVM_Node * fvm_node0 = node[0].fvm_node;
 
-    // search all the fvm_node which has *node_it as root node, these fvm_nodes have the same location in geometry,
-    // but belong to different regions in logic.
-    BoundaryCondition::region_node_iterator  rnode_it     = region_node_begin(*node_it);
-    BoundaryCondition::region_node_iterator  end_rnode_it = region_node_end(*node_it);
-    for(unsigned int i=0 ; rnode_it!=end_rnode_it; ++i, ++rnode_it  )
+    for(unsigned int i=0; i<node.size(); ++i )
     {
-      const SimulationRegion * region = (*rnode_it).second.first;
-      const FVM_Node * fvm_node = (*rnode_it).second.second;
-
-      fvm_nodes.push_back( fvm_node );
+      const SimulationRegion * region = node[i].region;
+      const FVM_Node * fvm_node = node[i].fvm_node;
 
       // the first semiconductor region
       if(i==0) continue;
@@ -472,27 +420,27 @@ void HeteroInterfaceBC::DDM2_Jacobian_Preprocess(PetscScalar *,Mat *jac, std::ve
             case SemiconductorRegion :
             {
               // record the source row and dst row
-              src_row.push_back(fvm_nodes[i]->global_offset()+0);
-              src_row.push_back(fvm_nodes[i]->global_offset()+3);
+              src_row.push_back(fvm_node->global_offset()+0);
+              src_row.push_back(fvm_node->global_offset()+3);
 
-              dst_row.push_back(fvm_nodes[0]->global_offset()+0);
-              dst_row.push_back(fvm_nodes[0]->global_offset()+3);
+              dst_row.push_back(fvm_node0->global_offset()+0);
+              dst_row.push_back(fvm_node0->global_offset()+3);
 
-              clear_row.push_back(fvm_nodes[i]->global_offset()+0);
-              clear_row.push_back(fvm_nodes[i]->global_offset()+3);
+              clear_row.push_back(fvm_node->global_offset()+0);
+              clear_row.push_back(fvm_node->global_offset()+3);
               break;
             }
             case InsulatorRegion:
             {
               // record the source row and dst row
-              src_row.push_back(fvm_nodes[i]->global_offset()+0);
-              src_row.push_back(fvm_nodes[i]->global_offset()+1);
+              src_row.push_back(fvm_node->global_offset()+0);
+              src_row.push_back(fvm_node->global_offset()+1);
 
-              dst_row.push_back(fvm_nodes[0]->global_offset()+0);
-              dst_row.push_back(fvm_nodes[0]->global_offset()+3);
+              dst_row.push_back(fvm_node0->global_offset()+0);
+              dst_row.push_back(fvm_node0->global_offset()+3);
 
-              clear_row.push_back(fvm_nodes[i]->global_offset()+0);
-              clear_row.push_back(fvm_nodes[i]->global_offset()+1);
+              clear_row.push_back(fvm_node->global_offset()+0);
+              clear_row.push_back(fvm_node->global_offset()+1);
               break;
             }
             default: genius_error();
@@ -523,15 +471,11 @@ void HeteroInterfaceBC::DDM2_Jacobian(PetscScalar * x, Mat *jac, InsertMode &add
   adtl::AutoDScalar::numdir=8;
 
   // after that, set values to source rows
-  BoundaryCondition::const_node_iterator node_it = nodes_begin();
-  BoundaryCondition::const_node_iterator end_it = nodes_end();
-  for(node_it = nodes_begin(); node_it!=end_it; ++node_it )
+  // search for all the on processor node with this boundary type
+  for(TableWalk node(*this); node.valid(); node.next() )
   {
-    // skip node not belongs to this processor
-    if( (*node_it)->processor_id()!=Genius::processor_id() ) continue;
-
-    std::vector<const SimulationRegion *> regions;
-    std::vector<const FVM_Node *> fvm_nodes;
+    // the fvm_node of the first region
+    const FVM_Node * fvm_node0 = node[0].fvm_node;
 
     // the variable for first region
     AutoDScalar V0;
@@ -541,34 +485,26 @@ void HeteroInterfaceBC::DDM2_Jacobian(PetscScalar * x, Mat *jac, InsertMode &add
     Material::MaterialSemiconductor * mt0;
     AutoDScalar Ec0,Ev0;
 
-    // search all the fvm_node which has *node_it as root node, these nodes are the same in geometry,
-    // but in different region.
-    BoundaryCondition::region_node_iterator  rnode_it     = region_node_begin(*node_it);
-    BoundaryCondition::region_node_iterator  end_rnode_it = region_node_end(*node_it);
-
-    for(unsigned int i=0 ; rnode_it!=end_rnode_it; ++i, ++rnode_it  )
+    for(unsigned int i=0; i<node.size(); ++i )
     {
-      const SimulationRegion * region = (*rnode_it).second.first;
-      const FVM_Node * fvm_node = (*rnode_it).second.second;
+      const SimulationRegion * region = node[i].region;
+      const FVM_Node * fvm_node = node[i].fvm_node;
       if(!fvm_node->is_valid()) continue;
 
-      regions.push_back( region );
-      fvm_nodes.push_back( fvm_node );
-
       // the first semiconductor region
       if(i==0)
       {
-        const SemiconductorSimulationRegion * semi_region = dynamic_cast<const SemiconductorSimulationRegion *>(regions[i]);
-        const FVM_NodeData * n0_data = fvm_nodes[i]->node_data();
+        const SemiconductorSimulationRegion * semi_region = dynamic_cast<const SemiconductorSimulationRegion *>(region);
+        const FVM_NodeData * n0_data = fvm_node->node_data();
 
         mt0 = semi_region->material();
         mt0->set_ad_num(adtl::AutoDScalar::numdir);
-        mt0->mapping(fvm_nodes[i]->root_node(), n0_data, SolverSpecify::clock);
+        mt0->mapping(fvm_node->root_node(), n0_data, SolverSpecify::clock);
 
-        V0 = x[fvm_nodes[i]->local_offset()+0];  V0.setADValue(0,1.0);
-        n0 = x[fvm_nodes[i]->local_offset()+1];  n0.setADValue(1,1.0);  // electron density
-        p0 = x[fvm_nodes[i]->local_offset()+2];  p0.setADValue(2,1.0);  // hole density
-        T0 = x[fvm_nodes[i]->local_offset()+3];  T0.setADValue(3,1.0);
+        V0 = x[fvm_node->local_offset()+0];  V0.setADValue(0,1.0);
+        n0 = x[fvm_node->local_offset()+1];  n0.setADValue(1,1.0);  // electron density
+        p0 = x[fvm_node->local_offset()+2];  p0.setADValue(2,1.0);  // hole density
+        T0 = x[fvm_node->local_offset()+3];  T0.setADValue(3,1.0);
 
         Ec0 =  -(e*V0 + n0_data->affinity() + mt0->band->EgNarrowToEc(p0, n0, T0) + kb*T0*log(n0_data->Nc()));
         Ev0 =  -(e*V0 + n0_data->affinity() - mt0->band->EgNarrowToEv(p0, n0, T0) - kb*T0*log(n0_data->Nv()) + mt0->band->Eg(T0));
@@ -583,34 +519,34 @@ void HeteroInterfaceBC::DDM2_Jacobian(PetscScalar * x, Mat *jac, InsertMode &add
       else
       {
         // the ghost node should have the same processor_id with me
-        genius_assert(fvm_nodes[i]->root_node()->processor_id() == fvm_nodes[0]->root_node()->processor_id() );
+        genius_assert(fvm_node->root_node()->processor_id() == fvm_node0->root_node()->processor_id() );
         switch( region->type() )
         {
             case SemiconductorRegion :
             {
               std::vector<int> rows, cols;
-              rows.push_back(fvm_nodes[0]->global_offset()+0);
-              rows.push_back(fvm_nodes[0]->global_offset()+1);
-              rows.push_back(fvm_nodes[0]->global_offset()+2);
-              rows.push_back(fvm_nodes[0]->global_offset()+3);
-              rows.push_back(fvm_nodes[i]->global_offset()+0);
-              rows.push_back(fvm_nodes[i]->global_offset()+1);
-              rows.push_back(fvm_nodes[i]->global_offset()+2);
-              rows.push_back(fvm_nodes[i]->global_offset()+3);
+              rows.push_back(fvm_node0->global_offset()+0);
+              rows.push_back(fvm_node0->global_offset()+1);
+              rows.push_back(fvm_node0->global_offset()+2);
+              rows.push_back(fvm_node0->global_offset()+3);
+              rows.push_back(fvm_node->global_offset()+0);
+              rows.push_back(fvm_node->global_offset()+1);
+              rows.push_back(fvm_node->global_offset()+2);
+              rows.push_back(fvm_node->global_offset()+3);
               cols = rows;
 
-              const SemiconductorSimulationRegion * semi_region = dynamic_cast<const SemiconductorSimulationRegion *>(regions[i]);
-              const FVM_NodeData * n_data = fvm_nodes[i]->node_data();
+              const SemiconductorSimulationRegion * semi_region = dynamic_cast<const SemiconductorSimulationRegion *>(region);
+              const FVM_NodeData * n_data = fvm_node->node_data();
 
-              AutoDScalar V = x[fvm_nodes[i]->local_offset()+0];  V.setADValue(4,1.0); // psi of this node
-              AutoDScalar n = x[fvm_nodes[i]->local_offset()+1];  n.setADValue(5,1.0); // electron density
-              AutoDScalar p = x[fvm_nodes[i]->local_offset()+2];  p.setADValue(6,1.0); // hole density
-              AutoDScalar T = x[fvm_nodes[i]->local_offset()+3];  T.setADValue(7,1.0);
+              AutoDScalar V = x[fvm_node->local_offset()+0];  V.setADValue(4,1.0); // psi of this node
+              AutoDScalar n = x[fvm_node->local_offset()+1];  n.setADValue(5,1.0); // electron density
+              AutoDScalar p = x[fvm_node->local_offset()+2];  p.setADValue(6,1.0); // hole density
+              AutoDScalar T = x[fvm_node->local_offset()+3];  T.setADValue(7,1.0);
 
               // mapping this node to material library
               Material::MaterialSemiconductor *mt = semi_region->material();
               mt->set_ad_num(adtl::AutoDScalar::numdir);
-              mt->mapping(fvm_nodes[i]->root_node(), n_data, SolverSpecify::clock);
+              mt->mapping(fvm_node->root_node(), n_data, SolverSpecify::clock);
               AutoDScalar Ec =  -(e*V + n_data->affinity() + mt->band->EgNarrowToEc(p, n, T) + kb*T*log(n_data->Nc()));
               AutoDScalar Ev =  -(e*V + n_data->affinity() - mt->band->EgNarrowToEv(p, n, T) - kb*T*log(n_data->Nv()) + mt->band->Eg(T));
               if(semi_region->get_advanced_model()->Fermi)
@@ -627,7 +563,7 @@ void HeteroInterfaceBC::DDM2_Jacobian(PetscScalar * x, Mat *jac, InsertMode &add
               MatSetValues(*jac, 1, &rows[7], cols.size(), &cols[0], ff4.getADValue(), ADD_VALUES);
 
               // area of out surface of control volume related with neighbor node
-              PetscScalar cv_boundary = fvm_nodes[i]->outside_boundary_surface_area();
+              PetscScalar cv_boundary = node[i].area;
 
               // thermal emit current
               if(Ec0 > Ec)
@@ -673,20 +609,20 @@ void HeteroInterfaceBC::DDM2_Jacobian(PetscScalar * x, Mat *jac, InsertMode &add
               adtl::AutoDScalar::numdir=2;
 
               // the governing equation of this fvm node
-              AutoDScalar V = x[fvm_nodes[i]->local_offset()+0];  V.setADValue(0,1.0); // psi of this node
-              AutoDScalar T = x[fvm_nodes[i]->local_offset()+1];  T.setADValue(0,1.0);// lattice temperature
-              AutoDScalar V_semi = x[fvm_nodes[0]->local_offset()+0]; V_semi.setADValue(1,1.0);
-              AutoDScalar T_semi = x[fvm_nodes[0]->local_offset()+3]; T_semi.setADValue(1,1.0); // lattice temperature
+              AutoDScalar V = x[fvm_node->local_offset()+0];  V.setADValue(0,1.0); // psi of this node
+              AutoDScalar T = x[fvm_node->local_offset()+1];  T.setADValue(0,1.0);// lattice temperature
+              AutoDScalar V_semi = x[fvm_node0->local_offset()+0]; V_semi.setADValue(1,1.0);
+              AutoDScalar T_semi = x[fvm_node0->local_offset()+3]; T_semi.setADValue(1,1.0); // lattice temperature
               // the solution value of this node is equal to corresponding node value in the first semiconductor region
               AutoDScalar ff1 = V - V_semi;
               AutoDScalar ff2 = T - T_semi;
 
-              PetscInt row_psi = fvm_nodes[i]->global_offset()+0;
-              PetscInt cols_psi[2] = { fvm_nodes[i]->global_offset()+0,  fvm_nodes[0]->global_offset()+0};
+              PetscInt row_psi = fvm_node->global_offset()+0;
+              PetscInt cols_psi[2] = { fvm_node->global_offset()+0,  fvm_node0->global_offset()+0};
               MatSetValues(*jac, 1, &row_psi, 2, cols_psi, ff1.getADValue(), ADD_VALUES);
 
-              PetscInt row_t = fvm_nodes[i]->global_offset()+1;
-              PetscInt cols_t[2] = { fvm_nodes[i]->global_offset()+1,  fvm_nodes[0]->global_offset()+3};
+              PetscInt row_t = fvm_node->global_offset()+1;
+              PetscInt cols_t[2] = { fvm_node->global_offset()+1,  fvm_node0->global_offset()+3};
               MatSetValues(*jac, 1, &row_t, 2, cols_t, ff2.getADValue(), ADD_VALUES);
 
               break;
@@ -43,25 +43,14 @@ using PhysicalUnit::e;
 void InsulatorInsulatorInterfaceBC::DDM2_Function_Preprocess(PetscScalar * ,Vec f, std::vector<PetscInt> &src_row,
     std::vector<PetscInt> &dst_row, std::vector<PetscInt> &clear_row)
 {
-  // search for all the node with this boundary type
-  BoundaryCondition::const_node_iterator node_it = nodes_begin();
-  BoundaryCondition::const_node_iterator end_it = nodes_end();
-
-  for(; node_it!=end_it; ++node_it )
+  // search for all the on processor node with this boundary type
+  for(TableWalk node(*this); node.valid(); node.next() )
   {
-
-    // skip node not belongs to this processor
-    if( (*node_it)->processor_id()!=Genius::processor_id() ) continue;
-
     const FVM_Node * first_node;
 
-    // search all the fvm_node which has *node_it as root node, these fvm_nodes have the same location in geometry,
-    // but belong to different regions in logic.
-    BoundaryCondition::region_node_iterator  rnode_it     = region_node_begin(*node_it);
-    BoundaryCondition::region_node_iterator  end_rnode_it = region_node_end(*node_it);
-    for(unsigned int i=0 ; rnode_it!=end_rnode_it; ++i, ++rnode_it  )
+    for(unsigned int i=0; i<node.size(); ++i )
     {
-      const FVM_Node * fvm_node = (*rnode_it).second.second;
+      const FVM_Node * fvm_node = node[i].fvm_node;
 
       // the first insulator region
       if(i==0)
@@ -104,32 +93,17 @@ void InsulatorInsulatorInterfaceBC::DDM2_Function(PetscScalar * x, Vec f, Insert
   // buffer for Vec value
   std::vector<PetscScalar> y_new;
 
-  // search for all the node with this boundary type
-  BoundaryCondition::const_node_iterator node_it = nodes_begin();
-  BoundaryCondition::const_node_iterator end_it = nodes_end();
-  for(; node_it!=end_it; ++node_it )
+  // search for all the on processor node with this boundary type
+  for(TableWalk node(*this); node.valid(); node.next() )
   {
+    // the fvm_node of the first region
+    const FVM_Node * fvm_node0 = node[0].fvm_node;
 
-    // skip node not belongs to this processor
-    if( (*node_it)->processor_id()!=Genius::processor_id() ) continue;
-
-    // buffer for saving regions and fvm_nodes this *node_it involves
-    std::vector<const SimulationRegion *> regions;
-    std::vector<const FVM_Node *> fvm_nodes;
-
-    // search all the fvm_node which has *node_it as root node, these fvm_nodes have the same location in geometry,
-    // but belong to different regions in logic.
-    BoundaryCondition::region_node_iterator  rnode_it     = region_node_begin(*node_it);
-    BoundaryCondition::region_node_iterator  end_rnode_it = region_node_end(*node_it);
-    for(unsigned int i=0 ; rnode_it!=end_rnode_it; ++i, ++rnode_it  )
+    for(unsigned int i=0; i<node.size(); ++i )
     {
-      const SimulationRegion * region = (*rnode_it).second.first;
-      const FVM_Node * fvm_node = (*rnode_it).second.second;
+      const FVM_Node * fvm_node = node[i].fvm_node;
       if(!fvm_node->is_valid()) continue;
 
-      regions.push_back( region );
-      fvm_nodes.push_back( fvm_node );
-
       // we may have several regions with insulator material
 
       // the first insulator region
@@ -144,23 +118,23 @@ void InsulatorInsulatorInterfaceBC::DDM2_Function(PetscScalar * x, Vec f, Insert
 
         // the governing equation of this fvm node --
 
-        PetscScalar V = x[fvm_nodes[i]->local_offset()+0]; // psi of this node
-        PetscScalar T = x[fvm_nodes[i]->local_offset()+1]; // T of this node
+        PetscScalar V = x[fvm_node->local_offset()+0]; // psi of this node
+        PetscScalar T = x[fvm_node->local_offset()+1]; // T of this node
 
 
-        PetscScalar V_in = x[fvm_nodes[0]->local_offset()+0]; // psi for ghost node
-        PetscScalar T_in = x[fvm_nodes[0]->local_offset()+1]; // T for ghost node
+        PetscScalar V_in = x[fvm_node0->local_offset()+0]; // psi for ghost node
+        PetscScalar T_in = x[fvm_node0->local_offset()+1]; // T for ghost node
 
         // the psi of this node is equal to corresponding psi of node in the first insulator region
         // since psi should be continuous for the interface
         PetscScalar ff1 = V - V_in;
-        iy.push_back(fvm_nodes[i]->global_offset()+0);
+        iy.push_back(fvm_node->global_offset()+0);
         y_new.push_back(ff1);
 
         // the T of this node is equal to corresponding T of node in the first insulator region
         // by assuming no heat resistance between 2 region
         PetscScalar ff2 = T - T_in;
-        iy.push_back(fvm_nodes[i]->global_offset()+1);
+        iy.push_back(fvm_node->global_offset()+1);
         y_new.push_back(ff2);
 
         genius_assert(iy.size()==y_new.size());
@@ -194,47 +168,33 @@ void InsulatorInsulatorInterfaceBC::DDM2_Jacobian_Reserve(Mat *jac, InsertMode &
     MatAssemblyEnd(*jac, MAT_FLUSH_ASSEMBLY);
   }
 
-  // search for all the node with this boundary type
-  BoundaryCondition::const_node_iterator node_it = nodes_begin();
-  BoundaryCondition::const_node_iterator end_it = nodes_end();
-  for(; node_it!=end_it; ++node_it )
+  // search for all the on processor node with this boundary type
+  for(TableWalk node(*this); node.valid(); node.next() )
   {
-    // skip node not belongs to this processor
-    if( (*node_it)->processor_id()!=Genius::processor_id() ) continue;
-
-    // buffer for saving regions and fvm_nodes this *node_it involves
-    std::vector<const SimulationRegion *> regions;
-    std::vector<const FVM_Node *> fvm_nodes;
-
-    // search all the fvm_node which has *node_it as root node, these fvm_nodes have the same location in geometry,
-    // but belong to different regions in logic.
-    BoundaryCondition::region_node_iterator  rnode_it     = region_node_begin(*node_it);
-    BoundaryCondition::region_node_iterator  end_rnode_it = region_node_end(*node_it);
-    for(unsigned int i=0 ; rnode_it!=end_rnode_it; ++i, ++rnode_it  )
+    // the fvm_node of the first region
+    const FVM_Node * fvm_node0 = node[0].fvm_node;
+
+    for(unsigned int i=0; i<node.size(); ++i )
     {
-      const SimulationRegion * region = (*rnode_it).second.first;
-      const FVM_Node * fvm_node = (*rnode_it).second.second;
+      const FVM_Node * fvm_node = node[i].fvm_node;
       if(!fvm_node->is_valid()) continue;
 
-      regions.push_back( region );
-      fvm_nodes.push_back( fvm_node );
-
       // the first insulator region
       if(i==0)
       {
         // reserve items for all the ghost nodes
-        FVM_Node::fvm_ghost_node_iterator gn_it = fvm_nodes[i]->ghost_node_begin();
-        for(; gn_it != fvm_nodes[i]->ghost_node_end(); ++gn_it)
+        FVM_Node::fvm_ghost_node_iterator gn_it = fvm_node->ghost_node_begin();
+        for(; gn_it != fvm_node->ghost_node_end(); ++gn_it)
         {
           const FVM_Node * ghost_fvm_node = (*gn_it).first;
-          MatSetValue(*jac, fvm_nodes[i]->global_offset()+0, ghost_fvm_node->global_offset()+0, 0, ADD_VALUES);
-          MatSetValue(*jac, fvm_nodes[i]->global_offset()+1, ghost_fvm_node->global_offset()+1, 0, ADD_VALUES);
+          MatSetValue(*jac, fvm_node->global_offset()+0, ghost_fvm_node->global_offset()+0, 0, ADD_VALUES);
+          MatSetValue(*jac, fvm_node->global_offset()+1, ghost_fvm_node->global_offset()+1, 0, ADD_VALUES);
 
           FVM_Node::fvm_neighbor_node_iterator  gnb_it = ghost_fvm_node->neighbor_node_begin();
           for(; gnb_it != ghost_fvm_node->neighbor_node_end(); ++gnb_it)
           {
-            MatSetValue(*jac, fvm_nodes[i]->global_offset()+0, (*gnb_it).first->global_offset()+0, 0, ADD_VALUES);
-            MatSetValue(*jac, fvm_nodes[i]->global_offset()+1, (*gnb_it).first->global_offset()+1, 0, ADD_VALUES);
+            MatSetValue(*jac, fvm_node->global_offset()+0, (*gnb_it).first->global_offset()+0, 0, ADD_VALUES);
+            MatSetValue(*jac, fvm_node->global_offset()+1, (*gnb_it).first->global_offset()+1, 0, ADD_VALUES);
           }
         }
       }
@@ -243,8 +203,8 @@ void InsulatorInsulatorInterfaceBC::DDM2_Jacobian_Reserve(Mat *jac, InsertMode &
       else
       {
         // reserve for later operator
-        MatSetValue(*jac, fvm_nodes[i]->global_offset()+0, fvm_nodes[0]->global_offset()+0, 0, ADD_VALUES);
-        MatSetValue(*jac, fvm_nodes[i]->global_offset()+1, fvm_nodes[0]->global_offset()+1, 0, ADD_VALUES);
+        MatSetValue(*jac, fvm_node->global_offset()+0, fvm_node0->global_offset()+0, 0, ADD_VALUES);
+        MatSetValue(*jac, fvm_node->global_offset()+1, fvm_node0->global_offset()+1, 0, ADD_VALUES);
       }
     }
 
@@ -264,24 +224,14 @@ void InsulatorInsulatorInterfaceBC::DDM2_Jacobian_Preprocess(PetscScalar *,Mat *
     std::vector<PetscInt> &dst_row, std::vector<PetscInt> &clear_row)
 {
  // search for all the node with this boundary type
-  BoundaryCondition::const_node_iterator node_it = nodes_begin();
-  BoundaryCondition::const_node_iterator end_it = nodes_end();
-
-  for(; node_it!=end_it; ++node_it )
+  // search for all the on processor node with this boundary type
+  for(TableWalk node(*this); node.valid(); node.next() )
   {
-
-    // skip node not belongs to this processor
-    if( (*node_it)->processor_id()!=Genius::processor_id() ) continue;
-
     const FVM_Node * first_node;
 
-    // search all the fvm_node which has *node_it as root node, these fvm_nodes have the same location in geometry,
-    // but belong to different regions in logic.
-    BoundaryCondition::region_node_iterator  rnode_it     = region_node_begin(*node_it);
-    BoundaryCondition::region_node_iterator  end_rnode_it = region_node_end(*node_it);
-    for(unsigned int i=0 ; rnode_it!=end_rnode_it; ++i, ++rnode_it  )
+    for(unsigned int i=0; i<node.size(); ++i )
     {
-      const FVM_Node * fvm_node = (*rnode_it).second.second;
+      const FVM_Node * fvm_node = node[i].fvm_node;
 
       // the first insulator region
       if(i==0)
@@ -320,31 +270,17 @@ void InsulatorInsulatorInterfaceBC::DDM2_Jacobian(PetscScalar * x, Mat *jac, Ins
 
 
   // after that, set values to source rows
-  BoundaryCondition::const_node_iterator node_it = nodes_begin();
-  BoundaryCondition::const_node_iterator end_it = nodes_end();
-  for(node_it = nodes_begin(); node_it!=end_it; ++node_it )
+  // search for all the on processor node with this boundary type
+  for(TableWalk node(*this); node.valid(); node.next() )
   {
-    // skip node not belongs to this processor
-    if( (*node_it)->processor_id()!=Genius::processor_id() ) continue;
-
-    // buffer for saving regions and fvm_nodes this *node_it involves
-    std::vector<const SimulationRegion *> regions;
-    std::vector<const FVM_Node *> fvm_nodes;
-
-    // search all the fvm_node which has *node_it as root node, these fvm_nodes have the same location in geometry,
-    // but belong to different regions in logic.
-    BoundaryCondition::region_node_iterator  rnode_it     = region_node_begin(*node_it);
-    BoundaryCondition::region_node_iterator  end_rnode_it = region_node_end(*node_it);
-    for(unsigned int i=0 ; rnode_it!=end_rnode_it; ++i, ++rnode_it  )
+    // the fvm_node of the first region
+    const FVM_Node * fvm_node0 = node[0].fvm_node;
+
+    for(unsigned int i=0; i<node.size(); ++i )
     {
-      const SimulationRegion * region = (*rnode_it).second.first;
-      const FVM_Node * fvm_node = (*rnode_it).second.second;
+      const FVM_Node * fvm_node = node[i].fvm_node;
       if(!fvm_node->is_valid()) continue;
 
-      regions.push_back( region );
-      fvm_nodes.push_back( fvm_node );
-
-
       // the first insulator region
       if(i==0) continue;
 
@@ -356,32 +292,32 @@ void InsulatorInsulatorInterfaceBC::DDM2_Jacobian(PetscScalar * x, Mat *jac, Ins
         adtl::AutoDScalar::numdir=2;
 
         // psi of this node
-        AutoDScalar  V    = x[fvm_nodes[i]->local_offset()]; V.setADValue(0,1.0);
+        AutoDScalar  V    = x[fvm_node->local_offset()]; V.setADValue(0,1.0);
 
         // psi for ghost node
-        AutoDScalar  V_in = x[fvm_nodes[0]->local_offset()]; V_in.setADValue(1,1.0);
+        AutoDScalar  V_in = x[fvm_node0->local_offset()]; V_in.setADValue(1,1.0);
 
         // the psi of this node is equal to corresponding psi of insulator node in the other region
         AutoDScalar  ff1 = V - V_in;
 
         // set Jacobian of governing equation ff
-        MatSetValue(*jac, fvm_nodes[i]->global_offset(), fvm_nodes[i]->global_offset(), ff1.getADValue(0), ADD_VALUES);
-        MatSetValue(*jac, fvm_nodes[i]->global_offset(), fvm_nodes[0]->global_offset(), ff1.getADValue(1), ADD_VALUES);
+        MatSetValue(*jac, fvm_node->global_offset(), fvm_node->global_offset(), ff1.getADValue(0), ADD_VALUES);
+        MatSetValue(*jac, fvm_node->global_offset(), fvm_node0->global_offset(), ff1.getADValue(1), ADD_VALUES);
 
 
         // T of this node
-        AutoDScalar  T = x[fvm_nodes[i]->local_offset()+1]; T.setADValue(0,1.0);
+        AutoDScalar  T = x[fvm_node->local_offset()+1]; T.setADValue(0,1.0);
 
         // T for corresponding  region
-        AutoDScalar  T_in = x[fvm_nodes[0]->local_offset()+1]; T_in.setADValue(1,1.0);
+        AutoDScalar  T_in = x[fvm_node0->local_offset()+1]; T_in.setADValue(1,1.0);
 
         // the T of this node is equal to corresponding T of other insulator node
         // we assuming T is continuous for the interface
         AutoDScalar ff2 = T - T_in;
 
         // set Jacobian of governing equation ff2
-        MatSetValue(*jac, fvm_nodes[i]->global_offset()+1, fvm_nodes[i]->global_offset()+1, ff2.getADValue(0), ADD_VALUES);
-        MatSetValue(*jac, fvm_nodes[i]->global_offset()+1, fvm_nodes[0]->global_offset()+1, ff2.getADValue(1), ADD_VALUES);
+        MatSetValue(*jac, fvm_node->global_offset()+1, fvm_node->global_offset()+1, ff2.getADValue(0), ADD_VALUES);
+        MatSetValue(*jac, fvm_node->global_offset()+1, fvm_node0->global_offset()+1, ff2.getADValue(1), ADD_VALUES);
 
       }
 
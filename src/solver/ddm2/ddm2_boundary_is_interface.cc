@@ -46,28 +46,15 @@ void InsulatorSemiconductorInterfaceBC::DDM2_Function_Preprocess(PetscScalar * ,
     std::vector<PetscInt> &dst_row, std::vector<PetscInt> &clear_row)
 {
 
-  // search for all the node with this boundary type
-  BoundaryCondition::const_node_iterator node_it = nodes_begin();
-  BoundaryCondition::const_node_iterator end_it = nodes_end();
-  for(; node_it!=end_it; ++node_it )
+  // search for all the on processor node with this boundary type
+  for(TableWalk node(*this); node.valid(); node.next() )
   {
-    // skip node not belongs to this processor
-    if( (*node_it)->processor_id()!=Genius::processor_id() ) continue;
-
-    // buffer for saving regions and fvm_nodes this *node_it involves
-    std::vector<const SimulationRegion *> regions;
-    std::vector<const FVM_Node *> fvm_nodes;
-
-    // search all the fvm_node which has *node_it as root node, these fvm_nodes have the same location in geometry,
-    // but belong to different regions in logic.
-    BoundaryCondition::region_node_iterator  rnode_it     = region_node_begin(*node_it);
-    BoundaryCondition::region_node_iterator  end_rnode_it = region_node_end(*node_it);
-    for(unsigned int i=0 ; rnode_it!=end_rnode_it; ++i, ++rnode_it  )
+    for(unsigned int i=0; i<node.size(); ++i )
     {
-      regions.push_back( (*rnode_it).second.first );
-      fvm_nodes.push_back( (*rnode_it).second.second );
+      const SimulationRegion * region = node[i].region;
+      const FVM_Node * fvm_node = node[i].fvm_node;
 
-      switch ( regions[i]->type() )
+      switch ( region->type() )
       {
           // Insulator-Semiconductor interface at Semiconductor side, do nothing
           case SemiconductorRegion:  break;
@@ -76,13 +63,13 @@ void InsulatorSemiconductorInterfaceBC::DDM2_Function_Preprocess(PetscScalar * ,
           case InsulatorRegion:
           {
             // record the source row and dst row
-            src_row.push_back(fvm_nodes[i]->global_offset());
-            dst_row.push_back(fvm_nodes[0]->global_offset());
-            clear_row.push_back(fvm_nodes[i]->global_offset());
+            src_row.push_back(fvm_node->global_offset());
+            dst_row.push_back(node[0].fvm_node->global_offset());
+            clear_row.push_back(fvm_node->global_offset());
 
-            src_row.push_back(fvm_nodes[i]->global_offset()+1);
-            dst_row.push_back(fvm_nodes[0]->global_offset()+3);
-            clear_row.push_back(fvm_nodes[i]->global_offset()+1);
+            src_row.push_back(fvm_node->global_offset()+1);
+            dst_row.push_back(node[0].fvm_node->global_offset()+3);
+            clear_row.push_back(fvm_node->global_offset()+1);
             break;
           }
           case VacuumRegion:
@@ -118,29 +105,15 @@ void InsulatorSemiconductorInterfaceBC::DDM2_Function(PetscScalar * x, Vec f, In
 
   const PetscScalar qf = this->scalar("qf");
 
-  // search for all the node with this boundary type
-  BoundaryCondition::const_node_iterator node_it = nodes_begin();
-  BoundaryCondition::const_node_iterator end_it = nodes_end();
-  for(; node_it!=end_it; ++node_it )
+  // search for all the on processor node with this boundary type
+  for(TableWalk node(*this); node.valid(); node.next() )
   {
-
-    // skip node not belongs to this processor
-    if( (*node_it)->processor_id()!=Genius::processor_id() ) continue;
-
-    // buffer for saving regions and fvm_nodes this *node_it involves
-    std::vector<const SimulationRegion *> regions;
-    std::vector<const FVM_Node *> fvm_nodes;
-
-    // search all the fvm_node which has *node_it as root node, these fvm_nodes have the same location in geometry,
-    // but belong to different regions in logic.
-    BoundaryCondition::region_node_iterator  rnode_it     = region_node_begin(*node_it);
-    BoundaryCondition::region_node_iterator  end_rnode_it = region_node_end(*node_it);
-    for(unsigned int i=0 ; rnode_it!=end_rnode_it; ++i, ++rnode_it  )
+    for(unsigned int i=0; i<node.size(); ++i )
     {
-      regions.push_back( (*rnode_it).second.first );
-      fvm_nodes.push_back( (*rnode_it).second.second );
+      const SimulationRegion * region = node[i].region;
+      const FVM_Node * fvm_node = node[i].fvm_node;
 
-      switch ( regions[i]->type() )
+      switch ( region->type() )
       {
           // Insulator-Semiconductor interface at Semiconductor side, do nothing
           case SemiconductorRegion:
@@ -149,58 +122,60 @@ void InsulatorSemiconductorInterfaceBC::DDM2_Function(PetscScalar * x, Vec f, In
             genius_assert(i==0);
 
             // process interface traps
-            SemiconductorSimulationRegion * sregion = (SemiconductorSimulationRegion *) regions[i];
+            SemiconductorSimulationRegion * sregion = (SemiconductorSimulationRegion *) region;
 
-            const FVM_NodeData * node_data = fvm_nodes[i]->node_data();
+            const FVM_NodeData * node_data = fvm_node->node_data();
             genius_assert(node_data);
 
-            PetscScalar n   =  x[fvm_nodes[i]->local_offset()+1];                         // electron density
-            PetscScalar p   =  x[fvm_nodes[i]->local_offset()+2];                         // hole density
-            PetscScalar T   =  x[fvm_nodes[i]->local_offset()+3];
+            PetscScalar n   =  x[fvm_node->local_offset()+1];                         // electron density
+            PetscScalar p   =  x[fvm_node->local_offset()+2];                         // hole density
+            PetscScalar T   =  x[fvm_node->local_offset()+3];
 
             // process interface fixed charge density
-            PetscScalar boundary_area = fvm_nodes[i]->outside_boundary_surface_area();
-            VecSetValue(f, fvm_nodes[i]->global_offset(), qf*boundary_area, ADD_VALUES);
+            PetscScalar boundary_area = fvm_node->outside_boundary_surface_area();
+            VecSetValue(f, fvm_node->global_offset(), qf*boundary_area, ADD_VALUES);
 
             {
               // surface recombination
               Material::MaterialSemiconductor *mt =  sregion->material();
-              mt->mapping(fvm_nodes[i]->root_node(), node_data, SolverSpecify::clock);
+              mt->mapping(fvm_node->root_node(), node_data, SolverSpecify::clock);
               mt->band->nie(p, n, T);
               PetscScalar GSurf = - mt->band->R_Surf(p, n, T) * boundary_area; //generation due to SRH
               PetscScalar HR = -GSurf*(node_data->Eg() + 3*PhysicalUnit::kb*T); // heat transferred to lattice
 
-              VecSetValue(f, fvm_nodes[i]->global_offset()+1, GSurf, ADD_VALUES);
-              VecSetValue(f, fvm_nodes[i]->global_offset()+2, GSurf, ADD_VALUES);
-              VecSetValue(f, fvm_nodes[i]->global_offset()+3, HR, ADD_VALUES);
+              VecSetValue(f, fvm_node->global_offset()+1, GSurf, ADD_VALUES);
+              VecSetValue(f, fvm_node->global_offset()+2, GSurf, ADD_VALUES);
+              VecSetValue(f, fvm_node->global_offset()+3, HR, ADD_VALUES);
             }
 
             if (sregion->get_advanced_model()->Trap)
             {
               // process interface traps
-              sregion->material()->mapping(fvm_nodes[i]->root_node(), node_data, SolverSpecify::clock);
+              sregion->material()->mapping(fvm_node->root_node(), node_data, SolverSpecify::clock);
 
               // calculate interface trap occupancy
               PetscScalar ni = sregion->material()->band->nie(p, n, T);
-              sregion->material()->trap->Calculate(false,p,n,ni,T);
+              // trap occupancy is frozen between steps when advanced explicitly
+              if (!sregion->get_advanced_model()->TrapExplicit)
+                sregion->material()->trap->Calculate(false,p,n,ni,T);
 
               // contribution of trapped charge to Poisson's eqn
               PetscScalar TrappedC = sregion->material()->trap->Charge(false) * boundary_area;
               if (TrappedC !=0)
-                VecSetValue(f, fvm_nodes[i]->global_offset(), TrappedC, ADD_VALUES);
+                VecSetValue(f, fvm_node->global_offset(), TrappedC, ADD_VALUES);
 
               // electron/hole capture rates and contribution to continuity equations
               PetscScalar TrapElec = sregion->material()->trap->ElectronTrapRate(false,n,ni,T) * boundary_area;
               PetscScalar TrapHole = sregion->material()->trap->HoleTrapRate    (false,p,ni,T) * boundary_area;
               if (TrapElec != 0)
-                VecSetValue(f, fvm_nodes[i]->global_offset()+1, -TrapElec, ADD_VALUES);
+                VecSetValue(f, fvm_node->global_offset()+1, -TrapElec, ADD_VALUES);
               if (TrapHole != 0)
-                VecSetValue(f, fvm_nodes[i]->global_offset()+2, -TrapHole, ADD_VALUES);
+                VecSetValue(f, fvm_node->global_offset()+2, -TrapHole, ADD_VALUES);
 
               PetscScalar EcEi = 0.5*node_data->Eg() - kb*T*log(node_data->Nc()/node_data->Nv());
               PetscScalar EiEv = 0.5*node_data->Eg() + kb*T*log(node_data->Nc()/node_data->Nv());
               PetscScalar H    = sregion->material()->trap->TrapHeat(false,p,n,ni,T,T,T,EcEi,EiEv);
-              VecSetValue(f, fvm_nodes[i]->global_offset()+3, H*boundary_area, ADD_VALUES);
+              VecSetValue(f, fvm_node->global_offset()+3, H*boundary_area, ADD_VALUES);
             }
             break;
           }
@@ -210,27 +185,27 @@ void InsulatorSemiconductorInterfaceBC::DDM2_Function(PetscScalar * x, Vec f, In
           // force the potential equal to corresponding point in semiconductor
           case InsulatorRegion:
           {
-            genius_assert(fvm_nodes[i]->root_node()->processor_id() == fvm_nodes[0]->root_node()->processor_id() );
+            genius_assert(fvm_node->root_node()->processor_id() == node[0].fvm_node->root_node()->processor_id() );
 
             // the governing equation of this fvm node
 
-            iy.push_back(fvm_nodes[i]->global_offset()+0);
+            iy.push_back(fvm_node->global_offset()+0);
             // psi of this node
-            PetscScalar V = x[fvm_nodes[i]->local_offset()+0];
+            PetscScalar V = x[fvm_node->local_offset()+0];
             // since the region is sorted, we know region[0] is semiconductor region
-            // as a result, x[fvm_nodes[0]->local_offset()] is psi for corresponding semiconductor region
-            //genius_assert( regions[0]->type()==SemiconductorRegion );
-            PetscScalar V_semi = x[fvm_nodes[0]->local_offset()+0];
+            // as a result, x[node[0].fvm_node->local_offset()] is psi for corresponding semiconductor region
+            //genius_assert( node[0].region->type()==SemiconductorRegion );
+            PetscScalar V_semi = x[node[0].fvm_node->local_offset()+0];
             // the psi of this node is equal to corresponding psi of semiconductor node
             // since psi should be continuous for the interface
             PetscScalar ff1 = V - V_semi;
             y.push_back(ff1);
 
-            iy.push_back(fvm_nodes[i]->global_offset()+1);
+            iy.push_back(fvm_node->global_offset()+1);
             // T of this node
-            PetscScalar T = x[fvm_nodes[i]->local_offset()+1];
+            PetscScalar T = x[fvm_node->local_offset()+1];
             // T for corresponding semiconductor region
-            PetscScalar T_semi = x[fvm_nodes[0]->local_offset()+3];
+            PetscScalar T_semi = x[node[0].fvm_node->local_offset()+3];
             // the T of this node is equal to corresponding T of semiconductor node
             // by assuming no heat resistance between 2 region
             PetscScalar ff2 = T - T_semi;
@@ -275,28 +250,15 @@ void InsulatorSemiconductorInterfaceBC::DDM2_Jacobian_Reserve(Mat *jac, InsertMo
     MatAssemblyEnd(*jac, MAT_FLUSH_ASSEMBLY);
   }
 
-  // search for all the node with this boundary type
-  BoundaryCondition::const_node_iterator node_it = nodes_begin();
-  BoundaryCondition::const_node_iterator end_it = nodes_end();
-  for(; node_it!=end_it; ++node_it )
+  // search for all the on processor node with this boundary type
+  for(TableWalk node(*this); node.valid(); node.next() )
   {
-    // skip node not belongs to this processor
-    if( (*node_it)->processor_id()!=Genius::processor_id() ) continue;
-
-    // buffer for saving regions and fvm_nodes this *node_it involves
-    std::vector<const SimulationRegion *> regions;
-    std::vector<const FVM_Node *> fvm_nodes;
-
-    // search all the fvm_node which has *node_it as root node, these fvm_nodes have the same location in geometry,
-    // but belong to different regions in logic.
-    BoundaryCondition::region_node_iterator  rnode_it     = region_node_begin(*node_it);
-    BoundaryCondition::region_node_iterator  end_rnode_it = region_node_end(*node_it);
-    for(unsigned int i=0 ; rnode_it!=end_rnode_it; ++i, ++rnode_it  )
+    for(unsigned int i=0; i<node.size(); ++i )
     {
-      regions.push_back( (*rnode_it).second.first );
-      fvm_nodes.push_back( (*rnode_it).second.second );
+      const SimulationRegion * region = node[i].region;
+      const FVM_Node * fvm_node = node[i].fvm_node;
 
-      switch ( regions[i]->type() )
+      switch ( region->type() )
       {
           // Insulator-Semiconductor interface at Semiconductor side, we should reserve entrance for later add operator
           case SemiconductorRegion:
@@ -304,17 +266,16 @@ void InsulatorSemiconductorInterfaceBC::DDM2_Jacobian_Reserve(Mat *jac, InsertMo
             // semiconductor region should be the first region
             genius_assert(i==0);
 
-            // since we know only one ghost node exit, there is ghost_node_begin()
-            FVM_Node::fvm_ghost_node_iterator gn_it = fvm_nodes[i]->ghost_node_begin();
-            const FVM_Node * ghost_fvm_node = (*gn_it).first;
-            MatSetValue(*jac, fvm_nodes[i]->global_offset()+0, ghost_fvm_node->global_offset()+0, 0, ADD_VALUES);
-            MatSetValue(*jac, fvm_nodes[i]->global_offset()+3, ghost_fvm_node->global_offset()+1, 0, ADD_VALUES);
+            // since we know only one ghost node exit, it is the ghost node of table entry
+            const FVM_Node * ghost_fvm_node = node[i].ghost_node;
+            MatSetValue(*jac, fvm_node->global_offset()+0, ghost_fvm_node->global_offset()+0, 0, ADD_VALUES);
+            MatSetValue(*jac, fvm_node->global_offset()+3, ghost_fvm_node->global_offset()+1, 0, ADD_VALUES);
 
             FVM_Node::fvm_neighbor_node_iterator  gnb_it = ghost_fvm_node->neighbor_node_begin();
             for(; gnb_it != ghost_fvm_node->neighbor_node_end(); ++gnb_it)
             {
-              MatSetValue(*jac, fvm_nodes[i]->global_offset()+0, (*gnb_it).first->global_offset()+0, 0, ADD_VALUES);
-              MatSetValue(*jac, fvm_nodes[i]->global_offset()+3, (*gnb_it).first->global_offset()+1, 0, ADD_VALUES);
+              MatSetValue(*jac, fvm_node->global_offset()+0, (*gnb_it).first->global_offset()+0, 0, ADD_VALUES);
+              MatSetValue(*jac, fvm_node->global_offset()+3, (*gnb_it).first->global_offset()+1, 0, ADD_VALUES);
             }
             break;
           }
@@ -323,8 +284,8 @@ void InsulatorSemiconductorInterfaceBC::DDM2_Jacobian_Reserve(Mat *jac, InsertMo
           case InsulatorRegion:
           {
             // reserve for later operator
-            MatSetValue(*jac, fvm_nodes[i]->global_offset()+0, fvm_nodes[0]->global_offset()+0, 0, ADD_VALUES);
-            MatSetValue(*jac, fvm_nodes[i]->global_offset()+1, fvm_nodes[0]->global_offset()+3, 0, ADD_VALUES);
+            MatSetValue(*jac, fvm_node->global_offset()+0, node[0].fvm_node->global_offset()+0, 0, ADD_VALUES);
+            MatSetValue(*jac, fvm_node->global_offset()+1, node[0].fvm_node->global_offset()+3, 0, ADD_VALUES);
 
             break;
           }
@@ -349,28 +310,15 @@ void InsulatorSemiconductorInterfaceBC::DDM2_Jacobian_Reserve(Mat *jac, InsertMo
 void InsulatorSemiconductorInterfaceBC::DDM2_Jacobian_Preprocess(PetscScalar *,Mat *jac, std::vector<PetscInt> &src_row,
     std::vector<PetscInt> &dst_row, std::vector<PetscInt> &clear_row)
 {
-  // search for all the node with this boundary type
-  BoundaryCondition::const_node_iterator node_it = nodes_begin();
-  BoundaryCondition::const_node_iterator end_it = nodes_end();
-  for(; node_it!=end_it; ++node_it )
+  // search for all the on processor node with this boundary type
+  for(TableWalk node(*this); node.valid(); node.next() )
   {
-    // skip node not belongs to this processor
-    if( (*node_it)->processor_id()!=Genius::processor_id() ) continue;
-
-    // buffer for saving regions and fvm_nodes this *node_it involves
-    std::vector<const SimulationRegion *> regions;
-    std::vector<const FVM_Node *> fvm_nodes;
-
-    // search all the fvm_node which has *node_it as root node, these fvm_nodes have the same location in geometry,
-    // but belong to different regions in logic.
-    BoundaryCondition::region_node_iterator  rnode_it     = region_node_begin(*node_it);
-    BoundaryCondition::region_node_iterator  end_rnode_it = region_node_end(*node_it);
-    for(unsigned int i=0 ; rnode_it!=end_rnode_it; ++i, ++rnode_it  )
+    for(unsigned int i=0; i<node.size(); ++i )
     {
-      regions.push_back( (*rnode_it).second.first );
-      fvm_nodes.push_back( (*rnode_it).second.second );
+      const SimulationRegion * region = node[i].region;
+      const FVM_Node * fvm_node = node[i].fvm_node;
 
-      switch ( regions[i]->type() )
+      switch ( region->type() )
       {
           // Insulator-Semiconductor interface at Semiconductor side, do nothing
           case SemiconductorRegion:  break;
@@ -379,13 +327,13 @@ void InsulatorSemiconductorInterfaceBC::DDM2_Jacobian_Preprocess(PetscScalar *,M
           case InsulatorRegion:
           {
             // record the source row and dst row
-            src_row.push_back(fvm_nodes[i]->global_offset());
-            dst_row.push_back(fvm_nodes[0]->global_offset());
-            clear_row.push_back(fvm_nodes[i]->global_offset());
+            src_row.push_back(fvm_node->global_offset());
+            dst_row.push_back(node[0].fvm_node->global_offset());
+            clear_row.push_back(fvm_node->global_offset());
 
-            src_row.push_back(fvm_nodes[i]->global_offset()+1);
-            dst_row.push_back(fvm_nodes[0]->global_offset()+3);
-            clear_row.push_back(fvm_nodes[i]->global_offset()+1);
+            src_row.push_back(fvm_node->global_offset()+1);
+            dst_row.push_back(node[0].fvm_node->global_offset()+3);
+            clear_row.push_back(fvm_node->global_offset()+1);
             break;
           }
           case VacuumRegion:
@@ -412,27 +360,14 @@ void InsulatorSemiconductorInterfaceBC::DDM2_Jacobian(PetscScalar * x, Mat *jac,
   }
 
   // after that, set values to source rows
-  BoundaryCondition::const_node_iterator node_it = nodes_begin();
-  BoundaryCondition::const_node_iterator end_it = nodes_end();
-  for(; node_it!=end_it; ++node_it )
+  for(TableWalk node(*this); node.valid(); node.next() )
   {
-    // skip node not belongs to this processor
-    if( (*node_it)->processor_id()!=Genius::processor_id() ) continue;
-
-    // buffer for saving regions and fvm_nodes this *node_it involves
-    std::vector<const SimulationRegion *> regions;
-    std::vector<const FVM_Node *> fvm_nodes;
-
-    // search all the fvm_node which has *node_it as root node, these fvm_nodes have the same location in geometry,
-    // but belong to different regions in logic.
-    BoundaryCondition::region_node_iterator  rnode_it     = region_node_begin(*node_it);
-    BoundaryCondition::region_node_iterator  end_rnode_it = region_node_end(*node_it);
-    for(unsigned int i=0 ; rnode_it!=end_rnode_it; ++i, ++rnode_it  )
+    for(unsigned int i=0; i<node.size(); ++i )
     {
-      regions.push_back( (*rnode_it).second.first );
-      fvm_nodes.push_back( (*rnode_it).second.second );
+      const SimulationRegion * region = node[i].region;
+      const FVM_Node * fvm_node = node[i].fvm_node;
 
-      switch ( regions[i]->type() )
+      switch ( region->type() )
       {
           // Insulator-Semiconductor interface at Semiconductor side, do nothing
           case SemiconductorRegion:
@@ -441,24 +376,24 @@ void InsulatorSemiconductorInterfaceBC::DDM2_Jacobian(PetscScalar * x, Mat *jac,
             adtl::AutoDScalar::numdir = 4;
 
             // process interface traps
-            SemiconductorSimulationRegion * sregion = (SemiconductorSimulationRegion *) regions[i];
+            SemiconductorSimulationRegion * sregion = (SemiconductorSimulationRegion *) region;
 
-            const FVM_NodeData * node_data = fvm_nodes[i]->node_data();
+            const FVM_NodeData * node_data = fvm_node->node_data();
             genius_assert(node_data);
 
             {
-              PetscInt index[4] = {fvm_nodes[i]->global_offset()+0, fvm_nodes[i]->global_offset()+1, fvm_nodes[i]->global_offset()+2, fvm_nodes[i]->global_offset()+3};
-              AutoDScalar n   =  x[fvm_nodes[i]->local_offset()+1];   n.setADValue(1, 1.0);              // electron density
-              AutoDScalar p   =  x[fvm_nodes[i]->local_offset()+2];   p.setADValue(2, 1.0);              // hole density
-              AutoDScalar T   =  x[fvm_nodes[i]->local_offset()+3];   T.setADValue(3, 1.0);
-              PetscScalar boundary_area = fvm_nodes[i]->outside_boundary_surface_area();
+              PetscInt index[4] = {fvm_node->global_offset()+0, fvm_node->global_offset()+1, fvm_node->global_offset()+2, fvm_node->global_offset()+3};
+              AutoDScalar n   =  x[fvm_node->local_offset()+1];   n.setADValue(1, 1.0);              // electron density
+              AutoDScalar p   =  x[fvm_node->local_offset()+2];   p.setADValue(2, 1.0);              // hole density
+              AutoDScalar T   =  x[fvm_node->local_offset()+3];   T.setADValue(3, 1.0);
+              PetscScalar boundary_area = fvm_node->outside_boundary_surface_area();
 
               Material::MaterialSemiconductor *mt =  sregion->material();
               //synchronize with material database
               mt->set_ad_num(adtl::AutoDScalar::numdir);
 
 
-              mt->mapping(fvm_nodes[i]->root_node(), node_data, SolverSpecify::clock);
+              mt->mapping(fvm_node->root_node(), node_data, SolverSpecify::clock);
 
               AutoDScalar ni = mt->band->nie(p, n, T);
 
@@ -475,7 +410,9 @@ void InsulatorSemiconductorInterfaceBC::DDM2_Jacobian(PetscScalar * x, Mat *jac,
               if (sregion->get_advanced_model()->Trap)
               {
 
-                mt->trap->Calculate(false,p,n,ni,T);
+                // trap occupancy is frozen between steps when advanced explicitly
+                if (!sregion->get_advanced_model()->TrapExplicit)
+                  mt->trap->Calculate(false,p,n,ni,T);
                 AutoDScalar TrappedC = mt->trap->ChargeAD(false) * boundary_area;
                 MatSetValues(*jac, 1, &index[0], 4, &index[0], TrappedC.getADValue(), ADD_VALUES);
 
@@ -501,34 +438,34 @@ void InsulatorSemiconductorInterfaceBC::DDM2_Jacobian(PetscScalar * x, Mat *jac,
             adtl::AutoDScalar::numdir=2;
 
             // psi of this node
-            AutoDScalar  V = x[fvm_nodes[i]->local_offset()]; V.setADValue(0,1.0);
+            AutoDScalar  V = x[fvm_node->local_offset()]; V.setADValue(0,1.0);
 
             // since the region is sorted, we know region[0] is semiconductor region
-            // as a result, x[fvm_nodes[0]->local_offset()] is psi for corresponding semiconductor region
-            //genius_assert( regions[0]->type()==SemiconductorRegion );
-            AutoDScalar  V_semi = x[fvm_nodes[0]->local_offset()]; V_semi.setADValue(1,1.0);
+            // as a result, x[node[0].fvm_node->local_offset()] is psi for corresponding semiconductor region
+            //genius_assert( node[0].region->type()==SemiconductorRegion );
+            AutoDScalar  V_semi = x[node[0].fvm_node->local_offset()]; V_semi.setADValue(1,1.0);
 
             // the psi of this node is equal to corresponding psi of semiconductor node
             AutoDScalar  ff1 = V - V_semi;
 
             // set Jacobian of governing equation ff
-            MatSetValue(*jac, fvm_nodes[i]->global_offset(), fvm_nodes[i]->global_offset(), ff1.getADValue(0), ADD_VALUES);
-            MatSetValue(*jac, fvm_nodes[i]->global_offset(), fvm_nodes[0]->global_offset(), ff1.getADValue(1), ADD_VALUES);
+            MatSetValue(*jac, fvm_node->global_offset(), fvm_node->global_offset(), ff1.getADValue(0), ADD_VALUES);
+            MatSetValue(*jac, fvm_node->global_offset(), node[0].fvm_node->global_offset(), ff1.getADValue(1), ADD_VALUES);
 
 
             // T of this node
-            AutoDScalar  T = x[fvm_nodes[i]->local_offset()+1]; T.setADValue(0,1.0);
+            AutoDScalar  T = x[fvm_node->local_offset()+1]; T.setADValue(0,1.0);
 
             // T for corresponding semiconductor region
-            AutoDScalar  T_semi = x[fvm_nodes[0]->local_offset()+3]; T_semi.setADValue(1,1.0);
+            AutoDScalar  T_semi = x[node[0].fvm_node->local_offset()+3]; T_semi.setADValue(1,1.0);
 
             // the T of this node is equal to corresponding T of semiconductor node
             // we assuming T is continuous for the interface
             AutoDScalar ff2 = T - T_semi;
 
             // set Jacobian of governing equation ff2
-            MatSetValue(*jac, fvm_nodes[i]->global_offset()+1, fvm_nodes[i]->global_offset()+1, ff2.getADValue(0), ADD_VALUES);
-            MatSetValue(*jac, fvm_nodes[i]->global_offset()+1, fvm_nodes[0]->global_offset()+3, ff2.getADValue(1), ADD_VALUES);
+            MatSetValue(*jac, fvm_node->global_offset()+1, fvm_node->global_offset()+1, ff2.getADValue(0), ADD_VALUES);
+            MatSetValue(*jac, fvm_node->global_offset()+1, node[0].fvm_node->global_offset()+3, ff2.getADValue(1), ADD_VALUES);
 
             break;
 
@@ -41,13 +41,12 @@ using PhysicalUnit::e;
  */
 void ElectrodeSimulationRegion::DDM2_Fill_Value(Vec x, Vec L)
 {
-  std::vector<int> ix;
-  std::vector<PetscScalar> y;
-  std::vector<PetscScalar> s;
+  PetscInt start;
+  VecGetOwnershipRange(x, &start, PETSC_NULL);
 
-  ix.reserve(2*this->n_node());
-  y.reserve(2*this->n_node());
-  s.reserve(2*this->n_node());
+  PetscScalar *xx, *ll;
+  VecGetArray(x, &xx);
+  VecGetArray(L, &ll);
 
   const_processor_node_iterator node_it = on_processor_nodes_begin();
   const_processor_node_iterator node_it_end = on_processor_nodes_end();
@@ -55,23 +54,19 @@ void ElectrodeSimulationRegion::DDM2_Fill_Value(Vec x, Vec L)
   {
     const FVM_Node * fvm_node = *node_it;
     const FVM_NodeData * node_data = fvm_node->node_data();
+    const PetscInt offset = fvm_node->global_offset() - start;
 
     // psi
-    ix.push_back(fvm_node->global_offset()+0);
-    y.push_back(node_data->psi());
-    s.push_back(1.0/(node_data->eps()*fvm_node->volume()));
+    xx[offset+0] = node_data->psi();
+    ll[offset+0] = 1.0/(node_data->eps()*fvm_node->volume());
 
     // lattice temperature
-    ix.push_back(fvm_node->global_offset()+1);
-    y.push_back(node_data->T());
-    s.push_back(1.0/fvm_node->volume());
+    xx[offset+1] = node_data->T();
+    ll[offset+1] = 1.0/fvm_node->volume();
   }
 
-  if( ix.size() )
-  {
-    VecSetValues(x, ix.size(), &ix[0], &y[0], INSERT_VALUES) ;
-    VecSetValues(L, ix.size(), &ix[0], &s[0], INSERT_VALUES) ;
-  }
+  VecRestoreArray(x, &xx);
+  VecRestoreArray(L, &ll);
 }
 
 
@@ -103,6 +98,7 @@ void ElectrodeSimulationRegion::DDM2_Function(PetscScalar * x, Vec f, InsertMode
   {
     // fvm_node of node1
     const FVM_Node * fvm_n1 = (*it).first;
+    const unsigned int edge_index = it - edges_begin();
     // fvm_node of node2
     const FVM_Node * fvm_n2 = (*it).second;
 
@@ -138,8 +134,8 @@ void ElectrodeSimulationRegion::DDM2_Function(PetscScalar * x, Vec f, InsertMode
 
 
       // "flux" from node 2 to node 1
-      PetscScalar f_psi =  eps*fvm_n1->cv_surface_area(fvm_n2)*(V2 - V1)/fvm_n1->distance(fvm_n2) ;
-      PetscScalar f_q =  kap*fvm_n1->cv_surface_area(fvm_n2)*(T2 - T1)/fvm_n1->distance(fvm_n2) ;
+      PetscScalar f_psi =  eps*this->edge_cv_surface_area(edge_index)*(V2 - V1)/this->edge_length(edge_index) ;
+      PetscScalar f_q =  kap*this->edge_cv_surface_area(edge_index)*(T2 - T1)/this->edge_length(edge_index) ;
 
       // ignore thoese ghost nodes
       if( fvm_n1->on_processor() )
@@ -202,6 +198,7 @@ void ElectrodeSimulationRegion::DDM2_Jacobian(PetscScalar * x, Mat *jac, InsertM
   {
     // fvm_node of node1
     const FVM_Node * fvm_n1 = (*it).first;
+    const unsigned int edge_index = it - edges_begin();
     // fvm_node of node2
     const FVM_Node * fvm_n2 = (*it).second;
 
@@ -237,8 +234,8 @@ void ElectrodeSimulationRegion::DDM2_Jacobian(PetscScalar * x, Mat *jac, InsertM
 
 
       // "flux" from node 2 to node 1
-      AutoDScalar f_psi =  eps*fvm_n1->cv_surface_area(fvm_n2)*(V2 - V1)/fvm_n1->distance(fvm_n2) ;
-      AutoDScalar f_q =  kap*fvm_n1->cv_surface_area(fvm_n2)*(T2 - T1)/fvm_n1->distance(fvm_n2) ;
+      AutoDScalar f_psi =  eps*this->edge_cv_surface_area(edge_index)*(V2 - V1)/this->edge_length(edge_index) ;
+      AutoDScalar f_q =  kap*this->edge_cv_surface_area(edge_index)*(T2 - T1)/this->edge_length(edge_index) ;
 
       // ignore thoese ghost nodes
       if( fvm_n1->on_processor() )
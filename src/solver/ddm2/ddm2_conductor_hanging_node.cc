@@ -54,19 +54,12 @@ void ElectrodeSimulationRegion::DDM2_Function_Hanging_Node(PetscScalar *x, Vec f
       // let the flux of hanging node flow into other "non-hanging" node on the element side averagely
       // this process ensure the global conservation of flux
 
-      const Elem * elem = (*hanging_node_it).second.first;
-      unsigned int side_index = (*hanging_node_it).second.second;
-
-      AutoPtr<Elem>  side = elem->build_side(side_index);
-
-      unsigned int n_side_node = side->n_nodes();
-      std::vector<const FVM_Node *> side_fvm_nodes;
+      unsigned int n_side_node;
+      const FVM_Node * const * side_fvm_nodes = hanging_node_on_elem_side_constraint(hanging_node_it, n_side_node);
 
       for(unsigned int n=0; n < n_side_node; n++)
       {
-        const Node * side_node = side->get_node(n);
-        const FVM_Node * side_fvm_node = region_fvm_node(side_node);
-        side_fvm_nodes.push_back(side_fvm_node);
+        const FVM_Node * side_fvm_node = side_fvm_nodes[n];
 
         src_row.push_back(fvm_node->global_offset()+0);
 	src_row.push_back(fvm_node->global_offset()+1);
@@ -84,13 +77,13 @@ void ElectrodeSimulationRegion::DDM2_Function_Hanging_Node(PetscScalar *x, Vec f
       const FVM_Node * interpolation_p2;
 
       // find the interpolation point
-      if (side_fvm_nodes.size() == 2)
+      if (n_side_node == 2)
       {
         // for 2D case, the side should be an edge
         interpolation_p1 = side_fvm_nodes[0];
         interpolation_p2 = side_fvm_nodes[1];
       }
-      else if (side_fvm_nodes.size() == 4)
+      else if (n_side_node == 4)
       {
         // for 3D case, the side should be QUAD4, we use 2 point which has little psi difference as interpolation point
         PetscScalar dv1 = std::abs( x[side_fvm_nodes[0]->local_offset()] - x[side_fvm_nodes[2]->local_offset()] );
@@ -170,21 +163,12 @@ void ElectrodeSimulationRegion::DDM2_Function_Hanging_Node(PetscScalar *x, Vec f
       // let the flux of hanging node flow into other "non-hanging" node on the element side averagely
       // this process ensure the global conservation of flux
 
-      const Elem * elem = (*hanging_node_it).second.first;
-      unsigned int edge_index = (*hanging_node_it).second.second;
-
-      AutoPtr<Elem>  edge = elem->build_edge(edge_index);
-
-      unsigned int n_edge_node = 2;
-      std::vector<const FVM_Node *> edge_fvm_nodes;
+      unsigned int n_edge_node;
+      const FVM_Node * const * edge_fvm_nodes = hanging_node_on_elem_edge_constraint(hanging_node_it, n_edge_node);
 
       for(unsigned int n=0; n < n_edge_node; n++)
       {
-        const Node * edge_node = edge->get_node(n);
-        const FVM_Node * edge_fvm_node = region_fvm_node(edge_node);
-        genius_assert(edge_fvm_node!=NULL);
-
-        edge_fvm_nodes.push_back(edge_fvm_node);
+        const FVM_Node * edge_fvm_node = edge_fvm_nodes[n];
 
         src_row.push_back(fvm_node->global_offset()+0);
 	src_row.push_back(fvm_node->global_offset()+1);
@@ -264,19 +248,12 @@ void ElectrodeSimulationRegion::DDM2_Jacobian_Hanging_Node(PetscScalar *x, Mat *
       // let the flux of hanging node flow into other "non-hanging" node on the element side averagely
       // this process ensure the global conservation of flux
 
-      const Elem * elem = (*hanging_node_it).second.first;
-      unsigned int side_index = (*hanging_node_it).second.second;
-
-      AutoPtr<Elem>  side = elem->build_side(side_index);
-
-      unsigned int n_side_node = side->n_nodes();
-      std::vector<const FVM_Node *> side_fvm_nodes;
+      unsigned int n_side_node;
+      const FVM_Node * const * side_fvm_nodes = hanging_node_on_elem_side_constraint(hanging_node_it, n_side_node);
 
       for(unsigned int n=0; n < n_side_node; n++)
       {
-        const Node * side_node = side->get_node(n);
-        const FVM_Node * side_fvm_node = region_fvm_node(side_node);
-        side_fvm_nodes.push_back(side_fvm_node);
+        const FVM_Node * side_fvm_node = side_fvm_nodes[n];
 
         src_row.push_back(fvm_node->global_offset()+0);
 	src_row.push_back(fvm_node->global_offset()+1);
@@ -297,13 +274,13 @@ void ElectrodeSimulationRegion::DDM2_Jacobian_Hanging_Node(PetscScalar *x, Mat *
       const FVM_Node * interpolation_p2;
 
       // find the interpolation point
-      if (side_fvm_nodes.size() == 2)
+      if (n_side_node == 2)
       {
         // for 2D case, the side should be an edge
         interpolation_p1 = side_fvm_nodes[0];
         interpolation_p2 = side_fvm_nodes[1];
       }
-      else if (side_fvm_nodes.size() == 4)
+      else if (n_side_node == 4)
       {
         // for 3D case, the side should be QUAD4, we use 2 point which has little psi difference as interpolation point
         PetscScalar dv1 = std::abs( x[side_fvm_nodes[0]->local_offset()] - x[side_fvm_nodes[2]->local_offset()] );
@@ -400,19 +377,12 @@ void ElectrodeSimulationRegion::DDM2_Jacobian_Hanging_Node(PetscScalar *x, Mat *
       // let the flux of hanging node flow into other "non-hanging" node on the element side averagely
       // this process ensure the global conservation of flux
 
-      const Elem * elem = (*hanging_node_it).second.first;
-      unsigned int edge_index = (*hanging_node_it).second.second;
-
-      AutoPtr<Elem>  edge = elem->build_edge(edge_index);
-
-      unsigned int n_edge_node = 2;
-      std::vector<const FVM_Node *> edge_fvm_nodes;
+      unsigned int n_edge_node;
+      const FVM_Node * const * edge_fvm_nodes = hanging_node_on_elem_edge_constraint(hanging_node_it, n_edge_node);
 
       for(unsigned int n=0; n < n_edge_node; n++)
       {
-        const Node * edge_node = edge->get_node(n);
-        const FVM_Node * edge_fvm_node = region_fvm_node(edge_node);
-        edge_fvm_nodes.push_back(edge_fvm_node);
+        const FVM_Node * edge_fvm_node = edge_fvm_nodes[n];
 
         src_row.push_back(fvm_node->global_offset()+0);
 	src_row.push_back(fvm_node->global_offset()+1);
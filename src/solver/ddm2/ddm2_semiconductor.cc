@@ -22,9 +22,11 @@
 #include "elem.h"
 #include "simulation_system.h"
 #include "semiconductor_region.h"
+#include "fvm_node_data_semiconductor.h"
 #include "solver_specify.h"
 
 #include "log.h"
+#include "fermi_table.h"
 #include "jflux2.h"
 
 
@@ -43,13 +45,12 @@ using PhysicalUnit::cm;
 
 void SemiconductorSimulationRegion::DDM2_Fill_Value(Vec x, Vec L)
 {
-  std::vector<int> ix;
-  std::vector<PetscScalar> y;
-  std::vector<PetscScalar> s;
+  PetscInt start;
+  VecGetOwnershipRange(x, &start, PETSC_NULL);
 
-  ix.reserve(4*this->n_node());
-  y.reserve(4*this->n_node());
-  s.reserve(4*this->n_node());
+  PetscScalar *xx, *ll;
+  VecGetArray(x, &xx);
+  VecGetArray(L, &ll);
 
   const_processor_node_iterator node_it = on_processor_nodes_begin();
   const_processor_node_iterator node_it_end = on_processor_nodes_end();
@@ -57,35 +58,29 @@ void SemiconductorSimulationRegion::DDM2_Fill_Value(Vec x, Vec L)
   {
     const FVM_Node * fvm_node = *node_it;
     const FVM_NodeData * node_data = fvm_node->node_data();
+    const PetscInt offset = fvm_node->global_offset() - start;
 
     mt->mapping(fvm_node->root_node(), node_data, 0.0);
 
     // the first variable, psi
-    ix.push_back(fvm_node->global_offset()+0);
-    y.push_back(node_data->psi());
-    s.push_back(1.0/(node_data->eps()*fvm_node->volume()));
+    xx[offset+0] = node_data->psi();
+    ll[offset+0] = 1.0/(node_data->eps()*fvm_node->volume());
 
     // the second variable, n
-    ix.push_back(fvm_node->global_offset()+1);
-    y.push_back(node_data->n());
-    s.push_back(1.0/fvm_node->volume());
+    xx[offset+1] = node_data->n();
+    ll[offset+1] = 1.0/fvm_node->volume();
 
     // the third variable, p
-    ix.push_back(fvm_node->global_offset()+2);
-    y.push_back(node_data->p());
-    s.push_back(1.0/fvm_node->volume());
+    xx[offset+2] = node_data->p();
+    ll[offset+2] = 1.0/fvm_node->volume();
 
     // the forth variable, lattice temperature
-    ix.push_back(fvm_node->global_offset()+3);
-    y.push_back(node_data->T());
-    s.push_back(1.0/fvm_node->volume());
+    xx[offset+3] = node_data->T();
+    ll[offset+3] = 1.0/fvm_node->volume();
   }
 
-  if( ix.size() )
-  {
-    VecSetValues(x, ix.size(), &ix[0], &y[0], INSERT_VALUES) ;
-    VecSetValues(L, ix.size(), &ix[0], &s[0], INSERT_VALUES) ;
-  }
+  VecRestoreArray(x, &xx);
+  VecRestoreArray(L, &ll);
 }
 
 
@@ -118,6 +113,15 @@ void SemiconductorSimulationRegion::DDM2_Function(PetscScalar * x, Vec f, Insert
   // first, search all the element in this region and process "cell" related terms
   // note, they are all local element, thus must be processed
 
+  std::vector<PetscScalar> psi_vertex;
+  std::vector<PetscScalar> phin_vertex;
+  std::vector<PetscScalar> phip_vertex;
+  std::vector<PetscScalar> Jn_edge;
+  std::vector<PetscScalar> Jp_edge;
+  std::vector<unsigned int> sides;
+  std::vector<SimulationRegion *> regions;
+  std::vector<PetscScalar> psi_vertex_neighbor;
+
   const_element_iterator it = elements_begin();
   const_element_iterator it_end = elements_end();
   for(unsigned int nelem=0 ; it!=it_end; ++it, ++nelem)
@@ -137,8 +141,8 @@ void SemiconductorSimulationRegion::DDM2_Function(PetscScalar * x, Vec f, Insert
     VectorValue<PetscScalar> Jnv;
     VectorValue<PetscScalar> Jpv;
 
-    std::vector<PetscScalar> Jn_edge; //store all the edge Jn
-    std::vector<PetscScalar> Jp_edge; //store all the edge Jp
+    Jn_edge.clear(); //store all the edge Jn
+    Jp_edge.clear(); //store all the edge Jp
 
     // E field parallel to current flow
     PetscScalar Epn=0;
@@ -153,9 +157,9 @@ void SemiconductorSimulationRegion::DDM2_Function(PetscScalar * x, Vec f, Insert
     {
       // build the gradient of psi and fermi potential in this cell.
       // which are the vector of electric field and current density.
-      std::vector<PetscScalar> psi_vertex(elem->n_nodes());
-      std::vector<PetscScalar> phin_vertex(elem->n_nodes());
-      std::vector<PetscScalar> phip_vertex(elem->n_nodes());
+      psi_vertex.resize(elem->n_nodes());
+      phin_vertex.resize(elem->n_nodes());
+      phip_vertex.resize(elem->n_nodes());
 
       for(unsigned int nd=0; nd<elem->n_nodes(); ++nd)
       {
@@ -201,8 +205,8 @@ void SemiconductorSimulationRegion::DDM2_Function(PetscScalar * x, Vec f, Insert
       if(get_advanced_model()->ESurface && insulator_interface_elem)
       {
         // get all the sides on insulator interface
-        std::vector<unsigned int> sides;
-        std::vector<SimulationRegion *> regions;
+        sides.clear();
+        regions.clear();
         elem_on_insulator_interface(elem, sides, regions);
 
         VectorValue<PetscScalar> E_insul(0,0,0);
@@ -212,7 +216,7 @@ void SemiconductorSimulationRegion::DDM2_Function(PetscScalar * x, Vec f, Insert
         for(unsigned int ne=0; ne<sides.size(); ++ne)
         {
           const Elem * elem_neighbor = elem->neighbor(sides[ne]);
-          std::vector<PetscScalar> psi_vertex_neighbor;
+          psi_vertex_neighbor.clear();
           for(unsigned int nd=0; nd<elem_neighbor->n_nodes(); ++nd)
           {
             const FVM_Node * fvm_node_neighbor = elem_neighbor->get_fvm_node(nd);
@@ -310,7 +314,7 @@ void SemiconductorSimulationRegion::DDM2_Function(PetscScalar * x, Vec f, Insert
       {
         // use truncated partial area to avoid negative area due to bad mesh elem
         truncated_partial_area =  this->truncated_partial_area(elem, ne);
-        truncated_partial_volume =  elem->partial_volume_with_edge_truncated(ne);
+        truncated_partial_volume =  this->truncated_partial_volume(elem, ne);
       }
 
       const unsigned int n1_local_offset = fvm_n1->local_offset();
@@ -337,8 +341,8 @@ void SemiconductorSimulationRegion::DDM2_Function(PetscScalar * x, Vec f, Insert
         PetscScalar Ev1 =  -(e*V1 + n1_data->affinity() - kb*T1*log(mt->band->nie(p1, n1, T1)));
         if(get_advanced_model()->Fermi)
         {
-          Ec1 = Ec1 - kb*T1*log(gamma_f(fabs(n1)/n1_data->Nc()));
-          Ev1 = Ev1 + kb*T1*log(gamma_f(fabs(p1)/n1_data->Nv()));
+          Ec1 = Ec1 - kb*T1*log_gamma_f(fabs(n1)/n1_data->Nc(), get_advanced_model()->FermiTable);
+          Ev1 = Ev1 + kb*T1*log_gamma_f(fabs(p1)/n1_data->Nv(), get_advanced_model()->FermiTable);
         }
 
         PetscScalar eps1 =  n1_data->eps();                        // eps
@@ -359,8 +363,8 @@ void SemiconductorSimulationRegion::DDM2_Function(PetscScalar * x, Vec f, Insert
         PetscScalar Ev2 =  -(e*V2 + n2_data->affinity() - kb*T2*log(mt->band->nie(p2, n2, T2)));
         if(get_advanced_model()->Fermi)
         {
-          Ec2 = Ec2 - kb*T2*log(gamma_f(fabs(n2)/n2_data->Nc()));
-          Ev2 = Ev2 + kb*T2*log(gamma_f(fabs(p2)/n2_data->Nv()));
+          Ec2 = Ec2 - kb*T2*log_gamma_f(fabs(n2)/n2_data->Nc(), get_advanced_model()->FermiTable);
+          Ev2 = Ev2 + kb*T2*log_gamma_f(fabs(p2)/n2_data->Nv(), get_advanced_model()->FermiTable);
         }
 
         PetscScalar eps2 =  n2_data->eps();                         // eps
@@ -621,7 +625,9 @@ void SemiconductorSimulationRegion::DDM2_Function(PetscScalar * x, Vec f, Insert
 
       // call the Trap MPI to calculate trap occupancy using the local carrier densities and lattice temperature
       PetscScalar ni = mt->band->nie(p, n, T);
-      mt->trap->Calculate(true,p,n,ni,T);
+      // trap occupancy is frozen between steps when advanced explicitly
+      if (!get_advanced_model()->TrapExplicit)
+        mt->trap->Calculate(true,p,n,ni,T);
 
       // calculate the contribution of trapped charge to Poisson's equation
       PetscScalar TrappedC = mt->trap->Charge(true) * fvm_node->volume();
@@ -660,6 +666,13 @@ void SemiconductorSimulationRegion::DDM2_Function(PetscScalar * x, Vec f, Insert
   // add into petsc vector, we should prevent zero length vector add here.
   if(iy.size())  VecSetValues(f, iy.size(), &iy[0], &y[0], ADD_VALUES);
 
+  // nonlocal band band tunneling along the cached tunneling paths
+  if( bbt_nonlocal() )
+  {
+    update_bbt_nonlocal_path(x);
+    BBT_Nonlocal_Function(x, f, 3);
+  }
+
   // after the first scan, every nodes are updated.
   // however, boundary condition should be processed later.
 
@@ -695,6 +708,13 @@ void SemiconductorSimulationRegion::DDM2_Jacobian(PetscScalar * x, Mat *jac, Ins
   // search all the element in this region.
   // note, they are all local element, thus must be processed
 
+  std::vector<AutoDScalar> psi_vertex;
+  std::vector<AutoDScalar> phin_vertex;
+  std::vector<AutoDScalar> phip_vertex;
+  std::vector<unsigned int> sides;
+  std::vector<SimulationRegion *> regions;
+  std::vector<AutoDScalar> psi_vertex_neighbor;
+
   const_element_iterator it = elements_begin();
   const_element_iterator it_end = elements_end();
   for(; it!=it_end; ++it)
@@ -742,9 +762,9 @@ void SemiconductorSimulationRegion::DDM2_Jacobian(PetscScalar * x, Mat *jac, Ins
       // which are the vector of electric field and current density.
       // here use type AutoDScalar, we should make sure the order of independent variable keeps the
       // same all the time
-      std::vector<AutoDScalar> psi_vertex;
-      std::vector<AutoDScalar> phin_vertex;
-      std::vector<AutoDScalar> phip_vertex;
+      psi_vertex.clear();
+      phin_vertex.clear();
+      phip_vertex.clear();
 
       for(unsigned int nd=0; nd<elem->n_nodes(); ++nd)
       {
@@ -796,8 +816,8 @@ void SemiconductorSimulationRegion::DDM2_Jacobian(PetscScalar * x, Mat *jac, Ins
       if(get_advanced_model()->ESurface && insulator_interface_elem)
       {
         // get all the sides on insulator interface
-        std::vector<unsigned int> sides;
-        std::vector<SimulationRegion *> regions;
+        sides.clear();
+        regions.clear();
         elem_on_insulator_interface(elem, sides, regions);
 
         VectorValue<AutoDScalar> E_insul(0.0,0.0,0.0);
@@ -810,7 +830,7 @@ void SemiconductorSimulationRegion::DDM2_Jacobian(PetscScalar * x, Mat *jac, Ins
         {
           const Elem * elem_neighbor = elem->neighbor(sides[ne]);
 
-          std::vector<AutoDScalar> psi_vertex_neighbor;
+          psi_vertex_neighbor.clear();
           for(unsigned int nd=0; nd<elem_neighbor->n_nodes(); ++nd)
           {
             const FVM_Node * fvm_node_neighbor = elem_neighbor->get_fvm_node(nd);
@@ -924,7 +944,7 @@ void SemiconductorSimulationRegion::DDM2_Jacobian(PetscScalar * x, Mat *jac, Ins
       {
         // use truncated partial area to avoid negative area due to bad mesh elem
         truncated_partial_area =  this->truncated_partial_area(elem, ne);
-        truncated_partial_volume =  elem->partial_volume_with_edge_truncated(ne);
+        truncated_partial_volume =  this->truncated_partial_volume(elem, ne);
       }
 
       const unsigned int n1_local_offset = fvm_n1->local_offset();
@@ -951,8 +971,8 @@ void SemiconductorSimulationRegion::DDM2_Jacobian(PetscScalar * x, Mat *jac, Ins
         AutoDScalar Ev1 =  -(e*V1 + n1_data->affinity() - kb*T1*log(mt->band->nie(p1, n1, T1)));//valence band energy level
         if(get_advanced_model()->Fermi)
         {
-          Ec1 = Ec1 - kb*T1*log(gamma_f(fabs(n1)/n1_data->Nc()));
-          Ev1 = Ev1 + kb*T1*log(gamma_f(fabs(p1)/n1_data->Nv()));
+          Ec1 = Ec1 - kb*T1*log_gamma_f(fabs(n1)/n1_data->Nc(), get_advanced_model()->FermiTable);
+          Ev1 = Ev1 + kb*T1*log_gamma_f(fabs(p1)/n1_data->Nv(), get_advanced_model()->FermiTable);
         }
         PetscScalar eps1 =  n1_data->eps();                        // eps
         AutoDScalar Eg1  =  mt->band->Eg(T1);
@@ -971,8 +991,8 @@ void SemiconductorSimulationRegion::DDM2_Jacobian(PetscScalar * x, Mat *jac, Ins
         AutoDScalar Ev2 =  -(e*V2 + n2_data->affinity() - kb*T2*log(mt->band->nie(p2, n2, T2)));//valence band energy level
         if(get_advanced_model()->Fermi)
         {
-          Ec2 = Ec2 - kb*T2*log(gamma_f(fabs(n2)/n2_data->Nc()));
-          Ev2 = Ev2 + kb*T2*log(gamma_f(fabs(p2)/n2_data->Nv()));
+          Ec2 = Ec2 - kb*T2*log_gamma_f(fabs(n2)/n2_data->Nc(), get_advanced_model()->FermiTable);
+          Ev2 = Ev2 + kb*T2*log_gamma_f(fabs(p2)/n2_data->Nv(), get_advanced_model()->FermiTable);
         }
         PetscScalar eps2 =  n2_data->eps();                         // eps
         AutoDScalar Eg2  = mt->band->Eg(T2);
@@ -1212,7 +1232,9 @@ void SemiconductorSimulationRegion::DDM2_Jacobian(PetscScalar * x, Mat *jac, Ins
     if (get_advanced_model()->Trap)
     {
       AutoDScalar ni = mt->band->nie(p, n, T);
-      mt->trap->Calculate(true,p,n,ni,T);
+      // trap occupancy is frozen between steps when advanced explicitly
+      if (!get_advanced_model()->TrapExplicit)
+        mt->trap->Calculate(true,p,n,ni,T);
 
       AutoDScalar TrappedC = mt->trap->ChargeAD(true) * fvm_node->volume();
       MatSetValues(*jac, 1, &index[0], 4, &index[0], TrappedC.getADValue(), ADD_VALUES);
@@ -1232,6 +1254,13 @@ void SemiconductorSimulationRegion::DDM2_Jacobian(PetscScalar * x, Mat *jac, Ins
 
   }
 
+  // nonlocal band band tunneling along the cached tunneling paths
+  if( bbt_nonlocal() )
+  {
+    update_bbt_nonlocal_path(x);
+    BBT_Nonlocal_Jacobian(x, jac, 3);
+  }
+
 
   // boundary condition should be processed later!
 
@@ -1421,6 +1450,7 @@ void SemiconductorSimulationRegion::DDM2_Pseudo_Time_Step_Function(PetscScalar *
   for(; node_it!=node_it_end; ++node_it)
   {
     const FVM_Node * fvm_node = *node_it;
+    const Real dt_scale = pseudo_time_step_scale(node_it - on_processor_nodes_begin());
     //if( fvm_node->boundary_id() == BoundaryInfo::invalid_id ) continue;
 
     const FVM_NodeData * node_data = fvm_node->node_data();
@@ -1429,13 +1459,14 @@ void SemiconductorSimulationRegion::DDM2_Pseudo_Time_Step_Function(PetscScalar *
     const unsigned int global_offset = fvm_node->global_offset();
 
     PetscScalar V   =  x[local_offset];                         // phi
-    PetscScalar f_V = -node_data->eps()*(V-node_data->psi())/SolverSpecify::PseudoTimeStepPotential*fvm_node->volume();
+    PetscScalar f_V = -node_data->eps()*(V-node_data->psi())/(SolverSpecify::PseudoTimeStepPotential*dt_scale)*fvm_node->volume();
     VecSetValue(f, global_offset, f_V, ADD_VALUES);
   }
 
   for(node_it = on_processor_nodes_begin(); node_it!=node_it_end; ++node_it)
   {
     const FVM_Node * fvm_node = *node_it;
+    const Real dt_scale = pseudo_time_step_scale(node_it - on_processor_nodes_begin());
     //if( fvm_node->boundary_id() != BoundaryInfo::invalid_id ) continue;
 
     const FVM_NodeData * node_data = fvm_node->node_data();
@@ -1446,10 +1477,10 @@ void SemiconductorSimulationRegion::DDM2_Pseudo_Time_Step_Function(PetscScalar *
     PetscScalar n   =  x[local_offset+1];                         // electron density
     PetscScalar p   =  x[local_offset+2];                         // hole density
 
-    PetscScalar f_n   =  -(n-node_data->n())/SolverSpecify::PseudoTimeStepCarrier*fvm_node->volume();
+    PetscScalar f_n   =  -(n-node_data->n())/(SolverSpecify::PseudoTimeStepCarrier*dt_scale)*fvm_node->volume();
     VecSetValue(f, global_offset+1, f_n, ADD_VALUES);
 
-    PetscScalar f_p   =  -(p-node_data->p())/SolverSpecify::PseudoTimeStepCarrier*fvm_node->volume();
+    PetscScalar f_p   =  -(p-node_data->p())/(SolverSpecify::PseudoTimeStepCarrier*dt_scale)*fvm_node->volume();
     VecSetValue(f, global_offset+2, f_p, ADD_VALUES);
   }
 
@@ -1480,6 +1511,7 @@ void SemiconductorSimulationRegion::DDM2_Pseudo_Time_Step_Jacobian(PetscScalar *
   for(; node_it!=node_it_end; ++node_it)
   {
     const FVM_Node * fvm_node = *node_it;
+    const Real dt_scale = pseudo_time_step_scale(node_it - on_processor_nodes_begin());
     //if( fvm_node->boundary_id() == BoundaryInfo::invalid_id ) continue;
 
     const FVM_NodeData * node_data = fvm_node->node_data();
@@ -1488,7 +1520,7 @@ void SemiconductorSimulationRegion::DDM2_Pseudo_Time_Step_Jacobian(PetscScalar *
     const unsigned int global_offset = fvm_node->global_offset();
 
     AutoDScalar V(x[local_offset]);   V.setADValue(0, 1.0);              // psi
-    AutoDScalar f_V = -node_data->eps()*(V-node_data->psi())/SolverSpecify::PseudoTimeStepPotential*fvm_node->volume();
+    AutoDScalar f_V = -node_data->eps()*(V-node_data->psi())/(SolverSpecify::PseudoTimeStepPotential*dt_scale)*fvm_node->volume();
     MatSetValue(*jac, global_offset, global_offset, f_V.getADValue(0), ADD_VALUES);
   }
 
@@ -1496,6 +1528,7 @@ void SemiconductorSimulationRegion::DDM2_Pseudo_Time_Step_Jacobian(PetscScalar *
   for(node_it = on_processor_nodes_begin(); node_it!=node_it_end; ++node_it)
   {
     const FVM_Node * fvm_node = *node_it;
+    const Real dt_scale = pseudo_time_step_scale(node_it - on_processor_nodes_begin());
     //if( fvm_node->boundary_id() != BoundaryInfo::invalid_id ) continue;
 
     const FVM_NodeData * node_data = fvm_node->node_data();
@@ -1506,10 +1539,10 @@ void SemiconductorSimulationRegion::DDM2_Pseudo_Time_Step_Jacobian(PetscScalar *
     AutoDScalar n(x[local_offset+1]);   n.setADValue(0, 1.0);              // electron density
     AutoDScalar p(x[local_offset+2]);   p.setADValue(0, 1.0);              // hole density
 
-    AutoDScalar f_n = -(n-node_data->n())/SolverSpecify::PseudoTimeStepCarrier*fvm_node->volume();
+    AutoDScalar f_n = -(n-node_data->n())/(SolverSpecify::PseudoTimeStepCarrier*dt_scale)*fvm_node->volume();
     MatSetValue(*jac, global_offset+1, global_offset+1, f_n.getADValue(0), ADD_VALUES);
 
-    AutoDScalar f_p = -(p-node_data->p())/SolverSpecify::PseudoTimeStepCarrier*fvm_node->volume();
+    AutoDScalar f_p = -(p-node_data->p())/(SolverSpecify::PseudoTimeStepCarrier*dt_scale)*fvm_node->volume();
     MatSetValue(*jac, global_offset+2, global_offset+2, f_p.getADValue(0), ADD_VALUES);
   }
 
@@ -1531,6 +1564,7 @@ int SemiconductorSimulationRegion::DDM2_Pseudo_Time_Step_Convergence_Test(PetscS
   for(; node_it!=node_it_end; ++node_it)
   {
     const FVM_Node * fvm_node = *node_it;
+    const Real dt_scale = pseudo_time_step_scale(node_it - on_processor_nodes_begin());
     //if( fvm_node->boundary_id() == BoundaryInfo::invalid_id ) continue;
 
     const FVM_NodeData * node_data = fvm_node->node_data();
@@ -1540,7 +1574,7 @@ int SemiconductorSimulationRegion::DDM2_Pseudo_Time_Step_Convergence_Test(PetscS
 
     PetscScalar V   =  x[local_offset];                         // phi
 
-    PetscScalar fV_abs = std::abs(-node_data->eps()*(V-node_data->psi())/SolverSpecify::PseudoTimeStepPotential);
+    PetscScalar fV_abs = std::abs(-node_data->eps()*(V-node_data->psi())/(SolverSpecify::PseudoTimeStepPotential*dt_scale));
     PetscScalar V_rel  = std::abs(node_data->eps()*(V-node_data->psi()))/(std::abs(V) + 1e-30);
 
     if( fV_abs > SolverSpecify::PseudoTimeTolRelax*SolverSpecify::poisson_abs_toler && V_rel > SolverSpecify::relative_toler )
@@ -1551,6 +1585,7 @@ int SemiconductorSimulationRegion::DDM2_Pseudo_Time_Step_Convergence_Test(PetscS
   for(node_it = on_processor_nodes_begin(); node_it!=node_it_end; ++node_it)
   {
     const FVM_Node * fvm_node = *node_it;
+    const Real dt_scale = pseudo_time_step_scale(node_it - on_processor_nodes_begin());
     //if( fvm_node->boundary_id() != BoundaryInfo::invalid_id ) continue;
 
     const FVM_NodeData * node_data = fvm_node->node_data();
@@ -1560,10 +1595,10 @@ int SemiconductorSimulationRegion::DDM2_Pseudo_Time_Step_Convergence_Test(PetscS
     PetscScalar n   =  x[local_offset+1];                         // electron density
     PetscScalar p   =  x[local_offset+2];                         // hole density
 
-    PetscScalar fn_abs   = std::abs(-(n-node_data->n())/SolverSpecify::PseudoTimeStepCarrier);
+    PetscScalar fn_abs   = std::abs(-(n-node_data->n())/(SolverSpecify::PseudoTimeStepCarrier*dt_scale));
     PetscScalar n_rel    = std::abs((n-node_data->n())/node_data->n());
 
-    PetscScalar fp_abs   = std::abs(-(p-node_data->p())/SolverSpecify::PseudoTimeStepCarrier);
+    PetscScalar fp_abs   = std::abs(-(p-node_data->p())/(SolverSpecify::PseudoTimeStepCarrier*dt_scale));
     PetscScalar p_rel    = std::abs((p-node_data->p())/node_data->p());
 
     if( fn_abs > SolverSpecify::PseudoTimeTolRelax*SolverSpecify::elec_continuity_abs_toler && n_rel  > SolverSpecify::relative_toler )
@@ -1579,6 +1614,11 @@ int SemiconductorSimulationRegion::DDM2_Pseudo_Time_Step_Convergence_Test(PetscS
 
 void SemiconductorSimulationRegion::DDM2_Update_Solution(PetscScalar *lxx)
 {
+  // save the last solution column by column, all the on local nodes hold a node data
+  _node_data_storage.copy_scalar(FVM_Semiconductor_NodeData::_psi_, FVM_Semiconductor_NodeData::_psi_last_);
+  _node_data_storage.copy_scalar(FVM_Semiconductor_NodeData::_n_,   FVM_Semiconductor_NodeData::_n_last_);
+  _node_data_storage.copy_scalar(FVM_Semiconductor_NodeData::_p_,   FVM_Semiconductor_NodeData::_p_last_);
+  _node_data_storage.copy_scalar(FVM_Semiconductor_NodeData::_T_,   FVM_Semiconductor_NodeData::_T_last_);
 
   local_node_iterator node_it = on_local_nodes_begin();
   local_node_iterator node_it_end = on_local_nodes_end();
@@ -1595,19 +1635,15 @@ void SemiconductorSimulationRegion::DDM2_Update_Solution(PetscScalar *lxx)
 
 
     //update psi
-    node_data->psi_last() =  node_data->psi();
     node_data->psi()      =  V;
 
     // electron density
-    node_data->n_last()   = node_data->n();
     node_data->n()        = n;
 
     // hole density
-    node_data->p_last()   = node_data->p();
     node_data->p()        =  p;
 
     // lattice temperature
-    node_data->T_last()   = node_data->T();
     node_data->T()        =  T;
 
     // update buffered parameters dependent on temperature
@@ -1639,32 +1675,20 @@ void SemiconductorSimulationRegion::DDM2_Update_Solution(PetscScalar *lxx)
     {
       // update traps
       mt->mapping(fvm_node->root_node(), node_data, SolverSpecify::clock);
-      mt->trap->Update(true, p, n, node_data->ni(), T_external());
-      mt->trap->Update(false, p, n, node_data->ni(), T_external());
+      if (get_advanced_model()->TrapExplicit)
+      {
+        mt->trap->Advance(true, p, n, node_data->ni(), T_external());
+        mt->trap->Advance(false, p, n, node_data->ni(), T_external());
+      }
+      else
+      {
+        mt->trap->Update(true, p, n, node_data->ni(), T_external());
+        mt->trap->Update(false, p, n, node_data->ni(), T_external());
+      }
     }
 
   }
 
-  // addtional work: compute electrical field for all the cell.
-  // Since this value is only used for reference.
-  // It can be done simply by weighted average of cell's electrical field
-  for(unsigned int n=0; n<n_cell(); ++n)
-  {
-    const Elem * elem = this->get_region_elem(n);
-    FVM_CellData * elem_data = this->get_region_elem_data(n);
-
-    std::vector<PetscScalar> psi_vertex;
-
-    for(unsigned int nd=0; nd<elem->n_nodes(); ++nd)
-    {
-      const FVM_Node * fvm_node = elem->get_fvm_node(nd);
-      const FVM_NodeData * fvm_node_data = fvm_node->node_data();
-      psi_vertex.push_back  ( fvm_node_data->psi() );
-    }
-    // compute the gradient in the cell
-    elem_data->E()  = - elem->gradient(psi_vertex);  // E = - grad(psi)
-  }
-
 
 }
 
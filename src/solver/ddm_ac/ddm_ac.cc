@@ -20,10 +20,17 @@
 /********************************************************************************/
 
 #include <iomanip>
+#include <fstream>
+#include <algorithm>
+#include <complex>
+#include <cmath>
+#include <set>
 
 #include "ddm_ac/ddm_ac.h"
 #include "parallel.h"
 #include "mathfunc.h"  // for PI
+#include "dense_matrix.h"
+#include "dense_vector.h"
 
 
 using PhysicalUnit::kb;
@@ -83,35 +90,10 @@ int DDMACSolver::create_solver()
   ierr = VecDuplicate ( lx, &ls );  genius_assert ( !ierr );
 
   // extra matrix for store Jacobian
-  ierr = MatCreate ( PETSC_COMM_WORLD, &J_ );  genius_assert ( !ierr );
-  ierr = MatSetSizes ( J_, n_local_dofs, n_local_dofs, n_global_dofs, n_global_dofs );genius_assert ( !ierr );
-  if ( Genius::n_processors() >1 )
-  {
-    ierr = MatSetType ( J_, MATMPIAIJ );  genius_assert ( !ierr );
-    ierr = MatMPIAIJSetPreallocation ( J_, 0, &n_nz[0], 0, &n_oz[0] );  genius_assert ( !ierr );
-  }
-  else
-  {
-    ierr = MatSetType ( J_, MATSEQAIJ );    genius_assert ( !ierr );
-    // alloc memory for sequence matrix here
-    ierr = MatSeqAIJSetPreallocation ( J_, 0, &n_nz[0] );    genius_assert ( !ierr );
-  }
-
+  create_ac_matrix ( J_ );
 
   // extra matrix for store A
-  ierr = MatCreate ( PETSC_COMM_WORLD, &A_ );  genius_assert ( !ierr );
-  ierr = MatSetSizes ( A_, n_local_dofs, n_local_dofs, n_global_dofs, n_global_dofs );genius_assert ( !ierr );
-  if ( Genius::n_processors() >1 )
-  {
-    ierr = MatSetType ( A_, MATMPIAIJ );  genius_assert ( !ierr );
-    ierr = MatMPIAIJSetPreallocation ( A_, 0, &n_nz[0], 0, &n_oz[0] );  genius_assert ( !ierr );
-  }
-  else
-  {
-    ierr = MatSetType ( A_, MATSEQAIJ );    genius_assert ( !ierr );
-    // alloc memory for sequence matrix here
-    ierr = MatSeqAIJSetPreallocation ( A_, 0, &n_nz[0] );    genius_assert ( !ierr );
-  }
+  create_ac_matrix ( A_ );
 
 
   // extra matrix for transformation matrix, each row has only 2 entry
@@ -142,6 +124,30 @@ int DDMACSolver::create_solver()
 
 
 
+/*------------------------------------------------------------------
+ * create an AIJ matrix with the preallocation of the AC system
+ */
+void DDMACSolver::create_ac_matrix ( Mat &M ) const
+{
+  int ierr=0;
+
+  ierr = MatCreate ( PETSC_COMM_WORLD, &M );  genius_assert ( !ierr );
+  ierr = MatSetSizes ( M, n_local_dofs, n_local_dofs, n_global_dofs, n_global_dofs );genius_assert ( !ierr );
+  if ( Genius::n_processors() >1 )
+  {
+    ierr = MatSetType ( M, MATMPIAIJ );  genius_assert ( !ierr );
+    ierr = MatMPIAIJSetPreallocation ( M, 0, &n_nz[0], 0, &n_oz[0] );  genius_assert ( !ierr );
+  }
+  else
+  {
+    ierr = MatSetType ( M, MATSEQAIJ );    genius_assert ( !ierr );
+    // alloc memory for sequence matrix here
+    ierr = MatSeqAIJSetPreallocation ( M, 0, &n_nz[0] );    genius_assert ( !ierr );
+  }
+}
+
+
+
 /*------------------------------------------------------------------
  * prepare solution and aux variables used by this solver
  */
@@ -274,8 +280,52 @@ int DDMACSolver::solve()
 
   this->pre_solve_process();
 
-  for ( SolverSpecify::Freq = SolverSpecify::FStart; SolverSpecify::Freq <= SolverSpecify::FStop;  )
+  std::vector<double> freqs = ac_frequencies();
+
+  if ( SolverSpecify::ACNPort )
+    solve_frequency_nport ( freqs );
+  else if ( SolverSpecify::ACMOR && freqs.size() > 1 )
+    solve_frequency_mor ( freqs );
+  else if ( SolverSpecify::ACFreqGroups > 1 && Genius::n_processors() > 1 && freqs.size() > 1 )
+    solve_frequency_groups ( freqs );
+  else
+    solve_frequency_serial ( freqs );
+
+  STOP_LOG ( "solve()", "DDMACSolver" );
+
+  return 0;
+}
+
+
+
+/*------------------------------------------------------------------
+ * the frequency points from FStart to FStop
+ */
+std::vector<double> DDMACSolver::ac_frequencies() const
+{
+  std::vector<double> freqs;
+  for ( double f = SolverSpecify::FStart; f <= SolverSpecify::FStop;  )
   {
+    freqs.push_back ( f );
+
+    if( f < SolverSpecify::FStop && f*SolverSpecify::FMultiple > SolverSpecify::FStop)
+      f = SolverSpecify::FStop;
+    else
+      f*=SolverSpecify::FMultiple;
+  }
+  return freqs;
+}
+
+
+
+/*------------------------------------------------------------------
+ * AC sweep, all the processors solve each frequency in turn
+ */
+void DDMACSolver::solve_frequency_serial ( const std::vector<double> &freqs )
+{
+  for ( unsigned int i=0; i<freqs.size(); ++i )
+  {
+    SolverSpecify::Freq = freqs[i];
 
     double omega = 2*PI*SolverSpecify::Freq;
 
@@ -302,17 +352,608 @@ int DDMACSolver::solve()
     RECORD();
 
     this->post_solve_process();
+  }
+}
 
-    if( SolverSpecify::Freq  < SolverSpecify::FStop && SolverSpecify::Freq*SolverSpecify::FMultiple > SolverSpecify::FStop)
-      SolverSpecify::Freq  = SolverSpecify::FStop;
-    else
-      SolverSpecify::Freq*=SolverSpecify::FMultiple;
+
+
+/*------------------------------------------------------------------
+ * AC sweep, frequency points are distributed to processor groups.
+ * the AC matrix of each frequency is still assembled on all the processors,
+ * then a redundant copy is sent to the group which solves it.
+ * the groups are interlaced, processor i belongs to group i%n_groups
+ */
+void DDMACSolver::solve_frequency_groups ( const std::vector<double> &freqs )
+{
+  int ierr = 0;
+
+  const unsigned int n_groups = std::min ( SolverSpecify::ACFreqGroups, Genius::n_processors() );
+  const unsigned int group = Genius::processor_id() % n_groups;
+
+  MESSAGE<<"AC Scan: distribute "<<freqs.size()<<" frequency points to "<<n_groups<<" processor groups"<<"\n\n";
+  RECORD();
+
+  MPI_Comm subcomm;
+  MPI_Comm_split ( PETSC_COMM_WORLD, group, Genius::processor_id(), &subcomm );
+
+  int sub_rank, sub_size;
+  MPI_Comm_rank ( subcomm, &sub_rank );
+  MPI_Comm_size ( subcomm, &sub_size );
+
+  // local rows of the redundant matrix
+  PetscInt mlocal_red = n_global_dofs/sub_size + ( static_cast<int> ( n_global_dofs%sub_size ) > sub_rank ? 1 : 0 );
+
+  // linear solver of each group, follows the type of the global one
+  KSP sub_ksp;
+  PC  sub_pc;
+  ierr = KSPCreate ( subcomm, &sub_ksp );  genius_assert ( !ierr );
+  ierr = KSPGetPC ( sub_ksp, &sub_pc );  genius_assert ( !ierr );
+  {
+    const char * ksp_type = PETSC_NULL;
+    const char * pc_type  = PETSC_NULL;
+    ierr = KSPGetType ( ksp, &ksp_type );  genius_assert ( !ierr );
+    ierr = PCGetType ( pc, &pc_type );  genius_assert ( !ierr );
+    ierr = KSPSetType ( sub_ksp, ksp_type );  genius_assert ( !ierr );
+    ierr = PCSetType ( sub_pc, pc_type );  genius_assert ( !ierr );
+    if ( std::string ( pc_type ) == PCLU || std::string ( pc_type ) == PCCHOLESKY )
+    {
+      const char * package = PETSC_NULL;
+      ierr = PCFactorGetMatSolverPackage ( pc, &package );  genius_assert ( !ierr );
+      ierr = PCFactorSetMatSolverPackage ( sub_pc, package );  genius_assert ( !ierr );
+    }
   }
+  ierr = KSPSetOptionsPrefix ( sub_ksp, "ddm_ac_sub_" );  genius_assert ( !ierr );
+  ierr = KSPSetTolerances ( sub_ksp, 1e-15, SolverSpecify::ksp_atol, PETSC_DEFAULT, std::max ( 50, static_cast<int> ( n_global_dofs/10 ) ) );  genius_assert ( !ierr );
+  ierr = KSPSetFromOptions ( sub_ksp );  genius_assert ( !ierr );
 
+  Vec b_sub, x_sub;
+  ierr = VecCreateMPI ( subcomm, mlocal_red, n_global_dofs, &b_sub );  genius_assert ( !ierr );
+  ierr = VecDuplicate ( b_sub, &x_sub );  genius_assert ( !ierr );
 
-  STOP_LOG ( "solve()", "DDMACSolver" );
+  PetscInt sub_begin, sub_end;
+  ierr = VecGetOwnershipRange ( b_sub, &sub_begin, &sub_end );  genius_assert ( !ierr );
 
-  return 0;
+  std::vector<PetscInt> sub_index;
+  for ( PetscInt i=sub_begin; i<sub_end; ++i ) sub_index.push_back ( i );
+
+  // full copy of rhs vector on each processor
+  Vec b_all;
+  VecScatter to_all;
+  ierr = VecScatterCreateToAll ( b, &to_all, &b_all );  genius_assert ( !ierr );
+
+  for ( unsigned int start=0; start<freqs.size(); start+=n_groups )
+  {
+    const unsigned int n_batch = std::min ( n_groups, static_cast<unsigned int> ( freqs.size()-start ) );
+
+    Mat A_sub = PETSC_NULL;
+
+    // assemble the AC matrix for each frequency of this batch and send it to its group
+    for ( unsigned int k=0; k<n_batch; ++k )
+    {
+      build_ddm_ac ( 2*PI*freqs[start+k] );
+
+      Mat A_red;
+      ierr = MatGetRedundantMatrix ( A, n_groups, subcomm, mlocal_red, MAT_INITIAL_MATRIX, &A_red );  genius_assert ( !ierr );
+
+      VecScatterBegin ( to_all, b, b_all, INSERT_VALUES, SCATTER_FORWARD );
+      VecScatterEnd ( to_all, b, b_all, INSERT_VALUES, SCATTER_FORWARD );
+
+      if ( k == group )
+      {
+        A_sub = A_red;
+
+        PetscScalar *bb;
+        VecGetArray ( b_all, &bb );
+        VecSetValues ( b_sub, sub_index.size(), sub_index.empty() ? PETSC_NULL : &sub_index[0], bb+sub_begin, INSERT_VALUES );
+        VecRestoreArray ( b_all, &bb );
+      }
+      else
+        MatDestroy ( PetscDestroyObject(A_red) );
+    }
+
+    // each group solves its own frequency
+    PetscInt   its = 0;
+    PetscReal  rnorm = 0.0;
+    int        reason = 0;
+    if ( group < n_batch )
+    {
+      VecAssemblyBegin ( b_sub );
+      VecAssemblyEnd ( b_sub );
+
+      KSPSetOperators ( sub_ksp, A_sub, A_sub, DIFFERENT_NONZERO_PATTERN );
+      KSPSolve ( sub_ksp, b_sub, x_sub );
+
+      KSPConvergedReason sub_reason;
+      KSPGetConvergedReason ( sub_ksp, &sub_reason );
+      KSPGetIterationNumber ( sub_ksp, &its );
+      KSPGetResidualNorm ( sub_ksp, &rnorm );
+      reason = static_cast<int> ( sub_reason );
+
+      MatDestroy ( PetscDestroyObject(A_sub) );
+    }
+
+    // report and post process in frequency order
+    for ( unsigned int k=0; k<n_batch; ++k )
+    {
+      SolverSpecify::Freq = freqs[start+k];
+
+      MESSAGE
+      <<"AC Scan: f("<<SolverSpecify::Electrode_ACScan[0]<<") = "
+      << std::setiosflags ( std::ios::fixed )
+      <<SolverSpecify::Freq*PhysicalUnit::s/1e6<<" MHz "<<"\n";
+      RECORD();
+
+      // processor k is the first member of group k
+      PetscInt   k_its = its;
+      PetscReal  k_rnorm = rnorm;
+      int        k_reason = reason;
+      Parallel::broadcast ( k_its, k );
+      Parallel::broadcast ( k_rnorm, k );
+      Parallel::broadcast ( k_reason, k );
+
+      MESSAGE<<"------> residual norm = "<<k_rnorm<<" its = "<<k_its<<" with "<<KSPConvergedReasons[k_reason]<<"\n\n";
+      RECORD();
+
+      // copy the solution of group k back to x
+      if ( k == group && !sub_index.empty() )
+      {
+        PetscScalar *xx;
+        VecGetArray ( x_sub, &xx );
+        VecSetValues ( x, sub_index.size(), &sub_index[0], xx, INSERT_VALUES );
+        VecRestoreArray ( x_sub, &xx );
+      }
+      VecAssemblyBegin ( x );
+      VecAssemblyEnd ( x );
+
+      this->post_solve_process();
+    }
+  }
+
+  VecScatterDestroy ( PetscDestroyObject(to_all) );
+  VecDestroy ( PetscDestroyObject(b_all) );
+  VecDestroy ( PetscDestroyObject(b_sub) );
+  VecDestroy ( PetscDestroyObject(x_sub) );
+  KSPDestroy ( PetscDestroyObject(sub_ksp) );
+  MPI_Comm_free ( &subcomm );
+}
+
+
+
+
+/*------------------------------------------------------------------
+ * solve the dense complex system M X = B with partial pivoting, X is returned in B.
+ * M is n*n and B is n*m, both row major
+ */
+static void complex_lu_solve ( std::vector< std::complex<double> > &M, std::vector< std::complex<double> > &B,
+                               unsigned int n, unsigned int m )
+{
+  for ( unsigned int k=0; k<n; ++k )
+  {
+    unsigned int p = k;
+    for ( unsigned int i=k+1; i<n; ++i )
+      if ( std::abs ( M[i*n+k] ) > std::abs ( M[p*n+k] ) ) p = i;
+    if ( p != k )
+    {
+      for ( unsigned int j=0; j<n; ++j ) std::swap ( M[k*n+j], M[p*n+j] );
+      for ( unsigned int j=0; j<m; ++j ) std::swap ( B[k*m+j], B[p*m+j] );
+    }
+    if ( M[k*n+k] == 0.0 ) continue;
+
+    for ( unsigned int i=k+1; i<n; ++i )
+    {
+      std::complex<double> f = M[i*n+k]/M[k*n+k];
+      for ( unsigned int j=k; j<n; ++j ) M[i*n+j] -= f*M[k*n+j];
+      for ( unsigned int j=0; j<m; ++j ) B[i*m+j] -= f*B[k*m+j];
+    }
+  }
+
+  for ( int k=n-1; k>=0; --k )
+  {
+    for ( unsigned int j=0; j<m; ++j )
+    {
+      for ( unsigned int i=k+1; i<n; ++i ) B[k*m+j] -= M[k*n+i]*B[i*m+j];
+      if ( M[k*n+k] != 0.0 ) B[k*m+j] /= M[k*n+k];
+    }
+  }
+}
+
+
+
+/*------------------------------------------------------------------
+ * N-port AC sweep. the AC matrix of each frequency is built and factored once,
+ * then each electrode of ACScan is driven in turn and only the rhs is assembled again.
+ * the admittance matrix Y and scattering matrix S = (I+Z0*Y)^-1 (I-Z0*Y) are written to
+ * SolverSpecify::ACNPortFile
+ */
+void DDMACSolver::solve_frequency_nport ( const std::vector<double> &freqs )
+{
+  START_LOG ( "solve_frequency_nport()", "DDMACSolver" );
+
+  const unsigned int N = SolverSpecify::Electrode_ACScan.size();
+  std::vector<BoundaryCondition *> ports;
+  for ( unsigned int n=0; n<N; ++n )
+    ports.push_back ( _system.get_bcs()->get_bc ( SolverSpecify::Electrode_ACScan[n] ) );
+
+  const double Z0 = SolverSpecify::ACNPortZ0/( PhysicalUnit::V/PhysicalUnit::A );
+
+  std::ofstream fout;
+  if ( Genius::processor_id() == 0 )
+  {
+    fout.open ( SolverSpecify::ACNPortFile.c_str(), std::ios::trunc );
+    fout << "# N-port admittance Y(A/V) and scattering matrix S with Z0 = " << Z0 << " ohm\n";
+    fout << "# port";
+    for ( unsigned int n=0; n<N; ++n )
+      fout << '\t' << ports[n]->label();
+    fout << '\n' << "# f(Hz), then re/im of Y(i,j) and S(i,j) in row major order\n";
+    fout << std::scientific << std::setprecision ( 8 );
+  }
+
+  for ( unsigned int i=0; i<freqs.size(); ++i )
+  {
+    SolverSpecify::Freq = freqs[i];
+
+    double omega = 2*PI*SolverSpecify::Freq;
+
+    MESSAGE
+    <<"AC Scan: "<<N<<"-port f = "
+    << std::setiosflags ( std::ios::fixed )
+    <<SolverSpecify::Freq*PhysicalUnit::s/1e6<<" MHz "<<"\n";
+    RECORD();
+
+    // the AC matrix of this frequency, it is factored at the first solve
+    build_ddm_ac ( omega );
+
+    std::vector< std::complex<double> > Y ( N*N, 0.0 );
+
+    // the first port is driven at last, its solution is kept for post process
+    for ( int k=N-1; k>=0; --k )
+    {
+      for ( unsigned int n=0; n<N; ++n )
+        ports[n]->ext_circuit()->Vac() = ( static_cast<int> ( n ) == k ? SolverSpecify::VAC : 0.0 );
+
+      build_ddm_ac_bc ( omega );
+      MatMult ( T_, b_, b );
+
+      // the operator is not changed, the preconditioner (factorization) of A is reused
+      KSPSolve ( ksp, b, x );
+
+      KSPConvergedReason reason;
+      KSPGetConvergedReason ( ksp, &reason );
+
+      PetscInt   its;
+      KSPGetIterationNumber ( ksp, &its );
+
+      PetscReal  rnorm;
+      KSPGetResidualNorm ( ksp, &rnorm );
+
+      MESSAGE<<"------> port "<<ports[k]->label()<<" residual norm = "<<rnorm<<" its = "<<its<<" with "<<KSPConvergedReasons[reason]<<"\n";
+      RECORD();
+
+      // terminal current of each port
+      VecScatterBegin ( scatter, x, lx, INSERT_VALUES, SCATTER_FORWARD );
+      VecScatterEnd ( scatter, x, lx, INSERT_VALUES, SCATTER_FORWARD );
+
+      PetscScalar *lxx;
+      VecGetArray ( lx, &lxx );
+      for ( unsigned int n=0; n<N; ++n )
+        ports[n]->DDMAC_Update_Solution ( lxx, J_, omega );
+      VecRestoreArray ( lx, &lxx );
+
+      std::complex<double> Vk = ports[k]->ext_circuit()->potential_ac()/PhysicalUnit::V;
+      if ( Vk == 0.0 ) continue;
+      for ( unsigned int n=0; n<N; ++n )
+        Y[n*N+k] = ( ports[n]->ext_circuit()->current_ac()/PhysicalUnit::A )/Vk;
+    }
+    MESSAGE<<"\n";
+    RECORD();
+
+    // S = (I+Z0*Y)^-1 (I-Z0*Y)
+    std::vector< std::complex<double> > M ( N*N ), S ( N*N );
+    for ( unsigned int r=0; r<N; ++r )
+      for ( unsigned int c=0; c<N; ++c )
+      {
+        M[r*N+c] = ( r==c ? 1.0 : 0.0 ) + Z0*Y[r*N+c];
+        S[r*N+c] = ( r==c ? 1.0 : 0.0 ) - Z0*Y[r*N+c];
+      }
+    complex_lu_solve ( M, S, N, N );
+
+    if ( Genius::processor_id() == 0 )
+    {
+      fout << SolverSpecify::Freq*PhysicalUnit::s;
+      for ( unsigned int n=0; n<N*N; ++n )
+        fout << '\t' << Y[n].real() << '\t' << Y[n].imag();
+      for ( unsigned int n=0; n<N*N; ++n )
+        fout << '\t' << S[n].real() << '\t' << S[n].imag();
+      fout << '\n';
+    }
+
+    this->post_solve_process();
+  }
+
+  // restore the excitation of pre_solve_process
+  for ( unsigned int n=0; n<N; ++n )
+    ports[n]->ext_circuit()->Vac() = SolverSpecify::VAC;
+
+  STOP_LOG ( "solve_frequency_nport()", "DDMACSolver" );
+}
+
+
+
+/*------------------------------------------------------------------
+ * AC sweep with reduced order model
+ */
+void DDMACSolver::solve_frequency_mor ( const std::vector<double> &freqs )
+{
+  START_LOG ( "solve_frequency_mor()", "DDMACSolver" );
+
+  build_ac_dof_pairs();
+
+  Vec v, t;
+  VecDuplicate ( x, &v );
+  VecDuplicate ( x, &t );
+
+  std::vector<Vec> basis;
+
+  // expansion points, geometric spaced between the first and last frequency
+  const unsigned int n_points = std::max ( 1u, std::min ( SolverSpecify::ACMORPoints, static_cast<unsigned int> ( freqs.size() ) ) );
+
+  MESSAGE<<"AC Scan: build reduced order model with "<<n_points<<" expansion points, "
+         <<SolverSpecify::ACMORMoments<<" moments each"<<"\n";
+  RECORD();
+
+  for ( unsigned int p=0; p<n_points; ++p )
+  {
+    double f = n_points == 1 ? std::sqrt ( freqs.front() *freqs.back() ) :
+               freqs.front() *std::pow ( freqs.back() /freqs.front(), static_cast<double> ( p ) / ( n_points-1 ) );
+    double omega = 2*PI*f;
+
+    build_ddm_ac ( omega );
+    KSPSolve ( ksp, b, v );
+
+    // moments of the solution: v_{j+1} = A^{-1} A1 v_j, where v_j is the latest basis vector
+    for ( unsigned int j=0; j<=SolverSpecify::ACMORMoments; ++j )
+    {
+      if ( j > 0 )
+      {
+        MatMult ( A1_, basis.back(), t );
+        MatMult ( T_, t, b );
+        KSPSolve ( ksp, b, v );
+      }
+
+      // the basis should span complex vectors, also add i*v
+      rotate_ac_vector ( v, t );
+      bool dependent = !add_mor_basis ( v, basis );
+      dependent = !add_mor_basis ( t, basis ) && dependent;
+      if ( dependent ) break;
+    }
+  }
+
+  const unsigned int m = basis.size();
+
+  MESSAGE<<"AC Scan: reduced order model has "<<m<<" basis vectors"<<"\n\n";
+  RECORD();
+
+  // projection of region contributions, Ar0 = V^T A0 V and Ar1 = V^T A1 V
+  std::vector<PetscScalar> Ar0 ( m*m ), Ar1 ( m*m );
+  {
+    std::vector<PetscScalar> col ( m );
+    for ( unsigned int j=0; j<m; ++j )
+    {
+      MatMult ( A0_, basis[j], t );
+      VecMDot ( t, m, &basis[0], &col[0] );
+      for ( unsigned int i=0; i<m; ++i ) Ar0[i*m+j] = col[i];
+
+      MatMult ( A1_, basis[j], t );
+      VecMDot ( t, m, &basis[0], &col[0] );
+      for ( unsigned int i=0; i<m; ++i ) Ar1[i*m+j] = col[i];
+    }
+  }
+
+  // the frequency points which are verified by full solve
+  std::set<unsigned int> check_points;
+  for ( unsigned int c=0; c<SolverSpecify::ACMORCheck; ++c )
+    check_points.insert ( std::min ( static_cast<unsigned int> ( freqs.size()-1 ), static_cast<unsigned int> ( ( c+1 ) *freqs.size() / ( SolverSpecify::ACMORCheck+1 ) ) ) );
+
+  PetscReal max_residual = 0.0;
+  PetscReal max_error = 0.0;
+
+  for ( unsigned int n=0; n<freqs.size(); ++n )
+  {
+    SolverSpecify::Freq = freqs[n];
+
+    double omega = 2*PI*SolverSpecify::Freq;
+
+    MESSAGE
+    <<"AC Scan: f("<<SolverSpecify::Electrode_ACScan[0]<<") = "
+    << std::setiosflags ( std::ios::fixed )
+    <<SolverSpecify::Freq*PhysicalUnit::s/1e6<<" MHz "<<"\n";
+    RECORD();
+
+    build_ddm_ac_bc ( omega );
+
+    // projection of boundary condition contributions, only rows of Abc_ with entries are involved
+    std::vector<PetscScalar> Ar_bc ( m*m, 0.0 );
+    for ( unsigned int j=0; j<m; ++j )
+    {
+      MatMult ( Abc_, basis[j], t );
+      PetscScalar *tt;
+      VecGetArray ( t, &tt );
+      for ( unsigned int i=0; i<m; ++i )
+      {
+        PetscScalar *vv;
+        VecGetArray ( basis[i], &vv );
+        for ( unsigned int k=0; k<_bc_rows.size(); ++k )
+          Ar_bc[i*m+j] += vv[_bc_rows[k]]*tt[_bc_rows[k]];
+        VecRestoreArray ( basis[i], &vv );
+      }
+      VecRestoreArray ( t, &tt );
+    }
+    Parallel::sum ( Ar_bc );
+
+    std::vector<PetscScalar> br ( m );
+    VecMDot ( b_, m, &basis[0], &br[0] );
+
+    // solve the reduced system
+    DenseMatrix<PetscScalar> Ar ( m, m );
+    DenseVector<PetscScalar> rhs ( m ), y ( m );
+    for ( unsigned int i=0; i<m; ++i )
+    {
+      rhs ( i ) = br[i];
+      for ( unsigned int j=0; j<m; ++j )
+        Ar ( i, j ) = Ar0[i*m+j] + omega*Ar1[i*m+j] + Ar_bc[i*m+j];
+    }
+    Ar.lu_solve ( rhs, y, true );
+
+    std::vector<PetscScalar> yy ( m );
+    for ( unsigned int j=0; j<m; ++j ) yy[j] = y ( j );
+    VecZeroEntries ( x );
+    VecMAXPY ( x, m, &yy[0], &basis[0] );
+
+    // residual of the full system, r = (A0 + omega*A1 + Abc) x - b
+    PetscReal rnorm, bnorm;
+    MatMult ( A0_, x, v );
+    MatMult ( A1_, x, t );
+    VecAXPY ( v, omega, t );
+    MatMult ( Abc_, x, t );
+    VecAXPY ( v, 1.0, t );
+    VecAXPY ( v, -1.0, b_ );
+    VecNorm ( v, NORM_2, &rnorm );
+    VecNorm ( b_, NORM_2, &bnorm );
+    PetscReal relative_residual = bnorm > 0.0 ? rnorm/bnorm : rnorm;
+    max_residual = std::max ( max_residual, relative_residual );
+
+    MESSAGE<<"------> reduced order model relative residual = "<<relative_residual;
+
+    if ( check_points.find ( n ) != check_points.end() )
+    {
+      build_ddm_ac ( omega );
+      KSPSolve ( ksp, b, v );
+
+      PetscReal enorm, xnorm;
+      VecNorm ( v, NORM_2, &xnorm );
+      VecAXPY ( v, -1.0, x );
+      VecNorm ( v, NORM_2, &enorm );
+      PetscReal relative_error = xnorm > 0.0 ? enorm/xnorm : enorm;
+      max_error = std::max ( max_error, relative_error );
+
+      MESSAGE<<", relative error to full solve = "<<relative_error;
+    }
+    MESSAGE<<"\n\n";
+    RECORD();
+
+    this->post_solve_process();
+  }
+
+  MESSAGE<<"AC Scan: reduced order model max relative residual = "<<max_residual;
+  if ( !check_points.empty() )
+    MESSAGE<<", max relative error to full solve = "<<max_error;
+  MESSAGE<<"\n";
+  if ( max_error > 1e-2 )
+    MESSAGE<<"Warning: the reduced order model is not accurate, more expansion points or moments are required."<<"\n";
+  MESSAGE<<"\n";
+  RECORD();
+
+  for ( unsigned int j=0; j<m; ++j )
+    VecDestroy ( PetscDestroyObject(basis[j]) );
+  VecDestroy ( PetscDestroyObject(v) );
+  VecDestroy ( PetscDestroyObject(t) );
+
+  STOP_LOG ( "solve_frequency_mor()", "DDMACSolver" );
+}
+
+
+
+/*------------------------------------------------------------------
+ * the real and imaginary part of each AC variable
+ */
+void DDMACSolver::build_ac_dof_pairs()
+{
+  _ac_dof_pairs.clear();
+
+  for ( unsigned int n=0; n<_system.n_regions(); n++ )
+  {
+    const SimulationRegion * region = _system.region ( n );
+    if ( this->node_dofs ( region ) == 0 ) continue;
+
+    const unsigned int n_variables = region->ebm_n_variables();
+
+    SimulationRegion::const_processor_node_iterator node_it = region->on_processor_nodes_begin();
+    SimulationRegion::const_processor_node_iterator node_it_end = region->on_processor_nodes_end();
+    for ( ; node_it!=node_it_end; ++node_it )
+    {
+      const FVM_Node * fvm_node = *node_it;
+      for ( unsigned int i=0; i<n_variables; ++i )
+        _ac_dof_pairs.push_back ( std::make_pair ( fvm_node->global_offset() +i, fvm_node->global_offset() +n_variables+i ) );
+    }
+  }
+
+  // bc dofs are on the last processor
+  if ( Genius::processor_id() == Genius::n_processors() -1 )
+  {
+    for ( unsigned int n=0; n<_system.get_bcs()->n_bcs(); ++n )
+    {
+      const BoundaryCondition * bc = _system.get_bcs()->get_bc ( n );
+      if ( this->bc_dofs ( bc ) == 0 ) continue;
+      _ac_dof_pairs.push_back ( std::make_pair ( bc->global_offset(), bc->global_offset() +1 ) );
+    }
+  }
+}
+
+
+
+/*------------------------------------------------------------------
+ * dst = i*src
+ */
+void DDMACSolver::rotate_ac_vector ( Vec src, Vec dst ) const
+{
+  PetscInt begin, end;
+  VecGetOwnershipRange ( src, &begin, &end );
+
+  VecZeroEntries ( dst );
+
+  PetscScalar *ss, *dd;
+  VecGetArray ( src, &ss );
+  VecGetArray ( dst, &dd );
+  for ( unsigned int n=0; n<_ac_dof_pairs.size(); ++n )
+  {
+    PetscInt real = _ac_dof_pairs[n].first  - begin;
+    PetscInt imag = _ac_dof_pairs[n].second - begin;
+    dd[real] = -ss[imag];
+    dd[imag] =  ss[real];
+  }
+  VecRestoreArray ( src, &ss );
+  VecRestoreArray ( dst, &dd );
+}
+
+
+
+/*------------------------------------------------------------------
+ * modified Gram-Schmidt with one reorthogonalization
+ */
+bool DDMACSolver::add_mor_basis ( Vec v, std::vector<Vec> &basis ) const
+{
+  PetscReal norm0, norm;
+  VecNorm ( v, NORM_2, &norm0 );
+  if ( norm0 == 0.0 ) return false;
+
+  for ( unsigned int pass=0; pass<2 && !basis.empty(); ++pass )
+  {
+    std::vector<PetscScalar> h ( basis.size() );
+    VecMDot ( v, basis.size(), &basis[0], &h[0] );
+    for ( unsigned int i=0; i<h.size(); ++i ) h[i] = -h[i];
+    VecMAXPY ( v, basis.size(), &h[0], &basis[0] );
+  }
+
+  VecNorm ( v, NORM_2, &norm );
+  if ( norm < 1e-10*norm0 ) return false;
+
+  Vec q;
+  VecDuplicate ( v, &q );
+  VecCopy ( v, q );
+  VecScale ( q, 1.0/norm );
+  basis.push_back ( q );
+
+  return true;
 }
 
 
@@ -382,7 +1023,20 @@ int DDMACSolver::destroy_solver()
   ierr = VecDestroy ( PetscDestroyObject(b_) );
   genius_assert ( !ierr );
 
-  if ( !_first_create ) MatDestroy ( PetscDestroyObject(C_) );
+  if ( !_first_create )
+  {
+    MatDestroy ( PetscDestroyObject(C_) );
+    MatDestroy ( PetscDestroyObject(T0_) );
+    MatDestroy ( PetscDestroyObject(T1_) );
+  }
+
+  if ( !_bc_create ) MatDestroy ( PetscDestroyObject(Abc_) );
+
+  if ( !_split_create )
+  {
+    MatDestroy ( PetscDestroyObject(A0_) );
+    MatDestroy ( PetscDestroyObject(A1_) );
+  }
 
   return FVM_LinearSolver::destroy_solver();
 }
@@ -402,6 +1056,128 @@ int DDMACSolver::destroy_solver()
 
 
 
+/*------------------------------------------------------------------
+ * assemble the frequency independent part A0_ and the omega coefficient A1_
+ * of the region contributions. the region terms are affine in omega,
+ * so A0_ is the fill with omega=0 and A1_ is the fill with omega=1 minus A0_.
+ * both matrices are duplicated from the assembled A_, so they share its nonzero pattern
+ */
+void DDMACSolver::build_ddm_ac_split()
+{
+  START_LOG ( "build_ddm_ac_split()", "DDMACSolver" );
+
+  int ierr = 0;
+
+  ierr = MatDuplicate ( A_, MAT_DO_NOT_COPY_VALUES, &A0_ );  genius_assert ( !ierr );
+  ierr = MatDuplicate ( A_, MAT_DO_NOT_COPY_VALUES, &A1_ );  genius_assert ( !ierr );
+
+  InsertMode add_value_flag = NOT_SET_VALUES;
+  for ( unsigned int n=0; n<_system.n_regions(); n++ )
+  {
+    SimulationRegion * region = _system.region ( n );
+    region->DDMAC_Fill_Matrix_Vector ( A0_, b_, J_, 0.0, add_value_flag );
+  }
+  MatAssemblyBegin ( A0_, MAT_FINAL_ASSEMBLY );
+  MatAssemblyEnd ( A0_, MAT_FINAL_ASSEMBLY );
+
+  add_value_flag = NOT_SET_VALUES;
+  for ( unsigned int n=0; n<_system.n_regions(); n++ )
+  {
+    SimulationRegion * region = _system.region ( n );
+    region->DDMAC_Fill_Matrix_Vector ( A1_, b_, J_, 1.0, add_value_flag );
+  }
+  MatAssemblyBegin ( A1_, MAT_FINAL_ASSEMBLY );
+  MatAssemblyEnd ( A1_, MAT_FINAL_ASSEMBLY );
+
+  ierr = MatAXPY ( A1_, -1.0, A0_, SAME_NONZERO_PATTERN );  genius_assert ( !ierr );
+
+  _split_create = false;
+
+  STOP_LOG ( "build_ddm_ac_split()", "DDMACSolver" );
+}
+
+
+
+/*------------------------------------------------------------------
+ * build the boundary condition part of matrix and right hand side vector b with certain freq omega
+ */
+void DDMACSolver::build_ddm_ac_bc ( double omega )
+{
+  START_LOG ( "build_ddm_ac_bc()", "DDMACSolver" );
+
+  if ( _bc_create )
+    create_ac_matrix ( Abc_ );
+  else
+    MatZeroEntries ( Abc_ );
+
+  VecZeroEntries ( b_ );
+
+  InsertMode add_value_flag = NOT_SET_VALUES;
+  for ( unsigned int n=0; n<_system.get_bcs()->n_bcs(); ++n )
+  {
+    BoundaryCondition * bc = _system.get_bcs()->get_bc ( n );
+    bc->DDMAC_Fill_Matrix_Vector ( Abc_, b_, J_, omega, add_value_flag );
+  }
+
+  MatAssemblyBegin ( Abc_, MAT_FINAL_ASSEMBLY );
+  MatAssemblyEnd ( Abc_, MAT_FINAL_ASSEMBLY );
+
+  VecAssemblyBegin ( b_ );
+  VecAssemblyEnd ( b_ );
+
+  if ( _bc_create )
+  {
+    // the nonzero pattern of Abc_ is kept, record the rows with entries
+    PetscInt begin, end;
+    MatGetOwnershipRange ( Abc_, &begin, &end );
+    _bc_rows.clear();
+    for ( PetscInt row=begin; row<end; ++row )
+    {
+      PetscInt ncols;
+      MatGetRow ( Abc_, row, &ncols, PETSC_NULL, PETSC_NULL );
+      if ( ncols > 0 ) _bc_rows.push_back ( row-begin );
+      MatRestoreRow ( Abc_, row, &ncols, PETSC_NULL, PETSC_NULL );
+    }
+    _bc_create = false;
+  }
+
+  STOP_LOG ( "build_ddm_ac_bc()", "DDMACSolver" );
+}
+
+
+
+/*------------------------------------------------------------------
+ * fill the transformation matrix with certain freq omega
+ */
+void DDMACSolver::fill_ac_transformation ( Mat T, double omega )
+{
+  MatZeroEntries ( T );
+
+  InsertMode add_value_flag = NOT_SET_VALUES;
+  for ( unsigned int n=0; n<_system.n_regions(); n++ )
+  {
+    SimulationRegion * region = _system.region ( n );
+    region->DDMAC_Fill_Transformation_Matrix ( T, J_, omega, add_value_flag );
+  }
+
+  if(Genius::processor_id() == Genius::n_processors() -1)
+  {
+    for ( unsigned int n=0; n<_system.get_bcs()->n_bcs(); ++n )
+    {
+      BoundaryCondition * bc = _system.get_bcs()->get_bc ( n );
+      if ( !bc->is_electrode() ) continue;
+      MatSetValue ( T, bc->global_offset(), bc->global_offset(), 1.0, ADD_VALUES );
+      MatSetValue ( T, bc->global_offset() +1, bc->global_offset() +1, 1.0, ADD_VALUES );
+    }
+  }
+
+  // assembly the transformation matrix
+  MatAssemblyBegin ( T, MAT_FINAL_ASSEMBLY );
+  MatAssemblyEnd ( T, MAT_FINAL_ASSEMBLY );
+}
+
+
+
 /*------------------------------------------------------------------
  * build the matrix and right hand side vector b with certain freq omega
  */
@@ -413,17 +1189,29 @@ void DDMACSolver::build_ddm_ac ( double omega )
   // flag for indicate ADD_VALUES operator.
   InsertMode add_value_flag = NOT_SET_VALUES;
 
-  MatZeroEntries ( A_ );
   VecZeroEntries ( b_ );
 
-  // evaluate Jacobian matrix of governing equations of EBM for all the regions
-  for ( unsigned int n=0; n<_system.n_regions(); n++ )
+  if ( _split_create )
   {
-    SimulationRegion * region = _system.region ( n );
-    region->DDMAC_Fill_Matrix_Vector ( A_, b_, J_, omega, add_value_flag );
+    // the first frequency, do the full assembly which also builds the nonzero pattern of A_
+    MatZeroEntries ( A_ );
+
+    // evaluate Jacobian matrix of governing equations of EBM for all the regions
+    for ( unsigned int n=0; n<_system.n_regions(); n++ )
+    {
+      SimulationRegion * region = _system.region ( n );
+      region->DDMAC_Fill_Matrix_Vector ( A_, b_, J_, omega, add_value_flag );
+    }
+  }
+  else
+  {
+    // region contributions are A0_ + omega*A1_
+    MatCopy ( A0_, A_, SAME_NONZERO_PATTERN );
+    MatAXPY ( A_, omega, A1_, SAME_NONZERO_PATTERN );
   }
 
   // evaluate Jacobian matrix of governing equations of EBM for all the boundaries
+  // the ext circuit terms are not affine in omega, they are always assembled here
   for ( unsigned int n=0; n<_system.get_bcs()->n_bcs(); ++n )
   {
     BoundaryCondition * bc = _system.get_bcs()->get_bc ( n );
@@ -438,33 +1226,30 @@ void DDMACSolver::build_ddm_ac ( double omega )
   VecAssemblyBegin ( b_ );
   VecAssemblyEnd ( b_ );
 
+  if ( _split_create ) build_ddm_ac_split();
+
 
   // process transformation matrix
   {
-    MatZeroEntries ( T_ );
-    add_value_flag = NOT_SET_VALUES;
-    for ( unsigned int n=0; n<_system.n_regions(); n++ )
+    if ( _first_create )
     {
-      SimulationRegion * region = _system.region ( n );
-      region->DDMAC_Fill_Transformation_Matrix ( T_, J_, omega, add_value_flag );
+      fill_ac_transformation ( T_, omega );
+
+      // the entries of T_ are affine in omega, split them as A_ above
+      int ierr = 0;
+      ierr = MatDuplicate ( T_, MAT_DO_NOT_COPY_VALUES, &T0_ );  genius_assert ( !ierr );
+      ierr = MatDuplicate ( T_, MAT_DO_NOT_COPY_VALUES, &T1_ );  genius_assert ( !ierr );
+      fill_ac_transformation ( T0_, 0.0 );
+      fill_ac_transformation ( T1_, 1.0 );
+      ierr = MatAXPY ( T1_, -1.0, T0_, SAME_NONZERO_PATTERN );  genius_assert ( !ierr );
     }
-
-    if(Genius::processor_id() == Genius::n_processors() -1)
+    else
     {
-      for ( unsigned int n=0; n<_system.get_bcs()->n_bcs(); ++n )
-      {
-        BoundaryCondition * bc = _system.get_bcs()->get_bc ( n );
-        if ( !bc->is_electrode() ) continue;
-        MatSetValue ( T_, bc->global_offset(), bc->global_offset(), 1.0, ADD_VALUES );
-        MatSetValue ( T_, bc->global_offset() +1, bc->global_offset() +1, 1.0, ADD_VALUES );
-      }
+      // no more MatGetValues from J_ for each node
+      MatCopy ( T0_, T_, SAME_NONZERO_PATTERN );
+      MatAXPY ( T_, omega, T1_, SAME_NONZERO_PATTERN );
     }
 
-    // assembly the transformation matrix
-    MatAssemblyBegin ( T_, MAT_FINAL_ASSEMBLY );
-    MatAssemblyEnd ( T_, MAT_FINAL_ASSEMBLY );
-
-
     // do transport
     if ( _first_create )
     {
@@ -473,7 +1258,11 @@ void DDMACSolver::build_ddm_ac ( double omega )
     }
     else
       MatMatMult ( T_, A_, MAT_REUSE_MATRIX , PETSC_DEFAULT, &C_ );
-    MatCopy(C_, A, DIFFERENT_NONZERO_PATTERN);
+
+    // the pattern of C_ is kept by MAT_REUSE_MATRIX, A takes it at the first copy,
+    // later copies are plain copies of the value arrays
+    MatCopy ( C_, A, _operator_create ? DIFFERENT_NONZERO_PATTERN : SAME_NONZERO_PATTERN );
+    _operator_create = false;
 
     MatMult ( T_, b_, b );
   }
@@ -0,0 +1,218 @@
+/********************************************************************************/
+/*     888888    888888888   88     888  88888   888      888    88888888       */
+/*   8       8   8           8 8     8     8      8        8    8               */
+/*  8            8           8  8    8     8      8        8    8               */
+/*  8            888888888   8   8   8     8      8        8     8888888        */
+/*  8      8888  8           8    8  8     8      8        8            8       */
+/*   8       8   8           8     8 8     8      8        8            8       */
+/*     888888    888888888  888     88   88888     88888888     88888888        */
+/*                                                                              */
+/*       A Three-Dimensional General Purpose Semiconductor Simulator.           */
+/*                                                                              */
+/*                                                                              */
+/*  Copyright (C) 2007-2008                                                     */
+/*  Cogenda Pte Ltd                                                             */
+/*                                                                              */
+/*  Please contact Cogenda Pte Ltd for license information                      */
+/*                                                                              */
+/*  Author: Gong Ding   gdiso@ustc.edu                                          */
+/*                                                                              */
+/********************************************************************************/
+
+#include "simulation_system.h"
+#include "semiconductor_region.h"
+#include "solver_specify.h"
+#include "perf_log.h"
+
+using PhysicalUnit::e;
+
+
+bool SemiconductorSimulationRegion::bbt_nonlocal() const
+{
+  return _advanced_model.BandBandTunnelingNonlocal && SolverSpecify::Type!=SolverSpecify::EQUILIBRIUM;
+}
+
+
+
+/*---------------------------------------------------------------------
+ * build the tunneling path of each on processor node. the path walks along the
+ * steepest ascent of psi over the fvm node neighbors, until psi rises by Eg/q.
+ * only local nodes are visited, so paths never leave the ghost layer of this processor.
+ */
+bool SemiconductorSimulationRegion::update_bbt_nonlocal_path(const PetscScalar * x)
+{
+  // test if the potential changed enough since last build
+  if( !_bbt_path_psi.empty() )
+  {
+    const PetscScalar dpsi = get_advanced_model()->BBTNonlocalDPsi;
+    bool rebuild = false;
+    for(unsigned int i=0; i<_bbt_path_psi.size(); ++i)
+    {
+      const FVM_Node * fvm_node = _bbt_path_psi[i].first;
+      if( std::abs(x[fvm_node->local_offset()] - _bbt_path_psi[i].second) > dpsi )
+      { rebuild = true; break; }
+    }
+    if( !rebuild ) return false;
+  }
+
+  START_LOG("update_bbt_nonlocal_path()", "SemiconductorSimulationRegion");
+
+  _bbt_path_begin.clear();
+  _bbt_path_end.clear();
+  _bbt_path_length.clear();
+  _bbt_path_psi.clear();
+
+  const Real max_length = get_advanced_model()->BBTNonlocalMaxLength;
+
+  const_local_node_iterator local_node_it = on_local_nodes_begin();
+  const_local_node_iterator local_node_it_end = on_local_nodes_end();
+  for(; local_node_it!=local_node_it_end; ++local_node_it)
+  {
+    const FVM_Node * fvm_node = *local_node_it;
+    _bbt_path_psi.push_back( std::make_pair(fvm_node, x[fvm_node->local_offset()]) );
+  }
+
+  const_processor_node_iterator node_it = on_processor_nodes_begin();
+  const_processor_node_iterator node_it_end = on_processor_nodes_end();
+  for(; node_it!=node_it_end; ++node_it)
+  {
+    const FVM_Node * begin = *node_it;
+    const PetscScalar psi_begin = x[begin->local_offset()];
+    const PetscScalar Eg = begin->node_data()->Eg()/e;
+    const Point & p_begin = *(begin->root_node());
+
+    const FVM_Node * current = begin;
+    PetscScalar psi_current = psi_begin;
+    Real length = 0.0;
+    while( length < max_length )
+    {
+      // the steepest ascent neighbor
+      const FVM_Node * next = 0;
+      PetscScalar psi_next = psi_current;
+      Real max_slope = 0.0;
+      Real step = 0.0;
+
+      FVM_Node::fvm_neighbor_node_iterator nb_it = current->neighbor_node_begin();
+      for(; nb_it != current->neighbor_node_end(); ++nb_it)
+      {
+        const FVM_Node * nb = (*nb_it).first;
+        if( !nb->on_local() ) continue;
+
+        const Real d = (*(nb->root_node()) - *(current->root_node())).size();
+        const PetscScalar psi_nb = x[nb->local_offset()];
+        if( (psi_nb - psi_current)/d > max_slope )
+        {
+          max_slope = (psi_nb - psi_current)/d;
+          next = nb;
+          psi_next = psi_nb;
+          step = d;
+        }
+      }
+
+      // reach a local maximum of psi
+      if( next == 0 ) break;
+
+      current = next;
+      psi_current = psi_next;
+      length += step;
+
+      // the conduction band at current node aligns with the valence band at begin node
+      if( psi_current - psi_begin >= Eg )
+      {
+        const Real distance = (*(current->root_node()) - p_begin).size();
+        if( distance < max_length )
+        {
+          _bbt_path_begin.push_back(begin);
+          _bbt_path_end.push_back(current);
+          _bbt_path_length.push_back(distance);
+        }
+        break;
+      }
+    }
+  }
+
+  STOP_LOG("update_bbt_nonlocal_path()", "SemiconductorSimulationRegion");
+
+  return true;
+}
+
+
+
+/*---------------------------------------------------------------------
+ * the generation rate is evaluated by the average field along the path,
+ * hole is generated at the begin node and electron at the end node.
+ */
+void SemiconductorSimulationRegion::BBT_Nonlocal_Function(const PetscScalar * x, Vec f, unsigned int T_dof)
+{
+  std::vector<PetscInt>          ibbt;
+  std::vector<PetscScalar>       bbt;
+  ibbt.reserve(2*_bbt_path_begin.size());
+  bbt.reserve(2*_bbt_path_begin.size());
+
+  for(unsigned int i=0; i<_bbt_path_begin.size(); ++i)
+  {
+    const FVM_Node * begin = _bbt_path_begin[i];
+    const FVM_Node * end   = _bbt_path_end[i];
+
+    const PetscScalar T = (T_dof == invalid_uint) ? T_external() : x[begin->local_offset()+T_dof];
+    const PetscScalar E = std::max(0.0, (x[end->local_offset()] - x[begin->local_offset()])/_bbt_path_length[i]);
+
+    mt->mapping(begin->root_node(), begin->node_data(), SolverSpecify::clock);
+    const PetscScalar GBTBT = mt->band->BB_Tunneling(T, E)*begin->volume();
+
+    // electron continuity equation at end node
+    ibbt.push_back(end->global_offset()+1);
+    bbt.push_back(GBTBT);
+
+    // hole continuity equation at begin node
+    ibbt.push_back(begin->global_offset()+2);
+    bbt.push_back(GBTBT);
+  }
+
+  // add into petsc vector, we should prevent zero length vector add here.
+  if(ibbt.size())     VecSetValues(f, ibbt.size(), &ibbt[0], &bbt[0], ADD_VALUES);
+}
+
+
+
+/*---------------------------------------------------------------------
+ * each path gives a sparse row block which only couples psi (and T) of its two end nodes
+ */
+void SemiconductorSimulationRegion::BBT_Nonlocal_Jacobian(const PetscScalar * x, Mat *jac, unsigned int T_dof)
+{
+  //the indepedent variable number, psi of begin and end node, and T of begin node
+  adtl::AutoDScalar::numdir = (T_dof == invalid_uint) ? 2 : 3;
+
+  //synchronize with material database
+  mt->set_ad_num(adtl::AutoDScalar::numdir);
+
+  for(unsigned int i=0; i<_bbt_path_begin.size(); ++i)
+  {
+    const FVM_Node * begin = _bbt_path_begin[i];
+    const FVM_Node * end   = _bbt_path_end[i];
+
+    AutoDScalar V_begin(x[begin->local_offset()]);  V_begin.setADValue(0, 1.0);
+    AutoDScalar V_end(x[end->local_offset()]);      V_end.setADValue(1, 1.0);
+
+    AutoDScalar T(T_external());
+    std::vector<PetscInt> cols;
+    cols.push_back(begin->global_offset());
+    cols.push_back(end->global_offset());
+    if(T_dof != invalid_uint)
+    {
+      T = x[begin->local_offset()+T_dof];  T.setADValue(2, 1.0);
+      cols.push_back(begin->global_offset()+T_dof);
+    }
+
+    AutoDScalar E = adtl::fmax((V_end - V_begin)/_bbt_path_length[i], 0.0);
+
+    mt->mapping(begin->root_node(), begin->node_data(), SolverSpecify::clock);
+    AutoDScalar GBTBT = mt->band->BB_Tunneling(T, E)*begin->volume();
+
+    PetscInt row_n = end->global_offset()+1;
+    PetscInt row_p = begin->global_offset()+2;
+    MatSetValues(*jac, 1, &row_n, cols.size(), &cols[0], GBTBT.getADValue(), ADD_VALUES);
+    MatSetValues(*jac, 1, &row_p, cols.size(), &cols[0], GBTBT.getADValue(), ADD_VALUES);
+  }
+}
+
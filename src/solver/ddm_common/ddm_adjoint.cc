@@ -0,0 +1,402 @@
+/********************************************************************************/
+/*     888888    888888888   88     888  88888   888      888    88888888       */
+/*   8       8   8           8 8     8     8      8        8    8               */
+/*  8            8           8  8    8     8      8        8    8               */
+/*  8            888888888   8   8   8     8      8        8     8888888        */
+/*  8      8888  8           8    8  8     8      8        8            8       */
+/*   8       8   8           8     8 8     8      8        8            8       */
+/*     888888    888888888  888     88   88888     88888888     88888888        */
+/*                                                                              */
+/*       A Three-Dimensional General Purpose Semiconductor Simulator.           */
+/*                                                                              */
+/*                                                                              */
+/*  Copyright (C) 2007-2008                                                     */
+/*  Cogenda Pte Ltd                                                             */
+/*                                                                              */
+/*  Please contact Cogenda Pte Ltd for license information                      */
+/*                                                                              */
+/*  Author: Gong Ding   gdiso@ustc.edu                                          */
+/*                                                                              */
+/********************************************************************************/
+
+#include <fstream>
+#include <iomanip>
+#include <set>
+#include <cmath>
+
+#include "solver_specify.h"
+#include "physical_unit.h"
+#include "ddm_solver.h"
+#include "semiconductor_region.h"
+#include "boundary_condition_collector.h"
+#include "material.h"
+#include "parallel.h"
+#include "random_stream.h"
+
+using PhysicalUnit::e;
+
+
+/*----------------------------------------------------------------------------
+ * with F(x,p) = 0 at the converged solution, the gradient of terminal current I(x,p) is
+ *   dI/dp = pI/pp - pI/px J^-1 pF/pp = pI/pp - lambda^T pF/pp,   J^T lambda = (pI/px)^T
+ * the adjoint lambda of each electrode is one transposed back-substitution with the jacobian
+ * still factored by the KSP. pI/pp and pF/pp come from function evaluations at perturbed
+ * parameter, they are exact for doping, trap density and work function which enter linearly.
+ */
+void DDMSolverBase::adjoint_sensitivity(bool append)
+{
+  BoundaryConditionCollector * bcs = _system.get_bcs();
+
+  std::vector<BoundaryCondition *> electrodes;
+  for ( unsigned int n=0; n<SolverSpecify::AdjointCurrent.size(); ++n )
+    electrodes.push_back ( bcs->get_bc ( SolverSpecify::AdjointCurrent[n] ) );
+
+  const unsigned int N = electrodes.size();
+  const unsigned int M = SolverSpecify::AdjointParameter.size();
+
+  Vec r0, r;
+  VecDuplicate ( x, &r0 );
+  VecDuplicate ( x, &r );
+
+  // electrode current is updated by function evaluation
+  std::vector<PetscScalar> I0 ( N ), I ( N );
+  SNESComputeFunction ( snes, x, r0 );
+  for ( unsigned int j=0; j<N; ++j )
+    I0[j] = electrodes[j]->ext_circuit()->current();
+  Parallel::sum ( I0 );
+
+  std::vector<Vec> lambda;
+  this->adjoint_solve ( electrodes, lambda );
+
+  std::vector<PetscScalar> G ( N*M, 0.0 );
+  std::vector<bool> valid ( M, false );
+  for ( unsigned int k=0; k<M; ++k )
+  {
+    const std::string & param = SolverSpecify::AdjointParameter[k];
+
+    const PetscScalar h = this->adjoint_perturb ( param, false );
+    if ( h == 0.0 )
+    {
+      MESSAGE<<"Warning: adjoint parameter " << param << " can't be found, skipped.\n"; RECORD();
+      continue;
+    }
+    SNESComputeFunction ( snes, x, r );
+    for ( unsigned int j=0; j<N; ++j )
+      I[j] = electrodes[j]->ext_circuit()->current();
+    Parallel::sum ( I );
+    this->adjoint_perturb ( param, true );
+
+    // pF/pp*h
+    VecAXPY ( r, -1.0, r0 );
+    for ( unsigned int j=0; j<N; ++j )
+    {
+      PetscScalar lf;
+      VecDot ( lambda[j], r, &lf );
+      G[k*N+j] = ( I[j] - I0[j] - lf ) /h;
+    }
+    valid[k] = true;
+  }
+
+  // restore electrode current of converged solution
+  SNESComputeFunction ( snes, x, r0 );
+
+  for ( unsigned int j=0; j<N; ++j )
+    VecDestroy ( PetscDestroyObject(lambda[j]) );
+  VecDestroy ( PetscDestroyObject(r0) );
+  VecDestroy ( PetscDestroyObject(r) );
+
+  if ( Genius::processor_id() == 0 )
+  {
+    std::ofstream fout ( SolverSpecify::AdjointFile.c_str(), append ? std::ios::app : std::ios::trunc );
+
+    fout << "# electrode";
+    for ( unsigned int j=0; j<N; ++j )
+      fout << '\t' << electrodes[j]->electrode_label();
+    fout << '\n' << "# V(V)";
+    for ( unsigned int j=0; j<N; ++j )
+      fout << '\t' << electrodes[j]->ext_circuit()->potential()/PhysicalUnit::V;
+    fout << '\n';
+
+    fout << std::scientific << std::setprecision ( 8 );
+    fout << "# I(A)";
+    for ( unsigned int j=0; j<N; ++j )
+      fout << '\t' << I0[j]/PhysicalUnit::A;
+    fout << '\n';
+
+    // relative parameter gives dI/dln(p) in A, work function gives dI/dp in A/V
+    for ( unsigned int k=0; k<M; ++k )
+    {
+      if ( !valid[k] ) continue;
+      const PetscScalar unit = SolverSpecify::AdjointParameter[k].find ( "workfunction:" ) == 0 ?
+                               PhysicalUnit::A/PhysicalUnit::V : PhysicalUnit::A;
+      fout << SolverSpecify::AdjointParameter[k];
+      for ( unsigned int j=0; j<N; ++j )
+        fout << '\t' << G[k*N+j]/unit;
+      fout << '\n';
+    }
+    fout << '\n';
+  }
+}
+
+
+
+/*----------------------------------------------------------------------------
+ * adjoint of terminal current, J^T lambda = (dI/dx)^T
+ */
+void DDMSolverBase::adjoint_solve(const std::vector<BoundaryCondition *> &electrodes, std::vector<Vec> &lambda)
+{
+  VecDuplicate ( x, &pdI_pdx );
+  VecDuplicate ( x, &pdF_pdV );
+
+  VecScatterBegin ( scatter, x, lx, INSERT_VALUES, SCATTER_FORWARD );
+  VecScatterEnd   ( scatter, x, lx, INSERT_VALUES, SCATTER_FORWARD );
+
+  PetscInt row_begin, row_end;
+  MatGetOwnershipRange ( J, &row_begin, &row_end );
+
+  lambda.resize ( electrodes.size() );
+  for ( unsigned int j=0; j<electrodes.size(); ++j )
+  {
+    // the trace routine gives dI/dx, but also replaces the electrode row of jacobian, keep it
+    PetscInt row = electrodes[j]->global_offset();
+    std::vector<PetscInt>    cols;
+    std::vector<PetscScalar> values;
+    if ( row >= row_begin && row < row_end )
+    {
+      PetscInt ncols;
+      const PetscInt    *c;
+      const PetscScalar *v;
+      MatGetRow ( J, row, &ncols, &c, &v );
+      cols.assign ( c, c+ncols );
+      values.assign ( v, v+ncols );
+      MatRestoreRow ( J, row, &ncols, &c, &v );
+    }
+
+    this->set_trace_electrode ( electrodes[j] );
+
+    if ( !cols.empty() )
+      MatSetValues ( J, 1, &row, cols.size(), &cols[0], &values[0], INSERT_VALUES );
+    MatAssemblyBegin ( J, MAT_FINAL_ASSEMBLY );
+    MatAssemblyEnd   ( J, MAT_FINAL_ASSEMBLY );
+
+    VecDuplicate ( x, &lambda[j] );
+    KSPSolveTranspose ( ksp, pdI_pdx, lambda[j] );
+  }
+
+  VecDestroy ( PetscDestroyObject(pdI_pdx) );
+  VecDestroy ( PetscDestroyObject(pdF_pdV) );
+}
+
+
+
+/*----------------------------------------------------------------------------
+ * impedance field method. a local net doping dN at node i adds e*dN*V_i to the poisson residual,
+ * the green's function of terminal current is g_i = dI/dN_i = -e*V_i*lambda_psi_i.
+ * the dopant count in the control volume is poisson distributed, Var(N_i) = N_i/(V_i*W),
+ * so Cov(I_j, I_k) = sum_i g_ji*g_ki*N_i/(V_i*W). random samples take the gaussian limit of the count.
+ * ohmic nodes are excluded since their potential is fixed by boundary condition.
+ */
+void DDMSolverBase::impedance_field(bool append)
+{
+  BoundaryConditionCollector * bcs = _system.get_bcs();
+
+  std::vector<BoundaryCondition *> electrodes;
+  for ( unsigned int n=0; n<SolverSpecify::IFMCurrent.size(); ++n )
+    electrodes.push_back ( bcs->get_bc ( SolverSpecify::IFMCurrent[n] ) );
+
+  const unsigned int N = electrodes.size();
+  const unsigned int K = std::max ( SolverSpecify::IFMSamples, 0 );
+  const PetscScalar  W = electrodes[0]->z_width();
+
+  // electrode current is updated by function evaluation
+  Vec r;
+  VecDuplicate ( x, &r );
+  std::vector<PetscScalar> I0 ( N );
+  SNESComputeFunction ( snes, x, r );
+  for ( unsigned int j=0; j<N; ++j )
+    I0[j] = electrodes[j]->ext_circuit()->current();
+  Parallel::sum ( I0 );
+  VecDestroy ( PetscDestroyObject(r) );
+
+  std::vector<Vec> lambda;
+  this->adjoint_solve ( electrodes, lambda );
+
+  std::vector<PetscScalar *> ll ( N );
+  for ( unsigned int j=0; j<N; ++j )
+    VecGetArray ( lambda[j], &ll[j] );
+
+  // nodes of electrodes
+  std::set<const Node *> electrode_nodes;
+  for ( unsigned int n=0; n<bcs->n_bcs(); ++n )
+  {
+    const BoundaryCondition * bc = bcs->get_bc ( n );
+    if ( !bc->is_electrode() ) continue;
+    electrode_nodes.insert ( bc->nodes_begin(), bc->nodes_end() );
+  }
+
+  std::vector<PetscScalar> cov ( N*N, 0.0 );
+  std::vector<PetscScalar> dI ( K*N, 0.0 );
+  std::vector<PetscScalar> g ( N );
+  for ( unsigned int n=0; n<_system.n_regions(); n++ )
+  {
+    const SimulationRegion * region = _system.region ( n );
+    if ( region->type() != SemiconductorRegion ) continue;
+
+    SimulationRegion::const_processor_node_iterator it = region->on_processor_nodes_begin();
+    SimulationRegion::const_processor_node_iterator it_end = region->on_processor_nodes_end();
+    for ( ; it!=it_end; ++it )
+    {
+      const FVM_Node * fvm_node = *it;
+      if ( electrode_nodes.find ( fvm_node->root_node() ) != electrode_nodes.end() ) continue;
+
+      const PetscScalar volume = fvm_node->volume();
+      const PetscScalar var_N = fvm_node->node_data()->Total_doping()/( volume*W );
+
+      // we konw the fvm_node->local_offset() is psi in semiconductor region
+      for ( unsigned int j=0; j<N; ++j )
+        g[j] = -e*volume*ll[j][fvm_node->local_offset()];
+
+      for ( unsigned int j=0; j<N; ++j )
+        for ( unsigned int k=0; k<N; ++k )
+          cov[j*N+k] += g[j]*g[k]*var_N;
+
+      if ( K )
+      {
+        // the stream only depends on the node, not the partition
+        RandomStream rng ( ( static_cast<unsigned long long> ( SolverSpecify::IFMSeed ) << 32 ) ^
+                           ( fvm_node->root_node()->id()*0xD1B54A32D192ED03ULL ) );
+        const PetscScalar sigma_N = std::sqrt ( var_N );
+        for ( unsigned int s=0; s<K; ++s )
+        {
+          const PetscScalar dN = sigma_N*rng.normal();
+          for ( unsigned int j=0; j<N; ++j )
+            dI[s*N+j] += g[j]*dN;
+        }
+      }
+    }
+  }
+
+  for ( unsigned int j=0; j<N; ++j )
+  {
+    VecRestoreArray ( lambda[j], &ll[j] );
+    VecDestroy ( PetscDestroyObject(lambda[j]) );
+  }
+
+  Parallel::sum ( cov );
+  if ( K ) Parallel::sum ( dI );
+
+  if ( Genius::processor_id() == 0 )
+  {
+    std::ofstream fout ( SolverSpecify::IFMFile.c_str(), append ? std::ios::app : std::ios::trunc );
+
+    fout << "# electrode";
+    for ( unsigned int j=0; j<N; ++j )
+      fout << '\t' << electrodes[j]->electrode_label();
+    fout << '\n' << "# V(V)";
+    for ( unsigned int j=0; j<N; ++j )
+      fout << '\t' << electrodes[j]->ext_circuit()->potential()/PhysicalUnit::V;
+    fout << '\n';
+
+    fout << std::scientific << std::setprecision ( 8 );
+    fout << "# I(A)";
+    for ( unsigned int j=0; j<N; ++j )
+      fout << '\t' << I0[j]/PhysicalUnit::A;
+    fout << '\n' << "# sigma(A)";
+    for ( unsigned int j=0; j<N; ++j )
+      fout << '\t' << std::sqrt ( cov[j*N+j] )/PhysicalUnit::A;
+    fout << '\n' << "# covariance(A^2)\n";
+    for ( unsigned int j=0; j<N; ++j )
+    {
+      for ( unsigned int k=0; k<N; ++k )
+        fout << ( k ? "\t" : "" ) << cov[j*N+k]/( PhysicalUnit::A*PhysicalUnit::A );
+      fout << '\n';
+    }
+
+    if ( K )
+    {
+      fout << "# samples of I(A)\n";
+      for ( unsigned int s=0; s<K; ++s )
+      {
+        for ( unsigned int j=0; j<N; ++j )
+          fout << ( j ? "\t" : "" ) << ( I0[j] + dI[s*N+j] )/PhysicalUnit::A;
+        fout << '\n';
+      }
+    }
+    fout << '\n';
+  }
+}
+
+
+
+PetscScalar DDMSolverBase::adjoint_perturb(const std::string &param, bool revert)
+{
+  // relative step of doping, trap density and pmi parameter
+  const PetscScalar h = 1e-6;
+  const PetscScalar factor = revert ? 1.0/( 1.0+h ) : 1.0+h;
+
+  std::vector<std::string> tokens;
+  {
+    std::string::size_type begin = 0, end;
+    while ( ( end = param.find ( ':', begin ) ) != std::string::npos )
+    {
+      tokens.push_back ( param.substr ( begin, end-begin ) );
+      begin = end+1;
+    }
+    tokens.push_back ( param.substr ( begin ) );
+  }
+
+  // work function of gate or schottky electrode, absolute step
+  if ( tokens[0] == "workfunction" && tokens.size() == 2 )
+  {
+    BoundaryCondition * bc = _system.get_bcs()->get_bc ( tokens[1] );
+    if ( bc == NULL || !bc->has_scalar ( "workfunction" ) ) return 0.0;
+    const PetscScalar dW = h*PhysicalUnit::V;
+    bc->scalar ( "workfunction" ) += revert ? -dW : dW;
+    return dW;
+  }
+
+  if ( tokens.size() < 2 ) return 0.0;
+  SimulationRegion * region = _system.region ( tokens[1] );
+  if ( region == NULL || region->type() != SemiconductorRegion ) return 0.0;
+  Material::MaterialSemiconductor * mt = static_cast<SemiconductorSimulationRegion *> ( region )->material();
+
+  // all the doping of region, including ghost nodes
+  if ( tokens[0] == "doping" && tokens.size() == 2 )
+  {
+    SimulationRegion::local_node_iterator node_it = region->on_local_nodes_begin();
+    SimulationRegion::local_node_iterator node_it_end = region->on_local_nodes_end();
+    for ( ; node_it!=node_it_end; ++node_it )
+    {
+      FVM_NodeData * node_data = ( *node_it )->node_data();
+      node_data->Na() *= factor;
+      node_data->Nd() *= factor;
+    }
+    return h;
+  }
+
+  // all the traps of region
+  if ( tokens[0] == "trap" && tokens.size() == 2 )
+    return mt->trap->ScaleDensity ( factor ) ? h : 0.0;
+
+  // real parameter of a PMI model
+  if ( tokens[0] == "pmi" && tokens.size() == 4 )
+  {
+    PMIS_Server * pmi = NULL;
+    if ( tokens[2] == "basic" )    pmi = mt->basic;
+    if ( tokens[2] == "band" )     pmi = mt->band;
+    if ( tokens[2] == "mobility" ) pmi = mt->mob;
+    if ( tokens[2] == "impact" )   pmi = mt->gen;
+    if ( tokens[2] == "thermal" )  pmi = mt->thermal;
+    if ( tokens[2] == "trap" )     pmi = mt->trap;
+    if ( pmi == NULL ) return 0.0;
+
+    std::map<std::string, PARA> & parameters = pmi->get_parameter_info();
+    std::map<std::string, PARA>::iterator it = parameters.find ( tokens[3] );
+    if ( it == parameters.end() || it->second.type != PARA::Real ) return 0.0;
+    *( ( PetscScalar * ) it->second.value ) *= factor;
+    pmi->post_calibrate_process();
+    return h;
+  }
+
+  return 0.0;
+}
@@ -0,0 +1,268 @@
+/********************************************************************************/
+/*     888888    888888888   88     888  88888   888      888    88888888       */
+/*   8       8   8           8 8     8     8      8        8    8               */
+/*  8            8           8  8    8     8      8        8    8               */
+/*  8            888888888   8   8   8     8      8        8     8888888        */
+/*  8      8888  8           8    8  8     8      8        8            8       */
+/*   8       8   8           8     8 8     8      8        8            8       */
+/*     888888    888888888  888     88   88888     88888888     88888888        */
+/*                                                                              */
+/*       A Three-Dimensional General Purpose Semiconductor Simulator.           */
+/*                                                                              */
+/*                                                                              */
+/*  Copyright (C) 2007-2008                                                     */
+/*  Cogenda Pte Ltd                                                             */
+/*                                                                              */
+/*  Please contact Cogenda Pte Ltd for license information                      */
+/*                                                                              */
+/*  Author: Gong Ding   gdiso@ustc.edu                                          */
+/*                                                                              */
+/********************************************************************************/
+
+#include <iomanip>
+
+#include "solver_specify.h"
+#include "physical_unit.h"
+#include "ddm_solver.h"
+#include "parallel.h"
+
+
+extern "C"
+{
+  //---------------------------------------------------------------
+  // this function is called by PETSc to apply I - M of shooting method
+  static PetscErrorCode  __genius_petsc_shooting_mult (Mat mat, Vec x, Vec y)
+  {
+    void * ctx;
+    MatShellGetContext(mat, &ctx);
+
+    DDMSolverBase * solver = (DDMSolverBase *)ctx;
+    solver->shooting_mult(x, y);
+
+    return 0;
+  }
+}
+
+
+/*----------------------------------------------------------------------------
+ * periodic steady state by shooting newton method.
+ * with x(T) = phi(x0) the transient of one period, we solve phi(x0) - x0 = 0,
+ * the newton equation (I - M) dx0 = phi(x0) - x0 is solved by matrix free GMRES.
+ * M = dphi/dx0 is applied by the sensitivity recursion of the recorded steps,
+ *   BDF1:  J_k s_k = C s_{k-1} / dt
+ *   BDF2:  J_k s_k = C (b s_{k-1} - c s_{k-2}) / h
+ * which only takes a back-substitution of the factored jacobian of each step.
+ */
+int DDMSolverBase::solve_transient_shooting()
+{
+  const PetscScalar t_start = SolverSpecify::TStart;
+  const PetscScalar t_stop  = SolverSpecify::TStop;
+  const PetscScalar period  = SolverSpecify::ShootingPeriod;
+
+  MESSAGE<<"Periodic steady state by shooting method, period "<<period/PhysicalUnit::s<<" s\n\n";
+  RECORD();
+
+  PetscErrorCode ierr;
+
+  Vec r, dx;
+  ierr = VecDuplicate(x, &_shooting_x0); genius_assert(!ierr);
+  ierr = VecDuplicate(x, &r); genius_assert(!ierr);
+  ierr = VecDuplicate(x, &dx); genius_assert(!ierr);
+
+  // GMRES with matrix free I - M, which is close to identity for dissipative device
+  PetscInt m, M;
+  ierr = VecGetLocalSize(x, &m); genius_assert(!ierr);
+  ierr = VecGetSize(x, &M); genius_assert(!ierr);
+
+  Mat A;
+  KSP ksp_shooting;
+  PC  pc_shooting;
+  ierr = MatCreateShell(PETSC_COMM_WORLD, m, m, M, M, (void *)this, &A); genius_assert(!ierr);
+  ierr = MatShellSetOperation(A, MATOP_MULT, (void(*)(void))__genius_petsc_shooting_mult); genius_assert(!ierr);
+  ierr = KSPCreate(PETSC_COMM_WORLD, &ksp_shooting); genius_assert(!ierr);
+  ierr = KSPSetType(ksp_shooting, KSPGMRES); genius_assert(!ierr);
+  ierr = KSPSetOperators(ksp_shooting, A, A, SAME_PRECONDITIONER); genius_assert(!ierr);
+  ierr = KSPGetPC(ksp_shooting, &pc_shooting); genius_assert(!ierr);
+  ierr = PCSetType(pc_shooting, (char*) PCNONE); genius_assert(!ierr);
+  ierr = KSPSetTolerances(ksp_shooting, SolverSpecify::ShootingKSPRelTol, 1e-30, PETSC_DEFAULT, 50); genius_assert(!ierr);
+  ierr = KSPSetOptionsPrefix(ksp_shooting, "shooting_"); genius_assert(!ierr);
+  ierr = KSPSetFromOptions(ksp_shooting); genius_assert(!ierr);
+
+  bool converged = false;
+  for(unsigned int its=0; its<=SolverSpecify::ShootingMaxIteration; ++its)
+  {
+    MESSAGE<<"Shooting iteration "<<its<<'\n'
+    <<"--------------------------------------------------------------------------------\n";
+    RECORD();
+
+    // integrate one period from the state held by system
+    SolverSpecify::TStart = t_start;
+    SolverSpecify::TStop  = t_start + period;
+    _shooting_record = true;
+    solve_transient();
+    _shooting_record = false;
+
+    // periodicity error, scaled by the tolerance of LTE
+    ierr = VecDuplicate(x, &LTE); genius_assert(!ierr);
+    VecWAXPY(LTE, -1.0, _shooting_x0, x);
+    VecCopy(LTE, r);
+    PetscReal error = variable_LTE_norm();
+    VecDestroy(PetscDestroyObject(LTE));
+
+    MESSAGE<<"------> periodicity error "<<std::scientific<<std::setprecision(3)<<error<<" over "<<_shooting_steps.size()<<" steps\n\n";
+    RECORD();
+
+    if( error <= 1.0 ) { converged = true; break; }
+    if( its == SolverSpecify::ShootingMaxIteration ) break;
+
+    // newton correction of the initial state
+    KSPSolve(ksp_shooting, r, dx);
+
+    KSPConvergedReason reason;
+    PetscInt lits;
+    KSPGetConvergedReason(ksp_shooting, &reason);
+    KSPGetIterationNumber(ksp_shooting, &lits);
+    MESSAGE<<"------> monodromy GMRES "<<KSPConvergedReasons[reason]<<", iteration "<<lits<<"\n\n\n";
+    RECORD();
+
+    VecAXPY(_shooting_x0, 1.0, dx);
+    this->projection_positive_density_check(_shooting_x0, x);
+
+    // the next period starts from the corrected state
+    flush_system(_shooting_x0);
+    shooting_clear_steps();
+  }
+
+  MESSAGE<<"Shooting method "<<(converged ? "reached periodic steady state" : "did not converge")<<".\n\n\n";
+  RECORD();
+
+  shooting_clear_steps();
+  KSPDestroy(PetscDestroyObject(ksp_shooting));
+  MatDestroy(PetscDestroyObject(A));
+  VecDestroy(PetscDestroyObject(r));
+  VecDestroy(PetscDestroyObject(dx));
+  VecDestroy(PetscDestroyObject(_shooting_x0));
+  _shooting_x0 = PETSC_NULL;
+
+  SolverSpecify::TStart = t_start;
+  SolverSpecify::TStop  = t_stop;
+
+  return 0;
+}
+
+
+
+void DDMSolverBase::shooting_record_step()
+{
+  PetscErrorCode ierr;
+
+  // jacobian at the accepted solution, the one left by SNES is at the last iterate or lagged
+  build_petsc_sens_jacobian(x, &J, &J);
+
+  // coefficient of time derivative, taken from the jacobian with and without the time derivative.
+  // the first step is always first order, where the time derivative term contributes C/dt
+  if( _shooting_C == PETSC_NULL )
+  {
+    ierr = MatDuplicate(J, MAT_COPY_VALUES, &_shooting_C); genius_assert(!ierr);
+    SolverSpecify::TimeDependent = false;
+    build_petsc_sens_jacobian(x, &J, &J);
+    SolverSpecify::TimeDependent = true;
+    ierr = MatAXPY(_shooting_C, -1.0, J, SAME_NONZERO_PATTERN); genius_assert(!ierr);
+    ierr = MatScale(_shooting_C, SolverSpecify::dt); genius_assert(!ierr);
+    build_petsc_sens_jacobian(x, &J, &J);
+  }
+
+  ShootingStep step;
+  step.dt      = SolverSpecify::dt;
+  step.dt_last = SolverSpecify::dt_last;
+  step.bdf2    = SolverSpecify::TS_type==SolverSpecify::BDF2 && SolverSpecify::BDF2_LowerOrder==false;
+  ierr = MatDuplicate(J, MAT_COPY_VALUES, &step.J); genius_assert(!ierr);
+
+  // the linear solver follows the one of nonlinear solver, the factorization is kept for the monodromy
+  const char * ksp_type = PETSC_NULL;
+  const char * pc_type  = PETSC_NULL;
+  PC step_pc;
+  ierr = KSPGetType ( ksp, &ksp_type );  genius_assert ( !ierr );
+  ierr = PCGetType ( pc, &pc_type );  genius_assert ( !ierr );
+  ierr = KSPCreate ( PETSC_COMM_WORLD, &step.ksp );  genius_assert ( !ierr );
+  ierr = KSPGetPC ( step.ksp, &step_pc );  genius_assert ( !ierr );
+  ierr = KSPSetType ( step.ksp, ksp_type );  genius_assert ( !ierr );
+  ierr = PCSetType ( step_pc, pc_type );  genius_assert ( !ierr );
+  if ( std::string ( pc_type ) == PCLU || std::string ( pc_type ) == PCCHOLESKY )
+  {
+    const char * package = PETSC_NULL;
+    ierr = PCFactorGetMatSolverPackage ( pc, &package );  genius_assert ( !ierr );
+    ierr = PCFactorSetMatSolverPackage ( step_pc, package );  genius_assert ( !ierr );
+  }
+  ierr = KSPSetOperators ( step.ksp, step.J, step.J, SAME_NONZERO_PATTERN );  genius_assert ( !ierr );
+  ierr = KSPSetOptionsPrefix ( step.ksp, "shooting_step_" );  genius_assert ( !ierr );
+  ierr = KSPSetTolerances ( step.ksp, 1e-10, SolverSpecify::ksp_atol, PETSC_DEFAULT, PETSC_DEFAULT );  genius_assert ( !ierr );
+  ierr = KSPSetFromOptions ( step.ksp );  genius_assert ( !ierr );
+  ierr = KSPSetUp ( step.ksp );  genius_assert ( !ierr );
+
+  _shooting_steps.push_back(step);
+}
+
+
+
+void DDMSolverBase::shooting_clear_steps()
+{
+  for(unsigned int k=0; k<_shooting_steps.size(); ++k)
+  {
+    KSPDestroy(PetscDestroyObject(_shooting_steps[k].ksp));
+    MatDestroy(PetscDestroyObject(_shooting_steps[k].J));
+  }
+  _shooting_steps.clear();
+
+  if( _shooting_C != PETSC_NULL )
+  {
+    MatDestroy(PetscDestroyObject(_shooting_C));
+    _shooting_C = PETSC_NULL;
+  }
+}
+
+
+
+void DDMSolverBase::shooting_mult(Vec v, Vec y)
+{
+  // s1 and s2 hold the sensitivity of the last two steps
+  Vec s1, s2, w, b;
+  VecDuplicate(v, &s1);
+  VecDuplicate(v, &s2);
+  VecDuplicate(v, &w);
+  VecDuplicate(v, &b);
+
+  VecCopy(v, s1);
+  VecZeroEntries(s2);
+
+  for(unsigned int k=0; k<_shooting_steps.size(); ++k)
+  {
+    const ShootingStep & step = _shooting_steps[k];
+    if( step.bdf2 )
+    {
+      const PetscScalar h  = step.dt_last + step.dt;
+      const PetscScalar rr = step.dt_last/h;
+      VecCopy(s1, w);
+      VecScale(w, 1.0/(rr*(1-rr)*h));
+      VecAXPY(w, -(1-rr)/(rr*h), s2);
+    }
+    else
+    {
+      VecCopy(s1, w);
+      VecScale(w, 1.0/step.dt);
+    }
+    MatMult(_shooting_C, w, b);
+
+    // s2 <- s1, s1 <- s_k
+    VecCopy(s1, s2);
+    KSPSolve(step.ksp, b, s1);
+  }
+
+  // y = v - M v
+  VecWAXPY(y, -1.0, s1, v);
+
+  VecDestroy(PetscDestroyObject(s1));
+  VecDestroy(PetscDestroyObject(s2));
+  VecDestroy(PetscDestroyObject(w));
+  VecDestroy(PetscDestroyObject(b));
+}
@@ -22,14 +22,19 @@
 //  $Id: ddm_solver.cc,v 1.11 2008/07/09 05:58:16 gdiso Exp $
 #include <iomanip>
 #include <stack>
+#include <fstream>
+#include <algorithm>
 
 #include "solver_specify.h"
 #include "physical_unit.h"
 #include "electrical_source.h"
 #include "resistance_region.h"
 #include "field_source.h"
+#include "transient_breakpoints.h"
 #include "ddm_solver.h"
+#include "solution_cache.h"
 #include "parallel.h"
+#include "solver_counters.h"
 #include "MXMLUtil.h"
 
 
@@ -39,7 +44,8 @@ using PhysicalUnit::W;
 using PhysicalUnit::C;
 
 
-DDMSolverBase::DDMSolverBase(SimulationSystem & system): FVM_NonlinearSolver(system)
+DDMSolverBase::DDMSolverBase(SimulationSystem & system): FVM_NonlinearSolver(system),
+  _x_history_valid(false), _shooting_record(false), _shooting_C(PETSC_NULL), _shooting_x0(PETSC_NULL)
 {
   // do clear
   potential_norm            = 0.0;
@@ -71,6 +77,27 @@ int DDMSolverBase::create_solver()
   // must setup nonlinear contex here!
   setup_nonlinear_data();
 
+  // the local offsets of each variable are fixed from now on
+  for(unsigned int v=0; v<NormVariables; ++v)
+  {
+    norm_index[v].clear();
+    norm_divisor[v].clear();
+  }
+  lte_index.clear();
+  build_norm_index();
+
+  semiconductor_offset.clear();
+  for(unsigned int n=0; n<_system.n_regions(); n++)
+  {
+    const SimulationRegion * region = _system.region(n);
+    if( region->type() != SemiconductorRegion ) continue;
+
+    SimulationRegion::const_processor_node_iterator it = region->on_processor_nodes_begin();
+    SimulationRegion::const_processor_node_iterator it_end = region->on_processor_nodes_end();
+    for(; it!=it_end; ++it)
+      semiconductor_offset.push_back((*it)->local_offset());
+  }
+
   //NOTE Tolerances here only be set as a reference
 
   //abstol = 1e-15                  - absolute convergence tolerance
@@ -89,6 +116,131 @@ int DDMSolverBase::create_solver()
 }
 
 
+void DDMSolverBase::variable_error_norm(bool electrode)
+{
+  PetscScalar    *xx;
+  PetscScalar    *ff;
+
+  // scatte global function vector f to local vector lf
+  // lx had already been scattered in function evaluation
+  VecScatterBegin(scatter, f, lf, INSERT_VALUES, SCATTER_FORWARD);
+  VecScatterEnd  (scatter, f, lf, INSERT_VALUES, SCATTER_FORWARD);
+
+  VecGetArray(lx, &xx);  // solution value
+  VecGetArray(lf, &ff);  // function value
+
+  // x norms, f norms and electrode norm
+  std::vector<PetscScalar> norm_buffer(2*NormVariables+1, 0.0);
+
+  for(unsigned int v=0; v<NormVariables; ++v)
+  {
+    const std::vector<unsigned int> & index = norm_index[v];
+    const std::vector<unsigned int> & divisor = norm_divisor[v];
+    const size_t size = index.size();
+
+    PetscScalar x_norm = 0, f_norm = 0;
+    if( divisor.empty() )
+    {
+      for(size_t i=0; i<size; ++i)
+      {
+        const PetscScalar xv = xx[index[i]];
+        const PetscScalar fv = ff[index[i]];
+        x_norm += xv*xv;
+        f_norm += fv*fv;
+      }
+    }
+    else
+    {
+      for(size_t i=0; i<size; ++i)
+      {
+        const PetscScalar xv = xx[index[i]]/xx[divisor[i]];
+        const PetscScalar fv = ff[index[i]];
+        x_norm += xv*xv;
+        f_norm += fv*fv;
+      }
+    }
+    norm_buffer[v] = x_norm;
+    norm_buffer[NormVariables+v] = f_norm;
+  }
+
+  if( electrode && Genius::is_last_processor() )
+  {
+    for(unsigned int b=0; b<_system.get_bcs()->n_bcs(); b++)
+    {
+      const BoundaryCondition * bc = _system.get_bcs()->get_bc(b);
+      unsigned int offset = bc->local_offset();
+      if( offset != invalid_uint )
+      {
+        norm_buffer[NormPotential] += xx[offset]*xx[offset];
+
+        PetscScalar scaling = 1.0;
+        if(bc->is_electrode())
+          scaling = bc->ext_circuit()->mna_scaling(SolverSpecify::dt);
+
+        norm_buffer[2*NormVariables] += scaling*ff[offset]*scaling*ff[offset];
+      }
+    }
+  }
+
+  VecRestoreArray(lx, &xx);
+  VecRestoreArray(lf, &ff);
+
+  // sum of variable value on all processors
+  Parallel::sum(norm_buffer);
+
+  // sqrt to get L2 norm
+  potential_norm            = sqrt(norm_buffer[NormPotential]);
+  electron_norm             = sqrt(norm_buffer[NormElectron]);
+  hole_norm                 = sqrt(norm_buffer[NormHole]);
+  temperature_norm          = sqrt(norm_buffer[NormTemperature]);
+  elec_temperature_norm     = sqrt(norm_buffer[NormElecTemperature]);
+  hole_temperature_norm     = sqrt(norm_buffer[NormHoleTemperature]);
+
+  poisson_norm              = sqrt(norm_buffer[NormVariables+NormPotential]);
+  elec_continuity_norm      = sqrt(norm_buffer[NormVariables+NormElectron]);
+  hole_continuity_norm      = sqrt(norm_buffer[NormVariables+NormHole]);
+  heat_equation_norm        = sqrt(norm_buffer[NormVariables+NormTemperature]);
+  elec_energy_equation_norm = sqrt(norm_buffer[NormVariables+NormElecTemperature]);
+  hole_energy_equation_norm = sqrt(norm_buffer[NormVariables+NormHoleTemperature]);
+  electrode_norm            = sqrt(norm_buffer[2*NormVariables]);
+}
+
+
+PetscReal DDMSolverBase::variable_LTE_norm()
+{
+  // relative error
+  PetscReal eps_r = SolverSpecify::TS_rtol;
+  // abs error
+  PetscReal eps_a = SolverSpecify::TS_atol;
+
+  PetscScalar    *xx, *ll;
+  VecGetArray(x, &xx);
+  VecGetArray(LTE, &ll);
+
+  // squared sum of scaled LTE and the number of variables
+  std::vector<PetscScalar> lte_buffer(2, 0.0);
+  const size_t size = lte_index.size();
+  for(size_t i=0; i<size; ++i)
+  {
+    const unsigned int k = lte_index[i];
+    const PetscScalar e = ll[k]/(eps_r*std::abs(xx[k])+eps_a);
+    lte_buffer[0] += e*e;
+  }
+  lte_buffer[1] = static_cast<PetscScalar>(size);
+
+  VecRestoreArray(x, &xx);
+  VecRestoreArray(LTE, &ll);
+
+  //for parallel situation, sum over all the processor in one reduction
+  Parallel::sum(lte_buffer);
+
+  if( lte_buffer[1]>0 )
+    return sqrt(lte_buffer[0]/lte_buffer[1]);
+
+  return 1.0;
+}
+
+
 int DDMSolverBase::post_solve_process()
 {
   mxml_node_t *eSolution = new_dom_solution_elem();
@@ -100,6 +252,7 @@ int DDMSolverBase::post_solve_process()
     switch (SolverSpecify::Type)
     {
         case SolverSpecify::TRANSIENT:
+        case SolverSpecify::HARMONIC:
         {
           mxml_node_t *eTime = mxmlNewElement(eLabel, "time");
           mxmlAdd(eTime, MXML_ADD_AFTER, NULL, MXMLQVariant::makeQVFloat(SolverSpecify::clock / PhysicalUnit::s));
@@ -232,13 +385,19 @@ int DDMSolverBase::solve_steadystate()
     // here call Petsc to solve the nonlinear equations
     sens_solve();
 
-    // call post_solve_process
-    this->post_solve_process();
-
     // get the converged reason
     SNESConvergedReason reason;
     SNESGetConvergedReason ( snes, &reason );
 
+    // adjoint sensitivity and impedance field with the factored jacobian of converged solution
+    if ( reason>0 && !SolverSpecify::AdjointCurrent.empty() )
+      this->adjoint_sensitivity ( false );
+    if ( reason>0 && !SolverSpecify::IFMCurrent.empty() )
+      this->impedance_field ( false );
+
+    // call post_solve_process
+    this->post_solve_process();
+
     // linear solver iteration
     PetscInt lits;
     SNESGetLinearSolveIterations(snes, &lits);
@@ -269,6 +428,9 @@ int DDMSolverBase::solve_dcsweep()
   // set electrode with transient time 0 value of stimulate source(s)
   _system.get_electrical_source()->update ( 0 );
 
+  // reuse the factored jacobian for several Newton iterations
+  set_jacobian_lag(SolverSpecify::NSLagJacobian);
+
   // not time dependent
   SolverSpecify::TimeDependent = false;
   SolverSpecify::dt = 1e100;
@@ -299,6 +461,11 @@ int DDMSolverBase::solve_dcsweep()
 
   PetscInt total_lits = 0;
 
+  // on-disk cache of converged points
+  AutoPtr<SolutionCache> cache;
+  if ( !SolverSpecify::SolutionCachePrefix.empty() )
+    cache.reset ( new SolutionCache ( _system, SolverSpecify::SolutionCachePrefix ) );
+
   // voltage scan
   if ( SolverSpecify::Electrode_VScan.size() )
   {
@@ -331,6 +498,10 @@ int DDMSolverBase::solve_dcsweep()
       _system.get_electrical_source()->assign_voltage_to ( SolverSpecify::Electrode_VScan, Vscan );
       _system.get_field_source()->update ( 0, SolverSpecify::SourceCoupled );
 
+      // start from the nearest cached point
+      if ( SolverSpecify::DC_Cycles == 0 && cache.get() )
+        cache->load_nearest();
+
       // call pre_solve_process
       if ( SolverSpecify::DC_Cycles == 0 )
         this->pre_solve_process();
@@ -351,10 +522,24 @@ int DDMSolverBase::solve_dcsweep()
 
       if ( reason>0 ) //ok, converged.
       {
+        // small signal matrix with the factored jacobian of this bias point
+        if ( !SolverSpecify::SmallSignalFile.empty() )
+          this->small_signal_extract();
+
+        // adjoint sensitivity of this bias point
+        if ( !SolverSpecify::AdjointCurrent.empty() )
+          this->adjoint_sensitivity ( SolverSpecify::DC_Cycles > 0 );
+
+        // current variability of this bias point
+        if ( !SolverSpecify::IFMCurrent.empty() )
+          this->impedance_field ( SolverSpecify::DC_Cycles > 0 );
 
         // call post_solve_process
         this->post_solve_process();
 
+        if ( cache.get() )
+          cache->store();
+
         SolverSpecify::DC_Cycles++;
 
         // save solution for linear/quadratic projection
@@ -441,7 +626,14 @@ int DDMSolverBase::solve_dcsweep()
         PetscScalar hn1 = Vs1-Vs2;
         PetscScalar hn2 = Vs2-Vs3;
 
-        if ( SolverSpecify::DC_Cycles>=3 )
+        if ( SolverSpecify::PredictTangent && reason>0 &&
+             (Vscan*SolverSpecify::VStep) <= SolverSpecify::VStop*SolverSpecify::VStep* ( 1.0+1e-7 ) )
+        {
+          // first order predictor with sensitivity dx/dV
+          _system.get_electrical_source()->assign_voltage_to ( SolverSpecify::Electrode_VScan, Vscan );
+          this->tangent_predict ( xs1 );
+        }
+        else if ( SolverSpecify::DC_Cycles>=3 )
         {
           // quadradic projection
           PetscScalar cn=hn* ( hn+2*hn1+hn2 ) / ( hn1* ( hn1+hn2 ) );
@@ -503,6 +695,10 @@ int DDMSolverBase::solve_dcsweep()
       _system.get_electrical_source()->assign_current_to ( SolverSpecify::Electrode_IScan, Iscan );
       _system.get_field_source()->update ( 0, SolverSpecify::SourceCoupled );
 
+      // start from the nearest cached point
+      if ( SolverSpecify::DC_Cycles == 0 && cache.get() )
+        cache->load_nearest();
+
       // call pre_solve_process
       if ( SolverSpecify::DC_Cycles == 0 )
         this->pre_solve_process();
@@ -521,10 +717,24 @@ int DDMSolverBase::solve_dcsweep()
 
       if ( reason>0 ) //ok, converged.
       {
+        // small signal matrix with the factored jacobian of this bias point
+        if ( !SolverSpecify::SmallSignalFile.empty() )
+          this->small_signal_extract();
+
+        // adjoint sensitivity of this bias point
+        if ( !SolverSpecify::AdjointCurrent.empty() )
+          this->adjoint_sensitivity ( SolverSpecify::DC_Cycles > 0 );
+
+        // current variability of this bias point
+        if ( !SolverSpecify::IFMCurrent.empty() )
+          this->impedance_field ( SolverSpecify::DC_Cycles > 0 );
 
         // call post_solve_process
         this->post_solve_process();
 
+        if ( cache.get() )
+          cache->store();
+
         SolverSpecify::DC_Cycles++;
 
         // save solution for linear/quadratic projection
@@ -608,7 +818,14 @@ int DDMSolverBase::solve_dcsweep()
         PetscScalar hn1 = Is1-Is2;
         PetscScalar hn2 = Is2-Is3;
 
-        if ( SolverSpecify::DC_Cycles>=3 )
+        if ( SolverSpecify::PredictTangent && reason>0 &&
+             (Iscan*SolverSpecify::IStep) <= SolverSpecify::IStop*SolverSpecify::IStep* ( 1.0+1e-7 ) )
+        {
+          // first order predictor with sensitivity dx/dI
+          _system.get_electrical_source()->assign_current_to ( SolverSpecify::Electrode_IScan, Iscan );
+          this->tangent_predict ( xs1 );
+        }
+        else if ( SolverSpecify::DC_Cycles>=3 )
         {
           // quadradic projection
           PetscScalar cn=hn* ( hn+2*hn1+hn2 ) / ( hn1* ( hn1+hn2 ) );
@@ -635,6 +852,7 @@ int DDMSolverBase::solve_dcsweep()
     VecDestroy ( PetscDestroyObject(xs3) );
   }
 
+  set_jacobian_lag(1);
 
   SolverSpecify::tran_histroy = false;
 
@@ -838,6 +1056,146 @@ int DDMSolverBase::solve_op()
 
 
 
+/**
+ * first order predictor of DC sweep
+ */
+void DDMSolverBase::tangent_predict(Vec x_ref)
+{
+  Vec r, dx;
+  VecDuplicate ( x, &r );
+  VecDuplicate ( x, &dx );
+
+  // residual of converged solution with new bias, it is about dF/dV*dV
+  SNESComputeFunction ( snes, x, r );
+
+  // the KSP still holds the jacobian of last newton iteration, only back-substitution is needed
+  KSPSolve ( ksp, r, dx );
+
+  VecAXPY ( x, -1.0, dx );
+  this->projection_positive_density_check ( x, x_ref );
+
+  VecDestroy ( PetscDestroyObject(r) );
+  VecDestroy ( PetscDestroyObject(dx) );
+}
+
+
+
+void DDMSolverBase::small_signal_extract()
+{
+  BoundaryConditionCollector * bcs = _system.get_bcs();
+
+  std::vector<BoundaryCondition *> electrodes;
+  for ( unsigned int n=0; n<bcs->n_bcs(); ++n )
+  {
+    BoundaryCondition * bc = bcs->get_bc ( n );
+    if ( bc->is_electrode() && !bc->is_inter_connect_bc() && bc->ext_circuit()->is_voltage_driven() )
+      electrodes.push_back ( bc );
+  }
+  if ( electrodes.empty() ) return;
+
+  const unsigned int N = electrodes.size();
+
+  // the residual is linear in bias, the perturbation only limits the error of dI and dQ
+  const PetscScalar dV = 1e-5*PhysicalUnit::V;
+
+  Vec r0, r, dx, xk;
+  VecDuplicate ( x, &r0 );
+  VecDuplicate ( x, &r );
+  VecDuplicate ( x, &dx );
+  VecDuplicate ( x, &xk );
+
+  std::vector<PetscScalar> I0 ( N ), Q0 ( N ), I ( N ), Q ( N );
+  std::vector<PetscScalar> G ( N*N ), C ( N*N );
+
+  // electrode current is updated by function evaluation, electrode charge is evaluated from local solution
+  SNESComputeFunction ( snes, x, r0 );
+  this->electrode_current_charge ( electrodes, x, I0, Q0 );
+
+  for ( unsigned int k=0; k<N; ++k )
+  {
+    // dF/dV*dV of electrode k
+    electrodes[k]->ext_circuit()->Vapp() += dV;
+    SNESComputeFunction ( snes, x, r );
+    electrodes[k]->ext_circuit()->Vapp() -= dV;
+    VecAXPY ( r, -1.0, r0 );
+
+    // the KSP still holds the factored jacobian, each electrode is one back-substitution
+    KSPSolve ( ksp, r, dx );
+    VecWAXPY ( xk, -1.0, dx, x );
+
+    SNESComputeFunction ( snes, xk, r );
+    this->electrode_current_charge ( electrodes, xk, I, Q );
+
+    for ( unsigned int j=0; j<N; ++j )
+    {
+      G[j*N+k] = ( I[j] - I0[j] ) /dV;
+      C[j*N+k] = ( Q[j] - Q0[j] ) /dV;
+    }
+  }
+
+  // restore electrode current of converged solution
+  SNESComputeFunction ( snes, x, r0 );
+
+  VecDestroy ( PetscDestroyObject(r0) );
+  VecDestroy ( PetscDestroyObject(r) );
+  VecDestroy ( PetscDestroyObject(dx) );
+  VecDestroy ( PetscDestroyObject(xk) );
+
+  if ( Genius::processor_id() == 0 )
+  {
+    // the first point of the sweep starts a new file
+    std::ofstream fout ( SolverSpecify::SmallSignalFile.c_str(),
+                         SolverSpecify::DC_Cycles == 0 ? std::ios::trunc : std::ios::app );
+
+    fout << "# electrode";
+    for ( unsigned int j=0; j<N; ++j )
+      fout << '\t' << electrodes[j]->electrode_label();
+    fout << '\n' << "# V(V)";
+    for ( unsigned int j=0; j<N; ++j )
+      fout << '\t' << electrodes[j]->ext_circuit()->Vapp()/PhysicalUnit::V;
+    fout << '\n';
+
+    fout << std::scientific << std::setprecision ( 8 );
+    fout << "# G(A/V)\n";
+    for ( unsigned int j=0; j<N; ++j )
+    {
+      for ( unsigned int k=0; k<N; ++k )
+        fout << ( k ? "\t" : "" ) << G[j*N+k]/( PhysicalUnit::A/PhysicalUnit::V );
+      fout << '\n';
+    }
+    fout << "# C(F)\n";
+    for ( unsigned int j=0; j<N; ++j )
+    {
+      for ( unsigned int k=0; k<N; ++k )
+        fout << ( k ? "\t" : "" ) << C[j*N+k]/( PhysicalUnit::C/PhysicalUnit::V );
+      fout << '\n';
+    }
+    fout << '\n';
+  }
+}
+
+
+void DDMSolverBase::electrode_current_charge ( const std::vector<BoundaryCondition *> &electrodes, Vec v,
+                                               std::vector<PetscScalar> &I, std::vector<PetscScalar> &Q )
+{
+  VecScatterBegin ( scatter, v, lx, INSERT_VALUES, SCATTER_FORWARD );
+  VecScatterEnd   ( scatter, v, lx, INSERT_VALUES, SCATTER_FORWARD );
+
+  PetscScalar *lxx;
+  VecGetArray ( lx, &lxx );
+  for ( unsigned int j=0; j<electrodes.size(); ++j )
+  {
+    I[j] = electrodes[j]->ext_circuit()->current();
+    Q[j] = electrodes[j]->electrode_charge ( lxx );
+  }
+  VecRestoreArray ( lx, &lxx );
+
+  // on processor parts
+  Parallel::sum ( I );
+  Parallel::sum ( Q );
+}
+
+
 /**
  * create ksp solver for trace mode
  */
@@ -1175,11 +1533,22 @@ trace_end:
 }
 
 
+bool DDMSolverBase::restore_from_history()
+{
+  if ( !_x_history_valid ) return false;
+  VecCopy ( x_n, x );
+  return true;
+}
+
+
 /*----------------------------------------------------------------------------
  * transient simulation!
  */
 int DDMSolverBase::solve_transient()
 {
+  // periodic steady state, the shooting method comes back here for each period
+  if ( SolverSpecify::Shooting && !_shooting_record )
+    return solve_transient_shooting();
 
   // init aux vectors used in transient simulation
   VecDuplicate ( x, &x_n );
@@ -1191,10 +1560,44 @@ int DDMSolverBase::solve_transient()
   // time dependent
   SolverSpecify::TimeDependent = true;
 
+  // reuse the factored jacobian for several Newton iterations
+  set_jacobian_lag(SolverSpecify::NSLagJacobian);
+
   // if BDF2 scheme is used, we should set SolverSpecify::BDF2_LowerOrder flag to true
   if ( SolverSpecify::TS_type==SolverSpecify::BDF2 )
     SolverSpecify::BDF2_LowerOrder = true;
 
+  // operator splitting of lattice heat equation, the temperature is held during carrier steps
+  bool heat_split = false;
+  std::vector<unsigned int> heat_dofs, electrical_dofs, lte_index_coupled;
+  if( SolverSpecify::HeatSplit > 0 )
+  {
+    heat_dofs = norm_index[NormTemperature];
+    unsigned int n_heat_dofs = heat_dofs.size();
+    Parallel::sum(n_heat_dofs);
+    heat_split = n_heat_dofs > 0;
+  }
+  if( heat_split )
+  {
+    std::vector<bool> is_heat_dof(n_local_dofs, false);
+    for(unsigned int i=0; i<heat_dofs.size(); ++i)
+      is_heat_dof[heat_dofs[i]] = true;
+    for(unsigned int i=0; i<n_local_dofs; ++i)
+      if( !is_heat_dof[i] ) electrical_dofs.push_back(i);
+
+    // the held temperature is out of LTE control
+    lte_index_coupled = lte_index;
+    lte_index.clear();
+    for(unsigned int i=0; i<lte_index_coupled.size(); ++i)
+      if( !is_heat_dof[lte_index_coupled[i]] ) lte_index.push_back(lte_index_coupled[i]);
+
+    MESSAGE<<"Lattice heat equation is solved every "<<SolverSpecify::HeatSplit<<" steps.\n";
+    RECORD();
+  }
+
+  // time of last lattice heat step
+  double t_heat = SolverSpecify::TStart;
+
   // we have a previous dc solution
   if(!SolverSpecify::tran_histroy)
   {
@@ -1207,11 +1610,15 @@ int DDMSolverBase::solve_transient()
     }
   }
 
-  // transient simulation clock
-  SolverSpecify::clock = SolverSpecify::TStart + SolverSpecify::TStep;
+  // corners of source waveforms, the step controller lands on them
+  TransientBreakpoints breakpoints;
+  breakpoints.build(_system, SolverSpecify::TStart, SolverSpecify::TStop);
 
   // for the first step, dt equals TStep
-  SolverSpecify::dt = SolverSpecify::TStep;
+  SolverSpecify::dt = breakpoints.limit_dt(SolverSpecify::TStart, SolverSpecify::TStep, SolverSpecify::TStepMin);
+
+  // transient simulation clock
+  SolverSpecify::clock = SolverSpecify::TStart + SolverSpecify::dt;
 
   MESSAGE<<"Transient compute from "<<SolverSpecify::TStart
   <<" ps step "<<SolverSpecify::TStep
@@ -1230,6 +1637,9 @@ int DDMSolverBase::solve_transient()
 
   double dt_dynamic_factor = 1.0;
 
+  // normalized truncate error of last accepted step, used by PI controller
+  PetscReal r_last = 1.0;
+
   // the main loop of transient solver.
   do
   {
@@ -1249,6 +1659,19 @@ int DDMSolverBase::solve_transient()
     else
       this->pre_solve_process ( false );
 
+    // x is loaded by the first pre_solve_process
+    if ( SolverSpecify::T_Cycles == 0 )
+    {
+      VecCopy ( x, x_n );
+      _x_history_valid = true;
+    }
+    if ( heat_split && SolverSpecify::T_Cycles == 0 )
+      hold_dofs(heat_dofs);
+
+    // initial state of the shooting period
+    if ( _shooting_record && SolverSpecify::T_Cycles == 0 )
+      VecCopy ( x, _shooting_x0 );
+
     sens_solve();
     // get the converged reason
     SNESConvergedReason reason;
@@ -1264,6 +1687,7 @@ int DDMSolverBase::solve_transient()
     {
       // increase diverged_retry
       diverged_retry++;
+      solver_counters.add(SolverCounters::RejectedSteps);
 
       if ( diverged_retry >= 8 ) //failed 8 times, stop tring
       {
@@ -1324,6 +1748,7 @@ int DDMSolverBase::solve_transient()
         // clear the counter
         diverged_retry = 0;
         autostep_retry++;
+        solver_counters.add(SolverCounters::RejectedSteps);
 
         MESSAGE<<"------> LTE too large, time step rejected...\n\n\n";
         RECORD();
@@ -1354,6 +1779,10 @@ int DDMSolverBase::solve_transient()
           autostep_retry = 0;
           diverged_retry = 0;
         }
+        else if( SolverSpecify::TS_controller == SolverSpecify::STEP_PI )
+        {
+          dt_dynamic_factor = SolverSpecify::pi_step_factor(r, r_last);
+        }
         else
         {
           if ( r > 1.0 )
@@ -1361,6 +1790,7 @@ int DDMSolverBase::solve_transient()
           else
             dt_dynamic_factor = std::min(r, 0.9);
         }
+        r_last = r;
       }
     }
     else // auto time step control not used
@@ -1376,6 +1806,20 @@ int DDMSolverBase::solve_transient()
         <<"      "<<SNESConvergedReasons[reason]<<", total linear iteration " << lits << "\n\n\n";
     RECORD();
 
+    // jacobian of this step for the monodromy matrix of shooting method
+    if ( _shooting_record )
+      shooting_record_step();
+
+    // lattice heat step with the joule heat of this step, done before the solution is saved
+    // so that the nodes still hold the temperature of last heat step
+    if ( heat_split &&
+         ( ( SolverSpecify::T_Cycles+1 ) % SolverSpecify::HeatSplit == 0 ||
+           SolverSpecify::clock > SolverSpecify::TStop - 1e-10*SolverSpecify::dt ) )
+    {
+      if ( solve_heat_split_step ( electrical_dofs, SolverSpecify::clock - t_heat ) )
+        t_heat = SolverSpecify::clock;
+      hold_dofs(heat_dofs);
+    }
 
     // call post_solve_process
     this->post_solve_process();
@@ -1385,10 +1829,12 @@ int DDMSolverBase::solve_transient()
 
     // time step counter ++
     SolverSpecify::T_Cycles++;
+    solver_counters.add(SolverCounters::AcceptedSteps);
 
     // save time step information
     SolverSpecify::dt_last_last = SolverSpecify::dt_last;
     SolverSpecify::dt_last = SolverSpecify::dt;
+    solver_counters.set_gauge("timestep.last", SolverSpecify::dt/PhysicalUnit::s);
 
     // prepare for next time step
     SolverSpecify::dt *= dt_dynamic_factor;
@@ -1405,6 +1851,9 @@ int DDMSolverBase::solve_transient()
     // limit time step by field source
     SolverSpecify::dt = _system.get_field_source()->limit_dt(SolverSpecify::clock, SolverSpecify::dt);
 
+    // land on the next corner of source waveforms
+    SolverSpecify::dt = breakpoints.limit_dt(SolverSpecify::clock, SolverSpecify::dt, SolverSpecify::TStepMin);
+
     // set clock to next time step
     SolverSpecify::clock += SolverSpecify::dt;
 
@@ -1420,13 +1869,11 @@ int DDMSolverBase::solve_transient()
     if ( SolverSpecify::TS_type==SolverSpecify::BDF2 )
       SolverSpecify::BDF2_LowerOrder = this->BDF2_positive_defined();
 
-    // use by auto step control and predict
-    if( SolverSpecify::AutoStep  || SolverSpecify::Predict )
-    {
-      VecCopy ( x_n1, x_n2 );
-      VecCopy ( x_n, x_n1 );
-      VecCopy ( x, x_n );
-    }
+    // rotate the solution history, the oldest vector is overwritten by x.
+    // x_n is also the rollback point of a diverged step
+    std::swap ( x_n2, x_n1 );
+    std::swap ( x_n1, x_n );
+    VecCopy ( x, x_n );
 
   Predict:
 
@@ -1475,12 +1922,20 @@ int DDMSolverBase::solve_transient()
   while ( SolverSpecify::clock < SolverSpecify::TStop+0.5*SolverSpecify::dt );
 
   // free aux vectors
+  _x_history_valid = false;
   VecDestroy ( PetscDestroyObject(x_n) );
   VecDestroy ( PetscDestroyObject(x_n1) );
   VecDestroy ( PetscDestroyObject(x_n2) );
   VecDestroy ( PetscDestroyObject(xp) );
   VecDestroy ( PetscDestroyObject(LTE) );
 
+  set_jacobian_lag(1);
+
+  if( heat_split )
+  {
+    hold_dofs(std::vector<unsigned int>());
+    lte_index = lte_index_coupled;
+  }
 
   SolverSpecify::tran_histroy = true;
 
@@ -1489,11 +1944,78 @@ int DDMSolverBase::solve_transient()
 
 
 
+bool DDMSolverBase::solve_heat_split_step(const std::vector<unsigned int> &electrical_dofs, PetscScalar dt_heat)
+{
+  MESSAGE<<"Lattice heat step over "<<dt_heat<<" ps\n"; RECORD();
+
+  const PetscScalar dt = SolverSpecify::dt;
+  const SolverSpecify::TemporalScheme ts_type = SolverSpecify::TS_type;
+  SolverSpecify::dt = dt_heat;
+  SolverSpecify::TS_type = SolverSpecify::BDF1;
+
+  Vec x_save;
+  VecDuplicate ( x, &x_save );
+  VecCopy ( x, x_save );
+
+  hold_dofs(electrical_dofs);
+
+  // the heat equation is diffusion dominated, AMG fits it better than the factorization of whole system
+  const SolverSpecify::LinearSolverType ls_type = _linear_solver_type;
+  const SolverSpecify::PreconditionerType pc_type = _preconditioner_type;
+  if( SolverSpecify::HeatSplitAMG )
+  {
+    _linear_solver_type = SolverSpecify::GMRES;
+    _preconditioner_type = SolverSpecify::GAMG_PRECOND;
+    set_petsc_linear_solver_type();
+    set_petsc_preconditioner_type();
+  }
+
+  sens_solve();
+
+  SNESConvergedReason reason;
+  SNESGetConvergedReason ( snes,&reason );
+
+  if( SolverSpecify::HeatSplitAMG )
+  {
+    _linear_solver_type = ls_type;
+    _preconditioner_type = pc_type;
+    set_petsc_linear_solver_type();
+    set_petsc_preconditioner_type();
+    set_jacobian_lag(SolverSpecify::NSLagJacobian);
+  }
+
+  // keep the temperature of last heat step, the next heat step covers this interval too
+  if ( reason<0 )
+  {
+    MESSAGE<<"------> heat step "<<SNESConvergedReasons[reason]<<", lattice temperature unchanged.\n\n"; RECORD();
+    VecCopy ( x_save, x );
+  }
+
+  VecDestroy ( PetscDestroyObject(x_save) );
+
+  SolverSpecify::dt = dt;
+  SolverSpecify::TS_type = ts_type;
+
+  return reason>0;
+}
+
+
+
 int DDMSolverBase::snes_solve_pseudo_time_step()
 {
   // diverged counter
   int diverged_retry=0;
 
+  // steady residual norm of the initial and the last pseudo time solution
+  PetscReal fnorm_initial = -1.0;
+  PetscReal fnorm_last = -1.0;
+
+  // relative steady residual to switch to plain newton, 0 for never
+  PetscReal newton_switch = SolverSpecify::PseudoTimeNewtonSwitch;
+
+  // local pseudo time step factor of each region
+  for(unsigned int n=0; n<_system.n_regions(); n++)
+    _system.region(n)->build_pseudo_time_step_scale(SolverSpecify::PseudoTimeLocal);
 
   for(int k=1; k<=SolverSpecify::PseudoTimeSteps; k++)
   {
@@ -1507,6 +2029,12 @@ int DDMSolverBase::snes_solve_pseudo_time_step()
     else
       this->pre_solve_process ( false );
 
+    if( fnorm_initial < 0.0 && (SolverSpecify::PseudoTimeSER || newton_switch > 0.0) )
+    {
+      fnorm_initial = steady_residual_norm();
+      fnorm_last = fnorm_initial;
+    }
+
     sens_solve();
     // get the converged reason
     SNESConvergedReason reason;
@@ -1560,25 +2088,88 @@ int DDMSolverBase::snes_solve_pseudo_time_step()
     // call post_solve_process
     this->post_solve_process();
 
+    // steady residual of the new solution
+    PetscReal fnorm = -1.0;
+    if( fnorm_initial >= 0.0 )
+    {
+      fnorm = steady_residual_norm();
+      MESSAGE <<"      steady residual " << fnorm << ", " << fnorm/(fnorm_initial + 1e-30) << " of initial\n\n"; RECORD();
+    }
+
     if(diverged_retry == 0)
     {
-      // set next pseudo time step
-      if(SolverSpecify::PseudoTimeStepPotential < SolverSpecify::PseudoTimeStepMax)
-        SolverSpecify::PseudoTimeStepPotential *= 2.0;
-      if(SolverSpecify::PseudoTimeStepCarrier < SolverSpecify::PseudoTimeStepMax)
-        SolverSpecify::PseudoTimeStepCarrier *= 2.0;
-      if(SolverSpecify::PseudoTimeStepMetal < SolverSpecify::PseudoTimeStepMax)
-        SolverSpecify::PseudoTimeStepMetal *= 2.0;
+      // set next pseudo time step. SER grows the step by the decrease of steady residual,
+      // (|F_{k-1}|/|F_k|)^e, limited to [0.1, growth]. else doubles it.
+      PetscReal factor = 2.0;
+      if( SolverSpecify::PseudoTimeSER && fnorm > 0.0 )
+      {
+        factor = std::pow(fnorm_last/fnorm, SolverSpecify::PseudoTimeSERExponent);
+        factor = std::max(PetscReal(0.1), std::min(factor, PetscReal(SolverSpecify::PseudoTimeSERGrowth)));
+      }
+
+      double * steps[3] = { &SolverSpecify::PseudoTimeStepPotential, &SolverSpecify::PseudoTimeStepCarrier, &SolverSpecify::PseudoTimeStepMetal };
+      for(unsigned int i=0; i<3; ++i)
+      {
+        if( factor > 1.0 && *steps[i] >= SolverSpecify::PseudoTimeStepMax ) continue;
+        *steps[i] *= factor;
+      }
+    }
+
+    if( fnorm >= 0.0 ) fnorm_last = fnorm;
+
+    // the solution is close enough to steady state, try plain newton from it
+    if( newton_switch > 0.0 && fnorm >= 0.0 && fnorm < newton_switch*fnorm_initial )
+    {
+      MESSAGE <<"------> steady residual below "<< newton_switch <<" of initial, switch to newton...\n\n"; RECORD();
+
+      SolverSpecify::PseudoTimeMethod = false;
+
+      if ( SolverSpecify::T_Cycles == 0 )
+        this->pre_solve_process();
+      else
+        this->pre_solve_process ( false );
+
+      sens_solve();
+      SNESGetConvergedReason ( snes,&reason );
+
+      SolverSpecify::PseudoTimeMethod = true;
+
+      if( reason > 0 )
+      {
+        MESSAGE <<"--------------------------------------------------------------------------------\n"
+                <<"      "<<SNESConvergedReasons[reason]<<", newton converged\n\n\n";
+        RECORD();
+        this->post_solve_process();
+        break;
+      }
+
+      // continue pseudo time steps, ask for a smaller residual before the next try
+      MESSAGE <<"------> newton "<<SNESConvergedReasons[reason]<<", back to pseudo time step...\n\n\n"; RECORD();
+      this->diverged_recovery();
+      newton_switch *= 0.1;
     }
 
     // do predict
   }
 
+  // restore the global pseudo time step
+  for(unsigned int n=0; n<_system.n_regions(); n++)
+    _system.region(n)->build_pseudo_time_step_scale(false);
 
   return 0;
 }
 
 
+PetscReal DDMSolverBase::steady_residual_norm()
+{
+  // x equals the last pseudo time solution here, the pseudo time terms vanish
+  PetscReal fnorm;
+  SNESComputeFunction(snes, x, f);
+  VecNorm(f, NORM_2, &fnorm);
+  return fnorm;
+}
+
+
 
 
 /*------------------------------------------------------------------
@@ -1745,6 +2336,9 @@ void DDMSolverBase::petsc_ksp_convergence_test ( PetscInt its, PetscReal rnorm,
 
   PetscInt kspit = std::max(200, std::min(1000, static_cast<int>(n_global_dofs/10)));
   PetscScalar rtol = SolverSpecify::ksp_rtol;
+  // inexact newton, keep the forcing term set by Eisenstat-Walker method
+  if( SolverSpecify::InexactNewton || SolverSpecify::JFNK )
+    KSPGetTolerances(ksp, &rtol, PETSC_NULL, PETSC_NULL, PETSC_NULL);
   PetscScalar abstol = std::max ( SolverSpecify::ksp_atol_fnorm*function_norm, SolverSpecify::ksp_atol);
 
   if(its > static_cast<PetscInt>(0.3*kspit))
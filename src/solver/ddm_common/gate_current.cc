@@ -69,49 +69,41 @@ void InsulatorSemiconductorInterfaceBC::_gate_current()
   std::vector<PetscScalar> J_VBHT_Buffer;
   std::vector<PetscScalar> J_VBET_Buffer;
 
-  std::multimap<const Node *, NearestPoint>::const_iterator node_it = _node_nearest_point_map.begin();
-  for(; node_it != _node_nearest_point_map.end(); ++node_it)
+  // gather the nodal values at the gate end of all the paths in one batch
+  const unsigned int n_paths = _gate_paths.size();
+  std::vector<PetscScalar> V_gate_batch(n_paths, 0.0);
+  std::vector<PetscScalar> Ec_gate_batch(n_paths, 0.0);
+  std::vector<PetscScalar> Ev_gate_batch(n_paths, 0.0);
+  std::vector<PetscScalar> Efn_gate_batch(n_paths, 0.0);
+  std::vector<PetscScalar> Efp_gate_batch(n_paths, 0.0);
+  for(unsigned int n=0; n<n_paths; ++n)
   {
-    // injection end
-    SimulationRegion * region = node_it->second.region;
-    BoundaryCondition * bc = node_it->second.bc;
-    const Elem * bc_elem = node_it->second.elem;
-    const unsigned int bc_elem_face_index = node_it->second.side;
-    const Point & point_injection = node_it->second.p;
-
-    AutoPtr<Elem> bc_elem_face = bc_elem->build_side(bc_elem_face_index, false);
-    std::vector<PetscScalar> psi_elem;
-    std::vector<PetscScalar> Ec_elem;
-    std::vector<PetscScalar> Ev_elem;
-    std::vector<PetscScalar> qfn_elem;
-    std::vector<PetscScalar> qfp_elem;
-    for(unsigned int n=0; n<bc_elem_face->n_nodes(); ++n)
+    const GatePath & path = _gate_paths[n];
+    for(unsigned int i=path.face_begin; i<path.face_end; ++i)
     {
-      const Node * node = bc_elem_face->get_node(n); assert(node->on_local());
-      const FVM_Node * fvm_node = region->region_fvm_node(node);
-      assert(fvm_node->on_local());
-      psi_elem.push_back(fvm_node->node_data()->psi());
-      Ec_elem.push_back(fvm_node->node_data()->Ec());
-      Ev_elem.push_back(fvm_node->node_data()->Ev());
-      qfn_elem.push_back(fvm_node->node_data()->qFn());
-      qfp_elem.push_back(fvm_node->node_data()->qFp());
+      const FVM_NodeData * node_data = _gate_path_face_nodes[i]->node_data();
+      const Real w = _gate_path_face_weights[i];
+      V_gate_batch[n]   += w*node_data->psi();
+      Ec_gate_batch[n]  += w*node_data->Ec();
+      Ev_gate_batch[n]  += w*node_data->Ev();
+      Efn_gate_batch[n] += w*node_data->qFn();
+      Efp_gate_batch[n] += w*node_data->qFp();
     }
-    PetscScalar V_gate = bc_elem_face->interpolation(psi_elem, point_injection);
-    PetscScalar Ec_gate = bc_elem_face->interpolation(Ec_elem, point_injection);
-    PetscScalar Ev_gate = bc_elem_face->interpolation(Ev_elem, point_injection);
-    PetscScalar Efn_gate = bc_elem_face->interpolation(qfn_elem, point_injection);
-    PetscScalar Efp_gate = bc_elem_face->interpolation(qfp_elem, point_injection);
-    // Ec/Ev is meaning less for metal
-    /*
-    if(region->type() == MetalRegion ||  region->type() == ElectrodeRegion )
-    {
-      Ec_gate = Efn_gate - 5.0;
-      Ev_gate = Efp_gate + 5.0;
-    }
-    */
+  }
+
+  for(unsigned int n=0; n<n_paths; ++n)
+  {
+    const GatePath & path = _gate_paths[n];
+    BoundaryCondition * bc = path.bc;
+
+    PetscScalar V_gate = V_gate_batch[n];
+    PetscScalar Ec_gate = Ec_gate_batch[n];
+    PetscScalar Ev_gate = Ev_gate_batch[n];
+    PetscScalar Efn_gate = Efn_gate_batch[n];
+    PetscScalar Efp_gate = Efp_gate_batch[n];
 
     // fvm_node at semiconductor side
-    const FVM_Node * semiconductor_node = get_region_fvm_node(node_it->first, semiconductor_region);    assert(semiconductor_node);
+    const FVM_Node * semiconductor_node = path.semiconductor_node;    assert(semiconductor_node);
     assert(semiconductor_node->on_processor());
 
     PetscScalar T_semi = semiconductor_node->node_data()->T();
@@ -128,7 +120,7 @@ void InsulatorSemiconductorInterfaceBC::_gate_current()
     PetscScalar mh_semi = semiconductor_region->material()->band->EffecHoleMass(T_semi);
 
     // barraier (of conduction band)
-    const FVM_Node * insulator_node = get_region_fvm_node(node_it->first, insulator_region);    assert(insulator_node);
+    const FVM_Node * insulator_node = path.insulator_node;    assert(insulator_node);
     assert(insulator_node->on_processor());
     PetscScalar Affinity_ins = insulator_node->node_data()->affinity();
     PetscScalar Eg_ins = insulator_node->node_data()->Eg();
@@ -138,7 +130,7 @@ void InsulatorSemiconductorInterfaceBC::_gate_current()
     PetscScalar Bv_gate = -e*V_gate - Affinity_ins - Eg_ins;
 
     // the electrical field in insulator
-    double t = (*(semiconductor_node->root_node())-point_injection).size();
+    double t = path.t;
     PetscScalar E_insulator = (V_gate - V_semi)/t;
 
     PetscScalar I_DIR = 0.0;
@@ -152,26 +144,6 @@ void InsulatorSemiconductorInterfaceBC::_gate_current()
       J_CBET_Buffer.push_back(J_CBET);
       J_VBHT_Buffer.push_back(J_VBHT);
       J_VBET_Buffer.push_back(J_VBET);
-
-
-      if(node_it == _node_nearest_point_map.begin())
-      {
-        /*
-        std::cout<<"Ec  " << Ec_semi <<" " << Ec_gate << std::endl;
-        std::cout<<"Efn " << Efn_semi<<" " << Efn_gate << std::endl;
-        std::cout<<"Bc  " << Bc_semi <<" " << Bc_gate << std::endl<< std::endl;
-
-
-        std::cout<<"Ev  " << Ev_semi <<" " << Ev_gate << std::endl;
-        std::cout<<"Efp " << Efp_semi<<" " << Efp_gate << std::endl;
-        std::cout<<"Bv  " << Bv_semi <<" " << Bv_gate << std::endl<< std::endl;
-
-        std::cout<< "J_CBET = " <<  J_CBET/(A/cm/cm) <<  " "
-                 << "J_VBHT = " <<  J_VBHT/(A/cm/cm) <<  " "
-                 << "J_VBET = " <<  J_VBET/(A/cm/cm) << std::endl;
-        */
-      }
-
     }
 
 
@@ -48,6 +48,15 @@ int MixASolverBase::create_solver()
   // must setup nonlinear contex here!
   setup_nonlinear_data();
 
+  // the local offsets of each variable are fixed from now on
+  for(unsigned int v=0; v<NormVariables; ++v)
+  {
+    norm_index[v].clear();
+    norm_divisor[v].clear();
+  }
+  lte_index.clear();
+  build_norm_index();
+
   //abstol = 1e-12*n_global_dofs    - absolute convergence tolerance
   //rtol   = 1e-14                  - relative convergence tolerance
   //stol   = 1e-9                   - convergence tolerance in terms of the norm of the change in the solution between steps
@@ -327,8 +336,21 @@ void MixASolverBase::build_spice_function(PetscScalar *lxx, Vec f, InsertMode &a
       rhs.push_back(lxx[_circuit->local_offset_x(n)]);
     _circuit->update_rhs_old(rhs);
 
-    // ask spice to build new rhs and matrix
-    _circuit->circuit_load();
+    // ask spice to build new rhs and matrix, unless the last stamp is still good.
+    // the residual below is evaluated with the stored matrix and rhs at the new node values,
+    // which is the linearized circuit of the last load
+    if( spice_bypass(rhs) )
+      _spice_bypass_count++;
+    else
+    {
+      _circuit->circuit_load();
+
+      // only the load in MODEINITFLOAT is linearized at rhs_old
+      _spice_stamp_valid = SolverSpecify::SpiceBypassTol > 0.0 &&
+                           (_circuit->ckt_mode() & MODETRAN) && (_circuit->ckt_mode() & MODEINITFLOAT);
+      if( _spice_stamp_valid )
+        _spice_stamp_rhs = rhs;
+    }
 
     std::vector<PetscInt> iy;
     std::vector<PetscScalar> y;
@@ -350,6 +372,23 @@ void MixASolverBase::build_spice_function(PetscScalar *lxx, Vec f, InsertMode &a
 }
 
 
+bool MixASolverBase::spice_bypass(const std::vector<double> &rhs) const
+{
+  if( !_spice_stamp_valid ) return false;
+  if( !((_circuit->ckt_mode() & MODETRAN) && (_circuit->ckt_mode() & MODEINITFLOAT)) ) return false;
+
+  // node 0 is the ground
+  const double abs_tol = 1e-6;
+  for(unsigned int n=1; n<rhs.size(); ++n)
+  {
+    const double ref = std::max(std::abs(rhs[n]), std::abs(_spice_stamp_rhs[n]));
+    if( std::abs(rhs[n] - _spice_stamp_rhs[n]) > SolverSpecify::SpiceBypassTol*ref + abs_tol )
+      return false;
+  }
+  return true;
+}
+
+
 void MixASolverBase::build_spice_jacobian(PetscScalar *lxx, Mat *jac, InsertMode &add_value_flag)
 {
 
@@ -566,9 +605,12 @@ int MixASolverBase::solve_dcop(bool tran_op)
 
     SNESSolve(snes,PETSC_NULL,x);
 
+    log_newton_finish();
+
     // get the converged reason
     SNESConvergedReason reason;
     SNESGetConvergedReason(snes,&reason);
+    if( reason < 0 ) hook_list()->trigger("diverged");
     if( reason>0  ) //ok, converged.
     {
       // call post_solve_process
@@ -681,9 +723,12 @@ int MixASolverBase::solve_dcop(bool tran_op)
 
     SNESSolve(snes,PETSC_NULL,x);
 
+    log_newton_finish();
+
     // get the converged reason
     SNESConvergedReason reason;
     SNESGetConvergedReason(snes,&reason);
+    if( reason < 0 ) hook_list()->trigger("diverged");
     if( reason < 0  )
     {
       if(reason == SNES_DIVERGED_LINEAR_SOLVE)
@@ -799,9 +844,12 @@ int MixASolverBase::solve_dcsweep()
 
       SNESSolve(snes,PETSC_NULL,x);
 
+      log_newton_finish();
+
       // get the converged reason
       SNESConvergedReason reason;
       SNESGetConvergedReason(snes,&reason);
+      if( reason < 0 ) hook_list()->trigger("diverged");
       if( reason>0  ) //ok, converged.
       {
         // call post_solve_process
@@ -961,9 +1009,12 @@ int MixASolverBase::solve_dcsweep()
 
       SNESSolve(snes,PETSC_NULL,x);
 
+      log_newton_finish();
+
       // get the converged reason
       SNESConvergedReason reason;
       SNESGetConvergedReason(snes,&reason);
+      if( reason < 0 ) hook_list()->trigger("diverged");
       if( reason>0  ) //ok, converged.
       {
         // call post_solve_process
@@ -1095,7 +1146,11 @@ int MixASolverBase::solve_transient()
   // diverged counter
   int diverged_retry=0;
 
+  // normalized truncate error of last accepted step, used by PI controller
+  PetscScalar r_last = 1.0;
+
   // init aux vectors used in transient simulation
+  _spice_bypass_count = 0;
   VecDuplicate(x, &x_n);
   VecDuplicate(x, &x_n1);
   VecDuplicate(x, &x_n2);
@@ -1165,6 +1220,9 @@ int MixASolverBase::solve_transient()
       _circuit->set_delta(SolverSpecify::dt/PhysicalUnit::s);
     }
 
+    // the companion models of reactive devices changed with time step, spice should load again
+    _spice_stamp_valid = false;
+
     _system.get_field_source()->update(SolverSpecify::clock);
 
     //we do solve here!
@@ -1181,6 +1239,7 @@ int MixASolverBase::solve_transient()
     // get the converged reason
     SNESConvergedReason reason;
     SNESGetConvergedReason(snes,&reason);
+    if( reason < 0 ) hook_list()->trigger("diverged");
 
     //nonlinear solution diverged? try to do recovery
     if(reason<0)
@@ -1271,7 +1330,9 @@ int MixASolverBase::solve_transient()
         SolverSpecify::dt_last_last = SolverSpecify::dt_last;
         SolverSpecify::dt_last = SolverSpecify::dt;
         // set next time step
-        if( r > 10.0 )
+        if( SolverSpecify::TS_controller == SolverSpecify::STEP_PI )
+          SolverSpecify::dt *= SolverSpecify::pi_step_factor(r, r_last);
+        else if( r > 10.0 )
           SolverSpecify::dt *= 2.0;
         else if( r > 3.0 )
           SolverSpecify::dt *= 1.5;
@@ -1281,6 +1342,7 @@ int MixASolverBase::solve_transient()
           SolverSpecify::dt *= 1.0;
         else
           SolverSpecify::dt *= 0.9;
+        r_last = r;
 
         // limit the max time step to TStepMax
         if(SolverSpecify::dt > SolverSpecify::TStepMax)
@@ -1386,6 +1448,13 @@ int MixASolverBase::solve_transient()
   VecDestroy(PetscDestroyObject(xp));
   VecDestroy(PetscDestroyObject(LTE));
 
+  if( SolverSpecify::SpiceBypassTol > 0.0 )
+  {
+    Parallel::broadcast(_spice_bypass_count, Genius::last_processor_id());
+    MESSAGE<<"Spice circuit load bypassed "<<_spice_bypass_count<<" times.\n\n";
+    RECORD();
+  }
+  _spice_stamp_valid = false;
 
   SolverSpecify::tran_histroy = true;
 
@@ -1548,6 +1617,9 @@ void MixASolverBase::petsc_ksp_convergence_test ( PetscInt its, PetscReal rnorm,
   PetscInt kspit = std::max(200, std::min(1000, static_cast<int>(n_global_dofs/10)));
 
   PetscScalar rtol = SolverSpecify::ksp_rtol;
+  // inexact newton, keep the forcing term set by Eisenstat-Walker method
+  if( SolverSpecify::InexactNewton || SolverSpecify::JFNK )
+    KSPGetTolerances(ksp, &rtol, PETSC_NULL, PETSC_NULL, PETSC_NULL);
   PetscScalar abstol = std::max ( std::min(1e-3,SolverSpecify::ksp_atol_fnorm*function_norm), SolverSpecify::ksp_atol);
   if(its > static_cast<PetscInt>(0.3*kspit))
     abstol *= 1e1;
@@ -38,15 +38,24 @@ void SemiconductorSimulationRegion::Mob_Evaluation( std::vector< std::pair<unsig
   const PetscScalar T   = T_external();
   const PetscScalar Vt  = kb*T/e;
   bool  highfield_mob   = this->highfield_mobility();
+  // driving forces kept by the residual of the last solve
+  bool  mob_force_cached = highfield_mob && this->mob_force_cached();
 
   typedef std::pair< std::pair< double, double > , double > EdgeMob;
   typedef std::map< std::pair<unsigned int, unsigned int>,  std::vector< EdgeMob > > WeightedMobMap;
   WeightedMobMap weighted_mob_map;
 
 
+  std::vector<PetscScalar> psi_vertex;
+  std::vector<PetscScalar> phin_vertex;
+  std::vector<PetscScalar> phip_vertex;
+  std::vector<unsigned int> sides;
+  std::vector<SimulationRegion *> regions;
+  std::vector<PetscScalar> psi_vertex_neighbor;
+
   const_element_iterator it = elements_begin();
   const_element_iterator it_end = elements_end();
-  for(; it!=it_end; ++it)
+  for(unsigned int nelem=0; it!=it_end; ++it, ++nelem)
   {
     const Elem * elem = *it;
     bool insulator_interface_elem = is_elem_on_insulator_interface(elem);
@@ -68,14 +77,23 @@ void SemiconductorSimulationRegion::Mob_Evaluation( std::vector< std::pair<unsig
     PetscScalar Etn=0;
     PetscScalar Etp=0;
 
+    if(mob_force_cached)
+    {
+      const FVM_CellData * elem_data = this->get_region_elem_data(nelem);
+      Epn = elem_data->Epn();
+      Epp = elem_data->Epp();
+      Etn = elem_data->Etn();
+      Etp = elem_data->Etp();
+    }
+
     // evaluate E field parallel and vertical to current flow
-    if(highfield_mob)
+    if(highfield_mob && !mob_force_cached)
     {
       // build the gradient of psi and fermi potential in this cell.
       // which are the vector of electric field and current density.
-      std::vector<PetscScalar> psi_vertex(elem->n_nodes());
-      std::vector<PetscScalar> phin_vertex(elem->n_nodes());
-      std::vector<PetscScalar> phip_vertex(elem->n_nodes());
+      psi_vertex.resize(elem->n_nodes());
+      phin_vertex.resize(elem->n_nodes());
+      phip_vertex.resize(elem->n_nodes());
 
       for(unsigned int nd=0; nd<elem->n_nodes(); ++nd)
       {
@@ -98,14 +116,14 @@ void SemiconductorSimulationRegion::Mob_Evaluation( std::vector< std::pair<unsig
       Jpv = - elem->gradient(phip_vertex); // Jpv = - gradient of Fp
     }
 
-    if(highfield_mob)
+    if(highfield_mob && !mob_force_cached)
     {
       // for elem on insulator interface, we will do special treatment to electrical field
       if(get_advanced_model()->ESurface && insulator_interface_elem)
       {
         // get all the sides on insulator interface
-        std::vector<unsigned int> sides;
-        std::vector<SimulationRegion *> regions;
+        sides.clear();
+        regions.clear();
         elem_on_insulator_interface(elem, sides, regions);
 
         VectorValue<PetscScalar> E_insul(0,0,0);
@@ -115,7 +133,7 @@ void SemiconductorSimulationRegion::Mob_Evaluation( std::vector< std::pair<unsig
         for(unsigned int ne=0; ne<sides.size(); ++ne)
         {
           const Elem * elem_neighbor = elem->neighbor(sides[ne]);
-          std::vector<PetscScalar> psi_vertex_neighbor;
+          psi_vertex_neighbor.clear();
           for(unsigned int nd=0; nd<elem_neighbor->n_nodes(); ++nd)
           {
             const FVM_Node * fvm_node_neighbor = elem_neighbor->get_fvm_node(nd);
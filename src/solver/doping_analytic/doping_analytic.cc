@@ -139,23 +139,43 @@ int DopingAnalytic::solve()
       ion_map.insert(std::make_pair(name, std::make_pair(ion_index, ion_type)));
     }
 
+    std::vector<FVM_Node *> fvm_nodes;
+    std::vector<const Node *> nodes;
     SimulationRegion::local_node_iterator node_it = region->on_local_nodes_begin();
     SimulationRegion::local_node_iterator node_it_end = region->on_local_nodes_end();
     for(; node_it!=node_it_end; ++node_it)
     {
-      FVM_Node * fvm_node = *node_it;
-      FVM_NodeData * node_data = fvm_node->node_data();
-      genius_assert(node_data!=NULL);
-
-      const Node * node = fvm_node->root_node();
-      node_data->Na() = doping_Na( node );
-      node_data->Nd() = doping_Nd( node );
-      // fill custom defined variable
-      for (std::map<std::string,DopingFunction *>::iterator it = _custom_profile_funs.begin();
-           it!=_custom_profile_funs.end(); it++)
+      genius_assert((*node_it)->node_data()!=NULL);
+      fvm_nodes.push_back(*node_it);
+      nodes.push_back((*node_it)->root_node());
+    }
+
+    // node index sorted by x coordinate, then the nodes inside the bounding box of doping function can be found fast
+    std::vector<unsigned int> x_order(nodes.size());
+    for(unsigned int i=0; i<nodes.size(); ++i)
+      x_order[i] = i;
+    std::sort(x_order.begin(), x_order.end(), NodeXLess(nodes));
+
+    std::vector<double> Na, Nd;
+    doping_profile(nodes, x_order, Na, Nd);
+    for(unsigned int i=0; i<fvm_nodes.size(); ++i)
+    {
+      FVM_NodeData * node_data = fvm_nodes[i]->node_data();
+      node_data->Na() = Na[i];
+      node_data->Nd() = Nd[i];
+    }
+
+    // fill custom defined variable
+    for (std::map<std::string,DopingFunction *>::iterator it = _custom_profile_funs.begin();
+         it!=_custom_profile_funs.end(); it++)
+    {
+      const std::string & name = it->first;
+      std::vector<std::pair<unsigned int, double> > profile;
+      evaluate_doping_function(it->second, nodes, x_order, profile);
+      for(unsigned int k=0; k<profile.size(); ++k)
       {
-        const std::string & name = it->first;
-        double d = it->second->profile((*node)(0),(*node)(1),(*node)(2));
+        FVM_NodeData * node_data = fvm_nodes[profile[k].first]->node_data();
+        double d = profile[k].second;
         node_data->data<Real>(ion_map[name].first) = d;
         if(ion_map[name].second < 0 ) node_data->Na() += d;
         if(ion_map[name].second > 0 ) node_data->Nd() += d;
@@ -711,44 +731,67 @@ double DopingAnalytic::_do_doping_interp(int i, const Node *node, const std::str
   return d;
 }
 
-double DopingAnalytic::doping_Na(const Node * node)
+void DopingAnalytic::evaluate_doping_function(DopingFunction * df, const std::vector<const Node *> & nodes,
+                                              const std::vector<unsigned int> & x_order,
+                                              std::vector<std::pair<unsigned int, double> > & profile)
 {
-  double dop = 0.0;
-
-  //only add negative value
-  for(size_t i=0; i<_doping_funs.size(); i++)
+  Point p_min, p_max;
+  if( !df->bounding_box(p_min, p_max) )
   {
-    double d = _doping_funs[i]->profile((*node)(0),(*node)(1),(*node)(2));
-    dop += d < 0.0 ? d: 0.0;
+    for(unsigned int i=0; i<nodes.size(); ++i)
+    {
+      const Node * node = nodes[i];
+      double d = df->profile((*node)(0),(*node)(1),(*node)(2));
+      if( d != 0.0 ) profile.push_back(std::make_pair(i, d));
+    }
+    return;
   }
-  double unit = 1.0/std::pow(PhysicalUnit::cm,3.0);
-  for(size_t i=0; i<_doping_data.size(); i++)
+
+  // only the nodes inside bounding box are evaluated
+  std::vector<unsigned int>::const_iterator begin = std::lower_bound(x_order.begin(), x_order.end(), p_min(0), NodeXLess(nodes));
+  std::vector<unsigned int>::const_iterator end   = std::upper_bound(begin, x_order.end(), p_max(0), NodeXLess(nodes));
+  for(std::vector<unsigned int>::const_iterator it=begin; it!=end; ++it)
   {
-    double d = unit * _do_doping_interp(i, node, "Na");
-    dop += d < 0.0 ? d: 0.0;
+    const Node * node = nodes[*it];
+    if( (*node)(1) < p_min(1) || (*node)(1) > p_max(1) ) continue;
+    if( (*node)(2) < p_min(2) || (*node)(2) > p_max(2) ) continue;
+    double d = df->profile((*node)(0),(*node)(1),(*node)(2));
+    if( d != 0.0 ) profile.push_back(std::make_pair(*it, d));
   }
-
-  return std::abs(dop);
+  // keep the node order
+  std::sort(profile.begin(), profile.end());
 }
 
 
-
-double DopingAnalytic::doping_Nd(const Node * node)
+void DopingAnalytic::doping_profile(const std::vector<const Node *> & nodes, const std::vector<unsigned int> & x_order,
+                                    std::vector<double> & Na, std::vector<double> & Nd)
 {
-  double dop = 0.0;
+  // add negative value to Na and positive value to Nd
+  Na.assign(nodes.size(), 0.0);
+  Nd.assign(nodes.size(), 0.0);
 
-  //only add positive value
   for(size_t i=0; i<_doping_funs.size(); i++)
   {
-    double d = _doping_funs[i]->profile((*node)(0),(*node)(1),(*node)(2));
-    dop += d > 0.0 ? d: 0.0;
+    std::vector<std::pair<unsigned int, double> > profile;
+    evaluate_doping_function(_doping_funs[i], nodes, x_order, profile);
+    for(unsigned int k=0; k<profile.size(); ++k)
+    {
+      double d = profile[k].second;
+      if( d < 0.0 ) Na[profile[k].first] += d;
+      else          Nd[profile[k].first] += d;
+    }
   }
+
   double unit = 1.0/std::pow(PhysicalUnit::cm,3.0);
-  for(size_t i=0; i<_doping_data.size(); i++)
+  for(unsigned int n=0; n<nodes.size(); ++n)
   {
-    double d = unit * _do_doping_interp(i, node, "Nd");
-    dop += d > 0.0 ? d: 0.0;
+    for(size_t i=0; i<_doping_data.size(); i++)
+    {
+      double d = unit * _do_doping_interp(i, nodes[n], "doping");
+      if( d < 0.0 ) Na[n] += d;
+      else          Nd[n] += d;
+    }
+    Na[n] = std::abs(Na[n]);
+    Nd[n] = std::abs(Nd[n]);
   }
-
-  return std::abs(dop);
 }
@@ -1,6 +1,7 @@
 #include "doping_fun.h"
 
 #include <cmath>
+#include <algorithm>
 //win32 does not have erfc function
 #ifdef WINDOWS
 #include "mathfunc.h"
@@ -20,6 +21,14 @@ double UniformDopingFunction::profile(double x,double y,double z)
 }
 
 
+bool UniformDopingFunction::bounding_box(Point &p_min, Point &p_max) const
+{
+  p_min = Point(_xmin-1e-6, _ymin-1e-6, _zmin-1e-6);
+  p_max = Point(_xmax+1e-6, _ymax+1e-6, _zmax+1e-6);
+  return true;
+}
+
+
 
 //------------------------------------------------------------------
 
@@ -81,6 +90,14 @@ double AnalyticDopingFunction::profile(double x, double y, double z)
 }
 
 
+bool AnalyticDopingFunction::bounding_box(Point &p_min, Point &p_max) const
+{
+  p_min = Point(_xmin-8*_XCHAR, _ymin-8*_YCHAR, _zmin-8*_ZCHAR);
+  p_max = Point(_xmax+8*_XCHAR, _ymax+8*_YCHAR, _zmax+8*_ZCHAR);
+  return true;
+}
+
+
 //------------------------------------------------------------------
 
 PolyMaskDopingFunction::PolyMaskDopingFunction(double ion, const std::vector<Point> &poly, double theta, double phi,
@@ -266,6 +283,36 @@ double RecMaskDopingFunction::profile(double x, double y, double z)
 }
 
 
+bool RecMaskDopingFunction::bounding_box(Point &p_min, Point &p_max) const
+{
+  // the axis normal to mask plane
+  unsigned int axis = 0;
+  if( _mask.is_xz_plane() ) axis = 1;
+  if( _mask.is_xy_plane() ) axis = 2;
+
+  // profile line parallel to mask plane
+  if( std::abs(_dir(axis)) < 1e-10 ) return false;
+
+  // the profile is nonzero only when its projection on mask plane is near the mask,
+  // and it is in the doping range along the normal axis
+  const double t1 = (_doping_min(axis) - _mask.point()(axis))/_dir(axis);
+  const double t2 = (_doping_max(axis) - _mask.point()(axis))/_dir(axis);
+  const Point extend(5*_char_depth, 5*_char_depth, 5*_char_depth);
+
+  p_min = _mask_min - extend + _dir*std::min(t1, t2);
+  p_max = _mask_max + extend + _dir*std::min(t1, t2);
+  for(unsigned int i=0; i<3; ++i)
+  {
+    p_min(i) = std::min(p_min(i), _mask_min(i) - extend(i) + _dir(i)*std::max(t1, t2));
+    p_max(i) = std::max(p_max(i), _mask_max(i) + extend(i) + _dir(i)*std::max(t1, t2));
+  }
+  p_min(axis) = _doping_min(axis);
+  p_max(axis) = _doping_max(axis);
+
+  return true;
+}
+
+
 double RecMaskDopingFunction::_profile_r(double r) const
 {
   double dr;
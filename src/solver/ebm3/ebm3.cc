@@ -215,6 +215,9 @@ void EBM3Solver::flush_system(Vec v)
  */
 int EBM3Solver::diverged_recovery()
 {
+  // rejected transient step, x_n is the last accepted solution
+  if( restore_from_history() ) return 0;
+
   // for all the regions
   for(unsigned int n=0; n<_system.n_regions(); n++)
   {
@@ -615,11 +618,6 @@ PetscReal EBM3Solver::LTE_norm()
   PetscReal hn1 = SolverSpecify::dt_last;
   PetscReal hn2 = SolverSpecify::dt_last_last;
 
-  // relative error
-  PetscReal eps_r = SolverSpecify::TS_rtol;
-  // abs error
-  PetscReal eps_a = SolverSpecify::TS_atol;
-
   VecZeroEntries(xp);
   VecZeroEntries(LTE);
 
@@ -654,153 +652,26 @@ PetscReal EBM3Solver::LTE_norm()
     }
   }
 
-  int N=0;
-  PetscReal r;
-
-
   // with LTE vector and relative & abs error, we get the error estimate here
-  PetscScalar    *xx, *ll;
-  VecGetArray(x, &xx);
-  VecGetArray(LTE, &ll);
-
-  // error estimate for each region
-  for(unsigned int n=0; n<_system.n_regions(); n++)
-  {
-    const SimulationRegion * region = _system.region(n);
-    switch ( region->type() )
-    {
-        case SemiconductorRegion :
-        {
-          unsigned int node_psi_offset = region->ebm_variable_offset(POTENTIAL);
-          unsigned int node_n_offset   = region->ebm_variable_offset(ELECTRON);
-          unsigned int node_p_offset   = region->ebm_variable_offset(HOLE);
-          unsigned int node_Tl_offset  = region->ebm_variable_offset(TEMPERATURE);
-          unsigned int node_Tn_offset  = region->ebm_variable_offset(E_TEMP);
-          unsigned int node_Tp_offset  = region->ebm_variable_offset(H_TEMP);
-
-          SimulationRegion::const_processor_node_iterator it = region->on_processor_nodes_begin();
-          SimulationRegion::const_processor_node_iterator it_end = region->on_processor_nodes_end();
-          for(; it!=it_end; ++it)
-          {
-            const FVM_Node * fvm_node = *it;
-            unsigned int local_offset = fvm_node->local_offset();
-
-            ll[local_offset+node_psi_offset] = 0;
-            ll[local_offset+node_n_offset] = ll[local_offset+node_n_offset]/(eps_r*xx[local_offset+node_n_offset]+eps_a);
-            ll[local_offset+node_p_offset] = ll[local_offset+node_p_offset]/(eps_r*xx[local_offset+node_p_offset]+eps_a);
-
-            if(region->get_advanced_model()->enable_Tl())
-              ll[local_offset+node_Tl_offset] = ll[local_offset+node_Tl_offset]/(eps_r*xx[local_offset+node_Tl_offset]+eps_a); // temperature
-
-            if(region->get_advanced_model()->enable_Tn())
-              ll[local_offset+node_Tn_offset] = ll[local_offset+node_Tn_offset]/(eps_r*xx[local_offset+node_Tn_offset]+eps_a); // temperature
-
-            if(region->get_advanced_model()->enable_Tp())
-              ll[local_offset+node_Tp_offset] = ll[local_offset+node_Tp_offset]/(eps_r*xx[local_offset+node_Tp_offset]+eps_a); // temperature
-          }
-
-          N += (region->ebm_n_variables()-1)*region->n_on_processor_node();
-
-          break;
-        }
-        case InsulatorRegion :
-        case ElectrodeRegion :
-        case MetalRegion     :
-        {
-          unsigned int node_psi_offset = region->ebm_variable_offset(POTENTIAL);
-          unsigned int node_Tl_offset  = region->ebm_variable_offset(TEMPERATURE);
-
-          SimulationRegion::const_processor_node_iterator it = region->on_processor_nodes_begin();
-          SimulationRegion::const_processor_node_iterator it_end = region->on_processor_nodes_end();
-          for(; it!=it_end; ++it)
-          {
-            const FVM_Node * fvm_node = *it;
-            unsigned int local_offset = fvm_node->local_offset();
-
-            ll[local_offset+node_psi_offset] = 0;
-
-            if(region->get_advanced_model()->enable_Tl())
-              ll[local_offset+node_Tl_offset] = ll[local_offset+node_Tl_offset]/(eps_r*xx[local_offset+node_Tl_offset]+eps_a); // temperature
-          }
-
-          N += (region->ebm_n_variables()-1)*region->n_on_processor_node();
-
-          break;
-        }
-        case VacuumRegion:
-        break;
-        default: genius_error();
-    }
-  }
-
-
-  // error estimate for each bc
-  if( Genius::processor_id() == Genius::n_processors()-1 )
-    for(unsigned int b=0; b<_system.get_bcs()->n_bcs(); b++)
-    {
-      BoundaryCondition * bc = _system.get_bcs()->get_bc(b);
-      unsigned int array_offset = bc->array_offset();
-      if( array_offset != invalid_uint )
-        ll[array_offset] = 0;
-    }
-
-  VecRestoreArray(x, &xx);
-  VecRestoreArray(LTE, &ll);
-
-  VecNorm(LTE, NORM_2, &r);
-
-  //for parallel situation, we should sum N of all the processor
-  Parallel::sum( N );
-
-  if( N>0 )
-  {
-    r /= sqrt(static_cast<double>(N));
-    return r;
-  }
-
-  return 1.0;
-
+  return variable_LTE_norm();
 }
 
 
 
 void EBM3Solver::error_norm()
 {
-  PetscScalar    *xx;
-  PetscScalar    *ff;
-
-  // scatte global solution vector x to local vector lx
-  // this is not necessary since it had already done in function evaluation
-  //VecScatterBegin(scatter, x, lx, INSERT_VALUES, SCATTER_FORWARD);
-  //VecScatterEnd  (scatter, x, lx, INSERT_VALUES, SCATTER_FORWARD);
-
-  // scatte global function vector f to local vector lf
-  VecScatterBegin(scatter, f, lf, INSERT_VALUES, SCATTER_FORWARD);
-  VecScatterEnd  (scatter, f, lf, INSERT_VALUES, SCATTER_FORWARD);
-
-
-  VecGetArray(lx, &xx);  // solution value
-  VecGetArray(lf, &ff);  // function value
-
-  // do clear
-  potential_norm        = 0;
-  electron_norm         = 0;
-  hole_norm             = 0;
-  temperature_norm      = 0;
-  elec_temperature_norm = 0;
-  hole_temperature_norm = 0;
+  // x and f norm of each variable, electrode norm from bc rows
+  variable_error_norm(true);
+}
 
-  poisson_norm              = 0;
-  elec_continuity_norm       = 0;
-  hole_continuity_norm       = 0;
-  heat_equation_norm        = 0;
-  elec_energy_equation_norm = 0;
-  hole_energy_equation_norm = 0;
-  electrode_norm            = 0;
 
+/*------------------------------------------------------------------
+ * the local offsets of each variable for error norm and LTE
+ */
+void EBM3Solver::build_norm_index()
+{
   for(unsigned int n=0; n<_system.n_regions(); n++)
   {
-    // only consider semiconductor region
     const SimulationRegion * region = _system.region(n);
 
     switch ( region->type() )
@@ -821,30 +692,31 @@ void EBM3Solver::error_norm()
             const FVM_Node * fvm_node = *it;
             unsigned int offset = fvm_node->local_offset();
 
-            potential_norm   += xx[offset+node_psi_offset]*xx[offset+node_psi_offset];
-            electron_norm    += xx[offset+node_n_offset]*xx[offset+node_n_offset];
-            hole_norm        += xx[offset+node_p_offset]*xx[offset+node_p_offset];
-
-            poisson_norm        += ff[offset+node_psi_offset]*ff[offset+node_psi_offset];
-            elec_continuity_norm += ff[offset+node_n_offset]*ff[offset+node_n_offset];
-            hole_continuity_norm += ff[offset+node_p_offset]*ff[offset+node_p_offset];
+            norm_index[NormPotential].push_back(offset+node_psi_offset);
+            norm_index[NormElectron].push_back(offset+node_n_offset);
+            norm_index[NormHole].push_back(offset+node_p_offset);
+            lte_index.push_back(offset+node_n_offset);
+            lte_index.push_back(offset+node_p_offset);
 
             if(region->get_advanced_model()->enable_Tl())
             {
-              temperature_norm    += xx[offset+node_Tl_offset]*xx[offset+node_Tl_offset];
-              heat_equation_norm  += ff[offset+node_Tl_offset]*ff[offset+node_Tl_offset];
+              norm_index[NormTemperature].push_back(offset+node_Tl_offset);
+              lte_index.push_back(offset+node_Tl_offset);
             }
 
+            // the x norm of carrier temperature is taken over Tn = (n*Tn)/n
             if(region->get_advanced_model()->enable_Tn())
             {
-              elec_temperature_norm      += xx[offset+node_Tn_offset]/xx[offset+node_n_offset]*xx[offset+node_Tn_offset]/xx[offset+node_n_offset];
-              elec_energy_equation_norm  += ff[offset+node_Tn_offset]*ff[offset+node_Tn_offset];
+              norm_index[NormElecTemperature].push_back(offset+node_Tn_offset);
+              norm_divisor[NormElecTemperature].push_back(offset+node_n_offset);
+              lte_index.push_back(offset+node_Tn_offset);
             }
 
             if(region->get_advanced_model()->enable_Tp())
             {
-              hole_temperature_norm      += xx[offset+node_Tp_offset]/xx[offset+node_p_offset]*xx[offset+node_Tp_offset]/xx[offset+node_p_offset];
-              hole_energy_equation_norm  += ff[offset+node_Tp_offset]*ff[offset+node_Tp_offset];
+              norm_index[NormHoleTemperature].push_back(offset+node_Tp_offset);
+              norm_divisor[NormHoleTemperature].push_back(offset+node_p_offset);
+              lte_index.push_back(offset+node_Tp_offset);
             }
           }
           break;
@@ -863,13 +735,11 @@ void EBM3Solver::error_norm()
             const FVM_Node * fvm_node = *it;
             unsigned int offset = fvm_node->local_offset();
 
-            potential_norm   += xx[offset+node_psi_offset]*xx[offset+node_psi_offset];
-            poisson_norm     += ff[offset+node_psi_offset]*ff[offset+node_psi_offset];
-
+            norm_index[NormPotential].push_back(offset+node_psi_offset);
             if(region->get_advanced_model()->enable_Tl())
             {
-              temperature_norm    += xx[offset+node_Tl_offset]*xx[offset+node_Tl_offset];
-              heat_equation_norm  += ff[offset+node_Tl_offset]*ff[offset+node_Tl_offset];
+              norm_index[NormTemperature].push_back(offset+node_Tl_offset);
+              lte_index.push_back(offset+node_Tl_offset);
             }
           }
           break;
@@ -879,65 +749,6 @@ void EBM3Solver::error_norm()
         default: genius_error();
     }
   }
-
-
-  if(Genius::processor_id() == Genius::n_processors() -1)
-    for(unsigned int b=0; b<_system.get_bcs()->n_bcs(); b++)
-    {
-      const BoundaryCondition * bc = _system.get_bcs()->get_bc(b);
-      unsigned int offset = bc->local_offset();
-      if( offset != invalid_uint )
-      {
-        potential_norm += xx[offset]*xx[offset];
-
-        PetscScalar scaling = 1.0;
-        if(bc->is_electrode())
-          scaling = bc->ext_circuit()->mna_scaling(SolverSpecify::dt);
-
-        electrode_norm += scaling*ff[offset]*scaling*ff[offset];
-      }
-    }
-
-  // sum of variable value on all processors
-  std::vector<PetscScalar> norm_buffer;
-
-  norm_buffer.push_back(potential_norm);
-  norm_buffer.push_back(electron_norm);
-  norm_buffer.push_back(hole_norm);
-  norm_buffer.push_back(temperature_norm);
-  norm_buffer.push_back(elec_temperature_norm);
-  norm_buffer.push_back(hole_temperature_norm);
-
-  norm_buffer.push_back(poisson_norm);
-  norm_buffer.push_back(elec_continuity_norm);
-  norm_buffer.push_back(hole_continuity_norm);
-  norm_buffer.push_back(heat_equation_norm);
-  norm_buffer.push_back(elec_energy_equation_norm);
-  norm_buffer.push_back(hole_energy_equation_norm);
-  norm_buffer.push_back(electrode_norm);
-
-  Parallel::sum(norm_buffer);
-
-
-  // sqrt to get L2 norm
-  potential_norm        = sqrt(norm_buffer[0]);
-  electron_norm         = sqrt(norm_buffer[1]);
-  hole_norm             = sqrt(norm_buffer[2]);
-  temperature_norm      = sqrt(norm_buffer[3]);
-  elec_temperature_norm = sqrt(norm_buffer[4]);
-  hole_temperature_norm = sqrt(norm_buffer[5]);
-
-  poisson_norm              = sqrt(norm_buffer[6]);
-  elec_continuity_norm      = sqrt(norm_buffer[7]);
-  hole_continuity_norm      = sqrt(norm_buffer[8]);
-  heat_equation_norm        = sqrt(norm_buffer[9]);
-  elec_energy_equation_norm = sqrt(norm_buffer[10]);
-  hole_energy_equation_norm = sqrt(norm_buffer[11]);
-  electrode_norm            = sqrt(norm_buffer[12]);
-
-  VecRestoreArray(lx, &xx);
-  VecRestoreArray(lf, &ff);
-
 }
 
 
@@ -980,8 +791,11 @@ void EBM3Solver::build_petsc_sens_residual(Vec x, Vec r)
   // evaluate governing equations of DDML1 in all the regions
   for(unsigned int n=0; n<_system.n_regions(); n++)
   {
+    if( region_frozen(n) ) continue;
     SimulationRegion * region = _system.region(n);
+    START_LOG("EBM3_Function(" + region->type_name() + ")", "EBM3Solver");
     region->EBM3_Function(lxx, r, add_value_flag);
+    STOP_LOG("EBM3_Function(" + region->type_name() + ")", "EBM3Solver");
   }
 
 #if defined(HAVE_FENV_H) && defined(DEBUG)
@@ -1028,7 +842,9 @@ void EBM3Solver::build_petsc_sens_residual(Vec x, Vec r)
   for(unsigned int b=0; b<_system.get_bcs()->n_bcs(); b++)
   {
     BoundaryCondition * bc = _system.get_bcs()->get_bc(b);
+    START_LOG("EBM3_Function(" + bc->bc_type_name() + ")", "EBM3Solver");
     bc->EBM3_Function(lxx, r, add_value_flag);
+    STOP_LOG("EBM3_Function(" + bc->bc_type_name() + ")", "EBM3Solver");
   }
 
 #if defined(HAVE_FENV_H) && defined(DEBUG)
@@ -1075,8 +891,11 @@ void EBM3Solver::build_petsc_sens_jacobian(Vec x, Mat *, Mat *)
   // evaluate Jacobian matrix of governing equations of EBM in all the regions
   for(unsigned int n=0; n<_system.n_regions(); n++)
   {
+    if( region_frozen(n) ) continue;
     SimulationRegion * region = _system.region(n);
+    START_LOG("EBM3_Jacobian(" + region->type_name() + ")", "EBM3Solver");
     region->EBM3_Jacobian(lxx, &J, add_value_flag);
+    STOP_LOG("EBM3_Jacobian(" + region->type_name() + ")", "EBM3Solver");
   }
 
 #if defined(HAVE_FENV_H) && defined(DEBUG)
@@ -1131,16 +950,16 @@ void EBM3Solver::build_petsc_sens_jacobian(Vec x, Mat *, Mat *)
     bc->EBM3_Jacobian_Preprocess(lxx, &J, src_row, dst_row, clear_row);
   }
 
-  //add source rows to destination rows
-  PetscUtils::MatAddRowToRow(J, src_row, dst_row);
-  // clear row
-  PetscUtils::MatZeroRows(J, clear_row.size(), clear_row.empty() ? NULL : &clear_row[0], 0.0);
+  //add source rows to destination rows, and clear rows
+  PetscUtils::MatAddClearRow(J, src_row, dst_row, clear_row);
   add_value_flag = NOT_SET_VALUES;
   // evaluate Jacobian matrix of governing equations of EBM for all the boundaries
   for(unsigned int b=0; b<_system.get_bcs()->n_bcs(); b++)
   {
     BoundaryCondition * bc = _system.get_bcs()->get_bc(b);
+    START_LOG("EBM3_Jacobian(" + bc->bc_type_name() + ")", "EBM3Solver");
     bc->EBM3_Jacobian(lxx, &J, add_value_flag);
+    STOP_LOG("EBM3_Jacobian(" + bc->bc_type_name() + ")", "EBM3Solver");
   }
 
 #if defined(HAVE_FENV_H) && defined(DEBUG)
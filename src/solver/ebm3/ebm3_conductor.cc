@@ -154,6 +154,7 @@ void ElectrodeSimulationRegion::EBM3_Function(PetscScalar * x, Vec f, InsertMode
   {
     // fvm_node of node1
     const FVM_Node * fvm_n1 = (*it).first;
+    const unsigned int edge_index = it - edges_begin();
     // fvm_node of node2
     const FVM_Node * fvm_n2 = (*it).second;
 
@@ -184,7 +185,7 @@ void ElectrodeSimulationRegion::EBM3_Function(PetscScalar * x, Vec f, InsertMode
       PetscScalar eps = 0.5*(eps1+eps2);       // eps at mid point of the edge
 
       // "flux" from node 2 to node 1
-      PetscScalar f_psi =  eps*fvm_n1->cv_surface_area(fvm_n2)*(V2 - V1)/fvm_n1->distance(fvm_n2) ;
+      PetscScalar f_psi =  eps*this->edge_cv_surface_area(edge_index)*(V2 - V1)/this->edge_length(edge_index) ;
 
       // ignore thoese ghost nodes
       if( fvm_n1->on_processor() )
@@ -212,7 +213,7 @@ void ElectrodeSimulationRegion::EBM3_Function(PetscScalar * x, Vec f, InsertMode
         PetscScalar T2   =  x[n2_local_offset+node_Tl_offset];
         PetscScalar kap2 =  mt->thermal->HeatConduction(T2);
         PetscScalar kap = 0.5*(kap1+kap2);       // kapa at mid point of the edge
-        PetscScalar f_q =  kap*fvm_n1->cv_surface_area(fvm_n2)*(T2 - T1)/fvm_n1->distance(fvm_n2) ;
+        PetscScalar f_q =  kap*this->edge_cv_surface_area(edge_index)*(T2 - T1)/this->edge_length(edge_index) ;
         // ignore thoese ghost nodes
         if( fvm_n1->on_processor() )
         {
@@ -276,6 +277,7 @@ void ElectrodeSimulationRegion::EBM3_Jacobian(PetscScalar * x, Mat *jac, InsertM
   {
     // fvm_node of node1
     const FVM_Node * fvm_n1 = (*it).first;
+    const unsigned int edge_index = it - edges_begin();
     // fvm_node of node2
     const FVM_Node * fvm_n2 = (*it).second;
 
@@ -306,7 +308,7 @@ void ElectrodeSimulationRegion::EBM3_Jacobian(PetscScalar * x, Mat *jac, InsertM
 
       PetscScalar eps = 0.5*(eps1+eps2);       // eps at mid point of the edge
       // "flux" from node 2 to node 1
-      AutoDScalar f_psi =  eps*fvm_n1->cv_surface_area(fvm_n2)*(V2 - V1)/fvm_n1->distance(fvm_n2) ;
+      AutoDScalar f_psi =  eps*this->edge_cv_surface_area(edge_index)*(V2 - V1)/this->edge_length(edge_index) ;
 
       // ignore thoese ghost nodes
       if( fvm_n1->on_processor() )
@@ -335,7 +337,7 @@ void ElectrodeSimulationRegion::EBM3_Jacobian(PetscScalar * x, Mat *jac, InsertM
         PetscScalar kap2 =  mt->thermal->HeatConduction(T2.getValue());
 
         PetscScalar kap = 0.5*(kap1+kap2);       // kapa at mid point of the edge
-        AutoDScalar f_q =  kap*fvm_n1->cv_surface_area(fvm_n2)*(T2 - T1)/fvm_n1->distance(fvm_n2) ;
+        AutoDScalar f_q =  kap*this->edge_cv_surface_area(edge_index)*(T2 - T1)/this->edge_length(edge_index) ;
 
         // ignore thoese ghost nodes
         if( fvm_n1->on_processor() )
@@ -154,6 +154,7 @@ void InsulatorSimulationRegion::EBM3_Function(PetscScalar * x, Vec f, InsertMode
   {
     // fvm_node of node1
     const FVM_Node * fvm_n1 = (*it).first;
+    const unsigned int edge_index = it - edges_begin();
     // fvm_node of node2
     const FVM_Node * fvm_n2 = (*it).second;
 
@@ -184,7 +185,7 @@ void InsulatorSimulationRegion::EBM3_Function(PetscScalar * x, Vec f, InsertMode
       PetscScalar eps = 0.5*(eps1+eps2);       // eps at mid point of the edge
 
       // "flux" from node 2 to node 1
-      PetscScalar f_psi =  eps*fvm_n1->cv_surface_area(fvm_n2)*(V2 - V1)/fvm_n1->distance(fvm_n2) ;
+      PetscScalar f_psi =  eps*this->edge_cv_surface_area(edge_index)*(V2 - V1)/this->edge_length(edge_index) ;
 
       // ignore thoese ghost nodes
       if( fvm_n1->on_processor() )
@@ -212,7 +213,7 @@ void InsulatorSimulationRegion::EBM3_Function(PetscScalar * x, Vec f, InsertMode
         PetscScalar T2   =  x[n2_local_offset+node_Tl_offset];
         PetscScalar kap2 =  mt->thermal->HeatConduction(T2);
         PetscScalar kap = 0.5*(kap1+kap2);       // kapa at mid point of the edge
-        PetscScalar f_q =  kap*fvm_n1->cv_surface_area(fvm_n2)*(T2 - T1)/fvm_n1->distance(fvm_n2) ;
+        PetscScalar f_q =  kap*this->edge_cv_surface_area(edge_index)*(T2 - T1)/this->edge_length(edge_index) ;
         // ignore thoese ghost nodes
         if( fvm_n1->on_processor() )
         {
@@ -276,6 +277,7 @@ void InsulatorSimulationRegion::EBM3_Jacobian(PetscScalar * x, Mat *jac, InsertM
   {
     // fvm_node of node1
     const FVM_Node * fvm_n1 = (*it).first;
+    const unsigned int edge_index = it - edges_begin();
     // fvm_node of node2
     const FVM_Node * fvm_n2 = (*it).second;
 
@@ -306,7 +308,7 @@ void InsulatorSimulationRegion::EBM3_Jacobian(PetscScalar * x, Mat *jac, InsertM
 
       PetscScalar eps = 0.5*(eps1+eps2);       // eps at mid point of the edge
       // "flux" from node 2 to node 1
-      AutoDScalar f_psi =  eps*fvm_n1->cv_surface_area(fvm_n2)*(V2 - V1)/fvm_n1->distance(fvm_n2) ;
+      AutoDScalar f_psi =  eps*this->edge_cv_surface_area(edge_index)*(V2 - V1)/this->edge_length(edge_index) ;
 
       // ignore thoese ghost nodes
       if( fvm_n1->on_processor() )
@@ -335,7 +337,7 @@ void InsulatorSimulationRegion::EBM3_Jacobian(PetscScalar * x, Mat *jac, InsertM
         PetscScalar kap2 =  mt->thermal->HeatConduction(T2.getValue());
 
         PetscScalar kap = 0.5*(kap1+kap2);       // kapa at mid point of the edge
-        AutoDScalar f_q =  kap*fvm_n1->cv_surface_area(fvm_n2)*(T2 - T1)/fvm_n1->distance(fvm_n2) ;
+        AutoDScalar f_q =  kap*this->edge_cv_surface_area(edge_index)*(T2 - T1)/this->edge_length(edge_index) ;
 
         // ignore thoese ghost nodes
         if( fvm_n1->on_processor() )
@@ -520,26 +522,6 @@ void InsulatorSimulationRegion::EBM3_Update_Solution(PetscScalar *lxx)
 
   }
 
-  // addtional work: compute electrical field for all the cell.
-  // Since this value is only used for reference.
-  // It can be done simply by weighted average of cell's electrical field
-  for(unsigned int n=0; n<n_cell(); ++n)
-  {
-    const Elem * elem = this->get_region_elem(n);
-    FVM_CellData * elem_data = this->get_region_elem_data(n);
-
-    std::vector<PetscScalar> psi_vertex;
-
-    for(unsigned int nd=0; nd<elem->n_nodes(); ++nd)
-    {
-      const FVM_Node * fvm_node = elem->get_fvm_node(nd);
-      const FVM_NodeData * fvm_node_data = fvm_node->node_data();
-      psi_vertex.push_back  ( fvm_node_data->psi() );
-    }
-    // compute the gradient in the cell
-    elem_data->E()  = - elem->gradient(psi_vertex);  // E = - grad(psi)
-  }
-
 }
 
 
@@ -158,6 +158,7 @@ void MetalSimulationRegion::EBM3_Function(PetscScalar * x, Vec f, InsertMode &ad
   {
     // fvm_node of node1
     const FVM_Node * fvm_n1 = (*it).first;
+    const unsigned int edge_index = it - edges_begin();
     // fvm_node of node2
     const FVM_Node * fvm_n2 = (*it).second;
 
@@ -184,10 +185,10 @@ void MetalSimulationRegion::EBM3_Function(PetscScalar * x, Vec f, InsertMode &ad
       PetscScalar rho2 =  0;
 
       // truncated to positive
-      double S = std::abs(fvm_n1->cv_surface_area(fvm_n2));
+      double S = std::abs(this->edge_cv_surface_area(edge_index));
 
       // "flux" from node 2 to node 1
-      PetscScalar f_psi =  sigma*S*(V2 - V1)/fvm_n1->distance(fvm_n2) ;
+      PetscScalar f_psi =  sigma*S*(V2 - V1)/this->edge_length(edge_index) ;
 
       // ignore thoese ghost nodes
       if( fvm_n1->on_processor() )
@@ -215,7 +216,7 @@ void MetalSimulationRegion::EBM3_Function(PetscScalar * x, Vec f, InsertMode &ad
         PetscScalar T2   =  x[n2_local_offset+node_Tl_offset];
         PetscScalar kap2 =  mt->thermal->HeatConduction(T2);
         PetscScalar kap = 0.5*(kap1+kap2);       // kapa at mid point of the edge
-        PetscScalar f_q =  kap*S*(T2 - T1)/fvm_n1->distance(fvm_n2) ;
+        PetscScalar f_q =  kap*S*(T2 - T1)/this->edge_length(edge_index) ;
         // ignore thoese ghost nodes
         if( fvm_n1->on_processor() )
         {
@@ -281,6 +282,7 @@ void MetalSimulationRegion::EBM3_Jacobian(PetscScalar * x, Mat *jac, InsertMode
   {
     // fvm_node of node1
     const FVM_Node * fvm_n1 = (*it).first;
+    const unsigned int edge_index = it - edges_begin();
     // fvm_node of node2
     const FVM_Node * fvm_n2 = (*it).second;
 
@@ -307,10 +309,10 @@ void MetalSimulationRegion::EBM3_Jacobian(PetscScalar * x, Mat *jac, InsertMode
       PetscScalar rho2 =  0;
 
       // truncated to positive
-      double S = std::abs(fvm_n1->cv_surface_area(fvm_n2));
+      double S = std::abs(this->edge_cv_surface_area(edge_index));
 
       // "flux" from node 2 to node 1
-      AutoDScalar f_psi =  sigma*S*(V2 - V1)/fvm_n1->distance(fvm_n2) ;
+      AutoDScalar f_psi =  sigma*S*(V2 - V1)/this->edge_length(edge_index) ;
 
       // ignore thoese ghost nodes
       if( fvm_n1->on_processor() )
@@ -339,7 +341,7 @@ void MetalSimulationRegion::EBM3_Jacobian(PetscScalar * x, Mat *jac, InsertMode
         PetscScalar kap2 =  mt->thermal->HeatConduction(T2.getValue());
 
         PetscScalar kap = 0.5*(kap1+kap2);       // kapa at mid point of the edge
-        AutoDScalar f_q =  kap*S*(T2 - T1)/fvm_n1->distance(fvm_n2) ;
+        AutoDScalar f_q =  kap*S*(T2 - T1)/this->edge_length(edge_index) ;
 
         // ignore thoese ghost nodes
         if( fvm_n1->on_processor() )
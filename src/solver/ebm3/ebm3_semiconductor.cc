@@ -26,6 +26,7 @@
 #include "semiconductor_region.h"
 #include "solver_specify.h"
 #include "log.h"
+#include "fermi_table.h"
 
 #include "jflux1.h"
 #include "jflux2.h"
@@ -244,6 +245,15 @@ void SemiconductorSimulationRegion::EBM3_Function(PetscScalar * x, Vec f, Insert
   // first, search all the element in this region and process "cell" related terms
   // note, they are all local element, thus must be processed
 
+  std::vector<PetscScalar> psi_vertex;
+  std::vector<PetscScalar> phin_vertex;
+  std::vector<PetscScalar> phip_vertex;
+  std::vector<PetscScalar> Jn_edge;
+  std::vector<PetscScalar> Jp_edge;
+  std::vector<unsigned int> sides;
+  std::vector<SimulationRegion *> regions;
+  std::vector<PetscScalar> psi_vertex_neighbor;
+
   const_element_iterator it = elements_begin();
   const_element_iterator it_end = elements_end();
   for(unsigned int nelem=0 ; it!=it_end; ++it, ++nelem)
@@ -263,8 +273,8 @@ void SemiconductorSimulationRegion::EBM3_Function(PetscScalar * x, Vec f, Insert
     VectorValue<PetscScalar> Jnv;
     VectorValue<PetscScalar> Jpv;
 
-    std::vector<PetscScalar> Jn_edge; //store all the edge Jn
-    std::vector<PetscScalar> Jp_edge; //store all the edge Jp
+    Jn_edge.clear(); //store all the edge Jn
+    Jp_edge.clear(); //store all the edge Jp
 
     // E field parallel to current flow
     PetscScalar Epn=0;
@@ -279,9 +289,9 @@ void SemiconductorSimulationRegion::EBM3_Function(PetscScalar * x, Vec f, Insert
     {
       // build the gradient of psi and fermi potential in this cell.
       // which are the vector of electric field and current density.
-      std::vector<PetscScalar> psi_vertex(elem->n_nodes());
-      std::vector<PetscScalar> phin_vertex(elem->n_nodes());
-      std::vector<PetscScalar> phip_vertex(elem->n_nodes());
+      psi_vertex.resize(elem->n_nodes());
+      phin_vertex.resize(elem->n_nodes());
+      phip_vertex.resize(elem->n_nodes());
 
       for(unsigned int nd=0; nd<elem->n_nodes(); ++nd)
       {
@@ -328,8 +338,8 @@ void SemiconductorSimulationRegion::EBM3_Function(PetscScalar * x, Vec f, Insert
       if(get_advanced_model()->ESurface && insulator_interface_elem)
       {
         // get all the sides on insulator interface
-        std::vector<unsigned int> sides;
-        std::vector<SimulationRegion *> regions;
+        sides.clear();
+        regions.clear();
         elem_on_insulator_interface(elem, sides, regions);
 
         VectorValue<PetscScalar> E_insul(0,0,0);
@@ -339,7 +349,7 @@ void SemiconductorSimulationRegion::EBM3_Function(PetscScalar * x, Vec f, Insert
         for(unsigned int ne=0; ne<sides.size(); ++ne)
         {
           const Elem * elem_neighbor = elem->neighbor(sides[ne]);
-          std::vector<PetscScalar> psi_vertex_neighbor;
+          psi_vertex_neighbor.clear();
           for(unsigned int nd=0; nd<elem_neighbor->n_nodes(); ++nd)
           {
             const FVM_Node * fvm_node_neighbor = elem_neighbor->get_fvm_node(nd);
@@ -433,7 +443,7 @@ void SemiconductorSimulationRegion::EBM3_Function(PetscScalar * x, Vec f, Insert
       {
         // use truncated partial area to avoid negative area due to bad mesh elem
         truncated_partial_area =  this->truncated_partial_area(elem, ne);
-        truncated_partial_volume =  elem->partial_volume_with_edge_truncated(ne);
+        truncated_partial_volume =  this->truncated_partial_volume(elem, ne);
       }
 
       unsigned int n1_local_offset = fvm_n1->local_offset();
@@ -475,8 +485,8 @@ void SemiconductorSimulationRegion::EBM3_Function(PetscScalar * x, Vec f, Insert
         PetscScalar Ev1 =  -(e*V1 + n1_data->affinity() - kb*T1*log(mt->band->nie(p1, n1, T1)));
         if(get_advanced_model()->Fermi)
         {
-          Ec1 = Ec1 - kb*T1*log(gamma_f(fabs(n1)/n1_data->Nc()));
-          Ev1 = Ev1 + kb*T1*log(gamma_f(fabs(p1)/n1_data->Nv()));
+          Ec1 = Ec1 - kb*T1*log_gamma_f(fabs(n1)/n1_data->Nc(), get_advanced_model()->FermiTable);
+          Ev1 = Ev1 + kb*T1*log_gamma_f(fabs(p1)/n1_data->Nv(), get_advanced_model()->FermiTable);
         }
 
         PetscScalar eps1 =  n1_data->eps();                        // eps
@@ -511,8 +521,8 @@ void SemiconductorSimulationRegion::EBM3_Function(PetscScalar * x, Vec f, Insert
         PetscScalar Ev2 =  -(e*V2 + n2_data->affinity() - kb*T2*log(mt->band->nie(p2, n2, T2)));
         if(get_advanced_model()->Fermi)
         {
-          Ec2 = Ec2 - kb*T2*log(gamma_f(fabs(n2)/n2_data->Nc()));
-          Ev2 = Ev2 + kb*T2*log(gamma_f(fabs(p2)/n2_data->Nv()));
+          Ec2 = Ec2 - kb*T2*log_gamma_f(fabs(n2)/n2_data->Nc(), get_advanced_model()->FermiTable);
+          Ev2 = Ev2 + kb*T2*log_gamma_f(fabs(p2)/n2_data->Nv(), get_advanced_model()->FermiTable);
         }
 
         PetscScalar eps2 =  n2_data->eps();                         // eps
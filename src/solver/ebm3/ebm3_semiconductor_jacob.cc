@@ -23,8 +23,10 @@
 #include "elem.h"
 #include "simulation_system.h"
 #include "semiconductor_region.h"
+#include "fvm_node_data_semiconductor.h"
 #include "solver_specify.h"
 #include "log.h"
+#include "fermi_table.h"
 
 #include "jflux1.h"
 #include "jflux2.h"
@@ -74,6 +76,13 @@ void SemiconductorSimulationRegion::EBM3_Jacobian(PetscScalar * x, Mat *jac, Ins
   // search all the element in this region.
   // note, they are all local element, thus must be processed
 
+  std::vector<AutoDScalar> psi_vertex;
+  std::vector<AutoDScalar> phin_vertex;
+  std::vector<AutoDScalar> phip_vertex;
+  std::vector<unsigned int> sides;
+  std::vector<SimulationRegion *> regions;
+  std::vector<AutoDScalar> psi_vertex_neighbor;
+
   const_element_iterator it = elements_begin();
   const_element_iterator it_end = elements_end();
   for(; it!=it_end; ++it)
@@ -117,9 +126,9 @@ void SemiconductorSimulationRegion::EBM3_Jacobian(PetscScalar * x, Mat *jac, Ins
       // which are the vector of electric field and current density.
       // here use type AutoDScalar, we should make sure the order of independent variable keeps the
       // same all the time
-      std::vector<AutoDScalar> psi_vertex;
-      std::vector<AutoDScalar> phin_vertex;
-      std::vector<AutoDScalar> phip_vertex;
+      psi_vertex.clear();
+      phin_vertex.clear();
+      phip_vertex.clear();
 
       for(unsigned int nd=0; nd<elem->n_nodes(); ++nd)
       {
@@ -171,8 +180,8 @@ void SemiconductorSimulationRegion::EBM3_Jacobian(PetscScalar * x, Mat *jac, Ins
       if(get_advanced_model()->ESurface && insulator_interface_elem)
       {
         // get all the sides on insulator interface
-        std::vector<unsigned int> sides;
-        std::vector<SimulationRegion *> regions;
+        sides.clear();
+        regions.clear();
         elem_on_insulator_interface(elem, sides, regions);
 
         VectorValue<AutoDScalar> E_insul(0.0,0.0,0.0);
@@ -185,7 +194,7 @@ void SemiconductorSimulationRegion::EBM3_Jacobian(PetscScalar * x, Mat *jac, Ins
         {
           const Elem * elem_neighbor = elem->neighbor(sides[ne]);
 
-          std::vector<AutoDScalar> psi_vertex_neighbor;
+          psi_vertex_neighbor.clear();
           for(unsigned int nd=0; nd<elem_neighbor->n_nodes(); ++nd)
           {
             const FVM_Node * fvm_node_neighbor = elem_neighbor->get_fvm_node(nd);
@@ -297,7 +306,7 @@ void SemiconductorSimulationRegion::EBM3_Jacobian(PetscScalar * x, Mat *jac, Ins
       {
         // use truncated partial area to avoid negative area due to bad mesh elem
         truncated_partial_area =  this->truncated_partial_area(elem, ne);
-        truncated_partial_volume =  elem->partial_volume_with_edge_truncated(ne);
+        truncated_partial_volume =  this->truncated_partial_volume(elem, ne);
       }
 
       unsigned int n1_local_offset = fvm_n1->local_offset();
@@ -355,8 +364,8 @@ void SemiconductorSimulationRegion::EBM3_Jacobian(PetscScalar * x, Mat *jac, Ins
         AutoDScalar Ev1 =  -(e*V1 + n1_data->affinity() - kb*T1*log(mt->band->nie(p1, n1, T1)));//valence band energy level
         if(get_advanced_model()->Fermi)
         {
-          Ec1 = Ec1 - kb*T1*log(gamma_f(fabs(n1)/n1_data->Nc()));
-          Ev1 = Ev1 + kb*T1*log(gamma_f(fabs(p1)/n1_data->Nv()));
+          Ec1 = Ec1 - kb*T1*log_gamma_f(fabs(n1)/n1_data->Nc(), get_advanced_model()->FermiTable);
+          Ev1 = Ev1 + kb*T1*log_gamma_f(fabs(p1)/n1_data->Nv(), get_advanced_model()->FermiTable);
         }
         PetscScalar eps1 =  n1_data->eps();                        // eps
         AutoDScalar kap1 =  mt->thermal->HeatConduction(T1);
@@ -406,8 +415,8 @@ void SemiconductorSimulationRegion::EBM3_Jacobian(PetscScalar * x, Mat *jac, Ins
         AutoDScalar Ev2 =  -(e*V2 + n2_data->affinity() - kb*T2*log(mt->band->nie(p2, n2, T2)));//valence band energy level
         if(get_advanced_model()->Fermi)
         {
-          Ec2 = Ec2 - kb*T2*log(gamma_f(fabs(n2)/n2_data->Nc()));
-          Ev2 = Ev2 + kb*T2*log(gamma_f(fabs(p2)/n2_data->Nv()));
+          Ec2 = Ec2 - kb*T2*log_gamma_f(fabs(n2)/n2_data->Nc(), get_advanced_model()->FermiTable);
+          Ev2 = Ev2 + kb*T2*log_gamma_f(fabs(p2)/n2_data->Nv(), get_advanced_model()->FermiTable);
         }
         PetscScalar eps2 =  n2_data->eps();                         // eps
         AutoDScalar kap2 =  mt->thermal->HeatConduction(T2);
@@ -1066,6 +1075,10 @@ void SemiconductorSimulationRegion::EBM3_Update_Solution(PetscScalar *lxx)
   unsigned int node_Tn_offset  = ebm_variable_offset(E_TEMP);
   unsigned int node_Tp_offset  = ebm_variable_offset(H_TEMP);
 
+  // save the last solution column by column, all the on local nodes hold a node data
+  _node_data_storage.copy_scalar(FVM_Semiconductor_NodeData::_psi_, FVM_Semiconductor_NodeData::_psi_last_);
+  _node_data_storage.copy_scalar(FVM_Semiconductor_NodeData::_n_,   FVM_Semiconductor_NodeData::_n_last_);
+  _node_data_storage.copy_scalar(FVM_Semiconductor_NodeData::_p_,   FVM_Semiconductor_NodeData::_p_last_);
 
   local_node_iterator node_it = on_local_nodes_begin();
   local_node_iterator node_it_end = on_local_nodes_end();
@@ -1081,15 +1094,12 @@ void SemiconductorSimulationRegion::EBM3_Update_Solution(PetscScalar *lxx)
     FVM_NodeData * node_data = fvm_node->node_data();  genius_assert(node_data!=NULL);
 
     //update psi
-    node_data->psi_last() =  node_data->psi();
     node_data->psi()      =  V;
 
     // electron density
-    node_data->n_last()   = node_data->n();
     node_data->n()        =  n;
 
     // hole density
-    node_data->p_last()   = node_data->p();
     node_data->p()        =  p;
 
     // lattice temperature if required
@@ -1151,25 +1161,5 @@ void SemiconductorSimulationRegion::EBM3_Update_Solution(PetscScalar *lxx)
     }
   }
 
-  // addtional work: compute electrical field for all the cell.
-  // Since this value is only used for reference.
-  // It can be done simply by weighted average of cell's electrical field
-  for(unsigned int n=0; n<n_cell(); ++n)
-  {
-    const Elem * elem = this->get_region_elem(n);
-    FVM_CellData * elem_data = this->get_region_elem_data(n);
-
-    std::vector<PetscScalar> psi_vertex;
-
-    for(unsigned int nd=0; nd<elem->n_nodes(); ++nd)
-    {
-      const FVM_Node * fvm_node = elem->get_fvm_node(nd);
-      const FVM_NodeData * fvm_node_data = fvm_node->node_data();
-      psi_vertex.push_back  ( fvm_node_data->psi() );
-    }
-    // compute the gradient in the cell
-    elem_data->E()  = - elem->gradient(psi_vertex);  // E = - grad(psi)
-  }
-
 
 }
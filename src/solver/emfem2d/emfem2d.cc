@@ -23,6 +23,7 @@
 #include <sstream>
 
 #include "mesh_base.h"
+#include "mesh_tools.h"
 #include "emfem2d/emfem2d.h"
 #include "petsc_type.h"
 #include "fe_type.h"
@@ -52,6 +53,13 @@ int EMFEM2DSolver::create_solver()
   MESSAGE<< '\n' << "EM FEM 2D Solver init..." << std::endl;
   RECORD();
 
+  // there is no full wave solver for 3D mesh (EM_FEM_3D) yet
+  if(_system.mesh().mesh_dimension()!=2)
+  {
+    MESSAGE<<"ERROR at " <<_card.get_fileline()<< " EMFEM2D: Only 2D mesh is supported, use RAYTRACE for 3D optical generation." << std::endl; RECORD();
+    genius_error();
+  }
+
   // set ac variables for each region
   set_variables();
 
@@ -96,7 +104,12 @@ int EMFEM2DSolver::solve()
 {
   START_LOG("EM FEM 2D Linear Solver", "solve");
 
-  // for each wave length, solve 2d fem probelm
+  // no matrix is built yet
+  _last_mode = EM_NONE;
+
+  // for each wave length, solve 2d fem probelm.
+  // all the TE problems are solved before TM ones, so the sources with the same (or adjacent)
+  // wavelength can share the matrix (or preconditioner) of the same polarization
   for(unsigned int n=0; n<_optical_sources.size(); ++n)
   {
     if(_optical_sources[n].TE_weight>0)
@@ -112,7 +125,10 @@ int EMFEM2DSolver::solve()
                        _optical_sources[n].eta,
                        _optical_sources[n].eta_auto);
     }
+  }
 
+  for(unsigned int n=0; n<_optical_sources.size(); ++n)
+  {
     if(_optical_sources[n].TM_weight>0)
     {
       solve_TM_scatter_problem(_optical_sources[n].wave_length,
@@ -149,9 +165,20 @@ void EMFEM2DSolver::solve_TM_scatter_problem(double lambda, double power, double
 {
   MESSAGE<<"Solve TM Mode. WaveLength = "<<lambda/um<< " um, Power = " <<power/(J/s/cm/cm)<<" W/(cm^2)." << std::endl; RECORD();
 
-  build_TM_matrix_rhs(lambda, power, phase0);
+  // the matrix only depends on wavelength and polarization, the incident phase and power only change the RHS
+  bool build_matrix = !(_last_mode == EM_TM && lambda == _last_lambda);
+
+  // for adjacent wavelength, the preconditioner of previous matrix may be good enough
+  bool reuse_pc = _last_mode == EM_TM && std::abs(lambda - _last_lambda) <= _pc_reuse_tol*lambda;
+
+  build_TM_matrix_rhs(lambda, power, phase0, build_matrix);
+
+  if(build_matrix)
+    KSPSetOperators(ksp, A, A, reuse_pc ? SAME_PRECONDITIONER : SAME_NONZERO_PATTERN);//must reset pc by is call!
+
+  _last_mode   = EM_TM;
+  _last_lambda = lambda;
 
-  KSPSetOperators(ksp, A, A, SAME_NONZERO_PATTERN);//must reset pc by is call!
   KSPSolve(ksp,b,x);
 
   KSPConvergedReason reason;
@@ -174,9 +201,20 @@ void EMFEM2DSolver::solve_TE_scatter_problem(double lambda, double power, double
 {
   MESSAGE<<"Solve TE Mode. WaveLength = "<<lambda/um<< " um, Power = " <<power/(J/s/cm/cm)<<" W/(cm^2)." << std::endl; RECORD();
 
-  build_TE_matrix_rhs(lambda, power, phase0);
+  // the matrix only depends on wavelength and polarization, the incident phase and power only change the RHS
+  bool build_matrix = !(_last_mode == EM_TE && lambda == _last_lambda);
+
+  // for adjacent wavelength, the preconditioner of previous matrix may be good enough
+  bool reuse_pc = _last_mode == EM_TE && std::abs(lambda - _last_lambda) <= _pc_reuse_tol*lambda;
+
+  build_TE_matrix_rhs(lambda, power, phase0, build_matrix);
+
+  if(build_matrix)
+    KSPSetOperators(ksp, A, A, reuse_pc ? SAME_PRECONDITIONER : SAME_NONZERO_PATTERN);//must reset pc by is call!
+
+  _last_mode   = EM_TE;
+  _last_lambda = lambda;
 
-  KSPSetOperators(ksp, A, A, SAME_NONZERO_PATTERN);//must reset pc by is call!
   KSPSolve(ksp,b,x);
 
   KSPConvergedReason reason;
@@ -193,7 +231,7 @@ void EMFEM2DSolver::solve_TE_scatter_problem(double lambda, double power, double
 }
 
 
-void EMFEM2DSolver::build_TE_matrix_rhs(double lambda, double power, double phase0)
+void EMFEM2DSolver::build_TE_matrix_rhs(double lambda, double power, double phase0, bool build_matrix)
 {
   //wave vector
   double k = 2*M_PI/lambda;
@@ -213,7 +251,7 @@ void EMFEM2DSolver::build_TE_matrix_rhs(double lambda, double power, double phas
 
   VecZeroEntries(x);
   VecZeroEntries(b);
-  MatZeroEntries(A);
+  if(build_matrix) MatZeroEntries(A);
 
   // process scatter field
   {
@@ -265,6 +303,7 @@ void EMFEM2DSolver::build_TE_matrix_rhs(double lambda, double power, double phas
         const Elem* elem  = *it;
         genius_assert(elem->active());
         if(elem->processor_id()!=Genius::processor_id()) continue;
+        if(!elem_in_domain(elem)) continue;
 
         std::vector<PetscInt> dof_indices;
         this->build_dof_indices(elem, dof_indices);
@@ -279,7 +318,7 @@ void EMFEM2DSolver::build_TE_matrix_rhs(double lambda, double power, double phas
         {
           for (unsigned int m=0; m<phi.size(); m++)
           {
-            for (unsigned int n=0; n<phi.size(); n++)
+            for (unsigned int n=0; n<phi.size() && build_matrix; n++)
             {
               // \nabla \cdot frac{1}{eps} \nabla H^_{sc}
               Ke(m,n) += - JxW[qp]/eps*(  dphidx[m][qp]*dphidx[n][qp]
@@ -297,13 +336,14 @@ void EMFEM2DSolver::build_TE_matrix_rhs(double lambda, double power, double phas
           }
         }
         PetscUtils::VecAdd(b, Fe, dof_indices);
-        PetscUtils::MatAdd(A, Ke, dof_indices);
+        if(build_matrix) PetscUtils::MatAdd(A, Ke, dof_indices);
       }
     }
   }
 
 
-  // process external absobing boundary
+  // process external absobing boundary, it only contributes to the matrix
+  if(build_matrix)
   {
     // Declare a special finite element object for boundary integration.
     AutoPtr<FEBase> fe_face (FEBase::build(dim-1, fe_type));
@@ -385,8 +425,11 @@ void EMFEM2DSolver::build_TE_matrix_rhs(double lambda, double power, double phas
   VecAssemblyBegin(b);
   VecAssemblyEnd(b);
 
-  MatAssemblyBegin(A, MAT_FINAL_ASSEMBLY);
-  MatAssemblyEnd  (A, MAT_FINAL_ASSEMBLY);
+  if(build_matrix)
+  {
+    MatAssemblyBegin(A, MAT_FINAL_ASSEMBLY);
+    MatAssemblyEnd  (A, MAT_FINAL_ASSEMBLY);
+  }
 
   //MatView(A, PETSC_VIEWER_DRAW_WORLD);
   //getchar();
@@ -396,7 +439,7 @@ void EMFEM2DSolver::build_TE_matrix_rhs(double lambda, double power, double phas
 
 
 
-void EMFEM2DSolver::build_TM_matrix_rhs(double lambda, double power, double phase0)
+void EMFEM2DSolver::build_TM_matrix_rhs(double lambda, double power, double phase0, bool build_matrix)
 {
   //wave vector
   double k = 2*M_PI/lambda;
@@ -416,7 +459,7 @@ void EMFEM2DSolver::build_TM_matrix_rhs(double lambda, double power, double phas
 
   VecZeroEntries(x);
   VecZeroEntries(b);
-  MatZeroEntries(A);
+  if(build_matrix) MatZeroEntries(A);
 
   // process scatter field
   {
@@ -468,6 +511,7 @@ void EMFEM2DSolver::build_TM_matrix_rhs(double lambda, double power, double phas
         const Elem* elem  = *it;
         genius_assert(elem->active());
         if(elem->processor_id()!=Genius::processor_id()) continue;
+        if(!elem_in_domain(elem)) continue;
 
         std::vector<PetscInt> dof_indices;
         this->build_dof_indices(elem, dof_indices);
@@ -482,7 +526,7 @@ void EMFEM2DSolver::build_TM_matrix_rhs(double lambda, double power, double phas
         {
           for (unsigned int m=0; m<phi.size(); m++)
           {
-            for (unsigned int n=0; n<phi.size(); n++)
+            for (unsigned int n=0; n<phi.size() && build_matrix; n++)
             {
               // \nabla^2 E^_{sc}
               Ke(m,n) += - JxW[qp]/mu*( dphidx[m][qp]*dphidx[n][qp]
@@ -500,13 +544,14 @@ void EMFEM2DSolver::build_TM_matrix_rhs(double lambda, double power, double phas
           }
         }
         PetscUtils::VecAdd(b, Fe, dof_indices);
-        PetscUtils::MatAdd(A, Ke, dof_indices);
+        if(build_matrix) PetscUtils::MatAdd(A, Ke, dof_indices);
       }
     }
   }
 
 
-  // process external absobing boundary
+  // process external absobing boundary, it only contributes to the matrix
+  if(build_matrix)
   {
     // Declare a special finite element object for boundary integration.
     AutoPtr<FEBase> fe_face (FEBase::build(dim-1, fe_type));
@@ -589,8 +634,11 @@ void EMFEM2DSolver::build_TM_matrix_rhs(double lambda, double power, double phas
   VecAssemblyBegin(b);
   VecAssemblyEnd(b);
 
-  MatAssemblyBegin(A, MAT_FINAL_ASSEMBLY);
-  MatAssemblyEnd  (A, MAT_FINAL_ASSEMBLY);
+  if(build_matrix)
+  {
+    MatAssemblyBegin(A, MAT_FINAL_ASSEMBLY);
+    MatAssemblyEnd  (A, MAT_FINAL_ASSEMBLY);
+  }
 
   //MatView(A, PETSC_VIEWER_DRAW_WORLD);
   //getchar();
@@ -632,6 +680,7 @@ void EMFEM2DSolver::save_TE_solution(double lambda, double power, double phase0,
     for(; elem_it!=elem_it_end; ++elem_it)
     {
       const Elem* elem  = *elem_it;
+      if(!elem_in_domain(elem)) continue;
       std::vector<Complex> H_element;
       for(unsigned int i=0; i<elem->n_nodes(); ++i)
       {
@@ -684,10 +733,14 @@ void EMFEM2DSolver::save_TE_solution(double lambda, double power, double phase0,
       double phase = phase0 - k*(node->x()*cos(_incidence_angle)+node->y()*sin(_incidence_angle));
       Complex H_inc = H*std::exp(Complex(0,phase));
 
-      unsigned int local_offset = node->local_dof_id();
-
       FVM_NodeData * fvm_node_data = fvm_node->node_data();
-      Complex H_field = H_inc - Complex(lxx[local_offset], lxx[local_offset+1]);
+      // no scatter field is solved at truncated node
+      Complex H_field = H_inc;
+      if(node_in_domain(node))
+      {
+        unsigned int local_offset = node->local_dof_id();
+        H_field -= Complex(lxx[local_offset], lxx[local_offset+1]);
+      }
       Complex E_field = node_Exy_map[node];
       if(append)
       {
@@ -748,10 +801,14 @@ void EMFEM2DSolver::save_TM_solution(double lambda, double power, double phase0,
       double phase = phase0 - k*(node->x()*cos(_incidence_angle)+node->y()*sin(_incidence_angle));
       Complex E_inc = E*std::exp(Complex(0,phase));
 
-      unsigned int local_offset = node->local_dof_id();
-
       FVM_NodeData * fvm_node_data = fvm_node->node_data();
-      Complex E_field = E_inc - Complex(lxx[local_offset], lxx[local_offset+1]);
+      // no scatter field is solved at truncated node
+      Complex E_field = E_inc;
+      if(node_in_domain(node))
+      {
+        unsigned int local_offset = node->local_dof_id();
+        E_field -= Complex(lxx[local_offset], lxx[local_offset+1]);
+      }
 
       if(append)
       {
@@ -990,6 +1047,9 @@ void EMFEM2DSolver::build_absorb_chain()
 
 void EMFEM2DSolver::setup_solver_parameters()
 {
+  // reuse the preconditioner between adjacent wavelengths
+  _pc_reuse_tol = _card.get_real("pc.reuse.tol", 0.0);
+
   // optical wave is defined by command line
   if(_card.is_parameter_exist("lambda")||_card.is_parameter_exist("wavelength"))
   {
@@ -1047,12 +1107,66 @@ void EMFEM2DSolver::setup_solver_parameters()
   // set preconditioner type
   SolverSpecify::PC = SolverSpecify::preconditioner_type(_card.get_string("pc", "asm"));
 
+  // vacuum padding around the device in the unit of the longest wavelength,
+  // PML region and the vacuum beyond it are truncated from the fem domain
+  _pad_lambda = _card.get_real("pad.lambda", 0.0);
+  build_truncated_domain();
+
   // build the absorbing boundary
   build_absorb_chain();
 }
 
 
 
+void EMFEM2DSolver::build_truncated_domain()
+{
+  _pad = 0.0;
+  if(_pad_lambda <= 0.0) return;
+
+  double lambda_max = 0.0;
+  for(unsigned int n=0; n<_optical_sources.size(); ++n)
+    lambda_max = std::max(lambda_max, _optical_sources[n].wave_length);
+
+  // bounding box of the device, the mesh is the same on each processor
+  bool has_device = false;
+  for(unsigned int n=0; n<_system.n_regions(); ++n)
+  {
+    const SimulationRegion * region = _system.region(n);
+    if(region->type() == VacuumRegion || region->type() == PMLRegion) continue;
+
+    std::pair<Point, Point> box = MeshTools::subdomain_bounding_box(_system.mesh(), region->subdomain_id());
+    if(!has_device) { _device_box = box; has_device = true; continue; }
+    for(unsigned int i=0; i<3; ++i)
+    {
+      _device_box.first(i)  = std::min(_device_box.first(i),  box.first(i));
+      _device_box.second(i) = std::max(_device_box.second(i), box.second(i));
+    }
+  }
+  if(!has_device) return;
+
+  _pad = _pad_lambda*lambda_max;
+
+  MESSAGE<<"EMFEM2D: Vacuum padding is truncated to " << _pad/um << " um." << std::endl; RECORD();
+}
+
+
+
+bool EMFEM2DSolver::elem_in_domain(const Elem *elem) const
+{
+  if(_pad <= 0.0) return true;
+
+  const SimulationRegion * region = _system.region(elem->subdomain_id());
+  switch(region->type())
+  {
+    // PML region has no optical material
+    case PMLRegion    : return false;
+    case VacuumRegion : return MeshTools::minimal_distance(_device_box, elem->centroid()) < _pad;
+    default           : return true;
+  }
+}
+
+
+
 void EMFEM2DSolver::parse_spectrum_file(const std::string & filename)
 {
   // only processor 0 read the spectrum file
@@ -27,6 +27,25 @@
 #include "parallel.h"
 
 
+extern "C"
+{
+  //---------------------------------------------------------------
+  // this function is called by PETSc to apply the matrix-free operator
+  static PetscErrorCode  __genius_petsc_fem_matrix_free_mult (Mat mat, Vec x, Vec y)
+  {
+    void * ctx;
+    MatShellGetContext(mat, &ctx);
+
+    // convert void* to FEM_LinearSolver*
+    FEM_LinearSolver * linear_solver = (FEM_LinearSolver *)ctx;
+
+    linear_solver->matrix_free_mult(x, y);
+
+    return 0;
+  }
+}
+
+
 /*------------------------------------------------------------------
  * constructor, setup context
  */
@@ -80,44 +99,72 @@ void FEM_LinearSolver::setup_linear_data()
 
 
   // create the matrix
-  ierr = MatCreate(PETSC_COMM_WORLD, &A); genius_assert(!ierr);
-  ierr = MatSetSizes(A, n_local_dofs, n_local_dofs, n_global_dofs, n_global_dofs); genius_assert(!ierr);
-
-
-  // we are using petsc-devel
-  if (Genius::n_processors()>1)
+  if( this->matrix_free() )
   {
-    ierr = MatSetType(A,MATMPIAIJ); genius_assert(!ierr);
-    // alloc memory for parallel matrix here
-    ierr = MatMPIAIJSetPreallocation(A, 0, &n_nz[0], 0, &n_oz[0]); genius_assert(!ierr);
+    // the operator is applied element by element, no global matrix is stored
+    ierr = MatCreateShell(PETSC_COMM_WORLD, n_local_dofs, n_local_dofs, n_global_dofs, n_global_dofs, this, &A); genius_assert(!ierr);
+    ierr = MatShellSetOperation(A, MATOP_MULT, (void(*)(void))__genius_petsc_fem_matrix_free_mult); genius_assert(!ierr);
+
+    // the preconditioning matrix only holds the node_dofs x node_dofs diagonal block of each node
+    const PetscInt bs = this->node_dofs();
+    ierr = MatCreate(PETSC_COMM_WORLD, &A_pc); genius_assert(!ierr);
+    ierr = MatSetSizes(A_pc, n_local_dofs, n_local_dofs, n_global_dofs, n_global_dofs); genius_assert(!ierr);
+    if (Genius::n_processors()>1)
+    {
+      ierr = MatSetType(A_pc, MATMPIAIJ); genius_assert(!ierr);
+      ierr = MatMPIAIJSetPreallocation(A_pc, bs, PETSC_NULL, 0, PETSC_NULL); genius_assert(!ierr);
+    }
+    else
+    {
+      ierr = MatSetType(A_pc, MATSEQAIJ); genius_assert(!ierr);
+      ierr = MatSeqAIJSetPreallocation(A_pc, bs, PETSC_NULL); genius_assert(!ierr);
+    }
+    ierr = MatSetBlockSize(A_pc, bs); genius_assert(!ierr);
+    ierr = MatSetFromOptions(A_pc); genius_assert(!ierr);
   }
   else
   {
-    ierr = MatSetType(A,MATSEQAIJ); genius_assert(!ierr);
-    // alloc memory for sequence matrix here
-    ierr = MatSeqAIJSetPreallocation(A, 0, &n_nz[0]); genius_assert(!ierr);
-  }
+    ierr = MatCreate(PETSC_COMM_WORLD, &A); genius_assert(!ierr);
+    ierr = MatSetSizes(A, n_local_dofs, n_local_dofs, n_global_dofs, n_global_dofs); genius_assert(!ierr);
 
 
-  // indicates when PetscUtils::MatZeroRows() is called the zeroed entries are kept in the nonzero structure
+    // we are using petsc-devel
+    if (Genius::n_processors()>1)
+    {
+      ierr = MatSetType(A,MATMPIAIJ); genius_assert(!ierr);
+      // alloc memory for parallel matrix here
+      ierr = MatMPIAIJSetPreallocation(A, 0, &n_nz[0], 0, &n_oz[0]); genius_assert(!ierr);
+    }
+    else
+    {
+      ierr = MatSetType(A,MATSEQAIJ); genius_assert(!ierr);
+      // alloc memory for sequence matrix here
+      ierr = MatSeqAIJSetPreallocation(A, 0, &n_nz[0]); genius_assert(!ierr);
+    }
+
+
+    // indicates when PetscUtils::MatZeroRows() is called the zeroed entries are kept in the nonzero structure
 #if PETSC_VERSION_GE(3,1,0)
-  ierr = MatSetOption(A, MAT_KEEP_NONZERO_PATTERN, PETSC_TRUE); genius_assert(!ierr);
+    ierr = MatSetOption(A, MAT_KEEP_NONZERO_PATTERN, PETSC_TRUE); genius_assert(!ierr);
 #endif
 
 #if PETSC_VERSION_EQ(3,0,0)
-  ierr = MatSetOption(A, MAT_KEEP_ZEROED_ROWS, PETSC_TRUE); genius_assert(!ierr);
+    ierr = MatSetOption(A, MAT_KEEP_ZEROED_ROWS, PETSC_TRUE); genius_assert(!ierr);
 #endif
 
+    ierr = MatSetFromOptions(A); genius_assert(!ierr);
+
+    A_pc = A;
+  }
+
   // the matrix is not assembled yet.
   matrix_first_assemble = false;
 
-  ierr = MatSetFromOptions(A); genius_assert(!ierr);
-
   // create petsc linear solver context
   ierr = KSPCreate(PETSC_COMM_WORLD, &ksp); genius_assert(!ierr);
 
   // set corresponding matrix
-  ierr = KSPSetOperators(ksp, A, A, SAME_NONZERO_PATTERN); genius_assert(!ierr);
+  ierr = KSPSetOperators(ksp, A, A_pc, SAME_NONZERO_PATTERN); genius_assert(!ierr);
 
   // get petsc preconditional context
   ierr = KSPGetPC(ksp, &pc); genius_assert(!ierr);
@@ -146,6 +193,10 @@ void FEM_LinearSolver::clear_linear_data()
   ierr = ISDestroy(PetscDestroyObject(gis));             genius_assert(!ierr);
   ierr = ISDestroy(PetscDestroyObject(lis));             genius_assert(!ierr);
   ierr = VecScatterDestroy(PetscDestroyObject(scatter)); genius_assert(!ierr);
+  if( A_pc != A )
+  {
+    ierr = MatDestroy(PetscDestroyObject(A_pc));         genius_assert(!ierr);
+  }
   ierr = MatDestroy(PetscDestroyObject(A));              genius_assert(!ierr);
   ierr = KSPDestroy(PetscDestroyObject(ksp));            genius_assert(!ierr);
 
@@ -657,6 +708,22 @@ void FEM_LinearSolver::set_petsc_preconditioner_type(SolverSpecify::Precondition
 #endif
     }
 
+    case SolverSpecify::GAMG_PRECOND:
+    {
+#if PETSC_VERSION_GE(3,2,0)
+      // smoothed aggregation AMG of petsc itself, runs on the device with device matrix types
+      MESSAGE<< "Using GAMG preconditioner..."<<std::endl;
+      RECORD();
+      ierr = PCSetType (pc, (char*) PCGAMG);      genius_assert(!ierr);
+      return;
+#else
+      MESSAGE << "Warning:  no GAMG preconditioner configured, use ASM instead!" << std::endl;
+      RECORD();
+      ierr = PCSetType (pc, (char*) PCASM);       genius_assert(!ierr);
+      return;
+#endif
+    }
+
     case SolverSpecify::JACOBI_PRECOND:
       ierr = PCSetType (pc, (char*) PCJACOBI);    genius_assert(!ierr); return;
 
@@ -33,11 +33,44 @@
 
 
 
+void FEM_PDESolver::build_truncated_nodes()
+{
+  MeshBase & mesh = _system.mesh();
+
+  _truncated_nodes.clear();
+
+  // all the active elements, the result is the same on each processor
+  std::set<const Node *> domain_nodes;
+  const std::vector<Elem *> & elems = mesh.active_elem_range();
+  for (unsigned int ne=0; ne<elems.size(); ++ne)
+  {
+    const Elem *elem  = elems[ne];
+    bool in_domain = this->elem_in_domain(elem);
+    for(unsigned int n=0; n<elem->n_nodes(); ++n)
+    {
+      if(in_domain) domain_nodes.insert(elem->get_node(n));
+      else _truncated_nodes.insert(elem->get_node(n));
+    }
+  }
+
+  // node on the border of the truncated domain keeps its dofs
+  std::set<const Node *>::iterator it = _truncated_nodes.begin();
+  for( ; it!=_truncated_nodes.end(); )
+  {
+    if(domain_nodes.count(*it)) _truncated_nodes.erase(it++);
+    else ++it;
+  }
+}
+
+
+
 void FEM_PDESolver::set_parallel_dof_map()
 {
 
   MeshBase & mesh = _system.mesh();
 
+  build_truncated_nodes();
+
   // the local index of dof
   n_local_dofs = 0;
 
@@ -51,6 +84,7 @@ void FEM_PDESolver::set_parallel_dof_map()
   {
     Node * node = (*nd);
     genius_assert(node!=NULL);
+    if( !node_in_domain(node) ) continue;
 
     //if this node belongs to this processor, set the local dof
     // then we can make sure that each partition has a continuous block
@@ -99,6 +133,7 @@ void FEM_PDESolver::set_parallel_dof_map()
   {
     Node * node = (*nd);
     genius_assert(node!=NULL);
+    if( !node_in_domain(node) ) continue;
 
     unsigned int processor_id = node->processor_id();
     // the global offset of this partition
@@ -133,11 +168,11 @@ void FEM_PDESolver::set_parallel_dof_map()
 
     std::map<Node *, std::set<Node *> > node_connect_map;
 
-    MeshBase::const_element_iterator       elem_it     = mesh.local_elements_begin();
-    const MeshBase::const_element_iterator elem_it_end = mesh.local_elements_end();
-    for ( ; elem_it != elem_it_end; ++elem_it)
+    const std::vector<Elem *> & local_elems = mesh.local_elem_range();
+    for (unsigned int ne=0; ne<local_elems.size(); ++ne)
     {
-      const Elem *elem  = (*elem_it);
+      const Elem *elem  = local_elems[ne];
+      if( !this->elem_in_domain(elem) ) continue;
       // search for all the nodes
       for(unsigned int n=0; n<elem->n_nodes(); ++n)
       {
@@ -193,6 +228,8 @@ void FEM_PDESolver::set_serial_dof_map()
 
   MeshBase & mesh = _system.mesh();
 
+  build_truncated_nodes();
+
   // the local index of dof
   n_local_dofs = 0;
 
@@ -203,6 +240,7 @@ void FEM_PDESolver::set_serial_dof_map()
   {
     Node * node = (*nd);
     genius_assert( node->processor_id() == Genius::processor_id() );
+    if( !node_in_domain(node) ) continue;
 
     node->local_dof_id()  = n_local_dofs;
     node->global_dof_id() = node->local_dof_id();
@@ -231,11 +269,11 @@ void FEM_PDESolver::set_serial_dof_map()
 
     std::map<Node *, std::set<Node *> > node_connect_map;
 
-    MeshBase::const_element_iterator       elem_it     = mesh.local_elements_begin();
-    const MeshBase::const_element_iterator elem_it_end = mesh.local_elements_end();
-    for ( ; elem_it != elem_it_end; ++elem_it)
+    const std::vector<Elem *> & local_elems = mesh.local_elem_range();
+    for (unsigned int ne=0; ne<local_elems.size(); ++ne)
     {
-      const Elem *elem  = (*elem_it);
+      const Elem *elem  = local_elems[ne];
+      if( !this->elem_in_domain(elem) ) continue;
       // search for all the nodes
       for(unsigned int n=0; n<elem->n_nodes(); ++n)
       {
@@ -210,6 +210,25 @@ FVM_LinearSolver::~FVM_LinearSolver()
 }
 
 
+/*------------------------------------------------------------------
+ * memory usage of this processor
+ */
+void FVM_LinearSolver::memory_usage(std::map<std::string, size_t> & usage) const
+{
+  SolverBase::memory_usage(usage);
+
+  MatInfo info;
+  MatGetInfo(A, MAT_LOCAL, &info);
+  usage["PETSc Mat"] += static_cast<size_t>(info.memory);
+
+  PetscInt n_x, n_lx;
+  VecGetLocalSize(x, &n_x);
+  VecGetLocalSize(lx, &n_lx);
+  // x, b, r, w and L are global vectors, lx and lb are local ones
+  usage["PETSc Vec"] += (5*n_x + 2*n_lx)*sizeof(PetscScalar);
+}
+
+
 
 PetscInt FVM_LinearSolver::get_linear_iteration() const
 {
@@ -715,6 +734,22 @@ void FVM_LinearSolver::set_petsc_preconditioner_type()
 #endif
     }
 
+    case SolverSpecify::GAMG_PRECOND:
+    {
+#if PETSC_VERSION_GE(3,2,0)
+      // smoothed aggregation AMG of petsc itself, runs on the device with device matrix types
+      MESSAGE<< "Using GAMG preconditioner..."<<std::endl;
+      RECORD();
+      ierr = PCSetType (pc, (char*) PCGAMG);      genius_assert(!ierr);
+      return;
+#else
+      MESSAGE << "Warning:  no GAMG preconditioner configured, use ASM instead!" << std::endl;
+      RECORD();
+      ierr = PCSetType (pc, (char*) PCASM);       genius_assert(!ierr);
+      return;
+#endif
+    }
+
     case SolverSpecify::JACOBI_PRECOND:
       ierr = PCSetType (pc, (char*) PCJACOBI);    genius_assert(!ierr); return;
 
@@ -21,10 +21,20 @@
 
 
 #include <numeric>
+#include <limits>
+#include <algorithm>
 #include <iomanip>
+#include <sstream>
 
 #include "fvm_nonlinear_solver.h"
 #include "parallel.h"
+#include "solver_counters.h"
+#include "mat_slot_locator.h"
+#include "mat_node_ordering.h"
+#include "petsc_utils.h"
+#include "csr_dump_writer.h"
+#include "klu_factor.h"
+#include "petsc_type.h"
 
 #ifdef HAVE_SLEPC
 #include "slepceps.h"
@@ -48,6 +58,14 @@ extern "C"
     // convert void* to FVM_NonlinearSolver*
     FVM_NonlinearSolver * nonlinear_solver = (FVM_NonlinearSolver *)ctx;
 
+    nonlinear_solver->log_newton_iteration(its);
+
+    nonlinear_solver->lag_preconditioner_monitor(its);
+
+    nonlinear_solver->freeze_dofs_monitor(its);
+
+    nonlinear_solver->warm_start_linear_solver(its, fnorm);
+
     nonlinear_solver->petsc_snes_monitor(its, fnorm);
 
     return ierr;
@@ -66,6 +84,8 @@ extern "C"
 
     nonlinear_solver->petsc_snes_convergence_test(its, xnorm, gnorm, fnorm, reason);
 
+    nonlinear_solver->frozen_dofs_convergence(its, xnorm, gnorm, reason);
+
     return ierr;
   }
 
@@ -91,7 +111,19 @@ extern "C"
     // convert void* to FVM_NonlinearSolver*
     FVM_NonlinearSolver * nonlinear_solver = (FVM_NonlinearSolver *)ctx;
 
-    nonlinear_solver->build_petsc_sens_residual(x, f);
+    // the accepted line search trial has been evaluated already
+    if( !nonlinear_solver->trial_residual_reuse(x, f) )
+    {
+      solver_counters.add(SolverCounters::FunctionAssembly);
+
+      nonlinear_solver->assembly_timer_start();
+      nonlinear_solver->fused_residual(x, f);
+      nonlinear_solver->assembly_timer_stop();
+    }
+
+    // the equations of held dofs are replaced by x = x_hold
+    nonlinear_solver->held_dofs_residual(x, f);
+    nonlinear_solver->frozen_dofs_residual(x, f);
 
     return ierr;
   }
@@ -105,11 +137,39 @@ extern "C"
     // convert void* to FVM_NonlinearSolver*
     FVM_NonlinearSolver * nonlinear_solver = (FVM_NonlinearSolver *)ctx;
 
-    nonlinear_solver->build_petsc_sens_jacobian(x, jac, pc);
+    // Broyden method keeps the last factored jacobian
+    if( !nonlinear_solver->broyden_rebuild_jacobian() )
+    {
+      *msflag = SAME_PRECONDITIONER;
+      return ierr;
+    }
+
+    // the jacobian may be built by the residual evaluation at the same x
+    if( !nonlinear_solver->fused_jacobian_valid(x) )
+    {
+      solver_counters.add(SolverCounters::JacobianAssembly);
+      nonlinear_solver->assembly_timer_start();
+      nonlinear_solver->build_petsc_sens_jacobian(x, jac, pc);
+      nonlinear_solver->assembly_timer_stop();
+    }
+    nonlinear_solver->held_dofs_jacobian(pc);
 
-    *msflag = SAME_NONZERO_PATTERN;
+    // the nonzero pattern is fixed after the first assembly, kernels may add values by slot later
+    if( !MatSlotLocator::get(*pc) )
+      MatSlotLocator::attach(*pc);
+
+    // matrix-free jacobian should be assembled to update the base vector of differencing
+    if( *jac != *pc )
+    {
+      MatAssemblyBegin(*jac, MAT_FINAL_ASSEMBLY);
+      MatAssemblyEnd(*jac, MAT_FINAL_ASSEMBLY);
+    }
 
-    //*msflag = DIFFERENT_NONZERO_PATTERN;
+    // krylov solver may keep the preconditioner built from an earlier jacobian
+    if( nonlinear_solver->lag_preconditioner() )
+      *msflag = SAME_PRECONDITIONER;
+    else
+      *msflag = nonlinear_solver->jacobian_matrix_structure();
 
     return ierr;
   }
@@ -123,6 +183,9 @@ extern "C"
     // convert void* to FVM_NonlinearSolver*
     FVM_NonlinearSolver * nonlinear_solver = (FVM_NonlinearSolver *)ctx;
 
+    // secant updates go first, the damping of derived solvers works on the updated direction
+    nonlinear_solver->broyden_update_direction(x, y, changed_y);
+
     nonlinear_solver->sens_line_search_pre_check(x, y, changed_y);
 
     return ierr;
@@ -146,11 +209,45 @@ extern "C"
 //---------------------------------------------------------------------
 
 
+/**
+ * petsc matrix and vector types of the user specified device matrix type.
+ * false when petsc is not configured with that device
+ */
+static bool device_matrix_type(const std::string & type, const char * &mat_type, const char * &vec_type)
+{
+#if defined(PETSC_HAVE_CUDA) && PETSC_VERSION_GE(3,8,0)
+  if( type == "aijcusparse" )
+  {
+    mat_type = MATAIJCUSPARSE;
+    vec_type = VECCUDA;
+    return true;
+  }
+#endif
+#if defined(PETSC_HAVE_KOKKOS_KERNELS) && PETSC_VERSION_GE(3,14,0)
+  if( type == "aijkokkos" )
+  {
+    mat_type = MATAIJKOKKOS;
+    vec_type = VECKOKKOS;
+    return true;
+  }
+#endif
+  return false;
+}
+
+
+
 
 /*------------------------------------------------------------------
  * constructor, setup context
  */
-FVM_NonlinearSolver::FVM_NonlinearSolver(SimulationSystem & system): FVM_PDESolver(system)
+FVM_NonlinearSolver::FVM_NonlinearSolver(SimulationSystem & system): FVM_PDESolver(system), newton_step_logged(false), warm_start_fnorm(0.0), J_mf(PETSC_NULL),
+    _lu_single_precision(SolverSpecify::LUSinglePrecision), _node_block_size(0), _freeze_x(PETSC_NULL), _freeze_closed(false),
+    _jacobian_lag(1), _fused_jacobian_valid(false), _fused_x(PETSC_NULL),
+    _trial_x(PETSC_NULL), _trial_r(PETSC_NULL), _trial_valid(false), _bank_rose_K(0.0),
+    _pc_age(0), _pc_base_its(-1), _pc_rebuild(true),
+    _adaptive_iterative_type(SolverSpecify::INVALID_LINEAR_SOLVER), _adaptive_iterative_failed(false), _adaptive_direct_dominant(0),
+    _broyden_jacobian_valid(false), _broyden_dt(0.0), _broyden_fnorm_last(0.0),
+    _broyden_x(PETSC_NULL), _broyden_f(PETSC_NULL), _broyden_q(PETSC_NULL), _broyden_has_last(false), _broyden_n(0)
 {
   PetscErrorCode ierr;
 
@@ -172,10 +269,36 @@ void FVM_NonlinearSolver::setup_nonlinear_data()
 
   PetscErrorCode ierr;
 
+  // jacobian matrix and global vectors on the device. the jacobian is still assembled on the host,
+  // petsc copies it to the device at assembly end, the krylov solver and preconditioner run on the device
+  const char * device_mat_type = 0;
+  const char * device_vec_type = 0;
+  bool on_device = false;
+  if( SolverSpecify::MatrixType != "aij" && SolverSpecify::MatrixType != "baij" )
+  {
+    on_device = device_matrix_type(SolverSpecify::MatrixType, device_mat_type, device_vec_type);
+    if( !on_device )
+    {
+      MESSAGE << "Warning:  PETSc is not configured with matrix type " << SolverSpecify::MatrixType << ", use aij instead!" << std::endl;
+      RECORD();
+    }
+  }
+
   // create the global solution vector
-  ierr = VecCreateMPI(PETSC_COMM_WORLD, n_local_dofs, n_global_dofs, &x); genius_assert(!ierr);
-  ierr = VecCreateMPI(PETSC_COMM_WORLD, n_local_dofs, n_global_dofs, &f); genius_assert(!ierr);
-  ierr = VecCreateMPI(PETSC_COMM_WORLD, n_local_dofs, n_global_dofs, &L); genius_assert(!ierr);
+  if( on_device )
+  {
+    ierr = VecCreate(PETSC_COMM_WORLD, &x); genius_assert(!ierr);
+    ierr = VecSetSizes(x, n_local_dofs, n_global_dofs); genius_assert(!ierr);
+    ierr = VecSetType(x, device_vec_type); genius_assert(!ierr);
+    ierr = VecDuplicate(x, &f); genius_assert(!ierr);
+    ierr = VecDuplicate(x, &L); genius_assert(!ierr);
+  }
+  else
+  {
+    ierr = VecCreateMPI(PETSC_COMM_WORLD, n_local_dofs, n_global_dofs, &x); genius_assert(!ierr);
+    ierr = VecCreateMPI(PETSC_COMM_WORLD, n_local_dofs, n_global_dofs, &f); genius_assert(!ierr);
+    ierr = VecCreateMPI(PETSC_COMM_WORLD, n_local_dofs, n_global_dofs, &L); genius_assert(!ierr);
+  }
 
   // set all the components of scale vector L to 1.0
   ierr = VecSet(L, 1.0); genius_assert(!ierr);
@@ -203,13 +326,106 @@ void FVM_NonlinearSolver::setup_nonlinear_data()
 #endif
   ierr = VecScatterCreate(x, gis, lx, lis, &scatter); genius_assert(!ierr);
 
+  // split the scatter into owned and ghost entries, the owned part is a local copy and the ghost
+  // part can be overlapped with the assembly which only reads on processor nodes
+  {
+    PetscInt x_begin, x_end;
+    ierr = VecGetOwnershipRange(x, &x_begin, &x_end); genius_assert(!ierr);
+
+    std::vector<PetscInt> owned_global, owned_local, ghost_global, ghost_local;
+    for(unsigned int i=0; i<global_index_array.size(); ++i)
+    {
+      if( global_index_array[i] >= x_begin && global_index_array[i] < x_end )
+      {
+        owned_global.push_back(global_index_array[i]);
+        owned_local.push_back(local_index_array[i]);
+      }
+      else
+      {
+        ghost_global.push_back(global_index_array[i]);
+        ghost_local.push_back(local_index_array[i]);
+      }
+    }
+
+    IS owned_gis, owned_lis, ghost_gis, ghost_lis;
+#if PETSC_VERSION_GE(3,2,0)
+    ierr = ISCreateGeneral(PETSC_COMM_WORLD, owned_global.size(), owned_global.empty() ? PETSC_NULL : &owned_global[0], PETSC_COPY_VALUES, &owned_gis); genius_assert(!ierr);
+    ierr = ISCreateGeneral(PETSC_COMM_SELF,  owned_local.size(),  owned_local.empty()  ? PETSC_NULL : &owned_local[0],  PETSC_COPY_VALUES, &owned_lis); genius_assert(!ierr);
+    ierr = ISCreateGeneral(PETSC_COMM_WORLD, ghost_global.size(), ghost_global.empty() ? PETSC_NULL : &ghost_global[0], PETSC_COPY_VALUES, &ghost_gis); genius_assert(!ierr);
+    ierr = ISCreateGeneral(PETSC_COMM_SELF,  ghost_local.size(),  ghost_local.empty()  ? PETSC_NULL : &ghost_local[0],  PETSC_COPY_VALUES, &ghost_lis); genius_assert(!ierr);
+#else
+    ierr = ISCreateGeneral(PETSC_COMM_WORLD, owned_global.size(), owned_global.empty() ? PETSC_NULL : &owned_global[0], &owned_gis); genius_assert(!ierr);
+    ierr = ISCreateGeneral(PETSC_COMM_SELF,  owned_local.size(),  owned_local.empty()  ? PETSC_NULL : &owned_local[0],  &owned_lis); genius_assert(!ierr);
+    ierr = ISCreateGeneral(PETSC_COMM_WORLD, ghost_global.size(), ghost_global.empty() ? PETSC_NULL : &ghost_global[0], &ghost_gis); genius_assert(!ierr);
+    ierr = ISCreateGeneral(PETSC_COMM_SELF,  ghost_local.size(),  ghost_local.empty()  ? PETSC_NULL : &ghost_local[0],  &ghost_lis); genius_assert(!ierr);
+#endif
+    ierr = VecScatterCreate(x, owned_gis, lx, owned_lis, &scatter_owned); genius_assert(!ierr);
+    ierr = VecScatterCreate(x, ghost_gis, lx, ghost_lis, &scatter_ghost); genius_assert(!ierr);
+
+    ierr = ISDestroy(PetscDestroyObject(owned_gis)); genius_assert(!ierr);
+    ierr = ISDestroy(PetscDestroyObject(owned_lis)); genius_assert(!ierr);
+    ierr = ISDestroy(PetscDestroyObject(ghost_gis)); genius_assert(!ierr);
+    ierr = ISDestroy(PetscDestroyObject(ghost_lis)); genius_assert(!ierr);
+  }
+
+
+  // dense blocks for the dofs of each node. BAIJ needs the same block size everywhere,
+  // i.e. a device of one semiconductor region without bc dofs, otherwise the variable
+  // block sizes are set on AIJ matrix, which is used by point block jacobi
+  std::vector<PetscInt> block_sizes;
+  _node_block_size = 0;
+  if( SolverSpecify::MatrixType == "baij" )
+  {
+    node_block_sizes(block_sizes);
+    int bs_min = block_sizes.empty() ? std::numeric_limits<int>::max() : block_sizes[0];
+    int bs_max = block_sizes.empty() ? 0 : block_sizes[0];
+    for(unsigned int i=1; i<block_sizes.size(); ++i)
+    {
+      bs_min = std::min(bs_min, static_cast<int>(block_sizes[i]));
+      bs_max = std::max(bs_max, static_cast<int>(block_sizes[i]));
+    }
+    Parallel::min(bs_min);
+    Parallel::max(bs_max);
+    _node_block_size = (bs_min == bs_max) ? bs_min : -1;
+    if( _node_block_size == 1 ) _node_block_size = 0;
+  }
 
   // create the jacobian matrix
   ierr = MatCreate(PETSC_COMM_WORLD,&J); genius_assert(!ierr);
   ierr = MatSetSizes(J, n_local_dofs, n_local_dofs, n_global_dofs, n_global_dofs); genius_assert(!ierr);
 
 
-  if (Genius::n_processors()>1)
+  if( on_device )
+  {
+#if PETSC_VERSION_GE(3,8,0)
+    ierr = MatSetType(J, device_mat_type); genius_assert(!ierr);
+    // the device types are derived from aij, preallocate them by the same nonzero pattern
+    ierr = MatXAIJSetPreallocation(J, 1, &n_nz[0], &n_oz[0], PETSC_NULL, PETSC_NULL); genius_assert(!ierr);
+#endif
+  }
+  else if ( _node_block_size > 1 )
+  {
+    // the nonzeros of a row are whole node blocks
+    const PetscInt bs = _node_block_size;
+    std::vector<PetscInt> d_nnz(n_local_dofs/bs), o_nnz(n_local_dofs/bs);
+    for(unsigned int b=0; b<d_nnz.size(); ++b)
+    {
+      d_nnz[b] = (n_nz[b*bs] + bs - 1)/bs;
+      o_nnz[b] = (n_oz[b*bs] + bs - 1)/bs;
+    }
+    if (Genius::n_processors()>1)
+    {
+      ierr = MatSetType(J,MATMPIBAIJ); genius_assert(!ierr);
+      ierr = MatMPIBAIJSetPreallocation(J, bs, 0, &d_nnz[0], 0, &o_nnz[0]); genius_assert(!ierr);
+    }
+    else
+    {
+      ierr = MatSetType(J,MATSEQBAIJ); genius_assert(!ierr);
+      ierr = MatSeqBAIJSetPreallocation(J, bs, 0, &d_nnz[0]); genius_assert(!ierr);
+    }
+    MESSAGE<< "Using BAIJ jacobian matrix with block size " << bs << "..." << std::endl;  RECORD();
+  }
+  else if (Genius::n_processors()>1)
   {
     ierr = MatSetType(J,MATMPIAIJ); genius_assert(!ierr);
     // alloc memory for parallel matrix here
@@ -222,6 +438,17 @@ void FVM_NonlinearSolver::setup_nonlinear_data()
     ierr = MatSeqAIJSetPreallocation(J, 0, &n_nz[0]); genius_assert(!ierr);
   }
 
+  if ( _node_block_size < 0 )
+  {
+#if PETSC_VERSION_GE(3,11,0)
+    ierr = MatSetVariableBlockSizes(J, block_sizes.size(), block_sizes.empty() ? PETSC_NULL : &block_sizes[0]); genius_assert(!ierr);
+    MESSAGE<< "Using AIJ jacobian matrix with variable node blocks..." << std::endl;  RECORD();
+#else
+    MESSAGE<< "Warning:  variable block size requires PETSc 3.11 or later, use aij instead!" << std::endl;  RECORD();
+    _node_block_size = 0;
+#endif
+  }
+
 
   // indicates when PetscUtils::MatZeroRows() is called the zeroed entries are kept in the nonzero structure
 #if PETSC_VERSION_GE(3,1,0)
@@ -242,6 +469,9 @@ void FVM_NonlinearSolver::setup_nonlinear_data()
   // the jacobian matrix is not assembled yet.
   jacobian_matrix_first_assemble = false;
 
+  // the ordering and symbolic factorization should be done for this new matrix
+  symbolic_factorization_done = false;
+
   ierr = MatSetFromOptions(J); genius_assert(!ierr);
 
 
@@ -285,6 +515,43 @@ void FVM_NonlinearSolver::setup_nonlinear_data()
   // set user defined ksy convergence criterion
   ierr = KSPSetConvergenceTest (ksp, __genius_petsc_ksp_convergence_test, this, PETSC_NULL); genius_assert(!ierr);
 
+  // direct solver is applied by KSPPREONLY
+  bool direct_linear_solver = ( _linear_solver_type == SolverSpecify::LU ||
+                                _linear_solver_type == SolverSpecify::UMFPACK ||
+                                _linear_solver_type == SolverSpecify::SuperLU ||
+                                _linear_solver_type == SolverSpecify::MUMPS   ||
+                                _linear_solver_type == SolverSpecify::PASTIX  ||
+                                _linear_solver_type == SolverSpecify::SuperLU_DIST ||
+                                _linear_solver_type == SolverSpecify::KLU );
+
+  // jacobian-free newton-krylov, the assembled jacobian is only used to build preconditioner
+  if( SolverSpecify::JFNK )
+  {
+    ierr = MatCreateSNESMF(snes, &J_mf); genius_assert(!ierr);
+    ierr = SNESSetJacobian (snes, J_mf, J, __genius_petsc_snes_jacobian, this);genius_assert(!ierr);
+    ierr = SNESSetLagJacobian(snes, SolverSpecify::JFNKLagPC); genius_assert(!ierr);
+
+    // direct solver only applies the (lagged) factorization, use it as preconditioner of gmres instead
+    if ( direct_linear_solver )
+    {
+      ierr = KSPSetType(ksp, KSPGMRES); genius_assert(!ierr);
+      direct_linear_solver = false;
+    }
+  }
+
+  // krylov solver starts from the extrapolated Newton correction of previous iteration
+  // it is meaningless for direct solver
+  if( SolverSpecify::KSPWarmStart && !direct_linear_solver )
+  {
+    ierr = KSPSetInitialGuessNonzero(ksp, PETSC_TRUE); genius_assert(!ierr);
+  }
+
+  // inexact newton, linear solver tolerance is adjusted by Eisenstat-Walker method
+  if( SolverSpecify::InexactNewton || SolverSpecify::JFNK )
+  {
+    ierr = SNESKSPSetUseEW(snes, PETSC_TRUE); genius_assert(!ierr);
+  }
+
 }
 
 
@@ -349,6 +616,76 @@ void FVM_NonlinearSolver::dump_matrix_triplet(const Mat mat, const std::string &
 
 
 
+/*------------------------------------------------------------------
+ * dump jacobian matrix and rhs in compressed CSR format to external file
+ */
+void FVM_NonlinearSolver::dump_matrix_csr(const Mat mat, const Vec rhs, const std::string &file, bool async) const
+{
+  START_LOG("dump_matrix_csr()", "FVM_NonlinearSolver");
+
+  CSRDump * dump = new CSRDump;
+
+  PetscInt nrow, ncol;
+  MatGetSize(mat, &nrow, &ncol);
+  dump->n_rows = nrow;
+  dump->n_cols = ncol;
+
+  PetscInt row_begin, row_end;
+  MatGetOwnershipRange(mat, &row_begin, &row_end);
+  dump->row_begin = row_begin;
+
+  MatInfo info;
+  MatGetInfo(mat, MAT_LOCAL, &info);
+  dump->cols.reserve(static_cast<size_t>(info.nz_used));
+  dump->vals.reserve(static_cast<size_t>(info.nz_used));
+  dump->row_ptr.reserve(row_end-row_begin+1);
+  dump->row_ptr.push_back(0);
+
+  for(PetscInt row=row_begin; row<row_end; row++)
+  {
+    PetscInt row_ncol;
+    const PetscInt * row_cols_pointer;
+    const PetscScalar * row_vals_pointer;
+
+    MatGetRow(mat, row, &row_ncol, &row_cols_pointer, &row_vals_pointer);
+    dump->cols.insert(dump->cols.end(), row_cols_pointer, row_cols_pointer+row_ncol);
+    dump->vals.insert(dump->vals.end(), row_vals_pointer, row_vals_pointer+row_ncol);
+    dump->row_ptr.push_back(dump->cols.size());
+    MatRestoreRow(mat, row, &row_ncol, &row_cols_pointer, &row_vals_pointer);
+  }
+
+  if( rhs )
+  {
+    PetscInt n;
+    VecGetLocalSize(rhs, &n);
+    genius_assert(n == row_end-row_begin);
+    PetscScalar * rhs_array;
+    VecGetArray(rhs, &rhs_array);
+    dump->rhs.assign(rhs_array, rhs_array+n);
+    VecRestoreArray(rhs, &rhs_array);
+  }
+
+  dump->filename = file;
+  if( Genius::n_processors() > 1 )
+  {
+    std::stringstream ss;
+    ss << file << '.' << Genius::processor_id();
+    dump->filename = ss.str();
+  }
+
+  if( async )
+    CSRDumpWriter::push(dump);
+  else
+  {
+    CSRDumpWriter::write(*dump);
+    delete dump;
+  }
+
+  STOP_LOG("dump_matrix_csr()", "FVM_NonlinearSolver");
+}
+
+
+
 /*------------------------------------------------------------------
  * dump function to external file
  */
@@ -361,6 +698,25 @@ void FVM_NonlinearSolver::dump_vector_petsc(const Vec vec, const std::string &fi
 }
 
 
+/*------------------------------------------------------------------
+ * memory usage of this processor
+ */
+void FVM_NonlinearSolver::memory_usage(std::map<std::string, size_t> & usage) const
+{
+  SolverBase::memory_usage(usage);
+
+  MatInfo info;
+  MatGetInfo(J, MAT_LOCAL, &info);
+  usage["PETSc Mat"] += static_cast<size_t>(info.memory);
+
+  PetscInt n_x, n_lx;
+  VecGetLocalSize(x, &n_x);
+  VecGetLocalSize(lx, &n_lx);
+  // x, f and L are global vectors, lx and lf are local ones
+  usage["PETSc Vec"] += (3*n_x + 2*n_lx)*sizeof(PetscScalar);
+}
+
+
 /*------------------------------------------------------------------
  * create a new vector with (compatable parallel) pattern
  */
@@ -379,6 +735,23 @@ void FVM_NonlinearSolver::destroy_vector(Vec &vec)
 }
 
 
+/*------------------------------------------------------------------
+ * scatter v to lx in two steps
+ */
+void FVM_NonlinearSolver::scatter_lx_begin(Vec v)
+{
+  VecScatterBegin(scatter_ghost, v, lx, INSERT_VALUES, SCATTER_FORWARD);
+  VecScatterBegin(scatter_owned, v, lx, INSERT_VALUES, SCATTER_FORWARD);
+  VecScatterEnd  (scatter_owned, v, lx, INSERT_VALUES, SCATTER_FORWARD);
+}
+
+
+void FVM_NonlinearSolver::scatter_lx_end(Vec v)
+{
+  VecScatterEnd  (scatter_ghost, v, lx, INSERT_VALUES, SCATTER_FORWARD);
+}
+
+
 /*------------------------------------------------------------------
  * destroy nonlinear data
  */
@@ -394,9 +767,67 @@ void FVM_NonlinearSolver::clear_nonlinear_data()
   ierr = ISDestroy(PetscDestroyObject(gis));             genius_assert(!ierr);
   ierr = ISDestroy(PetscDestroyObject(lis));             genius_assert(!ierr);
   ierr = VecScatterDestroy(PetscDestroyObject(scatter)); genius_assert(!ierr);
+  ierr = VecScatterDestroy(PetscDestroyObject(scatter_owned)); genius_assert(!ierr);
+  ierr = VecScatterDestroy(PetscDestroyObject(scatter_ghost)); genius_assert(!ierr);
+  MatSlotLocator::detach(J);
+  MatNodeOrdering::detach(J);
   ierr = MatDestroy(PetscDestroyObject(J));              genius_assert(!ierr);
+  if( J_mf )
+  {
+    ierr = MatDestroy(PetscDestroyObject(J_mf));         genius_assert(!ierr);
+    J_mf = PETSC_NULL;
+  }
   ierr = SNESDestroy(PetscDestroyObject(snes));          genius_assert(!ierr);
 
+  _held_dofs.clear();
+  _held_values.clear();
+
+  release_frozen_dofs();
+  if( _freeze_x )
+  {
+    ierr = VecDestroy(PetscDestroyObject(_freeze_x));    genius_assert(!ierr);
+    _freeze_x = PETSC_NULL;
+  }
+
+  if( _fused_x )
+  {
+    ierr = VecDestroy(PetscDestroyObject(_fused_x));     genius_assert(!ierr);
+    _fused_x = PETSC_NULL;
+  }
+  _fused_jacobian_valid = false;
+  _pc_rebuild = true;
+
+  if( _trial_x )
+  {
+    ierr = VecDestroy(PetscDestroyObject(_trial_x));     genius_assert(!ierr);
+    _trial_x = PETSC_NULL;
+  }
+  if( _trial_r )
+  {
+    ierr = VecDestroy(PetscDestroyObject(_trial_r));     genius_assert(!ierr);
+    _trial_r = PETSC_NULL;
+  }
+  _trial_valid = false;
+  _bank_rose_K = 0.0;
+
+  if( _broyden_x )
+  {
+    ierr = VecDestroy(PetscDestroyObject(_broyden_x));   genius_assert(!ierr);
+    ierr = VecDestroy(PetscDestroyObject(_broyden_f));   genius_assert(!ierr);
+    ierr = VecDestroy(PetscDestroyObject(_broyden_q));   genius_assert(!ierr);
+    _broyden_x = _broyden_f = _broyden_q = PETSC_NULL;
+  }
+  for(unsigned int i=0; i<_broyden_w.size(); ++i)
+  {
+    ierr = VecDestroy(PetscDestroyObject(_broyden_w[i]));  genius_assert(!ierr);
+    ierr = VecDestroy(PetscDestroyObject(_broyden_df[i])); genius_assert(!ierr);
+  }
+  _broyden_w.clear();
+  _broyden_df.clear();
+  _broyden_df2.clear();
+  _broyden_n = 0;
+  _broyden_has_last = false;
+  _broyden_jacobian_valid = false;
 
   // clear petsc options
   std::map<std::string, std::string>::const_iterator it = petsc_options.begin();
@@ -414,6 +845,68 @@ FVM_NonlinearSolver::~FVM_NonlinearSolver()
 }
 
 
+/*------------------------------------------------------------------
+ * the time between two monitor calls, excluding residual and jacobian evaluation
+ * which are logged by themselves, is spent in linear solver (KSP setup and solve)
+ * and line search
+ */
+void FVM_NonlinearSolver::warm_start_linear_solver(PetscInt its, PetscReal fnorm)
+{
+  if( !SolverSpecify::KSPWarmStart ) return;
+
+  PetscBool nonzero_guess;
+  KSPGetInitialGuessNonzero(ksp, &nonzero_guess);
+  if( !nonzero_guess ) return;
+
+  // the solution update vector still holds the Newton correction of previous iteration
+  Vec y;
+  SNESGetSolutionUpdate(snes, &y);
+
+  // correction of previous solve is not related to this one, start from zero
+  if( its == 0 )
+  {
+    VecSet(y, 0.0);
+  }
+  else
+  {
+    // Newton correction is proportional to residual, extrapolate it by the residual reduction
+    PetscReal ratio = warm_start_fnorm > 0.0 ? fnorm/warm_start_fnorm : 0.0;
+    VecScale(y, std::min(ratio, 1.0));
+  }
+
+  warm_start_fnorm = fnorm;
+}
+
+
+
+void FVM_NonlinearSolver::log_newton_iteration(PetscInt its)
+{
+  log_newton_finish();
+
+  {
+    std::stringstream ss;
+    ss << "Newton iteration " << its;
+    MARK_LOG(ss.str());
+  }
+
+  START_LOG("Newton step (KSP and line search)", "FVM_NonlinearSolver");
+  newton_step_logged = true;
+}
+
+
+/*------------------------------------------------------------------
+ * close the log event of the last Newton step
+ */
+void FVM_NonlinearSolver::log_newton_finish()
+{
+  if( newton_step_logged )
+  {
+    STOP_LOG("Newton step (KSP and line search)", "FVM_NonlinearSolver");
+    newton_step_logged = false;
+  }
+}
+
+
 /*------------------------------------------------------------------
  * default snes monitor
  */
@@ -428,7 +921,7 @@ void FVM_NonlinearSolver::petsc_snes_monitor(PetscInt its, PetscReal fnorm)
   PetscInt lits;
   SNESGetLinearSolveIterations(snes, &lits);
 
-  MESSAGE<< " its " << its << '\t'
+  MESSAGE_LOG(LOG_INFO, "newton")<< " its " << its << '\t'
   << std::scientific
   << " |residual|_2 = " << fnorm
   << "  linear iter = "  << lits - pre_lits
@@ -472,6 +965,10 @@ void FVM_NonlinearSolver::sens_line_search_pre_check(Vec , Vec , PetscBool *)
  */
 void FVM_NonlinearSolver::sens_line_search_post_check(Vec x, Vec y, Vec w, PetscBool *changed_y, PetscBool *changed_w)
 {
+  // derived solvers do their checks before calling this function, a changed w means the step was cut back
+  solver_counters.add(SolverCounters::LineSearchSteps);
+  if( *changed_w ) solver_counters.add(SolverCounters::LineSearchCutbacks);
+
   hook_list()->post_iteration();
 
   bool _changed_y = false, _changed_w = false;
@@ -499,7 +996,9 @@ void FVM_NonlinearSolver::set_petsc_nonelinear_solver_type()
       ierr = SNESLineSearchSetPostCheck(snes, __genius_petsc_snes_post_check, this); genius_assert(!ierr);
       return;
 
+      // Broyden method is line search newton with secant updated directions between jacobian rebuilds
       case SolverSpecify::LineSearch:
+      case SolverSpecify::Broyden:
       ierr = SNESSetType(snes,SNESLS); genius_assert(!ierr);
       ierr = SNESLineSearchSet(snes,SNESLineSearchCubic,PETSC_NULL); genius_assert(!ierr);
       // set the LineSearch pre/post check routine
@@ -526,6 +1025,16 @@ void FVM_NonlinearSolver::set_petsc_linear_solver_type()
 {
   int ierr = 0;
 
+  // single precision factorization replaces the double precision direct solvers
+  if( _lu_single_precision )
+  {
+    if( ( _linear_solver_type == SolverSpecify::LU     ||
+          _linear_solver_type == SolverSpecify::MUMPS  ||
+          _linear_solver_type == SolverSpecify::SuperLU_DIST ) && set_petsc_mixed_precision_lu() )
+      return;
+    _lu_single_precision = false;
+  }
+
   switch (_linear_solver_type)
   {
 
@@ -602,6 +1111,18 @@ void FVM_NonlinearSolver::set_petsc_linear_solver_type()
       MESSAGE<< "Using CHEBYSHEV linear solver..."<<std::endl;  RECORD();
       ierr = KSPSetType (ksp, (char*) KSPCHEBYCHEV);  genius_assert(!ierr); return;
 
+      case SolverSpecify::KLU:
+      // KLU is sequential, keeps its ordering and pivot sequence between newton steps
+      if (Genius::n_processors()==1)
+      {
+        MESSAGE<< "Using KLU linear solver..."<<std::endl;  RECORD();
+        ierr = KSPSetType (ksp, (char*) KSPPREONLY); genius_assert(!ierr);
+        KLUFactor::set_pc_shell(pc, SolverSpecify::ReuseSymbolicFactorization);
+        return;
+      }
+      MESSAGE<< "Warning:  KLU solver is sequential, use parallel LU instead!" << std::endl;  RECORD();
+      _linear_solver_type = SolverSpecify::LU;
+
       case SolverSpecify::LU:
       case SolverSpecify::UMFPACK:
       case SolverSpecify::SuperLU:
@@ -622,6 +1143,7 @@ void FVM_NonlinearSolver::set_petsc_linear_solver_type()
             ierr = KSPSetType (ksp, (char*) KSPPREONLY); genius_assert(!ierr);
             ierr = PCSetType  (pc, (char*) PCLU); genius_assert(!ierr);
             ierr = PCFactorSetMatSolverPackage (pc, "mumps"); genius_assert(!ierr);
+            set_petsc_mumps_options();
             //ierr = set_petsc_option("-mat_mumps_icntl_14", "80",false);  genius_assert(!ierr);
             //ierr = set_petsc_option("-mat_mumps_icntl_23","4000",false);
 #else
@@ -682,9 +1204,12 @@ void FVM_NonlinearSolver::set_petsc_linear_solver_type()
             MESSAGE<< "Using MUMPS linear solver..."<<std::endl;
             RECORD();
             ierr = PCFactorSetMatSolverPackage (pc, "mumps"); genius_assert(!ierr);
+            set_petsc_mumps_options();
+            set_petsc_node_ordering(true);
 #else
             MESSAGE << "Warning:  no MUMPS solver configured, use default LU solver instead!" << std::endl;
             RECORD();
+            set_petsc_node_ordering(false);
 #endif
             break;
 
@@ -739,8 +1264,8 @@ void FVM_NonlinearSolver::set_petsc_linear_solver_type()
       }
 
 
-      ierr = PCFactorSetReuseFill(pc, PETSC_TRUE);genius_assert(!ierr);
-      ierr = PCFactorSetReuseOrdering(pc, PETSC_TRUE); genius_assert(!ierr);
+      ierr = PCFactorSetReuseFill(pc, SolverSpecify::ReuseSymbolicFactorization ? PETSC_TRUE : PETSC_FALSE);genius_assert(!ierr);
+      ierr = PCFactorSetReuseOrdering(pc, SolverSpecify::ReuseSymbolicFactorization ? PETSC_TRUE : PETSC_FALSE); genius_assert(!ierr);
       // prevent zero pivot in LU factorization
       ierr = PCFactorSetColumnPivot(pc, 1.0); genius_assert(!ierr);
       //ierr = PCFactorReorderForNonzeroDiagonal(pc, 1e-20); genius_assert(!ierr);<-- Caught signal number 11 SEGV error will occure when diag value < 1e-20
@@ -756,6 +1281,81 @@ void FVM_NonlinearSolver::set_petsc_linear_solver_type()
 
 
 
+bool FVM_NonlinearSolver::set_petsc_mixed_precision_lu()
+{
+#if defined(PETSC_HAVE_SUPERLU_DIST_SINGLE)
+  int ierr = 0;
+
+  // the factor is only used as preconditioner, the krylov solver works in double precision
+  // and corrects the error of single precision factorization
+  if( SolverSpecify::LURefinement == "richardson" )
+  {
+    MESSAGE<< "Using single precision SuperLU_DIST with iterative refinement..."<<std::endl;  RECORD();
+    ierr = KSPSetType (ksp, (char*) KSPRICHARDSON); genius_assert(!ierr);
+  }
+  else
+  {
+    MESSAGE<< "Using single precision SuperLU_DIST with GMRES-IR..."<<std::endl;  RECORD();
+    ierr = KSPSetType (ksp, (char*) KSPGMRES);      genius_assert(!ierr);
+    ierr = KSPGMRESSetRestart(ksp, 30);             genius_assert(!ierr);
+  }
+
+  ierr = PCSetType  (pc, (char*) PCLU); genius_assert(!ierr);
+  ierr = PCFactorSetMatSolverPackage (pc, "superlu_dist"); genius_assert(!ierr);
+  ierr = set_petsc_option("-pc_precision", "single", false); genius_assert(!ierr);
+
+  ierr = PCFactorSetReuseFill(pc, SolverSpecify::ReuseSymbolicFactorization ? PETSC_TRUE : PETSC_FALSE);genius_assert(!ierr);
+  ierr = PCFactorSetReuseOrdering(pc, SolverSpecify::ReuseSymbolicFactorization ? PETSC_TRUE : PETSC_FALSE); genius_assert(!ierr);
+  ierr = PCFactorSetColumnPivot(pc, 1.0); genius_assert(!ierr);
+  ierr = PCFactorSetShiftType(pc,MAT_SHIFT_NONZERO);genius_assert(!ierr);
+  return true;
+#else
+  MESSAGE << "Warning:  no single precision SuperLU_DIST configured, factor in double precision!" << std::endl;
+  RECORD();
+  return false;
+#endif
+}
+
+
+
+void FVM_NonlinearSolver::set_petsc_mumps_options()
+{
+  if( !SolverSpecify::LUBlockLowRank ) return;
+
+  // ICNTL(35)=1: BLR factorization with automatic choice of variant, CNTL(7): dropping tolerance
+  std::stringstream tol;
+  tol << SolverSpecify::LUBlockLowRankTol;
+
+  int ierr = 0;
+  ierr = set_petsc_option("-mat_mumps_icntl_35", "1", false); genius_assert(!ierr);
+  ierr = set_petsc_option("-mat_mumps_cntl_7", tol.str(), false); genius_assert(!ierr);
+  MESSAGE<< "  with block low-rank compression of LU factors, tolerance " << SolverSpecify::LUBlockLowRankTol << std::endl;  RECORD();
+}
+
+
+
+void FVM_NonlinearSolver::set_petsc_node_ordering(bool mumps)
+{
+  if( SolverSpecify::LUOrdering != "nd" ) return;
+
+  // the ordering is computed once for this solver, and PCFactorSetReuseOrdering keeps it
+  // for all the factorizations of the sweep
+  if( !MatNodeOrdering::register_type() ) return;
+  if( node_ordering.empty() && !build_node_ordering() ) return;
+  MatNodeOrdering::attach(J, node_ordering);
+
+  int ierr = 0;
+  ierr = PCFactorSetMatOrderingType(pc, MatNodeOrdering::type()); genius_assert(!ierr);
+  // ICNTL(7)=1: use the ordering given by PETSc
+  if( mumps )
+  {
+    ierr = set_petsc_option("-mat_mumps_icntl_7", "1", false); genius_assert(!ierr);
+  }
+  MESSAGE<< "  with nested dissection ordering of mesh nodes" << std::endl;  RECORD();
+}
+
+
+
 void FVM_NonlinearSolver::set_petsc_preconditioner_type()
 {
   int ierr = 0;
@@ -766,7 +1366,8 @@ void FVM_NonlinearSolver::set_petsc_preconditioner_type()
       _linear_solver_type == SolverSpecify::SuperLU ||
       _linear_solver_type == SolverSpecify::MUMPS   ||
       _linear_solver_type == SolverSpecify::PASTIX  ||
-      _linear_solver_type == SolverSpecify::SuperLU_DIST
+      _linear_solver_type == SolverSpecify::SuperLU_DIST ||
+      _linear_solver_type == SolverSpecify::KLU
      )
   {
     return;
@@ -893,6 +1494,7 @@ void FVM_NonlinearSolver::set_petsc_preconditioner_type()
 #ifdef PETSC_HAVE_MUMPS
           MESSAGE<< "Using MUMPS as LU preconditioner..."<<std::endl;    RECORD();
           ierr = PCFactorSetMatSolverPackage (pc, "mumps"); genius_assert(!ierr);
+          set_petsc_mumps_options();
 #endif
           ierr = PCFactorSetReuseFill(pc, PETSC_TRUE);genius_assert(!ierr);
           ierr = PCFactorSetReuseOrdering(pc, PETSC_TRUE); genius_assert(!ierr);
@@ -906,6 +1508,7 @@ void FVM_NonlinearSolver::set_petsc_preconditioner_type()
           ierr = PCSetType (pc, (char*) PCLU);       genius_assert(!ierr);
           MESSAGE<< "Using MUMPS as parallel LU preconditioner..."<<std::endl;    RECORD();
           ierr = PCFactorSetMatSolverPackage (pc, "mumps"); genius_assert(!ierr);
+          set_petsc_mumps_options();
           ierr = PCFactorSetReuseFill(pc, PETSC_TRUE);genius_assert(!ierr);
           ierr = PCFactorSetReuseOrdering(pc, PETSC_TRUE); genius_assert(!ierr);
           ierr = PCFactorSetColumnPivot(pc, 1.0); genius_assert(!ierr);
@@ -1010,7 +1613,34 @@ void FVM_NonlinearSolver::set_petsc_preconditioner_type()
 
       }
 
+      case SolverSpecify::GAMG_PRECOND:
+      {
+#if PETSC_VERSION_GE(3,2,0)
+        // smoothed aggregation AMG of petsc itself, runs on the device with device matrix types
+        MESSAGE<< "Using GAMG preconditioner..."<<std::endl;
+        RECORD();
+        ierr = PCSetType (pc, (char*) PCGAMG);      genius_assert(!ierr);
+        return;
+#else
+        MESSAGE << "Warning:  no GAMG preconditioner configured, use ASM instead!" << std::endl;
+        RECORD();
+        ierr = PCSetType (pc, (char*) PCASM);       genius_assert(!ierr);
+        return;
+#endif
+      }
+
       case SolverSpecify::JACOBI_PRECOND:
+      // invert the dense block of each node
+      if( _node_block_size > 1 )
+      {
+        ierr = PCSetType (pc, (char*) PCPBJACOBI);  genius_assert(!ierr); return;
+      }
+#if PETSC_VERSION_GE(3,11,0)
+      if( _node_block_size < 0 )
+      {
+        ierr = PCSetType (pc, (char*) PCVPBJACOBI); genius_assert(!ierr); return;
+      }
+#endif
       ierr = PCSetType (pc, (char*) PCJACOBI);    genius_assert(!ierr); return;
 
       case SolverSpecify::BLOCK_JACOBI_PRECOND:
@@ -1023,8 +1653,34 @@ void FVM_NonlinearSolver::set_petsc_preconditioner_type()
       ierr = PCSetType (pc, (char*) PCEISENSTAT); genius_assert(!ierr); return;
 
 
-      case SolverSpecify::USER_PRECOND:
-      ierr = PCSetType (pc, (char*) PCMAT);       genius_assert(!ierr); return;
+      case SolverSpecify::FIELDSPLIT_PRECOND:
+      {
+        // device-circuit co-simulation, reduce device block to circuit by schur complement
+        if( SolverSpecify::FieldSplitType == "circuit" && set_petsc_circuit_schur_preconditioner() )
+          return;
+
+        if( !set_petsc_fieldsplit_preconditioner() )
+        {
+          MESSAGE << "Warning:  only one physical field in this problem, use ASM instead of field split preconditioner!" << std::endl;
+          RECORD();
+          ierr = PCSetType (pc, (char*) PCASM);       genius_assert(!ierr);
+        }
+        return;
+      }
+
+      case SolverSpecify::REGION_ASM_PRECOND:
+      {
+        if( !set_petsc_region_asm_preconditioner() )
+        {
+          MESSAGE << "Warning:  only one region in this problem, use ASM instead of region ASM preconditioner!" << std::endl;
+          RECORD();
+          ierr = PCSetType (pc, (char*) PCASM);       genius_assert(!ierr);
+        }
+        return;
+      }
+
+      case SolverSpecify::USER_PRECOND:
+      ierr = PCSetType (pc, (char*) PCMAT);       genius_assert(!ierr); return;
 
 
       case SolverSpecify::SHELL_PRECOND:
@@ -1039,6 +1695,276 @@ void FVM_NonlinearSolver::set_petsc_preconditioner_type()
 }
 
 
+bool FVM_NonlinearSolver::set_petsc_fieldsplit_preconditioner()
+{
+  int ierr = 0;
+
+  const bool schur = (SolverSpecify::FieldSplitType == "schur");
+
+  // group on processor dofs by solution variable. for schur complement,
+  // only two blocks are allowed: potential and all the others
+  std::map<SolutionVariable, std::vector<PetscInt> > field_dofs;
+  for(unsigned int n=0; n<_system.n_regions(); ++n)
+  {
+    const SimulationRegion * region = _system.region(n);
+    const unsigned int region_node_dofs = this->node_dofs( region );
+
+    SimulationRegion::const_processor_node_iterator it = region->on_processor_nodes_begin();
+    SimulationRegion::const_processor_node_iterator it_end = region->on_processor_nodes_end();
+    for(; it!=it_end; ++it)
+    {
+      const FVM_Node * fvm_node = (*it);
+      for(unsigned int i=0; i<region_node_dofs; ++i)
+      {
+        SolutionVariable var = this->node_dof_variable(region, i);
+        if( schur && var != POTENTIAL ) var = ELECTRON;
+        field_dofs[var].push_back(fvm_node->global_offset() + i);
+      }
+    }
+  }
+
+  // bc and extra dofs are located at the end of last processor, they are circuit (potential) equations
+  if( Genius::is_last_processor() )
+    for(unsigned int i=n_global_node_dofs; i<n_global_dofs; ++i)
+      field_dofs[POTENTIAL].push_back(i);
+
+  // the fields exist in global
+  std::vector<int> fields;
+  for(int var=POTENTIAL; var<=H_TEMP; ++var)
+  {
+    unsigned int n_field_dofs = 0;
+    if( field_dofs.find(static_cast<SolutionVariable>(var)) != field_dofs.end() )
+      n_field_dofs = field_dofs[static_cast<SolutionVariable>(var)].size();
+    Parallel::sum(n_field_dofs);
+    if( n_field_dofs ) fields.push_back(var);
+  }
+  // dofs with unknown variable can not be split
+  genius_assert( field_dofs.find(INVALID_Variable) == field_dofs.end() );
+
+  if( fields.size() < 2 ) return false;
+
+  MESSAGE<< "Using field split preconditioner with " << fields.size() << " fields..."<<std::endl;
+  RECORD();
+
+  ierr = PCSetType (pc, (char*) PCFIELDSPLIT);  genius_assert(!ierr);
+
+  for(unsigned int f=0; f<fields.size(); ++f)
+  {
+    std::vector<PetscInt> & dofs = field_dofs[static_cast<SolutionVariable>(fields[f])];
+
+    std::stringstream ss;
+    ss << f;
+
+    IS is;
+#if PETSC_VERSION_GE(3,2,0)
+    ierr = ISCreateGeneral(PETSC_COMM_WORLD, dofs.size(), dofs.empty() ? PETSC_NULL : &dofs[0], PETSC_COPY_VALUES, &is); genius_assert(!ierr);
+    ierr = PCFieldSplitSetIS(pc, ss.str().c_str(), is); genius_assert(!ierr);
+#else
+    ierr = ISCreateGeneral(PETSC_COMM_WORLD, dofs.size(), dofs.empty() ? PETSC_NULL : &dofs[0], &is); genius_assert(!ierr);
+    ierr = PCFieldSplitSetIS(pc, is); genius_assert(!ierr);
+#endif
+    ierr = ISDestroy(PetscDestroyObject(is)); genius_assert(!ierr);
+
+    // sub solver of each field
+    const std::string prefix = "-fieldsplit_" + ss.str() + "_";
+    ierr = set_petsc_option(prefix+"ksp_type", "preonly"); genius_assert(!ierr);
+    if( fields[f] == POTENTIAL )
+    {
+#ifdef PETSC_HAVE_LIBHYPRE
+      // poisson block is elliptic, AMG works well
+      ierr = set_petsc_option(prefix+"pc_type", "hypre"); genius_assert(!ierr);
+      ierr = set_petsc_option(prefix+"pc_hypre_type", "boomeramg"); genius_assert(!ierr);
+      continue;
+#endif
+    }
+
+    // continuity and energy balance blocks are convection dominated, use ILU
+    if (Genius::n_processors() > 1)
+    {
+      ierr = set_petsc_option(prefix+"pc_type", "asm"); genius_assert(!ierr);
+      ierr = set_petsc_option(prefix+"sub_pc_type", "ilu"); genius_assert(!ierr);
+      ierr = set_petsc_option(prefix+"sub_pc_factor_shift_type", "NONZERO"); genius_assert(!ierr);
+    }
+    else
+    {
+      ierr = set_petsc_option(prefix+"pc_type", "ilu"); genius_assert(!ierr);
+      ierr = set_petsc_option(prefix+"pc_factor_shift_type", "NONZERO"); genius_assert(!ierr);
+    }
+  }
+
+  if( schur )
+  {
+    ierr = PCFieldSplitSetType(pc, PC_COMPOSITE_SCHUR); genius_assert(!ierr);
+  }
+  else if( SolverSpecify::FieldSplitType == "additive" )
+  {
+    ierr = PCFieldSplitSetType(pc, PC_COMPOSITE_ADDITIVE); genius_assert(!ierr);
+  }
+  else
+  {
+    ierr = PCFieldSplitSetType(pc, PC_COMPOSITE_MULTIPLICATIVE); genius_assert(!ierr);
+  }
+
+  return true;
+}
+
+
+bool FVM_NonlinearSolver::set_petsc_region_asm_preconditioner()
+{
+  int ierr = 0;
+
+  // on processor dofs of each region, the materials of heterostructure are separated regions
+  std::vector< std::vector<PetscInt> > subdomain_dofs;
+  for(unsigned int n=0; n<_system.n_regions(); ++n)
+  {
+    const SimulationRegion * region = _system.region(n);
+    const unsigned int region_node_dofs = this->node_dofs( region );
+    if( !region_node_dofs ) continue;
+
+    std::vector<PetscInt> dofs;
+    SimulationRegion::const_processor_node_iterator it = region->on_processor_nodes_begin();
+    SimulationRegion::const_processor_node_iterator it_end = region->on_processor_nodes_end();
+    for(; it!=it_end; ++it)
+    {
+      const FVM_Node * fvm_node = (*it);
+      for(unsigned int i=0; i<region_node_dofs; ++i)
+        dofs.push_back(fvm_node->global_offset() + i);
+    }
+    if( !dofs.empty() )
+      subdomain_dofs.push_back(dofs);
+  }
+
+  // bc and extra dofs are located at the end of last processor
+  if( Genius::is_last_processor() && n_global_dofs > n_global_node_dofs )
+  {
+    std::vector<PetscInt> dofs;
+    for(unsigned int i=n_global_node_dofs; i<n_global_dofs; ++i)
+      dofs.push_back(i);
+    subdomain_dofs.push_back(dofs);
+  }
+
+  unsigned int n_subdomains = subdomain_dofs.size();
+  Parallel::sum(n_subdomains);
+  if( n_subdomains < 2 ) return false;
+
+  MESSAGE<< "Using region ASM preconditioner with " << n_subdomains << " subdomains..."<<std::endl;
+  RECORD();
+
+  ierr = PCSetType (pc, (char*) PCASM);  genius_assert(!ierr);
+
+  // the interface couplings (hetero junction, metal contact ...) enter the subdomain by overlap
+  std::vector<IS> is(subdomain_dofs.size());
+  for(unsigned int s=0; s<subdomain_dofs.size(); ++s)
+  {
+    std::vector<PetscInt> & dofs = subdomain_dofs[s];
+#if PETSC_VERSION_GE(3,2,0)
+    ierr = ISCreateGeneral(PETSC_COMM_SELF, dofs.size(), &dofs[0], PETSC_COPY_VALUES, &is[s]); genius_assert(!ierr);
+#else
+    ierr = ISCreateGeneral(PETSC_COMM_SELF, dofs.size(), &dofs[0], &is[s]); genius_assert(!ierr);
+#endif
+  }
+  ierr = PCASMSetLocalSubdomains(pc, is.size(), is.empty() ? PETSC_NULL : &is[0], PETSC_NULL); genius_assert(!ierr);
+  for(unsigned int s=0; s<is.size(); ++s)
+  {
+    ierr = ISDestroy(PetscDestroyObject(is[s])); genius_assert(!ierr);
+  }
+  ierr = PCASMSetOverlap(pc, 1); genius_assert(!ierr);
+
+  if( SolverSpecify::RegionASMType == "additive" )
+  {
+    ierr = PCASMSetType(pc, PC_ASM_BASIC); genius_assert(!ierr);
+  }
+  else if( SolverSpecify::RegionASMType == "multiplicative" )
+  {
+#if PETSC_VERSION_GE(3,9,0)
+    ierr = PCASMSetLocalType(pc, PC_COMPOSITE_MULTIPLICATIVE); genius_assert(!ierr);
+#else
+    ierr = PCASMSetType(pc, PC_ASM_BASIC); genius_assert(!ierr);
+#endif
+  }
+  else
+  {
+    ierr = PCASMSetType(pc, PC_ASM_RESTRICT); genius_assert(!ierr);
+  }
+
+  // a region has moderate size and uniform conditioning, exact LU of each subdomain
+  ierr = set_petsc_option("-sub_ksp_type", "preonly"); genius_assert(!ierr);
+  ierr = set_petsc_option("-sub_pc_type", "lu"); genius_assert(!ierr);
+  ierr = set_petsc_option("-sub_pc_factor_mat_ordering_type", "nd"); genius_assert(!ierr);
+  ierr = set_petsc_option("-sub_pc_factor_shift_type", "NONZERO"); genius_assert(!ierr);
+
+  return true;
+}
+
+
+bool FVM_NonlinearSolver::set_petsc_circuit_schur_preconditioner()
+{
+  int ierr = 0;
+
+  // the lumped equations of electrode circuits (bc dofs) and the spice circuit (extra dofs)
+  // are located after all the node dofs at the end of last processor.
+  // group them into one small dense block, all the node dofs belong to device
+  const unsigned int n_circuit_dofs = n_global_dofs - n_global_node_dofs;
+  if( n_circuit_dofs == 0 ) return false;
+
+  PetscInt begin, end;
+  ierr = VecGetOwnershipRange(x, &begin, &end); genius_assert(!ierr);
+
+  std::vector<PetscInt> device_dofs, circuit_dofs;
+  for(PetscInt i=begin; i<end; ++i)
+  {
+    if( static_cast<unsigned int>(i) < n_global_node_dofs )
+      device_dofs.push_back(i);
+    else
+      circuit_dofs.push_back(i);
+  }
+
+  MESSAGE<< "Using schur complement preconditioner with " << n_global_bc_dofs << " lumped bc and "
+         << this->extra_dofs() << " spice circuit dofs..."<<std::endl;
+  RECORD();
+
+  ierr = PCSetType (pc, (char*) PCFIELDSPLIT);  genius_assert(!ierr);
+
+  const std::vector<PetscInt> * blocks[2] = { &device_dofs, &circuit_dofs };
+  for(unsigned int b=0; b<2; ++b)
+  {
+    const std::vector<PetscInt> & dofs = *blocks[b];
+    IS is;
+#if PETSC_VERSION_GE(3,2,0)
+    ierr = ISCreateGeneral(PETSC_COMM_WORLD, dofs.size(), dofs.empty() ? PETSC_NULL : &dofs[0], PETSC_COPY_VALUES, &is); genius_assert(!ierr);
+    ierr = PCFieldSplitSetIS(pc, b==0 ? "0" : "1", is); genius_assert(!ierr);
+#else
+    ierr = ISCreateGeneral(PETSC_COMM_WORLD, dofs.size(), dofs.empty() ? PETSC_NULL : &dofs[0], &is); genius_assert(!ierr);
+    ierr = PCFieldSplitSetIS(pc, is); genius_assert(!ierr);
+#endif
+    ierr = ISDestroy(PetscDestroyObject(is)); genius_assert(!ierr);
+  }
+
+  // device block is factorized once, its schur complement is the terminal conductance stamps of circuit
+  ierr = set_petsc_option("-fieldsplit_0_ksp_type", "preonly"); genius_assert(!ierr);
+  ierr = set_petsc_option("-fieldsplit_0_pc_type", "lu"); genius_assert(!ierr);
+#ifdef PETSC_HAVE_MUMPS
+  ierr = set_petsc_option("-fieldsplit_0_pc_factor_mat_solver_package", "mumps"); genius_assert(!ierr);
+#else
+#ifdef PETSC_HAVE_SUPERLU_DIST
+  if (Genius::n_processors() > 1)
+  {
+    ierr = set_petsc_option("-fieldsplit_0_pc_factor_mat_solver_package", "superlu_dist"); genius_assert(!ierr);
+  }
+#endif
+#endif
+
+  // circuit block is small, solve schur complement by krylov method without assembling it
+  ierr = set_petsc_option("-fieldsplit_1_ksp_type", "gmres"); genius_assert(!ierr);
+  ierr = set_petsc_option("-fieldsplit_1_pc_type", "none"); genius_assert(!ierr);
+
+  ierr = PCFieldSplitSetType(pc, PC_COMPOSITE_SCHUR); genius_assert(!ierr);
+
+  return true;
+}
+
+
+
 int FVM_NonlinearSolver::set_petsc_option(const std::string &key, const std::string &value, bool has_prefix )
 {
   // insert snes_prefix to the key
@@ -1056,16 +1982,640 @@ int FVM_NonlinearSolver::set_petsc_option(const std::string &key, const std::str
 #if PETSC_VERSION_LE(3,1,0)
 #define SNES_DIVERGED_LINE_SEARCH SNES_DIVERGED_LS_FAILURE
 #endif
+void FVM_NonlinearSolver::set_jacobian_lag(int lag)
+{
+  if( lag < 1 ) lag = 1;
+
+  // Broyden method decides the rebuild of jacobian by itself
+  if( _nonlinear_solver_type == SolverSpecify::Broyden && !SolverSpecify::JFNK ) lag = 1;
+
+  _jacobian_lag = lag;
+
+  PetscErrorCode ierr;
+
+  // for JFNK, the lagged jacobian only serves as preconditioner, the krylov operator is always up to date
+  if( SolverSpecify::JFNK )
+  {
+    ierr = SNESSetLagJacobian(snes, std::max(lag, SolverSpecify::JFNKLagPC)); genius_assert(!ierr);
+    return;
+  }
+
+  ierr = SNESSetLagJacobian(snes, lag); genius_assert(!ierr);
+
+  // for direct solvers the preconditioner is the factored jacobian, rebuild them together
+  if (_linear_solver_type == SolverSpecify::LU ||
+      _linear_solver_type == SolverSpecify::UMFPACK ||
+      _linear_solver_type == SolverSpecify::SuperLU ||
+      _linear_solver_type == SolverSpecify::MUMPS   ||
+      _linear_solver_type == SolverSpecify::PASTIX  ||
+      _linear_solver_type == SolverSpecify::SuperLU_DIST ||
+      _linear_solver_type == SolverSpecify::KLU
+     )
+  {
+    ierr = SNESSetLagPreconditioner(snes, 1); genius_assert(!ierr);
+  }
+}
+
+
+bool FVM_NonlinearSolver::lag_preconditioner()
+{
+  // direct solver is lagged by set_jacobian_lag(), JFNK lags its preconditioner by itself
+  if( SolverSpecify::PCLag <= 1 || SolverSpecify::JFNK || direct_linear_solver() ) return false;
+
+  if( _pc_rebuild || _pc_age+1 >= SolverSpecify::PCLag )
+  {
+    _pc_rebuild = false;
+    _pc_age = 0;
+    _pc_base_its = -1;
+    return false;
+  }
+
+  _pc_age++;
+  return true;
+}
+
+
+void FVM_NonlinearSolver::lag_preconditioner_monitor(PetscInt its)
+{
+  if( SolverSpecify::PCLag <= 1 || SolverSpecify::JFNK ) return;
+
+  // no linear solve in this nonlinear solve yet
+  if( its == 0 ) return;
+
+  PetscInt lits;
+  KSPGetIterationNumber(ksp, &lits);
+
+  if( _pc_base_its < 0 )
+  {
+    _pc_base_its = lits;
+    return;
+  }
+
+  // the lagged preconditioner does not fit the jacobian any more
+  if( lits > SolverSpecify::PCLagGrowth*std::max(_pc_base_its, static_cast<PetscInt>(1)) )
+    _pc_rebuild = true;
+}
+
+
+bool FVM_NonlinearSolver::fused_assembly() const
+{
+  // line search evaluates the residual at trial points, lagged and matrix-free jacobian are not built at every residual
+  return SolverSpecify::FusedAssembly &&
+         fused_assembly_support() &&
+         _nonlinear_solver_type == SolverSpecify::Newton &&
+         !SolverSpecify::JFNK &&
+         _jacobian_lag == 1;
+}
+
+
+void FVM_NonlinearSolver::fused_residual(Vec x, Vec r)
+{
+  _fused_jacobian_valid = false;
+
+  if( !fused_assembly() )
+  {
+    build_petsc_sens_residual(x, r);
+    return;
+  }
+
+  if( !build_petsc_sens_residual_jacobian(x, r) ) return;
+
+  solver_counters.add(SolverCounters::JacobianAssembly);
+
+  if( !_fused_x )
+    VecDuplicate(x, &_fused_x);
+  VecCopy(x, _fused_x);
+  _fused_jacobian_valid = true;
+}
+
+
+bool FVM_NonlinearSolver::fused_jacobian_valid(Vec x)
+{
+  if( !_fused_jacobian_valid ) return false;
+
+  // the jacobian is used once
+  _fused_jacobian_valid = false;
+
+  PetscBool same;
+  VecEqual(x, _fused_x, &same);
+  return same == PETSC_TRUE;
+}
+
+
+PetscReal FVM_NonlinearSolver::trial_residual_norm(Vec x, Vec y, PetscReal t)
+{
+  if( !_trial_x ) VecDuplicate(x, &_trial_x);
+  if( !_trial_r ) VecDuplicate(x, &_trial_r);
+
+  // same operations as the step w = x - y of SNES with the scaled y, so that the
+  // residual can be reused when the trial is accepted
+  VecCopy(y, _trial_r);
+  VecScale(_trial_r, t);
+  VecWAXPY(_trial_x, -1.0, _trial_r, x);
+
+  solver_counters.add(SolverCounters::LineSearchTrials);
+  assembly_timer_start();
+  build_petsc_sens_residual(_trial_x, _trial_r);
+  assembly_timer_stop();
+  held_dofs_residual(_trial_x, _trial_r);
+  _trial_valid = true;
+
+  PetscReal norm;
+  VecNorm(_trial_r, NORM_2, &norm);
+
+  // frozen dofs enter the norm as in frozen_dofs_residual(), but they are not released
+  // here. the stored residual keeps the assembled values for the wake test.
+  PetscScalar *xx, *rr;
+  VecGetArray(_trial_x, &xx);
+  VecGetArray(_trial_r, &rr);
+  PetscReal frozen_correction = 0.0;
+  for(unsigned int i=0; i<_frozen_dofs.size(); ++i)
+  {
+    const unsigned int dof = _frozen_dofs[i];
+    const PetscScalar rf = xx[dof] - _frozen_values[i];
+    frozen_correction += rf*rf - rr[dof]*rr[dof];
+  }
+  VecRestoreArray(_trial_r, &rr);
+  VecRestoreArray(_trial_x, &xx);
+  Parallel::sum(frozen_correction);
+
+  return std::sqrt(std::max(0.0, norm*norm + frozen_correction));
+}
+
+
+bool FVM_NonlinearSolver::trial_residual_reuse(Vec x, Vec r)
+{
+  if( !_trial_valid ) return false;
+
+  // the trial residual is used once
+  _trial_valid = false;
+
+  PetscBool same;
+  VecEqual(x, _trial_x, &same);
+  if( same != PETSC_TRUE ) return false;
+
+  VecCopy(_trial_r, r);
+  return true;
+}
+
+
+PetscReal FVM_NonlinearSolver::bank_rose_factor(Vec x, Vec y)
+{
+  const PetscReal delta = 0.1;
+  const int max_trials = 10;
+
+  // f holds the residual at current x
+  PetscReal fnorm;
+  VecNorm(f, NORM_2, &fnorm);
+  if( fnorm == 0.0 ) return 1.0;
+
+  // relax the damping of the last newton iteration
+  _bank_rose_K *= 0.1;
+
+  PetscReal t = 1.0;
+  for(int k=0; k<max_trials; ++k)
+  {
+    t = 1.0/(1.0 + _bank_rose_K*fnorm);
+    PetscReal tnorm = trial_residual_norm(x, y, t);
+    if( tnorm <= (1.0 - delta*t)*fnorm ) break;
+    _bank_rose_K = std::max(10.0*_bank_rose_K, 1.0/fnorm);
+  }
+
+  return t;
+}
+
+
+void FVM_NonlinearSolver::hold_dofs(const std::vector<unsigned int> &offsets)
+{
+  _held_dofs = offsets;
+  _held_values.resize(offsets.size());
+
+  if( offsets.empty() ) return;
+
+  PetscScalar *xx;
+  VecGetArray(x, &xx);
+  for(unsigned int i=0; i<_held_dofs.size(); ++i)
+    _held_values[i] = xx[_held_dofs[i]];
+  VecRestoreArray(x, &xx);
+}
+
+
+void FVM_NonlinearSolver::held_dofs_residual(Vec x, Vec r)
+{
+  if( _held_dofs.empty() ) return;
+
+  PetscScalar *xx, *rr;
+  VecGetArray(x, &xx);
+  VecGetArray(r, &rr);
+  for(unsigned int i=0; i<_held_dofs.size(); ++i)
+    rr[_held_dofs[i]] = xx[_held_dofs[i]] - _held_values[i];
+  VecRestoreArray(r, &rr);
+  VecRestoreArray(x, &xx);
+}
+
+
+void FVM_NonlinearSolver::held_dofs_jacobian(Mat *pc)
+{
+  // all the processors take part in MatZeroRows
+  unsigned int n_held = _held_dofs.size() + _frozen_dofs.size();
+  Parallel::sum(n_held);
+  if( !n_held ) return;
+
+  std::vector<PetscInt> rows;
+  for(unsigned int i=0; i<_held_dofs.size(); ++i)
+    rows.push_back(this->global_offset + _held_dofs[i]);
+  for(unsigned int i=0; i<_frozen_dofs.size(); ++i)
+    rows.push_back(this->global_offset + _frozen_dofs[i]);
+
+  // the nonzero pattern is kept, see MAT_KEEP_NONZERO_PATTERN
+  PetscUtils::MatZeroRows(*pc, rows.size(), rows.empty() ? PETSC_NULL : &rows[0], 1.0);
+}
+
+
+void FVM_NonlinearSolver::freeze_dofs_monitor(PetscInt its)
+{
+  if( SolverSpecify::FreezeTol <= 0.0 || !freeze_support() ) return;
+
+  if( !_freeze_x ) VecDuplicate(x, &_freeze_x);
+
+  // a new nonlinear solve starts with all the dofs active
+  if( its == 0 )
+  {
+    release_frozen_dofs();
+    _freeze_closed = false;
+    _freeze_count.assign(n_local_dofs, 0);
+    VecCopy(x, _freeze_x);
+    return;
+  }
+
+  if( _freeze_closed ) return;
+
+  std::vector<bool> frozen(n_local_dofs, false);
+  for(unsigned int i=0; i<_frozen_dofs.size(); ++i)
+    frozen[_frozen_dofs[i]] = true;
+
+  // the waking reference of a frozen dof is not less than this fraction of the largest residual
+  PetscReal fmax;
+  VecNorm(f, NORM_INFINITY, &fmax);
+
+  PetscScalar *xx, *xo, *ff;
+  VecGetArray(x, &xx);
+  VecGetArray(_freeze_x, &xo);
+  VecGetArray(f, &ff);
+
+  // f holds the residual at x, residual of the frozen dof is replaced by x - x_freeze = 0
+  for(unsigned int i=0; i<n_local_dofs; ++i)
+  {
+    if( frozen[i] ) continue;
+
+    if( std::abs(xx[i] - xo[i]) <= SolverSpecify::FreezeTol*std::abs(xx[i]) )
+      _freeze_count[i]++;
+    else
+      _freeze_count[i] = 0;
+
+    if( _freeze_count[i] >= static_cast<unsigned int>(SolverSpecify::FreezeIts) )
+    {
+      _frozen_dofs.push_back(i);
+      _frozen_values.push_back(xx[i]);
+      _frozen_residual.push_back(std::max(std::abs(ff[i]), SolverSpecify::FreezeTol*fmax));
+      ff[i] = 0.0;
+    }
+  }
+
+  VecRestoreArray(f, &ff);
+  VecRestoreArray(_freeze_x, &xo);
+  VecRestoreArray(x, &xx);
+
+  VecCopy(x, _freeze_x);
+
+  update_frozen_regions();
+}
+
+
+void FVM_NonlinearSolver::frozen_dofs_residual(Vec x, Vec r)
+{
+  if( _frozen_dofs.empty() ) return;
+
+  PetscScalar *xx, *rr;
+  VecGetArray(x, &xx);
+  VecGetArray(r, &rr);
+  for(unsigned int i=0; i<_frozen_dofs.size(); )
+  {
+    const unsigned int dof = _frozen_dofs[i];
+    // the equation is no longer satisfied, the dof joins the Newton set again.
+    // the residual of a skipped region is incomplete, it is checked by frozen_dofs_convergence()
+    const bool skipped = !_frozen_skipped.empty() && _frozen_skipped[dof];
+    if( !skipped && std::abs(rr[dof]) > SolverSpecify::FreezeWake*_frozen_residual[i] )
+    {
+      _freeze_count[dof] = 0;
+      _frozen_dofs[i]     = _frozen_dofs.back();     _frozen_dofs.pop_back();
+      _frozen_values[i]   = _frozen_values.back();   _frozen_values.pop_back();
+      _frozen_residual[i] = _frozen_residual.back(); _frozen_residual.pop_back();
+      continue;
+    }
+    rr[dof] = xx[dof] - _frozen_values[i];
+    ++i;
+  }
+  VecRestoreArray(r, &rr);
+  VecRestoreArray(x, &xx);
+}
+
+
+void FVM_NonlinearSolver::release_frozen_dofs()
+{
+  _frozen_dofs.clear();
+  _frozen_values.clear();
+  _frozen_residual.clear();
+  _frozen_regions.clear();
+  _frozen_skipped.clear();
+}
+
+
+void FVM_NonlinearSolver::frozen_dofs_convergence(PetscInt its, PetscReal xnorm, PetscReal gnorm, SNESConvergedReason *reason)
+{
+  if( *reason <= 0 ) return;
+
+  unsigned int n_frozen = _frozen_dofs.size();
+  Parallel::sum(n_frozen);
+  if( !n_frozen ) return;
+
+  // f was evaluated with the frozen equations replaced, evaluate the full residual at x.
+  // it is also the right hand side of the next Newton step if the test fails
+  release_frozen_dofs();
+  _freeze_closed = true;
+
+  solver_counters.add(SolverCounters::FunctionAssembly);
+  assembly_timer_start();
+  fused_residual(x, f);
+  assembly_timer_stop();
+  held_dofs_residual(x, f);
+
+  PetscReal fnorm;
+  VecNorm(f, NORM_2, &fnorm);
+
+  *reason = SNES_CONVERGED_ITERATING;
+  petsc_snes_convergence_test(its, xnorm, gnorm, fnorm, reason);
+}
+
+
+void FVM_NonlinearSolver::update_frozen_regions()
+{
+  _frozen_regions.clear();
+  _frozen_skipped.clear();
+
+  unsigned int n_frozen = _frozen_dofs.size();
+  Parallel::sum(n_frozen);
+  // the extra dofs of circuit read the electrode rows, keep the full assembly
+  if( !n_frozen || this->extra_dofs() ) return;
+
+  std::vector<bool> frozen(n_local_dofs, false);
+  for(unsigned int i=0; i<_frozen_dofs.size(); ++i)
+    frozen[_frozen_dofs[i]] = true;
+
+  const unsigned int n_regions = _system.n_regions();
+  const unsigned int n_bcs = _system.get_bcs()->n_bcs();
+
+  // all the on processor nodes of the region are frozen
+  std::vector<unsigned int> region_flag(n_regions, 1);
+  std::vector< std::vector<unsigned int> > region_dofs(n_regions);
+  for(unsigned int n=0; n<n_regions; ++n)
+  {
+    region_local_dofs(_system.region(n), region_dofs[n]);
+    if( !this->node_dofs(_system.region(n)) ) region_flag[n] = 0;
+    for(unsigned int i=0; i<region_dofs[n].size(); ++i)
+      if( !frozen[region_dofs[n][i]] ) { region_flag[n] = 0; break; }
+  }
+  Parallel::min(region_flag);
+
+  // the bc reads and moves the rows of its nodes and feeds its own dofs by them,
+  // the regions it touches are skipped only if all these dofs are frozen
+  std::vector<unsigned int> bc_flag(n_bcs, 1);
+  std::vector<unsigned int> bc_region(n_bcs*n_regions, 0);
+  std::vector< std::vector<unsigned int> > bc_dof_list(n_bcs);
+  for(unsigned int b=0; b<n_bcs; ++b)
+  {
+    std::vector<unsigned int> regions;
+    bc_local_dofs(_system.get_bcs()->get_bc(b), bc_dof_list[b], regions);
+    for(unsigned int i=0; i<regions.size(); ++i)
+      bc_region[b*n_regions + regions[i]] = 1;
+    for(unsigned int i=0; i<bc_dof_list[b].size(); ++i)
+      if( !frozen[bc_dof_list[b][i]] ) { bc_flag[b] = 0; break; }
+  }
+  Parallel::min(bc_flag);
+  Parallel::max(bc_region);
+
+  for(unsigned int b=0; b<n_bcs; ++b)
+    for(unsigned int n=0; n<n_regions; ++n)
+      if( bc_region[b*n_regions + n] && !bc_flag[b] ) region_flag[n] = 0;
+
+  if( std::find(region_flag.begin(), region_flag.end(), 1u) == region_flag.end() ) return;
+
+  // the residual of the skipped regions and of the bcs they touch is incomplete
+  _frozen_regions.assign(n_regions, false);
+  _frozen_skipped.assign(n_local_dofs, false);
+  for(unsigned int n=0; n<n_regions; ++n)
+  {
+    if( !region_flag[n] ) continue;
+    _frozen_regions[n] = true;
+    for(unsigned int i=0; i<region_dofs[n].size(); ++i)
+      _frozen_skipped[region_dofs[n][i]] = true;
+    for(unsigned int b=0; b<n_bcs; ++b)
+    {
+      if( !bc_region[b*n_regions + n] ) continue;
+      for(unsigned int i=0; i<bc_dof_list[b].size(); ++i)
+        _frozen_skipped[bc_dof_list[b][i]] = true;
+    }
+  }
+}
+
+
+void FVM_NonlinearSolver::region_local_dofs(const SimulationRegion * region, std::vector<unsigned int> & dofs) const
+{
+  const unsigned int n_dofs = this->node_dofs(region);
+  SimulationRegion::const_processor_node_iterator node_it = region->on_processor_nodes_begin();
+  for(; node_it!=region->on_processor_nodes_end(); ++node_it)
+  {
+    const unsigned int offset = (*node_it)->global_offset() - this->global_offset;
+    for(unsigned int i=0; i<n_dofs; ++i)
+      dofs.push_back(offset+i);
+  }
+}
+
+
+void FVM_NonlinearSolver::bc_local_dofs(const BoundaryCondition * bc, std::vector<unsigned int> & dofs,
+                                        std::vector<unsigned int> & regions) const
+{
+  // the extra dofs of the bc and of its inter connect hub
+  std::vector<const BoundaryCondition *> dof_bcs(1, bc);
+  if( bc->is_inter_connect_bc() ) dof_bcs.push_back(bc->inter_connect_hub());
+  for(unsigned int k=0; k<dof_bcs.size(); ++k)
+  {
+    const unsigned int n_dofs = this->bc_dofs(dof_bcs[k]);
+    const unsigned int offset = dof_bcs[k]->global_offset();
+    if( !n_dofs || offset < this->global_offset || offset >= this->global_offset + n_local_dofs ) continue;
+    for(unsigned int i=0; i<n_dofs; ++i)
+      dofs.push_back(offset - this->global_offset + i);
+  }
+
+  // the node dofs of all the regions on the boundary
+  BoundaryCondition::const_node_iterator node_it = bc->nodes_begin();
+  for(; node_it!=bc->nodes_end(); ++node_it)
+  {
+    if( (*node_it)->processor_id() != Genius::processor_id() ) continue;
+
+    BoundaryCondition::const_region_node_iterator rnode_it = bc->region_node_begin(*node_it);
+    for(; rnode_it!=bc->region_node_end(*node_it); ++rnode_it)
+    {
+      const SimulationRegion * region = (*rnode_it).second.first;
+      const unsigned int n_dofs = this->node_dofs(region);
+      const unsigned int offset = (*rnode_it).second.second->global_offset() - this->global_offset;
+      for(unsigned int i=0; i<n_dofs; ++i)
+        dofs.push_back(offset+i);
+      regions.push_back(region->subdomain_id());
+    }
+  }
+}
+
+
+bool FVM_NonlinearSolver::broyden_rebuild_jacobian()
+{
+  if( _nonlinear_solver_type != SolverSpecify::Broyden || SolverSpecify::JFNK ) return true;
+
+  PetscInt its;
+  SNESGetIterationNumber(snes, &its);
+
+  // f holds the residual at current x
+  PetscReal fnorm;
+  VecNorm(f, NORM_2, &fnorm);
+
+  bool rebuild = !_broyden_jacobian_valid;
+  if( its == 0 )
+  {
+    // a new nonlinear solve, secant pairs of the last solve belong to another residual function
+    _broyden_n = 0;
+    _broyden_has_last = false;
+    // the time step enters the diagonal of jacobian
+    if( std::abs(SolverSpecify::dt - _broyden_dt) > 0.5*_broyden_dt ) rebuild = true;
+  }
+  else
+  {
+    if( fnorm > SolverSpecify::BroydenRestart*_broyden_fnorm_last ) rebuild = true;
+    if( _broyden_n >= static_cast<unsigned int>(std::max(SolverSpecify::BroydenMemory, 0)) ) rebuild = true;
+  }
+  _broyden_fnorm_last = fnorm;
+
+  if( rebuild )
+  {
+    _broyden_n = 0;
+    _broyden_has_last = false;
+    _broyden_jacobian_valid = true;
+    _broyden_dt = SolverSpecify::dt;
+  }
+
+  return rebuild;
+}
+
+
+void FVM_NonlinearSolver::broyden_update_direction(Vec x, Vec y, PetscBool *changed_y)
+{
+  if( _nonlinear_solver_type != SolverSpecify::Broyden || SolverSpecify::JFNK ) return;
+
+  if( !_broyden_x )
+  {
+    VecDuplicate(x, &_broyden_x);
+    VecDuplicate(x, &_broyden_f);
+    VecDuplicate(x, &_broyden_q);
+  }
+
+  // y is H_0 F(x) here. the newton step is x_new = x - y, so H maps df to the step s
+  if( _broyden_has_last )
+  {
+    if( _broyden_n == _broyden_w.size() )
+    {
+      _broyden_w.push_back(PETSC_NULL);
+      _broyden_df.push_back(PETSC_NULL);
+      _broyden_df2.push_back(0.0);
+      VecDuplicate(x, &_broyden_w.back());
+      VecDuplicate(x, &_broyden_df.back());
+    }
+
+    Vec w  = _broyden_w[_broyden_n];
+    Vec df = _broyden_df[_broyden_n];
+
+    // df = F - F_last
+    VecWAXPY(df, -1.0, _broyden_f, f);
+    PetscScalar df2;
+    VecDot(df, df, &df2);
+
+    if( std::abs(df2) > 0.0 )
+    {
+      // w = s - H df, where s = x - x_last, H_0 df = y - q_last
+      VecWAXPY(w, -1.0, _broyden_x, x);
+      VecAXPY(w, -1.0, y);
+      VecAXPY(w, 1.0, _broyden_q);
+      if( _broyden_n )
+      {
+        std::vector<PetscScalar> alpha(_broyden_n);
+        VecMDot(df, _broyden_n, &_broyden_df[0], &alpha[0]);
+        for(unsigned int j=0; j<_broyden_n; ++j)
+          alpha[j] = -alpha[j]/_broyden_df2[j];
+        VecMAXPY(w, _broyden_n, &alpha[0], &_broyden_w[0]);
+      }
+      _broyden_df2[_broyden_n++] = df2;
+    }
+  }
+
+  // save the last iteration
+  VecCopy(x, _broyden_x);
+  VecCopy(f, _broyden_f);
+  VecCopy(y, _broyden_q);
+  _broyden_has_last = true;
+
+  if( !_broyden_n ) return;
+
+  // y = H F = H_0 F + sum_j w_j (df_j^T F)/(df_j^T df_j)
+  std::vector<PetscScalar> alpha(_broyden_n);
+  VecMDot(f, _broyden_n, &_broyden_df[0], &alpha[0]);
+  for(unsigned int j=0; j<_broyden_n; ++j)
+    alpha[j] /= _broyden_df2[j];
+  VecMAXPY(y, _broyden_n, &alpha[0], &_broyden_w[0]);
+
+  *changed_y = PETSC_TRUE;
+}
+
+
+MatStructure FVM_NonlinearSolver::jacobian_matrix_structure()
+{
+  // the jacobian matrix always keeps its nonzero pattern (MAT_KEEP_NONZERO_PATTERN),
+  // so the symbolic factorization can be reused once it has been done.
+  if( !SolverSpecify::ReuseSymbolicFactorization || !symbolic_factorization_done )
+  {
+    symbolic_factorization_done = true;
+    return DIFFERENT_NONZERO_PATTERN;
+  }
+  return SAME_NONZERO_PATTERN;
+}
+
+
 void FVM_NonlinearSolver::sens_solve()
 {
   START_LOG("sens_solve()", "FVM_NonlinearSolver");
 
+  // the wall time of this solve and the part of residual and jacobian evaluation
+  PerfData solve_timer;
+  solve_timer.start();
+  const double assembly_time = _assembly_timer.tot_time;
+
   // do snes solve
   SNESSolve ( snes, PETSC_NULL, x );
 
+  // close the event opened by the last Newton iteration
+  log_newton_finish();
+
   // get the converged reason
   SNESConvergedReason reason;
   SNESGetConvergedReason ( snes,&reason );
+  count_snes_solve(reason);
 
   // if Line search failed, disable Line search
   if ( reason == SNES_DIVERGED_LINE_SEARCH || reason == SNES_DIVERGED_LOCAL_MIN )
@@ -1074,16 +2624,281 @@ void FVM_NonlinearSolver::sens_solve()
     RECORD();
     SNESLineSearchSet ( snes,SNESLineSearchNo,PETSC_NULL );
     SNESSolve ( snes, PETSC_NULL, x );
+    log_newton_finish();
+
+    SNESGetConvergedReason ( snes,&reason );
+    count_snes_solve(reason);
+  }
+
+  // single precision factorization can not be refined to the tolerance, factor in double precision
+  if ( reason == SNES_DIVERGED_LINEAR_SOLVE && _lu_single_precision )
+  {
+    MESSAGE <<"------> refinement of single precision LU stalled. Factor in double precision.\n\n\n";
+    RECORD();
+    _lu_single_precision = false;
+    set_petsc_option("-pc_precision", "double", false);
+    PCReset(pc);
+    set_petsc_linear_solver_type();
+    SNESSolve ( snes, PETSC_NULL, x );
+    log_newton_finish();
+
+    SNESGetConvergedReason ( snes,&reason );
+    count_snes_solve(reason);
+  }
+
+  // krylov solver failed, try again by direct solver
+  if ( reason == SNES_DIVERGED_LINEAR_SOLVE && SolverSpecify::AdaptiveLinearSolver && !SolverSpecify::JFNK && !direct_linear_solver() )
+  {
+    MESSAGE <<"------> krylov linear solver diverged. Switch to direct linear solver.\n\n\n";
+    RECORD();
+    _adaptive_iterative_failed = true;
+    _adaptive_iterative_type = _linear_solver_type;
+    switch_linear_solver(SolverSpecify::LU, _preconditioner_type);
+    SNESSolve ( snes, PETSC_NULL, x );
+    log_newton_finish();
+
+    SNESGetConvergedReason ( snes,&reason );
+    count_snes_solve(reason);
+  }
+
+  {
+    const double solve_time = solve_timer.stopit();
+    adaptive_linear_solver(reason, solve_time, solve_time - (_assembly_timer.tot_time - assembly_time));
+  }
+
+  // the residual out of Newton solve is the full one
+  release_frozen_dofs();
+
+  // let the hooks, i.e. jdump, save the state of the failed solve
+  if ( reason < 0 )
+  {
+    // the next try should not use a lagged preconditioner
+    _pc_rebuild = true;
+    hook_list()->trigger("diverged");
+    // the next try should not start from a jacobian of the failed solve
+    _broyden_jacobian_valid = false;
   }
 
   STOP_LOG("sens_solve()", "FVM_NonlinearSolver");
 }
 
 
+bool FVM_NonlinearSolver::direct_linear_solver() const
+{
+  switch (_linear_solver_type)
+  {
+    case SolverSpecify::LU:
+    case SolverSpecify::UMFPACK:
+    case SolverSpecify::SuperLU:
+    case SolverSpecify::MUMPS:
+    case SolverSpecify::PASTIX:
+    case SolverSpecify::SuperLU_DIST:
+    case SolverSpecify::KLU: return true;
+    default: break;
+  }
+
+  return _preconditioner_type == SolverSpecify::LU_PRECOND ||
+         _preconditioner_type == SolverSpecify::CHOLESKY_PRECOND;
+}
+
+
+void FVM_NonlinearSolver::switch_linear_solver(SolverSpecify::LinearSolverType ls, SolverSpecify::PreconditionerType pct)
+{
+  _linear_solver_type = ls;
+  _preconditioner_type = pct;
+
+  PCReset(pc);
+  set_petsc_linear_solver_type();
+  set_petsc_preconditioner_type();
+
+  // krylov solver may start from the extrapolated Newton correction
+  KSPSetInitialGuessNonzero(ksp, (SolverSpecify::KSPWarmStart && !direct_linear_solver()) ? PETSC_TRUE : PETSC_FALSE);
+
+  // the preconditioner lag of direct solver
+  set_jacobian_lag(_jacobian_lag);
+
+  symbolic_factorization_done = false;
+  _pc_rebuild = true;
+}
+
+
+void FVM_NonlinearSolver::adaptive_linear_solver(SNESConvergedReason reason, double solve_time, double linear_time)
+{
+  if( !SolverSpecify::AdaptiveLinearSolver || SolverSpecify::JFNK ) return;
+  if( reason < 0 ) return;
+
+  PetscInt its, lits;
+  SNESGetIterationNumber(snes, &its);
+  SNESGetLinearSolveIterations(snes, &lits);
+
+  if( !direct_linear_solver() )
+  {
+    // krylov iterations explode, the preconditioner does not work for this problem
+    if( its > 0 && lits > SolverSpecify::AdaptiveKSPIts*its )
+    {
+      MESSAGE <<"------> " << lits/its << " krylov iterations per Newton step. Switch to direct linear solver.\n\n\n";
+      RECORD();
+      _adaptive_iterative_failed = true;
+      _adaptive_iterative_type = _linear_solver_type;
+      switch_linear_solver(SolverSpecify::LU, _preconditioner_type);
+    }
+    return;
+  }
+
+  // krylov solver was tried in this solve command
+  if( _adaptive_iterative_failed ) return;
+
+  // all the processors should make the same decision
+  Parallel::max(solve_time);
+  Parallel::max(linear_time);
+
+  // factorization takes most of the time in successive solves
+  if( solve_time > 0.0 && linear_time > 0.8*solve_time )
+    _adaptive_direct_dominant++;
+  else
+    _adaptive_direct_dominant = 0;
+
+  if( _adaptive_direct_dominant >= 3 )
+  {
+    SolverSpecify::LinearSolverType ls = _adaptive_iterative_type;
+    if( ls == SolverSpecify::INVALID_LINEAR_SOLVER )
+      ls = SolverSpecify::linear_solver_category(_linear_solver_type) == SolverSpecify::DIRECT ? SolverSpecify::GMRES : _linear_solver_type;
+
+    SolverSpecify::PreconditionerType pct = _preconditioner_type;
+    if( pct == SolverSpecify::LU_PRECOND || pct == SolverSpecify::CHOLESKY_PRECOND )
+      pct = SolverSpecify::ASM_PRECOND;
+
+    MESSAGE <<"------> direct linear solver takes " << static_cast<int>(100*linear_time/solve_time) << "% of solve time. Switch to krylov linear solver.\n\n\n";
+    RECORD();
+    _adaptive_direct_dominant = 0;
+    switch_linear_solver(ls, pct);
+  }
+}
+
+
+void FVM_NonlinearSolver::count_snes_solve(SNESConvergedReason reason)
+{
+  PetscInt its, lits;
+  SNESGetIterationNumber(snes, &its);
+  SNESGetLinearSolveIterations(snes, &lits);
+
+  solver_counters.add(SolverCounters::NonlinearSolves);
+  solver_counters.add(SolverCounters::NewtonIterations, its);
+  solver_counters.add(SolverCounters::KSPIterations, lits);
+  if( reason < 0 ) solver_counters.add(SolverCounters::DivergedSolves);
+}
+
+
+
+#ifdef HAVE_SLEPC
+namespace
+{
+  // J^-1 and J^-T applied by the factorization held in the PC of nonlinear solver
+  PetscErrorCode inverse_jacobian_mult(Mat A, Vec x, Vec y)
+  {
+    void * ctx;
+    PetscErrorCode ierr = MatShellGetContext(A, &ctx); CHKERRQ(ierr);
+    return PCApply(static_cast<PC>(ctx), x, y);
+  }
+
+  PetscErrorCode inverse_jacobian_mult_transpose(Mat A, Vec x, Vec y)
+  {
+    void * ctx;
+    PetscErrorCode ierr = MatShellGetContext(A, &ctx); CHKERRQ(ierr);
+    return PCApplyTranspose(static_cast<PC>(ctx), x, y);
+  }
+}
+#endif
+
 
-double FVM_NonlinearSolver::condition_number_of_jacobian_matrix()
+bool FVM_NonlinearSolver::inverse_jacobian_operator(Mat &Jinv)
 {
 #ifdef HAVE_SLEPC
+  PetscErrorCode ierr;
+
+  // only a direct factorization gives J^-1
+  const char * pc_type = PETSC_NULL;
+  ierr = PCGetType(pc, &pc_type);  genius_assert(!ierr);
+  if( pc_type == PETSC_NULL || (std::string(pc_type) != PCLU && std::string(pc_type) != PCCHOLESKY) )
+  {
+    MESSAGE<< "Warning: linear solver is not a direct factorization, factorize jacobian matrix again for spectrum." << std::endl;
+    RECORD();
+    return false;
+  }
+
+  PetscInt m, n, M, N;
+  ierr = MatGetLocalSize(J, &m, &n);  genius_assert(!ierr);
+  ierr = MatGetSize(J, &M, &N);       genius_assert(!ierr);
+  ierr = MatCreateShell(PETSC_COMM_WORLD, m, n, M, N, (void *)pc, &Jinv);  genius_assert(!ierr);
+  ierr = MatShellSetOperation(Jinv, MATOP_MULT, (void(*)(void))inverse_jacobian_mult);  genius_assert(!ierr);
+  ierr = MatShellSetOperation(Jinv, MATOP_MULT_TRANSPOSE, (void(*)(void))inverse_jacobian_mult_transpose);  genius_assert(!ierr);
+  return true;
+#else
+  return false;
+#endif
+}
+
+
+double FVM_NonlinearSolver::condition_number_of_jacobian_matrix(bool reuse_pc)
+{
+#ifdef HAVE_SLEPC
+
+  // smallest singular value of J is the reciprocal of the largest one of J^-1,
+  // which thick-restart Lanczos finds with the factorization of nonlinear solver.
+  Mat Jinv;
+  if( reuse_pc && inverse_jacobian_operator(Jinv) )
+  {
+    PetscErrorCode ierr;
+    SVD svd_l, svd_s;
+    ierr = SVDCreate(PETSC_COMM_WORLD, &svd_l);  assert(!ierr);
+    ierr = SVDCreate(PETSC_COMM_WORLD, &svd_s);  assert(!ierr);
+    ierr = SVDSetOperator(svd_l, J);             assert(!ierr);
+    ierr = SVDSetOperator(svd_s, Jinv);          assert(!ierr);
+    ierr = SVDSetWhichSingularTriplets(svd_l, SVD_LARGEST);  assert(!ierr);
+    ierr = SVDSetWhichSingularTriplets(svd_s, SVD_LARGEST);  assert(!ierr);
+    ierr = SVDSetType(svd_l, SVDTRLANCZOS);      assert(!ierr);
+    ierr = SVDSetType(svd_s, SVDTRLANCZOS);      assert(!ierr);
+    ierr = SVDSetFromOptions(svd_l);  assert(!ierr);
+    ierr = SVDSetFromOptions(svd_s);  assert(!ierr);
+
+    PetscReal sigma_large=1, sigma_small=1;
+    PetscInt nconv_l, nconv_s;
+    PetscReal error;
+
+    SVDSolve(svd_l);
+    SVDGetConverged(svd_l, &nconv_l);
+    if(nconv_l>0)
+    {
+      SVDGetSingularTriplet(svd_l, 0, &sigma_large, PETSC_NULL, PETSC_NULL);
+      SVDComputeRelativeError(svd_l, 0, &error);
+      MESSAGE<< "Largest singular value  : " << std::scientific << std::setprecision(6)<<std::setw(10) << sigma_large << " with error " << error << std::endl;
+      RECORD();
+    }
+
+    SVDSolve(svd_s);
+    SVDGetConverged(svd_s, &nconv_s);
+    if(nconv_s>0)
+    {
+      PetscReal sigma_inv;
+      SVDGetSingularTriplet(svd_s, 0, &sigma_inv, PETSC_NULL, PETSC_NULL);
+      SVDComputeRelativeError(svd_s, 0, &error);
+      sigma_small = 1.0/sigma_inv;
+      MESSAGE<< "Smallest singular value : " << std::scientific << std::setprecision(6)<<std::setw(10) << sigma_small << " with error " << error << std::endl;
+      RECORD();
+    }
+
+    if(nconv_l>0 && nconv_s>0)
+    {
+      MESSAGE<< "Approx condition number: " << std::scientific << std::setprecision(6)<<std::setw(10) << sigma_large/sigma_small << std::endl;
+      RECORD();
+    }
+
+    ierr = SVDDestroy(PetscDestroyObject(svd_s));  assert(!ierr);
+    ierr = SVDDestroy(PetscDestroyObject(svd_l));  assert(!ierr);
+    ierr = MatDestroy(PetscDestroyObject(Jinv));   assert(!ierr);
+
+    return sigma_large/sigma_small;
+  }
 
   // SVD solver for largest singular value
   SVD            svd_l;
@@ -1203,15 +3018,56 @@ double FVM_NonlinearSolver::condition_number_of_jacobian_matrix()
 
 
 
-void FVM_NonlinearSolver::eigen_value_of_jacobian_matrix(int n, int is, Vec Vrs, int il, Vec Vrl)
+void FVM_NonlinearSolver::eigen_value_of_jacobian_matrix(int n, int is, Vec Vrs, int il, Vec Vrl, bool reuse_pc)
 {
   PetscErrorCode ierr;
 
 #ifdef HAVE_SLEPC
+  // a nonzero eigen vector given by caller, i.e. the one of last call, is the initial space
+  PetscReal norm_s = 0.0, norm_l = 0.0;
+  if( Vrs != PETSC_NULL ) VecNorm(Vrs, NORM_2, &norm_s);
+  if( Vrl != PETSC_NULL ) VecNorm(Vrl, NORM_2, &norm_l);
+
   // get the smallest eigen value
-  PetscInt    nconv_s;
+  PetscInt    nconv_s = 0;
   PetscScalar k_s;
   EPS         eps_s;
+
+  // shift-and-invert at zero with the factorization of nonlinear solver:
+  // the smallest eigen values of J are the reciprocal of the largest ones of J^-1
+  Mat Jinv;
+  if( reuse_pc && inverse_jacobian_operator(Jinv) )
+  {
+    EPSCreate(PETSC_COMM_WORLD, &eps_s);
+    EPSSetType(eps_s, EPSKRYLOVSCHUR);
+    EPSSetDimensions(eps_s, n, PETSC_DECIDE, PETSC_DECIDE);
+    EPSSetOperators(eps_s, Jinv, PETSC_NULL);
+    EPSSetWhichEigenpairs(eps_s, EPS_LARGEST_MAGNITUDE);
+    if( norm_s > 0.0 ) EPSSetInitialSpace(eps_s, 1, &Vrs);
+    EPSSetFromOptions(eps_s);
+    EPSSolve( eps_s );
+    EPSGetConverged( eps_s, &nconv_s );
+    for(PetscInt i=0; i<nconv_s; ++i)
+    {
+      PetscReal   error_s;
+      PetscScalar kr_s, ki_s;
+      EPSGetEigenvalue( eps_s, i, &kr_s, &ki_s );
+      EPSComputeRelativeError( eps_s, i, &error_s );
+      // 1/(kr+i*ki), the real part
+      PetscScalar k = kr_s/(kr_s*kr_s + ki_s*ki_s);
+      MESSAGE<< "Smallest " << i << " eigen value: " << std::scientific << std::setprecision(6)<<std::setw(10) << k << " with error " << error_s << std::endl;
+      RECORD();
+      if(i==is)
+      {
+        k_s = k;
+        EPSGetEigenpair( eps_s, i, &kr_s, &ki_s, Vrs, PETSC_NULL);
+      }
+    }
+    EPSDestroy(PetscDestroyObject(eps_s));
+    MatDestroy(PetscDestroyObject(Jinv));
+  }
+  else
+  {
   // create eigen value solver for smallest one
   EPSCreate(PETSC_COMM_WORLD, &eps_s);
   EPSSetDimensions(eps_s, n, 3*n, PETSC_DECIDE);
@@ -1278,6 +3134,7 @@ void FVM_NonlinearSolver::eigen_value_of_jacobian_matrix(int n, int is, Vec Vrs,
     }
   }
   EPSDestroy(PetscDestroyObject(eps_s));
+  }
 
 
   // get the largest eigen value
@@ -1293,6 +3150,7 @@ void FVM_NonlinearSolver::eigen_value_of_jacobian_matrix(int n, int is, Vec Vrs,
   EPSSetOperators(eps_l, J, PETSC_NULL);
   // set target to largest eigen value
   EPSSetWhichEigenpairs(eps_l, EPS_LARGEST_MAGNITUDE);
+  if( norm_l > 0.0 ) EPSSetInitialSpace(eps_l, 1, &Vrl);
   // Set solver parameters at runtime
   EPSSetFromOptions(eps_l);
   // solve here!
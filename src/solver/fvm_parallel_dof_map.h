@@ -0,0 +1,396 @@
+/********************************************************************************/
+/*     888888    888888888   88     888  88888   888      888    88888888       */
+/*   8       8   8           8 8     8     8      8        8    8               */
+/*  8            8           8  8    8     8      8        8    8               */
+/*  8            888888888   8   8   8     8      8        8     8888888        */
+/*  8      8888  8           8    8  8     8      8        8            8       */
+/*   8       8   8           8     8 8     8      8        8            8       */
+/*     888888    888888888  888     88   88888     88888888     88888888        */
+/*                                                                              */
+/*       A Three-Dimensional General Purpose Semiconductor Simulator.           */
+/*                                                                              */
+/*                                                                              */
+/*  Copyright (C) 2007-2008                                                     */
+/*  Cogenda Pte Ltd                                                             */
+/*                                                                              */
+/*  Please contact Cogenda Pte Ltd for license information                      */
+/*                                                                              */
+/*  Author: Gong Ding   gdiso@ustc.edu                                          */
+/*                                                                              */
+/********************************************************************************/
+
+
+#include <numeric>
+#include <algorithm>
+
+#include "boundary_info.h"
+#include "fvm_pde_solver.h"
+#include "parallel.h"
+
+
+
+void FVM_PDESolver::set_parallel_dof_map()
+{
+
+  // set all the global/local offset to invalid_uint
+  for(unsigned int n=0; n<_system.n_regions(); ++n)
+  {
+    SimulationRegion * region = _system.region(n);
+
+    SimulationRegion::local_node_iterator it = region->on_local_nodes_begin();
+    SimulationRegion::local_node_iterator it_end = region->on_local_nodes_end();
+    for(; it!=it_end; ++it)
+    {
+      FVM_Node * fvm_node = (*it);
+      fvm_node->set_local_offset(invalid_uint);
+      fvm_node->set_global_offset(invalid_uint);
+    }
+  }
+
+  // the local index of nodal dof, only on processor nodes are considered here,
+  // then we can make sure that each partition has a continuous block
+  unsigned int n_local_node_dofs = 0;
+  for(unsigned int n=0; n<_system.n_regions(); ++n)
+  {
+    SimulationRegion * region = _system.region(n);
+    const unsigned int region_node_dofs = this->node_dofs( region );
+
+    SimulationRegion::processor_node_iterator it = region->on_processor_nodes_begin();
+    SimulationRegion::processor_node_iterator it_end = region->on_processor_nodes_end();
+    for(; it!=it_end; ++it)
+    {
+      FVM_Node * fvm_node = (*it);
+      fvm_node->set_local_offset(n_local_node_dofs);
+      n_local_node_dofs += region_node_dofs;
+    }
+  }
+
+  // after the local index are set, we should know the block size on each processor,
+  // then the global offset of each local block is known.
+  std::vector<unsigned int> block_size;
+  block_size.push_back(n_local_node_dofs);
+  Parallel::allgather(block_size);
+  genius_assert( block_size.size() == Genius::n_processors() );
+
+  // the total node's dof number
+  n_global_node_dofs = std::accumulate(block_size.begin(), block_size.end(), 0 );
+
+  // the offset of local block at global dof array
+  global_offset = std::accumulate(block_size.begin(), block_size.begin()+Genius::processor_id(), 0 );
+
+  // the dofs of boundary condition and extra dofs, all the processors know these values
+  n_global_bc_dofs = 0;
+  if(_system.get_bcs()!=NULL)
+  {
+    for(unsigned int n=0; n<_system.get_bcs()->n_bcs(); ++n )
+      n_global_bc_dofs += this->bc_dofs( _system.get_bcs()->get_bc(n) );
+  }
+  unsigned int n_extra_dofs = this->extra_dofs();
+
+  n_global_dofs = n_global_node_dofs + n_global_bc_dofs + n_extra_dofs;
+
+  // bc dofs and extra dofs are located at the end of global dofs,
+  // as a result, only the last processor will hold them
+  n_local_dofs = n_local_node_dofs;
+  if( Genius::is_last_processor() )
+    n_local_dofs += n_global_bc_dofs + n_extra_dofs;
+
+
+  // set global offset of on processor nodes,
+  // and build the global and local index arrays for them
+  local_index_array.clear();
+  global_index_array.clear();
+  for(unsigned int n=0; n<_system.n_regions(); ++n)
+  {
+    SimulationRegion * region = _system.region(n);
+
+    SimulationRegion::processor_node_iterator it = region->on_processor_nodes_begin();
+    SimulationRegion::processor_node_iterator it_end = region->on_processor_nodes_end();
+    for(; it!=it_end; ++it)
+    {
+      FVM_Node * fvm_node = (*it);
+      fvm_node->set_global_offset(global_offset + fvm_node->local_offset());
+    }
+  }
+  for(unsigned int i=0; i<n_local_node_dofs; ++i )
+  {
+    local_index_array.push_back(i);
+    global_index_array.push_back(global_offset + i);
+  }
+
+
+  // the global offset of ghost nodes are known by their owner processor,
+  // each processor broadcasts the offset of its image nodes,
+  // then ghost nodes are appended at the end of local_index_array and global_index_array
+  for(unsigned int n=0; n<_system.n_regions(); ++n)
+  {
+    SimulationRegion * region = _system.region(n);
+    const unsigned int region_node_dofs = this->node_dofs( region );
+
+    std::map<unsigned int, unsigned int> image_offsets;
+    SimulationRegion::const_processor_node_iterator image_it = region->image_nodes_begin();
+    for(; image_it!=region->image_nodes_end(); ++image_it)
+    {
+      const FVM_Node * fvm_node = (*image_it);
+      image_offsets.insert( std::make_pair(fvm_node->root_node()->id(), fvm_node->global_offset()) );
+    }
+    Parallel::allgather(image_offsets);
+
+    SimulationRegion::const_local_node_iterator ghost_it = region->ghost_nodes_begin();
+    for(; ghost_it!=region->ghost_nodes_end(); ++ghost_it)
+    {
+      FVM_Node * fvm_node = (*ghost_it);
+      std::map<unsigned int, unsigned int>::const_iterator offset_it = image_offsets.find(fvm_node->root_node()->id());
+      genius_assert( offset_it != image_offsets.end() );
+
+      unsigned int local_offset = local_index_array.size();
+      unsigned int global_offset = offset_it->second;
+      fvm_node->set_local_offset(local_offset);
+      fvm_node->set_global_offset(global_offset);
+
+      for(unsigned int i=0; i<region_node_dofs; ++i)
+      {
+        local_index_array.push_back(local_offset + i);
+        global_index_array.push_back(global_offset + i);
+      }
+    }
+  }
+
+
+  // we compute the dofs of boundary condition here.
+  // these dofs will be added at the end of global_node_dofs
+  // the extra bc variable should in scatter list of all the processors,
+  // however, only the last processor owns the array
+  if(_system.get_bcs()!=NULL)
+  {
+    unsigned int bc_dofs_offset = 0;
+    for(unsigned int n=0; n<_system.get_bcs()->n_bcs(); ++n )
+    {
+      BoundaryCondition * bc = _system.get_bcs()->get_bc(n);
+      unsigned int bc_dofs = this->bc_dofs( bc );
+
+      if( bc_dofs >0 )
+      {
+        unsigned int local_offset = local_index_array.size();
+        bc->set_global_offset( n_global_node_dofs + bc_dofs_offset );
+        bc->set_local_offset ( local_offset );
+        if( Genius::is_last_processor() )
+          bc->set_array_offset ( n_local_node_dofs + bc_dofs_offset );
+        else
+          bc->set_array_offset ( invalid_uint );
+
+        for(unsigned int i=0; i<bc_dofs; ++i)
+        {
+          global_index_array.push_back (n_global_node_dofs + bc_dofs_offset + i);
+          local_index_array.push_back  (local_offset + i);
+        }
+
+        bc_dofs_offset +=  bc_dofs;
+      }
+      // no extra equation for this bc
+      else
+      {
+        bc->set_global_offset( invalid_uint );
+        bc->set_local_offset( invalid_uint );
+        bc->set_array_offset( invalid_uint );
+      }
+    }
+    genius_assert( bc_dofs_offset == n_global_bc_dofs );
+  }
+
+  // extra dofs are also in the scatter list of all the processors
+  for(unsigned int i=0; i<n_extra_dofs; ++i )
+  {
+    local_index_array.push_back(local_index_array.size());
+    global_index_array.push_back(n_global_dofs - n_extra_dofs + i);
+  }
+
+
+  // the same solver may have computed the nonzero pattern on this mesh before
+  if( restore_nonzero_pattern() ) return;
+
+  // only the boundary conditions changed? the rows of nodes not on the boundary are kept
+  const bool bulk_restored = restore_bulk_nonzero_pattern();
+
+  // compute the nonzero pattern of matrix
+  // search for all the regions...
+  n_nz.resize(n_local_dofs, 0);
+  n_oz.resize(n_local_dofs, 0);
+
+  // the max on/off processor bandwidth a row can have
+  const unsigned int max_on_processor_dofs  = n_local_dofs;
+  const unsigned int max_off_processor_dofs = n_global_dofs - n_local_dofs;
+
+  for(unsigned int n=0; n<_system.n_regions(); ++n)
+  {
+    const SimulationRegion * region = _system.region(n);
+
+    SimulationRegion::const_processor_node_iterator it = region->on_processor_nodes_begin();
+    SimulationRegion::const_processor_node_iterator it_end = region->on_processor_nodes_end();
+    for(; it!=it_end; ++it)
+    {
+      const FVM_Node * fvm_node = *it;
+
+      unsigned int local_offset = fvm_node->local_offset();
+      unsigned int local_node_dofs = this->node_dofs( region );
+      genius_assert(local_offset!=invalid_uint);
+
+      if( bulk_restored && fvm_node->boundary_id()==BoundaryInfo::invalid_id ) continue;
+
+      std::vector<std::pair<unsigned int, unsigned int> > v_region_nodes;
+      std::vector<std::pair<unsigned int, unsigned int> > v_off_region_nodes;
+      std::vector<std::pair<unsigned int, unsigned int> >::iterator itn;
+
+      // all the nodes involved, as well as the nodes not on this processor
+      fvm_node->PDE_node_pattern(v_region_nodes, v_off_region_nodes, this->all_neighbor_elements_involved(region));
+
+      unsigned int node_dofs=0;
+      for(itn=v_region_nodes.begin(); itn!=v_region_nodes.end(); ++itn)
+      {
+        const SimulationRegion * _region = _system.region((*itn).first);
+        node_dofs += (*itn).second*this->node_dofs( _region );
+      }
+
+      unsigned int off_processor_node_dofs=0;
+      for(itn=v_off_region_nodes.begin(); itn!=v_off_region_nodes.end(); ++itn)
+      {
+        const SimulationRegion * _region = _system.region((*itn).first);
+        off_processor_node_dofs += (*itn).second*this->node_dofs( _region );
+      }
+      genius_assert(node_dofs >= off_processor_node_dofs);
+
+      // set the nonzero pattern
+      for(unsigned int i=0; i<local_node_dofs; ++i)
+      {
+        n_nz[local_offset + i] = node_dofs-off_processor_node_dofs;
+        n_oz[local_offset + i] = off_processor_node_dofs;
+      }
+
+      // nonlocal band band tunneling couples the two end nodes of tunneling path, reserve for a few paths
+      if( region->get_advanced_model()->BandBandTunnelingNonlocal )
+        for(unsigned int i=0; i<local_node_dofs; ++i)
+        {
+          n_nz[local_offset + i] += 2*local_node_dofs;
+          n_oz[local_offset + i] += local_node_dofs;
+        }
+
+      // for boundary node, we need to consider extra dofs contributed by equ of boundary condition
+      if( fvm_node->boundary_id()!=BoundaryInfo::invalid_id )
+      {
+        unsigned int bc_index = _system.get_bcs()->get_bc_index_by_bd_id(fvm_node->boundary_id());
+        const BoundaryCondition * bc = _system.get_bcs()->get_bc(bc_index);
+        // the dof of this boundary condition
+        unsigned int bc_dofs = this->bc_dofs( bc );
+        // or this bc belongs to other bc_hub
+        if( bc->is_inter_connect_bc() )
+          bc_dofs += this->bc_dofs( bc->inter_connect_hub() );
+
+        // reserve for bc_dofs, which are owned by the last processor
+        for(unsigned int i=0; i<local_node_dofs; ++i)
+        {
+          if( Genius::is_last_processor() )
+            n_nz[local_offset + i] += bc_dofs;
+          else
+            n_oz[local_offset + i] += bc_dofs;
+        }
+      }
+
+      // prevent overflow, this may be happened for very small problems.
+      for(unsigned int i=0; i<local_node_dofs; ++i)
+      {
+        n_nz[local_offset + i] = std::min(n_nz[local_offset + i], static_cast<PetscInt>(max_on_processor_dofs));
+        n_oz[local_offset + i] = std::min(n_oz[local_offset + i], static_cast<PetscInt>(max_off_processor_dofs));
+      }
+    }
+  }
+
+
+  //  set n_nz and n_oz for boundary extra equation, only the last processor owns these rows
+  if(_system.get_bcs()!=NULL && Genius::is_last_processor())
+  {
+    for(unsigned int b=0; b<_system.get_bcs()->n_bcs(); ++b )
+    {
+      // get the boundary condition
+      const BoundaryCondition * bc = _system.get_bcs()->get_bc(b);
+      if( bc->array_offset() == invalid_uint ) continue;
+
+      // the dofs of this boundary condition
+      unsigned int bc_dofs = this->bc_dofs( bc );
+
+      // the bandwidth of this boundary condition
+      unsigned int bc_bandwidth = this->bc_bandwidth( bc );
+
+      // statistic neighbor information of boundary node
+      std::vector<unsigned int> neighbors;
+      // statistic dof information of boundary node
+      std::vector<unsigned int> node_dofs;
+
+      // get the nodes belongs to this boundary condition
+      // these nodes are sorted by their id,
+      // and should keep the same order for all processors.
+
+      std::vector<const Node *> bc_nodes;
+      if( !bc->is_inter_connect_hub() )
+      {
+        const std::vector<const Node *> & nodes = bc->nodes();
+        bc_nodes.insert( bc_nodes.end(),  nodes.begin(), nodes.end());
+        for(unsigned int n=0; n<bc_nodes.size(); ++n  )
+        {
+          neighbors.push_back( bc->n_node_neighbors(bc_nodes[n]) );
+          node_dofs.push_back(this->bc_node_dofs( bc ));
+        }
+      }
+      else
+      {
+        const std::vector<BoundaryCondition * > & inter_connect_bcs = bc->inter_connect();
+        for(unsigned int b=0; b<inter_connect_bcs.size(); ++b)
+        {
+          const BoundaryCondition * inter_connect_bc = inter_connect_bcs[b];
+          const std::vector<const Node *> & nodes = inter_connect_bc->nodes();
+          bc_nodes.insert( bc_nodes.end(),  nodes.begin(), nodes.end());
+          for(unsigned int n=0; n<nodes.size(); ++n  )
+          {
+            neighbors.push_back( inter_connect_bc->n_node_neighbors(nodes[n]) );
+            node_dofs.push_back(this->bc_node_dofs( inter_connect_bc ));
+          }
+        }
+      }
+
+
+      // statistic the on- and off- processor matrix bandwidth contributed by boundary node
+      // the neighbors of a boundary node are assumed to live on the same processor as the node
+      unsigned int on_processor_dofs = 0;
+      unsigned int off_processor_dofs = 0;
+      for(unsigned int n=0; n<bc_nodes.size(); ++n  )
+      {
+        if( bc_nodes[n]->processor_id() == Genius::processor_id() )
+          on_processor_dofs += (neighbors[n]+1)*node_dofs[n] ;
+        else
+          off_processor_dofs += (neighbors[n]+1)*node_dofs[n] ;
+      }
+
+      // prevent overflow, this may be happened for very small problems.
+      if ( on_processor_dofs + bc_bandwidth > max_on_processor_dofs )
+      { on_processor_dofs = max_on_processor_dofs - bc_bandwidth; }
+      if ( off_processor_dofs > max_off_processor_dofs )
+      { off_processor_dofs = max_off_processor_dofs; }
+
+      // assign to n_nz and n_oz
+      for(unsigned int i=0; i<bc_dofs; ++i)
+      {
+        //bc->array_offset() is the beginning offset of boundary dofs
+        n_nz[bc->array_offset() +i] = on_processor_dofs + bc_bandwidth;
+        n_oz[bc->array_offset() +i] = off_processor_dofs;
+      }
+    }
+  }
+
+  // coupling of periodic node pairs
+  set_periodic_nonzero_pattern();
+
+  // set n_nz and n_oz for extra dofs
+  if(this->extra_dofs())
+    this->set_extra_matrix_nonzero_pattern();
+
+  cache_nonzero_pattern();
+}
@@ -21,23 +21,333 @@
 
 
 
+#include <map>
+#include <typeinfo>
+
 #include "genius_common.h"
+#include "parallel.h"
+#include "mat_node_ordering.h"
+#include "boundary_condition_periodic.h"
+
+#include "spice_ckt.h"
+#include "fvm_parallel_dof_map.h"
+#include "fvm_serial_dof_map.h"
+
 
-#ifdef COGENDA_COMMERCIAL_PRODUCT
-  #include "fvm_parallel_dof_map.h"
-#else
-  #include "fvm_serial_dof_map.h"
-#endif
+/**
+ * the matrix nonzero pattern computed by a solver, together with the
+ * mesh revision and dof layout it was computed for
+ */
+struct NonzeroPatternCache
+{
+  unsigned int mesh_revision;
+  unsigned int n_global_dofs;
+  unsigned int n_global_node_dofs;
+  unsigned int n_global_bc_dofs;
+  unsigned int n_local_dofs;
+  unsigned int n_local_node_dofs;
+  std::vector<unsigned int> bc_key;
+  std::vector<PetscInt> n_nz;
+  std::vector<PetscInt> n_oz;
+};
+
+/**
+ * nonzero pattern cache for each solver class.
+ * POISSON/DDML1/DDML2... are created again and again in a typical deck,
+ * since PDE_node_pattern is not changed, the pattern can be reused.
+ * the key is the dynamic type name, since solvers such as LinearPoissonSolver
+ * and PoissonSolver report the same solver_type()
+ */
+static std::map<std::string, NonzeroPatternCache> _nonzero_pattern_cache;
+
+/**
+ * the fill-reducing ordering computed by a solver, the key is the same as nonzero pattern cache
+ */
+struct NodeOrderingCache
+{
+  unsigned int mesh_revision;
+  unsigned int n_global_dofs;
+  unsigned int n_global_bc_dofs;
+  std::vector<PetscInt> ordering;
+};
+
+static std::map<std::string, NodeOrderingCache> _node_ordering_cache;
 
 
 
 void FVM_PDESolver::build_dof_map()
 {
-#ifdef COGENDA_COMMERCIAL_PRODUCT
-    // for commercial version
+  // the parallel dof map also works for only one processor,
+  // however, the serial one is simpler and builds faster
+  if( Genius::n_processors() > 1 )
     set_parallel_dof_map();
-#else
-    // for open source version
+  else
     set_serial_dof_map();
-#endif
+}
+
+
+
+bool FVM_PDESolver::restore_nonzero_pattern()
+{
+  std::map<std::string, NonzeroPatternCache>::const_iterator it = _nonzero_pattern_cache.find(typeid(*this).name());
+
+  bool hit = SolverSpecify::CacheNonzeroPattern && it!=_nonzero_pattern_cache.end() &&
+             it->second.mesh_revision    == _system.mesh_revision() &&
+             it->second.n_global_dofs    == n_global_dofs &&
+             it->second.n_global_bc_dofs == n_global_bc_dofs &&
+             it->second.n_local_dofs     == n_local_dofs &&
+             it->second.bc_key           == bc_nonzero_pattern_key();
+
+  // all the processors should agree with it
+  Parallel::min(hit);
+  if(!hit) return false;
+
+  n_nz = it->second.n_nz;
+  n_oz = it->second.n_oz;
+
+  return true;
+}
+
+
+
+bool FVM_PDESolver::restore_bulk_nonzero_pattern()
+{
+  std::map<std::string, NonzeroPatternCache>::const_iterator it = _nonzero_pattern_cache.find(typeid(*this).name());
+
+  // only boundary conditions or circuit changed, the node dofs are the same
+  bool hit = SolverSpecify::CacheNonzeroPattern && it!=_nonzero_pattern_cache.end() &&
+             it->second.mesh_revision      == _system.mesh_revision() &&
+             it->second.n_global_node_dofs == n_global_node_dofs &&
+             it->second.n_local_node_dofs  == n_local_node_dofs();
+
+  // all the processors should agree with it
+  Parallel::min(hit);
+  if(!hit) return false;
+
+  // the max on/off processor bandwidth a row can have
+  const PetscInt max_on_processor_dofs  = n_local_dofs;
+  const PetscInt max_off_processor_dofs = n_global_dofs - n_local_dofs;
+
+  n_nz.assign(n_local_dofs, 0);
+  n_oz.assign(n_local_dofs, 0);
+  for(unsigned int i=0; i<n_local_node_dofs(); ++i)
+  {
+    n_nz[i] = std::min(it->second.n_nz[i], max_on_processor_dofs);
+    n_oz[i] = std::min(it->second.n_oz[i], max_off_processor_dofs);
+  }
+
+  return true;
+}
+
+
+
+void FVM_PDESolver::cache_nonzero_pattern() const
+{
+  if( !SolverSpecify::CacheNonzeroPattern ) return;
+
+  NonzeroPatternCache & cache = _nonzero_pattern_cache[typeid(*this).name()];
+  cache.mesh_revision      = _system.mesh_revision();
+  cache.n_global_dofs      = n_global_dofs;
+  cache.n_global_node_dofs = n_global_node_dofs;
+  cache.n_global_bc_dofs   = n_global_bc_dofs;
+  cache.n_local_dofs       = n_local_dofs;
+  cache.n_local_node_dofs  = n_local_node_dofs();
+  cache.bc_key             = bc_nonzero_pattern_key();
+  cache.n_nz               = n_nz;
+  cache.n_oz               = n_oz;
+}
+
+
+
+unsigned int FVM_PDESolver::n_local_node_dofs() const
+{
+  // bc and extra dofs are held by the last processor
+  if( Genius::is_last_processor() )
+    return n_local_dofs - n_global_bc_dofs - this->extra_dofs();
+  return n_local_dofs;
+}
+
+
+
+std::vector<unsigned int> FVM_PDESolver::bc_nonzero_pattern_key() const
+{
+  std::vector<unsigned int> key;
+  if( _system.get_bcs()==NULL ) return key;
+
+  for(unsigned int b=0; b<_system.get_bcs()->n_bcs(); ++b)
+  {
+    const BoundaryCondition * bc = _system.get_bcs()->get_bc(b);
+    key.push_back(static_cast<unsigned int>(bc->bc_type()));
+    key.push_back(this->bc_dofs(bc));
+    key.push_back(this->bc_node_dofs(bc));
+    key.push_back(this->bc_bandwidth(bc));
+    key.push_back(bc->is_inter_connect_bc() ? this->bc_dofs(bc->inter_connect_hub()) : 0);
+    key.push_back(bc->is_inter_connect_hub() ? bc->inter_connect().size() : 0);
+  }
+  key.push_back(this->extra_dofs());
+
+  // attached circuit
+  const SPICE_CKT * ckt = _system.get_circuit();
+  key.push_back(ckt ? 1 : 0);
+  key.push_back(ckt ? ckt->n_ckt_nodes() : 0);
+
+  return key;
+}
+
+
+
+void FVM_PDESolver::clear_solver_cache()
+{
+  _nonzero_pattern_cache.clear();
+  _node_ordering_cache.clear();
+}
+
+
+
+void FVM_PDESolver::set_periodic_nonzero_pattern()
+{
+  if( _system.get_bcs()==NULL ) return;
+
+  for(unsigned int b=0; b<_system.get_bcs()->n_bcs(); ++b)
+  {
+    PeriodicBC * bc = dynamic_cast<PeriodicBC *>(_system.get_bcs()->get_bc(b));
+    if( bc == NULL ) continue;
+
+    const std::vector<PeriodicBC::PeriodicPair> & pairs = bc->periodic_pairs();
+    for(unsigned int n=0; n<pairs.size(); ++n)
+    {
+      const FVM_Node * slave  = pairs[n].slave;
+      const FVM_Node * master = pairs[n].master;
+      const unsigned int dofs = this->node_dofs(pairs[n].region);
+
+      // master rows get the slave node and its neighbors, slave rows get the master node.
+      // the pair is always on this processor
+      const PetscInt slave_pattern = (slave->fvm_node_neighbors()+1)*dofs;
+      const PetscInt max_on_processor_dofs = n_local_dofs;
+      for(unsigned int i=0; i<dofs; ++i)
+      {
+        n_nz[master->local_offset()+i] = std::min(n_nz[master->local_offset()+i] + slave_pattern, max_on_processor_dofs);
+        n_nz[slave->local_offset()+i]  = std::min(n_nz[slave->local_offset()+i] + static_cast<PetscInt>(dofs), max_on_processor_dofs);
+      }
+    }
+  }
+}
+
+
+
+bool FVM_PDESolver::build_node_ordering()
+{
+  // the direct solver works on the whole matrix only with one processor
+  if( Genius::n_processors() > 1 ) return false;
+
+  std::map<std::string, NodeOrderingCache>::const_iterator it = _node_ordering_cache.find(typeid(*this).name());
+  if( it!=_node_ordering_cache.end() &&
+      it->second.mesh_revision    == _system.mesh_revision() &&
+      it->second.n_global_dofs    == n_global_dofs &&
+      it->second.n_global_bc_dofs == n_global_bc_dofs )
+  {
+    node_ordering = it->second.ordering;
+    return true;
+  }
+
+  // vertex of each node dof, -1 for not the first dof of a node
+  std::vector<int> dof_vertex(n_global_node_dofs, -1);
+  std::vector<const FVM_Node *> vertex_node;
+  for(unsigned int n=0; n<_system.n_regions(); ++n)
+  {
+    const SimulationRegion * region = _system.region(n);
+    if( this->node_dofs(region) == 0 ) continue;
+
+    SimulationRegion::const_processor_node_iterator node_it = region->on_processor_nodes_begin();
+    SimulationRegion::const_processor_node_iterator node_it_end = region->on_processor_nodes_end();
+    for(; node_it!=node_it_end; ++node_it)
+    {
+      dof_vertex[(*node_it)->local_offset()] = vertex_node.size();
+      vertex_node.push_back(*node_it);
+    }
+  }
+
+  // the node graph, a node couples to its neighbors and its ghost nodes in other regions.
+  // vertex weight is the dofs of the node, so the separators balance the dofs
+  std::vector<int> xadj, adjncy, vwgt;
+  xadj.reserve(vertex_node.size()+1);
+  vwgt.reserve(vertex_node.size());
+  adjncy.reserve(vertex_node.size()*8);
+  for(unsigned int v=0; v<vertex_node.size(); ++v)
+  {
+    const FVM_Node * fvm_node = vertex_node[v];
+    xadj.push_back(adjncy.size());
+    vwgt.push_back(this->node_dofs(_system.region(fvm_node->subdomain_id())));
+
+    FVM_Node::fvm_neighbor_node_iterator nb_it = fvm_node->neighbor_node_begin();
+    for(; nb_it!=fvm_node->neighbor_node_end(); ++nb_it)
+      adjncy.push_back(dof_vertex[(*nb_it).first->local_offset()]);
+
+    // only boundary node has ghost nodes
+    if( fvm_node->boundary_id()==BoundaryInfo::invalid_id ) continue;
+    FVM_Node::fvm_ghost_node_iterator gn_it = fvm_node->ghost_node_begin();
+    for(; gn_it!=fvm_node->ghost_node_end(); ++gn_it)
+    {
+      const FVM_Node * ghost_node = (*gn_it).first;
+      if( ghost_node==NULL || this->node_dofs(_system.region(ghost_node->subdomain_id())) == 0 ) continue;
+      adjncy.push_back(dof_vertex[ghost_node->local_offset()]);
+    }
+  }
+  xadj.push_back(adjncy.size());
+
+  std::vector<int> order;
+  if( !MatNodeOrdering::nested_dissection(xadj, adjncy, vwgt, order) ) return false;
+
+  // expand each node to its dof block
+  node_ordering.clear();
+  node_ordering.reserve(n_global_dofs);
+  for(unsigned int v=0; v<order.size(); ++v)
+  {
+    const FVM_Node * fvm_node = vertex_node[order[v]];
+    const unsigned int offset = fvm_node->local_offset();
+    const unsigned int dofs = this->node_dofs(_system.region(fvm_node->subdomain_id()));
+    for(unsigned int i=0; i<dofs; ++i)
+      node_ordering.push_back(offset + i);
+  }
+  // bc and extra dofs couple to many nodes, order them last
+  for(unsigned int i=n_global_node_dofs; i<n_global_dofs; ++i)
+    node_ordering.push_back(i);
+  genius_assert(node_ordering.size() == n_global_dofs);
+
+  NodeOrderingCache & cache = _node_ordering_cache[typeid(*this).name()];
+  cache.mesh_revision    = _system.mesh_revision();
+  cache.n_global_dofs    = n_global_dofs;
+  cache.n_global_bc_dofs = n_global_bc_dofs;
+  cache.ordering         = node_ordering;
+
+  return true;
+}
+
+
+
+void FVM_PDESolver::node_block_sizes(std::vector<PetscInt> &bsizes) const
+{
+  // size of the block starting at each local dof, 0 for the dof inside a block
+  std::vector<PetscInt> block_start(n_local_dofs, 1);
+  for(unsigned int n=0; n<_system.n_regions(); ++n)
+  {
+    const SimulationRegion * region = _system.region(n);
+    const unsigned int region_node_dofs = this->node_dofs(region);
+    if( region_node_dofs == 0 ) continue;
+
+    SimulationRegion::const_processor_node_iterator it = region->on_processor_nodes_begin();
+    SimulationRegion::const_processor_node_iterator it_end = region->on_processor_nodes_end();
+    for(; it!=it_end; ++it)
+    {
+      const unsigned int offset = (*it)->global_offset() - global_offset;
+      block_start[offset] = region_node_dofs;
+      for(unsigned int i=1; i<region_node_dofs; ++i)
+        block_start[offset+i] = 0;
+    }
+  }
+
+  bsizes.clear();
+  for(unsigned int i=0; i<n_local_dofs; ++i)
+    if( block_start[i] > 0 )
+      bsizes.push_back(block_start[i]);
 }
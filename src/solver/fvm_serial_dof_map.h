@@ -128,6 +128,12 @@ void FVM_PDESolver::set_serial_dof_map()
   }
 
 
+  // the same solver may have computed the nonzero pattern on this mesh before
+  if( restore_nonzero_pattern() ) return;
+
+  // only the boundary conditions changed? the rows of nodes not on the boundary are kept
+  const bool bulk_restored = restore_bulk_nonzero_pattern();
+
   // compute the nonzero pattern of matrix
   // search for all the regions...
   n_nz.resize(n_local_dofs, 0);
@@ -147,6 +153,8 @@ void FVM_PDESolver::set_serial_dof_map()
       unsigned int local_node_dofs = this->node_dofs( region );
       genius_assert(local_offset!=invalid_uint);
 
+      if( bulk_restored && fvm_node->boundary_id()==BoundaryInfo::invalid_id ) continue;
+
       std::vector<std::pair<unsigned int, unsigned int> > v_region_nodes;
       std::vector<std::pair<unsigned int, unsigned int> >::iterator itn;
       unsigned int node_dofs=0;
@@ -171,6 +179,11 @@ void FVM_PDESolver::set_serial_dof_map()
         n_nz[local_offset + i] = node_dofs-off_processor_node_dofs;
       }
 
+      // nonlocal band band tunneling couples the two end nodes of tunneling path, reserve for a few paths
+      if( region->get_advanced_model()->BandBandTunnelingNonlocal )
+        for(unsigned int i=0; i<local_node_dofs; ++i)
+          n_nz[local_offset + i] += 2*local_node_dofs;
+
       // not a boundary fvm_node? that's all
       if( fvm_node->boundary_id()==BoundaryInfo::invalid_id ) continue;
 
@@ -262,7 +275,12 @@ void FVM_PDESolver::set_serial_dof_map()
     }
   }
 
+  // coupling of periodic node pairs
+  set_periodic_nonzero_pattern();
+
   // set n_nz and n_oz for extra dofs
   if(this->extra_dofs())
     this->set_extra_matrix_nonzero_pattern();
+
+  cache_nonzero_pattern();
 }
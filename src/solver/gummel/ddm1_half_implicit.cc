@@ -0,0 +1,483 @@
+/********************************************************************************/
+/*     888888    888888888   88     888  88888   888      888    88888888       */
+/*   8       8   8           8 8     8     8      8        8    8               */
+/*  8            8           8  8    8     8      8        8    8               */
+/*  8            888888888   8   8   8     8      8        8     8888888        */
+/*  8      8888  8           8    8  8     8      8        8            8       */
+/*   8       8   8           8     8 8     8      8        8            8       */
+/*     888888    888888888  888     88   88888     88888888     88888888        */
+/*                                                                              */
+/*       A Three-Dimensional General Purpose Semiconductor Simulator.           */
+/*                                                                              */
+/*                                                                              */
+/*  Copyright (C) 2007-2008                                                     */
+/*  Cogenda Pte Ltd                                                             */
+/*                                                                              */
+/*  Please contact Cogenda Pte Ltd for license information                      */
+/*                                                                              */
+/*  Author: Gong Ding   gdiso@ustc.edu                                          */
+/*                                                                              */
+/********************************************************************************/
+
+
+#include "gummel/ddm1_half_implicit.h"
+#include "poisson/poisson.h"
+#include "semiconductor_region.h"
+#include "boundary_info.h"
+#include "electrical_source.h"
+#include "field_source.h"
+#include "solver_specify.h"
+#include "mathfunc.h"
+#include "parallel.h"
+
+using PhysicalUnit::kb;
+using PhysicalUnit::e;
+
+
+DDM1HalfImplicitSolver::DDM1HalfImplicitSolver(SimulationSystem & system)
+    :FVM_ExplicitSolver(system)
+{
+  // we need a nonlinear poisson solver
+  poisson_solver = new PoissonSolver(system);
+  poisson_solver->set_verbose(false);
+}
+
+
+
+DDM1HalfImplicitSolver::~DDM1HalfImplicitSolver()
+{
+  delete poisson_solver;
+  FVM_Node::set_solver_index(0);
+  BoundaryCondition::set_solver_index(0);
+}
+
+
+
+int DDM1HalfImplicitSolver::create_solver()
+{
+  MESSAGE<< '\n' << "Half Implicit Solver init..." << std::endl;
+  RECORD();
+
+  poisson_solver->create_solver();
+
+  // create explicit carrier context, use solver index 2
+  FVM_Node::set_solver_index(2);
+  BoundaryCondition::set_solver_index(2);
+  setup_explicit_data();
+  FVM_Node::set_solver_index(0);
+  BoundaryCondition::set_solver_index(0);
+
+  return FVM_ExplicitSolver::create_solver();
+}
+
+
+
+int DDM1HalfImplicitSolver::solve()
+{
+  START_LOG("solve()", "DDM1HalfImplicitSolver");
+
+  switch( SolverSpecify::Type )
+  {
+  case SolverSpecify::TRANSIENT:
+    solve_transient();
+    break;
+
+  default:
+    MESSAGE<< '\n' << "DDM1HalfImplicitSolver: Unsupported solve type, only transient is supported.";
+    RECORD();
+    break;
+  }
+
+  STOP_LOG("solve()", "DDM1HalfImplicitSolver");
+
+  return 0;
+}
+
+
+
+int DDM1HalfImplicitSolver::destroy_solver()
+{
+  poisson_solver->destroy_solver();
+
+  FVM_Node::set_solver_index(2);
+  BoundaryCondition::set_solver_index(2);
+  clear_explicit_data();
+  FVM_Node::set_solver_index(0);
+  BoundaryCondition::set_solver_index(0);
+
+  return FVM_ExplicitSolver::destroy_solver();
+}
+
+
+
+/*------------------------------------------------------------------
+ * fill solution vector with carrier density and vol vector with volume
+ */
+int DDM1HalfImplicitSolver::pre_solve_process ( bool load_solution )
+{
+  if(load_solution)
+  {
+    FVM_Node::set_solver_index(2);
+    for(unsigned int n=0; n<_system.n_regions(); n++)
+    {
+      const SimulationRegion * region = _system.region(n);
+      if( region->type() != SemiconductorRegion ) continue;
+
+      SimulationRegion::const_processor_node_iterator node_it = region->on_processor_nodes_begin();
+      SimulationRegion::const_processor_node_iterator node_it_end = region->on_processor_nodes_end();
+      for(; node_it!=node_it_end; ++node_it)
+      {
+        const FVM_Node * fvm_node = *node_it;
+        const FVM_NodeData * node_data = fvm_node->node_data();
+
+        PetscInt    ix[2] = {fvm_node->global_offset(), fvm_node->global_offset()+1};
+        PetscScalar y[2]  = {node_data->n(), node_data->p()};
+        PetscScalar v[2]  = {fvm_node->volume(), fvm_node->volume()};
+        VecSetValues(x, 2, ix, y, INSERT_VALUES);
+        VecSetValues(vol, 2, ix, v, INSERT_VALUES);
+      }
+    }
+    FVM_Node::set_solver_index(0);
+
+    VecAssemblyBegin(x);
+    VecAssemblyBegin(vol);
+    VecAssemblyEnd(x);
+    VecAssemblyEnd(vol);
+  }
+
+  return FVM_ExplicitSolver::pre_solve_process();
+}
+
+
+
+void DDM1HalfImplicitSolver::solve_transient()
+{
+  // time dependent
+  SolverSpecify::TimeDependent = true;
+
+  // we have a previous dc solution
+  if(!SolverSpecify::tran_histroy)
+  {
+    _system.get_electrical_source()->update ( SolverSpecify::TStart );
+    for(unsigned int b=0; b<_system.get_bcs()->n_bcs(); b++)
+    {
+      BoundaryCondition * bc = _system.get_bcs()->get_bc(b);
+      if(bc && bc->is_electrode())
+        bc->ext_circuit()->tran_op_init();
+    }
+  }
+
+  MESSAGE<<"Half implicit transient compute from "<<SolverSpecify::TStart
+  <<" ps step "<<SolverSpecify::TStep
+  <<" ps to "  <<SolverSpecify::TStop<<" ps"
+  <<'\n';
+  RECORD();
+
+  SolverSpecify::clock = SolverSpecify::TStart;
+  SolverSpecify::T_Cycles = 0;
+
+  this->pre_solve_process();
+
+  // the terminal error of the clock
+  const PetscScalar t_eps = 1e-10*SolverSpecify::TStep;
+
+  while( SolverSpecify::clock < SolverSpecify::TStop - t_eps )
+  {
+    const PetscScalar t_prev   = SolverSpecify::clock;
+    const PetscScalar t_target = std::min(SolverSpecify::clock + SolverSpecify::TStep, SolverSpecify::TStop);
+
+    // advance with CFL limited sub-steps until the output time
+    unsigned int sub_steps = 0;
+    PetscScalar  dt_min = t_target - t_prev;
+    while( SolverSpecify::clock < t_target - t_eps )
+    {
+      PetscScalar dt = time_advance(t_target - SolverSpecify::clock);
+      if( SolverSpecify::clock < t_target - t_eps )
+        dt_min = std::min(dt_min, dt);
+      sub_steps++;
+    }
+
+    SolverSpecify::dt = SolverSpecify::clock - t_prev;
+
+    MESSAGE
+    <<"t = "<<SolverSpecify::clock<<" ps"<<'\n'
+    <<"--------------------------------------------------------------------------------\n"
+    <<"      "<<sub_steps<<" explicit sub-step(s), min CFL time step "<<dt_min<<" ps\n\n\n";
+    RECORD();
+
+    // call post_solve_process
+    this->post_solve_process();
+
+    SolverSpecify::T_Cycles++;
+    SolverSpecify::dt_last_last = SolverSpecify::dt_last;
+    SolverSpecify::dt_last = SolverSpecify::dt;
+  }
+
+  SolverSpecify::tran_histroy = true;
+}
+
+
+
+PetscScalar DDM1HalfImplicitSolver::time_advance(PetscScalar dt_max)
+{
+  FVM_Node::set_solver_index(2);
+  BoundaryCondition::set_solver_index(2);
+
+  build_flux();
+
+  PetscInt rstart, rend;
+  VecGetOwnershipRange(x, &rstart, &rend);
+
+  PetscScalar *xx, *ff, *tt, *vv;
+  VecGetArray(x, &xx);
+  VecGetArray(f, &ff);
+  VecGetArray(t, &tt);
+  VecGetArray(vol, &vv);
+
+  // CFL limit of explicit flux: dt*sum(outflow coefficient) < volume
+  PetscScalar dt_cfl = 1e100;
+  for(PetscInt i=0; i<rend-rstart; ++i)
+    if( tt[i] > 0.0 )
+      dt_cfl = std::min(dt_cfl, vv[i]/tt[i]);
+  Parallel::min(dt_cfl);
+
+  const PetscScalar dt = std::min(SolverSpecify::HalfImplicitCFL*dt_cfl, dt_max);
+
+  // node update with implicit (linearized) recombination
+  for(unsigned int n=0; n<_system.n_regions(); n++)
+  {
+    const SimulationRegion * region = _system.region(n);
+    if( region->type() != SemiconductorRegion ) continue;
+
+    const SemiconductorSimulationRegion * semi_region = dynamic_cast<const SemiconductorSimulationRegion *>(region);
+    Material::MaterialSemiconductor * mt = semi_region->material();
+    const PetscScalar T = region->T_external();
+
+    SimulationRegion::const_processor_node_iterator node_it = region->on_processor_nodes_begin();
+    SimulationRegion::const_processor_node_iterator node_it_end = region->on_processor_nodes_end();
+    for(; node_it!=node_it_end; ++node_it)
+    {
+      const FVM_Node * fvm_node = *node_it;
+      const FVM_NodeData * node_data = fvm_node->node_data();
+      const PetscInt i = fvm_node->global_offset() - rstart;
+      const PetscScalar volume = fvm_node->volume();
+
+      mt->mapping(fvm_node->root_node(), node_data, SolverSpecify::clock);
+
+      const PetscScalar nn = xx[i];
+      const PetscScalar pp = xx[i+1];
+
+      const PetscScalar R = mt->band->Recomb(pp, nn, T);
+      const PetscScalar dRdn = std::max(0.0, (mt->band->Recomb(pp, nn*(1+1e-6), T) - R)/(1e-6*nn));
+      const PetscScalar dRdp = std::max(0.0, (mt->band->Recomb(pp*(1+1e-6), nn, T) - R)/(1e-6*pp));
+
+      // injection term EIn/HIn is already integrated over the control volume
+      const PetscScalar Gn = node_data->Field_G() + node_data->EIn()/volume;
+      const PetscScalar Gp = node_data->Field_G() + node_data->HIn()/volume;
+
+      // c^{n+1} = c^n + dt*(flux/vol + G - R(c^n) - dR/dc*(c^{n+1}-c^n))
+      PetscScalar n_new = (nn + dt*(ff[i]/volume   + Gn - R + dRdn*nn))/(1.0 + dt*dRdn);
+      PetscScalar p_new = (pp + dt*(ff[i+1]/volume + Gp - R + dRdp*pp))/(1.0 + dt*dRdp);
+
+      // carrier density should always be positive
+      xx[i]   = std::max(n_new, 1e-6*nn);
+      xx[i+1] = std::max(p_new, 1e-6*pp);
+    }
+  }
+
+  contact_boundary(xx, ff, rstart);
+
+  VecRestoreArray(x, &xx);
+  VecRestoreArray(f, &ff);
+  VecRestoreArray(t, &tt);
+  VecRestoreArray(vol, &vv);
+
+  update_solution();
+
+  FVM_Node::set_solver_index(0);
+  BoundaryCondition::set_solver_index(0);
+
+  // update sources to the new clock
+  SolverSpecify::clock += dt;
+  _system.get_electrical_source()->update ( SolverSpecify::clock );
+  _system.get_field_source()->update ( SolverSpecify::clock, SolverSpecify::SourceCoupled );
+
+  // implicit poisson's equation, carriers follow the potential with frozen quasi-Fermi potential
+  poisson_solver->solve();
+
+  // poisson's equation modified carrier density, write it back to solution vector
+  this->pre_solve_process();
+
+  return dt;
+}
+
+
+
+void DDM1HalfImplicitSolver::build_flux()
+{
+  VecZeroEntries(f);
+  VecZeroEntries(t);
+
+  for(unsigned int r=0; r<_system.n_regions(); ++r)
+  {
+    const SimulationRegion * region = _system.region(r);
+    if( region->type() != SemiconductorRegion ) continue;
+
+    const SemiconductorSimulationRegion * semi_region = dynamic_cast<const SemiconductorSimulationRegion *>(region);
+    Material::MaterialSemiconductor * mt = semi_region->material();
+
+    const PetscScalar T  = region->T_external();
+    const PetscScalar Vt = kb*T/e;
+
+    std::vector<PetscInt>    ix;
+    std::vector<PetscScalar> flux, coeff;
+
+    SimulationRegion::const_edge_iterator it = region->edges_begin();
+    SimulationRegion::const_edge_iterator it_end = region->edges_end();
+    for(; it!=it_end; ++it)
+    {
+      const FVM_Node * fvm_n1 = (*it).first;
+      const FVM_Node * fvm_n2 = (*it).second;
+      const unsigned int edge_index = it - region->edges_begin();
+
+      const FVM_NodeData * n1_data =  fvm_n1->node_data();
+      const FVM_NodeData * n2_data =  fvm_n2->node_data();
+
+      const PetscScalar length = region->edge_length(edge_index);
+      const PetscScalar area   = region->edge_cv_surface_area(edge_index);
+
+      mt->mapping(fvm_n1->root_node(), n1_data, SolverSpecify::clock);
+      const PetscScalar mun1 = mt->mob->ElecMob(n1_data->p(), n1_data->n(), T, 0, 0, T);
+      const PetscScalar mup1 = mt->mob->HoleMob(n1_data->p(), n1_data->n(), T, 0, 0, T);
+      mt->mapping(fvm_n2->root_node(), n2_data, SolverSpecify::clock);
+      const PetscScalar mun2 = mt->mob->ElecMob(n2_data->p(), n2_data->n(), T, 0, 0, T);
+      const PetscScalar mup2 = mt->mob->HoleMob(n2_data->p(), n2_data->n(), T, 0, 0, T);
+      const PetscScalar mun = 0.5*(mun1+mun2);
+      const PetscScalar mup = 0.5*(mup1+mup2);
+
+      const PetscScalar dVc = (n2_data->Ec()-n1_data->Ec())/e;
+      const PetscScalar dVv = (n2_data->Ev()-n1_data->Ev())/e;
+
+      // particle flux into node 1 is a1*c1 + a2*c2, a1 < 0 and a2 > 0
+      const PetscScalar an1 = -mun*Vt*bern( dVc/Vt)/length*area;
+      const PetscScalar an2 =  mun*Vt*bern(-dVc/Vt)/length*area;
+      const PetscScalar ap1 = -mup*Vt*bern(-dVv/Vt)/length*area;
+      const PetscScalar ap2 =  mup*Vt*bern( dVv/Vt)/length*area;
+
+      const PetscScalar Fn = an1*n1_data->n() + an2*n2_data->n();
+      const PetscScalar Fp = ap1*n1_data->p() + ap2*n2_data->p();
+
+      if( fvm_n1->on_processor() )
+      {
+        ix.push_back(fvm_n1->global_offset());   flux.push_back( Fn); coeff.push_back(-an1);
+        ix.push_back(fvm_n1->global_offset()+1); flux.push_back( Fp); coeff.push_back(-ap1);
+      }
+
+      if( fvm_n2->on_processor() )
+      {
+        ix.push_back(fvm_n2->global_offset());   flux.push_back(-Fn); coeff.push_back(an2);
+        ix.push_back(fvm_n2->global_offset()+1); flux.push_back(-Fp); coeff.push_back(ap2);
+      }
+    }
+
+    if( !ix.empty() )
+    {
+      VecSetValues(f, ix.size(), &ix[0], &flux[0], ADD_VALUES);
+      VecSetValues(t, ix.size(), &ix[0], &coeff[0], ADD_VALUES);
+    }
+  }
+
+  VecAssemblyBegin(f);
+  VecAssemblyBegin(t);
+  VecAssemblyEnd(f);
+  VecAssemblyEnd(t);
+}
+
+
+
+void DDM1HalfImplicitSolver::contact_boundary(PetscScalar *xx, const PetscScalar *ff, PetscInt rstart)
+{
+  for(unsigned int n=0; n<_system.get_bcs()->n_bcs(); ++n)
+  {
+    BoundaryCondition * bc = _system.get_bcs()->get_bc(n);
+    if( bc->bc_type() != OhmicContact && bc->bc_type() != SchottkyContact ) continue;
+
+    // the current flow into this electrode, see OhmicContactBC::DDM1_Function_Preprocess
+    PetscScalar current = 0.0;
+
+    BoundaryCondition::const_node_iterator node_it = bc->nodes_begin();
+    BoundaryCondition::const_node_iterator end_it = bc->nodes_end();
+    for(; node_it!=end_it; ++node_it )
+    {
+      // skip node not belongs to this processor
+      if( (*node_it)->processor_id()!=Genius::processor_id() ) continue;
+
+      BoundaryCondition::const_region_node_iterator  rnode_it     = bc->region_node_begin(*node_it);
+      BoundaryCondition::const_region_node_iterator  end_rnode_it = bc->region_node_end(*node_it);
+      for(; rnode_it!=end_rnode_it; ++rnode_it  )
+      {
+        const SimulationRegion * region = (*rnode_it).second.first;
+        if( region->type() != SemiconductorRegion ) continue;
+
+        const FVM_Node * fvm_node = (*rnode_it).second.second;
+        const FVM_NodeData * node_data = fvm_node->node_data();
+        const PetscInt i = fvm_node->global_offset() - rstart;
+
+        current += ff[i] - ff[i+1];
+
+        if( bc->bc_type() == OhmicContact )
+        {
+          // equilibrium carrier density
+          const SemiconductorSimulationRegion * semi_region = dynamic_cast<const SemiconductorSimulationRegion *>(region);
+          semi_region->material()->mapping(fvm_node->root_node(), node_data, SolverSpecify::clock);
+          const PetscScalar ni = semi_region->material()->band->ni(region->T_external());
+          const PetscScalar N  = node_data->Net_doping();
+          const PetscScalar majority = std::abs(N)/2 + sqrt(N*N/4 + ni*ni);
+          const PetscScalar minority = ni*ni/majority;
+          xx[i]   = N > 0 ? majority : minority;
+          xx[i+1] = N > 0 ? minority : majority;
+        }
+        else
+        {
+          // schottky contact, keep the carrier density
+          xx[i]   = node_data->n();
+          xx[i+1] = node_data->p();
+        }
+      }
+    }
+
+    Parallel::sum(current);
+    bc->ext_circuit()->current() = bc->z_width()*current;
+  }
+}
+
+
+
+void DDM1HalfImplicitSolver::update_solution()
+{
+  // scatte global solution vector x to local vector lx
+  VecScatterBegin(scatter, x, lx, INSERT_VALUES, SCATTER_FORWARD);
+  VecScatterEnd  (scatter, x, lx, INSERT_VALUES, SCATTER_FORWARD);
+
+  PetscScalar *lxx;
+  VecGetArray(lx, &lxx);
+
+  for(unsigned int n=0; n<_system.n_regions(); n++)
+  {
+    SimulationRegion * region = _system.region(n);
+    if( region->type() != SemiconductorRegion )  continue;
+
+    SimulationRegion::local_node_iterator it = region->on_local_nodes_begin();
+    SimulationRegion::local_node_iterator it_end = region->on_local_nodes_end();
+    for(; it!=it_end; ++it)
+    {
+      FVM_Node * fvm_node = (*it);
+      FVM_NodeData * node_data = fvm_node->node_data(); genius_assert(node_data);
+
+      node_data->n() = lxx[fvm_node->local_offset()];
+      node_data->p() = lxx[fvm_node->local_offset()+1];
+    }
+  }
+
+  VecRestoreArray(lx, &lxx);
+}
@@ -0,0 +1,172 @@
+/********************************************************************************/
+/*     888888    888888888   88     888  88888   888      888    88888888       */
+/*   8       8   8           8 8     8     8      8        8    8               */
+/*  8            8           8  8    8     8      8        8    8               */
+/*  8            888888888   8   8   8     8      8        8     8888888        */
+/*  8      8888  8           8    8  8     8      8        8            8       */
+/*   8       8   8           8     8 8     8      8        8            8       */
+/*     888888    888888888  888     88   88888     88888888     88888888        */
+/*                                                                              */
+/*       A Three-Dimensional General Purpose Semiconductor Simulator.           */
+/*                                                                              */
+/*                                                                              */
+/*  Copyright (C) 2007-2008                                                     */
+/*  Cogenda Pte Ltd                                                             */
+/*                                                                              */
+/*  Please contact Cogenda Pte Ltd for license information                      */
+/*                                                                              */
+/*  Author: Gong Ding   gdiso@ustc.edu                                          */
+/*                                                                              */
+/********************************************************************************/
+
+
+#include "gummel/gummel.h"
+#include "gummel/gummel_carrier.h"
+#include "poisson/poisson.h"
+#include "electrical_source.h"
+#include "parallel.h"
+
+
+
+/*------------------------------------------------------------------
+ * gummel iteration use its own sub-solvers, the coupled newton solver is created when required
+ */
+int GummelSolver::create_solver()
+{
+  MESSAGE<< '\n' << "Gummel Solver init..." << std::endl;
+  RECORD();
+
+  if( !SolverSpecify::GummelNewton )
+    return SolverBase::create_solver();
+
+  return 0;
+}
+
+
+
+/*------------------------------------------------------------------
+ * do gummel iteration and hand off the solution to DDML1 newton solver
+ */
+int GummelSolver::solve()
+{
+  START_LOG("solve()", "GummelSolver");
+
+  // equilibrium state is already well handled by the coupled solver
+  if( SolverSpecify::Type != SolverSpecify::EQUILIBRIUM )
+  {
+    // set electrode with transient time 0 value of stimulate source(s)
+    _system.get_electrical_source()->update ( 0 );
+    gummel_iteration();
+  }
+
+  if( SolverSpecify::GummelNewton )
+  {
+    MESSAGE<< "Hand off to DDML1 newton solver." << std::endl;
+    RECORD();
+
+    DDM1Solver::create_solver();
+    _newton_created = true;
+    DDM1Solver::solve();
+  }
+
+  STOP_LOG("solve()", "GummelSolver");
+
+  return 0;
+}
+
+
+
+bool GummelSolver::gummel_iteration()
+{
+  PoissonSolver poisson(_system);
+  poisson.create_solver();
+
+  GummelCarrierSolver carrier(_system);
+  carrier.create_solver();
+
+  bool converged = false;
+
+  for(unsigned int it=0; it<SolverSpecify::GummelMaxIteration; ++it)
+  {
+    // save the potential of last iteration
+    std::vector<PetscScalar> psi_old;
+    for(unsigned int n=0; n<_system.n_regions(); ++n)
+    {
+      const SimulationRegion * region = _system.region(n);
+      SimulationRegion::const_processor_node_iterator node_it = region->on_processor_nodes_begin();
+      SimulationRegion::const_processor_node_iterator node_it_end = region->on_processor_nodes_end();
+      for(; node_it!=node_it_end; ++node_it)
+        psi_old.push_back((*node_it)->node_data()->psi());
+    }
+
+    // nonlinear poisson with frozen quasi-Fermi potential
+    set_solver_index(0);
+    poisson.solve();
+
+    // linear continuity equations with frozen potential
+    carrier.set_carrier(GummelCarrierSolver::ELECTRON_CARRIER);
+    carrier.solve();
+    carrier.set_carrier(GummelCarrierSolver::HOLE_CARRIER);
+    carrier.solve();
+
+    // max potential update
+    PetscScalar dV_max = 0.0;
+    unsigned int i=0;
+    for(unsigned int n=0; n<_system.n_regions(); ++n)
+    {
+      const SimulationRegion * region = _system.region(n);
+      SimulationRegion::const_processor_node_iterator node_it = region->on_processor_nodes_begin();
+      SimulationRegion::const_processor_node_iterator node_it_end = region->on_processor_nodes_end();
+      for(; node_it!=node_it_end; ++node_it)
+        dV_max = std::max(dV_max, std::abs((*node_it)->node_data()->psi() - psi_old[i++]));
+    }
+    Parallel::max( dV_max );
+
+    MESSAGE<<"Gummel iteration "<< it <<", max potential update "<< dV_max/PhysicalUnit::V << " V" << std::endl;
+    RECORD();
+
+    if( dV_max < SolverSpecify::GummelPotentialToler )
+    {
+      converged = true;
+      break;
+    }
+  }
+
+  carrier.destroy_solver();
+  poisson.destroy_solver();
+  set_solver_index(0);
+
+  if( !converged )
+  {
+    MESSAGE<<"Warning: Gummel iteration not converged in "<< SolverSpecify::GummelMaxIteration << " steps." << std::endl;
+    RECORD();
+  }
+
+  return converged;
+}
+
+
+
+/*------------------------------------------------------------------
+ * destroy the coupled solver if it has been created
+ */
+int GummelSolver::destroy_solver()
+{
+  if( _newton_created )
+  {
+    _newton_created = false;
+    return DDM1Solver::destroy_solver();
+  }
+
+  return SolverBase::destroy_solver();
+}
+
+
+
+void GummelSolver::memory_usage(std::map<std::string, size_t> & usage) const
+{
+  if( _newton_created )
+    DDM1Solver::memory_usage(usage);
+  else
+    SolverBase::memory_usage(usage);
+}
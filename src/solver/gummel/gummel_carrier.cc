@@ -0,0 +1,306 @@
+/********************************************************************************/
+/*     888888    888888888   88     888  88888   888      888    88888888       */
+/*   8       8   8           8 8     8     8      8        8    8               */
+/*  8            8           8  8    8     8      8        8    8               */
+/*  8            888888888   8   8   8     8      8        8     8888888        */
+/*  8      8888  8           8    8  8     8      8        8            8       */
+/*   8       8   8           8     8 8     8      8        8            8       */
+/*     888888    888888888  888     88   88888     88888888     88888888        */
+/*                                                                              */
+/*       A Three-Dimensional General Purpose Semiconductor Simulator.           */
+/*                                                                              */
+/*                                                                              */
+/*  Copyright (C) 2007-2008                                                     */
+/*  Cogenda Pte Ltd                                                             */
+/*                                                                              */
+/*  Please contact Cogenda Pte Ltd for license information                      */
+/*                                                                              */
+/*  Author: Gong Ding   gdiso@ustc.edu                                          */
+/*                                                                              */
+/********************************************************************************/
+
+#include "gummel/gummel_carrier.h"
+#include "semiconductor_region.h"
+#include "boundary_info.h"
+#include "solver_specify.h"
+#include "mathfunc.h"
+#include "petsc_utils.h"
+#include "parallel.h"
+
+using PhysicalUnit::kb;
+using PhysicalUnit::e;
+
+
+
+/*------------------------------------------------------------------
+ * create the linear solver contex, gummel carrier solver use solver index 2
+ */
+int GummelCarrierSolver::create_solver()
+{
+  set_solver_index(2);
+
+  set_linear_solver_type    ( SolverSpecify::LS );
+  set_preconditioner_type   ( SolverSpecify::PC );
+
+  // must setup linear contex here!
+  setup_linear_data();
+
+  // rtol   = SolverSpecify::ksp_rtol  - the relative convergence tolerance (relative decrease in the residual norm)
+  // abstol = 1e-30                    - the absolute convergence tolerance (absolute size of the residual norm)
+  KSPSetTolerances(ksp, SolverSpecify::ksp_rtol, 1e-30, PETSC_DEFAULT, std::max(50, std::min(1000, static_cast<int>(n_global_dofs/10))) );
+
+  // user can do further adjusment from command line
+  KSPSetFromOptions (ksp);
+
+  set_solver_index(0);
+
+  return 0;
+}
+
+
+
+/*------------------------------------------------------------------
+ * solve the continuity equation with frozen potential
+ */
+int GummelCarrierSolver::solve()
+{
+  START_LOG("solve()", "GummelCarrierSolver");
+
+  set_solver_index(2);
+
+  build_system(A, b);
+
+  KSPSetOperators(ksp, A, A, SAME_NONZERO_PATTERN);
+  KSPSolve(ksp, b, x);
+
+  update_solution();
+
+  set_solver_index(0);
+
+  STOP_LOG("solve()", "GummelCarrierSolver");
+
+  return 0;
+}
+
+
+
+/*------------------------------------------------------------------
+ * destroy the solver
+ */
+int GummelCarrierSolver::destroy_solver()
+{
+  set_solver_index(2);
+
+  // clear linear contex
+  clear_linear_data();
+
+  set_solver_index(0);
+
+  return 0;
+}
+
+
+
+/*------------------------------------------------------------------
+ * the equation is  div(J) - R = 0 with S-G discretization,
+ * we assemble its negative form to get a matrix with positive diagonal
+ */
+void GummelCarrierSolver::build_system(Mat A, Vec b)
+{
+  MatZeroEntries(A);
+  VecZeroEntries(b);
+
+  const bool electron = (_carrier == ELECTRON_CARRIER);
+
+  for(unsigned int r=0; r<_system.n_regions(); ++r)
+  {
+    const SimulationRegion * region = _system.region(r);
+    if( region->type() != SemiconductorRegion ) continue;
+
+    const SemiconductorSimulationRegion * semi_region = dynamic_cast<const SemiconductorSimulationRegion *>(region);
+    Material::MaterialSemiconductor * mt = semi_region->material();
+
+    const PetscScalar T  = region->T_external();
+    const PetscScalar Vt = kb*T/e;
+
+    // S-G flux of each edge
+    SimulationRegion::const_edge_iterator it = region->edges_begin();
+    SimulationRegion::const_edge_iterator it_end = region->edges_end();
+    for(; it!=it_end; ++it)
+    {
+      const FVM_Node * fvm_n1 = (*it).first;
+      const FVM_Node * fvm_n2 = (*it).second;
+      const unsigned int edge_index = it - region->edges_begin();
+
+      const FVM_NodeData * n1_data =  fvm_n1->node_data();
+      const FVM_NodeData * n2_data =  fvm_n2->node_data();
+
+      const PetscScalar length = region->edge_length(edge_index);
+      const PetscScalar area   = region->edge_cv_surface_area(edge_index);
+
+      // low field mobility from current solution, the coupled solver takes the full mobility model
+      mt->mapping(fvm_n1->root_node(), n1_data, SolverSpecify::clock);
+      const PetscScalar mu1 = electron ? mt->mob->ElecMob(n1_data->p(), n1_data->n(), T, 0, 0, T) :
+                                         mt->mob->HoleMob(n1_data->p(), n1_data->n(), T, 0, 0, T);
+      mt->mapping(fvm_n2->root_node(), n2_data, SolverSpecify::clock);
+      const PetscScalar mu2 = electron ? mt->mob->ElecMob(n2_data->p(), n2_data->n(), T, 0, 0, T) :
+                                         mt->mob->HoleMob(n2_data->p(), n2_data->n(), T, 0, 0, T);
+      const PetscScalar mu = 0.5*(mu1+mu2);
+
+      // band edge difference along the edge
+      const PetscScalar dV = electron ? (n2_data->Ec()-n1_data->Ec())/e : (n2_data->Ev()-n1_data->Ev())/e;
+
+      // flux into node 1 is a1*c1 + a2*c2
+      PetscScalar a1, a2;
+      if( electron )
+      {
+        a1 = -mu*Vt*bern( dV/Vt)/length*area;
+        a2 =  mu*Vt*bern(-dV/Vt)/length*area;
+      }
+      else
+      {
+        a1 = -mu*Vt*bern(-dV/Vt)/length*area;
+        a2 =  mu*Vt*bern( dV/Vt)/length*area;
+      }
+
+      PetscInt col[2];
+      col[0] = fvm_n1->global_offset();
+      col[1] = fvm_n2->global_offset();
+
+      if( fvm_n1->on_processor() )
+      {
+        PetscScalar y[2] = {-a1, -a2};
+        MatSetValues(A, 1, &col[0], 2, col, y, ADD_VALUES);
+      }
+
+      if( fvm_n2->on_processor() )
+      {
+        PetscScalar y[2] = {a1, a2};
+        MatSetValues(A, 1, &col[1], 2, col, y, ADD_VALUES);
+      }
+    }
+
+    // recombination, linearized around current solution
+    SimulationRegion::const_processor_node_iterator node_it = region->on_processor_nodes_begin();
+    SimulationRegion::const_processor_node_iterator node_it_end = region->on_processor_nodes_end();
+    for(; node_it!=node_it_end; ++node_it)
+    {
+      const FVM_Node * fvm_node = *node_it;
+      const FVM_NodeData * node_data = fvm_node->node_data();
+
+      mt->mapping(fvm_node->root_node(), node_data, SolverSpecify::clock);
+
+      const PetscScalar n = node_data->n();
+      const PetscScalar p = node_data->p();
+      const PetscScalar c = electron ? n : p;
+
+      const PetscScalar R  = mt->band->Recomb(p, n, T);
+      const PetscScalar dc = 1e-6*c;
+      const PetscScalar R_dc = electron ? mt->band->Recomb(p, n+dc, T) : mt->band->Recomb(p+dc, n, T);
+      // keep diagonal dominance
+      const PetscScalar dRdc = std::max(0.0, (R_dc-R)/dc);
+
+      // injection term EIn/HIn is already integrated over the control volume
+      const PetscScalar G = node_data->Field_G()*fvm_node->volume() + (electron ? node_data->EIn() : node_data->HIn());
+
+      MatSetValue(A, fvm_node->global_offset(), fvm_node->global_offset(), dRdc*fvm_node->volume(), ADD_VALUES);
+      VecSetValue(b, fvm_node->global_offset(), G + (dRdc*c - R)*fvm_node->volume(), ADD_VALUES);
+    }
+  }
+
+  MatAssemblyBegin(A, MAT_FINAL_ASSEMBLY);
+  MatAssemblyEnd(A, MAT_FINAL_ASSEMBLY);
+  VecAssemblyBegin(b);
+  VecAssemblyEnd(b);
+
+  // ohmic and schottky contacts are dirichlet boundary of carrier
+  std::vector<PetscInt>    rows;
+  std::vector<PetscScalar> values;
+  for(unsigned int n=0; n<_system.get_bcs()->n_bcs(); ++n)
+  {
+    const BoundaryCondition * bc = _system.get_bcs()->get_bc(n);
+    if( bc->bc_type() != OhmicContact && bc->bc_type() != SchottkyContact ) continue;
+
+    BoundaryCondition::const_node_iterator node_it = bc->nodes_begin();
+    BoundaryCondition::const_node_iterator end_it = bc->nodes_end();
+    for(; node_it!=end_it; ++node_it )
+    {
+      // skip node not belongs to this processor
+      if( (*node_it)->processor_id()!=Genius::processor_id() ) continue;
+
+      BoundaryCondition::const_region_node_iterator  rnode_it     = bc->region_node_begin(*node_it);
+      BoundaryCondition::const_region_node_iterator  end_rnode_it = bc->region_node_end(*node_it);
+      for(; rnode_it!=end_rnode_it; ++rnode_it  )
+      {
+        const SimulationRegion * region = (*rnode_it).second.first;
+        if( region->type() != SemiconductorRegion ) continue;
+
+        const FVM_Node * fvm_node = (*rnode_it).second.second;
+        const FVM_NodeData * node_data = fvm_node->node_data();
+
+        PetscScalar c = electron ? node_data->n() : node_data->p();
+        if( bc->bc_type() == OhmicContact )
+        {
+          // equilibrium carrier density
+          const SemiconductorSimulationRegion * semi_region = dynamic_cast<const SemiconductorSimulationRegion *>(region);
+          semi_region->material()->mapping(fvm_node->root_node(), node_data, SolverSpecify::clock);
+          const PetscScalar ni = semi_region->material()->band->ni(region->T_external());
+          const PetscScalar N  = node_data->Net_doping();
+          const PetscScalar majority = std::abs(N)/2 + sqrt(N*N/4 + ni*ni);
+          const PetscScalar minority = ni*ni/majority;
+          if( electron ) c = N > 0 ? majority : minority;
+          else           c = N > 0 ? minority : majority;
+        }
+
+        rows.push_back(fvm_node->global_offset());
+        values.push_back(c);
+      }
+    }
+  }
+
+  //note! PetscUtils::MatZeroRows should be excuted on all the processor
+  PetscUtils::MatZeroRows(A, rows.size(), rows.empty() ? NULL : &rows[0], 1.0);
+
+  if( !rows.empty() )
+    VecSetValues(b, rows.size(), &rows[0], &values[0], INSERT_VALUES);
+  VecAssemblyBegin(b);
+  VecAssemblyEnd(b);
+}
+
+
+
+/*------------------------------------------------------------------
+ * write carrier density back to node data
+ */
+void GummelCarrierSolver::update_solution()
+{
+  // scatte global solution vector x to local vector lx
+  VecScatterBegin ( scatter, x, lx, INSERT_VALUES, SCATTER_FORWARD );
+  VecScatterEnd ( scatter, x, lx, INSERT_VALUES, SCATTER_FORWARD );
+
+  PetscScalar *lxx;
+  VecGetArray ( lx, &lxx );
+
+  for(unsigned int r=0; r<_system.n_regions(); ++r)
+  {
+    SimulationRegion * region = _system.region(r);
+    if( region->type() != SemiconductorRegion ) continue;
+
+    SimulationRegion::local_node_iterator node_it = region->on_local_nodes_begin();
+    SimulationRegion::local_node_iterator node_it_end = region->on_local_nodes_end();
+    for(; node_it!=node_it_end; ++node_it)
+    {
+      FVM_Node * fvm_node = *node_it;
+      FVM_NodeData * node_data = fvm_node->node_data();
+
+      // carrier density should always be positive
+      const PetscScalar c = std::max(lxx[fvm_node->local_offset()], 1e-6*std::abs(_carrier == ELECTRON_CARRIER ? node_data->n() : node_data->p()));
+      if( _carrier == ELECTRON_CARRIER )
+        node_data->n() = c;
+      else
+        node_data->p() = c;
+    }
+  }
+
+  VecRestoreArray ( lx, &lxx );
+}
@@ -24,6 +24,7 @@
 #include "hall/hall.h"
 #include "parallel.h"
 #include "petsc_utils.h"
+#include "electrical_source.h"
 
 
 using PhysicalUnit::kb;
@@ -106,6 +107,9 @@ int HallSolver::solve()
       case SolverSpecify::TRACE:
       solve_iv_trace();break;
 
+      case SolverSpecify::BSWEEP:
+      solve_bsweep();break;
+
       default: genius_error();
   }
 
@@ -117,6 +121,158 @@ int HallSolver::solve()
 
 
 
+/*------------------------------------------------------------------
+ * sweep the magnetic field at fixed bias. the tangent predictor gives the initial guess
+ * of next B point by one back-substitution. with b.perturb, the jacobian factored at the
+ * first point is kept for the whole sweep, the other points are solved by chord Newton
+ * iterations, which only evaluate the residual and do back-substitution.
+ */
+int HallSolver::solve_bsweep()
+{
+  // set electrode with transient time 0 value of stimulate source(s)
+  _system.get_electrical_source()->update ( 0 );
+
+  // reuse the factored jacobian for several Newton iterations
+  set_jacobian_lag(SolverSpecify::NSLagJacobian);
+
+  // not time dependent
+  SolverSpecify::TimeDependent = false;
+  SolverSpecify::dt = 1e100;
+  SolverSpecify::clock = 0.0;
+
+  const PetscScalar T = PhysicalUnit::V/(PhysicalUnit::m*PhysicalUnit::m)*PhysicalUnit::s;
+  const char direction = "xyz"[SolverSpecify::BDirection];
+
+  MESSAGE
+  <<"Magnetic field scan from " <<SolverSpecify::BStart/T
+  <<" step "                    <<SolverSpecify::BStep/T
+  <<" to "                      <<SolverSpecify::BStop/T
+  << (SolverSpecify::BPerturb ? ", reuse jacobian of the first point" : "")
+  <<'\n';
+  RECORD();
+
+  VectorValue<double> B = _system.get_magnetic_field();
+
+  // the current B and B step
+  PetscScalar Bscan = SolverSpecify::BStart;
+  PetscScalar BStep = SolverSpecify::BStep;
+
+  // last converged solution
+  Vec xs1;
+  PetscScalar Bs1 = Bscan;
+  VecDuplicate ( x, &xs1 );
+
+  // jacobian is frozen
+  bool chord = false;
+  unsigned int n_retry = 0;
+
+  for ( SolverSpecify::DC_Cycles=0;  (Bscan*SolverSpecify::BStep) <= SolverSpecify::BStop*SolverSpecify::BStep* ( 1.0+1e-7 ); )
+  {
+    MESSAGE << "B Scan: B" << direction << " = " << Bscan/T << " T" << '\n'
+    <<"--------------------------------------------------------------------------------\n";
+    RECORD();
+
+    B(SolverSpecify::BDirection) = Bscan;
+    _system.set_magnetic_field(B);
+
+    // call pre_solve_process
+    if ( SolverSpecify::DC_Cycles == 0 )
+      this->pre_solve_process();
+    else
+      this->pre_solve_process ( false );
+
+    sens_solve();
+
+    SNESConvergedReason reason;
+    SNESGetConvergedReason ( snes,&reason );
+
+    if ( reason>0 ) //ok, converged.
+    {
+      this->post_solve_process();
+
+      SolverSpecify::DC_Cycles++;
+      n_retry = 0;
+
+      Bs1 = Bscan;
+      VecCopy ( x, xs1 );
+
+      // freeze the jacobian (and its factorization) of this point for the rest of the sweep
+      if ( SolverSpecify::BPerturb && !chord )
+      {
+        SNESSetLagJacobian ( snes, -1 );
+        chord = true;
+      }
+
+      // recover the step reduced by failures
+      if ( fabs ( BStep ) < fabs ( SolverSpecify::BStep ) )
+        BStep = std::min ( 2*fabs ( BStep ), fabs ( SolverSpecify::BStep ) ) * ( SolverSpecify::BStep > 0 ? 1 : -1 );
+
+      Bscan += BStep;
+
+      // for last step, we force B equal to BStop
+      if ( (Bscan*SolverSpecify::BStep) > SolverSpecify::BStop*SolverSpecify::BStep &&
+           (Bscan*SolverSpecify::BStep) < ( SolverSpecify::BStop + BStep - 1e-10*BStep ) *SolverSpecify::BStep
+         )
+        Bscan = SolverSpecify::BStop;
+
+      MESSAGE
+      <<"--------------------------------------------------------------------------------\n"
+      <<"      "<<SNESConvergedReasons[reason]<<"\n\n\n";
+      RECORD();
+    }
+    else // diverged
+    {
+      MESSAGE <<"------> nonlinear solver "<<SNESConvergedReasons[reason];
+
+      if ( SolverSpecify::DC_Cycles == 0 )
+      {
+        MESSAGE <<". Failed in the first step.\n\n\n";
+        RECORD();
+        break;
+      }
+
+      if ( chord )
+      {
+        // the frozen jacobian is too far from this B, rebuild it and freeze again after convergence
+        MESSAGE <<", rebuild jacobian...\n\n\n"; RECORD();
+        set_jacobian_lag(SolverSpecify::NSLagJacobian);
+        chord = false;
+      }
+      else
+      {
+        if ( ++n_retry > 8 )
+        {
+          MESSAGE <<". Too many failed steps, give up tring.\n\n\n";
+          RECORD();
+          break;
+        }
+        MESSAGE <<", do recovery...\n\n\n"; RECORD();
+        BStep /= 2.0;
+        Bscan = Bs1 + BStep;
+      }
+
+      // load previous result into solution vector
+      this->diverged_recovery();
+    }
+
+    // first order predictor with sensitivity dx/dB
+    if ( SolverSpecify::Predict && reason>0 &&
+         (Bscan*SolverSpecify::BStep) <= SolverSpecify::BStop*SolverSpecify::BStep* ( 1.0+1e-7 ) )
+    {
+      B(SolverSpecify::BDirection) = Bscan;
+      _system.set_magnetic_field(B);
+      this->tangent_predict ( xs1 );
+    }
+  }
+
+  VecDestroy ( PetscDestroyObject(xs1) );
+
+  return 0;
+}
+
+
+
+
 /*------------------------------------------------------------------
  * restore the solution to each region
  */
@@ -157,6 +313,9 @@ int HallSolver::post_solve_process()
  */
 int HallSolver::diverged_recovery()
 {
+  // rejected transient step, x_n is the last accepted solution
+  if( restore_from_history() ) return 0;
+
   // for all the regions
   for(unsigned int n=0; n<_system.n_regions(); n++)
   {
@@ -678,14 +837,18 @@ void HallSolver::error_norm()
 
   // sum of variable value on all processors
   parallel_only();
-  Parallel::sum(potential_norm);
-  Parallel::sum(electron_norm);
-  Parallel::sum(hole_norm);
-
-  Parallel::sum(poisson_norm);
-  Parallel::sum(elec_continuity_norm);
-  Parallel::sum(hole_continuity_norm);
-  Parallel::sum(electrode_norm);
+  {
+    Parallel::SumBatch<PetscScalar> batch;
+    batch.add(potential_norm);
+    batch.add(electron_norm);
+    batch.add(hole_norm);
+
+    batch.add(poisson_norm);
+    batch.add(elec_continuity_norm);
+    batch.add(hole_continuity_norm);
+    batch.add(electrode_norm);
+    batch.reduce();
+  }
 
   // sqrt to get L2 norm
   potential_norm = sqrt(potential_norm);
@@ -741,6 +904,7 @@ void HallSolver::build_petsc_sens_residual(Vec x, Vec r)
   // evaluate governing equations of DDML1 in all the regions
   for(unsigned int n=0; n<_system.n_regions(); n++)
   {
+    if( region_frozen(n) ) continue;
     SimulationRegion * region = _system.region(n);
     region->HALL_Function(B, lxx, r, add_value_flag);
   }
@@ -836,6 +1000,7 @@ void HallSolver::build_petsc_sens_jacobian(Vec x, Mat *, Mat *)
   // evaluate Jacobian matrix of governing equations of DDML1 in all the regions
   for(unsigned int n=0; n<_system.n_regions(); n++)
   {
+    if( region_frozen(n) ) continue;
     SimulationRegion * region = _system.region(n);
     region->HALL_Jacobian(B, lxx, &J, add_value_flag);
   }
@@ -894,10 +1059,8 @@ void HallSolver::build_petsc_sens_jacobian(Vec x, Mat *, Mat *)
     BoundaryCondition * bc = _system.get_bcs()->get_bc(b);
     bc->DDM1_Jacobian_Preprocess(lxx, &J, src_row, dst_row, clear_row);
   }
-  //add source rows to destination rows
-  PetscUtils::MatAddRowToRow(J, src_row, dst_row);
-  // clear row
-  PetscUtils::MatZeroRows(J, clear_row.size(), clear_row.empty() ? NULL : &clear_row[0], 0.0);
+  //add source rows to destination rows, and clear rows
+  PetscUtils::MatAddClearRow(J, src_row, dst_row, clear_row);
 
   add_value_flag = NOT_SET_VALUES;
   for(unsigned int b=0; b<_system.get_bcs()->n_bcs(); b++)
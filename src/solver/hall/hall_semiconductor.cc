@@ -137,6 +137,19 @@ void SemiconductorSimulationRegion::HALL_Function(const VectorValue<double> & B,
   // first, search all the element in this region and process "cell" related terms
   // note, they are all local element, thus must be processed
 
+  std::vector<PetscScalar> psi_vertex;
+  std::vector<PetscScalar> phin_vertex;
+  std::vector<PetscScalar> phip_vertex;
+  std::vector<PetscScalar> mun_edge;
+  std::vector<PetscScalar> mup_edge;
+  std::vector<PetscScalar> Jp_edge;
+  std::vector<PetscScalar> Jn_edge;
+  std::vector<PetscScalar> Vp_edge;
+  std::vector<PetscScalar> Vn_edge;
+  std::vector<unsigned int> sides;
+  std::vector<SimulationRegion *> regions;
+  std::vector<PetscScalar> psi_vertex_neighbor;
+
   const_element_iterator it = elements_begin();
   const_element_iterator it_end = elements_end();
 
@@ -154,16 +167,16 @@ void SemiconductorSimulationRegion::HALL_Function(const VectorValue<double> & B,
     // build the gradient of psi and fermi potential in this cell.
     // which are the vector of electric field and current density.
 
-    std::vector<PetscScalar> psi_vertex;
-    std::vector<PetscScalar> phin_vertex;
-    std::vector<PetscScalar> phip_vertex;
+    psi_vertex.clear();
+    phin_vertex.clear();
+    phip_vertex.clear();
 
-    std::vector<PetscScalar> mun_edge; //store all the edge mun
-    std::vector<PetscScalar> mup_edge; //store all the edge mup
-    std::vector<PetscScalar> Jp_edge; //store all the edge Jp
-    std::vector<PetscScalar> Jn_edge; //store all the edge Jn
-    std::vector<PetscScalar> Vp_edge; //store all the edge Vp=Jp/p
-    std::vector<PetscScalar> Vn_edge; //store all the edge Vn=Jn/n
+    mun_edge.clear(); //store all the edge mun
+    mup_edge.clear(); //store all the edge mup
+    Jp_edge.clear(); //store all the edge Jp
+    Jn_edge.clear(); //store all the edge Jn
+    Vp_edge.clear(); //store all the edge Vp=Jp/p
+    Vn_edge.clear(); //store all the edge Vn=Jn/n
 
     // E field parallel to current flow
     PetscScalar Epn=0;
@@ -221,8 +234,8 @@ void SemiconductorSimulationRegion::HALL_Function(const VectorValue<double> & B,
       if(get_advanced_model()->ESurface && insulator_interface_elem)
       {
         // get all the sides on insulator interface
-        std::vector<unsigned int> sides;
-        std::vector<SimulationRegion *> regions;
+        sides.clear();
+        regions.clear();
         elem_on_insulator_interface(elem, sides, regions);
 
         VectorValue<PetscScalar> E_insul(0,0,0);
@@ -232,7 +245,7 @@ void SemiconductorSimulationRegion::HALL_Function(const VectorValue<double> & B,
         for(unsigned int ne=0; ne<sides.size(); ++ne)
         {
           const Elem * elem_neighbor = elem->neighbor(sides[ne]);
-          std::vector<PetscScalar> psi_vertex_neighbor;
+          psi_vertex_neighbor.clear();
           for(unsigned int nd=0; nd<elem_neighbor->n_nodes(); ++nd)
           {
             const FVM_Node * fvm_node_neighbor = elem_neighbor->get_fvm_node(nd);
@@ -304,17 +317,15 @@ void SemiconductorSimulationRegion::HALL_Function(const VectorValue<double> & B,
     // search for all the edges this cell own
     for(unsigned int ne=0; ne<elem->n_edges(); ++ne )
     {
-      AutoPtr<Elem> edge = elem->build_edge (ne);
-      genius_assert(edge->type()==EDGE2);
-
-      std::vector<unsigned int > edge_nodes;
+      std::pair<unsigned int, unsigned int> edge_nodes;
       elem->nodes_on_edge(ne, edge_nodes);
+      const Point edge_vector = elem->point(edge_nodes.second) - elem->point(edge_nodes.first);
 
-      double length = edge->volume();                           // the length of this edge
-      VectorValue<double> dir = (edge->point(1) - edge->point(0)).unit(); // unit direction of the edge
+      double length = edge_vector.size();        // the length of this edge
+      VectorValue<double> dir = edge_vector.unit(); // unit direction of the edge
 
-      const FVM_Node * fvm_n1 = elem->get_fvm_node(edge_nodes[0]);   assert(fvm_n1);  // fvm_node of node1
-      const FVM_Node * fvm_n2 = elem->get_fvm_node(edge_nodes[1]);   assert(fvm_n2);  // fvm_node of node2
+      const FVM_Node * fvm_n1 = elem->get_fvm_node(edge_nodes.first);   assert(fvm_n1);  // fvm_node of node1
+      const FVM_Node * fvm_n2 = elem->get_fvm_node(edge_nodes.second);   assert(fvm_n2);  // fvm_node of node2
 
       const FVM_NodeData * n1_data = fvm_n1->node_data();  assert(n1_data);            // fvm_node_data of node1
       const FVM_NodeData * n2_data = fvm_n2->node_data();  assert(n2_data);            // fvm_node_data of node2
@@ -327,7 +338,7 @@ void SemiconductorSimulationRegion::HALL_Function(const VectorValue<double> & B,
       {
         // use truncated partial area to avoid negative area due to bad mesh elem
         truncated_partial_area =  this->truncated_partial_area(elem, ne);
-        truncated_partial_volume =  elem->partial_volume_with_edge_truncated(ne);
+        truncated_partial_volume =  this->truncated_partial_volume(elem, ne);
       }
 
       unsigned int n1_local_offset = fvm_n1->local_offset();
@@ -517,7 +528,7 @@ void SemiconductorSimulationRegion::HALL_Function(const VectorValue<double> & B,
           Jnv.add_scaled(VectorValue<PetscScalar>(0, 1e-20, 0), 1.0);
           Jpv.add_scaled(VectorValue<PetscScalar>(0, 1e-20, 0), 1.0);
 
-          VectorValue<PetscScalar> ev = (elem->point(edge_nodes[1]) - elem->point(edge_nodes[0]));
+          VectorValue<PetscScalar> ev = (elem->point(edge_nodes.second) - elem->point(edge_nodes.first));
           PetscScalar riin1 = 0.5 + 0.5* (ev.unit()).dot(Jnv.unit());
           PetscScalar riin2 = 1.0 - riin1;
           PetscScalar riip2 = 0.5 + 0.5* (ev.unit()).dot(Jpv.unit());
@@ -600,10 +611,12 @@ void SemiconductorSimulationRegion::HALL_Function(const VectorValue<double> & B,
 
     for(unsigned int ne=0; ne<elem->n_edges(); ++ne )
     {
-      AutoPtr<Elem> edge = elem->build_edge (ne);
-      VectorValue<double> dir = (edge->point(1) - edge->point(0)).unit(); // unit direction of the edge
+      std::pair<unsigned int, unsigned int> edge_nodes;
+      elem->nodes_on_edge(ne, edge_nodes);
+      const Point edge_vector = elem->point(edge_nodes.second) - elem->point(edge_nodes.first);
+      VectorValue<double> dir = edge_vector.unit(); // unit direction of the edge
 
-      double length = edge->volume();
+      double length = edge_vector.size();
       double partial_area = elem->partial_area_with_edge(ne);  // partial area associated with this edge
       double truncated_partial_area =  partial_area;
       if(truncation)
@@ -611,11 +624,8 @@ void SemiconductorSimulationRegion::HALL_Function(const VectorValue<double> & B,
         truncated_partial_area =  this->truncated_partial_area(elem, ne);
       }
 
-      std::vector<unsigned int > edge_nodes;
-      elem->nodes_on_edge(ne, edge_nodes);
-
-      FVM_Node * fvm_n1 = elem->get_fvm_node(edge_nodes[0]);   // fvm_node of node1
-      FVM_Node * fvm_n2 = elem->get_fvm_node(edge_nodes[1]);   // fvm_node of node2
+      FVM_Node * fvm_n1 = elem->get_fvm_node(edge_nodes.first);   // fvm_node of node1
+      FVM_Node * fvm_n2 = elem->get_fvm_node(edge_nodes.second);   // fvm_node of node2
 
       FVM_NodeData * n1_data = fvm_n1->node_data();  assert(n1_data);            // fvm_node_data of node1
       FVM_NodeData * n2_data = fvm_n2->node_data();  assert(n2_data);            // fvm_node_data of node2
@@ -755,6 +765,17 @@ void SemiconductorSimulationRegion::HALL_Jacobian(const VectorValue<double> & B,
   // search all the element in this region.
   // note, they are all local element, thus must be processed
 
+  std::vector<AutoDScalar> psi_vertex;
+  std::vector<AutoDScalar> phin_vertex;
+  std::vector<AutoDScalar> phip_vertex;
+  std::vector<AutoDScalar> mun_edge;
+  std::vector<AutoDScalar> mup_edge;
+  std::vector<AutoDScalar> Vp_edge;
+  std::vector<AutoDScalar> Vn_edge;
+  std::vector<unsigned int> sides;
+  std::vector<SimulationRegion *> regions;
+  std::vector<AutoDScalar> psi_vertex_neighbor;
+
   const_element_iterator it = elements_begin();
   const_element_iterator it_end = elements_end();
   for(; it!=it_end; ++it)
@@ -786,14 +807,14 @@ void SemiconductorSimulationRegion::HALL_Jacobian(const VectorValue<double> & B,
     // which are the vector of electric field and current density.
     // here use type AutoDScalar, we should make sure the order of independent variable keeps the
     // same all the time
-    std::vector<AutoDScalar> psi_vertex;
-    std::vector<AutoDScalar> phin_vertex;
-    std::vector<AutoDScalar> phip_vertex;
+    psi_vertex.clear();
+    phin_vertex.clear();
+    phip_vertex.clear();
 
-    std::vector<AutoDScalar> mun_edge; //store all the edge mun
-    std::vector<AutoDScalar> mup_edge; //store all the edge mup
-    std::vector<AutoDScalar> Vp_edge; //store all the edge Jp/p
-    std::vector<AutoDScalar> Vn_edge; //store all the edge Jn/n
+    mun_edge.clear(); //store all the edge mun
+    mup_edge.clear(); //store all the edge mup
+    Vp_edge.clear(); //store all the edge Jp/p
+    Vn_edge.clear(); //store all the edge Jn/n
 
     // E field parallel to current flow
     AutoDScalar Epn=0;
@@ -851,8 +872,8 @@ void SemiconductorSimulationRegion::HALL_Jacobian(const VectorValue<double> & B,
       if(get_advanced_model()->ESurface && insulator_interface_elem)
       {
         // get all the sides on insulator interface
-        std::vector<unsigned int> sides;
-        std::vector<SimulationRegion *> regions;
+        sides.clear();
+        regions.clear();
         elem_on_insulator_interface(elem, sides, regions);
 
         VectorValue<AutoDScalar> E_insul(0.0,0.0,0.0);
@@ -865,7 +886,7 @@ void SemiconductorSimulationRegion::HALL_Jacobian(const VectorValue<double> & B,
         {
           const Elem * elem_neighbor = elem->neighbor(sides[ne]);
 
-          std::vector<AutoDScalar> psi_vertex_neighbor;
+          psi_vertex_neighbor.clear();
           for(unsigned int nd=0; nd<elem_neighbor->n_nodes(); ++nd)
           {
             const FVM_Node * fvm_node_neighbor = elem_neighbor->get_fvm_node(nd);
@@ -952,20 +973,18 @@ void SemiconductorSimulationRegion::HALL_Jacobian(const VectorValue<double> & B,
     // search for all the Edge this cell own
     for(unsigned int ne=0; ne<elem->n_edges(); ++ne )
     {
-      AutoPtr<Elem> edge = elem->build_edge (ne);
-      genius_assert(edge->type()==EDGE2);
-
-      std::vector<unsigned int > edge_nodes;
+      std::pair<unsigned int, unsigned int> edge_nodes;
       elem->nodes_on_edge(ne, edge_nodes);
+      const Point edge_vector = elem->point(edge_nodes.second) - elem->point(edge_nodes.first);
 
       // the length of this edge
-      double length = edge->volume();
-      VectorValue<double> dir = (edge->point(1) - edge->point(0)).unit(); // unit direction of the edge
+      double length = edge_vector.size();
+      VectorValue<double> dir = edge_vector.unit(); // unit direction of the edge
 
       // fvm_node of node1
-      const FVM_Node * fvm_n1 = elem->get_fvm_node(edge_nodes[0]);
+      const FVM_Node * fvm_n1 = elem->get_fvm_node(edge_nodes.first);
       // fvm_node of node2
-      const FVM_Node * fvm_n2 = elem->get_fvm_node(edge_nodes[1]);
+      const FVM_Node * fvm_n2 = elem->get_fvm_node(edge_nodes.second);
 
       // fvm_node_data of node1
       const FVM_NodeData * n1_data =  fvm_n1->node_data() ;
@@ -980,7 +999,7 @@ void SemiconductorSimulationRegion::HALL_Jacobian(const VectorValue<double> & B,
       if(truncation)
       {
         truncated_partial_area =  this->truncated_partial_area(elem, ne);
-        truncated_partial_volume =  elem->partial_volume_with_edge_truncated(ne);
+        truncated_partial_volume =  this->truncated_partial_volume(elem, ne);
       }
 
       unsigned int n1_local_offset = fvm_n1->local_offset();
@@ -997,9 +1016,9 @@ void SemiconductorSimulationRegion::HALL_Jacobian(const VectorValue<double> & B,
         //for node 1 of the edge
         mt->mapping(fvm_n1->root_node(), n1_data, SolverSpecify::clock);
 
-        AutoDScalar V1   =  x[n1_local_offset+0];       V1.setADValue(3*edge_nodes[0]+0, 1.0);           // electrostatic potential
-        AutoDScalar n1   =  x[n1_local_offset+1];       n1.setADValue(3*edge_nodes[0]+1, 1.0);           // electron density
-        AutoDScalar p1   =  x[n1_local_offset+2];       p1.setADValue(3*edge_nodes[0]+2, 1.0);           // hole density
+        AutoDScalar V1   =  x[n1_local_offset+0];       V1.setADValue(3*edge_nodes.first+0, 1.0);           // electrostatic potential
+        AutoDScalar n1   =  x[n1_local_offset+1];       n1.setADValue(3*edge_nodes.first+1, 1.0);           // electron density
+        AutoDScalar p1   =  x[n1_local_offset+2];       p1.setADValue(3*edge_nodes.first+2, 1.0);           // hole density
 
         AutoDScalar Ec1 =  -(e*V1 + n1_data->affinity() + kb*T*log(mt->band->nie(p1, n1, T)) );
         AutoDScalar Ev1 =  -(e*V1 + n1_data->affinity() - kb*T*log(mt->band->nie(p1, n1, T)) );
@@ -1015,9 +1034,9 @@ void SemiconductorSimulationRegion::HALL_Jacobian(const VectorValue<double> & B,
         //for node 2 of the edge
         mt->mapping(fvm_n2->root_node(), n2_data, SolverSpecify::clock);
 
-        AutoDScalar V2   =  x[n2_local_offset+0];       V2.setADValue(3*edge_nodes[1]+0, 1.0);             // electrostatic potential
-        AutoDScalar n2   =  x[n2_local_offset+1];       n2.setADValue(3*edge_nodes[1]+1, 1.0);             // electron density
-        AutoDScalar p2   =  x[n2_local_offset+2];       p2.setADValue(3*edge_nodes[1]+2, 1.0);             // hole density
+        AutoDScalar V2   =  x[n2_local_offset+0];       V2.setADValue(3*edge_nodes.second+0, 1.0);             // electrostatic potential
+        AutoDScalar n2   =  x[n2_local_offset+1];       n2.setADValue(3*edge_nodes.second+1, 1.0);             // electron density
+        AutoDScalar p2   =  x[n2_local_offset+2];       p2.setADValue(3*edge_nodes.second+2, 1.0);             // hole density
 
         AutoDScalar Ec2 =  -(e*V2 + n2_data->affinity() + kb*T*log(mt->band->nie(p2, n2, T)) );
         AutoDScalar Ev2 =  -(e*V2 + n2_data->affinity() - kb*T*log(mt->band->nie(p2, n2, T)) );
@@ -1157,7 +1176,7 @@ void SemiconductorSimulationRegion::HALL_Jacobian(const VectorValue<double> & B,
           Jnv.add_scaled(VectorValue<AutoDScalar>(0, 1e-20, 0), 1.0);
           Jpv.add_scaled(VectorValue<AutoDScalar>(0, 1e-20, 0), 1.0);
 
-          VectorValue<PetscScalar> ev0 = (elem->point(edge_nodes[1]) - elem->point(edge_nodes[0]));
+          VectorValue<PetscScalar> ev0 = (elem->point(edge_nodes.second) - elem->point(edge_nodes.first));
           VectorValue<AutoDScalar> ev;
           ev(0)=ev0(0); ev(1)=ev0(1); ev(2)=ev0(2);
           AutoDScalar riin1 = 0.5 + 0.5* (ev.unit()).dot(Jnv.unit());
@@ -1238,10 +1257,12 @@ void SemiconductorSimulationRegion::HALL_Jacobian(const VectorValue<double> & B,
 
     for(unsigned int ne=0; ne<elem->n_edges(); ++ne )
     {
-      AutoPtr<Elem> edge = elem->build_edge (ne);
-      VectorValue<double> dir = (edge->point(1) - edge->point(0)).unit(); // unit direction of the edge
+      std::pair<unsigned int, unsigned int> edge_nodes;
+      elem->nodes_on_edge(ne, edge_nodes);
+      const Point edge_vector = elem->point(edge_nodes.second) - elem->point(edge_nodes.first);
+      VectorValue<double> dir = edge_vector.unit(); // unit direction of the edge
 
-      double length = edge->volume();
+      double length = edge_vector.size();
       double partial_area = elem->partial_area_with_edge(ne);  // partial area associated with this edge
       double truncated_partial_area =  partial_area;
       if(truncation)
@@ -1249,13 +1270,10 @@ void SemiconductorSimulationRegion::HALL_Jacobian(const VectorValue<double> & B,
         truncated_partial_area =  this->truncated_partial_area(elem, ne);
       }
 
-      std::vector<unsigned int > edge_nodes;
-      elem->nodes_on_edge(ne, edge_nodes);
-
       // fvm_node of node1
-      const FVM_Node * fvm_n1 = elem->get_fvm_node(edge_nodes[0]);
+      const FVM_Node * fvm_n1 = elem->get_fvm_node(edge_nodes.first);
       // fvm_node of node2
-      const FVM_Node * fvm_n2 = elem->get_fvm_node(edge_nodes[1]);
+      const FVM_Node * fvm_n2 = elem->get_fvm_node(edge_nodes.second);
 
       // fvm_node_data of node1
       const FVM_NodeData * n1_data =  fvm_n1->node_data() ;
@@ -1273,9 +1291,9 @@ void SemiconductorSimulationRegion::HALL_Jacobian(const VectorValue<double> & B,
       //for node 1 of the edge
       mt->mapping(fvm_n1->root_node(), n1_data, SolverSpecify::clock);
 
-      AutoDScalar V1   =  x[n1_local_offset+0];       V1.setADValue(3*edge_nodes[0]+0, 1.0);           // electrostatic potential
-      AutoDScalar n1   =  x[n1_local_offset+1];       n1.setADValue(3*edge_nodes[0]+1, 1.0);           // electron density
-      AutoDScalar p1   =  x[n1_local_offset+2];       p1.setADValue(3*edge_nodes[0]+2, 1.0);           // hole density
+      AutoDScalar V1   =  x[n1_local_offset+0];       V1.setADValue(3*edge_nodes.first+0, 1.0);           // electrostatic potential
+      AutoDScalar n1   =  x[n1_local_offset+1];       n1.setADValue(3*edge_nodes.first+1, 1.0);           // electron density
+      AutoDScalar p1   =  x[n1_local_offset+2];       p1.setADValue(3*edge_nodes.first+2, 1.0);           // hole density
 
       AutoDScalar Ec1 =  -(e*V1 + n1_data->affinity() + kb*T*log(mt->band->nie(p1, n1, T)) );
       AutoDScalar Ev1 =  -(e*V1 + n1_data->affinity() - kb*T*log(mt->band->nie(p1, n1, T)) );
@@ -1288,9 +1306,9 @@ void SemiconductorSimulationRegion::HALL_Jacobian(const VectorValue<double> & B,
       //for node 2 of the edge
       mt->mapping(fvm_n2->root_node(), n2_data, SolverSpecify::clock);
 
-      AutoDScalar V2   =  x[n2_local_offset+0];       V2.setADValue(3*edge_nodes[1]+0, 1.0);             // electrostatic potential
-      AutoDScalar n2   =  x[n2_local_offset+1];       n2.setADValue(3*edge_nodes[1]+1, 1.0);             // electron density
-      AutoDScalar p2   =  x[n2_local_offset+2];       p2.setADValue(3*edge_nodes[1]+2, 1.0);             // hole density
+      AutoDScalar V2   =  x[n2_local_offset+0];       V2.setADValue(3*edge_nodes.second+0, 1.0);             // electrostatic potential
+      AutoDScalar n2   =  x[n2_local_offset+1];       n2.setADValue(3*edge_nodes.second+1, 1.0);             // electron density
+      AutoDScalar p2   =  x[n2_local_offset+2];       p2.setADValue(3*edge_nodes.second+2, 1.0);             // hole density
 
       AutoDScalar Ec2 =  -(e*V2 + n2_data->affinity() + kb*T*log(mt->band->nie(p2, n2, T)) );
       AutoDScalar Ev2 =  -(e*V2 + n2_data->affinity() - kb*T*log(mt->band->nie(p2, n2, T)) );
@@ -20,8 +20,13 @@
 /********************************************************************************/
 
 #include "electrical_source.h"
+#include "simulation_system.h"
+#include "semiconductor_region.h"
 #include "hdm/hdm.h"
 #include "hdm/linear_poisson.h"
+#include "hdm_flux.h"
+
+using PhysicalUnit::kb;
 
 
 HDMSolver::HDMSolver(SimulationSystem & system)
@@ -53,6 +58,7 @@ int HDMSolver::create_solver()
   BoundaryCondition::set_solver_index(0);
   setup_explicit_data();
 
+  build_flux_table();
 
   return FVM_ExplicitSolver::create_solver();
 }
@@ -88,6 +94,7 @@ int HDMSolver::destroy_solver()
 {
   poisson_solver->destroy_solver();
 
+  clear_flux_table();
   clear_explicit_data();
 
   return FVM_ExplicitSolver::destroy_solver();
@@ -182,12 +189,7 @@ void HDMSolver::local_time_advance(int step, Real alpha)
   VecZeroEntries(t);
 
   // build flux, compute local time step
-  FVM_Node::set_solver_index(0);
-  for(unsigned int n=0; n<_system.n_regions(); n++)
-  {
-    SimulationRegion * region = _system.region(n);
-    region->HDM_Flux(lxx, f, t);
-  }
+  flux_kernel(lxx);
 
   // process solid wall boundary by ghost cell
   InsertMode add_value_flag = NOT_SET_VALUES;
@@ -322,6 +324,170 @@ void HDMSolver::update_solution()
 }
 
 
+void HDMSolver::build_flux_table()
+{
+  clear_flux_table();
+
+  PetscInt row_begin, row_end;
+  VecGetOwnershipRange(f, &row_begin, &row_end);
+
+  _flux_edge_ptr.push_back(0);
+
+  FVM_Node::set_solver_index(0);
+  for(unsigned int n=0; n<_system.n_regions(); n++)
+  {
+    SimulationRegion * region = _system.region(n);
+    if( region->type() != SemiconductorRegion )  continue;
+
+    const SemiconductorSimulationRegion * semi_region = dynamic_cast<const SemiconductorSimulationRegion *>(region);
+    const PetscScalar mn = semi_region->material()->band->EffecElecMass(region->T_external());
+    const PetscScalar mp = semi_region->material()->band->EffecHoleMass(region->T_external());
+
+    SimulationRegion::const_processor_node_iterator node_it = region->on_processor_nodes_begin();
+    SimulationRegion::const_processor_node_iterator node_it_end = region->on_processor_nodes_end();
+    for(; node_it!=node_it_end; ++node_it)
+    {
+      const FVM_Node * node = *node_it;
+      genius_assert(node->global_offset() >= static_cast<unsigned int>(row_begin) && node->global_offset()+8 <= static_cast<unsigned int>(row_end));
+
+      _flux_node_row.push_back(node->global_offset() - row_begin);
+      _flux_node_x.push_back(node->local_offset());
+      _flux_node_mass.push_back(mn);
+      _flux_node_mass.push_back(mp);
+
+      FVM_Node::fvm_neighbor_node_iterator  neighbor_begin = node->neighbor_node_begin();
+      FVM_Node::fvm_neighbor_node_iterator  neighbor_end = node->neighbor_node_end();
+      for(; neighbor_begin!=neighbor_end; ++neighbor_begin )
+      {
+        const FVM_Node * neigbor_node = (*neighbor_begin).first;
+        VectorValue<double> dir = (*(neigbor_node->root_node()) - *(node->root_node())).unit();
+
+        _flux_edge_x.push_back(neigbor_node->local_offset());
+        _flux_edge_geom.push_back(node->distance(neigbor_node));
+        _flux_edge_geom.push_back(node->cv_surface_area(neigbor_node));
+        _flux_edge_geom.push_back(dir(0));
+        _flux_edge_geom.push_back(dir(1));
+        _flux_edge_geom.push_back(dir(2));
+      }
+      _flux_edge_ptr.push_back(_flux_edge_x.size());
+    }
+  }
+
+#ifdef HAVE_OPENMP_OFFLOAD
+  // keep the table on the device, only the solution goes there each step
+  const int n_nodes = _flux_node_row.size();
+  const int n_edges = _flux_edge_x.size();
+  const PetscInt * node_row = n_nodes ? &_flux_node_row[0] : 0;
+  const PetscInt * node_x   = n_nodes ? &_flux_node_x[0] : 0;
+  const PetscInt * edge_ptr = &_flux_edge_ptr[0];
+  const PetscInt * edge_x   = n_edges ? &_flux_edge_x[0] : 0;
+  const Real * edge_geom    = n_edges ? &_flux_edge_geom[0] : 0;
+  const Real * node_mass    = n_nodes ? &_flux_node_mass[0] : 0;
+  #pragma omp target enter data map(to: node_row[0:n_nodes], node_x[0:n_nodes], edge_ptr[0:n_nodes+1], \
+                                        edge_x[0:n_edges], edge_geom[0:5*n_edges], node_mass[0:2*n_nodes])
+#endif
+}
+
+
+void HDMSolver::clear_flux_table()
+{
+#ifdef HAVE_OPENMP_OFFLOAD
+  if( !_flux_edge_ptr.empty() )
+  {
+    const int n_nodes = _flux_node_row.size();
+    const int n_edges = _flux_edge_x.size();
+    const PetscInt * node_row = n_nodes ? &_flux_node_row[0] : 0;
+    const PetscInt * node_x   = n_nodes ? &_flux_node_x[0] : 0;
+    const PetscInt * edge_ptr = &_flux_edge_ptr[0];
+    const PetscInt * edge_x   = n_edges ? &_flux_edge_x[0] : 0;
+    const Real * edge_geom    = n_edges ? &_flux_edge_geom[0] : 0;
+    const Real * node_mass    = n_nodes ? &_flux_node_mass[0] : 0;
+    #pragma omp target exit data map(delete: node_row[0:n_nodes], node_x[0:n_nodes], edge_ptr[0:n_nodes+1], \
+                                             edge_x[0:n_edges], edge_geom[0:5*n_edges], node_mass[0:2*n_nodes])
+  }
+#endif
+
+  _flux_node_row.clear();
+  _flux_node_x.clear();
+  _flux_edge_ptr.clear();
+  _flux_edge_x.clear();
+  _flux_edge_geom.clear();
+  _flux_node_mass.clear();
+}
+
+
+void HDMSolver::flux_kernel(const PetscScalar * lxx)
+{
+  PetscScalar *ff, *tt;
+  PetscInt n_f, n_lx;
+  VecGetLocalSize(f, &n_f);
+  VecGetLocalSize(lx, &n_lx);
+  VecGetArray(f, &ff);
+  VecGetArray(t, &tt);
+
+  // kb as HDM_Flux of semiconductor region does
+  const Real kT = kb;
+
+  const int n_nodes = _flux_node_row.size();
+  const int n_edges = _flux_edge_x.size();
+  const PetscInt * node_row = n_nodes ? &_flux_node_row[0] : 0;
+  const PetscInt * node_x   = n_nodes ? &_flux_node_x[0] : 0;
+  const PetscInt * edge_ptr = &_flux_edge_ptr[0];
+  const PetscInt * edge_x   = n_edges ? &_flux_edge_x[0] : 0;
+  const Real * edge_geom    = n_edges ? &_flux_edge_geom[0] : 0;
+  const Real * node_mass    = n_nodes ? &_flux_node_mass[0] : 0;
+
+  // each node writes its own rows, no atomic is needed
+#if defined(HAVE_OPENMP_OFFLOAD)
+  #pragma omp target teams distribute parallel for map(to: lxx[0:n_lx]) map(from: ff[0:n_f], tt[0:n_f])
+#elif defined(HAVE_OPENMP)
+  #pragma omp parallel for schedule(static)
+#endif
+  for(int i=0; i<n_nodes; ++i)
+  {
+    const Real * Un1 = &lxx[node_x[i]];
+    const Real * Up1 = &lxx[node_x[i]+4];
+    const Real mn = node_mass[2*i];
+    const Real mp = node_mass[2*i+1];
+
+    Real fn[4] = {0.0, 0.0, 0.0, 0.0};
+    Real fp[4] = {0.0, 0.0, 0.0, 0.0};
+    Real dt = 1e38;
+    for(PetscInt e=edge_ptr[i]; e<edge_ptr[i+1]; ++e)
+    {
+      const Real * geom = &edge_geom[5*e];
+      Real fn_e[4], fp_e[4];
+      Real local_dt1 = AUSM_if_flux(Un1, &lxx[edge_x[e]],   mn, kT, geom[0], geom[1], &geom[2], fn_e);
+      Real local_dt2 = AUSM_if_flux(Up1, &lxx[edge_x[e]+4], mp, kT, geom[0], geom[1], &geom[2], fp_e);
+      for(int k=0; k<4; ++k)
+      {
+        fn[k] += fn_e[k];
+        fp[k] += fp_e[k];
+      }
+      dt = dt < local_dt1 ? dt : local_dt1;
+      dt = dt < local_dt2 ? dt : local_dt2;
+    }
+
+    // f is zero before, all the semiconductor rows belong to the table
+    const PetscInt row = node_row[i];
+    for(int k=0; k<4; ++k)
+    {
+      ff[row+k]   = fn[k];
+      ff[row+4+k] = fp[k];
+    }
+    for(int k=0; k<8; ++k)
+      tt[row+k] = dt;
+  }
+
+  VecRestoreArray(f, &ff);
+  VecRestoreArray(t, &tt);
+
+#if defined(HAVE_FENV_H) && defined(DEBUG)
+  genius_assert( !fetestexcept(FE_INVALID) );
+#endif
+}
+
+
 void HDMSolver::sync_rho()
 {
   // scatte global solution vector x to local vector lx
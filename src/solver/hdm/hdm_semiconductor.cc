@@ -26,7 +26,7 @@
 #include "solver_specify.h"
 
 #include "hdm_flux.h"
-#include <TNT/jama_lu.h>
+#include "dense_matrix_fixed.h"
 
 using PhysicalUnit::kb;
 using PhysicalUnit::e;
@@ -180,9 +180,6 @@ void SemiconductorSimulationRegion::HDM_Source(const PetscScalar * lx, const Pet
   const PetscScalar mp = mt->band->EffecHoleMass(T);
   const PetscScalar damping_density = 1e17*std::pow(cm, -3);
 
-  TNT::Array2D<Real> I(4, 4, 0.0);
-  I[0][0]=I[1][1]=I[2][2]=I[3][3]=1.0;
-
   const_processor_node_iterator node_it = on_processor_nodes_begin();
   const_processor_node_iterator node_it_end = on_processor_nodes_end();
   for(; node_it!=node_it_end; ++node_it)
@@ -209,55 +206,49 @@ void SemiconductorSimulationRegion::HDM_Source(const PetscScalar * lx, const Pet
     PetscScalar taop = mp*mup/e;
 
     {
-      TNT::Array2D<Real> An (4, 4, 0.0);
-      TNT::Array1D<Real> bn (4);
-      TNT::Array1D<Real> rn (4);
-
-      An[0][0] = -R/n;
-      An[1][0] = -node_data->E()(0);
-      An[1][1] = -1/taon;
-      An[2][0] = -node_data->E()(1);
-      An[2][2] = -1/taon;
-      An[3][0] = -node_data->E()(2);
-      An[3][3] = -1/taon;
-
-      bn[0] = lx[node->local_offset()+0];
-      bn[1] = lx[node->local_offset()+1];
-      bn[2] = lx[node->local_offset()+2];
-      bn[3] = lx[node->local_offset()+3];
-
-      rn = dt*(An*bn);
-      An = I - dt*An;
-
-      JAMA::LU<Real> solver(An);
-      TNT::Array1D<Real> dx = solver.solve(rn);
+      DenseMatrixFixed<4,4> An;
+      Real dx[4];
+
+      An(0,0) = -R/n;
+      An(1,0) = -node_data->E()(0);
+      An(1,1) = -1/taon;
+      An(2,0) = -node_data->E()(1);
+      An(2,2) = -1/taon;
+      An(3,0) = -node_data->E()(2);
+      An(3,3) = -1/taon;
+
+      // rn = dt*An*bn, then solve (I - dt*An)*dx = rn
+      An.vector_mult(lx+node->local_offset(), dx);
+      for(int i=0; i<4; ++i) dx[i] *= dt;
+      An *= -dt;
+      An.add_diagonal(1.0);
+
+      DenseLUFixed<4> solver(An);
+      solver.solve(dx, dx);
       //dx = 0.1*dx;
       VecSetValues(x, 4, &loc[0], &dx[0], ADD_VALUES);
     }
 
     {
-      TNT::Array2D<Real> Ap (4, 4, 0.0);
-      TNT::Array1D<Real> bp (4);
-      TNT::Array1D<Real> rp (4);
-
-      Ap[0][0] = -R/p;
-      Ap[1][0] = node_data->E()(0);
-      Ap[1][1] = -1/taop;
-      Ap[2][0] = node_data->E()(1);
-      Ap[2][2] = -1/taop;
-      Ap[3][0] = node_data->E()(2);
-      Ap[3][3] = -1/taop;
-
-      bp[0] = lx[node->local_offset()+4];
-      bp[1] = lx[node->local_offset()+5];
-      bp[2] = lx[node->local_offset()+6];
-      bp[3] = lx[node->local_offset()+7];
-
-      rp = dt*(Ap*bp);
-      Ap = I - dt*Ap;
-
-      JAMA::LU<Real> solver(Ap);
-      TNT::Array1D<Real> dx = solver.solve(rp);
+      DenseMatrixFixed<4,4> Ap;
+      Real dx[4];
+
+      Ap(0,0) = -R/p;
+      Ap(1,0) = node_data->E()(0);
+      Ap(1,1) = -1/taop;
+      Ap(2,0) = node_data->E()(1);
+      Ap(2,2) = -1/taop;
+      Ap(3,0) = node_data->E()(2);
+      Ap(3,3) = -1/taop;
+
+      // rp = dt*Ap*bp, then solve (I - dt*Ap)*dx = rp
+      Ap.vector_mult(lx+node->local_offset()+4, dx);
+      for(int i=0; i<4; ++i) dx[i] *= dt;
+      Ap *= -dt;
+      Ap.add_diagonal(1.0);
+
+      DenseLUFixed<4> solver(Ap);
+      solver.solve(dx, dx);
       //dx = 0.1*dx;
       VecSetValues(x, 4, &loc[4], &dx[0], ADD_VALUES);
     }
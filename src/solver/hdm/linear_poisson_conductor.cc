@@ -68,22 +68,20 @@ void ElectrodeSimulationRegion::LinearPoissin_Matrix(Mat A, InsertMode &add_valu
     //search for all the Edge this cell own
     for(unsigned int ne=0; ne<(*it)->n_edges(); ++ne )
     {
-      AutoPtr<Elem> edge = (*it)->build_edge (ne);
-      genius_assert(edge->type()==EDGE2);
-
-      std::vector<unsigned int > edge_nodes;
+      std::pair<unsigned int, unsigned int> edge_nodes;
       (*it)->nodes_on_edge(ne, edge_nodes);
+      const Point edge_vector = (*it)->point(edge_nodes.second) - (*it)->point(edge_nodes.first);
 
       // the length of this edge
-      double length = edge->volume();
+      double length = edge_vector.size();
 
       // partial area associated with this edge
       double partial_area = (*it)->partial_area_with_edge(ne);
 
       // fvm_node of node1
-      const FVM_Node * fvm_n1 = (*it)->get_fvm_node(edge_nodes[0]);
+      const FVM_Node * fvm_n1 = (*it)->get_fvm_node(edge_nodes.first);
       // fvm_node of node2
-      const FVM_Node * fvm_n2 = (*it)->get_fvm_node(edge_nodes[1]);
+      const FVM_Node * fvm_n2 = (*it)->get_fvm_node(edge_nodes.second);
 
 
       // fvm_node_data of node1
@@ -24,6 +24,7 @@
 #include "simulation_system.h"
 #include "semiconductor_region.h"
 #include "solver_specify.h"
+#include "dense_matrix_fixed.h"
 
 using PhysicalUnit::cm;
 using PhysicalUnit::kb;
@@ -74,22 +75,20 @@ void SemiconductorSimulationRegion::LinearPoissin_Matrix(Mat A, InsertMode &add_
     //search for all the Edge this cell own
     for(unsigned int ne=0; ne<(*it)->n_edges(); ++ne )
     {
-      AutoPtr<Elem> edge = (*it)->build_edge (ne);
-      genius_assert(edge->type()==EDGE2);
-
-      std::vector<unsigned int > edge_nodes;
+      std::pair<unsigned int, unsigned int> edge_nodes;
       (*it)->nodes_on_edge(ne, edge_nodes);
+      const Point edge_vector = (*it)->point(edge_nodes.second) - (*it)->point(edge_nodes.first);
 
       // the length of this edge
-      double length = edge->volume();
+      double length = edge_vector.size();
 
       // partial area associated with this edge
       double partial_area = (*it)->partial_area_with_edge(ne);
 
       // fvm_node of node1
-      const FVM_Node * fvm_n1 = (*it)->get_fvm_node(edge_nodes[0]);
+      const FVM_Node * fvm_n1 = (*it)->get_fvm_node(edge_nodes.first);
       // fvm_node of node2
-      const FVM_Node * fvm_n2 = (*it)->get_fvm_node(edge_nodes[1]);
+      const FVM_Node * fvm_n2 = (*it)->get_fvm_node(edge_nodes.second);
 
 
       // fvm_node_data of node1
@@ -143,7 +142,6 @@ void SemiconductorSimulationRegion::LinearPoissin_Matrix(Mat A, InsertMode &add_
   add_value_flag = ADD_VALUES;
 }
 
-#include <TNT/jama_lu.h>
 void SemiconductorSimulationRegion::LinearPoissin_Update_Solution(const PetscScalar * x)
 {
   PetscScalar damping_density = 1e17*std::pow(cm, -3);
@@ -181,8 +179,7 @@ void SemiconductorSimulationRegion::LinearPoissin_Update_Solution(const PetscSca
 
   // calculate E with least squares
   {
-    TNT::Array2D<Real> A (3, 3, 0.0);
-    TNT::Array1D<Real> r (3, 0.0);
+    DenseMatrixFixed<3,3> A;
 
     processor_node_iterator node_it = on_processor_nodes_begin();
     processor_node_iterator node_it_end = on_processor_nodes_end();
@@ -222,16 +219,13 @@ void SemiconductorSimulationRegion::LinearPoissin_Update_Solution(const PetscSca
       // so we set it to 1.0
       if(fabs(f)<1e-6) f=1.0;
 
-      A[0][0] = a; A[0][1] = b; A[0][2] = c;
-      A[1][0] = b; A[1][1] = d; A[1][2] = e;
-      A[2][0] = c; A[2][1] = e; A[2][2] = f;
-
-      r[0] = r1;
-      r[1] = r2;
-      r[2] = r3;
+      A(0,0) = a; A(0,1) = b; A(0,2) = c;
+      A(1,0) = b; A(1,1) = d; A(1,2) = e;
+      A(2,0) = c; A(2,1) = e; A(2,2) = f;
 
-      JAMA::LU<Real> solver(A);
-      TNT::Array1D<Real> dphi = solver.solve(r);
+      Real dphi[3] = {r1, r2, r3};
+      DenseLUFixed<3> solver(A);
+      solver.solve(dphi, dphi);
 
       //PetscScalar carrier = node_data->n() + node_data->p();
       //PetscScalar damping = carrier > damping_density ? damping_density/carrier : 1.0;
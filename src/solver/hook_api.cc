@@ -0,0 +1,211 @@
+/********************************************************************************/
+/*     888888    888888888   88     888  88888   888      888    88888888       */
+/*   8       8   8           8 8     8     8      8        8    8               */
+/*  8            8           8  8    8     8      8        8    8               */
+/*  8            888888888   8   8   8     8      8        8     8888888        */
+/*  8      8888  8           8    8  8     8      8        8            8       */
+/*   8       8   8           8     8 8     8      8        8            8       */
+/*     888888    888888888  888     88   88888     88888888     88888888        */
+/*                                                                              */
+/*       A Three-Dimensional General Purpose Semiconductor Simulator.           */
+/*                                                                              */
+/*                                                                              */
+/*  Copyright (C) 2007-2008                                                     */
+/*  Cogenda Pte Ltd                                                             */
+/*                                                                              */
+/*  Please contact Cogenda Pte Ltd for license information                      */
+/*                                                                              */
+/*  Author: Gong Ding   gdiso@ustc.edu                                          */
+/*                                                                              */
+/********************************************************************************/
+
+#include <map>
+#include <vector>
+
+#include "genius_hook_api.h"
+#include "solver_base.h"
+#include "fvm_nonlinear_solver.h"
+#include "simulation_system.h"
+#include "simulation_region.h"
+#include "boundary_condition_collector.h"
+#include "solver_specify.h"
+#include "parallel.h"
+#include "solver_counters.h"
+
+
+namespace
+{
+  /**
+   * node coordinates and ownership of a region in the order of node data storage
+   */
+  struct RegionNodeCache
+  {
+    RegionNodeCache() : mesh_revision(invalid_uint) {}
+    unsigned int        mesh_revision;
+    std::vector<double> xyz;
+    std::vector<char>   on_processor;
+  };
+
+  std::map<std::pair<const SimulationSystem *, unsigned int>, RegionNodeCache> _region_node_cache;
+
+  /**
+   * double copy of the node variables stored in float, keyed by region and variable index
+   */
+  std::map<std::pair<const SimulationRegion *, unsigned int>, std::vector<double> > _float_variable_copy;
+
+  inline const SolverBase & solver_of(const GeniusHookContext * ctx)
+  { return *reinterpret_cast<const SolverBase *>(ctx); }
+
+  const RegionNodeCache & region_node_cache(const GeniusHookContext * ctx, unsigned int r)
+  {
+    const SimulationSystem & system = solver_of(ctx).get_system();
+    RegionNodeCache & cache = _region_node_cache[std::make_pair(&system, r)];
+    if( cache.mesh_revision == system.mesh_revision() ) return cache;
+
+    const SimulationRegion * region = system.region(r);
+    const unsigned int n = region->node_data_storage().size();
+    cache.xyz.assign(3*n, 0.0);
+    cache.on_processor.assign(n, 0);
+
+    SimulationRegion::const_local_node_iterator it = region->on_local_nodes_begin();
+    SimulationRegion::const_local_node_iterator it_end = region->on_local_nodes_end();
+    for(; it!=it_end; ++it)
+    {
+      const FVM_Node * fvm_node = *it;
+      const unsigned int offset = fvm_node->node_data()->offset();
+      const Node * node = fvm_node->root_node();
+      cache.xyz[3*offset+0] = (*node)(0);
+      cache.xyz[3*offset+1] = (*node)(1);
+      cache.xyz[3*offset+2] = (*node)(2);
+      cache.on_processor[offset] = fvm_node->on_processor() ? 1 : 0;
+    }
+
+    cache.mesh_revision = system.mesh_revision();
+    return cache;
+  }
+
+  const BoundaryCondition * electrode_bc(const GeniusHookContext * ctx, unsigned int e)
+  {
+    const BoundaryConditionCollector * bcs = solver_of(ctx).get_system().get_bcs();
+    for(unsigned int n=0; n<bcs->n_bcs(); ++n)
+    {
+      const BoundaryCondition * bc = bcs->get_bc(n);
+      if( !bc->is_electrode() ) continue;
+      if( e-- == 0 ) return bc;
+    }
+    return NULL;
+  }
+}
+
+
+extern "C"
+{
+
+  int genius_hook_processor_id(const GeniusHookContext *)
+  { return Genius::processor_id(); }
+
+
+  int genius_hook_n_processors(const GeniusHookContext *)
+  { return Genius::n_processors(); }
+
+
+  unsigned int genius_hook_n_regions(const GeniusHookContext * ctx)
+  { return solver_of(ctx).get_system().n_regions(); }
+
+
+  const char * genius_hook_region_label(const GeniusHookContext * ctx, unsigned int r)
+  {
+    if( r >= genius_hook_n_regions(ctx) ) return NULL;
+    return solver_of(ctx).get_system().region(r)->name().c_str();
+  }
+
+
+  unsigned int genius_hook_region_n_nodes(const GeniusHookContext * ctx, unsigned int r)
+  {
+    if( r >= genius_hook_n_regions(ctx) ) return 0;
+    return solver_of(ctx).get_system().region(r)->node_data_storage().size();
+  }
+
+
+  const double * genius_hook_region_node_coordinates(const GeniusHookContext * ctx, unsigned int r)
+  {
+    if( r >= genius_hook_n_regions(ctx) ) return NULL;
+    const RegionNodeCache & cache = region_node_cache(ctx, r);
+    return cache.xyz.empty() ? NULL : &cache.xyz[0];
+  }
+
+
+  int genius_hook_region_node_on_processor(const GeniusHookContext * ctx, unsigned int r, unsigned int i)
+  {
+    if( r >= genius_hook_n_regions(ctx) ) return 0;
+    const RegionNodeCache & cache = region_node_cache(ctx, r);
+    return i < cache.on_processor.size() ? cache.on_processor[i] : 0;
+  }
+
+
+  const double * genius_hook_region_node_variable(const GeniusHookContext * ctx, unsigned int r, const char * v, double * unit)
+  {
+    if( r >= genius_hook_n_regions(ctx) || v == NULL ) return NULL;
+    const SimulationRegion * region = solver_of(ctx).get_system().region(r);
+
+    SimulationVariable variable;
+    if( !region->get_variable(v, POINT_CENTER, variable) ) return NULL;
+    if( variable.variable_data_type != SCALAR || !variable.variable_valid ) return NULL;
+
+    if( unit ) *unit = variable.variable_unit;
+    const DataStorage & storage = region->node_data_storage();
+    if( !storage.scalar_single(variable.variable_index) )
+      return storage.scalar_block(variable.variable_index);
+
+    std::vector<double> & data = _float_variable_copy[std::make_pair(region, variable.variable_index)];
+    storage.scalar_to_vector(variable.variable_index, data);
+    return data.empty() ? NULL : &data[0];
+  }
+
+
+  int genius_hook_residual_norm(const GeniusHookContext * ctx, double * norm2, double * norm_inf)
+  {
+    const FVM_NonlinearSolver * solver = dynamic_cast<const FVM_NonlinearSolver *>(&solver_of(ctx));
+    if( solver == NULL ) return -1;
+
+    PetscReal n2=0, ninf=0;
+    VecNorm(solver->rhs_vector(), NORM_2, &n2);
+    VecNorm(solver->rhs_vector(), NORM_INFINITY, &ninf);
+    if( norm2 ) *norm2 = n2;
+    if( norm_inf ) *norm_inf = ninf;
+    return 0;
+  }
+
+
+  unsigned int genius_hook_n_electrodes(const GeniusHookContext * ctx)
+  { return solver_of(ctx).get_system().get_bcs()->n_electrode_bcs(); }
+
+
+  int genius_hook_electrode_iv(const GeniusHookContext * ctx, unsigned int e, const char ** label, double * v, double * i)
+  {
+    const BoundaryCondition * bc = electrode_bc(ctx, e);
+    if( bc == NULL ) return -1;
+
+    if( label ) *label = bc->label().c_str();
+    if( v ) *v = bc->ext_circuit()->potential()/PhysicalUnit::V;
+    if( i ) *i = bc->ext_circuit()->current()/PhysicalUnit::A;
+    return 0;
+  }
+
+
+  double genius_hook_clock(const GeniusHookContext *)
+  { return SolverSpecify::clock/PhysicalUnit::s; }
+
+
+  long genius_hook_counter(const GeniusHookContext *, const char * name)
+  { return solver_counters.value(std::string(name)); }
+
+
+  void genius_hook_add_counter(const GeniusHookContext *, const char * name, long n)
+  { solver_counters.add(solver_counters.counter(name), n); }
+
+
+  void genius_hook_set_gauge(const GeniusHookContext *, const char * name, double v)
+  { solver_counters.set_gauge(name, v); }
+
+}
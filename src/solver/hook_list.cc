@@ -0,0 +1,195 @@
+/********************************************************************************/
+/*     888888    888888888   88     888  88888   888      888    88888888       */
+/*   8       8   8           8 8     8     8      8        8    8               */
+/*  8            8           8  8    8     8      8        8    8               */
+/*  8            888888888   8   8   8     8      8        8     8888888        */
+/*  8      8888  8           8    8  8     8      8        8            8       */
+/*   8       8   8           8     8 8     8      8        8            8       */
+/*     888888    888888888  888     88   88888     88888888     88888888        */
+/*                                                                              */
+/*       A Three-Dimensional General Purpose Semiconductor Simulator.           */
+/*                                                                              */
+/*                                                                              */
+/*  Copyright (C) 2007-2008                                                     */
+/*  Cogenda Pte Ltd                                                             */
+/*                                                                              */
+/*  Please contact Cogenda Pte Ltd for license information                      */
+/*                                                                              */
+/*  Author: Gong Ding   gdiso@ustc.edu                                          */
+/*                                                                              */
+/********************************************************************************/
+
+#include <iomanip>
+
+#include "genius_env.h"
+#include "genius_common.h"
+#include "hook_list.h"
+#include "parallel.h"
+#include "log.h"
+
+
+double HookList::_wtime()
+{
+  PetscLogDouble t;
+  PetscGetTime(&t);
+  return t;
+}
+
+
+bool HookList::_schedule(const Hook * hook, unsigned int & counter, double & last)
+{
+  // every N-th callback, the counter is identical on all the processors
+  if( hook->every() > 1 && (counter++)%hook->every() != 0 ) return false;
+
+  if( hook->interval() > 0.0 )
+  {
+    // wall clock differs between processors, let processor 0 make the decision
+    int run = 1;
+    double now = _wtime();
+    if( now - last < hook->interval() ) run = 0;
+    Parallel::broadcast(run);
+    if( !run ) return false;
+    last = now;
+  }
+
+  return true;
+}
+
+
+void HookList::on_init()
+{
+  for (unsigned int i=0; i<_hook_list.size(); ++i)
+  {
+    Hook * hook = _hook_list[i];
+    START_LOG(hook->name(), "Hook::on_init");
+    double t0 = _wtime();
+    hook->on_init();
+    _hook_stat[i].time += _wtime() - t0;
+    STOP_LOG(hook->name(), "Hook::on_init");
+  }
+}
+
+
+void HookList::pre_solve()
+{
+  for (unsigned int i=0; i<_hook_list.size(); ++i)
+  {
+    Hook * hook = _hook_list[i];
+    HookStat & stat = _hook_stat[i];
+
+    stat.run_solve = _schedule(hook, stat.n_solve, stat.last_solve);
+    stat.solve_decided = true;
+    if( !stat.run_solve ) continue;
+
+    START_LOG(hook->name(), "Hook::pre_solve");
+    double t0 = _wtime();
+    hook->pre_solve();
+    stat.time += _wtime() - t0;
+    STOP_LOG(hook->name(), "Hook::pre_solve");
+  }
+}
+
+
+void HookList::post_solve()
+{
+  for (unsigned int i=0; i<_hook_list.size(); ++i)
+  {
+    Hook * hook = _hook_list[i];
+    HookStat & stat = _hook_stat[i];
+
+    // pair with the decision of pre_solve
+    if( !stat.solve_decided )
+      stat.run_solve = _schedule(hook, stat.n_solve, stat.last_solve);
+    stat.solve_decided = false;
+    if( !stat.run_solve ) { stat.skips++; continue; }
+
+    START_LOG(hook->name(), "Hook::post_solve");
+    double t0 = _wtime();
+    hook->post_solve();
+    stat.time += _wtime() - t0;
+    stat.calls++;
+    STOP_LOG(hook->name(), "Hook::post_solve");
+  }
+}
+
+
+void HookList::trigger(const std::string & source)
+{
+  for (unsigned int i=0; i<_hook_list.size(); ++i)
+  {
+    Hook * hook = _hook_list[i];
+    START_LOG(hook->name(), "Hook::on_trigger");
+    double t0 = _wtime();
+    hook->on_trigger(source);
+    _hook_stat[i].time += _wtime() - t0;
+    STOP_LOG(hook->name(), "Hook::on_trigger");
+  }
+}
+
+
+void HookList::pre_iteration()
+{
+  for (unsigned int i=0; i<_hook_list.size(); ++i)
+  {
+    Hook * hook = _hook_list[i];
+    HookStat & stat = _hook_stat[i];
+
+    stat.run_iteration = _schedule(hook, stat.n_iteration, stat.last_iteration);
+    stat.iteration_decided = true;
+    if( !stat.run_iteration ) continue;
+
+    START_LOG(hook->name(), "Hook::pre_iteration");
+    double t0 = _wtime();
+    hook->pre_iteration();
+    stat.time += _wtime() - t0;
+    STOP_LOG(hook->name(), "Hook::pre_iteration");
+  }
+}
+
+
+void HookList::post_iteration()
+{
+  for (unsigned int i=0; i<_hook_list.size(); ++i)
+  {
+    Hook * hook = _hook_list[i];
+    HookStat & stat = _hook_stat[i];
+
+    // some solver call post_iteration without pre_iteration
+    if( !stat.iteration_decided )
+      stat.run_iteration = _schedule(hook, stat.n_iteration, stat.last_iteration);
+    stat.iteration_decided = false;
+    if( !stat.run_iteration ) { stat.skips++; continue; }
+
+    START_LOG(hook->name(), "Hook::post_iteration");
+    double t0 = _wtime();
+    hook->post_iteration();
+    stat.time += _wtime() - t0;
+    stat.calls++;
+    STOP_LOG(hook->name(), "Hook::post_iteration");
+  }
+}
+
+
+void HookList::on_close()
+{
+  for (unsigned int i=0; i<_hook_list.size(); ++i)
+  {
+    Hook * hook = _hook_list[i];
+    HookStat & stat = _hook_stat[i];
+
+    START_LOG(hook->name(), "Hook::on_close");
+    double t0 = _wtime();
+    hook->on_close();
+    stat.time += _wtime() - t0;
+    STOP_LOG(hook->name(), "Hook::on_close");
+
+    if( hook->report() )
+    {
+      MESSAGE<<"Hook " << hook->name() << ": " << stat.calls << " runs, " << stat.skips << " skipped, "
+             << std::setprecision(3) << stat.time << " s" << std::endl;
+      RECORD();
+    }
+  }
+
+  this->clear();
+}
@@ -0,0 +1,325 @@
+/********************************************************************************/
+/*     888888    888888888   88     888  88888   888      888    88888888       */
+/*   8       8   8           8 8     8     8      8        8    8               */
+/*  8            8           8  8    8     8      8        8    8               */
+/*  8            888888888   8   8   8     8      8        8     8888888        */
+/*  8      8888  8           8    8  8     8      8        8            8       */
+/*   8       8   8           8     8 8     8      8        8            8       */
+/*     888888    888888888  888     88   88888     88888888     88888888        */
+/*                                                                              */
+/*       A Three-Dimensional General Purpose Semiconductor Simulator.           */
+/*                                                                              */
+/*                                                                              */
+/*  Copyright (C) 2007-2008                                                     */
+/*  Cogenda Pte Ltd                                                             */
+/*                                                                              */
+/*  Please contact Cogenda Pte Ltd for license information                      */
+/*                                                                              */
+/*  Author: Gong Ding   gdiso@ustc.edu                                          */
+/*                                                                              */
+/********************************************************************************/
+
+#include <cmath>
+#include <limits>
+
+#include "elem.h"
+#include "mesh_base.h"
+#include "point_locator_tree.h"
+#include "simulation_system.h"
+#include "simulation_region.h"
+#include "ray_tracing/object_tree.h"
+#include "mc/mc_solver.h"
+#include "parallel.h"
+#include "perf_log.h"
+
+using PhysicalUnit::um;
+using PhysicalUnit::cm;
+using PhysicalUnit::g;
+using PhysicalUnit::eV;
+
+
+double MonteCarloSolver::RandomStream::uniform()
+{
+  unsigned long long z = (_state += 0x9E3779B97F4A7C15ULL);
+  z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+  z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+  z = z ^ (z >> 31);
+  // 53 bits mantissa, never be 0 or 1
+  return ((z >> 11) + 0.5) * (1.0/9007199254740992.0);
+}
+
+
+double MonteCarloSolver::RandomStream::normal()
+{
+  // Box-Muller transform
+  const double u1 = uniform();
+  const double u2 = uniform();
+  return std::sqrt(-2.0*std::log(u1))*std::cos(2*3.14159265358979323846*u2);
+}
+
+
+
+MonteCarloSolver::MonteCarloSolver(SimulationSystem & system, const Parser::Card & c)
+  : ParticalSolver(system), _card(c), _surface_elem_tree(0)
+{
+  system.record_active_solver(this->solver_type());
+}
+
+
+MonteCarloSolver::~MonteCarloSolver()
+{
+  delete _surface_elem_tree;
+}
+
+
+int MonteCarloSolver::create_solver()
+{
+  MESSAGE<< '\n' << "Monte-Carlo particle solver init... ";
+  RECORD();
+
+  // each processor traces histories in the whole mesh
+  MeshBase & mesh = _system.mesh();
+  genius_assert(mesh.is_serial());
+
+  if( mesh.mesh_dimension() != 2 )
+  {
+    MESSAGE<<"ERROR at " << _card.get_fileline() <<" PARTICLE: Monte-Carlo solver only supports 2D mesh."<<std::endl; RECORD();
+    genius_error();
+  }
+
+  _surface_elem_tree = new ObjectTree(mesh);
+
+  _start.x() = _card.get_real("x", 0.0)*um;
+  _start.y() = _card.get_real("y", 0.0)*um;
+  _start.z() = 0.0;
+
+  // particle direction in xy plane
+  double phi   = _card.get_real("phi",   0.0)/180.0*3.14159265358979323846;
+  _dir = Point(sin(phi), cos(phi), 0.0);
+
+  _lateral_char = _card.get_real("lateral.char", 0.1)*um;
+  _length       = _card.get_real("length", 50.0)*um;
+  _LET          = _card.get_real("let", 0.0)*1e6*eV*cm*cm/(g/1e3);
+  _histories    = std::max(1, _card.get_int("mc.histories", 10000));
+  _seed         = _card.get_int("mc.seed", 0);
+  _step         = _card.get_real("mc.step", 0.05)*um;
+  _straggling   = _card.get_real("mc.straggling", 0.1);
+  _scatter      = _card.get_real("mc.scatter", 0.01);
+
+  _region_density.resize(_system.n_regions());
+  for(unsigned int r=0; r<_system.n_regions(); ++r)
+  {
+    const SimulationRegion * region = _system.region(r);
+    _region_density[r] = region->get_density(region->T_external());
+  }
+
+  MESSAGE<< _histories <<" histories."<<std::endl;
+  RECORD();
+
+  return 0;
+}
+
+
+int MonteCarloSolver::solve()
+{
+  START_LOG("solve()", "MonteCarloSolver");
+
+  const MeshBase & mesh = _system.mesh();
+  _energy_in_elem.assign(mesh.n_elem(), 0.0);
+
+  // histories of this processor
+  const unsigned int h_begin = (_histories/Genius::n_processors())*Genius::processor_id() + std::min(_histories%Genius::n_processors(), Genius::processor_id());
+  const unsigned int h_end   = h_begin + _histories/Genius::n_processors() + (Genius::processor_id() < _histories%Genius::n_processors() ? 1 : 0);
+  const int n_histories = static_cast<int>(h_end - h_begin);
+
+  std::vector< std::vector<EnergyDeposit> > history_deposits(n_histories);
+
+  // in plane normal of particle direction, for lateral offset
+  const Point lateral(-_dir(1), _dir(0), 0.0);
+
+#ifdef HAVE_OPENMP
+  #pragma omp parallel
+#endif
+  {
+    // each thread has its own locator, which shares the tree of mesh locator
+    PointLocatorTree locator(mesh, &mesh.point_locator());
+    locator.enable_out_of_mesh_mode();
+
+#ifdef HAVE_OPENMP
+    #pragma omp for schedule(dynamic, 16)
+#endif
+    for(int i=0; i<n_histories; ++i)
+    {
+      // random stream of this history only depends on seed and history index
+      const unsigned long long h = h_begin + i;
+      RandomStream rng( (static_cast<unsigned long long>(_seed) << 32) ^ (h*0xD1B54A32D192ED03ULL) );
+
+      Point p = _start + lateral*(_lateral_char*rng.normal()/std::sqrt(2.0));
+      Point d = _dir;
+
+      // the history starts inside mesh
+      const Elem * elem = locator(p);
+      if(!elem) elem = locate_history(p, d);
+      if(!elem) continue;
+
+      trace_history(elem, p, d, rng, history_deposits[i]);
+    }
+  }
+
+  // add energy deposit to elems by one thread
+  for(int i=0; i<n_histories; ++i)
+  {
+    const std::vector<EnergyDeposit> & deposits = history_deposits[i];
+    for(unsigned int d=0; d<deposits.size(); ++d)
+      _energy_in_elem[deposits[d].elem_id] += deposits[d].energy;
+  }
+
+  Parallel::sum(_energy_in_elem);
+
+  // average over histories
+  for(unsigned int n=0; n<_energy_in_elem.size(); ++n)
+    _energy_in_elem[n] /= _histories;
+
+  STOP_LOG("solve()", "MonteCarloSolver");
+
+  return 0;
+}
+
+
+int MonteCarloSolver::destroy_solver()
+{
+  delete _surface_elem_tree;
+  _surface_elem_tree = 0;
+
+  return 0;
+}
+
+
+const Elem * MonteCarloSolver::locate_history(Point & p, const Point & d) const
+{
+  const Elem * elem = _surface_elem_tree->hit(p, d);
+  if(!elem) return NULL;
+
+  // the entry point is the nearest intersection of the ray with elem sides
+  double t_entry = std::numeric_limits<double>::infinity();
+  for(unsigned int s=0; s<elem->n_sides(); ++s)
+  {
+    const Point & a = elem->point(elem->side_node(s, 0));
+    const Point & b = elem->point(elem->side_node(s, 1));
+    const Point e = b - a;
+    const double det = d(1)*e(0) - d(0)*e(1);
+    if( std::abs(det) < 1e-30 ) continue;
+    const Point w = a - p;
+    const double t = (w(1)*e(0) - w(0)*e(1))/det;
+    const double u = (d(0)*w(1) - d(1)*w(0))/det;
+    if( t >= 0.0 && u >= 0.0 && u <= 1.0 )
+      t_entry = std::min(t_entry, t);
+  }
+  if( t_entry == std::numeric_limits<double>::infinity() ) return NULL;
+
+  p = p + t_entry*d;
+  return elem;
+}
+
+
+double MonteCarloSolver::exit_distance(const Elem * elem, const Point & p, const Point & d, unsigned int & side)
+{
+  const double eps = 1e-9*elem->hmax();
+
+  double t_exit = std::numeric_limits<double>::infinity();
+  side = invalid_uint;
+  for(unsigned int s=0; s<elem->n_sides(); ++s)
+  {
+    const Point & a = elem->point(elem->side_node(s, 0));
+    const Point & b = elem->point(elem->side_node(s, 1));
+    const Point e = b - a;
+    const double det = d(1)*e(0) - d(0)*e(1);
+    if( std::abs(det) < 1e-30 ) continue;
+    const Point w = a - p;
+    const double t = (w(1)*e(0) - w(0)*e(1))/det;
+    const double u = (d(0)*w(1) - d(1)*w(0))/det;
+    if( t > eps && u >= -1e-9 && u <= 1.0+1e-9 && t < t_exit )
+    {
+      t_exit = t;
+      side = s;
+    }
+  }
+  return t_exit;
+}
+
+
+void MonteCarloSolver::trace_history(const Elem * elem, Point p, Point d, RandomStream & rng, std::vector<EnergyDeposit> & deposits) const
+{
+  // the 2D mesh has a depth of 1um in z direction.
+  double range = _length;
+
+  // safe guard for endless loop
+  for(unsigned int step=0; step<1000000 && range > 0.0 && elem; ++step)
+  {
+    unsigned int side;
+    const double t_exit = exit_distance(elem, p, d, side);
+    // numerical problem, i.e. the history is on a vertex
+    if( side == invalid_uint ) break;
+
+    const double l = std::min(std::min(t_exit, _step), range);
+
+    // energy loss with straggling
+    const double dE = _LET*_region_density[elem->subdomain_id()]*l*std::max(0.0, 1.0 + _straggling*rng.normal());
+    if(dE > 0.0)
+    {
+      EnergyDeposit deposit = { elem->id(), dE };
+      deposits.push_back(deposit);
+    }
+
+    p = p + l*d;
+    range -= l;
+
+    if( l == t_exit )
+    {
+      // enter the neighbor elem, NULL when the history leaves the mesh
+      elem = elem->neighbor(side);
+    }
+    else
+    {
+      // multiple scattering, rotate direction in xy plane
+      const double theta = _scatter*std::sqrt(l/um)*rng.normal();
+      const double c = std::cos(theta), s = std::sin(theta);
+      d = Point(c*d(0) - s*d(1), s*d(0) + c*d(1), 0.0);
+    }
+  }
+}
+
+
+void MonteCarloSolver::node_energy_density(std::vector<Point> & points, std::vector<double> & energy_density) const
+{
+  const MeshBase & mesh = _system.mesh();
+
+  // lump the elem energy to its nodes
+  std::vector<double> node_energy(mesh.max_node_id(), 0.0);
+  std::vector<double> node_volume(mesh.max_node_id(), 0.0);
+
+  MeshBase::const_element_iterator it = mesh.active_elements_begin();
+  MeshBase::const_element_iterator it_end = mesh.active_elements_end();
+  for(; it!=it_end; ++it)
+  {
+    const Elem * elem = *it;
+    // 2D elem has a depth of 1um
+    const double v = elem->volume()*1.0*um/elem->n_nodes();
+    const double e = _energy_in_elem[elem->id()]/elem->n_nodes();
+    for(unsigned int n=0; n<elem->n_nodes(); ++n)
+    {
+      node_energy[elem->node(n)] += e;
+      node_volume[elem->node(n)] += v;
+    }
+  }
+
+  points.clear();
+  energy_density.clear();
+  for(unsigned int n=0; n<node_energy.size(); ++n)
+  {
+    if( node_volume[n] == 0.0 ) continue;
+    points.push_back(mesh.point(n));
+    energy_density.push_back(node_energy[n]/node_volume[n]);
+  }
+}
+
@@ -613,41 +613,22 @@ PetscReal MixA1Solver::LTE_norm()
 
 void MixA1Solver::error_norm()
 {
-  PetscScalar    *xx;
-  PetscScalar    *ff;
+  // x and f norm of each variable
+  variable_error_norm(false);
+
+  if(Genius::is_last_processor())
+    spice_norm = _circuit->ckt_residual_norm2()*A;
+  Parallel::broadcast(spice_norm, Genius::last_processor_id());
+}
 
-  // scatte global solution vector x to local vector lx
-  // this is not necessary since it had already done in function evaluation
-  //VecScatterBegin(scatter, x, lx, INSERT_VALUES, SCATTER_FORWARD);
-  //VecScatterEnd  (scatter, x, lx, INSERT_VALUES, SCATTER_FORWARD);
-
-  // scatte global function vector f to local vector lf
-  VecScatterBegin(scatter, f, lf, INSERT_VALUES, SCATTER_FORWARD);
-  VecScatterEnd  (scatter, f, lf, INSERT_VALUES, SCATTER_FORWARD);
-
-
-  VecGetArray(lx, &xx);  // solution value
-  VecGetArray(lf, &ff);  // function value
-
-  // do clear
-  potential_norm        = 0;
-  electron_norm         = 0;
-  hole_norm             = 0;
-  temperature_norm      = 0;
-  elec_temperature_norm = 0;
-  hole_temperature_norm = 0;
-
-  poisson_norm              = 0;
-  elec_continuity_norm      = 0;
-  hole_continuity_norm      = 0;
-  heat_equation_norm        = 0;
-  elec_energy_equation_norm = 0;
-  hole_energy_equation_norm = 0;
-  electrode_norm            = 0;
 
+/*------------------------------------------------------------------
+ * the local offsets of each variable for error norm
+ */
+void MixA1Solver::build_norm_index()
+{
   for(unsigned int n=0; n<_system.n_regions(); n++)
   {
-    // only consider semiconductor region
     const SimulationRegion * region = _system.region(n);
 
     SimulationRegion::const_processor_node_iterator it = region->on_processor_nodes_begin();
@@ -655,77 +636,31 @@ void MixA1Solver::error_norm()
     for(; it!=it_end; ++it)
     {
       const FVM_Node * fvm_node = *it;
-
       unsigned int offset = fvm_node->local_offset();
 
       switch ( region->type() )
       {
           case SemiconductorRegion :
           {
-            potential_norm += xx[offset+0]*xx[offset+0];
-            electron_norm  += xx[offset+1]*xx[offset+1];
-            hole_norm      += xx[offset+2]*xx[offset+2];
-
-            poisson_norm         += ff[offset+0]*ff[offset+0];
-            elec_continuity_norm += ff[offset+1]*ff[offset+1];
-            hole_continuity_norm += ff[offset+2]*ff[offset+2];
+            norm_index[NormPotential].push_back(offset+0);
+            norm_index[NormElectron].push_back(offset+1);
+            norm_index[NormHole].push_back(offset+2);
             break;
           }
           case InsulatorRegion :
-          {
-            potential_norm += xx[offset]*xx[offset];
-            poisson_norm   += ff[offset]*ff[offset];
-            break;
-          }
           case ElectrodeRegion :
-          {
-            potential_norm += xx[offset]*xx[offset];
-            poisson_norm   += ff[offset]*ff[offset];
-            break;
-          }
           case MetalRegion :
           {
-            potential_norm += xx[offset]*xx[offset];
-            poisson_norm   += ff[offset]*ff[offset];
+            norm_index[NormPotential].push_back(offset);
             break;
           }
           case VacuumRegion:
           break;
-          default: genius_error(); //we should never reach here
+          default:
+          genius_error(); //we should never reach here
       }
     }
   }
-
-  if(Genius::is_last_processor())
-    spice_norm = _circuit->ckt_residual_norm2()*A;
-  Parallel::broadcast(spice_norm, Genius::last_processor_id());
-
-  // sum of variable value on all processors
-  std::vector<PetscScalar> norm_buffer;
-
-  norm_buffer.push_back(potential_norm);
-  norm_buffer.push_back(electron_norm);
-  norm_buffer.push_back(hole_norm);
-
-  norm_buffer.push_back(poisson_norm);
-  norm_buffer.push_back(elec_continuity_norm);
-  norm_buffer.push_back(hole_continuity_norm);
-
-  Parallel::sum(norm_buffer);
-
-  // sqrt to get L2 norm
-  potential_norm = sqrt(norm_buffer[0]);
-  electron_norm  = sqrt(norm_buffer[1]);
-  hole_norm      = sqrt(norm_buffer[2]);
-
-  poisson_norm         = sqrt(norm_buffer[3]);
-  elec_continuity_norm = sqrt(norm_buffer[4]);
-  hole_continuity_norm = sqrt(norm_buffer[5]);
-
-
-  VecRestoreArray(lx, &xx);
-  VecRestoreArray(lf, &ff);
-
 }
 
 
@@ -764,6 +699,7 @@ void MixA1Solver::build_petsc_sens_residual(Vec x, Vec r)
   // evaluate governing equations of DDML1 in all the regions
   for(unsigned int n=0; n<_system.n_regions(); n++)
   {
+    if( region_frozen(n) ) continue;
     SimulationRegion * region = _system.region(n);
     region->DDM1_Function(lxx, r, add_value_flag);
   }
@@ -873,6 +809,7 @@ void MixA1Solver::build_petsc_sens_jacobian(Vec x, Mat *, Mat *)
   // evaluate Jacobian matrix of governing equations of DDML1 in all the regions
   for(unsigned int n=0; n<_system.n_regions(); n++)
   {
+    if( region_frozen(n) ) continue;
     SimulationRegion * region = _system.region(n);
     region->DDM1_Jacobian(lxx, &J, add_value_flag);
   }
@@ -936,10 +873,8 @@ void MixA1Solver::build_petsc_sens_jacobian(Vec x, Mat *, Mat *)
     else
       bc->DDM1_Jacobian_Preprocess(lxx, &J, src_row, dst_row, clear_row);
   }
-  //add source rows to destination rows
-  PetscUtils::MatAddRowToRow(J, src_row, dst_row);
-  // clear row
-  PetscUtils::MatZeroRows(J, clear_row.size(), clear_row.empty() ? NULL : &clear_row[0], 0.0);
+  //add source rows to destination rows, and clear rows
+  PetscUtils::MatAddClearRow(J, src_row, dst_row, clear_row);
 
   add_value_flag = NOT_SET_VALUES;
   for(unsigned int b=0; b<_system.get_bcs()->n_bcs(); b++)
@@ -95,7 +95,7 @@ void GateContactBC::MixA_DDM1_Function(PetscScalar * x, Vec f, InsertMode &add_v
   std::vector<double> current_buffer;
 
   // for 2D mesh, z_width() is the device dimension in Z direction; for 3D mesh, z_width() is 1.0
-  PetscScalar current_scale = this->z_width()/A;
+  PetscScalar current_scale = this->z_width()*this->system().device_multiplicity()/A;
 
   const PetscScalar Work_Function = this->scalar("workfunction");
 
@@ -387,7 +387,7 @@ void GateContactBC::MixA_DDM1_Jacobian(PetscScalar * x, Mat *jac, InsertMode &ad
   // do gate boundary process here
 
   // for 2D mesh, z_width() is the device dimension in Z direction; for 3D mesh, z_width() is 1.0
-  PetscScalar current_scale = this->z_width()/A;
+  PetscScalar current_scale = this->z_width()*this->system().device_multiplicity()/A;
 
   const PetscScalar Work_Function = this->scalar("workfunction");
 
@@ -58,7 +58,7 @@ void OhmicContactBC::MixA_DDM1_Function_Preprocess(PetscScalar *, Vec f, std::ve
   this->_current_buffer.clear();
 
   // for 2D mesh, z_width() is the device dimension in Z direction; for 3D mesh, z_width() is 1.0
-  const PetscScalar current_scale = this->z_width()/A;
+  const PetscScalar current_scale = this->z_width()*this->system().device_multiplicity()/A;
 
   BoundaryCondition::const_node_iterator node_it = nodes_begin();
   BoundaryCondition::const_node_iterator end_it = nodes_end();
@@ -139,7 +139,7 @@ void OhmicContactBC::MixA_DDM1_Function(PetscScalar * x, Vec f, InsertMode &add_
   std::vector<PetscScalar> y;
 
   // for 2D mesh, z_width() is the device dimension in Z direction; for 3D mesh, z_width() is 1.0
-  PetscScalar current_scale = this->z_width()/A;
+  PetscScalar current_scale = this->z_width()*this->system().device_multiplicity()/A;
 
   // the electrode potential in current iteration
   PetscScalar Ve = x[ckt->local_offset_x(spice_node_index)];
@@ -485,7 +485,7 @@ void OhmicContactBC::MixA_DDM1_Jacobian_Preprocess(PetscScalar *, Mat *jac, std:
   _buffer_jacobian_entries.clear();
 
   // for 2D mesh, z_width() is the device dimension in Z direction; for 3D mesh, z_width() is 1.0
-  PetscScalar current_scale = this->z_width()/A;
+  PetscScalar current_scale = this->z_width()*this->system().device_multiplicity()/A;
 
   // search and process all the boundary nodes
   BoundaryCondition::const_node_iterator node_it;
@@ -621,7 +621,7 @@ void OhmicContactBC::MixA_DDM1_Jacobian(PetscScalar * x, Mat *jac, InsertMode &a
   PetscInt bc_global_offset = this->global_offset();
 
   // for 2D mesh, z_width() is the device dimension in Z direction; for 3D mesh, z_width() is 1.0
-  PetscScalar current_scale = this->z_width()/A;
+  PetscScalar current_scale = this->z_width()*this->system().device_multiplicity()/A;
 
   // d(current)/d(independent variables of bd node and its neighbors)
   for(unsigned int n=0; n<_buffer_cols.size(); ++n)
@@ -115,7 +115,7 @@ void SolderPadBC::MixA_DDM1_Function(PetscScalar * x, Vec f, InsertMode &add_val
   std::vector<double> current_buffer;
 
   // for 2D mesh, z_width() is the device dimension in Z direction; for 3D mesh, z_width() is 1.0
-  PetscScalar current_scale = this->z_width()/A;
+  PetscScalar current_scale = this->z_width()*this->system().device_multiplicity()/A;
 
   // the electrode potential in current iteration
   PetscScalar Ve = x[ckt->local_offset_x(spice_node_index)];
@@ -343,7 +343,7 @@ void SolderPadBC::MixA_DDM1_Jacobian(PetscScalar * x, Mat *jac, InsertMode &add_
   // after that, we should do gate boundary process here
 
   // for 2D mesh, z_width() is the device dimension in Z direction; for 3D mesh, z_width() is 1.0
-  PetscScalar current_scale = this->z_width()/A;
+  PetscScalar current_scale = this->z_width()*this->system().device_multiplicity()/A;
 
   const SimulationRegion * _r1 = bc_regions().first;
   const SimulationRegion * _r2 = bc_regions().second;
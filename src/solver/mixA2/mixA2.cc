@@ -638,41 +638,22 @@ PetscReal MixA2Solver::LTE_norm()
 
 void MixA2Solver::error_norm()
 {
-  PetscScalar    *xx;
-  PetscScalar    *ff;
+  // x and f norm of each variable
+  variable_error_norm(false);
+
+  if(Genius::is_last_processor())
+    spice_norm = _circuit->ckt_residual_norm2()*A;
+  Parallel::broadcast(spice_norm, Genius::last_processor_id());
+}
 
-  // scatte global solution vector x to local vector lx
-  // this is not necessary since it had already done in function evaluation
-  //VecScatterBegin(scatter, x, lx, INSERT_VALUES, SCATTER_FORWARD);
-  //VecScatterEnd  (scatter, x, lx, INSERT_VALUES, SCATTER_FORWARD);
-
-  // scatte global function vector f to local vector lf
-  VecScatterBegin(scatter, f, lf, INSERT_VALUES, SCATTER_FORWARD);
-  VecScatterEnd  (scatter, f, lf, INSERT_VALUES, SCATTER_FORWARD);
-
-
-  VecGetArray(lx, &xx);  // solution value
-  VecGetArray(lf, &ff);  // function value
-
-  // do clear
-  potential_norm        = 0;
-  electron_norm         = 0;
-  hole_norm             = 0;
-  temperature_norm      = 0;
-  elec_temperature_norm = 0;
-  hole_temperature_norm = 0;
-
-  poisson_norm              = 0;
-  elec_continuity_norm      = 0;
-  hole_continuity_norm      = 0;
-  heat_equation_norm        = 0;
-  elec_energy_equation_norm = 0;
-  hole_energy_equation_norm = 0;
-  electrode_norm            = 0;
 
+/*------------------------------------------------------------------
+ * the local offsets of each variable for error norm
+ */
+void MixA2Solver::build_norm_index()
+{
   for(unsigned int n=0; n<_system.n_regions(); n++)
   {
-    // only consider semiconductor region
     const SimulationRegion * region = _system.region(n);
 
     SimulationRegion::const_processor_node_iterator it = region->on_processor_nodes_begin();
@@ -680,77 +661,32 @@ void MixA2Solver::error_norm()
     for(; it!=it_end; ++it)
     {
       const FVM_Node * fvm_node = *it;
-
       unsigned int offset = fvm_node->local_offset();
 
       switch ( region->type() )
       {
           case SemiconductorRegion :
           {
-            potential_norm   += xx[offset+0]*xx[offset+0];
-            electron_norm    += xx[offset+1]*xx[offset+1];
-            hole_norm        += xx[offset+2]*xx[offset+2];
-            temperature_norm += xx[offset+3]*xx[offset+3];
-
-            poisson_norm         += ff[offset+0]*ff[offset+0];
-            elec_continuity_norm += ff[offset+1]*ff[offset+1];
-            hole_continuity_norm += ff[offset+2]*ff[offset+2];
-            heat_equation_norm   += ff[offset+3]*ff[offset+3];
+            norm_index[NormPotential].push_back(offset+0);
+            norm_index[NormElectron].push_back(offset+1);
+            norm_index[NormHole].push_back(offset+2);
+            norm_index[NormTemperature].push_back(offset+3);
             break;
           }
           case InsulatorRegion :
           case ElectrodeRegion :
-          case MetalRegion     :
+          case MetalRegion :
           {
-            potential_norm   += xx[offset]*xx[offset];
-            temperature_norm += xx[offset+1]*xx[offset+1];
-
-            poisson_norm        += ff[offset]*ff[offset];
-            heat_equation_norm  += ff[offset+1]*ff[offset+1];
+            norm_index[NormPotential].push_back(offset);
+            norm_index[NormTemperature].push_back(offset+1);
             break;
           }
-
           case VacuumRegion:
           break;
           default: genius_error();
       }
     }
   }
-
-  if(Genius::is_last_processor())
-    spice_norm = _circuit->ckt_residual_norm2()*A;
-  Parallel::broadcast(spice_norm, Genius::last_processor_id());
-
-  // sum of variable value on all processors
-  std::vector<PetscScalar> norm_buffer;
-
-  norm_buffer.push_back(potential_norm);
-  norm_buffer.push_back(electron_norm);
-  norm_buffer.push_back(hole_norm);
-  norm_buffer.push_back(temperature_norm);
-
-  norm_buffer.push_back(poisson_norm);
-  norm_buffer.push_back(elec_continuity_norm);
-  norm_buffer.push_back(hole_continuity_norm);
-  norm_buffer.push_back(heat_equation_norm);
-
-  Parallel::sum(norm_buffer);
-
-  // sqrt to get L2 norm
-  potential_norm   = sqrt(norm_buffer[0]);
-  electron_norm    = sqrt(norm_buffer[1]);
-  hole_norm        = sqrt(norm_buffer[2]);
-  temperature_norm = sqrt(norm_buffer[3]);
-
-  poisson_norm        = sqrt(norm_buffer[4]);
-  elec_continuity_norm = sqrt(norm_buffer[5]);
-  hole_continuity_norm = sqrt(norm_buffer[6]);
-  heat_equation_norm  = sqrt(norm_buffer[7]);
-
-
-  VecRestoreArray(lx, &xx);
-  VecRestoreArray(lf, &ff);
-
 }
 
 
@@ -789,6 +725,7 @@ void MixA2Solver::build_petsc_sens_residual(Vec x, Vec r)
   // evaluate governing equations of DDML2 in all the regions
   for(unsigned int n=0; n<_system.n_regions(); n++)
   {
+    if( region_frozen(n) ) continue;
     SimulationRegion * region = _system.region(n);
     region->DDM2_Function(lxx, r, add_value_flag);
   }
@@ -898,6 +835,7 @@ void MixA2Solver::build_petsc_sens_jacobian(Vec x, Mat *, Mat *)
   // evaluate Jacobian matrix of governing equations of DDML2 in all the regions
   for(unsigned int n=0; n<_system.n_regions(); n++)
   {
+    if( region_frozen(n) ) continue;
     SimulationRegion * region = _system.region(n);
     region->DDM2_Jacobian(lxx, &J, add_value_flag);
   }
@@ -965,10 +903,8 @@ void MixA2Solver::build_petsc_sens_jacobian(Vec x, Mat *, Mat *)
     else
       bc->DDM2_Jacobian_Preprocess(lxx, &J, src_row, dst_row, clear_row);
   }
-  //add source rows to destination rows
-  PetscUtils::MatAddRowToRow(J, src_row, dst_row);
-  // clear row
-  PetscUtils::MatZeroRows(J, clear_row.size(), clear_row.empty() ? NULL : &clear_row[0], 0.0);
+  //add source rows to destination rows, and clear rows
+  PetscUtils::MatAddClearRow(J, src_row, dst_row, clear_row);
   add_value_flag = NOT_SET_VALUES;
 
   for(unsigned int b=0; b<_system.get_bcs()->n_bcs(); b++)
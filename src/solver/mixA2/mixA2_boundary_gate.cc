@@ -126,7 +126,7 @@ void GateContactBC::MixA_DDM2_Function(PetscScalar * x, Vec f, InsertMode &add_v
   std::vector<double> current_buffer;
 
   // for 2D mesh, z_width() is the device dimension in Z direction; for 3D mesh, z_width() is 1.0
-  PetscScalar current_scale = this->z_width()/A;
+  PetscScalar current_scale = this->z_width()*this->system().device_multiplicity()/A;
 
   const PetscScalar Work_Function = this->scalar("workfunction");
   const PetscScalar Heat_Transfer = this->scalar("heat.transfer");
@@ -483,7 +483,7 @@ void GateContactBC::MixA_DDM2_Jacobian(PetscScalar * x, Mat *jac, InsertMode &ad
   // after that, we should do gate boundary process here
 
   // for 2D mesh, z_width() is the device dimension in Z direction; for 3D mesh, z_width() is 1.0
-  PetscScalar current_scale = this->z_width()/A;
+  PetscScalar current_scale = this->z_width()*this->system().device_multiplicity()/A;
 
   const PetscScalar Work_Function = this->scalar("workfunction");
   const PetscScalar Heat_Transfer = this->scalar("heat.transfer");
@@ -60,7 +60,7 @@ void OhmicContactBC::MixA_DDM2_Function_Preprocess(PetscScalar * ,Vec f, std::ve
   this->_current_buffer.clear();
 
   // for 2D mesh, z_width() is the device dimension in Z direction; for 3D mesh, z_width() is 1.0
-  const PetscScalar current_scale = this->z_width()/A;
+  const PetscScalar current_scale = this->z_width()*this->system().device_multiplicity()/A;
 
   BoundaryCondition::const_node_iterator node_it = nodes_begin();
   BoundaryCondition::const_node_iterator end_it = nodes_end();
@@ -150,7 +150,7 @@ void OhmicContactBC::MixA_DDM2_Function(PetscScalar * x, Vec f, InsertMode &add_
 
 
   // for 2D mesh, z_width() is the device dimension in Z direction; for 3D mesh, z_width() is 1.0
-  PetscScalar current_scale = this->z_width()/A;
+  PetscScalar current_scale = this->z_width()*this->system().device_multiplicity()/A;
 
   const PetscScalar Heat_Transfer = this->scalar("heat.transfer");
 
@@ -530,7 +530,7 @@ void OhmicContactBC::MixA_DDM2_Jacobian_Preprocess(PetscScalar *,Mat *jac, std::
   _buffer_jacobian_entries.clear();
 
   // for 2D mesh, z_width() is the device dimension in Z direction; for 3D mesh, z_width() is 1.0
-  PetscScalar current_scale = this->z_width()/A;
+  PetscScalar current_scale = this->z_width()*this->system().device_multiplicity()/A;
   PetscScalar dt = SolverSpecify::dt;
 
   // search and process all the boundary nodes
@@ -679,7 +679,7 @@ void OhmicContactBC::MixA_DDM2_Jacobian(PetscScalar * x, Mat *jac, InsertMode &a
   PetscInt bc_global_offset = this->global_offset();
 
   // for 2D mesh, z_width() is the device dimension in Z direction; for 3D mesh, z_width() is 1.0
-  PetscScalar current_scale = this->z_width()/A;
+  PetscScalar current_scale = this->z_width()*this->system().device_multiplicity()/A;
 
   const PetscScalar Heat_Transfer = this->scalar("heat.transfer");
 
@@ -117,7 +117,7 @@ void SolderPadBC::MixA_DDM2_Function(PetscScalar * x, Vec f, InsertMode &add_val
   std::vector<double> current_buffer;
 
   // for 2D mesh, z_width() is the device dimension in Z direction; for 3D mesh, z_width() is 1.0
-  PetscScalar current_scale = this->z_width()/A;
+  PetscScalar current_scale = this->z_width()*this->system().device_multiplicity()/A;
 
   const PetscScalar Heat_Transfer = this->scalar("heat.transfer");
 
@@ -352,7 +352,7 @@ void SolderPadBC::MixA_DDM2_Jacobian(PetscScalar * x, Mat *jac, InsertMode &add_
 
 
   // for 2D mesh, z_width() is the device dimension in Z direction; for 3D mesh, z_width() is 1.0
-  PetscScalar current_scale = this->z_width()/A;
+  PetscScalar current_scale = this->z_width()*this->system().device_multiplicity()/A;
 
   const PetscScalar Heat_Transfer = this->scalar("heat.transfer");
 
@@ -751,41 +751,22 @@ PetscReal MixA3Solver::LTE_norm()
 
 void MixA3Solver::error_norm()
 {
-  PetscScalar    *xx;
-  PetscScalar    *ff;
+  // x and f norm of each variable
+  variable_error_norm(false);
 
-  // scatte global solution vector x to local vector lx
-  // this is not necessary since it had already done in function evaluation
-  //VecScatterBegin(scatter, x, lx, INSERT_VALUES, SCATTER_FORWARD);
-  //VecScatterEnd  (scatter, x, lx, INSERT_VALUES, SCATTER_FORWARD);
-
-  // scatte global function vector f to local vector lf
-  VecScatterBegin(scatter, f, lf, INSERT_VALUES, SCATTER_FORWARD);
-  VecScatterEnd  (scatter, f, lf, INSERT_VALUES, SCATTER_FORWARD);
-
-
-  VecGetArray(lx, &xx);  // solution value
-  VecGetArray(lf, &ff);  // function value
-
-  // do clear
-  potential_norm        = 0;
-  electron_norm         = 0;
-  hole_norm             = 0;
-  temperature_norm      = 0;
-  elec_temperature_norm = 0;
-  hole_temperature_norm = 0;
-
-  poisson_norm              = 0;
-  elec_continuity_norm       = 0;
-  hole_continuity_norm       = 0;
-  heat_equation_norm        = 0;
-  elec_energy_equation_norm = 0;
-  hole_energy_equation_norm = 0;
-  electrode_norm            = 0;
+  if(Genius::is_last_processor())
+    spice_norm = _circuit->ckt_residual_norm2()*A;
+  Parallel::broadcast(spice_norm, Genius::last_processor_id());
+}
 
+
+/*------------------------------------------------------------------
+ * the local offsets of each variable for error norm
+ */
+void MixA3Solver::build_norm_index()
+{
   for(unsigned int n=0; n<_system.n_regions(); n++)
   {
-    // only consider semiconductor region
     const SimulationRegion * region = _system.region(n);
 
     switch ( region->type() )
@@ -804,33 +785,28 @@ void MixA3Solver::error_norm()
           for(; it!=it_end; ++it)
           {
             const FVM_Node * fvm_node = *it;
-
             unsigned int offset = fvm_node->local_offset();
 
-            potential_norm   += xx[offset+node_psi_offset]*xx[offset+node_psi_offset];
-            electron_norm    += xx[offset+node_n_offset]*xx[offset+node_n_offset];
-            hole_norm        += xx[offset+node_p_offset]*xx[offset+node_p_offset];
-
-            poisson_norm        += ff[offset+node_psi_offset]*ff[offset+node_psi_offset];
-            elec_continuity_norm += ff[offset+node_n_offset]*ff[offset+node_n_offset];
-            hole_continuity_norm += ff[offset+node_p_offset]*ff[offset+node_p_offset];
+            norm_index[NormPotential].push_back(offset+node_psi_offset);
+            norm_index[NormElectron].push_back(offset+node_n_offset);
+            norm_index[NormHole].push_back(offset+node_p_offset);
 
             if(region->get_advanced_model()->enable_Tl())
             {
-              temperature_norm    += xx[offset+node_Tl_offset]*xx[offset+node_Tl_offset];
-              heat_equation_norm  += ff[offset+node_Tl_offset]*ff[offset+node_Tl_offset];
+              norm_index[NormTemperature].push_back(offset+node_Tl_offset);
             }
 
+            // the x norm of carrier temperature is taken over Tn = (n*Tn)/n
             if(region->get_advanced_model()->enable_Tn())
             {
-              elec_temperature_norm      += xx[offset+node_Tn_offset]/xx[offset+node_n_offset]*xx[offset+node_Tn_offset]/xx[offset+node_n_offset];
-              elec_energy_equation_norm  += ff[offset+node_Tn_offset]*ff[offset+node_Tn_offset];
+              norm_index[NormElecTemperature].push_back(offset+node_Tn_offset);
+              norm_divisor[NormElecTemperature].push_back(offset+node_n_offset);
             }
 
             if(region->get_advanced_model()->enable_Tp())
             {
-              hole_temperature_norm      += xx[offset+node_Tp_offset]/xx[offset+node_p_offset]*xx[offset+node_Tp_offset]/xx[offset+node_p_offset];
-              hole_energy_equation_norm  += ff[offset+node_Tp_offset]*ff[offset+node_Tp_offset];
+              norm_index[NormHoleTemperature].push_back(offset+node_Tp_offset);
+              norm_divisor[NormHoleTemperature].push_back(offset+node_p_offset);
             }
           }
           break;
@@ -847,15 +823,12 @@ void MixA3Solver::error_norm()
           for(; it!=it_end; ++it)
           {
             const FVM_Node * fvm_node = *it;
-
             unsigned int offset = fvm_node->local_offset();
-            potential_norm   += xx[offset+node_psi_offset]*xx[offset+node_psi_offset];
-            poisson_norm     += ff[offset+node_psi_offset]*ff[offset+node_psi_offset];
 
+            norm_index[NormPotential].push_back(offset+node_psi_offset);
             if(region->get_advanced_model()->enable_Tl())
             {
-              temperature_norm    += xx[offset+node_Tl_offset]*xx[offset+node_Tl_offset];
-              heat_equation_norm  += ff[offset+node_Tl_offset]*ff[offset+node_Tl_offset];
+              norm_index[NormTemperature].push_back(offset+node_Tl_offset);
             }
           }
           break;
@@ -865,51 +838,6 @@ void MixA3Solver::error_norm()
         default: genius_error();
     }
   }
-
-
-  if(Genius::is_last_processor())
-    spice_norm = _circuit->ckt_residual_norm2()*A;
-  Parallel::broadcast(spice_norm, Genius::last_processor_id());
-
-  // sum of variable value on all processors
-  std::vector<PetscScalar> norm_buffer;
-
-  norm_buffer.push_back(potential_norm);
-  norm_buffer.push_back(electron_norm);
-  norm_buffer.push_back(hole_norm);
-  norm_buffer.push_back(temperature_norm);
-  norm_buffer.push_back(elec_temperature_norm);
-  norm_buffer.push_back(hole_temperature_norm);
-
-  norm_buffer.push_back(poisson_norm);
-  norm_buffer.push_back(elec_continuity_norm);
-  norm_buffer.push_back(hole_continuity_norm);
-  norm_buffer.push_back(heat_equation_norm);
-  norm_buffer.push_back(elec_energy_equation_norm);
-  norm_buffer.push_back(hole_energy_equation_norm);
-
-  Parallel::sum(norm_buffer);
-
-
-  // sqrt to get L2 norm
-  potential_norm        = sqrt(norm_buffer[0]);
-  electron_norm         = sqrt(norm_buffer[1]);
-  hole_norm             = sqrt(norm_buffer[2]);
-  temperature_norm      = sqrt(norm_buffer[3]);
-  elec_temperature_norm = sqrt(norm_buffer[4]);
-  hole_temperature_norm = sqrt(norm_buffer[5]);
-
-  poisson_norm              = sqrt(norm_buffer[6]);
-  elec_continuity_norm      = sqrt(norm_buffer[7]);
-  hole_continuity_norm      = sqrt(norm_buffer[8]);
-  heat_equation_norm        = sqrt(norm_buffer[9]);
-  elec_energy_equation_norm = sqrt(norm_buffer[10]);
-  hole_energy_equation_norm = sqrt(norm_buffer[11]);
-
-
-  VecRestoreArray(lx, &xx);
-  VecRestoreArray(lf, &ff);
-
 }
 
 
@@ -948,6 +876,7 @@ void MixA3Solver::build_petsc_sens_residual(Vec x, Vec r)
   // evaluate governing equations of DDML1 in all the regions
   for(unsigned int n=0; n<_system.n_regions(); n++)
   {
+    if( region_frozen(n) ) continue;
     SimulationRegion * region = _system.region(n);
     region->EBM3_Function(lxx, r, add_value_flag);
   }
@@ -1056,6 +985,7 @@ void MixA3Solver::build_petsc_sens_jacobian(Vec x, Mat *, Mat *)
   // evaluate Jacobian matrix of governing equations of DDML1 in all the regions
   for(unsigned int n=0; n<_system.n_regions(); n++)
   {
+    if( region_frozen(n) ) continue;
     SimulationRegion * region = _system.region(n);
     region->EBM3_Jacobian(lxx, &J, add_value_flag);
   }
@@ -1123,10 +1053,8 @@ void MixA3Solver::build_petsc_sens_jacobian(Vec x, Mat *, Mat *)
     else
       bc->EBM3_Jacobian_Preprocess(lxx, &J, src_row, dst_row, clear_row);
   }
-  //add source rows to destination rows
-  PetscUtils::MatAddRowToRow(J, src_row, dst_row);
-  // clear row
-  PetscUtils::MatZeroRows(J, clear_row.size(), clear_row.empty() ? NULL : &clear_row[0], 0.0);
+  //add source rows to destination rows, and clear rows
+  PetscUtils::MatAddClearRow(J, src_row, dst_row, clear_row);
   add_value_flag = NOT_SET_VALUES;
 
   for(unsigned int b=0; b<_system.get_bcs()->n_bcs(); b++)
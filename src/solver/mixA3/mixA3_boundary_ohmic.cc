@@ -58,7 +58,7 @@ void OhmicContactBC::MixA_EBM3_Function_Preprocess(PetscScalar *,Vec f, std::vec
   this->_current_buffer.clear();
 
   // for 2D mesh, z_width() is the device dimension in Z direction; for 3D mesh, z_width() is 1.0
-  const PetscScalar current_scale = this->z_width();
+  const PetscScalar current_scale = this->z_width()*this->system().device_multiplicity();
 
   BoundaryCondition::const_node_iterator node_it = nodes_begin();
   BoundaryCondition::const_node_iterator end_it = nodes_end();
@@ -158,7 +158,7 @@ void OhmicContactBC::MixA_EBM3_Function(PetscScalar * x, Vec f, InsertMode &add_
   std::vector<PetscScalar> & current_buffer = this->_current_buffer;
 
   // for 2D mesh, z_width() is the device dimension in Z direction; for 3D mesh, z_width() is 1.0
-  PetscScalar current_scale = this->z_width()/A;
+  PetscScalar current_scale = this->z_width()*this->system().device_multiplicity()/A;
 
   const PetscScalar Heat_Transfer = this->scalar("heat.transfer");
 
@@ -571,7 +571,7 @@ void OhmicContactBC::MixA_EBM3_Jacobian_Preprocess(PetscScalar * ,Mat *jac, std:
   _buffer_jacobian_entries.clear();
 
   // for 2D mesh, z_width() is the device dimension in Z direction; for 3D mesh, z_width() is 1.0
-  PetscScalar current_scale = this->z_width();
+  PetscScalar current_scale = this->z_width()*this->system().device_multiplicity();
   PetscScalar dt = SolverSpecify::dt;
 
   // search and process all the boundary nodes
@@ -730,7 +730,7 @@ void OhmicContactBC::MixA_EBM3_Jacobian(PetscScalar * x, Mat *jac, InsertMode &a
   PetscInt bc_global_offset = this->global_offset();
 
   // for 2D mesh, z_width() is the device dimension in Z direction; for 3D mesh, z_width() is 1.0
-  PetscScalar current_scale = this->z_width()/A;
+  PetscScalar current_scale = this->z_width()*this->system().device_multiplicity()/A;
 
   const PetscScalar Heat_Transfer = this->scalar("heat.transfer");
 
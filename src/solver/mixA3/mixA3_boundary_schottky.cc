@@ -126,7 +126,7 @@ void SchottkyContactBC::MixA_EBM3_Function(PetscScalar * x, Vec f, InsertMode &a
   std::vector<PetscScalar> y;
 
   // for 2D mesh, z_width() is the device dimension in Z direction; for 3D mesh, z_width() is 1.0
-  PetscScalar current_scale = this->z_width()/A;
+  PetscScalar current_scale = this->z_width()*this->system().device_multiplicity()/A;
   std::vector<double> current_buffer;
 
   const PetscScalar Work_Function = this->scalar("workfunction");
@@ -596,7 +596,7 @@ void SchottkyContactBC::MixA_EBM3_Jacobian(PetscScalar * x, Mat *jac, InsertMode
 
 
   // for 2D mesh, z_width() is the device dimension in Z direction; for 3D mesh, z_width() is 1.0
-  PetscScalar current_scale = this->z_width()/A;
+  PetscScalar current_scale = this->z_width()*this->system().device_multiplicity()/A;
 
   const PetscScalar Work_Function = this->scalar("workfunction");
   const PetscScalar Heat_Transfer = this->scalar("heat.transfer");
@@ -24,6 +24,7 @@
 
 
 #include "poisson/poisson.h"
+#include "mesh_base.h"
 #include "solver_specify.h"
 #include "electrical_source.h"
 #include "parallel.h"
@@ -47,6 +48,17 @@ int PoissonSolver::create_solver()
   set_linear_solver_type    ( SolverSpecify::LS );
   set_preconditioner_type   ( SolverSpecify::PC );
 
+  // newton-AMG, the direct solver of poisson's equation is expensive for 3D mesh
+  if( SolverSpecify::PoissonAMG )
+  {
+    set_linear_solver_type  ( SolverSpecify::GMRES );
+#ifdef PETSC_HAVE_LIBHYPRE
+    set_preconditioner_type ( SolverSpecify::BOOMERAMG_PRECOND );
+#else
+    set_preconditioner_type ( SolverSpecify::GAMG_PRECOND );
+#endif
+  }
+
   // must set nonlinear matrix/vector here!
   setup_nonlinear_data();
 
@@ -59,6 +71,9 @@ int PoissonSolver::create_solver()
   // abstol = 1e-20*n_global_dofs  - the absolute convergence tolerance (absolute size of the residual norm)
   KSPSetTolerances(ksp, 1e-12*n_global_dofs, 1e-20*n_global_dofs, PETSC_DEFAULT, std::max(50, static_cast<int>(n_global_dofs/10)) );
 
+  if( SolverSpecify::PoissonAMG )
+    set_petsc_amg_options();
+
   // user can do further adjusment from command line
   SNESSetFromOptions (snes);
 
@@ -71,6 +86,35 @@ int PoissonSolver::create_solver()
 
 
 
+/*------------------------------------------------------------------
+ * tune AMG for the poisson jacobian: one dof per node, the edge couplings are
+ * the FVM stencil and the charge term only adds to diagonal
+ */
+void PoissonSolver::set_petsc_amg_options()
+{
+  const unsigned int dim = _system.mesh().mesh_dimension();
+
+#ifdef PETSC_HAVE_LIBHYPRE
+  // HMIS coarsening with ext+i interpolation keeps the operator complexity low for 3D mesh,
+  // where the stencil is larger and a higher strong threshold is preferred
+  set_petsc_option("-pc_hypre_boomeramg_strong_threshold", dim==3 ? "0.5" : "0.25");
+  set_petsc_option("-pc_hypre_boomeramg_coarsen_type", "HMIS");
+  set_petsc_option("-pc_hypre_boomeramg_interp_type", "ext+i");
+  set_petsc_option("-pc_hypre_boomeramg_P_max", "4");
+  if( dim==3 )
+    set_petsc_option("-pc_hypre_boomeramg_agg_nl", "1");
+#else
+  // the jacobian is not symmetric after row scaling, build the aggregates on symmetrized graph
+  set_petsc_option("-pc_gamg_sym_graph", "true");
+  set_petsc_option("-pc_gamg_threshold", dim==3 ? "0.05" : "0.02");
+#endif
+
+  // the linear solve only needs to follow the convergence of Newton iteration
+  SNESKSPSetUseEW(snes, PETSC_TRUE);
+}
+
+
+
 /*------------------------------------------------------------------
  * set initial value to solution vector and scaling vector
  */
@@ -112,7 +156,8 @@ int PoissonSolver::solve()
   START_LOG("solve()", "PoissonSolver");
 
   // set each electrode with external stimulate. transient 0 value is used here
-  _system.get_electrical_source()->update(0);
+  // unless poisson's equation is solved as part of a time dependent problem
+  _system.get_electrical_source()->update(SolverSpecify::TimeDependent ? SolverSpecify::clock : 0);
 
   // call pre_solve_process
   pre_solve_process();
@@ -125,6 +170,7 @@ int PoissonSolver::solve()
   SNESGetConvergedReason(snes, &reason);
 
   // print convergence/divergence reason
+  if(_verbose)
   {
     MESSAGE
     <<"----------------------------------------------------------------------\n"
@@ -352,10 +398,8 @@ void PoissonSolver::build_petsc_sens_jacobian(Vec x, Mat *, Mat *)
     BoundaryCondition * bc = _system.get_bcs()->get_bc(b);
     bc->Poissin_Jacobian_Preprocess(lxx, &J, src_row, dst_row, clear_row);
   }
-  //add source rows to destination rows
-  PetscUtils::MatAddRowToRow(J, src_row, dst_row);
-  // clear row
-  PetscUtils::MatZeroRows(J, clear_row.size(), clear_row.empty() ? NULL : &clear_row[0], 0.0);
+  //add source rows to destination rows, and clear rows
+  PetscUtils::MatAddClearRow(J, src_row, dst_row, clear_row);
 
   add_value_flag = NOT_SET_VALUES;
   for(unsigned int b=0; b<_system.get_bcs()->n_bcs(); b++)
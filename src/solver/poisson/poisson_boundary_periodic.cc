@@ -0,0 +1,91 @@
+/********************************************************************************/
+/*     888888    888888888   88     888  88888   888      888    88888888       */
+/*   8       8   8           8 8     8     8      8        8    8               */
+/*  8            8           8  8    8     8      8        8    8               */
+/*  8            888888888   8   8   8     8      8        8     8888888        */
+/*  8      8888  8           8    8  8     8      8        8            8       */
+/*   8       8   8           8     8 8     8      8        8            8       */
+/*     888888    888888888  888     88   88888     88888888     88888888        */
+/*                                                                              */
+/*       A Three-Dimensional General Purpose Semiconductor Simulator.           */
+/*                                                                              */
+/*                                                                              */
+/*  Copyright (C) 2007-2008                                                     */
+/*  Cogenda Pte Ltd                                                             */
+/*                                                                              */
+/*  Please contact Cogenda Pte Ltd for license information                      */
+/*                                                                              */
+/*  Author: Gong Ding   gdiso@ustc.edu                                          */
+/*                                                                              */
+/********************************************************************************/
+
+
+
+#include "simulation_system.h"
+#include "simulation_region.h"
+#include "boundary_condition_periodic.h"
+
+
+// the dofs of node pair in poisson solver
+static unsigned int poisson_periodic_dofs(const SimulationRegion * region)
+{
+  switch(region->type())
+  {
+    case SemiconductorRegion :
+    case InsulatorRegion     :
+    case ElectrodeRegion     :
+    case MetalRegion         : return 1;
+    default : return 0;
+  }
+}
+
+
+///////////////////////////////////////////////////////////////////////
+//----------------Function and Jacobian evaluate---------------------//
+///////////////////////////////////////////////////////////////////////
+
+/*---------------------------------------------------------------------
+ * do pre-process to function for poisson solver
+ */
+void PeriodicBC::Poissin_Function_Preprocess(PetscScalar *, Vec, std::vector<PetscInt> &src_row,
+                                             std::vector<PetscInt> &dst_row, std::vector<PetscInt> &clear_row)
+{
+  _periodic_preprocess(poisson_periodic_dofs, src_row, dst_row, clear_row);
+}
+
+
+/*---------------------------------------------------------------------
+ * build function and its jacobian for poisson solver
+ */
+void PeriodicBC::Poissin_Function(PetscScalar * x, Vec f, InsertMode &add_value_flag)
+{
+  _periodic_function(poisson_periodic_dofs, x, f, add_value_flag);
+}
+
+
+/*---------------------------------------------------------------------
+ * reserve non zero pattern in jacobian matrix for poisson solver
+ */
+void PeriodicBC::Poissin_Jacobian_Reserve(Mat *jac, InsertMode &add_value_flag)
+{
+  _periodic_jacobian_reserve(poisson_periodic_dofs, jac, add_value_flag);
+}
+
+
+/*---------------------------------------------------------------------
+ * do pre-process to jacobian matrix for poisson solver
+ */
+void PeriodicBC::Poissin_Jacobian_Preprocess(PetscScalar *, Mat *, std::vector<PetscInt> &src_row,
+                                             std::vector<PetscInt> &dst_row, std::vector<PetscInt> &clear_row)
+{
+  _periodic_preprocess(poisson_periodic_dofs, src_row, dst_row, clear_row);
+}
+
+
+/*---------------------------------------------------------------------
+ * build function and its jacobian for poisson solver
+ */
+void PeriodicBC::Poissin_Jacobian(PetscScalar * , Mat *jac, InsertMode &add_value_flag)
+{
+  _periodic_jacobian(poisson_periodic_dofs, jac, add_value_flag);
+}
@@ -93,6 +93,7 @@ void ElectrodeSimulationRegion::Poissin_Function(PetscScalar * x, Vec f, InsertM
   {
     // fvm_node of node1
     const FVM_Node * fvm_n1 = (*it).first;
+    const unsigned int edge_index = it - edges_begin();
     // fvm_node of node2
     const FVM_Node * fvm_n2 = (*it).second;
 
@@ -116,7 +117,7 @@ void ElectrodeSimulationRegion::Poissin_Function(PetscScalar * x, Vec f, InsertM
       PetscScalar eps = 0.5*(eps1+eps2);
 
       // "flux" from node 2 to node 1
-      PetscScalar f =  eps*fvm_n1->cv_surface_area(fvm_n2)*(V2 - V1)/fvm_n1->distance(fvm_n2) ;
+      PetscScalar f =  eps*this->edge_cv_surface_area(edge_index)*(V2 - V1)/this->edge_length(edge_index) ;
 
       // ignore thoese ghost nodes
       if( fvm_n1->on_processor() )
@@ -173,6 +174,7 @@ void ElectrodeSimulationRegion::Poissin_Jacobian(PetscScalar * x, Mat *jac, Inse
   {
     // fvm_node of node1
     const FVM_Node * fvm_n1 = (*it).first;
+    const unsigned int edge_index = it - edges_begin();
     // fvm_node of node2
     const FVM_Node * fvm_n2 = (*it).second;
 
@@ -201,7 +203,7 @@ void ElectrodeSimulationRegion::Poissin_Jacobian(PetscScalar * x, Mat *jac, Inse
 
       PetscScalar eps = 0.5*(eps1+eps2);
 
-      AutoDScalar f =  eps*fvm_n1->cv_surface_area(fvm_n2)*(V2 - V1)/fvm_n1->distance(fvm_n2) ;
+      AutoDScalar f =  eps*this->edge_cv_surface_area(edge_index)*(V2 - V1)/this->edge_length(edge_index) ;
 
       // ignore thoese ghost nodes
       if( fvm_n1->on_processor() )
@@ -443,14 +445,6 @@ void ElectrodeSimulationRegion::Poissin_Update_Solution(PetscScalar *lxx)
     //update psi
     node_data->psi() = lxx[fvm_node->local_offset()];
   }
-
-  // addtional work: compute electrical field for all the node.
-  // however, the electrical field is always zero. We needn't do anything here.
-  for(unsigned int n=0; n<n_cell(); ++n)
-  {
-    FVM_CellData * elem_data = this->get_region_elem_data(n);
-    elem_data->E()  = VectorValue<PetscScalar>(0.0, 0.0, 0.0);
-  }
 }
 
 
@@ -100,6 +100,7 @@ void MetalSimulationRegion::Poissin_Function(PetscScalar * x, Vec f, InsertMode
   {
     // fvm_node of node1
     const FVM_Node * fvm_n1 = (*it).first;
+    const unsigned int edge_index = it - edges_begin();
     // fvm_node of node2
     const FVM_Node * fvm_n2 = (*it).second;
 
@@ -123,7 +124,7 @@ void MetalSimulationRegion::Poissin_Function(PetscScalar * x, Vec f, InsertMode
       PetscScalar eps = 0.5*(eps1+eps2);
 
       // "flux" from node 2 to node 1
-      PetscScalar f =  sigma*fvm_n1->cv_surface_area(fvm_n2)*(V2 - V1)/fvm_n1->distance(fvm_n2) ;
+      PetscScalar f =  sigma*this->edge_cv_surface_area(edge_index)*(V2 - V1)/this->edge_length(edge_index) ;
 
       // ignore thoese ghost nodes
       if( fvm_n1->on_processor() )
@@ -184,6 +185,7 @@ void MetalSimulationRegion::Poissin_Jacobian(PetscScalar * x, Mat *jac, InsertMo
   {
     // fvm_node of node1
     const FVM_Node * fvm_n1 = (*it).first;
+    const unsigned int edge_index = it - edges_begin();
     // fvm_node of node2
     const FVM_Node * fvm_n2 = (*it).second;
 
@@ -212,7 +214,7 @@ void MetalSimulationRegion::Poissin_Jacobian(PetscScalar * x, Mat *jac, InsertMo
 
       PetscScalar eps = 0.5*(eps1+eps2);
 
-      AutoDScalar f =  sigma*fvm_n1->cv_surface_area(fvm_n2)*(V2 - V1)/fvm_n1->distance(fvm_n2) ;
+      AutoDScalar f =  sigma*this->edge_cv_surface_area(edge_index)*(V2 - V1)/this->edge_length(edge_index) ;
 
       // ignore thoese ghost nodes
       if( fvm_n1->on_processor() )
@@ -446,13 +448,6 @@ void MetalSimulationRegion::Poissin_Update_Solution(PetscScalar *lxx)
     node_data->psi() = lxx[fvm_node->local_offset()];
   }
 
-  // the electrical field is always zero here.
-  for(unsigned int n=0; n<n_cell(); ++n)
-  {
-    FVM_CellData * elem_data = this->get_region_elem_data(n);
-    elem_data->E()  = VectorValue<PetscScalar>(0.0, 0.0, 0.0);
-  }
-
 }
 
 
@@ -24,6 +24,7 @@
 #include "elem.h"
 #include "simulation_system.h"
 #include "semiconductor_region.h"
+#include "solver_specify.h"
 
 using PhysicalUnit::cm;
 using PhysicalUnit::kb;
@@ -110,6 +111,7 @@ void SemiconductorSimulationRegion::Poissin_Function(PetscScalar * x, Vec f, Ins
   {
     // fvm_node of node1
     const FVM_Node * fvm_n1 = (*it).first;
+    const unsigned int edge_index = it - edges_begin();
     // fvm_node of node2
     const FVM_Node * fvm_n2 = (*it).second;
 
@@ -133,7 +135,7 @@ void SemiconductorSimulationRegion::Poissin_Function(PetscScalar * x, Vec f, Ins
       PetscScalar eps = 0.5*(eps1+eps2);
 
       // "flux" from node 2 to node 1
-      PetscScalar f =  eps*fvm_n1->cv_surface_area(fvm_n2)*(V2 - V1)/fvm_n1->distance(fvm_n2) ;
+      PetscScalar f =  eps*this->edge_cv_surface_area(edge_index)*(V2 - V1)/this->edge_length(edge_index) ;
 
       // ignore thoese ghost nodes
       if( fvm_n1->on_processor() )
@@ -173,6 +175,13 @@ void SemiconductorSimulationRegion::Poissin_Function(PetscScalar * x, Vec f, Ins
     PetscScalar n   =  ni*exp( e/(kb*T)*V_i);
     // approx hole density
     PetscScalar p   =  ni*exp(-e/(kb*T)*V_i);
+
+    // gummel and half implicit method, quasi-Fermi potential is frozen, carrier follows the potential update
+    if( SolverSpecify::Solver == SolverSpecify::GUMMEL || SolverSpecify::Solver == SolverSpecify::HALF_IMPLICIT )
+    {
+      n = fvm_node_data->n()*exp( e/(kb*T)*(V - fvm_node_data->psi()));
+      p = fvm_node_data->p()*exp(-e/(kb*T)*(V - fvm_node_data->psi()));
+    }
 #if 0
     // bandgap narrowing
     PetscScalar dEg =  mt->band->EgNarrow(p, n, T);
@@ -242,6 +251,7 @@ void SemiconductorSimulationRegion::Poissin_Jacobian(PetscScalar * x, Mat *jac,
   {
     // fvm_node of node1
     const FVM_Node * fvm_n1 = (*it).first;
+    const unsigned int edge_index = it - edges_begin();
     // fvm_node of node2
     const FVM_Node * fvm_n2 = (*it).second;
 
@@ -270,7 +280,7 @@ void SemiconductorSimulationRegion::Poissin_Jacobian(PetscScalar * x, Mat *jac,
 
       PetscScalar eps = 0.5*(eps1+eps2);
 
-      AutoDScalar f =  eps*fvm_n1->cv_surface_area(fvm_n2)*(V2 - V1)/fvm_n1->distance(fvm_n2) ;
+      AutoDScalar f =  eps*this->edge_cv_surface_area(edge_index)*(V2 - V1)/this->edge_length(edge_index) ;
 
       // ignore thoese ghost nodes
       if( fvm_n1->on_processor() )
@@ -316,6 +326,13 @@ void SemiconductorSimulationRegion::Poissin_Jacobian(PetscScalar * x, Mat *jac,
     // hole density
     AutoDScalar p   =  ni*exp(-e/(kb*T)*V_i);
 
+    // gummel and half implicit method, quasi-Fermi potential is frozen, carrier follows the potential update
+    if( SolverSpecify::Solver == SolverSpecify::GUMMEL || SolverSpecify::Solver == SolverSpecify::HALF_IMPLICIT )
+    {
+      n = fvm_node_data->n()*exp( e/(kb*T)*(V - fvm_node_data->psi()));
+      p = fvm_node_data->p()*exp(-e/(kb*T)*(V - fvm_node_data->psi()));
+    }
+
 #if 0
     // bandgap narrowing
     AutoDScalar dEg =  mt->band->EgNarrow(p, n, T);
@@ -661,10 +678,21 @@ void SemiconductorSimulationRegion::Poissin_Update_Solution(PetscScalar *lxx)
       // hole density
       PetscScalar p    =  ni*exp(-e/(kb*T)*V_i);
 
-      // consider bandgap narrow
-      PetscScalar dEg = mt->band->EgNarrow(p, n, T);
-      node_data->n()   =  n*exp(dEg);
-      node_data->p()   =  p*exp(dEg);
+      if( SolverSpecify::Solver == SolverSpecify::GUMMEL || SolverSpecify::Solver == SolverSpecify::HALF_IMPLICIT )
+      {
+        // gummel and half implicit method, carriers follow the potential update with frozen quasi-Fermi potential
+        n = node_data->n()*exp( e/(kb*T)*(V - node_data->psi()));
+        p = node_data->p()*exp(-e/(kb*T)*(V - node_data->psi()));
+        node_data->n()   =  n;
+        node_data->p()   =  p;
+      }
+      else
+      {
+        // consider bandgap narrow
+        PetscScalar dEg = mt->band->EgNarrow(p, n, T);
+        node_data->n()   =  n*exp(dEg);
+        node_data->p()   =  p*exp(dEg);
+      }
 
       //update psi
       PetscScalar Eg = mt->band->Eg(T);
@@ -678,26 +706,6 @@ void SemiconductorSimulationRegion::Poissin_Update_Solution(PetscScalar *lxx)
     }
   }
 
-  // addtional work: compute electrical field for all the node.
-  // Since this value is only used for reference.
-  // It can be done simply by weighted average of cell's electrical field
-  for(unsigned int n=0; n<n_cell(); ++n)
-  {
-    const Elem * elem = this->get_region_elem(n);
-    FVM_CellData * elem_data = this->get_region_elem_data(n);
-
-    std::vector<PetscScalar> psi_vertex;
-
-    for(unsigned int nd=0; nd<elem->n_nodes(); ++nd)
-    {
-      const FVM_Node * fvm_node = elem->get_fvm_node(nd);
-      const FVM_NodeData * fvm_node_data = fvm_node->node_data();
-      psi_vertex.push_back  ( fvm_node_data->psi() );
-    }
-    // compute the gradient in the cell
-    elem_data->E()  = - elem->gradient(psi_vertex);  // E = - grad(psi)
-  }
-
 }
 
 
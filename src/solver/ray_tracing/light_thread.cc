@@ -21,6 +21,7 @@
 
 
 #include <cmath>
+#include <vector>
 #include <algorithm>
 
 #include "plane.h"
@@ -35,6 +36,77 @@ using PhysicalUnit::mu0;
 double LightThread::dead_factor = 1e-3;
 
 
+// the pool of LightThread objects.
+// the memory is allocated by chunk, and the free blocks of each thread form a single linked list.
+// the generation is increased by release_pool(), the free list of old generation is dropped.
+struct LightThreadPoolBlock { LightThreadPoolBlock * next; };
+
+static const unsigned int light_thread_pool_chunk_size = 256;
+static std::vector<void *> light_thread_pool_chunks;
+static unsigned int light_thread_pool_generation = 1;
+
+static LightThreadPoolBlock * light_thread_free_list = NULL;
+static unsigned int light_thread_free_list_generation = 0;
+#ifdef HAVE_OPENMP
+#pragma omp threadprivate(light_thread_free_list, light_thread_free_list_generation)
+#endif
+
+
+void * LightThread::operator new(size_t size)
+{
+  if(size != sizeof(LightThread)) return ::operator new(size);
+
+  if(light_thread_free_list_generation != light_thread_pool_generation)
+  {
+    light_thread_free_list = NULL;
+    light_thread_free_list_generation = light_thread_pool_generation;
+  }
+
+  if(light_thread_free_list == NULL)
+  {
+    const size_t block_size = std::max(sizeof(LightThread), sizeof(LightThreadPoolBlock));
+    char * chunk = static_cast<char *>(::operator new(light_thread_pool_chunk_size*block_size));
+#ifdef HAVE_OPENMP
+    #pragma omp critical (light_thread_pool)
+#endif
+    light_thread_pool_chunks.push_back(chunk);
+
+    for(unsigned int i=0; i<light_thread_pool_chunk_size; ++i)
+    {
+      LightThreadPoolBlock * block = reinterpret_cast<LightThreadPoolBlock *>(chunk + i*block_size);
+      block->next = light_thread_free_list;
+      light_thread_free_list = block;
+    }
+  }
+
+  LightThreadPoolBlock * block = light_thread_free_list;
+  light_thread_free_list = block->next;
+  return block;
+}
+
+
+void LightThread::operator delete(void * p, size_t size)
+{
+  if(p == NULL) return;
+  if(size != sizeof(LightThread)) { ::operator delete(p); return; }
+
+  LightThreadPoolBlock * block = static_cast<LightThreadPoolBlock *>(p);
+  block->next = light_thread_free_list;
+  light_thread_free_list = block;
+}
+
+
+void LightThread::release_pool()
+{
+  for(unsigned int n=0; n<light_thread_pool_chunks.size(); ++n)
+    ::operator delete(light_thread_pool_chunks[n]);
+  light_thread_pool_chunks.clear();
+
+  // free lists of all the threads are invalid now
+  ++light_thread_pool_generation;
+}
+
+
 std::vector<double> LightThread::advance_to(const Point & p_end, double a_band, double a_tail, double a_fc)
 {
   const double length = (_p - p_end).size();
@@ -60,7 +132,9 @@ std::vector<double> LightThread::advance_to(const Point & p_end, double a_band,
 LightThread * LightThread::reflection(const Point & in_p, const Point & norm) const
 {
   Point reflect_dir = (_dir-2*(norm.dot(_dir))*norm).unit();
-  return  new LightThread(in_p, reflect_dir, _E_dir, _wavelength, _init_power, _power);
+  LightThread * reflect_light = new LightThread(in_p, reflect_dir, _E_dir, _wavelength, _init_power, _power);
+  reflect_light->segment = segment;
+  return reflect_light;
 }
 
 #if 0
@@ -399,9 +473,15 @@ std::pair<LightThread *, LightThread *> LightThread::interface_light_gen_linear_
 {
   if(norm.dot(_dir) == 0.0 ) return std::make_pair((LightThread *)0, (LightThread *)0);
 
+  std::pair<LightThread *, LightThread *> lights;
   if(arc)
-    return _interface_light_gen_linear_polarized_stack(in_p, norm, n1, n2, arc, inv);
+    lights = _interface_light_gen_linear_polarized_stack(in_p, norm, n1, n2, arc, inv);
   else
-    return _interface_light_gen_linear_polarized_simple(in_p, norm, n1, n2);
+    lights = _interface_light_gen_linear_polarized_simple(in_p, norm, n1, n2);
+
+  // the reflect/refract light continues the path of this light
+  if(lights.first)  lights.first->segment  = segment;
+  if(lights.second) lights.second->segment = segment;
+  return lights;
 }
 
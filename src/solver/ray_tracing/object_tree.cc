@@ -20,61 +20,372 @@
 /********************************************************************************/
 
 
+#include <algorithm>
+#include <limits>
+
 #include "elem.h"
 #include "mesh_base.h"
 #include "mesh_tools.h"
-#include "tree.h"
 #include "ray_tracing/light_thread.h"
 #include "ray_tracing/object_tree.h"
 
-ObjectTree::ObjectTree(const MeshBase& mesh)
+
+// max elems in a leaf node
+static const unsigned int bvh_leaf_size = 4;
+
+// number of bins used to evaluate the surface area heuristic
+static const unsigned int bvh_n_bins = 16;
+
+// bounding box padding, prevent the ray miss the face lies on the box
+static double bvh_box_padding = 1e-10;
+
+
+// measure of the surface of a bounding box, the perimeter is used for planar mesh
+static double box_surface(const Point & min, const Point & max, bool planar)
 {
-  // A 1D/2D mesh in 3D space needs special consideration.
-  // If the mesh is planar XY, we want to build a QuadTree
-  // to search efficiently.  If the mesh is truly a manifold,
-  // then we need an octree
-  bool is_planar_xy = false;
+  const Point d = max - min;
+  if(planar) return d(0) + d(1);
+  return d(0)*d(1) + d(1)*d(2) + d(2)*d(0);
+}
 
-  // Build the bounding box for the mesh.  If the delta-z bound is
-  // negligibly small then we can use a quadtree.
+static void box_expand(Point & min, Point & max, const Point & other_min, const Point & other_max)
+{
+  for(unsigned int k=0; k<3; ++k)
   {
-    MeshTools::BoundingBox bbox = MeshTools::bounding_box(mesh);
+    min(k) = std::min(min(k), other_min(k));
+    max(k) = std::max(max(k), other_max(k));
+  }
+}
+
+
 
+ObjectTree::ObjectTree(const MeshBase& mesh)
+{
+  // A 1D/2D mesh in 3D space needs special consideration.
+  // If the delta-z bound is negligibly small, the mesh is planar XY
+  MeshTools::BoundingBox bbox = MeshTools::bounding_box(mesh);
+  {
     const Real
     Dx = bbox.second(0) - bbox.first(0),
          Dz = bbox.second(2) - bbox.first(2);
 
-    if (std::abs(Dz/(Dx + 1.e-20)) < 1e-10)
-      is_planar_xy = true;
+    _planar_xy = (std::abs(Dz/(Dx + 1.e-20)) < 1e-10);
+  }
+  bvh_box_padding = 1e-10*(bbox.second - bbox.first).size();
+
+  // only the active elems on boundary can be hit by the ray from outside
+  MeshBase::const_element_iterator       it  = mesh.active_elements_begin();
+  const MeshBase::const_element_iterator end = mesh.active_elements_end();
+  for (; it != end; ++it)
+  {
+    const Elem * elem = *it;
+    if(!elem->on_boundary()) continue;
+
+    Point min = elem->point(0), max = elem->point(0);
+    for(unsigned int n=1; n<elem->n_nodes(); ++n)
+      box_expand(min, max, elem->point(n), elem->point(n));
+    for(unsigned int k=0; k<3; ++k)
+    {
+      min(k) -= bvh_box_padding;
+      max(k) += bvh_box_padding;
+    }
+
+    _elems.push_back(elem);
+    _elem_boxes.push_back(std::make_pair(min, max));
   }
 
-  if (is_planar_xy)
-    _tree = new Trees::QuadTree (mesh, 16, 10, Trees::ELEMENTS_ON_BOUNDARY);
-  else
-    _tree = new Trees::OctTree  (mesh, 36, 10, Trees::ELEMENTS_ON_BOUNDARY);
+  if(_elems.empty()) return;
+
+  // a binary tree has at most 2n-1 nodes
+  _nodes.reserve(2*_elems.size());
+  _build(0, _elems.size());
 }
 
 
 ObjectTree::~ObjectTree()
+{}
+
+
+void ObjectTree::_build(unsigned int begin, unsigned int end)
+{
+  const unsigned int node_index = _nodes.size();
+  _nodes.push_back(BVHNode());
+
+  // bounding box of all the elems, and of their centers
+  Point box_min = _elem_boxes[begin].first, box_max = _elem_boxes[begin].second;
+  Point center_min = 0.5*(box_min + box_max), center_max = center_min;
+  for(unsigned int i=begin+1; i<end; ++i)
+  {
+    box_expand(box_min, box_max, _elem_boxes[i].first, _elem_boxes[i].second);
+    const Point center = 0.5*(_elem_boxes[i].first + _elem_boxes[i].second);
+    box_expand(center_min, center_max, center, center);
+  }
+  _nodes[node_index].box_min = box_min;
+  _nodes[node_index].box_max = box_max;
+  _nodes[node_index].offset  = begin;
+  _nodes[node_index].n_elems = end - begin;
+
+  if( end - begin <= bvh_leaf_size ) return;
+
+  // split along the longest axis of elem centers
+  unsigned int axis = 0;
+  const Point extent = center_max - center_min;
+  for(unsigned int k=1; k<3; ++k)
+    if(extent(k) > extent(axis)) axis = k;
+
+  // all the elems have the same center, can not be split
+  if( extent(axis) <= bvh_box_padding ) return;
+
+  // put elems into bins by their centers
+  std::vector<unsigned int> bin_count(bvh_n_bins, 0);
+  std::vector<std::pair<Point, Point> > bin_box(bvh_n_bins);
+  const double bin_scale = bvh_n_bins*(1-1e-6)/extent(axis);
+  for(unsigned int i=begin; i<end; ++i)
+  {
+    const double center = 0.5*(_elem_boxes[i].first(axis) + _elem_boxes[i].second(axis));
+    const unsigned int b = static_cast<unsigned int>((center - center_min(axis))*bin_scale);
+    if(bin_count[b]++ == 0)
+      bin_box[b] = _elem_boxes[i];
+    else
+      box_expand(bin_box[b].first, bin_box[b].second, _elem_boxes[i].first, _elem_boxes[i].second);
+  }
+
+  // evaluate the SAH cost of splitting after each bin, sweep from right to left first
+  std::vector<double> right_cost(bvh_n_bins, 0.0);
+  {
+    unsigned int count = 0;
+    Point min, max;
+    for(unsigned int b=bvh_n_bins-1; b>0; --b)
+    {
+      if(bin_count[b])
+      {
+        if(count == 0) { min = bin_box[b].first; max = bin_box[b].second; }
+        else box_expand(min, max, bin_box[b].first, bin_box[b].second);
+        count += bin_count[b];
+      }
+      right_cost[b-1] = count ? count*box_surface(min, max, _planar_xy) : 0.0;
+    }
+  }
+
+  double best_cost = std::numeric_limits<double>::max();
+  unsigned int best_split = invalid_uint;
+  {
+    unsigned int count = 0;
+    Point min, max;
+    for(unsigned int b=0; b<bvh_n_bins-1; ++b)
+    {
+      if(bin_count[b])
+      {
+        if(count == 0) { min = bin_box[b].first; max = bin_box[b].second; }
+        else box_expand(min, max, bin_box[b].first, bin_box[b].second);
+        count += bin_count[b];
+      }
+      if(count == 0 || count == end - begin) continue;
+      const double cost = count*box_surface(min, max, _planar_xy) + right_cost[b];
+      if(cost < best_cost) { best_cost = cost; best_split = b; }
+    }
+  }
+
+  // splitting is not cheaper than testing all the elems of this node
+  const double leaf_cost = (end - begin)*box_surface(box_min, box_max, _planar_xy);
+  if( best_split == invalid_uint || (best_cost >= leaf_cost && end - begin <= 4*bvh_leaf_size) ) return;
+
+  // partition the elems by the split bin
+  unsigned int mid = begin;
+  for(unsigned int i=begin; i<end; ++i)
+  {
+    const double center = 0.5*(_elem_boxes[i].first(axis) + _elem_boxes[i].second(axis));
+    const unsigned int b = static_cast<unsigned int>((center - center_min(axis))*bin_scale);
+    if( b <= best_split )
+    {
+      std::swap(_elems[i], _elems[mid]);
+      std::swap(_elem_boxes[i], _elem_boxes[mid]);
+      ++mid;
+    }
+  }
+  genius_assert(mid > begin && mid < end);
+
+  // left child follows this node
+  _nodes[node_index].n_elems = 0;
+  _build(begin, mid);
+  _nodes[node_index].offset = _nodes.size();
+  _build(mid, end);
+}
+
+
+
+bool ObjectTree::_hit_box(const BVHNode & node, const Point & p, const Point & inv_d, double t_max, double & t_near)
 {
-  delete this->_tree;
+  double t0 = -std::numeric_limits<double>::max();
+  double t1 =  std::numeric_limits<double>::max();
+  for(unsigned int k=0; k<3; ++k)
+  {
+    // the ray is parallel to the slab
+    if( inv_d(k) == std::numeric_limits<double>::infinity() || inv_d(k) == -std::numeric_limits<double>::infinity() )
+    {
+      if( p(k) < node.box_min(k) || p(k) > node.box_max(k) ) return false;
+      continue;
+    }
+
+    double tk0 = (node.box_min(k) - p(k))*inv_d(k);
+    double tk1 = (node.box_max(k) - p(k))*inv_d(k);
+    if(tk0 > tk1) std::swap(tk0, tk1);
+    t0 = std::max(t0, tk0);
+    t1 = std::min(t1, tk1);
+    if(t0 > t1) return false;
+  }
+
+  // the box is behind the ray, or farther than current nearest hit
+  if( t1 < 0 || t0 > t_max ) return false;
+
+  t_near = t0;
+  return true;
 }
 
 
+
 const Elem * ObjectTree::hit(const LightThread *light) const
 {
-  return this->_tree->hit_element(light->start_point(), light->dir());
+  return this->hit(light->start_point(), light->dir());
 }
 
 
 const Elem * ObjectTree::hit(const Point & p, const Point & d) const
 {
-  return this->_tree->hit_element(p, d);
+  if(_nodes.empty()) return NULL;
+
+  const Point inv_d(1.0/d(0), 1.0/d(1), 1.0/d(2));
+
+  const Elem * hit_elem = NULL;
+  double dist = 1e30;
+
+  double t_near;
+  if( !_hit_box(_nodes[0], p, inv_d, dist, t_near) ) return NULL;
+
+  std::vector<unsigned int> stack;
+  stack.reserve(64);
+  stack.push_back(0);
+
+  while(!stack.empty())
+  {
+    const BVHNode & node = _nodes[stack.back()];
+    stack.pop_back();
+
+    // the nearest hit may be updated after this node was pushed
+    if( !_hit_box(node, p, inv_d, dist, t_near) ) continue;
+
+    if( node.n_elems )
+    {
+      for(unsigned int i=node.offset; i<node.offset+node.n_elems; ++i)
+      {
+        IntersectionResult result;
+        _elems[i]->ray_hit(p, d, result);
+        if(result.state!=Missed && result.hit_points[0].t < dist)
+        {
+          hit_elem = _elems[i];
+          dist = result.hit_points[0].t;
+        }
+      }
+      continue;
+    }
+
+    // visit the nearer child first, so it is pushed last
+    const unsigned int left  = &node - &_nodes[0] + 1;
+    const unsigned int right = node.offset;
+    double t_left, t_right;
+    bool hit_left  = _hit_box(_nodes[left],  p, inv_d, dist, t_left);
+    bool hit_right = _hit_box(_nodes[right], p, inv_d, dist, t_right);
+    if(hit_left && hit_right)
+    {
+      if(t_left < t_right) { stack.push_back(right); stack.push_back(left); }
+      else                 { stack.push_back(left);  stack.push_back(right); }
+    }
+    else if(hit_left)  stack.push_back(left);
+    else if(hit_right) stack.push_back(right);
+  }
+
+#if defined(HAVE_FENV_H) && defined(DEBUG)
+  feclearexcept(FE_ALL_EXCEPT);
+#endif
+
+  return hit_elem;
+}
+
+
+void ObjectTree::hit(const std::vector<Point> & p, const Point & d, std::vector<const Elem *> & elems) const
+{
+  const unsigned int n_rays = p.size();
+  elems.assign(n_rays, NULL);
+  if(_nodes.empty() || n_rays==0) return;
+
+  const Point inv_d(1.0/d(0), 1.0/d(1), 1.0/d(2));
+
+  // nearest hit distance of each ray
+  std::vector<double> dist(n_rays, 1e30);
+  // the rays hit current node
+  std::vector<unsigned int> active;
+  active.reserve(n_rays);
+
+  std::vector<unsigned int> stack;
+  stack.reserve(64);
+  stack.push_back(0);
+
+  while(!stack.empty())
+  {
+    const BVHNode & node = _nodes[stack.back()];
+    stack.pop_back();
+
+    active.clear();
+    double t_near;
+    for(unsigned int r=0; r<n_rays; ++r)
+      if( _hit_box(node, p[r], inv_d, dist[r], t_near) ) active.push_back(r);
+    if( active.empty() ) continue;
+
+    if( node.n_elems )
+    {
+      for(unsigned int i=node.offset; i<node.offset+node.n_elems; ++i)
+        for(unsigned int a=0; a<active.size(); ++a)
+        {
+          const unsigned int r = active[a];
+          IntersectionResult result;
+          _elems[i]->ray_hit(p[r], d, result);
+          if(result.state!=Missed && result.hit_points[0].t < dist[r])
+          {
+            elems[r] = _elems[i];
+            dist[r]  = result.hit_points[0].t;
+          }
+        }
+      continue;
+    }
+
+    // all the rays share the same direction, the child nearer to the first active ray is nearer to the packet
+    const unsigned int left  = &node - &_nodes[0] + 1;
+    const unsigned int right = node.offset;
+    double t_left = 1e30, t_right = 1e30;
+    _hit_box(_nodes[left],  p[active[0]], inv_d, 1e30, t_left);
+    _hit_box(_nodes[right], p[active[0]], inv_d, 1e30, t_right);
+    if(t_left < t_right) { stack.push_back(right); stack.push_back(left); }
+    else                 { stack.push_back(left);  stack.push_back(right); }
+  }
+
+#if defined(HAVE_FENV_H) && defined(DEBUG)
+  feclearexcept(FE_ALL_EXCEPT);
+#endif
 }
 
+
 bool ObjectTree::hit_boundbox(const Point & p, const Point & d) const
 {
-  return this->_tree->hit_boundbox(p, d);
-}
+  if(_nodes.empty()) return false;
+
+  const Point inv_d(1.0/d(0), 1.0/d(1), 1.0/d(2));
+  double t_near;
+  bool result = _hit_box(_nodes[0], p, inv_d, 1e30, t_near);
 
+#if defined(HAVE_FENV_H) && defined(DEBUG)
+  feclearexcept(FE_ALL_EXCEPT);
+#endif
+
+  return result;
+}
 
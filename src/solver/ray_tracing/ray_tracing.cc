@@ -20,8 +20,12 @@
 /********************************************************************************/
 
 #include <stack>
+#include <set>
+#include <algorithm>
 #include <iomanip>
 #include <numeric>
+#include <fstream>
+#include <sstream>
 
 
 #include "sphere.h"
@@ -30,12 +34,14 @@
 #include "semiconductor_region.h"
 #include "mesh_tools.h"
 #include "field_source.h"
+#include "elem_node_deposition.h"
 #include "light_lenses.h"
 #include "ray_tracing/light_thread.h"
 #include "ray_tracing/object_tree.h"
 #include "ray_tracing/ray_tracing.h"
 #include "ray_tracing/anti_reflection_coating.h"
 #include "parallel.h"
+#include "random_stream.h"
 
 
 using PhysicalUnit::um;
@@ -50,7 +56,7 @@ using PhysicalUnit::h;
 
 
 RayTraceSolver::RayTraceSolver(SimulationSystem & system, const Parser::Card & c)
-    : SolverBase(system), _card(c), surface_elem_tree(0)
+    : SolverBase(system), _card(c), surface_elem_tree(0), _record_ray_paths(false)
 {
   system.record_active_solver(this->solver_type());
 }
@@ -75,6 +81,12 @@ int RayTraceSolver::create_solver()
   // parse input deck
   define_lenses();
   create_rays();
+  _cache_file = _card.get_string("cache.file", "");
+  _record_ray_paths = _card.get_bool("fca.incremental", false);
+  _dynamic_schedule = _card.get_bool("ray.dynamic", true);
+  _adaptive_level = std::max(0, _card.get_int("ray.adaptive.level", 0));
+  _adaptive_tol = _card.get_real("ray.adaptive.tol", 0.05);
+  _roulette_survival = std::min(1.0, std::max(0.0, _card.get_real("ray.roulette", 0.0)));
 
   MESSAGE<< _total_rays <<" rays for each wave length."<<std::endl;
   RECORD();
@@ -87,6 +99,30 @@ int RayTraceSolver::solve()
 {
   START_LOG("solve()", "RayTraceSolver");
 
+  // generation of the whole spectrum
+  _generation_in_elem.assign(_system.mesh().n_elem(), 0.0);
+  _heat_in_elem.assign(_system.mesh().n_elem(), 0.0);
+  _energy_in_elem.assign(_system.mesh().n_elem(), 0.0);
+
+  _ray_segments.clear();
+  _ray_deposits.clear();
+
+  // energy deposit of all the wavelengths, reloaded from or saved to cache file
+  const unsigned int n_elem = _system.mesh().n_elem();
+  std::vector<double> cached_absorption;
+  bool cache_hit = false;
+  if(!_cache_file.empty())
+  {
+    cache_hit = load_cache(cached_absorption);
+    if(cache_hit)
+    {
+      MESSAGE<< "  reload energy deposit from " << _cache_file <<std::endl;
+      RECORD();
+    }
+    else
+      cached_absorption.assign(_optical_sources.size()*n_elem, 0.0);
+  }
+
   // for each wavelentgh
   for(unsigned int n=0; n<_optical_sources.size(); ++n)
   {
@@ -106,53 +142,506 @@ int RayTraceSolver::solve()
     MESSAGE<< "  process light of " /*<< std::setiosflags(std::ios::fixed)*/  << lamda/um << " um";
     RECORD();
 
-    //process all the rays
-    unsigned int n_on_processor_rays = _wave_plane.n_on_processor_rays();
-    for(unsigned int k=0; k<n_on_processor_rays; ++k)
+    if(cache_hit)
+    {
+      // energy deposit is reloaded from cache, only free carrier absorption is updated
+      restore_energy_deposit(n, cached_absorption);
+    }
+    else
+    {
+      if(_record_ray_paths)
+      {
+        _ray_segments.push_back(std::vector<RaySegment>());
+        _ray_deposits.push_back(std::vector<EnergyDeposit>());
+      }
+      trace_rays(lamda, power);
+      if(!_cache_file.empty())
+        std::copy(_total_absorption_energy_in_elem.begin(), _total_absorption_energy_in_elem.end(), cached_absorption.begin()+n*n_elem);
+    }
+
+    // convert energy deposit to carrier optical generation.
+    // the wavelengths are independent, gather from all the processors later
+    accumulate_optical_generation(n);
+
+    MESSAGE<< "ok" <<std::endl;
+    RECORD();
+  }
+
+  // the new energy deposit is saved for later runs
+  if(!_cache_file.empty() && !cache_hit)
+  {
+    Parallel::sum(cached_absorption);
+    save_cache(cached_absorption);
+  }
+
+  // set the optical generation of the whole spectrum
+  optical_generation();
+#if defined(HAVE_FENV_H) && defined(DEBUG)
+  genius_assert( !fetestexcept(FE_INVALID) );
+#endif
+
+  STOP_LOG("solve()", "RayTraceSolver");
+
+  return 0;
+}
+
+
+int RayTraceSolver::update_free_carrier_absorption()
+{
+  START_LOG("update_free_carrier_absorption()", "RayTraceSolver");
+
+  MESSAGE<< '\n' << "Ray tracing Solver: update free carrier absorption with recorded ray paths..." << std::endl;
+  RECORD();
+
+  // the carrier density of current electrical state
+  _elem_carrier_density.clear();
+  build_elem_carrier_density();
+
+  _generation_in_elem.assign(_system.mesh().n_elem(), 0.0);
+  _heat_in_elem.assign(_system.mesh().n_elem(), 0.0);
+  _energy_in_elem.assign(_system.mesh().n_elem(), 0.0);
+
+  for(unsigned int n=0; n<_ray_segments.size(); ++n)
+  {
+    _band_absorption_energy_in_elem.assign(_system.mesh().n_elem(), 0.0);
+    _total_absorption_energy_in_elem.assign(_system.mesh().n_elem(), 0.0);
+
+    replay_ray_paths(n);
+    accumulate_optical_generation(n);
+  }
+
+  optical_generation();
+
+  STOP_LOG("update_free_carrier_absorption()", "RayTraceSolver");
+
+  return 0;
+}
+
+
+void RayTraceSolver::replay_ray_paths(unsigned int n)
+{
+  const MeshBase &mesh = _system.mesh();
+  const double lamda = _optical_sources[n].wave_length;
+  const std::vector<RaySegment> & segments = _ray_segments[n];
+  const std::vector<EnergyDeposit> & deposits = _ray_deposits[n];
+
+  // power at segment end, relative to the one when traced
+  std::vector<double> end_power_ratio(segments.size(), 1.0);
+
+  unsigned int d=0;
+  for(unsigned int k=0; k<segments.size(); ++k)
+  {
+    const RaySegment & segment = segments[k];
+
+    // parent segment is always recorded before its children
+    const double start_power_ratio = segment.parent >= 0 ? end_power_ratio[segment.parent] : 1.0;
+
+    const double a_fc = this->get_free_carrier_absorption(mesh.elem(segment.elem_id), lamda);
+    const double a_old = segment.a_band + segment.a_fc;
+    const double a_new = segment.a_band + a_fc;
+
+    end_power_ratio[k] = start_power_ratio*exp(-(a_fc - segment.a_fc)*segment.length);
+
+    // scale the energy deposit of this segment
+    const double loss_old = 1.0 - exp(-a_old*segment.length);
+    const double loss_new = 1.0 - exp(-a_new*segment.length);
+    const double scale = loss_old > 0.0 ? start_power_ratio*loss_new/loss_old : 0.0;
+    const double band_fraction = segment.a_band/(a_new+1e-30);
+
+    for(unsigned int i=0; i<segment.n_deposits; ++i, ++d)
+    {
+      const EnergyDeposit & deposit = deposits[d];
+      _band_absorption_energy_in_elem[deposit.elem_id]  += deposit.total*scale*band_fraction;
+      _total_absorption_energy_in_elem[deposit.elem_id] += deposit.total*scale;
+    }
+  }
+  genius_assert(d == deposits.size());
+}
+
+
+namespace
+{
+  // the cell of ray grid at level l which contains grid point c, 2^l x 2^l grid points in a cell
+  std::pair<int, int> ray_grid_cell(const std::pair<int, int> & c, unsigned int l)
+  {
+    const int n = 1<<l;
+    const int i = c.first  >= 0 ? c.first/n  : -((-c.first+n-1)/n);
+    const int j = c.second >= 0 ? c.second/n : -((-c.second+n-1)/n);
+    return std::make_pair(i, j);
+  }
+
+  // message tags of the ray batch queue
+  const int ray_request_tag = 2601;
+  const int ray_reply_tag   = 2602;
+
+  /**
+   * queue of ray batches. in dynamic mode, processor 0 hands out the batches on request and
+   * traces batches itself, it polls the requests between its own batches. the other processors
+   * request the next batch as soon as they receive one, so the reply is usually there when
+   * the batch is needed. otherwise each processor takes a contiguous share of the rays.
+   */
+  class RayBatchQueue
+  {
+  public:
+    RayBatchQueue(unsigned int n_rays, unsigned int batch_size, bool dynamic)
+      : _n_rays(n_rays), _batch_size(batch_size), _dynamic(dynamic && Genius::n_processors() > 1),
+        _next(0), _stop(n_rays), _n_done(0), _requested(false), _reply(1, 0)
+    {
+      if( !_dynamic )
+      {
+        _next = static_cast<unsigned int>( (static_cast<unsigned long long>(n_rays)*Genius::processor_id())/Genius::n_processors() );
+        _stop = static_cast<unsigned int>( (static_cast<unsigned long long>(n_rays)*(Genius::processor_id()+1))/Genius::n_processors() );
+      }
+    }
+
+    /**
+     * get the next batch [begin, end) of this processor
+     * @return false if all the rays are traced
+     */
+    bool next(unsigned int &begin, unsigned int &end)
+    {
+      if( !_dynamic )
+      {
+        if( _next >= _stop ) return false;
+        begin = _next;
+        end   = std::min(_next+_batch_size, _stop);
+        _next = end;
+        return true;
+      }
+
+      if( Genius::processor_id() == 0 )
+      {
+        serve(false);
+        if( _next >= _n_rays )
+        {
+          // all the batches are handed out, the workers are told to stop
+          serve(true);
+          return false;
+        }
+        begin = _next;
+        _next += _batch_size;
+      }
+      else
+      {
+        if( !_requested ) request();
+        Parallel::wait(_reply_request);
+        _requested = false;
+        if( _reply[0] >= _n_rays ) return false;
+        begin = _reply[0];
+        request();
+      }
+      end = std::min(begin+_batch_size, _n_rays);
+      return true;
+    }
+
+  private:
+    unsigned int _n_rays;
+    unsigned int _batch_size;
+    bool         _dynamic;
+
+    // next ray to be handed out, and the end of static share
+    unsigned int _next;
+    unsigned int _stop;
+
+    // number of workers which have been told to stop
+    unsigned int _n_done;
+
+    // worker has an outstanding request
+    bool _requested;
+    std::vector<unsigned int> _reply;
+    Parallel::request _reply_request;
+
+    void request()
     {
-      // create ray
-      LightThread * light = new  LightThread(_wave_plane.ray_start_point(k),
+      std::vector<unsigned int> msg(1, Genius::processor_id());
+      Parallel::irecv(0, _reply, _reply_request, ray_reply_tag);
+      Parallel::send(0, msg, ray_request_tag);
+      _requested = true;
+    }
+
+    // reply the requests of workers, until all of them are stopped when block
+    void serve(bool block)
+    {
+      while( block ? _n_done+1 < Genius::n_processors() : Parallel::iprobe(Parallel::any_source, ray_request_tag) )
+      {
+        std::vector<unsigned int> msg(1);
+        Parallel::recv(Parallel::any_source, msg, ray_request_tag);
+        std::vector<unsigned int> reply(1, std::min(_next, _n_rays));
+        if( _next < _n_rays )
+          _next += _batch_size;
+        else
+          _n_done++;
+        Parallel::send(msg[0], reply, ray_reply_tag);
+      }
+    }
+  };
+}
+
+
+void RayTraceSolver::trace_rays(double lamda, double power)
+{
+  std::vector<unsigned int> rays;
+  std::vector<double> weights;
+  if(_adaptive_level > 0)
+    adaptive_ray_set(lamda, power, rays, weights);
+  else
+  {
+    for(unsigned int k=0; k<_wave_plane.n_rays(); ++k)
+      rays.push_back(k);
+    weights.assign(rays.size(), 1.0);
+  }
+
+  trace_ray_set(rays, weights, lamda, power, NULL);
+}
+
+
+void RayTraceSolver::trace_ray_set(const std::vector<unsigned int> & rays, const std::vector<double> & weights,
+                                   double lamda, double power, std::vector<double> * absorption)
+{
+  //process all the rays batch by batch, the batches are handed out to the processors by the queue.
+  //rays in a batch are traced independently (in parallel when OpenMP is enabled),
+  //each ray records its own energy deposit, which is added to the elems in ray order.
+  //as a result, the absorption is the same as tracing the rays one by one.
+  const unsigned int n_rays = rays.size();
+  const bool pilot = absorption != NULL;
+  const bool record_ray_paths = _record_ray_paths && !pilot;
+  if(pilot) absorption->assign(n_rays, 0.0);
+  unsigned int indicator_step = 1+(n_rays)/20; // +1 for prevent divide by zero error
+
+  // smaller batches balance the processors better, the cost of rays varies a lot
+  unsigned int batch_size = 1024;
+  if(_dynamic_schedule && Genius::n_processors() > 1)
+    batch_size = std::max(64u, std::min(batch_size, n_rays/(8*Genius::n_processors())));
+  RayBatchQueue queue(n_rays, batch_size, _dynamic_schedule);
+
+  std::vector<LightThread *> lights;
+  std::vector<const Elem *> surface_elems;
+  std::vector< std::vector<EnergyDeposit> > ray_deposits(batch_size);
+  std::vector< std::vector<RaySegment> > ray_segments(record_ray_paths ? batch_size : 0);
+
+  // without lenses, all the primary rays are parallel, the first surface elem they hit
+  // is searched by packet of neighbor rays
+  const bool packet_tracing = _lenses->empty();
+  const unsigned int packet_size = 8;
+
+  unsigned int k_begin, k_end;
+  while(queue.next(k_begin, k_end))
+  {
+
+    // create rays, the lenses are applied to the whole batch in parallel
+    lights.assign(k_end-k_begin, static_cast<LightThread *>(0));
+#ifdef HAVE_OPENMP
+    #pragma omp parallel for schedule(dynamic, 64) if(!_lenses->empty())
+#endif
+    for(int k=static_cast<int>(k_begin); k<static_cast<int>(k_end); ++k)
+    {
+      LightThread * light = new  LightThread(_wave_plane.ray_start_point(rays[k]),
                                              _wave_plane.norm,
                                              _wave_plane.E_dir,
                                              lamda,
-                                             power,
-                                             power
+                                             power*weights[k],
+                                             power*weights[k]
                                             );
 
       if(!_lenses->empty())  light = (*_lenses) << light;
+      lights[k-k_begin] = light;
+    }
+
+    const int n_lights = static_cast<int>(lights.size());
+    surface_elems.assign(n_lights, NULL);
+
+    if(packet_tracing)
+    {
+      const int n_packets = (n_lights + packet_size - 1)/packet_size;
+#ifdef HAVE_OPENMP
+      #pragma omp parallel for schedule(dynamic, 4)
+#endif
+      for(int k=0; k<n_packets; ++k)
+      {
+        std::vector<Point> start_points;
+        std::vector<const Elem *> packet_elems;
+        for(int i=k*packet_size; i<std::min(n_lights, static_cast<int>((k+1)*packet_size)); ++i)
+          start_points.push_back(lights[i]->start_point());
+        surface_elem_tree->hit(start_points, lights[k*packet_size]->dir(), packet_elems);
+        for(unsigned int i=0; i<packet_elems.size(); ++i)
+          surface_elems[k*packet_size+i] = packet_elems[i];
+      }
+    }
+
+    // call function ray_tracing to process each ray
+#ifdef HAVE_OPENMP
+    #pragma omp parallel for schedule(dynamic, 16)
+#endif
+    for(int i=0; i<n_lights; ++i)
+    {
+      ray_deposits[i].clear();
+      if(record_ray_paths) ray_segments[i].clear();
+
+      // the ray missed the mesh
+      if(packet_tracing && surface_elems[i]==NULL)
+      {
+        delete lights[i];
+        continue;
+      }
+
+      // the random stream of russian roulette only depends on the ray
+      ray_tracing(lights[i], ray_deposits[i], surface_elems[i], record_ray_paths ? &ray_segments[i] : NULL, rays[k_begin+i]+1);
+    }
+
+    // pilot pass only sums the band absorption of each ray
+    if(pilot)
+    {
+      for(int i=0; i<n_lights; ++i)
+        for(unsigned int d=0; d<ray_deposits[i].size(); ++d)
+          (*absorption)[k_begin+i] += ray_deposits[i][d].band;
+      continue;
+    }
 
-      // call function ray_tracing to process a single ray
-      ray_tracing(light);
+    // add energy deposit to elems by one thread
+    for(int i=0; i<n_lights; ++i)
+    {
+      const std::vector<EnergyDeposit> & deposits = ray_deposits[i];
+      for(unsigned int d=0; d<deposits.size(); ++d)
+      {
+        _band_absorption_energy_in_elem[deposits[d].elem_id]  += deposits[d].band;
+        _total_absorption_energy_in_elem[deposits[d].elem_id] += deposits[d].total;
+      }
+    }
 
-      //indicator
-      if(k%(1+(n_on_processor_rays)/20)==0) // +1 for prevent divide by zero error
+    // keep the ray paths, the segment index of parent is shifted to the path record of this wavelength
+    if(record_ray_paths)
+    {
+      std::vector<RaySegment> & segments = _ray_segments.back();
+      std::vector<EnergyDeposit> & deposits = _ray_deposits.back();
+      for(int i=0; i<n_lights; ++i)
+      {
+        const int offset = static_cast<int>(segments.size());
+        for(unsigned int k=0; k<ray_segments[i].size(); ++k)
+        {
+          RaySegment segment = ray_segments[i][k];
+          if(segment.parent >= 0) segment.parent += offset;
+          segments.push_back(segment);
+        }
+        deposits.insert(deposits.end(), ray_deposits[i].begin(), ray_deposits[i].end());
+      }
+    }
+
+    //indicator
+    for(unsigned int k=k_begin; k<k_end; ++k)
+      if(k%indicator_step==0)
       {
         MESSAGE<< ".";
         RECORD();
       }
 #if defined(HAVE_FENV_H) && defined(DEBUG)
-      genius_assert( !fetestexcept(FE_INVALID) );
+    genius_assert( !fetestexcept(FE_INVALID) );
 #endif
 
+  }
+
+  // the rays are traced by different processors
+  if(pilot)
+    Parallel::sum(*absorption);
+
+  // all the rays of this set are traced
+  LightThread::release_pool();
+}
+
+
+void RayTraceSolver::adaptive_ray_set(double lamda, double power, std::vector<unsigned int> & rays, std::vector<double> & weights)
+{
+  typedef std::pair<int, int> Cell;
+  const std::vector<Cell> & grid = _wave_plane.ray_grid;
+  const unsigned int n_rays = _wave_plane.n_rays();
+
+  // all the cells of the coarsest level are traced
+  std::set<Cell> active;
+  for(unsigned int n=0; n<n_rays; ++n)
+    active.insert(ray_grid_cell(grid[n], _adaptive_level));
+
+  for(unsigned int l=_adaptive_level; l>0; --l)
+  {
+    // the ray nearest to the cell center represents the cell, and carries the power of all the rays in it
+    const double half = 0.5*((1<<l) - 1);
+    std::map<Cell, unsigned int> cell_index;
+    std::vector<Cell> cells;
+    std::vector<unsigned int> rep;
+    std::vector<double> w, d_min;
+    for(unsigned int n=0; n<n_rays; ++n)
+    {
+      const Cell c = ray_grid_cell(grid[n], l);
+      if(active.find(c) == active.end()) continue;
+
+      const double di = grid[n].first  - (c.first*(1<<l) + half);
+      const double dj = _dim==3 ? grid[n].second - (c.second*(1<<l) + half) : 0.0;
+      const double d  = di*di + dj*dj;
+
+      std::map<Cell, unsigned int>::iterator it = cell_index.find(c);
+      if(it == cell_index.end())
+      {
+        cell_index.insert(std::make_pair(c, static_cast<unsigned int>(cells.size())));
+        cells.push_back(c);
+        rep.push_back(n);
+        w.push_back(1.0);
+        d_min.push_back(d);
+        continue;
+      }
+      const unsigned int k = it->second;
+      w[k] += 1.0;
+      if(d < d_min[k]) { d_min[k] = d; rep[k] = n; }
     }
 
-    // gather energy deposit from all the processors
-    Parallel::sum(_band_absorption_energy_in_elem);
-    Parallel::sum(_total_absorption_energy_in_elem);
+    // pilot pass
+    std::vector<double> absorption;
+    trace_ray_set(rep, w, lamda, power, &absorption);
 
-    // convert energy deposit to carrier optical generation
-    optical_generation(n);
+    std::vector<double> fraction(cells.size());
+    double fraction_max = 0.0;
+    for(unsigned int k=0; k<cells.size(); ++k)
+    {
+      fraction[k] = absorption[k]/(w[k]*power);
+      fraction_max = std::max(fraction_max, fraction[k]);
+    }
 
-    MESSAGE<< "ok" <<std::endl;
-    RECORD();
+    // refine the cells which differ from their neighbors
+    std::set<Cell> refine;
+    const int neighbors[4][2] = { {1, 0}, {-1, 0}, {0, 1}, {0, -1} };
+    for(unsigned int k=0; k<cells.size(); ++k)
+      for(unsigned int m=0; m<(_dim==3 ? 4u : 2u); ++m)
+      {
+        const Cell nb(cells[k].first + neighbors[m][0], cells[k].second + neighbors[m][1]);
+        std::map<Cell, unsigned int>::const_iterator it = cell_index.find(nb);
+        if(it == cell_index.end()) continue;
+        if(std::abs(fraction[k] - fraction[it->second]) > _adaptive_tol*fraction_max)
+          refine.insert(cells[k]);
+      }
+
+    // the smooth cells are traced by their representative ray
+    for(unsigned int k=0; k<cells.size(); ++k)
+      if(refine.find(cells[k]) == refine.end())
+      {
+        rays.push_back(rep[k]);
+        weights.push_back(w[k]);
+      }
+
+    // children of the refined cells
+    active.clear();
+    for(std::set<Cell>::const_iterator it=refine.begin(); it!=refine.end(); ++it)
+      for(int a=0; a<2; ++a)
+        for(int b=0; b<(_dim==3 ? 2 : 1); ++b)
+          active.insert(Cell(2*it->first + a, 2*it->second + b));
   }
-#if defined(HAVE_FENV_H) && defined(DEBUG)
-  genius_assert( !fetestexcept(FE_INVALID) );
-#endif
 
-  STOP_LOG("solve()", "RayTraceSolver");
+  // the rays of the finest level
+  for(unsigned int n=0; n<n_rays; ++n)
+    if(active.find(grid[n]) != active.end())
+    {
+      rays.push_back(n);
+      weights.push_back(1.0);
+    }
 
-  return 0;
+  MESSAGE<< "(" << rays.size() << " of " << n_rays << " rays) ";
+  RECORD();
 }
 
 
@@ -183,6 +672,9 @@ int RayTraceSolver::destroy_solver()
 
   }
 
+  _ray_segments.clear();
+  _ray_deposits.clear();
+
 
   MESSAGE<< "Ray tracing Solver finished.\n" <<std::endl;
   RECORD();
@@ -349,7 +841,10 @@ void RayTraceSolver::create_rays()
       {
         Point s = _wave_plane.center + i*_wave_plane.min_dist*d1 + j*_wave_plane.min_dist*d2;
         if(surface_elem_tree->hit_boundbox(s, dir))
+        {
           ray_start_points.push_back(s);
+          _wave_plane.ray_grid.push_back(std::make_pair(i, j));
+        }
       }
     _dim = 3;
   }
@@ -365,19 +860,18 @@ void RayTraceSolver::create_rays()
     {
       Point s = _wave_plane.center + i*_wave_plane.min_dist*d;
       if(surface_elem_tree->hit_boundbox(s, dir))
+      {
         ray_start_points.push_back(s);
+        _wave_plane.ray_grid.push_back(std::make_pair(i, 0));
+      }
     }
 
     _dim = 2;
   }
 
-  // compute start point on all the processors
+  // all the processors compute the same start points, the rays are distributed by trace_rays()
   _total_rays = ray_start_points.size();
-  unsigned int on_process_rays = ray_start_points.size()/Genius::n_processors();
-  unsigned int begin = on_process_rays*Genius::processor_id();
-  unsigned int end   = std::min(begin+on_process_rays, ray_start_points.size());
-  for(unsigned int n=begin; n<end; ++n)
-    _wave_plane.ray_start_points.push_back(ray_start_points[n]);
+  _wave_plane.ray_start_points.swap(ray_start_points);
 
 }
 
@@ -759,8 +1253,11 @@ const Elem * RayTraceSolver::ray_hit(const Point &p, const Point &dir, const Ele
 
 
 
-void RayTraceSolver::ray_tracing(LightThread *ray)
+void RayTraceSolver::ray_tracing(LightThread *ray, std::vector<EnergyDeposit> & deposits, const Elem * surface_elem,
+                                 std::vector<RaySegment> * segments, unsigned long long seed) const
 {
+  // random stream of russian roulette
+  RandomStream rng(seed*0xD1B54A32D192ED03ULL);
 
   // use stack to save all the rays (origin and secondary)
   std::stack<LightThread *> ray_stack;
@@ -776,8 +1273,9 @@ void RayTraceSolver::ray_tracing(LightThread *ray)
     // the ray doesn't hit any elem yet?
     if(current_ray->hit_elem==NULL)
     {
-      // find the first element this ray hit
-      const Elem * elem = surface_elem_tree->hit(current_ray);
+      // find the first element this ray hit, it is known for primary ray traced by packet
+      const Elem * elem = surface_elem ? surface_elem : surface_elem_tree->hit(current_ray);
+      surface_elem = NULL;
       if(elem==NULL) {delete current_ray; continue;}
 
       current_ray->hit_elem = elem;
@@ -917,6 +1415,10 @@ void RayTraceSolver::ray_tracing(LightThread *ray)
     double a_tail = 0.0;
     double a_fc   = this->get_free_carrier_absorption(elem, current_ray->wavelength());
 
+    const double length = (current_ray->start_point() - end_point.p).size();
+    const double power  = current_ray->power();
+    const unsigned int n_deposits = deposits.size();
+
     std::vector<double> energy_deposit = current_ray->advance_to(end_point.p, a_band, a_tail, a_fc);
     double total_energy_deposit = std::accumulate(energy_deposit.begin(), energy_deposit.end(), 0.0);
 
@@ -924,20 +1426,22 @@ void RayTraceSolver::ray_tracing(LightThread *ray)
     {
       // all the energy deposited in this elem
     case Intersect_Body :
-      _band_absorption_energy_in_elem[elem->id()] += energy_deposit[0];
-      _total_absorption_energy_in_elem[elem->id()] += total_energy_deposit;
-      break;
+      {
+        EnergyDeposit deposit = { elem->id(), energy_deposit[0], total_energy_deposit };
+        deposits.push_back(deposit);
+        break;
+      }
       // two elem shares the energy deposite
     case On_Face        :
       {
-        _band_absorption_energy_in_elem[elem->id()] += 0.5*energy_deposit[0];
-        _total_absorption_energy_in_elem[elem->id()] += 0.5*total_energy_deposit;
+        EnergyDeposit deposit = { elem->id(), 0.5*energy_deposit[0], 0.5*total_energy_deposit };
+        deposits.push_back(deposit);
         unsigned int side = current_ray->result.mark;
         const Elem * neighbor = elem->neighbor(side);
         if(neighbor)
         {
-          _band_absorption_energy_in_elem[neighbor->id()] += 0.5*energy_deposit[0];
-          _total_absorption_energy_in_elem[neighbor->id()] += 0.5*total_energy_deposit;
+          EnergyDeposit neighbor_deposit = { neighbor->id(), 0.5*energy_deposit[0], 0.5*total_energy_deposit };
+          deposits.push_back(neighbor_deposit);
         }
         break;
       }
@@ -950,8 +1454,8 @@ void RayTraceSolver::ray_tracing(LightThread *ray)
         assert(elems.size());
         for(unsigned int n=0; n<elems.size(); ++n)
         {
-          _band_absorption_energy_in_elem[elems[n]->id()] += energy_deposit[0]/elems.size();
-          _total_absorption_energy_in_elem[elems[n]->id()] += total_energy_deposit/elems.size();
+          EnergyDeposit deposit = { elems[n]->id(), energy_deposit[0]/elems.size(), total_energy_deposit/elems.size() };
+          deposits.push_back(deposit);
         }
         break;
       }
@@ -959,9 +1463,24 @@ void RayTraceSolver::ray_tracing(LightThread *ray)
     default: genius_error();
     }
 
+    // record the path segment, the following segments of this ray take it as parent
+    if(segments)
+    {
+      RaySegment segment = { current_ray->segment, elem->id(), length, power, a_band, a_fc,
+                             static_cast<unsigned int>(deposits.size() - n_deposits) };
+      segments->push_back(segment);
+      current_ray->segment = static_cast<int>(segments->size()) - 1;
+    }
+
 
+    // russian roulette, the survivor carries the power of the killed ones so the deposit is unbiased
     if(current_ray->is_dead())
-    { delete current_ray; continue; }
+    {
+      if(_roulette_survival > 0.0 && rng.uniform() < _roulette_survival)
+        current_ray->power() /= _roulette_survival;
+      else
+      { delete current_ray; continue; }
+    }
 
     // safe guard: when the number of rays in stack exceed 1000, we may fall into endless loop
     // force to exit
@@ -1114,7 +1633,7 @@ void RayTraceSolver::ray_tracing(LightThread *ray)
       {
         unsigned int vertex_index = end_point.mark;
         const Node * node = elem->get_node(vertex_index);
-        std::vector<const Elem *> & elems = _elems_shared_this_node[node->id()];
+        const std::vector<const Elem *> & elems = _elems_shared_this_node[node->id()];
         // the node is not on boundary
         if( _boundary_node_to_elem_side_map.find(node)==_boundary_node_to_elem_side_map.end())
         {
@@ -1194,26 +1713,37 @@ void RayTraceSolver::ray_tracing(LightThread *ray)
 
 
 
-void RayTraceSolver::optical_generation(unsigned int n)
+void RayTraceSolver::accumulate_optical_generation(unsigned int n)
 {
   const MeshBase &mesh = _system.mesh();
 
   double c = 1.0/sqrt(eps0*mu0);
   double lamda    = _optical_sources[n].wave_length;
   double quan_eff = _optical_sources[n].eta;
+  double E_photon = h*c/lamda;
+
+  // optical band gap of each semiconductor region
+  std::vector<double> region_Eg(_system.n_regions(), 0.0);
+  for (unsigned int r=0; r<_system.n_regions(); r++)
+  {
+    SimulationRegion* region = _system.region(r);
+    if(region->type() == SemiconductorRegion)
+      region_Eg[r] = region->get_optical_Eg(region->T_external());
+  }
 
   for (unsigned int i=0; i<_band_absorption_energy_in_elem.size(); i++)
   {
-    const Elem * elem = mesh.elem(i);
-    if(!elem->on_local()) continue; //skip nonlocal elements
+    _energy_in_elem[i] += _total_absorption_energy_in_elem[i];
+
+    if(_band_absorption_energy_in_elem[i]==0.0) continue;
 
+    const Elem * elem = mesh.elem(i);
     SimulationRegion* elem_region = _system.region(elem->subdomain_id());
 
     // only semiconductor region generating carriers
     if(elem_region->type() == SemiconductorRegion)
     {
-      double Eg = elem_region->get_optical_Eg(elem_region->T_external());
-      double E_photon = h*c/lamda;
+      double Eg = region_Eg[elem->subdomain_id()];
       if(_optical_sources[n].eta_auto)
       {
         // calculate optical gen quantum efficiency
@@ -1221,57 +1751,197 @@ void RayTraceSolver::optical_generation(unsigned int n)
       }
 
       double gen = _band_absorption_energy_in_elem[i]/E_photon*quan_eff;
-      double heat = _band_absorption_energy_in_elem[i] - Eg*gen;
+      _generation_in_elem[i] += gen;
+      _heat_in_elem[i] += _band_absorption_energy_in_elem[i] - Eg*gen;
+    }
+  }
+}
 
-      double volumn = 0;
-      for(unsigned int nd=0; nd<elem->n_nodes(); nd++)
-      {
-        volumn += elem->partial_volume_truncated(nd);
-      }
 
-      for(unsigned int nd=0; nd<elem->n_nodes(); nd++)
-      {
-        const Node* node = elem->get_node(nd);
-        double vol_ratio = elem->partial_volume_truncated(nd)/(volumn+1e-10);
 
-        FVM_Node* fvm_node = elem_region->region_fvm_node(node);
-        assert(fvm_node->node_data());
+void RayTraceSolver::optical_generation()
+{
+  // gather the generation from all the processors, the vectors are as long as the mesh
+  Parallel::sum_node_aware(_generation_in_elem);
+  Parallel::sum_node_aware(_heat_in_elem);
+  Parallel::sum_node_aware(_energy_in_elem);
+
+  // generation and heat are only accumulated in semiconductor elements,
+  // both are deposited to nodes in one pass of the precomputed operator
+  std::vector<const std::vector<double> *> values;
+  std::vector<ElemNodeDeposition::Field> fields;
+  const ElemNodeDeposition::Field OptG = &FVM_NodeData::OptG;
+  const ElemNodeDeposition::Field OptQ = &FVM_NodeData::OptQ;
+  values.push_back(&_generation_in_elem);  fields.push_back(OptG);
+  values.push_back(&_heat_in_elem);        fields.push_back(OptQ);
+  _system.elem_node_deposition().deposit(values, fields);
+
+  // the optical energy is stored in single precision
+  const ElemNodeDeposition::FloatField OptE = &FVM_NodeData::OptE;
+  _system.elem_node_deposition().deposit(_energy_in_elem, OptE);
+
+}
 
-        fvm_node->node_data()->OptG() += gen*vol_ratio/fvm_node->volume();
-        fvm_node->node_data()->OptQ() += heat*vol_ratio/fvm_node->volume();
-      }
-    }
-  }
 
 
-  for (unsigned int i=0; i<_total_absorption_energy_in_elem.size(); i++)
+
+
+std::string RayTraceSolver::cache_key() const
+{
+  const MeshBase &mesh = _system.mesh();
+
+  // FNV-1a digest of mesh geometry and topology
+  unsigned long long mesh_digest = 14695981039346656037ULL;
+  for(unsigned int i=0; i<mesh.n_nodes(); ++i)
+  {
+    const Point & p = mesh.point(i);
+    const unsigned char * bytes = reinterpret_cast<const unsigned char *>(&p(0));
+    for(unsigned int b=0; b<3*sizeof(Real); ++b)
+      mesh_digest = (mesh_digest ^ bytes[b]) * 1099511628211ULL;
+  }
+  for(unsigned int i=0; i<mesh.n_elem(); ++i)
   {
     const Elem * elem = mesh.elem(i);
-    if(!elem->on_local()) continue; //skip nonlocal elements
+    mesh_digest = (mesh_digest ^ static_cast<unsigned long long>(elem->type())) * 1099511628211ULL;
+    mesh_digest = (mesh_digest ^ static_cast<unsigned long long>(elem->subdomain_id())) * 1099511628211ULL;
+    for(unsigned int nd=0; nd<elem->n_nodes(); ++nd)
+      mesh_digest = (mesh_digest ^ static_cast<unsigned long long>(elem->node(nd))) * 1099511628211ULL;
+  }
 
-    SimulationRegion* elem_region = _system.region(elem->subdomain_id());
+  std::ostringstream key;
+  key << std::setprecision(17);
+  key << "mesh " << mesh.n_nodes() << ' ' << mesh.n_elem() << ' ' << std::hex << mesh_digest << std::dec << ';';
 
-    double energy = _total_absorption_energy_in_elem[i];
-    if(energy==0.0) continue;
+  // the material of each region determines the refractive index
+  for(unsigned int r=0; r<_system.n_regions(); ++r)
+    key << "region " << _system.region(r)->name() << ' ' << _system.region(r)->material() << ';';
+  key << "T " << _system.T_external() << ';';
 
-    double volumn = 0;
-    for(unsigned int nd=0; nd<elem->n_nodes(); nd++)
+  // the source card, except the cache options
+  for(unsigned int idx=0; idx<_card.parameter_size(); idx++)
+  {
+    Parser::Parameter p = _card.get_parameter(idx);
+    if( p.name().find("cache.") == 0 || p.name() == "ray.dynamic" ) continue;
+    key << p.name() << '=';
+    for(unsigned int v=0; v<p.array_size(); ++v)
     {
-      volumn += elem->partial_volume_truncated(nd);
+      switch(p.type())
+      {
+      case Parser::BOOL    : key << p.get_bool(v)   << ' '; break;
+      case Parser::INTEGER : key << p.get_int(v)    << ' '; break;
+      case Parser::REAL    : key << p.get_real(v)   << ' '; break;
+      case Parser::STRING  :
+      case Parser::ENUM    : key << p.get_string(v) << ' '; break;
+      default: break;
+      }
     }
+    key << ';';
+  }
 
-    for(unsigned int nd=0; nd<elem->n_nodes(); nd++)
-    {
-      const Node* node = elem->get_node(nd);
-      double vol_ratio = elem->partial_volume_truncated(nd)/(volumn+1e-10);
+  // the resolved spectrum, which may come from spectrum file
+  for(unsigned int n=0; n<_optical_sources.size(); ++n)
+    key << "source " << _optical_sources[n].wave_length << ' ' << _optical_sources[n].power << ' '
+        << _optical_sources[n].eta << ' ' << _optical_sources[n].eta_auto << ';';
+
+  key << "rays " << _total_rays << ' ' << _wave_plane.min_dist << ' ' << _wave_plane.R << ' '
+      << _wave_plane.center(0) << ' ' << _wave_plane.center(1) << ' ' << _wave_plane.center(2) << ' '
+      << _wave_plane.norm(0)   << ' ' << _wave_plane.norm(1)   << ' ' << _wave_plane.norm(2)   << ' '
+      << _wave_plane.E_dir(0)  << ' ' << _wave_plane.E_dir(1)  << ' ' << _wave_plane.E_dir(2)  << ';';
+
+  return key.str();
+}
 
-      FVM_Node* fvm_node = elem_region->region_fvm_node(node);
-      assert(fvm_node->node_data());
 
-      fvm_node->node_data()->OptE() += energy*vol_ratio/fvm_node->volume();
+bool RayTraceSolver::load_cache(std::vector<double> & total_absorption) const
+{
+  const unsigned int n_elem = _system.mesh().n_elem();
+  const std::string key = cache_key();
+
+  // only processor 0 read the cache file, the energy deposit is summed from all the processors later
+  unsigned int hit = 0;
+  if(Genius::processor_id() == 0)
+  {
+    std::ifstream in(_cache_file.c_str());
+    std::string header, file_key;
+    std::getline(in, header);
+    std::getline(in, file_key);
+
+    unsigned int n_sources = 0, n_cached_elem = 0;
+    in >> n_sources >> n_cached_elem;
+
+    if( in.good() && file_key == key && n_sources == _optical_sources.size() && n_cached_elem == n_elem )
+    {
+      total_absorption.assign(n_sources*n_elem, 0.0);
+      unsigned int n, i;
+      double energy;
+      while( in >> n >> i >> energy )
+      {
+        if( n >= n_sources || i >= n_elem ) break;
+        total_absorption[n*n_elem+i] = energy;
+      }
+      hit = in.eof() ? 1 : 0;
     }
+    in.close();
+  }
+
+  Parallel::broadcast(hit);
+  if(!hit)
+  {
+    total_absorption.clear();
+    return false;
   }
 
+  // other processors contribute nothing
+  if(Genius::processor_id() != 0)
+    total_absorption.assign(_optical_sources.size()*n_elem, 0.0);
+
+  return true;
 }
 
 
+void RayTraceSolver::save_cache(const std::vector<double> & total_absorption) const
+{
+  const unsigned int n_elem = _system.mesh().n_elem();
+  const std::string key = cache_key();
+
+  if(Genius::processor_id() == 0)
+  {
+    std::ofstream out(_cache_file.c_str());
+    out << "# Genius ray tracing energy deposit cache" << std::endl;
+    out << key << std::endl;
+    out << _optical_sources.size() << ' ' << n_elem << std::endl;
+
+    out << std::setprecision(17);
+    for(unsigned int n=0; n<_optical_sources.size(); ++n)
+      for(unsigned int i=0; i<n_elem; ++i)
+      {
+        double energy = total_absorption[n*n_elem+i];
+        if(energy == 0.0) continue;
+        out << n << ' ' << i << ' ' << energy << '\n';
+      }
+    out.close();
+  }
+}
+
+
+void RayTraceSolver::restore_energy_deposit(unsigned int n, const std::vector<double> & total_absorption)
+{
+  const MeshBase &mesh = _system.mesh();
+  const unsigned int n_elem = mesh.n_elem();
+  const double lamda = _optical_sources[n].wave_length;
+
+  for(unsigned int i=0; i<n_elem; ++i)
+  {
+    double energy = total_absorption[n*n_elem+i];
+    if(energy == 0.0) continue;
+
+    // the energy absorbed by each elem is kept, and shared between band-band and free carrier
+    // absorption with current carrier density. the change of attenuation along the ray path is omitted.
+    const Elem * elem = mesh.elem(i);
+    double a_band = 4*3.14159265358979*this->get_refractive_index_im(elem->subdomain_id())/lamda;
+    double a_fc   = this->get_free_carrier_absorption(elem, lamda);
+
+    _total_absorption_energy_in_elem[i] = energy;
+    _band_absorption_energy_in_elem[i]  = energy*a_band/(a_band+a_fc+1e-30);
+  }
+}
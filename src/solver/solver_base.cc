@@ -49,6 +49,10 @@ int SolverBase::destroy_solver()
 
 int SolverBase::pre_solve_process(bool /*load_solution*/)
 {
+  // cell driving forces of the previous solve are out of date
+  for(unsigned int n=0; n<_system.n_regions(); n++)
+    _system.region(n)->Mob_Force_Invalidate();
+
   // call (user defined) hook function hook_pre_solve_process
   hook_list()->pre_solve();
 
@@ -21,7 +21,9 @@
 
 //  $Id: solver_specify.cc,v 1.5 2008/07/09 12:25:19 gdiso Exp $
 
+#include <cmath>
 #include <limits>
+#include <algorithm>
 #include <deque>
 #include <string>
 #include <vector>
@@ -73,6 +75,8 @@ namespace SolverSpecify
    * hooks to be installed \<id \<hook_name, hook_parameters\> \>
    */
   std::map<std::string, std::pair<std::string, std::vector<Parser::Parameter> > > Hooks;
+  std::map<std::string, std::pair<int, double> > HookSchedule;
+  std::map<std::string, bool> HookReport;
 
   /**
    * nonlinear solver scheme: basic, line search, trust region...
@@ -84,6 +88,138 @@ namespace SolverSpecify
    */
   int     NSLagPCLU;
 
+  /**
+   * Determines when the jacobian matrix is rebuilt in DC sweep and transient nonlinear solve
+   */
+  int     NSLagJacobian;
+
+  /**
+   * max number of secant updates of Broyden nonlinear solver before the jacobian matrix is rebuilt
+   */
+  int     BroydenMemory;
+
+  /**
+   * Broyden nonlinear solver rebuilds the jacobian matrix when the residual norm
+   * decreases by less than this factor in one iteration
+   */
+  double  BroydenRestart;
+
+  /**
+   * inexact newton, the relative tolerance of linear solver is set by Eisenstat-Walker forcing term
+   */
+  bool    InexactNewton;
+
+  /**
+   * newton-AMG for poisson's equation, the linearized poisson's equation is solved by
+   * GMRES with algebraic multigrid preconditioner and Eisenstat-Walker tolerance
+   */
+  bool    PoissonAMG;
+
+  /**
+   * jacobian-free newton-krylov, the krylov operator is finite differenced residual,
+   * and the assembled jacobian matrix is only used as preconditioner
+   */
+  bool    JFNK;
+
+  /**
+   * rebuild the preconditioner of JFNK every n Newton iterations
+   */
+  int     JFNKLagPC;
+
+  /**
+   * build the jacobian matrix together with the residual by one AD pass, plain newton only
+   */
+  bool    FusedAssembly;
+
+  /**
+   * switch between krylov and direct linear solver by the cost of previous nonlinear solves
+   */
+  bool    AdaptiveLinearSolver;
+
+  /**
+   * krylov iterations per Newton step, above which adaptive linear solver switches to direct solver
+   */
+  int     AdaptiveKSPIts;
+
+  /**
+   * rebuild the preconditioner of krylov solver every n jacobian matrices, across time steps
+   */
+  int     PCLag;
+
+  /**
+   * rebuild the lagged preconditioner when krylov iterations exceed this factor of the ones after the last rebuild
+   */
+  double  PCLagGrowth;
+
+  /**
+   * freeze the dofs whose relative Newton update stays below this value, 0 disables freezing
+   */
+  double  FreezeTol;
+
+  /**
+   * the number of consecutive quiet Newton iterations before a dof is frozen
+   */
+  int     FreezeIts;
+
+  /**
+   * release a frozen dof when its residual grows by this factor
+   */
+  double  FreezeWake;
+
+  /**
+   * mixed-mode transient skips the spice circuit load when all the spice nodes moved below this
+   * relative value since the last load, the last stamp is reused. 0 disables the bypass
+   */
+  double  SpiceBypassTol;
+
+  /**
+   * reuse the ordering and symbolic factorization of jacobian matrix across Newton steps
+   */
+  bool    ReuseSymbolicFactorization;
+
+  /**
+   * cache the matrix nonzero pattern of each solver type, reuse it when the same solver is created again
+   */
+  bool    CacheNonzeroPattern;
+
+  /**
+   * krylov solver starts from the extrapolated Newton correction of previous iteration
+   */
+  bool    KSPWarmStart;
+
+  /**
+   * factor the jacobian matrix of direct solver in single precision,
+   * and recover double precision accuracy by iterative refinement
+   */
+  bool    LUSinglePrecision;
+
+  /**
+   * refinement of single precision LU: "gmres" (GMRES-IR) or "richardson" (classic iterative refinement)
+   */
+  std::string LURefinement;
+
+  /**
+   * block low-rank compression of MUMPS LU factors
+   */
+  bool    LUBlockLowRank;
+
+  /**
+   * dropping tolerance of block low-rank compression
+   */
+  double  LUBlockLowRankTol;
+
+  /**
+   * fill-reducing ordering of direct solver: "nd" for nested dissection of mesh nodes,
+   * "default" for the ordering of the solver package
+   */
+  std::string LUOrdering;
+
+  /**
+   * repartition the mesh after a solve command when the measured load imbalance
+   * (max/average solve time of processors) exceeds this ratio. disabled when less than 1
+   */
+  double  RepartitionImbalance;
+
   /**
    * linear solver scheme: LU, BCGS, GMRES ...
    */
@@ -94,6 +230,21 @@ namespace SolverSpecify
    */
   PreconditionerType      PC;
 
+  /**
+   * composition of field split preconditioner: additive, multiplicative or schur
+   */
+  std::string             FieldSplitType;
+
+  /**
+   * composition of region schwarz preconditioner: restrict, additive or multiplicative
+   */
+  std::string             RegionASMType;
+
+  /**
+   * matrix type of jacobian matrix: aij, baij for node blocks, or aijcusparse / aijkokkos to solve the linear system on the device
+   */
+  std::string             MatrixType;
+
   /**
    * Newton damping
    */
@@ -161,6 +312,30 @@ namespace SolverSpecify
    */
   double    PoissonCorrectionParameter;
 
+  /**
+   * safety factor of the CFL time step limit of half implicit method
+   */
+  double    HalfImplicitCFL;
+
+  //--------------------------------------------
+  // parameters for gummel method
+  //--------------------------------------------
+
+  /**
+   * max number of gummel (Poisson/electron/hole) iterations
+   */
+  unsigned int    GummelMaxIteration;
+
+  /**
+   * gummel iteration is converged when the max potential update less than this value
+   */
+  double    GummelPotentialToler;
+
+  /**
+   * hand off to coupled DDML1 newton solver after gummel iteration
+   */
+  bool      GummelNewton;
+
 
   //--------------------------------------------
   // linear solver convergence criteria
@@ -285,6 +460,44 @@ namespace SolverSpecify
    */
   TemporalScheme    TS_type;
 
+  /**
+   * step size controller used in AutoStep
+   */
+  StepController    TS_controller;
+
+  /**
+   * operator splitting of lattice heat equation in transient simulation. the lattice temperature
+   * is held during carrier steps, and the heat equation is solved every HeatSplit carrier steps
+   * over the elapsed time with the electrical variables held. 0 for fully coupled solution
+   */
+  int       HeatSplit;
+
+  /**
+   * solve the split heat step by GMRES with algebraic multigrid preconditioner
+   */
+  bool      HeatSplitAMG;
+
+  /**
+   * periodic steady state by shooting method, the transient of one period is integrated
+   * repeatedly and its initial state is corrected by newton method
+   */
+  bool      Shooting;
+
+  /**
+   * period of the sources for shooting method
+   */
+  double    ShootingPeriod;
+
+  /**
+   * max newton iterations of shooting method
+   */
+  unsigned int ShootingMaxIteration;
+
+  /**
+   * relative tolerance of GMRES for the monodromy equation of shooting method
+   */
+  double    ShootingKSPRelTol;
+
   /**
    * start time of transient simulation
    */
@@ -326,6 +539,81 @@ namespace SolverSpecify
    */
   bool      Predict;
 
+  /**
+   * predict next solution of DC sweep by the sensitivity dx/dV (or dx/dI) with factored jacobian,
+   * instead of projection from previous solutions
+   */
+  bool      PredictTangent;
+
+  /**
+   * extract the terminal conductance and quasi-static capacitance matrix at each converged
+   * point of DC sweep and write them to this file, empty for no extraction
+   */
+  std::string SmallSignalFile;
+
+  /**
+   * file prefix of the on-disk solution cache of DC sweep
+   */
+  std::string SolutionCachePrefix;
+
+  /**
+   * electrodes whose terminal current is differentiated by adjoint method at the converged
+   * solution of steadystate and DC sweep, one transposed linear solve for each
+   */
+  std::vector<std::string> AdjointCurrent;
+
+  /**
+   * device parameters of adjoint sensitivity, doping:<region>, trap:<region>, workfunction:<electrode>
+   * or pmi:<region>:<model>:<parameter>. doping, trap and pmi are relative to the parameter value
+   */
+  std::vector<std::string> AdjointParameter;
+
+  /**
+   * file for the gradient of adjoint sensitivity
+   */
+  std::string AdjointFile;
+
+  /**
+   * electrodes of impedance field method, the green's function of their terminal current to local
+   * charge gives the current variability by random dopant fluctuation
+   */
+  std::vector<std::string> IFMCurrent;
+
+  /**
+   * number of random doping samples evaluated by the green's function, 0 for variance only
+   */
+  int         IFMSamples;
+
+  /**
+   * seed of random doping samples
+   */
+  int         IFMSeed;
+
+  /**
+   * file for the result of impedance field method
+   */
+  std::string IFMFile;
+
+  /**
+   * number of ensemble instances
+   */
+  int         EnsembleSize;
+
+  /**
+   * seed of ensemble random doping
+   */
+  int         EnsembleSeed;
+
+  /**
+   * relative standard deviation of ensemble trap density
+   */
+  double      EnsembleTrapSigma;
+
+  /**
+   * file for the result of ensemble instances
+   */
+  std::string EnsembleFile;
+
   /**
    * relative tol of TS truncate error, used in AutoStep
    */
@@ -437,6 +725,32 @@ namespace SolverSpecify
    */
   double    IStop;
 
+  /**
+   * start magnetic field of B sweep (hall solver)
+   */
+  double    BStart;
+
+  /**
+   * magnetic field step
+   */
+  double    BStep;
+
+  /**
+   * stop magnetic field of B sweep
+   */
+  double    BStop;
+
+  /**
+   * direction of swept magnetic field, 0:x 1:y 2:z
+   */
+  unsigned int BDirection;
+
+  /**
+   * B sweep keeps the jacobian factored at the first point, and solves the
+   * other points by chord Newton iterations with it. valid for small B
+   */
+  bool      BPerturb;
+
   /**
    *  the simulation cycles
    */
@@ -512,6 +826,71 @@ namespace SolverSpecify
    */
   double    Freq;
 
+  /**
+   * number of processor groups, each group solves a disjoint subset of frequency points
+   */
+  unsigned int ACFreqGroups;
+
+  /**
+   * use reduced order model for AC sweep
+   */
+  bool      ACMOR;
+
+  /**
+   * number of expansion frequencies of the reduced order model
+   */
+  unsigned int ACMORPoints;
+
+  /**
+   * number of moments at each expansion frequency
+   */
+  unsigned int ACMORMoments;
+
+  /**
+   * number of frequency points verified by full solve
+   */
+  unsigned int ACMORCheck;
+
+  /**
+   * N-port AC sweep, each electrode of ACScan is driven in turn with the factored AC matrix
+   * of the frequency, the admittance and scattering matrix are written to ACNPortFile
+   */
+  bool      ACNPort;
+
+  /**
+   * file of the N-port admittance and scattering matrix
+   */
+  std::string ACNPortFile;
+
+  /**
+   * reference impedance of scattering matrix
+   */
+  double    ACNPortZ0;
+
+
+  //------------------------------------------------------
+  // parameters for harmonic balance
+  //------------------------------------------------------
+
+  /**
+   * fundamental frequency of the periodic excitation
+   */
+  double    HBFrequency;
+
+  /**
+   * number of harmonics, the period is sampled at 2*HBHarmonics+1 time points
+   */
+  unsigned int HBHarmonics;
+
+  /**
+   * relative reduction of the harmonic balance residual norm
+   */
+  double    HBRelTol;
+
+  /**
+   * relative tolerance of GMRES for each newton step of harmonic balance
+   */
+  double    HBKSPRelTol;
 
   //------------------------------------------------------
   // parameters for pseudo time stepping method
@@ -588,6 +967,31 @@ namespace SolverSpecify
    */
   int PseudoTimeSteps;
 
+  /**
+   * switched evolution relaxation of pseudo time step, dt grows with the ratio of successive steady residual norms
+   */
+  bool PseudoTimeSER;
+
+  /**
+   * exponent of the residual ratio in switched evolution relaxation
+   */
+  double PseudoTimeSERExponent;
+
+  /**
+   * max growth factor of pseudo time step in one step of switched evolution relaxation
+   */
+  double PseudoTimeSERGrowth;
+
+  /**
+   * use local pseudo time step scaled by the diffusive time scale of each control volume
+   */
+  bool PseudoTimeLocal;
+
+  /**
+   * switch to plain newton when the steady residual falls below this fraction of the initial one, 0 disables it
+   */
+  double PseudoTimeNewtonSwitch;
+
 
   //------------------------------------------------------
   // parameters for optical / particle effect
@@ -631,6 +1035,34 @@ namespace SolverSpecify
     PC                = ASM_PRECOND;
     NSLagPCLU         = 1;
 #endif
+    NSLagJacobian     = 1;
+    BroydenMemory     = 10;
+    BroydenRestart    = 0.5;
+    InexactNewton     = false;
+    PoissonAMG        = false;
+    JFNK              = false;
+    JFNKLagPC         = 5;
+    FusedAssembly     = false;
+    AdaptiveLinearSolver = false;
+    AdaptiveKSPIts    = 100;
+    PCLag             = 1;
+    PCLagGrowth       = 3.0;
+    FreezeTol         = 0.0;
+    FreezeIts         = 3;
+    FreezeWake        = 10.0;
+    SpiceBypassTol    = 0.0;
+    ReuseSymbolicFactorization = true;
+    CacheNonzeroPattern = true;
+    KSPWarmStart      = false;
+    LUSinglePrecision = false;
+    LURefinement      = "gmres";
+    LUBlockLowRank    = false;
+    LUBlockLowRankTol = 1e-8;
+    LUOrdering        = "nd";
+    RepartitionImbalance = 0.0;
+    FieldSplitType    = "multiplicative";
+    RegionASMType     = "restrict";
+    MatrixType        = "aij";
 
     out_append        = false;
 
@@ -643,6 +1075,11 @@ namespace SolverSpecify
     ReSolveCarrier    = false;
     ArtificialCarrier = true;
     PoissonCorrectionParameter= 0.0;
+    HalfImplicitCFL   = 0.5;
+
+    GummelMaxIteration        = 50;
+    GummelPotentialToler      = 1e-4*V;
+    GummelNewton              = true;
 
     MaxIteration              = 30;
     potential_update          = 1.0;
@@ -669,6 +1106,13 @@ namespace SolverSpecify
     TimeDependent             = false;
     TStepMin                  = 1e-14*s;
     TS_type                   = BDF2;
+    TS_controller             = STEP_HEURISTIC;
+    HeatSplit                 = 0;
+    HeatSplitAMG              = true;
+    Shooting                  = false;
+    ShootingPeriod            = 0.0;
+    ShootingMaxIteration      = 10;
+    ShootingKSPRelTol         = 1e-3;
     BDF2_LowerOrder           = true;
     UIC                       = false;
     tran_op                   = true;
@@ -676,6 +1120,20 @@ namespace SolverSpecify
     AutoStep                  = true;
     RejectStep                = true;
     Predict                   = true;
+    PredictTangent            = false;
+    SmallSignalFile           = "";
+    SolutionCachePrefix       = "";
+    AdjointCurrent.clear();
+    AdjointParameter.clear();
+    AdjointFile               = "adjoint.dat";
+    IFMCurrent.clear();
+    IFMSamples                = 0;
+    IFMSeed                   = 0;
+    IFMFile                   = "ifm.dat";
+    EnsembleSize              = 0;
+    EnsembleSeed              = 0;
+    EnsembleTrapSigma         = 0.0;
+    EnsembleFile              = "ensemble.dat";
     clock                     = 0.0;
     dt                        = 1e100;
 
@@ -692,6 +1150,19 @@ namespace SolverSpecify
     Gmin              = 1e-12;
 
     VAC               = 0.0;
+    ACFreqGroups      = 1;
+    ACMOR             = false;
+    ACMORPoints       = 4;
+    ACMORMoments      = 2;
+    ACMORCheck        = 2;
+    ACNPort           = false;
+    ACNPortFile       = "nport.dat";
+    ACNPortZ0         = 50*V/A;
+
+    HBFrequency       = 1e6/s;
+    HBHarmonics       = 3;
+    HBRelTol          = 1e-6;
+    HBKSPRelTol       = 1e-4;
 
     OpToSteady        = true;
 
@@ -713,6 +1184,11 @@ namespace SolverSpecify
     PseudoTimeMethodRFTol       = 1e-2;
     PseudoTimeTolRelax          = 1e8;
     PseudoTimeSteps             = 50;
+    PseudoTimeSER               = false;
+    PseudoTimeSERExponent       = 1.0;
+    PseudoTimeSERGrowth         = 10.0;
+    PseudoTimeLocal             = false;
+    PseudoTimeNewtonSwitch      = 0.0;
   }
 
   SolutionType type_string_to_enum(const std::string s)
@@ -722,11 +1198,25 @@ namespace SolverSpecify
     if (s == "op" )                           return OP;
     if (s == "dcsweep" )                      return DCSWEEP;
     if (s == "trace" )                        return TRACE;
+    if (s == "bsweep" )                       return BSWEEP;
     if (s == "acsweep")                       return ACSWEEP;
     if (s == "transient")                     return TRANSIENT;
+    if (s == "harmonic")                      return HARMONIC;
 
     return INVALID_SolutionType;
   }
 
+
+  double pi_step_factor(double r, double r_last)
+  {
+    // Gustafsson PI controller: h_{n+1} = h_n * (1/err_n)^(kI+kP) * err_{n-1}^kP
+    // with kI = 0.3, kP = 0.4 expressed in normalized error r = err^(-1/(k+1))
+    const double kI = 0.3;
+    const double kP = 0.4;
+    double factor = 0.9*std::pow(r, kI+kP)*std::pow(r_last, -kP);
+    // prevent too large variation of time step
+    return std::min(2.0, std::max(0.2, factor));
+  }
+
 }
 
@@ -21,39 +21,39 @@
 
 //  $Id: poisson.cc,v 1.36 2008/07/09 07:53:36 gdiso Exp $
 
-
 #include "elem.h"
 #include "mesh_base.h"
+#include "simulation_system.h"
+#include "simulation_region.h"
 #include "stress_solver/stress_solver.h"
 #include "solver_specify.h"
 #include "fe_type.h"
 #include "fe_base.h"
 #include "quadrature_gauss.h"
-#include "tensor_value.h"
+#include "parallel.h"
+
+
+// the integral order used in gauss intergral.
+// the stiffness integrand of first order element is at most quadratic
+static const Order int_order = THIRD;
 
 
 /*------------------------------------------------------------------
- * create the poisson solver contex
+ * create the stress solver contex
  */
 int StressSolver::create_solver()
 {
   MESSAGE<< '\n' << "Stress Solver init..." << std::endl;
   RECORD();
 
-
-  // adjust default snes/ksp/pc/mat/vec settings
-
-  // use BCGS as default solver
-  KSPSetType(ksp, KSPBCGS);
-
-  // Set user-specified  solver and preconditioner types
-  set_linear_solver_type    ( SolverSpecify::LS );
-  set_preconditioner_type   ( SolverSpecify::PC );
-
   // must set linear matrix/vector here!
   setup_linear_data();
 
-  //SNESLineSearchSet(snes,SNESLineSearchNo, 0);
+  // the stiffness matrix is symmetric positive definite and never assembled,
+  // use CG with point-block jacobi of the nodal 3x3 blocks as default solver.
+  // direct solvers do not apply here
+  KSPSetType(ksp, KSPCG);
+  PCSetType(pc, PCPBJACOBI);
 
   // rtol   = 1e-10*n_global_dofs  - the relative convergence tolerance (relative decrease in the residual norm)
   // abstol = 1e-20*n_global_dofs  - the absolute convergence tolerance (absolute size of the residual norm)
@@ -77,7 +77,7 @@ int StressSolver::solve()
 {
   START_LOG("StressSolver_Linear()", "StressSolver");
 
-  build_matrix(A, A);
+  build_matrix(A, A_pc);
 
   build_rhs(b);
 
@@ -99,349 +99,273 @@ int StressSolver::destroy_solver()
 
 
 
-void StressSolver::build_matrix(Mat A, Mat )
+void StressSolver::elastic_tensor(const Elem *, double C[6][6]) const
 {
-  // the integral order used in gauss intergral. default value= 2*fe_order+1
-  Order int_order=FIFTH;
+  //this should be function of node. for convinent, we take parameter as const in every element
+  //the stiff matrix. a general stiff matrix named C of 3D is a 6x6 symmetry matrx
+  // so it has 21 independent parameter. in some special case the independent parameter number will be reduce.
+  // note that in 2D case, plane stress and plane strain are two deferent case.
+  for(unsigned int ii=0; ii<6; ++ii)
+    for(unsigned int jj=0; jj<6; ++jj)
+      C[ii][jj] = 0.0;
+
+  //material initialization for every element, now only a sample is taken
+  C[0][0]=C[1][1]=C[2][2]=1.e9;
+  C[3][3]=C[4][4]=C[5][5]=1.e8;
+}
 
-  const MeshBase& mesh = _system.mesh();
 
+
+/*------------------------------------------------------------------
+ * the element-by-element stiffness operator y = K*x.
+ * at each quadrature point the strain B*u is evaluated from the nodal
+ * displacement, and B'*C*B*u is added to the element residual. the 6x(3*n_node)
+ * B matrix and the element stiffness matrix are never formed.
+ * strain and stress are in Voigt order xx, yy, zz, xy, yz, zx.
+ */
+void StressSolver::matrix_free_mult(Vec x, Vec y)
+{
+  START_LOG("matrix_free_mult()", "StressSolver");
+
+  const MeshBase& mesh = _system.mesh();
   const unsigned int dim = mesh.mesh_dimension();
 
   FEType fe_type;
-
   AutoPtr<FEBase> fe (FEBase::build(dim, fe_type));
-
-  // Gauss quadrature rule for numerical integration.
   QGauss qrule (dim, int_order);
-
-  // Tell the finite element object to use our quadrature rule.
   fe->attach_quadrature_rule (&qrule);
 
-  // Declare a special finite element object for boundary integration.
-  AutoPtr<FEBase> fe_face (FEBase::build(dim, fe_type));
+  const std::vector<Real>& JxW = fe->get_JxW();
+  const std::vector<std::vector<Real> >& dphidx = fe->get_dphidx();
+  const std::vector<std::vector<Real> >& dphidy = fe->get_dphidy();
+  const std::vector<std::vector<Real> >& dphidz = fe->get_dphidz();
 
-  // Boundary integration requires one quadraure rule,
-  // with dimensionality one less than the dimensionality
-  // of the element.
-  QGauss qface(dim-1, int_order);
+  // the displacement, including ghost dofs
+  VecScatterBegin(scatter, x, lx, INSERT_VALUES, SCATTER_FORWARD);
+  VecScatterEnd  (scatter, x, lx, INSERT_VALUES, SCATTER_FORWARD);
 
-  // Tell the finite element object to use our
-  // quadrature rule.
-  fe_face->attach_quadrature_rule (&qface);
+  VecZeroEntries(y);
 
-  // Here we define some references to cell-specific data that
-  // will be used to assemble the linear system.
-  //
-  // The element Jacobian * quadrature weight at each integration point.
-  const std::vector<Real>& JxW = fe->get_JxW();
+  PetscScalar *lxx;
+  VecGetArray(lx, &lxx);
 
-  // The physical XY locations of the quadrature points on the element.
-  // These might be useful for evaluating spatially varying material
-  // properties at the quadrature points.
-  const std::vector<Point>& q_point = fe->get_xyz();
+  std::vector<PetscInt> dof_indices;
+  std::vector<PetscScalar> ye;
+  std::vector<const PetscScalar *> ue;
+  double C[6][6];
 
-  // The element shape functions evaluated at the quadrature points.
-  const std::vector<std::vector<Real> >& phi = fe->get_phi();
+  for(unsigned int n=0; n<_system.n_regions(); ++n)
+  {
+    SimulationRegion * region = _system.region(n);
 
-  // The element shape function gradients evaluated at the quadrature
-  // points.
-  //const std::vector<std::vector<RealGradient> >& dphi = fe->get_dphi();
-  const std::vector<std::vector<Real> >& dphidx       = fe->get_dphidx();
-  const std::vector<std::vector<Real> >& dphidy       = fe->get_dphidy();
-  const std::vector<std::vector<Real> >& dphidz       = fe->get_dphidz();
-
-  // Define data structures to contain the element matrix
-  // and right-hand-side vector contribution.  Following
-  // basic finite element terminology we will denote these
-  // "Ke" and "Fe".  These datatypes are templated on
-  //  Number, which allows the same code to work for real
-  // or complex numbers.
-  //DenseMatrix<Number> Ke;
-  //DenseVector<Number> Fe;
-
-
-  // This vector will hold the degree of freedom indices for
-  // the element.  These define where in the global system
-  // the element degrees of freedom get mapped.
-  //std::vector<unsigned int> dof_indices;
-
-  // Now we will loop over all the elements in the mesh.
-  // We will compute the element matrix and right-hand-side
-  // contribution.
-  //
-  // Element iterators are a nice way to iterate through
-  // all the elements, or all the elements that have some property.
-  // There are many types of element iterators, but here we will
-  // use the most basic type, the  const_elem_iterator.  The iterator
-  //  el will iterate from the first to the last element.  The
-  // iterator  end_el tells us when to stop.  It is smart to make
-  // this one  const so that we don't accidentally mess it up!
-  //   const_elem_iterator           el (mesh.elements_begin());
-  //   const const_elem_iterator end_el (mesh.elements_end());
-
-  //for(unsigned int n=0; n<_system.n_regions(); ++n)
-  //{
-  //	SimulationRegion * region = _system.region(n);
-  //}
-
-  MeshBase::const_element_iterator       el     = mesh.elements_begin();
-  const MeshBase::const_element_iterator end_el = mesh.elements_end();
+    SimulationRegion::element_iterator it = region->elements_begin();
+    SimulationRegion::element_iterator it_end = region->elements_end();
+    for(; it!=it_end; ++it)
+    {
+      const Elem* elem  = *it;
+      if(elem->processor_id()!=Genius::processor_id()) continue;
 
-  //this should be function of node. for convinent, we take parameter as const in every element
-  // you should re_value it for your own use.
-  //VectorValue<double> E;      //yang's modul
-  //TensorValue<double> G;   //shear modul
-  //TensorValue<double> nu;  //possion ratio
+      elastic_tensor(elem, C);
 
-  //the stiff matrix. a general stiff matrix named C of 3D is a 6x6 symmetry matrx
-  // so it has 21 independent parameter. in some special case the independent parameter number will be reduce.
-  // note that in 2D case, plane stress and plane strain are two deferent case.
-  double C[6][6]={0.};
+      this->build_dof_indices(elem, dof_indices);
 
-  //std::cout<<"k="<<k<<std::endl;
-  // Loop over the elements.  Note that  ++el is preferred to
-  // el++ since the latter requires an unnecessary temporary
-  // object.
-  for ( ; el != end_el ; ++el)
-  {
-    //material initialization for every element, now only a sample is taken
-    C[0][0]=C[1][1]=C[2][2]=1.e9;
-    C[3][3]=C[4][4]=C[5][5]=1.e8;
+      fe->reinit (elem);
 
-    // Store a pointer to the element we are currently
-    // working on.  This allows for nicer syntax later.
-    const Elem* elem = *el;
+      const unsigned int n_node = elem->n_nodes();
+      ye.assign(3*n_node, 0.0);
+      ue.resize(n_node);
+      for(unsigned int i=0; i<n_node; ++i)
+        ue[i] = lxx + elem->get_node(i)->local_dof_id();
 
-    //matrix K and F are matrix of Ax=b in every element Kx=F, its size are changed with node in element,
-    // so initialize it in every element.
-    unsigned int n_node=elem->n_nodes();
-    unsigned int dim=3;   // 3 is 3D, 2D and 1D are regard as reduced 3D problem.
-    unsigned int dim_stress=6; //6 is the dim of stress. stress is 3x3 symmetry matrix and has 6 independent element.
+      for (unsigned int qp=0; qp<qrule.n_points(); qp++)
+      {
+        // strain = B*u
+        double eps[6]={0.};
+        for(unsigned int i=0; i<n_node; ++i)
+        {
+          const PetscScalar *u = ue[i];
+          const double dx = dphidx[i][qp], dy = dphidy[i][qp], dz = dphidz[i][qp];
+          eps[0] += dx*u[0];
+          eps[1] += dy*u[1];
+          eps[2] += dz*u[2];
+          eps[3] += dy*u[0] + dx*u[1];
+          eps[4] += dz*u[1] + dy*u[2];
+          eps[5] += dz*u[0] + dx*u[2];
+        }
 
-    unsigned int n_node2=n_node*dim;
+        // stress = C*strain, weighted
+        double sigma[6];
+        for(unsigned int ii=0; ii<6; ++ii)
+        {
+          sigma[ii] = 0.0;
+          for(unsigned int kk=0; kk<6; ++kk)
+            sigma[ii] += C[ii][kk]*eps[kk];
+          sigma[ii] *= JxW[qp];
+        }
 
-    double* K  =new double[n_node2*n_node2];   //K=B'CB
-    double* F  =new double[n_node2];
-    double* CB =new double[dim_stress*n_node2]; //a matrix=C*B
+        // B'*stress
+        for(unsigned int i=0; i<n_node; ++i)
+        {
+          const double dx = dphidx[i][qp], dy = dphidy[i][qp], dz = dphidz[i][qp];
+          ye[i*3+0] += dx*sigma[0] + dy*sigma[3] + dz*sigma[5];
+          ye[i*3+1] += dy*sigma[1] + dx*sigma[3] + dz*sigma[4];
+          ye[i*3+2] += dz*sigma[2] + dy*sigma[4] + dx*sigma[5];
+        }
+      }
 
-    for(unsigned int ii=0;ii<n_node2*n_node2;++ii)
-    {
-      K[ii]=0.;
+      VecSetValues(y, dof_indices.size(), &dof_indices[0], &ye[0], ADD_VALUES);
     }
+  }
 
-    for(unsigned int ii=0;ii<n_node2;++ii)
-    {
-      F[ii]=0.;
-    }
+  VecRestoreArray(lx, &lxx);
+
+  VecAssemblyBegin(y);
+  VecAssemblyEnd(y);
 
+  STOP_LOG("matrix_free_mult()", "StressSolver");
+}
 
-    // Get the degree of freedom indices for the
-    // current element.  These define where in the global
-    // matrix and right-hand-side this element will
-    // contribute to.
-    //	dof_map.dof_indices (elem, dof_indices);
 
-    // Compute the element-specific data for the current
-    // element.  This involves computing the location of the
-    // quadrature points (q_point) and the shape functions
-    // (phi, dphi) for the current element.
-    fe->reinit (elem);
 
-    double B[6][81]={0.}; //81=27*3, and 27 is the max n_node in an element.
+/*------------------------------------------------------------------
+ * the preconditioning matrix: the 3x3 diagonal block B_i'*C*B_i of each node.
+ * the matrix-free operator itself never needs the assembled stiffness matrix
+ */
+void StressSolver::build_matrix(Mat , Mat pc)
+{
+  START_LOG("build_matrix()", "StressSolver");
+
+  const MeshBase& mesh = _system.mesh();
+  const unsigned int dim = mesh.mesh_dimension();
 
+  FEType fe_type;
+  AutoPtr<FEBase> fe (FEBase::build(dim, fe_type));
+  QGauss qrule (dim, int_order);
+  fe->attach_quadrature_rule (&qrule);
 
-    // Zero the element matrix and right-hand side before
-    // summing them.  We use the resize member here because
-    // the number of degrees of freedom might have changed from
-    // the last element.  Note that this will be the case if the
-    // element type is different (i.e. the last element was a
-    // triangle, now we are on a quadrilateral).
+  const std::vector<Real>& JxW = fe->get_JxW();
+  const std::vector<std::vector<Real> >& dphidx = fe->get_dphidx();
+  const std::vector<std::vector<Real> >& dphidy = fe->get_dphidy();
+  const std::vector<std::vector<Real> >& dphidz = fe->get_dphidz();
 
-    // The  DenseMatrix::resize() and the  DenseVector::resize()
-    // members will automatically zero out the matrix  and vector.
-    //	Ke.resize (dof_indices.size(),
-    //			dof_indices.size());
+  MatZeroEntries(pc);
 
-    //	Fe.resize (dof_indices.size());
+  std::vector<PetscInt> dof_indices;
+  double C[6][6];
 
-    // Now loop over the quadrature points.  This handles
-    // the numeric integration.
+  for(unsigned int n=0; n<_system.n_regions(); ++n)
+  {
+    SimulationRegion * region = _system.region(n);
 
-    for (unsigned int qp=0; qp<qrule.n_points(); qp++)
+    SimulationRegion::element_iterator it = region->elements_begin();
+    SimulationRegion::element_iterator it_end = region->elements_end();
+    for(; it!=it_end; ++it)
     {
+      const Elem* elem  = *it;
+      if(elem->processor_id()!=Genius::processor_id()) continue;
+
+      elastic_tensor(elem, C);
 
-      // Now we will build the element matrix.  This involves
-      // a double loop to integrate the test funcions (i) against
-      // the trial functions (j).
-      for (unsigned int i=0; i<phi.size(); i++)
+      this->build_dof_indices(elem, dof_indices);
+
+      fe->reinit (elem);
+
+      for(unsigned int i=0; i<elem->n_nodes(); ++i)
       {
-        for (unsigned int j=0; j<phi.size(); j++)
+        PetscScalar K[3][3]={{0.}};
+
+        for (unsigned int qp=0; qp<qrule.n_points(); qp++)
         {
-          //	Ke(i,j) += JxW[qp]*(dphi[i][qp]*dphi[j][qp]);
+          const double dx = dphidx[i][qp], dy = dphidy[i][qp], dz = dphidz[i][qp];
+
+          // the 6x3 strain matrix of node i
+          const double B[6][3] = { {dx, 0., 0.}, {0., dy, 0.}, {0., 0., dz},
+                                   {dy, dx, 0.}, {0., dz, dy}, {dz, 0., dx} };
+
+          double CB[6][3];
+          for(unsigned int ii=0; ii<6; ++ii)
+            for(unsigned int jj=0; jj<3; ++jj)
+            {
+              CB[ii][jj] = 0.0;
+              for(unsigned int kk=0; kk<6; ++kk)
+                CB[ii][jj] += C[ii][kk]*B[kk][jj];
+            }
+
+          for(unsigned int ii=0; ii<3; ++ii)
+            for(unsigned int jj=0; jj<3; ++jj)
+              for(unsigned int kk=0; kk<6; ++kk)
+                K[ii][jj] += B[kk][ii]*CB[kk][jj]*JxW[qp];
         }
+
+        MatSetValues(pc, 3, &dof_indices[3*i], 3, &dof_indices[3*i], &K[0][0], ADD_VALUES);
       }
+    }
+  }
 
-      for(unsigned int i=0;i<phi.size();i++)
-      {
-        B[0][i*3+0]=dphidx[i][qp];  //vd0[0][i];
+  MatAssemblyBegin(pc, MAT_FINAL_ASSEMBLY);
+  MatAssemblyEnd(pc, MAT_FINAL_ASSEMBLY);
 
-        B[1][i*3+1]=dphidy[i][qp];  //vd0[1][i];
+  // the nonzero pattern of the nodal blocks never changes
+  matrix_first_assemble = true;
 
-        B[2][i*3+2]=dphidz[i][qp];  //vd0[2][i];
+  STOP_LOG("build_matrix()", "StressSolver");
+}
 
-        B[3][i*3+0]=dphidy[i][qp];  //vd0[1][i];
-        B[3][i*3+1]=dphidx[i][qp];  //vd0[0][i];
 
-        B[4][i*3+1]=dphidz[i][qp];  //vd0[2][i];
-        B[4][i*3+2]=dphidy[i][qp];  //vd0[1][i];
 
-        B[5][i*3+0]=dphidz[i][qp];  //vd0[2][i];
-        B[5][i*3+2]=dphidx[i][qp];  //vd0[0][i];
-      }
+/*------------------------------------------------------------------
+ * the body force, now only a sample is taken.
+ * NOTE boundary conditions are not imposed yet.
+ */
+void StressSolver::build_rhs(Vec b)
+{
+  START_LOG("build_rhs()", "StressSolver");
 
-      for(unsigned int ii=0;ii<dim_stress;ii++)
-      {
-        for(unsigned int jj=0;jj<n_node2;jj++)
-        {
-          CB[ii*n_node2+jj]=0.0;
-          for(unsigned int kk=0;kk<dim_stress;kk++)
-          {
-            CB[ii*n_node2+jj]+=C[ii][kk]*B[kk][jj];
-          }
-        }
-      }
+  const MeshBase& mesh = _system.mesh();
+  const unsigned int dim = mesh.mesh_dimension();
 
-      for(unsigned int ii=0;ii<n_node2;ii++)
-      {
-        for(unsigned int jj=0;jj<n_node2;jj++)
-        {
-          for(unsigned int kk=0;kk<dim_stress;kk++)
-          {
-            K[ii*n_node2+jj]+=B[kk][ii]*CB[kk*n_node2+jj]*JxW[qp];
-          }
-          //	cout<<element_k[ii]<<endl;
-        }
-      }
+  FEType fe_type;
+  AutoPtr<FEBase> fe (FEBase::build(dim, fe_type));
+  QGauss qrule (dim, int_order);
+  fe->attach_quadrature_rule (&qrule);
 
-      double f[3]={1.e3,0.,0.};
-      for (unsigned int ii=0; ii<n_node; ii++)
-      {
-        for(unsigned int jj=0; jj<dim; jj++)
-        {
-          F[ii*dim+jj] += JxW[qp]*f[jj]*phi[ii][qp];
-        }
-      }
-    }
+  const std::vector<Real>& JxW = fe->get_JxW();
+  const std::vector<std::vector<Real> >& phi = fe->get_phi();
+
+  VecZeroEntries(b);
+
+  std::vector<PetscInt> dof_indices;
+  std::vector<PetscScalar> F;
+
+  const double f[3]={1.e3,0.,0.};
 
-    // We have now reached the end of the RHS summation,
-    // and the end of quadrature point loop, so
-    // the interior element integration has
-    // been completed.  However, we have not yet addressed
-    // boundary conditions.  For this example we will only
-    // consider simple Dirichlet boundary conditions.
-    //
-    // There are several ways Dirichlet boundary conditions
-    // can be imposed.  A simple approach, which works for
-    // interpolary bases like the standard Lagrange polynomials,
-    // is to assign function values to the
-    // degrees of freedom living on the domain boundary. This
-    // works well for interpolary bases, but is more difficult
-    // when non-interpolary (e.g Legendre or Hierarchic) bases
-    // are used.
-    //
-    // Dirichlet boundary conditions can also be imposed with a
-    // "penalty" method.  In this case essentially the L2 projection
-    // of the boundary values are added to the matrix. The
-    // projection is multiplied by some large factor so that, in
-    // floating point arithmetic, the existing (smaller) entries
-    // in the matrix and right-hand-side are effectively ignored.
-    //
-    // This amounts to adding a term of the form (in latex notation)
-    //
-    // \frac{1}{\epsilon} \int_{\delta \Omega} \phi_i \phi_j = \frac{1}{\epsilon} \int_{\delta \Omega} u \phi_i
-    //
-    // where
-    //
-    // \frac{1}{\epsilon} is the penalty parameter, defined such that \epsilon << 1
-    /*
+  for(unsigned int n=0; n<_system.n_regions(); ++n)
+  {
+    SimulationRegion * region = _system.region(n);
+
+    SimulationRegion::element_iterator it = region->elements_begin();
+    SimulationRegion::element_iterator it_end = region->elements_end();
+    for(; it!=it_end; ++it)
     {
+      const Elem* elem  = *it;
+      if(elem->processor_id()!=Genius::processor_id()) continue;
+
+      this->build_dof_indices(elem, dof_indices);
 
-    	// The following loop is over the sides of the element.
-    	// If the element has no neighbor on a side then that
-    	// side MUST live on a boundary of the domain.
-    	for (unsigned int side=0; side<elem->n_sides(); side++)
-    	{
-    		if (elem->neighbor(side) == NULL)
-    		{
-    			// The value of the shape functions at the quadrature
-    			// points.
-    			const std::vector<std::vector<Real> >&  phi_face = fe_face->get_phi();
-
-    			// The Jacobian * Quadrature Weight at the quadrature
-    			// points on the face.
-    			const std::vector<Real>& JxW_face = fe_face->get_JxW();
-
-    			// The XYZ locations (in physical space) of the
-    			// quadrature points on the face.  This is where
-    			// we will interpolate the boundary value function.
-    			const std::vector<Point >& qface_point = fe_face->get_xyz();
-
-    			// Compute the shape function values on the element
-    			// face.
-    			fe_face->reinit(elem, side);
-
-    			// Loop over the face quadrature points for integration.
-    			for (unsigned int qp=0; qp<qface.n_points(); qp++)
-    			{
-
-    				// The location on the boundary of the current
-    				// face quadrature point.
-    				const Real xf = qface_point[qp](0);
-    				const Real yf = qface_point[qp](1);
-
-    				// The penalty value.  \frac{1}{\epsilon}
-    				// in the discussion above.
-    				const Real penalty = 1.e10;
-
-    				// The boundary value.
-    				const Real value = 20.;//exact_solution(xf, yf);
-
-    				// Matrix contribution of the L2 projection.
-    				for (unsigned int i=0; i<phi_face.size(); i++)
-    				for (unsigned int j=0; j<phi_face.size(); j++)
-    				Ke(i,j) += JxW_face[qp]*penalty*phi_face[i][qp]*phi_face[j][qp];
-
-    				// Right-hand-side contribution of the L2
-    				// projection.
-    				for (unsigned int i=0; i<phi_face.size(); i++)
-    				Fe(i) += JxW_face[qp]*penalty*value*phi_face[i][qp];
-    			}
-    		}
-    	}
-    }/*/
-
-    // We have now finished the quadrature point loop,
-    // and have therefore applied all the boundary conditions.
-    //
-    // The element matrix and right-hand-side are now built
-    // for this element.  Add them to the global matrix and
-    // right-hand-side vector.  The  SparseMatrix::add_matrix()
-    // and  NumericVector::add_vector() members do this for us.
-    //	system.matrix->add_matrix (Ke, dof_indices);
-    //	system.rhs->add_vector    (Fe, dof_indices);
-
-    delete []K;
-    delete []F;
-    delete []CB;
+      fe->reinit (elem);
 
+      F.assign(3*elem->n_nodes(), 0.0);
+      for (unsigned int qp=0; qp<qrule.n_points(); qp++)
+        for (unsigned int ii=0; ii<elem->n_nodes(); ii++)
+          for(unsigned int jj=0; jj<3; jj++)
+            F[ii*3+jj] += JxW[qp]*f[jj]*phi[ii][qp];
+
+      VecSetValues(b, dof_indices.size(), &dof_indices[0], &F[0], ADD_VALUES);
+    }
   }
 
-  // All done!
-}
+  VecAssemblyBegin(b);
+  VecAssemblyEnd(b);
 
-void StressSolver::build_rhs(Vec b)
-{
-  //std::cout<<"here b"<<std::endl;
+  STOP_LOG("build_rhs()", "StressSolver");
 }
-
@@ -0,0 +1,87 @@
+/********************************************************************************/
+/*     888888    888888888   88     888  88888   888      888    88888888       */
+/*   8       8   8           8 8     8     8      8        8    8               */
+/*  8            8           8  8    8     8      8        8    8               */
+/*  8            888888888   8   8   8     8      8        8     8888888        */
+/*  8      8888  8           8    8  8     8      8        8            8       */
+/*   8       8   8           8     8 8     8      8        8            8       */
+/*     888888    888888888  888     88   88888     88888888     88888888        */
+/*                                                                              */
+/*       A Three-Dimensional General Purpose Semiconductor Simulator.           */
+/*                                                                              */
+/*                                                                              */
+/*  Copyright (C) 2007-2008                                                     */
+/*  Cogenda Pte Ltd                                                             */
+/*                                                                              */
+/*  Please contact Cogenda Pte Ltd for license information                      */
+/*                                                                              */
+/*  Author: Gong Ding   gdiso@ustc.edu                                          */
+/*                                                                              */
+/********************************************************************************/
+
+
+#include <algorithm>
+#include <limits>
+
+#include "transient_breakpoints.h"
+#include "simulation_system.h"
+#include "electrical_source.h"
+#include "field_source.h"
+#include "log.h"
+
+
+void TransientBreakpoints::build(const SimulationSystem & system, double t_start, double t_stop)
+{
+  _points.clear();
+
+  // a fast periodic source may produce a lot of corners, they are resolved by limit_dt of sources anyway
+  const unsigned int max_points = 100000;
+
+  double t = t_start;
+  while( _points.size() < max_points )
+  {
+    double t_bp = system.get_electrical_source()->next_breakpoint(t);
+    t_bp = std::min(t_bp, system.get_field_source()->next_breakpoint(t));
+    if( t_bp > t_stop ) break;
+    _points.push_back(t_bp);
+    t = t_bp;
+  }
+
+  if( !_points.empty() )
+  {
+    MESSAGE<<"Transient step controller uses " << _points.size() << " breakpoints of source waveform." << std::endl;
+    RECORD();
+  }
+}
+
+
+std::vector<double>::const_iterator TransientBreakpoints::_next(double t, double tol) const
+{
+  return std::upper_bound(_points.begin(), _points.end(), t + tol);
+}
+
+
+double TransientBreakpoints::limit_dt(double clock, double dt, double dt_min) const
+{
+  if( _points.empty() ) return dt;
+
+  // breakpoints closer than this to clock are regarded as reached
+  const double tol = 1e-6*std::max(dt, dt_min);
+
+  std::vector<double>::const_iterator it = _next(clock, tol);
+  if( it == _points.end() ) return dt;
+
+  // just passed a breakpoint, restart with a step well inside the next interval
+  if( it != _points.begin() && clock - *(it-1) <= tol )
+  {
+    const double prev = *(it-1);
+    dt = std::min(dt, std::max(0.1*(*it - prev), dt_min));
+  }
+
+  const double distance = *it - clock;
+  if( distance <= dt )
+    return distance;
+  if( distance < 1.5*dt )
+    return 0.5*distance;
+  return dt;
+}
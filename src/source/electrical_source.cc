@@ -293,6 +293,23 @@ double ElectricalSource::limit_dt(double time, double dt, double dt_min, double
 
 
 
+double ElectricalSource::next_breakpoint(double t) const
+{
+  double t_bp = std::numeric_limits<double>::infinity();
+
+  CBIt it = _bc_source_map.begin();
+  for(; it!=_bc_source_map.end(); ++it)
+  {
+    for(unsigned int i=0; i<(*it).second.first.size(); ++i)
+      t_bp = std::min(t_bp, (*it).second.first[i]->next_breakpoint(t));
+    for(unsigned int i=0; i<(*it).second.second.size(); ++i)
+      t_bp = std::min(t_bp, (*it).second.second[i]->next_breakpoint(t));
+  }
+
+  return t_bp;
+}
+
+
 void ElectricalSource::update(double time)
 {
   BIt it = _bc_source_map.begin();
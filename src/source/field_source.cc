@@ -23,6 +23,7 @@
 #include <fstream>
 #include <sstream>
 #include <iomanip>
+#include <limits>
 
 
 #include "genius_common.h"
@@ -81,7 +82,7 @@ FieldSource::FieldSource(SimulationSystem & system, Parser::InputParser & decks)
         genius_error();
       }
 
-      if( c.is_enum_value("profile", "fromfile2d") || c.is_enum_value("profile", "fromfile3d") )
+      if( c.is_enum_value("profile", "fromfile2d") || c.is_enum_value("profile", "fromfile3d") || c.is_enum_value("profile", "montecarlo") )
       {
         Particle_Source * particle_source = new Particle_Source_DataFile(system, c);
         add_particle_source(particle_source);
@@ -181,15 +182,6 @@ void FieldSource::update(double time, bool force_update_system)
 
   if( _applied_to_system == false ) this->update_system();
 
-  // second order trapezoidal quadrature
-  double particle_gen_waveform = 0.0;
-  std::vector<Particle_Source *>::iterator pit = _particle_sources.begin();
-  for(; pit!=_particle_sources.end(); ++pit)
-  {
-    particle_gen_waveform += 0.5*((*pit)->carrier_generation(time) + (*pit)->carrier_generation(time-SolverSpecify::dt));
-  }
-
-
   double optical_gen_waveform = 1.0;
   if(current_waveform)
     optical_gen_waveform = 0.5*(current_waveform->waveform(time) + current_waveform->waveform(time-SolverSpecify::dt));
@@ -209,11 +201,6 @@ void FieldSource::update(double time, bool force_update_system)
 
         double G=0;
 
-        if(SolverSpecify::PatG)
-        {
-          G += fvm_node_data->PatG()*particle_gen_waveform;
-        }
-
         if(SolverSpecify::OptG)
         {
           G += fvm_node_data->OptG()*optical_gen_waveform;
@@ -223,6 +210,18 @@ void FieldSource::update(double time, bool force_update_system)
       }
     }
   }
+
+  // the spatial deposition of each particle source is cached, only scaled by its own time profile.
+  // second order trapezoidal quadrature
+  if(SolverSpecify::PatG)
+  {
+    std::vector<Particle_Source *>::iterator pit = _particle_sources.begin();
+    for(; pit!=_particle_sources.end(); ++pit)
+    {
+      double particle_gen_waveform = 0.5*((*pit)->carrier_generation(time) + (*pit)->carrier_generation(time-SolverSpecify::dt));
+      (*pit)->apply_carrier_generation(particle_gen_waveform);
+    }
+  }
 #if defined(HAVE_FENV_H) && defined(DEBUG)
   genius_assert( !fetestexcept(FE_INVALID) );
 #endif
@@ -244,6 +243,7 @@ void FieldSource::update_system()
         FVM_Node * fvm_node = (*it);
         FVM_NodeData * fvm_node_data = fvm_node->node_data();
         fvm_node_data->PatG() = 0.0;
+        fvm_node_data->PatE() = 0.0;
         fvm_node_data->OptG() = 0.0;
       }
     }
@@ -290,11 +290,34 @@ double FieldSource::limit_dt(double time, double dt) const
 }
 
 
+double FieldSource::next_breakpoint(double t) const
+{
+  double t_bp = std::numeric_limits<double>::infinity();
+
+  if(SolverSpecify::PatG)
+  {
+    std::vector<Particle_Source *>::const_iterator pit = _particle_sources.begin();
+    for(; pit!=_particle_sources.end(); ++pit)
+      t_bp = std::min(t_bp, (*pit)->next_breakpoint(t));
+  }
+
+  if(SolverSpecify::OptG && current_waveform)
+    t_bp = std::min(t_bp, current_waveform->next_breakpoint(t));
+
+  return t_bp;
+}
+
+
 bool FieldSource::request_serial_mesh() const
 {
   std::vector<Light_Source *>::const_iterator lit = _light_sources.begin();
   for(; lit!=_light_sources.end(); ++lit)
     if( (*lit)->light_source_type() == "light_source_raytracing") return true;
+
+  std::vector<Particle_Source *>::const_iterator pit = _particle_sources.begin();
+  for(; pit!=_particle_sources.end(); ++pit)
+    if( (*pit)->request_serial_mesh() ) return true;
+
   return false;
 }
 
@@ -25,6 +25,7 @@
 #endif
 
 #include <cmath>
+#include <algorithm>
 
 #include "parser.h"
 #include "plane.h"
@@ -106,6 +107,150 @@ LightLenses::~LightLenses()
 void LightLenses::set_lenses(const std::vector<std::string> & lens)
 {
   _effect_lenses = lens;
+
+  _active_lenses.clear();
+  for(unsigned int n=0; n<_effect_lenses.size(); ++n)
+    _active_lenses.push_back(_lenses.find(_effect_lenses[n])->second);
+
+  // lens arrays may have thousands of lenses, rays search them by a bounding volume hierarchy
+  _lens_tree.clear();
+  _lens_order.clear();
+  for(unsigned int n=0; n<_active_lenses.size(); ++n)
+    _lens_order.push_back(n);
+  if(!_lens_order.empty())
+    build_lens_tree(0, _lens_order.size());
+}
+
+
+namespace
+{
+  // order lenses by the center coordinate along an axis
+  struct LensCenterLess
+  {
+    LensCenterLess(const std::vector<Point> & c, unsigned int a) : centers(c), axis(a) {}
+    bool operator() (unsigned int a, unsigned int b) const
+    { return centers[a](axis) < centers[b](axis); }
+    const std::vector<Point> & centers;
+    unsigned int axis;
+  };
+}
+
+
+int LightLenses::build_lens_tree(unsigned int begin, unsigned int end)
+{
+  const int node = _lens_tree.size();
+  _lens_tree.push_back(LensBox());
+
+  // bounding box of the lens disks
+  LensBox box;
+  box.lo = Point( 1e30,  1e30,  1e30);
+  box.hi = Point(-1e30, -1e30, -1e30);
+  box.left = box.right = -1;
+  box.begin = begin;
+  box.end = end;
+  for(unsigned int n=begin; n<end; ++n)
+  {
+    const Lens * lens = _active_lenses[_lens_order[n]];
+    for(unsigned int i=0; i<3; ++i)
+    {
+      const double r = lens->radius*std::sqrt(std::max(0.0, 1.0 - lens->norm(i)*lens->norm(i))) + 1e-6*lens->radius;
+      box.lo(i) = std::min(box.lo(i), lens->center(i) - r);
+      box.hi(i) = std::max(box.hi(i), lens->center(i) + r);
+    }
+  }
+
+  const unsigned int leaf_size = 4;
+  if(end - begin > leaf_size)
+  {
+    // split at the median center along the longest axis of the centers
+    std::vector<Point> centers(_active_lenses.size());
+    Point clo( 1e30,  1e30,  1e30), chi(-1e30, -1e30, -1e30);
+    for(unsigned int n=begin; n<end; ++n)
+    {
+      const Point & c = _active_lenses[_lens_order[n]]->center;
+      centers[_lens_order[n]] = c;
+      for(unsigned int i=0; i<3; ++i)
+      {
+        clo(i) = std::min(clo(i), c(i));
+        chi(i) = std::max(chi(i), c(i));
+      }
+    }
+    unsigned int axis = 0;
+    for(unsigned int i=1; i<3; ++i)
+      if(chi(i) - clo(i) > chi(axis) - clo(axis)) axis = i;
+
+    const unsigned int mid = (begin + end)/2;
+    std::nth_element(_lens_order.begin()+begin, _lens_order.begin()+mid, _lens_order.begin()+end, LensCenterLess(centers, axis));
+
+    box.left  = build_lens_tree(begin, mid);
+    box.right = build_lens_tree(mid, end);
+  }
+
+  _lens_tree[node] = box;
+  return node;
+}
+
+
+const LightLenses::Lens * LightLenses::nearest_lens(const Point &p, const Point &dir, double &t) const
+{
+  t = 1e30;
+  const Lens * active_lens = 0;
+  unsigned int active_index = 0;
+
+  std::vector<int> stack;
+  stack.push_back(0);
+  while(!stack.empty())
+  {
+    const LensBox & box = _lens_tree[stack.back()];
+    stack.pop_back();
+
+    // slab test, skip the box beyond the nearest lens found
+    double tmin = 0.0, tmax = t;
+    bool hit = true;
+    for(unsigned int i=0; i<3 && hit; ++i)
+    {
+      if(dir(i) == 0.0)
+      {
+        hit = p(i) >= box.lo(i) && p(i) <= box.hi(i);
+        continue;
+      }
+      double t1 = (box.lo(i) - p(i))/dir(i);
+      double t2 = (box.hi(i) - p(i))/dir(i);
+      if(t1 > t2) std::swap(t1, t2);
+      tmin = std::max(tmin, t1);
+      tmax = std::min(tmax, t2);
+      hit = tmin <= tmax;
+    }
+    if(!hit) continue;
+
+    if(box.left >= 0)
+    {
+      stack.push_back(box.left);
+      stack.push_back(box.right);
+      continue;
+    }
+
+    for(unsigned int n=box.begin; n<box.end; ++n)
+    {
+      const unsigned int index = _lens_order[n];
+      const Lens * lens = _active_lenses[index];
+      Plane lens_plane(lens->center, lens->norm);
+      double dist;
+      if(lens_plane.intersect_point(p, dir, dist) )
+      {
+        if( (lens->center - (p + dist*dir) ).size() > lens->radius) continue;
+        // the first one in _effect_lenses wins at equal distance
+        if(dist > 0 && (dist < t || (dist == t && index < active_index)))
+        {
+          t = dist;
+          active_lens = lens;
+          active_index = index;
+        }
+      }
+    }
+  }
+
+  return active_lens;
 }
 
 
@@ -138,23 +283,8 @@ LightThread * LightLenses::operator << (LightThread *light) const
   do
   {
     //find intersection lens
-    double t=1e30;
-    const Lens * active_lens=0;
-    for(unsigned int n=0; n<_effect_lenses.size(); ++n)
-    {
-      const Lens * lens = _lenses.find(_effect_lenses[n])->second;
-      Plane lens_plane(lens->center, lens->norm);
-      double dist;
-      if(lens_plane.intersect_point(light->start_point(), light->dir(), dist) )
-      {
-        if( (lens->center - (light->start_point() + dist*light->dir()) ).size() > lens->radius) continue;
-        if(dist > 0 && dist<t)
-        {
-          t = dist;
-          active_lens = lens;
-        }
-      }
-    }
+    double t;
+    const Lens * active_lens = nearest_lens(light->start_point(), light->dir(), t);
 
     if(!active_lens)
     {
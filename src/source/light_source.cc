@@ -307,13 +307,42 @@ void Light_Source_Uniform::update_system()
 //-------------------------------------------------------------------------------------------
 
 #include "ray_tracing/ray_tracing.h"
+Light_Source_RayTracing::~Light_Source_RayTracing()
+{
+  release_solver();
+}
+
+
+void Light_Source_RayTracing::release_solver()
+{
+  if(_solver)
+  {
+    _solver->destroy_solver();
+    delete _solver;
+    _solver = 0;
+  }
+}
+
+
 void Light_Source_RayTracing::update_system()
 {
-  RayTraceSolver * solver = new RayTraceSolver(_system, _card);
-  solver->create_solver();
-  solver->solve();
-  solver->destroy_solver();
-  delete solver;
+  // only the carrier density changed since last trace, reuse the ray paths
+  if( _solver && _solver->has_ray_paths() && _solver_mesh_revision == _system.mesh_revision() )
+  {
+    _solver->update_free_carrier_absorption();
+    return;
+  }
+
+  release_solver();
+
+  _solver = new RayTraceSolver(_system, _card);
+  _solver->create_solver();
+  _solver->solve();
+  _solver_mesh_revision = _system.mesh_revision();
+
+  // keep the solver only if ray paths are recorded
+  if( !_solver->has_ray_paths() )
+    release_solver();
 }
 
 
@@ -26,6 +26,7 @@
 #include "mesh_base.h"
 #include "point_locator_base.h"
 #include "particle_source.h"
+#include "source_breakpoint.h"
 #include "simulation_system.h"
 #include "simulation_region.h"
 #include "semiconductor_region.h"
@@ -33,6 +34,7 @@
 //#include "interpolation_3d_qshep.h"
 #include "interpolation_3d_nbtet.h"
 #include "nearest_node_locator.h"
+#include "mc/mc_solver.h"
 #include "parallel.h"
 #include "mathfunc.h"
 #include "log.h"
@@ -80,9 +82,65 @@ double Particle_Source::limit_dt(double time, double dt) const
   return dt;
 }
 
+
+double Particle_Source::next_breakpoint(double t) const
+{
+  if(t<_t0) return _t0;
+  return step_next_breakpoint(t, _t_max);
+}
+
+
+void Particle_Source::update_system()
+{
+  // the spatial deposition only depends on mesh, build it once for each mesh
+  if( _deposition_mesh_revision != _system.mesh_revision() )
+  {
+    _deposition_node.clear();
+    _deposition_PatG.clear();
+    _deposition_PatE.clear();
+    _generation_index.clear();
+
+    build_deposition();
+
+    _deposition_mesh_revision = _system.mesh_revision();
+  }
+
+  for(unsigned int i=0; i<_deposition_node.size(); ++i)
+  {
+    FVM_NodeData * node_data = _deposition_node[i]->node_data();
+    node_data->PatG() += _deposition_PatG[i];
+    node_data->PatE() += _deposition_PatE[i];
+  }
+}
+
+
+void Particle_Source::apply_carrier_generation(double weight) const
+{
+  if( weight == 0.0 ) return;
+
+  for(unsigned int i=0; i<_generation_index.size(); ++i)
+  {
+    const unsigned int n = _generation_index[i];
+    _deposition_node[n]->node_data()->Field_G() += _deposition_PatG[n]*weight;
+  }
+}
+
+
+void Particle_Source::add_deposition(FVM_Node *fvm_node, double PatG, double PatE)
+{
+  // only semiconductor node has carrier generation
+  if( _system.region(fvm_node->subdomain_id())->type() == SemiconductorRegion )
+    _generation_index.push_back(_deposition_node.size());
+
+  _deposition_node.push_back(fvm_node);
+  _deposition_PatG.push_back(PatG);
+  _deposition_PatE.push_back(PatE);
+}
+
 //-------------------------------------------------------------------------------------------------------------------------
 
-Particle_Source_DataFile::Particle_Source_DataFile(SimulationSystem &system, const Parser::Card &c):Particle_Source(system)
+Particle_Source_DataFile::Particle_Source_DataFile(SimulationSystem &system, const Parser::Card &c)
+  :Particle_Source(system), _card(c), _montecarlo(false)
 {
   MESSAGE<<"Setting Radiation Source from data file..."; RECORD();
 
@@ -95,6 +153,10 @@ Particle_Source_DataFile::Particle_Source_DataFile(SimulationSystem &system, con
   if(c.is_enum_value("profile","fromfile3d"))
     set_particle_profile_fromfile3d(c);
 
+  // the mesh is not ready yet
+  if(c.is_enum_value("profile","montecarlo"))
+    _montecarlo = true;
+
   _t0     = c.get_real("t0", 0.0)*s;
   _t_max  = c.get_real("tmax", 0.0)*s;
   _t_char = c.get_real("t.char", 2e-12)*s;
@@ -246,8 +308,37 @@ void Particle_Source_DataFile::set_particle_profile_fromfile3d(const Parser::Car
 }
 
 
-void Particle_Source_DataFile::update_system()
+void Particle_Source_DataFile::set_particle_profile_montecarlo()
+{
+  interpolator = AutoPtr<InterpolationBase>(new Interpolation2D_CSA);
+  interpolator->set_interpolation_type(0, InterpolationBase::Asinh);
+
+  MonteCarloSolver solver(_system, _card);
+  solver.create_solver();
+  solver.solve();
+
+  // energy deposit is the same on all the processors
+  if(Genius::processor_id()==0)
+  {
+    std::vector<Point> points;
+    std::vector<double> energy;
+    solver.node_energy_density(points, energy);
+    for(unsigned int n=0; n<points.size(); ++n)
+      interpolator->add_scatter_data(points[n], 0, energy[n]);
+  }
+  solver.destroy_solver();
+
+  interpolator->broadcast(0);
+  interpolator->setup(0);
+}
+
+
+void Particle_Source_DataFile::build_deposition()
 {
+  // the profile by Monte-Carlo solver does not depend on mesh, solve it only once
+  if( _montecarlo && !interpolator.get() )
+    set_particle_profile_montecarlo();
+
   // interpolate to mesh node
   for(unsigned int n=0; n<_system.n_regions(); n++)
   {
@@ -260,10 +351,11 @@ void Particle_Source_DataFile::update_system()
     for(; it!=it_end; ++it)
     {
       FVM_Node * fvm_node = (*it);
-      FVM_NodeData * node_data = fvm_node->node_data();
 
       double E = interpolator->get_interpolated_value(*(fvm_node->root_node()), 0);
-      node_data->PatG() += 2*E/_quan_eff/_t_char/sqrt(3.1415926536)/(1+Erf((_t_max-_t0)/_t_char));
+      double PatG = 2*E/_quan_eff/_t_char/sqrt(3.1415926536)/(1+Erf((_t_max-_t0)/_t_char));
+      if( PatG != 0.0 )
+        add_deposition(fvm_node, PatG);
 
     }
   }
@@ -305,7 +397,7 @@ Particle_Source_Analytic::Particle_Source_Analytic(SimulationSystem &system, con
 
 
 
-void Particle_Source_Analytic::update_system()
+void Particle_Source_Analytic::build_deposition()
 {
   const double pi = 3.1415926536;
   bool is_2d = _system.mesh().mesh_dimension() == 2;
@@ -337,11 +429,12 @@ void Particle_Source_Analytic::update_system()
       double d = (p-_start).dot(_dir);
       double r = (p-_start - (p-_start).dot(_dir)*_dir).size();
 
-      FVM_NodeData * node_data = fvm_node->node_data();
       if(d < _length)
-        node_data->PatG() += G0*exp(-r*r/(_lateral_char*_lateral_char));
-      else
-        node_data->PatG() += 0;
+      {
+        double PatG = G0*exp(-r*r/(_lateral_char*_lateral_char));
+        if( PatG != 0.0 )
+          add_deposition(fvm_node, PatG);
+      }
     }
   }
 
@@ -446,9 +539,9 @@ void Particle_Source_Track::_read_particle_profile_track(const std::string & fil
 
 
 #if 1
-void Particle_Source_Track::update_system()
+void Particle_Source_Track::build_deposition()
 {
-  START_LOG("update_system()", "Particle_Source_Track");
+  START_LOG("build_deposition()", "Particle_Source_Track");
 
   MESSAGE<< "  process particle generation";
   RECORD();
@@ -456,11 +549,38 @@ void Particle_Source_Track::update_system()
   const double pi = 3.1415926536;
   genius_assert(_system.mesh().mesh_dimension() == 3);
 
-  std::vector<double> region_energy(_system.n_regions(), 0.0);
-  double total_energy=0.0;
-
   AutoPtr<NearestNodeLocator> nn_locator( new NearestNodeLocator(_system.mesh()) );
 
+  // bounding box of on processor nodes of each region, used for culling tracks far away from this processor
+  std::vector< std::pair<Point, Point> > region_bbox(_system.n_regions());
+  std::vector<bool> region_has_node(_system.n_regions(), false);
+  for(unsigned int r=0; r<_system.n_regions(); r++)
+  {
+    const SimulationRegion * region = _system.region(r);
+    Point pmin( std::numeric_limits<Real>::max(),  std::numeric_limits<Real>::max(),  std::numeric_limits<Real>::max());
+    Point pmax(-std::numeric_limits<Real>::max(), -std::numeric_limits<Real>::max(), -std::numeric_limits<Real>::max());
+
+    SimulationRegion::const_processor_node_iterator it = region->on_processor_nodes_begin();
+    SimulationRegion::const_processor_node_iterator it_end = region->on_processor_nodes_end();
+    for(; it!=it_end; ++it)
+    {
+      const Point & p = *((*it)->root_node());
+      for(unsigned int d=0; d<3; ++d)
+      {
+        pmin(d) = std::min(pmin(d), p(d));
+        pmax(d) = std::max(pmax(d), p(d));
+      }
+      region_has_node[r] = true;
+    }
+    region_bbox[r] = std::make_pair(pmin, pmax);
+  }
+
+  // energy density of each track on this processor, as flat arrays indexed by track_offset
+  std::vector<unsigned int> track_offset(1, 0);
+  std::vector<FVM_Node *>   track_node;
+  std::vector<double>       track_energy_density;
+  std::vector<double>       track_energy(_tracks.size(), 0.0);
+
   for(unsigned int t=0; t<_tracks.size(); ++t)
   {
     if( t%(1+_tracks.size()/20) ==0 )
@@ -472,24 +592,15 @@ void Particle_Source_Track::update_system()
     const track_t & track = _tracks[t];
     genius_assert(track.energy > 0.0 && (track.end - track.start).size() > 0.0);
 
-    /*
-    // prevent bad tracks
-    int bad_track = 0;
-    if( track.energy == 0.0 || (track.end - track.start).size() == 0.0) bad_track=1;
-    Parallel::broadcast(bad_track);
-    if(bad_track) continue;
-    */
-
-    double track_energy = 0.0;
-    std::map<FVM_Node *, double> track_energy_density;
-
     const Point track_dir = (track.end - track.start).unit(); // track direction
     const double ed = track.energy/(track.end - track.start).size(); // linear energy density
     const double lateral_char = track.lateral_char;
+
     // find the nodes that near the track
     for(unsigned int r=0; r<_system.n_regions(); r++)
     {
       const SimulationRegion * region = _system.region(r);
+      if( !region_has_node[r] ) continue;
 
       // fast return
       const std::pair<Point, Real> bsphere = region->boundingsphere();
@@ -497,6 +608,15 @@ void Particle_Source_Track::update_system()
       const double diag = 0.5*(track.start-track.end).size();
       if( (bsphere.first - cent).size() > bsphere.second + diag + 5*lateral_char ) continue;
 
+      // the box of track, extended by lateral range, should overlap the box of on processor nodes
+      bool overlap = true;
+      for(unsigned int d=0; d<3; ++d)
+      {
+        const double tmin = std::min(track.start(d), track.end(d)) - 5*lateral_char;
+        const double tmax = std::max(track.start(d), track.end(d)) + 5*lateral_char;
+        if( tmax < region_bbox[r].first(d) || tmin > region_bbox[r].second(d) ) overlap = false;
+      }
+      if( !overlap ) continue;
 
       std::vector<const Node *> nn = nn_locator->nearest_nodes(track.start, track.end, 5*lateral_char, r);
       for(unsigned int n=0; n<nn.size(); ++n)
@@ -510,79 +630,69 @@ void Particle_Source_Track::update_system()
         double e_r = exp(-r*r/(lateral_char*lateral_char));
         double e_z = Erf((loc_pp-track.start)*track_dir/lateral_char) - Erf((loc_pp-track.end)*track_dir/lateral_char);
         double energy_density = ed/(2*pi*lateral_char*lateral_char)*e_r*e_z;
-        track_energy += energy_density*fvm_node->volume();
-        track_energy_density[fvm_node] += energy_density;
+        track_energy[t] += energy_density*fvm_node->volume();
+        track_node.push_back(fvm_node);
+        track_energy_density.push_back(energy_density);
       }
     }
+    track_offset.push_back(track_node.size());
+  }
 
-    Parallel::sum(track_energy);
+  // one collective operation for all the tracks
+  Parallel::sum(track_energy);
 
-    if(track_energy > 0.0)
-    {
-      double alpha = track.energy/track_energy; //used for keep energy conservation track.energy;
-      std::map<FVM_Node *, double>::const_iterator it = track_energy_density.begin();
-      for(; it != track_energy_density.end(); ++it)
-      {
-        FVM_Node * fvm_node = it->first;
-        if(!fvm_node) continue;
-
-        double energy_density = it->second;
-
-        SimulationRegion * region = _system.region(fvm_node->subdomain_id());
-        //if( region->type() != SemiconductorRegion) continue;
-
-        if(fvm_node && fvm_node->on_local())
-        {
-          FVM_NodeData * node_data = fvm_node->node_data();
-          node_data->PatG() += alpha*energy_density/_quan_eff/(_t_char/2.0*sqrt(pi)*(1+Erf((_t_max-_t0)/_t_char)));
-          node_data->PatE() += alpha*energy_density;
-          total_energy += alpha*energy_density*fvm_node->volume();
-          region_energy[ fvm_node->subdomain_id() ] += alpha*energy_density*fvm_node->volume();
-        }
-      }
-    }
-    else
+  // track without node nearby deposits all its energy to the nearest node
+  std::vector<double> nearest_distance(_tracks.size(), std::numeric_limits<double>::infinity());
+  std::vector<FVM_Node *> nearest_node(_tracks.size(), 0);
+  for(unsigned int t=0; t<_tracks.size(); ++t)
+  {
+    if( track_energy[t] > 0.0 ) continue;
+
+    const track_t & track = _tracks[t];
+    for(unsigned int r=0; r<_system.n_regions(); r++)
     {
-      // find the nearest node of the track
-      FVM_Node * neraset_node=0;
-      double distance=std::numeric_limits<double>::infinity();
-      for(unsigned int r=0; r<_system.n_regions(); r++)
-      {
-        const SimulationRegion * region = _system.region(r);
-        double dist;
-        const Node * n = nn_locator->nearest_node(0.5*(track.start+track.end), r, dist);
-        if(n == NULL) continue;
+      const SimulationRegion * region = _system.region(r);
+      double dist;
+      const Node * n = nn_locator->nearest_node(0.5*(track.start+track.end), r, dist);
+      if(n == NULL) continue;
 
-        FVM_Node * fvm_node = region->region_fvm_node(n); // may be NULL, if not on local
-        if(!fvm_node || !fvm_node->on_processor()) continue;
+      FVM_Node * fvm_node = region->region_fvm_node(n); // may be NULL, if not on local
+      if(!fvm_node || !fvm_node->on_processor()) continue;
 
-        if( dist < distance)
-        {
-          distance = dist;
-          neraset_node = fvm_node;
-        }
+      if( dist < nearest_distance[t])
+      {
+        nearest_distance[t] = dist;
+        nearest_node[t] = fvm_node;
       }
+    }
+  }
 
-      double min_distance=distance;
-      Parallel::min(min_distance);
+  std::vector<double> min_distance = nearest_distance;
+  Parallel::min(min_distance);
 
-      if( min_distance == distance && neraset_node)
+  const double time_norm = _quan_eff*(_t_char/2.0*sqrt(pi)*(1+Erf((_t_max-_t0)/_t_char)));
+  for(unsigned int t=0; t<_tracks.size(); ++t)
+  {
+    if(track_energy[t] > 0.0)
+    {
+      double alpha = _tracks[t].energy/track_energy[t]; //used for keep energy conservation track.energy;
+      for(unsigned int i=track_offset[t]; i<track_offset[t+1]; ++i)
       {
-        double energy_density = track.energy/neraset_node->volume();
-        FVM_NodeData * node_data = neraset_node->node_data();
-        node_data->PatG() += energy_density/_quan_eff/(_t_char/2.0*sqrt(pi)*(1+Erf((_t_max-_t0)/_t_char)));
-        node_data->PatE() += energy_density;
-        total_energy += track.energy;
-        region_energy[neraset_node->subdomain_id()] += track.energy;
+        double energy_density = alpha*track_energy_density[i];
+        add_deposition(track_node[i], energy_density/time_norm, energy_density);
       }
     }
-
+    else if( min_distance[t] == nearest_distance[t] && nearest_node[t] )
+    {
+      double energy_density = _tracks[t].energy/nearest_node[t]->volume();
+      add_deposition(nearest_node[t], energy_density/time_norm, energy_density);
+    }
   }
 
   MESSAGE<< "ok" <<std::endl;
   RECORD();
 
-  STOP_LOG("update_system()", "Particle_Source_Track");
+  STOP_LOG("build_deposition()", "Particle_Source_Track");
 
 }
 
@@ -21,6 +21,7 @@
 
 #include <fstream>
 #include <cassert>
+#include <algorithm>
 
 #include "waveform.h"
 
@@ -60,6 +61,10 @@ WaveformShell::WaveformShell(const std::string & s, const std::string & dll_file
   Waveform_Shell = (double (*)(double)) fp;
 
   scale_t = s_t;
+
+  _cache_t[0] = _cache_t[1] = std::numeric_limits<double>::quiet_NaN();
+  _cache_v[0] = _cache_v[1] = 0.0;
+  _cache_next = 0;
 }
 
   /**
@@ -80,7 +85,7 @@ WaveformShell::~WaveformShell()
 //-------------------------------------------------------------------------------
 #include "monot_cubic_interpolator.h"
 
-WaveformFile::WaveformFile(const std::string & s, const std::string & filename):Waveform(s)
+WaveformFile::WaveformFile(const std::string & s, const std::string & filename):Waveform(s), _hint(0)
 {
   if(Genius::processor_id()==0)
   {
@@ -102,25 +107,63 @@ WaveformFile::WaveformFile(const std::string & s, const std::string & filename):
   Parallel::broadcast(_time);
   Parallel::broadcast(_wave);
 
-  _int = new MonotCubicInterpolator(_time, _wave);
+  if(_time.empty()) return;
+
+  // the spline sorts the data and computes the monotone derivatives,
+  // keep them as flat arrays for the hinted evaluation
+  MonotCubicInterpolator interpolator(_time, _wave);
+  _time  = interpolator.get_xVector();
+  _wave  = interpolator.get_fVector();
+  _dwave = interpolator.get_dVector();
 }
 
 
 WaveformFile::~WaveformFile()
-{
-  delete _int;
-}
+{}
 
 
 
 double WaveformFile::waveform(double t)
 {
   if(_time.empty()) return 0.0;
-  if( t <_int->getMinimumX().first ) return 0.0;
-  if( t >_int->getMaximumX().first ) return 0.0;
-  return _int->evaluate(t);
-}
+  if( t < _time.front() ) return 0.0;
+  if( t > _time.back() ) return 0.0;
+  if( _time.size() == 1 ) return _wave[0];
+
+  // search from the interval of last call, fall back to bisection
+  const unsigned int n = _time.size();
+  if( _hint+1 >= n ) _hint = n-2;
+  if( !(_time[_hint] <= t && t <= _time[_hint+1]) )
+  {
+    if( _hint+2 < n && _time[_hint+1] < t && t <= _time[_hint+2] )
+      ++_hint;
+    else
+    {
+      std::vector<double>::const_iterator it = std::upper_bound(_time.begin(), _time.end(), t);
+      _hint = std::min(static_cast<unsigned int>(it - _time.begin()), n-1) - 1;
+    }
+  }
 
+  const double x1 = _time[_hint], x2 = _time[_hint+1];
+  const double f1 = _wave[_hint], f2 = _wave[_hint+1];
+  const double h  = x2 - x1;
 
+  // linear interpolation if derivative data is not available
+  if( _dwave.empty() )
+    return f1 + (f2 - f1)/h*(t - x1);
+
+  // cubic Hermite spline, same as MonotCubicInterpolator::evaluate
+  const double s  = (t - x1)/h;
+  const double s2 = s*s, s3 = s2*s;
+  return f1*(2*s3 - 3*s2 + 1) + _dwave[_hint]*(s3 - 2*s2 + s)*h
+       + f2*(-2*s3 + 3*s2)    + _dwave[_hint+1]*(s3 - s2)*h;
+}
 
 
+double WaveformFile::next_breakpoint(double t) const
+{
+  std::vector<double>::const_iterator it = std::upper_bound(_time.begin(), _time.end(), t);
+  if( it == _time.end() ) return std::numeric_limits<double>::infinity();
+  return *it;
+}
+
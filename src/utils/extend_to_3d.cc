@@ -24,7 +24,6 @@
 #include "simulation_system.h"
 #include "simulation_region.h"
 #include "extend_to_3d.h"
-#include "mesh_communication.h"
 #include "parallel.h"
 #include "mesh_tools.h"
 #include "boundary_info.h"
@@ -101,6 +100,9 @@ void ExtendTo3D::save_old_system()
     }
   }
 
+  // the 2d mesh is small, each processor extrudes it by itself
+  this->broadcast_old_mesh();
+
 
   // save solutions
   variables["T"     ].resize(_system.n_regions());
@@ -144,6 +146,51 @@ void ExtendTo3D::save_old_system()
 }
 
 
+void ExtendTo3D::broadcast_old_mesh()
+{
+  Parallel::broadcast(magic_num);
+  Parallel::broadcast(n_nodes);
+  Parallel::broadcast(n_elem);
+  Parallel::broadcast(n_subs);
+
+  {
+    std::vector<Real> pts;
+    for(unsigned int n=0; n<mesh_points.size(); ++n)
+    {
+      pts.push_back(mesh_points[n].x());
+      pts.push_back(mesh_points[n].y());
+    }
+    Parallel::broadcast(pts);
+    mesh_points.resize(n_nodes);
+    for(unsigned int n=0; n<n_nodes; ++n)
+      mesh_points[n] = Point(pts[2*n], pts[2*n+1], 0.0);
+  }
+
+  Parallel::broadcast(mesh_conn);
+  Parallel::broadcast(subdomain_label);
+  Parallel::broadcast(subdomain_material);
+  Parallel::broadcast(bd_elems);
+  Parallel::broadcast(bd_sides);
+  Parallel::broadcast(bd_ids);
+
+  {
+    std::vector<std::string> bd_labels;
+    std::vector<int>         bd_label_ids;
+    for(Bd_It it = bd_map.begin(); it!=bd_map.end(); ++it)
+    {
+      bd_labels.push_back(it->first);
+      bd_label_ids.push_back(it->second.first);
+      bd_label_ids.push_back(it->second.second);
+    }
+    Parallel::broadcast(bd_labels);
+    Parallel::broadcast(bd_label_ids);
+    bd_map.clear();
+    for(unsigned int n=0; n<bd_labels.size(); ++n)
+      bd_map.insert(std::make_pair(bd_labels[n], std::make_pair(static_cast<short int>(bd_label_ids[2*n]), bd_label_ids[2*n+1]!=0)));
+  }
+}
+
+
 void ExtendTo3D::pack_element (std::vector<int> &conn, const Elem* elem) const
 {
   assert (elem != NULL);
@@ -169,10 +216,11 @@ void ExtendTo3D::set_new_system()
 {
   MeshBase & mesh = _system.mesh();
 
-  std::map<const Node *, unsigned int> node_to_old_node_id;
+  // the new nodes in the order of creation, old node id is the index modulo n_nodes
+  std::vector<const Node *> new_nodes;
 
-  // set new mesh
-  if(Genius::processor_id() == 0)
+  // set new mesh. every processor builds the same mesh from the 2d one,
+  // which avoids broadcasting the much larger 3d mesh
   {
     mesh.magic_num() = magic_num + 2008;
 
@@ -181,15 +229,16 @@ void ExtendTo3D::set_new_system()
     double zmax = _card.get_real("z.max", 1.0, "z.back")*um;
     int    zdiv = _card.get_int("n.spaces", 1);
 
+    mesh.reserve_nodes( (zdiv+1)*n_nodes );
+    mesh.reserve_elem( zdiv*n_elem );
+
     // set new points
+    new_nodes.reserve( (zdiv+1)*n_nodes );
     for(int z=0; z<=zdiv; ++z)
     {
       double zloc = zmin + z*(zmax - zmin)/zdiv;
       for(unsigned n=0; n<n_nodes; ++n)
-      {
-        Node * node = mesh.add_point(Point(mesh_points[n].x(), mesh_points[n].y(), zloc));
-        node_to_old_node_id[node] = n;
-      }
+        new_nodes.push_back( mesh.add_point(Point(mesh_points[n].x(), mesh_points[n].y(), zloc)) );
     }
 
     // set new elem
@@ -302,21 +351,22 @@ void ExtendTo3D::set_new_system()
       mesh.boundary_info->set_label_to_id(it->second.first, it->first, it->second.second);
   }
 
-  // broadcast mesh to all the processor
-  MeshCommunication mesh_comm;
-  mesh_comm.broadcast(mesh);
+  // the 2d mesh is no longer needed
+  std::vector<Point>().swap(mesh_points);
+  std::vector<int>().swap(mesh_conn);
 
   // build simulation system
   _system.build_simulation_system();
   _system.sync_print_info();
 
 
-  // set renumbered node id to original node id map
+  // set renumbered node id to original node id map.
+  // only processor 0 keeps all the nodes after building the system
   if(Genius::processor_id() == 0)
   {
-    std::map<const Node *, unsigned int>::iterator  it=node_to_old_node_id.begin();
-    for(; it!=node_to_old_node_id.end(); ++it)
-      _node_to_old_node_id_map[it->first->id()] = it->second;
+    _node_to_old_node_id_map.resize(mesh.max_node_id(), invalid_uint);
+    for(unsigned int i=0; i<new_nodes.size(); ++i)
+      _node_to_old_node_id_map[new_nodes[i]->id()] = i%n_nodes;
   }
 
   Parallel::broadcast(_node_to_old_node_id_map);
@@ -27,11 +27,12 @@
 
 #include "petscmat.h"
 #include "parallel.h"
+#include "mat_analysis.h"
 
 
 
 
-void  mat_analysis(const Mat mat)
+void  mat_analysis(const Mat mat, MatAnalysisInfo &info)
 {
   PetscBool assembled;
   MatAssembled(mat, &assembled);
@@ -56,6 +57,10 @@ void  mat_analysis(const Mat mat)
   std::vector<PetscInt> cols;
   std::vector<PetscScalar> values;
 
+  // diagonal and sum of off-diagonal entries of each local row
+  PetscInt zero_diagonal_rows = 0;
+  PetscInt weak_diagonal_rows = 0;
+
   // read the row
   for(PetscInt row=row_begin; row<row_end; row++)
   {
@@ -65,13 +70,19 @@ void  mat_analysis(const Mat mat)
 
     MatGetRow(mat, row, &ncols, &row_cols_pointer, &row_vals_pointer);
 
+    PetscScalar diag = 0.0, off_diag = 0.0;
     for(PetscInt c=0; c<ncols; c++)
     {
       PetscInt col = row_cols_pointer[c];
       rows.push_back(row);
       cols.push_back(col);
       values.push_back(fabs(row_vals_pointer[c]));
+
+      if( col == row ) diag = fabs(row_vals_pointer[c]);
+      else off_diag += fabs(row_vals_pointer[c]);
     }
+    if( diag == 0.0 ) zero_diagonal_rows++;
+    else if( diag < off_diag ) weak_diagonal_rows++;
 
     // restore pointers
     MatRestoreRow(mat, row, &ncols, &row_cols_pointer, &row_vals_pointer);
@@ -81,12 +92,21 @@ void  mat_analysis(const Mat mat)
   Parallel::gather(0, rows);
   Parallel::gather(0, cols);
   Parallel::gather(0, values);
-
-  if( Genius::is_first_processor() )
+  Parallel::sum(zero_diagonal_rows);
+  Parallel::sum(weak_diagonal_rows);
+
+  info.M = M;
+  info.N = N;
+  info.nnz = values.size();
+  info.max_entry = 0.0;
+  info.unsymmetric_rate = 0.0;
+  info.zero_diagonal_rows = zero_diagonal_rows;
+  info.weak_diagonal_rows = weak_diagonal_rows;
+
+  if( Genius::is_first_processor() && !values.empty() )
   {
-    std::cout<< "Matrix has dimension of " << M << "x" << N <<" with " << values.size() << " fill in values" << std::endl;
     // find the max abs value of matrix
-    std::cout<< "Max matrix entry is: " << *( std::max_element( values.begin(), values.end() ) ) << std::endl;
+    info.max_entry = *( std::max_element( values.begin(), values.end() ) );
 
     // find the unsymmetric rate of the matrix
     std::set< std::pair<PetscInt, PetscInt> > mat_entry_set;
@@ -99,8 +119,24 @@ void  mat_analysis(const Mat mat)
       if( mat_entry_set.find(std::make_pair(cols[n], rows[n])) == mat_entry_set.end() )
         n_unsymmetric_entry++;
     }
-    std::cout<< "Unsymmetric matrix entries: " << n_unsymmetric_entry
-    << " , rate " << n_unsymmetric_entry/double(values.size()) << std::endl;
+    info.unsymmetric_rate = n_unsymmetric_entry/double(values.size());
+  }
+}
+
+
+void  mat_analysis(const Mat mat)
+{
+  MatAnalysisInfo info;
+  mat_analysis(mat, info);
+
+  if( Genius::is_first_processor() )
+  {
+    std::cout<< "Matrix has dimension of " << info.M << "x" << info.N <<" with " << info.nnz << " fill in values" << std::endl;
+    std::cout<< "Max matrix entry is: " << info.max_entry << std::endl;
+    std::cout<< "Unsymmetric matrix entries: " << static_cast<PetscInt>(info.unsymmetric_rate*info.nnz+0.5)
+    << " , rate " << info.unsymmetric_rate << std::endl;
+    std::cout<< "Rows with zero diagonal: " << info.zero_diagonal_rows
+    << " , not diagonally dominant: " << info.weak_diagonal_rows << std::endl;
   }
 }
 
@@ -271,6 +271,24 @@ get_fVector() const
 }
 
 
+vector<double>
+MonotCubicInterpolator::
+get_dVector() const
+{
+  vector<double> outputvector;
+  if (ddata.size() != data.size()) {
+    return outputvector;
+  }
+
+  map<double,double>::const_iterator xf_iterator;
+  outputvector.reserve(data.size());
+  for (xf_iterator = data.begin(); xf_iterator != data.end(); ++xf_iterator) {
+    outputvector.push_back(ddata[xf_iterator->first]);
+  }
+  return outputvector;
+}
+
+
 
 string
 MonotCubicInterpolator::
@@ -23,6 +23,7 @@
 #include <set>
 #include "mesh_base.h"
 #include "nearest_node_locator.h"
+#include "space_filling_curve.h"
 #include "perf_log.h"
 
 
@@ -141,3 +142,43 @@ void NearestNodeLocator::nearest_nodes(const Point &p1, const Point &p2, Real ra
 
 
 
+void NearestNodeLocator::nearest_node(const std::vector<Point> &points, unsigned int subdomain,
+                                      std::vector<const Node *> &nodes, std::vector<Real> &dists) const
+{
+  nodes.resize(points.size());
+  dists.resize(points.size());
+
+  std::vector<unsigned int> order;
+  SpaceFillingCurve::morton_order(points, order);
+
+  const int n_points = static_cast<int>(points.size());
+#ifdef HAVE_OPENMP
+  #pragma omp parallel for schedule(static)
+#endif
+  for(int i=0; i<n_points; ++i)
+  {
+    const unsigned int n = order[i];
+    nodes[n] = this->nearest_node(points[n], subdomain, dists[n]);
+  }
+}
+
+
+void NearestNodeLocator::nearest_nodes(const std::vector<Point> &points, Real radius, unsigned int subdomain,
+                                       std::vector< std::vector<const Node *> > &nns) const
+{
+  nns.resize(points.size());
+
+  std::vector<unsigned int> order;
+  SpaceFillingCurve::morton_order(points, order);
+
+  const int n_points = static_cast<int>(points.size());
+#ifdef HAVE_OPENMP
+  #pragma omp parallel for schedule(dynamic, 64)
+#endif
+  for(int i=0; i<n_points; ++i)
+  {
+    const unsigned int n = order[i];
+    nns[n] = this->nearest_nodes(points[n], radius, subdomain);
+  }
+}
+
@@ -0,0 +1,124 @@
+/********************************************************************************/
+/*     888888    888888888   88     888  88888   888      888    88888888       */
+/*   8       8   8           8 8     8     8      8        8    8               */
+/*  8            8           8  8    8     8      8        8    8               */
+/*  8            888888888   8   8   8     8      8        8     8888888        */
+/*  8      8888  8           8    8  8     8      8        8            8       */
+/*   8       8   8           8     8 8     8      8        8            8       */
+/*     888888    888888888  888     88   88888     88888888     88888888        */
+/*                                                                              */
+/*       A Three-Dimensional General Purpose Semiconductor Simulator.           */
+/*                                                                              */
+/*                                                                              */
+/*  Copyright (C) 2007-2008                                                     */
+/*  Cogenda Pte Ltd                                                             */
+/*                                                                              */
+/*  Please contact Cogenda Pte Ltd for license information                      */
+/*                                                                              */
+/*  Author: Gong Ding   gdiso@ustc.edu                                          */
+/*                                                                              */
+/********************************************************************************/
+
+// C++ includes
+#include <new>
+#include <cstdlib>
+
+// Local includes
+#include "object_pool.h"
+
+
+ObjectPool::SizeClass ObjectPool::_size_class[ObjectPool::max_block_size/ObjectPool::alignment];
+
+// each chunk holds at least 256 blocks
+static const std::size_t chunk_blocks = 256;
+
+
+static inline std::size_t size_class_index(std::size_t size)
+{
+  return size ? (size-1)/ObjectPool::alignment : 0;
+}
+
+
+void * ObjectPool::allocate(std::size_t size)
+{
+  if( size > max_block_size ) return ::operator new(size);
+
+  const std::size_t index = size_class_index(size);
+  SizeClass & sc = _size_class[index];
+  sc.alive++;
+
+  // reuse a freed block
+  if( sc.free_list )
+  {
+    void * p = sc.free_list;
+    sc.free_list = *static_cast<void **>(p);
+    return p;
+  }
+
+  // open a new chunk
+  const std::size_t block_size = (index+1)*alignment;
+  if( sc.cur == sc.end )
+  {
+    char * chunk = static_cast<char *>( std::malloc(alignment + chunk_blocks*block_size) );
+    if( !chunk ) { sc.alive--; throw std::bad_alloc(); }
+    *reinterpret_cast<char **>(chunk) = sc.chunks;
+    sc.chunks = chunk;
+    sc.n_chunks++;
+    sc.cur = chunk + alignment;
+    sc.end = sc.cur + chunk_blocks*block_size;
+  }
+
+  void * p = sc.cur;
+  sc.cur += block_size;
+  return p;
+}
+
+
+void ObjectPool::deallocate(void * p, std::size_t size)
+{
+  if( !p ) return;
+  if( size > max_block_size ) { ::operator delete(p); return; }
+
+  SizeClass & sc = _size_class[size_class_index(size)];
+  *static_cast<void **>(p) = sc.free_list;
+  sc.free_list = p;
+  sc.alive--;
+}
+
+
+void ObjectPool::release()
+{
+  for(std::size_t i=0; i<max_block_size/alignment; ++i)
+  {
+    SizeClass & sc = _size_class[i];
+    if( sc.alive ) continue;
+
+    while( sc.chunks )
+    {
+      char * next = *reinterpret_cast<char **>(sc.chunks);
+      std::free(sc.chunks);
+      sc.chunks = next;
+    }
+    sc.n_chunks = 0;
+    sc.free_list = 0;
+    sc.cur = sc.end = 0;
+  }
+}
+
+
+std::size_t ObjectPool::n_alive()
+{
+  std::size_t n = 0;
+  for(std::size_t i=0; i<max_block_size/alignment; ++i)
+    n += _size_class[i].alive;
+  return n;
+}
+
+
+std::size_t ObjectPool::memory()
+{
+  std::size_t m = 0;
+  for(std::size_t i=0; i<max_block_size/alignment; ++i)
+    m += _size_class[i].n_chunks*(alignment + chunk_blocks*(i+1)*alignment);
+  return m;
+}
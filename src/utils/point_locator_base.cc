@@ -26,6 +26,7 @@
 #include "point_locator_base.h"
 #include "point_locator_tree.h"
 #include "point_locator_list.h"
+#include "point.h"
 
 
 
@@ -52,6 +53,18 @@ PointLocatorBase::~PointLocatorBase ()
 
 
 
+void PointLocatorBase::locate_points (const std::vector<Point>& points,
+                                      std::vector<const Elem*>& elems) const
+{
+  elems.resize(points.size());
+  for (unsigned int i=0; i<points.size(); i++)
+    elems[i] = (*this)(points[i]);
+}
+
+
+
+
+
 AutoPtr<PointLocatorBase> PointLocatorBase::build (const PointLocatorType t,
 						   const MeshBase& mesh,
 						   const PointLocatorBase* master)
@@ -27,6 +27,7 @@
 #include "tree.h"
 #include "point_locator_tree.h"
 #include "mesh_tools.h"
+#include "space_filling_curve.h"
 
 
 
@@ -175,44 +176,85 @@ const Elem* PointLocatorTree::operator() (const Point& p) const
   assert (this->_initialized);
 
   // First check the element from last time before asking the tree
-  if (this->_element==NULL || !(this->_element->contains_point(p)))
+  this->_element = this->locate(p, this->_element);
+
+  // return the element
+  return this->_element;
+}
+
+
+
+void PointLocatorTree::locate_points (const std::vector<Point>& points,
+                                      std::vector<const Elem*>& elems) const
+{
+  assert (this->_initialized);
+
+  elems.resize(points.size());
+
+  // visit the points along Morton curve, the successive points are close to each other
+  std::vector<unsigned int> order;
+  SpaceFillingCurve::morton_order(points, order);
+
+  const int n_points = static_cast<int>(points.size());
+
+#ifdef HAVE_OPENMP
+  #pragma omp parallel
+#endif
+  {
+    // each thread keeps its own start guess
+    const Elem* hint = NULL;
+
+#ifdef HAVE_OPENMP
+    #pragma omp for schedule(static)
+#endif
+    for (int i=0; i<n_points; ++i)
     {
-	// ask the tree
-	this->_element = this->_tree->find_element (p);
+      const unsigned int n = order[i];
+      const Elem* elem = this->locate(points[n], hint);
+      if (elem != NULL) hint = elem;
+      elems[n] = elem;
+    }
+  }
+}
 
-	if (this->_element == NULL)
-	  {
-	      // No element seems to contain this point.  If out-of-mesh
-	      // mode is enabled, just return NULL.  If not, however, we
-	      // have to perform a linear search before we call \p
-	      // genius_error() since in the case of curved elements, the
-	      // bounding box computed in \p TreeNode::insert(const
-	      // Elem*) might be slightly inaccurate.
-	    if(!_out_of_mesh_mode)
-	      {
-		MeshBase::const_element_iterator       pos     = this->_mesh.active_elements_begin();
-		const MeshBase::const_element_iterator end_pos = this->_mesh.active_elements_end();
-
-		for ( ; pos != end_pos; ++pos)
-		  if ((*pos)->contains_point(p))
-		    return this->_element = (*pos);
-
-		if (this->_element == NULL)
-		  {
-		    std::cerr << std::endl
-			      << " ******** Serious Problem.  Could not find an Element "
-			      << "in the Mesh"
-			      << std:: endl
-			      << " ******** that contains the Point "
-			      << p;
-		    genius_error();
-		  }
-	      }
-	  }
+
+
+const Elem* PointLocatorTree::locate (const Point& p, const Elem* hint) const
+{
+  if (hint!=NULL && hint->contains_point(p))
+    return hint;
+
+  // ask the tree
+  const Elem* elem = this->_tree->find_element (p);
+
+  if (elem == NULL)
+  {
+    // No element seems to contain this point.  If out-of-mesh
+    // mode is enabled, just return NULL.  If not, however, we
+    // have to perform a linear search before we call \p
+    // genius_error() since in the case of curved elements, the
+    // bounding box computed in \p TreeNode::insert(const
+    // Elem*) might be slightly inaccurate.
+    if(!_out_of_mesh_mode)
+    {
+      MeshBase::const_element_iterator       pos     = this->_mesh.active_elements_begin();
+      const MeshBase::const_element_iterator end_pos = this->_mesh.active_elements_end();
+
+      for ( ; pos != end_pos; ++pos)
+        if ((*pos)->contains_point(p))
+          return (*pos);
+
+      std::cerr << std::endl
+                << " ******** Serious Problem.  Could not find an Element "
+                << "in the Mesh"
+                << std:: endl
+                << " ******** that contains the Point "
+                << p;
+      genius_error();
     }
+  }
 
-  // return the element
-  return this->_element;
+  return elem;
 }
 
 
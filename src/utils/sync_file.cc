@@ -23,80 +23,188 @@
 
 #include "genius_common.h"
 #include <cstring>
+#include <climits>
 #include <iostream>
 #include <fstream>
 #include <sstream>
 #include <string>
 #include "parallel.h"
+#include "sync_file.h"
 
-/**
- * transport text file to other processor,
- * return local name as filename.processor_id 
- */
-const std::string sync_file(const char * filename)
+
+SharedFile::SharedFile(const std::string & filename)
+  : _good(false), _data(0), _size(0)
 {
 #ifdef HAVE_MPI
-  // buffer for file text
-  std::string   str;
-  
-  // read only at processor 0
-  if (Genius::processor_id() == 0)
+  _comm_node = MPI_COMM_NULL;
+
+  // the processors which read the file
+  MPI_Comm comm_read = Genius::comm_world();
+  bool own_comm_read = false;
+  int node_rank = 0;
+
+#if MPI_VERSION >= 3
+  // one reader on each shared memory node, also when all the processors are on one node
+  MPI_Comm_split_type(Genius::comm_world(), MPI_COMM_TYPE_SHARED, Genius::processor_id(), MPI_INFO_NULL, &_comm_node);
+  MPI_Comm_rank(_comm_node, &node_rank);
+  MPI_Comm_split(Genius::comm_world(), node_rank == 0 ? 0 : MPI_UNDEFINED, Genius::processor_id(), &comm_read);
+  own_comm_read = true;
+#endif
+
+  MPI_File fh;
+  long long file_size = -1;
+  if( comm_read != MPI_COMM_NULL )
   {
-    std::ifstream   in(filename);
-    // test if file exist
-    genius_assert(in.good());
-    // read file into string
-    std::istreambuf_iterator<char>   beg(in),   end;
-    str = std::string(beg,   end);
-    
-    in.close();
+    if( MPI_File_open(comm_read, const_cast<char *>(filename.c_str()), MPI_MODE_RDONLY, MPI_INFO_NULL, &fh) == MPI_SUCCESS )
+    {
+      MPI_Offset offset;
+      MPI_File_get_size(fh, &offset);
+      file_size = offset;
+    }
   }
+  if( _comm_node != MPI_COMM_NULL )
+    MPI_Bcast(&file_size, 1, MPI_LONG_LONG, 0, _comm_node);
 
-  // Broadcast the string
-  Parallel::broadcast(str);
-  
-  //generate local file name 
-  std::string localfilename(filename);
-  std::string processor;
-  std::stringstream   ss;
-  ss << Genius::processor_id();
-  ss >> processor;
-  localfilename = localfilename + "." + processor;
-  
-  // write down
-  std::ofstream   out(localfilename.c_str());
-  out << str;
-  out.close();
-  
-  return localfilename;
+  if( file_size < 0 )
+  {
+    if( own_comm_read && comm_read != MPI_COMM_NULL ) MPI_Comm_free(&comm_read);
+    if( _comm_node != MPI_COMM_NULL ) MPI_Comm_free(&_comm_node);
+    return;
+  }
+  // the counts of MPI calls are int
+  genius_assert( file_size < INT_MAX );
+  _size = static_cast<size_t>(file_size);
+
+  // memory of the content
+#if MPI_VERSION >= 3
+  if( _comm_node != MPI_COMM_NULL )
+  {
+    char * base;
+    MPI_Win_allocate_shared(node_rank == 0 ? _size : 0, 1, MPI_INFO_NULL, _comm_node, &base, &_win);
+    MPI_Aint win_size;
+    int disp_unit;
+    MPI_Win_shared_query(_win, 0, &win_size, &disp_unit, &base);
+    _data = base;
+    MPI_Win_fence(0, _win);
+  }
+  else
+#endif
+  {
+    _buffer.resize(_size);
+    _data = _buffer.empty() ? 0 : &_buffer[0];
+  }
+
+  // each reader reads its part, and gathers the others
+  if( comm_read != MPI_COMM_NULL )
+  {
+    int n_readers, reader;
+    MPI_Comm_size(comm_read, &n_readers);
+    MPI_Comm_rank(comm_read, &reader);
+
+    std::vector<int> counts(n_readers), displs(n_readers);
+    for(int r=0; r<n_readers; ++r)
+    {
+      displs[r] = static_cast<int>(file_size*r/n_readers);
+      counts[r] = static_cast<int>(file_size*(r+1)/n_readers) - displs[r];
+    }
+
+    char * buf = const_cast<char *>(_data);
+    MPI_Status status;
+    MPI_File_read_at_all(fh, displs[reader], buf + displs[reader], counts[reader], MPI_BYTE, &status);
+    MPI_File_close(&fh);
+
+    if( n_readers > 1 )
+      MPI_Allgatherv(MPI_IN_PLACE, 0, MPI_DATATYPE_NULL, buf, &counts[0], &displs[0], MPI_BYTE, comm_read);
+
+    if( own_comm_read ) MPI_Comm_free(&comm_read);
+  }
+
+#if MPI_VERSION >= 3
+  // the content written by the reader is visible to the node after the fence
+  if( _comm_node != MPI_COMM_NULL )
+    MPI_Win_fence(0, _win);
+#endif
 
 #else
 
+  FILE * fp = fopen(filename.c_str(), "rb");
+  if( !fp ) return;
+  char buf[65536];
+  size_t n;
+  while( (n = fread(buf, 1, sizeof(buf), fp)) > 0 )
+    _buffer.insert(_buffer.end(), buf, buf+n);
+  fclose(fp);
+  _size = _buffer.size();
+  _data = _buffer.empty() ? 0 : &_buffer[0];
+
+#endif
+
+  _good = true;
+}
+
+
+SharedFile::~SharedFile()
+{
+#ifdef HAVE_MPI
+#if MPI_VERSION >= 3
+  if( _comm_node != MPI_COMM_NULL )
+  {
+    if( _good )
+      MPI_Win_free(&_win);
+    MPI_Comm_free(&_comm_node);
+  }
+#endif
+#endif
+}
+
+
+FILE * SharedFile::open() const
+{
+#ifndef WINDOWS
+  if( _size )
+    return fmemopen(const_cast<char *>(_data), _size, "r");
+#endif
+  // no fmemopen, use an anonymous temporary file
+  FILE * fp = tmpfile();
+  if( fp )
+  {
+    if( _size ) fwrite(_data, 1, _size, fp);
+    rewind(fp);
+  }
+  return fp;
+}
+
+
+/**
+ * transport text file to other processor,
+ * return local name as filename.processor_id
+ * (filename.processor_id.g<group> in sweep farm mode)
+ */
+const std::string sync_file(const char * filename, int processor)
+{
+  SharedFile file(filename);
   // test if file exist
-  std::ifstream   in(filename);
-  genius_assert(in.good());
-  
-  // read file into string
-  std::istreambuf_iterator<char>   beg(in),   end;
-  std::string str(beg,   end);
-  in.close();
-  
-  //generate local file name 
+  genius_assert(file.good());
+
+  if( processor >= 0 && static_cast<int>(Genius::processor_id()) != processor )
+    return std::string();
+
+  //generate local file name
   std::string localfilename(filename);
-  std::string processor;
+  std::string proc;
   std::stringstream   ss;
   ss << Genius::processor_id();
-  ss >> processor;
-  localfilename = localfilename + "." + processor;
-  
+  // processors of different sweep groups share the same processor_id
+  if( Genius::n_sweep_groups() > 1 )
+    ss << ".g" << Genius::sweep_group();
+  ss >> proc;
+  localfilename = localfilename + "." + proc;
+
   // write down
-  std::ofstream   out(localfilename.c_str());
-  out << str;
+  std::ofstream   out(localfilename.c_str(), std::ios::binary);
+  out.write(file.data(), file.size());
   out.close();
-  
-  return localfilename;
-
-#endif  
 
+  return localfilename;
 }
 
@@ -106,6 +106,9 @@ Tree<N>::Tree (const MeshBase& m,
       surface_elems.push_back(surface_elem);
     }
   }
+
+  // the tree will not change any more, build its flat image for fast query
+  root.flatten(flat_nodes, flat_elems);
 }
 
 
@@ -121,7 +124,37 @@ Tree<N>::~Tree()
 template <unsigned int N>
 const Elem* Tree<N>::find_element(const Point& p) const
 {
-  return root.find_element(p);
+  if (flat_nodes.empty()) return NULL;
+
+  // depth-first search over the tree nodes whose bounding box contains p.
+  // use local stack instead of recursion, nothing in the tree is modified
+  std::vector<unsigned int> stack;
+  stack.reserve(64);
+  stack.push_back(0);
+
+  while (!stack.empty())
+  {
+    const Trees::FlatTreeNode & node = flat_nodes[stack.back()];
+    stack.pop_back();
+
+    if (!node.bounds_point(p) && !node.contains_ifems) continue;
+
+    if (node.first_child == invalid_uint)
+    {
+      for (unsigned int e=node.elem_begin; e<node.elem_end; ++e)
+        if (flat_elems[e]->active() && flat_elems[e]->contains_point(p))
+          return flat_elems[e];
+    }
+    else
+    {
+      // push in reverse order, the first child is searched first
+      for (unsigned int c=node.n_children; c>0; --c)
+        stack.push_back(node.first_child + c - 1);
+    }
+  }
+
+  // _no_ elements in the tree claim to contain point p
+  return NULL;
 }
 
 
@@ -906,6 +906,45 @@ const Elem* TreeNode<N>::find_element_in_children(const Point& p) const
 
 
 
+template <unsigned int N>
+void TreeNode<N>::flatten (std::vector<Trees::FlatTreeNode> & flat_nodes,
+                           std::vector<const Elem*> & flat_elems) const
+{
+  flat_nodes.clear();
+  flat_elems.clear();
+
+  // breadth-first traversal, the position in queue is the index of flat node
+  std::vector<const TreeNode<N>*> queue(1, this);
+  for (unsigned int i=0; i<queue.size(); i++)
+  {
+    const TreeNode<N>* node = queue[i];
+
+    Trees::FlatTreeNode flat_node;
+    flat_node.bbox_min       = node->bounding_box.first;
+    flat_node.bbox_max       = node->bounding_box.second;
+    flat_node.contains_ifems = node->contains_ifems;
+    flat_node.elem_begin     = flat_elems.size();
+
+    if (node->active())
+    {
+      flat_node.first_child = invalid_uint;
+      flat_node.n_children  = 0;
+      flat_elems.insert(flat_elems.end(), node->elements.begin(), node->elements.end());
+    }
+    else
+    {
+      flat_node.first_child = queue.size();
+      flat_node.n_children  = node->children.size();
+      queue.insert(queue.end(), node->children.begin(), node->children.end());
+    }
+
+    flat_node.elem_end = flat_elems.size();
+    flat_nodes.push_back(flat_node);
+  }
+}
+
+
+
 // ------------------------------------------------------------
 // Explicit Instantiations
 template class TreeNode<4>;